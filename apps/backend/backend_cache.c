@@ -74,6 +74,8 @@
 
 /*! Autocli cache write
  *
+ * The terminating NUL is written as well, so that a client may map the file and parse it
+ * as a string
  * @param[in]  h        Clixon handle
  * @param[in]  filename Name of cache-line file
  * @param[in]  str      CLIspec data string
@@ -101,9 +103,9 @@ cache_autocli_write(clixon_handle h,
         clixon_err(OE_UNIX, errno, "fopen(%s)", filename);
         goto done;
     }
-    len = fwrite(str, 1, strlen(str), f);
-    if (len != strlen(str)){
-        clixon_err(OE_UNIX, errno, "fwrite %lu != %lu", len, strlen(str));
+    len = fwrite(str, 1, strlen(str)+1, f);
+    if (len != strlen(str)+1){
+        clixon_err(OE_UNIX, errno, "fwrite %lu != %lu", len, strlen(str)+1);
         goto done;
     }
     retval = 0;
@@ -121,7 +123,7 @@ cache_autocli_write(clixon_handle h,
  * @param[in]  spec     Yang spec
  * @param[in]  module   Yang module
  * @param[in]  revision Yang module revision
- * @param[in]  keyword  Yang keyword, module / submodule / grouping supported
+ * @param[in]  keyword  Yang keyword, module / submodule / grouping / container / list supported
  * @param[in]  argument Yang argument name
  * @param[out] cb       Generated clispec if retval = 1
  * @param[out] cbret    Return xml tree, eg <rpc-reply>..., <rpc-error.. if retval = 0
@@ -193,6 +195,16 @@ cache_autocli_generate(clixon_handle h,
         if (ret == 0)
             ; // empty
         break;
+    case Y_CONTAINER: /* Top-level treeref */
+    case Y_LIST:
+        if ((ys = yang_find(ymod, kw, argument)) == NULL){
+            if (netconf_operation_failed(cbret, "application", "No such YANG node %s %s", keyword, argument) < 0)
+                goto done;
+            goto fail;
+        }
+        if (yang2cli_toplevel(h, ys, cb) < 0)
+            goto done;
+        break;
     default:
         if (netconf_operation_failed(cbret, "application", "Keyword %s not supported", keyword) < 0)
             goto done;
@@ -240,6 +252,7 @@ trydir(const char *dir)
  * @param[in]  revision  Yang module revision
  * @param[in]  keyword   Yang node keyword
  * @param[in]  argument  Yang argument name
+ * @param[in]  file      Return name of cache file instead of data
  * @param[out] cbret     Return xml tree, eg <rpc-reply>..., <rpc-error..
  * @retval     1         OK
  * @retval     0         Fail, rpc error returned in cbret
@@ -254,6 +267,7 @@ cache_autocli_read_gen_write(clixon_handle h,
                              const char   *revision,
                              const char   *keyword,
                              const char   *argument,
+                             int           file,
                              cbuf         *cbret)
 {
     int         retval = -1;
@@ -265,6 +279,7 @@ cache_autocli_read_gen_write(clixon_handle h,
     struct stat fstat = {0,};
     size_t      len0;
     size_t      len;
+    int         generated = 0;
     int         ret;
 
     if (domain == NULL || module == NULL || argument == NULL || keyword == NULL){
@@ -295,6 +310,18 @@ cache_autocli_read_gen_write(clixon_handle h,
             goto fail;
         if (cache_autocli_write(h, filename, cbuf_get(cbdata)) < 0)
             goto done;
+        generated = 1;
+    }
+    if (file){
+        cprintf(cbret, "<rpc-reply xmlns=\"%s\"><file xmlns=\"%s\">",
+                NETCONF_BASE_NAMESPACE, CLIXON_LIB_NS);
+        if (xml_chardata_cbuf_append(cbret, 0, filename) < 0){
+            clixon_err(OE_UNIX, errno, "cbuf_append_str");
+            goto done;
+        }
+        cprintf(cbret, "</file></rpc-reply>");
+    }
+    else if (generated){
         /* XXX Or skip this and just read it ? */
         cprintf(cbret, "<rpc-reply xmlns=\"%s\"><data xmlns=\"%s\">",
                 NETCONF_BASE_NAMESPACE, CLIXON_LIB_NS);
@@ -370,6 +397,7 @@ clixon_cache_autocli(clixon_handle h,
     char           *argument = NULL;
     cbuf           *cberr = NULL;
     autocli_cache_t type;
+    int             file = 0;
     int             ret;
 
     if (autocli_cache(h, &type, &dir) < 0)
@@ -397,7 +425,9 @@ clixon_cache_autocli(clixon_handle h,
             keyword = xml_body(x);
         if ((x = xml_find_type(xe, NULL, "argument", CX_ELMNT)) != NULL)
             argument = xml_body(x);
-        if ((ret = cache_autocli_read_gen_write(h, dir, domain, spec, module, revision, keyword, argument, cbret)) < 0)
+        if ((x = xml_find_type(xe, NULL, "file", CX_ELMNT)) != NULL)
+            file = strcmp(xml_body(x), "true") == 0;
+        if ((ret = cache_autocli_read_gen_write(h, dir, domain, spec, module, revision, keyword, argument, file, cbret)) < 0)
             goto done;
         if (ret == 0)
             goto fail;
@@ -55,6 +55,8 @@
 #include <sys/socket.h>
 #include <sys/param.h>
 #include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/uio.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <netinet/in.h>
@@ -72,6 +74,55 @@
 #include "backend_get.h"
 #include "backend_cache.h"
 #include "backend_client.h"
+#include "backend_profile.h"
+#include "backend_partial_lock.h"
+#include "backend_snapshot.h"
+#include "backend_socket.h"
+
+/* Number of running reader processes, see CLICON_BACKEND_READERS */
+static int _backend_readers = 0;
+
+/* Set in a reader process, which writes its reply blocking before it exits */
+static int _backend_reader_child = 0;
+
+/* Max number of output queue buffers written in one call */
+#define BACKEND_OUTQ_IOV 64
+
+/* Max size of user name, transport and source host of a session handed over */
+#define BACKEND_HANDOFF_STRLEN 1024
+
+/*! Session handed over from the process serving clients while plugins start
+ *
+ * Followed by user name, transport and source host, each null-terminated and empty if
+ * not set. The client socket is passed with SCM_RIGHTS, a message without a socket ends
+ * the handover.
+ * @see backend_client_handoff
+ */
+struct client_handoff {
+    uint32_t        ch_id;                /* Session id */
+    uint32_t        ch_next_id;           /* Next session id, at end of handover */
+    struct sockaddr ch_addr;              /* Client address */
+    struct timeval  ch_time;              /* Time the session was established */
+    uint32_t        ch_in_rpcs;           /* Counters, see client_entry */
+    uint32_t        ch_in_bad_rpcs;
+    uint32_t        ch_out_rpc_errors;
+    uint32_t        ch_out_notifications;
+    int             ch_binary;            /* Client accepts binary replies */
+};
+
+/* Socket to the backend process, in the process serving clients while plugins start */
+static int _handoff_s = -1;
+
+/* Last notification serialized, shared by all subscribers it is sent to, see ce_event_buf */
+static struct outq_buf *_event_buf = NULL;
+static uint64_t         _event_buf_seq = 0;
+
+static int from_client_reader_cb(int fd, void *arg);
+static int backend_client_outq_cb(int fd, void *arg);
+static int backend_client_outq_done(client_entry *ce);
+static size_t backend_client_outq_len(client_entry *ce);
+static int backend_client_send_buf(client_entry *ce, struct outq_buf *ob);
+static struct outq_buf *backend_outq_buf_new(void);
 
 /*! Construct a client string description from client_entry information for logging
  *
@@ -119,8 +170,68 @@ ce_client_descr(client_entry *ce,
     return retval;
 }
 
+/*! Get notification event serialized and framed once for all subscribers
+ *
+ * @param[in]  h     Clixon handle
+ * @param[in]  event Event as XML
+ * @retval     ob    Output buffer, referenced until next event
+ * @retval     NULL  Error
+ * @see stream_event_seq
+ */
+static struct outq_buf *
+ce_event_buf(clixon_handle h,
+             cxobj        *event)
+{
+    struct outq_buf *ob = NULL;
+    cbuf            *cb = NULL;
+    uint64_t         seq;
+
+    seq = stream_event_seq();
+    if (_event_buf != NULL && _event_buf_seq == seq)
+        return _event_buf;
+    if (_event_buf != NULL){
+        backend_outq_buf_unref(_event_buf);
+        _event_buf = NULL;
+    }
+    if ((cb = cbuf_new()) == NULL){
+        clixon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    if (clixon_xml2cbuf(cb, event, 0, 0, NULL, -1, 0) < 0)
+        goto done;
+    clixon_debug(CLIXON_DBG_MSG | CLIXON_DBG_TRUNC, "Notify %s", cbuf_get(cb));
+    if ((ob = backend_outq_buf_new()) == NULL)
+        goto done;
+    cprintf(ob->ob_cb, "\n#%zu\n", cbuf_len(cb));
+    if (cbuf_append_buf(ob->ob_cb, cbuf_get(cb), cbuf_len(cb)) < 0){
+        clixon_err(OE_UNIX, errno, "cbuf_append_buf");
+        backend_outq_buf_unref(ob);
+        ob = NULL;
+        goto done;
+    }
+    cprintf(ob->ob_cb, "\n##\n");
+    _event_buf = ob;
+    _event_buf_seq = seq;
+ done:
+    if (cb)
+        cbuf_free(cb);
+    return ob;
+}
+
+/*! Release last shared notification buffer
+ */
+void
+ce_event_exit(void)
+{
+    if (_event_buf != NULL){
+        backend_outq_buf_unref(_event_buf);
+        _event_buf = NULL;
+    }
+}
+
 /*! Stream callback for netconf stream notification (RFC 5277)
  *
+ * The event is serialized once and the output buffer is shared by all subscribers.
  * @param[in]  h     Clixon handle
  * @param[in]  op    0:event, 1:rm
  * @param[in]  event Event as XML
@@ -136,8 +247,10 @@ ce_event_cb(clixon_handle h,
             void         *arg)
 {
     int           retval = -1;
-    client_entry *ce = (client_entry *)arg;
-    cbuf         *cbce = NULL;
+    client_entry    *ce = (client_entry *)arg;
+    cbuf            *cbce = NULL;
+    struct outq_buf *ob;
+    uint32_t         max;
 
     clixon_debug(CLIXON_DBG_BACKEND, "op:%d", op);
     switch (op){
@@ -147,14 +260,26 @@ ce_event_cb(clixon_handle h,
             backend_client_rm(h, ce);
         break;
     default:
-        if (ce_client_descr(ce, &cbce) < 0)
-            goto done;
-        if (send_msg_notify_xml(h, ce->ce_s, cbuf_get(cbce), event) < 0){
-            if (errno == ECONNRESET || errno == EPIPE){
-                clixon_log(h, LOG_WARNING, "client %d reset", ce->ce_nr);
-            }
+        if (ce->ce_s == 0)
+            break;
+        /* Drop a subscriber that does not keep up, instead of queueing without limit */
+        max = clicon_option_int(h, "CLICON_BACKEND_OUTQ_MAX");
+        if (max && backend_client_outq_len(ce) > max){
+            clixon_log(h, LOG_WARNING, "client %d: output queue exceeds %u bytes, disconnecting",
+                       ce->ce_nr, max);
+            if (backend_client_outq_done(ce) < 0)
+                goto done;
+            shutdown(ce->ce_s, SHUT_RDWR); /* Client is removed when eof is read */
             break;
         }
+        if (ce_client_descr(ce, &cbce) < 0)
+            goto done;
+        if ((ob = ce_event_buf(h, event)) == NULL)
+            goto done;
+        clixon_debug(CLIXON_DBG_MSG, "Send [%s] notification %zu bytes",
+                     cbuf_get(cbce), cbuf_len(ob->ob_cb));
+        if (backend_client_send_buf(ce, ob) < 0)
+            goto done;
         /* note there may be other notifications than RFC5277 streams */
         ce->ce_out_notifications++;
         netconf_monitoring_counter_inc(h, "out-notifications");
@@ -192,7 +317,7 @@ release_all_dbs(clixon_handle h,
     if (xmldb_candidate_find(h, "candidate", ceid, &de0, &db0) < 0)
         goto done;
     if (de0 != NULL){
-        if (clicon_option_bool(h, "CLICON_XMLDB_PRIVATE_CANDIDATE")) {
+        if (clicon_option_bool_id(h, CO_XMLDB_PRIVATE_CANDIDATE)) {
             if (xmldb_delete(h, db0) < 0)
                 goto done;
             if (xmldb_candidate_find(h, "candidate-orig", ceid, NULL, &db1) < 0)
@@ -207,7 +332,7 @@ release_all_dbs(clixon_handle h,
          * modified, and these changes have not been committed or rolled back.
          */
         else if (xmldb_islocked(h, db0) == id &&
-            clicon_option_bool(h, "CLICON_AUTOLOCK")){
+            clicon_option_bool_id(h, CO_AUTOLOCK)){
             if (xmldb_copy(h, "running", db0) < 0)
                 goto done;
             xmldb_modified_set(de0, 0); /* reset dirty bit */
@@ -225,6 +350,8 @@ release_all_dbs(clixon_handle h,
                 goto done;
         }
     }
+    if (partial_lock_release_all(h, id) < 0)
+        goto done;
     retval = 0;
  done:
     if (keys)
@@ -232,6 +359,561 @@ release_all_dbs(clixon_handle h,
     return retval;
 }
 
+/*! Write to client socket without blocking
+ *
+ * @param[in]  s       Client socket
+ * @param[in]  iov     Vector of buffers
+ * @param[in]  iovcnt  Number of buffers
+ * @retval     n       Number of bytes written, 0 if client is not ready to receive
+ * @retval    -1       Error, errno set
+ */
+static ssize_t
+backend_client_sendv(int           s,
+                     struct iovec *iov,
+                     int           iovcnt)
+{
+    struct msghdr msg = {0,};
+    ssize_t       n;
+
+    msg.msg_iov = iov;
+    msg.msg_iovlen = iovcnt;
+    while ((n = sendmsg(s, &msg, MSG_DONTWAIT)) < 0){
+        if (errno == EINTR)
+            continue;
+        if (errno == EAGAIN || errno == EWOULDBLOCK)
+            return 0;
+        break;
+    }
+    return n;
+}
+
+/*! Discard output queue of client and stop waiting for output
+ *
+ * @param[in]  ce   Client entry
+ */
+static void
+backend_client_outq_reset(client_entry *ce)
+{
+    if (ce->ce_outq_fd != -1){
+        clixon_event_unreg_fd(ce->ce_outq_fd, backend_client_outq_cb);
+        close(ce->ce_outq_fd);
+        ce->ce_outq_fd = -1;
+    }
+    backend_client_outq_free(ce);
+}
+
+/*! Create output buffer
+ *
+ * @retval  ob    Output buffer with one reference, release with backend_outq_buf_unref
+ * @retval  NULL  Error
+ */
+static struct outq_buf *
+backend_outq_buf_new(void)
+{
+    struct outq_buf *ob;
+
+    if ((ob = malloc(sizeof(*ob))) == NULL){
+        clixon_err(OE_UNIX, errno, "malloc");
+        return NULL;
+    }
+    memset(ob, 0, sizeof(*ob));
+    if ((ob->ob_cb = cbuf_new()) == NULL){
+        clixon_err(OE_UNIX, errno, "cbuf_new");
+        free(ob);
+        return NULL;
+    }
+    ob->ob_refcnt = 1;
+    return ob;
+}
+
+/*! Add a reference to an output buffer last in output queue of client
+ *
+ * @param[in]  ce   Client entry
+ * @param[in]  ob   Output buffer
+ * @param[in]  pos  Bytes of buffer already written
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+backend_client_outq_add(client_entry    *ce,
+                        struct outq_buf *ob,
+                        size_t           pos)
+{
+    struct outq_elem *oe;
+
+    if ((oe = malloc(sizeof(*oe))) == NULL){
+        clixon_err(OE_UNIX, errno, "malloc");
+        return -1;
+    }
+    memset(oe, 0, sizeof(*oe));
+    oe->oe_buf = ob;
+    oe->oe_pos = pos;
+    ob->ob_refcnt++;
+    ADDQ(oe, ce->ce_outq);
+    ce->ce_outq_len += cbuf_len(ob->ob_cb) - pos;
+    return 0;
+}
+
+/*! Append data to output queue of client
+ *
+ * The data is copied to the last buffer of the queue, unless it is shared or partly written
+ * @param[in]  ce    Client entry
+ * @param[in]  data  Data
+ * @param[in]  len   Length of data
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+static int
+backend_client_outq_append(client_entry *ce,
+                           const char   *data,
+                           size_t        len)
+{
+    struct outq_elem *oe;
+    struct outq_buf  *ob;
+
+    if ((oe = PREVQ(struct outq_elem *, ce->ce_outq)) != NULL &&
+        oe->oe_buf->ob_refcnt == 1 && oe->oe_pos == 0)
+        ob = oe->oe_buf;
+    else {
+        if ((ob = backend_outq_buf_new()) == NULL)
+            return -1;
+        if (backend_client_outq_add(ce, ob, 0) < 0){
+            backend_outq_buf_unref(ob);
+            return -1;
+        }
+        backend_outq_buf_unref(ob); /* Referenced by queue */
+    }
+    if (cbuf_append_buf(ob->ob_cb, (void*)data, len) < 0){
+        clixon_err(OE_UNIX, errno, "cbuf_append_buf");
+        return -1;
+    }
+    ce->ce_outq_len += len;
+    return 0;
+}
+
+/*! Dispatch class of a client given its transport: interactive CLI, then RESTCONF and SNMP
+ *
+ * NETCONF and other clients, typically bulk and automated, have the lowest class
+ * @param[in]  transport  Transport given in hello, or NULL
+ * @retval     class      Class, higher is served first
+ * @see clixon_event_fd_class
+ */
+static int
+backend_client_class(const char *transport)
+{
+    if (transport == NULL)
+        return 0;
+    if (strcmp(transport, "cl:cli") == 0)
+        return 2;
+    if (strcmp(transport, "cl:restconf") == 0 ||
+        strcmp(transport, "cl:snmp") == 0)
+        return 1;
+    return 0;
+}
+
+/*! Register client socket for reading requests with the dispatch class of the client
+ *
+ * @param[in]  ce   Client entry
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+backend_client_reg(client_entry *ce)
+{
+    int prio;
+
+    prio = clicon_option_bool_id(ce->ce_handle, CO_SOCK_PRIO);
+    if (clixon_event_reg_fd_prio(ce->ce_s, from_client, (void*)ce, "local netconf client socket",
+                                 prio) < 0)
+        return -1;
+    if (!prio && ce->ce_class &&
+        clixon_event_fd_class(ce->ce_s, ce->ce_class) < 0)
+        return -1;
+    return 0;
+}
+
+/*! Output queue of client is written or discarded, resume reading requests from it
+ *
+ * @param[in]  ce   Client entry
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+backend_client_outq_done(client_entry *ce)
+{
+    int waiting;
+
+    waiting = (ce->ce_outq_fd != -1);
+    backend_client_outq_reset(ce);
+    if (waiting && ce->ce_async == 0 &&
+        backend_client_reg(ce) < 0)
+        return -1;
+    return 0;
+}
+
+/*! Write as much as possible of the output queue of a client without blocking
+ *
+ * As long as the queue is not empty, wait for output on the client socket and do not
+ * read further requests from the client.
+ * A dup of the client socket is used since the socket itself is registered for input.
+ * @param[in]  ce   Client entry
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+backend_client_outq_flush(client_entry *ce)
+{
+    struct iovec      iov[BACKEND_OUTQ_IOV];
+    int               iovcnt = 0;
+    struct outq_elem *oe;
+    ssize_t           n;
+    size_t            len;
+
+    if (ce->ce_outq_len == 0)
+        return backend_client_outq_done(ce);
+    if (ce->ce_reader_pid != 0) /* Written when reader process has exited */
+        return 0;
+    oe = ce->ce_outq;
+    do {
+        iov[iovcnt].iov_base = cbuf_get(oe->oe_buf->ob_cb) + oe->oe_pos;
+        iov[iovcnt++].iov_len = cbuf_len(oe->oe_buf->ob_cb) - oe->oe_pos;
+        oe = NEXTQ(struct outq_elem *, oe);
+    } while (oe != ce->ce_outq && iovcnt < BACKEND_OUTQ_IOV);
+    if ((n = backend_client_sendv(ce->ce_s, iov, iovcnt)) < 0){
+        /* Client is gone, it is removed when eof is read */
+        clixon_debug(CLIXON_DBG_BACKEND, "client %d: %s", ce->ce_nr, strerror(errno));
+        return backend_client_outq_done(ce);
+    }
+    ce->ce_outq_len -= n;
+    /* Release written buffers */
+    while (n > 0 && (oe = ce->ce_outq) != NULL){
+        len = cbuf_len(oe->oe_buf->ob_cb) - oe->oe_pos;
+        if (n < len){
+            oe->oe_pos += n;
+            break;
+        }
+        n -= len;
+        DELQ(oe, ce->ce_outq, struct outq_elem *);
+        backend_outq_buf_unref(oe->oe_buf);
+        free(oe);
+    }
+    if (ce->ce_outq_len == 0)
+        return backend_client_outq_done(ce);
+    if (ce->ce_outq_fd == -1){
+        if ((ce->ce_outq_fd = dup(ce->ce_s)) < 0){
+            clixon_err(OE_UNIX, errno, "dup");
+            return -1;
+        }
+        if (clixon_event_reg_fd_out(ce->ce_outq_fd, backend_client_outq_cb, ce, "client output") < 0)
+            return -1;
+        /* Backpressure: no more requests until replies are written */
+        clixon_event_unreg_fd(ce->ce_s, from_client);
+    }
+    return 0;
+}
+
+/*! Client socket is writable, write queued output
+ *
+ * @param[in]  fd   Dup of client socket
+ * @param[in]  arg  Client entry
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+backend_client_outq_cb(int   fd,
+                       void *arg)
+{
+    client_entry *ce = (client_entry *)arg;
+
+    if (backend_client_outq_flush(ce) < 0)
+        return -1;
+    /* Requests read before reading was suspended */
+    if (ce->ce_outq_fd == -1 && ce->ce_async == 0 && clixon_msg_pending(ce->ce_s))
+        return from_client(ce->ce_s, ce);
+    return 0;
+}
+
+/*! Get number of bytes in output queue of client
+ *
+ * @param[in]  ce   Client entry
+ * @retval     len  Number of bytes not yet written to client
+ */
+static size_t
+backend_client_outq_len(client_entry *ce)
+{
+    return ce->ce_outq_len;
+}
+
+/*! Admission control of a request given its estimated memory cost
+ *
+ * The estimate plus the output queued to the client is checked against
+ * CLICON_BACKEND_SESSION_MEM_MAX, and plus the output queued to all clients against
+ * CLICON_BACKEND_MEM_MAX.
+ * Call before the request copies any tree.
+ * @param[in]  h      Clixon handle
+ * @param[in]  ce     Client entry of request
+ * @param[in]  size   Estimated memory cost of request in bytes
+ * @param[out] cbret  Return resource-denied rpc-error if not admitted
+ * @retval     1      Admitted
+ * @retval     0      Not admitted, rpc-error in cbret
+ * @retval    -1      Error
+ */
+int
+backend_client_admit(clixon_handle h,
+                     client_entry *ce,
+                     size_t        size,
+                     cbuf         *cbret)
+{
+    int           retval = -1;
+    uint32_t      max;
+    size_t        len;
+    client_entry *c;
+
+    if ((max = clicon_option_int(h, "CLICON_BACKEND_SESSION_MEM_MAX")) != 0 &&
+        size + backend_client_outq_len(ce) > max){
+        clixon_debug(CLIXON_DBG_BACKEND, "client %d: %zu bytes exceeds session budget %u",
+                     ce->ce_nr, size + backend_client_outq_len(ce), max);
+        if (netconf_resource_denied(cbret, "application", "Request exceeds session memory budget") < 0)
+            goto done;
+        goto fail;
+    }
+    if ((max = clicon_option_int(h, "CLICON_BACKEND_MEM_MAX")) != 0){
+        len = size;
+        for (c = backend_client_list(h); c; c = c->ce_next)
+            len += backend_client_outq_len(c);
+        if (len > max){
+            clixon_debug(CLIXON_DBG_BACKEND, "client %d: %zu bytes exceeds backend budget %u",
+                         ce->ce_nr, len, max);
+            if (netconf_resource_denied(cbret, "application", "Request exceeds backend memory budget") < 0)
+                goto done;
+            goto fail;
+        }
+    }
+    retval = 1;
+ done:
+    return retval;
+ fail:
+    ce->ce_out_rpc_errors++;
+    netconf_monitoring_counter_inc(h, "out-rpc-errors");
+    retval = 0;
+    goto done;
+}
+
+/*! Send a message, or a chunk of a message, to a client using NETCONF chunked framing
+ *
+ * The client socket is written without blocking. Output the client is not ready to
+ * receive is queued and written in order when the socket becomes writable.
+ * @param[in]  h     Clixon handle
+ * @param[in]  ce    Client entry
+ * @param[in]  data  Message data
+ * @param[in]  len   Length of message data, if 0 no chunk is sent
+ * @param[in]  last  If set, end message with end-of-chunks
+ * @retval     0     OK, or client is gone
+ * @retval    -1    Error
+ * @see clixon_msg_send11_chunk  Blocking
+ */
+int
+backend_client_send(clixon_handle h,
+                    client_entry *ce,
+                    const char   *data,
+                    size_t        len,
+                    int           last)
+{
+    struct iovec iov[3];
+    int          iovcnt = 0;
+    char         hdr[32];
+    ssize_t      n = 0;
+    int          i;
+
+    if (ce->ce_s == 0)
+        return 0;
+    if (_backend_reader_child)
+        return clixon_msg_send11_chunk(ce->ce_s, data, len, last);
+    if (len > 0){
+        snprintf(hdr, sizeof(hdr), "\n#%zu\n", len);
+        iov[iovcnt].iov_base = hdr;
+        iov[iovcnt++].iov_len = strlen(hdr);
+        iov[iovcnt].iov_base = (void*)data;
+        iov[iovcnt++].iov_len = len;
+    }
+    if (last){
+        iov[iovcnt].iov_base = "\n##\n";
+        iov[iovcnt++].iov_len = strlen("\n##\n");
+    }
+    /* Write directly unless earlier output is queued or a reader process is writing */
+    if (backend_client_outq_len(ce) == 0 &&
+        ce->ce_reader_pid == 0 &&
+        (n = backend_client_sendv(ce->ce_s, iov, iovcnt)) < 0){
+        clixon_debug(CLIXON_DBG_BACKEND, "client %d: %s", ce->ce_nr, strerror(errno));
+        return 0; /* Client is gone, it is removed when eof is read */
+    }
+    /* Queue the rest */
+    for (i=0; i<iovcnt; i++){
+        if (n >= iov[i].iov_len){
+            n -= iov[i].iov_len;
+            continue;
+        }
+        if (backend_client_outq_append(ce, (char*)iov[i].iov_base + n, iov[i].iov_len - n) < 0)
+            return -1;
+        n = 0;
+    }
+    if (backend_client_outq_len(ce) == 0)
+        return 0;
+    return backend_client_outq_flush(ce);
+}
+
+/*! Send a framed message in a shared output buffer to a client
+ *
+ * As backend_client_send, but output the client is not ready to receive is queued as
+ * a reference to the buffer instead of a copy.
+ * @param[in]  ce    Client entry
+ * @param[in]  ob    Output buffer with complete framed message
+ * @retval     0     OK, or client is gone
+ * @retval    -1     Error
+ */
+static int
+backend_client_send_buf(client_entry    *ce,
+                        struct outq_buf *ob)
+{
+    struct iovec iov;
+    ssize_t      n = 0;
+
+    if (ce->ce_s == 0)
+        return 0;
+    if (_backend_reader_child)
+        return clixon_msg_send(ce->ce_s, NULL, ob->ob_cb);
+    if (backend_client_outq_len(ce) == 0 &&
+        ce->ce_reader_pid == 0){
+        iov.iov_base = cbuf_get(ob->ob_cb);
+        iov.iov_len = cbuf_len(ob->ob_cb);
+        if ((n = backend_client_sendv(ce->ce_s, &iov, 1)) < 0){
+            clixon_debug(CLIXON_DBG_BACKEND, "client %d: %s", ce->ce_nr, strerror(errno));
+            return 0; /* Client is gone, it is removed when eof is read */
+        }
+        if (n == iov.iov_len)
+            return 0;
+    }
+    if (backend_client_outq_add(ce, ob, n) < 0)
+        return -1;
+    return backend_client_outq_flush(ce);
+}
+
+/*! Reap reader process of a client
+ *
+ * @param[in]  ce    Client entry
+ * @param[in]  stop  Kill reader process first, eg when client is removed
+ */
+static void
+from_client_reader_reap(client_entry *ce,
+                        int           stop)
+{
+    clixon_event_unreg_fd(ce->ce_reader_fd, from_client_reader_cb);
+    close(ce->ce_reader_fd);
+    if (stop)
+        kill(ce->ce_reader_pid, SIGKILL);
+    if (waitpid(ce->ce_reader_pid, NULL, 0) < 0)
+        clixon_debug(CLIXON_DBG_BACKEND, "waitpid(%d): %s", ce->ce_reader_pid, strerror(errno));
+    ce->ce_reader_pid = 0;
+    ce->ce_reader_fd = 0;
+    _backend_readers--;
+}
+
+/*! Reader process has sent its reply and exited, resume reading from client
+ *
+ * @param[in]  fd   Pipe closed by reader process
+ * @param[in]  arg  Client entry
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+from_client_reader_cb(int   fd,
+                      void *arg)
+{
+    client_entry *ce = (client_entry *)arg;
+
+    from_client_reader_reap(ce, 0);
+    if (backend_client_reg(ce) < 0)
+        return -1;
+    /* Output queued while reader process was writing, may suspend reading again */
+    if (backend_client_outq_flush(ce) < 0)
+        return -1;
+    /* Messages read while suspended */
+    if (ce->ce_outq_fd == -1 && clixon_msg_pending(ce->ce_s))
+        return from_client(ce->ce_s, ce);
+    return 0;
+}
+
+/*! Serve a read-only rpc in a reader process
+ *
+ * The reader process has a copy-on-write snapshot of the datastore caches, makes the
+ * rpc callback, sends the reply and exits, while the main loop serves other clients.
+ * Reading from the client socket is suspended until the reader process exits, so that
+ * replies are sent in order.
+ * @param[in]  h     Clixon handle
+ * @param[in]  ce    Client entry
+ * @param[in]  xe    Rpc operation, eg get-config
+ * @retval     2     Reader process: continue with rpc and exit after reply
+ * @retval     1     Parent: rpc is served by reader process
+ * @retval     0     Not a read-only rpc or no reader available: serve it here
+ * @retval    -1     Error
+ * @see CLICON_BACKEND_READERS
+ */
+static int
+from_client_reader(clixon_handle h,
+                   client_entry *ce,
+                   cxobj        *xe)
+{
+    yang_stmt *ye;
+    char      *ns;
+    char      *name;
+    int        fd[2] = {-1, -1};
+    pid_t      pid;
+    clixon_plugin_t *cp = NULL;
+
+    if (_backend_readers >= clicon_option_int(h, "CLICON_BACKEND_READERS"))
+        return 0;
+    /* Queued output must be written before the reply */
+    if (backend_client_outq_len(ce) > 0)
+        return 0;
+    if ((ye = xml_spec(xe)) == NULL ||
+        (ns = yang_find_mynamespace(ye)) == NULL)
+        return 0;
+    name = xml_name(xe);
+    if (!(strcmp(ns, NETCONF_BASE_NAMESPACE) == 0 &&
+          (strcmp(name, "get-config") == 0 || strcmp(name, "get") == 0)) &&
+        !(strcmp(ns, NETCONF_MONITORING_NAMESPACE) == 0 && strcmp(name, "get-schema") == 0) &&
+        !(strcmp(ns, NETCONF_COMPARE_NAMESPACE) == 0 && strcmp(name, "compare") == 0))
+        return 0;
+    /* Asynchronous state data is collected in the main loop */
+    if (strcmp(name, "get") == 0)
+        while ((cp = clixon_plugin_each(h, cp)) != NULL)
+            if (clixon_plugin_api_get(cp)->ca_statedata_async != NULL)
+                return 0;
+    if (pipe(fd) < 0 || (pid = fork()) < 0){
+        clixon_log(h, LOG_WARNING, "Reader process: %s, serving %s in main loop", strerror(errno), name);
+        if (fd[0] != -1){
+            close(fd[0]);
+            close(fd[1]);
+        }
+        return 0;
+    }
+    if (pid == 0){ /* Reader process, fd[1] is closed on exit */
+        close(fd[0]);
+        _backend_reader_child = 1;
+        return 2;
+    }
+    close(fd[1]);
+    ce->ce_reader_pid = pid;
+    ce->ce_reader_fd = fd[0];
+    _backend_readers++;
+    if (clixon_event_unreg_fd(ce->ce_s, from_client) < 0 ||
+        clixon_event_reg_fd(fd[0], from_client_reader_cb, ce, "backend reader") < 0){
+        clixon_err(OE_EVENTS, 0, "Reader process events");
+        return -1;
+    }
+    return 1;
+}
+
 /*! Remove client entry state
  *
  * Close down everything wrt clients (eg sockets, subscriptions)
@@ -273,6 +955,12 @@ backend_client_rm(clixon_handle h,
     }
 
     clixon_debug(CLIXON_DBG_BACKEND, "");
+    if (ce->ce_reader_pid != 0)
+        from_client_reader_reap(ce, 1);
+    /* Pending asynchronous rpc, there is no client to reply to */
+    if (clixon_plugin_rpc_async_client_rm(h, myid) < 0)
+        return -1;
+    backend_client_outq_reset(ce);
     /* for all streams: XXX better to do it top-level? */
     stream_ss_delete_all(h, ce_event_cb, (void*)ce);
     c0 = backend_client_list(h);
@@ -353,7 +1041,7 @@ do_lock(clixon_handle h,
         goto done;
     if (xmldb_candidate_get(de)) {
         /* Add system-only config to candidate cache */
-        if (clicon_option_bool(h, "CLICON_XMLDB_SYSTEM_ONLY_CONFIG")){
+        if (clicon_option_bool_id(h, CO_XMLDB_SYSTEM_ONLY_CONFIG)){
             if (system_only_data_add(h, db) < 0)
                 goto done;
         }
@@ -401,6 +1089,7 @@ from_client_edit_config(clixon_handle h,
     uint32_t             myid = ce->ce_id;
     uint32_t             iddb;
     char                *target = NULL;
+    char                *dbput;
     cxobj               *xc;
     cxobj               *x;
     enum operation_type  operation = OP_MERGE;
@@ -441,7 +1130,7 @@ from_client_edit_config(clixon_handle h,
         goto ok;
     }
     /* Here iddb is =0 (not locked) or locked by this process =myid */
-    if (iddb == 0 && clicon_option_bool(h, "CLICON_AUTOLOCK") &&
+    if (iddb == 0 && clicon_option_bool_id(h, CO_AUTOLOCK) &&
         xmldb_candidate_get(de)){
         if ((ret = do_lock(h, cbret, myid, de)) < 0)
             goto done;
@@ -450,7 +1139,7 @@ from_client_edit_config(clixon_handle h,
     }
     if (xmldb_candidate_get(de)) {
         /* Add system-only config to candidate cache */
-        if (clicon_option_bool(h, "CLICON_XMLDB_SYSTEM_ONLY_CONFIG")){
+        if (clicon_option_bool_id(h, CO_XMLDB_SYSTEM_ONLY_CONFIG)){
             if (system_only_data_add(h, target) < 0)
                 goto done;
         }
@@ -504,6 +1193,17 @@ from_client_edit_config(clixon_handle h,
             goto done;
         goto ok;
     }
+    /* Memory admission control, the edit grows the target by about the size of config */
+    if (clicon_option_int(h, "CLICON_BACKEND_SESSION_MEM_MAX") ||
+        clicon_option_int(h, "CLICON_BACKEND_MEM_MAX")){
+        size_t sz = 0;
+        if (xml_stats(xc, XML_STATS_ALL, NULL, &sz) < 0)
+            goto done;
+        if ((ret = backend_client_admit(h, ce, sz, cbret)) < 0)
+            goto done;
+        if (ret == 0)
+            goto ok;
+    }
     if (non_config){
         if (netconf_invalid_value(cbret, "protocol", "State data not allowed")< 0)
             goto done;
@@ -544,13 +1244,30 @@ from_client_edit_config(clixon_handle h,
             goto done;
         goto ok;
     }
-    if ((ret = xmldb_put(h, target, operation, xc, username, cbret)) < 0){
+    /* Edit of running while another session holds a partial lock is made in a copy,
+     * and is denied if it changes locked nodes, RFC 5717 */
+    if (strcmp(target, "running") == 0 && partial_lock_other(h, myid) != 0){
+        if (xmldb_copy(h, "running", "tmp") < 0)
+            goto done;
+        dbput = "tmp";
+    }
+    else
+        dbput = target;
+    if ((ret = xmldb_put(h, dbput, operation, xc, username, cbret)) < 0){
         if (netconf_operation_failed(cbret, "protocol", "%s", clixon_err_reason())< 0)
             goto done;
         goto ok;
     }
     if (ret == 0)
         goto ok;
+    if (dbput != target){
+        if ((ret = partial_lock_write_check(h, target, dbput, myid, cbret)) < 0)
+            goto done;
+        if (ret == 0)
+            goto ok;
+        if (xmldb_copy(h, dbput, target) < 0)
+            goto done;
+    }
     xmldb_modified_set(de, 1); /* mark as dirty */
     /* Clixon extension: autocommit */
     if ((attr = xml_find_value(xe, "autocommit")) != NULL &&
@@ -586,7 +1303,7 @@ from_client_edit_config(clixon_handle h,
                 break;
             }
         }
-        if (clicon_option_bool(h, "CLICON_XMLDB_PRIVATE_CANDIDATE")) {
+        if (clicon_option_bool_id(h, CO_XMLDB_PRIVATE_CANDIDATE)) {
             /* First step, rebase private candidate with running */
             if ((ret = backend_update(h, ce->ce_id, de, cbret)) < 0)
                 goto done;
@@ -634,7 +1351,7 @@ from_client_edit_config(clixon_handle h,
     /* Unwind auto-lock if no changes made, ie put deny */
     if (de &&
         xmldb_modified_get(de) == 0 &&
-        clicon_option_bool(h, "CLICON_AUTOLOCK") &&
+        clicon_option_bool_id(h, CO_AUTOLOCK) &&
         xmldb_islocked(h, target) == myid){
         xmldb_unlock(h, target);
         /* user callback */
@@ -710,13 +1427,20 @@ from_client_copy_config(clixon_handle h,
         goto ok;
     }
     /* Here iddb is =0 (not locked) or locked by this process =myid */
-    if (iddb == 0 && clicon_option_bool(h, "CLICON_AUTOLOCK") &&
+    if (iddb == 0 && clicon_option_bool_id(h, CO_AUTOLOCK) &&
         xmldb_candidate_get(detarget)){
         if ((ret = do_lock(h, cbret, myid, detarget)) < 0)
             goto done;
         if (ret == 0)
             goto ok;
     }
+    /* Changes of nodes partially locked by other sessions are denied, RFC 5717 */
+    if (strcmp(target, "running") == 0){
+        if ((ret = partial_lock_write_check(h, target, source, myid, cbret)) < 0)
+            goto done;
+        if (ret == 0)
+            goto ok;
+    }
     if (xmldb_copy(h, source, target) < 0){
         if ((cbmsg = cbuf_new()) == NULL){
             clixon_err(OE_UNIX, errno, "cbuf_new");
@@ -730,14 +1454,14 @@ from_client_copy_config(clixon_handle h,
     if (xmldb_candidate_get(detarget)){
         xmldb_modified_set(detarget, 1); /* mark as dirty */
         /* Add system-only config to candidate */
-        if (clicon_option_bool(h, "CLICON_XMLDB_SYSTEM_ONLY_CONFIG")){
+        if (clicon_option_bool_id(h, CO_XMLDB_SYSTEM_ONLY_CONFIG)){
             if (system_only_data_add(h, target) < 0)
                 goto done;
         }
     }
     /* Remove system-only-config data from destination cache */
     if (xmldb_candidate_get(desrc)){
-        if (clicon_option_bool(h, "CLICON_XMLDB_SYSTEM_ONLY_CONFIG")){
+        if (clicon_option_bool_id(h, CO_XMLDB_SYSTEM_ONLY_CONFIG)){
             xmldb_clear(h, target);
         }
     }
@@ -813,7 +1537,7 @@ from_client_delete_config(clixon_handle h,
             goto done;
         goto ok;
     }
-    if (clicon_option_bool(h, "CLICON_XMLDB_PRIVATE_CANDIDATE") &&
+    if (clicon_option_bool_id(h, CO_XMLDB_PRIVATE_CANDIDATE) &&
         xmldb_candidate_get(de)){
         /* deleting the private candidate will destroy the private candidate for
            that session */
@@ -896,6 +1620,15 @@ from_client_lock(clixon_handle h,
             goto done;
         goto ok;
     }
+    /* RFC 5717: A global lock of running fails if another session holds a partial lock */
+    if (strcmp(db, "running") == 0 &&
+        (iddb = partial_lock_other(h, id)) != 0){
+        cprintf(cbx, "<session-id>%u</session-id>", iddb);
+        cprintf(cbx, "<db>%s</db>", db);
+        if (netconf_lock_denied(cbret, cbuf_get(cbx), "Operation failed, partial lock is held by another session") < 0)
+            goto done;
+        goto ok;
+    }
     if ((de = xmldb_find(h, db)) == NULL){
         clixon_err(OE_DB, 0, "DB not found %s", db);
         goto done;
@@ -1154,7 +1887,7 @@ from_client_create_subscription(clixon_handle h,
     /* Add subscriber to stream - to make notifications for this client */
     if (stream_ss_add(h, stream, selector,
                       starttime?&start:NULL, stoptime?&stop:NULL,
-                      ce_event_cb, (void*)ce) < 0)
+                      ce_event_cb, (void*)ce) == NULL)
         goto done;
     /* Replay of this stream to specific subscription according to start and
      * stop (if present). 
@@ -1224,6 +1957,9 @@ from_client_get_schema(clixon_handle h,
         version = xml_body(x);
     if ((x = xpath_first(xe, nsc, "format")) != NULL)
         format = xml_body(x);
+    /* Module may not be loaded yet, see CLICON_YANG_MAIN_LAZY */
+    if (identifier && yang_find(yspec, Y_MODULE, identifier) == NULL)
+        yang_lazy_load(yspec, NULL, identifier);
     ymatch = NULL;
     inext = 0;
     while ((ymod = yn_iter(yspec, &inext)) != NULL) {
@@ -1540,6 +2276,8 @@ from_client_hello(clixon_handle  h,
     int           retval = -1;
     char         *val;
     client_entry *ce = (client_entry *)arg;
+    cxobj        *xcaps;
+    cxobj        *xcap;
 
     if ((val = xml_find_type_value(xe, "cl", "transport", CX_ATTR)) != NULL){
         if (ce->ce_transport)
@@ -1548,6 +2286,12 @@ from_client_hello(clixon_handle  h,
             clixon_err(OE_UNIX, errno, "strdup");
             goto done;
         }
+        /* Serve interactive clients before bulk clients */
+        ce->ce_class = backend_client_class(ce->ce_transport);
+        if (!clicon_option_bool_id(h, CO_SOCK_PRIO) &&
+            ce->ce_reader_pid == 0 && ce->ce_outq_fd == -1 &&
+            clixon_event_fd_class(ce->ce_s, ce->ce_class) < 0)
+            goto done;
     }
     if ((val = xml_find_type_value(xe, "cl", "source-host", CX_ATTR)) != NULL){
         if (ce->ce_source_host)
@@ -1557,6 +2301,14 @@ from_client_hello(clixon_handle  h,
             goto done;
         }
     }
+    ce->ce_binary = 0;
+    if ((xcaps = xml_find_type(xe, NULL, "capabilities", CX_ELMNT)) != NULL){
+        xcap = NULL;
+        while ((xcap = xml_child_each(xcaps, xcap, CX_ELMNT)) != NULL)
+            if ((val = xml_body(xcap)) != NULL &&
+                strcmp(val, CLIXON_BIN_CAPABILITY) == 0)
+                ce->ce_binary = 1;
+    }
     cprintf(cbret, "<hello xmlns=\"%s\"><session-id>%u</session-id></hello>",
             NETCONF_BASE_NAMESPACE, ce->ce_id);
     retval = 0;
@@ -1564,6 +2316,107 @@ from_client_hello(clixon_handle  h,
     return retval;
 }
 
+/*! Send a part of a reply to client while the reply is printed
+ *
+ * @param[in]  buf   Reply data
+ * @param[in]  len   Length of reply data
+ * @param[in]  arg   Client entry
+ * @retval     0     OK
+ * @retval    -1     Error
+ * @see clixon_xml2cbuf_stream
+ */
+static int
+from_client_stream_cb(char  *buf,
+                      size_t len,
+                      void  *arg)
+{
+    client_entry *ce = (client_entry *)arg;
+
+    return backend_client_send(ce->ce_handle, ce, buf, len, 0);
+}
+
+/*! Record time and sizes of an rpc in the rpc profile, and log the rpc if it is slow
+ *
+ * @param[in]  h         Clixon handle
+ * @param[in]  ce        Client entry
+ * @param[in]  rpc       Rpc name
+ * @param[in]  username  Username of rpc, or NULL
+ * @param[in]  t0        Time when request was read
+ * @param[in]  msg       Request
+ * @param[in]  reply     Size of reply
+ * @param[in]  error     Reply is an rpc-error
+ * @retval     0         OK
+ * @retval    -1         Error
+ * @see CLICON_RPC_PROFILE
+ * @see CLICON_RPC_SLOW_LOG
+ */
+static int
+from_client_msg_profile(clixon_handle   h,
+                        client_entry   *ce,
+                        const char     *rpc,
+                        const char     *username,
+                        struct timeval *t0,
+                        const char     *msg,
+                        size_t          reply,
+                        int             error)
+{
+    struct timeval t;
+    uint64_t       usec;
+    uint32_t       slow;
+    int            profile;
+    size_t         req;
+
+    profile = clicon_option_bool(h, "CLICON_RPC_PROFILE");
+    slow = clicon_option_int(h, "CLICON_RPC_SLOW_LOG");
+    if (!profile && slow == 0)
+        return 0;
+    gettimeofday(&t, NULL);
+    timersub(&t, t0, &t);
+    usec = (uint64_t)t.tv_sec*1000000 + t.tv_usec;
+    req = strlen(msg);
+    if (profile &&
+        rpc_profile_add(rpc, usec, req, reply, error) < 0)
+        return -1;
+    if (slow && usec >= (uint64_t)slow*1000)
+        clixon_log(h, LOG_NOTICE, "Slow rpc %s: %" PRIu64 " usec session-id:%u username:%s transport:%s request:%zu reply:%zu bytes%s",
+                   rpc, usec, ce->ce_id,
+                   username ? username : (ce->ce_username ? ce->ce_username : ""),
+                   ce->ce_transport ? ce->ce_transport : "",
+                   req, reply,
+                   error ? " rpc-error" : "");
+    return 0;
+}
+
+/*! Check if an rpc is read-only, served while plugins start in the background
+ *
+ * @param[in]  xe    Rpc operation, eg <get>
+ * @retval     1     Read-only: get, get-config, get-schema, compare, close-session, or
+ *                   clixon-lib ping, stats or generation
+ * @retval     0     Not read-only
+ * @note create-subscription is not served, subscriptions are not handed over
+ * @see clixon_plugin_start_background
+ */
+static int
+from_client_readonly(cxobj *xe)
+{
+    yang_stmt *ye;
+    char      *ns;
+    char      *name;
+
+    if ((ye = xml_spec(xe)) == NULL ||
+        (ns = yang_find_mynamespace(ye)) == NULL)
+        return 0;
+    name = xml_name(xe);
+    if (strcmp(ns, NETCONF_BASE_NAMESPACE) == 0)
+        return strcmp(name, "get-config") == 0 || strcmp(name, "get") == 0 ||
+            strcmp(name, "close-session") == 0;
+    if (strcmp(ns, CLIXON_LIB_NS) == 0)
+        return strcmp(name, "ping") == 0 || strcmp(name, "stats") == 0 ||
+            strcmp(name, "generation") == 0;
+    return (strcmp(ns, NETCONF_MONITORING_NAMESPACE) == 0 && strcmp(name, "get-schema") == 0) ||
+        (strcmp(ns, NETCONF_COMPARE_NAMESPACE) == 0 && strcmp(name, "compare") == 0);
+}
+
 /*! An internal clixon NETCONF message has arrived from a local client. Receive and dispatch.
  *
  * @param[in]   h    Clixon handle
@@ -1585,7 +2438,7 @@ from_client_msg(clixon_handle h,
     char                *rpc = NULL;
     char                *module = NULL;
     cbuf                *cbret = NULL; /* return message */
-    char                *username;
+    char                *username = NULL;
     yang_stmt           *yspec;
     yang_stmt           *ye;
     yang_stmt           *ymod;
@@ -1598,9 +2451,17 @@ from_client_msg(clixon_handle h,
     char                *msg_id = NULL;
     int                  nr = 0;
     cbuf                *cbce = NULL;
+    int                  reader = 0;
+    size_t               streamed = 0;
+    int                  chunk;
+    size_t               len;
+    struct timeval       t0;
+    uint32_t             errors0;
     int                  ret;
 
     clixon_debug(CLIXON_DBG_BACKEND | CLIXON_DBG_DETAIL, "");
+    gettimeofday(&t0, NULL);
+    errors0 = ce->ce_out_rpc_errors;
     yspec = clicon_dbspec_yang(h);
     /* Return netconf message. Should be filled in by the dispatch(sub) functions
      * as wither rpc-error or by positive response.
@@ -1728,8 +2589,10 @@ from_client_msg(clixon_handle h,
         netconf_monitoring_counter_inc(h, "in-bad-rpcs");
         goto reply;
     }
-    ce->ce_in_rpcs++; /* Track all RPCs */
-    netconf_monitoring_counter_inc(h, "in-rpcs");
+    if (ce->ce_async == 0){ /* Not again when asynchronous state data is done */
+        ce->ce_in_rpcs++; /* Track all RPCs */
+        netconf_monitoring_counter_inc(h, "in-rpcs");
+    }
     /* Message-id for replies */
     msg_id = xml_find_value(x, "message-id");
 
@@ -1753,6 +2616,9 @@ from_client_msg(clixon_handle h,
         module = yang_argument_get(ymod);
         clixon_debug(CLIXON_DBG_BACKEND, "module:%s rpc:%s ce_id:%u s:%d", module,
                      rpc, ce->ce_id, ce->ce_s);
+        /* Make waiting grouped commits first, if needed */
+        if (commit_group_check(h, ce, xe) < 0)
+            goto done;
         /* Pre-NACM access step */
         xnacm = NULL;
 
@@ -1794,8 +2660,40 @@ from_client_msg(clixon_handle h,
                 goto reply;
             }
         }
+        /* Only read-only rpcs until plugins started in background are done */
+        if (clixon_plugin_start_pending(NULL) && !from_client_readonly(xe)){
+            if (netconf_resource_denied(cbret, "application", "Backend is starting, only read-only operations are allowed") < 0)
+                goto done;
+            ce->ce_out_rpc_errors++;
+            netconf_monitoring_counter_inc(h, "out-rpc-errors");
+            goto reply;
+        }
         clixon_err_reset();
-        if ((ret = rpc_callback_call(h, xe, ce, &nr, cbret)) < 0){
+        /* Read-only rpc may be served by a reader process */
+        if ((reader = from_client_reader(h, ce, xe)) < 0)
+            goto done;
+        if (reader == 1){
+            ce->ce_reply_deferred = 1;
+            goto reply;
+        }
+        /* Large replies are sent in chunks while they are printed */
+        if ((chunk = clicon_option_int(h, "CLICON_BACKEND_REPLY_STREAM")) > 0)
+            clixon_xml2cbuf_stream(cbret, from_client_stream_cb, ce, chunk);
+        /* State data of get may be collected asynchronously */
+        if (reader == 0 && strcmp(rpc, "get") == 0 && strcmp(module, "ietf-netconf") == 0)
+            clixon_plugin_statedata_async_client(ce, msg);
+        ret = rpc_callback_call(h, xe, ce, &nr, cbret);
+        clixon_plugin_statedata_async_client(NULL, NULL);
+        /* Suspend reading from client until state data is done, so that replies are in order */
+        if (ce->ce_async && ce->ce_reply_deferred && ce->ce_outq_fd == -1 &&
+            clixon_event_unreg_fd(ce->ce_s, from_client) < 0)
+            goto done;
+        streamed += clixon_xml2cbuf_stream_flushed();
+        clixon_xml2cbuf_stream(NULL, NULL, NULL, 0);
+        /* Asynchronous rpc, the reply is sent by clixon_plugin_rpc_async_done */
+        if (ret >= 0 && nr && ce->ce_async && ce->ce_reply_deferred)
+            goto reply;
+        if (ret < 0){
             if (netconf_operation_failed(cbret, "application", "%s", clixon_err_reason())< 0)
                 goto done;
             clixon_log(h, LOG_NOTICE, "%s Error in rpc_callback_call:%s", __func__, xml_name(xe));
@@ -1815,14 +2713,18 @@ from_client_msg(clixon_handle h,
             netconf_monitoring_counter_inc(h, "out-rpc-errors");
             goto reply;
         }
-        if (xnacm){
-            xml_free(xnacm);
+        if (xnacm){ /* Owned by NACM */
             xnacm = NULL;
             if (clicon_nacm_cache_set(h, NULL) < 0)
                 goto done;
         }
     } /* while */
  reply:
+    if (ce->ce_reply_deferred){ /* Sent by commit_group_flush, when state data is done, or by async rpc */
+        ce->ce_reply_deferred = 0;
+        retval = 0;
+        goto done;
+    }
     if (cbuf_len(cbret) == 0)
         if (netconf_operation_failed(cbret, "application", "%s",
                                      clixon_err_category()?clixon_err_reason():"unknown")< 0)
@@ -1837,29 +2739,29 @@ from_client_msg(clixon_handle h,
         cprintf(cbce, " r:%s", rpc);
     if (msg_id)
         cprintf(cbce, " m:%s", msg_id);
-    if (send_msg_reply(ce->ce_s, cbuf_get(cbce), cbuf_get(cbret), cbuf_len(cbret)+1) < 0){
-        switch (errno){
-        case EPIPE:
-            /* man (2) write: 
-             * EPIPE  fd is connected to a pipe or socket whose reading end is 
-             * closed.  When this happens the writing process will also receive 
-             * a SIGPIPE signal. 
-             * In Clixon this means a client, eg restconf, netconf or cli closes
-             * the (UNIX domain) socket.
-             */
-        case ECONNRESET:
-            clixon_log(h, LOG_WARNING, "client rpc reset");
-            break;
-        default:
-            goto done;
-        }
-    }
+    if (streamed) /* Rest of streamed reply */
+        clixon_debug(CLIXON_DBG_MSG, "Send [%s] %zu bytes streamed", cbuf_get(cbce), streamed + cbuf_len(cbret));
+    else
+        clixon_debug(CLIXON_DBG_MSG | CLIXON_DBG_TRUNC, "Send [%s] %s", cbuf_get(cbce), cbuf_get(cbret));
+    /* A client that has closed its socket, eg restconf, netconf or cli, is removed when
+     * eof is read */
+    /* Binary replies may contain NULL chars */
+    if (clixon_bin_magic(cbuf_get(cbret), cbuf_len(cbret)))
+        len = cbuf_len(cbret);
+    else
+        len = strlen(cbuf_get(cbret));
+    if (backend_client_send(h, ce, cbuf_get(cbret), len, 1) < 0)
+        goto done;
+    /* Rpcs served by reader processes are not recorded */
+    if (rpc && reader == 0 &&
+        from_client_msg_profile(h, ce, rpc, username, &t0, msg, streamed + len,
+                                ce->ce_out_rpc_errors != errors0) < 0)
+        goto done;
     // ok:
     retval = 0;
   done:
     clixon_debug(CLIXON_DBG_BACKEND | CLIXON_DBG_DETAIL, "retval:%d", retval);
     if (xnacm){
-        xml_free(xnacm);
         if (clicon_nacm_cache_set(h, NULL) < 0)
             goto done;
     }
@@ -1875,6 +2777,8 @@ from_client_msg(clixon_handle h,
     if (retval < 0 && clixon_err_category() < 0)
         clixon_log(h, LOG_NOTICE, "%s: Internal error: No clixon_err call on RPC error (message: %s)",
                    __func__, rpc?rpc:"");
+    if (reader == 2) /* Reader process: reply sent, dont exit() parent state */
+        _exit(retval < 0 ? 1 : 0);
     //    clixon_debug(CLIXON_DBG_BACKEND, "retval:%d", retval);
     return retval;// -1 here terminates backend
 }
@@ -1898,6 +2802,11 @@ from_client(int   s,
     int           eof = 0;
     cbuf         *cbce = NULL;
     cbuf         *cb = NULL;
+    uint32_t      id;
+    int           slice;
+    struct timeval t0;
+    struct timeval t;
+    int           ret;
 
     clixon_debug(CLIXON_DBG_BACKEND | CLIXON_DBG_DETAIL, "");
     if (s != ce->ce_s){
@@ -1906,14 +2815,46 @@ from_client(int   s,
     }
     if (ce_client_descr(ce, &cbce) < 0)
         goto done;
-    if (clixon_msg_rcv11(s, cbuf_get(cbce), 0, &cb, &eof) < 0)
-        goto done;
-    if (eof){
-        backend_client_rm(h, ce);
-        netconf_monitoring_counter_inc(h, "dropped-sessions");
+    id = ce->ce_id;
+    slice = clicon_option_bool_id(h, CO_SOCK_PRIO) ? 0 : clicon_option_int_id(h, CO_BACKEND_SLICE);
+    gettimeofday(&t0, NULL);
+    /* Serve messages already read, the socket may not become readable again */
+    while (1) {
+        if (cb){
+            cbuf_free(cb);
+            cb = NULL;
+        }
+        if (clixon_msg_rcv11(s, cbuf_get(cbce), 0, &cb, &eof) < 0)
+            goto done;
+        if (eof){
+            backend_client_rm(h, ce);
+            netconf_monitoring_counter_inc(h, "dropped-sessions");
+            break;
+        }
+        if (from_client_msg(h, ce, cbuf_get(cb)) < 0)
+            goto done;
+        /* Running may have been changed by the request, eg edit-config or copy-config */
+        if (backend_snapshot_publish(h) < 0)
+            goto done;
+        /* Client may have been removed, or suspended by a reader process or output */
+        if ((ce = backend_client_find(h, id)) == NULL ||
+            ce->ce_reader_pid != 0 ||
+            ce->ce_outq_fd != -1 ||
+            ce->ce_async ||
+            !clixon_msg_pending(s))
+            break;
+        /* Time slice is used: serve other clients before the remaining messages */
+        if (slice > 0){
+            gettimeofday(&t, NULL);
+            timersub(&t, &t0, &t);
+            if (t.tv_sec*1000000 + t.tv_usec >= slice){
+                if ((ret = clixon_event_fd_ready(s)) < 0)
+                    goto done;
+                if (ret == 1)
+                    break;
+            }
+        }
     }
-    else if (from_client_msg(h, ce, cbuf_get(cb)) < 0)
-        goto done;
     retval = 0;
   done:
     clixon_debug(CLIXON_DBG_BACKEND | CLIXON_DBG_DETAIL, "retval:%d", retval);
@@ -1924,6 +2865,389 @@ from_client(int   s,
     return retval; /* -1 here terminates backend */
 }
 
+/*! Asynchronous state data of a request is done: make the request again and resume reading
+ *
+ * @param[in]  h     Clixon handle
+ * @param[in]  id    Session id of client
+ * @param[in]  msg   Request message
+ * @retval     0     OK, or client is gone
+ * @retval    -1     Error
+ * @see clixon_plugin_statedata_async_done
+ */
+int
+backend_client_async_resume(clixon_handle h,
+                            uint32_t      id,
+                            char         *msg)
+{
+    client_entry *ce;
+
+    if ((ce = backend_client_find(h, id)) == NULL || ce->ce_async == 0)
+        return 0;
+    if (from_client_msg(h, ce, msg) < 0)
+        return -1;
+    if ((ce = backend_client_find(h, id)) == NULL)
+        return 0;
+    ce->ce_async = 0;
+    /* Else resumed when output queue is written */
+    if (ce->ce_outq_fd == -1 && backend_client_reg(ce) < 0)
+        return -1;
+    /* Output queued while waiting, may suspend reading again */
+    if (backend_client_outq_flush(ce) < 0)
+        return -1;
+    /* Messages read while suspended */
+    if (ce->ce_outq_fd == -1 && clixon_msg_pending(ce->ce_s))
+        return from_client(ce->ce_s, ce);
+    return 0;
+}
+
+/*! Asynchronous rpc is done: send its reply and resume reading
+ *
+ * @param[in]  h      Clixon handle
+ * @param[in]  id     Session id of client
+ * @param[in]  reply  Reply message
+ * @param[in]  len    Length of reply
+ * @param[in]  err    Reply is an rpc-error made by the backend
+ * @retval     0      OK, or client is gone
+ * @retval    -1      Error
+ * @see clixon_plugin_rpc_async_done
+ */
+int
+backend_client_async_reply(clixon_handle h,
+                           uint32_t      id,
+                           const char   *reply,
+                           size_t        len,
+                           int           err)
+{
+    client_entry *ce;
+
+    if ((ce = backend_client_find(h, id)) == NULL || ce->ce_async == 0)
+        return 0;
+    if (err){
+        ce->ce_out_rpc_errors++;
+        netconf_monitoring_counter_inc(h, "out-rpc-errors");
+    }
+    clixon_debug(CLIXON_DBG_MSG | CLIXON_DBG_TRUNC, "Send [%u] %s", id, reply);
+    if (backend_client_send(h, ce, reply, len, 1) < 0)
+        return -1;
+    if ((ce = backend_client_find(h, id)) == NULL)
+        return 0;
+    ce->ce_async = 0;
+    /* Else resumed when output queue is written */
+    if (ce->ce_outq_fd == -1 && backend_client_reg(ce) < 0)
+        return -1;
+    /* Messages read while suspended */
+    if (ce->ce_outq_fd == -1 && clixon_msg_pending(ce->ce_s))
+        return from_client(ce->ce_s, ce);
+    return 0;
+}
+
+/*! Send a session, or the end of the handover, to the backend process
+ *
+ * @param[in]  s    Socket to backend process
+ * @param[in]  ch   Session
+ * @param[in]  str  User name, transport and source host
+ * @param[in]  len  Length of str
+ * @param[in]  fd   Client socket, or -1 at end of handover
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+backend_client_handoff_msg(int                    s,
+                           struct client_handoff *ch,
+                           char                  *str,
+                           size_t                 len,
+                           int                    fd)
+{
+    struct msghdr   msg = {0,};
+    struct iovec    iov[2];
+    struct cmsghdr *cmsg;
+    union {
+        char           buf[CMSG_SPACE(sizeof(int))];
+        struct cmsghdr align;
+    } ctl;
+
+    iov[0].iov_base = ch;
+    iov[0].iov_len = sizeof(*ch);
+    iov[1].iov_base = str;
+    iov[1].iov_len = len;
+    msg.msg_iov = iov;
+    msg.msg_iovlen = 2;
+    if (fd != -1){
+        memset(&ctl, 0, sizeof(ctl));
+        msg.msg_control = ctl.buf;
+        msg.msg_controllen = sizeof(ctl.buf);
+        cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+        memcpy(CMSG_DATA(cmsg), &fd, sizeof(int));
+    }
+    while (sendmsg(s, &msg, 0) < 0){
+        if (errno == EINTR)
+            continue;
+        clixon_err(OE_UNIX, errno, "sendmsg");
+        return -1;
+    }
+    return 0;
+}
+
+/*! Hand over sessions to the backend process when they are idle, then exit
+ *
+ * Called in the process serving clients while plugins start. Requests are no longer read
+ * from idle sessions. Sessions with a pending reply, or with requests already read, are
+ * tried again later. Requests not yet read are read by the backend process.
+ * @param[in]  fd   Not used
+ * @param[in]  arg  Clixon handle
+ * @retval     0    OK
+ * @retval    -1    Error
+ * @see backend_client_handoff_recv
+ */
+static int
+backend_client_handoff(int   fd,
+                       void *arg)
+{
+    int                   retval = -1;
+    clixon_handle         h = (clixon_handle)arg;
+    client_entry         *ce;
+    struct client_handoff ch;
+    char                  str[BACKEND_HANDOFF_STRLEN];
+    char                 *strs[3];
+    size_t                len;
+    size_t                n;
+    struct timeval        t;
+    struct timeval        t1 = {0, 10000};
+    int                   busy = 0;
+    int                   i;
+
+    for (ce = backend_client_list(h); ce; ce = ce->ce_next){
+        if (ce->ce_reply_deferred || ce->ce_async || ce->ce_reader_pid != 0 ||
+            ce->ce_outq_len || clixon_msg_pending(ce->ce_s)){
+            busy++;
+            continue;
+        }
+        /* May already be unregistered */
+        clixon_event_unreg_fd(ce->ce_s, from_client);
+    }
+    if (busy){
+        gettimeofday(&t, NULL);
+        timeradd(&t, &t1, &t);
+        if (clixon_event_reg_timeout(t, backend_client_handoff, h, "session handover") < 0)
+            goto done;
+        goto ok;
+    }
+    for (ce = backend_client_list(h); ce; ce = ce->ce_next){
+        strs[0] = ce->ce_username;
+        strs[1] = ce->ce_transport;
+        strs[2] = ce->ce_source_host;
+        len = 0;
+        for (i=0; i<3; i++){
+            n = strs[i] ? strlen(strs[i]) + 1 : 1;
+            if (len + n > sizeof(str))
+                break;
+            if (strs[i])
+                memcpy(str+len, strs[i], n);
+            else
+                str[len] = '\0';
+            len += n;
+        }
+        if (i < 3){ /* Closed on exit, client must reconnect */
+            clixon_log(h, LOG_WARNING, "%s: Session %u not handed over", __func__, ce->ce_id);
+            continue;
+        }
+        memset(&ch, 0, sizeof(ch));
+        ch.ch_id = ce->ce_id;
+        memcpy(&ch.ch_addr, &ce->ce_addr, sizeof(ch.ch_addr));
+        ch.ch_time = ce->ce_time;
+        ch.ch_in_rpcs = ce->ce_in_rpcs;
+        ch.ch_in_bad_rpcs = ce->ce_in_bad_rpcs;
+        ch.ch_out_rpc_errors = ce->ce_out_rpc_errors;
+        ch.ch_out_notifications = ce->ce_out_notifications;
+        ch.ch_binary = ce->ce_binary;
+        if (backend_client_handoff_msg(_handoff_s, &ch, str, len, ce->ce_s) < 0)
+            goto done;
+    }
+    memset(&ch, 0, sizeof(ch));
+    if (clicon_session_id_get(h, &ch.ch_next_id) < 0)
+        ch.ch_next_id = 0;
+    if (backend_client_handoff_msg(_handoff_s, &ch, NULL, 0, -1) < 0)
+        goto done;
+    clixon_exit_set(1);
+ ok:
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Backend process is done starting plugins: stop accepting clients and hand over sessions
+ *
+ * @param[in]  s    Socket to backend process
+ * @param[in]  arg  Clixon handle
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+backend_client_handoff_cb(int   s,
+                          void *arg)
+{
+    clixon_handle h = (clixon_handle)arg;
+    char          c;
+    ssize_t       n;
+    int           ss;
+
+    clixon_event_unreg_fd(s, backend_client_handoff_cb);
+    while ((n = read(s, &c, 1)) < 0 && errno == EINTR)
+        ;
+    if (n <= 0){ /* Backend process is gone */
+        clixon_exit_set(1);
+        return 0;
+    }
+    /* New clients are accepted by the backend process */
+    if ((ss = clicon_socket_get(h)) != -1)
+        clixon_event_unreg_fd(ss, backend_accept_client);
+    return backend_client_handoff(s, h);
+}
+
+/*! Serve clients in a process while plugins start, and hand over sessions when done
+ *
+ * Call in the forked process before its event loop
+ * @param[in]  h    Clixon handle
+ * @param[in]  s    Socket to backend process, a SOCK_SEQPACKET socket pair
+ * @retval     0    OK
+ * @retval    -1    Error
+ * @see backend_client_handoff_recv  Called in the backend process when plugins are started
+ */
+int
+backend_client_handoff_reg(clixon_handle h,
+                           int           s)
+{
+    _handoff_s = s;
+    return clixon_event_reg_fd(s, backend_client_handoff_cb, h, "session handover");
+}
+
+/*! Take over the sessions of the process serving clients while plugins started
+ *
+ * Signals the process to hand over its sessions, and receives the client sockets and
+ * session state, see backend_client_handoff. The sessions are then served as if they
+ * were accepted by this process.
+ * @param[in]  h    Clixon handle
+ * @param[in]  s    Socket to the forked process
+ * @retval     0    OK
+ * @retval    -1    Error
+ * @see backend_client_handoff_reg
+ */
+int
+backend_client_handoff_recv(clixon_handle h,
+                            int           s)
+{
+    int                   retval = -1;
+    char                  buf[sizeof(struct client_handoff) + BACKEND_HANDOFF_STRLEN];
+    struct client_handoff ch;
+    struct msghdr         msg;
+    struct iovec          iov;
+    struct cmsghdr       *cmsg;
+    union {
+        char           buf[CMSG_SPACE(sizeof(int))];
+        struct cmsghdr align;
+    } ctl;
+    client_entry         *ce;
+    char                 *strs[3];
+    char                 *p;
+    uint32_t              next = 0;
+    uint32_t              id;
+    ssize_t               n;
+    int                   fd = -1;
+    int                   i;
+
+    while (write(s, "", 1) < 0){
+        if (errno == EINTR)
+            continue;
+        if (errno == EPIPE) /* Process is gone */
+            goto ok;
+        clixon_err(OE_UNIX, errno, "write");
+        goto done;
+    }
+    while (1){
+        memset(&msg, 0, sizeof(msg));
+        iov.iov_base = buf;
+        iov.iov_len = sizeof(buf);
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = ctl.buf;
+        msg.msg_controllen = sizeof(ctl.buf);
+        if ((n = recvmsg(s, &msg, 0)) < 0){
+            if (errno == EINTR)
+                continue;
+            clixon_err(OE_UNIX, errno, "recvmsg");
+            goto done;
+        }
+        if (n == 0) /* Process is gone */
+            break;
+        fd = -1;
+        if ((cmsg = CMSG_FIRSTHDR(&msg)) != NULL &&
+            cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS)
+            memcpy(&fd, CMSG_DATA(cmsg), sizeof(int));
+        if (n < (ssize_t)sizeof(ch)){
+            clixon_err(OE_UNIX, EINVAL, "Session handover message too short");
+            goto done;
+        }
+        memcpy(&ch, buf, sizeof(ch));
+        if (fd == -1){ /* End of handover */
+            if (ch.ch_next_id > next)
+                next = ch.ch_next_id;
+            break;
+        }
+        p = buf + sizeof(ch);
+        for (i=0; i<3; i++){
+            if (p >= buf + n || memchr(p, '\0', buf + n - p) == NULL)
+                break;
+            strs[i] = p;
+            p += strlen(p) + 1;
+        }
+        if (i < 3){
+            clixon_err(OE_UNIX, EINVAL, "Session handover message of session %u malformed", ch.ch_id);
+            goto done;
+        }
+        if ((ce = backend_client_add(h, &ch.ch_addr)) == NULL)
+            goto done;
+        ce->ce_s = fd;
+        fd = -1;
+        ce->ce_id = ch.ch_id;
+        ce->ce_time = ch.ch_time;
+        ce->ce_in_rpcs = ch.ch_in_rpcs;
+        ce->ce_in_bad_rpcs = ch.ch_in_bad_rpcs;
+        ce->ce_out_rpc_errors = ch.ch_out_rpc_errors;
+        ce->ce_out_notifications = ch.ch_out_notifications;
+        ce->ce_binary = ch.ch_binary;
+        if (*strs[0] && (ce->ce_username = strdup(strs[0])) == NULL){
+            clixon_err(OE_UNIX, errno, "strdup");
+            goto done;
+        }
+        if (*strs[1] && (ce->ce_transport = strdup(strs[1])) == NULL){
+            clixon_err(OE_UNIX, errno, "strdup");
+            goto done;
+        }
+        if (*strs[2] && (ce->ce_source_host = strdup(strs[2])) == NULL){
+            clixon_err(OE_UNIX, errno, "strdup");
+            goto done;
+        }
+        ce->ce_class = backend_client_class(ce->ce_transport);
+        if (backend_client_reg(ce) < 0)
+            goto done;
+        clixon_debug(CLIXON_DBG_BACKEND, "Session %u handed over", ce->ce_id);
+        if (ch.ch_id >= next)
+            next = ch.ch_id + 1;
+    }
+    /* Session ids of the process are not reused */
+    if (clicon_session_id_get(h, &id) == 0 && id < next)
+        clicon_session_id_set(h, next);
+ ok:
+    retval = 0;
+ done:
+    if (fd != -1)
+        close(fd);
+    return retval;
+}
+
 /*! Init backend rpc: Set up standard netconf rpc callbacks
  *
  * @param[in]  h     Clixon handle
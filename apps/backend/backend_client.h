@@ -40,8 +40,15 @@
 /*
  * Prototypes
  */
+int backend_client_send(clixon_handle h, client_entry *ce, const char *data, size_t len, int last);
 int backend_client_rm(clixon_handle h, client_entry *ce);
+int backend_client_admit(clixon_handle h, client_entry *ce, size_t size, cbuf *cbret);
 int from_client(int fd, void *arg);
+int backend_client_async_resume(clixon_handle h, uint32_t id, char *msg);
+int backend_client_async_reply(clixon_handle h, uint32_t id, const char *reply, size_t len, int err);
+int backend_client_handoff_reg(clixon_handle h, int s);
+int backend_client_handoff_recv(clixon_handle h, int s);
 int backend_rpc_init(clixon_handle h);
+void ce_event_exit(void);
 
 #endif  /* _BACKEND_CLIENT_H_ */
@@ -99,21 +99,23 @@ clixon_stats_datastore_get(clixon_handle  h,
     clixon_debug(CLIXON_DBG_BACKEND | CLIXON_DBG_DETAIL, "%s", dbname);
     /* This is the db cache */
     if ((de = xmldb_find(h, dbname)) != NULL &&
-        (xt = xmldb_cache_get(de)) == NULL){
+        (xt = xmldb_cache_read(de)) == NULL){
         /* Trigger cache if no exist (trick to ensure cache is present) */
         if ((ret = xmldb_get0(h, dbname, YB_MODULE, NULL, "/", 1, 0, &xn, NULL, NULL)) < 0)
             //goto done;
             goto ok;
         if (ret == 0)
             goto ok;
-        xt = xmldb_cache_get(de);
+        xt = xmldb_cache_read(de);
     }
     if (xt != NULL){
-        if (xml_stats(xt, xml_type, &nr, &sz) < 0)
+        /* A shared cache is counted in the datastore owning it */
+        if (!xmldb_cache_shared(de) &&
+            xml_stats(xt, xml_type, &nr, &sz) < 0)
             goto done;
         cprintf(cb, "<datastore><name>%s</name><nr>%" PRIu64 "</nr>"
-                "<size>%zu</size></datastore>",
-                dbname, nr, sz);
+                "<size>%zu</size><generation>%" PRIu64 "</generation></datastore>",
+                dbname, nr, sz, xmldb_generation_get(de));
     }
  ok:
     retval = 0;
@@ -242,6 +244,9 @@ from_client_stats(clixon_handle h,
     int        inext;
     int        inext2;
     int        inext3;
+    int        entries;
+    int        hits;
+    int        misses;
     xml_stats_enum xml_type = XML_STATS_ALL;
 
     if ((str = xml_find_body(xe, "modules")) != NULL)
@@ -294,6 +299,18 @@ from_client_stats(clixon_handle h,
         }
     }
     cprintf(cbret, "</module-sets>");
+    cprintf(cbret, "<caches xmlns=\"%s\">", CLIXON_LIB_NS);
+    entries = hits = misses = 0;
+    if (xpath_parse_cache_stats(&entries, &hits, &misses) < 0)
+        goto done;
+    cprintf(cbret, "<cache><name>xpath-parse</name><entries>%d</entries><hits>%d</hits><misses>%d</misses></cache>",
+            entries, hits, misses);
+    entries = hits = misses = 0;
+    if (api_path_cache_stats(&entries, &hits, &misses) < 0)
+        goto done;
+    cprintf(cbret, "<cache><name>api-path</name><entries>%d</entries><hits>%d</hits><misses>%d</misses></cache>",
+            entries, hits, misses);
+    cprintf(cbret, "</caches>");
     cprintf(cbret, "</rpc-reply>");
     retval = 0;
  done:
@@ -1037,6 +1054,716 @@ from_client_translate_format(clixon_handle h,
     return retval;
 }
 
+/*! Count nodes selected by an XPath in a datastore, or check if any exists
+ *
+ * The XPath is evaluated on the datastore cache, without copying or printing data.
+ * If the result is modified, ie NACM, system-only-config or NACM disabled on empty config,
+ * the count is made on a copy of the selected data instead.
+ * @param[in]  h       Clixon handle
+ * @param[in]  xe      Request: <rpc><xn></rpc>
+ * @param[out] cbret   Return xml tree, eg <rpc-reply>..., <rpc-error..
+ * @param[in]  arg     client-entry
+ * @param[in]  regarg  User argument given at rpc_callback_register()
+ * @retval     0       OK
+ * @retval    -1       Error
+ */
+static int
+from_client_count(clixon_handle h,
+                  cxobj        *xe,
+                  cbuf         *cbret,
+                  void         *arg,
+                  void         *regarg)
+{
+    int        retval = -1;
+    yang_stmt *yspec;
+    char      *db;
+    char      *xpath0;
+    char      *xpath = NULL;
+    char      *str;
+    cvec      *nsc0 = NULL;
+    cvec      *nsc = NULL;
+    cbuf      *cbreason = NULL;
+    cxobj     *xt = NULL;
+    cxobj     *xcopy = NULL;
+    cxobj     *xerr = NULL;
+    cxobj     *xnacm;
+    char      *username;
+    int        exists = 0;
+    uint32_t   count = 0;
+    int        ret;
+
+    if ((yspec = clicon_dbspec_yang(h)) == NULL){
+        clixon_err(OE_YANG, ENOENT, "No yang spec");
+        goto done;
+    }
+    if ((db = xml_find_body(xe, "datastore")) == NULL)
+        db = "running";
+    if ((xpath0 = xml_find_body(xe, "xpath")) == NULL){
+        if (netconf_missing_element(cbret, "protocol", "xpath", NULL) < 0)
+            goto done;
+        goto ok;
+    }
+    if ((str = xml_find_body(xe, "exists")) != NULL)
+        exists = strcmp(str, "true") == 0;
+    if (xml_find(xe, "namespace-context") != NULL){
+        if (xml_nsctx_parse(xe, &nsc0) < 0)
+            goto done;
+    }
+    if (nsc0 == NULL && (nsc0 = cvec_new(0)) == NULL){
+        clixon_err(OE_UNIX, errno, "cvec_new");
+        goto done;
+    }
+    if ((ret = xpath2canonical(xpath0, nsc0, yspec, &xpath, &nsc, &cbreason)) < 0)
+        goto done;
+    if (ret == 0){
+        if (netconf_invalid_value(cbret, "application", cbuf_get(cbreason)) < 0)
+            goto done;
+        goto ok;
+    }
+    xnacm = clicon_nacm_cache(h);
+    if (xnacm == NULL &&
+        !clicon_option_bool(h, "CLICON_XMLDB_SYSTEM_ONLY_CONFIG") &&
+        !clicon_option_bool(h, "CLICON_NACM_DISABLED_ON_EMPTY")){
+        /* Read-only, evaluate on the datastore cache directly */
+        if ((ret = xmldb_get_cache(h, db, &xt, &xerr)) < 0)
+            goto done;
+    }
+    else {
+        if ((ret = xmldb_get0(h, db, YB_MODULE, nsc, xpath, 1, WITHDEFAULTS_REPORT_ALL, &xcopy, NULL, &xerr)) < 0)
+            goto done;
+        if (ret == 1 && xnacm != NULL){
+            username = clicon_username_get(h);
+            if (nacm_datanode_read1(h, xcopy, username, xnacm) < 0)
+                goto done;
+            if (nacm_datanode_read_prune(h, xcopy) < 0)
+                goto done;
+        }
+        xt = xcopy;
+    }
+    if (ret == 0){
+        if (clixon_xml2cbuf1(cbret, xerr, 0, 0, NULL, -1, 0, 0, WITHDEFAULTS_REPORT_ALL) < 0)
+            goto done;
+        goto ok;
+    }
+    if (exists)
+        count = xpath_first(xt, nsc, "%s", xpath) != NULL;
+    else if (xpath_count(xt, nsc, xpath, &count) < 0)
+        goto done;
+    cprintf(cbret, "<rpc-reply xmlns=\"%s\"><count xmlns=\"%s\">%" PRIu32 "</count></rpc-reply>",
+            NETCONF_BASE_NAMESPACE, CLIXON_LIB_NS, count);
+ ok:
+    retval = 0;
+ done:
+    if (xpath)
+        free(xpath);
+    if (nsc0)
+        cvec_free(nsc0);
+    if (nsc)
+        cvec_free(nsc);
+    if (cbreason)
+        cbuf_free(cbreason);
+    if (xcopy)
+        xml_free(xcopy);
+    if (xerr)
+        xml_free(xerr);
+    return retval;
+}
+
+/*! State of a list-keys request
+ */
+struct list_keys {
+    char          *lk_prefix; /* Key prefix, or NULL */
+    size_t         lk_plen;   /* Length of prefix */
+    uint32_t       lk_max;    /* Max number of keys, 0 is unlimited */
+    uint32_t       lk_nr;     /* Number of keys in reply */
+    int            lk_more;   /* Max reached and there are more keys */
+    clicon_hash_t *lk_seen;   /* Keys in reply if from several parents, or NULL */
+    cbuf          *lk_cb;     /* Reply */
+};
+
+/*! Append a key to the list-keys reply unless a duplicate or max is reached
+ *
+ * @param[in]  lk    List-keys state
+ * @param[in]  body  Key value, prefix already checked
+ * @retval     1     OK, continue
+ * @retval     0     Max reached, stop
+ * @retval    -1     Error
+ */
+static int
+list_keys_add(struct list_keys *lk,
+              char             *body)
+{
+    if (lk->lk_seen != NULL){
+        if (clicon_hash_lookup(lk->lk_seen, body) != NULL)
+            return 1;
+        if (clicon_hash_add(lk->lk_seen, body, NULL, 0) == NULL)
+            return -1;
+    }
+    if (lk->lk_max && lk->lk_nr >= lk->lk_max){
+        lk->lk_more = 1;
+        return 0;
+    }
+    cprintf(lk->lk_cb, "<%s:key>", CLIXON_LIB_PREFIX);
+    if (xml_chardata_cbuf_append(lk->lk_cb, 0, body) < 0)
+        return -1;
+    cprintf(lk->lk_cb, "</%s:key>", CLIXON_LIB_PREFIX);
+    lk->lk_nr++;
+    return 1;
+}
+
+/*! Check if a child is ordered before the first entry of a list or leaf-list with a key prefix
+ *
+ * @param[in]  xc      Child
+ * @param[in]  yi      YANG order of list or leaf-list
+ * @param[in]  keyname Name of first key of list, NULL for leaf-list
+ * @param[in]  prefix  Key prefix, or NULL for first entry
+ * @retval     1       Before
+ * @retval     0       Not before
+ * @see xml_cmp  Must be consistent with
+ */
+static int
+list_keys_before(cxobj *xc,
+                 int    yi,
+                 char  *keyname,
+                 char  *prefix)
+{
+    yang_stmt *yc;
+    int        yci;
+    char      *body;
+
+    if (xml_type(xc) != CX_ELMNT || (yc = xml_spec(xc)) == NULL)
+        return 1;
+    if ((yci = yang_order(yc)) != yi)
+        return yci < yi;
+    if (prefix == NULL)
+        return 0;
+    body = keyname ? xml_find_body(xc, keyname) : xml_body(xc);
+    return body == NULL || strcmp(body, prefix) < 0;
+}
+
+/*! Add keys of the entries of a list or leaf-list under a parent to the list-keys reply
+ *
+ * Children are sorted by YANG order and then by key, so the first entry is found by binary
+ * search. If the list is sorted by a string key, also the first entry with the prefix is found
+ * by binary search and the scan stops at the first key without the prefix.
+ * Otherwise all entries are scanned for the prefix.
+ * @param[in]  lk    List-keys state
+ * @param[in]  xp    Parent XML node
+ * @param[in]  y     YANG of list or leaf-list
+ * @retval     1     OK, continue
+ * @retval     0     Max reached, stop
+ * @retval    -1     Error
+ */
+static int
+list_keys_parent(struct list_keys *lk,
+                 cxobj            *xp,
+                 yang_stmt        *y)
+{
+    yang_stmt *yk;
+    cg_var    *cv;
+    char      *keyname = NULL;
+    char      *body;
+    cxobj     *xc;
+    int        yi;
+    int        strsorted = 0;
+    int        low;
+    int        upper;
+    int        mid;
+    int        i;
+    int        ret;
+
+    if ((yi = yang_order(y)) < -1)
+        return -1;
+    if (yang_keyword_get(y) == Y_LIST){
+        if ((cv = cvec_i(yang_cvec_get(y), 0)) == NULL)
+            return 1; /* State list without key */
+        keyname = cv_string_get(cv);
+        yk = yang_find(y, Y_LEAF, keyname);
+    }
+    else
+        yk = y;
+    if (lk->lk_prefix != NULL &&
+#ifndef STATE_ORDERED_BY_SYSTEM
+        yang_config(y) != 0 &&
+#endif
+        yang_find(y, Y_ORDERED_BY, "user") == NULL &&
+        yk != NULL &&
+        (cv = yang_cv_get(yk)) != NULL &&
+        cv_type_get(cv) == CGV_STRING)
+        strsorted = 1;
+    low = 0;
+    upper = xml_child_nr(xp);
+    while (low < upper){
+        mid = (low + upper) / 2;
+        if (list_keys_before(xml_child_i(xp, mid), yi, keyname, strsorted?lk->lk_prefix:NULL))
+            low = mid + 1;
+        else
+            upper = mid;
+    }
+    for (i = low; i < xml_child_nr(xp); i++){
+        xc = xml_child_i(xp, i);
+        if (xml_spec(xc) != y)
+            break;
+        body = keyname ? xml_find_body(xc, keyname) : xml_body(xc);
+        if (body == NULL)
+            continue;
+        if (lk->lk_prefix != NULL && strncmp(body, lk->lk_prefix, lk->lk_plen) != 0){
+            if (strsorted)
+                break;
+            continue;
+        }
+        if ((ret = list_keys_add(lk, body)) <= 0)
+            return ret;
+    }
+    return 1;
+}
+
+/*! Find the start of the last step of an XPath location path, skipping predicates and literals
+ *
+ * @param[in]  xpath  XPath
+ * @retval     step   Pointer to the last '/' outside predicates
+ * @retval     NULL   No such '/', or not a single location path
+ */
+static char *
+list_keys_last_step(char *xpath)
+{
+    char *p;
+    char *step = NULL;
+    char  quote = 0;
+    int   depth = 0;
+
+    for (p = xpath; *p != '\0'; p++){
+        if (quote){
+            if (*p == quote)
+                quote = 0;
+        }
+        else if (*p == '\'' || *p == '"')
+            quote = *p;
+        else if (*p == '[')
+            depth++;
+        else if (*p == ']')
+            depth--;
+        else if (depth > 0)
+            ;
+        else if (*p == '/')
+            step = p;
+        else if (*p == '|' || *p == '(' || *p == ' ')
+            return NULL; /* Not a location path */
+    }
+    return step;
+}
+
+/*! Check if an XPath step is a plain node name with optional prefix
+ */
+static int
+list_keys_plain_step(char *step)
+{
+    return *step != '\0' &&
+        strspn(step, "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789_.-:") == strlen(step) &&
+        strcmp(step, ".") != 0 && strcmp(step, "..") != 0;
+}
+
+/*! Find YANG data node of an XPath step under a parent XML node
+ *
+ * @param[in]  xp    Parent, or top of datastore
+ * @param[in]  step  Plain XPath step: <prefix>:<name>
+ * @param[in]  nsc   Namespace context of XPath
+ * @param[in]  yspec Top-level YANG spec
+ * @retval     y     YANG data node
+ * @retval     NULL  Not found
+ */
+static yang_stmt *
+list_keys_yang(cxobj     *xp,
+               char      *step,
+               cvec      *nsc,
+               yang_stmt *yspec)
+{
+    yang_stmt *yp;
+    yang_stmt *ymod;
+    char      *prefix = NULL;
+    char      *name = NULL;
+    char      *ns;
+    yang_stmt *y = NULL;
+
+    if (nodeid_split(step, &prefix, &name) < 0)
+        goto done;
+    ns = xml_nsctx_get(nsc, prefix);
+    if ((yp = xml_spec(xp)) != NULL)
+        y = yang_find_datanode_ns(yp, name, ns);
+    else if (ns != NULL &&
+             (ymod = yang_find_module_by_namespace(yspec, ns)) != NULL)
+        y = yang_find_datanode(ymod, name);
+ done:
+    if (prefix)
+        free(prefix);
+    if (name)
+        free(name);
+    return y;
+}
+
+/*! Add keys of entries of lists or leaf-lists selected by an XPath to the list-keys reply
+ *
+ * The XPath selects the first key leaf of a list or a leaf-list. If the last steps are plain
+ * node names, the entries are found by binary search among the children of each parent.
+ * Otherwise the XPath is evaluated and the selected nodes are scanned.
+ * @param[in]  lk    List-keys state
+ * @param[in]  xt    Top of datastore
+ * @param[in]  nsc   Namespace context of XPath
+ * @param[in]  xpath Canonical XPath
+ * @param[in]  yspec Top-level YANG spec
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+static int
+list_keys_xpath(struct list_keys *lk,
+                cxobj            *xt,
+                cvec             *nsc,
+                char             *xpath,
+                yang_stmt        *yspec)
+{
+    int        retval = -1;
+    char      *xpath1 = NULL;
+    char      *keystep;
+    char      *liststep = NULL;
+    char      *p;
+    cxobj    **xvec = NULL;
+    size_t     xlen = 0;
+    cxobj     *xp;
+    yang_stmt *y = NULL;
+    char      *body;
+    int        i;
+    int        ret;
+
+    if ((xpath1 = strdup(xpath)) == NULL){
+        clixon_err(OE_UNIX, errno, "strdup");
+        goto done;
+    }
+    /* Split xpath1 into <parents>/<list>/<key> or <parents>/<leaf-list> */
+    if ((p = list_keys_last_step(xpath1)) == NULL || p == xpath1 || p[-1] == '/' ||
+        !list_keys_plain_step(p+1))
+        goto scan;
+    *p = '\0';
+    keystep = p+1;
+    if ((p = list_keys_last_step(xpath1)) != NULL && (p == xpath1 || p[-1] != '/') &&
+        list_keys_plain_step(p+1)){
+        *p = '\0';
+        liststep = p+1;
+        if (*xpath1 == '\0')
+            xp = xt;
+        else{
+            if (xpath_vec(xt, nsc, "%s", &xvec, &xlen, xpath1) < 0)
+                goto done;
+            xp = xlen ? xvec[0] : NULL;
+        }
+        if (xp != NULL &&
+            (y = list_keys_yang(xp, liststep, nsc, yspec)) != NULL &&
+            yang_keyword_get(y) == Y_LIST &&
+            cvec_len(yang_cvec_get(y)) > 0 &&
+            strcmp(cv_string_get(cvec_i(yang_cvec_get(y), 0)),
+                   strchr(keystep, ':') ? strchr(keystep, ':')+1 : keystep) == 0)
+            goto parents;
+        liststep[-1] = '/';
+        if (xvec){
+            free(xvec);
+            xvec = NULL;
+        }
+        xlen = 0;
+    }
+    /* <parents>/<leaf-list> */
+    if (*xpath1 == '\0')
+        xp = xt;
+    else{
+        if (xpath_vec(xt, nsc, "%s", &xvec, &xlen, xpath1) < 0)
+            goto done;
+        xp = xlen ? xvec[0] : NULL;
+    }
+    if (xp == NULL)
+        goto ok; /* No parents */
+    if ((y = list_keys_yang(xp, keystep, nsc, yspec)) == NULL ||
+        yang_keyword_get(y) != Y_LEAF_LIST){
+        keystep[-1] = '/';
+        goto scan;
+    }
+ parents:
+    if (xvec == NULL){
+        if ((ret = list_keys_parent(lk, xt, y)) < 0)
+            goto done;
+        goto ok;
+    }
+    if (xlen > 1 && (lk->lk_seen = clicon_hash_init()) == NULL)
+        goto done;
+    for (i = 0; i < xlen; i++){
+        if ((ret = list_keys_parent(lk, xvec[i], y)) < 0)
+            goto done;
+        if (ret == 0)
+            break;
+    }
+    goto ok;
+ scan:
+    if (xpath_vec(xt, nsc, "%s", &xvec, &xlen, xpath) < 0)
+        goto done;
+    if ((lk->lk_seen = clicon_hash_init()) == NULL)
+        goto done;
+    for (i = 0; i < xlen; i++){
+        if ((body = xml_body(xvec[i])) == NULL)
+            continue;
+        if (lk->lk_prefix != NULL && strncmp(body, lk->lk_prefix, lk->lk_plen) != 0)
+            continue;
+        if ((ret = list_keys_add(lk, body)) < 0)
+            goto done;
+        if (ret == 0)
+            break;
+    }
+ ok:
+    retval = 0;
+ done:
+    if (xvec)
+        free(xvec);
+    if (xpath1)
+        free(xpath1);
+    return retval;
+}
+
+/*! Get the keys of list entries or leaf-list values, optionally with a prefix and max number
+ *
+ * Only the keys are sent, not the list entries. Keys of lists sorted by system are found by
+ * binary search on the datastore cache.
+ * @param[in]  h       Clixon handle
+ * @param[in]  xe      Request: <rpc><xn></rpc>
+ * @param[out] cbret   Return xml tree, eg <rpc-reply>..., <rpc-error..
+ * @param[in]  arg     client-entry
+ * @param[in]  regarg  User argument given at rpc_callback_register()
+ * @retval     0       OK
+ * @retval    -1       Error
+ * @see from_client_count
+ */
+static int
+from_client_list_keys(clixon_handle h,
+                      cxobj        *xe,
+                      cbuf         *cbret,
+                      void         *arg,
+                      void         *regarg)
+{
+    int              retval = -1;
+    yang_stmt       *yspec;
+    char            *db;
+    char            *xpath0;
+    char            *xpath = NULL;
+    char            *str;
+    cvec            *nsc0 = NULL;
+    cvec            *nsc = NULL;
+    cbuf            *cbreason = NULL;
+    cxobj           *xt = NULL;
+    cxobj           *xcopy = NULL;
+    cxobj           *xerr = NULL;
+    cxobj           *xnacm;
+    char            *username;
+    struct list_keys lk = {0,};
+    int              ret;
+
+    if ((yspec = clicon_dbspec_yang(h)) == NULL){
+        clixon_err(OE_YANG, ENOENT, "No yang spec");
+        goto done;
+    }
+    if ((db = xml_find_body(xe, "datastore")) == NULL)
+        db = "running";
+    if ((xpath0 = xml_find_body(xe, "xpath")) == NULL){
+        if (netconf_missing_element(cbret, "protocol", "xpath", NULL) < 0)
+            goto done;
+        goto ok;
+    }
+    if ((lk.lk_prefix = xml_find_body(xe, "prefix")) != NULL)
+        lk.lk_plen = strlen(lk.lk_prefix);
+    if ((str = xml_find_body(xe, "max")) != NULL){
+        if ((ret = netconf_parse_uint32("max", str, NULL, 0, cbret, &lk.lk_max)) < 0)
+            goto done;
+        if (ret == 0)
+            goto ok;
+    }
+    if (xml_find(xe, "namespace-context") != NULL){
+        if (xml_nsctx_parse(xe, &nsc0) < 0)
+            goto done;
+    }
+    if (nsc0 == NULL && (nsc0 = cvec_new(0)) == NULL){
+        clixon_err(OE_UNIX, errno, "cvec_new");
+        goto done;
+    }
+    if ((ret = xpath2canonical(xpath0, nsc0, yspec, &xpath, &nsc, &cbreason)) < 0)
+        goto done;
+    if (ret == 0){
+        if (netconf_invalid_value(cbret, "application", cbuf_get(cbreason)) < 0)
+            goto done;
+        goto ok;
+    }
+    xnacm = clicon_nacm_cache(h);
+    if (xnacm == NULL &&
+        !clicon_option_bool(h, "CLICON_XMLDB_SYSTEM_ONLY_CONFIG") &&
+        !clicon_option_bool(h, "CLICON_NACM_DISABLED_ON_EMPTY")){
+        /* Read-only, evaluate on the datastore cache directly */
+        if ((ret = xmldb_get_cache(h, db, &xt, &xerr)) < 0)
+            goto done;
+    }
+    else {
+        if ((ret = xmldb_get0(h, db, YB_MODULE, nsc, xpath, 1, WITHDEFAULTS_REPORT_ALL, &xcopy, NULL, &xerr)) < 0)
+            goto done;
+        if (ret == 1 && xnacm != NULL){
+            username = clicon_username_get(h);
+            if (nacm_datanode_read1(h, xcopy, username, xnacm) < 0)
+                goto done;
+            if (nacm_datanode_read_prune(h, xcopy) < 0)
+                goto done;
+        }
+        xt = xcopy;
+    }
+    if (ret == 0){
+        if (clixon_xml2cbuf1(cbret, xerr, 0, 0, NULL, -1, 0, 0, WITHDEFAULTS_REPORT_ALL) < 0)
+            goto done;
+        goto ok;
+    }
+    if ((lk.lk_cb = cbuf_new()) == NULL){
+        clixon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    if (list_keys_xpath(&lk, xt, nsc, xpath, yspec) < 0)
+        goto done;
+    /* Keys use a prefix to keep the reply small */
+    cprintf(cbret, "<rpc-reply xmlns=\"%s\" xmlns:%s=\"%s\">%s",
+            NETCONF_BASE_NAMESPACE, CLIXON_LIB_PREFIX, CLIXON_LIB_NS, cbuf_get(lk.lk_cb));
+    if (lk.lk_more)
+        cprintf(cbret, "<%s:more>true</%s:more>", CLIXON_LIB_PREFIX, CLIXON_LIB_PREFIX);
+    cprintf(cbret, "</rpc-reply>");
+ ok:
+    retval = 0;
+ done:
+    if (lk.lk_cb)
+        cbuf_free(lk.lk_cb);
+    if (lk.lk_seen)
+        clicon_hash_free(lk.lk_seen);
+    if (xpath)
+        free(xpath);
+    if (nsc0)
+        cvec_free(nsc0);
+    if (nsc)
+        cvec_free(nsc);
+    if (cbreason)
+        cbuf_free(cbreason);
+    if (xcopy)
+        xml_free(xcopy);
+    if (xerr)
+        xml_free(xerr);
+    return retval;
+}
+
+/*! Get generation of a datastore and the time it was set
+ *
+ * Cheap, no data is read or copied. If the datastore is not cached, it is read
+ * from file first.
+ * @param[in]  h       Clixon handle
+ * @param[in]  xe      Request: <rpc><xn></rpc>
+ * @param[out] cbret   Return xml tree, eg <rpc-reply>..., <rpc-error..
+ * @param[in]  arg     client-entry
+ * @param[in]  regarg  User argument given at rpc_callback_register()
+ * @retval     0       OK
+ * @retval    -1       Error
+ * @see xmldb_generation_get
+ */
+static int
+from_client_generation(clixon_handle h,
+                       cxobj        *xe,
+                       cbuf         *cbret,
+                       void         *arg,
+                       void         *regarg)
+{
+    int            retval = -1;
+    char          *db;
+    db_elmnt      *de;
+    cxobj         *xt = NULL;
+    cxobj         *xerr = NULL;
+    struct timeval tv;
+    char           timestr[28];
+    int            ret;
+
+    if ((db = xml_find_body(xe, "datastore")) == NULL)
+        db = "running";
+    /* Ensure cache is present, the generation is set when it is read */
+    if ((ret = xmldb_get_cache(h, db, &xt, &xerr)) < 0)
+        goto done;
+    if (ret == 0){
+        if (clixon_xml2cbuf1(cbret, xerr, 0, 0, NULL, -1, 0, 0, WITHDEFAULTS_REPORT_ALL) < 0)
+            goto done;
+        goto ok;
+    }
+    if ((de = xmldb_find(h, db)) == NULL){
+        clixon_err(OE_DB, ENOENT, "Datastore %s not found", db);
+        goto done;
+    }
+    if (xmldb_generation_time(de, &tv) < 0)
+        goto done;
+    if (time2str(&tv, timestr, sizeof(timestr)) < 0){
+        clixon_err(OE_UNIX, errno, "time2str");
+        goto done;
+    }
+    cprintf(cbret, "<rpc-reply xmlns=\"%s\">", NETCONF_BASE_NAMESPACE);
+    cprintf(cbret, "<generation xmlns=\"%s\">%" PRIu64 "</generation>",
+            CLIXON_LIB_NS, xmldb_generation_get(de));
+    cprintf(cbret, "<last-modified xmlns=\"%s\">%s</last-modified>",
+            CLIXON_LIB_NS, timestr);
+    cprintf(cbret, "</rpc-reply>");
+ ok:
+    retval = 0;
+ done:
+    if (xerr)
+        xml_free(xerr);
+    return retval;
+}
+
+/*! Export trace buffers of backend, and optionally clear them
+ *
+ * @param[in]  h       Clixon handle
+ * @param[in]  xe      Request: <rpc><xn></rpc>
+ * @param[out] cbret   Return xml tree, eg <rpc-reply>..., <rpc-error..
+ * @param[in]  arg     client-entry
+ * @param[in]  regarg  User argument given at rpc_callback_register()
+ * @retval     0       OK
+ * @retval    -1       Error
+ * @see CLICON_TRACE
+ */
+static int
+from_client_trace(clixon_handle h,
+                  cxobj        *xe,
+                  cbuf         *cbret,
+                  void         *arg,
+                  void         *regarg)
+{
+    int    retval = -1;
+    cbuf  *cb = NULL;
+    char  *format;
+    char  *str;
+
+    if ((format = xml_find_body(xe, "format")) == NULL)
+        format = "chrome";
+    if ((cb = cbuf_new()) == NULL){
+        clixon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    if (clixon_trace_print(cb, format) < 0)
+        goto done;
+    if ((str = xml_find_body(xe, "clear")) != NULL && strcmp(str, "true") == 0)
+        clixon_trace_clear();
+    cprintf(cbret, "<rpc-reply xmlns=\"%s\">", NETCONF_BASE_NAMESPACE);
+    cprintf(cbret, "<data xmlns=\"%s\">", CLIXON_LIB_NS);
+    cprintf(cbret, "<![CDATA[");
+    cbuf_append_str(cbret, cbuf_get(cb));
+    cprintf(cbret, "]]>");
+    cprintf(cbret, "</data>");
+    cprintf(cbret, "</rpc-reply>");
+    retval = 0;
+ done:
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+}
+
 /*! Init clixon lib rpc:s
  *
  * @param[in]  h     Clixon handle
@@ -1069,6 +1796,18 @@ backend_clixon_lib_init(clixon_handle h)
     if (rpc_callback_register(h, from_client_translate_format, NULL,
                               CLIXON_LIB_NS, "translate-format") < 0)
         goto done;
+    if (rpc_callback_register(h, from_client_count, NULL,
+                              CLIXON_LIB_NS, "count") < 0)
+        goto done;
+    if (rpc_callback_register(h, from_client_generation, NULL,
+                              CLIXON_LIB_NS, "generation") < 0)
+        goto done;
+    if (rpc_callback_register(h, from_client_list_keys, NULL,
+                              CLIXON_LIB_NS, "list-keys") < 0)
+        goto done;
+    if (rpc_callback_register(h, from_client_trace, NULL,
+                              CLIXON_LIB_NS, "trace") < 0)
+        goto done;
 
     retval = 0;
  done:
@@ -42,6 +42,7 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <inttypes.h>
 #include <unistd.h>
 #include <stdarg.h>
 #include <errno.h>
@@ -73,6 +74,9 @@
 #include "backend_state.h"
 #include "backend_get.h"
 #include "backend_client.h"
+#include "backend_profile.h"
+#include "backend_partial_lock.h"
+#include "backend_snapshot.h"
 
 /*! Key values are checked for validity independent of user-defined callbacks
  *
@@ -102,7 +106,9 @@ generic_validate(clixon_handle       h,
     int        i;
     cbuf      *cb = NULL;
     int        ret;
+    struct trans_timer tt;
 
+    transaction_profile_start(&tt, 0);
     /* All entries */
     if ((ret = xml_yang_validate_all_state(h, td->td_target, 0, xret)) < 0)
         goto done;
@@ -128,6 +134,7 @@ generic_validate(clixon_handle       h,
     // ok:
     retval = 1;
  done:
+    transaction_profile_stop(&tt, "yang_validate", NULL);
     if (cb)
         cbuf_free(cb);
     return retval;
@@ -140,31 +147,51 @@ generic_validate(clixon_handle       h,
  *
  * @param[in]  h       Clixon handle
  * @param[in]  td      Transaction data
+ * @param[in]  xlog    Edited subtrees of target, or NULL if not known, see xmldb_editlog_get
  * @retval     0   OK
  * @retval    -1   Error
  */
 static int
 compute_diffs(clixon_handle       h,
-              transaction_data_t *td)
+              transaction_data_t *td,
+              cxobj              *xlog)
 {
     int    retval = -1;
     int    i;
     cxobj *xn;
+    struct trans_timer tt;
 
-    /* Clear flags xpath for get */
-    xml_apply0(td->td_src, CX_ELMNT, (xml_applyfn_t*)xml_flag_reset,
-               (void*)(XML_FLAG_MARK|XML_FLAG_CHANGE));
-    /* 3. Compute differences */
-    if (xml_diff(td->td_src,
-                 td->td_target,
-                 &td->td_dvec,      /* removed: only in running */
-                 &td->td_dlen,
-                 &td->td_avec,      /* added: only in candidate */
-                 &td->td_alen,
-                 &td->td_scvec,     /* changed: original values */
-                 &td->td_tcvec,     /* changed: wanted values */
-                 &td->td_clen) < 0)
-        goto done;
+    transaction_profile_start(&tt, 0);
+    if (xlog != NULL){
+        /* 3. Compute differences in edited subtrees, src and target are fresh copies */
+        if (xml_diff_select(td->td_src,
+                            td->td_target,
+                            xlog,
+                            &td->td_dvec,
+                            &td->td_dlen,
+                            &td->td_avec,
+                            &td->td_alen,
+                            &td->td_scvec,
+                            &td->td_tcvec,
+                            &td->td_clen) < 0)
+            goto done;
+    }
+    else {
+        /* Clear flags xpath for get */
+        if (xml_flag_reset_tree(td->td_src, XML_FLAG_MARK|XML_FLAG_CHANGE) < 0)
+            goto done;
+        /* 3. Compute differences */
+        if (xml_diff(td->td_src,
+                     td->td_target,
+                     &td->td_dvec,      /* removed: only in running */
+                     &td->td_dlen,
+                     &td->td_avec,      /* added: only in candidate */
+                     &td->td_alen,
+                     &td->td_scvec,     /* changed: original values */
+                     &td->td_tcvec,     /* changed: wanted values */
+                     &td->td_clen) < 0)
+            goto done;
+    }
     if (clixon_debug_get() & CLIXON_DBG_DETAIL)
         transaction_dbg(h, CLIXON_DBG_DETAIL, td, __func__);
     /* Mark as changed in tree */
@@ -190,6 +217,77 @@ compute_diffs(clixon_handle       h,
     }
     retval = 0;
  done:
+    transaction_profile_stop(&tt, "diff", NULL);
+    return retval;
+}
+
+/*! Find the node in the target tree corresponding to a node in the source tree
+ *
+ * @param[in]  xs   Node in source tree
+ * @param[in]  xt   Top of target tree
+ * @param[out] xtp  Corresponding target node, or NULL if none
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+validate_incr_target(cxobj  *xs,
+                     cxobj  *xt,
+                     cxobj **xtp)
+{
+    cxobj *xp;
+
+    *xtp = NULL;
+    if (xml_parent(xs) == NULL){
+        *xtp = xt;
+        return 0;
+    }
+    if (validate_incr_target(xml_parent(xs), xt, &xp) < 0)
+        return -1;
+    if (xp == NULL)
+        return 0;
+    return match_base_child(xp, xs, xml_spec(xs), xtp);
+}
+
+/*! Register changes of a transaction for incremental validation
+ *
+ * Parents of deleted nodes are marked as changed also in the target tree, for
+ * mandatory, unique and min/max-elements checks of only changed nodes.
+ * @param[in]  td  Transaction data with computed diffs
+ * @retval     0   OK
+ * @retval    -1   Error
+ * @see xml_yang_validate_incr_add
+ */
+static int
+validate_incr_init(transaction_data_t *td)
+{
+    int    retval = -1;
+    int    i;
+    cxobj *xn;
+
+    for (i=0; i<td->td_dlen; i++){
+        if (xml_yang_validate_incr_add(td->td_dvec[i]) < 0)
+            goto done;
+        /* Mark parent of deleted node also in target, it has lost a child */
+        if (validate_incr_target(xml_parent(td->td_dvec[i]), td->td_target, &xn) < 0)
+            goto done;
+        if (xn != NULL){
+            xml_flag_set(xn, XML_FLAG_CHANGE);
+            xml_apply_ancestor(xn, (xml_applyfn_t*)xml_flag_set, (void*)XML_FLAG_CHANGE);
+        }
+    }
+    for (i=0; i<td->td_alen; i++)
+        if (xml_yang_validate_incr_add(td->td_avec[i]) < 0)
+            goto done;
+    for (i=0; i<td->td_clen; i++){
+        if (xml_yang_validate_incr_add(td->td_scvec[i]) < 0)
+            goto done;
+        if (xml_yang_validate_incr_add(td->td_tcvec[i]) < 0)
+            goto done;
+    }
+    retval = 0;
+ done:
+    if (retval < 0)
+        xml_yang_validate_incr_reset();
     return retval;
 }
 
@@ -200,6 +298,7 @@ compute_diffs(clixon_handle       h,
  * and call application callback validations.
  * @param[in]  h       Clixon handle
  * @param[in]  db      The startup database. The wanted backend state
+ * @param[in]  detach  Take over the db cache instead of copying it, see xmldb_get_detach
  * @param[in]  td      Transaction data
  * @param[out] cbret   CLIgen buffer w error stmt if retval = 0
  * @retval     1       Validation OK       
@@ -219,6 +318,7 @@ compute_diffs(clixon_handle       h,
 static int
 startup_common(clixon_handle       h,
                char               *db,
+               int                 detach,
                transaction_data_t *td,
                cbuf               *cbret)
 {
@@ -238,7 +338,11 @@ startup_common(clixon_handle       h,
             goto done;
     }
     if (clicon_option_bool(h, "CLICON_XMLDB_UPGRADE_CHECKOLD")){
-        if ((ret = xmldb_get0(h, db, YB_MODULE, NULL, "/", 0, 0, &xt, NULL, &xerr)) < 0)
+        if (detach)
+            ret = xmldb_get_detach(h, db, &xt, &xerr);
+        else
+            ret = xmldb_get0(h, db, YB_MODULE, NULL, "/", 0, 0, &xt, NULL, &xerr);
+        if (ret < 0)
             goto done;
         if (ret == 0){     /* ret should not be 0 */
             /* Print upgraded db: -q backend switch for debugging/ showing upgraded config only */
@@ -258,7 +362,11 @@ startup_common(clixon_handle       h,
         /* Get the startup datastore WITHOUT binding to YANG, sorting and default setting.
          * It is done below, later in this function
          */
-        if ((ret = xmldb_get0(h, db, YB_NONE, NULL, "/", 0, 0, &xt, NULL, &xerr)) < 0)
+        if (detach)
+            ret = xmldb_get_detach(h, db, &xt, &xerr);
+        else
+            ret = xmldb_get0(h, db, YB_NONE, NULL, "/", 0, 0, &xt, NULL, &xerr);
+        if (ret < 0)
             goto done;
         if (ret == 0){
             if (clixon_xml2cbuf1(cbret, xerr, 0, 0, NULL, -1, 0, 0, WITHDEFAULTS_REPORT_ALL) < 0)
@@ -273,8 +381,8 @@ startup_common(clixon_handle       h,
     }
     clixon_debug(CLIXON_DBG_BACKEND, "Reading startup config done");
     /* Clear flags xpath for get */
-    xml_apply0(xt, CX_ELMNT, (xml_applyfn_t*)xml_flag_reset,
-               (void*)(XML_FLAG_MARK|XML_FLAG_CHANGE));
+    if (xml_flag_reset_tree(xt, XML_FLAG_MARK|XML_FLAG_CHANGE) < 0)
+        goto done;
     /* Print upgraded db: -q backend switch for debugging/ showing upgraded config only */
     if (clicon_quit_upgrade_get(h) == 1){
         /* bind yang */
@@ -338,7 +446,7 @@ startup_common(clixon_handle       h,
     /* Handcraft transition with with only add tree */
     td->td_target = xt;
     xt = NULL;
-    if (compute_diffs(h, td) < 0)
+    if (compute_diffs(h, td, NULL) < 0)
         goto done;
     /* 4. Call plugin transaction start callbacks */
     if (plugin_transaction_begin_all(h, td) < 0)
@@ -399,7 +507,7 @@ startup_validate(clixon_handle h,
     /* Handcraft a transition with only target and add trees */
     if ((td = transaction_new()) == NULL)
         goto done;
-    if ((ret = startup_common(h, db, td, cbret)) < 0){
+    if ((ret = startup_common(h, db, 0, td, cbret)) < 0){
         plugin_transaction_abort_all(h, td);
         goto done;
     }
@@ -442,6 +550,7 @@ startup_commit(clixon_handle h,
 #ifdef STARTUP_COMMIT_REORDER
     cxobj              *xt = NULL;
 #endif
+    struct trans_timer  tt;
     int                 ret;
 
     if (strcmp(db,"running")==0){
@@ -451,7 +560,8 @@ startup_commit(clixon_handle h,
     /* Handcraft a transition with only target and add trees */
     if ((td = transaction_new()) == NULL)
         goto done;
-    if ((ret = startup_common(h, db, td, cbret)) < 0)
+    /* Startup db is not used after commit, take over its cache instead of copying it */
+    if ((ret = startup_common(h, db, 1, td, cbret)) < 0)
         goto done;
     if (ret == 0)
         goto fail;
@@ -461,6 +571,8 @@ startup_commit(clixon_handle h,
     /* After commit, make a post-commit call (sure that all plugins have committed) */
     if (plugin_transaction_commit_done_all(h, td) < 0)
         goto done;
+    /* System-only config may have been written by commit callbacks */
+    xmldb_system_only_reset(h);
     /* [Delete and] create running db */
     if (xmldb_exists(h, "running") == 1){
         if (xmldb_delete(h, "running") != 0 && errno != ENOENT)
@@ -473,6 +585,7 @@ startup_commit(clixon_handle h,
      * XXX default values are overwritten
      */
     if (td->td_target){
+        transaction_profile_start(&tt, 0);
 #ifdef STARTUP_COMMIT_REORDER
         if ((xt = xml_dup(td->td_target)) == NULL)
             goto done;
@@ -497,6 +610,8 @@ startup_commit(clixon_handle h,
         if (ret == 0)
             goto fail;
 #endif
+        if (transaction_profile_stop(&tt, "datastore", NULL) < 0)
+            goto done;
     }
     /* 10. Call plugin transaction end callbacks
      * XXX Issue: diff may include default values, but these are removed ^
@@ -544,19 +659,25 @@ validate_common(clixon_handle       h,
     int         retval = -1;
     yang_stmt  *yspec;
     db_elmnt   *de;
+    cxobj      *xlog = NULL;
     int         ret;
 
     if ((yspec = clicon_dbspec_yang(h)) == NULL){
         clixon_err(OE_FATAL, 0, "No DB_SPEC");
         goto done;
     }
+#ifdef XMLDB_EDIT_LOG
+    /* Get edits before cache access below sets a new generation */
+    if (xmldb_editlog_get(h, db, &xlog) < 0)
+        goto done;
+#endif
     /* This is mysterious: If cache, then populate it,.. */
     if ((de = xmldb_find(h, db)) != NULL &&
         xmldb_cache_get(de) != NULL){
         if (xmldb_populate(h, db) < 0)
             goto done;
         if (!xmldb_volatile_get(de))
-            if (xmldb_write_cache2file(h, db) < 0)
+            if (xmldb_persist(h, db) < 0)
                 goto done;
     }
     /* This is the state we are going to */
@@ -574,23 +695,32 @@ validate_common(clixon_handle       h,
             goto fail;
     }
     /* Clear flags xpath for get */
-    xml_apply0(td->td_target, CX_ELMNT, (xml_applyfn_t*)xml_flag_reset,
-               (void*)(XML_FLAG_MARK|XML_FLAG_CHANGE));
+    if (xlog == NULL &&
+        xml_flag_reset_tree(td->td_target, XML_FLAG_MARK|XML_FLAG_CHANGE) < 0)
+        goto done;
     /* 2. Parse xml trees
      * This is the state we are going from */
     if ((ret = xmldb_get0(h, "running", YB_MODULE, NULL, "/", 0, 0, &td->td_src, NULL, xret)) < 0)
         goto done;
     if (ret == 0)
         goto fail;
-    if (compute_diffs(h, td) < 0)
+    if (compute_diffs(h, td, xlog) < 0)
         goto done;
     /* 4. Call plugin transaction start callbacks */
     if (plugin_transaction_begin_all(h, td) < 0)
         goto done;
 
     /* 5. Make generic validation on all new or changed data.
-       Note this is only call that uses 3-values */
-    if ((ret = generic_validate(h, yspec, td, xret)) < 0)
+       Note this is only call that uses 3-values.
+       Running is valid, so must/when need only be evaluated for changes, unless
+       state data is included */
+    if (clicon_option_bool(h, "CLICON_VALIDATE_INCREMENTAL") &&
+        !clicon_option_bool(h, "CLICON_VALIDATE_TARGET_STATE") &&
+        validate_incr_init(td) < 0)
+        goto done;
+    ret = generic_validate(h, yspec, td, xret);
+    xml_yang_validate_incr_reset();
+    if (ret < 0)
         goto done;
     if (ret == 0)
         goto fail;
@@ -604,6 +734,56 @@ validate_common(clixon_handle       h,
         goto done;
     retval = 1;
  done:
+    if (xlog)
+        xml_free(xlog);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! Validate a datastore in place without a transaction
+ *
+ * Validate the cache of db against YANG, as if all of it was added. There is no copy of
+ * target and running, no diff and no plugin transaction callbacks.
+ * @param[in]  h     Clixon handle
+ * @param[in]  db    Name of datastore to validate
+ * @param[out] xret  Error XML tree. Free with xml_free after use
+ * @retval     1     Validation OK
+ * @retval     0     Validation failed (xret set)
+ * @retval    -1     Error
+ * @see CLICON_VALIDATE_LIGHT
+ */
+static int
+validate_light(clixon_handle h,
+               const char   *db,
+               cxobj       **xret)
+{
+    int                retval = -1;
+    cxobj             *xt = NULL;
+    cxobj             *x;
+    struct trans_timer tt;
+    int                ret;
+
+    transaction_profile_start(&tt, 0);
+    if ((ret = xmldb_get_cache(h, db, &xt, xret)) < 0)
+        goto done;
+    if (ret == 0)
+        goto fail;
+    x = NULL;
+    while ((x = xml_child_each(xt, x, CX_ELMNT)) != NULL){
+        if ((ret = xml_yang_validate_add(h, x, xret)) < 0)
+            goto done;
+        if (ret == 0)
+            goto fail;
+    }
+    if ((ret = xml_yang_validate_all_top(h, xt, xret)) < 0)
+        goto done;
+    if (ret == 0)
+        goto fail;
+    retval = 1;
+ done:
+    transaction_profile_stop(&tt, "yang_validate", NULL);
     return retval;
  fail:
     retval = 0;
@@ -634,11 +814,18 @@ candidate_validate(clixon_handle h,
         clixon_err(OE_CFG, EINVAL, "db or cbret is NULL");
         goto done;
     }
-    /* 1. Start transaction */
-    if ((td = transaction_new()) == NULL)
-        goto done;
+    /* Validate in place, unless state data is included in target which needs a copy */
+    if (clicon_option_bool(h, "CLICON_VALIDATE_LIGHT") &&
+        !clicon_option_bool(h, "CLICON_VALIDATE_TARGET_STATE"))
+        ret = validate_light(h, db, &xret);
+    else {
+        /* 1. Start transaction */
+        if ((td = transaction_new()) == NULL)
+            goto done;
         /* Common steps (with commit) */
-    if ((ret = validate_common(h, db, td, &xret)) < 0){
+        ret = validate_common(h, db, td, &xret);
+    }
+    if (ret < 0){
         /* A little complex due to several sources of validation fails or errors.
          * (1) xerr is set -> translate to cbret; (2) cbret set use that; otherwise
          * use clixon_err. 
@@ -661,7 +848,8 @@ candidate_validate(clixon_handle h,
             goto done;
         goto fail;
     }
-    plugin_transaction_end_all(h, td);
+    if (td)
+        plugin_transaction_end_all(h, td);
     retval = 1;
  done:
     if (xret)
@@ -677,6 +865,465 @@ candidate_validate(clixon_handle h,
     goto done;
 }
 
+/*! Committed changes of running, entry in change feed
+ *
+ * @see CLICON_CHANGE_FEED
+ */
+struct change_feed_entry{
+    qelem_t   cf_qelem;   /* List header */
+    uint64_t  cf_gen0;    /* Generation of running before commit */
+    uint64_t  cf_gen;     /* Generation of running after commit */
+    uint64_t  cf_id;      /* Transaction id */
+    char     *cf_changes; /* Changes as XML leaf-lists deleted, added and changed */
+};
+typedef struct change_feed_entry change_feed_entry;
+
+/*! Change feed, oldest commit first
+ */
+struct change_feed{
+    change_feed_entry *cf_list; /* List of commits, oldest first */
+    uint32_t           cf_nr;   /* Number of commits in list */
+};
+
+/*! Get current generation of running
+ *
+ * @param[in]  h     Clixon handle
+ * @retval     gen   Generation, or 0 if running has no cache
+ */
+static uint64_t
+change_feed_running_gen(clixon_handle h)
+{
+    db_elmnt *de;
+
+    if ((de = xmldb_find(h, "running")) == NULL)
+        return 0;
+    return xmldb_generation_get(de);
+}
+
+/*! Serialize diff vectors of a commit transaction as api-paths
+ *
+ * Made before running is replaced, since the deleted nodes are in the old tree
+ * @param[in]  td    Transaction data
+ * @param[out] cb    Leaf-lists deleted, added and changed
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+static int
+change_feed_serialize(transaction_data_t *td,
+                      cbuf               *cb)
+{
+    int    retval = -1;
+    cbuf  *cbp = NULL;
+    size_t i;
+    int    j;
+    char  *tag[] = {"deleted", "added", "changed"};
+    cxobj **vec[3];
+    size_t len[3];
+
+    vec[0] = td->td_dvec; len[0] = td->td_dlen;
+    vec[1] = td->td_avec; len[1] = td->td_alen;
+    vec[2] = td->td_tcvec; len[2] = td->td_clen;
+    if ((cbp = cbuf_new()) == NULL){
+        clixon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    for (j=0; j<3; j++)
+        for (i=0; i<len[j]; i++){
+            cbuf_reset(cbp);
+            if (xml2api_path(vec[j][i], 0, cbp) < 0)
+                goto done;
+            cprintf(cb, "<%s>", tag[j]);
+            if (xml_chardata_cbuf_append(cb, 0, cbuf_get(cbp)) < 0)
+                goto done;
+            cprintf(cb, "</%s>", tag[j]);
+        }
+    retval = 0;
+ done:
+    if (cbp)
+        cbuf_free(cbp);
+    return retval;
+}
+
+/*! Add commit to change feed, remove oldest commits if full
+ *
+ * If running has changed other than by commit since the last commit in the feed, the
+ * earlier commits are removed since the changes in between are not known.
+ * @param[in]  h       Clixon handle
+ * @param[in]  id      Transaction id
+ * @param[in]  gen0    Generation of running before commit
+ * @param[in]  changes Serialized changes, copied
+ * @retval     0       OK
+ * @retval    -1       Error
+ */
+static int
+change_feed_add(clixon_handle h,
+                uint64_t      id,
+                uint64_t      gen0,
+                const char   *changes)
+{
+    int                 retval = -1;
+    struct change_feed *cf = NULL;
+    change_feed_entry  *ce;
+    uint32_t            max;
+
+    max = clicon_option_int(h, "CLICON_CHANGE_FEED");
+    clicon_ptr_get(h, "change-feed-struct", (void**)&cf);
+    if (cf == NULL){
+        if ((cf = calloc(1, sizeof(*cf))) == NULL){
+            clixon_err(OE_UNIX, errno, "calloc");
+            goto done;
+        }
+        if (clicon_ptr_set(h, "change-feed-struct", cf) < 0){
+            free(cf);
+            goto done;
+        }
+    }
+    while ((ce = cf->cf_list) != NULL &&
+           (cf->cf_nr >= max || PREVQ(change_feed_entry *, ce)->cf_gen != gen0)){
+        DELQ(ce, cf->cf_list, change_feed_entry *);
+        cf->cf_nr--;
+        free(ce->cf_changes);
+        free(ce);
+    }
+    if ((ce = calloc(1, sizeof(*ce))) == NULL){
+        clixon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    if ((ce->cf_changes = strdup(changes)) == NULL){
+        clixon_err(OE_UNIX, errno, "strdup");
+        free(ce);
+        goto done;
+    }
+    ce->cf_gen0 = gen0;
+    ce->cf_gen = change_feed_running_gen(h);
+    ce->cf_id = id;
+    ADDQ(ce, cf->cf_list);
+    cf->cf_nr++;
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Free change feed
+ *
+ * @param[in] h  Clixon handle
+ * @retval    0  OK
+ */
+int
+change_feed_free(clixon_handle h)
+{
+    struct change_feed *cf = NULL;
+    change_feed_entry  *ce;
+
+    clicon_ptr_get(h, "change-feed-struct", (void**)&cf);
+    if (cf != NULL){
+        while ((ce = cf->cf_list) != NULL){
+            DELQ(ce, cf->cf_list, change_feed_entry *);
+            free(ce->cf_changes);
+            free(ce);
+        }
+        free(cf);
+    }
+    clicon_ptr_del(h, "change-feed-struct");
+    return 0;
+}
+
+/*! Find first commit in change feed after a generation
+ *
+ * @param[in]  cf     Change feed, or NULL
+ * @param[in]  all    If set, all commits in feed, since is ignored
+ * @param[in]  since  Generation of running
+ * @param[in]  gen    Current generation of running
+ * @param[out] cep    First commit after since, or NULL if none
+ * @retval     1      Complete: the commits from cep are all changes of running since since
+ * @retval     0      Not complete: changes of running are missing in the feed
+ */
+static int
+change_feed_since(struct change_feed *cf,
+                  int                 all,
+                  uint64_t            since,
+                  uint64_t            gen,
+                  change_feed_entry **cep)
+{
+    change_feed_entry *ce;
+    change_feed_entry *ce0 = NULL;
+
+    if ((ce = cf ? cf->cf_list : NULL) != NULL){
+        do {
+            if (all || ce->cf_gen > since){
+                ce0 = ce;
+                break;
+            }
+            ce = NEXTQ(change_feed_entry *, ce);
+        } while (ce != cf->cf_list);
+    }
+    *cep = ce0;
+    if (ce0 == NULL)     /* No commits after since */
+        return since == gen;
+    /* Commits are contiguous, check both ends */
+    return (all || ce0->cf_gen0 == since) &&
+        PREVQ(change_feed_entry *, cf->cf_list)->cf_gen == gen;
+}
+
+/*! Mark nodes of running changed since a generation using the change feed
+ *
+ * Nodes of the committed changes found in x0 or x2, and their ancestors, are marked
+ * with XML_FLAG_MARK and added to vec so that the caller can reset the flags.
+ * @param[in]  h      Clixon handle
+ * @param[in]  since  Generation of running when it was equal to x0
+ * @param[in]  x0     Running at generation since
+ * @param[in]  x2     Current running
+ * @param[out] vecp   Marked nodes, free with free(), also if retval is 0
+ * @param[out] lenp   Length of vec
+ * @retval     1      OK, all changes are marked
+ * @retval     0      Change feed not complete, or change not understood
+ * @retval    -1      Error
+ * @see xml_rebase_marked
+ */
+static int
+change_feed_mark(clixon_handle h,
+                 uint64_t      since,
+                 cxobj        *x0,
+                 cxobj        *x2,
+                 cxobj      ***vecp,
+                 size_t       *lenp)
+{
+    int                 retval = -1;
+    struct change_feed *cf = NULL;
+    change_feed_entry  *ce;
+    yang_stmt          *yspec;
+    cbuf               *cb = NULL;
+    cxobj              *xt = NULL;
+    cxobj              *xp;
+    cxobj              *xc;
+    cxobj              *x;
+    cxobj              *xerr = NULL;
+    cxobj              *xv[2];
+    char               *xpath = NULL;
+    cvec               *nsc = NULL;
+    int                 i;
+    int                 ret;
+
+    clicon_ptr_get(h, "change-feed-struct", (void**)&cf);
+    if (change_feed_since(cf, 0, since, change_feed_running_gen(h), &ce) == 0)
+        goto fail;
+    if (ce == NULL)
+        goto ok;
+    yspec = clicon_dbspec_yang(h);
+    if ((cb = cbuf_new()) == NULL){
+        clixon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    xv[0] = x0;
+    xv[1] = x2;
+    do {
+        cbuf_reset(cb);
+        cprintf(cb, "<changes>%s</changes>", ce->cf_changes);
+        if (clixon_xml_parse_string(cbuf_get(cb), YB_NONE, NULL, &xt, NULL) < 0)
+            goto done;
+        xp = xml_find(xt, "changes");
+        xc = NULL;
+        while ((xc = xml_child_each(xp, xc, CX_ELMNT)) != NULL){
+            if ((ret = api_path2xpath(xml_body(xc), yspec, &xpath, &nsc, &xerr)) < 0)
+                goto done;
+            if (ret == 0)
+                goto fail;
+            for (i=0; i<2; i++){
+                x = xpath_first(xv[i], nsc, "%s", xpath);
+                for (; x != NULL && xml_flag(x, XML_FLAG_MARK) == 0; x = xml_parent(x)){
+                    xml_flag_set(x, XML_FLAG_MARK);
+                    if (cxvec_append(x, vecp, lenp) < 0)
+                        goto done;
+                }
+            }
+            free(xpath);
+            xpath = NULL;
+            cvec_free(nsc);
+            nsc = NULL;
+        }
+        xml_free(xt);
+        xt = NULL;
+        ce = NEXTQ(change_feed_entry *, ce);
+    } while (ce != cf->cf_list);
+ ok:
+    retval = 1;
+ done:
+    if (xpath)
+        free(xpath);
+    if (nsc)
+        cvec_free(nsc);
+    if (xerr)
+        xml_free(xerr);
+    if (xt)
+        xml_free(xt);
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! Get configuration changes committed to running since a generation
+ *
+ * @param[in]  h       Clixon handle
+ * @param[in]  xe      Request: <rpc><xn></rpc>
+ * @param[out] cbret   Return xml tree, eg <rpc-reply>..., <rpc-error..
+ * @param[in]  arg     client-entry
+ * @param[in]  regarg  User argument given at rpc_callback_register()
+ * @retval     0       OK
+ * @retval    -1       Error
+ * @see CLICON_CHANGE_FEED
+ */
+static int
+from_client_change_feed(clixon_handle h,
+                        cxobj        *xe,
+                        cbuf         *cbret,
+                        void         *arg,
+                        void         *regarg)
+{
+    int                 retval = -1;
+    struct change_feed *cf = NULL;
+    change_feed_entry  *ce;
+    change_feed_entry  *ce0 = NULL;
+    char               *str;
+    uint64_t            since = 0;
+    uint64_t            gen;
+    int                 complete;
+    char               *reason = NULL;
+    int                 ret;
+
+    if ((str = xml_find_body(xe, "since")) != NULL){
+        if ((ret = parse_uint64(str, &since, &reason)) < 0){
+            clixon_err(OE_XML, errno, "parse_uint64");
+            goto done;
+        }
+        if (ret == 0){
+            if (netconf_bad_element(cbret, "application", "since", reason) < 0)
+                goto done;
+            goto ok;
+        }
+    }
+    gen = change_feed_running_gen(h);
+    clicon_ptr_get(h, "change-feed-struct", (void**)&cf);
+    complete = change_feed_since(cf, str == NULL, since, gen, &ce0);
+    cprintf(cbret, "<rpc-reply xmlns=\"%s\">", NETCONF_BASE_NAMESPACE);
+    cprintf(cbret, "<generation xmlns=\"%s\">%" PRIu64 "</generation>", CLIXON_LIB_NS, gen);
+    cprintf(cbret, "<complete xmlns=\"%s\">%s</complete>", CLIXON_LIB_NS, complete?"true":"false");
+    if ((ce = ce0) != NULL){
+        do {
+            cprintf(cbret, "<commit xmlns=\"%s\">", CLIXON_LIB_NS);
+            cprintf(cbret, "<generation>%" PRIu64 "</generation>", ce->cf_gen);
+            cprintf(cbret, "<transaction-id>%" PRIu64 "</transaction-id>", ce->cf_id);
+            cbuf_append_str(cbret, ce->cf_changes);
+            cprintf(cbret, "</commit>");
+            ce = NEXTQ(change_feed_entry *, ce);
+        } while (ce != cf->cf_list);
+    }
+    cprintf(cbret, "</rpc-reply>");
+ ok:
+    retval = 0;
+ done:
+    if (reason)
+        free(reason);
+    return retval;
+}
+
+/*! Serialize diff vectors of a commit transaction as config-change edits
+ *
+ * Made before running is replaced, since the deleted nodes are in the old tree.
+ * Added nodes and changed leafs are included with their new values.
+ * @param[in]  td    Transaction data
+ * @param[out] cb    List of edit elements
+ * @retval     0     OK
+ * @retval    -1     Error
+ * @see change_feed_serialize  Paths only
+ */
+static int
+config_change_serialize(transaction_data_t *td,
+                        cbuf               *cb)
+{
+    int    retval = -1;
+    cbuf  *cbp = NULL;
+    cxobj *xc = NULL;
+    cvec  *nsc = NULL;
+    size_t i;
+    int    j;
+    char  *op[] = {"delete", "create", "replace"};
+    cxobj **vec[3];
+    size_t len[3];
+
+    vec[0] = td->td_dvec; len[0] = td->td_dlen;
+    vec[1] = td->td_avec; len[1] = td->td_alen;
+    vec[2] = td->td_tcvec; len[2] = td->td_clen;
+    if ((cbp = cbuf_new()) == NULL){
+        clixon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    for (j=0; j<3; j++)
+        for (i=0; i<len[j]; i++){
+            cbuf_reset(cbp);
+            if (xml2api_path(vec[j][i], 0, cbp) < 0)
+                goto done;
+            cprintf(cb, "<edit><target>");
+            if (xml_chardata_cbuf_append(cb, 0, cbuf_get(cbp)) < 0)
+                goto done;
+            cprintf(cb, "</target><operation>%s</operation>", op[j]);
+            if (j > 0){
+                /* Detached copy with namespaces of its context */
+                if ((xc = xml_dup(vec[j][i])) == NULL)
+                    goto done;
+                if (xml_nsctx_node(vec[j][i], &nsc) < 0)
+                    goto done;
+                if (xmlns_set_all(xc, nsc) < 0)
+                    goto done;
+                cprintf(cb, "<value>");
+                if (clixon_xml2cbuf(cb, xc, 0, 0, NULL, -1, 0) < 0)
+                    goto done;
+                cprintf(cb, "</value>");
+                xml_free(xc);
+                xc = NULL;
+                cvec_free(nsc);
+                nsc = NULL;
+            }
+            cprintf(cb, "</edit>");
+        }
+    retval = 0;
+ done:
+    if (xc)
+        xml_free(xc);
+    if (nsc)
+        cvec_free(nsc);
+    if (cbp)
+        cbuf_free(cbp);
+    return retval;
+}
+
+/*! Notify committed changes on the config-change stream
+ *
+ * @param[in]  h       Clixon handle
+ * @param[in]  id      Transaction id
+ * @param[in]  gen0    Generation of running before commit
+ * @param[in]  edits   Serialized edits
+ * @retval     0       OK
+ * @retval    -1       Error
+ * @see CLICON_STREAM_CONFIG_CHANGE
+ */
+static int
+config_change_notify(clixon_handle h,
+                     uint64_t      id,
+                     uint64_t      gen0,
+                     const char   *edits)
+{
+    return stream_notify(h, CONFIG_CHANGE_STREAM,
+                         "<config-change xmlns=\"%s\">"
+                         "<generation>%" PRIu64 "</generation>"
+                         "<previous-generation>%" PRIu64 "</previous-generation>"
+                         "<transaction-id>%" PRIu64 "</transaction-id>"
+                         "%s</config-change>",
+                         CLIXON_LIB_NS, change_feed_running_gen(h), gen0, id, edits);
+}
+
 /*! Do a diff between candidate and running, then start a commit transaction
  *
  * The code reverts changes if the commit fails. But if the revert
@@ -707,6 +1354,10 @@ candidate_commit(clixon_handle  h,
     cxobj              *xret = NULL;
     yang_stmt          *yspec;
     db_elmnt           *de;
+    cbuf               *cbfeed = NULL;
+    cbuf               *cbchange = NULL;
+    uint64_t            gen0 = 0;
+    struct trans_timer  tt;
     int                 ret;
 
     clixon_debug(CLIXON_DBG_DATASTORE, "db: %s", db);
@@ -719,6 +1370,13 @@ candidate_commit(clixon_handle  h,
      */
     if ((ret = validate_common(h, db, td, &xret)) < 0)
         goto done;
+    /* Changes of nodes partially locked by other sessions are denied, RFC 5717 */
+    if (ret == 1 && myid != 0){
+        if ((ret = partial_lock_commit_check(h, td, myid, cbret)) < 0)
+            goto done;
+        if (ret == 0)
+            goto fail;
+    }
 
     /* If the confirmed-commit feature is enabled, execute phase 2:
      *  - If a valid confirming-commit, cancel the rollback event
@@ -737,7 +1395,7 @@ candidate_commit(clixon_handle  h,
     if (if_feature(h, "ietf-netconf", "confirmed-commit")
         && confirmed_commit_state_get(h) != ROLLBACK
         && xe != NULL){
-        if (handle_confirmed_commit(h, xe, myid) < 0)
+        if (handle_confirmed_commit(h, xe, myid, ret == 1 ? td : NULL) < 0)
             goto done;
     }
     if (ret == 0){
@@ -751,10 +1409,34 @@ candidate_commit(clixon_handle  h,
     /* After commit, make a post-commit call (sure that all plugins have committed) */
     if (plugin_transaction_commit_done_all(h, td) < 0)
         goto done;
+    /* System-only config may have been written by commit callbacks */
+    xmldb_system_only_reset(h);
+    /* Serialize changes before the old running tree is replaced */
+    if (clicon_option_int(h, "CLICON_CHANGE_FEED") > 0){
+        if ((cbfeed = cbuf_new()) == NULL){
+            clixon_err(OE_UNIX, errno, "cbuf_new");
+            goto done;
+        }
+        if (change_feed_serialize(td, cbfeed) < 0)
+            goto done;
+        gen0 = change_feed_running_gen(h);
+    }
+    if (clicon_option_bool(h, "CLICON_STREAM_CONFIG_CHANGE")){
+        if ((cbchange = cbuf_new()) == NULL){
+            clixon_err(OE_UNIX, errno, "cbuf_new");
+            goto done;
+        }
+        if (config_change_serialize(td, cbchange) < 0)
+            goto done;
+        gen0 = change_feed_running_gen(h);
+    }
     /* 8. Success: Copy candidate to running
      */
+    transaction_profile_start(&tt, 0);
     if (xmldb_copy(h, db, "running") < 0)
         goto done;
+    if (transaction_profile_stop(&tt, "datastore", NULL) < 0)
+        goto done;
     /* Remove system-only-config data from destination cache */
     if (clicon_option_bool(h, "CLICON_XMLDB_SYSTEM_ONLY_CONFIG")){
         xmldb_clear(h, "running");
@@ -762,6 +1444,14 @@ candidate_commit(clixon_handle  h,
         xmldb_clear(h, db);
 #endif
     }
+    if (backend_snapshot_publish(h) < 0)
+        goto done;
+    if (cbfeed &&
+        change_feed_add(h, td->td_id, gen0, cbuf_get(cbfeed)) < 0)
+        goto done;
+    if (cbchange &&
+        config_change_notify(h, td->td_id, gen0, cbuf_get(cbchange)) < 0)
+        goto done;
     if ((de = xmldb_find(h, db)) == NULL){
         clixon_err(OE_DB, 0, "DB not found %s", db);
         goto done;
@@ -787,6 +1477,10 @@ candidate_commit(clixon_handle  h,
             plugin_transaction_abort_all(h, td);
         transaction_free1(td, 1);
     }
+    if (cbfeed)
+        cbuf_free(cbfeed);
+    if (cbchange)
+        cbuf_free(cbchange);
     if (xret)
         xml_free(xret);
     return retval;
@@ -820,6 +1514,12 @@ backend_update(clixon_handle h,
     cxobj         *xrun = NULL;
     int            conflict = 0;
     diff_rebase_t *dr = NULL;
+    db_elmnt      *de;
+    uint64_t       gen0;
+    cxobj        **vec = NULL;
+    size_t         veclen = 0;
+    size_t         i;
+    int            ret;
 
     /* Original candidate */
     if (xmldb_candidate_find(h, "candidate-orig", ceid, &de0, &db0) < 0)
@@ -828,7 +1528,7 @@ backend_update(clixon_handle h,
         clixon_err(OE_DB, 0, "candidate-orig de not found");
         goto done;
     }
-    if ((xorig = xmldb_cache_get(de0)) == NULL){
+    if ((xorig = xmldb_cache_read(de0)) == NULL){
         clixon_err(OE_DB, 0, "candidate-orig cache not found");
         goto done;
     }
@@ -841,9 +1541,27 @@ backend_update(clixon_handle h,
     /* Running */
     if (xmldb_get_cache(h, "running", &xrun, NULL) < 0)
         goto done;
+    /* Running is unchanged since candidate-orig was copied from it */
+    if ((gen0 = xmldb_generation_base(de0)) != 0 &&
+        (de = xmldb_find(h, "running")) != NULL &&
+        xmldb_generation_get(de) == gen0)
+        goto ok;
     if ((dr = diff_rebase_new()) == NULL)
         goto done;
-    if (xml_rebase(h, xorig, xcand, xrun, &conflict, cbret, dr) < 0)
+    /* Only rebase nodes committed since then, if all such commits are known */
+    ret = 0;
+    if (gen0 != 0 && clicon_option_int(h, "CLICON_CHANGE_FEED") > 0){
+        if ((ret = change_feed_mark(h, gen0, xorig, xrun, &vec, &veclen)) < 0)
+            goto done;
+        if (ret == 1 && xml_rebase_marked(h, xorig, xcand, xrun, &conflict, cbret, dr) < 0)
+            goto done;
+        /* Reset marks before nodes of running are copied to candidate */
+        for (i=0; i<veclen; i++)
+            xml_flag_reset(vec[i], XML_FLAG_MARK);
+        free(vec);
+        vec = NULL;
+    }
+    if (ret == 0 && xml_rebase(h, xorig, xcand, xrun, &conflict, cbret, dr) < 0)
         goto done;
     if (conflict == 0){
         /* Rebase candidate, step 1 of 4.8.2.1.  <commit>
@@ -859,7 +1577,7 @@ backend_update(clixon_handle h,
         if (xmldb_populate(h, db1) < 0) // ??
             goto done;
         if (!xmldb_volatile_get(de1))
-            if (xmldb_write_cache2file(h, db1) < 0)
+            if (xmldb_persist(h, db1) < 0)
                 goto done;
         /* Reset candidate-orig to running */
         if (xmldb_copy(h, "running", db0) < 0){
@@ -875,8 +1593,14 @@ backend_update(clixon_handle h,
         }
         goto fail;
     }
+ ok:
     retval = 1;
  done:
+    if (vec){
+        for (i=0; i<veclen; i++)
+            xml_flag_reset(vec[i], XML_FLAG_MARK);
+        free(vec);
+    }
     if (dr)
         diff_rebase_free(dr);
     return retval;
@@ -885,6 +1609,209 @@ backend_update(clixon_handle h,
     goto done;
 }
 
+/* Commits of shared candidate waiting to be made as one transaction, see CLICON_COMMIT_GROUP
+ */
+struct commit_group {
+    uint32_t *cg_idv; /* Session ids of clients waiting for reply, in arrival order */
+    int       cg_len;
+    int       cg_max;
+    cxobj    *cg_xe;  /* Copy of first commit request */
+};
+
+static int commit_group_timeout(int fd, void *arg);
+
+/*! Check if a session is waiting in the commit group
+ */
+static int
+commit_group_member(struct commit_group *cg,
+                    uint32_t             id)
+{
+    int i;
+
+    for (i=0; i<cg->cg_len; i++)
+        if (cg->cg_idv[i] == id)
+            return 1;
+    return 0;
+}
+
+/*! Add a commit to the commit group, the reply to the client is deferred
+ *
+ * The first commit of a group starts a timer of CLICON_COMMIT_GROUP ms
+ * @param[in]  h       Clixon handle
+ * @param[in]  xe      Request: <rpc><xn></rpc>
+ * @param[in]  ce      Client entry of commit
+ * @retval     0       OK
+ * @retval    -1       Error
+ */
+static int
+commit_group_add(clixon_handle h,
+                 cxobj        *xe,
+                 client_entry *ce)
+{
+    int                  retval = -1;
+    struct commit_group *cg = NULL;
+    uint32_t            *idv;
+    struct timeval       t;
+    struct timeval       t1;
+
+    clicon_ptr_get(h, "commit-group-struct", (void**)&cg);
+    if (cg == NULL){
+        if ((cg = calloc(1, sizeof(*cg))) == NULL){
+            clixon_err(OE_UNIX, errno, "calloc");
+            goto done;
+        }
+        clicon_ptr_set(h, "commit-group-struct", cg);
+    }
+    if (cg->cg_len == 0){
+        if ((cg->cg_xe = xml_dup(xe)) == NULL)
+            goto done;
+        gettimeofday(&t, NULL);
+        t1.tv_sec = clicon_option_int(h, "CLICON_COMMIT_GROUP")/1000;
+        t1.tv_usec = (clicon_option_int(h, "CLICON_COMMIT_GROUP")%1000)*1000;
+        timeradd(&t, &t1, &t);
+        if (clixon_event_reg_timeout(t, commit_group_timeout, h, "commit group") < 0)
+            goto done;
+    }
+    if (cg->cg_len == cg->cg_max){
+        cg->cg_max = cg->cg_max ? 2*cg->cg_max : 8;
+        if ((idv = realloc(cg->cg_idv, cg->cg_max*sizeof(*idv))) == NULL){
+            clixon_err(OE_UNIX, errno, "realloc");
+            goto done;
+        }
+        cg->cg_idv = idv;
+    }
+    cg->cg_idv[cg->cg_len++] = ce->ce_id;
+    ce->ce_reply_deferred = 1;
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Commit the shared candidate once for all commits in the commit group and reply to each client
+ *
+ * All clients get the same reply. Clients that have closed their sessions are skipped.
+ * @param[in]  h       Clixon handle
+ * @retval     0       OK
+ * @retval    -1       Error
+ */
+static int
+commit_group_flush(clixon_handle h)
+{
+    int                  retval = -1;
+    struct commit_group *cg = NULL;
+    cbuf                *cbret = NULL;
+    client_entry        *ce;
+    int                  i;
+    int                  ret;
+
+    clicon_ptr_get(h, "commit-group-struct", (void**)&cg);
+    if (cg == NULL || cg->cg_len == 0)
+        return 0;
+    clixon_event_unreg_timeout(commit_group_timeout, h);
+    clixon_debug(CLIXON_DBG_BACKEND, "commits:%d", cg->cg_len);
+    if ((cbret = cbuf_new()) == NULL){
+        clixon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    if ((ret = candidate_commit(h, cg->cg_xe, "candidate", cg->cg_idv[0], 0, cbret)) < 0){
+        clixon_debug(CLIXON_DBG_BACKEND, "Commit candidate failed");
+        if (clixon_plugin_report_err(h, cbret) < 0)
+            goto done;
+    }
+    else if (ret == 1){
+        if (clicon_option_bool(h, "CLICON_AUTOLOCK"))
+            xmldb_unlock(h, "candidate");
+        cprintf(cbret, "<rpc-reply xmlns=\"%s\"><ok/></rpc-reply>", NETCONF_BASE_NAMESPACE);
+    }
+    if (cbuf_len(cbret) == 0)
+        if (netconf_operation_failed(cbret, "application", "%s",
+                                     clixon_err_category()?clixon_err_reason():"unknown")< 0)
+            goto done;
+    for (i=0; i<cg->cg_len; i++){
+        if ((ce = backend_client_find(h, cg->cg_idv[i])) == NULL)
+            continue;
+        if (backend_client_send(h, ce, cbuf_get(cbret), cbuf_len(cbret), 1) < 0)
+            goto done;
+    }
+    retval = 0;
+ done:
+    cg->cg_len = 0;
+    if (cg->cg_xe){
+        xml_free(cg->cg_xe);
+        cg->cg_xe = NULL;
+    }
+    if (cbret)
+        cbuf_free(cbret);
+    return retval;
+}
+
+/*! Timer of commit group has expired
+ */
+static int
+commit_group_timeout(int   fd,
+                     void *arg)
+{
+    return commit_group_flush((clixon_handle)arg);
+}
+
+/*! Make waiting commits of the commit group before a request, if needed
+ *
+ * Commits and edit-config of candidate from other sessions are made while commits wait.
+ * All other requests, and all requests from sessions waiting for a commit reply, first
+ * make the waiting commits. This keeps replies of a session in order, and keeps for
+ * example a discard-changes or edit of running from overtaking the waiting commits.
+ * @param[in]  h       Clixon handle
+ * @param[in]  ce      Client entry of request
+ * @param[in]  xe      Request: <rpc><xn></rpc>
+ * @retval     0       OK
+ * @retval    -1       Error
+ * @see CLICON_COMMIT_GROUP
+ */
+int
+commit_group_check(clixon_handle h,
+                   client_entry *ce,
+                   cxobj        *xe)
+{
+    struct commit_group *cg = NULL;
+    cxobj               *xt;
+
+    clicon_ptr_get(h, "commit-group-struct", (void**)&cg);
+    if (cg == NULL || cg->cg_len == 0)
+        return 0;
+    if (!commit_group_member(cg, ce->ce_id)){
+        if (strcmp(xml_name(xe), "commit") == 0)
+            return 0;
+        if (strcmp(xml_name(xe), "edit-config") == 0 &&
+            (xt = xml_find_type(xe, NULL, "target", CX_ELMNT)) != NULL &&
+            xml_find_type(xt, NULL, "candidate", CX_ELMNT) != NULL)
+            return 0;
+    }
+    return commit_group_flush(h);
+}
+
+/*! Free commit group, waiting clients get no reply
+ *
+ * @param[in] h  Clixon handle
+ * @retval    0  OK
+ */
+int
+commit_group_free(clixon_handle h)
+{
+    struct commit_group *cg = NULL;
+
+    clicon_ptr_get(h, "commit-group-struct", (void**)&cg);
+    if (cg != NULL){
+        clixon_event_unreg_timeout(commit_group_timeout, h);
+        if (cg->cg_idv)
+            free(cg->cg_idv);
+        if (cg->cg_xe)
+            xml_free(cg->cg_xe);
+        free(cg);
+    }
+    clicon_ptr_del(h, "commit-group-struct");
+    return 0;
+}
+
 /*! Commit the candidate configuration as the device's new current configuration
  *
  * @param[in]  h       Clixon handle
@@ -975,6 +1902,17 @@ from_client_commit(clixon_handle h,
             goto done;
         goto ok;
     }
+    /* Group plain commits of shared candidate, the reply is sent by commit_group_flush */
+    if (clicon_option_int(h, "CLICON_COMMIT_GROUP") > 0 &&
+        !clicon_option_bool(h, "CLICON_XMLDB_PRIVATE_CANDIDATE") &&
+        partial_lock_other(h, 0) == 0 &&
+        xml_child_nr_type(xe, CX_ELMNT) == 0 &&
+        (!if_feature(h, "ietf-netconf", "confirmed-commit") ||
+         confirmed_commit_state_get(h) == INACTIVE)){
+        if (commit_group_add(h, xe, ce) < 0)
+            goto done;
+        goto ok;
+    }
     if (clicon_option_bool(h, "CLICON_XMLDB_PRIVATE_CANDIDATE")){
         if ((ret = candidate_validate(h, db, cbret)) < 0)
             goto done;
@@ -1329,7 +2267,7 @@ xmldb_find_create(clixon_handle h,
                 if ((de = xmldb_candidate_new(h, "candidate", ceid)) == NULL)
                     goto done;
             }
-            if (xmldb_cache_get(de) == NULL){
+            if (xmldb_cache_read(de) == NULL){
                 if (xmldb_copy(h, "running", xmldb_name_get(de)) < 0)
                     goto done;
             }
@@ -1340,7 +2278,7 @@ xmldb_find_create(clixon_handle h,
                 if ((de_orig = xmldb_candidate_new(h, "candidate-orig", ceid)) == NULL)
                     goto done;
             }
-            if (xmldb_cache_get(de_orig) == NULL){
+            if (xmldb_cache_read(de_orig) == NULL){
                 if (xmldb_copy(h, "running", xmldb_name_get(de_orig)) < 0)
                     goto done;
             }
@@ -1457,6 +2395,8 @@ xmldb_candidate_new(clixon_handle h,
         goto done;
     if (xmldb_modified_set(de, 0) < 0)
         goto done;
+    if (xmldb_cache_shared(de)) /* Shares cache of running which is already populated */
+        goto done;
     if ((xt = xmldb_cache_get(de)) == NULL){
         if ((xt = xml_new(DATASTORE_TOP_SYMBOL, NULL, CX_ELMNT)) == NULL)
             goto done;
@@ -1479,6 +2419,7 @@ xmldb_candidate_new(clixon_handle h,
 
 /*! Init backend commit: Set up commit-related netconf rpc callbacks
  *
+ * Also add the config-change stream if CLICON_STREAM_CONFIG_CHANGE is set
  * @param[in]  h     Clixon handle
  * @retval     0     OK
  * @retval    -1     Error (fatal)
@@ -1486,7 +2427,8 @@ xmldb_candidate_new(clixon_handle h,
 int
 backend_commit_init(clixon_handle h)
 {
-    int retval = -1;
+    int            retval = -1;
+    struct timeval retention = {0,0};
 
     if (rpc_callback_register(h, from_client_commit, NULL,
                       NETCONF_BASE_NAMESPACE, "commit") < 0)
@@ -1502,6 +2444,15 @@ backend_commit_init(clixon_handle h)
     if (rpc_callback_register(h, from_client_update, NULL,
                               NETCONF_PRIVCAND_NAMESPACE, "update") < 0)
         goto done;
+    if (rpc_callback_register(h, from_client_change_feed, NULL,
+                              CLIXON_LIB_NS, "change-feed") < 0)
+        goto done;
+    if (clicon_option_bool(h, "CLICON_STREAM_CONFIG_CHANGE")){
+        retention.tv_sec = clicon_option_int(h, "CLICON_STREAM_RETENTION");
+        if (stream_add(h, CONFIG_CHANGE_STREAM, "Configuration changes of commits to running",
+                       1, &retention) < 0)
+            goto done;
+    }
     retval = 0;
  done:
     return retval;
@@ -84,6 +84,7 @@ struct confirmed_commit {
     uint32_t    cc_session_id;       /* the session_id of the client that gave no <persist> value */
     int        (*cc_fn)(int, void*); /* function pointer for rollback event (rollback_fn()) */
     void        *cc_arg;             /* clixon_handle that will be passed to rollback_fn() */
+    cxobj       *cc_inverse;         /* Inverse edits of confirmed-commits, oldest first */
 };
 
 int
@@ -118,6 +119,8 @@ confirmed_commit_free(clixon_handle h)
     if (cc != NULL){
         if (cc->cc_persist_id != NULL)
             free (cc->cc_persist_id);
+        if (cc->cc_inverse != NULL)
+            xml_free(cc->cc_inverse);
         free(cc);
     }
     clicon_ptr_del(h, "confirmed-commit-struct");
@@ -293,6 +296,246 @@ xe_timeout(cxobj *xe)
     return 0;
 }
 
+/*! Get copy of node in inverse edit, create it and its ancestors if needed
+ *
+ * Only the node itself and its list keys are copied
+ * @param[in]  x     Node in source or target tree of transaction
+ * @param[in]  xinv  Inverse edit, corresponding to top of tree
+ * @param[out] xp    Copy of x in xinv
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+static int
+confirm_inverse_node(cxobj  *x,
+                     cxobj  *xinv,
+                     cxobj **xp)
+{
+    int        retval = -1;
+    cxobj     *xpp;
+    cxobj     *xc = NULL;
+    cxobj     *xk;
+    yang_stmt *y;
+    cg_var    *cvi;
+    char      *ns = NULL;
+    char      *pns = NULL;
+    int        i;
+
+    if (xml_parent(x) == NULL){
+        *xp = xinv;
+        goto ok;
+    }
+    if (confirm_inverse_node(xml_parent(x), xinv, &xpp) < 0)
+        goto done;
+    y = xml_spec(x);
+    /* Transaction vectors are in tree order: try last child first */
+    if ((i = xml_child_nr_type(xpp, CX_ELMNT)) > 0){
+        xc = xml_child_i_type(xpp, i-1, CX_ELMNT);
+        if (xml_spec(xc) != y || xml_cmp(x, xc, 0, 0, NULL) != 0){
+            xc = NULL;
+            while ((xc = xml_child_each(xpp, xc, CX_ELMNT)) != NULL)
+                if (xml_spec(xc) == y && xml_cmp(x, xc, 0, 0, NULL) == 0)
+                    break;
+        }
+    }
+    if (xc == NULL){
+        if ((xc = xml_new(xml_name(x), xpp, CX_ELMNT)) == NULL)
+            goto done;
+        xml_spec_set(xc, y);
+        if (xml2ns(x, xml_prefix(x), &ns) < 0)
+            goto done;
+        if (xml2ns(xpp, NULL, &pns) < 0)
+            goto done;
+        if (ns && clicon_strcmp(ns, pns) != 0 && xmlns_set(xc, NULL, ns) < 0)
+            goto done;
+        if (y && yang_keyword_get(y) == Y_LIST){
+            cvi = NULL;
+            while ((cvi = cvec_each(yang_cvec_get(y), cvi)) != NULL) {
+                if ((xk = xml_find_type(x, NULL, cv_string_get(cvi), CX_ELMNT)) == NULL)
+                    continue;
+                if ((xk = xml_dup(xk)) == NULL)
+                    goto done;
+                if (xml_addsub(xc, xk) < 0)
+                    goto done;
+            }
+        }
+    }
+    *xp = xc;
+ ok:
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Add node to inverse edit, either removed or with its old value
+ *
+ * @param[in]  x     Node in source (old value) or target (remove) tree of transaction
+ * @param[in]  xinv  Inverse edit
+ * @param[in]  old   If set, restore subtree of x, otherwise remove x
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+static int
+confirm_inverse_add(cxobj *x,
+                    cxobj *xinv,
+                    int    old)
+{
+    int        retval = -1;
+    yang_stmt *y;
+    cxobj     *xp;
+    cxobj     *xc;
+    cvec      *nsc = NULL;
+
+    y = xml_spec(x);
+    /* Old default value is removed, then it is set as default again */
+    if (old && xml_flag(x, XML_FLAG_DEFAULT))
+        old = 0;
+    if (!old && y &&
+        (yang_keyword_get(y) == Y_LIST || yang_keyword_get(y) == Y_CONTAINER)){
+        if (confirm_inverse_node(x, xinv, &xc) < 0)
+            goto done;
+    }
+    else {
+        if (confirm_inverse_node(xml_parent(x), xinv, &xp) < 0)
+            goto done;
+        if ((xc = xml_dup(x)) == NULL)
+            goto done;
+        if (xml_addsub(xp, xc) < 0)
+            goto done;
+        if (xml_tree_prune_flags(xc, XML_FLAG_DEFAULT, XML_FLAG_DEFAULT) < 0)
+            goto done;
+        if (xml_nsctx_node(x, &nsc) < 0)
+            goto done;
+        if (xmlns_set_all(xc, nsc) < 0)
+            goto done;
+    }
+    if (xml_add_attr(xc, "operation", old?"replace":"remove", NETCONF_BASE_PREFIX, NULL) == NULL)
+        goto done;
+    retval = 0;
+ done:
+    if (nsc)
+        cvec_free(nsc);
+    return retval;
+}
+
+/*! Add inverse edit of confirmed-commit transaction, made from its diff vectors
+ *
+ * Instead of copying running to the rollback database, the inverse edit of each
+ * confirmed-commit in a sequence is kept and applied on rollback.
+ * @param[in]  h     Clixon handle
+ * @param[in]  td    Transaction data, running not yet replaced
+ * @retval     1     OK, inverse edit added
+ * @retval     0     Changes cannot be inverted, eg moved ordered-by user entries
+ * @retval    -1     Error
+ * @see confirm_rollback_db
+ */
+static int
+confirm_inverse_append(clixon_handle       h,
+                       transaction_data_t *td)
+{
+    int                      retval = -1;
+    struct confirmed_commit *cc = NULL;
+    cxobj                   *xinv = NULL;
+    cxobj                  **vec[3];
+    size_t                   len[3];
+    yang_stmt               *y;
+    size_t                   i;
+    int                      j;
+
+    vec[0] = td->td_dvec; len[0] = td->td_dlen;
+    vec[1] = td->td_avec; len[1] = td->td_alen;
+    vec[2] = td->td_scvec; len[2] = td->td_clen;
+    for (j=0; j<3; j++)
+        for (i=0; i<len[j]; i++){
+            if ((y = xml_spec(vec[j][i])) == NULL)
+                goto fail;
+            if ((yang_keyword_get(y) == Y_LIST || yang_keyword_get(y) == Y_LEAF_LIST) &&
+                yang_find(y, Y_ORDERED_BY, "user") != NULL)
+                goto fail;
+        }
+    if ((xinv = xml_new(NETCONF_INPUT_CONFIG, NULL, CX_ELMNT)) == NULL)
+        goto done;
+    if (xmlns_set(xinv, NETCONF_BASE_PREFIX, NETCONF_BASE_NAMESPACE) < 0)
+        goto done;
+    for (j=0; j<3; j++)
+        for (i=0; i<len[j]; i++)
+            if (confirm_inverse_add(vec[j][i], xinv, j != 1) < 0)
+                goto done;
+    clicon_ptr_get(h, "confirmed-commit-struct", (void**)&cc);
+    if (cc->cc_inverse == NULL &&
+        (cc->cc_inverse = xml_new("inverse", NULL, CX_ELMNT)) == NULL)
+        goto done;
+    if (xml_addsub(cc->cc_inverse, xinv) < 0)
+        goto done;
+    xinv = NULL;
+    retval = 1;
+ done:
+    if (xinv)
+        xml_free(xinv);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! Remove inverse edits of confirmed-commits
+ *
+ * @param[in]  h     Clixon handle
+ */
+static void
+confirm_inverse_free(clixon_handle h)
+{
+    struct confirmed_commit *cc = NULL;
+
+    clicon_ptr_get(h, "confirmed-commit-struct", (void**)&cc);
+    if (cc->cc_inverse != NULL){
+        xml_free(cc->cc_inverse);
+        cc->cc_inverse = NULL;
+    }
+}
+
+/*! Create rollback database from running and inverse edits of confirmed-commits
+ *
+ * The inverse edits are applied newest first, and are then removed.
+ * @param[in]  h     Clixon handle
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+static int
+confirm_rollback_db(clixon_handle h)
+{
+    int                      retval = -1;
+    struct confirmed_commit *cc = NULL;
+    cbuf                    *cbret = NULL;
+    cxobj                   *xinv;
+    int                      i;
+    int                      ret;
+
+    if (xmldb_copy(h, "running", "rollback") < 0)
+        goto done;
+    clicon_ptr_get(h, "confirmed-commit-struct", (void**)&cc);
+    if (cc->cc_inverse != NULL){
+        if ((cbret = cbuf_new()) == NULL){
+            clixon_err(OE_UNIX, errno, "cbuf_new");
+            goto done;
+        }
+        for (i = xml_child_nr_type(cc->cc_inverse, CX_ELMNT) - 1; i >= 0; i--){
+            xinv = xml_child_i_type(cc->cc_inverse, i, CX_ELMNT);
+            if ((ret = xmldb_put(h, "rollback", OP_MERGE, xinv, NULL, cbret)) < 0)
+                goto done;
+            if (ret == 0){
+                clixon_err(OE_DB, 0, "Inverse edit of confirmed-commit failed: %s", cbuf_get(cbret));
+                goto done;
+            }
+        }
+    }
+    confirm_inverse_free(h);
+    retval = 0;
+ done:
+    if (cbret)
+        cbuf_free(cbret);
+    return retval;
+}
+
 /*! Cancel a scheduled rollback as previously registered by schedule_rollback_event()
  *
  * @param[in]   h       Clixon handle
@@ -391,7 +634,7 @@ cancel_confirmed_commit(clixon_handle h)
     }
 
     confirmed_commit_state_set(h, INACTIVE);
-
+    confirm_inverse_free(h);
     if (xmldb_delete(h, "rollback") < 0)
         clixon_err(OE_DB, 0, "Error deleting the rollback configuration");
     return 0;
@@ -477,21 +720,24 @@ check_valid_confirming_commit(clixon_handle h,
  * @param[in]   h          Clixon handle
  * @param[in]   xe         Commit rpc xml or NULL
  * @param[in]   myid       Current session-id, only valid > 0 if call is made as a result of an incoming message
+ * @param[in]   td         Transaction data of commit, before running is replaced, or NULL if not validated
  * @retval      0          OK
  * @retval     -1          Error
  * @note There are some calls to this function where myid is 0 (which is invalid). It is unclear if such calls
  *       actually occur, and if so, if they are correctly handled. The calls are from do_rollback() and load_failsafe()
  */
 int
-handle_confirmed_commit(clixon_handle h,
-                        cxobj        *xe,
-                        uint32_t      myid)
+handle_confirmed_commit(clixon_handle       h,
+                        cxobj              *xe,
+                        uint32_t            myid,
+                        transaction_data_t *td)
 {
     int           retval = -1;
     char         *persist;
     unsigned long confirm_timeout = 0L;
     int           cc_valid;
     int           db_exists;
+    int           ret;
 
     if (xe == NULL){
         clixon_err(OE_CFG, EINVAL, "xe is NULL");
@@ -588,10 +834,17 @@ handle_confirmed_commit(clixon_handle h,
             goto done;
         } else if (db_exists == 0) {
             // db does not yet exists
-            if (xmldb_copy(h, "running", "rollback") < 0) {
+            /* Keep inverse of this commit, or make rollback database of earlier ones */
+            ret = 0;
+            if (clicon_option_bool(h, "CLICON_CONFIRMED_COMMIT_INVERSE")){
+                ret = 1;
+                if (td != NULL && (ret = confirm_inverse_append(h, td)) < 0)
+                    goto done;
+            }
+            if (ret == 0 && confirm_rollback_db(h) < 0) {
                 clixon_err(OE_DAEMON, 0, "there was an error while copying the running configuration to rollback database.");
                 goto done;
-            };
+            }
         }
 
         if (schedule_rollback_event(h, confirm_timeout) < 0) {
@@ -604,6 +857,7 @@ handle_confirmed_commit(clixon_handle h,
         /* There was no subsequent confirmed-commit, meaning this is the end of the confirmed/confirming sequence;
          * The new configuration is already committed to running and the rollback database can now be deleted
          */
+        confirm_inverse_free(h);
         if (xmldb_delete(h, "rollback") < 0) {
             clixon_err(OE_DB, 0, "Error deleting the rollback configuration");
             goto done;
@@ -657,6 +911,19 @@ do_rollback(clixon_handle h,
         confirmed_commit_persist_id_set(h, NULL);
     }
     confirmed_commit_state_set(h, ROLLBACK);
+    /* Rollback database is made from running only when needed */
+    if (clicon_option_bool(h, "CLICON_CONFIRMED_COMMIT_INVERSE") &&
+        xmldb_exists(h, "rollback") != 1 &&
+        confirm_rollback_db(h) < 0) {
+        clixon_log(h, LOG_CRIT, "An error occurred creating the rollback database.");
+        errstate |= ROLLBACK_NOT_APPLIED;
+        if (load_failsafe(h, "Rollback") < 0) {
+            clixon_log(h, LOG_CRIT, "An error occurred committing the failsafe database.  Exiting.");
+            raise(SIGINT);
+        }
+        errstate |= ROLLBACK_FAILSAFE_APPLIED;
+        goto done;
+    }
     if (candidate_commit(h, NULL, "rollback", 0, 0, cbret) < 0) { /* Assume validation fail, nofatal */
         /* theoretically, this should never error, since the rollback database was previously active and therefore
          * had itself been previously and successfully committed.
@@ -41,10 +41,12 @@
 
 #include <stdio.h>
 #include <string.h>
+#define __USE_GNU /* for qsort_r or qsort_s */
 #include <stdlib.h>
 #include <unistd.h>
 #include <stdarg.h>
 #include <inttypes.h>
+#include <ctype.h>
 #include <errno.h>
 #include <signal.h>
 #include <fcntl.h>
@@ -102,32 +104,41 @@ filter_xpath_again(clixon_handle h,
                    cvec         *nsc)
 {
     int     retval = -1;
-    int     i;
 
     if (xret == NULL){
         clixon_err(OE_PLUGIN, EINVAL, "xret is NULL");
         goto done;
     }
-    /* If vectors are specified then mark the nodes found and
-     * then filter out everything else,
-     * otherwise return complete tree.
+    /* Filter out everything that is not found, unless xret itself is found.
+     * Only the paths to the nodes found are traversed
      */
-    if (xvec != NULL){
-        for (i=0; i<xlen; i++)
-            xml_flag_set(xvec[i], XML_FLAG_MARK);
-    }
-    /* Remove everything that is not marked */
-    if (!xml_flag(xret, XML_FLAG_MARK))
-        if (xml_tree_prune_flagged_sub(xret, XML_FLAG_MARK, 1, NULL) < 0)
-            goto done;
-    /* reset flag */
-    if (xml_apply(xret, CX_ELMNT, (xml_applyfn_t*)xml_flag_reset, (void*)XML_FLAG_MARK) < 0)
+    if (xml_tree_prune_marked(xret, xvec, xvec?xlen:0) < 0)
         goto done;
     retval = 0;
  done:
     return retval;
 }
 
+/*! Check if a get reply to a client is sent in binary format
+ *
+ * Only complete trees are encoded, depth and tagged defaults are printed as XML
+ * @param[in]  ce     Client entry
+ * @param[in]  depth  Nr of levels to print, -1 is all, 0 is none
+ * @param[in]  wdef   With-defaults parameter
+ * @retval     1      Reply in binary format
+ * @retval     0      Reply in XML
+ * @see CLIXON_BIN_CAPABILITY
+ */
+static int
+get_reply_binary(client_entry     *ce,
+                 int32_t           depth,
+                 withdefaults_type wdef)
+{
+    return ce != NULL && ce->ce_binary &&
+        depth == -1 &&
+        wdef != WITHDEFAULTS_REPORT_ALL_TAGGED;
+}
+
 /*! Help function for NACM access and return message
  *
  * @param[in]  h        Clixon handle
@@ -137,6 +148,7 @@ filter_xpath_again(clixon_handle h,
  * @param[in]  username User name for NACM access
  * @param[in]  depth    Nr of levels to print, -1 is all, 0 is none
  * @param[in]  wdef     With-defaults parameter
+ * @param[in]  binary   Reply in binary format, see get_reply_binary
  * @param[out] cbret    Return xml tree, eg <rpc-reply>..., <rpc-error..
  * @retval     0        OK
  * @retval    -1        Error
@@ -149,6 +161,7 @@ get_nacm_and_reply(clixon_handle     h,
                    char             *username,
                    int32_t           depth,
                    withdefaults_type wdef,
+                   int               binary,
                    cbuf             *cbret)
 {
     int     retval = -1;
@@ -156,6 +169,18 @@ get_nacm_and_reply(clixon_handle     h,
 
     /* Pre-NACM access step */
     xnacm = clicon_nacm_cache(h);
+    /* Denied subtrees are not printed, instead of pruned from the tree */
+    if (xnacm != NULL && !binary && xret != NULL &&
+        nacm_datanode_read_filtered(username, xnacm)){
+        cprintf(cbret, "<rpc-reply xmlns=\"%s\">", NETCONF_BASE_NAMESPACE);
+        if (xml_name_set(xret, NETCONF_OUTPUT_DATA) < 0)
+            goto done;
+        if (nacm_datanode_read_filter(h, cbret, xret, username, xnacm,
+                                      depth>0?depth+1:depth, wdef) < 0)
+            goto done;
+        cprintf(cbret, "</rpc-reply>");
+        goto ok;
+    }
     if (xnacm != NULL){ /* Do NACM validation */
         /* NACM datanode/module read validation */
         if (nacm_datanode_read1(h, xret, username, xnacm) < 0)
@@ -163,6 +188,11 @@ get_nacm_and_reply(clixon_handle     h,
         if (nacm_datanode_read_prune(h, xret) < 0)
             goto done;
     }
+    if (binary){
+        if (clixon_xml2bin_reply(cbret, xret, clicon_dbspec_yang(h), wdef, 0) < 0)
+            goto done;
+        goto ok;
+    }
     cprintf(cbret, "<rpc-reply xmlns=\"%s\">", NETCONF_BASE_NAMESPACE);     /* OK */
     if (xret==NULL)
         cprintf(cbret, "<data/>");
@@ -174,11 +204,101 @@ get_nacm_and_reply(clixon_handle     h,
             goto done;
     }
     cprintf(cbret, "</rpc-reply>");
+ ok:
     retval = 0;
  done:
     return retval;
 }
 
+/*! Get config and reply by reading the datastore cache directly, without copying it
+ *
+ * Only used if the result is not modified, ie no NACM, system-only-config or
+ * NACM disabled on empty config.
+ * @param[in]  h        Clixon handle
+ * @param[in]  db       Database name
+ * @param[in]  xpath    XPath point to object to get
+ * @param[in]  nsc      Namespace context of xpath
+ * @param[in]  depth    Nr of levels to print, -1 is all, 0 is none
+ * @param[in]  wdef     With-defaults parameter
+ * @param[in]  binary   Reply in binary format, see get_reply_binary
+ * @param[out] cbret    Return xml tree, eg <rpc-reply>..., <rpc-error..
+ * @retval     1        OK, reply in cbret
+ * @retval     0        Error reply in cbret
+ * @retval    -1        Error
+ * @see get_nacm_and_reply
+ */
+static int
+get_config_borrow(clixon_handle     h,
+                  char             *db,
+                  char             *xpath,
+                  cvec             *nsc,
+                  int32_t           depth,
+                  withdefaults_type wdef,
+                  int               binary,
+                  cbuf             *cbret)
+{
+    int       retval = -1;
+    cxobj    *xt = NULL;
+    cxobj   **xvec = NULL;
+    size_t    xlen = 0;
+    uint64_t  gen = 0;
+    cxobj    *xerr = NULL;
+    cbuf     *cbmsg = NULL;
+    size_t    len;
+    int       ret;
+
+    if ((ret = xmldb_get_borrow(h, db, nsc, xpath?xpath:"/", &xt, &xvec, &xlen, &gen, &xerr)) < 0){
+        if ((cbmsg = cbuf_new()) == NULL){
+            clixon_err(OE_UNIX, errno, "cbuf_new");
+            goto done;
+        }
+        cprintf(cbmsg, "Get %s datastore: %s", db, clixon_err_reason());
+        if (netconf_operation_failed(cbret, "application", "%s", cbuf_get(cbmsg)) < 0)
+            goto done;
+        goto fail;
+    }
+    if (ret == 0){
+        if (clixon_xml2cbuf1(cbret, xerr, 0, 0, NULL, -1, 0, 0, WITHDEFAULTS_REPORT_ALL) < 0)
+            goto done;
+        goto fail;
+    }
+    if (binary){
+        if (clixon_xml2bin_reply(cbret, xt, clicon_dbspec_yang(h), wdef, 1) < 0)
+            goto done;
+        retval = 1;
+        goto done;
+    }
+    cprintf(cbret, "<rpc-reply xmlns=\"%s\">", NETCONF_BASE_NAMESPACE);
+    if (depth != 0){
+        cprintf(cbret, "<%s>", NETCONF_OUTPUT_DATA);
+        len = clixon_xml2cbuf_pos(cbret);
+        /* Top level is data */
+        if (clixon_xml2cbuf_marked(cbret, xt, 0, 0, depth, 1, wdef) < 0)
+            goto done;
+        if (clixon_xml2cbuf_pos(cbret) == len){ /* Nothing printed, not streamed */
+            cbuf_trunc(cbret, cbuf_len(cbret)-1);
+            cprintf(cbret, "/>");
+        }
+        else
+            cprintf(cbret, "</%s>", NETCONF_OUTPUT_DATA);
+    }
+    cprintf(cbret, "</rpc-reply>");
+    retval = 1;
+ done:
+    if (xvec){
+        if (xmldb_get_release(h, db, xvec, xlen, gen) < 0)
+            retval = -1;
+    }
+    if (cbmsg)
+        cbuf_free(cbmsg);
+    if (xerr)
+        xml_free(xerr);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
 /*! Help function for parsing restconf query parameter and setting netconf attribute
  *
  * Parse and set a uint32 numeric value,
@@ -241,6 +361,372 @@ list_pagination_hdr(clixon_handle h,
     return retval;
 }
 
+/*! Encode list-pagination cursor of a list or leaf-list entry
+ *
+ * The cursor is the key values of a list entry, or the value of a leaf-list entry,
+ * percent-encoded and separated by ','. It is opaque to clients.
+ * @param[in]  x      List or leaf-list entry
+ * @param[in]  ylist  Yang of list or leaf-list
+ * @param[out] cb     Cursor is appended
+ * @retval     0      OK
+ * @retval    -1      Error
+ * @see list_pagination_cursor_decode
+ */
+static int
+list_pagination_cursor_encode(cxobj     *x,
+                              yang_stmt *ylist,
+                              cbuf      *cb)
+{
+    int     retval = -1;
+    cg_var *cvi = NULL;
+    char   *body;
+    char   *enc = NULL;
+
+    if (yang_keyword_get(ylist) == Y_LEAF_LIST){
+        if ((body = xml_body(x)) == NULL)
+            body = "";
+        if (uri_percent_encode(&enc, "%s", body) < 0)
+            goto done;
+        cprintf(cb, "%s", enc);
+    }
+    else
+        while ((cvi = cvec_each(yang_cvec_get(ylist), cvi)) != NULL){
+            if ((body = xml_find_body(x, cv_string_get(cvi))) == NULL)
+                body = "";
+            if (uri_percent_encode(&enc, "%s", body) < 0)
+                goto done;
+            cprintf(cb, "%s%s", cbuf_len(cb)?",":"", enc);
+            free(enc);
+            enc = NULL;
+        }
+    retval = 0;
+ done:
+    if (enc)
+        free(enc);
+    return retval;
+}
+
+/*! Decode list-pagination cursor to a key entry
+ *
+ * @param[in]  cursor Cursor as encoded by list_pagination_cursor_encode
+ * @param[in]  ylist  Yang of list or leaf-list
+ * @param[out] xkp    List or leaf-list entry with key values only, free with xml_free
+ * @retval     1      OK
+ * @retval     0      Invalid cursor, wrong number or type of key values
+ * @retval    -1      Error
+ */
+static int
+list_pagination_cursor_decode(char       *cursor,
+                              yang_stmt  *ylist,
+                              cxobj     **xkp)
+{
+    int        retval = -1;
+    cxobj     *xk = NULL;
+    cxobj     *xb;
+    cvec      *cvk;
+    cg_var    *cvi = NULL;
+    cg_var    *cv = NULL;
+    yang_stmt *yk;
+    char     **vec = NULL;
+    int        nvec = 0;
+    char      *str = NULL;
+    char      *reason = NULL;
+    int        i;
+    int        ret;
+
+    if ((vec = clixon_strsep1(cursor, ",", &nvec)) == NULL)
+        goto done;
+    if (yang_keyword_get(ylist) == Y_LEAF_LIST)
+        cvk = NULL;
+    else if ((cvk = yang_cvec_get(ylist)) == NULL)
+        goto fail;
+    if (nvec != (cvk ? cvec_len(cvk) : 1))
+        goto fail;
+    if ((xk = xml_new(yang_argument_get(ylist), NULL, CX_ELMNT)) == NULL)
+        goto done;
+    xml_spec_set(xk, ylist);
+    for (i=0; i<nvec; i++){
+        if (uri_percent_decode(vec[i], &str) < 0)
+            goto done;
+        if (cvk == NULL){
+            yk = ylist;
+            if ((xb = xml_new("body", xk, CX_BODY)) == NULL ||
+                xml_value_set(xb, str) < 0)
+                goto done;
+        }
+        else {
+            cvi = cvec_i(cvk, i);
+            if ((yk = yang_find(ylist, Y_LEAF, cv_string_get(cvi))) == NULL)
+                goto fail;
+            if ((xb = xml_new_body(cv_string_get(cvi), xk, str)) == NULL)
+                goto done;
+            xml_spec_set(xb, yk);
+        }
+        /* Check value against type, compared as typed values in the search */
+        if (yang_cv_get(yk) != NULL){
+            if ((cv = cv_dup(yang_cv_get(yk))) == NULL){
+                clixon_err(OE_UNIX, errno, "cv_dup");
+                goto done;
+            }
+            if ((ret = cv_parse1(str, cv, &reason)) < 0){
+                clixon_err(OE_UNIX, errno, "cv_parse1");
+                goto done;
+            }
+            if (ret == 0)
+                goto fail;
+            cv_free(cv);
+            cv = NULL;
+        }
+        free(str);
+        str = NULL;
+    }
+    *xkp = xk;
+    xk = NULL;
+    retval = 1;
+ done:
+    if (reason)
+        free(reason);
+    if (cv)
+        cv_free(cv);
+    if (str)
+        free(str);
+    if (vec)
+        free(vec);
+    if (xk)
+        xml_free(xk);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! Binary search for list or leaf-list entries among the sorted children of a parent
+ *
+ * @param[in]  xp     Parent
+ * @param[in]  ylist  Yang of list or leaf-list
+ * @param[in]  xk     Key entry, or NULL to compare yang order only
+ * @param[in]  low    Lower index of search interval
+ * @param[in]  upper  Upper index of search interval (exclusive)
+ * @param[in]  after  If set, first child after xk, else first child not before xk
+ * @retval     i      Index of child, upper if none
+ * @note Only applicable to system-ordered lists
+ */
+static int
+list_pagination_bound(cxobj     *xp,
+                      yang_stmt *ylist,
+                      cxobj     *xk,
+                      int        low,
+                      int        upper,
+                      int        after)
+{
+    int        yi;
+    int        mid;
+    int        cmp;
+    cxobj     *xc;
+    yang_stmt *yc;
+
+    yi = yang_order(ylist);
+    while (low < upper){
+        mid = (low + upper) / 2;
+        xc = xml_child_i(xp, mid);
+        if (xml_type(xc) != CX_ELMNT || (yc = xml_spec(xc)) == NULL)
+            cmp = 1; /* Attributes and unbound children are sorted first */
+        else if ((cmp = yi - yang_order(yc)) == 0 && xk != NULL)
+            cmp = xml_cmp(xk, xc, 0, 0, NULL);
+        if (cmp > 0 || (cmp == 0 && after))
+            low = mid + 1;
+        else
+            upper = mid;
+    }
+    return low;
+}
+
+/*! Get xpath of the parent of a list if the last step of the list xpath is a plain name
+ *
+ * @param[in]  xpath   XPath of list
+ * @param[out] xpath0  XPath of list parent, malloced, free after use
+ * @retval     1       OK
+ * @retval     0       No parent or last step is not a plain name, eg has predicates
+ * @retval    -1       Error
+ */
+static int
+list_pagination_parent_xpath(char  *xpath,
+                             char **xpath0)
+{
+    char *p;
+
+    if (xpath == NULL ||
+        (p = strrchr(xpath, '/')) == NULL || p == xpath || *(p+1) == '\0')
+        return 0;
+    if (strspn(p+1, "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789_-.:") != strlen(p+1))
+        return 0;
+    if ((*xpath0 = strndup(xpath, p-xpath)) == NULL){
+        clixon_err(OE_UNIX, errno, "strndup");
+        return -1;
+    }
+    return 1;
+}
+
+/*! Get list-pagination of a config list by reading the datastore cache directly
+ *
+ * The list is not copied. The first entry after the cursor is found with binary search among
+ * the sorted children of the list parent, offset and limit are then applied by index and only
+ * the entries of the page are marked and printed.
+ * Only applicable if the last step of xpath is a plain name of a system-ordered list with a
+ * single parent, and if the result is not modified, see get_config_borrow.
+ * @param[in]  h       Clixon handle
+ * @param[in]  db      Database name
+ * @param[in]  ylist   Yang of list or leaf-list
+ * @param[in]  xpath   XPath of list
+ * @param[in]  nsc     Namespace context of xpath
+ * @param[in]  depth   Nr of levels to print, -1 is all, 0 is none
+ * @param[in]  wdef    With-defaults parameter
+ * @param[in]  xk      Key entry of cursor, or NULL
+ * @param[in]  offset  Nr of entries skipped after cursor
+ * @param[in]  limit   Max nr of entries, 0 is unbounded
+ * @param[out] cbret   Return xml tree, eg <rpc-reply>..., <rpc-error..
+ * @retval     1       OK, reply or error reply in cbret
+ * @retval     0       Not applicable, cbret not changed
+ * @retval    -1       Error
+ */
+static int
+get_list_pagination_borrow(clixon_handle     h,
+                           char             *db,
+                           yang_stmt        *ylist,
+                           char             *xpath,
+                           cvec             *nsc,
+                           int32_t           depth,
+                           withdefaults_type wdef,
+                           cxobj            *xk,
+                           uint32_t          offset,
+                           uint32_t          limit,
+                           cbuf             *cbret)
+{
+    int       retval = -1;
+    char     *xpath0 = NULL;
+    cxobj    *xt = NULL;
+    cxobj   **xvec = NULL;
+    size_t    xlen = 0;
+    uint64_t  gen = 0;
+    cxobj    *xerr = NULL;
+    cxobj    *xp = NULL;
+    cxobj    *x;
+    cxobj    *xa = NULL;
+    cxobj    *xns = NULL;
+    char     *ns = NULL;
+    cbuf     *cb = NULL;
+    int       start = 0;
+    int       end = 0;
+    int       upper = 0;
+    int       i;
+    size_t    len;
+    int       ret;
+
+    if ((ret = list_pagination_parent_xpath(xpath, &xpath0)) < 0)
+        goto done;
+    if (ret == 0)
+        goto notapplicable;
+    if ((cb = cbuf_new()) == NULL){
+        clixon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    if ((ret = xmldb_get_borrow(h, db, nsc, xpath0, &xt, &xvec, &xlen, &gen, &xerr)) < 0){
+        cprintf(cb, "Get %s datastore: %s", db, clixon_err_reason());
+        if (netconf_operation_failed(cbret, "application", "%s", cbuf_get(cb)) < 0)
+            goto done;
+        goto ok;
+    }
+    if (ret == 0){
+        if (clixon_xml2cbuf1(cbret, xerr, 0, 0, NULL, -1, 0, 0, WITHDEFAULTS_REPORT_ALL) < 0)
+            goto done;
+        goto ok;
+    }
+    if (xlen != 1)
+        goto notapplicable;
+    xp = xvec[0];
+    /* Entries are contiguous and sorted by key among the children of the parent */
+    end = xml_child_nr(xp);
+    start = list_pagination_bound(xp, ylist, NULL, 0, end, 0);
+    end = list_pagination_bound(xp, ylist, NULL, start, end, 1);
+    if (xk)
+        start = list_pagination_bound(xp, ylist, xk, start, end, 1);
+    if (offset > end - start)
+        start = end;
+    else
+        start += offset;
+    if (limit == 0 || limit > end - start)
+        upper = end;
+    else
+        upper = start + limit;
+    /* Print only the entries of the page, not the whole parent */
+    xml_flag_reset(xp, XML_FLAG_MARK);
+    if (start < upper)
+        xml_flag_set(xp, XML_FLAG_CHANGE);
+    else
+        xml_apply_ancestor(xp, (xml_applyfn_t*)xml_flag_reset, (void*)XML_FLAG_CHANGE);
+    for (i=start; i<upper; i++)
+        xml_flag_set(xml_child_i(xp, i), XML_FLAG_MARK);
+    /* Annotate last entry with next cursor if entries remain. Temporary, removed after print */
+    if (start < upper && upper < end){
+        x = xml_child_i(xp, upper-1);
+        cbuf_reset(cb);
+        if (list_pagination_cursor_encode(x, ylist, cb) < 0)
+            goto done;
+        if ((xa = xml_new("next", x, CX_ATTR)) == NULL)
+            goto done;
+        if (xml_prefix_set(xa, "lp") < 0 ||
+            xml_value_set(xa, cbuf_get(cb)) < 0)
+            goto done;
+        if (xml2ns(x, "lp", &ns) < 0)
+            goto done;
+        if (ns == NULL){
+            if (xmlns_set(x, "lp", IETF_PAGINATON_NAMESPACE) < 0)
+                goto done;
+            xns = xml_find_type(x, "xmlns", "lp", CX_ATTR);
+        }
+    }
+    cprintf(cbret, "<rpc-reply xmlns=\"%s\">", NETCONF_BASE_NAMESPACE);
+    if (depth != 0){
+        cprintf(cbret, "<%s>", NETCONF_OUTPUT_DATA);
+        len = clixon_xml2cbuf_pos(cbret);
+        if (clixon_xml2cbuf_marked(cbret, xt, 0, 0, depth, 1, wdef) < 0)
+            goto done;
+        if (clixon_xml2cbuf_pos(cbret) == len){ /* Nothing printed, not streamed */
+            cbuf_trunc(cbret, cbuf_len(cbret)-1);
+            cprintf(cbret, "/>");
+        }
+        else
+            cprintf(cbret, "</%s>", NETCONF_OUTPUT_DATA);
+    }
+    cprintf(cbret, "</rpc-reply>");
+ ok:
+    retval = 1;
+ done:
+    if (xp){
+        for (i=start; i<upper; i++)
+            xml_flag_reset(xml_child_i(xp, i), XML_FLAG_MARK);
+        xml_flag_reset(xp, XML_FLAG_CHANGE);
+    }
+    if (xa && xml_purge(xa) < 0)
+        retval = -1;
+    if (xns && xml_purge(xns) < 0)
+        retval = -1;
+    if (xvec){
+        if (xmldb_get_release(h, db, xvec, xlen, gen) < 0)
+            retval = -1;
+    }
+    if (cb)
+        cbuf_free(cb);
+    if (xerr)
+        xml_free(xerr);
+    if (xpath0)
+        free(xpath0);
+    return retval;
+ notapplicable:
+    retval = 0;
+    goto done;
+}
+
 /*! Special handling of state data for partial reading
  *
  * @param[in]  h       Clixon handle
@@ -336,6 +822,380 @@ get_pagination_state_partial(clixon_handle h,
     goto done;
 }
 
+#ifdef XML_EXPLICIT_INDEX
+/*! Parse a where expression comparing an indexed leaf of a list with a literal
+ *
+ * Only the form <leaf> <op> <literal> is recognized, where op is =, <, <=, > or >=.
+ * A number is compared with a numeric leaf, and a string literal only for equality with
+ * a string leaf, so that the search index order gives the same result as XPath.
+ * @param[in]  where   XPath expression of where parameter
+ * @param[in]  nsc     Namespace context of where
+ * @param[in]  ylist   Yang of list
+ * @param[out] yleafp  Yang of indexed leaf
+ * @param[out] op      Comparison operator
+ * @param[out] valp    Literal value, malloced, free after use
+ * @retval     1       OK
+ * @retval     0       Not a simple comparison of an indexed leaf
+ * @retval    -1       Error
+ */
+static int
+list_pagination_where_parse(char       *where,
+                            cvec       *nsc,
+                            yang_stmt  *ylist,
+                            yang_stmt **yleafp,
+                            char        op[3],
+                            char      **valp)
+{
+    int          retval = -1;
+    char        *p;
+    char        *q;
+    char        *name = NULL;
+    char        *prefix = NULL;
+    char        *id = NULL;
+    char        *ns;
+    char        *val = NULL;
+    int          quoted = 0;
+    int          numeric;
+    yang_stmt   *yleaf;
+    cg_var      *ycv;
+    cg_var      *cv = NULL;
+    enum cv_type cvtype;
+    char        *reason = NULL;
+    int          ret;
+
+    p = where;
+    while (isspace(*p))
+        p++;
+    for (q = p; *p && (isalnum(*p) || strchr("_-.:", *p)); p++);
+    if (p == q)
+        goto fail;
+    if ((name = strndup(q, p-q)) == NULL){
+        clixon_err(OE_UNIX, errno, "strndup");
+        goto done;
+    }
+    if (nodeid_split(name, &prefix, &id) < 0)
+        goto done;
+    if (prefix &&
+        ((ns = xml_nsctx_get(nsc, prefix)) == NULL ||
+         strcmp(ns, yang_find_mynamespace(ylist)) != 0))
+        goto fail;
+    if ((yleaf = yang_find(ylist, Y_LEAF, id)) == NULL ||
+        yang_flag_get(yleaf, YANG_FLAG_INDEX) == 0)
+        goto fail;
+    while (isspace(*p))
+        p++;
+    memset(op, 0, 3);
+    if (*p != '=' && *p != '<' && *p != '>')
+        goto fail;
+    op[0] = *p++;
+    if (op[0] != '=' && *p == '=')
+        op[1] = *p++;
+    while (isspace(*p))
+        p++;
+    if (*p == '\'' || *p == '"'){
+        if ((q = strchr(p+1, *p)) == NULL)
+            goto fail;
+        quoted++;
+        p++;
+    }
+    else {
+        q = p;
+        if (*q == '-')
+            q++;
+        while (isdigit(*q) || *q == '.')
+            q++;
+    }
+    if (q == p || (val = strndup(p, q-p)) == NULL){
+        if (q != p)
+            clixon_err(OE_UNIX, errno, "strndup");
+        goto fail;
+    }
+    p = quoted ? q+1 : q;
+    while (isspace(*p))
+        p++;
+    if (*p != '\0')
+        goto fail;
+    if ((ycv = yang_cv_get(yleaf)) == NULL)
+        goto fail;
+    cvtype = cv_type_get(ycv);
+    numeric = cv_isint(cvtype) || cvtype == CGV_DEC64;
+    if (numeric ? quoted : (!quoted || cvtype != CGV_STRING || op[0] != '='))
+        goto fail;
+    /* Literal is compared as a value of the leaf type in the search index */
+    if ((cv = cv_dup(ycv)) == NULL){
+        clixon_err(OE_UNIX, errno, "cv_dup");
+        goto done;
+    }
+    if ((ret = cv_parse1(val, cv, &reason)) < 0){
+        clixon_err(OE_UNIX, errno, "cv_parse1");
+        goto done;
+    }
+    if (ret == 0)
+        goto fail;
+    *yleafp = yleaf;
+    *valp = val;
+    val = NULL;
+    retval = 1;
+ done:
+    if (reason)
+        free(reason);
+    if (cv)
+        cv_free(cv);
+    if (val)
+        free(val);
+    if (name)
+        free(name);
+    if (prefix)
+        free(prefix);
+    if (id)
+        free(id);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! Binary search in a search index vector
+ *
+ * @param[in]  xv       Search index vector
+ * @param[in]  xprobe   List entry with index variable only
+ * @param[in]  indexvar Name of index variable
+ * @param[in]  after    If set, first entry after xprobe, else first entry not before xprobe
+ * @retval     i        Position in xv
+ */
+static int
+list_pagination_index_bound(clixon_xvec *xv,
+                            cxobj       *xprobe,
+                            char        *indexvar,
+                            int          after)
+{
+    int low = 0;
+    int upper = clixon_xvec_len(xv);
+    int mid;
+    int cmp;
+
+    while (low < upper){
+        mid = (low + upper) / 2;
+        cmp = xml_cmp(xprobe, clixon_xvec_i(xv, mid), 0, 0, indexvar);
+        if (cmp > 0 || (cmp == 0 && after))
+            low = mid + 1;
+        else
+            upper = mid;
+    }
+    return low;
+}
+
+/*! Compare list entries by sort-by index variable, if any, then by key
+ */
+static int
+list_pagination_index_cmp(const void *arg1,
+                          const void *arg2,
+                          void       *indexvar)
+{
+    cxobj *x1 = *(cxobj**)arg1;
+    cxobj *x2 = *(cxobj**)arg2;
+    int    cmp = 0;
+
+    if (indexvar)
+        cmp = xml_cmp(x1, x2, 0, 0, indexvar);
+    if (cmp == 0)
+        cmp = xml_cmp(x1, x2, 0, 0, NULL);
+    return cmp;
+}
+
+/*! Copy a list-pagination page of a config list selected using search indexes
+ *
+ * A where expression comparing an indexed leaf with a literal is a range of the search index
+ * of that leaf. Without where, a sort-by of an indexed leaf walks its search index directly.
+ * Only the entries of the page are copied from the datastore cache, in key order and marked
+ * with XML_FLAG_MARK. Sort-by and direction of the page itself is made by the caller.
+ * @param[in]  h         Clixon handle
+ * @param[in]  db        Database name
+ * @param[in]  ylist     Yang of system-ordered config list
+ * @param[in]  xpath     XPath of list
+ * @param[in]  nsc       Namespace context of xpath
+ * @param[in]  where     Where expression, or NULL
+ * @param[in]  wherens   Namespace context of where
+ * @param[in]  sort_by   Sort-by, or NULL
+ * @param[in]  direction NULL means forwards
+ * @param[in]  offset    Start of page
+ * @param[in]  limit     Max nr of entries, 0 is unbounded
+ * @param[out] xretp     Result tree with page, free with xml_free
+ * @retval     1         OK
+ * @retval     0         Not applicable, no usable search index
+ * @retval    -1         Error
+ * @see xml_search_vector_get
+ */
+static int
+get_list_pagination_index(clixon_handle h,
+                          char         *db,
+                          yang_stmt    *ylist,
+                          char         *xpath,
+                          cvec         *nsc,
+                          char         *where,
+                          cvec         *wherens,
+                          char         *sort_by,
+                          char         *direction,
+                          uint32_t      offset,
+                          uint32_t      limit,
+                          cxobj       **xretp)
+{
+    int          retval = -1;
+    char        *xpath0 = NULL;
+    cxobj       *xt = NULL;
+    cxobj      **xvec = NULL;
+    size_t       xlen = 0;
+    uint64_t     gen = 0;
+    cxobj       *xerr = NULL;
+    cxobj       *xp = NULL;
+    cxobj       *xpc;
+    cxobj       *x;
+    cxobj       *xret = NULL;
+    cxobj       *xprobe = NULL;
+    cxobj       *xb;
+    cxobj      **vec = NULL;  /* Entries matching where */
+    clixon_xvec *xv = NULL;   /* Search index */
+    yang_stmt   *yleaf = NULL;
+    yang_stmt   *ysort = NULL;
+    char         op[3] = {0,};
+    char        *val = NULL;
+    char        *p;
+    int          n;
+    int          len = 0;
+    int          lo;
+    int          hi;
+    int          i;
+    uint32_t     start = 0;
+    uint32_t     upper = 0;
+    int          ret;
+
+    if (sort_by &&
+        (ysort = yang_find(ylist, Y_LEAF, (p = strchr(sort_by, ':')) ? p+1 : sort_by)) != NULL &&
+        yang_flag_get(ysort, YANG_FLAG_INDEX) == 0)
+        ysort = NULL;
+    if (where){
+        if ((ret = list_pagination_where_parse(where, wherens, ylist, &yleaf, op, &val)) < 0)
+            goto done;
+        if (ret == 0)
+            goto notapplicable;
+    }
+    else if (ysort == NULL)
+        goto notapplicable;
+    if ((ret = list_pagination_parent_xpath(xpath, &xpath0)) < 0)
+        goto done;
+    if (ret == 0)
+        goto notapplicable;
+    if ((ret = xmldb_get_borrow(h, db, nsc, xpath0, &xt, &xvec, &xlen, &gen, &xerr)) < 0)
+        goto done;
+    if (ret == 0 || xlen != 1)
+        goto notapplicable;
+    xp = xvec[0];
+    /* Nr of list entries */
+    n = xml_child_nr(xp);
+    lo = list_pagination_bound(xp, ylist, NULL, 0, n, 0);
+    n = list_pagination_bound(xp, ylist, NULL, lo, n, 1) - lo;
+    if (yleaf){
+        if (xml_search_vector_get(xp, yang_argument_get(yleaf), &xv) < 0)
+            goto done;
+        if (xv == NULL)
+            goto notapplicable;
+        /* Range of matching entries in the search index */
+        if ((xprobe = xml_new(yang_argument_get(ylist), NULL, CX_ELMNT)) == NULL)
+            goto done;
+        xml_spec_set(xprobe, ylist);
+        if ((xb = xml_new_body(yang_argument_get(yleaf), xprobe, val)) == NULL)
+            goto done;
+        xml_spec_set(xb, yleaf);
+        lo = 0;
+        hi = clixon_xvec_len(xv);
+        if (op[0] == '>' || op[0] == '=')
+            lo = list_pagination_index_bound(xv, xprobe, yang_argument_get(yleaf), op[0] == '>' && op[1] == '\0');
+        if (op[0] == '<' || op[0] == '=')
+            hi = list_pagination_index_bound(xv, xprobe, yang_argument_get(yleaf), op[0] == '=' || op[1] == '=');
+        if (hi > lo){
+            if ((vec = calloc(hi - lo, sizeof(cxobj *))) == NULL){
+                clixon_err(OE_UNIX, errno, "calloc");
+                goto done;
+            }
+            for (i=lo; i<hi; i++)
+                if (xml_spec(x = clixon_xvec_i(xv, i)) == ylist)
+                    vec[len++] = x;
+        }
+        /* Order of working result-set */
+        if (len > 1 && (ysort == NULL || ysort != yleaf)){
+#ifdef HAVE_QSORT_S
+            qsort_s(vec, len, sizeof(cxobj *), list_pagination_index_cmp, sort_by);
+#else
+            qsort_r(vec, len, sizeof(cxobj *), list_pagination_index_cmp, sort_by);
+#endif
+        }
+    }
+    else {
+        if (xml_search_vector_get(xp, yang_argument_get(ysort), &xv) < 0)
+            goto done;
+        /* Entries without the index variable are not in the search index */
+        if (xv == NULL || clixon_xvec_len(xv) != n)
+            goto notapplicable;
+        len = n;
+    }
+    start = offset < len ? offset : len;
+    if (limit == 0 || limit > len - start)
+        upper = len;
+    else
+        upper = start + limit;
+    if ((xret = xml_new(DATASTORE_TOP_SYMBOL, NULL, CX_ELMNT)) == NULL)
+        goto done;
+    if (start < upper){
+        /* Copy only the marked page and the path to it */
+        xml_flag_reset(xp, XML_FLAG_MARK);
+        xml_flag_set(xp, XML_FLAG_CHANGE);
+        for (i=start; i<upper; i++){
+            n = direction ? len-1-i : i;
+            xml_flag_set(vec ? vec[n] : clixon_xvec_i(xv, n), XML_FLAG_MARK);
+        }
+        if (xml_copy_marked(xt, xret) < 0)
+            goto done;
+        if ((xpc = xpath_first(xret, nsc, "%s", xpath0)) != NULL){
+            x = NULL;
+            while ((x = xml_child_each(xpc, x, CX_ELMNT)) != NULL)
+                if (xml_spec(x) == ylist)
+                    xml_flag_set(x, XML_FLAG_MARK);
+        }
+    }
+    *xretp = xret;
+    xret = NULL;
+    retval = 1;
+ done:
+    if (xp && start < upper){
+        for (i=start; i<upper; i++){
+            n = direction ? len-1-i : i;
+            xml_flag_reset(vec ? vec[n] : clixon_xvec_i(xv, n), XML_FLAG_MARK);
+        }
+        xml_flag_reset(xp, XML_FLAG_CHANGE);
+    }
+    if (xvec){
+        if (xmldb_get_release(h, db, xvec, xlen, gen) < 0)
+            retval = -1;
+    }
+    if (xret)
+        xml_free(xret);
+    if (vec)
+        free(vec);
+    if (xprobe)
+        xml_free(xprobe);
+    if (val)
+        free(val);
+    if (xerr)
+        xml_free(xerr);
+    if (xpath0)
+        free(xpath0);
+    return retval;
+ notapplicable:
+    retval = 0;
+    goto done;
+}
+#endif /* XML_EXPLICIT_INDEX */
+
 /*! Specialized get for list-pagination
  *
  * It is specialized enough to have its own function. Specifically, extra attributes as well
@@ -398,6 +1258,9 @@ get_list_pagination(clixon_handle     h,
     char      *sort_by = NULL;
     char      *direction = NULL;
     char      *where = NULL;
+    char      *cursor;
+    cxobj     *xk = NULL;  /* Key entry of cursor */
+    int        indexed = 0; /* Page selected using search indexes */
     int        i;
     int        j;
     dispatcher_entry_t *htable = NULL;
@@ -483,17 +1346,61 @@ get_list_pagination(clixon_handle     h,
         if (strcmp(direction, "forwards") == 0)
             direction = NULL;
     }
-    /* the "offset" parameter (see Section 3.1.5) or
-       NYI: the "cursor" parameter (see Section 3.1.6)
+    /* the "offset" parameter (see Section 3.1.5) and/or
+       the "cursor" parameter (see Section 3.1.6)
        lastly "the "limit" parameter (see Section 3.1.7) */
     if ((ret = list_pagination_hdr(h, xe, &offset, &limit, cbret)) < 0)
         goto done;
     if (ret == 0)
         goto ok;
+    /* Cursor is the key of the last entry of the previous page, offset is applied after it */
+    if ((x = xml_find_type(xe, NULL, "cursor", CX_ELMNT)) != NULL &&
+        (cursor = xml_body(x)) != NULL){
+        if ((ret = list_pagination_cursor_decode(cursor, ylist, &xk)) < 0)
+            goto done;
+        if (ret == 0 || partial_pagination_cb){
+            if (netconf_invalid_value(cbret, "application", "cursor-not-found") < 0)
+                goto done;
+            goto ok;
+        }
+    }
+    /* Read the page directly from the datastore cache if possible */
+    if (content == CONTENT_CONFIG &&
+        where == NULL && sort_by == NULL && direction == NULL &&
+        yang_find(ylist, Y_ORDERED_BY, "user") == NULL &&
+        clicon_nacm_cache(h) == NULL &&
+        !clicon_option_bool_id(h, CO_XMLDB_SYSTEM_ONLY_CONFIG) &&
+        !clicon_option_bool_id(h, CO_NACM_DISABLED_ON_EMPTY) &&
+        !get_reply_binary(ce, depth, wdef)){
+        if ((ret = get_list_pagination_borrow(h, db, ylist, xpath, nsc, depth, wdef,
+                                              xk, offset, limit, cbret)) < 0)
+            goto done;
+        if (ret == 1)
+            goto ok;
+    }
     /* Read config */
     switch (content){
     case CONTENT_CONFIG:    /* config data only */
     case CONTENT_ALL:       /* both config and state */
+#ifdef XML_EXPLICIT_INDEX
+        /* Select the page of a config list using search indexes of where and sort-by leafs */
+        if (xk == NULL && (where || sort_by) && !partial_pagination_cb &&
+            yang_config_ancestor(ylist) != 0 &&
+            yang_find(ylist, Y_ORDERED_BY, "user") == NULL &&
+            !clicon_option_bool_id(h, CO_XMLDB_SYSTEM_ONLY_CONFIG) &&
+            !clicon_option_bool_id(h, CO_NACM_DISABLED_ON_EMPTY)){
+            if ((ret = get_list_pagination_index(h, db, ylist, xpath, nsc, where, wherens,
+                                                 sort_by, direction, offset, limit, &xret)) < 0)
+                goto done;
+            if (ret == 1){
+                indexed++;
+                where = NULL;
+                offset = 0;
+                limit = 0;
+                break;
+            }
+        }
+#endif
         /* Build a "predicate" cbuf */
         if ((ret = xmldb_get0(h, db, YB_MODULE, nsc, xpath?xpath:"/", 1, wdef, &xret, NULL, &xerr)) < 0) {
             if ((cbmsg = cbuf_new()) == NULL){
@@ -529,6 +1436,8 @@ get_list_pagination(clixon_handle     h,
         if (content != CONTENT_CONFIG){
             if ((ret = get_state_data(h, xpath?xpath:"/", nsc, &xret)) < 0)
                 goto done;
+            if (ret == 2) /* Reply is deferred */
+                goto ok;
             if (ret == 0){ /* Error from callback (error in xret) */
                 if (clixon_xml2cbuf1(cbret, xret, 0, 0, NULL, -1, 0, 0, WITHDEFAULTS_REPORT_ALL) < 0)
                     goto done;
@@ -546,16 +1455,8 @@ get_list_pagination(clixon_handle     h,
         if (where){
             if (xpath_vec(xret, nsc, "%s[%s]", &xvec, &xlen, xpath?xpath:"/", where) < 0)
                 goto done;
-            for (i=0; i<xlen; i++){
-                if ((x = xvec[i]) == NULL)
-                    break;
-                xml_flag_set(x, XML_FLAG_MARK);
-            }
-            /* Remove everything that is not marked */
-            if (xml_tree_prune_flagged_sub(xret, XML_FLAG_MARK, 1, NULL) < 0)
-                goto done;
-            if (xml_apply(xret, CX_ELMNT, (xml_applyfn_t*)xml_flag_reset,
-                          (void*)XML_FLAG_MARK) < 0)
+            /* Remove everything that is not found, only paths to found nodes are traversed */
+            if (xml_tree_prune_marked(xret, xvec, xlen) < 0)
                 goto done;
             if (xvec){
                 free(xvec);
@@ -593,17 +1494,44 @@ get_list_pagination(clixon_handle     h,
            lastly "the "limit" parameter (see Section 3.1.7) */
         if (xpath_vec(xret, nsc, "%s", &xvec, &xlen, xpath?xpath:"/") < 0)
             goto done;
+        if (xk){
+            for (i=0; i<xlen; i++)
+                if (xml_cmp(xk, xvec[i], 0, 0, NULL) == 0)
+                    break;
+            if (i == xlen){
+                if (netconf_invalid_value(cbret, "application", "cursor-not-found") < 0)
+                    goto done;
+                goto ok;
+            }
+            if ((offset += i+1) > xlen)
+                offset = xlen;
+        }
         if (limit == 0)
             upper = xlen;
         else{
             if ((upper = offset+limit) > xlen)
                 upper = xlen;
         }
+        /* Page is already marked, list entries added by state data are pruned */
+        if (indexed)
+            upper = offset;
         for (i=offset; i<upper; i++){
             if ((x = xvec[i]) == NULL)
                 break;
             xml_flag_set(x, XML_FLAG_MARK);
         }
+        /* Annotate last entry with next cursor if entries remain */
+        if (offset < upper && upper < xlen){
+            x = xvec[upper-1];
+            if ((cbmsg = cbuf_new()) == NULL){
+                clixon_err(OE_UNIX, errno, "cbuf_new");
+                goto done;
+            }
+            if (list_pagination_cursor_encode(x, ylist, cbmsg) < 0)
+                goto done;
+            if (xml_add_attr(x, "next", cbuf_get(cbmsg), "lp", IETF_PAGINATON_NAMESPACE) == NULL)
+                goto done;
+        }
         /* Remove everything that is not marked */
         if (xml_tree_prune_flagged_sub(xret, XML_FLAG_MARK, 1, NULL) < 0)
             goto done;
@@ -651,7 +1579,8 @@ get_list_pagination(clixon_handle     h,
             cbuf_free(cba);
     }
 #endif /* LIST_PAGINATION_REMAINING */
-    if (get_nacm_and_reply(h, xret, xpath, nsc, username, depth, wdef, cbret) < 0)
+    if (get_nacm_and_reply(h, xret, xpath, nsc, username, depth, wdef,
+                           get_reply_binary(ce, depth, wdef), cbret) < 0)
         goto done;
  ok:
     retval = 0;
@@ -666,9 +1595,268 @@ get_list_pagination(clixon_handle     h,
         xml_free(xerr);
     if (xret)
         xml_free(xret);
+    if (xk)
+        xml_free(xk);
+    return retval;
+}
+
+/* Max number of cached get-config replies */
+#define GET_REPLY_CACHE_MAX 64
+
+/*! Cached get-config reply, value of reply cache hash keyed by request
+ */
+struct get_reply_entry{
+    uint64_t       gr_gen;     /* Generation of datastore */
+    uint64_t       gr_rgen;    /* Generation of running, for NACM rules */
+    struct timeval gr_tv;      /* Time of reply */
+    char           gr_reply[]; /* Reply string */
+};
+typedef struct get_reply_entry get_reply_entry;
+
+/*! Get generation of datastore and of running
+ *
+ * @param[in]  h     Clixon handle
+ * @param[in]  db    Database name
+ * @param[out] gen   Generation of db
+ * @param[out] rgen  Generation of running
+ * @retval     1     OK, db and running caches exist
+ * @retval     0     Not cached, dont use reply cache
+ */
+static int
+get_reply_cache_gen(clixon_handle h,
+                    char         *db,
+                    uint64_t     *gen,
+                    uint64_t     *rgen)
+{
+    db_elmnt *de;
+
+    if ((de = xmldb_find(h, db)) == NULL || xmldb_cache_read(de) == NULL)
+        return 0;
+    *gen = xmldb_generation_get(de);
+    if ((de = xmldb_find(h, "running")) == NULL || xmldb_cache_read(de) == NULL)
+        return 0;
+    *rgen = xmldb_generation_get(de);
+    return 1;
+}
+
+/*! Find reply of identical get-config request of unchanged datastore
+ *
+ * @param[in]  h     Clixon handle
+ * @param[in]  db    Database name
+ * @param[in]  key   Request key
+ * @param[in]  ttl   Max age of a reply in seconds
+ * @param[out] cbret Return xml tree, reply is appended if found
+ * @retval     1     Found, reply appended to cbret
+ * @retval     0     Not found
+ * @retval    -1     Error
+ */
+static int
+get_reply_cache_find(clixon_handle h,
+                     char         *db,
+                     char         *key,
+                     int           ttl,
+                     cbuf         *cbret)
+{
+    clicon_hash_t   *hash = NULL;
+    get_reply_entry *gr;
+    uint64_t         gen;
+    uint64_t         rgen;
+    struct timeval   tv;
+
+    if (clicon_ptr_get(h, "get-reply-cache", (void**)&hash) < 0 || hash == NULL)
+        return 0;
+    if ((gr = clicon_hash_value(hash, key, NULL)) == NULL)
+        return 0;
+    gettimeofday(&tv, NULL);
+    if (get_reply_cache_gen(h, db, &gen, &rgen) == 0 ||
+        gr->gr_gen != gen || gr->gr_rgen != rgen ||
+        tv.tv_sec - gr->gr_tv.tv_sec > ttl){
+        clicon_hash_del(hash, key);
+        return 0;
+    }
+    cprintf(cbret, "%s", gr->gr_reply);
+    return 1;
+}
+
+/*! Add reply of get-config request to reply cache
+ *
+ * Expired entries are removed if the cache is full.
+ * @param[in]  h     Clixon handle
+ * @param[in]  db    Database name
+ * @param[in]  key   Request key
+ * @param[in]  ttl   Max age of a reply in seconds
+ * @param[in]  reply Reply string
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+static int
+get_reply_cache_add(clixon_handle h,
+                    char         *db,
+                    char         *key,
+                    int           ttl,
+                    char         *reply)
+{
+    int              retval = -1;
+    clicon_hash_t   *hash = NULL;
+    get_reply_entry *gr = NULL;
+    get_reply_entry *gr1;
+    size_t           len;
+    char           **keys = NULL;
+    size_t           klen = 0;
+    int              i;
+
+    if (clicon_ptr_get(h, "get-reply-cache", (void**)&hash) < 0 || hash == NULL){
+        if ((hash = clicon_hash_init()) == NULL)
+            goto done;
+        if (clicon_ptr_set(h, "get-reply-cache", hash) < 0)
+            goto done;
+    }
+    if (clicon_hash_keys(hash, &keys, &klen) < 0)
+        goto done;
+    if (klen >= GET_REPLY_CACHE_MAX){
+        for (i=0; i<klen; i++){
+            if ((gr1 = clicon_hash_value(hash, keys[i], NULL)) != NULL &&
+                time(NULL) - gr1->gr_tv.tv_sec > ttl){
+                clicon_hash_del(hash, keys[i]);
+                klen--;
+            }
+        }
+        if (klen >= GET_REPLY_CACHE_MAX)
+            goto ok;
+    }
+    len = sizeof(*gr) + strlen(reply) + 1;
+    if ((gr = malloc(len)) == NULL){
+        clixon_err(OE_UNIX, errno, "malloc");
+        goto done;
+    }
+    memset(gr, 0, sizeof(*gr));
+    if (get_reply_cache_gen(h, db, &gr->gr_gen, &gr->gr_rgen) == 0)
+        goto ok;
+    gettimeofday(&gr->gr_tv, NULL);
+    strcpy(gr->gr_reply, reply);
+    if (clicon_hash_add(hash, key, gr, len) == NULL)
+        goto done;
+ ok:
+    retval = 0;
+ done:
+    if (gr)
+        free(gr);
+    if (keys)
+        free(keys);
     return retval;
 }
 
+/*! Free get-config reply cache
+ *
+ * @param[in]  h      Clixon handle
+ * @retval     0      OK
+ * @see CLICON_GET_REPLY_CACHE_TTL
+ */
+int
+get_reply_cache_exit(clixon_handle h)
+{
+    clicon_hash_t *hash = NULL;
+
+    if (clicon_ptr_get(h, "get-reply-cache", (void**)&hash) == 0 && hash != NULL){
+        clicon_hash_free(hash);
+        clicon_ptr_del(h, "get-reply-cache");
+    }
+    return 0;
+}
+
+/*! Check if only the part of the datastore printed with depth can be read
+ *
+ * Sub-trees below depth are not printed and need not be copied, unless xpath predicates
+ * are evaluated again in filter_xpath_again, or NACM read rules are applied by pruning
+ * @param[in]  h        Clixon handle
+ * @param[in]  xpath    XPath of get request, or NULL
+ * @param[in]  depth    Nr of levels to print, -1 is all
+ * @param[in]  username User of get request
+ * @retval     1        Yes, read with xmldb_get_depth
+ * @retval     0        No, read complete sub-trees
+ */
+static int
+get_depth_copy(clixon_handle h,
+               char         *xpath,
+               int32_t       depth,
+               char         *username)
+{
+    cxobj *xnacm;
+
+    if (depth < 0)
+        return 0;
+    if (xpath && strchr(xpath, '[') != NULL)
+        return 0;
+    if (clicon_option_bool_id(h, CO_NACM_DISABLED_ON_EMPTY))
+        return 0;
+    if ((xnacm = clicon_nacm_cache(h)) != NULL &&
+        !nacm_datanode_read_filtered(username, xnacm))
+        return 0;
+    return 1;
+}
+
+/*! Memory admission control of get request
+ *
+ * Estimate the cost of the reply from the size of the datastore nodes selected by xpath,
+ * before any tree is copied.
+ * @param[in]  h      Clixon handle
+ * @param[in]  ce     Client entry
+ * @param[in]  db     Database name
+ * @param[in]  xpath  XPath of get request, or NULL
+ * @param[in]  nsc    Namespace context of xpath
+ * @param[out] cbret  Return resource-denied rpc-error if not admitted
+ * @retval     1      Admitted
+ * @retval     0      Not admitted, rpc-error in cbret
+ * @retval    -1      Error
+ * @see backend_client_admit
+ */
+static int
+get_admit(clixon_handle h,
+          client_entry *ce,
+          char         *db,
+          char         *xpath,
+          cvec         *nsc,
+          cbuf         *cbret)
+{
+    int     retval = -1;
+    cxobj  *xt = NULL;
+    cxobj  *xerr = NULL;
+    cxobj **xvec = NULL;
+    size_t  xlen = 0;
+    size_t  sz = 0;
+    size_t  i;
+    int     ret;
+
+    if (clicon_option_int(h, "CLICON_BACKEND_SESSION_MEM_MAX") == 0 &&
+        clicon_option_int(h, "CLICON_BACKEND_MEM_MAX") == 0)
+        goto ok;
+    /* Errors reading the datastore are reported by the get itself */
+    if ((ret = xmldb_get_cache(h, db, &xt, &xerr)) < 0)
+        goto done;
+    if (ret == 0 || xt == NULL)
+        goto ok;
+    if (xpath_vec(xt, nsc, "%s", &xvec, &xlen, xpath?xpath:"/") < 0)
+        goto done;
+    for (i=0; i<xlen; i++)
+        if (xml_stats(xvec[i], XML_STATS_ALL, NULL, &sz) < 0)
+            goto done;
+    if ((ret = backend_client_admit(h, ce, sz, cbret)) < 0)
+        goto done;
+    if (ret == 0)
+        goto fail;
+ ok:
+    retval = 1;
+ done:
+    if (xvec)
+        free(xvec);
+    if (xerr)
+        xml_free(xerr);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
 /*! Common get/get-config code for retrieving  configuration and state information.
  *
  * @param[in]  h       Clixon handle
@@ -714,6 +1902,9 @@ get_common(clixon_handle   h,
     withdefaults_type wdef;
     char             *wdefstr;
     int               ret;
+    cbuf             *cbkey = NULL;
+    size_t            len0 = 0;
+    int               ttl = 0;
 
     clixon_debug(CLIXON_DBG_BACKEND | CLIXON_DBG_DETAIL, "");
     if (db == NULL){
@@ -726,8 +1917,9 @@ get_common(clixon_handle   h,
         clixon_err(OE_YANG, ENOENT, "No yang spec9");
         goto done;
     }
-    /* filter assumes xpath, if type=subtree is requested, all i retrieved
-     * and then the netconf client filters it in netconf_get_config_subtree */
+    /* filter assumes xpath, if type=subtree is requested, all is retrieved
+     * and then the netconf client filters it in netconf_get_config_subtree.
+     * The netconf client translates subtree filters to xpath, see netconf_filter_pushdown */
     if ((xfilter = xml_find(xe, "filter")) != NULL){
         if ((xpath0 = xml_find_value(xfilter, "select"))==NULL)
             xpath0 = "/";
@@ -783,11 +1975,47 @@ get_common(clixon_handle   h,
             goto ok;
         }
     }
+    if (content != CONTENT_NONCONFIG){
+        if ((ret = get_admit(h, ce, db, xpath, nsc, cbret)) < 0)
+            goto done;
+        if (ret == 0)
+            goto ok;
+    }
+    /* Identical config requests of an unchanged datastore get the same reply */
+    if ((ttl = clicon_option_int(h, "CLICON_GET_REPLY_CACHE_TTL")) > 0 &&
+        content == CONTENT_CONFIG &&
+        !clicon_option_bool_id(h, CO_XMLDB_SYSTEM_ONLY_CONFIG)){
+        if ((cbkey = cbuf_new()) == NULL){
+            clixon_err(OE_UNIX, errno, "cbuf_new");
+            goto done;
+        }
+        cprintf(cbkey, "%s %s %d %d %s", db, username?username:"", depth, wdef, xpath?xpath:"/");
+        if ((ret = get_reply_cache_find(h, db, cbuf_get(cbkey), ttl, cbret)) < 0)
+            goto done;
+        if (ret == 1)
+            goto ok;
+        len0 = cbuf_len(cbret);
+    }
     /* Read configuration */
     switch (content){
     case CONTENT_CONFIG:    /* config data only */
+        /* Read-only result, print the datastore cache directly */
+        if (clicon_nacm_cache(h) == NULL &&
+            !clicon_option_bool_id(h, CO_XMLDB_SYSTEM_ONLY_CONFIG) &&
+            !clicon_option_bool_id(h, CO_NACM_DISABLED_ON_EMPTY)){
+            if ((ret = get_config_borrow(h, db, xpath, nsc, depth, wdef,
+                                         get_reply_binary(ce, depth, wdef), cbret)) < 0)
+                goto done;
+            if (ret == 0)
+                goto ok;
+            goto reply;
+        }
         /* specific xpath. with-default gets masked in get_nacm_and_reply */
-        if ((ret = xmldb_get0(h, db, YB_MODULE, nsc, xpath?xpath:"/", 1, WITHDEFAULTS_REPORT_ALL, &xret, NULL, &xerr)) < 0) {
+        if (get_depth_copy(h, xpath, depth, username))
+            ret = xmldb_get_depth(h, db, nsc, xpath?xpath:"/", depth, wdef, &xret, &xerr);
+        else
+            ret = xmldb_get0(h, db, YB_MODULE, nsc, xpath?xpath:"/", 1, WITHDEFAULTS_REPORT_ALL, &xret, NULL, &xerr);
+        if (ret < 0) {
             if ((cbmsg = cbuf_new()) == NULL){
                 clixon_err(OE_UNIX, errno, "cbuf_new");
                 goto done;
@@ -805,7 +2033,7 @@ get_common(clixon_handle   h,
         break;
     case CONTENT_ALL:       /* both config and state */
     case CONTENT_NONCONFIG: /* state data only */
-        if (clicon_option_bool(h, "CLICON_VALIDATE_STATE_XML")){
+        if (clicon_option_bool_id(h, CO_VALIDATE_STATE_XML)){
             /* Whole config tree, for validate debug */
             if ((ret = xmldb_get0(h, "running", YB_MODULE, nsc, NULL, 1, WITHDEFAULTS_REPORT_ALL, &xret, NULL, &xerr)) < 0) {
                 if ((cbmsg = cbuf_new()) == NULL){
@@ -825,7 +2053,11 @@ get_common(clixon_handle   h,
         }
         else if (content == CONTENT_ALL){
             /* specific xpath */
-            if ((ret = xmldb_get0(h, db, YB_MODULE, nsc, xpath?xpath:"/", 1, WITHDEFAULTS_REPORT_ALL, &xret, NULL, &xerr)) < 0) {
+            if (get_depth_copy(h, xpath, depth, username))
+                ret = xmldb_get_depth(h, db, nsc, xpath?xpath:"/", depth, wdef, &xret, &xerr);
+            else
+                ret = xmldb_get0(h, db, YB_MODULE, nsc, xpath?xpath:"/", 1, WITHDEFAULTS_REPORT_ALL, &xret, NULL, &xerr);
+            if (ret < 0) {
                 if ((cbmsg = cbuf_new()) == NULL){
                     clixon_err(OE_UNIX, errno, "cbuf_new");
                     goto done;
@@ -858,6 +2090,8 @@ get_common(clixon_handle   h,
 
         if ((ret = get_state_data(h, xpath?xpath:"/", nsc, &xret)) < 0)
             goto done;
+        if (ret == 2) /* Asynchronous state data, reply is deferred */
+            goto ok;
         if (ret == 0){ /* Error from callback (error in xret) */
             if (clixon_xml2cbuf1(cbret, xret, 0, 0, NULL, -1, 0, 0, WITHDEFAULTS_REPORT_ALL) < 0)
                 goto done;
@@ -873,7 +2107,7 @@ get_common(clixon_handle   h,
         break;
     }
     if (content != CONTENT_CONFIG &&
-        clicon_option_bool(h, "CLICON_VALIDATE_STATE_XML")){
+        clicon_option_bool_id(h, CO_VALIDATE_STATE_XML)){
         /* Check XML  by validating it. return internal error with error cause
          * Primarily intended for user-supplied state-data.
          * The whole config tree must be present in case the state data references config data
@@ -896,7 +2130,7 @@ get_common(clixon_handle   h,
             goto ok;
         }
     } /* CLICON_VALIDATE_STATE_XML */
-    if (clicon_option_bool(h, "CLICON_VALIDATE_STATE_XML"))
+    if (clicon_option_bool_id(h, CO_VALIDATE_STATE_XML))
         if (content == CONTENT_NONCONFIG){ /* state only, all config should be removed now */
             /* Keep state data only, remove everything that is config. Note that state data
              * may be a sub-part in a config tree, we need to traverse to find all
@@ -912,12 +2146,21 @@ get_common(clixon_handle   h,
         goto done;
     if (filter_xpath_again(h, yspec, xret, xvec, xlen, xpath, nsc) < 0)
         goto done;
-    if (get_nacm_and_reply(h, xret, xpath, nsc, username, depth, wdef, cbret) < 0)
+    if (get_nacm_and_reply(h, xret, xpath, nsc, username, depth, wdef,
+                           get_reply_binary(ce, depth, wdef), cbret) < 0)
+        goto done;
+ reply:
+    if (cbkey &&
+        clixon_xml2cbuf_stream_flushed() == 0 && /* Not if parts of reply have been sent */
+        !get_reply_binary(ce, depth, wdef) &&
+        get_reply_cache_add(h, db, cbuf_get(cbkey), ttl, cbuf_get(cbret) + len0) < 0)
         goto done;
  ok:
     retval = 0;
  done:
     clixon_debug(CLIXON_DBG_BACKEND | CLIXON_DBG_DETAIL, "retval:%d", retval);
+    if (cbkey)
+        cbuf_free(cbkey);
     if (xlpg2)
         xml_free(xlpg2);
     if (xvec)
@@ -42,6 +42,7 @@
  */
 int from_client_get_config(clixon_handle h, cxobj *xe, cbuf *cbret, void *arg, void *regarg);
 int from_client_get(clixon_handle h, cxobj *xe, cbuf *cbret, void *arg, void *regarg);
+int get_reply_cache_exit(clixon_handle h);
 int from_client_get_pageable_list(clixon_handle h, cxobj *xe, cbuf *cbret, void *arg, void *regarg); /* XXX */
 
 #endif  /* _BACKEND_GET_H_ */
@@ -53,6 +53,10 @@ client_entry *backend_client_list(clixon_handle h);
 
 int backend_client_delete(clixon_handle h, client_entry *ce);
 
+void backend_outq_buf_unref(struct outq_buf *ob);
+
+void backend_client_outq_free(client_entry *ce);
+
 int backend_client_print(clixon_handle h, FILE *f);
 
 #endif  /* _BACKEND_HANDLE_H_ */
@@ -78,10 +78,14 @@
 #include "backend_startup.h"
 #include "backend_cache.h"
 #include "backend_clixon_lib.h"
+#include "backend_get.h"
 #include "backend_plugin_restconf.h"
+#include "backend_profile.h"
+#include "backend_partial_lock.h"
+#include "backend_snapshot.h"
 
 /* Command line options to be passed to getopt(3) */
-#define BACKEND_OPTS "hVD:f:E:l:C:d:p:b:Fza:u:P:1qs:c:U:g:y:Ao:"
+#define BACKEND_OPTS "hVD:f:E:l:C:G:d:p:b:Fza:u:P:1qs:c:U:g:y:Ao:"
 
 #define BACKEND_LOGFILE "/usr/local/var/clixon_backend.log"
 
@@ -110,8 +114,7 @@ backend_terminate(clixon_handle h)
     if ((x = clicon_modst_cache_get(h, 1)) != NULL)
         xml_free(x);
     /* Free changelog */
-    if ((x = clicon_xml_changelog_get(h)) != NULL)
-        xml_free(x);
+    clixon_xml_changelog_exit(h);
     xml_yang_validate_exit(h);
     yang_exit(h);
     if ((nsctx = clicon_nsctx_global_get(h)) != NULL)
@@ -121,14 +124,31 @@ backend_terminate(clixon_handle h)
     if ((x = clicon_conf_xml(h)) != NULL)
         xml_free(x);
     confirmed_commit_free(h);
+    change_feed_free(h);
+    commit_group_free(h);
+    partial_lock_release_all(h, 0);
+    ce_event_exit();
     stream_publish_exit();
+    /* Free plugins starting in background */
+    clixon_plugin_start_exit(h);
     /* Delete all plugins, RPC callbacks, and upgrade callbacks */
     clixon_plugin_module_exit(h);
     /* Delete all process-control entries */
     clixon_process_delete_all(h);
 
     xpath_optimize_exit();
+    xpath_parse_cache_exit();
+    api_path_cache_exit();
+    xpath_profile_exit();
+    transaction_profile_exit();
+    rpc_profile_exit();
+    clixon_trace_exit();
+    regex_cache_exit();
     clixon_pagination_free(h);
+    get_reply_cache_exit(h);
+    clixon_plugin_statedata_cache_exit(h);
+    clixon_plugin_statedata_async_exit(h);
+    clixon_plugin_rpc_async_exit(h);
     if (pidfile)
         unlink(pidfile);
     if (sockfamily==AF_UNIX && lstat(sockpath, &st) == 0)
@@ -143,6 +163,7 @@ backend_terminate(clixon_handle h)
     xmldb_disconnect(h);
     clixon_debug_exit();
     backend_handle_exit(h); /* Cannot use h after this. */
+    xml_exit();
     return 0;
 }
 
@@ -173,6 +194,77 @@ backend_sig_child(int arg)
     clicon_sig_child_set(1);
 }
 
+/* Pipe written by SIGUSR1 handler and read in event loop, see CLICON_RPC_PROFILE */
+static int _backend_sig_usr1[2] = {-1, -1};
+
+/*! Log rpc profile, and dump log ring, on SIGUSR1
+ *
+ * The profile is logged in the event loop, the handler only writes to a pipe
+ */
+static void
+backend_sig_usr1(int arg)
+{
+    int  saved = errno;
+    char c = 0;
+
+    if (_backend_sig_usr1[1] != -1 &&
+        write(_backend_sig_usr1[1], &c, 1) < 0){
+        /* Pipe full: already signalled */
+    }
+    clicon_sig_ignore_set(1); /* EINTR in event loop */
+    errno = saved;
+}
+
+/*! SIGUSR1 received, log rpc profile and dump log ring if log destination is ring
+ *
+ * @param[in]  fd   Read end of signal pipe
+ * @param[in]  arg  Clixon handle
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+backend_sig_usr1_cb(int   fd,
+                    void *arg)
+{
+    clixon_handle h = (clixon_handle)arg;
+    char          buf[64];
+
+    while (read(fd, buf, sizeof(buf)) > 0)
+        ;
+    if (clixon_logflags_get() & CLIXON_LOG_RING)
+        clixon_log_ring_dump(NULL);
+    if (!clicon_option_bool(h, "CLICON_RPC_PROFILE"))
+        return 0;
+    return rpc_profile_log(h);
+}
+
+/*! Log rpc profile, or dump log ring, when SIGUSR1 is received
+ *
+ * @param[in]  h    Clixon handle
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+backend_sig_usr1_init(clixon_handle h)
+{
+    if (pipe(_backend_sig_usr1) < 0){
+        clixon_err(OE_UNIX, errno, "pipe");
+        return -1;
+    }
+    if (fcntl(_backend_sig_usr1[0], F_SETFL, O_NONBLOCK) < 0 ||
+        fcntl(_backend_sig_usr1[1], F_SETFL, O_NONBLOCK) < 0){
+        clixon_err(OE_UNIX, errno, "fcntl");
+        return -1;
+    }
+    if (clixon_event_reg_fd(_backend_sig_usr1[0], backend_sig_usr1_cb, h, "rpc profile signal") < 0)
+        return -1;
+    if (set_signal(SIGUSR1, backend_sig_usr1, NULL) < 0){
+        clixon_err(OE_DAEMON, errno, "Setting signal");
+        return -1;
+    }
+    return 0;
+}
+
 /*! Create backend server socket and register callback
  *
  * @param[in]  h    Clixon handle
@@ -393,6 +485,7 @@ usage(clixon_handle h,
             "\t-E <dir> \tExtra configuration file directory\n"
             "\t-l <s|e|o|n|f<file>> \tLog on (s)yslog, std(e)rr, std(o)ut, (n)one or (f)ile (syslog is default)\n"
             "\t-C <format>\tDump configuration options on stdout after loading. Format is xml|json|text\n"
+            "\t-G <module>\tPrint C accessors generated from YANG module on stdout and exit\n"
             "\t-d <dir>\tSpecify backend plugin directory (default: %s)\n"
             "\t-p <dir>\tAdd Yang directory path (see CLICON_YANG_DIR)\n"
             "\t-b <dir>\tSpecify datastore directory\n"
@@ -462,6 +555,7 @@ main(int    argc,
     int           config_dump;
     enum format_enum config_dump_format = FORMAT_XML;
     int           print_version = 0;
+    char         *yang2c_module = NULL;
     int32_t       d;
     int autocli_cache_clear = 1;
 
@@ -577,6 +671,9 @@ main(int    argc,
             }
             config_dump++;
             break;
+        case 'G' : /* Print C accessors generated from YANG module */
+            yang2c_module = optarg;
+            break;
         case 'd':  /* Plugin directory */
             if (!strlen(optarg))
                 usage(h, argv[0]);
@@ -850,6 +947,18 @@ main(int    argc,
         goto done;
     if (clicon_nsctx_global_set(h, nsctx_global) < 0)
         goto done;
+    /* Print generated C accessors of a yang module and exit */
+    if (yang2c_module){
+        yang_stmt *ymod;
+
+        if ((ymod = yang_find_module_by_name(yspec, yang2c_module)) == NULL){
+            clixon_err(OE_YANG, ENOENT, "Yang module %s not found", yang2c_module);
+            goto done;
+        }
+        if (yang2c_module_print(stdout, ymod) < 0)
+            goto done;
+        goto ok;
+    }
 
     /* Set up standard netconf rpc callbacks */
     if (backend_rpc_init(h) < 0)
@@ -857,11 +966,29 @@ main(int    argc,
     /* Setup other rpc callbacks */
     if (backend_commit_init(h) < 0)
         goto done;
+    if (backend_partial_lock_init(h) < 0)
+        goto done;
     if (backend_clixon_lib_init(h) < 0)
         goto done;
     if (backend_clixon_cache_init(h) < 0)
         goto done;
 
+    if (clicon_option_bool(h, "CLICON_XPATH_PROFILE"))
+        xpath_profile_set(1);
+    if (clicon_option_bool(h, "CLICON_TRANSACTION_PROFILE"))
+        transaction_profile_set(1);
+    if (clicon_option_bool(h, "CLICON_RPC_PROFILE"))
+        rpc_profile_set(1);
+    if (clixon_trace_init(h) < 0)
+        goto done;
+    xpath_parallel_set(clicon_option_int(h, "CLICON_XPATH_PARALLEL"));
+    xpath_parse_cache_set(clicon_option_bool(h, "CLICON_XPATH_PARSE_CACHE"));
+    xml_yang_validate_parallel_set(clicon_option_int(h, "CLICON_VALIDATE_PARALLEL"));
+    xml_hindex_enable_set(clicon_option_bool(h, "CLICON_XML_HASH_INDEX"));
+    xml_childvec_chunk_set(clicon_option_bool(h, "CLICON_XML_CHILDVEC_CHUNK"));
+    xml_digest_set(clicon_option_bool(h, "CLICON_XML_DIGEST"));
+    xml_value_shared_set(clicon_option_int(h, "CLICON_XML_VALUE_SHARED"));
+    xml_slab_set(clicon_option_bool(h, "CLICON_XML_SLAB_ALLOC"));
     /* Must be after netconf_module_load, but before startup code */
     if (clicon_option_bool(h, "CLICON_XML_CHANGELOG"))
         if (clixon_xml_changelog_init(h) < 0)
@@ -1006,8 +1133,8 @@ main(int    argc,
 
     if (status == STARTUP_INVALID && cbuf_len(cbret))
         clixon_log(h, LOG_NOTICE, "%s: %u %s", __PROGRAM__, getpid(), cbuf_get(cbret));
-    /* Call backend plugin_start with user -- options */
-    if (clixon_plugin_start_all(h) < 0)
+    /* Call backend plugin_start with user -- options, background starts are made later */
+    if (clixon_plugin_start_backend_all(h, !once) < 0)
         goto done;
     /* Explicit dump of config (also debug dump below). */
     if (config_dump){
@@ -1015,6 +1142,9 @@ main(int    argc,
             goto done;
     }
 
+    /* YANG load and startup bind profile, see CLICON_YANG_PROFILE */
+    if (yang_profile_log(h, yspec) < 0)
+        goto done;
     /* -1 option to run only once */
     if (once)
         goto ok;
@@ -1026,7 +1156,8 @@ main(int    argc,
        also */
     if (foreground==0){
         clixon_log_init(h, __PROGRAM__, dbg?LOG_DEBUG:LOG_INFO,
-                        logdst==CLIXON_LOG_FILE?CLIXON_LOG_FILE:CLIXON_LOG_SYSLOG);
+                        (logdst & (CLIXON_LOG_FILE|CLIXON_LOG_RING)) ?
+                        logdst & (CLIXON_LOG_FILE|CLIXON_LOG_RING) : CLIXON_LOG_SYSLOG);
         /* Call plugin callbacks just before fork/daemonization */
         if (clixon_plugin_pre_daemon_all(h) < 0)
             goto done;
@@ -1062,6 +1193,10 @@ main(int    argc,
         clixon_err(OE_DAEMON, errno, "Setting signal");
         goto done;
     }
+    if ((clicon_option_bool(h, "CLICON_RPC_PROFILE") ||
+         (clixon_logflags_get() & CLIXON_LOG_RING)) &&
+        backend_sig_usr1_init(h) < 0)
+        goto done;
     /* Initialize server socket and save it to handle */
     if ((ss = backend_server_socket(h)) < 0)
         goto done;
@@ -1089,6 +1224,12 @@ main(int    argc,
     /* Just before event-loop, after socket bind/listen */
     if (netconf_monitoring_statistics_init(h) < 0)
         goto done;
+    /* Plugins starting in background, meanwhile only read-only rpcs */
+    if (clixon_plugin_start_background(h) < 0)
+        goto done;
+    /* Running after startup, also if not committed, eg startup mode none */
+    if (backend_snapshot_publish(h) < 0)
+        goto done;
     clixon_log(h, LOG_NOTICE, "%s: %u Started", __PROGRAM__, getpid());
     if (clixon_event_loop(h) < 0)
         goto done;
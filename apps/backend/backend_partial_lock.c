@@ -0,0 +1,648 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+
+  Copyright (C) 2009-2016 Olof Hagsand and Benny Holmgren
+  Copyright (C) 2017-2019 Olof Hagsand
+  Copyright (C) 2020-2022 Olof Hagsand and Rubicon Communications, LLC(Netgate)
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2,
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+
+ * RFC 5717 Partial Lock Remote Procedure Call (RPC) for NETCONF
+ * A partial lock protects a set of nodes of running, and their descendants, selected by
+ * XPaths, from changes by other sessions. Other sessions may change disjoint parts of running.
+ * Locked nodes are kept as canonical XPaths, two nodes overlap if one is an ancestor of, or
+ * equal to, the other.
+ * @see CLICON_NETCONF_PARTIAL_LOCK
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "clixon_config.h" /* generated by config & autoconf */
+#endif
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <errno.h>
+#include <syslog.h>
+#include <sys/time.h>
+
+/* cligen */
+#include <cligen/cligen.h>
+
+/* clixon */
+#include <clixon/clixon.h>
+
+#include "clixon_backend_transaction.h"
+#include "clixon_backend_plugin.h"
+#include "clixon_backend_client.h"
+#include "backend_partial_lock.h"
+
+/*! Partial lock of a session, element of circular list
+ */
+struct partial_lock {
+    qelem_t   pl_qelem;   /* List header */
+    uint32_t  pl_id;      /* Lock id */
+    uint32_t  pl_session; /* Session id of owner */
+    char    **pl_nodes;   /* Canonical XPaths of locked nodes */
+    int       pl_len;     /* Length of pl_nodes */
+};
+typedef struct partial_lock partial_lock;
+
+/*! Get list of partial locks
+ *
+ * @param[in]  h   Clixon handle
+ * @retval     pl  First partial lock, or NULL
+ */
+static partial_lock *
+partial_lock_list(clixon_handle h)
+{
+    partial_lock *pl = NULL;
+
+    if (clicon_ptr_get(h, "partial-locks", (void**)&pl) < 0)
+        return NULL;
+    return pl;
+}
+
+/*! Free a partial lock
+ *
+ * @param[in]  pl  Partial lock, removed from list
+ */
+static void
+partial_lock_free(partial_lock *pl)
+{
+    int i;
+
+    if (pl->pl_nodes){
+        for (i=0; i<pl->pl_len; i++)
+            if (pl->pl_nodes[i])
+                free(pl->pl_nodes[i]);
+        free(pl->pl_nodes);
+    }
+    free(pl);
+}
+
+/*! Check if two canonical XPaths of nodes overlap
+ *
+ * Paths are compared on node boundaries: the shorter path must be equal to the longer,
+ * or be followed by '/' in it. Eg /ex:a/ex:b overlaps /ex:a/ex:b/ex:c but not /ex:a/ex:bc
+ * or /ex:a/ex:b2
+ * @param[in]  p0  XPath of first node
+ * @param[in]  p1  XPath of second node
+ * @retval     1   Equal, or one node is an ancestor of the other
+ * @retval     0   Disjoint
+ */
+static int
+partial_lock_overlap(const char *p0,
+                     const char *p1)
+{
+    size_t n0 = strlen(p0);
+    size_t n1 = strlen(p1);
+
+    if (n0 == n1)
+        return strcmp(p0, p1) == 0;
+    else if (n0 < n1)
+        return strncmp(p0, p1, n0) == 0 && p1[n0] == '/';
+    else
+        return strncmp(p0, p1, n1) == 0 && p0[n1] == '/';
+}
+
+/*! Find partial lock of another session overlapping a node
+ *
+ * @param[in]  h     Clixon handle
+ * @param[in]  path  Canonical XPath of node
+ * @param[in]  id    Session id, locks of this session are ignored
+ * @retval     pl    Partial lock of other session
+ * @retval     NULL  No overlapping lock of other session
+ */
+static partial_lock *
+partial_lock_find(clixon_handle h,
+                  const char   *path,
+                  uint32_t      id)
+{
+    partial_lock *pl;
+    int           i;
+
+    if ((pl = partial_lock_list(h)) != NULL)
+        do {
+            if (pl->pl_session != id)
+                for (i=0; i<pl->pl_len; i++)
+                    if (partial_lock_overlap(pl->pl_nodes[i], path))
+                        return pl;
+            pl = NEXTQ(partial_lock *, pl);
+        } while (pl && pl != partial_lock_list(h));
+    return NULL;
+}
+
+/*! Get session id of any partial lock of another session
+ *
+ * @param[in]  h    Clixon handle
+ * @param[in]  id   Session id, or 0 for any session
+ * @retval     id   Session id of other session holding a partial lock
+ * @retval     0    No other session holds a partial lock
+ */
+uint32_t
+partial_lock_other(clixon_handle h,
+                   uint32_t      id)
+{
+    partial_lock *pl;
+
+    if ((pl = partial_lock_list(h)) != NULL)
+        do {
+            if (pl->pl_session != id)
+                return pl->pl_session;
+            pl = NEXTQ(partial_lock *, pl);
+        } while (pl != partial_lock_list(h));
+    return 0;
+}
+
+/*! Release all partial locks of a session
+ *
+ * @param[in]  h    Clixon handle
+ * @param[in]  id   Session id, or 0 for all sessions
+ * @retval     0    OK
+ */
+int
+partial_lock_release_all(clixon_handle h,
+                         uint32_t      id)
+{
+    partial_lock *list;
+    partial_lock *pl;
+    partial_lock *keep = NULL;
+
+    list = partial_lock_list(h);
+    while ((pl = list) != NULL) {
+        DELQ(pl, list, partial_lock *);
+        if (id == 0 || pl->pl_session == id)
+            partial_lock_free(pl);
+        else
+            ADDQ(pl, keep);
+    }
+    if (keep)
+        clicon_ptr_set(h, "partial-locks", keep);
+    else
+        clicon_ptr_del(h, "partial-locks");
+    return 0;
+}
+
+/*! Compute canonical XPath of a node
+ *
+ * @param[in]  h     Clixon handle
+ * @param[in]  x     XML node bound to YANG
+ * @param[out] path  Malloced XPath, free after use
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+static int
+partial_lock_path(clixon_handle h,
+                  cxobj        *x,
+                  char        **path)
+{
+    return xml2xpath(x, clicon_nsctx_global_get(h), 1, 1, path);
+}
+
+/*! Check if a node overlaps a partial lock of another session
+ *
+ * @param[in]  h     Clixon handle
+ * @param[in]  x     XML node bound to YANG
+ * @param[in]  id    Session id, locks of this session are ignored
+ * @param[out] sid   Session id of the overlapping lock
+ * @retval     1     No overlap
+ * @retval     0     Overlap, sid set
+ * @retval    -1     Error
+ */
+static int
+partial_lock_node_check(clixon_handle h,
+                        cxobj        *x,
+                        uint32_t      id,
+                        uint32_t     *sid)
+{
+    int           retval = -1;
+    char         *path = NULL;
+    partial_lock *pl;
+
+    if (partial_lock_path(h, x, &path) < 0)
+        goto done;
+    if ((pl = partial_lock_find(h, path, id)) != NULL){
+        *sid = pl->pl_session;
+        retval = 0;
+        goto done;
+    }
+    retval = 1;
+ done:
+    if (path)
+        free(path);
+    return retval;
+}
+
+/*! Check that a commit does not change nodes locked by another session
+ *
+ * Deleted, added and changed nodes of the transaction are checked against the partial
+ * locks of all other sessions.
+ * @param[in]  h      Clixon handle
+ * @param[in]  td     Transaction data, after validation
+ * @param[in]  id     Session id of committing session
+ * @param[out] cbret  Return lock-denied rpc-error if conflict
+ * @retval     1      OK, no conflict
+ * @retval     0      Conflict, rpc-error in cbret
+ * @retval    -1      Error
+ */
+int
+partial_lock_commit_check(clixon_handle       h,
+                          transaction_data_t *td,
+                          uint32_t            id,
+                          cbuf               *cbret)
+{
+    int       retval = -1;
+    cbuf     *cbx = NULL;
+    uint32_t  sid = 0;
+    size_t    i;
+    int       ret = 1;
+
+    if (partial_lock_other(h, id) == 0)
+        goto ok;
+    for (i=0; ret == 1 && i<td->td_dlen; i++)
+        if ((ret = partial_lock_node_check(h, td->td_dvec[i], id, &sid)) < 0)
+            goto done;
+    for (i=0; ret == 1 && i<td->td_alen; i++)
+        if ((ret = partial_lock_node_check(h, td->td_avec[i], id, &sid)) < 0)
+            goto done;
+    for (i=0; ret == 1 && i<td->td_clen; i++)
+        if ((ret = partial_lock_node_check(h, td->td_tcvec[i], id, &sid)) < 0)
+            goto done;
+    if (ret == 0){
+        if ((cbx = cbuf_new()) == NULL){
+            clixon_err(OE_XML, errno, "cbuf_new");
+            goto done;
+        }
+        cprintf(cbx, "<session-id>%u</session-id>", sid);
+        if (netconf_lock_denied(cbret, cbuf_get(cbx), "Operation failed, part of running is locked by another session") < 0)
+            goto done;
+        goto fail;
+    }
+ ok:
+    retval = 1;
+ done:
+    if (cbx)
+        cbuf_free(cbx);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! Check that a write of running does not change nodes locked by another session
+ *
+ * Used by operations that write running directly, not by commit of a candidate,
+ * such as copy-config and edit-config with running as target.
+ * @param[in]  h      Clixon handle
+ * @param[in]  db0    Datastore with current content of running
+ * @param[in]  db1    Datastore with new content of running
+ * @param[in]  id     Session id of writing session
+ * @param[out] cbret  Return lock-denied rpc-error if conflict
+ * @retval     1      OK, no conflict
+ * @retval     0      Conflict, rpc-error in cbret
+ * @retval    -1      Error
+ * @see partial_lock_commit_check
+ */
+int
+partial_lock_write_check(clixon_handle h,
+                         const char   *db0,
+                         const char   *db1,
+                         uint32_t      id,
+                         cbuf         *cbret)
+{
+    int                 retval = -1;
+    transaction_data_t *td = NULL;
+    cxobj              *xerr = NULL;
+    int                 ret;
+
+    if (partial_lock_other(h, id) == 0)
+        goto ok;
+    if ((td = transaction_new()) == NULL)
+        goto done;
+    if ((ret = xmldb_get_cache(h, db0, &td->td_src, &xerr)) < 0)
+        goto done;
+    if (ret == 1 &&
+        (ret = xmldb_get_cache(h, db1, &td->td_target, &xerr)) < 0)
+        goto done;
+    if (ret == 0){
+        if (clixon_xml2cbuf1(cbret, xerr, 0, 0, NULL, -1, 0, 0, WITHDEFAULTS_REPORT_ALL) < 0)
+            goto done;
+        goto fail;
+    }
+    if (xml_diff(td->td_src,
+                 td->td_target,
+                 &td->td_dvec,
+                 &td->td_dlen,
+                 &td->td_avec,
+                 &td->td_alen,
+                 &td->td_scvec,
+                 &td->td_tcvec,
+                 &td->td_clen) < 0)
+        goto done;
+    if ((ret = partial_lock_commit_check(h, td, id, cbret)) < 0)
+        goto done;
+    if (ret == 0)
+        goto fail;
+ ok:
+    retval = 1;
+ done:
+    if (td)
+        transaction_free1(td, 0); /* Trees are datastore caches */
+    if (xerr)
+        xml_free(xerr);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! Append a locked-node element of a partial-lock reply
+ *
+ * Namespaces of the prefixes in the XPath are declared in the element
+ * @param[in]  cb    Reply buffer
+ * @param[in]  x     Locked XML node
+ * @param[in]  path  Canonical XPath of x
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+static int
+partial_lock_node2cbuf(cbuf       *cb,
+                       cxobj      *x,
+                       const char *path)
+{
+    int        retval = -1;
+    cvec      *nsc = NULL;
+    cg_var    *cv = NULL;
+    cxobj     *xp;
+    yang_stmt *ymod;
+    char      *prefix;
+
+    if ((nsc = xml_nsctx_init(NULL, NULL)) == NULL)
+        goto done;
+    for (xp = x; xp && xml_spec(xp); xp = xml_parent(xp)){
+        if ((ymod = ys_module(xml_spec(xp))) == NULL)
+            continue;
+        if ((prefix = yang_find_myprefix(ymod)) == NULL)
+            continue;
+        if (xml_nsctx_get(nsc, prefix) == NULL &&
+            xml_nsctx_add(nsc, prefix, yang_find_mynamespace(ymod)) < 0)
+            goto done;
+    }
+    cprintf(cb, "<locked-node xmlns=\"%s\"", NETCONF_PARTIAL_LOCK_NAMESPACE);
+    while ((cv = cvec_each(nsc, cv)) != NULL)
+        cprintf(cb, " xmlns:%s=\"%s\"", cv_name_get(cv), cv_string_get(cv));
+    cprintf(cb, ">");
+    if (xml_chardata_cbuf_append(cb, 0, path) < 0)
+        goto done;
+    cprintf(cb, "</locked-node>");
+    retval = 0;
+ done:
+    if (nsc)
+        xml_nsctx_free(nsc);
+    return retval;
+}
+
+/*! Lock parts of running selected by XPaths, RFC 5717 partial-lock
+ *
+ * @param[in]  h       Clixon handle
+ * @param[in]  xe      Request: <rpc><xn></rpc>
+ * @param[out] cbret   Return xml tree, eg <rpc-reply>..., <rpc-error..
+ * @param[in]  arg     client-entry
+ * @param[in]  regarg  User argument given at rpc_callback_register()
+ * @retval     0       OK
+ * @retval    -1       Error
+ */
+static int
+from_client_partial_lock(clixon_handle h,
+                         cxobj        *xe,
+                         cbuf         *cbret,
+                         void         *arg,
+                         void         *regarg)
+{
+    int           retval = -1;
+    client_entry *ce = (client_entry *)arg;
+    uint32_t      id = ce->ce_id;
+    cxobj        *xt = NULL;
+    cxobj        *xerr = NULL;
+    cxobj        *xs = NULL;
+    cxobj       **xvec = NULL;
+    size_t        xlen = 0;
+    cvec         *nsc = NULL;
+    xp_ctx       *xc = NULL;
+    cbuf         *cbx = NULL;
+    partial_lock *pl = NULL;
+    partial_lock *list;
+    partial_lock *pl1;
+    uint32_t      iddb;
+    int           lockid;
+    size_t        i;
+    int           ret;
+
+    if ((cbx = cbuf_new()) == NULL){
+        clixon_err(OE_XML, errno, "cbuf_new");
+        goto done;
+    }
+    /* A partial lock cannot be granted if running is locked by another session */
+    if ((iddb = xmldb_islocked(h, "running")) != 0 && iddb != id){
+        cprintf(cbx, "<session-id>%u</session-id>", iddb);
+        if (netconf_lock_denied(cbret, cbuf_get(cbx), "Operation failed, lock is already held") < 0)
+            goto done;
+        goto ok;
+    }
+    if ((ret = xmldb_get_cache(h, "running", &xt, &xerr)) < 0)
+        goto done;
+    if (ret == 0){
+        if (clixon_xml2cbuf1(cbret, xerr, 0, 0, NULL, -1, 0, 0, WITHDEFAULTS_REPORT_ALL) < 0)
+            goto done;
+        goto ok;
+    }
+    /* Union of the nodes selected by all select expressions */
+    while (xt && (xs = xml_child_each(xe, xs, CX_ELMNT)) != NULL) {
+        if (strcmp(xml_name(xs), "select") != 0)
+            continue;
+        if (xml_nsctx_node(xs, &nsc) < 0)
+            goto done;
+        if (xpath_vec_ctx(xt, nsc, xml_body(xs)?xml_body(xs):"", 0, &xc) < 0){
+            if (netconf_invalid_value(cbret, "application", "Invalid select XPath") < 0)
+                goto done;
+            goto ok;
+        }
+        if (xc->xc_type != XT_NODESET){
+            if (netconf_invalid_value(cbret, "application", "not-a-node-set") < 0)
+                goto done;
+            goto ok;
+        }
+        for (i=0; i<xc->xc_size; i++)
+            if (xml_spec(xc->xc_nodeset[i]) != NULL &&
+                cxvec_append(xc->xc_nodeset[i], &xvec, &xlen) < 0)
+                goto done;
+        ctx_free(xc);
+        xc = NULL;
+        xml_nsctx_free(nsc);
+        nsc = NULL;
+    }
+    if (xlen == 0){
+        if (netconf_invalid_value(cbret, "application", "no-matches") < 0)
+            goto done;
+        goto ok;
+    }
+    if ((pl = calloc(1, sizeof(*pl))) == NULL ||
+        (pl->pl_nodes = calloc(xlen, sizeof(char*))) == NULL){
+        clixon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    pl->pl_session = id;
+    pl->pl_len = xlen;
+    for (i=0; i<xlen; i++){
+        if (partial_lock_path(h, xvec[i], &pl->pl_nodes[i]) < 0)
+            goto done;
+        /* A partial lock cannot be granted if a node is locked by another session */
+        if ((pl1 = partial_lock_find(h, pl->pl_nodes[i], id)) != NULL){
+            cprintf(cbx, "<session-id>%u</session-id>", pl1->pl_session);
+            if (netconf_lock_denied(cbret, cbuf_get(cbx), "Operation failed, part of running is locked by another session") < 0)
+                goto done;
+            goto ok;
+        }
+    }
+    if ((lockid = clicon_data_int_get(h, "partial-lock-id")) < 0)
+        lockid = 0;
+    pl->pl_id = ++lockid;
+    clicon_data_int_set(h, "partial-lock-id", lockid);
+    cprintf(cbret, "<rpc-reply xmlns=\"%s\">", NETCONF_BASE_NAMESPACE);
+    cprintf(cbret, "<lock-id xmlns=\"%s\">%u</lock-id>", NETCONF_PARTIAL_LOCK_NAMESPACE, pl->pl_id);
+    for (i=0; i<xlen; i++)
+        if (partial_lock_node2cbuf(cbret, xvec[i], pl->pl_nodes[i]) < 0)
+            goto done;
+    cprintf(cbret, "</rpc-reply>");
+    list = partial_lock_list(h);
+    ADDQ(pl, list);
+    clicon_ptr_set(h, "partial-locks", list);
+    pl = NULL;
+ ok:
+    retval = 0;
+ done:
+    if (pl)
+        partial_lock_free(pl);
+    if (xc)
+        ctx_free(xc);
+    if (nsc)
+        xml_nsctx_free(nsc);
+    if (xvec)
+        free(xvec);
+    if (xerr)
+        xml_free(xerr);
+    if (cbx)
+        cbuf_free(cbx);
+    return retval;
+}
+
+/*! Release a partial lock, RFC 5717 partial-unlock
+ *
+ * @param[in]  h       Clixon handle
+ * @param[in]  xe      Request: <rpc><xn></rpc>
+ * @param[out] cbret   Return xml tree, eg <rpc-reply>..., <rpc-error..
+ * @param[in]  arg     client-entry
+ * @param[in]  regarg  User argument given at rpc_callback_register()
+ * @retval     0       OK
+ * @retval    -1       Error
+ */
+static int
+from_client_partial_unlock(clixon_handle h,
+                           cxobj        *xe,
+                           cbuf         *cbret,
+                           void         *arg,
+                           void         *regarg)
+{
+    int           retval = -1;
+    client_entry *ce = (client_entry *)arg;
+    partial_lock *list;
+    partial_lock *pl;
+    char         *str;
+    uint32_t      lockid = 0;
+    int           ret;
+
+    if ((str = xml_find_body(xe, "lock-id")) != NULL){
+        if ((ret = parse_uint32(str, &lockid, NULL)) < 0)
+            goto done;
+        if (ret == 0)
+            lockid = 0;
+    }
+    if ((pl = list = partial_lock_list(h)) != NULL)
+        do {
+            if (pl->pl_id == lockid)
+                break;
+            pl = NEXTQ(partial_lock *, pl);
+        } while (pl != list);
+    /* The lock must exist and be owned by this session */
+    if (pl == NULL || pl->pl_id != lockid || pl->pl_session != ce->ce_id){
+        if (netconf_lock_denied(cbret, "", "Operation failed, no such partial lock of this session") < 0)
+            goto done;
+        goto ok;
+    }
+    DELQ(pl, list, partial_lock *);
+    partial_lock_free(pl);
+    if (list)
+        clicon_ptr_set(h, "partial-locks", list);
+    else
+        clicon_ptr_del(h, "partial-locks");
+    cprintf(cbret, "<rpc-reply xmlns=\"%s\"><ok/></rpc-reply>", NETCONF_BASE_NAMESPACE);
+ ok:
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Init partial locks: Set up partial-lock and partial-unlock rpc callbacks
+ *
+ * @param[in]  h     Clixon handle
+ * @retval     0     OK
+ * @retval    -1     Error (fatal)
+ * @see CLICON_NETCONF_PARTIAL_LOCK
+ */
+int
+backend_partial_lock_init(clixon_handle h)
+{
+    int retval = -1;
+
+    if (!clicon_option_bool(h, "CLICON_NETCONF_PARTIAL_LOCK"))
+        goto ok;
+    if (rpc_callback_register(h, from_client_partial_lock, NULL,
+                      NETCONF_PARTIAL_LOCK_NAMESPACE, "partial-lock") < 0)
+        goto done;
+    if (rpc_callback_register(h, from_client_partial_unlock, NULL,
+                      NETCONF_PARTIAL_LOCK_NAMESPACE, "partial-unlock") < 0)
+        goto done;
+ ok:
+    retval = 0;
+ done:
+    return retval;
+}
@@ -43,15 +43,23 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <stddef.h>
 #include <stdarg.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <ctype.h>
 #include <dlfcn.h>
 #include <unistd.h>
 #include <errno.h>
 #include <signal.h>
 #include <syslog.h>
+#include <time.h>
+#include <sys/time.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <sys/param.h>
+#include <sys/wait.h>
+#include <sys/socket.h>
 #include <netinet/in.h>
 
 /* cligen */
@@ -64,6 +72,8 @@
 #include "clixon_backend_plugin.h"
 #include "clixon_backend_client.h"
 #include "clixon_backend_commit.h"
+#include "backend_client.h"
+#include "backend_profile.h"
 
 /*! Request plugins to reset system state
  *
@@ -254,6 +264,251 @@ clixon_plugin_daemon_all(clixon_handle h)
     return retval;
 }
 
+/* Plugins with CA_START_BACKGROUND whose start is pending, see clixon_plugin_start_background() */
+static clixon_plugin_t **_start_bg = NULL;
+static int               _start_bg_len = 0;
+
+/*! Call start callbacks of all plugins in plugin order, except background starts
+ *
+ * Plugins with CA_START_BACKGROUND are started later by clixon_plugin_start_background() if
+ * background is set, otherwise in plugin order as the other plugins.
+ * @param[in]  h          Clixon handle
+ * @param[in]  background Defer background starts
+ * @retval     0          OK
+ * @retval    -1          Error
+ * @see clixon_plugin_start_all  Without background starts, used by clients
+ */
+int
+clixon_plugin_start_backend_all(clixon_handle h,
+                                int           background)
+{
+    int                retval = -1;
+    clixon_plugin_t   *cp = NULL;
+    clixon_plugin_api *api;
+
+    while ((cp = clixon_plugin_each(h, cp)) != NULL) {
+        api = clixon_plugin_api_get(cp);
+        if (api->ca_start != NULL && background &&
+            (api->ca_start_flags & CA_START_BACKGROUND)){
+            if ((_start_bg = realloc(_start_bg, (_start_bg_len+1)*sizeof(*_start_bg))) == NULL){
+                clixon_err(OE_UNIX, errno, "realloc");
+                goto done;
+            }
+            _start_bg[_start_bg_len++] = cp;
+            continue;
+        }
+        if (clixon_plugin_start_one(cp, h) < 0)
+            goto done;
+    }
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Start plugins with CA_START_BACKGROUND while a forked process serves read-only rpcs
+ *
+ * Call just before the event loop, after the server socket is opened.
+ * The start callbacks are called in plugin order in the backend process. Meanwhile, a forked
+ * copy of the backend serves clients with read-only rpcs, see clixon_plugin_start_pending().
+ * When all plugins are started, the forked process hands over its sessions and exits, and
+ * the backend serves the sessions from then on, see backend_client_handoff_recv().
+ * If fork fails, the plugins are started before clients are served.
+ * @param[in]  h       Clixon handle
+ * @retval     0       OK
+ * @retval    -1       Error, a start callback failed, the backend exits
+ */
+int
+clixon_plugin_start_background(clixon_handle h)
+{
+    int   retval = -1;
+    pid_t pid = 0;
+    int   sv[2] = {-1, -1};
+    int   status;
+    int   i;
+
+    if (_start_bg_len == 0)
+        goto ok;
+    for (i=0; i<_start_bg_len; i++)
+        clixon_log(h, LOG_NOTICE, "%s: Plugin %s starting in background", __PROGRAM__,
+                   clixon_plugin_name_get(_start_bg[i]));
+    if (socketpair(AF_UNIX, SOCK_SEQPACKET, 0, sv) < 0)
+        clixon_log(h, LOG_WARNING, "%s: socketpair: %s, not serving clients during start",
+                   __func__, strerror(errno));
+    else if ((pid = fork()) == 0){ /* Serve read-only rpcs until sessions are handed over */
+        close(sv[0]);
+        if (backend_client_handoff_reg(h, sv[1]) < 0 ||
+            clixon_event_loop(h) < 0)
+            _exit(1);
+        _exit(0); /* Dont exit() here, parent state must not be flushed */
+    }
+    else if (pid < 0)
+        clixon_log(h, LOG_WARNING, "%s: fork: %s, not serving clients during start",
+                   __func__, strerror(errno));
+    if (sv[1] != -1){
+        close(sv[1]);
+        sv[1] = -1;
+    }
+    for (i=0; i<_start_bg_len; i++){
+        if (clixon_plugin_start_one(_start_bg[i], h) < 0){
+            clixon_log(h, LOG_ERR, "%s: Start callback in plugin %s failed: %s, exiting",
+                       __func__, clixon_plugin_name_get(_start_bg[i]),
+                       clixon_err_category()?clixon_err_reason():"unknown");
+            goto done;
+        }
+        clixon_log(h, LOG_NOTICE, "%s: Plugin %s started", __PROGRAM__,
+                   clixon_plugin_name_get(_start_bg[i]));
+    }
+ ok:
+    retval = 0;
+ done:
+    if (pid > 0){
+        /* Take over the sessions, or terminate the process if the backend exits */
+        if (retval == 0 &&
+            backend_client_handoff_recv(h, sv[0]) < 0)
+            retval = -1;
+        if (retval < 0)
+            kill(pid, SIGTERM);
+        while (waitpid(pid, &status, 0) < 0 && errno == EINTR)
+            ;
+    }
+    if (sv[0] != -1)
+        close(sv[0]);
+    clixon_plugin_start_exit(h);
+    return retval;
+}
+
+/*! Check if plugin start is pending in the background
+ *
+ * Only set in the process serving clients while plugins start
+ * @param[in]  cp      Plugin handle, or NULL for any plugin
+ * @retval     1       Start callback of plugin (or of any plugin) is not done
+ * @retval     0       Done, or not a background start
+ */
+int
+clixon_plugin_start_pending(clixon_plugin_t *cp)
+{
+    int i;
+
+    if (_start_bg_len == 0)
+        return 0;
+    if (cp == NULL)
+        return 1;
+    for (i=0; i<_start_bg_len; i++)
+        if (_start_bg[i] == cp)
+            return 1;
+    return 0;
+}
+
+/*! Free pending background starts, before plugins are unloaded
+ *
+ * @param[in]  h       Clixon handle
+ * @retval     0       OK
+ */
+int
+clixon_plugin_start_exit(clixon_handle h)
+{
+    if (_start_bg)
+        free(_start_bg);
+    _start_bg = NULL;
+    _start_bg_len = 0;
+    return 0;
+}
+
+/*! Find yang node of a subtree path on the form /module:name/name
+ *
+ * @param[in]  yspec   Yang spec
+ * @param[in]  path    Path, keys are ignored
+ * @param[out] yres    Yang node
+ * @retval     0       OK
+ * @retval    -1       Error, path not found
+ */
+static int
+plugin_subtree_yang(yang_stmt  *yspec,
+                    const char *path,
+                    yang_stmt **yres)
+{
+    int        retval = -1;
+    char      *str = NULL;
+    char      *s;
+    char      *id;
+    char      *name;
+    yang_stmt *y = NULL;
+
+    if ((str = strdup(path)) == NULL){
+        clixon_err(OE_UNIX, errno, "strdup");
+        goto done;
+    }
+    s = str;
+    while ((id = strsep(&s, "/")) != NULL){
+        if (*id == '\0')
+            continue;
+        if ((name = strchr(id, '=')) != NULL) /* Skip keys */
+            *name = '\0';
+        if ((name = strchr(id, ':')) != NULL){
+            *name++ = '\0';
+            if (y == NULL && (y = yang_find_module_by_name(yspec, id)) == NULL)
+                break;
+        }
+        else
+            name = id;
+        if (y == NULL || (y = yang_find_datanode(y, name)) == NULL)
+            break;
+    }
+    if (id != NULL || y == NULL){
+        clixon_err(OE_PLUGIN, ENOENT, "Plugin subtree %s not found", path);
+        goto done;
+    }
+    *yres = y;
+    retval = 0;
+ done:
+    if (str)
+        free(str);
+    return retval;
+}
+
+/*! Check if a yang node is in or above one of the subtrees
+ *
+ * @param[in]  yx     Yang node
+ * @param[in]  yv     Yang nodes of subtrees
+ * @param[in]  yn     Length of yv
+ */
+static int
+plugin_subtree_match_yang(yang_stmt  *yx,
+                          yang_stmt **yv,
+                          int         yn)
+{
+    yang_stmt *y;
+    int        i;
+
+    for (i=0; i<yn; i++){
+        for (y = yx; y != NULL; y = yang_parent_get(y))
+            if (y == yv[i])
+                return 1;
+        for (y = yv[i]; y != NULL; y = yang_parent_get(y))
+            if (y == yx)
+                return 1;
+    }
+    return 0;
+}
+
+/*! Check if a change is in or above one of the subtrees
+ *
+ * @param[in]  x      Changed XML node
+ * @param[in]  yv     Yang nodes of subtrees
+ * @param[in]  yn     Length of yv
+ */
+static int
+plugin_subtree_match(cxobj      *x,
+                     yang_stmt **yv,
+                     int         yn)
+{
+    yang_stmt *yx;
+
+    if ((yx = xml_spec(x)) == NULL)
+        return 1;
+    return plugin_subtree_match_yang(yx, yv, yn);
+}
+
 /*! Call single backend statedata callback
  *
  * Create an xml state tree (xret) for one callback only on the form:
@@ -286,7 +541,9 @@ clixon_plugin_statedata_one(clixon_plugin_t *cp,
     plgstatedata_t *fn;          /* Plugin statedata fn */
     cxobj          *x = NULL;
     void           *wh = NULL;
+    clixon_trace_t  tr;
 
+    tr = clixon_trace_begin(CLIXON_DBG_BACKEND);
     if ((fn = clixon_plugin_api_get(cp)->ca_statedata) != NULL){
         if ((x = xml_new(DATASTORE_TOP_SYMBOL, NULL, CX_ELMNT)) == NULL)
             goto done;
@@ -312,12 +569,1050 @@ clixon_plugin_statedata_one(clixon_plugin_t *cp,
  done:
     if (x)
         xml_free(x);
+    if (fn)
+        clixon_trace_end(tr, CLIXON_DBG_BACKEND, __func__, clixon_plugin_name_get(cp));
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/* Max number of entries of state data cache */
+#define STATE_CACHE_MAX 256
+
+/*! Cached state data of a plugin for an xpath, value of state cache hash
+ *
+ * Keyed by plugin name, xpath and namespace context
+ * @see CLICON_STATE_CACHE_TTL
+ */
+struct state_cache_entry{
+    struct timeval sc_tv;  /* Time of collection */
+    cxobj         *sc_x;   /* Bound and sorted state tree, or NULL if empty */
+};
+typedef struct state_cache_entry state_cache_entry;
+
+/*! Get TTL of state data cache of a plugin
+ *
+ * @param[in]  h       Clixon handle
+ * @param[in]  plugin  Plugin name
+ * @retval     ttl     TTL in milliseconds, 0 if not cached
+ */
+static uint32_t
+statedata_cache_ttl(clixon_handle h,
+                    const char   *plugin)
+{
+    clicon_hash_t *hash = NULL;
+    uint32_t      *ttl;
+
+    if (clicon_ptr_get(h, "state-cache-ttl", (void**)&hash) == 0 && hash != NULL &&
+        (ttl = clicon_hash_value(hash, plugin, NULL)) != NULL)
+        return *ttl;
+    return clicon_option_int(h, "CLICON_STATE_CACHE_TTL");
+}
+
+/*! Create state data cache key of plugin, xpath and namespace context
+ *
+ * @param[in]  plugin  Plugin name
+ * @param[in]  nsc     Namespace context
+ * @param[in]  xpath   XPath or NULL
+ * @param[out] cb      Key
+ */
+static void
+statedata_cache_key(const char *plugin,
+                    cvec       *nsc,
+                    char       *xpath,
+                    cbuf       *cb)
+{
+    cg_var *cv = NULL;
+
+    cprintf(cb, "%s\n%s", plugin, xpath ? xpath : "/");
+    while ((cv = cvec_each(nsc, cv)) != NULL)
+        cprintf(cb, "\n%s=%s", cv_name_get(cv) ? cv_name_get(cv) : "", cv_string_get(cv));
+}
+
+/*! Free state data cache entry and remove it from cache
+ */
+static void
+statedata_cache_rm(clicon_hash_t *hash,
+                   const char    *key)
+{
+    state_cache_entry *sc;
+
+    if ((sc = clicon_hash_value(hash, key, NULL)) != NULL && sc->sc_x)
+        xml_free(sc->sc_x);
+    clicon_hash_del(hash, key);
+}
+
+/*! Milliseconds since time of state data cache entry
+ */
+static uint64_t
+statedata_cache_age(state_cache_entry *sc)
+{
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+    timersub(&tv, &sc->sc_tv, &tv);
+    return (uint64_t)tv.tv_sec*1000 + tv.tv_usec/1000;
+}
+
+/*! Find state data of plugin for identical request collected within TTL
+ *
+ * @param[in]  h     Clixon handle
+ * @param[in]  key   Cache key
+ * @param[in]  ttl   TTL in milliseconds
+ * @param[out] xp    Copy of state tree, or NULL if empty, if xp is NULL only check
+ * @retval     1     Found
+ * @retval     0     Not found
+ * @retval    -1     Error
+ */
+static int
+statedata_cache_find(clixon_handle h,
+                     char         *key,
+                     uint32_t      ttl,
+                     cxobj       **xp)
+{
+    clicon_hash_t     *hash = NULL;
+    state_cache_entry *sc;
+
+    if (clicon_ptr_get(h, "state-cache", (void**)&hash) < 0 || hash == NULL)
+        return 0;
+    if ((sc = clicon_hash_value(hash, key, NULL)) == NULL)
+        return 0;
+    if (statedata_cache_age(sc) >= ttl){
+        statedata_cache_rm(hash, key);
+        return 0;
+    }
+    if (xp == NULL)
+        return 1;
+    *xp = NULL;
+    if (sc->sc_x && (*xp = xml_dup(sc->sc_x)) == NULL)
+        return -1;
+    return 1;
+}
+
+/*! Add copy of state data of plugin to state data cache
+ *
+ * Expired entries are removed if the cache is full.
+ * @param[in]  h     Clixon handle
+ * @param[in]  key   Cache key
+ * @param[in]  ttl   TTL in milliseconds
+ * @param[in]  x     State tree, or NULL if empty
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+static int
+statedata_cache_add(clixon_handle h,
+                    char         *key,
+                    uint32_t      ttl,
+                    cxobj        *x)
+{
+    int                retval = -1;
+    clicon_hash_t     *hash = NULL;
+    state_cache_entry  sc0 = {0,};
+    state_cache_entry *sc;
+    char             **keys = NULL;
+    size_t             klen = 0;
+    int                i;
+
+    if (clicon_ptr_get(h, "state-cache", (void**)&hash) < 0 || hash == NULL){
+        if ((hash = clicon_hash_init()) == NULL)
+            goto done;
+        if (clicon_ptr_set(h, "state-cache", hash) < 0)
+            goto done;
+    }
+    statedata_cache_rm(hash, key);
+    if (clicon_hash_keys(hash, &keys, &klen) < 0)
+        goto done;
+    if (klen >= STATE_CACHE_MAX){
+        for (i=0; i<klen; i++){
+            if ((sc = clicon_hash_value(hash, keys[i], NULL)) != NULL &&
+                statedata_cache_age(sc) >= ttl){
+                statedata_cache_rm(hash, keys[i]);
+                klen--;
+            }
+        }
+        if (klen >= STATE_CACHE_MAX)
+            goto ok;
+    }
+    gettimeofday(&sc0.sc_tv, NULL);
+    if (x && (sc0.sc_x = xml_dup(x)) == NULL)
+        goto done;
+    if (clicon_hash_add(hash, key, &sc0, sizeof(sc0)) == NULL){
+        if (sc0.sc_x)
+            xml_free(sc0.sc_x);
+        goto done;
+    }
+ ok:
+    retval = 0;
+ done:
+    if (keys)
+        free(keys);
+    return retval;
+}
+
+/*! Set TTL of state data cache of a plugin
+ *
+ * Overrides CLICON_STATE_CACHE_TTL for the plugin, eg in its init function
+ * @param[in]  h       Clixon handle
+ * @param[in]  plugin  Plugin name
+ * @param[in]  ttl     TTL in milliseconds, 0: do not cache state data of plugin
+ * @retval     0       OK
+ * @retval    -1       Error
+ * @see clixon_plugin_statedata_invalidate
+ */
+int
+clixon_plugin_statedata_ttl(clixon_handle h,
+                            const char   *plugin,
+                            uint32_t      ttl)
+{
+    clicon_hash_t *hash = NULL;
+
+    if (clicon_ptr_get(h, "state-cache-ttl", (void**)&hash) < 0 || hash == NULL){
+        if ((hash = clicon_hash_init()) == NULL)
+            return -1;
+        if (clicon_ptr_set(h, "state-cache-ttl", hash) < 0)
+            return -1;
+    }
+    if (clicon_hash_add(hash, plugin, &ttl, sizeof(ttl)) == NULL)
+        return -1;
+    return clixon_plugin_statedata_invalidate(h, plugin);
+}
+
+/*! Invalidate cached state data of a plugin, eg when its state has changed
+ *
+ * @param[in]  h       Clixon handle
+ * @param[in]  plugin  Plugin name, or NULL for all plugins
+ * @retval     0       OK
+ * @retval    -1       Error
+ * @see CLICON_STATE_CACHE_TTL
+ */
+int
+clixon_plugin_statedata_invalidate(clixon_handle h,
+                                   const char   *plugin)
+{
+    clicon_hash_t *hash = NULL;
+    char         **keys = NULL;
+    size_t         klen = 0;
+    size_t         len;
+    int            i;
+
+    if (clicon_ptr_get(h, "state-cache", (void**)&hash) < 0 || hash == NULL)
+        return 0;
+    if (clicon_hash_keys(hash, &keys, &klen) < 0)
+        return -1;
+    len = plugin ? strlen(plugin) : 0;
+    for (i=0; i<klen; i++)
+        if (plugin == NULL ||
+            (strncmp(keys[i], plugin, len) == 0 && keys[i][len] == '\n'))
+            statedata_cache_rm(hash, keys[i]);
+    if (keys)
+        free(keys);
+    return 0;
+}
+
+/*! Free state data cache
+ *
+ * @param[in]  h      Clixon handle
+ * @retval     0      OK
+ */
+int
+clixon_plugin_statedata_cache_exit(clixon_handle h)
+{
+    clicon_hash_t *hash = NULL;
+
+    if (clixon_plugin_statedata_invalidate(h, NULL) < 0)
+        return -1;
+    if (clicon_ptr_get(h, "state-cache", (void**)&hash) == 0 && hash != NULL){
+        clicon_hash_free(hash);
+        clicon_ptr_del(h, "state-cache");
+    }
+    hash = NULL;
+    if (clicon_ptr_get(h, "state-cache-ttl", (void**)&hash) == 0 && hash != NULL){
+        clicon_hash_free(hash);
+        clicon_ptr_del(h, "state-cache-ttl");
+    }
+    return 0;
+}
+
+/*! Check if an xpath is a plain location path from the root
+ *
+ * A location path of child steps with predicates, eg /a:x/y[k='v']/z, but not
+ * unions, descendants, wildcards or functions.
+ * @param[in]  xpath  XPath
+ * @param[out] eqonly Predicates only use equality and "and", eg [a='1' and b='2']
+ * @retval     1      Plain location path
+ * @retval     0      Other expression
+ */
+static int
+statedata_xpath_path(const char *xpath,
+                     int        *eqonly)
+{
+    const char *p;
+    int         pred = 0;
+    char        quote = 0;
+
+    *eqonly = 1;
+    if (xpath == NULL || *xpath != '/' || strstr(xpath, "//") != NULL)
+        return 0;
+    for (p = xpath; *p; p++){
+        if (quote){
+            if (*p == quote)
+                quote = 0;
+            continue;
+        }
+        if (*p == '[')
+            pred++;
+        else if (*p == ']'){
+            if (--pred < 0)
+                return 0;
+        }
+        else if (pred){
+            if (*p == '\'' || *p == '"')
+                quote = *p;
+            else if (strchr("<>!()|*+", *p) != NULL ||
+                     (strncmp(p, " or ", 4) == 0))
+                *eqonly = 0;
+        }
+        else if (!isalnum(*p) && strchr("_-.:/", *p) == NULL)
+            return 0;
+        else if (*p == '.' && (p[1] == '.' || p[1] == '/' || p[1] == '\0' || p[-1] == '/'))
+            return 0;
+    }
+    return pred == 0 && quote == 0;
+}
+
+/*! Get yang node of a state data request for pruning plugins with ca_state_subtrees
+ *
+ * @param[in]  h      Clixon handle
+ * @param[in]  yspec  Yang spec
+ * @param[in]  nsc    Namespace context of xpath
+ * @param[in]  xpath  XPath of request
+ * @param[out] yreq   Yang node of request, or NULL if all plugins should be called
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+static int
+statedata_request_yang(clixon_handle h,
+                       yang_stmt    *yspec,
+                       cvec         *nsc,
+                       char         *xpath,
+                       yang_stmt   **yreq)
+{
+    int               retval = -1;
+    clixon_plugin_t **cpv;
+    int               cpn;
+    cxobj            *xtop = NULL;
+    cxobj            *xbot = NULL;
+    yang_stmt        *ybot = NULL;
+    int               eqonly;
+
+    *yreq = NULL;
+    if (clixon_plugin_index(h, CLIXON_PLUGIN_CB(ca_state_subtrees), &cpv, &cpn) < 0)
+        goto done;
+    if (cpn == 0 || statedata_xpath_path(xpath, &eqonly) == 0)
+        goto ok;
+    if ((xtop = xml_new(DATASTORE_TOP_SYMBOL, NULL, CX_ELMNT)) == NULL)
+        goto done;
+    if (xpath2xml(xpath, nsc, xtop, yspec, 0, &xbot, &ybot, NULL) == 1 &&
+        ybot != NULL && yang_keyword_get(ybot) != Y_SPEC)
+        *yreq = ybot;
+ ok:
+    retval = 0;
+ done:
+    if (xtop)
+        xml_free(xtop);
+    return retval;
+}
+
+/*! Check if state data of a plugin intersects a request
+ *
+ * @param[in]  cp     Plugin handle
+ * @param[in]  yspec  Yang spec
+ * @param[in]  yreq   Yang node of request, or NULL for all
+ * @retval     1      Call plugin
+ * @retval     0      Skip plugin, its subtrees are not in or above the request
+ * @retval    -1      Error
+ */
+static int
+statedata_plugin_match(clixon_plugin_t *cp,
+                       yang_stmt       *yspec,
+                       yang_stmt       *yreq)
+{
+    const char **paths;
+    yang_stmt   *y;
+    int          i;
+
+    if (clixon_plugin_start_pending(cp))
+        return 0;
+    if (yreq == NULL ||
+        (paths = clixon_plugin_api_get(cp)->ca_state_subtrees) == NULL)
+        return 1;
+    for (i=0; paths[i]; i++){
+        if (plugin_subtree_yang(yspec, paths[i], &y) < 0)
+            return -1;
+        if (plugin_subtree_match_yang(yreq, &y, 1))
+            return 1;
+    }
+    return 0;
+}
+
+/*! Get list keys of a state data request, eg to fetch one list entry only
+ *
+ * For example, /if:interfaces-state/if:interface[if:name='eth0'] gives name=eth0.
+ * Use in a statedata callback of a plugin.
+ * @param[in]  h      Clixon handle
+ * @param[in]  nsc    Namespace context of xpath
+ * @param[in]  xpath  XPath of request
+ * @param[out] keys   Key leaf name and value of list entries in path order, free with cvec_free
+ * @retval     1      OK, keys is set, empty if no list keys are given
+ * @retval     0      No key constraint, xpath is not a plain path with key equality predicates
+ * @retval    -1      Error
+ * @code
+ *   cvec *keys = NULL;
+ *   if ((ret = clixon_plugin_statedata_keys(h, nsc, xpath, &keys)) == 1 &&
+ *       (name = cvec_find_str(keys, "name")) != NULL)
+ *      ... fetch state of interface name only
+ * @endcode
+ */
+int
+clixon_plugin_statedata_keys(clixon_handle h,
+                             cvec         *nsc,
+                             char         *xpath,
+                             cvec        **keys)
+{
+    int         retval = -1;
+    yang_stmt  *yspec;
+    cxobj      *xtop = NULL;
+    cxobj      *xbot = NULL;
+    yang_stmt  *ybot = NULL;
+    cxobj      *x;
+    cxobj      *xk;
+    cxobj     **xv = NULL;
+    int         xlen = 0;
+    cg_var     *cvk = NULL;
+    cvec       *cvv = NULL;
+    yang_stmt  *y;
+    int         eqonly;
+    int         ret;
+    int         i;
+
+    if (statedata_xpath_path(xpath, &eqonly) == 0 || !eqonly)
+        goto fail;
+    if ((yspec = clicon_dbspec_yang(h)) == NULL){
+        clixon_err(OE_YANG, ENOENT, "No yang spec");
+        goto done;
+    }
+    if ((xtop = xml_new(DATASTORE_TOP_SYMBOL, NULL, CX_ELMNT)) == NULL)
+        goto done;
+    if ((ret = xpath2xml(xpath, nsc, xtop, yspec, 0, &xbot, &ybot, NULL)) < 0)
+        goto done;
+    if (ret == 0)
+        goto fail;
+    for (x = xbot; x != NULL && x != xtop; x = xml_parent(x))
+        if (cxvec_prepend(x, &xv, &xlen) < 0)
+            goto done;
+    if ((cvv = cvec_new(0)) == NULL){
+        clixon_err(OE_UNIX, errno, "cvec_new");
+        goto done;
+    }
+    for (i=0; i<xlen; i++){
+        if ((y = xml_spec(xv[i])) == NULL || yang_keyword_get(y) != Y_LIST)
+            continue;
+        cvk = NULL;
+        while ((cvk = cvec_each(yang_cvec_get(y), cvk)) != NULL){
+            if ((xk = xml_find_type(xv[i], NULL, cv_string_get(cvk), CX_ELMNT)) == NULL ||
+                xml_body(xk) == NULL)
+                continue;
+            if (cvec_add_string(cvv, cv_string_get(cvk), xml_body(xk)) < 0){
+                clixon_err(OE_UNIX, errno, "cvec_add_string");
+                goto done;
+            }
+        }
+    }
+    *keys = cvv;
+    cvv = NULL;
+    retval = 1;
+ done:
+    if (cvv)
+        cvec_free(cvv);
+    if (xv)
+        free(xv);
+    if (xtop)
+        xml_free(xtop);
     return retval;
  fail:
     retval = 0;
     goto done;
 }
 
+/*! Asynchronous state data request of one plugin, given to ca_statedata_async
+ */
+struct statedata_async_req{
+    struct statedata_async *sr_sa;
+    clixon_plugin_t        *sr_cp;
+    int                     sr_state;  /* 0: collecting, 1: done, 2: failed */
+    cxobj                  *sr_x;      /* State tree if done */
+    char                   *sr_reason; /* Error reason if failed */
+};
+
+/*! Asynchronous state data of a client request
+ *
+ * The reply of the request is deferred and reading from the client is suspended until
+ * all plugins are done, or the deadline expires. Then the request is made again using
+ * the collected state data.
+ * @see ca_statedata_async
+ */
+struct statedata_async{
+    struct statedata_async     *sa_next;
+    clixon_handle               sa_h;
+    uint32_t                    sa_id;      /* Session id of client */
+    char                       *sa_msg;     /* Request message, made again when done */
+    struct statedata_async_req *sa_reqv;    /* One per plugin */
+    int                         sa_len;
+    int                         sa_pending; /* Nr of plugins collecting */
+    int                         sa_start;   /* Plugins are being started */
+};
+typedef struct statedata_async statedata_async;
+
+/* Client and message of the request being served, see clixon_plugin_statedata_async_client */
+static client_entry *_statedata_async_ce = NULL;
+static char         *_statedata_async_msg = NULL;
+
+/*! Find asynchronous state data of a client
+ */
+static statedata_async *
+statedata_async_find(clixon_handle h,
+                     uint32_t      id)
+{
+    statedata_async *sa = NULL;
+
+    clicon_ptr_get(h, "state-async", (void**)&sa);
+    for (; sa != NULL; sa = sa->sa_next)
+        if (sa->sa_id == id)
+            break;
+    return sa;
+}
+
+/*! Find plugin request of asynchronous state data
+ */
+static struct statedata_async_req *
+statedata_async_req_find(statedata_async *sa,
+                         clixon_plugin_t *cp)
+{
+    int i;
+
+    for (i=0; i<sa->sa_len; i++)
+        if (sa->sa_reqv[i].sr_cp == cp)
+            return &sa->sa_reqv[i];
+    return NULL;
+}
+
+static int statedata_async_timeout(int fd, void *arg);
+
+/*! Remove and free asynchronous state data of a client request
+ */
+static void
+statedata_async_rm(statedata_async *sa)
+{
+    statedata_async  *sa0 = NULL;
+    statedata_async **sap;
+    int               i;
+
+    clixon_event_unreg_timeout(statedata_async_timeout, sa);
+    clicon_ptr_get(sa->sa_h, "state-async", (void**)&sa0);
+    for (sap = &sa0; *sap != NULL; sap = &(*sap)->sa_next)
+        if (*sap == sa){
+            *sap = sa->sa_next;
+            break;
+        }
+    clicon_ptr_set(sa->sa_h, "state-async", sa0);
+    for (i=0; i<sa->sa_len; i++){
+        if (sa->sa_reqv[i].sr_x)
+            xml_free(sa->sa_reqv[i].sr_x);
+        if (sa->sa_reqv[i].sr_reason)
+            free(sa->sa_reqv[i].sr_reason);
+    }
+    if (sa->sa_reqv)
+        free(sa->sa_reqv);
+    if (sa->sa_msg)
+        free(sa->sa_msg);
+    free(sa);
+}
+
+/*! All plugins are done: make the request again with the collected state data
+ */
+static int
+statedata_async_resume(statedata_async *sa)
+{
+    int           retval = -1;
+    clixon_handle h = sa->sa_h;
+    uint32_t      id = sa->sa_id;
+
+    clixon_event_unreg_timeout(statedata_async_timeout, sa);
+    if (backend_client_async_resume(h, id, sa->sa_msg) < 0)
+        goto done;
+    retval = 0;
+ done:
+    /* Not used by request, eg client is gone */
+    if ((sa = statedata_async_find(h, id)) != NULL)
+        statedata_async_rm(sa);
+    return retval;
+}
+
+/*! Deadline of asynchronous state data: plugins not done have failed
+ */
+static int
+statedata_async_timeout(int   fd,
+                        void *arg)
+{
+    statedata_async            *sa = (statedata_async *)arg;
+    struct statedata_async_req *sr;
+    int                         i;
+
+    for (i=0; i<sa->sa_len; i++){
+        sr = &sa->sa_reqv[i];
+        if (sr->sr_state != 0)
+            continue;
+        clixon_log(sa->sa_h, LOG_WARNING, "State callback in plugin %s timed out",
+                   clixon_plugin_name_get(sr->sr_cp));
+        sr->sr_state = 2;
+        if ((sr->sr_reason = strdup("timeout")) == NULL){
+            clixon_err(OE_UNIX, errno, "strdup");
+            return -1;
+        }
+    }
+    sa->sa_pending = 0;
+    return statedata_async_resume(sa);
+}
+
+/*! Set client and message of request being served, asynchronous state data may be used
+ *
+ * @param[in]  ce   Client entry, or NULL when request is done
+ * @param[in]  msg  Request message
+ */
+void
+clixon_plugin_statedata_async_client(struct client_entry *ce,
+                                     char                *msg)
+{
+    _statedata_async_ce = ce;
+    _statedata_async_msg = msg;
+}
+
+/*! Asynchronous state data of a plugin is done
+ *
+ * Call from a fd or timer callback of the plugin. The request handle is not valid after
+ * this call. Calls after the deadline CLICON_STATE_ASYNC_TIMEOUT are ignored.
+ * @param[in]  h      Clixon handle
+ * @param[in]  req    Request handle given to ca_statedata_async
+ * @param[in]  xstate State tree on the form <config>...</config>, consumed by this call.
+ *                    NULL if failed, with reason in clixon_err
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+int
+clixon_plugin_statedata_async_done(clixon_handle h,
+                                   void         *req,
+                                   cxobj        *xstate)
+{
+    statedata_async            *sa = NULL;
+    struct statedata_async_req *sr = (struct statedata_async_req *)req;
+
+    clicon_ptr_get(h, "state-async", (void**)&sa);
+    for (; sa != NULL; sa = sa->sa_next)
+        if (sr >= sa->sa_reqv && sr < sa->sa_reqv + sa->sa_len)
+            break;
+    if (sa == NULL || sr->sr_state != 0){ /* Too late */
+        if (xstate)
+            xml_free(xstate);
+        return 0;
+    }
+    if (xstate == NULL){
+        sr->sr_state = 2;
+        if ((sr->sr_reason = strdup(clixon_err_category() ? clixon_err_reason() : "failed")) == NULL){
+            clixon_err(OE_UNIX, errno, "strdup");
+            return -1;
+        }
+    }
+    else {
+        sr->sr_state = 1;
+        sr->sr_x = xstate;
+    }
+    if (--sa->sa_pending == 0 && !sa->sa_start)
+        return statedata_async_resume(sa);
+    return 0;
+}
+
+/*! Start asynchronous state data callbacks of a client request
+ *
+ * @param[in]  h      Clixon handle
+ * @param[in]  yspec  Yang spec
+ * @param[in]  nsc    Namespace context
+ * @param[in]  xpath  XPath
+ * @param[in]  yreq   Yang node of request, or NULL
+ * @retval     1      Plugins are collecting, reply is deferred
+ * @retval     0      OK, no plugin is collecting
+ * @retval    -1      Error
+ */
+static int
+statedata_async_start(clixon_handle h,
+                      yang_stmt    *yspec,
+                      cvec         *nsc,
+                      char         *xpath,
+                      yang_stmt    *yreq)
+{
+    int                         retval = -1;
+    client_entry               *ce = _statedata_async_ce;
+    clixon_plugin_t            *cp = NULL;
+    clixon_plugin_t           **cpv;
+    plgstatedata_async_t       *fn;
+    statedata_async            *sa = NULL;
+    statedata_async            *sa0 = NULL;
+    struct statedata_async_req *sr;
+    cbuf                       *cbkey = NULL;
+    uint32_t                    ttl;
+    uint32_t                    tmo;
+    struct timeval              t;
+    struct timeval              t1;
+    int                         n = 0;
+    int                         i;
+    int                         ret;
+
+    if (ce == NULL || _statedata_async_msg == NULL ||
+        statedata_async_find(h, ce->ce_id) != NULL)
+        return 0;
+    if (clixon_plugin_index(h, CLIXON_PLUGIN_CB(ca_statedata_async), &cpv, &n) < 0)
+        return -1;
+    for (i=0; i<n; i++) {
+        cp = cpv[i];
+        fn = clixon_plugin_api_get(cp)->ca_statedata_async;
+        if ((ret = statedata_plugin_match(cp, yspec, yreq)) < 0)
+            goto done;
+        if (ret == 0)
+            continue;
+        if ((ttl = statedata_cache_ttl(h, clixon_plugin_name_get(cp))) > 0){
+            if (cbkey == NULL && (cbkey = cbuf_new()) == NULL){
+                clixon_err(OE_UNIX, errno, "cbuf_new");
+                goto done;
+            }
+            cbuf_reset(cbkey);
+            statedata_cache_key(clixon_plugin_name_get(cp), nsc, xpath, cbkey);
+            if (statedata_cache_find(h, cbuf_get(cbkey), ttl, NULL) == 1)
+                continue;
+        }
+        if (sa == NULL){
+            if ((sa = calloc(1, sizeof(*sa))) == NULL ||
+                (sa->sa_reqv = calloc(n, sizeof(*sa->sa_reqv))) == NULL ||
+                (sa->sa_msg = strdup(_statedata_async_msg)) == NULL){
+                clixon_err(OE_UNIX, errno, "calloc");
+                goto done;
+            }
+            sa->sa_h = h;
+            sa->sa_id = ce->ce_id;
+            sa->sa_start = 1;
+            clicon_ptr_get(h, "state-async", (void**)&sa0);
+            sa->sa_next = sa0;
+            clicon_ptr_set(h, "state-async", sa);
+        }
+        sr = &sa->sa_reqv[sa->sa_len++];
+        sr->sr_sa = sa;
+        sr->sr_cp = cp;
+        sa->sa_pending++;
+        clixon_debug(CLIXON_DBG_BACKEND | CLIXON_DBG_DETAIL, "%s", clixon_plugin_name_get(cp));
+        if (fn(h, nsc, xpath, sr) < 0 &&
+            clixon_plugin_statedata_async_done(h, sr, NULL) < 0)
+            goto done;
+    }
+    if (sa == NULL)
+        goto ok;
+    sa->sa_start = 0;
+    if (sa->sa_pending == 0)
+        goto ok;
+    tmo = clicon_option_int(h, "CLICON_STATE_ASYNC_TIMEOUT");
+    gettimeofday(&t, NULL);
+    t1.tv_sec = tmo/1000;
+    t1.tv_usec = (tmo%1000)*1000;
+    timeradd(&t, &t1, &t);
+    if (clixon_event_reg_timeout(t, statedata_async_timeout, sa, "state data async") < 0)
+        goto done;
+    ce->ce_async = 1;
+    ce->ce_reply_deferred = 1;
+    sa = NULL;
+    retval = 1;
+    goto done;
+ ok:
+    sa = NULL;  /* All done while starting: used by caller */
+    retval = 0;
+ done:
+    if (sa)
+        statedata_async_rm(sa);
+    if (cbkey)
+        cbuf_free(cbkey);
+    return retval;
+}
+
+/*! Free asynchronous state data of all client requests, clients get no reply
+ *
+ * @param[in]  h      Clixon handle
+ * @retval     0      OK
+ */
+int
+clixon_plugin_statedata_async_exit(clixon_handle h)
+{
+    statedata_async *sa = NULL;
+
+    while (clicon_ptr_get(h, "state-async", (void**)&sa) == 0 && sa != NULL)
+        statedata_async_rm(sa);
+    clicon_ptr_del(h, "state-async");
+    return 0;
+}
+
+/*! Asynchronous rpc of a client, reply is sent by clixon_plugin_rpc_async_done
+ *
+ * @see clixon_plugin_rpc_async
+ */
+struct rpc_async{
+    struct rpc_async *ra_next;
+    clixon_handle     ra_h;
+    uint32_t          ra_id;   /* Session id of client */
+};
+typedef struct rpc_async rpc_async;
+
+static int rpc_async_timeout(int fd, void *arg);
+
+/*! Find asynchronous rpc given request handle, or session id if req is NULL
+ */
+static rpc_async *
+rpc_async_find(clixon_handle h,
+               void         *req,
+               uint32_t      id)
+{
+    rpc_async *ra = NULL;
+
+    clicon_ptr_get(h, "rpc-async", (void**)&ra);
+    for (; ra != NULL; ra = ra->ra_next)
+        if (req ? ra == (rpc_async *)req : ra->ra_id == id)
+            break;
+    return ra;
+}
+
+/*! Remove and free asynchronous rpc
+ */
+static void
+rpc_async_rm(rpc_async *ra)
+{
+    rpc_async  *ra0 = NULL;
+    rpc_async **rap;
+
+    clixon_event_unreg_timeout(rpc_async_timeout, ra);
+    clicon_ptr_get(ra->ra_h, "rpc-async", (void**)&ra0);
+    for (rap = &ra0; *rap != NULL; rap = &(*rap)->ra_next)
+        if (*rap == ra){
+            *rap = ra->ra_next;
+            break;
+        }
+    clicon_ptr_set(ra->ra_h, "rpc-async", ra0);
+    free(ra);
+}
+
+/*! Deadline of asynchronous rpc: reply with an error, later replies of the handler are ignored
+ */
+static int
+rpc_async_timeout(int   fd,
+                  void *arg)
+{
+    rpc_async *ra = (rpc_async *)arg;
+
+    clixon_debug(CLIXON_DBG_BACKEND, "client %u", ra->ra_id);
+    clixon_err(OE_PLUGIN, ETIMEDOUT, "Asynchronous rpc timed out");
+    return clixon_plugin_rpc_async_done(ra->ra_h, ra, NULL);
+}
+
+/*! Defer the reply of an rpc or action, to be sent later by clixon_plugin_rpc_async_done
+ *
+ * Call from an rpc or action callback registered with rpc_callback_register or
+ * action_callback_register, which then returns 0 without writing a reply.
+ * The handler completes later from a fd or timer callback of the event loop with
+ * clixon_plugin_rpc_async_done. A worker thread may signal completion to the event loop
+ * via a pipe registered with clixon_event_reg_fd.
+ * Other clients are served meanwhile. Reading from this client is suspended so that
+ * replies are in order.
+ * @param[in]  h        Clixon handle
+ * @param[in]  arg      Client entry, the arg parameter of the rpc callback
+ * @param[in]  timeout  Deadline in ms, after which an error is replied. 0: no deadline
+ * @retval     req      Request handle, valid until clixon_plugin_rpc_async_done, deadline
+ *                      or end of client session
+ * @retval     NULL     Error
+ * @code
+ *   if ((req = clixon_plugin_rpc_async(h, arg, 10000)) == NULL)
+ *      goto done;
+ *   ... start work, on completion:
+ *   clixon_plugin_rpc_async_done(h, req, cbret);
+ * @endcode
+ */
+void *
+clixon_plugin_rpc_async(clixon_handle h,
+                        void         *arg,
+                        uint32_t      timeout)
+{
+    client_entry  *ce = (client_entry *)arg;
+    rpc_async     *ra = NULL;
+    rpc_async     *ra0 = NULL;
+    struct timeval t;
+    struct timeval t1;
+
+    if (ce == NULL || ce->ce_handle != h){
+        clixon_err(OE_PLUGIN, EINVAL, "No client of rpc");
+        goto err;
+    }
+    if (ce->ce_async || rpc_async_find(h, NULL, ce->ce_id) != NULL){
+        clixon_err(OE_PLUGIN, EEXIST, "Reply of client %u is already deferred", ce->ce_id);
+        goto err;
+    }
+    if ((ra = calloc(1, sizeof(*ra))) == NULL){
+        clixon_err(OE_UNIX, errno, "calloc");
+        goto err;
+    }
+    ra->ra_h = h;
+    ra->ra_id = ce->ce_id;
+    if (timeout){
+        gettimeofday(&t, NULL);
+        t1.tv_sec = timeout/1000;
+        t1.tv_usec = (timeout%1000)*1000;
+        timeradd(&t, &t1, &t);
+        if (clixon_event_reg_timeout(t, rpc_async_timeout, ra, "rpc async") < 0)
+            goto err;
+    }
+    clicon_ptr_get(h, "rpc-async", (void**)&ra0);
+    ra->ra_next = ra0;
+    clicon_ptr_set(h, "rpc-async", ra);
+    clixon_debug(CLIXON_DBG_BACKEND, "client %u", ra->ra_id);
+    ce->ce_async = 1;
+    ce->ce_reply_deferred = 1;
+    return ra;
+ err:
+    if (ra)
+        free(ra);
+    return NULL;
+}
+
+/*! Asynchronous rpc is done: send its reply and resume reading from the client
+ *
+ * Call from a fd or timer callback of the event loop. The request handle is not valid after
+ * this call. Calls after the deadline are ignored.
+ * @param[in]  h      Clixon handle
+ * @param[in]  req    Request handle given by clixon_plugin_rpc_async
+ * @param[in]  cbret  Reply, eg <rpc-reply>..., or <rpc-error>. NULL if failed, with reason
+ *                    in clixon_err
+ * @retval     0      OK, or too late
+ * @retval    -1      Error
+ */
+int
+clixon_plugin_rpc_async_done(clixon_handle h,
+                             void         *req,
+                             cbuf         *cbret)
+{
+    int        retval = -1;
+    rpc_async *ra;
+    uint32_t   id;
+    cbuf      *cberr = NULL;
+    int        err = 0;
+
+    if ((ra = rpc_async_find(h, req, 0)) == NULL) /* Too late */
+        return 0;
+    id = ra->ra_id;
+    clixon_debug(CLIXON_DBG_BACKEND, "client %u", id);
+    rpc_async_rm(ra);
+    if (cbret == NULL || cbuf_len(cbret) == 0){
+        if ((cberr = cbuf_new()) == NULL){
+            clixon_err(OE_UNIX, errno, "cbuf_new");
+            goto done;
+        }
+        if (netconf_operation_failed(cberr, "application", "%s",
+                                     clixon_err_category()?clixon_err_reason():"failed") < 0)
+            goto done;
+        cbret = cberr;
+        err = 1;
+    }
+    if (backend_client_async_reply(h, id, cbuf_get(cbret), cbuf_len(cbret), err) < 0)
+        goto done;
+    retval = 0;
+ done:
+    if (cberr)
+        cbuf_free(cberr);
+    return retval;
+}
+
+/*! Free asynchronous rpc of a client that has closed its session
+ *
+ * Also without deadline, the pending rpc is freed. Later calls of
+ * clixon_plugin_rpc_async_done with its request handle are ignored.
+ * @param[in]  h      Clixon handle
+ * @param[in]  id     Session id of client
+ * @retval     0      OK
+ */
+int
+clixon_plugin_rpc_async_client_rm(clixon_handle h,
+                                  uint32_t      id)
+{
+    rpc_async *ra;
+
+    if ((ra = rpc_async_find(h, NULL, id)) != NULL){
+        clixon_debug(CLIXON_DBG_BACKEND, "client %u", id);
+        rpc_async_rm(ra);
+    }
+    return 0;
+}
+
+/*! Free asynchronous rpcs of all clients, clients get no reply
+ *
+ * @param[in]  h      Clixon handle
+ * @retval     0      OK
+ */
+int
+clixon_plugin_rpc_async_exit(clixon_handle h)
+{
+    rpc_async *ra = NULL;
+
+    while (clicon_ptr_get(h, "rpc-async", (void**)&ra) == 0 && ra != NULL)
+        rpc_async_rm(ra);
+    clicon_ptr_del(h, "rpc-async");
+    return 0;
+}
+
+/*! Get next plugin in plugin order from either of two plugin index vectors
+ *
+ * @param[in]     v1   Plugin vector of first callback
+ * @param[in]     n1   Length of v1
+ * @param[in,out] i1   Position in v1
+ * @param[in]     v2   Plugin vector of second callback
+ * @param[in]     n2   Length of v2
+ * @param[in,out] i2   Position in v2
+ * @retval        cp   Next plugin implementing either callback
+ * @retval        NULL No more plugins
+ * @see clixon_plugin_index
+ */
+static clixon_plugin_t *
+plugin_index_next2(clixon_plugin_t **v1,
+                   int               n1,
+                   int              *i1,
+                   clixon_plugin_t **v2,
+                   int               n2,
+                   int              *i2)
+{
+    clixon_plugin_t *cp;
+
+    if (*i1 < n1 &&
+        (*i2 >= n2 || clixon_plugin_nr_get(v1[*i1]) <= clixon_plugin_nr_get(v2[*i2]))){
+        cp = v1[(*i1)++];
+        if (*i2 < n2 && v2[*i2] == cp)
+            (*i2)++;
+        return cp;
+    }
+    if (*i2 < n2)
+        return v2[(*i2)++];
+    return NULL;
+}
+
 /*! Go through all backend statedata callbacks and collect state data
  *
  * This is internal system call, plugin is invoked (does not call) this function
@@ -327,10 +1622,12 @@ clixon_plugin_statedata_one(clixon_plugin_t *cp,
  * @param[in]     nsc     Namespace context
  * @param[in]     xpath   String with XPATH syntax. or NULL for all
  * @param[in,out] xret    State XML tree is merged with existing tree.
+ * @retval        2       Asynchronous callbacks are collecting, reply is deferred
  * @retval        1       OK
  * @retval        0       Statedata callback failed (xret set with netconf-error)
  * @retval       -1       Error
  * @note xret can be replaced in this function
+ * @see clixon_plugin_statedata_async_done
  */
 int
 clixon_plugin_statedata_all(clixon_handle h,
@@ -339,15 +1636,78 @@ clixon_plugin_statedata_all(clixon_handle h,
                             char         *xpath,
                             cxobj       **xret)
 {
-    int              retval = -1;
-    cxobj           *x = NULL;
-    clixon_plugin_t *cp = NULL;
-    cxobj           *xerr = NULL;
+    int               retval = -1;
+    cxobj            *x = NULL;
+    clixon_plugin_t  *cp = NULL;
+    clixon_plugin_t **cpv;
+    clixon_plugin_t **cpva;
+    int               cpn;
+    int               cpna;
+    int               i = 0;
+    int               ia = 0;
+    cxobj            *xerr = NULL;
+    cbuf             *cbkey = NULL;
+    yang_stmt        *yreq = NULL;
+    statedata_async  *sa = NULL;
+    struct statedata_async_req *sr;
+    uint32_t         ttl;
     int              ret;
 
     clixon_debug(CLIXON_DBG_BACKEND | CLIXON_DBG_DETAIL, "");
-    while ((cp = clixon_plugin_each(h, cp)) != NULL) {
-        if ((ret = clixon_plugin_statedata_one(cp, h, nsc, xpath, &x)) < 0)
+    if (statedata_request_yang(h, yspec, nsc, xpath, &yreq) < 0)
+        goto done;
+    /* Start asynchronous callbacks first, synchronous callbacks are called when they are done */
+    if ((ret = statedata_async_start(h, yspec, nsc, xpath, yreq)) < 0)
+        goto done;
+    if (ret == 1){
+        retval = 2;
+        goto done;
+    }
+    if (_statedata_async_ce)
+        sa = statedata_async_find(h, _statedata_async_ce->ce_id);
+    if (clixon_plugin_index(h, CLIXON_PLUGIN_CB(ca_statedata), &cpv, &cpn) < 0 ||
+        clixon_plugin_index(h, CLIXON_PLUGIN_CB(ca_statedata_async), &cpva, &cpna) < 0)
+        goto done;
+    while ((cp = plugin_index_next2(cpv, cpn, &i, cpva, cpna, &ia)) != NULL) {
+        /* Skip plugins whose state subtrees do not intersect the request */
+        if ((ret = statedata_plugin_match(cp, yspec, yreq)) < 0)
+            goto done;
+        if (ret == 0)
+            continue;
+        /* Identical request within TTL, also of requests queued while collecting */
+        if ((ttl = statedata_cache_ttl(h, clixon_plugin_name_get(cp))) > 0){
+            if (cbkey == NULL && (cbkey = cbuf_new()) == NULL){
+                clixon_err(OE_UNIX, errno, "cbuf_new");
+                goto done;
+            }
+            cbuf_reset(cbkey);
+            statedata_cache_key(clixon_plugin_name_get(cp), nsc, xpath, cbkey);
+            if ((ret = statedata_cache_find(h, cbuf_get(cbkey), ttl, &x)) < 0)
+                goto done;
+            if (ret == 1){
+                if (x == NULL)
+                    continue;
+                goto merge;
+            }
+        }
+        if (sa && (sr = statedata_async_req_find(sa, cp)) != NULL){
+            if (sr->sr_state == 2){
+                if (clixon_plugin_report_err_xml(h, &xerr,
+                                                 "Internal error, state callback in plugin %s failed: %s",
+                                                 clixon_plugin_name_get(cp), sr->sr_reason) < 0)
+                    goto done;
+                xml_free(*xret);
+                *xret = xerr;
+                xerr = NULL;
+                goto fail;
+            }
+            x = sr->sr_x;
+            sr->sr_x = NULL;
+            ret = 1;
+        }
+        else if (clixon_plugin_api_get(cp)->ca_statedata == NULL) /* Not in a client request */
+            continue;
+        else if ((ret = clixon_plugin_statedata_one(cp, h, nsc, xpath, &x)) < 0)
             goto done;
         if (ret == 0){
             /* error reason should be in clixon_err_reason */
@@ -360,11 +1720,14 @@ clixon_plugin_statedata_all(clixon_handle h,
             xerr = NULL;
             goto fail;
         }
-        if (x == NULL)
-            continue;
-        if (xml_child_nr(x) == 0){
+        if (x != NULL && xml_child_nr(x) == 0){
             xml_free(x);
             x = NULL;
+        }
+        if (x == NULL){
+            if (ttl > 0 &&
+                statedata_cache_add(h, cbuf_get(cbkey), ttl, NULL) < 0)
+                goto done;
             continue;
         }
         clixon_debug_xml(CLIXON_DBG_BACKEND | CLIXON_DBG_DETAIL, x, "%s STATE:", clixon_plugin_name_get(cp));
@@ -387,6 +1750,10 @@ clixon_plugin_statedata_all(clixon_handle h,
         /* XXX: only for state data and according to with-defaults setting */
         if (xml_default_nopresence(x, 2, 0) < 0)
             goto done;
+        if (ttl > 0 &&
+            statedata_cache_add(h, cbuf_get(cbkey), ttl, x) < 0)
+            goto done;
+    merge:
         if (xpath_first(x, nsc, "%s", xpath) != NULL){
             if ((ret = netconf_trymerge(x, yspec, xret)) < 0)
                 goto done;
@@ -400,6 +1767,10 @@ clixon_plugin_statedata_all(clixon_handle h,
     } /* while plugin */
     retval = 1;
  done:
+    if (sa)
+        statedata_async_rm(sa);
+    if (cbkey)
+        cbuf_free(cbkey);
     if (xerr)
         xml_free(xerr);
     if (x)
@@ -489,35 +1860,201 @@ clixon_pagination_cb_register(clixon_handle    h,
                               char            *xpath,
                               void            *arg)
 {
-    int                       retval = -1;
-    dispatcher_definition     x = {xpath, fn, arg};
-    dispatcher_entry_t       *htable = NULL;
-
-    clicon_ptr_get(h, "pagination-entries", (void**)&htable);
-    if (dispatcher_register_handler(&htable, &x) < 0){
-        clixon_err(OE_PLUGIN, errno, "dispatcher");
+    int                       retval = -1;
+    dispatcher_definition     x = {xpath, fn, arg};
+    dispatcher_entry_t       *htable = NULL;
+
+    clicon_ptr_get(h, "pagination-entries", (void**)&htable);
+    if (dispatcher_register_handler(&htable, &x) < 0){
+        clixon_err(OE_PLUGIN, errno, "dispatcher");
+        goto done;
+    }
+    if (clicon_ptr_set(h, "pagination-entries", htable) < 0)
+        goto done;
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Free pagination callback structure
+ *
+ * @param[in]  h      Clixon handle
+ */
+int
+clixon_pagination_free(clixon_handle h)
+{
+    dispatcher_entry_t       *htable = NULL;
+
+    clicon_ptr_get(h, "pagination-entries", (void**)&htable);
+    if (htable)
+        dispatcher_free(htable);
+    return 0;
+}
+
+/* Changes of plugins with ca_trans_subtrees in a transaction
+ * Built at the first plugin call of a transaction, after the diff is computed
+ */
+struct trans_index {
+    clixon_plugin_t    **ti_cpv;   /* Plugins with subtrees */
+    transaction_data_t  *ti_tdv;   /* Transaction of each plugin with its changes only */
+    int                  ti_len;
+};
+
+/*! Free index of a transaction, XML trees are not freed
+ */
+static int
+plugin_transaction_index_free(struct trans_index *ti)
+{
+    transaction_data_t *td;
+    int                 i;
+
+    for (i=0; i<ti->ti_len; i++){
+        td = &ti->ti_tdv[i];
+        if (td->td_dvec)
+            free(td->td_dvec);
+        if (td->td_avec)
+            free(td->td_avec);
+        if (td->td_scvec)
+            free(td->td_scvec);
+        if (td->td_tcvec)
+            free(td->td_tcvec);
+    }
+    if (ti->ti_cpv)
+        free(ti->ti_cpv);
+    if (ti->ti_tdv)
+        free(ti->ti_tdv);
+    free(ti);
+    return 0;
+}
+
+/*! Build index of changes of plugins with ca_trans_subtrees
+ *
+ * @param[in]  h       Clixon handle
+ * @param[in]  td      Transaction data with computed diff
+ * @retval     0       OK, td->td_index is set
+ * @retval    -1       Error
+ */
+static int
+plugin_transaction_index(clixon_handle       h,
+                         transaction_data_t *td)
+{
+    int                 retval = -1;
+    struct trans_index *ti = NULL;
+    clixon_plugin_t    *cp = NULL;
+    transaction_data_t *tdp;
+    yang_stmt          *yspec;
+    yang_stmt         **yv = NULL;
+    const char        **paths;
+    int                 yn;
+    int                 j;
+    int                 n = 0;
+    size_t              clen;
+    size_t              i;
+
+    if ((yspec = clicon_dbspec_yang(h)) == NULL){
+        clixon_err(OE_YANG, ENOENT, "No yang spec");
         goto done;
     }
-    if (clicon_ptr_set(h, "pagination-entries", htable) < 0)
+    if ((ti = calloc(1, sizeof(*ti))) == NULL){
+        clixon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    while ((cp = clixon_plugin_each(h, cp)) != NULL)
+        n++;
+    if ((ti->ti_cpv = calloc(n+1, sizeof(*ti->ti_cpv))) == NULL ||
+        (ti->ti_tdv = calloc(n+1, sizeof(*ti->ti_tdv))) == NULL){
+        clixon_err(OE_UNIX, errno, "calloc");
         goto done;
+    }
+    while ((cp = clixon_plugin_each(h, cp)) != NULL){
+        if ((paths = clixon_plugin_api_get(cp)->ca_trans_subtrees) == NULL)
+            continue;
+        for (yn=0; paths[yn]; yn++);
+        if (yv)
+            free(yv);
+        if ((yv = calloc(yn+1, sizeof(*yv))) == NULL){
+            clixon_err(OE_UNIX, errno, "calloc");
+            goto done;
+        }
+        for (j=0; j<yn; j++)
+            if (plugin_subtree_yang(yspec, paths[j], &yv[j]) < 0)
+                goto done;
+        tdp = &ti->ti_tdv[ti->ti_len];
+        ti->ti_cpv[ti->ti_len++] = cp;
+        tdp->td_id = td->td_id;
+        tdp->td_src = td->td_src;
+        tdp->td_target = td->td_target;
+        for (i=0; i<td->td_dlen; i++)
+            if (plugin_subtree_match(td->td_dvec[i], yv, yn) &&
+                cxvec_append(td->td_dvec[i], &tdp->td_dvec, &tdp->td_dlen) < 0)
+                goto done;
+        for (i=0; i<td->td_alen; i++)
+            if (plugin_subtree_match(td->td_avec[i], yv, yn) &&
+                cxvec_append(td->td_avec[i], &tdp->td_avec, &tdp->td_alen) < 0)
+                goto done;
+        for (i=0; i<td->td_clen; i++){
+            if (!plugin_subtree_match(td->td_tcvec[i], yv, yn))
+                continue;
+            clen = tdp->td_clen;
+            if (cxvec_append(td->td_scvec[i], &tdp->td_scvec, &clen) < 0)
+                goto done;
+            if (cxvec_append(td->td_tcvec[i], &tdp->td_tcvec, &tdp->td_clen) < 0)
+                goto done;
+        }
+        clixon_debug(CLIXON_DBG_BACKEND | CLIXON_DBG_DETAIL, "%s: del:%zu add:%zu chg:%zu",
+                     clixon_plugin_name_get(cp), tdp->td_dlen, tdp->td_alen, tdp->td_clen);
+    }
+    td->td_index = ti;
+    ti = NULL;
     retval = 0;
  done:
+    if (yv)
+        free(yv);
+    if (ti)
+        plugin_transaction_index_free(ti);
     return retval;
 }
 
-/*! Free pagination callback structure
+/*! Get transaction data of a plugin call
  *
- * @param[in]  h      Clixon handle
+ * Plugins with ca_trans_subtrees get their own transaction with the changes of their
+ * subtrees only. Other plugins get the whole transaction.
+ * @param[in]  h       Clixon handle
+ * @param[in]  cp      Plugin handle
+ * @param[in]  td      Transaction data
+ * @param[out] tdp     Transaction data of plugin
+ * @retval     1       OK, call plugin with tdp
+ * @retval     0       OK, plugin has no changes, do not call it
+ * @retval    -1       Error
  */
-int
-clixon_pagination_free(clixon_handle h)
+static int
+plugin_transaction_view(clixon_handle        h,
+                        clixon_plugin_t     *cp,
+                        transaction_data_t  *td,
+                        transaction_data_t **tdp)
 {
-    dispatcher_entry_t       *htable = NULL;
-
-    clicon_ptr_get(h, "pagination-entries", (void**)&htable);
-    if (htable)
-        dispatcher_free(htable);
-    return 0;
+    struct trans_index *ti;
+    transaction_data_t *tdv;
+    int                 i;
+
+    *tdp = td;
+    if (clixon_plugin_api_get(cp)->ca_trans_subtrees == NULL)
+        return 1;
+    if (td->td_index == NULL &&
+        plugin_transaction_index(h, td) < 0)
+        return -1;
+    ti = (struct trans_index *)td->td_index;
+    for (i=0; i<ti->ti_len; i++)
+        if (ti->ti_cpv[i] == cp)
+            break;
+    if (i == ti->ti_len) /* Plugin loaded after index was built */
+        return 1;
+    tdv = &ti->ti_tdv[i];
+    if (tdv->td_dlen == 0 && tdv->td_alen == 0 && tdv->td_clen == 0)
+        return 0;
+    tdv->td_arg = td->td_arg;
+    *tdp = tdv;
+    return 1;
 }
 
 /*! Create and initialize a validate/commit transaction 
@@ -532,8 +2069,8 @@ transaction_new(void)
     transaction_data_t *td;
     static uint64_t     id = 0; /* Global transaction id */
 
-    if ((td = malloc(sizeof(*td))) == NULL){
-        clixon_err(OE_CFG, errno, "malloc");
+    if ((td = clixon_mem_malloc(CLIXON_MEM_TRANSACTION, sizeof(*td))) == NULL){
+        clixon_err(OE_CFG, errno, "clixon_mem_malloc");
         return NULL;
     }
     memset(td, 0, sizeof(*td));
@@ -582,7 +2119,9 @@ transaction_free1(transaction_data_t *td,
         free(td->td_scvec);
     if (td->td_tcvec)
         free(td->td_tcvec);
-    free(td);
+    if (td->td_index)
+        plugin_transaction_index_free(td->td_index);
+    clixon_mem_free(td);
     return 0;
 }
 
@@ -593,14 +2132,24 @@ plugin_transaction_call_one(clixon_handle       h,
 			    const char         *fnname,
 			    transaction_data_t *td)
 {
-    int  retval = -1;
-    int  rv;
-    void *wh = NULL;
+    int                 retval = -1;
+    int                 rv;
+    void               *wh = NULL;
+    transaction_data_t *tdv;
+    struct trans_timer  tt;
 
+    if ((rv = plugin_transaction_view(h, cp, td, &tdv)) < 0)
+        goto done;
+    if (rv == 0)
+        goto ok;
     wh = NULL;
     if (clixon_resource_check(h, &wh, clixon_plugin_name_get(cp), fnname) < 0)
         goto done;
-    rv = fn(h, (transaction_data)td);
+    transaction_profile_start(&tt, 1);
+    rv = fn(h, (transaction_data)tdv);
+    if (transaction_profile_stop(&tt, fnname, clixon_plugin_name_get(cp)) < 0)
+        goto done;
+    td->td_arg = tdv->td_arg;
     if (clixon_resource_check(h, &wh, clixon_plugin_name_get(cp), fnname) < 0)
         goto done;
     if (rv < 0) {
@@ -610,8 +2159,453 @@ plugin_transaction_call_one(clixon_handle       h,
                        fnname, clixon_plugin_name_get(cp));
         goto done;
     }
+ ok:
+    retval = 0;
+ done:
+    return retval;
+}
+
+/* Transaction callback of one plugin in a batch of parallel-safe callbacks */
+struct trans_worker {
+    clixon_handle       tw_h;
+    clixon_plugin_t    *tw_cp;
+    trans_cb_t         *tw_fn;
+    transaction_data_t *tw_td;
+    int                 tw_nr;      /* Position of plugin, first is 1 */
+    int                 tw_rv;      /* Return value of callback */
+    uint64_t            tw_usec;    /* Wall time of callback, see CLICON_TRANSACTION_PROFILE */
+    uint64_t            tw_cpu;     /* CPU time of callback */
+    pid_t               tw_pid;     /* Worker process, or 0 if run by the backend */
+    int                 tw_fd;      /* Read end of reply pipe of worker, or -1 */
+};
+
+/*! Get transaction callback of plugin given its plugin index key
+ */
+static trans_cb_t *
+plugin_transaction_cb_get(clixon_plugin_t *cp,
+                          size_t           cb)
+{
+    return *(trans_cb_t **)((char *)clixon_plugin_api_get(cp) + cb);
+}
+
+/*! Run one callback of a parallel batch
+ */
+static void
+plugin_transaction_worker(struct trans_worker *tw)
+{
+    struct trans_timer tt;
+
+    transaction_profile_start(&tt, 0);
+    tw->tw_rv = tw->tw_fn(tw->tw_h, (transaction_data)tw->tw_td);
+    transaction_profile_elapsed(&tt, &tw->tw_usec, &tw->tw_cpu);
+    clixon_trace_end(tt.tt_trace, CLIXON_DBG_BACKEND, "plugin_transaction", clixon_plugin_name_get(tw->tw_cp));
+}
+
+/*! Append a string including its terminating null to a worker reply
+ */
+static int
+plugin_transaction_reply_add(cbuf       *cb,
+                             const char *str)
+{
+    return cbuf_append_buf(cb, (void*)str, strlen(str)+1);
+}
+
+/*! Run one callback of a parallel batch in a forked worker process and write reply
+ *
+ * The reply is null-separated strings: return value, wall and CPU time, clixon_err category,
+ * subnr and reason, followed by name and value pairs of a clixon_plugin_rpc_err() error.
+ * Does not return.
+ * @param[in]  tw  Callback
+ * @param[in]  fd  Write end of reply pipe
+ */
+static void
+plugin_transaction_child(struct trans_worker *tw,
+                         int                  fd)
+{
+    cbuf   *cb;
+    cvec   *cvv;
+    cg_var *cv = NULL;
+    char    buf[64];
+    size_t  n = 0;
+    ssize_t len;
+
+    clixon_err_reset();
+    plugin_transaction_worker(tw);
+    if ((cb = cbuf_new()) == NULL)
+        _exit(1);
+    snprintf(buf, sizeof(buf), "%d", tw->tw_rv);
+    plugin_transaction_reply_add(cb, buf);
+    snprintf(buf, sizeof(buf), "%" PRIu64, tw->tw_usec);
+    plugin_transaction_reply_add(cb, buf);
+    snprintf(buf, sizeof(buf), "%" PRIu64, tw->tw_cpu);
+    plugin_transaction_reply_add(cb, buf);
+    snprintf(buf, sizeof(buf), "%d", clixon_err_category());
+    plugin_transaction_reply_add(cb, buf);
+    snprintf(buf, sizeof(buf), "%d", clixon_err_subnr());
+    plugin_transaction_reply_add(cb, buf);
+    plugin_transaction_reply_add(cb, clixon_err_reason());
+    if ((cvv = clicon_data_cvec_get(tw->tw_h, "rpc_err")) != NULL)
+        while ((cv = cvec_each(cvv, cv)) != NULL){
+            plugin_transaction_reply_add(cb, cv_name_get(cv));
+            plugin_transaction_reply_add(cb, cv_string_get(cv));
+        }
+    while (n < cbuf_len(cb)){
+        if ((len = write(fd, cbuf_get(cb)+n, cbuf_len(cb)-n)) < 0){
+            if (errno == EINTR)
+                continue;
+            _exit(1);
+        }
+        n += len;
+    }
+    close(fd);
+    _exit(0); /* Dont exit() here, parent state must not be flushed */
+}
+
+/*! Read reply of a forked worker and set result and error of its callback
+ *
+ * Set clixon_err and rpc error of the worker only if seterr is set. A worker that exits
+ * without a valid reply is a failed callback.
+ * @param[in]  h       Clixon handle
+ * @param[in]  tw      Callback
+ * @param[in]  seterr  Set error of failed callback
+ * @retval     0       OK
+ * @retval    -1       Error
+ * @see plugin_transaction_child
+ */
+static int
+plugin_transaction_reply(clixon_handle        h,
+                         struct trans_worker *tw,
+                         int                  seterr)
+{
+    int      retval = -1;
+    cbuf    *cb = NULL;
+    cvec    *cvv = NULL;
+    char    *fields[6];
+    char    *p;
+    char    *end;
+    char    *name;
+    char     buf[1024];
+    ssize_t  len;
+    int      status;
+    int      ok;
+    int      i;
+
+    if ((cb = cbuf_new()) == NULL){
+        clixon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    while ((len = read(tw->tw_fd, buf, sizeof(buf))) != 0){
+        if (len < 0){
+            if (errno == EINTR)
+                continue;
+            break;
+        }
+        if (cbuf_append_buf(cb, buf, len) < 0){
+            clixon_err(OE_UNIX, errno, "cbuf_append_buf");
+            goto done;
+        }
+    }
+    close(tw->tw_fd);
+    tw->tw_fd = -1;
+    ok = (waitpid(tw->tw_pid, &status, 0) == tw->tw_pid &&
+          WIFEXITED(status) && WEXITSTATUS(status) == 0 && len == 0);
+    tw->tw_pid = 0;
+    p = cbuf_get(cb);
+    end = p + cbuf_len(cb);
+    for (i=0; ok && i<6; i++){
+        if (p >= end || memchr(p, '\0', end-p) == NULL)
+            ok = 0;
+        else {
+            fields[i] = p;
+            p += strlen(p) + 1;
+        }
+    }
+    if (!ok){
+        tw->tw_rv = -1;
+        if (seterr)
+            clixon_err(OE_PLUGIN, 0, "Worker of plugin %s exited without reply",
+                       clixon_plugin_name_get(tw->tw_cp));
+        goto ok;
+    }
+    tw->tw_rv = atoi(fields[0]);
+    tw->tw_usec = strtoull(fields[1], NULL, 10);
+    tw->tw_cpu = strtoull(fields[2], NULL, 10);
+    if (tw->tw_rv >= 0 || !seterr)
+        goto ok;
+    if (atoi(fields[3]))
+        clixon_err(atoi(fields[3]), atoi(fields[4]), "%s", fields[5]);
+    if (p < end){
+        if ((cvv = cvec_new(0)) == NULL){
+            clixon_err(OE_UNIX, errno, "cvec_new");
+            goto done;
+        }
+        while (p < end && memchr(p, '\0', end-p) != NULL){
+            name = p;
+            p += strlen(p) + 1;
+            if (p >= end || memchr(p, '\0', end-p) == NULL)
+                break;
+            if (cvec_add_string(cvv, name, p) < 0)
+                goto done;
+            p += strlen(p) + 1;
+        }
+        if (cvec_find_str(cvv, "tag") != NULL &&
+            clixon_plugin_rpc_err(h, cvec_find_str(cvv, "ns"), cvec_find_str(cvv, "type"),
+                                  cvec_find_str(cvv, "tag"), cvec_find_str(cvv, "info"),
+                                  cvec_find_str(cvv, "severity"),
+                                  cvec_find_str(cvv, "message") ? "%s" : NULL,
+                                  cvec_find_str(cvv, "message")) < 0)
+            goto done;
+    }
+ ok:
+    retval = 0;
+ done:
+    if (cvv)
+        cvec_free(cvv);
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+}
+
+/*! Run a batch of parallel-safe callbacks concurrently and wait for all of them
+ *
+ * Each callback of a batch of two or more runs in a forked worker process, on a
+ * copy-on-write image of the backend. Results, profile times and errors are sent back to
+ * the backend in a pipe, see plugin_transaction_child(). Other changes made by a callback
+ * in the worker, such as to memory of the plugin or to the transaction argument, are lost.
+ * Callbacks whose worker can not be forked run in the backend.
+ * Resource checks are not made since they are process-wide.
+ * The error of the first failed callback in plugin order is set.
+ * @param[in]  h       Clixon handle
+ * @param[in]  twv     Vector of callbacks
+ * @param[in]  n       Length of twv
+ * @param[in]  fnname  Name of callback for logs
+ * @retval     n       Number of failed callbacks, 0 if all succeeded
+ * @retval    -1       Error
+ */
+static int
+plugin_transaction_batch(clixon_handle        h,
+                         struct trans_worker *twv,
+                         int                  n,
+                         const char          *fnname)
+{
+    int   retval = -1;
+    int   i;
+    int   failed = 0;
+    int   fd[2];
+    pid_t pid;
+    int   status;
+
+    clixon_debug(CLIXON_DBG_BACKEND | CLIXON_DBG_DETAIL, "%s: %d plugins", fnname, n);
+    for (i=0; i<n; i++){
+        twv[i].tw_pid = 0;
+        twv[i].tw_fd = -1;
+    }
+    for (i=0; i<n; i++){
+        if (n > 1 && pipe(fd) == 0){
+            if ((pid = fork()) == 0){ /* Worker */
+                close(fd[0]);
+                plugin_transaction_child(&twv[i], fd[1]);
+            }
+            close(fd[1]);
+            if (pid > 0){
+                twv[i].tw_pid = pid;
+                twv[i].tw_fd = fd[0];
+                continue;
+            }
+            close(fd[0]);
+        }
+        plugin_transaction_worker(&twv[i]);
+    }
+    for (i=0; i<n; i++){
+        if (twv[i].tw_pid != 0 &&
+            plugin_transaction_reply(h, &twv[i], failed == 0) < 0)
+            goto done;
+        transaction_profile_add(fnname, clixon_plugin_name_get(twv[i].tw_cp),
+                                twv[i].tw_usec, twv[i].tw_cpu);
+        if (twv[i].tw_rv >= 0)
+            continue;
+        if (failed++ == 0 && !clixon_plugin_rpc_err_set(h) && !clixon_err_category())
+            /* sanity: log if err is not called ! */
+            clixon_log(h, LOG_NOTICE, "%s: Plugin '%s' callback does not make clixon_err or clixon_plugin_rpc_err call on error",
+                       fnname, clixon_plugin_name_get(twv[i].tw_cp));
+    }
+    retval = failed;
+ done:
+    for (i=0; i<n; i++){
+        if (twv[i].tw_fd != -1)
+            close(twv[i].tw_fd);
+        if (twv[i].tw_pid != 0){
+            kill(twv[i].tw_pid, SIGKILL);
+            waitpid(twv[i].tw_pid, &status, 0);
+        }
+    }
+    return retval;
+}
+
+/*! Check if plugin is a failed member of a batch
+ */
+static int
+plugin_transaction_failed(clixon_plugin_t     *cp,
+                          struct trans_worker *twv,
+                          int                  n)
+{
+    int i;
+
+    for (i=0; i<n; i++)
+        if (twv[i].tw_cp == cp)
+            return twv[i].tw_rv < 0;
+    return 0;
+}
+
+/*! Revert a commit
+ *
+ * @param[in]  h   CLICON handle
+ * @param[in]  td  Transaction data
+ * @param[in]  nr  The plugin where an error occured. 
+ * @param[in]  twv Batch of parallel callbacks whose failed plugins are not reverted, or NULL
+ * @param[in]  n   Length of twv
+ * @retval     0       OK
+ * @retval    -1       Error
+ * The revert is made in plugin before this one. Eg if error occurred in
+ * plugin 2, then the revert will be made in plugins 1 and 0.
+ */
+static int
+plugin_transaction_revert_all(clixon_handle        h,
+                              transaction_data_t  *td,
+                              int                  nr,
+                              struct trans_worker *twv,
+                              int                  n)
+{
+    int                 retval = 0;
+    clixon_plugin_t    *cp = NULL;
+    trans_cb_t         *fn;
+    transaction_data_t *tdv;
+
+    while ((cp = clixon_plugin_each_revert(h, cp, nr)) != NULL) {
+        if ((fn = clixon_plugin_api_get(cp)->ca_trans_revert) == NULL)
+            continue;
+        if (plugin_transaction_failed(cp, twv, n))
+            continue;
+        if (plugin_transaction_view(h, cp, td, &tdv) <= 0)
+            continue;
+        if ((retval = fn(h, (transaction_data)tdv)) < 0){
+            clixon_log(h, LOG_NOTICE, "%s: Plugin '%s' trans_revert callback failed",
+                           __func__, clixon_plugin_name_get(cp));
+                break;
+        }
+    }
+    return retval; /* ignore errors */
+}
+
+/*! Revert a commit for failed plugin
+ * The commit failed is called for only failed plugin before revert all cb.
+ */
+static int
+plugin_transaction_commit_failed(clixon_plugin_t    *cp,
+                                 clixon_handle       h,
+                                 transaction_data_t *td)
+{
+    trans_cb_t *fn;
+
+    if ((fn = clixon_plugin_api_get(cp)->ca_trans_commit_failed) != NULL)
+        return plugin_transaction_call_one(h, cp, fn, __func__, td);
+    return 0;
+}
+
+/*! Call a transaction callback in all plugins, concurrently in plugins declaring it parallel-safe
+ *
+ * Plugins are called in plugin order, except that consecutive plugins with the callback
+ * flagged in ca_trans_parallel run as one batch in worker processes. Plugins without the
+ * callback do not break a batch.
+ * On commit error, commit_failed is called in the failed plugins, and revert in all other
+ * plugins up to the failed plugin, or up to the end of a failed batch.
+ * @param[in]  h       Clixon handle
+ * @param[in]  td      Transaction data
+ * @param[in]  cb      Callback, plugin index key, eg CLIXON_PLUGIN_CB(ca_trans_commit)
+ * @param[in]  flag    CA_PARALLEL_VALIDATE or CA_PARALLEL_COMMIT, or 0 if never parallel
+ * @param[in]  fnname  Name of callback for logs
+ * @retval     0       OK
+ * @retval    -1       Error: one of the plugin callbacks returned error
+ */
+static int
+plugin_transaction_call_all(clixon_handle       h,
+                            transaction_data_t *td,
+                            size_t              cb,
+                            int                 flag,
+                            const char         *fnname)
+{
+    int                  retval = -1;
+    clixon_plugin_t     *cp = NULL;
+    clixon_plugin_t    **cpv;
+    trans_cb_t          *fn = NULL;
+    struct trans_worker *twv = NULL;
+    struct trans_worker *tw;
+    transaction_data_t  *tdv;
+    int                  len = 0;
+    int                  n = 0;
+    int                  nr = 0;
+    int                  cpn;
+    int                  i = 0;
+    int                  ret;
+
+    if (clixon_plugin_index(h, cb, &cpv, &cpn) < 0)
+        goto done;
+    do {
+        cp = i < cpn ? cpv[i++] : NULL;
+        if (cp != NULL){
+            nr = clixon_plugin_nr_get(cp) + 1;
+            fn = plugin_transaction_cb_get(cp, cb);
+            if (clixon_plugin_api_get(cp)->ca_trans_parallel & flag){
+                if ((ret = plugin_transaction_view(h, cp, td, &tdv)) < 0)
+                    goto done;
+                if (ret == 0)
+                    continue;
+                if (n == len){
+                    len = len ? 2*len : 8;
+                    if ((tw = realloc(twv, len*sizeof(*twv))) == NULL){
+                        clixon_err(OE_UNIX, errno, "realloc");
+                        goto done;
+                    }
+                    twv = tw;
+                }
+                tw = &twv[n++];
+                memset(tw, 0, sizeof(*tw));
+                tw->tw_h = h;
+                tw->tw_cp = cp;
+                tw->tw_fn = fn;
+                tw->tw_td = tdv;
+                tw->tw_nr = nr;
+                continue;
+            }
+        }
+        if (n > 0){ /* Run batch before next sequential plugin, or at end */
+            if ((ret = plugin_transaction_batch(h, twv, n, fnname)) < 0)
+                goto done;
+            if (ret > 0){
+                if (flag == CA_PARALLEL_COMMIT){
+                    for (tw=twv; tw<twv+n; tw++)
+                        if (tw->tw_rv < 0)
+                            plugin_transaction_commit_failed(tw->tw_cp, h, td);
+                    plugin_transaction_revert_all(h, td, twv[n-1].tw_nr, twv, n);
+                }
+                goto done;
+            }
+            n = 0;
+        }
+        if (cp != NULL && plugin_transaction_call_one(h, cp, fn, fnname, td) < 0){
+            if (flag == CA_PARALLEL_COMMIT){
+                /* First make an effort ro revert transaction for the failed plugin */
+                plugin_transaction_commit_failed(cp, h, td);
+                /* Make an effort to revert transaction */
+                plugin_transaction_revert_all(h, td, nr-1, NULL, 0);
+            }
+            goto done;
+        }
+    } while (cp != NULL);
     retval = 0;
  done:
+    if (twv)
+        free(twv);
     return retval;
 }
 
@@ -648,16 +2642,23 @@ int
 plugin_transaction_begin_all(clixon_handle       h,
                              transaction_data_t *td)
 {
-    int            retval = -1;
-    clixon_plugin_t *cp = NULL;
+    int                retval = -1;
+    clixon_plugin_t  **cpv;
+    int                cpn;
+    int                i;
+    struct trans_timer tt;
 
     clixon_debug(CLIXON_DBG_BACKEND | CLIXON_DBG_DETAIL, "");
-    while ((cp = clixon_plugin_each(h, cp)) != NULL) {
-        if (plugin_transaction_begin_one(cp, h, td) < 0)
+    transaction_profile_start(&tt, 0);
+    if (clixon_plugin_index(h, CLIXON_PLUGIN_CB(ca_trans_begin), &cpv, &cpn) < 0)
+        goto done;
+    for (i=0; i<cpn; i++) {
+        if (plugin_transaction_begin_one(cpv[i], h, td) < 0)
             goto done;
     }
     retval = 0;
  done:
+    transaction_profile_stop(&tt, __func__, NULL);
     return retval;
 }
 
@@ -692,15 +2693,13 @@ int
 plugin_transaction_validate_all(clixon_handle       h,
                                 transaction_data_t *td)
 {
-    int            retval = -1;
-    clixon_plugin_t *cp = NULL;
+    int                retval;
+    struct trans_timer tt;
 
-    while ((cp = clixon_plugin_each(h, cp)) != NULL) {
-        if (plugin_transaction_validate_one(cp, h, td) < 0)
-            goto done;
-    }
-    retval = 0;
- done:
+    transaction_profile_start(&tt, 0);
+    retval = plugin_transaction_call_all(h, td, CLIXON_PLUGIN_CB(ca_trans_validate),
+                                         CA_PARALLEL_VALIDATE, "plugin_transaction_validate_one");
+    transaction_profile_stop(&tt, __func__, NULL);
     return retval;
 }
 
@@ -738,65 +2737,16 @@ int
 plugin_transaction_complete_all(clixon_handle       h,
                                 transaction_data_t *td)
 {
-    int            retval = -1;
-    clixon_plugin_t *cp = NULL;
+    int                retval;
+    struct trans_timer tt;
 
-    while ((cp = clixon_plugin_each(h, cp)) != NULL) {
-        if (plugin_transaction_complete_one(cp, h, td) < 0)
-            goto done;
-    }
-    retval = 0;
- done:
+    transaction_profile_start(&tt, 0);
+    retval = plugin_transaction_call_all(h, td, CLIXON_PLUGIN_CB(ca_trans_complete),
+                                         0, "plugin_transaction_complete_one");
+    transaction_profile_stop(&tt, __func__, NULL);
     return retval;
 }
 
-/*! Revert a commit
- *
- * @param[in]  h   CLICON handle
- * @param[in]  td  Transaction data
- * @param[in]  nr  The plugin where an error occured. 
- * @retval     0       OK
- * @retval    -1       Error
- * The revert is made in plugin before this one. Eg if error occurred in
- * plugin 2, then the revert will be made in plugins 1 and 0.
- */
-static int
-plugin_transaction_revert_all(clixon_handle       h,
-                              transaction_data_t *td,
-                              int                 nr)
-{
-    int              retval = 0;
-    clixon_plugin_t *cp = NULL;
-    trans_cb_t      *fn;
-
-    while ((cp = clixon_plugin_each_revert(h, cp, nr)) != NULL) {
-        if ((fn = clixon_plugin_api_get(cp)->ca_trans_revert) == NULL)
-            continue;
-
-        if ((retval = fn(h, (transaction_data)td)) < 0){
-            clixon_log(h, LOG_NOTICE, "%s: Plugin '%s' trans_revert callback failed",
-                           __func__, clixon_plugin_name_get(cp));
-                break;
-        }
-    }
-    return retval; /* ignore errors */
-}
-
-/*! Revert a commit for failed plugin
- * The commit failed is called for only failed plugin before revert all cb.
- */
-static int
-plugin_transaction_commit_failed(clixon_plugin_t    *cp,
-                                 clixon_handle       h,
-                                 transaction_data_t *td)
-{
-    trans_cb_t *fn;
-
-    if ((fn = clixon_plugin_api_get(cp)->ca_trans_commit_failed) != NULL)
-        return plugin_transaction_call_one(h, cp, fn, __func__, td);
-    return 0;
-}
-
 /*! Call single plugin transaction_commit() in a commit transaction
  *
  * @param[in]  cp      Plugin handle
@@ -831,22 +2781,13 @@ int
 plugin_transaction_commit_all(clixon_handle       h,
                               transaction_data_t *td)
 {
-    int            retval = -1;
-    clixon_plugin_t *cp = NULL;
-    int            i=0;
+    int                retval;
+    struct trans_timer tt;
 
-    while ((cp = clixon_plugin_each(h, cp)) != NULL) {
-        i++;
-        if (plugin_transaction_commit_one(cp, h, td) < 0){
-            /* First make an effort ro revert transaction for the failed plugin */
-            plugin_transaction_commit_failed(cp, h, td);
-            /* Make an effort to revert transaction */
-            plugin_transaction_revert_all(h, td, i-1);
-            goto done;
-        }
-    }
-    retval = 0;
- done:
+    transaction_profile_start(&tt, 0);
+    retval = plugin_transaction_call_all(h, td, CLIXON_PLUGIN_CB(ca_trans_commit),
+                                         CA_PARALLEL_COMMIT, "plugin_transaction_commit_one");
+    transaction_profile_stop(&tt, __func__, NULL);
     return retval;
 }
 
@@ -882,15 +2823,22 @@ int
 plugin_transaction_commit_done_all(clixon_handle       h,
                                    transaction_data_t *td)
 {
-    int            retval = -1;
-    clixon_plugin_t *cp = NULL;
-
-    while ((cp = clixon_plugin_each(h, cp)) != NULL) {
-        if (plugin_transaction_commit_done_one(cp, h, td) < 0)
+    int                retval = -1;
+    clixon_plugin_t  **cpv;
+    int                cpn;
+    int                i;
+    struct trans_timer tt;
+
+    transaction_profile_start(&tt, 0);
+    if (clixon_plugin_index(h, CLIXON_PLUGIN_CB(ca_trans_commit_done), &cpv, &cpn) < 0)
+        goto done;
+    for (i=0; i<cpn; i++) {
+        if (plugin_transaction_commit_done_one(cpv[i], h, td) < 0)
             goto done;
     }
     retval = 0;
  done:
+    transaction_profile_stop(&tt, __func__, NULL);
     return retval;
 }
 
@@ -925,16 +2873,23 @@ int
 plugin_transaction_end_all(clixon_handle h,
                            transaction_data_t *td)
 {
-    int            retval = -1;
-    clixon_plugin_t *cp = NULL;
+    int                retval = -1;
+    clixon_plugin_t  **cpv;
+    int                cpn;
+    int                i;
+    struct trans_timer tt;
 
     clixon_debug(CLIXON_DBG_BACKEND | CLIXON_DBG_DETAIL, "");
-    while ((cp = clixon_plugin_each(h, cp)) != NULL) {
-        if (plugin_transaction_end_one(cp, h, td) < 0)
+    transaction_profile_start(&tt, 0);
+    if (clixon_plugin_index(h, CLIXON_PLUGIN_CB(ca_trans_end), &cpv, &cpn) < 0)
+        goto done;
+    for (i=0; i<cpn; i++) {
+        if (plugin_transaction_end_one(cpv[i], h, td) < 0)
             goto done;
     }
     retval = 0;
  done:
+    transaction_profile_stop(&tt, __func__, NULL);
     return retval;
 }
 
@@ -961,12 +2916,16 @@ int
 plugin_transaction_abort_all(clixon_handle       h,
                              transaction_data_t *td)
 {
-    int            retval = -1;
-    clixon_plugin_t *cp = NULL;
+    int               retval = -1;
+    clixon_plugin_t **cpv;
+    int               cpn;
+    int               i;
 
     clixon_debug(CLIXON_DBG_BACKEND | CLIXON_DBG_DETAIL, "");
-    while ((cp = clixon_plugin_each(h, cp)) != NULL) {
-        if (plugin_transaction_abort_one(cp, h, td) < 0)
+    if (clixon_plugin_index(h, CLIXON_PLUGIN_CB(ca_trans_abort), &cpv, &cpn) < 0)
+        return -1;
+    for (i=0; i<cpn; i++) {
+        if (plugin_transaction_abort_one(cpv[i], h, td) < 0)
             ; /* dont abort on error */
     }
     retval = 0;
@@ -0,0 +1,541 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+
+  Copyright (C) 2009-2016 Olof Hagsand and Benny Holmgren
+  Copyright (C) 2017-2019 Olof Hagsand
+  Copyright (C) 2020-2022 Olof Hagsand and Rubicon Communications, LLC(Netgate)
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2,
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+
+ * Timing of commit and validate transaction phases, in total and per plugin
+ * Timing and sizes of rpcs from clients, per rpc name
+ * @see CLICON_TRANSACTION_PROFILE
+ * @see CLICON_RPC_PROFILE
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "clixon_config.h" /* generated by config & autoconf */
+#endif
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <errno.h>
+#include <time.h>
+#include <syslog.h>
+#include <sys/time.h>
+
+/* cligen */
+#include <cligen/cligen.h>
+
+/* clixon */
+#include <clixon/clixon.h>
+
+#include "backend_profile.h"
+
+/* Upper bounds in microseconds of wall time histogram buckets, last bucket is unbounded */
+static const uint64_t _trans_profile_bounds[TRANS_PROFILE_BUCKETS-1] = {
+    100, 1000, 10000, 100000, 1000000, 10000000
+};
+
+/*! Transaction profile entry, value of profile hash
+ *
+ * Keyed by phase, or by phase and plugin name separated by space
+ */
+struct trans_profile_entry{
+    uint64_t tpe_calls;     /* Number of calls */
+    uint64_t tpe_usec;      /* Total wall time in microseconds */
+    uint64_t tpe_max_usec;  /* Max wall time in microseconds */
+    uint64_t tpe_cpu_usec;  /* Total CPU time in microseconds */
+    uint64_t tpe_hist[TRANS_PROFILE_BUCKETS]; /* Number of calls per wall time bucket */
+};
+typedef struct trans_profile_entry trans_profile_entry;
+
+static int            _trans_profile_enable = 0;
+static clicon_hash_t *_trans_profile = NULL;  /* Profile entries keyed by phase [plugin] */
+
+/*! Enable or disable transaction profiling
+ *
+ * @param[in]  enable  0: disable, 1: enable
+ */
+void
+transaction_profile_set(int enable)
+{
+    _trans_profile_enable = enable;
+}
+
+/*! Get CPU time in microseconds of a clock
+ */
+static uint64_t
+transaction_profile_cpu(clockid_t clock)
+{
+    struct timespec ts = {0,};
+
+    clock_gettime(clock, &ts);
+    return (uint64_t)ts.tv_sec*1000000 + ts.tv_nsec/1000;
+}
+
+/*! Start timing of a transaction phase or plugin callback
+ *
+ * @param[out] tt      Timer
+ * @param[in]  thread  If set, CPU time of calling thread, otherwise of process
+ */
+void
+transaction_profile_start(struct trans_timer *tt,
+                          int                 thread)
+{
+    tt->tt_trace = clixon_trace_begin(CLIXON_DBG_BACKEND);
+    if ((tt->tt_on = _trans_profile_enable) == 0)
+        return;
+    tt->tt_clock = thread ? CLOCK_THREAD_CPUTIME_ID : CLOCK_PROCESS_CPUTIME_ID;
+    gettimeofday(&tt->tt_tv, NULL);
+    tt->tt_cpu = transaction_profile_cpu(tt->tt_clock);
+}
+
+/*! Get wall and CPU time since start of timer
+ *
+ * May be called in a forked worker
+ * @param[in]  tt      Timer
+ * @param[out] usec    Wall time in microseconds
+ * @param[out] cpu     CPU time in microseconds
+ */
+void
+transaction_profile_elapsed(struct trans_timer *tt,
+                            uint64_t           *usec,
+                            uint64_t           *cpu)
+{
+    struct timeval tv;
+
+    *usec = *cpu = 0;
+    if (!tt->tt_on)
+        return;
+    gettimeofday(&tv, NULL);
+    timersub(&tv, &tt->tt_tv, &tv);
+    *usec = (uint64_t)tv.tv_sec*1000000 + tv.tv_usec;
+    *cpu = transaction_profile_cpu(tt->tt_clock) - tt->tt_cpu;
+}
+
+/*! Record time of a transaction phase or plugin callback in the profile
+ *
+ * Function names of plugin callbacks, eg plugin_transaction_validate_one, are
+ * recorded as the phase, eg validate.
+ * @param[in]  name    Phase or function name
+ * @param[in]  plugin  Plugin name or NULL for whole phase
+ * @param[in]  usec    Wall time in microseconds
+ * @param[in]  cpu     CPU time in microseconds
+ * @retval     0       OK
+ * @retval    -1       Error
+ */
+int
+transaction_profile_add(const char *name,
+                        const char *plugin,
+                        uint64_t    usec,
+                        uint64_t    cpu)
+{
+    int                  retval = -1;
+    cbuf                *cb = NULL;
+    size_t               len;
+    trans_profile_entry *tpe;
+    trans_profile_entry  tpe0 = {0,};
+    clicon_hash_t        hp;
+    int                  i;
+
+    if (!_trans_profile_enable)
+        goto ok;
+    if ((cb = cbuf_new()) == NULL){
+        clixon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    if (strncmp(name, "plugin_transaction_", strlen("plugin_transaction_")) == 0)
+        name += strlen("plugin_transaction_");
+    len = strlen(name);
+    if (len > 4 &&
+        (strcmp(name+len-4, "_one") == 0 || strcmp(name+len-4, "_all") == 0))
+        len -= 4;
+    cprintf(cb, "%.*s", (int)len, name);
+    if (plugin)
+        cprintf(cb, " %s", plugin);
+    if (_trans_profile == NULL &&
+        (_trans_profile = clicon_hash_init()) == NULL)
+        goto done;
+    if ((tpe = clicon_hash_value(_trans_profile, cbuf_get(cb), NULL)) == NULL){
+        if ((hp = clicon_hash_add(_trans_profile, cbuf_get(cb), &tpe0, sizeof(tpe0))) == NULL)
+            goto done;
+        tpe = (trans_profile_entry *)hp->h_val;
+    }
+    tpe->tpe_calls++;
+    tpe->tpe_usec += usec;
+    if (usec > tpe->tpe_max_usec)
+        tpe->tpe_max_usec = usec;
+    tpe->tpe_cpu_usec += cpu;
+    for (i=0; i<TRANS_PROFILE_BUCKETS-1; i++)
+        if (usec <= _trans_profile_bounds[i])
+            break;
+    tpe->tpe_hist[i]++;
+    clixon_debug(CLIXON_DBG_BACKEND | CLIXON_DBG_DETAIL, "%s: %" PRIu64 " usec, cpu %" PRIu64 " usec",
+                 cbuf_get(cb), usec, cpu);
+ ok:
+    retval = 0;
+ done:
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+}
+
+/*! Stop timing and record time of a transaction phase or plugin callback
+ *
+ * @param[in]  tt      Timer
+ * @param[in]  name    Phase or function name, see transaction_profile_add
+ * @param[in]  plugin  Plugin name or NULL for whole phase
+ * @retval     0       OK
+ * @retval    -1       Error
+ */
+int
+transaction_profile_stop(struct trans_timer *tt,
+                         const char         *name,
+                         const char         *plugin)
+{
+    uint64_t usec;
+    uint64_t cpu;
+
+    clixon_trace_end(tt->tt_trace, CLIXON_DBG_BACKEND, name, plugin);
+    if (!tt->tt_on)
+        return 0;
+    transaction_profile_elapsed(tt, &usec, &cpu);
+    return transaction_profile_add(name, plugin, usec, cpu);
+}
+
+/*! Print timing of one profile entry
+ */
+static void
+transaction_profile_print_entry(cbuf                *cb,
+                                trans_profile_entry *tpe)
+{
+    int i;
+
+    cprintf(cb, "<calls>%" PRIu64 "</calls>", tpe->tpe_calls);
+    cprintf(cb, "<total-usec>%" PRIu64 "</total-usec>", tpe->tpe_usec);
+    cprintf(cb, "<max-usec>%" PRIu64 "</max-usec>", tpe->tpe_max_usec);
+    cprintf(cb, "<cpu-usec>%" PRIu64 "</cpu-usec>", tpe->tpe_cpu_usec);
+    for (i=0; i<TRANS_PROFILE_BUCKETS; i++){
+        if (tpe->tpe_hist[i] == 0)
+            continue;
+        if (i < TRANS_PROFILE_BUCKETS-1)
+            cprintf(cb, "<bucket><le-usec>%" PRIu64 "</le-usec>", _trans_profile_bounds[i]);
+        else
+            cprintf(cb, "<bucket><le-usec>inf</le-usec>");
+        cprintf(cb, "<count>%" PRIu64 "</count></bucket>", tpe->tpe_hist[i]);
+    }
+}
+
+/*! Print transaction profile as clixon-lib transaction-stats XML state data
+ *
+ * @param[out] cb  CLIgen buf, XML is appended
+ * @retval     0   OK
+ * @retval    -1   Error
+ * @code
+ *   <transaction-stats xmlns="http://clicon.org/lib">
+ *     <phase><name>validate</name><calls>2</calls>...
+ *       <plugin><name>example_backend</name><calls>2</calls>...</plugin>
+ *     </phase>
+ *   </transaction-stats>
+ * @endcode
+ */
+int
+transaction_profile_print(cbuf *cb)
+{
+    int                  retval = -1;
+    char               **keys = NULL;
+    size_t               klen = 0;
+    trans_profile_entry *tpe;
+    char                *p;
+    size_t               len;
+    int                  i;
+    int                  j;
+
+    cprintf(cb, "<transaction-stats xmlns=\"%s\">", CLIXON_LIB_NS);
+    if (_trans_profile != NULL){
+        if (clicon_hash_keys(_trans_profile, &keys, &klen) < 0)
+            goto done;
+        for (i=0; i<klen; i++){
+            len = (p = strchr(keys[i], ' ')) ? p - keys[i] : strlen(keys[i]);
+            /* Each phase once, at its first key */
+            for (j=0; j<i; j++)
+                if (strncmp(keys[j], keys[i], len) == 0 &&
+                    (keys[j][len] == ' ' || keys[j][len] == '\0'))
+                    break;
+            if (j < i)
+                continue;
+            cprintf(cb, "<phase><name>%.*s</name>", (int)len, keys[i]);
+            for (j=i; j<klen; j++){
+                if (strncmp(keys[j], keys[i], len) != 0 || keys[j][len] != '\0')
+                    continue;
+                if ((tpe = clicon_hash_value(_trans_profile, keys[j], NULL)) != NULL)
+                    transaction_profile_print_entry(cb, tpe);
+            }
+            for (j=i; j<klen; j++){
+                if (strncmp(keys[j], keys[i], len) != 0 || keys[j][len] != ' ')
+                    continue;
+                if ((tpe = clicon_hash_value(_trans_profile, keys[j], NULL)) == NULL)
+                    continue;
+                cprintf(cb, "<plugin><name>");
+                if (xml_chardata_cbuf_append(cb, 0, keys[j]+len+1) < 0)
+                    goto done;
+                cprintf(cb, "</name>");
+                transaction_profile_print_entry(cb, tpe);
+                cprintf(cb, "</plugin>");
+            }
+            cprintf(cb, "</phase>");
+        }
+    }
+    cprintf(cb, "</transaction-stats>");
+    retval = 0;
+ done:
+    if (keys)
+        free(keys);
+    return retval;
+}
+
+/*! Free all transaction profile entries
+ */
+void
+transaction_profile_exit(void)
+{
+    if (_trans_profile){
+        clicon_hash_free(_trans_profile);
+        _trans_profile = NULL;
+    }
+}
+
+/*! Rpc profile entry, value of rpc profile hash keyed by rpc name
+ *
+ * Wall time histogram bucket i has upper bound 2^i*RPC_PROFILE_USEC0 usec, last is unbounded
+ */
+struct rpc_profile_entry{
+    uint64_t rpe_calls;       /* Number of rpcs */
+    uint64_t rpe_errors;      /* Number of rpcs replied with rpc-error */
+    uint64_t rpe_usec;        /* Total wall time in microseconds */
+    uint64_t rpe_max_usec;    /* Max wall time in microseconds */
+    uint64_t rpe_req_bytes;   /* Total size of requests */
+    uint64_t rpe_reply_bytes; /* Total size of replies */
+    uint64_t rpe_max_reply;   /* Max size of reply */
+    uint64_t rpe_hist[RPC_PROFILE_BUCKETS]; /* Number of rpcs per wall time bucket */
+};
+typedef struct rpc_profile_entry rpc_profile_entry;
+
+static int            _rpc_profile_enable = 0;
+static clicon_hash_t *_rpc_profile = NULL;  /* Profile entries keyed by rpc name */
+
+/*! Enable or disable rpc profiling
+ *
+ * @param[in]  enable  0: disable, 1: enable
+ */
+void
+rpc_profile_set(int enable)
+{
+    _rpc_profile_enable = enable;
+}
+
+/*! Record time and sizes of an rpc in the profile
+ *
+ * @param[in]  rpc    Rpc name
+ * @param[in]  usec   Wall time from request read to reply sent in microseconds
+ * @param[in]  req    Size of request in bytes
+ * @param[in]  reply  Size of reply in bytes
+ * @param[in]  error  Reply is an rpc-error
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+int
+rpc_profile_add(const char *rpc,
+                uint64_t    usec,
+                size_t      req,
+                size_t      reply,
+                int         error)
+{
+    int                retval = -1;
+    rpc_profile_entry *rpe;
+    rpc_profile_entry  rpe0 = {0,};
+    clicon_hash_t      hp;
+    int                i;
+
+    if (!_rpc_profile_enable)
+        goto ok;
+    if (_rpc_profile == NULL &&
+        (_rpc_profile = clicon_hash_init()) == NULL)
+        goto done;
+    if ((rpe = clicon_hash_value(_rpc_profile, rpc, NULL)) == NULL){
+        if ((hp = clicon_hash_add(_rpc_profile, rpc, &rpe0, sizeof(rpe0))) == NULL)
+            goto done;
+        rpe = (rpc_profile_entry *)hp->h_val;
+    }
+    rpe->rpe_calls++;
+    if (error)
+        rpe->rpe_errors++;
+    rpe->rpe_usec += usec;
+    if (usec > rpe->rpe_max_usec)
+        rpe->rpe_max_usec = usec;
+    rpe->rpe_req_bytes += req;
+    rpe->rpe_reply_bytes += reply;
+    if (reply > rpe->rpe_max_reply)
+        rpe->rpe_max_reply = reply;
+    for (i=0; i<RPC_PROFILE_BUCKETS-1; i++)
+        if (usec <= ((uint64_t)RPC_PROFILE_USEC0 << i))
+            break;
+    rpe->rpe_hist[i]++;
+ ok:
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Get approximate percentile of wall time of an rpc from its histogram
+ *
+ * @param[in]  rpe   Rpc profile entry
+ * @param[in]  pct   Percentile, 1-100
+ * @retval     usec  Upper bound of bucket of percentile, at most max wall time
+ */
+static uint64_t
+rpc_profile_percentile(rpc_profile_entry *rpe,
+                       int                pct)
+{
+    uint64_t n;
+    uint64_t sum = 0;
+    uint64_t usec;
+    int      i;
+
+    n = (rpe->rpe_calls*pct + 99)/100;
+    for (i=0; i<RPC_PROFILE_BUCKETS-1; i++){
+        sum += rpe->rpe_hist[i];
+        if (sum >= n)
+            break;
+    }
+    if (i == RPC_PROFILE_BUCKETS-1)
+        return rpe->rpe_max_usec;
+    usec = (uint64_t)RPC_PROFILE_USEC0 << i;
+    return usec < rpe->rpe_max_usec ? usec : rpe->rpe_max_usec;
+}
+
+/*! Print rpc profile as clixon-lib rpc-stats XML state data
+ *
+ * @param[out] cb  CLIgen buf, XML is appended
+ * @retval     0   OK
+ * @retval    -1   Error
+ * @code
+ *   <rpc-stats xmlns="http://clicon.org/lib">
+ *     <rpc><name>get-config</name><calls>2</calls>...<p50-usec>256</p50-usec>...</rpc>
+ *   </rpc-stats>
+ * @endcode
+ */
+int
+rpc_profile_print(cbuf *cb)
+{
+    int                retval = -1;
+    char             **keys = NULL;
+    size_t             klen = 0;
+    rpc_profile_entry *rpe;
+    int                i;
+
+    cprintf(cb, "<rpc-stats xmlns=\"%s\">", CLIXON_LIB_NS);
+    if (_rpc_profile != NULL){
+        if (clicon_hash_keys(_rpc_profile, &keys, &klen) < 0)
+            goto done;
+        for (i=0; i<klen; i++){
+            if ((rpe = clicon_hash_value(_rpc_profile, keys[i], NULL)) == NULL)
+                continue;
+            cprintf(cb, "<rpc><name>%s</name>", keys[i]);
+            cprintf(cb, "<calls>%" PRIu64 "</calls>", rpe->rpe_calls);
+            cprintf(cb, "<errors>%" PRIu64 "</errors>", rpe->rpe_errors);
+            cprintf(cb, "<total-usec>%" PRIu64 "</total-usec>", rpe->rpe_usec);
+            cprintf(cb, "<p50-usec>%" PRIu64 "</p50-usec>", rpc_profile_percentile(rpe, 50));
+            cprintf(cb, "<p99-usec>%" PRIu64 "</p99-usec>", rpc_profile_percentile(rpe, 99));
+            cprintf(cb, "<max-usec>%" PRIu64 "</max-usec>", rpe->rpe_max_usec);
+            cprintf(cb, "<request-bytes>%" PRIu64 "</request-bytes>", rpe->rpe_req_bytes);
+            cprintf(cb, "<reply-bytes>%" PRIu64 "</reply-bytes>", rpe->rpe_reply_bytes);
+            cprintf(cb, "<max-reply-bytes>%" PRIu64 "</max-reply-bytes>", rpe->rpe_max_reply);
+            cprintf(cb, "</rpc>");
+        }
+    }
+    cprintf(cb, "</rpc-stats>");
+    retval = 0;
+ done:
+    if (keys)
+        free(keys);
+    return retval;
+}
+
+/*! Log rpc profile, one line per rpc name
+ *
+ * @param[in]  h   Clixon handle
+ * @retval     0   OK
+ * @retval    -1   Error
+ */
+int
+rpc_profile_log(clixon_handle h)
+{
+    int                retval = -1;
+    char             **keys = NULL;
+    size_t             klen = 0;
+    rpc_profile_entry *rpe;
+    int                i;
+
+    if (_rpc_profile != NULL){
+        if (clicon_hash_keys(_rpc_profile, &keys, &klen) < 0)
+            goto done;
+        for (i=0; i<klen; i++){
+            if ((rpe = clicon_hash_value(_rpc_profile, keys[i], NULL)) == NULL)
+                continue;
+            clixon_log(h, LOG_NOTICE, "rpc %s: calls:%" PRIu64 " errors:%" PRIu64
+                       " p50:%" PRIu64 " p99:%" PRIu64 " max:%" PRIu64 " usec"
+                       " request:%" PRIu64 " reply:%" PRIu64 " max-reply:%" PRIu64 " bytes",
+                       keys[i], rpe->rpe_calls, rpe->rpe_errors,
+                       rpc_profile_percentile(rpe, 50), rpc_profile_percentile(rpe, 99),
+                       rpe->rpe_max_usec, rpe->rpe_req_bytes, rpe->rpe_reply_bytes,
+                       rpe->rpe_max_reply);
+        }
+    }
+    retval = 0;
+ done:
+    if (keys)
+        free(keys);
+    return retval;
+}
+
+/*! Free all rpc profile entries
+ */
+void
+rpc_profile_exit(void)
+{
+    if (_rpc_profile){
+        clicon_hash_free(_rpc_profile);
+        _rpc_profile = NULL;
+    }
+}
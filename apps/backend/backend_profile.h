@@ -0,0 +1,80 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+ 
+  Copyright (C) 2009-2016 Olof Hagsand and Benny Holmgren
+  Copyright (C) 2017-2019 Olof Hagsand
+  Copyright (C) 2020-2022 Olof Hagsand and Rubicon Communications, LLC (Netgate)
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2, 
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+ */
+
+#ifndef _BACKEND_PROFILE_H_
+#define _BACKEND_PROFILE_H_
+
+/*
+ * Constants
+ */
+/* Number of wall time histogram buckets of transaction profile */
+#define TRANS_PROFILE_BUCKETS 7
+
+/* Number of wall time histogram buckets of rpc profile, powers of two from RPC_PROFILE_USEC0 */
+#define RPC_PROFILE_BUCKETS 24
+
+/* Upper bound in microseconds of first wall time bucket of rpc profile */
+#define RPC_PROFILE_USEC0 16
+
+/*
+ * Types
+ */
+/* Timer of a transaction phase or plugin callback */
+struct trans_timer {
+    int            tt_on;    /* Profiling was enabled at start */
+    clockid_t      tt_clock; /* CPU clock, process or thread */
+    struct timeval tt_tv;    /* Wall time at start */
+    uint64_t       tt_cpu;   /* CPU time at start in microseconds */
+    clixon_trace_t tt_trace; /* Trace span, see CLICON_TRACE */
+};
+
+/*
+ * Prototypes
+ */
+void transaction_profile_set(int enable);
+void transaction_profile_start(struct trans_timer *tt, int thread);
+void transaction_profile_elapsed(struct trans_timer *tt, uint64_t *usec, uint64_t *cpu);
+int  transaction_profile_add(const char *name, const char *plugin, uint64_t usec, uint64_t cpu);
+int  transaction_profile_stop(struct trans_timer *tt, const char *name, const char *plugin);
+int  transaction_profile_print(cbuf *cb);
+void transaction_profile_exit(void);
+void rpc_profile_set(int enable);
+int  rpc_profile_add(const char *rpc, uint64_t usec, size_t req, size_t reply, int error);
+int  rpc_profile_print(cbuf *cb);
+int  rpc_profile_log(clixon_handle h);
+void rpc_profile_exit(void);
+
+#endif  /* _BACKEND_PROFILE_H_ */
@@ -0,0 +1,141 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+
+  Copyright (C) 2009-2016 Olof Hagsand and Benny Holmgren
+  Copyright (C) 2017-2019 Olof Hagsand
+  Copyright (C) 2020-2022 Olof Hagsand and Rubicon Communications, LLC(Netgate)
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2,
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+
+ * Publish read-only snapshots of running for co-located readers
+ * After each change of running, the backend writes it as a new snapshot, see
+ * clixon_snapshot.c and CLICON_XMLDB_SNAPSHOT
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "clixon_config.h" /* generated by config & autoconf */
+#endif
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <errno.h>
+#include <syslog.h>
+
+/* cligen */
+#include <cligen/cligen.h>
+
+/* clixon */
+#include <clixon/clixon.h>
+
+#include "backend_snapshot.h"
+
+/* Generation of running when last published, or 0 */
+static uint64_t _snapshot_rgen = 0;
+
+/* Generation of last published snapshot, 0 if not known */
+static uint64_t _snapshot_gen = 0;
+
+/*! Write running as new snapshot
+ *
+ * @param[in]  h     Clixon handle
+ * @param[in]  path  Snapshot file
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+static int
+backend_snapshot_write(clixon_handle h,
+                       const char   *path)
+{
+    int       retval = -1;
+    db_elmnt *de;
+    cxobj    *xt = NULL;
+    cxobj    *xerr = NULL;
+    uint64_t  rgen;
+    int       ret;
+
+    if ((ret = xmldb_get_cache(h, "running", &xt, &xerr)) < 0)
+        goto done;
+    if (ret == 0){
+        clixon_err(OE_DB, 0, "Running not bound to yang");
+        goto done;
+    }
+    if ((de = xmldb_find(h, "running")) == NULL)
+        goto ok;
+    rgen = xmldb_generation_get(de);
+    if (rgen == _snapshot_rgen)
+        goto ok;
+    /* Continue from generation of snapshot of earlier backend */
+    if (_snapshot_gen == 0 &&
+        clixon_snapshot_generation(path, &_snapshot_gen) < 0){
+        clixon_log(h, LOG_WARNING, "Snapshot %s: %s, replaced", path, clixon_err_reason());
+        clixon_err_reset();
+        _snapshot_gen = 0;
+    }
+    if (clixon_snapshot_write(path, xt, clicon_dbspec_yang(h),
+                              clicon_option_bool(h, "CLICON_XMLDB_SYSTEM_ONLY_CONFIG"),
+                              _snapshot_gen + 1) < 0)
+        goto done;
+    _snapshot_gen++;
+    _snapshot_rgen = rgen;
+ ok:
+    retval = 0;
+ done:
+    if (xerr)
+        xml_free(xerr);
+    return retval;
+}
+
+/*! Publish running as a new snapshot if it has changed since last published
+ *
+ * Called after a request or commit that may have changed running. Errors are logged,
+ * since running has already been changed
+ * @param[in]  h     Clixon handle
+ * @retval     0     OK
+ * @see CLICON_XMLDB_SNAPSHOT
+ */
+int
+backend_snapshot_publish(clixon_handle h)
+{
+    char     *path;
+    db_elmnt *de;
+
+    if ((path = clicon_option_str(h, "CLICON_XMLDB_SNAPSHOT")) == NULL)
+        return 0;
+    if ((de = xmldb_find(h, "running")) == NULL ||
+        xmldb_generation_get(de) == _snapshot_rgen)
+        return 0;
+    if (backend_snapshot_write(h, path) < 0){
+        clixon_log(h, LOG_WARNING, "Snapshot %s not published: %s", path, clixon_err_reason());
+        clixon_err_reset();
+    }
+    return 0;
+}
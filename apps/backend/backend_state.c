@@ -71,6 +71,7 @@
 #include "backend_client.h"
 #include "backend_handle.h"
 #include "backend_state.h"
+#include "backend_profile.h"
 
 /*! Restconf get capabilities
  *
@@ -257,12 +258,235 @@ backend_monitoring_state_get(clixon_handle h,
     goto done;
 }
 
+/*! Get XPath profile state of backend as clixon-lib xpath-stats
+ *
+ * @param[in]     h       Clixon handle
+ * @param[in]     yspec   Yang spec
+ * @param[in,out] xret    Existing XML tree, merge x into this
+ * @retval        1       OK
+ * @retval        0       Parse failed, error in xret
+ * @retval       -1       Error (fatal)
+ * @see CLICON_XPATH_PROFILE
+ */
+static int
+xpath_profile_state_get(clixon_handle h,
+                        yang_stmt    *yspec,
+                        cxobj       **xret)
+{
+    int   retval = -1;
+    cbuf *cb = NULL;
+
+    if ((cb = cbuf_new()) == NULL){
+        clixon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    if (xpath_profile_print(cb) < 0)
+        goto done;
+    if (clixon_xml_parse_string(cbuf_get(cb), YB_MODULE, yspec, xret, NULL) < 0){
+        if (xret && netconf_operation_failed_xml(xret, "protocol", clixon_err_reason())< 0)
+            goto done;
+        goto fail;
+    }
+    retval = 1;
+ done:
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! Get transaction profile state of backend as clixon-lib transaction-stats
+ *
+ * @param[in]     h       Clixon handle
+ * @param[in]     yspec   Yang spec
+ * @param[in,out] xret    Existing XML tree, merge x into this
+ * @retval        1       OK
+ * @retval        0       Parse failed, error in xret
+ * @retval       -1       Error (fatal)
+ * @see CLICON_TRANSACTION_PROFILE
+ */
+static int
+transaction_profile_state_get(clixon_handle h,
+                              yang_stmt    *yspec,
+                              cxobj       **xret)
+{
+    int   retval = -1;
+    cbuf *cb = NULL;
+
+    if ((cb = cbuf_new()) == NULL){
+        clixon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    if (transaction_profile_print(cb) < 0)
+        goto done;
+    if (clixon_xml_parse_string(cbuf_get(cb), YB_MODULE, yspec, xret, NULL) < 0){
+        if (xret && netconf_operation_failed_xml(xret, "protocol", clixon_err_reason())< 0)
+            goto done;
+        goto fail;
+    }
+    retval = 1;
+ done:
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! Get rpc profile state of backend as clixon-lib rpc-stats
+ *
+ * @param[in]     h       Clixon handle
+ * @param[in]     yspec   Yang spec
+ * @param[in,out] xret    Existing XML tree, merge x into this
+ * @retval        1       OK
+ * @retval        0       Parse failed, error in xret
+ * @retval       -1       Error (fatal)
+ * @see CLICON_RPC_PROFILE
+ */
+static int
+rpc_profile_state_get(clixon_handle h,
+                      yang_stmt    *yspec,
+                      cxobj       **xret)
+{
+    int   retval = -1;
+    cbuf *cb = NULL;
+
+    if ((cb = cbuf_new()) == NULL){
+        clixon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    if (rpc_profile_print(cb) < 0)
+        goto done;
+    if (clixon_xml_parse_string(cbuf_get(cb), YB_MODULE, yspec, xret, NULL) < 0){
+        if (xret && netconf_operation_failed_xml(xret, "protocol", clixon_err_reason())< 0)
+            goto done;
+        goto fail;
+    }
+    retval = 1;
+ done:
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! Get memory usage of backend as clixon-lib memory-stats
+ *
+ * Tagged categories are read from the allocation counters, YANG specs, the external NACM
+ * tree and the datastore caches are traversed.
+ * @param[in]     h       Clixon handle
+ * @param[in]     yspec   Yang spec
+ * @param[in,out] xret    Existing XML tree, merge x into this
+ * @retval        1       OK
+ * @retval        0       Parse failed, error in xret
+ * @retval       -1       Error (fatal)
+ * @see clixon_mem_stats
+ */
+static int
+memory_state_get(clixon_handle h,
+                 yang_stmt    *yspec,
+                 cxobj       **xret)
+{
+    int                  retval = -1;
+    cbuf                *cb = NULL;
+    enum clixon_mem_tag  tag;
+    uint64_t             nr;
+    uint64_t             bytes;
+    uint64_t             max;
+    size_t               sz;
+    yang_stmt           *ymounts;
+    yang_stmt           *ydomain;
+    yang_stmt           *ys;
+    int                  inext;
+    int                  inext2;
+    cxobj               *xt;
+    char               **keys = NULL;
+    size_t               klen;
+    int                  i;
+    db_elmnt            *de;
+
+    if ((cb = cbuf_new()) == NULL){
+        clixon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    cprintf(cb, "<memory-stats xmlns=\"%s\">", CLIXON_LIB_NS);
+    for (tag = 0; tag < CLIXON_MEM_NR; tag++){
+        if (clixon_mem_stats(tag, &nr, &bytes, &max) < 0)
+            goto done;
+        cprintf(cb, "<category><name>%s</name>", clixon_mem_tag2str(tag));
+        cprintf(cb, "<nr>%" PRIu64 "</nr><bytes>%" PRIu64 "</bytes>", nr, bytes);
+        cprintf(cb, "<max-bytes>%" PRIu64 "</max-bytes></category>", max);
+    }
+    /* All YANG specs: config, main and mountpoints */
+    nr = 0;
+    sz = 0;
+    if ((ymounts = clixon_yang_mounts_get(h)) != NULL){
+        inext = 0;
+        while ((ydomain = yn_iter(ymounts, &inext)) != NULL) {
+            inext2 = 0;
+            while ((ys = yn_iter(ydomain, &inext2)) != NULL)
+                if (yang_stats(ys, 0, &nr, &sz) < 0)
+                    goto done;
+        }
+    }
+    cprintf(cb, "<category><name>yang</name>");
+    cprintf(cb, "<nr>%" PRIu64 "</nr><bytes>%zu</bytes></category>", nr, sz);
+    /* External NACM tree, internal NACM is part of running */
+    if ((xt = clicon_nacm_ext(h)) != NULL){
+        nr = 0;
+        sz = 0;
+        if (xml_stats(xt, XML_STATS_ALL, &nr, &sz) < 0)
+            goto done;
+        cprintf(cb, "<category><name>nacm-tree</name>");
+        cprintf(cb, "<nr>%" PRIu64 "</nr><bytes>%zu</bytes></category>", nr, sz);
+    }
+    /* Datastore caches, do not load datastores not in memory */
+    if (clicon_hash_keys(clicon_db_elmnt(h), &keys, &klen) < 0)
+        goto done;
+    for (i = 0; i < klen; i++) {
+        if ((de = xmldb_find(h, keys[i])) == NULL ||
+            (xt = xmldb_cache_read(de)) == NULL)
+            continue;
+        nr = 0;
+        sz = 0;
+        /* A shared cache is counted in the datastore owning it */
+        if (!xmldb_cache_shared(de) &&
+            xml_stats(xt, XML_STATS_ALL, &nr, &sz) < 0)
+            goto done;
+        cprintf(cb, "<datastore><name>%s</name>", keys[i]);
+        cprintf(cb, "<nodes>%" PRIu64 "</nodes><bytes>%zu</bytes>", nr, sz);
+        cprintf(cb, "<shared>%s</shared></datastore>", xmldb_cache_shared(de)?"true":"false");
+    }
+    cprintf(cb, "</memory-stats>");
+    if (clixon_xml_parse_string(cbuf_get(cb), YB_MODULE, yspec, xret, NULL) < 0){
+        if (xret && netconf_operation_failed_xml(xret, "protocol", clixon_err_reason())< 0)
+            goto done;
+        goto fail;
+    }
+    retval = 1;
+ done:
+    if (keys)
+        free(keys);
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
 /*! Get system state-data, including streams and plugins
  *
  * @param[in]     h       Clixon handle
  * @param[in]     xpath   XPath selection, may be used to filter early
  * @param[in]     nsc     XML Namespace context for xpath
  * @param[in,out] xret    Existing XML tree, merge x into this, or rpc-error
+ * @retval        2       Asynchronous state data is collected, reply of request is deferred
  * @retval        1       OK
  * @retval        0       Statedata callback failed (error in xret)
  * @retval       -1       Error (fatal)
@@ -376,6 +600,64 @@ get_state_data(clixon_handle h,
                     goto fail;
             }
         }
+    if (clicon_option_bool(h, "CLICON_XPATH_PROFILE"))
+        if (xpath == NULL ||         /* Raw optimization of xpath filtering */
+            strcmp(xpath, "/") == 0 ||
+            strstr(xpath, "xpath-stats") != 0){
+            if ((ret = xpath_profile_state_get(h, yspec, &x1)) < 0)
+                goto done;
+            if (ret == 0)
+                goto fail;
+            if (xpath_first(x1, nsc, "%s", xpath) != NULL){
+                if ((ret = netconf_trymerge(x1, yspec, xret)) < 0)
+                    goto done;
+                if (ret == 0)
+                    goto fail;
+            }
+        }
+    if (clicon_option_bool(h, "CLICON_TRANSACTION_PROFILE"))
+        if (xpath == NULL ||         /* Raw optimization of xpath filtering */
+            strcmp(xpath, "/") == 0 ||
+            strstr(xpath, "transaction-stats") != 0){
+            if ((ret = transaction_profile_state_get(h, yspec, &x1)) < 0)
+                goto done;
+            if (ret == 0)
+                goto fail;
+            if (xpath_first(x1, nsc, "%s", xpath) != NULL){
+                if ((ret = netconf_trymerge(x1, yspec, xret)) < 0)
+                    goto done;
+                if (ret == 0)
+                    goto fail;
+            }
+        }
+    if (clicon_option_bool(h, "CLICON_RPC_PROFILE"))
+        if (xpath == NULL ||         /* Raw optimization of xpath filtering */
+            strcmp(xpath, "/") == 0 ||
+            strstr(xpath, "rpc-stats") != 0){
+            if ((ret = rpc_profile_state_get(h, yspec, &x1)) < 0)
+                goto done;
+            if (ret == 0)
+                goto fail;
+            if (xpath_first(x1, nsc, "%s", xpath) != NULL){
+                if ((ret = netconf_trymerge(x1, yspec, xret)) < 0)
+                    goto done;
+                if (ret == 0)
+                    goto fail;
+            }
+        }
+    /* Not in a full get, since datastore caches are traversed */
+    if (xpath && strstr(xpath, "memory-stats") != 0){
+        if ((ret = memory_state_get(h, yspec, &x1)) < 0)
+            goto done;
+        if (ret == 0)
+            goto fail;
+        if (xpath_first(x1, nsc, "%s", xpath) != NULL){
+            if ((ret = netconf_trymerge(x1, yspec, xret)) < 0)
+                goto done;
+            if (ret == 0)
+                goto fail;
+        }
+    }
     if (clicon_option_bool(h, "CLICON_YANG_SCHEMA_MOUNT")){
         if ((ret = yang_schema_mount_statedata(h, yspec, xpath, nsc, xret, &xerr)) < 0)
             goto done;
@@ -394,6 +676,10 @@ get_state_data(clixon_handle h,
         goto done;
     if (ret == 0)
         goto fail;
+    if (ret == 2){ /* Reply is deferred */
+        retval = 2;
+        goto done;
+    }
     retval = 1; /* OK */
  done:
     clixon_debug(CLIXON_DBG_BACKEND, "retval:%d", retval);
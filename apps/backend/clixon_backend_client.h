@@ -45,6 +45,19 @@
 /*
  * Types
  */
+/* Output buffer, shared by the output queues of all clients a notification is sent to */
+struct outq_buf{
+    int                   ob_refcnt;  /* Number of references, freed when 0 */
+    cbuf                 *ob_cb;      /* Framed output */
+};
+
+/* Output queue element: buffer not yet completely written to a client */
+struct outq_elem{
+    qelem_t               oe_q;       /* queue header */
+    struct outq_buf      *oe_buf;     /* Output buffer */
+    size_t                oe_pos;     /* Bytes of oe_buf already written */
+};
+
 /* Backend client entry.
  * Keep state about every connected client.
  * References from RFC 6022, ietf-netconf-monitoring.yang sessions container
@@ -73,6 +86,15 @@ struct client_entry{
     uint32_t              ce_in_bad_rpcs;    /* Not correct <rpc> messages */
     uint32_t              ce_out_rpc_errors; /*  <rpc-error> messages*/
     uint32_t              ce_out_notifications; /* Outgoing notifications */
+    int                   ce_reply_deferred; /* Reply of current rpc is sent later, see CLICON_COMMIT_GROUP */
+    pid_t                 ce_reader_pid; /* Reader process serving current rpc, see CLICON_BACKEND_READERS */
+    int                   ce_reader_fd;  /* Closed by reader process on exit */
+    struct outq_elem     *ce_outq;       /* Output not yet written, see CLICON_BACKEND_OUTQ_MAX */
+    size_t                ce_outq_len;   /* Bytes of ce_outq not yet written */
+    int                   ce_outq_fd;    /* Dup of ce_s waiting for output, or -1 */
+    int                   ce_binary;     /* Client accepts binary replies, see CLIXON_BIN_CAPABILITY */
+    int                   ce_class;      /* Dispatch class of client socket, see clixon_event_fd_class */
+    int                   ce_async;      /* Current rpc waits for asynchronous state data */
 };
 typedef struct client_entry client_entry;
 
@@ -44,6 +44,9 @@
 
 #define COMMIT_NOT_CONFIRMED "Commit was not confirmed; automatic rollback complete."
 
+/* Stream of changes committed to running, see CLICON_STREAM_CONFIG_CHANGE */
+#define CONFIG_CHANGE_STREAM "CONFIG-CHANGE"
+
 enum confirmed_commit_state {
     INACTIVE,       // a confirmed-commit is not in progress
     PERSISTENT,     // a confirmed-commit is in progress and a persist value was given
@@ -61,7 +64,7 @@ enum confirmed_commit_state confirmed_commit_state_get(clixon_handle h);
 uint32_t confirmed_commit_session_id_get(clixon_handle h);
 int cancel_rollback_event(clixon_handle h);
 int cancel_confirmed_commit(clixon_handle h);
-int handle_confirmed_commit(clixon_handle h, cxobj *xe, uint32_t myid);
+int handle_confirmed_commit(clixon_handle h, cxobj *xe, uint32_t myid, transaction_data_t *td);
 int do_rollback(clixon_handle h, uint8_t *errs);
 int from_client_cancel_commit(clixon_handle h,  cxobj *xe, cbuf *cbret, void *arg, void *regarg);
 int from_client_confirmed_commit(clixon_handle h, cxobj *xe, uint32_t myid, cbuf *cbret);
@@ -79,6 +82,9 @@ int system_only_data_add(clixon_handle h, char *db);
 int xmldb_netconf_name_find(clixon_handle h, cxobj *xn, const char *name, client_entry *ce, int create, db_elmnt **de, cbuf *cbret);
 int       xmldb_find_create(clixon_handle h, const char *db, uint32_t ceid, db_elmnt **dep, char **dbp);
 db_elmnt *xmldb_candidate_new(clixon_handle h, const char *name, uint32_t ceid);
+int change_feed_free(clixon_handle h);
+int commit_group_check(clixon_handle h, client_entry *ce, cxobj *xe);
+int commit_group_free(clixon_handle h);
 int backend_commit_init(clixon_handle h);
 
 #endif  /* _CLIXON_BACKEND_COMMIT_H_ */
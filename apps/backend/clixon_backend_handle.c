@@ -90,6 +90,7 @@ struct backend_handle {
     clicon_hash_t  *bh_data;      /* internal clicon data (HDR) */
     clicon_hash_t  *ch_db_elmnt;  /* xml datastore element cache data */
     event_stream_t *bh_stream;    /* notification streams, see clixon_stream.[ch] */
+    void           *bh_optv;      /* typed option values, see clicon_option_bool_id */
 
     /* ------ end of common handle ------ */
     client_entry   *bh_ce_list;   /* The client list */
@@ -150,6 +151,7 @@ backend_client_add(clixon_handle    h,
         return NULL;
     }
     memset(ce, 0, sizeof(*ce));
+    ce->ce_outq_fd = -1;
     ce->ce_nr = bh->bh_ce_nr++; /* Session-id ? */
     memcpy(&ce->ce_addr, addr, sizeof(*addr));
     ce->ce_handle = h;
@@ -180,6 +182,37 @@ backend_client_list(clixon_handle h)
     return bh->bh_ce_list;
 }
 
+/*! Release a reference to an output buffer, free it if no longer referenced
+ *
+ * @param[in]  ob   Output buffer
+ */
+void
+backend_outq_buf_unref(struct outq_buf *ob)
+{
+    if (--ob->ob_refcnt > 0)
+        return;
+    if (ob->ob_cb)
+        cbuf_free(ob->ob_cb);
+    free(ob);
+}
+
+/*! Free output queue of a client
+ *
+ * @param[in]  ce   Client entry
+ */
+void
+backend_client_outq_free(client_entry *ce)
+{
+    struct outq_elem *oe;
+
+    while ((oe = ce->ce_outq) != NULL){
+        DELQ(oe, ce->ce_outq, struct outq_elem *);
+        backend_outq_buf_unref(oe->oe_buf);
+        free(oe);
+    }
+    ce->ce_outq_len = 0;
+}
+
 /*! Actually remove client from client list
  *
  * @param[in]  h   Clixon handle
@@ -204,6 +237,9 @@ backend_client_delete(clixon_handle h,
                 free(ce->ce_transport);
             if (ce->ce_source_host)
                 free(ce->ce_source_host);
+            backend_client_outq_free(ce);
+            if (ce->ce_outq_fd != -1)
+                close(ce->ce_outq_fd);
             ce->ce_next = NULL;
             free(ce);
             break;
@@ -66,6 +66,7 @@ typedef struct {
     cxobj    **td_scvec;    /* Source changed xml vector */
     cxobj    **td_tcvec;    /* Target changed xml vector */
     size_t     td_clen;     /* Changed xml vector length */
+    void      *td_index;    /* Changes per plugin with ca_trans_subtrees, see plugin_transaction_view */
 } transaction_data_t;
 
 /*! Pagination userdata 
@@ -94,6 +95,8 @@ typedef struct {
     cxobj            *pd_xstate;    /* Returned xml state tree */
 } pagination_data_t;
 
+struct client_entry;
+
 /*
  * Prototypes
  */
@@ -103,6 +106,22 @@ int clixon_plugin_reset_all(clixon_handle h, char *db);
 int clixon_plugin_pre_daemon_all(clixon_handle h);
 int clixon_plugin_daemon_all(clixon_handle h);
 
+int clixon_plugin_start_backend_all(clixon_handle h, int background);
+int clixon_plugin_start_background(clixon_handle h);
+int clixon_plugin_start_pending(clixon_plugin_t *cp);
+int clixon_plugin_start_exit(clixon_handle h);
+
+int clixon_plugin_statedata_ttl(clixon_handle h, const char *plugin, uint32_t ttl);
+int clixon_plugin_statedata_invalidate(clixon_handle h, const char *plugin);
+int clixon_plugin_statedata_cache_exit(clixon_handle h);
+int clixon_plugin_statedata_keys(clixon_handle h, cvec *nsc, char *xpath, cvec **keys);
+void clixon_plugin_statedata_async_client(struct client_entry *ce, char *msg);
+int clixon_plugin_statedata_async_done(clixon_handle h, void *req, cxobj *xstate);
+int clixon_plugin_statedata_async_exit(clixon_handle h);
+void *clixon_plugin_rpc_async(clixon_handle h, void *arg, uint32_t timeout);
+int clixon_plugin_rpc_async_done(clixon_handle h, void *req, cbuf *cbret);
+int clixon_plugin_rpc_async_client_rm(clixon_handle h, uint32_t id);
+int clixon_plugin_rpc_async_exit(clixon_handle h);
 int clixon_plugin_statedata_all(clixon_handle h, yang_stmt *yspec, cvec *nsc, char *xpath, cxobj **xtop);
 int clixon_plugin_lockdb_all(clixon_handle h, char *db, int lock, int id);
 
@@ -314,6 +314,149 @@ mtpoint_paths(clixon_handle h,
     return retval;
 }
 
+/*! Batch of CLI edits not yet sent to the backend, see CLICON_CLI_EDIT_BATCH
+ */
+struct cli_edit_batch {
+    char **eb_vec;   /* Edit-config XML strings in the order they are made */
+    int    eb_len;
+};
+
+/*! Get batch of CLI edits
+ *
+ * @param[in]  h    Clixon handle
+ * @retval     eb   Edit batch
+ * @retval     NULL No edits batched
+ */
+static struct cli_edit_batch *
+cli_edit_batch_get(clixon_handle h)
+{
+    void *p = NULL;
+
+    if (clicon_ptr_get(h, "cli-edit-batch", &p) < 0)
+        return NULL;
+    return (struct cli_edit_batch *)p;
+}
+
+/*! Free batch of CLI edits without sending them
+ *
+ * @param[in]  h    Clixon handle
+ */
+static void
+cli_edit_batch_free(clixon_handle h)
+{
+    struct cli_edit_batch *eb;
+    int                    i;
+
+    if ((eb = cli_edit_batch_get(h)) == NULL)
+        return;
+    for (i=0; i<eb->eb_len; i++)
+        free(eb->eb_vec[i]);
+    if (eb->eb_vec)
+        free(eb->eb_vec);
+    free(eb);
+    clicon_ptr_set(h, "cli-edit-batch", NULL);
+}
+
+/*! Send batched CLI edits to the backend
+ *
+ * The edits are sent as separate edit-configs back-to-back and then all replies are read,
+ * which is one round-trip for the whole batch. The backend applies them in order.
+ * The first error is reported, edits after it are still applied.
+ * @param[in]  h    Clixon handle
+ * @retval     0    OK, or no edits batched
+ * @retval    -1    Error
+ * @see CLICON_CLI_EDIT_BATCH
+ */
+int
+cli_edit_batch_flush(clixon_handle h)
+{
+    int                    retval = -1;
+    struct cli_edit_batch *eb;
+    uint32_t              *ids = NULL;
+    cxobj                 *xret = NULL;
+    cxobj                 *xerr;
+    int                    failed = 0;
+    int                    nr;
+    int                    i;
+
+    if ((eb = cli_edit_batch_get(h)) == NULL)
+        return 0;
+    clixon_debug(CLIXON_DBG_CLI, "%d edits", eb->eb_len);
+    if ((ids = calloc(eb->eb_len, sizeof(*ids))) == NULL){
+        clixon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    for (nr=0; nr<eb->eb_len; nr++)
+        if (clicon_rpc_edit_config_send(h, "candidate", OP_NONE, eb->eb_vec[nr], &ids[nr]) < 0){
+            failed++;
+            break;
+        }
+    /* Read replies of all edits sent, also after an error */
+    for (i=0; i<nr; i++){
+        if (clicon_rpc_msg_recv(h, ids[i], &xret) < 0){
+            failed++;
+            break;
+        }
+        if (!failed && (xerr = xpath_first(xret, NULL, "//rpc-error")) != NULL){
+            clixon_err_netconf(h, OE_NETCONF, 0, xerr, "Editing configuration");
+            failed++;
+        }
+        if (xret){
+            xml_free(xret);
+            xret = NULL;
+        }
+    }
+    if (failed)
+        goto done;
+    retval = 0;
+ done:
+    cli_edit_batch_free(h);
+    if (ids)
+        free(ids);
+    return retval;
+}
+
+/*! Add an edit to the batch of CLI edits, send the batch if full
+ *
+ * @param[in]  h      Clixon handle
+ * @param[in]  xmlstr Edit-config XML string with <config> as top element
+ * @param[in]  max    Max number of edits in batch
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+static int
+cli_edit_batch_add(clixon_handle h,
+                   char         *xmlstr,
+                   int           max)
+{
+    struct cli_edit_batch *eb;
+    char                 **vec;
+
+    if ((eb = cli_edit_batch_get(h)) == NULL){
+        if ((eb = calloc(1, sizeof(*eb))) == NULL){
+            clixon_err(OE_UNIX, errno, "calloc");
+            return -1;
+        }
+        if (clicon_ptr_set(h, "cli-edit-batch", eb) < 0){
+            free(eb);
+            return -1;
+        }
+    }
+    if ((vec = realloc(eb->eb_vec, (eb->eb_len+1)*sizeof(*vec))) == NULL){
+        clixon_err(OE_UNIX, errno, "realloc");
+        return -1;
+    }
+    eb->eb_vec = vec;
+    if ((eb->eb_vec[eb->eb_len] = strdup(xmlstr)) == NULL){
+        clixon_err(OE_UNIX, errno, "strdup");
+        return -1;
+    }
+    eb->eb_len++;
+    if (eb->eb_len >= max)
+        return cli_edit_batch_flush(h);
+    return 0;
+}
+
 /*! Modify xml datastore from a callback using xml key format strings
  *
  * @param[in]  h     Clixon handle
@@ -361,6 +504,7 @@ cli_dbxml(clixon_handle       h,
     char      *mtspec = NULL;
     yang_stmt *yspec0 = NULL;
     int        argc = 0;
+    int        batch;
 
     /* Top-level yspec */
     if ((yspec0 = clicon_dbspec_yang(h)) == NULL){
@@ -440,7 +584,11 @@ cli_dbxml(clixon_handle       h,
     }
     if (clixon_xml2cbuf(cb, xtop, 0, 0, NULL, -1, 0) < 0)
         goto done;
-    if (clicon_rpc_edit_config(h, "candidate", OP_NONE, cbuf_get(cb)) < 0)
+    if ((batch = clicon_option_int(h, "CLICON_CLI_EDIT_BATCH")) > 0){
+        if (cli_edit_batch_add(h, cbuf_get(cb), batch) < 0)
+            goto done;
+    }
+    else if (clicon_rpc_edit_config(h, "candidate", OP_NONE, cbuf_get(cb)) < 0)
         goto done;
     retval = 0;
  done:
@@ -804,6 +952,8 @@ cli_commit(clixon_handle h,
     }
     persist = cvec_find_str(cvv, "persist-val");
     persist_id = cvec_find_str(cvv, "persist-id-val");
+    if (cli_edit_batch_flush(h) < 0)
+        goto done;
     if (clicon_rpc_commit(h, confirmed, cancel, timeout, persist, persist_id) < 1)
         goto done;
     retval = 0;
@@ -825,6 +975,8 @@ cli_validate(clixon_handle h,
 {
     int     retval = -1;
 
+    if (cli_edit_batch_flush(h) < 0)
+        goto done;
     if (clicon_rpc_validate(h, "candidate") < 1)
         goto done;
     retval = 0;
@@ -832,6 +984,23 @@ cli_validate(clixon_handle h,
     return retval;
 }
 
+/*! Send batched edits to the backend
+ *
+ * @param[in]  h     Clixon handle
+ * @param[in]  cvv   Vector of command variables
+ * @param[in]  argv  No arguments expected
+ * @retval     0     OK
+ * @retval    -1     Error
+ * @see CLICON_CLI_EDIT_BATCH
+ */
+int
+cli_edit_flush(clixon_handle h,
+               cvec         *cvv,
+               cvec         *argv)
+{
+    return cli_edit_batch_flush(h);
+}
+
 /*! Compare two datastore by name and formats
  *
  * @param[in]  h      Clixon handle
@@ -949,6 +1118,8 @@ compare_dbs(clixon_handle h,
         }
         format = ret;
     }
+    if (cli_edit_batch_flush(h) < 0)
+        goto done;
     if (compare_db_names(h, format, db1, db2) < 0)
         goto done;
     retval = 0;
@@ -956,6 +1127,58 @@ compare_dbs(clixon_handle h,
     return retval;
 }
 
+/*! Check if an XML file has a single <config> top element and can be sent unparsed
+ *
+ * Skips leading whitespace, XML declaration, processing instructions and comments.
+ * @param[in]  fp   Open file. On return positioned at <config> if 1, otherwise at start
+ * @retval     1    Top element is config, fp at start of it
+ * @retval     0    Not config, or not recognized, fp at start of file
+ * @retval    -1    Error
+ */
+static int
+load_config_stream_check(FILE *fp)
+{
+    char   buf[BUFSIZ];
+    size_t len;
+    size_t i = 0;
+    char  *p;
+    size_t taglen = strlen(NETCONF_INPUT_CONFIG);
+
+    if ((len = fread(buf, 1, sizeof(buf)-1, fp)) == 0 && ferror(fp)){
+        clixon_err(OE_UNIX, errno, "fread");
+        return -1;
+    }
+    buf[len] = '\0';
+    while (i < len){
+        if (isspace(buf[i]))
+            i++;
+        else if (strncmp(&buf[i], "<?", 2) == 0){
+            if ((p = strstr(&buf[i], "?>")) == NULL)
+                break;
+            i = p - buf + 2;
+        }
+        else if (strncmp(&buf[i], "<!--", 4) == 0){
+            if ((p = strstr(&buf[i], "-->")) == NULL)
+                break;
+            i = p - buf + 3;
+        }
+        else
+            break;
+    }
+    if (i + taglen + 1 < len &&
+        buf[i] == '<' &&
+        strncmp(&buf[i+1], NETCONF_INPUT_CONFIG, taglen) == 0 &&
+        (isspace(buf[i+taglen+1]) || buf[i+taglen+1] == '>' || buf[i+taglen+1] == '/')){
+        if (fseek(fp, i, SEEK_SET) < 0){
+            clixon_err(OE_UNIX, errno, "fseek");
+            return -1;
+        }
+        return 1;
+    }
+    rewind(fp);
+    return 0;
+}
+
 /*! Load a configuration file to candidate database
  *
  * Utility function used by cligen spec file
@@ -1036,6 +1259,8 @@ load_config_file(clixon_handle h,
         clixon_err(OE_UNIX, errno, "load_config: stat(%s)", filename);
         goto done;
     }
+    if (cli_edit_batch_flush(h) < 0)
+        goto done;
     /* Open and parse local file into xml */
     if ((fp = fopen(filename, "r")) == NULL){
         clixon_err(OE_UNIX, errno, "fopen(%s)", filename);
@@ -1043,6 +1268,20 @@ load_config_file(clixon_handle h,
     }
     switch (format){
     case FORMAT_XML:
+        if (clicon_option_bool(h, "CLICON_CLI_LOAD_STREAM")){
+            if ((ret = load_config_stream_check(fp)) < 0)
+                goto done;
+        }
+        else
+            ret = 0;
+        if (ret == 1){
+            /* Send file as-is, backend validates */
+            if (clicon_rpc_edit_config_file(h, "candidate",
+                                            replace?OP_REPLACE:OP_MERGE,
+                                            fp) < 0)
+                goto done;
+            goto ok;
+        }
         if ((retval = clixon_xml_parse_file(fp, YB_NONE, yspec, &xt, &xerr)) < 0)
             goto done;
         if (retval == 0){
@@ -1201,6 +1440,8 @@ save_config_file(clixon_handle h,
         goto done;
     }
     filename = cv_string_get(cv);
+    if (cli_edit_batch_flush(h) < 0)
+        goto done;
     if (clicon_rpc_get_config(h, NULL, dbstr,"/", NULL, NULL, &xt) < 0)
         goto done;
     if (xt == NULL){
@@ -1290,6 +1531,8 @@ delete_all(clixon_handle h,
         clixon_err(OE_PLUGIN, 0, "No such db name: %s", dbstr);
         goto done;
     }
+    if (cli_edit_batch_flush(h) < 0)
+        goto done;
     if (clicon_rpc_delete_config(h, dbstr) < 0)
         goto done;
     retval = 0;
@@ -1304,8 +1547,9 @@ discard_changes(clixon_handle h,
                 cvec         *cvv,
                 cvec         *argv)
 {
+    /* Batched edits are discarded too */
+    cli_edit_batch_free(h);
     return clicon_rpc_discard_changes(h);
-
 }
 
 /*! Copy from one database to another, eg running->startup
@@ -88,10 +88,13 @@ You can see which CLISPEC it generates via clixon_cli -D 2:
 #include <stdlib.h>
 #include <errno.h>
 #include <fcntl.h>
+#include <unistd.h>
 #include <syslog.h>
 #include <signal.h>
 #include <sys/param.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
 
 /* cligen */
 #include <cligen/cligen.h>
@@ -434,6 +437,85 @@ yang2cli_yspec(clixon_handle h,
     return retval;
 }
 
+/*! Read autocli clispec from backend cache
+ *
+ * If AUTOCLI_CACHE_MMAP and the backend is on a local socket, the cache file is mapped
+ * read-only, so that CLI sessions share the pages and the clispec is not sent in the reply.
+ * Otherwise the clispec is read in the reply and returned in cb.
+ * @param[in]  h        Clixon handle
+ * @param[in]  domain   Domain name
+ * @param[in]  spec     Yang spec name
+ * @param[in]  module   Yang module
+ * @param[in]  revision Yang module revision
+ * @param[in]  keyword  Yang keyword
+ * @param[in]  argument Yang argument
+ * @param[in]  cb       Buffer for clispec if not mapped
+ * @param[out] strp     Clispec string, mapped or in cb
+ * @param[out] maplen   Length of mapping, unmap with munmap if > 0
+ * @retval     0        OK
+ * @retval    -1        Error
+ * @note The backend unlinks but never rewrites a cache file, so a mapping stays valid
+ */
+static int
+yang2cli_cache_read(clixon_handle h,
+                    const char   *domain,
+                    const char   *spec,
+                    const char   *module,
+                    const char   *revision,
+                    const char   *keyword,
+                    const char   *argument,
+                    cbuf         *cb,
+                    char        **strp,
+                    size_t       *maplen)
+{
+    int         retval = -1;
+#ifdef AUTOCLI_CACHE_MMAP
+    char       *filename = NULL;
+    int         fd = -1;
+    struct stat st = {0,};
+    char       *p;
+#endif
+
+    *maplen = 0;
+#ifdef AUTOCLI_CACHE_MMAP
+    if (clicon_sock_family(h) == AF_UNIX){
+        if (clixon_rpc_clixon_cache_file(h, domain, spec, module, revision, keyword, argument, &filename) < 0)
+            goto done;
+        if (filename != NULL &&
+            (fd = open(filename, O_RDONLY)) >= 0 &&
+            fstat(fd, &st) == 0 &&
+            st.st_size > 0){
+            if ((p = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0)) == MAP_FAILED){
+                clixon_err(OE_UNIX, errno, "mmap(%s)", filename);
+                goto done;
+            }
+            if (p[st.st_size-1] == '\0'){
+                *strp = p;
+                *maplen = st.st_size;
+                goto ok;
+            }
+            munmap(p, st.st_size); /* Not NUL-terminated, read in reply */
+        }
+        clixon_debug(CLIXON_DBG_CLI, "Cannot map %s, read in reply", filename?filename:"cache file");
+    }
+#endif
+    if (clixon_rpc_clixon_cache(h, "read", "autocli", domain, spec, module, revision, keyword, argument, cb) < 0)
+        goto done;
+    *strp = cbuf_get(cb);
+#ifdef AUTOCLI_CACHE_MMAP
+ ok:
+#endif
+    retval = 0;
+ done:
+#ifdef AUTOCLI_CACHE_MMAP
+    if (fd != -1)
+        close(fd);
+    if (filename)
+        free(filename);
+#endif
+    return retval;
+}
+
 /*! Generate clispec for all modules given a yang modules-spec in XML
  *
  * @param[in]  h         Clixon handle
@@ -462,6 +544,8 @@ yang2cli_yanglib(clixon_handle h,
     char           *revision;
     char           *keyword;
     int             enable;
+    char           *str = NULL;
+    size_t          maplen = 0;
     //    char           *namespace;
 
     if (autocli_cache(h, &cache, NULL) < 0)
@@ -496,19 +580,26 @@ yang2cli_yanglib(clixon_handle h,
             continue;
         //        namespace = xml_find_body(xy, "namespace");
         cbuf_reset(cb);
-        if (clixon_rpc_clixon_cache(h, "read", "autocli", domain, spec, argument, revision, keyword, argument, cb) < 0)
+        if (yang2cli_cache_read(h, domain, spec, argument, revision, keyword, argument, cb, &str, &maplen) < 0)
             goto done;
-        if (cbuf_len(cb) == 0)
+        if (strlen(str) == 0){
+            if (maplen)
+                munmap(str, maplen);
             continue;
-        if (yang2cli_client(h, cbuf_get(cb), argument, keyword, argument, &pt) < 0)
+        }
+        if (yang2cli_client(h, str, argument, keyword, argument, &pt) < 0)
             goto done;
         if (clicon_data_int_get(h, "autocli-print-debug") == 1){
             clixon_log(h, LOG_NOTICE, "%s: Top-level cli-spec %s:\n%s",
-                       __func__, treename, cbuf_get(cb));
+                       __func__, treename, str);
         }
         else
             clixon_debug(CLIXON_DBG_CLI | CLIXON_DBG_DETAIL, "Top-level cli-spec %s:\n%s",
-                         treename, cbuf_get(cb));
+                         treename, str);
+        if (maplen){
+            munmap(str, maplen);
+            maplen = 0;
+        }
         if (cligen_parsetree_merge(pt0, NULL, pt) < 0){
             clixon_err(OE_YANG, errno, "cligen_parsetree_merge");
             goto done;
@@ -530,6 +621,8 @@ yang2cli_yanglib(clixon_handle h,
     pt0 = NULL;
     retval = 0;
  done:
+    if (maplen)
+        munmap(str, maplen);
     if (pt)
         pt_free(pt, 1);
     if (pt0)
@@ -560,6 +653,7 @@ yang2cli_grouping_wrap_local(clixon_handle h,
                              const char   *domain,
                              const char   *spec,
                              const char   *module,
+                             const char   *keyword,
                              const char   *argument,
                              cbuf         *cb)
 {
@@ -585,6 +679,12 @@ yang2cli_grouping_wrap_local(clixon_handle h,
         clixon_err(OE_YANG, 0, "yang2cli cmd label no module %s", module);
         goto done;
     }
+    if (strcmp(keyword, "grouping") != 0){
+        if ((ys = yang_find(ymod, yang_str2key(keyword), argument)) == NULL)
+            goto skip;
+        retval = yang2cli_toplevel(h, ys, cb);
+        goto done;
+    }
     if ((ys = yang_find(ymod, Y_GROUPING, argument)) == NULL)
         goto skip;
     inext = 0;
@@ -633,6 +733,8 @@ yang2cli_grouping_wrap(cligen_handle ch,
     cbuf           *cb = NULL;
     parse_tree     *pt = NULL;
     autocli_cache_t cache = AUTOCLI_CACHE_DISABLED;
+    char           *str = NULL;
+    size_t          maplen = 0;
     int             ret;
 
     clixon_debug(CLIXON_DBG_CLI, "%s", treename);
@@ -649,7 +751,11 @@ yang2cli_grouping_wrap(cligen_handle ch,
                                 &keyword,
                                 &argument) < 0)
         goto done;
-    if (keyword == NULL || strcmp(keyword, "grouping") != 0)
+    if (keyword == NULL)
+        goto ok;
+    if (strcmp(keyword, "grouping") != 0 &&
+        strcmp(keyword, "container") != 0 &&
+        strcmp(keyword, "list") != 0)
         goto ok;
     if (cligen_ph_find(ch, treename) != NULL){
         if ((*namep = strdup(treename)) == NULL){
@@ -666,21 +772,21 @@ yang2cli_grouping_wrap(cligen_handle ch,
     }
     switch (cache){
         case AUTOCLI_CACHE_DISABLED: /* Generate locally */
-            if ((ret = yang2cli_grouping_wrap_local(h, domain, spec, module, argument, cb)) < 0)
+            if ((ret = yang2cli_grouping_wrap_local(h, domain, spec, module, keyword, argument, cb)) < 0)
                 goto done;
             if (ret == 0)
                 goto ok;
             break;
         case AUTOCLI_CACHE_READ: /* Query backend */
-                if (clixon_rpc_clixon_cache(h, "read", "autocli", domain, spec, module, revision, keyword, argument, cb) < 0)
-                    goto done;
-            if (cbuf_len(cb) == 0){
+            if (yang2cli_cache_read(h, domain, spec, module, revision, keyword, argument, cb, &str, &maplen) < 0)
+                goto done;
+            if (strlen(str) == 0){
                 clixon_err(OE_UNIX, 0, "Tree empty %s 1", treename);
                 goto done;
             }
             break;
     }
-    if (yang2cli_client(h, cbuf_get(cb), module, keyword, argument, &pt) < 0)
+    if (yang2cli_client(h, str?str:cbuf_get(cb), module, keyword, argument, &pt) < 0)
         goto done;
     if (cligen_expand_str2fn(pt, (expand_str2fn_t*)clixon_str2fn, NULL) < 0)
         goto done;
@@ -711,6 +817,8 @@ yang2cli_grouping_wrap(cligen_handle ch,
         free(keyword);
     if (argument)
         free(argument);
+    if (maplen)
+        munmap(str, maplen);
     if (cb)
         cbuf_free(cb);
     return retval;
@@ -721,6 +829,7 @@ yang2cli_grouping_wrap(cligen_handle ch,
  * Initialize CLIgen generation from YANG models.
  * Some logic around grouping-treeref: if enabled, then groupings are separate trees with lazy
  * evaluation.  Only expanded when referenced, but need a callback. If one is not already installed.
+ * The same callback resolves top-level containers and lists, see autocli toplevel-treeref
  * @param[in]  h      Clixon handle
  */
 int
@@ -728,11 +837,14 @@ yang2cli_init(clixon_handle h)
 {
     int                             retval = -1;
     int                             grouping_treeref = 0;
+    int                             toplevel_treeref = 0;
     cligen_tree_resolve_wrapper_fn *fn = NULL;
 
     if (autocli_grouping_treeref(h, &grouping_treeref) < 0)
         goto done;
-    if (grouping_treeref) {
+    if (autocli_toplevel_treeref(h, &toplevel_treeref) < 0)
+        goto done;
+    if (grouping_treeref || toplevel_treeref) {
         cligen_tree_resolve_wrapper_get(cli_cligen(h), &fn, NULL);
         if (fn == NULL)
             cligen_tree_resolve_wrapper_set(cli_cligen(h), yang2cli_grouping_wrap, NULL);
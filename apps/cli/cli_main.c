@@ -52,6 +52,7 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <sys/param.h>
+#include <sys/time.h>
 #include <netinet/in.h>
 #include <pwd.h>
 #include <libgen.h>
@@ -69,6 +70,7 @@
 #include "cli_generate.h"
 #include "cli_common.h"
 #include "cli_handle.h"
+#include "cli_timing.h"
 
 /* Command line options to be passed to getopt(3) */
 #define CLI_OPTS "+hVD:f:E:l:C:F:1sa:u:d:m:qp:GLy:c:U:o:"
@@ -176,6 +178,8 @@ cli_terminate(clixon_handle h)
 
     if (clixon_exit_get() == 0)
         clixon_exit_set(1);
+    /* Send batched edits before leaving, errors are logged */
+    cli_edit_batch_flush(h);
     if (clicon_data_get(h, "session-transport", NULL) == 0)
         clicon_rpc_close_session(h);
     yang_exit(h);
@@ -186,6 +190,11 @@ cli_terminate(clixon_handle h)
     clicon_data_cvec_del(h, "cli-edit-cvv");;
     clicon_data_cvec_del(h, "cli-edit-filter");;
     xpath_optimize_exit();
+    xpath_parse_cache_exit();
+    api_path_cache_exit();
+    regex_cache_exit();
+    expand_dbvar_cache_exit();
+    cli_timing_exit();
     /* Delete all plugins, and RPC callbacks */
     clixon_plugin_module_exit(h);
     /* Delete CLI syntax et al */
@@ -193,6 +202,7 @@ cli_terminate(clixon_handle h)
 
     cli_history_save(h);
     cli_handle_exit(h);
+    xml_exit();
     clixon_debug_exit();
     clixon_err_exit();
     clixon_log_exit();
@@ -433,6 +443,7 @@ main(int    argc,
     enum format_enum config_dump_format = FORMAT_XML;
     int            print_version = 0;
     int32_t        d;
+    struct timeval tv;
 
     /* Defaults */
     once = 0;
@@ -735,6 +746,8 @@ main(int    argc,
     /* In case ietf-yang-metadata is loaded by application, handle annotation extension */
     if (yang_metadata_init(h) < 0)
         goto done;
+    /* YANG descriptions are used as CLI help texts */
+    clicon_option_bool_set(h, "CLICON_YANG_DOCUMENTATION", 1);
     yang_start(h);
     /* Set default namespace according to CLICON_NAMESPACE_NETCONF_DEFAULT */
     xml_nsctx_namespace_netconf_default(h);
@@ -787,13 +800,19 @@ main(int    argc,
             goto done;
         if (!enable)
             clixon_debug(CLIXON_DBG_CLI, "Autocli-enabled is false, skipping autocli generation");
-        else if (autocli_start(h) < 0)
-            goto done;
+        else {
+            yang_profile_start(&tv);
+            if (autocli_start(h) < 0)
+                goto done;
+            yang_profile_stop(YANG_PROF_AUTOCLI, &tv);
+        }
     }
     /* Initialize cli syntax.
      * Plugins have already been loaded by clixon_plugins_load above */
     if (clispec_load(h) < 0)
         goto done;
+    if (yang_profile_log(h, yspec) < 0)
+        goto done;
 
     /* Set syntax mode if specified from command-line or config-file. */
     if (clicon_option_exists(h, "CLICON_CLI_MODE"))
@@ -848,6 +867,7 @@ main(int    argc,
         goto done;
     /* Experimental utf8 mode */
     cligen_utf8_set(cli_cligen(h), clicon_option_int(h,"CLICON_CLI_UTF8"));
+    cli_timing_set(clicon_option_bool(h, "CLICON_CLI_TIMING"));
 
     /* Set RFC6022 session parameters that will be sent in first hello,
      * @see clicon_hello_req
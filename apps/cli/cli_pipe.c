@@ -32,6 +32,8 @@
   ***** END LICENSE BLOCK *****
  * 
  * Example cli pipe output functions.
+ * grep, count, tail and head are built-in filters copying stdin to stdout, other options than
+ * the built-in exec the external commands.
  * @note Paths to bins, such as GREP_BIN, are detected in configure.ac
  * @note These functions are normally run in a forked sub-process as spawned in cligen_eval()
  * A developer should probably revise these functions, since they are primarily intended for testing
@@ -57,6 +59,7 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h>
+#include <regex.h>
 #include <sys/wait.h>
 #include <sys/param.h>
 #include <sys/mount.h>
@@ -119,12 +122,161 @@ pipe_arg_fn(clixon_handle h,
     return retval;
 }
 
+/*! Built-in grep: copy lines of stdin matching a regex to stdout
+ *
+ * The regex is compiled once and matched against each line without newline
+ * @param[in]  pattern  Basic regex, GNU "\\|" is alternation
+ * @param[in]  cflags   Extra regcomp flags, eg REG_ICASE
+ * @param[in]  invert   Copy non-matching lines instead
+ * @retval     0        OK
+ * @retval    -1        Error
+ */
+static int
+pipe_grep_lines(const char *pattern,
+                int         cflags,
+                int         invert)
+{
+    int     retval = -1;
+    regex_t re = {0,};
+    int     compiled = 0;
+    char   *line = NULL;
+    size_t  n = 0;
+    ssize_t len;
+    int     nl;
+    int     match;
+    char    errbuf[128];
+    int     ret;
+
+    if ((ret = regcomp(&re, pattern, cflags | REG_NOSUB)) != 0){
+        regerror(ret, &re, errbuf, sizeof(errbuf));
+        clixon_err(OE_REGEX, 0, "regcomp(%s): %s", pattern, errbuf);
+        goto done;
+    }
+    compiled++;
+    while ((len = getline(&line, &n, stdin)) != -1){
+        if ((nl = (len > 0 && line[len-1] == '\n')) != 0)
+            line[len-1] = '\0';
+        match = regexec(&re, line, 0, NULL, 0) == 0;
+        if (match != invert){
+            if (nl)
+                line[len-1] = '\n';
+            fwrite(line, 1, len, stdout);
+        }
+    }
+    fflush(stdout);
+    retval = 0;
+ done:
+    if (line)
+        free(line);
+    if (compiled)
+        regfree(&re);
+    return retval;
+}
+
+/*! Built-in tail or head: copy the last or first nr lines of stdin to stdout
+ *
+ * All of stdin is read also for head, so that the writer is not interrupted
+ * @param[in]  nr    Number of lines
+ * @param[in]  head  Copy first lines, else last
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+static int
+pipe_lines(int nr,
+           int head)
+{
+    int     retval = -1;
+    char  **ring = NULL;
+    char   *line = NULL;
+    size_t  n = 0;
+    ssize_t len;
+    int     i = 0;
+    int     j;
+
+    if (nr < 0)
+        nr = 0;
+    if (!head && nr > 0 &&
+        (ring = calloc(nr, sizeof(char *))) == NULL){
+        clixon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    while ((len = getline(&line, &n, stdin)) != -1){
+        if (head){
+            if (i < nr)
+                fwrite(line, 1, len, stdout);
+        }
+        else if (nr > 0){
+            if (ring[i % nr])
+                free(ring[i % nr]);
+            ring[i % nr] = line; /* Take over line */
+            line = NULL;
+            n = 0;
+        }
+        i++;
+    }
+    if (ring){
+        for (j = i>nr?i-nr:0; j<i; j++)
+            fputs(ring[j % nr], stdout);
+    }
+    fflush(stdout);
+    retval = 0;
+ done:
+    if (ring){
+        for (j=0; j<nr; j++)
+            if (ring[j])
+                free(ring[j]);
+        free(ring);
+    }
+    if (line)
+        free(line);
+    return retval;
+}
+
+/*! Parse number of lines argument of tail and head
+ *
+ * @param[in]  value  Number as string
+ * @param[out] nr     Number of lines
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+static int
+pipe_lines_nr(char *value,
+              int  *nr)
+{
+    int   retval = -1;
+    char *reason = NULL;
+    int   ret;
+
+    if (value == NULL){
+        clixon_err(OE_PLUGIN, EINVAL, "Number of lines missing");
+        goto done;
+    }
+    if ((ret = parse_int32(value, nr, &reason)) < 0){
+        clixon_err(OE_UNIX, errno, "parse_int32");
+        goto done;
+    }
+    if (ret == 0){
+        clixon_err(OE_PLUGIN, EINVAL, "Number of lines %s: %s", value, reason);
+        goto done;
+    }
+    retval = 0;
+ done:
+    if (reason)
+        free(reason);
+    return retval;
+}
+
 /* Grep pipe output function
  *
+ * Options -e, -v, -i and -vi are built-in, other options exec GREP_BIN
  * @param[in]  h     Clixon handle
  * @param[in]  cvv   Vector of cli string and instantiated variables 
  * @param[in]  argv  String vector of options. Format: <option> <value>
  * @note  Any vertical bar (|] in the patterns field is quoted for OR function
+ * @code
+ *   include <arg:string>, pipe_grep_fn("-e", "arg");
+ *   except <arg:string>, pipe_grep_fn("-v", "arg");
+ * @endcode
  */
 int
 pipe_grep_fn(clixon_handle h,
@@ -171,7 +323,16 @@ pipe_grep_fn(clixon_handle h,
         else
             cprintf(cb, "%c", c);
     }
-    retval = pipe_arg_fn(h, GREP_BIN, option, cbuf_get(cb));
+    if (option == NULL || strcmp(option, "-e") == 0)
+        retval = pipe_grep_lines(cbuf_get(cb), 0, 0);
+    else if (strcmp(option, "-v") == 0)
+        retval = pipe_grep_lines(cbuf_get(cb), 0, 1);
+    else if (strcmp(option, "-i") == 0)
+        retval = pipe_grep_lines(cbuf_get(cb), REG_ICASE, 0);
+    else if (strcmp(option, "-vi") == 0 || strcmp(option, "-iv") == 0)
+        retval = pipe_grep_lines(cbuf_get(cb), REG_ICASE, 1);
+    else
+        retval = pipe_arg_fn(h, GREP_BIN, option, cbuf_get(cb));
  done:
     if (cb)
         cbuf_free(cb);
@@ -180,6 +341,7 @@ pipe_grep_fn(clixon_handle h,
 
 /*! wc pipe output function
  *
+ * Options -l and -c are built-in, other options exec WC_BIN
  * @param[in]  h     Clixon handle
  * @param[in]  cvv   Vector of cli string and instantiated variables 
  * @param[in]  argv  String vector of options. Format: <option> <value>
@@ -195,6 +357,10 @@ pipe_wc_fn(clixon_handle h,
     cg_var *cv;
     char   *str;
     char   *option = NULL;
+    char    buf[BUFSIZ];
+    size_t  len;
+    size_t  nr = 0;
+    size_t  i;
 
     if (cvec_len(argv) != 1){
         clixon_err(OE_PLUGIN, EINVAL, "Received %d arguments. Expected: <NUM>", cvec_len(argv));
@@ -205,13 +371,28 @@ pipe_wc_fn(clixon_handle h,
         (str = cv_string_get(cv)) != NULL &&
         strlen(str))
         option = str;
-    retval = pipe_arg_fn(h, WC_BIN, option, NULL);
+    if (option && (strcmp(option, "-l") == 0 || strcmp(option, "-c") == 0)){
+        while ((len = fread(buf, 1, sizeof(buf), stdin)) > 0){
+            if (option[1] == 'c')
+                nr += len;
+            else
+                for (i=0; i<len; i++)
+                    if (buf[i] == '\n')
+                        nr++;
+        }
+        fprintf(stdout, "%zu\n", nr);
+        fflush(stdout);
+        retval = 0;
+    }
+    else
+        retval = pipe_arg_fn(h, WC_BIN, option, NULL);
  done:
     return retval;
 }
 
-/*! wc pipe output function
+/*! tail pipe output function
  *
+ * Option -n is built-in, other options exec TAIL_BIN
  * @param[in]  h     Clixon handle
  * @param[in]  cvv   Vector of cli string and instantiated variables 
  * @param[in]  argv  String vector of options. Format: <option> <value>
@@ -229,6 +410,7 @@ pipe_tail_fn(clixon_handle h,
     char   *str;
     char   *option = NULL;
     char   *argname = NULL;
+    int     nr;
 
     if (cvec_len(argv) != 2){
         clixon_err(OE_PLUGIN, EINVAL, "Received %d arguments. Expected: <option> <argname>", cvec_len(argv));
@@ -248,11 +430,61 @@ pipe_tail_fn(clixon_handle h,
             strlen(str))
             value = str;
     }
-    return pipe_arg_fn(h, TAIL_BIN, option, value);
+    if (option && strcmp(option, "-n") == 0){
+        if (pipe_lines_nr(value, &nr) < 0)
+            goto done;
+        retval = pipe_lines(nr, 0);
+    }
+    else
+        retval = pipe_arg_fn(h, TAIL_BIN, option, value);
  done:
     return retval;
 }
 
+/*! head pipe output function, built-in
+ *
+ * @param[in]  h     Clixon handle
+ * @param[in]  cvv   Vector of cli string and instantiated variables
+ * @param[in]  argv  String vector of options. Format: <argname>
+ * @retval     0     OK
+ * @retval    -1     Error
+ * @code
+ *   head <arg:uint32>, pipe_head_fn("arg");
+ * @endcode
+ */
+int
+pipe_head_fn(clixon_handle h,
+             cvec         *cvv,
+             cvec         *argv)
+{
+    int     retval = -1;
+    char   *value = NULL;
+    cg_var *cv;
+    char   *str;
+    char   *argname = NULL;
+    int     nr;
+
+    if (cvec_len(argv) != 1){
+        clixon_err(OE_PLUGIN, EINVAL, "Received %d arguments. Expected: <argname>", cvec_len(argv));
+        goto done;
+    }
+    if ((cv = cvec_i(argv, 0)) != NULL &&
+        (str = cv_string_get(cv)) != NULL &&
+        strlen(str))
+        argname = str;
+    if (argname && strlen(argname)){
+        if ((cv = cvec_find_var(cvv, argname)) != NULL)
+            value = cv2str_dup(cv);
+    }
+    if (pipe_lines_nr(value, &nr) < 0)
+        goto done;
+    retval = pipe_lines(nr, 1);
+ done:
+    if (value)
+        free(value);
+    return retval;
+}
+
 /*! Output pipe translate from xml to other format: json,text,
  *
  * @param[in]  h     Clixon handle
@@ -343,6 +575,77 @@ pipe_showas_fn(clixon_handle h,
     return retval;
 }
 
+/*! Output pipe showing the XML nodes selected by an XPath
+ *
+ * The XML output is parsed and the XPath is evaluated on the XML tree instead of on lines.
+ * Prefixes in the XPath are YANG module prefixes.
+ * @param[in]  h     Clixon handle
+ * @param[in]  cvv   Vector of cli string and instantiated variables
+ * @param[in]  argv  String vector of options. Format: <argname>
+ * @retval     0     OK
+ * @retval    -1     Error
+ * @code
+ *   display xpath <xpath:string>, pipe_xpath_fn("xpath");
+ * @endcode
+ */
+int
+pipe_xpath_fn(clixon_handle h,
+              cvec         *cvv,
+              cvec         *argv)
+{
+    int        retval = -1;
+    cxobj     *xt = NULL;
+    cxobj     *xerr = NULL;
+    cxobj    **vec = NULL;
+    size_t     veclen = 0;
+    cvec      *nsc = NULL;
+    yang_stmt *yspec;
+    cg_var    *cv;
+    char      *argname;
+    char      *xpath = NULL;
+    size_t     i;
+    int        ret;
+
+    if (cvec_len(argv) != 1){
+        clixon_err(OE_PLUGIN, EINVAL, "Received %d arguments. Expected: <argname>", cvec_len(argv));
+        goto done;
+    }
+    if ((argname = cv_string_get(cvec_i(argv, 0))) != NULL &&
+        (cv = cvec_find_var(cvv, argname)) != NULL)
+        xpath = cv_string_get(cv);
+    if (xpath == NULL || strlen(xpath) == 0){
+        clixon_err(OE_PLUGIN, EINVAL, "XPath missing");
+        goto done;
+    }
+    yspec = clicon_dbspec_yang(h);
+    if (clixon_xml_parse_file(stdin, YB_NONE, yspec, &xt, NULL) < 0)
+        goto done;
+    if ((ret = xml_bind_yang(h, xt, YB_MODULE, yspec, 0, &xerr)) < 0)
+        goto done;
+    if (ret == 0){
+        clixon_err_netconf(h, OE_NETCONF, 0, xerr, "Parse top file");
+        goto done;
+    }
+    if (xml_nsctx_yangspec(yspec, &nsc) < 0)
+        goto done;
+    if (xpath_vec(xt, nsc, "%s", &vec, &veclen, xpath) < 0)
+        goto done;
+    for (i=0; i<veclen; i++)
+        if (clixon_xml2file(stdout, vec[i], 0, 1, NULL, cligen_output, 0, 0) < 0)
+            goto done;
+    retval = 0;
+ done:
+    if (vec)
+        free(vec);
+    if (nsc)
+        cvec_free(nsc);
+    if (xerr)
+        xml_free(xerr);
+    if (xt)
+        xml_free(xt);
+    return retval;
+}
+
 /*! pipe function: save to file
  *
  * @param[in]  h     Clixon handle
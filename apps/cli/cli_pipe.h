@@ -41,6 +41,8 @@
 int pipe_grep_fn(clixon_handle h, cvec *cvv, cvec *argv);
 int pipe_wc_fn(clixon_handle h, cvec *cvv, cvec *argv);
 int pipe_tail_fn(clixon_handle h, cvec *cvv, cvec *argv);
+int pipe_head_fn(clixon_handle h, cvec *cvv, cvec *argv);
+int pipe_xpath_fn(clixon_handle h, cvec *cvv, cvec *argv);
 int pipe_showas_fn(clixon_handle h, cvec *cvv, cvec *argv);
 int pipe_save_file(clixon_handle h, cvec *cvv, cvec *argv);
 int pipe_generic(clixon_handle h, cvec *cvv, cvec *argv);
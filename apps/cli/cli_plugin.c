@@ -67,6 +67,7 @@
 #include "cli_plugin.h"
 #include "cli_handle.h"
 #include "cli_generate.h"
+#include "cli_timing.h"
 
 /*
  * Constants
@@ -533,6 +534,7 @@ clicon_parse(clixon_handle  h,
     char             *reason = NULL;
     cligen_handle     ch;
     pt_head          *ph;
+    struct cli_timer  ct;
     int               ret;
 
     ch = cli_cligen(h);
@@ -551,8 +553,10 @@ clicon_parse(clixon_handle  h,
             fprintf(f, "No such parse-tree registered: %s\n", modename);
             goto done;
         }
+        cli_timing_start(&ct);
         if (cliread_parse(ch, cmd, pt, &match_obj, &cvv, result, &reason) < 0)
             goto done;
+        cli_timing_match(&ct);
         /* Debug command and result code */
         clixon_debug(CLIXON_DBG_CLI, "result:%d command: \"%s\"", *result, cmd);
         switch (*result) {
@@ -581,6 +585,9 @@ clicon_parse(clixon_handle  h,
                 ret = 0;
             if (evalres)
                 *evalres = ret;
+            cli_timing_eval(&ct);
+            if (cli_timing_add(&ct, cmd) < 0)
+                goto done;
             break;
         default:
             fprintf(f, "CLI syntax error: \"%s\" is ambiguous\n", cmd);
@@ -70,6 +70,7 @@
 /* Exported functions in this file are in clixon_cli_api.h */
 #include "clixon_cli_api.h"
 #include "cli_common.h" /* internal functions */
+#include "cli_timing.h"
 
 /*! Insert (escaped) strings into expand commands
  *
@@ -177,6 +178,197 @@ expand_dbvar_insert(clixon_handle h,
     return retval;
 }
 
+/*! Insert (escaped) keys from the backend into expand commands
+ *
+ * Help function to expand_dbvar
+ * Keys are in datastore order without duplicates, see list-keys rpc
+ * @param[in]  co       Matching cligen object
+ * @param[in]  keys     Keys as string variables
+ * @param[out] commands Vector of function pointers to callback functions
+ * @retval     0        OK
+ * @retval    -1        Error
+ */
+static int
+expand_dbvar_insert_keys(cg_obj *co,
+                         cvec   *keys,
+                         cvec   *commands)
+{
+    int     retval = -1;
+    cg_var *cv;
+    char   *key;
+    char   *keyesc = NULL;
+    int     ret;
+
+    cv = NULL;
+    while ((cv = cvec_each(keys, cv)) != NULL) {
+        key = cv_string_get(cv);
+        /* Dont escape if REST, peek on cligen-object */
+        if (co == NULL || !ISREST(co)){
+            if ((ret = cligen_escape_need(key)) < 0)
+                goto done;
+            if (ret && (keyesc = cligen_escape_do(key)) == NULL)
+                goto done;
+        }
+        if (cvec_add_string(commands, NULL, keyesc?keyesc:key) < 0){
+            clixon_err(OE_UNIX, errno, "cvec_add_string");
+            goto done;
+        }
+        if (keyesc){
+            free(keyesc);
+            keyesc = NULL;
+        }
+    }
+    retval = 0;
+ done:
+    if (keyesc)
+        free(keyesc);
+    return retval;
+}
+
+/*! Cached expansion of a datastore xpath, valid while the datastore generation is unchanged
+ *
+ * @see expand_dbvar
+ */
+struct expand_cache {
+    uint64_t ec_gen; /* Generation of datastore when expanded */
+    cvec    *ec_cvv; /* Expanded, possibly escaped, values */
+};
+
+/* Expansion cache of expand_dbvar, key is datastore and xpath */
+static clicon_hash_t *_expand_cache = NULL;
+
+/*! Free all entries of expand cache
+ */
+static int
+expand_dbvar_cache_clear(void)
+{
+    struct expand_cache *ec;
+    char               **keys = NULL;
+    size_t               klen = 0;
+    size_t               i;
+
+    if (_expand_cache == NULL)
+        return 0;
+    if (clicon_hash_keys(_expand_cache, &keys, &klen) < 0)
+        return -1;
+    for (i = 0; i < klen; i++){
+        if ((ec = clicon_hash_value(_expand_cache, keys[i], NULL)) != NULL &&
+            ec->ec_cvv)
+            cvec_free(ec->ec_cvv);
+        clicon_hash_del(_expand_cache, keys[i]);
+    }
+    if (keys)
+        free(keys);
+    return 0;
+}
+
+/*! Get cached expansion if datastore is unchanged since it was cached
+ *
+ * @param[in]  key      Datastore and xpath
+ * @param[in]  gen      Current generation of datastore
+ * @param[out] commands Cached values are appended
+ * @retval     1        Found, values appended
+ * @retval     0        Not found or stale
+ * @retval    -1        Error
+ */
+static int
+expand_dbvar_cache_get(const char *key,
+                       uint64_t    gen,
+                       cvec       *commands)
+{
+    struct expand_cache *ec;
+    cg_var              *cv;
+
+    if (_expand_cache == NULL ||
+        (ec = clicon_hash_value(_expand_cache, key, NULL)) == NULL ||
+        ec->ec_gen != gen)
+        return 0;
+    cv = NULL;
+    while ((cv = cvec_each(ec->ec_cvv, cv)) != NULL)
+        if (cvec_add_string(commands, NULL, cv_string_get(cv)) < 0){
+            clixon_err(OE_UNIX, errno, "cvec_add_string");
+            return -1;
+        }
+    clixon_debug(CLIXON_DBG_CLI, "%s: %d cached", key, cvec_len(ec->ec_cvv));
+    return 1;
+}
+
+/*! Cache expansion of datastore xpath, replacing any stale entry
+ *
+ * The whole cache is cleared when it has CLI_EXPAND_CACHE_MAX entries
+ * @param[in]  key      Datastore and xpath
+ * @param[in]  gen      Generation of datastore before it was read
+ * @param[in]  commands Expanded values
+ * @param[in]  i0       Index of first value of this expansion in commands
+ * @retval     0        OK
+ * @retval    -1        Error
+ */
+static int
+expand_dbvar_cache_add(const char *key,
+                       uint64_t    gen,
+                       cvec       *commands,
+                       int         i0)
+{
+    int                  retval = -1;
+    struct expand_cache  ec = {0,};
+    struct expand_cache *ec0;
+    char               **keys = NULL;
+    size_t               klen = 0;
+    int                  i;
+
+    if (_expand_cache == NULL &&
+        (_expand_cache = clicon_hash_init()) == NULL)
+        goto done;
+    if ((ec0 = clicon_hash_value(_expand_cache, key, NULL)) != NULL){
+        if (ec0->ec_cvv)
+            cvec_free(ec0->ec_cvv);
+        clicon_hash_del(_expand_cache, key);
+    }
+    else {
+        if (clicon_hash_keys(_expand_cache, &keys, &klen) < 0)
+            goto done;
+        if (klen >= CLI_EXPAND_CACHE_MAX &&
+            expand_dbvar_cache_clear() < 0)
+            goto done;
+    }
+    if ((ec.ec_cvv = cvec_new(0)) == NULL){
+        clixon_err(OE_UNIX, errno, "cvec_new");
+        goto done;
+    }
+    for (i = i0; i < cvec_len(commands); i++)
+        if (cvec_add_string(ec.ec_cvv, NULL, cv_string_get(cvec_i(commands, i))) < 0){
+            clixon_err(OE_UNIX, errno, "cvec_add_string");
+            goto done;
+        }
+    ec.ec_gen = gen;
+    if (clicon_hash_add(_expand_cache, key, &ec, sizeof(ec)) == NULL)
+        goto done;
+    ec.ec_cvv = NULL;
+    retval = 0;
+ done:
+    if (ec.ec_cvv)
+        cvec_free(ec.ec_cvv);
+    if (keys)
+        free(keys);
+    return retval;
+}
+
+/*! Free expand cache, called on exit
+ *
+ * @see expand_dbvar
+ */
+int
+expand_dbvar_cache_exit(void)
+{
+    if (_expand_cache == NULL)
+        return 0;
+    if (expand_dbvar_cache_clear() < 0)
+        return -1;
+    clicon_hash_free(_expand_cache);
+    _expand_cache = NULL;
+    return 0;
+}
+
 /*! Completion callback of variable for configured data and automatically generated data model
  *
  * Returns an expand-type list of commands as used by cligen 'expand'
@@ -200,6 +392,8 @@ expand_dbvar_insert(clixon_handle h,
  *   %k  Represents the (first) key of the (previous) list
  * @note Label leafref-no-refer means do not expand leafrefs referred values, instead use the
  * once in place
+ * @note Expansions are cached per datastore and xpath and reused while the generation of
+ * the datastore is unchanged, see CLI_EXPAND_CACHE_MAX
  */
 int
 expand_dbvar(clixon_handle h,
@@ -234,8 +428,15 @@ expand_dbvar(clixon_handle h,
     cvec            *callback_cvv;
     int              argc = 0;
     cvec            *cvv2 = NULL;
+    cbuf            *cbkey = NULL;
+    cvec            *keys = NULL;
+    uint64_t         gen = 0;
+    struct timeval   tv;
+    int              i0;
+    uint64_t         t0;
     int              ret;
 
+    t0 = cli_timing_usec();
     if (argv == NULL || (cvec_len(argv) != 2 && cvec_len(argv) != 3)){
         clixon_err(OE_PLUGIN, EINVAL, "requires arguments: <db> <apipathfmt> [<mountpt>]");
         goto done;
@@ -323,28 +524,57 @@ expand_dbvar(clixon_handle h,
             cvec_append_var(nsc, cv);
     }
     cprintf(cbxpath, "%s", xpath);
-    /* Get configuration based on cbxpath */
-    if (clixon_rpc_get_config1(h, NULL, dbstr, cbuf_get(cbxpath), nsc, NULL, YB_NONE, &xt) < 0)
+    /* Reuse cached expansion if datastore is unchanged, escaping depends on co */
+    if (clicon_rpc_generation(h, dbstr, &gen, &tv) < 0)
         goto done;
-    if ((ret = xml_bind_yang_mnt(h, xt, YB_MODULE, yspec0, 0, 1, &xerr)) < 0)
+    if ((cbkey = cbuf_new()) == NULL){
+        clixon_err(OE_UNIX, errno, "cbuf_new");
         goto done;
-    if (ret == 0){
-        if ((xe = xpath_first(xerr, NULL, "/rpc-error")) != NULL)
-            clixon_err_netconf(h, OE_NETCONF, 0, xe, "Get configuration");
-        goto ok;
     }
-    if ((xe = xpath_first(xt, NULL, "/rpc-error")) != NULL){
-        clixon_err_netconf(h, OE_NETCONF, 0, xe, "Get configuration");
+    cprintf(cbkey, "%s %d %s", dbstr, co != NULL && ISREST(co), cbuf_get(cbxpath));
+    if ((ret = expand_dbvar_cache_get(cbuf_get(cbkey), gen, commands)) < 0)
+        goto done;
+    if (ret == 1)
         goto ok;
+    i0 = cvec_len(commands);
+    if (mtdomain == NULL){
+        /* Get only the keys, not the list entries */
+        if (clicon_rpc_list_keys(h, dbstr, cbuf_get(cbxpath), nsc, NULL, 0, &keys, NULL) < 0)
+            goto done;
+        if (expand_dbvar_insert_keys(co, keys, commands) < 0)
+            goto done;
     }
-    if (xpath_vec(xt, nsc, "%s", &xvec, &xlen, cbuf_get(cbxpath)) < 0)
-        goto done;
-    /* Loop for inserting into commands cvec. */
-    if (expand_dbvar_insert(h, co, xvec, xlen, commands) < 0)
+    else {
+        /* Get configuration based on cbxpath, bound to mounted yang */
+        if (clixon_rpc_get_config1(h, NULL, dbstr, cbuf_get(cbxpath), nsc, NULL, YB_NONE, &xt) < 0)
+            goto done;
+        if ((ret = xml_bind_yang_mnt(h, xt, YB_MODULE, yspec0, 0, 1, &xerr)) < 0)
+            goto done;
+        if (ret == 0){
+            if ((xe = xpath_first(xerr, NULL, "/rpc-error")) != NULL)
+                clixon_err_netconf(h, OE_NETCONF, 0, xe, "Get configuration");
+            goto ok;
+        }
+        if ((xe = xpath_first(xt, NULL, "/rpc-error")) != NULL){
+            clixon_err_netconf(h, OE_NETCONF, 0, xe, "Get configuration");
+            goto ok;
+        }
+        if (xpath_vec(xt, nsc, "%s", &xvec, &xlen, cbuf_get(cbxpath)) < 0)
+            goto done;
+        /* Loop for inserting into commands cvec. */
+        if (expand_dbvar_insert(h, co, xvec, xlen, commands) < 0)
+            goto done;
+    }
+    if (expand_dbvar_cache_add(cbuf_get(cbkey), gen, commands, i0) < 0)
         goto done;
  ok:
     retval = 0;
  done:
+    cli_timing_expand_add(cli_timing_usec() - t0);
+    if (cbkey)
+        cbuf_free(cbkey);
+    if (keys)
+        cvec_free(keys);
     if (mtdomain)
         free(mtdomain);
     if (mtspec)
@@ -645,6 +875,162 @@ show_yang(clixon_handle h,
     return retval;
 }
 
+#ifdef CLI_SHOW_PAGE_SIZE
+/*! Show list entries page by page as they are received from the backend
+ *
+ * Pages of CLI_SHOW_PAGE_SIZE entries are requested with list-pagination using the cursor of
+ * the last entry of the previous page, so that the first entries are shown without getting
+ * the whole list, and the next page is requested only when the previous is shown, ie as the
+ * user scrolls. If the output is quit, the remaining pages are not requested.
+ * Only applicable if xpath selects a config list or leaf-list without a predicate in the
+ * last step, and for formats where entries are printed one by one.
+ * @param[in] h            Clixon handle
+ * @param[in] db           Datastore
+ * @param[in] format       Output format
+ * @param[in] pretty
+ * @param[in] state
+ * @param[in] withdefault  RFC 6243 with-default modes
+ * @param[in] extdefault   with-defaults with propriatary extensions
+ * @param[in] prepend      CLI prefix to prepend cli syntax, eg "set "
+ * @param[in] xpath        XPath
+ * @param[in] fromroot     If 0, display config from node of XPATH, if 1 display from root
+ * @param[in] nsc          Namespace mapping for xpath
+ * @param[in] skiptop      If set, do not show object itself, only its children
+ * @retval    1            OK, shown
+ * @retval    0            Not applicable, nothing shown
+ * @retval   -1            Error
+ * @see cli_pagination
+ */
+static int
+cli_show_paged(clixon_handle    h,
+               char            *db,
+               enum format_enum format,
+               int              pretty,
+               int              state,
+               char            *withdefault,
+               char            *extdefault,
+               char            *prepend,
+               char            *xpath,
+               int              fromroot,
+               cvec            *nsc,
+               int              skiptop)
+{
+    int        retval = -1;
+    yang_stmt *yspec;
+    yang_stmt *y = NULL;
+    cxobj     *xret = NULL;
+    cxobj     *xe;
+    cxobj     *xa;
+    cxobj    **xvec = NULL;
+    size_t     xlen = 0;
+    cxobj     *xc;
+    char      *p;
+    char      *cursor = NULL;
+    int        i;
+
+    if (fromroot || skiptop || xpath == NULL ||
+        (format != FORMAT_XML && format != FORMAT_TEXT && format != FORMAT_CLI))
+        goto notapplicable;
+    /* Tagged modes remove default nodes from the whole tree */
+    if (extdefault &&
+        (strcmp(extdefault, "report-all-tagged-strip") == 0 ||
+         strcmp(extdefault, "report-all-tagged-default") == 0))
+        goto notapplicable;
+    if ((p = strrchr(xpath, '/')) == NULL || strchr(p, '[') != NULL)
+        goto notapplicable;
+    if ((yspec = clicon_dbspec_yang(h)) == NULL){
+        clixon_err(OE_FATAL, 0, "No DB_SPEC");
+        goto done;
+    }
+    if (yang_path_arg(yspec, xpath, &y) < 0){
+        clixon_err_reset(); /* Not a schema path, eg mountpoint */
+        goto notapplicable;
+    }
+    if (y == NULL ||
+        (yang_keyword_get(y) != Y_LIST && yang_keyword_get(y) != Y_LEAF_LIST) ||
+        yang_config_ancestor(y) == 0)
+        goto notapplicable;
+    do {
+        if (clicon_rpc_get_pageable_list(h, db, xpath, nsc,
+                                         state?CONTENT_ALL:CONTENT_CONFIG,
+                                         -1,                 /* depth */
+                                         withdefault,
+                                         0,                  /* offset */
+                                         CLI_SHOW_PAGE_SIZE, /* limit */
+                                         NULL, NULL, NULL,
+                                         cursor,
+                                         &xret) < 0)
+            goto done;
+        if ((xe = xpath_first(xret, NULL, "/rpc-error")) != NULL){
+            clixon_err_netconf(h, OE_NETCONF, 0, xe, "Get configuration");
+            goto ok;
+        }
+        if (xpath_vec(xret, nsc, "%s", &xvec, &xlen, xpath) < 0)
+            goto done;
+        if (cursor){
+            free(cursor);
+            cursor = NULL;
+        }
+        for (i = 0; i < xlen; i++){
+            xc = xvec[i];
+            /* Last entry has the cursor of the next page if entries remain */
+            if ((xa = xml_find_type(xc, "lp", "next", CX_ATTR)) != NULL){
+                if ((cursor = strdup(xml_value(xa))) == NULL){
+                    clixon_err(OE_UNIX, errno, "strdup");
+                    goto done;
+                }
+                if (xml_purge(xa) < 0)
+                    goto done;
+            }
+            if ((xa = xml_find_type(xc, "xmlns", "lp", CX_ATTR)) != NULL &&
+                xml_purge(xa) < 0)
+                goto done;
+            switch (format){
+            case FORMAT_XML:
+                if (clixon_xml2file(stdout, xc, 0, pretty, NULL, cligen_output, 0, 1) < 0)
+                    goto done;
+                break;
+            case FORMAT_TEXT:
+                if (clixon_text2file(stdout, xc, 0, cligen_output, 0, 1) < 0)
+                    goto done;
+                break;
+            case FORMAT_CLI:
+                if (clixon_cli2file(h, stdout, xc, prepend, cligen_output, 0) < 0)
+                    goto done;
+                break;
+            default:
+                break;
+            }
+            if (cli_output_status() < 0)
+                goto ok; /* Output quit, skip remaining pages */
+        }
+        if (!pretty && format == FORMAT_XML && xlen && cursor == NULL)
+            cligen_output(stdout, "\n");
+        if (xvec){
+            free(xvec);
+            xvec = NULL;
+        }
+        if (xret){
+            xml_free(xret);
+            xret = NULL;
+        }
+    } while (cursor != NULL);
+ ok:
+    retval = 1;
+ done:
+    if (cursor)
+        free(cursor);
+    if (xvec)
+        free(xvec);
+    if (xret)
+        xml_free(xret);
+    return retval;
+ notapplicable:
+    retval = 0;
+    goto done;
+}
+#endif /* CLI_SHOW_PAGE_SIZE */
+
 /*! Common internal show routine for several show cli callbacks
  *
  * @param[in] h            Clixon handle
@@ -691,6 +1077,13 @@ cli_show_common(clixon_handle    h,
         clixon_err(OE_FATAL, 0, "Show state only for running database, not %s", db);
         goto done;
     }
+#ifdef CLI_SHOW_PAGE_SIZE
+    if ((ret = cli_show_paged(h, db, format, pretty, state, withdefault, extdefault,
+                              prepend, xpath, fromroot, nsc, skiptop)) < 0)
+        goto done;
+    if (ret == 1)
+        goto ok;
+#endif
     if (state == 0){     /* Get configuration-only from a database */
         if ((ret = clixon_rpc_get_config1(h, NULL, db, xpath, nsc, withdefault, YB_NONE, &xt)) < 0){
             goto done;
@@ -1499,6 +1892,7 @@ cli_pagination(clixon_handle h,
                                          limit*i,  /* offset */
                                          limit,    /* limit */
                                          NULL, NULL, NULL, /* nyi */
+                                         NULL,     /* cursor */
                                          &xret) < 0){
             goto done;
         }
@@ -2091,6 +2485,216 @@ cli_show_sessions(clixon_handle h,
     return retval;
 }
 
+/*! Compare XPath profile entries on total evaluation time, descending
+ */
+static int
+xpath_stats_cmp(const void *a,
+                const void *b)
+{
+    char    *b1;
+    char    *b2;
+    uint64_t u1 = 0;
+    uint64_t u2 = 0;
+
+    if ((b1 = xml_find_body(*(cxobj **)a, "total-usec")) != NULL)
+        u1 = strtoull(b1, NULL, 10);
+    if ((b2 = xml_find_body(*(cxobj **)b, "total-usec")) != NULL)
+        u2 = strtoull(b2, NULL, 10);
+    if (u1 == u2)
+        return 0;
+    return u1 < u2 ? 1 : -1;
+}
+
+/*! Show backend XPath profile, most time-consuming XPath first
+ *
+ * Requires CLICON_XPATH_PROFILE to be set in the backend
+ * @param[in]  h     Clixon handle
+ * @param[in]  cvv   Vector of cli string and instantiated variables
+ * @param[in]  argv  Arguments given at the callback: [detail]
+ * @retval     0     OK
+ * @retval    -1     Error
+ * @see xpath_profile_print
+ */
+int
+cli_show_xpath_stats(clixon_handle h,
+                     cvec         *cvv,
+                     cvec         *argv)
+{
+    int      retval = -1;
+    cvec    *nsc = NULL;
+    cxobj   *xret = NULL;
+    cxobj   *xerr;
+    cxobj   *x;
+    cxobj  **vec = NULL;
+    size_t   veclen = 0;
+    cg_var  *cv;
+    int      detail = 0;
+    int      i;
+    char    *b;
+
+    if (argv != NULL && cvec_len(argv) > 1){
+        clixon_err(OE_PLUGIN, EINVAL, "optional argument: <detail>");
+        goto done;
+    }
+    if (argv != NULL && cvec_len(argv) == 1){
+        if ((cv = cvec_i(argv, 0)) == NULL){
+            clixon_err(OE_PLUGIN, 0, "Error when accessing argument <detail>");
+            goto done;
+        }
+        detail = strcmp(cv_string_get(cv), "detail")==0;
+    }
+    if ((nsc = xml_nsctx_init(CLIXON_LIB_PREFIX, CLIXON_LIB_NS)) == NULL)
+        goto done;
+    if (clicon_rpc_get(h, CLIXON_LIB_PREFIX ":xpath-stats", nsc, CONTENT_NONCONFIG, -1, "report-all", &xret) < 0)
+        goto done;
+    if ((xerr = xpath_first(xret, NULL, "/rpc-error")) != NULL){
+        clixon_err_netconf(h, OE_XML, 0, xerr, "Get xpath-stats");
+        goto done;
+    }
+    if (xpath_vec(xret, NULL, "xpath-stats/xpath", &vec, &veclen) < 0)
+        goto done;
+    if (veclen > 1)
+        qsort(vec, veclen, sizeof(*vec), xpath_stats_cmp);
+    if (!detail && veclen){
+        cligen_output(stdout, "%-10s %-12s %-10s %-12s %-10s %s\n",
+                      "Calls", "Total(us)", "Max(us)", "Nodes", "Optimized", "XPath");
+        cligen_output(stdout, "===============================================================\n");
+    }
+    for (i=0; i<veclen; i++){
+        x = vec[i];
+        if (detail){
+            if (clixon_xml2file(stdout, x, 0, 1, NULL, cligen_output, 0, 1) < 0)
+                goto done;
+            continue;
+        }
+        b = xml_find_body(x, "calls");
+        cligen_output(stdout, "%-11s", b?b:"");
+        b = xml_find_body(x, "total-usec");
+        cligen_output(stdout, "%-13s", b?b:"");
+        b = xml_find_body(x, "max-usec");
+        cligen_output(stdout, "%-11s", b?b:"");
+        b = xml_find_body(x, "nodes");
+        cligen_output(stdout, "%-13s", b?b:"");
+        b = xml_find_body(x, "optimized");
+        cligen_output(stdout, "%-11s", b?b:"");
+        b = xml_find_body(x, "expr");
+        cligen_output(stdout, "%s\n", b?b:"");
+    }
+    retval = 0;
+ done:
+    if (nsc)
+        cvec_free(nsc);
+    if (vec)
+        free(vec);
+    if (xret)
+        xml_free(xret);
+    return retval;
+}
+
+/*! Show backend memory usage per subsystem and per datastore cache
+ *
+ * @param[in]  h     Clixon handle
+ * @param[in]  cvv   Vector of cli string and instantiated variables
+ * @param[in]  argv  Arguments given at the callback: [xml]
+ * @retval     0     OK
+ * @retval    -1     Error
+ * @see memory_state_get  in backend
+ */
+int
+cli_show_memory(clixon_handle h,
+                cvec         *cvv,
+                cvec         *argv)
+{
+    int      retval = -1;
+    cvec    *nsc = NULL;
+    cxobj   *xret = NULL;
+    cxobj   *xerr;
+    cxobj   *xm;
+    cxobj   *x;
+    cg_var  *cv;
+    int      xml = 0;
+    char    *b;
+    uint64_t u64;
+    uint64_t tsz = 0;
+    char    *unit;
+    char     valbuf[32];
+
+    if (argv != NULL && cvec_len(argv) > 1){
+        clixon_err(OE_PLUGIN, EINVAL, "optional argument: <xml>");
+        goto done;
+    }
+    if (argv != NULL && cvec_len(argv) == 1){
+        if ((cv = cvec_i(argv, 0)) == NULL){
+            clixon_err(OE_PLUGIN, 0, "Error when accessing argument <xml>");
+            goto done;
+        }
+        xml = strcmp(cv_string_get(cv), "xml")==0;
+    }
+    if ((nsc = xml_nsctx_init(CLIXON_LIB_PREFIX, CLIXON_LIB_NS)) == NULL)
+        goto done;
+    if (clicon_rpc_get(h, CLIXON_LIB_PREFIX ":memory-stats", nsc, CONTENT_NONCONFIG, -1, "report-all", &xret) < 0)
+        goto done;
+    if ((xerr = xpath_first(xret, NULL, "/rpc-error")) != NULL){
+        clixon_err_netconf(h, OE_XML, 0, xerr, "Get memory-stats");
+        goto done;
+    }
+    if ((xm = xpath_first(xret, NULL, "memory-stats")) == NULL)
+        goto ok;
+    if (xml){
+        if (clixon_xml2file(stdout, xm, 0, 1, NULL, cligen_output, 0, 1) < 0)
+            goto done;
+        goto ok;
+    }
+    cligen_output(stdout, "%-25s %-12s %-12s %s\n", "Category", "Objects", "Bytes", "Max");
+    cligen_output(stdout, "===============================================================\n");
+    x = NULL;
+    while ((x = xml_child_each(xm, x, CX_ELMNT)) != NULL) {
+        if (strcmp(xml_name(x), "category") != 0)
+            continue;
+        b = xml_find_body(x, "name");
+        cligen_output(stdout, "%-26s", b?b:"");
+        b = xml_find_body(x, "nr");
+        cligen_output(stdout, "%-13s", b?b:"");
+        u64 = (b = xml_find_body(x, "bytes")) ? strtoull(b, NULL, 10) : 0;
+        tsz += u64;
+        translatenumber(u64, &u64, &unit);
+        snprintf(valbuf, sizeof(valbuf), "%" PRIu64 "%s", u64, unit);
+        cligen_output(stdout, "%-13s", valbuf);
+        if ((b = xml_find_body(x, "max-bytes")) != NULL){
+            translatenumber(strtoull(b, NULL, 10), &u64, &unit);
+            cligen_output(stdout, "%" PRIu64 "%s", u64, unit);
+        }
+        cligen_output(stdout, "\n");
+    }
+    cligen_output(stdout, "\n%-25s %-12s %s\n", "Datastore", "Nodes", "Bytes");
+    cligen_output(stdout, "===============================================================\n");
+    x = NULL;
+    while ((x = xml_child_each(xm, x, CX_ELMNT)) != NULL) {
+        if (strcmp(xml_name(x), "datastore") != 0)
+            continue;
+        b = xml_find_body(x, "name");
+        cligen_output(stdout, "%-26s", b?b:"");
+        b = xml_find_body(x, "nodes");
+        cligen_output(stdout, "%-13s", b?b:"");
+        u64 = (b = xml_find_body(x, "bytes")) ? strtoull(b, NULL, 10) : 0;
+        tsz += u64;
+        translatenumber(u64, &u64, &unit);
+        b = xml_find_body(x, "shared");
+        cligen_output(stdout, "%" PRIu64 "%s%s\n", u64, unit,
+                      b && strcmp(b, "true") == 0 ? " (shared)" : "");
+    }
+    translatenumber(tsz, &u64, &unit);
+    cligen_output(stdout, "\n%-25s %" PRIu64 "%s\n", "Total", u64, unit);
+ ok:
+    retval = 0;
+ done:
+    if (nsc)
+        cvec_free(nsc);
+    if (xret)
+        xml_free(xret);
+    return retval;
+}
+
 /*! Given mount-point and api_path_fmt, find api_path
  *
  * @param[in]  h            Clixon handle
@@ -0,0 +1,285 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+ 
+  Copyright (C) 2009-2016 Olof Hagsand and Benny Holmgren
+  Copyright (C) 2017-2019 Olof Hagsand
+  Copyright (C) 2020-2022 Olof Hagsand and Rubicon Communications, LLC (Netgate)
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2, 
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+
+ * Timing of CLI commands, see CLICON_CLI_TIMING
+ * The time of the last CLI_TIMING_HISTORY commands is kept, split into the phases:
+ * - match: cligen parse of the command, excluding expand callbacks
+ * - expand: expand callbacks during match, eg expand_dbvar()
+ * - rpc: backend rpcs made by the command callback
+ * - print: rest of the command callback, typically formatting and printing
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "clixon_config.h" /* generated by config & autoconf */
+#endif
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <errno.h>
+#include <sys/time.h>
+
+/* cligen */
+#include <cligen/cligen.h>
+
+/* clixon */
+#include <clixon/clixon.h>
+
+#include "clixon_cli_api.h"
+#include "cli_timing.h"
+
+/*! Timing of one executed CLI command
+ */
+struct cli_timing_entry {
+    char    *cte_cmd;      /* Command string, malloced */
+    uint64_t cte_match;    /* Match time excluding expand in microseconds */
+    uint64_t cte_expand;   /* Expand time in microseconds */
+    uint64_t cte_rpc;      /* Backend rpc time in microseconds */
+    uint64_t cte_rpc_nr;   /* Number of backend rpcs */
+    uint64_t cte_print;    /* Callback time excluding rpcs in microseconds */
+};
+typedef struct cli_timing_entry cli_timing_entry;
+
+static int              _cli_timing_enable = 0;
+static uint64_t         _cli_timing_expand = 0; /* Expand time of current command */
+static uint64_t         _cli_timing_nr = 0;     /* Number of commands recorded */
+static cli_timing_entry _cli_timing[CLI_TIMING_HISTORY]; /* Ring of last commands */
+
+/*! Enable or disable CLI command timing
+ *
+ * @param[in]  enable  0: disable, 1: enable
+ */
+void
+cli_timing_set(int enable)
+{
+    _cli_timing_enable = enable;
+}
+
+/*! Get wall time in microseconds
+ */
+uint64_t
+cli_timing_usec(void)
+{
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+    return (uint64_t)tv.tv_sec*1000000 + tv.tv_usec;
+}
+
+/*! Start timing of a CLI command before match
+ *
+ * @param[out] ct   Timer
+ */
+void
+cli_timing_start(struct cli_timer *ct)
+{
+    memset(ct, 0, sizeof(*ct));
+    if ((ct->ct_on = _cli_timing_enable) == 0)
+        return;
+    _cli_timing_expand = 0;
+    ct->ct_t0 = cli_timing_usec();
+}
+
+/*! End of match and start of callback of a CLI command
+ *
+ * @param[in]  ct   Timer
+ */
+void
+cli_timing_match(struct cli_timer *ct)
+{
+    uint64_t t;
+
+    if (!ct->ct_on)
+        return;
+    t = cli_timing_usec();
+    ct->ct_match = t - ct->ct_t0;
+    ct->ct_t0 = t;
+    clicon_rpc_stats_get(&ct->ct_rpc_nr, &ct->ct_rpc_usec);
+}
+
+/*! End of callback of a CLI command
+ *
+ * @param[in]  ct   Timer
+ */
+void
+cli_timing_eval(struct cli_timer *ct)
+{
+    uint64_t nr;
+    uint64_t usec;
+
+    if (!ct->ct_on)
+        return;
+    ct->ct_eval = cli_timing_usec() - ct->ct_t0;
+    clicon_rpc_stats_get(&nr, &usec);
+    ct->ct_rpc_nr = nr - ct->ct_rpc_nr;
+    ct->ct_rpc_usec = usec - ct->ct_rpc_usec;
+}
+
+/*! Add time of an expand callback to the current command
+ *
+ * @param[in]  usec  Wall time of expand callback in microseconds
+ */
+void
+cli_timing_expand_add(uint64_t usec)
+{
+    if (_cli_timing_enable)
+        _cli_timing_expand += usec;
+}
+
+/*! Record timing of an executed CLI command
+ *
+ * @param[in]  ct   Timer
+ * @param[in]  cmd  Command string
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+int
+cli_timing_add(struct cli_timer *ct,
+               const char       *cmd)
+{
+    cli_timing_entry *cte;
+    char             *str;
+
+    if (!ct->ct_on)
+        return 0;
+    if ((str = strdup(cmd)) == NULL){
+        clixon_err(OE_UNIX, errno, "strdup");
+        return -1;
+    }
+    cte = &_cli_timing[_cli_timing_nr++ % CLI_TIMING_HISTORY];
+    if (cte->cte_cmd)
+        free(cte->cte_cmd);
+    cte->cte_cmd = str;
+    cte->cte_expand = _cli_timing_expand;
+    cte->cte_match = ct->ct_match > _cli_timing_expand ? ct->ct_match - _cli_timing_expand : 0;
+    cte->cte_rpc = ct->ct_rpc_usec;
+    cte->cte_rpc_nr = ct->ct_rpc_nr;
+    cte->cte_print = ct->ct_eval > ct->ct_rpc_usec ? ct->ct_eval - ct->ct_rpc_usec : 0;
+    _cli_timing_expand = 0;
+    return 0;
+}
+
+/*! Free recorded CLI command timing
+ */
+void
+cli_timing_exit(void)
+{
+    int i;
+
+    for (i=0; i<CLI_TIMING_HISTORY; i++)
+        if (_cli_timing[i].cte_cmd){
+            free(_cli_timing[i].cte_cmd);
+            _cli_timing[i].cte_cmd = NULL;
+        }
+    _cli_timing_nr = 0;
+}
+
+/*! Show timing of last CLI commands in ms: match, expand, backend rpc and print
+ *
+ * @param[in]  h     Clixon handle
+ * @param[in]  cvv   Vector of command variables
+ * @param[in]  argv  Optional "clear" to clear recorded timing after showing
+ * @retval     0     OK
+ * @retval    -1     Error
+ * @code
+ *   show cli-timing, cli_show_timing();
+ * @endcode
+ * @see CLICON_CLI_TIMING
+ */
+int
+cli_show_timing(clixon_handle h,
+                cvec         *cvv,
+                cvec         *argv)
+{
+    int               retval = -1;
+    cli_timing_entry *cte;
+    uint64_t          i0;
+    uint64_t          i;
+    uint64_t          sum[4] = {0,};
+    uint64_t          max[4] = {0,};
+    uint64_t          v[4];
+    uint64_t          rpcs = 0;
+    uint64_t          n;
+    int               j;
+    int               clear = 0;
+
+    if (argv && cvec_len(argv) > 0){
+        if (strcmp(cv_string_get(cvec_i(argv, 0)), "clear") != 0){
+            clixon_err(OE_PLUGIN, EINVAL, "Unexpected argument: %s, expected: clear",
+                       cv_string_get(cvec_i(argv, 0)));
+            goto done;
+        }
+        clear++;
+    }
+    if (!_cli_timing_enable){
+        cligen_output(stdout, "CLI timing not enabled, see CLICON_CLI_TIMING\n");
+        goto ok;
+    }
+    i0 = _cli_timing_nr > CLI_TIMING_HISTORY ? _cli_timing_nr - CLI_TIMING_HISTORY : 0;
+    n = _cli_timing_nr - i0;
+    cligen_output(stdout, "%9s %9s %9s %5s %9s  %s\n",
+                  "match", "expand", "rpc", "rpcs", "print", "command");
+    for (i=i0; i<_cli_timing_nr; i++){
+        cte = &_cli_timing[i % CLI_TIMING_HISTORY];
+        v[0] = cte->cte_match;
+        v[1] = cte->cte_expand;
+        v[2] = cte->cte_rpc;
+        v[3] = cte->cte_print;
+        for (j=0; j<4; j++){
+            sum[j] += v[j];
+            if (v[j] > max[j])
+                max[j] = v[j];
+        }
+        rpcs += cte->cte_rpc_nr;
+        cligen_output(stdout, "%9.3f %9.3f %9.3f %5" PRIu64 " %9.3f  %s\n",
+                      v[0]/1000.0, v[1]/1000.0, v[2]/1000.0, cte->cte_rpc_nr, v[3]/1000.0,
+                      cte->cte_cmd);
+    }
+    if (n > 0){
+        cligen_output(stdout, "%9.3f %9.3f %9.3f %5.1f %9.3f  (average of %" PRIu64 ")\n",
+                      sum[0]/1000.0/n, sum[1]/1000.0/n, sum[2]/1000.0/n, (double)rpcs/n,
+                      sum[3]/1000.0/n, n);
+        cligen_output(stdout, "%9.3f %9.3f %9.3f %5s %9.3f  (max)\n",
+                      max[0]/1000.0, max[1]/1000.0, max[2]/1000.0, "", max[3]/1000.0);
+    }
+    if (clear)
+        cli_timing_exit();
+ ok:
+    retval = 0;
+ done:
+    return retval;
+}
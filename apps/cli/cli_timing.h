@@ -0,0 +1,68 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+ 
+  Copyright (C) 2009-2016 Olof Hagsand and Benny Holmgren
+  Copyright (C) 2017-2019 Olof Hagsand
+  Copyright (C) 2020-2022 Olof Hagsand and Rubicon Communications, LLC (Netgate)
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2, 
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+
+ * Timing of CLI commands, see CLICON_CLI_TIMING
+ */
+
+#ifndef _CLI_TIMING_H_
+#define _CLI_TIMING_H_
+
+/*
+ * Types
+ */
+/*! Timer of one CLI command
+ */
+struct cli_timer {
+    int      ct_on;         /* Timing enabled when started */
+    uint64_t ct_t0;         /* Start of current phase in microseconds */
+    uint64_t ct_match;      /* Match time in microseconds, including expand */
+    uint64_t ct_eval;       /* Callback time in microseconds, including rpcs */
+    uint64_t ct_rpc_nr;     /* Number of backend rpcs of callback */
+    uint64_t ct_rpc_usec;   /* Backend rpc time of callback in microseconds */
+};
+
+/*
+ * Prototypes
+ */
+void cli_timing_set(int enable);
+void cli_timing_start(struct cli_timer *ct);
+void cli_timing_match(struct cli_timer *ct);
+void cli_timing_eval(struct cli_timer *ct);
+int  cli_timing_add(struct cli_timer *ct, const char *cmd);
+void cli_timing_expand_add(uint64_t usec);
+uint64_t cli_timing_usec(void);
+void cli_timing_exit(void);
+
+#endif /* _CLI_TIMING_H_ */
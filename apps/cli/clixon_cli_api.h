@@ -66,6 +66,7 @@ void cli_signal_flush(clixon_handle h);
 int mtpoint_paths(clixon_handle h, yang_stmt *yspec0, const char *domain, const char *spec,
                   const char *api_path_fmt1, char **api_path_fmt01);
 int dbxml_body(cxobj *xbot, cvec *cvv);
+int cli_edit_batch_flush(clixon_handle h);
 int cli_dbxml(clixon_handle h, cvec *vars, cvec *argv, enum operation_type op, cvec *nsctx);
 int cli_set(clixon_handle h, cvec *vars, cvec *argv);
 int cli_merge(clixon_handle h, cvec *vars, cvec *argv);
@@ -82,6 +83,7 @@ int cli_start_shell(clixon_handle h, cvec *vars, cvec *argv);
 int cli_quit(clixon_handle h, cvec *vars, cvec *argv);
 int cli_commit(clixon_handle h, cvec *vars, cvec *argv);
 int cli_validate(clixon_handle h, cvec *vars, cvec *argv);
+int cli_edit_flush(clixon_handle h, cvec *vars, cvec *argv);
 int cli_update(clixon_handle h, cvec *vars, cvec *argv);
 int compare_db_names(clixon_handle h, enum format_enum format, char *db1, char *db2);
 int compare_dbs(clixon_handle h, cvec *vars, cvec *argv);
@@ -126,6 +128,8 @@ int cli_show_auto(clixon_handle h, cvec *cvv, cvec *argv);
 int cli_show_options(clixon_handle h, cvec *cvv, cvec *argv);
 int cli_show_version(clixon_handle h, cvec *vars, cvec *argv);
 int cli_show_sessions(clixon_handle h, cvec *cvv, cvec *argv);
+int cli_show_xpath_stats(clixon_handle h, cvec *cvv, cvec *argv);
+int cli_show_memory(clixon_handle h, cvec *cvv, cvec *argv);
 int cli_apipath(clixon_handle h, cvec *cvv, const char *domain, const char *spec,  const char *api_path_fmt, int *cvvi, char **api_path);
 int cli_show_config_info(clixon_handle h, cvec *cvv, cvec *argv);
 
@@ -142,6 +146,9 @@ int cli_auto_del(clixon_handle h, cvec *cvv, cvec *argv);
 int cli_auto_sub_enter(clixon_handle h, cvec *cvv, cvec *argv);
 int autocli_start(clixon_handle h);
 
+/* cli_timing.c: Timing of CLI commands */
+int cli_show_timing(clixon_handle h, cvec *cvv, cvec *argv);
+
 int cli_pagination(clixon_handle h, cvec *cvv, cvec *argv);
 
 #endif /* _CLIXON_CLI_API_H_ */
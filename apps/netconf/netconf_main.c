@@ -67,9 +67,10 @@
 #include <clixon/clixon.h>
 
 #include "netconf_rpc.h"
+#include "netconf_server.h"
 
 /* Command line options to be passed to getopt(3) */
-#define NETCONF_OPTS "hVD:f:E:l:C:q01ca:u:d:p:y:U:t:eo:"
+#define NETCONF_OPTS "hVD:f:E:l:C:q01ca:u:d:p:y:U:t:eSo:"
 
 #define NETCONF_LOGFILE "/tmp/clixon_netconf.log"
 
@@ -90,6 +91,8 @@ static int ignore_packet_errors = 1;
 /* Hello request received */
 static int _netconf_hello_nr = 0;
 
+static int netconf_reply_relay(clixon_handle h, cxobj *xrpc, netconf_framing_type framing);
+
 /*! Copy attributes from incoming request to reply. Skip already present (dont overwrite)
  *
  * RFC 6241 Section 4.1:
@@ -273,6 +276,10 @@ netconf_rpc_message(clixon_handle h,
             goto done;
         goto ok;
     }
+    if ((ret = netconf_reply_relay(h, xrpc, framing)) < 0)
+        goto done;
+    if (ret == 1)
+        goto ok;
     if (netconf_rpc_dispatch(h, xrpc, &xret, eof) < 0)
         goto done;
 
@@ -398,6 +405,506 @@ netconf_input_packet(clixon_handle h,
     return retval;
 }
 
+/*! Find end of tag, skipping quoted attribute values
+ *
+ * @param[in]  p    Pointer into tag after name
+ * @retval     e    Pointer to '>' ending the tag
+ * @retval     NULL No end found
+ */
+static char *
+passthrough_tag_end(char *p)
+{
+    char  q;
+
+    for (; *p != '\0' && *p != '>'; p++)
+        if (*p == '"' || *p == '\''){
+            q = *p;
+            if ((p = strchr(p+1, q)) == NULL)
+                return NULL;
+        }
+    return *p == '>' ? p : NULL;
+}
+
+/*! State of relaying a reply from the backend to the client
+ *
+ * @see netconf_reply_relay
+ */
+struct netconf_relay {
+    cxobj               *nr_xrpc;    /* Incoming rpc, its attributes are copied to the reply */
+    netconf_framing_type nr_framing; /* Framing to client */
+    cbuf                *nr_head;    /* Start of reply until end of its start tag */
+    int                  nr_body;    /* Start tag is written, rest of reply is written as is */
+};
+
+/*! Write part of a relayed reply to the client with the framing of the client
+ *
+ * @param[in]  framing Framing type
+ * @param[in]  data    Data
+ * @param[in]  len     Length of data
+ * @retval     0       OK
+ * @retval    -1       Error
+ */
+static int
+netconf_relay_write(netconf_framing_type framing,
+                    const char          *data,
+                    size_t               len)
+{
+    ssize_t n;
+
+    if (framing == NETCONF_SSH_CHUNKED)
+        return clixon_msg_send11_chunk(1, data, len, 0);
+    while (len > 0){
+        if ((n = write(1, data, len)) < 0){
+            if (errno == EINTR)
+                continue;
+            clixon_err(OE_UNIX, errno, "write");
+            return -1;
+        }
+        data += n;
+        len -= n;
+    }
+    return 0;
+}
+
+/*! Write start tag of relayed reply with attributes of the request added
+ *
+ * Attributes already present in the reply are not overwritten, see netconf_add_request_attr
+ * @param[in]  nr    Relay state
+ * @param[in]  p     Start tag of reply
+ * @param[in]  name  Qualified name of reply element
+ * @param[in]  nlen  Length of name
+ * @param[in]  e     Pointer to '>' ending start tag
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+static int
+netconf_relay_start(struct netconf_relay *nr,
+                    char                 *p,
+                    char                 *name,
+                    size_t                nlen,
+                    char                 *e)
+{
+    int    retval = -1;
+    cbuf  *cb = NULL;
+    cxobj *xt = NULL;
+    cxobj *xrep;
+    cxobj *xa;
+    int    empty = e[-1] == '/';
+    int    i;
+    int    n0;
+
+    if ((cb = cbuf_new()) == NULL){
+        clixon_err(OE_XML, errno, "cbuf_new");
+        goto done;
+    }
+    if (empty)
+        cprintf(cb, "%.*s", (int)(e + 1 - p), p);
+    else
+        cprintf(cb, "%.*s</%.*s>", (int)(e + 1 - p), p, (int)nlen, name);
+    if (clixon_xml_parse_string(cbuf_get(cb), YB_NONE, NULL, &xt, NULL) < 0)
+        goto done;
+    if ((xrep = xml_child_i_type(xt, 0, CX_ELMNT)) == NULL){
+        clixon_err(OE_XML, EINVAL, "Reply without element");
+        goto done;
+    }
+    n0 = xml_child_nr_type(xrep, CX_ATTR);
+    if (netconf_add_request_attr(nr->nr_xrpc, xrep) < 0)
+        goto done;
+    /* Original start tag followed by added attributes */
+    cbuf_reset(cb);
+    cprintf(cb, "%.*s", (int)(e - empty - p), p);
+    xa = NULL;
+    i = 0;
+    while ((xa = xml_child_each(xrep, xa, CX_ATTR)) != NULL){
+        if (i++ < n0)
+            continue;
+        if (xml_prefix(xa))
+            cprintf(cb, " %s:%s=\"", xml_prefix(xa), xml_name(xa));
+        else
+            cprintf(cb, " %s=\"", xml_name(xa));
+        if (xml_chardata_cbuf_append(cb, 1, xml_value(xa)) < 0)
+            goto done;
+        cprintf(cb, "\"");
+    }
+    cprintf(cb, "%s", empty ? "/>" : ">");
+    if (netconf_relay_write(nr->nr_framing, cbuf_get(cb), cbuf_len(cb)) < 0)
+        goto done;
+    retval = 0;
+ done:
+    if (cb)
+        cbuf_free(cb);
+    if (xt)
+        xml_free(xt);
+    return retval;
+}
+
+/*! Relay a span of reply data from the backend to the client
+ *
+ * Data is buffered until the start tag of the reply is complete, thereafter written as is
+ * @param[in]  arg   Relay state
+ * @param[in]  data  Reply data
+ * @param[in]  len   Length of data
+ * @retval     0     OK
+ * @retval    -1     Error
+ * @see clixon_msg_relay_cb
+ */
+static int
+netconf_relay_cb(void       *arg,
+                 const char *data,
+                 size_t      len)
+{
+    int                   retval = -1;
+    struct netconf_relay *nr = (struct netconf_relay *)arg;
+    char                 *str;
+    char                 *p;
+    char                 *name;
+    size_t                nlen;
+    char                 *e;
+
+    if (nr->nr_body)
+        return netconf_relay_write(nr->nr_framing, data, len);
+    if (cbuf_append_buf(nr->nr_head, (void*)data, len) < 0){
+        clixon_err(OE_UNIX, errno, "cbuf_append_buf");
+        goto done;
+    }
+    str = cbuf_get(nr->nr_head);
+    p = str + strspn(str, " \t\r\n");
+    if (strncmp(p, "<?xml", 5) == 0){
+        if ((p = strstr(p, "?>")) == NULL)
+            goto ok; /* Wait for more data */
+        p += 2;
+        p += strspn(p, " \t\r\n");
+    }
+    if (*p == '\0')
+        goto ok;
+    if (*p != '<'){
+        clixon_err(OE_XML, EINVAL, "Reply does not start with an element");
+        goto done;
+    }
+    name = p + 1;
+    nlen = strcspn(name, " \t\r\n/>");
+    if ((e = passthrough_tag_end(name + nlen)) == NULL)
+        goto ok;
+    if (netconf_relay_start(nr, p, name, nlen, e) < 0)
+        goto done;
+    nr->nr_body = 1;
+    e++;
+    if (netconf_relay_write(nr->nr_framing, e, cbuf_len(nr->nr_head) - (e - str)) < 0)
+        goto done;
+    cbuf_reset(nr->nr_head);
+ ok:
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Relay the reply of a get or get-config from the backend to the client as it arrives
+ *
+ * Only requests whose reply is not processed by the netconf client are relayed, ie get
+ * and get-config with an xpath filter or no filter. Other requests are processed as usual.
+ * The start tag of the reply gets the attributes of the request, the rest is written to
+ * the client as it is read from the backend, re-framed with the framing of the client.
+ * The reply is not reassembled or bound to YANG.
+ * @param[in]  h       Clixon handle
+ * @param[in]  xrpc    Incoming rpc
+ * @param[in]  framing Framing type
+ * @retval     1       Relayed
+ * @retval     0       Not relayed, process rpc as usual
+ * @retval    -1       Error
+ * @see CLICON_NETCONF_REPLY_RELAY
+ */
+static int
+netconf_reply_relay(clixon_handle        h,
+                    cxobj               *xrpc,
+                    netconf_framing_type framing)
+{
+    int                  retval = -1;
+    cxobj               *xe;
+    cxobj               *xfilter;
+    char                *ftype;
+    char                *ns = NULL;
+    char                *username;
+    cxobj               *xa = NULL;
+    cbuf                *cb = NULL;
+    struct netconf_relay nr = {0,};
+
+    if (!clicon_option_bool(h, "CLICON_NETCONF_REPLY_RELAY") ||
+        clicon_option_bool(h, "CLICON_SOCK_BINARY")) /* Binary replies are decoded */
+        goto fail;
+    if (xml_child_nr_type(xrpc, CX_ELMNT) != 1 ||
+        (xe = xml_child_i_type(xrpc, 0, CX_ELMNT)) == NULL)
+        goto fail;
+    if (strcmp(xml_name(xe), "get") != 0 &&
+        strcmp(xml_name(xe), "get-config") != 0)
+        goto fail;
+    if (xml2ns(xe, xml_prefix(xe), &ns) < 0)
+        goto done;
+    if (ns == NULL || strcmp(ns, NETCONF_BASE_NAMESPACE) != 0)
+        goto fail;
+    if ((xfilter = xml_find_type(xe, NULL, "filter", CX_ELMNT)) != NULL &&
+        ((ftype = xml_find_value(xfilter, "type")) == NULL ||
+         strcmp(ftype, "xpath") != 0))
+        goto fail;
+    /* Tag username, see netconf_rpc_dispatch */
+    if ((username = clicon_username_get(h)) != NULL &&
+        (xa = xml_add_attr(xrpc, "username", username, CLIXON_LIB_PREFIX, CLIXON_LIB_NS)) == NULL)
+        goto done;
+    if ((cb = cbuf_new()) == NULL ||
+        (nr.nr_head = cbuf_new()) == NULL){
+        clixon_err(OE_XML, errno, "cbuf_new");
+        goto done;
+    }
+    if (clixon_xml2cbuf1(cb, xrpc, 0, 0, NULL, -1, 0, 0, WITHDEFAULTS_REPORT_ALL) < 0)
+        goto done;
+    nr.nr_xrpc = xrpc;
+    nr.nr_framing = framing;
+    clixon_debug(CLIXON_DBG_NETCONF, "relay %s reply", xml_name(xe));
+    if (clicon_rpc_netconf_relay(h, cbuf_get(cb), netconf_relay_cb, &nr) < 0)
+        goto done;
+    if (nr.nr_body == 0){
+        clixon_err(OE_XML, EINVAL, "Truncated reply");
+        goto done;
+    }
+    /* End of message */
+    if (framing == NETCONF_SSH_CHUNKED){
+        if (clixon_msg_send11_chunk(1, NULL, 0, 1) < 0)
+            goto done;
+    }
+    else if (netconf_relay_write(framing, "]]>]]>", strlen("]]>]]>")) < 0)
+        goto done;
+    retval = 1;
+ done:
+    /* Username attribute not returned to sender */
+    if (xa)
+        xml_purge(xa);
+    if (cb)
+        cbuf_free(cb);
+    if (nr.nr_head)
+        cbuf_free(nr.nr_head);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! Check that message is a single edit-config that can be passed through as is
+ *
+ * Scan tags without building a tree. Comments, CDATA and processing instructions are skipped.
+ * @param[in]  body  Message after rpc start tag
+ * @param[in]  name  Qualified name of rpc element
+ * @param[in]  nlen  Length of name
+ * @retval     1     Yes, a single edit-config without test-option or error-option
+ * @retval     0     No
+ */
+static int
+passthrough_edit_config(char  *body,
+                        char  *name,
+                        size_t nlen)
+{
+    char  *p = body;
+    char  *t;
+    char  *e;
+    char  *lp;
+    size_t tlen;
+    size_t llen;
+    size_t plen = nlen - strlen("rpc"); /* including ':' */
+    int    depth = 0;
+    int    nelem = 0;
+
+    while ((p = strchr(p, '<')) != NULL){
+        if (strncmp(p, "<!--", 4) == 0){
+            if ((p = strstr(p+4, "-->")) == NULL)
+                return 0;
+            continue;
+        }
+        if (strncmp(p, "<![CDATA[", 9) == 0){
+            if ((p = strstr(p+9, "]]>")) == NULL)
+                return 0;
+            continue;
+        }
+        if (p[1] == '?'){
+            if ((p = strstr(p+2, "?>")) == NULL)
+                return 0;
+            continue;
+        }
+        if (p[1] == '/'){
+            if (depth == 0)
+                break;
+            depth--;
+            p += 2;
+            continue;
+        }
+        t = p + 1;
+        tlen = strcspn(t, " \t\r\n/>");
+        if ((e = passthrough_tag_end(t + tlen)) == NULL)
+            return 0;
+        if (depth == 0){ /* Single edit-config with rpc prefix and no namespace declarations */
+            if (nelem++ > 0 ||
+                tlen != plen + strlen("edit-config") ||
+                strncmp(t, name, plen) != 0 ||
+                strncmp(t + plen, "edit-config", strlen("edit-config")) != 0 ||
+                e[-1] == '/')
+                return 0;
+            for (lp = t + tlen; lp < e; lp++)
+                if (strncmp(lp, "xmlns", 5) == 0)
+                    return 0;
+        }
+        else if (depth == 1){ /* Options not supported by backend */
+            if ((lp = memchr(t, ':', tlen)) != NULL)
+                lp++;
+            else
+                lp = t;
+            llen = tlen - (lp - t);
+            if ((llen == strlen("test-option") && strncmp(lp, "test-option", llen) == 0) ||
+                (llen == strlen("error-option") && strncmp(lp, "error-option", llen) == 0))
+                return 0;
+        }
+        if (e[-1] != '/')
+            depth++;
+        p = e + 1;
+    }
+    if (p == NULL || nelem == 0)
+        return 0;
+    /* End of rpc, followed by whitespace only */
+    p += 2;
+    if (strncmp(p, name, nlen) != 0)
+        return 0;
+    p += nlen;
+    p += strspn(p, " \t\r\n");
+    if (*p++ != '>')
+        return 0;
+    p += strspn(p, " \t\r\n");
+    return *p == '\0';
+}
+
+/*! Pass a large edit-config message through to the backend without parsing it
+ *
+ * Only the rpc start tag is parsed, to check its namespace, tag it with the username and
+ * copy its attributes to the reply. The rest of the message is sent to the backend as is,
+ * where it is parsed and validated.
+ * @param[in]  h       Clixon handle
+ * @param[in]  cbmsg   Complete incoming message
+ * @param[in]  framing Framing type
+ * @retval     1       Handled
+ * @retval     0       Not handled, process message as usual
+ * @retval    -1       Error
+ * @see CLICON_NETCONF_PASSTHROUGH_MIN
+ */
+static int
+netconf_input_passthrough(clixon_handle        h,
+                          cbuf                *cbmsg,
+                          netconf_framing_type framing)
+{
+    int    retval = -1;
+    char  *str = cbuf_get(cbmsg);
+    char  *p;
+    char  *name;
+    size_t nlen;
+    char  *e;
+    char  *body;
+    char  *username;
+    char  *ns = NULL;
+    cbuf  *cb = NULL;
+    cbuf  *cbret = NULL;
+    cxobj *xt = NULL;
+    cxobj *xrpc;
+    cxobj *xa;
+    cxobj *xret = NULL;
+    cxobj *xc;
+
+    if (_netconf_hello_nr == 0 &&
+        clicon_option_bool(h, "CLICON_NETCONF_HELLO_OPTIONAL") == 0)
+        goto fail;
+    p = str + strspn(str, " \t\r\n");
+    if (strncmp(p, "<?xml", 5) == 0){
+        if ((p = strstr(p, "?>")) == NULL)
+            goto fail;
+        p += 2;
+        p += strspn(p, " \t\r\n");
+    }
+    if (*p != '<')
+        goto fail;
+    name = p + 1;
+    nlen = strcspn(name, " \t\r\n/>");
+    if (nlen < 3 || strncmp(name + nlen - 3, "rpc", 3) != 0 ||
+        (nlen > 3 && name[nlen - 4] != ':'))
+        goto fail;
+    if ((e = passthrough_tag_end(name + nlen)) == NULL || e[-1] == '/')
+        goto fail;
+    body = e + 1;
+    if (passthrough_edit_config(body, name, nlen) == 0)
+        goto fail;
+    /* Parse rpc start tag only */
+    if ((cb = cbuf_new()) == NULL){
+        clixon_err(OE_XML, errno, "cbuf_new");
+        goto done;
+    }
+    cprintf(cb, "%.*s</%.*s>", (int)(body - p), p, (int)nlen, name);
+    if (clixon_xml_parse_string(cbuf_get(cb), YB_NONE, NULL, &xt, NULL) < 0){
+        clixon_err_reset();
+        goto fail;
+    }
+    if ((xrpc = xml_child_i_type(xt, 0, CX_ELMNT)) == NULL)
+        goto fail;
+    if (xml2ns(xrpc, xml_prefix(xrpc), &ns) < 0)
+        goto done;
+    if (ns == NULL || strcmp(ns, NETCONF_BASE_NAMESPACE) != 0)
+        goto fail;
+    xa = NULL;
+    while ((xa = xml_child_each(xrpc, xa, CX_ATTR)) != NULL){
+        if (strcmp(xml_name(xa), "username") == 0 ||
+            strcmp(xml_name(xa), CLIXON_LIB_PREFIX) == 0 ||
+            (xml_prefix(xa) && strcmp(xml_prefix(xa), CLIXON_LIB_PREFIX) == 0))
+            goto fail;
+    }
+    clixon_debug(CLIXON_DBG_NETCONF, "pass through %lu bytes", cbuf_len(cbmsg));
+    /* Tag username, see netconf_rpc_dispatch */
+    cbuf_reset(cb);
+    cprintf(cb, "%.*s", (int)(e - p), p);
+    if ((username = clicon_username_get(h)) != NULL){
+        cprintf(cb, " xmlns:%s=\"%s\" %s:username=\"",
+                CLIXON_LIB_PREFIX, CLIXON_LIB_NS, CLIXON_LIB_PREFIX);
+        if (xml_chardata_cbuf_append(cb, 1, username) < 0)
+            goto done;
+        cprintf(cb, "\"");
+    }
+    cprintf(cb, ">");
+    if (clicon_rpc_netconf_split(h, cbuf_get(cb), body, cbuf_len(cbmsg) - (body - str), &xret) < 0)
+        goto done;
+    if ((cbret = cbuf_new()) == NULL){
+        clixon_err(OE_XML, errno, "cbuf_new");
+        goto done;
+    }
+    if ((xc = xml_child_i(xret, 0)) == NULL){
+        if (netconf_operation_failed_xml(&xret, "rpc", "Internal error: no xml return")< 0)
+            goto done;
+        xc = xret;
+    }
+    /* Copy attributes from incoming request to reply. Skip already present (dont overwrite) */
+    if (netconf_add_request_attr(xrpc, xc) < 0)
+        goto done;
+    if (clixon_xml2cbuf(cbret, xc, 0, 0, NULL, -1, 0) < 0)
+        goto done;
+    if (netconf_output_encap(framing, cbret) < 0)
+        goto done;
+    if (netconf_output(1, cbret, "rpc-reply") < 0)
+        goto done;
+    retval = 1;
+ done:
+    if (cb)
+        cbuf_free(cb);
+    if (cbret)
+        cbuf_free(cbret);
+    if (xt)
+        xml_free(xt);
+    if (xret)
+        xml_free(xret);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
 /*! Get netconf message: detect end-of-msg
  *
  * @param[in]  s    Socket where input arrived. read from this.
@@ -427,6 +934,7 @@ netconf_input_cb(int   s,
     int            frame_state;
     size_t         frame_size;
     int            i32;
+    size_t         passmin;
     int            eom = 0;
     int            eof = 0;
     netconf_framing_type framing_type;
@@ -463,6 +971,10 @@ netconf_input_cb(int   s,
         frame_size = 0;
     else
         frame_size = i32;
+    if ((i32 = clicon_option_int(h, "CLICON_NETCONF_PASSTHROUGH_MIN")) < 0)
+        passmin = 0;
+    else
+        passmin = i32;
     /* Read input data from socket and append to cbuf */
     if ((len = netconf_input_read2(s, buf, buflen, &eof)) < 0)
         goto done;
@@ -489,6 +1001,14 @@ netconf_input_cb(int   s,
             clixon_debug(CLIXON_DBG_MSG | CLIXON_DBG_DETAIL, "Recv ext: %s", cbuf_get(cbmsg));
         else
             clixon_debug(CLIXON_DBG_MSG, "Recv ext len: %lu", cbuf_len(cbmsg));
+        if (passmin > 0 && cbuf_len(cbmsg) >= passmin){
+            if ((ret = netconf_input_passthrough(h, cbmsg, framing_type)) < 0)
+                goto done;
+            if (ret == 1){
+                cbuf_reset(cbmsg);
+                continue;
+            }
+        }
         if ((ret = netconf_input_frame2(cbmsg, YB_RPC, yspec, &xtop, &xerr)) < 0)
             goto done;
         cbuf_reset(cbmsg);
@@ -601,8 +1121,12 @@ netconf_terminate(clixon_handle h)
     if ((x = clicon_conf_xml(h)) != NULL)
         xml_free(x);
     xpath_optimize_exit();
+    xpath_parse_cache_exit();
+    api_path_cache_exit();
+    regex_cache_exit();
     clixon_event_exit();
     clixon_handle_exit(h);
+    xml_exit();
     clixon_debug_exit();
     clixon_err_exit();
     clixon_log_exit();
@@ -662,6 +1186,7 @@ usage(clixon_handle h,
             "\t-U <user>\tOver-ride unix user with a pseudo user for NACM.\n"
             "\t-t <sec>\tTimeout in seconds. Quit after this time.\n"
             "\t-e \t\tDont ignore errors on packet input.\n"
+            "\t-S \t\tRun as shared netconf server on CLICON_NETCONF_SERVER_SOCK\n"
             "\t-o \"<option>=<value>\"\tGive configuration option overriding config file (see clixon-config.yang)\n",
             argv0,
             clicon_netconf_dir(h)
@@ -698,6 +1223,9 @@ main(int    argc,
     enum format_enum config_dump_format = FORMAT_XML;
     int              print_version = 0;
     int32_t          d;
+    int              server = 0;
+    char            *sockpath;
+    int              ret;
 
     /* Create handle */
     if ((h = clixon_handle_init()) == NULL)
@@ -829,6 +1357,9 @@ main(int    argc,
         case 'e': /* dont ignore packet errors */
             ignore_packet_errors = 0;
             break;
+        case 'S': /* shared netconf server */
+            server++;
+            break;
         case '0': /* Force EOM */
             clicon_option_int_set(h, "CLICON_NETCONF_BASE_CAPABILITY", 0);
             clicon_option_bool_set(h, "CLICON_NETCONF_HELLO_OPTIONAL", 1);
@@ -867,6 +1398,14 @@ main(int    argc,
     if ((sz = clicon_option_int(h, "CLICON_LOG_STRING_LIMIT")) != 0)
         clixon_log_string_limit_set(sz);
 
+    /* Hand over session to shared netconf server if running, before loading plugins and yang */
+    sockpath = clicon_option_str(h, "CLICON_NETCONF_SERVER_SOCK");
+    if (!server && !config_dump && !print_version && sockpath != NULL){
+        if ((ret = netconf_server_handoff(h, sockpath)) < 0)
+            goto done;
+        if (ret == 1)
+            goto ok;
+    }
     /* Init event handler */
     clixon_event_init(h);
 
@@ -977,6 +1516,18 @@ main(int    argc,
     /* Debug dump of config options */
     clicon_option_dump(h, CLIXON_DBG_INIT);
 
+    /* Shared netconf server: only forked session processes continue */
+    if (server){
+        if (sockpath == NULL){
+            clixon_err(OE_CFG, 0, "CLICON_NETCONF_SERVER_SOCK not set");
+            goto done;
+        }
+        if ((ret = netconf_server(h, sockpath)) < 0)
+            goto done;
+        if (ret == 0)
+            goto ok;
+    }
+
     /* Send hello request to backend to get session-id back
      * This is done once at the beginning of the session and then this is
      * used by the client, even though new TCP sessions are created for
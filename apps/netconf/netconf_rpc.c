@@ -48,6 +48,7 @@
 
 #include <stdio.h>
 #include <string.h>
+#include <ctype.h>
 #include <unistd.h>
 #include <stdlib.h>
 #include <errno.h>
@@ -105,6 +106,264 @@ netconf_get_config_subtree(clixon_handle h,
     return retval;
 }
 
+/*! Get yang node and xpath prefix of a subtree filter element
+ *
+ * Prefixes nf0, nf1,.. are allocated in order of first use
+ * @param[in]  xf      Filter element
+ * @param[in]  yp      Yang node of parent filter element, or NULL if top-level
+ * @param[in]  yspec   Yang spec
+ * @param[in]  nsc     Namespace context of xpath
+ * @param[out] prefix  Prefix
+ * @param[out] yf      Yang node of xf, or NULL if not found
+ * @retval     0       OK
+ * @retval    -1       Error
+ */
+static int
+netconf_filter_yang(cxobj      *xf,
+                    yang_stmt  *yp,
+                    yang_stmt  *yspec,
+                    cvec       *nsc,
+                    char      **prefix,
+                    yang_stmt **yf)
+{
+    int        retval = -1;
+    char      *ns = NULL;
+    yang_stmt *ymod;
+    char       pfx[16];
+
+    *yf = NULL;
+    if (xml2ns(xf, xml_prefix(xf), &ns) < 0)
+        goto done;
+    if (ns == NULL)
+        goto ok;
+    if (yp == NULL){
+        if ((ymod = yang_find_module_by_namespace(yspec, ns)) == NULL)
+            goto ok;
+        *yf = yang_find_datanode(ymod, xml_name(xf));
+    }
+    else
+        *yf = yang_find_datanode_ns(yp, xml_name(xf), ns);
+    if (*yf == NULL)
+        goto ok;
+    if (xml_nsctx_get_prefix(nsc, ns, prefix) == 0){
+        snprintf(pfx, sizeof(pfx), "nf%d", cvec_len(nsc));
+        if (xml_nsctx_add(nsc, pfx, ns) < 0)
+            goto done;
+        if (xml_nsctx_get_prefix(nsc, ns, prefix) == 0)
+            goto done;
+    }
+ ok:
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Check if a subtree filter element is a content match node, ie a leaf with a value
+ *
+ * @param[in]  xf     Filter element
+ * @param[in]  yf     Yang node of xf
+ * @param[out] quote  Quote character of value in xpath
+ * @retval     1      Content match node
+ * @retval     0      Not content match node, or value cannot be quoted in xpath
+ */
+static int
+netconf_filter_content_match(cxobj     *xf,
+                             yang_stmt *yf,
+                             char      *quote)
+{
+    char *body;
+    char *p;
+
+    if (yang_keyword_get(yf) != Y_LEAF && yang_keyword_get(yf) != Y_LEAF_LIST)
+        return 0;
+    if (xml_child_nr_type(xf, CX_ELMNT) != 0)
+        return 0;
+    if ((body = xml_body(xf)) == NULL)
+        return 0;
+    for (p = body; *p != '\0' && isspace((unsigned char)*p); p++);
+    if (*p == '\0')
+        return 0;
+    if (strchr(body, '\'') == NULL)
+        *quote = '\'';
+    else if (strchr(body, '"') == NULL)
+        *quote = '"';
+    else
+        return 0;
+    return 1;
+}
+
+/*! Translate a subtree filter element to xpath location paths of selected nodes
+ *
+ * Content match nodes are translated to predicates, so that eg
+ * <interfaces><interface><name>eth0</name></interface></interfaces> selects
+ * /interfaces/interface[name='eth0'].
+ * Containers are descended into, list entries are selected as a whole.
+ * The paths select a superset of the subtree filter, eg attribute match expressions are
+ * not translated, and a step is not descended into if a child is not found in yang.
+ * @param[in]  xf      Filter element
+ * @param[in]  yp      Yang node of parent of xf, or NULL if top-level
+ * @param[in]  yspec   Yang spec
+ * @param[in]  nsc     Namespace context of xpath
+ * @param[in]  path    Location path of parent of xf
+ * @param[out] cb      Union of location paths
+ * @retval     1       OK
+ * @retval     0       xf not found in yang, no path added
+ * @retval    -1       Error
+ */
+static int
+netconf_filter2xpath(cxobj      *xf,
+                     yang_stmt  *yp,
+                     yang_stmt  *yspec,
+                     cvec       *nsc,
+                     const char *path,
+                     cbuf       *cb)
+{
+    int        retval = -1;
+    cbuf      *cbstep = NULL;
+    cxobj     *xc;
+    yang_stmt *yf;
+    yang_stmt *yc;
+    char      *prefix;
+    char      *cprefix;
+    char       quote;
+    int        descend = 0;
+
+    if (netconf_filter_yang(xf, yp, yspec, nsc, &prefix, &yf) < 0)
+        goto done;
+    if (yf == NULL)
+        goto fail;
+    if ((cbstep = cbuf_new()) == NULL){
+        clixon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    cprintf(cbstep, "%s/%s:%s", path, prefix, xml_name(xf));
+    /* Content match nodes as predicates, and check if any child to descend into */
+    xc = NULL;
+    while ((xc = xml_child_each(xf, xc, CX_ELMNT)) != NULL) {
+        if (netconf_filter_yang(xc, yf, yspec, nsc, &cprefix, &yc) < 0)
+            goto done;
+        if (yc == NULL)
+            break;
+        if (netconf_filter_content_match(xc, yc, &quote))
+            cprintf(cbstep, "[%s:%s=%c%s%c]", cprefix, xml_name(xc), quote, xml_body(xc), quote);
+        else
+            descend++;
+    }
+    if (xc != NULL || descend == 0 || yang_keyword_get(yf) == Y_LIST){
+        /* Select whole subtree */
+        cprintf(cb, "%s%s", cbuf_len(cb)?" | ":"", cbuf_get(cbstep));
+        goto ok;
+    }
+    xc = NULL;
+    while ((xc = xml_child_each(xf, xc, CX_ELMNT)) != NULL) {
+        if (netconf_filter_yang(xc, yf, yspec, nsc, &cprefix, &yc) < 0)
+            goto done;
+        if (netconf_filter_content_match(xc, yc, &quote))
+            cprintf(cb, "%s%s/%s:%s", cbuf_len(cb)?" | ":"", cbuf_get(cbstep), cprefix, xml_name(xc));
+        else if (netconf_filter2xpath(xc, yf, yspec, nsc, cbuf_get(cbstep), cb) < 0)
+            goto done;
+    }
+ ok:
+    retval = 1;
+ done:
+    if (cbstep)
+        cbuf_free(cbstep);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! Push down a subtree filter to the backend as an equivalent xpath filter
+ *
+ * The subtree filter is translated to a union of location paths with content match nodes
+ * as predicates, eg list keys, so that the backend only reads and sends the selected data
+ * instead of the complete datastore.
+ * The xpath selects a superset of the subtree filter, which is still applied on the reply.
+ * Only done if all top-level elements are found in yang
+ * @param[in]  h       Clixon handle
+ * @param[in]  xn      Sub-tree (under xorig) at <rpc>...</rpc> level.
+ * @param[in]  xfilter Subtree filter of xn
+ * @param[out] xrpcp   Copy of rpc with xpath filter, or NULL if not pushed down. Free with xml_free
+ * @retval     0       OK
+ * @retval    -1       Error
+ * @see netconf_filter2xpath
+ */
+static int
+netconf_filter_pushdown(clixon_handle h,
+                        cxobj        *xn,
+                        cxobj        *xfilter,
+                        cxobj       **xrpcp)
+{
+    int        retval = -1;
+    yang_stmt *yspec;
+    cxobj     *xc;
+    cxobj     *xrpc = NULL;
+    cxobj     *xf;
+    cxobj     *xa;
+    cbuf      *cb = NULL;
+    cvec      *nsc = NULL;
+    cg_var    *cv;
+    char      *select = NULL;
+    int        ret;
+
+    *xrpcp = NULL;
+    if ((yspec = clicon_dbspec_yang(h)) == NULL)
+        goto ok;
+    if ((cb = cbuf_new()) == NULL){
+        clixon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    if ((nsc = xml_nsctx_init(NULL, NULL)) == NULL)
+        goto done;
+    xc = NULL;
+    while ((xc = xml_child_each(xfilter, xc, CX_ELMNT)) != NULL) {
+        if ((ret = netconf_filter2xpath(xc, NULL, yspec, nsc, "", cb)) < 0)
+            goto done;
+        if (ret == 0)
+            goto ok;
+    }
+    if (cbuf_len(cb) == 0)
+        goto ok;
+    clixon_debug(CLIXON_DBG_NETCONF | CLIXON_DBG_DETAIL, "subtree filter as xpath: %s", cbuf_get(cb));
+    if ((xrpc = xml_dup(xml_parent(xn))) == NULL)
+        goto done;
+    if ((xf = xml_find_type(xrpc, NULL, xml_name(xn), CX_ELMNT)) == NULL ||
+        (xf = xml_find_type(xf, NULL, xml_name(xfilter), CX_ELMNT)) == NULL)
+        goto ok;
+    while ((xc = xml_child_i_type(xf, 0, CX_ELMNT)) != NULL)
+        if (xml_purge(xc) < 0)
+            goto done;
+    if ((xa = xml_find_type(xf, NULL, "type", CX_ATTR)) != NULL &&
+        xml_purge(xa) < 0)
+        goto done;
+    if (xml_add_attr(xf, "type", "xpath", NULL, NULL) == NULL)
+        goto done;
+    /* Attribute values are sent as is, the backend decodes select */
+    if (xml_chardata_encode(&select, 1, "%s", cbuf_get(cb)) < 0)
+        goto done;
+    if (xml_add_attr(xf, "select", select, NULL, NULL) == NULL)
+        goto done;
+    cv = NULL;
+    while ((cv = cvec_each(nsc, cv)) != NULL)
+        if (xmlns_set(xf, cv_name_get(cv), cv_string_get(cv)) < 0)
+            goto done;
+    *xrpcp = xrpc;
+    xrpc = NULL;
+ ok:
+    retval = 0;
+ done:
+    if (select)
+        free(select);
+    if (nsc)
+        xml_nsctx_free(nsc);
+    if (xrpc)
+        xml_free(xrpc);
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+}
+
 /*! Get configuration
  *
  * @param[in]  h       Clixon handle
@@ -163,6 +422,7 @@ netconf_get_config(clixon_handle h,
 {
     int        retval = -1;
     cxobj     *xfilter; /* filter */
+    cxobj     *xrpc = NULL;
     char      *ftype = NULL;
     cvec      *nsc = NULL;
     char      *prefix = NULL;
@@ -179,9 +439,10 @@ netconf_get_config(clixon_handle h,
     if ((xfilter = xpath_first(xn, nsc, "%s%sfilter", prefix ? prefix : "", prefix ? ":" : "")) != NULL)
         ftype = xml_find_value(xfilter, "type");
     if (xfilter == NULL || ftype == NULL || strcmp(ftype, "subtree") == 0) {
-        /* Get whole config first, then filter. This is suboptimal
-         */
-        if (clicon_rpc_netconf_xml(h, xml_parent(xn), xret, NULL) < 0)
+        /* Get selected top-level sub-trees, or whole config, then filter */
+        if (xfilter && netconf_filter_pushdown(h, xn, xfilter, &xrpc) < 0)
+            goto done;
+        if (clicon_rpc_netconf_xml(h, xrpc?xrpc:xml_parent(xn), xret, NULL) < 0)
             goto done;
         /* Now filter on whole tree */
         if (netconf_get_config_subtree(h, xfilter, xret) < 0)
@@ -202,6 +463,8 @@ netconf_get_config(clixon_handle h,
     }
     retval = 0;
  done:
+    if (xrpc)
+        xml_free(xrpc);
     if (nsc)
         cvec_free(nsc);
     return retval;
@@ -376,6 +639,7 @@ netconf_get(clixon_handle h,
 {
     int        retval = -1;
     cxobj     *xfilter; /* filter */
+    cxobj     *xrpc = NULL;
     char      *ftype = NULL;
     cvec      *nsc = NULL;
     char      *prefix = NULL;
@@ -392,9 +656,10 @@ netconf_get(clixon_handle h,
     if ((xfilter = xpath_first(xn, nsc, "%s%sfilter", prefix ? prefix : "", prefix ? ":" : "")) != NULL)
         ftype = xml_find_value(xfilter, "type");
     if (xfilter == NULL || ftype == NULL || strcmp(ftype, "subtree") == 0) {
-        /* Get whole config + state first, then filter. This is suboptimal
-         */
-        if (clicon_rpc_netconf_xml(h, xml_parent(xn), xret, NULL) < 0)
+        /* Get selected top-level sub-trees, or whole config + state, then filter */
+        if (xfilter && netconf_filter_pushdown(h, xn, xfilter, &xrpc) < 0)
+            goto done;
+        if (clicon_rpc_netconf_xml(h, xrpc?xrpc:xml_parent(xn), xret, NULL) < 0)
             goto done;
         /* Now filter on whole tree */
         if (netconf_get_config_subtree(h, xfilter, xret) < 0)
@@ -414,6 +679,8 @@ netconf_get(clixon_handle h,
     }
     retval = 0;
  done:
+    if (xrpc)
+        xml_free(xrpc);
     if(nsc)
         cvec_free(nsc);
     return retval;
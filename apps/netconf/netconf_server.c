@@ -0,0 +1,449 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+ 
+  Copyright (C) 2009-2016 Olof Hagsand and Benny Holmgren
+  Copyright (C) 2017-2019 Olof Hagsand
+  Copyright (C) 2020-2022 Olof Hagsand and Rubicon Communications, LLC (Netgate)
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2, 
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+
+ *
+ * Shared netconf server
+ * Instead of each clixon_netconf session loading config, plugins and YANG, and
+ * connecting to the backend before it can send hello, a long-running clixon_netconf -S
+ * does the loading once and listens on the unix socket CLICON_NETCONF_SERVER_SOCK.
+ * A clixon_netconf started per session (eg as ssh subsystem) connects to the socket and
+ * passes its stdin and stdout with SCM_RIGHTS. The server forks a session process which
+ * continues as a regular netconf session on the passed file descriptors. The session
+ * process keeps the connection open until it terminates, which the handing-off process
+ * waits for before it exits.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "clixon_config.h" /* generated by config & autoconf */
+#endif
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <errno.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <syslog.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#define __USE_GNU   /* for ucred */
+#define _GNU_SOURCE /* for ucred */
+#include <sys/socket.h>
+#include <sys/un.h>
+
+/* cligen */
+#include <cligen/cligen.h>
+
+/* clixon */
+#include <clixon/clixon.h>
+
+#include "netconf_server.h"
+
+/* Max length of user name passed in handoff message */
+#define NETCONF_SERVER_USERMAX 256
+
+/*! Set on SIGTERM/SIGINT in the server process
+ */
+static void
+netconf_server_sig_term(int arg)
+{
+    clixon_exit_set(1);
+}
+
+/*! Pass stdin and stdout of this process to the netconf server
+ *
+ * The message consists of the user name and the two file descriptors.
+ * @param[in]  s         Connected unix socket
+ * @param[in]  username  User name, or NULL
+ * @retval     0         OK
+ * @retval    -1         Error
+ */
+static int
+netconf_server_send_fds(int         s,
+                        const char *username)
+{
+    int             retval = -1;
+    struct msghdr   msg = {0};
+    struct cmsghdr *cmsg;
+    struct iovec    iov;
+    int             fds[2] = {0, 1};
+    char            buf[CMSG_SPACE(sizeof(fds))];
+    char            nul = '\0';
+
+    memset(buf, 0, sizeof(buf));
+    /* At least one byte of data must be sent along with the descriptors */
+    if (username != NULL){
+        iov.iov_base = (void*)username;
+        iov.iov_len = strlen(username) + 1;
+    }
+    else {
+        iov.iov_base = &nul;
+        iov.iov_len = 1;
+    }
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = buf;
+    msg.msg_controllen = sizeof(buf);
+    cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(fds));
+    memcpy(CMSG_DATA(cmsg), fds, sizeof(fds));
+    if (sendmsg(s, &msg, 0) < 0){
+        clixon_err(OE_UNIX, errno, "sendmsg");
+        goto done;
+    }
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Receive file descriptors and user name of a session from a handoff
+ *
+ * @param[in]  s         Accepted unix socket
+ * @param[out] fds       Session input and output file descriptors
+ * @param[out] username  User name sent by peer, malloced, empty if not sent
+ * @retval     0         OK
+ * @retval    -1         Error
+ */
+static int
+netconf_server_recv_fds(int    s,
+                        int    fds[2],
+                        char **username)
+{
+    int             retval = -1;
+    struct msghdr   msg = {0};
+    struct cmsghdr *cmsg;
+    struct iovec    iov;
+    char            name[NETCONF_SERVER_USERMAX];
+    char            buf[CMSG_SPACE(2*sizeof(int))];
+    ssize_t         len;
+
+    memset(name, 0, sizeof(name));
+    iov.iov_base = name;
+    iov.iov_len = sizeof(name) - 1;
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = buf;
+    msg.msg_controllen = sizeof(buf);
+    if ((len = recvmsg(s, &msg, 0)) < 0){
+        clixon_err(OE_UNIX, errno, "recvmsg");
+        goto done;
+    }
+    if ((cmsg = CMSG_FIRSTHDR(&msg)) == NULL ||
+        cmsg->cmsg_level != SOL_SOCKET ||
+        cmsg->cmsg_type != SCM_RIGHTS ||
+        cmsg->cmsg_len != CMSG_LEN(2*sizeof(int))){
+        clixon_err(OE_UNIX, EPROTO, "Expected two file descriptors");
+        goto done;
+    }
+    memcpy(fds, CMSG_DATA(cmsg), 2*sizeof(int));
+    if ((*username = strdup(name)) == NULL){
+        clixon_err(OE_UNIX, errno, "strdup");
+        close(fds[0]);
+        close(fds[1]);
+        goto done;
+    }
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Get user name of session, from peer credentials
+ *
+ * The user name sent in the handoff, eg from -U, is only used if the peer runs as root
+ * or as the same user as the server
+ * @param[in]  s         Accepted unix socket
+ * @param[in]  sent      User name sent by peer
+ * @param[out] username  User name, malloced
+ * @retval     0         OK
+ * @retval    -1         Error
+ */
+static int
+netconf_server_peer_user(int    s,
+                         char  *sent,
+                         char **username)
+{
+    int       retval = -1;
+    uid_t     uid;
+#ifdef HAVE_SO_PEERCRED        /* Linux. */
+    socklen_t clen;
+    struct ucred cr = {0,};
+#elif defined(HAVE_GETPEEREID) /* FreeBSD */
+    gid_t     gid;
+#endif
+
+#if defined(HAVE_SO_PEERCRED)
+    clen = sizeof(cr);
+    if (getsockopt(s, SOL_SOCKET, SO_PEERCRED, &cr, &clen) < 0){
+        clixon_err(OE_UNIX, errno, "getsockopt");
+        goto done;
+    }
+    uid = cr.uid;
+#elif defined(HAVE_GETPEEREID)
+    if (getpeereid(s, &uid, &gid) < 0){
+        clixon_err(OE_UNIX, errno, "getpeereid");
+        goto done;
+    }
+#else
+#error "Need getsockopt O_PEERCRED or getpeereid for unix socket peer cred"
+#endif
+    if (*sent != '\0' && (uid == 0 || uid == geteuid())){
+        if ((*username = strdup(sent)) == NULL){
+            clixon_err(OE_UNIX, errno, "strdup");
+            goto done;
+        }
+    }
+    else if (uid2name(uid, username) < 0)
+        goto done;
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Open unix socket of netconf server, with same group and mode as the backend socket
+ *
+ * @param[in]  h         Clixon handle
+ * @param[in]  sockpath  Unix socket path
+ * @retval     s         Listening socket
+ * @retval    -1         Error
+ */
+static int
+netconf_server_socket(clixon_handle h,
+                      const char   *sockpath)
+{
+    int                s = -1;
+    struct sockaddr_un addr;
+    mode_t             old_mask;
+    char              *group;
+    gid_t              gid = -1;
+    struct stat        st;
+
+    if (lstat(sockpath, &st) == 0 && unlink(sockpath) < 0){
+        clixon_err(OE_UNIX, errno, "unlink(%s)", sockpath);
+        goto err;
+    }
+    if ((group = clicon_sock_group(h)) != NULL &&
+        group_name2gid(group, &gid) < 0)
+        goto err;
+    if ((s = socket(AF_UNIX, SOCK_STREAM, 0)) < 0) {
+        clixon_err(OE_UNIX, errno, "socket %s", sockpath);
+        goto err;
+    }
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, sockpath, sizeof(addr.sun_path)-1);
+    old_mask = umask(S_IRWXO | S_IXGRP | S_IXUSR);
+    if (bind(s, (struct sockaddr *)&addr, SUN_LEN(&addr)) < 0){
+        clixon_err(OE_UNIX, errno, "bind %s", sockpath);
+        umask(old_mask);
+        goto err;
+    }
+    umask(old_mask);
+    if (gid != (gid_t)-1 && lchown(sockpath, -1, gid) < 0){
+        clixon_err(OE_UNIX, errno, "lchown(%s, %s)", sockpath, group);
+        goto err;
+    }
+    if (listen(s, SOMAXCONN) < 0){
+        clixon_err(OE_UNIX, errno, "listen");
+        goto err;
+    }
+    clixon_debug(CLIXON_DBG_INIT, "Listen on netconf server socket at %s", sockpath);
+    return s;
+ err:
+    if (s != -1)
+        close(s);
+    return -1;
+}
+
+/*! Hand over this netconf session to a running netconf server
+ *
+ * Called early in a clixon_netconf session, before plugins and YANG are loaded.
+ * If the server accepts, block until the session is terminated.
+ * @param[in]  h         Clixon handle
+ * @param[in]  sockpath  Unix socket path of netconf server
+ * @retval     1         Session handed over and terminated
+ * @retval     0         No netconf server running, run session in this process
+ * @retval    -1         Error
+ */
+int
+netconf_server_handoff(clixon_handle h,
+                       const char   *sockpath)
+{
+    int                retval = -1;
+    int                s = -1;
+    struct sockaddr_un addr;
+    char               buf[64];
+    ssize_t            len;
+
+    if ((s = socket(AF_UNIX, SOCK_STREAM, 0)) < 0) {
+        clixon_err(OE_UNIX, errno, "socket");
+        goto done;
+    }
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, sockpath, sizeof(addr.sun_path)-1);
+    if (connect(s, (struct sockaddr *)&addr, SUN_LEN(&addr)) < 0){
+        clixon_debug(CLIXON_DBG_NETCONF, "No netconf server at %s: %s", sockpath, strerror(errno));
+        retval = 0;
+        goto done;
+    }
+    if (netconf_server_send_fds(s, clicon_username_get(h)) < 0)
+        goto done;
+    clixon_debug(CLIXON_DBG_NETCONF, "Session handed over to netconf server at %s", sockpath);
+    /* Wait until session process closes the socket */
+    while ((len = read(s, buf, sizeof(buf))) != 0){
+        if (len < 0 && errno != EINTR)
+            break;
+    }
+    retval = 1;
+ done:
+    if (s != -1)
+        close(s);
+    return retval;
+}
+
+/*! Run shared netconf server, accept sessions and fork a session process for each
+ *
+ * Returns in the parent only when terminated. Returns in forked session processes with
+ * stdin/stdout replaced by the descriptors of the session, and the user name set. The
+ * caller then continues as a regular netconf session.
+ * @param[in]  h         Clixon handle
+ * @param[in]  sockpath  Unix socket path
+ * @retval     1         In session process
+ * @retval     0         Server terminated
+ * @retval    -1         Error
+ */
+int
+netconf_server(clixon_handle h,
+               const char   *sockpath)
+{
+    int    retval = -1;
+    int    ss = -1;
+    int    s = -1;
+    int    fds[2] = {-1, -1};
+    char  *sent = NULL;
+    char  *username = NULL;
+    pid_t  pid;
+
+    if ((ss = netconf_server_socket(h, sockpath)) < 0)
+        goto done;
+    /* Sessions are not waited for */
+    if (set_signal(SIGCHLD, SIG_IGN, NULL) < 0)
+        goto done;
+    /* No SA_RESTART so that accept is interrupted */
+    if (set_signal_flags(SIGTERM, 0, netconf_server_sig_term, NULL) < 0)
+        goto done;
+    if (set_signal_flags(SIGINT, 0, netconf_server_sig_term, NULL) < 0)
+        goto done;
+    clixon_log(h, LOG_NOTICE, "%s: %u Server started on %s", __PROGRAM__, getpid(), sockpath);
+    while (clixon_exit_get() == 0){
+        if ((s = accept(ss, NULL, NULL)) < 0){
+            if (errno == EINTR || errno == ECONNABORTED)
+                continue;
+            clixon_err(OE_UNIX, errno, "accept");
+            goto done;
+        }
+        if (netconf_server_recv_fds(s, fds, &sent) < 0 ||
+            netconf_server_peer_user(s, sent, &username) < 0){
+            /* Log and drop this session, continue serving others */
+            clixon_log(h, LOG_WARNING, "%s: netconf server handoff failed: %s",
+                       __func__, clixon_err_reason());
+            clixon_err_reset();
+            goto next;
+        }
+        if ((pid = fork()) < 0){
+            clixon_err(OE_UNIX, errno, "fork");
+            goto done;
+        }
+        if (pid == 0){ /* Session process */
+            close(ss);
+            ss = -1;
+            set_signal(SIGCHLD, SIG_DFL, NULL);
+            set_signal(SIGTERM, SIG_DFL, NULL);
+            set_signal(SIGINT, SIG_DFL, NULL);
+            if (dup2(fds[0], 0) < 0 || dup2(fds[1], 1) < 0){
+                clixon_err(OE_UNIX, errno, "dup2");
+                goto done;
+            }
+            if (fds[0] > 1)
+                close(fds[0]);
+            if (fds[1] > 1)
+                close(fds[1]);
+            if (clicon_username_set(h, username) < 0)
+                goto done;
+            /* s is kept open until the session process exits */
+            retval = 1;
+            goto done;
+        }
+        clixon_debug(CLIXON_DBG_NETCONF, "Session of %s in process %u", username, pid);
+    next:
+        if (fds[0] != -1)
+            close(fds[0]);
+        if (fds[1] != -1)
+            close(fds[1]);
+        fds[0] = fds[1] = -1;
+        close(s);
+        s = -1;
+        if (sent){
+            free(sent);
+            sent = NULL;
+        }
+        if (username){
+            free(username);
+            username = NULL;
+        }
+    }
+    retval = 0;
+ done:
+    if (retval != 1){
+        if (s != -1)
+            close(s);
+        if (fds[0] != -1)
+            close(fds[0]);
+        if (fds[1] != -1)
+            close(fds[1]);
+    }
+    if (ss != -1){
+        close(ss);
+        unlink(sockpath);
+    }
+    if (sent)
+        free(sent);
+    if (username)
+        free(username);
+    return retval;
+}
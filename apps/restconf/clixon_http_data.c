@@ -51,8 +51,10 @@
 #include <signal.h>
 #include <sys/time.h>
 #include <sys/wait.h>
+#include <ctype.h>
 #include <libgen.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
 
 /* cligen */
 #include <cligen/cligen.h>
@@ -83,6 +85,26 @@ static const map_str2str mime_map[] = {
     { NULL,    NULL} /* if not found: application/octet-stream */
 };
 
+/*! Open, memory-mapped file, in static http data cache if hf_cached is set
+ */
+typedef struct {
+    qelem_t         hf_qelem;   /* List header */
+    char           *hf_path;    /* File path */
+    dev_t           hf_dev;     /* Device, for revalidation */
+    ino_t           hf_ino;     /* Inode, for revalidation */
+    off_t           hf_size;    /* Size, for revalidation */
+    struct timespec hf_mtime;   /* Modification time, for revalidation */
+    int             hf_fd;      /* Open file, eg for sendfile */
+    char           *hf_map;     /* File memory-mapped, NULL if empty */
+    int             hf_cached;  /* In cache, not freed after reply */
+} http_data_file;
+
+/* Static http data cache, most recently used first, see HTTP_DATA_CACHE_MAX */
+static http_data_file *_http_data_cache = NULL;
+
+/* Total size of files in static http data cache */
+static size_t _http_data_cache_size = 0;
+
 /*! Check if uri path denotes a data path
  *
  * @param[in]  h      Clixon handle
@@ -165,9 +187,8 @@ api_http_data_err(clixon_handle  h,
  * @param[in]      req     Generic Www handle (can be part of clixon handle)
  * @param[in]      prefix  Prefix of path0, where to start file check
  * @param[in,out]  cbpath  Filepath as cbuf, internal redirection may change it
- * @param[out]     fp      Open file, if retval = 1
- * @param[out]     fsz     Size of file, if retval = 1
- * @retval         1       OK, fp,fsz set
+ * @param[out]     st      File status, if retval = 1
+ * @retval         1       OK, st set
  * @retval         0       Invalid
  * @retval        -1       Error
  */
@@ -176,18 +197,16 @@ http_data_check_file_path(clixon_handle h,
                           void         *req,
                           char         *prefix,
                           cbuf         *cbpath,
-                          FILE        **fp,
-                          off_t        *fsz)
+                          struct stat  *st)
 {
     int         retval = -1;
     struct stat fstat;
     char       *p;
     int         i;
     int         code = 0;
-    FILE       *f;
 
-    if (prefix == NULL || cbpath == NULL || fp == NULL){
-        clixon_err(OE_UNIX, EINVAL, "prefix, cbpath0 or fp is NULL");
+    if (prefix == NULL || cbpath == NULL || st == NULL){
+        clixon_err(OE_UNIX, EINVAL, "prefix, cbpath0 or st is NULL");
         goto done;
     }
     p = cbuf_get(cbpath);
@@ -247,13 +266,7 @@ http_data_check_file_path(clixon_handle h,
         code = 403;
         goto invalid;
     }
-    *fsz = fstat.st_size;
-    if ((f = fopen(p, "rb")) == NULL){
-        clixon_debug(CLIXON_DBG_RESTCONF, "Error fopen(%s) %s", p, strerror(errno));
-        code = 403;
-        goto invalid;
-    }
-    *fp = f;
+    *st = fstat;
     retval = 1; /* OK */
  done:
     return retval;
@@ -264,16 +277,289 @@ http_data_check_file_path(clixon_handle h,
     goto done;
 }
 
+/*! Find precompressed variant of a file if accepted by the client
+ *
+ * Try <filename>.br and <filename>.gz, in that order, if the corresponding content-coding
+ * is in the Accept-Encoding request header
+ * @param[in]  h         Clixon handle
+ * @param[in]  filename  Path of uncompressed file
+ * @param[out] cbz       Path of precompressed variant, if retval = 1
+ * @param[out] st        File status of variant, if retval = 1
+ * @param[out] encoding  Content-coding, if retval = 1
+ * @retval     1         OK, precompressed variant found
+ * @retval     0         No accepted variant found
+ * @retval    -1         Error
+ */
+static int
+http_data_precompressed(clixon_handle h,
+                        char         *filename,
+                        cbuf         *cbz,
+                        struct stat  *st,
+                        const char  **encoding)
+{
+    int         retval = -1;
+    static const char *variants[][2] = {{"br", ".br"}, {"gzip", ".gz"}};
+    char       *list;
+    struct stat fstat;
+    int         i;
+
+    if ((list = restconf_param_get(h, "HTTP_ACCEPT_ENCODING")) == NULL)
+        goto notfound;
+    for (i=0; i<sizeof(variants)/sizeof(variants[0]); i++){
+        if (restconf_encoding_in_list(variants[i][0], list) != 1)
+            continue;
+        cbuf_reset(cbz);
+        cprintf(cbz, "%s%s", filename, variants[i][1]);
+        /* Ensure regular file, not soft link */
+        if (lstat(cbuf_get(cbz), &fstat) < 0 || !S_ISREG(fstat.st_mode))
+            continue;
+        clixon_debug(CLIXON_DBG_RESTCONF, "precompressed %s", cbuf_get(cbz));
+        *st = fstat;
+        *encoding = variants[i][0];
+        retval = 1;
+        goto done;
+    }
+ notfound:
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Free an open, memory-mapped file
+ *
+ * @param[in]  hf   File entry
+ */
+static void
+http_data_file_free(http_data_file *hf)
+{
+    if (hf->hf_map)
+        munmap(hf->hf_map, hf->hf_size);
+    if (hf->hf_fd >= 0)
+        close(hf->hf_fd);
+    if (hf->hf_path)
+        free(hf->hf_path);
+    free(hf);
+}
+
+/*! Get open, memory-mapped file from cache, or open it
+ *
+ * A cached file is revalidated with the file status given by the caller: if device, inode,
+ * size or modification time differ, it is opened again.
+ * Files larger than HTTP_DATA_CACHE_MAX are not cached, the caller frees them after reply.
+ * The least recently used files are removed from the cache when it exceeds HTTP_DATA_CACHE_MAX.
+ * @param[in]  path     File path
+ * @param[in]  st       File status from lstat of path
+ * @param[out] hfp      File entry, if retval = 1
+ * @retval     1        OK
+ * @retval     0        File could not be opened or has changed
+ * @retval    -1        Error
+ */
+static int
+http_data_file_get(char            *path,
+                   struct stat     *st,
+                   http_data_file **hfp)
+{
+    int             retval = -1;
+    http_data_file *hf;
+    struct stat     fst;
+
+    if ((hf = _http_data_cache) != NULL){
+        do {
+            if (strcmp(hf->hf_path, path) == 0)
+                break;
+            hf = NEXTQ(http_data_file *, hf);
+        } while (hf && hf != _http_data_cache);
+        if (hf == _http_data_cache && strcmp(hf->hf_path, path) != 0)
+            hf = NULL;
+    }
+    if (hf != NULL){
+        DELQ(hf, _http_data_cache, http_data_file *);
+        if (hf->hf_dev == st->st_dev && hf->hf_ino == st->st_ino &&
+            hf->hf_size == st->st_size &&
+            hf->hf_mtime.tv_sec == st->st_mtim.tv_sec &&
+            hf->hf_mtime.tv_nsec == st->st_mtim.tv_nsec){
+            clixon_debug(CLIXON_DBG_RESTCONF | CLIXON_DBG_DETAIL, "cache hit %s", path);
+            INSQ(hf, _http_data_cache); /* Most recently used first */
+            *hfp = hf;
+            goto ok;
+        }
+        _http_data_cache_size -= hf->hf_size;
+        http_data_file_free(hf);
+    }
+    if ((hf = malloc(sizeof(*hf))) == NULL){
+        clixon_err(OE_UNIX, errno, "malloc");
+        goto done;
+    }
+    memset(hf, 0, sizeof(*hf));
+    hf->hf_fd = -1;
+    if ((hf->hf_path = strdup(path)) == NULL){
+        clixon_err(OE_UNIX, errno, "strdup");
+        free(hf);
+        goto done;
+    }
+    if ((hf->hf_fd = open(path, O_RDONLY|O_NOFOLLOW|O_CLOEXEC)) < 0){
+        clixon_debug(CLIXON_DBG_RESTCONF, "Error open(%s) %s", path, strerror(errno));
+        goto invalid;
+    }
+    /* Status of open file, reduces race condition with lstat */
+    if (fstat(hf->hf_fd, &fst) < 0 || !S_ISREG(fst.st_mode) ||
+        fst.st_ino != st->st_ino || fst.st_dev != st->st_dev){
+        clixon_debug(CLIXON_DBG_RESTCONF, "Error file %s changed", path);
+        goto invalid;
+    }
+    hf->hf_dev = fst.st_dev;
+    hf->hf_ino = fst.st_ino;
+    hf->hf_size = fst.st_size;
+    hf->hf_mtime = fst.st_mtim;
+    if (hf->hf_size > 0 &&
+        (hf->hf_map = mmap(NULL, hf->hf_size, PROT_READ, MAP_PRIVATE, hf->hf_fd, 0)) == MAP_FAILED){
+        hf->hf_map = NULL;
+        clixon_err(OE_UNIX, errno, "mmap %s", path);
+        http_data_file_free(hf);
+        goto done;
+    }
+    if (hf->hf_size <= HTTP_DATA_CACHE_MAX){
+        hf->hf_cached = 1;
+        INSQ(hf, _http_data_cache);
+        _http_data_cache_size += hf->hf_size;
+        /* Remove least recently used, except this */
+        while (_http_data_cache_size > HTTP_DATA_CACHE_MAX){
+            http_data_file *hl = PREVQ(http_data_file *, _http_data_cache);
+            if (hl == hf)
+                break;
+            DELQ(hl, _http_data_cache, http_data_file *);
+            _http_data_cache_size -= hl->hf_size;
+            http_data_file_free(hl);
+        }
+    }
+    *hfp = hf;
+ ok:
+    retval = 1;
+ done:
+    return retval;
+ invalid:
+    http_data_file_free(hf);
+    retval = 0;
+    goto done;
+}
+
+/*! Free all files of static http data cache
+ */
+void
+api_http_data_cache_free(void)
+{
+    http_data_file *hf;
+
+    while ((hf = _http_data_cache) != NULL){
+        DELQ(hf, _http_data_cache, http_data_file *);
+        http_data_file_free(hf);
+    }
+    _http_data_cache_size = 0;
+}
+
+/*! Parse Range header of a single byte range
+ *
+ * Only a single range is supported, several ranges or invalid syntax are ignored
+ * and the whole file is sent, as allowed by RFC 9110 Sec 14.2
+ * @param[in]  range  Range field value, eg "bytes=0-499"
+ * @param[in]  size   Size of file
+ * @param[out] first  First byte position, if retval = 1
+ * @param[out] last   Last byte position, if retval = 1
+ * @retval     1      OK, range set
+ * @retval     0      Ignore range, send whole file
+ * @retval    -1      Range not satisfiable
+ */
+static int
+http_data_range(char   *range,
+                off_t   size,
+                off_t  *first,
+                off_t  *last)
+{
+    char              *s;
+    char              *end;
+    unsigned long long n1;
+    unsigned long long n2;
+
+    if (strncmp(range, "bytes=", 6) != 0 || strchr(range, ',') != NULL)
+        return 0;
+    s = range + 6;
+    if (*s == '-'){ /* suffix-range: last n bytes */
+        s++;
+        if (!isdigit((unsigned char)*s))
+            return 0;
+        errno = 0;
+        n2 = strtoull(s, &end, 10);
+        if (errno || *end != '\0')
+            return 0;
+        if (n2 == 0 || size == 0)
+            return -1;
+        *first = n2 < size ? size - n2 : 0;
+        *last = size - 1;
+        return 1;
+    }
+    if (!isdigit((unsigned char)*s))
+        return 0;
+    errno = 0;
+    n1 = strtoull(s, &end, 10);
+    if (errno || *end != '-')
+        return 0;
+    s = end + 1;
+    if (*s == '\0')
+        n2 = size - 1;
+    else {
+        if (!isdigit((unsigned char)*s))
+            return 0;
+        n2 = strtoull(s, &end, 10);
+        if (errno || *end != '\0' || n2 < n1)
+            return 0;
+    }
+    if (n1 >= size)
+        return -1;
+    *first = n1;
+    *last = n2 < size ? n2 : size - 1;
+    return 1;
+}
+
+/*! Check conditional request header fields of a file
+ *
+ * @param[in]  h         Clixon handle
+ * @param[in]  etag      Entity-tag of file
+ * @param[in]  mtime     Modification time of file
+ * @retval     1         Not modified, reply 304
+ * @retval     0         Modified
+ */
+static int
+http_data_not_modified(clixon_handle h,
+                       char         *etag,
+                       time_t        mtime)
+{
+    char     *str;
+    struct tm tm;
+    char      datestr[64];
+
+    /* If-Modified-Since is ignored if If-None-Match is present, RFC 9110 Sec 13.1.3 */
+    if ((str = restconf_param_get(h, "HTTP_IF_NONE_MATCH")) != NULL)
+        return strstr(str, etag) != NULL || strcmp(str, "*") == 0;
+    if ((str = restconf_param_get(h, "HTTP_IF_MODIFIED_SINCE")) != NULL){
+        gmtime_r(&mtime, &tm);
+        strftime(datestr, sizeof(datestr), "%a, %d %b %Y %H:%M:%S GMT", &tm);
+        return strcmp(str, datestr) == 0;
+    }
+    return 0;
+}
+
 /*! Read file data request
  *
+ * Files are served from an in-memory cache of memory-mapped files, revalidated with stat().
+ * The reply has ETag, Last-Modified and Cache-Control header fields, conditional requests
+ * are replied with 304, and a single byte Range is replied with 206.
+ * The body is sent with sendfile() if possible, see restconf_reply_send_file
  * @param[in]  h         Clixon handle
  * @param[in]  req       Generic Www handle (can be part of clixon handle)
  * @param[in]  pathname  With stripped prefix (eg /data), ultimately a filename
  * @param[in]  head      HEAD not GET
  * @retval     0         OK
  * @retval    -1         Error
- * @note: primitive file handling, just check if file exists and read it all
- * XXX 1: Buffer copying once too many, see #if 0 below
  */
 static int
 api_http_data_file(clixon_handle h,
@@ -281,20 +567,26 @@ api_http_data_file(clixon_handle h,
                    char         *pathname,
                    int           head)
 {
-    int    retval = -1;
-    cbuf  *cbfile = NULL;
-    char  *filename = NULL;
-    cbuf  *cbdata = NULL;
-    FILE  *f = NULL;
-    off_t  fsz = 0;
-    long   fsize;
-    char  *www_data_root = NULL;
-    char  *suffix;
-    const char *media;
-    char  *buf = NULL;
-    size_t sz;
-    char  *media_list = NULL;
-    int    ret;
+    int             retval = -1;
+    cbuf           *cbfile = NULL;
+    cbuf           *cbz = NULL;
+    cbuf           *cbetag = NULL;
+    char           *filename = NULL;
+    struct stat     st;
+    http_data_file *hf = NULL;
+    const char     *encoding = NULL;
+    char           *www_data_root = NULL;
+    char           *suffix;
+    const char     *media;
+    char           *media_list = NULL;
+    char           *range;
+    char           *str;
+    off_t           first = 0;
+    off_t           last = 0;
+    int             code = 200;
+    struct tm       tm;
+    char            datestr[64];
+    int             ret;
 
     clixon_debug(CLIXON_DBG_RESTCONF, "");
     if ((cbfile = cbuf_new()) == NULL){
@@ -316,7 +608,7 @@ api_http_data_file(clixon_handle h,
         }
         cprintf(cbfile, "%s", pathname); /* Assume pathname starts with '/' */
     }
-    if ((ret = http_data_check_file_path(h, req, www_data_root, cbfile, &f, &fsz)) < 0)
+    if ((ret = http_data_check_file_path(h, req, www_data_root, cbfile, &st)) < 0)
         goto done;
     if (ret == 0) /* Invalid, return code set */
         goto ok;
@@ -343,65 +635,92 @@ api_http_data_file(clixon_handle h,
             goto ok;
         }
     }
-    /* Size could have been taken from stat() but this reduces the race condition interval 
-     * There is still one without flock
-     */
-    fseek(f, 0, SEEK_END);
-    fsize = ftell(f);
-    /* Extra sanity check, had some problems with wrong file types */
-    if (fsz != fsize){
-        clixon_debug(CLIXON_DBG_RESTCONF, "Error file %s size mismatch sz:%zu vs %li",
-                     filename, (size_t)fsz, fsize);
-        if (api_http_data_err(h, req, 500) < 0) /* Internal error? */
+    /* Serve precompressed variant instead, if present and accepted */
+    if ((cbz = cbuf_new()) == NULL){
+        clixon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    if ((ret = http_data_precompressed(h, filename, cbz, &st, &encoding)) < 0)
+        goto done;
+    if (ret == 1)
+        filename = cbuf_get(cbz);
+    if ((ret = http_data_file_get(filename, &st, &hf)) < 0)
+        goto done;
+    if (ret == 0){
+        if (api_http_data_err(h, req, 403) < 0)
             goto done;
         goto ok;
     }
-    fseek(f, 0, SEEK_SET);  /* same as rewind(f); */
-    if ((cbdata = cbuf_new_alloc(fsize+1)) == NULL){
-        clixon_err(OE_UNIX, errno, "cbuf_new_alloc");
+    /* Strong entity-tag of the file (of the precompressed variant if served) */
+    if ((cbetag = cbuf_new()) == NULL){
+        clixon_err(OE_UNIX, errno, "cbuf_new");
         goto done;
     }
-    /* Unoptimized, no direct read but requires an extra copy,
-     * the cligen buf API should have some mechanism for this case without the extra copy.
-     */
-    if ((buf = malloc(fsize)) == NULL){
-        clixon_err(OE_UNIX, errno, "malloc");
+    cprintf(cbetag, "\"%lx-%llx-%lx.%lx\"", (unsigned long)hf->hf_ino,
+            (unsigned long long)hf->hf_size,
+            (unsigned long)hf->hf_mtime.tv_sec, (unsigned long)hf->hf_mtime.tv_nsec);
+    gmtime_r(&hf->hf_mtime.tv_sec, &tm);
+    strftime(datestr, sizeof(datestr), "%a, %d %b %Y %H:%M:%S GMT", &tm);
+    last = hf->hf_size - 1;
+    /* Range is ignored if If-Range does not match, RFC 9110 Sec 13.1.5 */
+    if (!http_data_not_modified(h, cbuf_get(cbetag), hf->hf_mtime.tv_sec) &&
+        (range = restconf_param_get(h, "HTTP_RANGE")) != NULL &&
+        ((str = restconf_param_get(h, "HTTP_IF_RANGE")) == NULL ||
+         strcmp(str, cbuf_get(cbetag)) == 0 || strcmp(str, datestr) == 0)){
+        if ((ret = http_data_range(range, hf->hf_size, &first, &last)) < 0){
+            if (restconf_reply_header(req, "Content-Range", "bytes */%llu",
+                                      (unsigned long long)hf->hf_size) < 0)
+                goto done;
+            if (api_http_data_err(h, req, 416) < 0)
+                goto done;
+            goto ok;
+        }
+        if (ret == 1){
+            code = 206;
+            if (restconf_reply_header(req, "Content-Range", "bytes %llu-%llu/%llu",
+                                      (unsigned long long)first, (unsigned long long)last,
+                                      (unsigned long long)hf->hf_size) < 0)
+                goto done;
+        }
+    }
+    if (restconf_reply_header(req, "ETag", "%s", cbuf_get(cbetag)) < 0)
+        goto done;
+    if (restconf_reply_header(req, "Last-Modified", "%s", datestr) < 0)
+        goto done;
+    if (restconf_reply_header(req, "Cache-Control", "%s", HTTP_DATA_CACHE_CONTROL) < 0)
         goto done;
+    if (encoding){
+        if (restconf_reply_header(req, "Content-Encoding", "%s", encoding) < 0)
+            goto done;
     }
-    if ((sz = fread(buf, fsize, 1, f)) == 0){
-        clixon_debug(CLIXON_DBG_RESTCONF, "Error fread(%s) err:%d", filename, ferror(f));
-        if (api_http_data_err(h, req, 500) < 0) /* Internal error? */
+    if (restconf_param_get(h, "HTTP_ACCEPT_ENCODING") != NULL || encoding){
+        if (restconf_reply_header(req, "Vary", "Accept-Encoding") < 0)
             goto done;
-        goto ok;
     }
-    if (sz != 1){
-        clixon_debug(CLIXON_DBG_RESTCONF, "Error fread(%s) sz:%zu", filename, sz);
-        if (api_http_data_err(h, req, 500) < 0) /* Internal error? */
+    if (http_data_not_modified(h, cbuf_get(cbetag), hf->hf_mtime.tv_sec)){
+        if (restconf_reply_send(req, 304, NULL, head) < 0)
             goto done;
         goto ok;
     }
-    if (cbuf_append_buf(cbdata, buf, fsize) < 0){
-        clixon_err(OE_UNIX, errno, "cbuf_append_str");
-        goto done;
-    }
     if (restconf_reply_header(req, "Content-Type", "%s", media) < 0)
         goto done;
-    if (restconf_reply_send(req, 200, cbdata, head) < 0)
+    if (restconf_reply_header(req, "Accept-Ranges", "bytes") < 0)
+        goto done;
+    if (restconf_reply_send_file(req, code, hf->hf_fd, hf->hf_map, first, last-first+1, head) < 0)
         goto done;
-    cbdata = NULL; /* consumed by reply-send */
     clixon_debug(CLIXON_DBG_RESTCONF, "Read %s OK", filename);
  ok:
     retval = 0;
  done:
-    if (buf)
-        free(buf);
-    if (f)
-        fclose(f);
+    if (hf && !hf->hf_cached)
+        http_data_file_free(hf);
     if (cbfile)
         cbuf_free(cbfile);
-    if (cbdata)
-        cbuf_free(cbdata);
- return retval;
+    if (cbz)
+        cbuf_free(cbz);
+    if (cbetag)
+        cbuf_free(cbetag);
+    return retval;
 }
 
 /*! Get data request
@@ -43,5 +43,6 @@
  */
 int api_path_is_data(clixon_handle h);
 int api_http_data(clixon_handle h, void *req, cvec *qvec);
+void api_http_data_cache_free(void);
 
 #endif /* _CLIXON_HTTP_DATA_H_ */
@@ -45,7 +45,11 @@ int restconf_reply_header(void *req, const char *name, const char *vfmt, ...)  _
 
 /* note cb is consumed dont free */
 int restconf_reply_send(void *req, int code, cbuf *cb, int head);
+int restconf_reply_send_file(void *req, int code, int fd, const char *map, off_t offset, size_t len, int head);
 
 cbuf *restconf_get_indata(void *req);
+int   restconf_reply_defer(void *req, void *arg);
+int   restconf_reply_deferred(void *req);
+int   restconf_reply_resume(void *req);
 
 #endif /* _RESTCONF_API_H_ */
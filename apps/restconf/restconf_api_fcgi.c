@@ -229,6 +229,46 @@ restconf_reply_send(void  *req0,
     return retval;
 }
 
+/*! Send HTTP reply with a file as message body
+ *
+ * The body is written from the memory-mapped file
+ * @param[in]  req     Fastcgi request handle
+ * @param[in]  code    Status code
+ * @param[in]  fd      Open file, not used
+ * @param[in]  map     File memory-mapped, NULL if empty
+ * @param[in]  offset  Offset of body in file
+ * @param[in]  len     Length of body
+ * @param[in]  head    Only send headers, dont send body
+ * @retval     0       OK
+ * @retval    -1       Error
+ */
+int
+restconf_reply_send_file(void       *req0,
+                         int         code,
+                         int         fd,
+                         const char *map,
+                         off_t       offset,
+                         size_t      len,
+                         int         head)
+{
+    FCGX_Request *req = (FCGX_Request *)req0;
+    int           retval = -1;
+
+    if (restconf_reply_header(req, "Content-Length", "%zu", len) < 0)
+        goto done;
+    if (restconf_reply_send(req, code, NULL, head) < 0)
+        goto done;
+    if (!head && len &&
+        FCGX_PutStr(map + offset, len, req->out) < 0){
+        clixon_err(OE_RESTCONF, errno, "FCGX_PutStr");
+        goto done;
+    }
+    FCGX_FFlush(req->out);
+    retval = 0;
+ done:
+    return retval;
+}
+
 /*! Get input data from http request, eg such as curl -X PUT http://... <indata>
  *
  * @param[in]  req        Fastcgi request handle
@@ -249,3 +289,39 @@ restconf_get_indata(void *req0)
         cprintf(cb, "%c", c);
     return cb;
 }
+
+/*! Defer reply of http request until the backend replies, not supported by fcgi
+ *
+ * @param[in]  req   Fastcgi request handle
+ * @param[in]  arg   Argument of the backend request callback
+ * @retval     0     Not deferred, reply now
+ */
+int
+restconf_reply_defer(void *req0,
+                     void *arg)
+{
+    return 0;
+}
+
+/*! Check if reply of http request is still deferred, not supported by fcgi
+ *
+ * @param[in]  req   Fastcgi request handle
+ * @retval     0     Not deferred
+ */
+int
+restconf_reply_deferred(void *req0)
+{
+    return 0;
+}
+
+/*! Send a deferred reply of http request, not supported by fcgi
+ *
+ * @param[in]  req   Fastcgi request handle
+ * @retval    -1     Error
+ */
+int
+restconf_reply_resume(void *req0)
+{
+    clixon_err(OE_RESTCONF, EINVAL, "Reply not deferred");
+    return -1;
+}
@@ -49,6 +49,9 @@
 #include <arpa/inet.h>
 #include <openssl/ssl.h>
 #include <openssl/err.h>
+#ifdef HAVE_LIBZ
+#include <zlib.h>
+#endif
 
 #ifdef HAVE_LIBNGHTTP2
 #include <nghttp2/nghttp2.h>
@@ -61,8 +64,12 @@
 #include <clixon/clixon.h>
 
 #include "restconf_lib.h"
+#include "restconf_handle.h"
 #include "restconf_api.h"  /* Virtual api */
 #include "restconf_native.h"
+#ifdef HAVE_LIBNGHTTP2
+#include "restconf_nghttp2.h"
+#endif
 
 /*! Add HTTP header field name and value to reply
  *
@@ -136,6 +143,89 @@ restconf_reply_header(void       *req0,
     return retval;
 }
 
+#ifdef HAVE_LIBZ
+/* Size of zlib output chunk when compressing a reply body */
+#define REPLY_GZIP_CHUNK 16384
+
+/*! Gzip compress reply body if large enough and accepted by the client
+ *
+ * @param[in]  sd    Http stream
+ * @param[in]  cb    Reply body
+ * @param[out] cbz   Compressed body if retval is 1, free with cbuf_free
+ * @retval     1     Compressed, Content-Encoding header added
+ * @retval     0     Not compressed
+ * @retval    -1     Error
+ * @see CLICON_RESTCONF_COMPRESS_MIN
+ */
+static int
+native_reply_gzip(restconf_stream_data *sd,
+                  cbuf                 *cb,
+                  cbuf                **cbz)
+{
+    int           retval = -1;
+    clixon_handle h = sd->sd_conn->rc_h;
+    int           min;
+    char         *list;
+    z_stream      zs = {0,};
+    int           zinit = 0;
+    unsigned char out[REPLY_GZIP_CHUNK];
+    cbuf         *cbz1 = NULL;
+    int           zret;
+
+    if ((min = clicon_option_int(h, "CLICON_RESTCONF_COMPRESS_MIN")) <= 0 ||
+        cbuf_len(cb) < min)
+        goto nocompress;
+    if (cvec_find(sd->sd_outp_hdrs, "Content-Encoding") != NULL) /* eg precompressed file */
+        goto nocompress;
+    if (sd->sd_code == 206) /* Content-Range is of the uncompressed file */
+        goto nocompress;
+    if (restconf_reply_header(sd, "Vary", "Accept-Encoding") < 0)
+        goto done;
+    if ((list = restconf_param_get(h, "HTTP_ACCEPT_ENCODING")) == NULL ||
+        restconf_encoding_in_list("gzip", list) != 1)
+        goto nocompress;
+    /* windowBits 15+16: gzip header and trailer */
+    if (deflateInit2(&zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15+16, 8, Z_DEFAULT_STRATEGY) != Z_OK){
+        clixon_err(OE_RESTCONF, 0, "deflateInit2: %s", zs.msg?zs.msg:"");
+        goto done;
+    }
+    zinit++;
+    if ((cbz1 = cbuf_new_alloc(cbuf_len(cb)/4 + 64)) == NULL){
+        clixon_err(OE_UNIX, errno, "cbuf_new_alloc");
+        goto done;
+    }
+    zs.next_in = (Bytef*)cbuf_get(cb);
+    zs.avail_in = cbuf_len(cb);
+    do {
+        zs.next_out = out;
+        zs.avail_out = sizeof(out);
+        if ((zret = deflate(&zs, Z_FINISH)) == Z_STREAM_ERROR){
+            clixon_err(OE_RESTCONF, 0, "deflate: %s", zs.msg?zs.msg:"");
+            goto done;
+        }
+        if (cbuf_append_buf(cbz1, out, sizeof(out) - zs.avail_out) < 0){
+            clixon_err(OE_UNIX, errno, "cbuf_append_buf");
+            goto done;
+        }
+    } while (zret != Z_STREAM_END);
+    clixon_debug(CLIXON_DBG_RESTCONF, "gzip %zu -> %zu", cbuf_len(cb), cbuf_len(cbz1));
+    if (restconf_reply_header(sd, "Content-Encoding", "gzip") < 0)
+        goto done;
+    *cbz = cbz1;
+    cbz1 = NULL;
+    retval = 1;
+ done:
+    if (zinit)
+        deflateEnd(&zs);
+    if (cbz1)
+        cbuf_free(cbz1);
+    return retval;
+ nocompress:
+    retval = 0;
+    goto done;
+}
+#endif /* HAVE_LIBZ */
+
 /*! Assign values to HTTP reply with potential message body
  *
  * Generic code, add to restconf/native struct. Specific http/1 or /2 code actually sends
@@ -155,6 +245,10 @@ restconf_reply_send(void  *req0,
 {
     int                   retval = -1;
     restconf_stream_data *sd = (restconf_stream_data *)req0;
+#ifdef HAVE_LIBZ
+    cbuf                 *cbz = NULL;
+    int                   ret;
+#endif
 
     clixon_debug(CLIXON_DBG_RESTCONF, "code:%d", code);
     if (sd == NULL){
@@ -164,6 +258,16 @@ restconf_reply_send(void  *req0,
     sd->sd_code = code;
     if (cb != NULL){
         if (cbuf_len(cb)){
+#ifdef HAVE_LIBZ
+            if ((ret = native_reply_gzip(sd, cb, &cbz)) < 0){
+                cbuf_free(cb);
+                goto done;
+            }
+            if (ret == 1){
+                cbuf_free(cb);
+                cb = cbz;
+            }
+#endif
             sd->sd_body_len = cbuf_len(cb);
             if (head){
                 cbuf_free(cb);
@@ -185,6 +289,85 @@ restconf_reply_send(void  *req0,
     return retval;
 }
 
+/*! Assign values to HTTP reply with a file as message body
+ *
+ * For HTTP/1 without TLS, the body is sent from the file with sendfile() after the header,
+ * without copying it through user space. Otherwise, eg TLS or HTTP/2, the body is copied
+ * from the memory-mapped file, and may be compressed as by restconf_reply_send.
+ * @param[in]  req     http request handle
+ * @param[in]  code    Status code
+ * @param[in]  fd      Open file, duplicated if used
+ * @param[in]  map     File memory-mapped, NULL if empty
+ * @param[in]  offset  Offset of body in file
+ * @param[in]  len     Length of body
+ * @param[in]  head    Only send headers, dont send body
+ * @retval     0       OK
+ * @retval    -1       Error
+ * @see restconf_reply_send
+ */
+int
+restconf_reply_send_file(void       *req0,
+                         int         code,
+                         int         fd,
+                         const char *map,
+                         off_t       offset,
+                         size_t      len,
+                         int         head)
+{
+    int                   retval = -1;
+    restconf_stream_data *sd = (restconf_stream_data *)req0;
+    cbuf                 *cb = NULL;
+#ifdef HAVE_SYS_SENDFILE_H
+    restconf_conn        *rc;
+    int                   min;
+#endif
+
+    clixon_debug(CLIXON_DBG_RESTCONF, "code:%d len:%zu", code, len);
+    if (sd == NULL){
+        clixon_err(OE_CFG, EINVAL, "sd is NULL");
+        goto done;
+    }
+    if (head || len == 0){
+        sd->sd_code = code;
+        sd->sd_body_len = len;
+        goto ok;
+    }
+#ifdef HAVE_SYS_SENDFILE_H
+    rc = sd->sd_conn;
+    min = clicon_option_int(rc->rc_h, "CLICON_RESTCONF_COMPRESS_MIN");
+    if (rc->rc_ssl == NULL && rc->rc_proto == HTTP_11 && !sd->sd_upgrade2 &&
+        (min <= 0 || len < min || code != 200)){
+        if (sd->sd_fd != -1)
+            close(sd->sd_fd);
+        if ((sd->sd_fd = dup(fd)) < 0){
+            clixon_err(OE_UNIX, errno, "dup");
+            goto done;
+        }
+        sd->sd_fd_offset = offset;
+        sd->sd_code = code;
+        sd->sd_body_len = len;
+        goto ok;
+    }
+#endif
+    if ((cb = cbuf_new_alloc(len+1)) == NULL){
+        clixon_err(OE_UNIX, errno, "cbuf_new_alloc");
+        goto done;
+    }
+    if (cbuf_append_buf(cb, (void*)(map + offset), len) < 0){
+        clixon_err(OE_UNIX, errno, "cbuf_append_buf");
+        goto done;
+    }
+    retval = restconf_reply_send(req0, code, cb, head);
+    cb = NULL; /* consumed */
+    goto done;
+ ok:
+    retval = 0;
+ done:
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+}
+
 /*! Get input data from http request, eg such as curl -X PUT http://... <indata>
  *
  * @param[in]  req        Request handle
@@ -204,3 +387,68 @@ restconf_get_indata(void *req0)
  done:
     return cb;
 }
+
+/*! Defer reply of http request until the backend replies, if possible
+ *
+ * Only http/2 replies are deferred, since other streams of the connection can then be served
+ * meanwhile. An http/1 connection serves one request at a time.
+ * @param[in]  req   Request handle
+ * @param[in]  arg   Argument of the backend request callback, NULL to not defer anymore
+ * @retval     1     Deferred, reply later with restconf_reply_resume
+ * @retval     0     Not deferred, reply now
+ * @see http2_resume
+ */
+int
+restconf_reply_defer(void *req0,
+                     void *arg)
+{
+    restconf_stream_data *sd = (restconf_stream_data *)req0;
+
+    if (sd == NULL || sd->sd_proto != HTTP_2 || sd->sd_conn->rc_event_stream)
+        return 0;
+#ifdef HAVE_LIBNGHTTP2
+    sd->sd_defer = arg;
+    return 1;
+#else
+    return 0;
+#endif
+}
+
+/*! Check if reply of http request is still deferred
+ *
+ * @param[in]  req   Request handle
+ * @retval     1     Deferred
+ * @retval     0     Not deferred, or the request has been closed
+ */
+int
+restconf_reply_deferred(void *req0)
+{
+    restconf_stream_data *sd = (restconf_stream_data *)req0;
+
+    return sd != NULL && sd->sd_defer != NULL;
+}
+
+/*! Send a deferred reply of http request
+ *
+ * Prerequisites: reply given with restconf_reply_header and restconf_reply_send
+ * @param[in]  req   Request handle
+ * @retval     0     OK
+ * @retval    -1     Error
+ * @see restconf_reply_defer
+ */
+int
+restconf_reply_resume(void *req0)
+{
+    restconf_stream_data *sd = (restconf_stream_data *)req0;
+
+    if (sd == NULL || sd->sd_defer == NULL){
+        clixon_err(OE_RESTCONF, EINVAL, "Reply not deferred");
+        return -1;
+    }
+    sd->sd_defer = NULL;
+#ifdef HAVE_LIBNGHTTP2
+    return http2_resume(sd);
+#else
+    return 0;
+#endif
+}
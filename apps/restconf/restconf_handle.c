@@ -89,6 +89,7 @@ struct restconf_handle {
     clicon_hash_t           *rh_data;      /* internal clicon data (HDR) */
     clicon_hash_t           *rh_db_elmnt;  /* xml datastore element cache data */
     event_stream_t          *rh_stream;    /* notification streams, see clixon_stream.[ch] */
+    void                    *rh_optv;      /* typed option values, see clicon_option_bool_id */
 
     /* ------ end of common handle ------ */
     clicon_hash_t           *rh_params;      /* restconf parameters, including http headers */
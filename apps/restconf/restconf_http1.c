@@ -42,6 +42,7 @@
 #include <stdlib.h>
 #include <stdint.h>
 #include <string.h>
+#include <ctype.h>
 #include <inttypes.h>
 #include <syslog.h>
 #include <errno.h>
@@ -64,163 +65,221 @@
 #include "restconf_native.h"
 #include "restconf_api.h"
 #include "restconf_err.h"
-#include "clixon_http1_parse.h"
 #include "restconf_http1.h"
 #include "clixon_http_data.h"
 #include "restconf_stream.h"
 
-/* Size of xml read buffer */
-#define BUFLEN 1024
+/* Max size of HTTP/1 request line and header fields */
+#define HTTP1_HEADER_MAX 65536
 
-/*! HTTP/1 parsing function. Input is string and side-effect is populating connection structs
+/*! HTTP/1 token character according to RFC 7230 Sec 3.2.6
+ */
+static int
+http1_tchar(int c)
+{
+    return isalnum((unsigned char)c) || (c != '\0' && strchr("!#$%&'*+-.^_`|~", c) != NULL);
+}
+
+/*! Percent-encoded character %HH
+ */
+static int
+http1_pct_encoded(char  *s,
+                  size_t len)
+{
+    return len >= 3 && s[0] == '%' &&
+        isxdigit((unsigned char)s[1]) && isxdigit((unsigned char)s[2]);
+}
+
+/*! Number of characters of a path char (pchar) at s, or 0 if not a pchar
+ *
+ * RFC 3986 pchar, if query is set also '/' and '?' which are allowed in query
+ */
+static int
+http1_pchar(char  *s,
+            size_t len,
+            int    query)
+{
+    int c = s[0];
+
+    if (http1_pct_encoded(s, len))
+        return 3;
+    if (isalnum((unsigned char)c) || (c != '\0' && strchr("-._~!$&'()*+,;=:@", c) != NULL))
+        return 1;
+    if (query && (c == '/' || c == '?'))
+        return 1;
+    return 0;
+}
+
+/*! Parse HTTP/1 request line: method SP request-target SP HTTP-version CRLF
  *
- * @param[in]  h        Clixon handle
- * @param[in]  rc       Restconf connection
- * @param[in]  str      Pointer to string containing HTTP/1 
- * @param[in]  filename Debug string identifying file or connection
- * @retval     0        Parse OK 
- * @retval    -1        Error
+ * Slices of the line are null-terminated in place and set as restconf parameters
+ * @param[in]  h     Clixon handle
+ * @param[in]  rc    Restconf connection
+ * @param[in]  sd    Restconf stream
+ * @param[in]  s     Start of request line
+ * @param[in]  end   End of header section
+ * @param[out] next  Start of next line
+ * @retval     0     OK
+ * @retval    -1     Error, malformed request
  */
 static int
-_http1_parse(clixon_handle  h,
-             restconf_conn *rc,
-             char          *str,
-             const char    *filename)
+http1_parse_request_line(clixon_handle         h,
+                         restconf_conn        *rc,
+                         restconf_stream_data *sd,
+                         char                 *s,
+                         char                 *end,
+                         char                **next)
 {
-    int               retval = -1;
-    clixon_http1_yacc hy = {0,};
-    int               ret;
-
-    clixon_debug(CLIXON_DBG_PARSE, "%s", str);
-    if (strlen(str) == 0)
-        goto ok;
-    hy.hy_parse_string = str;
-    hy.hy_name = filename;
-    hy.hy_h = h;
-    hy.hy_rc = rc;
-    hy.hy_linenum = 1;
-    if (http1_scan_init(&hy) < 0)
+    int   retval = -1;
+    char *method;
+    char *path;
+    char *pend;
+    char *query = NULL;
+    char *p;
+    int   n;
+
+    /* method = token */
+    for (p = s; p < end && http1_tchar(*p); p++);
+    if (p == s || p >= end || *p != ' '){
+        clixon_err(OE_RESTCONF, 0, "Invalid method in request line");
         goto done;
-    if (http1_parse_init(&hy) < 0)
+    }
+    method = s;
+    *p++ = '\0';
+    /* request-target = absolute-path [ "?" query ] */
+    if (p >= end || *p != '/'){
+        clixon_err(OE_RESTCONF, 0, "Invalid request-target, expected absolute path");
         goto done;
-    ret = clixon_http1_parseparse(&hy); /* yacc returns 1 on error */
-    /* yacc/lex terminates parsing after headers. 
-     * Look for body after headers assuming str terminating with \n\n\0 and then <body> */
-    http1_parse_exit(&hy);
-    http1_scan_exit(&hy);
-    if (ret != 0){
-        if (filename)
-            clixon_log(h, LOG_NOTICE, "HTTP1 error: on line %d in %s", hy.hy_linenum, filename);
+    }
+    path = p;
+    while (p < end){
+        if (*p == '/')
+            p++;
+        else if ((n = http1_pchar(p, end-p, 0)) > 0)
+            p += n;
         else
-            clixon_log(h, LOG_NOTICE, "HTTP1 error: on line %d", hy.hy_linenum);
-        if (clixon_err_category() == 0)
-            clixon_err(OE_RESTCONF, 0, "HTTP1 parser error with no error code (should not happen)");
+            break;
+    }
+    pend = p;
+    if (p < end && *p == '?'){
+        *p++ = '\0';
+        query = p;
+        while (p < end && (n = http1_pchar(p, end-p, 1)) > 0)
+            p += n;
+    }
+    if (p >= end || *p != ' '){
+        clixon_err(OE_RESTCONF, 0, "Invalid character in request-target");
+        goto done;
+    }
+    *p++ = '\0';
+    /* Remove trailing slash */
+    if (pend-1 > path && *(pend-1) == '/')
+        *(pend-1) = '\0';
+    /* HTTP-version = "HTTP" "/" DIGIT "." DIGIT */
+    if (end - p < 10 ||
+        strncmp(p, "HTTP/", 5) != 0 ||
+        !isdigit((unsigned char)p[5]) || p[6] != '.' || !isdigit((unsigned char)p[7]) ||
+        p[8] != '\r' || p[9] != '\n'){
+        clixon_err(OE_RESTCONF, 0, "Invalid HTTP-version in request line");
         goto done;
     }
- ok:
+    /* make sanity check later */
+    rc->rc_proto_d1 = p[5] - '0';
+    rc->rc_proto_d2 = p[7] - '0';
+    clixon_debug(CLIXON_DBG_RESTCONF, "http/%d.%d", rc->rc_proto_d1, rc->rc_proto_d2);
+    *next = p + 10;
+    if (restconf_param_set(h, "REQUEST_METHOD", method) < 0)
+        goto done;
+    if (restconf_param_set(h, "REQUEST_URI", path) < 0)
+        goto done;
+    if (query && *query != '\0'){
+        clixon_debug(CLIXON_DBG_RESTCONF, "?%s", query);
+        if (uri_str2cvec(query, '&', '=', 1, &sd->sd_qvec) < 0)
+            goto done;
+    }
     retval = 0;
  done:
-    clixon_debug(CLIXON_DBG_PARSE, "retval:%d", retval);
     return retval;
 }
 
-/*! HTTP/1 parsing function from file
+/*! Parse HTTP/1 header fields: *( field-name ":" OWS field-value OWS CRLF ) CRLF
  *
- * @param[in]  h        Clixon handle
- * @param[in]  rc       Restconf connection
- * @param[in]  f        A file descriptor containing HTTP/1 (as ASCII characters)
- * @param[in]  filename Debug string identifying file or connection
- * @retval     0        Parse OK 
- * @retval    -1        Error
+ * Field values are null-terminated in place, with inner whitespace folded to single spaces
+ * @param[in]  h     Clixon handle
+ * @param[in]  s     Start of first header field
+ * @param[in]  end   End of header section, after final CRLF
+ * @retval     0     OK
+ * @retval    -1     Error, malformed request
  */
-int
-clixon_http1_parse_file(clixon_handle  h,
-                        restconf_conn *rc,
-                        FILE          *f,
-                        const char    *filename)
+static int
+http1_parse_header_fields(clixon_handle h,
+                          char         *s,
+                          char         *end)
 {
     int   retval = -1;
-    char  ch;
-    char *buf = NULL;
-    char *ptr;
-    int   buflen = BUFLEN; /* start size */
-    int   len = 0;
-    int   oldbuflen;
-    size_t sz;
-
-    clixon_debug(CLIXON_DBG_RESTCONF, "%s", filename);
-    if (f == NULL){
-        clixon_err(OE_RESTCONF, EINVAL, "f is NULL");
-        goto done;
-    }
-    if ((buf = malloc(buflen)) == NULL){
-        clixon_err(OE_XML, errno, "malloc");
-        goto done;
-    }
-    memset(buf, 0, buflen);
-    ptr = buf;
-    while (1){
-        if ((sz = fread(&ch, 1, 1, f)) == 0){
-            clixon_err(OE_XML, errno, "read");
-            break;
+    char *name;
+    char *value;
+    char *p;
+    char *v;
+
+    p = s;
+    while (p < end && *p != '\r'){
+        /* field-name = token */
+        name = p;
+        for (; p < end && http1_tchar(*p); p++);
+        if (p == name || p >= end || *p != ':'){
+            clixon_err(OE_RESTCONF, 0, "Invalid header field name");
+            goto done;
         }
-        if (sz == 0) { /* buffer read */
-            if (feof(f)){
-                if (_http1_parse(h, rc, ptr, filename) < 0)
-                    goto done;
-                break;
+        *p++ = '\0';
+        /* OWS */
+        while (p < end && (*p == ' ' || *p == '\t'))
+            p++;
+        /* field-value: copy down in place folding whitespace */
+        value = v = p;
+        while (p < end && *p != '\r'){
+            if (*p == ' ' || *p == '\t'){
+                while (p < end && (*p == ' ' || *p == '\t'))
+                    p++;
+                if (p < end && *p != '\r')
+                    *v++ = ' ';
+                continue;
             }
-            else{
-                clixon_err(OE_XML, 0, "fread(%s)", filename);
+            if (iscntrl((unsigned char)*p)){
+                clixon_err(OE_RESTCONF, 0, "Invalid character in header field %s", name);
                 goto done;
             }
+            *v++ = *p++;
         }
-        buf[len++] = ch;
-        if (len >= buflen-1){ /* Space: one for the null character */
-            oldbuflen = buflen;
-            buflen *= 2;
-            if ((buf = realloc(buf, buflen)) == NULL){
-                clixon_err(OE_XML, errno, "realloc");
-                goto done;
-            }
-            memset(buf+oldbuflen, 0, buflen-oldbuflen);
-            ptr = buf;
+        if (p+1 >= end || p[1] != '\n'){
+            clixon_err(OE_RESTCONF, 0, "Expected CRLF after header field %s", name);
+            goto done;
         }
-    } /* while */
+        *v = '\0';
+        p += 2;
+        if (*value != '\0' &&
+            restconf_convert_hdr(h, name, value) < 0)
+            goto done;
+    }
     retval = 0;
  done:
-    if (buf)
-        free(buf);
     return retval;
 }
 
-/*! HTTP/1 parsing function from string
- *
- * @param[in]  h        Clixon handle
- * @param[in]  rc       Restconf connection
- * @param[in]  str      HTTP/1 string
- * @retval     0        Parse OK 
- * @retval    -1        Error
- */
-int
-clixon_http1_parse_string(clixon_handle  h,
-                          restconf_conn *rc,
-                          char          *str)
-{
-    return _http1_parse(h, rc, str, "http1-parse");
-}
-
-/*! HTTP/1 parsing function from buffer (non-null terminated)
+/*! Parse HTTP/1 request incrementally from buffer
  *
- * Convert buffer to null-terminated string
- * @param[in]  h        Clixon handle
- * @param[in]  rc       Restconf connection
- * @param[in]  buf      HTTP/1 buffer
- * @param[in]  n        Length of buffer
- * @retval     0        Parse OK 
- * @retval    -1        Error
- * @note  Had preferred to do this without copying, OR 
- * input flex with a non-null terminated string
+ * The buffer contains the bytes read so far. Nothing is parsed until the request line and
+ * header fields are complete, ie terminated with an empty line, so a request split over
+ * several reads is not re-parsed. Request line and header fields are parsed in place and
+ * set as restconf parameters, remaining bytes are appended to the stream body (sd_indata).
+ * The buffer is modified: slices are null-terminated in place.
+ * @param[in]  h    Clixon handle
+ * @param[in]  rc   Restconf connection
+ * @param[in]  buf  HTTP/1 buffer
+ * @param[in]  n    Length of buffer
+ * @retval     1    OK, request line and headers parsed
+ * @retval     0    Incomplete, read more data
+ * @retval    -1    Error, malformed request, clixon_err set
  */
 int
 clixon_http1_parse_buf(clixon_handle  h,
@@ -228,18 +287,50 @@ clixon_http1_parse_buf(clixon_handle  h,
                        char          *buf,
                        size_t         n)
 {
-    char *str = NULL;
-    int   ret;
+    int                   retval = -1;
+    restconf_stream_data *sd;
+    char                 *end;
+    char                 *s;
+    char                 *p;
 
-    if ((str = malloc(n+1)) == NULL){
-        clixon_err(OE_RESTCONF, errno, "malloc");
-        return -1;
+    clixon_debug(CLIXON_DBG_PARSE, "n:%zu", n);
+    if ((sd = restconf_stream_find(rc, 0)) == NULL){
+        clixon_err(OE_RESTCONF, 0, "stream 0 not found");
+        goto done;
+    }
+    /* Ignore empty lines preceding request-line, RFC 7230 Sec 3.5 */
+    s = buf;
+    while (n - (s-buf) >= 2 && s[0] == '\r' && s[1] == '\n')
+        s += 2;
+    /* Find end of header fields */
+    for (p = s; p + 4 <= buf + n; p++)
+        if (memcmp(p, "\r\n\r\n", 4) == 0)
+            break;
+    if (p + 4 > buf + n){
+        if (n > HTTP1_HEADER_MAX){
+            clixon_err(OE_RESTCONF, 0, "Request header fields too large");
+            goto done;
+        }
+        goto incomplete;
     }
-    memcpy(str, buf, n);
-    str[n] = '\0';
-    ret = _http1_parse(h, rc, str, "http1-parse");
-    free(str);
-    return ret;
+    end = p + 4;
+    if (http1_parse_request_line(h, rc, sd, s, end, &s) < 0)
+        goto done;
+    if (http1_parse_header_fields(h, s, end) < 0)
+        goto done;
+    /* Body: rest of buffer */
+    if (end < buf + n &&
+        cbuf_append_buf(sd->sd_indata, end, buf + n - end) < 0){
+        clixon_err(OE_RESTCONF, errno, "cbuf_append_buf");
+        goto done;
+    }
+    retval = 1;
+ done:
+    clixon_debug(CLIXON_DBG_PARSE, "retval:%d", retval);
+    return retval;
+ incomplete:
+    retval = 0;
+    goto done;
 }
 
 #ifdef HAVE_LIBNGHTTP2
@@ -314,8 +405,9 @@ restconf_http1_reply(restconf_conn        *rc,
      * server MUST NOT send a Content-Length header field in any 2xx
      * (Successful) response to a CONNECT request (Section 4.3.6 of
      * [RFC7231]).
+     * A 304 (Not Modified) has no body, a Content-Length would be that of the 200 reply.
      */
-    if (sd->sd_code != 204 && sd->sd_code > 199 && !rc->rc_event_stream)
+    if (sd->sd_code != 204 && sd->sd_code != 304 && sd->sd_code > 199 && !rc->rc_event_stream)
         if (restconf_reply_header(sd, "Content-Length", "%zu", sd->sd_body_len) < 0)
             goto done;
     /* Create reply and write headers */
@@ -39,8 +39,6 @@
 /*
  * Prototypes
  */
-int clixon_http1_parse_file(clixon_handle h, restconf_conn *rc, FILE *f, const char *filename);
-int clixon_http1_parse_string(clixon_handle h, restconf_conn *rc, char *str);
 int clixon_http1_parse_buf(clixon_handle h, restconf_conn *rc, char *buf, size_t n);
 int restconf_http1_path_root(clixon_handle h, restconf_conn *rc);
 int http1_check_expect(clixon_handle h, restconf_conn *rc, restconf_stream_data *sd);
@@ -44,6 +44,7 @@
 
 #include <stdlib.h>
 #include <string.h>
+#include <strings.h>
 #include <unistd.h>
 #include <errno.h>
 #include <signal.h>
@@ -309,6 +310,54 @@ restconf_media_in_list(const char *media,
     return retval;
 }
 
+/*! Check if content-coding is accepted in an Accept-Encoding list
+ *
+ * Example: encoding="gzip";
+ *          list="deflate, gzip;q=0.5, br"
+ * Returns: 1
+ * A coding is not accepted if its quality value is zero, eg "gzip;q=0".
+ * "*" matches any coding.
+ * @param[in]  encoding  Single content-coding, eg gzip
+ * @param[in]  list      Comma-separated list of codings with optional quality values
+ * @retval     1         Accepted
+ * @retval     0         Not accepted
+ */
+int
+restconf_encoding_in_list(const char *encoding,
+                          const char *list)
+{
+    const char *p;
+    const char *t;
+    size_t      len;
+    size_t      elen = strlen(encoding);
+    int         match;
+
+    p = list;
+    while (*p != '\0'){
+        while (*p == ' ' || *p == '\t' || *p == ',')
+            p++;
+        t = p;
+        while (*p != '\0' && *p != ',' && *p != ';' && *p != ' ' && *p != '\t')
+            p++;
+        len = p - t;
+        match = (len == elen && strncasecmp(t, encoding, len) == 0) ||
+            (len == 1 && *t == '*');
+        /* Parameters, only q is of interest */
+        while (*p != '\0' && *p != ','){
+            if (*p == 'q' && *(p+1) == '='){
+                p += 2;
+                if (match && strtod(p, NULL) == 0.0)
+                    match = 0;
+            }
+            else
+                p++;
+        }
+        if (match && len > 0)
+            return 1;
+    }
+    return 0;
+}
+
 const char *
 restconf_media_int2str(restconf_media media)
 {
@@ -446,10 +495,14 @@ restconf_terminate(clixon_handle h)
     if ((x = clicon_conf_xml(h)) != NULL)
         xml_free(x);
     xpath_optimize_exit();
+    xpath_parse_cache_exit();
+    api_path_cache_exit();
+    regex_cache_exit();
     clixon_err_exit();
     clixon_debug(CLIXON_DBG_RESTCONF, "pid:%u done", getpid());
     clixon_debug_exit();
     restconf_handle_exit(h);
+    xml_exit();
     clixon_log_exit(); /* Must be after last clixon_debug */
     return 0;
 }
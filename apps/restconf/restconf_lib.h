@@ -86,6 +86,7 @@ int restconf_err2code(const char *tag);
 const char *restconf_code2reason(int code);
 const restconf_media restconf_media_str2int(const char *media);
 int   restconf_media_in_list(const char *media, const char *list);
+int   restconf_encoding_in_list(const char *encoding, const char *list);
 const restconf_media restconf_media_list_str2int(const char *list);
 const char *restconf_media_int2str(restconf_media media);
 int   restconf_str2proto(const char *str);
@@ -259,6 +259,138 @@ restconf_sig_child(int arg)
         stream_child_free(_CLIXON_HANDLE, pid);
 }
 
+/*! Init a forked fcgi worker process
+ *
+ * The worker inherits the fcgi socket of the supervisor, but opens its own persistent
+ * session to the backend, which is reused by all requests of the worker.
+ * @param[in]  h    Clixon handle
+ * @retval     0    OK
+ * @retval    -1    Error
+ * @see fcgi_workers_supervise
+ */
+static int
+fcgi_worker_init(clixon_handle h)
+{
+    int      retval = -1;
+    uint32_t id = 0;
+
+    if (set_signal(SIGTERM, restconf_sig_term, NULL) < 0 ||
+        set_signal(SIGINT, restconf_sig_term, NULL) < 0 ||
+        set_signal(SIGCHLD, restconf_sig_child, NULL) < 0){
+        clixon_err(OE_DAEMON, errno, "Setting signal");
+        goto done;
+    }
+    if (clicon_hello_req(h, "cl:restconf", NULL, &id) < 0)
+        goto done;
+    clicon_session_id_set(h, id);
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Fork fcgi worker processes and supervise them
+ *
+ * All workers accept requests on the fcgi socket opened by the supervisor, so that
+ * the reverse proxy may have as many requests in progress as there are workers.
+ * A worker that terminates abnormally is restarted, a worker that exits normally is not.
+ * On SIGTERM, the supervisor terminates the workers and returns.
+ * @param[in]  h       Clixon handle
+ * @param[in]  nr      Number of workers
+ * @param[out] worker  Set to 1 in a worker process, which continues to the accept loop
+ * @retval     0       OK
+ * @retval    -1       Error
+ * @see CLICON_RESTCONF_WORKERS
+ * @see restconf_workers_supervise in restconf_main_native.c
+ */
+static int
+fcgi_workers_supervise(clixon_handle h,
+                       int           nr,
+                       int          *worker)
+{
+    int    retval = -1;
+    pid_t *pids = NULL;
+    pid_t  pid;
+    int    status;
+    int    alive = 0;
+    int    i;
+    int    s;
+
+    if ((pids = calloc(nr, sizeof(pid_t))) == NULL){
+        clixon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    /* Workers open their own backend sessions */
+    if ((s = clicon_client_socket_get(h)) >= 0){
+        close(s);
+        clicon_client_socket_set(h, -1);
+    }
+    clicon_session_id_del(h);
+    /* Without SA_RESTART so that a signal interrupts waitpid.
+     * Workers are reaped here, not by the stream child handler */
+    if (set_signal_flags(SIGTERM, 0, restconf_sig_term, NULL) < 0 ||
+        set_signal_flags(SIGINT, 0, restconf_sig_term, NULL) < 0 ||
+        set_signal(SIGCHLD, SIG_DFL, NULL) < 0)
+        goto done;
+    while (!clixon_exit_get()){
+        /* Start workers that are not running */
+        for (i=0; i<nr; i++){
+            if (pids[i] != 0)
+                continue;
+            if ((pid = fork()) < 0){
+                clixon_err(OE_UNIX, errno, "fork");
+                goto done;
+            }
+            if (pid == 0){ /* Worker */
+                free(pids);
+                pids = NULL;
+                if (fcgi_worker_init(h) < 0)
+                    goto done;
+                *worker = 1;
+                retval = 0;
+                goto done;
+            }
+            clixon_debug(CLIXON_DBG_RESTCONF, "worker %d pid:%d", i, (int)pid);
+            pids[i] = pid;
+            alive++;
+        }
+        if ((pid = waitpid(-1, &status, 0)) < 0){
+            if (errno == EINTR)
+                continue;
+            clixon_err(OE_UNIX, errno, "waitpid");
+            goto done;
+        }
+        for (i=0; i<nr; i++)
+            if (pids[i] == pid)
+                break;
+        if (i == nr)
+            continue;
+        alive--;
+        if (WIFEXITED(status) && WEXITSTATUS(status) == 0){
+            pids[i] = -1;
+            if (alive == 0)
+                break;
+        }
+        else {
+            clixon_log(h, LOG_WARNING, "%s: worker %d pid:%d terminated with status %d, restarting",
+                       __PROGRAM__, i, (int)pid, status);
+            pids[i] = 0;
+            sleep(1); /* Eg backend not reachable: do not restart at once */
+        }
+    }
+    retval = 0;
+ done:
+    if (pids){
+        for (i=0; i<nr; i++)
+            if (pids[i] > 0)
+                kill(pids[i], SIGTERM);
+        for (i=0; i<nr; i++)
+            if (pids[i] > 0)
+                waitpid(pids[i], NULL, 0);
+        free(pids);
+    }
+    return retval;
+}
+
 /*! Usage help routine
  *
  * @param[in]  h      Clixon handle
@@ -328,6 +460,8 @@ main(int    argc,
     int              config_dump = 0;
     enum format_enum config_dump_format = FORMAT_XML;
     int              print_version = 0;
+    int              nr;
+    int              worker = 0;
     int              stream_timeout = 0;
     int32_t          d;
 
@@ -645,7 +779,12 @@ main(int    argc,
      * @see clicon_hello_req
      */
     clicon_data_set(h, "session-transport", "cl:restconf");
-
+    if ((nr = clicon_option_int(h, "CLICON_RESTCONF_WORKERS")) > 0){
+        if (fcgi_workers_supervise(h, nr, &worker) < 0)
+            goto done;
+        if (!worker) /* Supervisor */
+            goto ok;
+    }
     if (FCGX_InitRequest(req, sock, 0) != 0){
         clixon_err(OE_CFG, errno, "FCGX_InitRequest");
         goto done;
@@ -125,6 +125,7 @@
 #include <ctype.h>
 #include <signal.h>
 #include <sys/stat.h>
+#include <sys/wait.h>
 #include <sys/socket.h>
 #include <arpa/inet.h>
 #include <sys/resource.h>
@@ -151,6 +152,7 @@
 #include "restconf_err.h"
 #include "restconf_root.h"
 #include "restconf_native.h"   /* Restconf-openssl mode specific headers*/
+#include "clixon_http_data.h"
 #ifdef HAVE_LIBNGHTTP2
 #include "restconf_nghttp2.h"  /* http/2 */
 #endif
@@ -181,6 +183,12 @@
 /* Cert verify depth: dont know what to set here? */
 #define VERIFY_DEPTH 5
 
+/* Max number of TLS sessions in server session cache */
+#define SSL_SESSION_CACHE_SIZE 1024
+
+/* Lifetime of TLS sessions and tickets for resumption in seconds */
+#define SSL_SESSION_TIMEOUT 300
+
 static int             session_id_context = 1;
 
 /*! Set restconf native handle
@@ -433,7 +441,14 @@ restconf_ssl_context_configure(clixon_handle h,
 
     SSL_CTX_set_session_id_context(ctx, (void *)&session_id_context, sizeof(session_id_context));
     SSL_CTX_set_app_data(ctx, h);
-    SSL_CTX_set_session_cache_mode(ctx, 0);
+    /* Server-side session cache and stateless session tickets for TLS session resumption.
+     * Ticket keys are created with the context before workers are forked, so a session
+     * resumes on any worker, see CLICON_RESTCONF_WORKERS.
+     * TLS 1.3 early data (0-RTT) is not enabled since it may be replayed.
+     */
+    SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_SERVER);
+    SSL_CTX_sess_set_cache_size(ctx, SSL_SESSION_CACHE_SIZE);
+    SSL_CTX_set_timeout(ctx, SSL_SESSION_TIMEOUT);
 
     /* Set the key and cert */
     if (SSL_CTX_use_certificate_chain_file(ctx, server_cert_path) != 1) {
@@ -548,6 +563,11 @@ restconf_accept_client(int   fd,
     h = rsock->rs_h;
     len = sizeof(from);
     if ((s = accept(rsock->rs_ss, &from, &len)) < 0){
+        /* Listen socket shared by workers: another worker accepted the client */
+        if (errno == EAGAIN || errno == EWOULDBLOCK){
+            retval = 0;
+            goto done;
+        }
         clixon_err(OE_UNIX, errno, "accept");
         goto done;
     }
@@ -638,6 +658,7 @@ restconf_native_terminate(clixon_handle h)
             SSL_CTX_free(rn->rn_ctx);
         free(rn);
     }
+    clicon_rpc_async_exit(h);
     EVP_cleanup();
     return 0;
 }
@@ -1131,6 +1152,146 @@ restconf_sig_term(int arg)
     clixon_exit_set(1);
 }
 
+/*! Init a forked restconf worker process
+ *
+ * The worker inherits the listen sockets and openssl context of the supervisor, but opens
+ * its own session to the backend.
+ * Only the first worker makes callhome connections.
+ * @param[in]  h    Clixon handle
+ * @param[in]  i    Worker index
+ * @retval     0    OK
+ * @retval    -1    Error
+ * @see restconf_workers_supervise
+ */
+static int
+restconf_worker_init(clixon_handle h,
+                     int           i)
+{
+    int                     retval = -1;
+    restconf_native_handle *rn;
+    restconf_socket        *rsock;
+    uint32_t                id = 0;
+
+    if (set_signal(SIGTERM, restconf_sig_term, NULL) < 0 ||
+        set_signal(SIGINT, restconf_sig_term, NULL) < 0){
+        clixon_err(OE_DAEMON, errno, "Setting signal");
+        goto done;
+    }
+    if (i > 0 &&
+        (rn = restconf_native_handle_get(h)) != NULL &&
+        (rsock = rn->rn_sockets) != NULL){
+        do {
+            if (rsock->rs_callhome)
+                restconf_callhome_timer_unreg(rsock);
+            rsock = NEXTQ(restconf_socket *, rsock);
+        } while (rsock && rsock != rn->rn_sockets);
+    }
+    if (clicon_hello_req(h, "cl:restconf", NULL, &id) < 0)
+        goto done;
+    clicon_session_id_set(h, id);
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Fork restconf worker processes and supervise them
+ *
+ * All workers accept clients on the listen sockets opened by the supervisor.
+ * A worker that terminates abnormally is restarted, a worker that exits normally is not.
+ * On SIGTERM, the supervisor terminates the workers and returns.
+ * @param[in]  h       Clixon handle
+ * @param[in]  nr      Number of workers
+ * @param[out] worker  Set to 1 in a worker process, which continues to the event loop
+ * @retval     0       OK
+ * @retval    -1       Error
+ * @see CLICON_RESTCONF_WORKERS
+ */
+static int
+restconf_workers_supervise(clixon_handle h,
+                           int           nr,
+                           int          *worker)
+{
+    int    retval = -1;
+    pid_t *pids = NULL;
+    pid_t  pid;
+    int    status;
+    int    alive = 0;
+    int    i;
+    int    s;
+
+    if ((pids = calloc(nr, sizeof(pid_t))) == NULL){
+        clixon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    /* Workers open their own backend sessions */
+    if ((s = clicon_client_socket_get(h)) >= 0){
+        close(s);
+        clicon_client_socket_set(h, -1);
+    }
+    /* Without SA_RESTART so that a signal interrupts waitpid */
+    if (set_signal_flags(SIGTERM, 0, restconf_sig_term, NULL) < 0 ||
+        set_signal_flags(SIGINT, 0, restconf_sig_term, NULL) < 0)
+        goto done;
+    while (!clixon_exit_get()){
+        /* Start workers that are not running */
+        for (i=0; i<nr; i++){
+            if (pids[i] != 0)
+                continue;
+            if ((pid = fork()) < 0){
+                clixon_err(OE_UNIX, errno, "fork");
+                goto done;
+            }
+            if (pid == 0){ /* Worker */
+                free(pids);
+                pids = NULL;
+                if (restconf_worker_init(h, i) < 0)
+                    goto done;
+                *worker = 1;
+                retval = 0;
+                goto done;
+            }
+            clixon_debug(CLIXON_DBG_RESTCONF, "worker %d pid:%d", i, (int)pid);
+            pids[i] = pid;
+            alive++;
+        }
+        if ((pid = waitpid(-1, &status, 0)) < 0){
+            if (errno == EINTR)
+                continue;
+            clixon_err(OE_UNIX, errno, "waitpid");
+            goto done;
+        }
+        for (i=0; i<nr; i++)
+            if (pids[i] == pid)
+                break;
+        if (i == nr)
+            continue;
+        alive--;
+        if (WIFEXITED(status) && WEXITSTATUS(status) == 0){
+            pids[i] = -1; /* Eg stream timeout, do not restart */
+            if (alive == 0)
+                break;
+        }
+        else {
+            clixon_log(h, LOG_WARNING, "%s: worker %d pid:%d terminated with status %d, restarting",
+                       __PROGRAM__, i, (int)pid, status);
+            pids[i] = 0;
+            sleep(1); /* Eg backend not reachable: do not restart at once */
+        }
+    }
+    retval = 0;
+ done:
+    if (pids){
+        for (i=0; i<nr; i++)
+            if (pids[i] > 0)
+                kill(pids[i], SIGTERM);
+        for (i=0; i<nr; i++)
+            if (pids[i] > 0)
+                waitpid(pids[i], NULL, 0);
+        free(pids);
+    }
+    return retval;
+}
+
 /*! Usage help routine
  *
  * @param[in]  argv0  command line
@@ -1187,6 +1348,8 @@ main(int    argc,
     int                     print_version = 0;
     int                     stream_timeout = 0;
     int32_t                 d;
+    int                     nr;
+    int                     worker = 0;
     int                     ret;
 
     /* Create handle */
@@ -1409,6 +1572,12 @@ main(int    argc,
      * @see clicon_hello_req
      */
     clicon_data_set(h, "session-transport", "cl:restconf");
+    if ((nr = clicon_option_int(h, "CLICON_RESTCONF_WORKERS")) > 0){
+        if (restconf_workers_supervise(h, nr, &worker) < 0)
+            goto done;
+        if (!worker) /* Supervisor */
+            goto ok;
+    }
     clixon_log(h, LOG_NOTICE, "%s: %u Started", __PROGRAM__, getpid());
     /* Main event loop */
     if (clixon_event_loop(h) < 0)
@@ -1423,6 +1592,7 @@ main(int    argc,
         clixon_log_init(h, __PROGRAM__, LOG_INFO, 0); /* Log on syslog no stderr */
         clixon_log(h, LOG_NOTICE, "%s: %u Terminated", __PROGRAM__, getpid());
         restconf_native_terminate(h);
+        api_http_data_cache_free();
         restconf_terminate(h);
     }
     return retval;
@@ -40,6 +40,7 @@
 #endif
 #include <stdlib.h>
 #include <string.h>
+#include <inttypes.h>
 #include <unistd.h>
 #include <errno.h>
 #include <signal.h>
@@ -66,6 +67,477 @@
 /* Forward */
 static int api_data_pagination(clixon_handle h, void *req, char *api_path, int pi, cvec *qvec, int pretty, restconf_media media_out);
 
+/*! Context of a GET request waiting for its backend reply
+ *
+ * @see api_data_get_async_cb
+ */
+struct get_async {
+    void           *ga_req;       /* Generic Www handle */
+    char           *ga_xpath;     /* XPath of requested data */
+    cvec           *ga_nsc;       /* Namespace context of xpath */
+    int             ga_pretty;    /* Pretty-printed output */
+    restconf_media  ga_media_out; /* Output media */
+};
+
+/*! Send reply of a GET request
+ *
+ * @param[in]  req       Generic Www handle
+ * @param[in]  cbx       Reply body, consumed
+ * @param[in]  media_out Output media
+ * @param[in]  head      If 1 is HEAD, otherwise GET
+ * @retval     0         OK
+ * @retval    -1         Error
+ */
+static int
+api_data_get_send(void          *req,
+                  cbuf          *cbx,
+                  restconf_media media_out,
+                  int            head)
+{
+    int retval = -1;
+
+    if (restconf_reply_header(req, "Content-Type", "%s", restconf_media_int2str(media_out)) < 0)
+        goto done;
+    if (restconf_reply_header(req, "Cache-Control", "no-cache") < 0)
+        goto done;
+    if (restconf_reply_send(req, 200, cbx, head) < 0)
+        goto done;
+    cbx = NULL;
+    retval = 0;
+ done:
+    if (cbx)
+        cbuf_free(cbx);
+    return retval;
+}
+
+/*! Send 404 reply of a GET request of a non-existing instance
+ *
+ * @param[in]  h         Clixon handle
+ * @param[in]  req       Generic Www handle
+ * @param[in]  pretty    Set to 1 for pretty-printed xml/json output
+ * @param[in]  media_out Output media
+ * @retval     0         OK
+ * @retval    -1         Error
+ */
+static int
+api_data_get_notfound(clixon_handle  h,
+                      void          *req,
+                      int            pretty,
+                      restconf_media media_out)
+{
+    int    retval = -1;
+    cxobj *xerr = NULL;
+
+    /* 4.3: If a retrieval request for a data resource represents an
+       instance that does not exist, then an error response containing
+       a "404 Not Found" status-line MUST be returned by the server.
+       The error-tag value "invalid-value" is used in this case. */
+    if (netconf_invalid_value_xml(&xerr, "application", "Instance does not exist") < 0)
+        goto done;
+    /* override invalid-value default 400 with 404 */
+    if (api_return_err0(h, req, xerr, pretty, media_out, 404) < 0)
+        goto done;
+    retval = 0;
+ done:
+    if (xerr)
+        xml_free(xerr);
+    return retval;
+}
+
+/*! Reply to a GET request given data from backend
+ *
+ * @param[in]  h         Clixon handle
+ * @param[in]  req       Generic Www handle
+ * @param[in]  xret      Data or rpc-error from backend
+ * @param[in]  xpath     XPath of requested data
+ * @param[in]  nsc       Namespace context of xpath
+ * @param[in]  pretty    Set to 1 for pretty-printed xml/json output
+ * @param[in]  media_out Output media
+ * @param[in]  head      If 1 is HEAD, otherwise GET
+ * @retval     0         OK
+ * @retval    -1         Error
+ */
+static int
+api_data_get_reply(clixon_handle  h,
+                   void          *req,
+                   cxobj         *xret,
+                   char          *xpath,
+                   cvec          *nsc,
+                   int            pretty,
+                   restconf_media media_out,
+                   int            head)
+{
+    int        retval = -1;
+    cbuf      *cbx = NULL;
+    cxobj     *xerr = NULL; /* malloced */
+    cxobj     *xe = NULL;   /* not malloced */
+    cxobj    **xvec = NULL;
+    size_t     xlen;
+    int        i;
+    cxobj     *x;
+    cvec      *nscd = NULL;
+    int        ret;
+
+    /* We get return via netconf which is complete tree from root
+     * We need to cut that tree to only the object.
+     */
+#if 0 /* DEBUG */
+    if (clixon_debug_get())
+        clixon_debug_xml(CLIXON_DBG_RESTCONF, xret, "xret:");
+#endif
+    /* Check if error return  */
+    if ((xe = xpath_first(xret, NULL, "//rpc-error")) != NULL){
+        if (api_return_err(h, req, xe, pretty, media_out, 0) < 0)
+            goto done;
+        goto ok;
+    }
+    /* Normal return, no error */
+    if ((cbx = cbuf_new()) == NULL){
+        clixon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    if (xpath==NULL || strcmp(xpath,"/")==0){ /* Special case: data root */
+        switch (media_out){
+        case YANG_DATA_XML:
+            if (clixon_xml2cbuf(cbx, xret, 0, pretty, NULL, -1, 0) < 0) /* Dont print top object?  */
+                goto done;
+            break;
+        case YANG_DATA_JSON:
+            if (clixon_json2cbuf(cbx, xret, pretty, 0, 0, 0) < 0)
+                goto done;
+            break;
+        default:
+            break;
+        }
+    }
+    else{
+        if (xpath_vec(xret, nsc, "%s", &xvec, &xlen, xpath) < 0){
+            if (netconf_operation_failed_xml(&xerr, "application", clixon_err_reason()) < 0)
+                goto done;
+            if (api_return_err0(h, req, xerr, pretty, media_out, 0) < 0)
+                goto done;
+            goto ok;
+        }
+        /* Check if not exists */
+        if (xlen == 0){
+            if (api_data_get_notfound(h, req, pretty, media_out) < 0)
+                goto done;
+            goto ok;
+        }
+        switch (media_out){
+        case YANG_DATA_XML:
+            for (i=0; i<xlen; i++){
+                x = xvec[i];
+                if (xml_nsctx_node(x, &nscd) < 0)
+                    goto done;
+                if (xmlns_set_all(x, nscd) < 0)
+                    goto done;
+                if (nscd){
+                    cvec_free(nscd);
+                    nscd = NULL;
+                }
+                if (clixon_xml2cbuf(cbx, x, 0, pretty, NULL, -1, 0) < 0) /* Dont print top object?  */
+                    goto done;
+            }
+            break;
+        case YANG_DATA_JSON:
+            /* In: <x xmlns="urn:example:clixon">0</x>
+             * Out: {"example:x": {"0"}}
+             */
+            if (xml2json_cbuf_vec(cbx, xvec, xlen, pretty, 0) < 0)
+                goto done;
+            break;
+        default:
+            break;
+        }
+    }
+    clixon_debug(CLIXON_DBG_RESTCONF, "cbuf:%s", cbuf_get(cbx));
+    ret = api_data_get_send(req, cbx, media_out, head);
+    cbx = NULL; /* consumed */
+    if (ret < 0)
+        goto done;
+ ok:
+    retval = 0;
+ done:
+    if (nscd)
+        cvec_free(nscd);
+    if (cbx)
+        cbuf_free(cbx);
+    if (xerr)
+        xml_free(xerr);
+    if (xvec)
+        free(xvec);
+    return retval;
+}
+
+/*! Parse HTTP-date in IMF-fixdate format, eg "Sun, 06 Nov 1994 08:49:37 GMT"
+ *
+ * @param[in]  str   HTTP-date string
+ * @param[out] t     Time in seconds since epoch
+ * @retval     1     OK
+ * @retval     0     Invalid or obsolete format
+ * @see RFC 9110 Sec 5.6.7
+ */
+static int
+api_data_httpdate_parse(char   *str,
+                        time_t *t)
+{
+    const char *months = "JanFebMarAprMayJunJulAugSepOctNovDec";
+    struct tm   tm = {0,};
+    char        mon[4];
+    char       *m;
+
+    if (sscanf(str, "%*3s, %2d %3s %4d %2d:%2d:%2d GMT",
+               &tm.tm_mday, mon, &tm.tm_year, &tm.tm_hour, &tm.tm_min, &tm.tm_sec) != 6)
+        return 0;
+    if (strlen(mon) != 3 || (m = strstr(months, mon)) == NULL || (m - months) % 3 != 0)
+        return 0;
+    tm.tm_mon = (m - months) / 3;
+    tm.tm_year -= 1900;
+    if ((*t = timegm(&tm)) == (time_t)-1)
+        return 0;
+    return 1;
+}
+
+/*! Check if an entity-tag matches an If-None-Match field value
+ *
+ * Weak comparison, ie W/ prefixes are ignored, RFC 9110 Sec 13.1.2
+ * @param[in]  etag   Entity-tag of resource, quoted
+ * @param[in]  inm    If-None-Match field value, comma-separated entity-tags
+ * @retval     1      Match
+ * @retval     0      No match
+ * @note "*" does not match since existence of the resource is not known without reading it
+ */
+static int
+api_data_etag_match(char *etag,
+                    char *inm)
+{
+    size_t len = strlen(etag);
+    char  *s = inm;
+
+    while (*s != '\0'){
+        while (*s == ' ' || *s == '\t' || *s == ',')
+            s++;
+        if (strncmp(s, "W/", 2) == 0)
+            s += 2;
+        if (strncmp(s, etag, len) == 0 &&
+            (s[len] == '\0' || s[len] == ',' || s[len] == ' ' || s[len] == '\t'))
+            return 1;
+        while (*s != '\0' && *s != ',')
+            s++;
+    }
+    return 0;
+}
+
+/*! Conditional GET of configuration data using the generation of running
+ *
+ * The entity-tag consists of the generation and its time, which makes it unique also if the
+ * backend is restarted, and a hash of the representation: media, pretty, depth,
+ * with-defaults and user (NACM). Last-Modified is the time of the generation.
+ * Only the generation is read from the backend, no data.
+ * @param[in]  h         Clixon handle
+ * @param[in]  req       Generic Www handle
+ * @param[in]  pretty    Set to 1 for pretty-printed xml/json output
+ * @param[in]  media_out Output media
+ * @param[in]  depth     Depth attribute, -1 is unbounded
+ * @param[in]  defaults  With-defaults attribute or NULL
+ * @param[in]  head      If 1 is HEAD, otherwise GET
+ * @retval     1         Not modified, 304 reply is sent
+ * @retval     0         Modified, ETag and Last-Modified header fields are added
+ * @retval    -1         Error
+ * @see CLICON_RESTCONF_ETAG
+ */
+static int
+api_data_get_conditional(clixon_handle  h,
+                         void          *req,
+                         int            pretty,
+                         restconf_media media_out,
+                         int32_t        depth,
+                         char          *defaults,
+                         int            head)
+{
+    int            retval = -1;
+    uint64_t       gen;
+    struct timeval tv;
+    cbuf          *cb = NULL;
+    char          *str;
+    char          *s;
+    uint32_t       hash = 2166136261u; /* FNV-1a */
+    struct tm      tm;
+    char           datestr[64];
+    time_t         ims;
+
+    if (clicon_rpc_generation(h, "running", &gen, &tv) < 0)
+        goto done;
+    if ((cb = cbuf_new()) == NULL){
+        clixon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    /* Representation of the resource */
+    cprintf(cb, "%d/%d/%d/%s/%s", media_out, pretty, depth,
+            defaults?defaults:"", clicon_username_get(h)?clicon_username_get(h):"");
+    for (s = cbuf_get(cb); *s != '\0'; s++){
+        hash ^= (uint8_t)*s;
+        hash *= 16777619u;
+    }
+    cbuf_reset(cb);
+    cprintf(cb, "\"%" PRIx64 "-%lx.%lx-%08x\"", gen,
+            (unsigned long)tv.tv_sec, (unsigned long)tv.tv_usec, hash);
+    if (restconf_reply_header(req, "ETag", "%s", cbuf_get(cb)) < 0)
+        goto done;
+    /* If-Modified-Since is ignored if If-None-Match is present, RFC 9110 Sec 13.1.3 */
+    if ((str = restconf_param_get(h, "HTTP_IF_NONE_MATCH")) != NULL){
+        if (api_data_etag_match(cbuf_get(cb), str))
+            goto notmodified;
+    }
+    else if ((str = restconf_param_get(h, "HTTP_IF_MODIFIED_SINCE")) != NULL &&
+             api_data_httpdate_parse(str, &ims) == 1 &&
+             tv.tv_sec <= ims)
+        goto notmodified;
+    gmtime_r(&tv.tv_sec, &tm);
+    strftime(datestr, sizeof(datestr), "%a, %d %b %Y %H:%M:%S GMT", &tm);
+    if (restconf_reply_header(req, "Last-Modified", "%s", datestr) < 0)
+        goto done;
+    retval = 0;
+ done:
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+ notmodified:
+    clixon_debug(CLIXON_DBG_RESTCONF, "not modified: %s", cbuf_get(cb));
+    if (restconf_reply_send(req, 304, NULL, head) < 0)
+        goto done;
+    retval = 1;
+    goto done;
+}
+
+/*! Free context of a GET request waiting for its backend reply
+ *
+ * @param[in]  ga   GET request context
+ */
+static void
+api_data_get_async_free(struct get_async *ga)
+{
+    if (ga->ga_xpath)
+        free(ga->ga_xpath);
+    if (ga->ga_nsc)
+        xml_nsctx_free(ga->ga_nsc);
+    free(ga);
+}
+
+/*! Backend reply callback of a deferred GET request, reply to the request
+ *
+ * @param[in]  h     Clixon handle
+ * @param[in]  xret  Reply from backend, or NULL if connection lost or request closed
+ * @param[in]  arg   GET request context, freed here
+ * @retval     0     OK
+ * @retval    -1     Error
+ * @see clixon_rpc_get_async
+ */
+static int
+api_data_get_async_cb(clixon_handle h,
+                      cxobj        *xret,
+                      void         *arg)
+{
+    int               retval = -1;
+    struct get_async *ga = (struct get_async *)arg;
+    cxobj            *xt = NULL;
+    cxobj            *xerr = NULL;
+
+    clixon_debug(CLIXON_DBG_RESTCONF, "");
+    if (!restconf_reply_deferred(ga->ga_req)) /* Request closed */
+        goto ok;
+    if (xret == NULL){ /* Backend connection lost */
+        if (netconf_operation_failed_xml(&xerr, "protocol", clixon_err_reason()) < 0)
+            goto done;
+        if (api_return_err0(h, ga->ga_req, xerr, ga->ga_pretty, ga->ga_media_out, 0) < 0)
+            goto done;
+    }
+    else {
+        if (clixon_rpc_get_reply(h, xret, YB_MODULE, &xt) < 0)
+            goto done;
+        if (api_data_get_reply(h, ga->ga_req, xt, ga->ga_xpath, ga->ga_nsc,
+                               ga->ga_pretty, ga->ga_media_out, 0) < 0)
+            goto done;
+    }
+    if (restconf_reply_resume(ga->ga_req) < 0)
+        goto done;
+ ok:
+    retval = 0;
+ done:
+    clixon_debug(CLIXON_DBG_RESTCONF, "retval:%d", retval);
+    if (xt)
+        xml_free(xt);
+    if (xerr)
+        xml_free(xerr);
+    api_data_get_async_free(ga);
+    return retval;
+}
+
+/*! Send GET request to backend and defer reply until backend replies, if possible
+ *
+ * The process then serves other requests, eg other http/2 streams, while the backend
+ * serves the request.
+ * @param[in]  h         Clixon handle
+ * @param[in]  req       Generic Www handle
+ * @param[in]  xpath     XPath of requested data
+ * @param[in]  nsc       Namespace context of xpath
+ * @param[in]  content   Config and/or state data
+ * @param[in]  depth     Nr of levels to get, -1 is all
+ * @param[in]  defaults  Value of with-defaults, or NULL
+ * @param[in]  pretty    Set to 1 for pretty-printed xml/json output
+ * @param[in]  media_out Output media
+ * @retval     1         Deferred, reply is sent by api_data_get_async_cb
+ * @retval     0         Not deferred, get synchronously
+ * @retval    -1         Error
+ */
+static int
+api_data_get_async(clixon_handle   h,
+                   void           *req,
+                   char           *xpath,
+                   cvec           *nsc,
+                   netconf_content content,
+                   int32_t         depth,
+                   char           *defaults,
+                   int             pretty,
+                   restconf_media  media_out)
+{
+    int               retval = -1;
+    struct get_async *ga = NULL;
+
+    if ((ga = calloc(1, sizeof(*ga))) == NULL){
+        clixon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    ga->ga_req = req;
+    ga->ga_pretty = pretty;
+    ga->ga_media_out = media_out;
+    if (xpath && (ga->ga_xpath = strdup(xpath)) == NULL){
+        clixon_err(OE_UNIX, errno, "strdup");
+        goto done;
+    }
+    if (nsc && (ga->ga_nsc = cvec_dup(nsc)) == NULL){
+        clixon_err(OE_UNIX, errno, "cvec_dup");
+        goto done;
+    }
+    if (restconf_reply_defer(req, ga) == 0)
+        goto fail;
+    if (clixon_rpc_get_async(h, xpath, nsc, content, depth, defaults,
+                             api_data_get_async_cb, ga) < 0){
+        restconf_reply_defer(req, NULL);
+        goto fail;
+    }
+    ga = NULL; /* Freed by callback */
+    retval = 1;
+ done:
+    if (ga)
+        api_data_get_async_free(ga);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
 /*! Generic GET (both HEAD and GET)
  *
  * According to restconf
@@ -113,11 +585,7 @@ api_data_get2(clixon_handle  h,
     yang_stmt *yspec;
     cxobj     *xret = NULL;
     cxobj     *xerr = NULL; /* malloced */
-    cxobj     *xe = NULL;   /* not malloced */
-    cxobj    **xvec = NULL;
-    size_t     xlen;
     int        i;
-    cxobj     *x;
     cvec      *nsc = NULL;
     char      *attr; /* attribute value string */
     netconf_content content = CONTENT_ALL;
@@ -125,7 +593,7 @@ api_data_get2(clixon_handle  h,
     cxobj     *xtop = NULL;
     yang_stmt *y = NULL;
     char      *defaults = NULL;
-    cvec      *nscd = NULL;
+    uint32_t   count;
     int        ret;
 
     clixon_debug(CLIXON_DBG_RESTCONF, "");
@@ -209,109 +677,65 @@ api_data_get2(clixon_handle  h,
     }
 
     clixon_debug(CLIXON_DBG_RESTCONF, "path:%s", xpath);
-    if ((ret = clicon_rpc_get(h, xpath, nsc, content, depth, defaults, &xret)) < 0){
-        if (netconf_operation_failed_xml(&xerr, "protocol", clixon_err_reason()) < 0)
-            goto done;
-        if (api_return_err0(h, req, xerr, pretty, media_out, 0) < 0)
-            goto done;
-        goto ok;
-    }
-    /* We get return via netconf which is complete tree from root
-     * We need to cut that tree to only the object.
-     */
-#if 0 /* DEBUG */
-    if (clixon_debug_get())
-        clixon_debug_xml(CLIXON_DBG_RESTCONF, xret, "xret:");
-#endif
-    /* Check if error return  */
-    if ((xe = xpath_first(xret, NULL, "//rpc-error")) != NULL){
-        if (api_return_err(h, req, xe, pretty, media_out, 0) < 0)
-            goto done;
-        goto ok;
-    }
-    /* Normal return, no error */
-    if ((cbx = cbuf_new()) == NULL){
-        clixon_err(OE_UNIX, errno, "cbuf_new");
-        goto done;
-    }
-    if (xpath==NULL || strcmp(xpath,"/")==0){ /* Special case: data root */
-        switch (media_out){
-        case YANG_DATA_XML:
-            if (clixon_xml2cbuf(cbx, xret, 0, pretty, NULL, -1, 0) < 0) /* Dont print top object?  */
+    /* Entity-tag of config data is the generation of running, unchanged data is not read */
+    if (content == CONTENT_CONFIG && clicon_option_bool(h, "CLICON_RESTCONF_ETAG")){
+        if ((ret = api_data_get_conditional(h, req, pretty, media_out, depth, defaults, head)) < 0){
+            if (netconf_operation_failed_xml(&xerr, "protocol", clixon_err_reason()) < 0)
                 goto done;
-            break;
-        case YANG_DATA_JSON:
-            if (clixon_json2cbuf(cbx, xret, pretty, 0, 0, 0) < 0)
+            if (api_return_err0(h, req, xerr, pretty, media_out, 0) < 0)
                 goto done;
-            break;
-        default:
-            break;
+            goto ok;
         }
+        if (ret == 1)
+            goto ok;
     }
-    else{
-        if (xpath_vec(xret, nsc, "%s", &xvec, &xlen, xpath) < 0){
-            if (netconf_operation_failed_xml(&xerr, "application", clixon_err_reason()) < 0)
+    /* HEAD of config data only needs to know if the instance exists, no data is read */
+    if (head && content == CONTENT_CONFIG && xpath && strcmp(xpath, "/") != 0){
+        if (clicon_rpc_count(h, "running", xpath, nsc, 1, &count) < 0){
+            if (netconf_operation_failed_xml(&xerr, "protocol", clixon_err_reason()) < 0)
                 goto done;
             if (api_return_err0(h, req, xerr, pretty, media_out, 0) < 0)
                 goto done;
             goto ok;
         }
-        /* Check if not exists */
-        if (xlen == 0){
-            /* 4.3: If a retrieval request for a data resource represents an
-               instance that does not exist, then an error response containing
-               a "404 Not Found" status-line MUST be returned by the server.
-               The error-tag value "invalid-value" is used in this case. */
-            if (netconf_invalid_value_xml(&xerr, "application", "Instance does not exist") < 0)
-                goto done;
-            /* override invalid-value default 400 with 404 */
-            if (api_return_err0(h, req, xerr, pretty, media_out, 404) < 0)
+        if (count == 0){
+            if (api_data_get_notfound(h, req, pretty, media_out) < 0)
                 goto done;
             goto ok;
         }
-        switch (media_out){
-        case YANG_DATA_XML:
-            for (i=0; i<xlen; i++){
-                x = xvec[i];
-                if (xml_nsctx_node(x, &nscd) < 0)
-                    goto done;
-                if (xmlns_set_all(x, nscd) < 0)
-                    goto done;
-                if (nscd){
-                    cvec_free(nscd);
-                    nscd = NULL;
-                }
-                if (clixon_xml2cbuf(cbx, x, 0, pretty, NULL, -1, 0) < 0) /* Dont print top object?  */
-                    goto done;
-            }
-            break;
-        case YANG_DATA_JSON:
-            /* In: <x xmlns="urn:example:clixon">0</x>
-             * Out: {"example:x": {"0"}}
-             */
-            if (xml2json_cbuf_vec(cbx, xvec, xlen, pretty, 0) < 0)
-                goto done;
-            break;
-        default:
-            break;
+        if ((cbx = cbuf_new()) == NULL){
+            clixon_err(OE_UNIX, errno, "cbuf_new");
+            goto done;
         }
+        ret = api_data_get_send(req, cbx, media_out, head);
+        cbx = NULL; /* consumed */
+        if (ret < 0)
+            goto done;
+        goto ok;
     }
-    clixon_debug(CLIXON_DBG_RESTCONF, "cbuf:%s", cbuf_get(cbx));
-    if (restconf_reply_header(req, "Content-Type", "%s", restconf_media_int2str(media_out)) < 0)
-        goto done;
-    if (restconf_reply_header(req, "Cache-Control", "no-cache") < 0)
-        goto done;
-    if (restconf_reply_send(req, 200, cbx, head) < 0)
+    /* Reply when backend replies, if possible */
+    if (!head){
+        if ((ret = api_data_get_async(h, req, xpath, nsc, content, depth, defaults,
+                                      pretty, media_out)) < 0)
+            goto done;
+        if (ret == 1)
+            goto ok;
+    }
+    if ((ret = clicon_rpc_get(h, xpath, nsc, content, depth, defaults, &xret)) < 0){
+        if (netconf_operation_failed_xml(&xerr, "protocol", clixon_err_reason()) < 0)
+            goto done;
+        if (api_return_err0(h, req, xerr, pretty, media_out, 0) < 0)
+            goto done;
+        goto ok;
+    }
+    if (api_data_get_reply(h, req, xret, xpath, nsc, pretty, media_out, head) < 0)
         goto done;
-    cbx = NULL;
  ok:
     retval = 0;
  done:
     clixon_debug(CLIXON_DBG_RESTCONF, "retval:%d", retval);
     if (xpath)
         free(xpath);
-    if (nscd)
-        cvec_free(nscd);
     if (nsc)
         xml_nsctx_free(nsc);
     if (xtop)
@@ -322,8 +746,6 @@ api_data_get2(clixon_handle  h,
         xml_free(xret);
     if (xerr)
         xml_free(xerr);
-    if (xvec)
-        free(xvec);
     return retval;
 }
 
@@ -378,6 +800,7 @@ api_data_pagination(clixon_handle  h,
     char      *direction;
     char      *sort;
     char      *where;
+    char      *cursor;
     char      *ns;
 
     clixon_debug(CLIXON_DBG_RESTCONF, "");
@@ -489,9 +912,10 @@ api_data_pagination(clixon_handle  h,
     direction = cvec_find_str(qvec, "direction");
     sort = cvec_find_str(qvec, "sort-by");
     where = cvec_find_str(qvec, "where");
+    cursor = cvec_find_str(qvec, "cursor");
     if (clicon_rpc_get_pageable_list(h, "running", xpath, nsc, content,
                                      depth, NULL, offset, limit, direction, sort, where,
-                                     &xret) < 0){
+                                     cursor, &xret) < 0){
         if (netconf_operation_failed_xml(&xerr, "protocol", clixon_err_reason()) < 0)
             goto done;
         if ((xe = xpath_first(xerr, NULL, "rpc-error")) == NULL){
@@ -98,643 +98,577 @@ yang_patch_op2int(char *op)
     return clicon_str2int(yang_patch_op_map, op);
 }
 
-/*! Add square brackets after the surrounding curly brackets in JSON
+/*! Translate module-name prefixes in yang patch value to XML namespaces
  *
-  * Needed, in order to modify the result of clixon_json2cbuf() to be valid input
-  * to api_data_post() and api_data_write()
-  * @param[in]  x_simple_patch  a cxobj to pass to clixon_json2cbuf()
-  * @retval     cbuf            With the modified json
-  * @retval     NULL            Error
-  */
-static cbuf*
-yang_patch_xml2json_modified_cbuf(cxobj *x_simple_patch)
-{
-    cbuf *json_simple_patch = NULL;
-    cbuf *cb = NULL;
-    char *json_simple_patch_tmp;
-    int   brace_count = 0;
-    size_t len;
-
-    json_simple_patch = cbuf_new();
-    if (json_simple_patch == NULL)
-        return NULL;
-    cb = cbuf_new();
-    if (clixon_json2cbuf(cb, x_simple_patch, 0, 0, 0) < 0)
-        goto done;
-
-    // Insert a '[' after the first '{' to get the JSON to match what api_data_post/write() expect
-    json_simple_patch_tmp = cbuf_get(cb);
-    len = strlen(json_simple_patch_tmp);
-    for (int l = 0; l < len; l++) {
-        char c = json_simple_patch_tmp[l];
-        if (c == '{') {
-            brace_count++;
-            if (brace_count == 2) { // We've reached the second brace, insert a '[' before it
-                cbuf_append(json_simple_patch,(int)'[');
-            }
-        }
-        cbuf_append(json_simple_patch,(int)c);
-    }
-
-    // Insert a ']' before the last '}' to get the JSON to match what api_data_post() expects
-    for (int l = cbuf_len(json_simple_patch) - 1; l >= 0; l--) {
-        char c = cbuf_get(json_simple_patch)[l];
-        if (c == '}') {
-            // Truncate and add a string, as there is not a function to insert a char into a cbuf
-            cbuf_trunc(json_simple_patch, l);
-            cbuf_append_str(json_simple_patch, "]}");
-            break;
-        }
-    }
-    cbuf_free(cb);
-    return json_simple_patch;
-}
-
-/*! yang_patch_strip_after_last_slash
- *
- * Strip /... from end  of val
- * so that e.g. "/interface=eth2" becomes "/"
- * or "/interface_list=mylist/interface=eth2" becomes "/interface_list=mylist/"
- *
- * @param[in]  val     value to strip
- * @retval     cbuf    with the stripped string
- * @retval     NULL    error
+ * Values in a JSON yang patch are anydata, where element prefixes are module names
+ * (RFC 7951). Prefixes that are not declared as XML namespaces are looked up as
+ * module names.
+ * @param[in]  yspec  Yang spec
+ * @param[in]  x      XML value element, translated in-line
+ * @retval     0      OK
+ * @retval    -1      Error
  */
-static cbuf*
-yang_patch_strip_after_last_slash(char* val)
+static int
+yang_patch_value_ns(yang_stmt *yspec,
+                    cxobj     *x)
 {
-    cbuf *cb;
-    cbuf *val_tmp;
-    int   idx;
-
-    cb = cbuf_new();
-    val_tmp = cbuf_new();
-    cbuf_append_str(val_tmp, val);
-    idx = cbuf_len(val_tmp);
-    for (int l = cbuf_len(val_tmp) - 1; l>= 0; l--) {
-        if (cbuf_get(val_tmp)[l] == '/') {
-            idx = l;
-            break;
+    int        retval = -1;
+    char      *prefix;
+    char      *ns = NULL;
+    yang_stmt *ymod;
+    cxobj     *xc;
+
+    if ((prefix = xml_prefix(x)) != NULL){
+        if (xml2ns(x, prefix, &ns) < 0)
+            goto done;
+        if (ns == NULL &&
+            (ymod = yang_find_module_by_name(yspec, prefix)) != NULL){
+            if (xml_prefix_set(x, NULL) < 0)
+                goto done;
+            if (xmlns_set(x, NULL, yang_find_mynamespace(ymod)) < 0)
+                goto done;
         }
     }
-    if (idx == cbuf_len(val_tmp)) // Didn't find a slash in the loop above
-        return NULL;
-    cbuf_trunc(val_tmp, idx + 1);
-    if (cbuf_append_str(cb, cbuf_get(val_tmp)) < 0)
-        return NULL;
-    cbuf_free(val_tmp);
-    return cb;
+    xc = NULL;
+    while ((xc = xml_child_each(x, xc, CX_ELMNT)) != NULL)
+        if (yang_patch_value_ns(yspec, xc) < 0)
+            goto done;
+    retval = 0;
+ done:
+    return retval;
 }
 
-/*! YANG PATCH replace method
+/*! Translate a yang patch "edit" element to an edit-config tree
  *
- * @param[in]  h         Clixon handle
- * @param[in]  req       Generic Www handle
- * @param[in]  pi        Offset, where to start api-path
- * @param[in]  qvec      Vector of query string (QUERY_STRING)
- * @param[in]  pretty    Set to 1 for pretty-printed xml/json output
- * @param[in]  media_out Output media
- * @param[in]  ds       0 if "data" resource, 1 if rfc8527 "ds" resource
- * @param[in]  simplepatch_request_uri URI for patch request, e.g. "/restconf/data/ietf-interfaces:interfaces"
- * @param[in]  target_val       value in "target" field of edit in YANG patch
- * @param[in]  value_vec_len    number of elements in the "value" array of an edit in YANG patch
- * @param[in]  value_vec        pointer to the "value" array of an edit in YANG patch
- * @param[in]  x_simple_patch   pointer to XML containing module name, e.g. <ietf-interfaces:interface/>
- * @retval     0    OK
- * @retval    -1    Error
+ * The target api-path is translated to XML, the target node is replaced with the value of
+ * the edit (if any) and given a NETCONF operation attribute.
+ * @param[in]  h        Clixon handle
+ * @param[in]  yspec    Yang spec
+ * @param[in]  api_path Api-path of request, target of edit is relative to this
+ * @param[in]  xedit    XML edit element
+ * @param[in]  xt       Edit-config top-level <config>, edit is added here
+ * @param[out] xtarget  Target node of edit in xt
+ * @param[out] xerr     Error if invalid edit
+ * @retval     1        OK
+ * @retval     0        Invalid edit, xerr set
+ * @retval    -1        Error
  */
 static int
-yang_patch_do_replace(clixon_handle  h,
-                      void          *req,
-                      int            pi,
-                      cvec          *qvec,
-                      int            pretty,
-                      restconf_media media_out,
-                      ietf_ds_t      ds,
-                      cbuf          *simple_patch_request_uri,
-                      char          *target_val,
-                      int            value_vec_len,
-                      cxobj        **value_vec,
-                      cxobj         *x_simple_patch
-                      )
+yang_patch_edit2xml(clixon_handle h,
+                    yang_stmt    *yspec,
+                    char         *api_path,
+                    cxobj        *xedit,
+                    cxobj        *xt,
+                    cxobj       **xtarget,
+                    cxobj       **xerr)
 {
-    int    retval = -1;
-    cxobj *value_vec_tmp = NULL;
-    cbuf  *delete_req_uri = NULL;
-    cbuf  *post_req_uri = NULL;
-    cbuf  *json_simple_patch = NULL;
-
-    if ((delete_req_uri = cbuf_new()) == NULL){
-        clixon_err(OE_UNIX, errno, "cbuf_new");
-        goto done;
+    int                 retval = -1;
+    char               *target;
+    char               *opstr;
+    char               *where = NULL;
+    char               *point = NULL;
+    yang_patch_op_t     operation;
+    enum operation_type op;
+    cbuf               *cbpath = NULL;
+    cxobj              *xbot = NULL;
+    yang_stmt          *ybot = NULL;
+    cxobj              *xparent;
+    cxobj              *xv;
+    cxobj              *x;
+    cvec               *qvec = NULL;
+    cg_var             *cv;
+    cg_var             *cvi;
+    char               *keyname;
+    int                 ret;
+
+    if ((target = xml_find_body(xedit, "target")) == NULL){
+        if (netconf_missing_element_xml(xerr, "protocol", "target", NULL) < 0)
+            goto done;
+        goto fail;
     }
-    if ((json_simple_patch = cbuf_new()) == NULL){
-        clixon_err(OE_UNIX, errno, "cbuf_new");
-        goto done;
+    if ((opstr = xml_find_body(xedit, "operation")) == NULL){
+        if (netconf_missing_element_xml(xerr, "protocol", "operation", NULL) < 0)
+            goto done;
+        goto fail;
     }
-    // Make delete_req_uri something like "/restconf/data/ietf-interfaces:interfaces"
-    if (cbuf_append_str(delete_req_uri, cbuf_get(simple_patch_request_uri)) < 0){
-        clixon_err(OE_UNIX, errno, "cbuf_append_str");
-        goto done;
+    switch (operation = yang_patch_op2int(opstr)){
+    case YANG_PATCH_OP_CREATE:
+    case YANG_PATCH_OP_INSERT:
+        op = OP_CREATE;
+        break;
+    case YANG_PATCH_OP_MERGE:
+    case YANG_PATCH_OP_MOVE:
+        op = OP_MERGE;
+        break;
+    case YANG_PATCH_OP_REPLACE:
+        op = OP_REPLACE;
+        break;
+    case YANG_PATCH_OP_DELETE:
+        op = OP_DELETE;
+        break;
+    case YANG_PATCH_OP_REMOVE:
+        op = OP_REMOVE;
+        break;
+    default:
+        if (netconf_invalid_value_xml(xerr, "protocol", "Unknown yang patch operation") < 0)
+            goto done;
+        goto fail;
+    }
+    if (operation == YANG_PATCH_OP_INSERT || operation == YANG_PATCH_OP_MOVE){
+        point = xml_find_body(xedit, "point");
+        if ((where = xml_find_body(xedit, "where")) == NULL)
+            where = "last";
+        if (point == NULL && (strcmp(where, "before") == 0 || strcmp(where, "after") == 0)){
+            if (netconf_missing_element_xml(xerr, "protocol", "point", NULL) < 0)
+                goto done;
+            goto fail;
+        }
     }
-
-    // Add the target to delete_req_uri,
-    // so it's something like "/restconf/data/ietf-interfaces:interfaces/interface=eth2"
-    if (cbuf_append_str(delete_req_uri, target_val) <  0){
-        clixon_err(OE_UNIX, errno, "cbuf_append_str");
+    if ((cbpath = cbuf_new()) == NULL){
+        clixon_err(OE_UNIX, errno, "cbuf_new");
         goto done;
     }
-
-    // Delete the object with the old values
-    if (api_data_delete(h, req, cbuf_get(delete_req_uri), pi, pretty, YANG_DATA_JSON, ds) < 0)
-        goto done;
-
-    // Now set up for the post request.
-    // Strip /... from end  of target val
-    // so that e.g. "/interface=eth2" becomes "/"
-    // or "/interface_list=mylist/interface=eth2" becomes "/interface_list=mylist/"
-    if ((post_req_uri = yang_patch_strip_after_last_slash(target_val)) == NULL)
-        goto done;
-
-    // Make post_req_uri something like "/restconf/data/ietf-interfaces:interfaces"
-    if (cbuf_append_str(simple_patch_request_uri, cbuf_get(post_req_uri)) < 0){
-        clixon_err(OE_UNIX, errno, "cbuf_append_str");
+    cprintf(cbpath, "%s%s", api_path?api_path:"", target);
+    xbot = xt;
+    if ((ret = api_path2xml_mnt(cbuf_get(cbpath), yspec, xt, YC_DATANODE, 1,
+                                restconf_apipath_mount_cb, h, &xbot, &ybot, xerr)) < 0)
         goto done;
-    }
-    // Now insert the new values into the data
-    // (which will include the key value and all other mandatory values)
-    for (int k = 0; k < value_vec_len; k++) {
-        if (value_vec[k] != NULL) {
-            value_vec_tmp = xml_dup(value_vec[k]);
-            xml_addsub(x_simple_patch, value_vec_tmp);
+    if (ret == 0)
+        goto fail;
+    if (xbot == xt || ybot == NULL){
+        if (netconf_invalid_value_xml(xerr, "application", "Edit target must be a data resource") < 0)
+            goto done;
+        goto fail;
+    }
+    /* Replace target with value, which includes keys and all other values */
+    if (operation == YANG_PATCH_OP_CREATE ||
+        operation == YANG_PATCH_OP_INSERT ||
+        operation == YANG_PATCH_OP_MERGE ||
+        operation == YANG_PATCH_OP_REPLACE){
+        if ((x = xml_find_type(xedit, NULL, "value", CX_ELMNT)) == NULL ||
+            (x = xml_child_i_type(x, 0, CX_ELMNT)) == NULL){
+            if (netconf_missing_element_xml(xerr, "protocol", "value", NULL) < 0)
+                goto done;
+            goto fail;
+        }
+        if ((xv = xml_dup(x)) == NULL)
+            goto done;
+        if (yang_patch_value_ns(yspec, xv) < 0){
+            xml_free(xv);
+            goto done;
+        }
+        xparent = xml_parent(xbot);
+        if (xml_addsub(xparent, xv) < 0){
+            xml_free(xv);
+            goto done;
+        }
+        if ((ret = xml_bind_yang0(h, xv, xml_spec(xparent)?YB_PARENT:YB_MODULE,
+                                  yspec, 0, 0, xerr)) < 0)
+            goto done;
+        if (ret == 0)
+            goto fail;
+        if (xml_spec(xv) != ybot){
+            if (netconf_bad_element_xml(xerr, "application", xml_name(xv),
+                                        "Edit value does not match target") < 0)
+                goto done;
+            goto fail;
+        }
+        /* Keys of value must be the keys of target */
+        if (yang_keyword_get(ybot) == Y_LEAF_LIST)
+            ret = clicon_strcmp(xml_body(xv), xml_body(xbot)) == 0;
+        else if (yang_keyword_get(ybot) == Y_LIST){
+            ret = 1;
+            cvi = NULL;
+            while ((cvi = cvec_each(yang_cvec_get(ybot), cvi)) != NULL){
+                keyname = cv_string_get(cvi);
+                if (clicon_strcmp(xml_find_body(xv, keyname), xml_find_body(xbot, keyname)) != 0)
+                    ret = 0;
+            }
         }
+        if (ret == 0){
+            if (netconf_operation_failed_xml(xerr, "protocol", "api-path keys do not match data keys") < 0)
+                goto done;
+            goto fail;
+        }
+        if (xml_purge(xbot) < 0)
+            goto done;
+        xbot = xv;
     }
-    // Convert the data to json
-    if (clixon_json2cbuf(json_simple_patch, x_simple_patch, 0, 0, 0) < 0)
-        goto done;
-
-    // Send the POST request
-    if (api_data_post(h, req, cbuf_get(simple_patch_request_uri), pi, qvec, cbuf_get(json_simple_patch), pretty, YANG_DATA_JSON, media_out, ds ) < 0)
+    if (xml_add_attr(xbot, "operation", xml_operation2str(op), NETCONF_BASE_PREFIX, NULL) == NULL)
         goto done;
-    retval = 0;
+    if (where){
+        if ((qvec = cvec_new(0)) == NULL){
+            clixon_err(OE_UNIX, errno, "cvec_new");
+            goto done;
+        }
+        if ((cv = cvec_add(qvec, CGV_STRING)) == NULL){
+            clixon_err(OE_UNIX, errno, "cvec_add");
+            goto done;
+        }
+        cv_name_set(cv, "insert");
+        cv_string_set(cv, where);
+        if (point){
+            cbuf_reset(cbpath);
+            cprintf(cbpath, "%s%s", api_path?api_path:"", point);
+            if ((cv = cvec_add(qvec, CGV_STRING)) == NULL){
+                clixon_err(OE_UNIX, errno, "cvec_add");
+                goto done;
+            }
+            cv_name_set(cv, "point");
+            cv_string_set(cv, cbuf_get(cbpath));
+        }
+        if (restconf_insert_attributes(xbot, qvec) < 0)
+            goto done;
+    }
+    *xtarget = xbot;
+    retval = 1;
  done:
-    if (post_req_uri)
-        cbuf_free(post_req_uri);
-    if (delete_req_uri)
-        cbuf_free(delete_req_uri);
-    if (json_simple_patch)
-        cbuf_free(json_simple_patch);
-    if (value_vec_tmp)
-        xml_free(value_vec_tmp);
+    if (qvec)
+        cvec_free(qvec);
+    if (cbpath)
+        cbuf_free(cbpath);
     return retval;
+ fail:
+    retval = 0;
+    goto done;
 }
 
-/*! YANG PATCH create method
+/*! Check if the target of an edit overlaps the target of an earlier edit in the batch
  *
- * @param[in]  h         Clixon handle
- * @param[in]  req       Generic Www handle
- * @param[in]  pi        Offset, where to start api-path
- * @param[in]  qvec      Vector of query string (QUERY_STRING)
- * @param[in]  pretty    Set to 1 for pretty-printed xml/json output
- * @param[in]  media_out Output media
- * @param[in]  ds       0 if "data" resource, 1 if rfc8527 "ds" resource
- * @param[in]  simplepatch_request_uri URI for patch request, e.g. "/restconf/data/ietf-interfaces:interfaces"
- * @param[in]  value_vec_len    number of elements in the "value" array of an edit in YANG patch
- * @param[in]  value_vec        pointer to the "value" array of an edit in YANG patch
- * @param[in]  x_simple_patch   pointer to XML containing module name, e.g. <ietf-interfaces:interface/>
- * @retval     0    OK
- * @retval    -1    Error
+ * NETCONF applies one operation per node, so an edit of a node that is, or is above or
+ * below, the target of an earlier edit cannot be combined with it in one edit-config.
+ * @param[in]  xtop     Batch edit-config tree, earlier targets are marked with XML_FLAG_MARK
+ * @param[in]  xt       Edit-config tree of edit
+ * @param[in]  xtarget  Target node of edit in xt
+ * @retval     1        Overlap
+ * @retval     0        No overlap
+ * @retval    -1        Error
  */
 static int
-yang_patch_do_create(clixon_handle  h,
-                     void          *req,
-                     int            pi,
-                     cvec          *qvec,
-                     int            pretty,
-                     restconf_media media_out,
-                     ietf_ds_t      ds,
-                     cbuf          *simple_patch_request_uri,
-                     int            value_vec_len,
-                     cxobj        **value_vec,
-                     cxobj         *x_simple_patch
-                     )
+yang_patch_overlap(cxobj *xtop,
+                   cxobj *xt,
+                   cxobj *xtarget)
 {
-    int    retval = -1;
-    cxobj *value_vec_tmp = NULL;
-    cbuf  *cb = NULL;
-
-    // Send the POST request
-    if ((cb = cbuf_new()) == NULL){
-        clixon_err(OE_UNIX, errno, "cbuf_new");
-        goto done;
-    }
-    for (int k = 0; k < value_vec_len; k++) {
-        if (value_vec[k] != NULL) {
-            if ((value_vec_tmp = xml_dup(value_vec[k])) == NULL)
-                goto done;
-            xml_addsub(x_simple_patch, value_vec_tmp);
-        }
+    int     retval = -1;
+    cxobj **vec = NULL;
+    int     len = 0;
+    cxobj  *x;
+    cxobj  *x0;
+    cxobj  *x0c = NULL;
+    int     i;
+
+    for (x = xtarget; x && x != xt; x = xml_parent(x))
+        len++;
+    if ((vec = calloc(len, sizeof(cxobj *))) == NULL){
+        clixon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    i = len;
+    for (x = xtarget; x && x != xt; x = xml_parent(x))
+        vec[--i] = x;
+    x0 = xtop;
+    for (i=0; i<len; i++){
+        if (match_base_child(x0, vec[i], xml_spec(vec[i]), &x0c) < 0)
+            goto done;
+        if (x0c == NULL)
+            break;
+        if (xml_flag(x0c, XML_FLAG_MARK) || vec[i] == xtarget)
+            break;
+        x0 = x0c;
     }
-    if (clixon_json2cbuf(cb, x_simple_patch, 0, 0, 0) < 0)
-        goto done;
-    if (api_data_post(h, req, cbuf_get(simple_patch_request_uri),
-                      pi, qvec,
-                      cbuf_get(cb), pretty, YANG_DATA_JSON, media_out, ds) < 0)
-        goto done;
-     retval = 0;
+    retval = (x0c != NULL);
  done:
-     if (cb)
-         cbuf_free(cb);
+    if (vec)
+        free(vec);
     return retval;
 }
 
-/*! YANG PATCH insert method
+/*! Send a batch of yang patch edits to the backend as one edit-config
  *
- * @param[in]  h                Clixon handle
- * @param[in]  req              Generic Www handle
- * @param[in]  pi               Offset, where to start api-path
- * @param[in]  pretty           Set to 1 for pretty-printed xml/json output
- * @param[in]  media_out        Output media
- * @param[in]  ds       0       if "data" resource, 1 if rfc8527 "ds" resource
- * @param[in]  simple_patch_request_uri URI for patch request, e.g. "/restconf/data/ietf-interfaces:interfaces"
- * @param[in]  value_vec_len    number of elements in the "value" array of an edit in YANG patch
- * @param[in]  value_vec        pointer to the "value" array of an edit in YANG patch
- * @param[in]  x_simple_patch   pointer to XML containing module name, e.g. <ietf-interfaces:interface/>
- * @param[in]  where_val       value in "where" field of edit in YANG patch
- * @param[in]  api_path        full API path, e.g. "/restconf/data/example-jukebox:jukebox/playlist=Foo-One"
- * @param[in]  point_val       value in "point" field of edit in YANG patch
- * @retval     0               OK
- * @retval    -1               Error
+ * @param[in]  h       Clixon handle
+ * @param[in]  xtop    Edit-config <config> tree
+ * @param[in]  ds      0 if "data" resource, 1 if rfc8527 "ds" resource
+ * @param[in]  last    Last batch of patch: commit the candidate
+ * @param[out] xret    Reply from backend, free with xml_free
+ * @retval     0       OK
+ * @retval    -1       Error
+ * @see api_data_write
  */
 static int
-yang_patch_do_insert(clixon_handle  h,
-                     void          *req,
-                     int            pi,
-                     int            pretty,
-                     restconf_media media_out,
-                     ietf_ds_t      ds,
-                     cbuf          *simple_patch_request_uri,
-                     int            value_vec_len,
-                     cxobj        **value_vec,
-                     cxobj         *x_simple_patch,
-                     char          *where_val,
-                     char          *api_path,
-                     char          *point_val
-                     )
+yang_patch_send(clixon_handle h,
+                cxobj        *xtop,
+                ietf_ds_t     ds,
+                int           last,
+                cxobj       **xret)
 {
-    int     retval = -1;
-    cxobj  *value_vec_tmp = NULL;
-    cbuf   *json_simple_patch;
-    cg_var *cv;
-    cbuf   *point_str = NULL;
-    cvec   *qvec_tmp = NULL;
+    int   retval = -1;
+    cbuf *cbx = NULL;
+    char *username;
 
-    if ((point_str = cbuf_new()) == NULL){
+    if ((cbx = cbuf_new()) == NULL){
         clixon_err(OE_UNIX, errno, "cbuf_new");
         goto done;
     }
-    if ((qvec_tmp = cvec_new(0)) == NULL){
-        clixon_err(OE_UNIX, errno, "cbuf_new");
-        goto done;
-    }
-    // Loop through the XML, and get each value
-    for (int k = 0; k < value_vec_len; k++) {
-        if (value_vec[k] != NULL) {
-            value_vec_tmp = xml_dup(value_vec[k]);
-            xml_addsub(x_simple_patch, value_vec_tmp);
+    cprintf(cbx, "<rpc xmlns=\"%s\"", NETCONF_BASE_NAMESPACE);
+    cprintf(cbx, " xmlns:%s=\"%s\"", NETCONF_BASE_PREFIX, NETCONF_BASE_NAMESPACE);
+    if ((username = clicon_username_get(h)) != NULL){
+        cprintf(cbx, " %s:username=\"%s\"", CLIXON_LIB_PREFIX, username);
+        cprintf(cbx, " xmlns:%s=\"%s\"", CLIXON_LIB_PREFIX, CLIXON_LIB_NS);
+    }
+    cprintf(cbx, " %s", NETCONF_MESSAGE_ID_ATTR);
+    cprintf(cbx, ">");
+    cprintf(cbx, "<edit-config");
+    if (last){
+        /* RFC8040 Sec 1.4: update startup after running is altered */
+        if ((IETF_DS_NONE == ds) &&
+            if_feature(h, "ietf-netconf", "startup") &&
+            !clicon_option_bool(h, "CLICON_RESTCONF_STARTUP_DONTUPDATE")){
+            cprintf(cbx, " %s:copystartup=\"true\"", CLIXON_LIB_PREFIX);
+            cprintf(cbx, " xmlns:%s=\"%s\"", CLIXON_LIB_PREFIX, CLIXON_LIB_NS);
         }
+        cprintf(cbx, " %s:autocommit=\"true\" xmlns:%s=\"%s\"",
+                CLIXON_LIB_PREFIX, CLIXON_LIB_PREFIX, CLIXON_LIB_NS);
     }
-    if ((json_simple_patch = yang_patch_xml2json_modified_cbuf(x_simple_patch)) == NULL)
-        goto done;
-
-    // Set the insert attributes
-    if ((cv = cvec_add(qvec_tmp, CGV_STRING)) == NULL){
-        clixon_err(OE_UNIX, errno, "cvec_add");
+    cprintf(cbx, "><target><candidate /></target>");
+    cprintf(cbx, "<default-operation>none</default-operation>");
+    if (clixon_xml2cbuf1(cbx, xtop, 0, 0, NULL, -1, 0, 0, WITHDEFAULTS_REPORT_ALL) < 0)
         goto done;
-    }
-    cv_name_set(cv, "insert");
-    if (where_val)
-        cv_string_set(cv, where_val);
-    cbuf_append_str(point_str, api_path);
-    if (point_val)
-        cbuf_append_str(point_str, point_val);
-    if ((cv = cvec_add(qvec_tmp, CGV_STRING)) == NULL){
-        clixon_err(OE_UNIX, errno, "cvec_add");
-        goto done;
-    }
-    cv_name_set(cv, "point");
-    cv_string_set(cv, cbuf_get(point_str));
-
-    // Send the POST request
-    if (api_data_post(h, req, cbuf_get(simple_patch_request_uri), pi, qvec_tmp, cbuf_get(json_simple_patch), pretty, YANG_DATA_JSON, media_out, ds)<  0)
+    cprintf(cbx, "</edit-config></rpc>");
+    clixon_debug(CLIXON_DBG_RESTCONF, "xml: %s", cbuf_get(cbx));
+    if (clicon_rpc_netconf(h, cbuf_get(cbx), xret, NULL) < 0)
         goto done;
     retval = 0;
  done:
-    if (qvec_tmp)
-        cvec_free(qvec_tmp);
-    if (point_str)
-        cbuf_free(point_str);
-    if (json_simple_patch)
-        cbuf_free(json_simple_patch);
+    if (cbx)
+        cbuf_free(cbx);
     return retval;
 }
 
-/*! YANG PATCH merge method
+/*! Append a JSON string value to a reply, with quotes
+ */
+static void
+yang_patch_json_str(cbuf *cb,
+                    char *str)
+{
+    char *p;
+
+    cbuf_append(cb, '"');
+    for (p = str; *p; p++){
+        if (*p == '"' || *p == '\\')
+            cprintf(cb, "\\%c", *p);
+        else if ((unsigned char)*p < 0x20)
+            cprintf(cb, "\\u%04x", *p);
+        else
+            cbuf_append(cb, *p);
+    }
+    cbuf_append(cb, '"');
+}
+
+/*! Reply yang-patch-status ok
  *
- * @param[in]  h               Clixon handle
- * @param[in]  req             Generic Www handle
- * @param[in]  pi              Offset, where to start api-path
- * @param[in]  qvec            Vector of query string (QUERY_STRING)
- * @param[in]  pretty          Set to 1 for pretty-printed xml/json output
- * @param[in]  media_out       Output media
- * @param[in]  ds       0      if "data" resource, 1 if rfc8527 "ds" resource
- * @param[in]  simple_patch_request_uri URI for patch request, e.g. "/restconf/data/ietf-interfaces:interfaces"
- * @param[in]  value_vec_len   number of elements in the "value" array of an edit in YANG patch
- * @param[in]  value_vec       pointer to the "value" array of an edit in YANG patch
- * @param[in]  x_simple_patch  pointer to XML containing module name, e.g. "<ietf-interfaces:interface/>"
- * @param[in]  where_val       value in "where" field of edit in YANG patch
- * @param[in]  key_xn          XML with key tag and value, e.g. "<name>Foo-One</name>"
- * @retval     0               OK
- * @retval    -1               Error
+ * @param[in]  h         Clixon handle
+ * @param[in]  req       Generic Www handle
+ * @param[in]  patchid   Patch-id of yang patch
+ * @param[in]  media_out Output media
+ * @retval     0         OK
+ * @retval    -1         Error
+ * @see RFC 8072 Sec 2.2
  */
 static int
-yang_patch_do_merge(clixon_handle  h,
+yang_patch_reply_ok(clixon_handle  h,
                     void          *req,
-                    int            pi,
-                    cvec          *qvec,
-                    int            pretty,
-                    restconf_media media_out,
-                    ietf_ds_t      ds,
-                    cbuf          *simple_patch_request_uri,
-                    int            value_vec_len,
-                    cxobj        **value_vec,
-                    cxobj         *x_simple_patch,
-                    cxobj         *key_xn
-                    )
+                    char          *patchid,
+                    restconf_media media_out)
 {
-    int    retval = -1;
-    cxobj *value_vec_tmp = NULL;
-    cbuf  *cb = NULL;
-    cbuf  *json_simple_patch = NULL;
+    int   retval = -1;
+    cbuf *cb = NULL;
 
     if ((cb = cbuf_new()) == NULL){
         clixon_err(OE_UNIX, errno, "cbuf_new");
         goto done;
     }
-    if (key_xn != NULL)
-        xml_addsub(x_simple_patch, key_xn);
-    // Loop through the XML, create JSON from each one, and submit a simple patch
-    for (int k = 0; k < value_vec_len; k++) {
-        if (value_vec[k] != NULL) {
-            value_vec_tmp = xml_dup(value_vec[k]);
-            xml_addsub(x_simple_patch, value_vec_tmp);
-        }
-        cbuf_reset(cb); /* reuse cb */
-        if (clixon_json2cbuf(cb, x_simple_patch, 0, 0, 0) < 0)
-            goto done;
-
-        if ((json_simple_patch = yang_patch_xml2json_modified_cbuf(x_simple_patch)) == NULL)
-            goto done;
-        // Send the simple patch request
-        if (api_data_write(h, req, cbuf_get(simple_patch_request_uri), pi, qvec, cbuf_get(json_simple_patch), pretty, YANG_DATA_JSON, media_out, 1, ds ) < 0)
+    switch (media_out){
+    case YANG_DATA_JSON:
+    case YANG_PATCH_JSON:
+        media_out = YANG_DATA_JSON;
+        cprintf(cb, "{\"ietf-yang-patch:yang-patch-status\":{\"patch-id\":");
+        yang_patch_json_str(cb, patchid);
+        cprintf(cb, ",\"ok\":[null]}}");
+        break;
+    default:
+        media_out = YANG_DATA_XML;
+        cprintf(cb, "<yang-patch-status xmlns=\"urn:ietf:params:xml:ns:yang:ietf-yang-patch\"><patch-id>");
+        if (xml_chardata_cbuf_append(cb, 0, patchid) < 0)
             goto done;
-        if (json_simple_patch){
-            cbuf_free(json_simple_patch);
-            json_simple_patch = NULL;
-        }
+        cprintf(cb, "</patch-id><ok/></yang-patch-status>");
+        break;
     }
+    if (restconf_reply_header(req, "Content-Type", "%s", restconf_media_int2str(media_out)) < 0)
+        goto done;
+    if (restconf_reply_send(req, 200, cb, 0) < 0)
+        goto done;
+    cb = NULL;
     retval = 0;
  done:
     if (cb)
         cbuf_free(cb);
-    if (json_simple_patch)
-        cbuf_free(json_simple_patch);
     return retval;
 }
 
-/*! Process a single yang patch "edit/value" element
+/*! Reply yang-patch-status with the error of an edit, or a global error
  *
- * @param[in]  xn        XML value element
+ * The HTTP status code is given by the error-tag as in other RESTCONF errors.
+ * @param[in]  h         Clixon handle
+ * @param[in]  req       Generic Www handle
+ * @param[in]  patchid   Patch-id of yang patch
+ * @param[in]  editid    Edit-id of failed edit, or NULL for a global error
+ * @param[in]  xerr      Error on the form <rpc-error>, renamed to <error>
+ * @param[in]  media_out Output media
  * @retval     0         OK
  * @retval    -1         Error
+ * @see RFC 8072 Sec 2.3
+ * @see api_return_err
  */
 static int
-yang_patch_do_value(clixon_handle  h,
-                    void          *req,
-                    int            pi,
-                    cvec          *qvec,
-                    int            pretty,
-                    restconf_media media_out,
-                    ietf_ds_t      ds,
-                    cxobj         *xn,
-                    char          *modname,
-                    yang_patch_op_t operation,
-                    char          *where_val,
-                    char          *point_val,
-                    cbuf          *simple_patch_request_uri,
-                    char          *target_val,
-                    char          *api_path,
-                    cxobj         *key_xn
-                    )
+yang_patch_reply_err(clixon_handle  h,
+                     void          *req,
+                     char          *patchid,
+                     char          *editid,
+                     cxobj         *xerr,
+                     restconf_media media_out)
 {
-    int     retval = -1;
-    cxobj **values_child_vec;
-    char   *key_node_id;
-    cbuf   *patch_header = NULL;
-    cxobj  *x_simple_patch = NULL;
-    int     value_vec_len;
-    cxobj **value_vec;
-
-    values_child_vec = xml_childvec_get(xn);
-    key_node_id = xml_name(*values_child_vec);
-    /* Create cbufs:s */
-    if ((patch_header = cbuf_new()) == NULL){
+    int   retval = -1;
+    cbuf *cb = NULL;
+    char *tag;
+    int   code;
+
+    if ((cb = cbuf_new()) == NULL){
         clixon_err(OE_UNIX, errno, "cbuf_new");
         goto done;
     }
-    cprintf(patch_header, "%s:%s", modname, key_node_id);
-    if ((x_simple_patch = xml_new(cbuf_get(patch_header), NULL, CX_ELMNT)) == NULL)
-        goto done;
-    value_vec_len = xml_child_nr(*values_child_vec);
-    value_vec = xml_childvec_get(*values_child_vec);
-    switch (operation){
-    case YANG_PATCH_OP_REPLACE:
-        if (yang_patch_do_replace(h, req, pi, qvec, pretty, media_out, ds, simple_patch_request_uri, target_val, value_vec_len, value_vec, x_simple_patch) < 0)
-            goto done;
-        break;
-    case YANG_PATCH_OP_CREATE:
-        if (yang_patch_do_create(h, req, pi, qvec, pretty, media_out, ds, simple_patch_request_uri, value_vec_len, value_vec, x_simple_patch) < 0)
+    if ((tag = xml_find_body(xerr, "error-tag")) == NULL ||
+        (code = restconf_err2code(tag)) < 0)
+        code = 500; /* internal server error */
+    if (xml_name_set(xerr, "error") < 0)
+        goto done;
+    switch (media_out){
+    case YANG_DATA_JSON:
+    case YANG_PATCH_JSON:
+        media_out = YANG_DATA_JSON;
+        cprintf(cb, "{\"ietf-yang-patch:yang-patch-status\":{\"patch-id\":");
+        yang_patch_json_str(cb, patchid);
+        if (editid){
+            cprintf(cb, ",\"edit-status\":{\"edit\":[{\"edit-id\":");
+            yang_patch_json_str(cb, editid);
+            cprintf(cb, ",\"errors\":");
+        }
+        else
+            cprintf(cb, ",\"errors\":");
+        if (clixon_json2cbuf(cb, xerr, 0, 0, 0, 0) < 0)
             goto done;
+        if (editid)
+            cprintf(cb, "}]}");
+        cprintf(cb, "}}");
         break;
-    case YANG_PATCH_OP_INSERT:
-        if (yang_patch_do_insert(h, req, pi, pretty, media_out, ds, simple_patch_request_uri, value_vec_len, value_vec, x_simple_patch, where_val, api_path, point_val) < 0)
+    default:
+        media_out = YANG_DATA_XML;
+        cprintf(cb, "<yang-patch-status xmlns=\"urn:ietf:params:xml:ns:yang:ietf-yang-patch\"><patch-id>");
+        if (xml_chardata_cbuf_append(cb, 0, patchid) < 0)
             goto done;
-        break;
-    case YANG_PATCH_OP_MERGE:
-        if (yang_patch_do_merge(h, req, pi, qvec, pretty, media_out, ds, simple_patch_request_uri, value_vec_len, value_vec, x_simple_patch, key_xn) < 0)
+        cprintf(cb, "</patch-id>");
+        if (editid){
+            cprintf(cb, "<edit-status><edit><edit-id>");
+            if (xml_chardata_cbuf_append(cb, 0, editid) < 0)
+                goto done;
+            cprintf(cb, "</edit-id>");
+        }
+        cprintf(cb, "<errors>");
+        if (clixon_xml2cbuf(cb, xerr, 0, 0, NULL, -1, 0) < 0)
             goto done;
-        break;
-    default:
+        cprintf(cb, "</errors>");
+        if (editid)
+            cprintf(cb, "</edit></edit-status>");
+        cprintf(cb, "</yang-patch-status>");
         break;
     }
+    if (restconf_reply_header(req, "Content-Type", "%s", restconf_media_int2str(media_out)) < 0)
+        goto done;
+    if (restconf_reply_send(req, code, cb, 0) < 0)
+        goto done;
+    cb = NULL;
     retval = 0;
  done:
-    if (x_simple_patch)
-        xml_free(x_simple_patch);
-    if (patch_header)
-        cbuf_free(patch_header);
+    if (cb)
+        cbuf_free(cb);
     return retval;
 }
 
-/*! Process a single yang patch "edit" element
+/*! Find the edit of a yang patch that a failed edit-config of a batch belongs to
  *
- * @param[in]  h         Clixon handle
- * @param[in]  req       Generic Www handle
- * @param[in]  pi        Offset, where to start api-path
- * @param[in]  qvec      Vector of query string (QUERY_STRING)
- * @param[in]  pretty    Set to 1 for pretty-printed xml/json output
- * @param[in]  media_out Output media
- * @param[in]  xn        XML edit element
- * @retval     0         OK
- * @retval    -1         Error
+ * The candidate is discarded and the edits are sent one by one, without commit, until one
+ * fails. The candidate is then discarded again. Only made on error.
+ * @param[in]  h        Clixon handle
+ * @param[in]  yspec    Yang spec
+ * @param[in]  api_path Api-path of request
+ * @param[in]  vec      Edit elements of yang patch
+ * @param[in]  veclen   Number of edits sent so far
+ * @param[in]  ds       0 if "data" resource, 1 if rfc8527 "ds" resource
+ * @param[out] xret     Reply of failed edit, free with xml_free
+ * @retval     i        Index of failed edit, xret set
+ * @retval     veclen   No edit fails by itself, eg a validation error of the commit
+ * @retval    -1        Error
  */
 static int
-yang_patch_do_edit(clixon_handle  h,
-                   void          *req,
-                   int            pi,
-                   cvec          *qvec,
-                   int            pretty,
-                   restconf_media media_out,
-                   ietf_ds_t      ds,
-                   yang_stmt     *yspec,
-                   cxobj         *xn,
-                   char          *uripath0,
-                   char          *api_path
-                   )
+yang_patch_failed_edit(clixon_handle h,
+                       yang_stmt    *yspec,
+                       char         *api_path,
+                       cxobj       **vec,
+                       size_t        veclen,
+                       ietf_ds_t     ds,
+                       cxobj       **xret)
 {
-    int        retval = -1;
-    cxobj    **vec = NULL;
-    size_t     veclen = 0;
-    cxobj     *xerr = NULL;    /* malloced must be freed */
-    cxobj     *xtop;
-    cxobj     *xbot = NULL;
-    yang_patch_op_t operation;
-    char      *where_val = NULL;
-    char      *point_val = NULL;
-    char      *target_val = NULL;
-    char      *modname;
-    cxobj    **key_vec = NULL;
-    cxobj     *key_xn = NULL;
-    int        i;
-    cxobj     *x; /* general purpose xml-tree pointer */
-    cbuf      *simple_patch_request_uri = NULL;
-    cbuf      *api_path_target = NULL;
-    yang_stmt *ybot = NULL;
-    yang_stmt *ymod;
-    int        ret;
-
-    clixon_debug_xml(CLIXON_DBG_RESTCONF, xn, "%d xn:", __LINE__);
-    /* Create cbufs:s */
-    if ((simple_patch_request_uri = cbuf_new()) == NULL){
-        clixon_err(OE_UNIX, errno, "cbuf_new");
-        goto done;
-    }
-    if ((api_path_target = cbuf_new()) == NULL){
-        clixon_err(OE_UNIX, errno, "cbuf_new");
-        goto done;
-    }
-    if ((x = xpath_first(xn, NULL, "target")) == NULL){
-        clixon_err(OE_YANG, 0, "target mandatory element not found");
-        goto done;
-    }
-    target_val = xml_body(x);
-    if ((x = xpath_first(xn, NULL, "operation")) == NULL){
-        clixon_err(OE_YANG, 0, "operation mandatory element not found");
-        goto done;
-    }
-    operation = yang_patch_op2int(xml_body(x));
-    /* target and operation are mandatory */
-    if (target_val == NULL){
-        clixon_err(OE_YANG, 0, "operation/target: mandatory element not found");
-        goto done;
-    }
-    if (operation == YANG_PATCH_OP_INSERT){
-        if ((x = xpath_first(xn, NULL, "point")) != NULL)
-            point_val = xml_body(x);
-        if ((x = xpath_first(xn, NULL, "where")) != NULL)
-            where_val = xml_body(x);
-        if (point_val == NULL || where_val == NULL){
-            clixon_err(OE_YANG, 0, "point/where: expected element not found");
-            goto done;
-        }
-    }
-    // Construct request URI
-    cprintf(simple_patch_request_uri, "%s", uripath0);
-    cprintf(api_path_target, "%s", api_path);
-    if (operation == YANG_PATCH_OP_MERGE) {
-        cbuf_append_str(api_path_target, target_val);
-        cbuf_append_str(simple_patch_request_uri, target_val);
-    }
-
-    if ((xtop = xml_new(NETCONF_INPUT_CONFIG, NULL, CX_ELMNT)) == NULL)
-        goto done;
+    int    retval = -1;
+    cxobj *xt = NULL;
+    cxobj *xtarget;
+    cxobj *xerr = NULL;
+    int    i;
+    int    ret;
 
-    // Get key field
-    /* Translate api_path to xml in the form of xtop/xbot */
-    xbot = xtop;
-    if ((ret = api_path2xml_mnt(h, cbuf_get(api_path_target), yspec, xtop, YC_DATANODE, 1, &xbot, &ybot, &xerr)) < 0)
+    if (clicon_rpc_discard_changes(h) < 0)
         goto done;
-    if (ret == 0){ /* validation failed */
-        if (api_return_err0(h, req, xerr, pretty, media_out, 0) < 0)
+    for (i = 0; i < veclen; i++){
+        if ((xt = xml_new(NETCONF_INPUT_CONFIG, NULL, CX_ELMNT)) == NULL)
             goto done;
-        goto ok;
-    }
-    /* Get module name */
-    if (ys_real_module(ybot, &ymod) < 0)
-        goto done;
-    modname = yang_argument_get(ymod);
-    // XXX this seems to be hardcoded to a yang list?
-    if ((key_vec = xml_childvec_get(xbot)) != NULL)
-        key_xn = key_vec[0];
-    // Get values (for "delete" and "remove", there are no values)
-    xpath_vec(xn, NULL, "value", &vec, &veclen);
-
-    // Loop through the values
-    for (i = 0; i < veclen; i++) {
-        if (yang_patch_do_value(h, req, pi, qvec, pretty, media_out, ds,
-                                vec[i], modname,
-                                operation, where_val, point_val, simple_patch_request_uri, target_val,
-                                api_path, key_xn) < 0)
+        if ((ret = yang_patch_edit2xml(h, yspec, api_path, vec[i], xt, &xtarget, &xerr)) < 0)
             goto done;
-    }
-    if (operation == YANG_PATCH_OP_DELETE ||
-        operation == YANG_PATCH_OP_REMOVE){
-        cbuf_append_str(simple_patch_request_uri, target_val);
-        if (operation == YANG_PATCH_OP_DELETE) {
-            // TODO - send error
-        } else {
-            // TODO - do not send error
+        if (ret == 1){
+            if (yang_patch_send(h, xt, ds, 0, xret) < 0)
+                goto done;
+            if (xpath_first(*xret, NULL, "//rpc-error") != NULL)
+                break;
+            xml_free(*xret);
+            *xret = NULL;
         }
-        api_data_delete(h, req, cbuf_get(simple_patch_request_uri), pi, pretty, YANG_DATA_JSON, ds);
+        xml_free(xt);
+        xt = NULL;
     }
- ok:
-    retval = 0;
+    if (clicon_rpc_discard_changes(h) < 0)
+        goto done;
+    retval = i;
  done:
-    if (vec)
-        free(vec);
-    if (simple_patch_request_uri)
-        cbuf_free(simple_patch_request_uri);
-    if (api_path_target)
-        cbuf_free(api_path_target);
-    if (xtop)
-        xml_free(xtop);
     if (xerr)
         xml_free(xerr);
+    if (xt)
+        xml_free(xt);
     return retval;
 }
 
 /*! YANG PATCH method
  *
+ * All edits are combined into one edit-config of the candidate, which is committed and
+ * validated once. Edits are combined in order, an edit whose target overlaps the target
+ * of an earlier edit starts a new edit-config, and the candidate is committed after the
+ * last. If any edit fails, the candidate is discarded and no edit is applied.
  * @param[in]  h         Clixon handle
  * @param[in]  req       Generic Www handle
  * @param[in]  api_path0 According to restconf (Sec 3.5.3.1 in rfc8040)
@@ -742,16 +676,17 @@ yang_patch_do_edit(clixon_handle  h,
  * @param[in]  qvec      Vector of query string (QUERY_STRING)
  * @param[in]  data      Stream input data
  * @param[in]  pretty    Set to 1 for pretty-printed xml/json output
- * @param[in]  media_in Input media
+ * @param[in]  media_in  Input media
  * @param[in]  media_out Output media
- * @param[in]  ds       0 if "data" resource, 1 if rfc8527 "ds" resource
+ * @param[in]  ds        0 if "data" resource, 1 if rfc8527 "ds" resource
  * @retval     0         OK
  * @retval    -1         Error
- * Netconf:  <edit-config> (nc:operation="merge")
+ * Netconf:  <edit-config> (nc:operation="create/merge/replace/delete/remove")
  * @see RFC8072
  * YANG patch can be used to "create", "delete", "insert", "merge", "move", "replace", and/or
    "remove" a resource within the target resource.
- * Currently "move" not supported
+ * Errors of the patch message itself are returned as RESTCONF errors, errors of an edit or
+ * the commit as yang-patch-status, see RFC 8072 Sec 2.3.
  */
 int
 api_data_yang_patch(clixon_handle  h,
@@ -771,9 +706,18 @@ api_data_yang_patch(clixon_handle  h,
     yang_stmt     *yspec;
     char          *api_path;
     cxobj         *xerr = NULL;    /* malloced must be freed */
-    char          *uripath0 = NULL;
+    cxobj         *xret = NULL;
+    cxobj         *xret1 = NULL;   /* Reply of failed edit */
+    cxobj         *xe;
+    cxobj         *xtop = NULL;    /* Edit-config of batch of edits */
+    cxobj         *xt = NULL;      /* Edit-config of one edit */
+    cxobj         *xtarget;
+    char          *patchid;
+    char          *editid = NULL;
+    char          *reason = NULL;
     size_t         veclen;
     cxobj        **vec = NULL;
+    int            sent = 0;       /* Batches sent to candidate, not yet committed */
     int            ret;
 
     clixon_debug(CLIXON_DBG_RESTCONF, "api_path:\"%s\"", api_path0);
@@ -794,10 +738,10 @@ api_data_yang_patch(clixon_handle  h,
     }
     switch (media_in){
     case YANG_PATCH_XML:
-        ret = clixon_xml_parse_string(data, YB_MODULE, yspec, &xpatch, &xerr);
+        ret = clixon_xml_parse_string1(h, data, YB_MODULE, yspec, &xpatch, &xerr);
         break;
     case YANG_PATCH_JSON:       /* RFC 8072 patch */
-        ret = clixon_json_parse_string(data, 1, YB_MODULE, yspec, &xpatch, &xerr);
+        ret = clixon_json_parse_string(h, data, 1, YB_MODULE, yspec, &xpatch, &xerr);
         break;
     default:
         restconf_unsupported_media(h, req, pretty, media_out);
@@ -827,32 +771,104 @@ api_data_yang_patch(clixon_handle  h,
             goto done;
         goto ok;
     }
-    /* Save original uripath (will be changed by sub-calls) */
-    if ((uripath0 = restconf_uripath(h)) == NULL)
-        goto done;
-    /* Find all edit operations and loop over them
+    if ((patchid = xml_find_body(xml_child_i_type(xpatch, 0, CX_ELMNT), "patch-id")) == NULL)
+        patchid = "";
+    /* Find all edit operations and add them to as few edit-configs as possible
      */
     if (xpath_vec(xpatch, NULL, "yang-patch/edit", &vec, &veclen) < 0)
         goto done;
+    if ((xtop = xml_new(NETCONF_INPUT_CONFIG, NULL, CX_ELMNT)) == NULL)
+        goto done;
     for (i = 0; i < veclen; i++) {
-        if (yang_patch_do_edit(h, req, pi, qvec, pretty, media_out, ds,
-                               yspec,
-                               vec[i],
-                               uripath0, api_path) < 0)
+        if ((xt = xml_new(NETCONF_INPUT_CONFIG, NULL, CX_ELMNT)) == NULL)
+            goto done;
+        editid = xml_find_body(vec[i], "edit-id");
+        if ((ret = yang_patch_edit2xml(h, yspec, api_path, vec[i], xt, &xtarget, &xerr)) < 0)
             goto done;
+        if (ret == 0)
+            goto fail;
+        if ((ret = yang_patch_overlap(xtop, xt, xtarget)) < 0)
+            goto done;
+        if (ret == 1){ /* Send batch so far and start a new */
+            if (yang_patch_send(h, xtop, ds, 0, &xret) < 0)
+                goto done;
+            sent++;
+            if (xpath_first(xret, NULL, "//rpc-error") != NULL)
+                goto fail_batch;
+            xml_free(xret);
+            xret = NULL;
+            xml_free(xtop);
+            if ((xtop = xml_new(NETCONF_INPUT_CONFIG, NULL, CX_ELMNT)) == NULL)
+                goto done;
+        }
+        if ((ret = xml_merge1(xtop, xt, yspec, 0, &reason)) < 0)
+            goto done;
+        if (ret == 0){
+            if (netconf_operation_failed_xml(&xerr, "application", reason) < 0)
+                goto done;
+            goto fail;
+        }
+        xml_flag_set(xtarget, XML_FLAG_MARK); /* xtarget is now in xtop */
+        xml_free(xt);
+        xt = NULL;
     }
+    /* Last batch, commit */
+    if (yang_patch_send(h, xtop, ds, 1, &xret) < 0)
+        goto done;
+    if (xpath_first(xret, NULL, "//rpc-error") != NULL)
+        goto fail_batch;
+    sent = 0;
+    if (yang_patch_reply_ok(h, req, patchid, media_out) < 0)
+        goto done;
  ok:
     retval = 0;
  done:
-    if (uripath0)
-        free(uripath0);
+    /* Revert edits sent to candidate but not committed */
+    if (sent && clicon_rpc_discard_changes(h) < 0)
+        retval = -1;
     if (vec)
         free(vec);
+    if (reason)
+        free(reason);
+    if (xret)
+        xml_free(xret);
+    if (xret1)
+        xml_free(xret1);
     if (xerr)
         xml_free(xerr);
+    if (xt)
+        xml_free(xt);
+    if (xtop)
+        xml_free(xtop);
     if (xpatch)
         xml_free(xpatch);
     return retval;
+ fail: /* Edit i failed, xerr set */
+    if ((xe = xpath_first(xerr, NULL, "rpc-error")) == NULL){
+        clixon_err(OE_XML, 0, "Internal error, shouldnt happen");
+        goto done;
+    }
+    if (yang_patch_reply_err(h, req, patchid, editid, xe, media_out) < 0)
+        goto done;
+    goto ok;
+ fail_batch: /* Batch of edits before edit i, or commit, failed, xret set */
+    if ((ret = yang_patch_failed_edit(h, yspec, api_path, vec, i, ds, &xret1)) < 0)
+        goto done;
+    sent = 0;
+    editid = NULL;     /* Commit failed, global error */
+    if (ret < i){
+        editid = xml_find_body(vec[ret], "edit-id");
+        xml_free(xret);
+        xret = xret1;
+        xret1 = NULL;
+    }
+    if ((xe = xpath_first(xret, NULL, "//rpc-error")) == NULL){
+        clixon_err(OE_XML, 0, "Internal error, shouldnt happen");
+        goto done;
+    }
+    if (yang_patch_reply_err(h, req, patchid, editid, xe, media_out) < 0)
+        goto done;
+    goto ok;
 }
 
 #else // CLIXON_YANG_PATCH
@@ -45,10 +45,14 @@
 #include <pwd.h>
 #include <ctype.h>
 #include <signal.h>
+#include <fcntl.h>
 #include <sys/stat.h>
 #include <sys/socket.h>
 #include <arpa/inet.h>
 #include <sys/resource.h>
+#ifdef HAVE_SYS_SENDFILE_H
+#include <sys/sendfile.h>
+#endif
 
 #include <openssl/ssl.h>
 #include <openssl/rand.h>
@@ -78,8 +82,13 @@
 #endif
 #include "restconf_stream.h"
 
+/* Seconds a client may take to complete TLS handshake before it is closed */
+#define RESTCONF_HANDSHAKE_TIMEOUT 10
+
 /* Forward */
 static int restconf_idle_cb(int fd, void *arg);
+static int restconf_ssl_handshake_cb(int s, void *arg);
+static int restconf_ssl_handshake_timeout(int fd, void *arg);
 
 /*! Create restconf stream
  *
@@ -153,6 +162,13 @@ restconf_stream_find(restconf_conn *rc,
 int
 restconf_stream_free(restconf_stream_data *sd)
 {
+    void *arg;
+
+    /* Cancel backend request the reply is waiting for */
+    if ((arg = sd->sd_defer) != NULL){
+        sd->sd_defer = NULL;
+        clicon_rpc_async_cancel(sd->sd_conn->rc_h, arg);
+    }
     if (sd->sd_fd != -1) {
         close(sd->sd_fd);
     }
@@ -221,6 +237,10 @@ restconf_conn_free(restconf_conn *rc)
         clixon_err(OE_RESTCONF, EINVAL, "rc is NULL");
         goto done;
     }
+    if (rc->rc_handshake){
+        clixon_event_unreg_fd(rc->rc_s, restconf_ssl_handshake_cb);
+        clixon_event_unreg_timeout(restconf_ssl_handshake_timeout, rc);
+    }
 #ifdef HAVE_LIBNGHTTP2
     if (rc->rc_ngsession)
         nghttp2_session_del(rc->rc_ngsession);
@@ -486,6 +506,67 @@ native_buf_write(clixon_handle    h,
     goto done;
 }
 
+#ifdef HAVE_SYS_SENDFILE_H
+/*! Write file to socket with sendfile, without copying it through user space
+ *
+ * Only for HTTP/1 without TLS, see restconf_reply_send_file
+ * @param[in]  h        Clixon handle
+ * @param[in]  fd       Open file
+ * @param[in]  offset   Offset in file
+ * @param[in]  len      Number of bytes to write
+ * @param[in]  rc       Connection struct
+ * @retval     1        OK
+ * @retval     0        OK, but socket write returned error, caller should close rc
+ * @retval    -1        Error
+ * @see native_buf_write
+ */
+static int
+native_file_write(clixon_handle  h,
+                  int            fd,
+                  off_t          offset,
+                  size_t         len,
+                  restconf_conn *rc)
+{
+    int     retval = -1;
+    ssize_t n;
+
+    clixon_debug(CLIXON_DBG_RESTCONF, "offset:%lld len:%zu", (long long)offset, len);
+    while (len > 0){
+        if ((n = sendfile(rc->rc_s, fd, &offset, len)) < 0){
+            switch (errno){
+            case EAGAIN:     /* Operation would block */
+                clixon_debug(CLIXON_DBG_RESTCONF, "sendfile EAGAIN");
+                usleep(10000);
+                continue;
+                break;
+            case EINTR:
+                continue;
+                break;
+            case ECONNRESET: /* Connection reset by peer */
+            case EPIPE:      /* Broken pipe */
+                goto closed; /* Close socket */
+                break;
+            default:
+                clixon_err(OE_UNIX, errno, "sendfile");
+                goto done;
+                break;
+            }
+        }
+        if (n == 0){ /* File truncated after its size was read */
+            clixon_err(OE_UNIX, EIO, "sendfile: unexpected end of file");
+            goto done;
+        }
+        len -= n;
+    }
+    retval = 1;
+ done:
+    return retval;
+ closed:
+    retval = 0;
+    goto done;
+}
+#endif /* HAVE_SYS_SENDFILE_H */
+
 /*! Send early handcoded bad request reply before actual packet received, just after accept
  *
  * @param[in]  h    Clixon handle
@@ -711,22 +792,8 @@ restconf_http1_process(restconf_conn *rc,
             clixon_err(OE_UNIX, errno, "cbuf_append");
             goto done;
         }
-        if (clixon_http1_parse_string(h, rc, cbuf_get(sd->sd_inbuf)) < 0){
-            /* XXX This does not work for SSL */
-            if (rc->rc_ssl){
-                ret = SSL_pending(rc->rc_ssl);
-            }
-            else if ((ret = clixon_event_poll(rc->rc_s)) < 0)
-                goto done;
-            if (ret > 0){
-                if (http1_native_clear_input(h, sd) < 0)
-                    goto done;
-                (*readmore)++;
-                goto ok;
-            }
-            /* Return error. Honestly, the sender could just e slow, it should really be a 
-             * timeout here.
-             */
+        /* Parse request line and header fields, once they are complete */
+        if ((ret = clixon_http1_parse_buf(h, rc, cbuf_get(sd->sd_inbuf), cbuf_len(sd->sd_inbuf))) < 0){
             if ((cberr = cbuf_new()) == NULL){
                 clixon_err(OE_UNIX, errno, "cbuf_new");
                 goto done;
@@ -741,6 +808,10 @@ restconf_http1_process(restconf_conn *rc,
             rc = NULL;
             goto closed;
         }
+        if (ret == 0){ /* Header fields not complete */
+            (*readmore)++;
+            goto ok;
+        }
         /* Check for Continue and if so reply with 100 Continue 
          * ret == 1: send reply
          */
@@ -784,6 +855,16 @@ restconf_http1_process(restconf_conn *rc,
     if ((ret = native_buf_write(h, cbuf_get(sd->sd_outp_buf), cbuf_len(sd->sd_outp_buf),
                                 rc, __func__)) < 0)
         goto done;
+#ifdef HAVE_SYS_SENDFILE_H
+    /* Body from file after header, see restconf_reply_send_file */
+    if (sd->sd_fd != -1){
+        if (ret == 1 &&
+            (ret = native_file_write(h, sd->sd_fd, sd->sd_fd_offset, sd->sd_body_len, rc)) < 0)
+            goto done;
+        close(sd->sd_fd);
+        sd->sd_fd = -1;
+    }
+#endif
     cvec_reset(sd->sd_outp_hdrs); /* Can be done in native_send_reply */
     cbuf_reset(sd->sd_outp_buf);
     cbuf_reset(sd->sd_inbuf);
@@ -1227,149 +1308,202 @@ ssl_alpn_check(clixon_handle        h,
     goto done;
 } /* ssl_alpn_check */
 
-/*! Accept new socket client. Note SSL not ip, this applies also to callhome
+/*! Set or clear O_NONBLOCK on a connection socket
+ *
+ * @param[in]  s       Socket
+ * @param[in]  on      If set, nonblocking, otherwise blocking
+ * @retval     0       OK
+ * @retval    -1       Error
+ */
+static int
+restconf_socket_nonblock(int s,
+                         int on)
+{
+    int flags;
+
+    if ((flags = fcntl(s, F_GETFL, 0)) < 0){
+        clixon_err(OE_UNIX, errno, "fcntl");
+        return -1;
+    }
+    if (on)
+        flags |= O_NONBLOCK;
+    else
+        flags &= ~O_NONBLOCK;
+    if (fcntl(s, F_SETFL, flags) < 0){
+        clixon_err(OE_UNIX, errno, "fcntl");
+        return -1;
+    }
+    return 0;
+}
+
+/*! TLS handshake did not complete in time, close connection
+ *
+ * @param[in]  fd   Not used
+ * @param[in]  arg  Restconf connection
+ * @retval     0    OK
+ * @retval    -1    Error
+ * @see restconf_ssl_handshake  where the timer is registered
+ */
+static int
+restconf_ssl_handshake_timeout(int   fd,
+                               void *arg)
+{
+    restconf_conn *rc = (restconf_conn *)arg;
+
+    clixon_debug(CLIXON_DBG_RESTCONF, "s:%d", rc->rc_s);
+    rc->rc_handshake = 0; /* timer already removed */
+    clixon_event_unreg_fd(rc->rc_s, restconf_ssl_handshake_cb);
+    return restconf_close_ssl_socket(rc, __func__, 1);
+}
+
+/*! Run TLS server handshake on a connection
  *
+ * On a nonblocking socket, a handshake that needs more data from the client registers
+ * restconf_ssl_handshake_cb on the socket and returns, instead of blocking the event loop.
+ * A handshake timer closes clients that do not complete the handshake in time.
+ * Blocking (callhome) sockets do not get WANT_READ/WRITE and complete here.
  * @param[in]  h     Clixon handle
- * @param[in]  s     Socket (unix or ip)
- * @param[in]  rsock Socket struct
- * @param[out] rcp   Restconf connection, if present and retval=1
- * @retval     1     OK, connection is up, rcp set
+ * @param[in]  rc    Restconf connection
+ * @retval     2     OK, handshake in progress, continued in restconf_ssl_handshake_cb
+ * @retval     1     OK, handshake done
  * @retval     0     OK, but connection closed
  * @retval    -1     Error
- * @see openssl_init_socket where this callback is registered
  */
-int
-restconf_ssl_accept_client(clixon_handle    h,
-                           int              s,
-                           restconf_socket *rsock,
-                           restconf_conn  **rcp)
+static int
+restconf_ssl_handshake(clixon_handle  h,
+                       restconf_conn *rc)
+{
+    int            retval = -1;
+    int            ret;
+    int            e;
+    int            er;
+    struct timeval t;
+
+    /* 1: OK, -1 fatal, 0: TLS/SSL handshake was not successful
+     * Both error cases: Call SSL_get_error() with the return value ret
+     */
+    while ((ret = SSL_accept(rc->rc_ssl)) != 1) {
+        clixon_debug(CLIXON_DBG_RESTCONF, "SSL_accept() ret:%d errno:%d", ret, er=errno);
+        e = SSL_get_error(rc->rc_ssl, ret);
+        switch (e){
+        case SSL_ERROR_SSL:                  /* 1 */
+            clixon_debug(CLIXON_DBG_RESTCONF, "SSL_ERROR_SSL (non-ssl message on ssl socket)");
+#ifdef HTTP_ON_HTTPS_REPLY
+            SSL_free(rc->rc_ssl);
+            rc->rc_ssl = NULL;
+            if (!rc->rc_callhome)
+                restconf_socket_nonblock(rc->rc_s, 0);
+            if (native_send_badrequest(h, "application/yang-data+xml",
+                                       "<errors xmlns=\"urn:ietf:params:xml:ns:yang:ietf-restconf\"><error><error-type>protocol</error-type><error-tag>malformed-message</error-tag><error-message>The plain HTTP request was sent to HTTPS port</error-message></error></errors>", rc) < 0)
+                goto done;
+#endif
+            if (restconf_close_ssl_socket(rc, __func__, 1) < 0)
+                goto done;
+            goto closed;
+            break;
+        case SSL_ERROR_SYSCALL:              /* 5 */
+            /* Some non-recoverable, fatal I/O error occurred. The OpenSSL error queue
+               may contain more information on the error. For socket I/O on Unix systems,
+               consult errno for details. If this error occurs then no further I/O
+               operations should be performed on the connection and SSL_shutdown() must
+               not be called.*/
+            clixon_debug(CLIXON_DBG_RESTCONF, "SSL_accept() SSL_ERROR_SYSCALL %d", er);
+            if (restconf_close_ssl_socket(rc, __func__, 1) < 0)
+                goto done;
+            goto closed;
+            break;
+        case SSL_ERROR_WANT_READ:            /* 2 */
+        case SSL_ERROR_WANT_WRITE:           /* 3 */
+            /* SSL_ERROR_WANT_READ is returned when the last operation was a read operation
+             * from a nonblocking BIO.
+             */
+            clixon_debug(CLIXON_DBG_RESTCONF, "SSL_accept() %s",
+                         e==SSL_ERROR_WANT_READ?"SSL_ERROR_WANT_READ":"SSL_ERROR_WANT_WRITE");
+            if (rc->rc_callhome){
+                usleep(10000);
+                continue;
+            }
+            if (rc->rc_handshake)
+                clixon_event_unreg_fd(rc->rc_s, restconf_ssl_handshake_cb);
+            else {
+                gettimeofday(&t, NULL);
+                t.tv_sec += RESTCONF_HANDSHAKE_TIMEOUT;
+                if (clixon_event_reg_timeout(t, restconf_ssl_handshake_timeout, rc,
+                                             "restconf tls handshake") < 0)
+                    goto done;
+                rc->rc_handshake = 1;
+            }
+            if (e == SSL_ERROR_WANT_READ)
+                ret = clixon_event_reg_fd(rc->rc_s, restconf_ssl_handshake_cb, rc,
+                                          "restconf tls handshake");
+            else
+                ret = clixon_event_reg_fd_out(rc->rc_s, restconf_ssl_handshake_cb, rc,
+                                              "restconf tls handshake");
+            if (ret < 0)
+                goto done;
+            retval = 2;
+            goto done;
+            break;
+        case SSL_ERROR_NONE:                 /* 0 */
+        case SSL_ERROR_ZERO_RETURN:          /* 6 */
+        case SSL_ERROR_WANT_CONNECT:         /* 7 */
+        case SSL_ERROR_WANT_ACCEPT:          /* 8 */
+        case SSL_ERROR_WANT_X509_LOOKUP:     /* 4 */
+        case SSL_ERROR_WANT_ASYNC:           /* 8 */
+        case SSL_ERROR_WANT_ASYNC_JOB:       /* 10 */
+#ifdef SSL_ERROR_WANT_CLIENT_HELLO_CB
+        case SSL_ERROR_WANT_CLIENT_HELLO_CB: /* 11 */
+#endif
+        default:
+            clixon_err(OE_SSL, 0, "SSL_accept:%d", e);
+            goto done;
+            break;
+        }
+    } /* SSL_accept */
+    clixon_debug(CLIXON_DBG_RESTCONF, "SSL_accept() done%s",
+                 SSL_session_reused(rc->rc_ssl)?", session resumed":"");
+    /* Rest of connection uses blocking socket */
+    if (rc->rc_handshake){
+        clixon_event_unreg_fd(rc->rc_s, restconf_ssl_handshake_cb);
+        clixon_event_unreg_timeout(restconf_ssl_handshake_timeout, rc);
+        rc->rc_handshake = 0;
+    }
+    if (!rc->rc_callhome &&
+        restconf_socket_nonblock(rc->rc_s, 0) < 0)
+        goto done;
+    retval = 1;
+ done:
+    return retval;
+ closed:
+    retval = 0;
+    goto done;
+}
+
+/*! Set up protocol of an accepted connection and register it in the event loop
+ *
+ * For SSL, the TLS handshake is done and ALPN selects the protocol
+ * @param[in]  h     Clixon handle
+ * @param[in]  rc    Restconf connection
+ * @retval     1     OK, connection is up
+ * @retval     0     OK, but connection closed
+ * @retval    -1     Error
+ */
+static int
+restconf_accept_setup(clixon_handle  h,
+                      restconf_conn *rc)
 {
     int                     retval = -1;
-    restconf_native_handle *rn = NULL;
-    restconf_conn          *rc = NULL;
-    char                   *name = NULL;
-    int                     e;
-    int                     er;
-    int                     readmore;
     const unsigned char    *alpn = NULL;
     unsigned int            alpnlen = 0;
     restconf_http_proto     proto = HTTP_11;  /* Non-SSL negotiation NYI */
     int                     ret;
 
-    clixon_debug(CLIXON_DBG_RESTCONF, "");
 #ifdef HAVE_LIBNGHTTP2
 #ifndef HAVE_HTTP1
     proto = HTTP_2;     /* If nghttp2 only let default be 2.0  */
 #endif
 #endif
-    if ((rn = restconf_native_handle_get(h)) == NULL){
-        clixon_err(OE_XML, EFAULT, "No openssl handle");
-        goto done;
-    }
-    /*
-     * Register callbacks for actual data socket 
-     */
-    if ((rc = restconf_conn_new(h, s, rsock)) == NULL)
-        goto done;
-    clixon_debug(CLIXON_DBG_RESTCONF, "s:%d", rc->rc_s);
-    if (rsock->rs_ssl){
-        if ((rc->rc_ssl = SSL_new(rn->rn_ctx)) == NULL){
-            clixon_err(OE_SSL, 0, "SSL_new");
-            goto done;
-        }
-        clixon_debug(CLIXON_DBG_RESTCONF, "SSL_new(%p)", rc->rc_ssl);
-        /* CCL_CTX_set_verify already set, need not call SSL_set_verify again for this server
-         */
-        /* X509_CHECK_FLAG_NO_WILDCARDS disables wildcard expansion */
-        SSL_set_hostflags(rc->rc_ssl, X509_CHECK_FLAG_NO_WILDCARDS);
-#if 0
-        /* XXX This code is kept for the time being just for reference, it does not belong here.
-         * If you want to restrict client certs to a specific set.
-         * Otherwise this is done in restcon ca-auth callback and ultimately NACM
-         * SSL_set1_host() sets the expected DNS hostname to name
-           C                      = SE  
-           L                      = Stockholm
-           O                      = Clixon
-           OU                     = clixon
-           CN                     = ca <---
-           emailAddress           = olof@hagsand.se
-        */
-        if (SSL_set1_host(rc->rc_ssl, "andy") != 1) { /* for peer cert */
-            clixon_err(OE_SSL, 0, "SSL_set1_host");
-            goto done;
-        }
-        if (SSL_add1_host(rc->rc_ssl, "olof") != 1) { /* for peer cert */
-            clixon_err(OE_SSL, 0, "SSL_set1_host");
-            goto done;
-        }
-#endif
-        if (SSL_set_fd(rc->rc_ssl, rc->rc_s) != 1){
-            clixon_err(OE_SSL, 0, "SSL_set_fd");
-            goto done;
-        }
-        readmore = 1;
-        while (readmore){
-            readmore = 0;
-            /* 1: OK, -1 fatal, 0: TLS/SSL handshake was not successful
-             * Both error cases: Call SSL_get_error() with the return value ret 
-             */
-            if ((ret = SSL_accept(rc->rc_ssl)) != 1) {
-                clixon_debug(CLIXON_DBG_RESTCONF, "SSL_accept() ret:%d errno:%d", ret, er=errno);
-                e = SSL_get_error(rc->rc_ssl, ret);
-                switch (e){
-                case SSL_ERROR_SSL:                  /* 1 */
-                    clixon_debug(CLIXON_DBG_RESTCONF, "SSL_ERROR_SSL (non-ssl message on ssl socket)");
-#ifdef HTTP_ON_HTTPS_REPLY
-                    SSL_free(rc->rc_ssl);
-                    rc->rc_ssl = NULL;
-                    if (native_send_badrequest(h, "application/yang-data+xml",
-                                               "<errors xmlns=\"urn:ietf:params:xml:ns:yang:ietf-restconf\"><error><error-type>protocol</error-type><error-tag>malformed-message</error-tag><error-message>The plain HTTP request was sent to HTTPS port</error-message></error></errors>", rc) < 0)
-                        goto done;
-#endif
-                    if (restconf_close_ssl_socket(rc, __func__, 1) < 0)
-                        goto done;
-                    goto closed;
-                    break;
-                case SSL_ERROR_SYSCALL:              /* 5 */
-                    /* Some non-recoverable, fatal I/O error occurred. The OpenSSL error queue
-                       may contain more information on the error. For socket I/O on Unix systems, 
-                       consult errno for details. If this error occurs then no further I/O
-                       operations should be performed on the connection and SSL_shutdown() must 
-                       not be called.*/
-                    clixon_debug(CLIXON_DBG_RESTCONF, "SSL_accept() SSL_ERROR_SYSCALL %d", er);
-                    if (restconf_close_ssl_socket(rc, __func__, 1) < 0)
-                        goto done;
-                    rc = NULL;
-                    goto closed;
-                    break;
-                case SSL_ERROR_WANT_READ:            /* 2 */
-                case SSL_ERROR_WANT_WRITE:           /* 3 */
-                    /* SSL_ERROR_WANT_READ is returned when the last operation was a read operation 
-                     * from a nonblocking BIO. 
-                     * That is, it can happen if restconf_socket_init() below is called 
-                     * with SOCK_NONBLOCK
-                     */
-                    clixon_debug(CLIXON_DBG_RESTCONF, "write SSL_ERROR_WANT_READ");
-                    usleep(10000);
-                    readmore = 1;
-                    break;
-                case SSL_ERROR_NONE:                 /* 0 */
-                case SSL_ERROR_ZERO_RETURN:          /* 6 */
-                case SSL_ERROR_WANT_CONNECT:         /* 7 */
-                case SSL_ERROR_WANT_ACCEPT:          /* 8 */
-                case SSL_ERROR_WANT_X509_LOOKUP:     /* 4 */
-                case SSL_ERROR_WANT_ASYNC:           /* 8 */
-                case SSL_ERROR_WANT_ASYNC_JOB:       /* 10 */
-#ifdef SSL_ERROR_WANT_CLIENT_HELLO_CB
-                case SSL_ERROR_WANT_CLIENT_HELLO_CB: /* 11 */
-#endif
-                default:
-                    clixon_err(OE_SSL, 0, "SSL_accept:%d", e);
-                    goto done;
-                    break;
-                }
-            } /* SSL_accept */
-        } /* while(readmore) */
+    if (rc->rc_ssl){
         /* Sets data and len to point to the client's requested protocol for this connection. */
 #ifndef OPENSSL_NO_NEXTPROTONEG
         SSL_get0_next_proto_negotiated(rc->rc_ssl, &alpn, &alpnlen);
@@ -1385,7 +1519,7 @@ restconf_ssl_accept_client(clixon_handle    h,
         }
         clixon_debug(CLIXON_DBG_RESTCONF, "proto:%s", restconf_proto2str(proto));
 
-        /* Get the actual peer, XXX this maybe could be done in ca-auth client-cert code ? 
+        /* Get the actual peer, XXX this maybe could be done in ca-auth client-cert code ?
          * Note this _only_ works if SSL_set1_host() was set previously,...
          */
         if ((ret = SSL_get_verify_result(rc->rc_ssl)) == X509_V_OK) { /* for peer cert */
@@ -1441,13 +1575,135 @@ restconf_ssl_accept_client(clixon_handle    h,
     gettimeofday(&rc->rc_t, NULL); /* activity timer */
     if (clixon_event_reg_fd(rc->rc_s, restconf_connection, (void*)rc, "restconf client socket") < 0)
         goto done;
+    retval = 1; /* OK, up */
+ done:
+    clixon_debug(CLIXON_DBG_RESTCONF, "retval:%d", retval);
+    return retval;
+ closed:
+    retval = 0; /* OK, closed */
+    goto done;
+}
+
+/*! Continue TLS handshake of a listen connection when client data arrives
+ *
+ * @param[in]  s    Socket
+ * @param[in]  arg  Restconf connection
+ * @retval     0    OK
+ * @retval    -1    Error
+ * @see restconf_ssl_handshake  where this callback is registered
+ */
+static int
+restconf_ssl_handshake_cb(int   s,
+                          void *arg)
+{
+    int            retval = -1;
+    restconf_conn *rc = (restconf_conn *)arg;
+    int            ret;
+
+    clixon_debug(CLIXON_DBG_RESTCONF, "s:%d", s);
+    if ((ret = restconf_ssl_handshake(rc->rc_h, rc)) < 0)
+        goto done;
+    if (ret == 1 &&
+        restconf_accept_setup(rc->rc_h, rc) < 0)
+        goto done;
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Accept new socket client. Note SSL not ip, this applies also to callhome
+ *
+ * Listen sockets run the TLS handshake nonblocking in the event loop, so that slow or
+ * stalled clients do not block other connections.
+ * @param[in]  h     Clixon handle
+ * @param[in]  s     Socket (unix or ip)
+ * @param[in]  rsock Socket struct
+ * @param[out] rcp   Restconf connection, if present and retval=1
+ * @retval     2     OK, TLS handshake in progress (listen sockets only)
+ * @retval     1     OK, connection is up, rcp set
+ * @retval     0     OK, but connection closed
+ * @retval    -1     Error
+ * @see openssl_init_socket where this callback is registered
+ */
+int
+restconf_ssl_accept_client(clixon_handle    h,
+                           int              s,
+                           restconf_socket *rsock,
+                           restconf_conn  **rcp)
+{
+    int                     retval = -1;
+    restconf_native_handle *rn = NULL;
+    restconf_conn          *rc = NULL;
+    int                     ret;
+
+    clixon_debug(CLIXON_DBG_RESTCONF, "");
+    if ((rn = restconf_native_handle_get(h)) == NULL){
+        clixon_err(OE_XML, EFAULT, "No openssl handle");
+        goto done;
+    }
+    /*
+     * Register callbacks for actual data socket
+     */
+    if ((rc = restconf_conn_new(h, s, rsock)) == NULL)
+        goto done;
+    clixon_debug(CLIXON_DBG_RESTCONF, "s:%d", rc->rc_s);
+    if (rsock->rs_ssl){
+        if ((rc->rc_ssl = SSL_new(rn->rn_ctx)) == NULL){
+            clixon_err(OE_SSL, 0, "SSL_new");
+            goto done;
+        }
+        clixon_debug(CLIXON_DBG_RESTCONF, "SSL_new(%p)", rc->rc_ssl);
+        /* CCL_CTX_set_verify already set, need not call SSL_set_verify again for this server
+         */
+        /* X509_CHECK_FLAG_NO_WILDCARDS disables wildcard expansion */
+        SSL_set_hostflags(rc->rc_ssl, X509_CHECK_FLAG_NO_WILDCARDS);
+#if 0
+        /* XXX This code is kept for the time being just for reference, it does not belong here.
+         * If you want to restrict client certs to a specific set.
+         * Otherwise this is done in restcon ca-auth callback and ultimately NACM
+         * SSL_set1_host() sets the expected DNS hostname to name
+           C                      = SE
+           L                      = Stockholm
+           O                      = Clixon
+           OU                     = clixon
+           CN                     = ca <---
+           emailAddress           = olof@hagsand.se
+        */
+        if (SSL_set1_host(rc->rc_ssl, "andy") != 1) { /* for peer cert */
+            clixon_err(OE_SSL, 0, "SSL_set1_host");
+            goto done;
+        }
+        if (SSL_add1_host(rc->rc_ssl, "olof") != 1) { /* for peer cert */
+            clixon_err(OE_SSL, 0, "SSL_set1_host");
+            goto done;
+        }
+#endif
+        if (SSL_set_fd(rc->rc_ssl, rc->rc_s) != 1){
+            clixon_err(OE_SSL, 0, "SSL_set_fd");
+            goto done;
+        }
+        /* Handshake of listen sockets is nonblocking, callhome sockets are blocking */
+        if (!rc->rc_callhome &&
+            restconf_socket_nonblock(rc->rc_s, 1) < 0)
+            goto done;
+        if ((ret = restconf_ssl_handshake(h, rc)) < 0)
+            goto done;
+        if (ret == 0)
+            goto closed;
+        if (ret == 2){
+            retval = 2;
+            goto done;
+        }
+    } /* if ssl */
+    if ((ret = restconf_accept_setup(h, rc)) < 0)
+        goto done;
+    if (ret == 0)
+        goto closed;
     if (rcp)
         *rcp = rc;
     retval = 1; /* OK, up */
  done:
     clixon_debug(CLIXON_DBG_RESTCONF, "retval:%d", retval);
-    if (name)
-        free(name);
     return retval;
  closed:
     retval = 0; /* OK, closed */
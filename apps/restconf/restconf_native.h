@@ -76,7 +76,8 @@ struct restconf_conn;
 typedef struct  {
     qelem_t               sd_qelem;     /* List header */
     int32_t               sd_stream_id;
-    int                   sd_fd;        /* XXX Is this used? */
+    int                   sd_fd;        /* File of body sent with sendfile after header, or -1 */
+    off_t                 sd_fd_offset; /* Offset of body in sd_fd, see restconf_reply_send_file */
     cvec                 *sd_outp_hdrs; /* List of output headers */
     cbuf                 *sd_outp_buf;  /* Output buffer */
     cbuf                 *sd_body;      /* http output body as cbuf terminated with \r\n */
@@ -92,6 +93,7 @@ typedef struct  {
     void                 *sd_req;       /* Lib-specific request */
     int                   sd_upgrade2;  /* Upgrade to http/2 */
     uint8_t              *sd_settings2; /* Settings for upgrade to http/2 request */
+    void                 *sd_defer;     /* Reply deferred until backend replies, see restconf_reply_defer */
 } restconf_stream_data;
 
 typedef struct restconf_socket restconf_socket;
@@ -122,6 +124,7 @@ typedef struct restconf_conn {
     struct timeval        rc_t;         /* Timestamp of last read/write activity, used by callhome
                                            idle-timeout algorithm */
     int                   rc_event_stream;    /* Event notification stream socket (maybe in sd?) */
+    int                   rc_handshake; /* TLS handshake in progress in event loop */
 } restconf_conn;
 
 /* Restconf per socket handle
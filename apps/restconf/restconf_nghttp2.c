@@ -425,8 +425,8 @@ restconf_sd_read(nghttp2_session     *session,
     else{
         len = length;
     }
-    memcpy(buf, cbuf_get(cb) + sd->sd_body_offset, len);
-    sd->sd_body_offset += len;
+    /* Do not copy body into buf, it is written directly from sd_body in send_data_callback */
+    *data_flags |= NGHTTP2_DATA_FLAG_NO_COPY;
     clixon_debug(CLIXON_DBG_RESTCONF, "retval:%zu", len);
     return len;
 }
@@ -511,6 +511,45 @@ restconf_submit_response(nghttp2_session      *session,
     return retval;
 }
 
+/*! Submit reply of a request
+ *
+ * @param[in] rc        Restconf connection
+ * @param[in] sd        Restconf native stream struct
+ * @param[in] session   Nghttp2 session struct
+ * @param[in] stream_id Nghttp2 stream id
+ * @retval    0         OK
+ * @retval   -1         Error
+ */
+static int
+http2_reply(restconf_conn        *rc,
+            restconf_stream_data *sd,
+            nghttp2_session      *session,
+            int32_t               stream_id)
+{
+    int retval = -1;
+
+    /* If body, add a content-length header 
+     *    A server MUST NOT send a Content-Length header field in any response
+     * with a status code of 1xx (Informational) or 204 (No Content).  A
+     * server MUST NOT send a Content-Length header field in any 2xx
+     * (Successful) response to a CONNECT request (Section 4.3.6 of
+     * [RFC7231]).
+     */
+    if (sd->sd_code != 204 && sd->sd_code > 199 && sd->sd_body_len)
+        if (restconf_reply_header(sd, "Content-Length", "%zu", sd->sd_body_len) < 0)
+            goto done;
+    if (sd->sd_code){
+        if (restconf_submit_response(session, rc, stream_id, sd) < 0)
+            goto done;
+    }
+    else {
+        /* 500 Internal server error ? */
+    }
+    retval = 0;
+ done:
+    return retval;
+}
+
 /*! Simulate a received request in an upgrade scenario by talking the http/1 parameters
  *
  * @param[in] rc        Restconf connection
@@ -553,24 +592,45 @@ http2_exec(restconf_conn        *rc,
     }
     if (restconf_param_del_all(rc->rc_h) < 0) // XXX
         goto done;
+    /* No reply if deferred until backend replies, see http2_resume */
+    if (sd->sd_defer == NULL &&
+        http2_reply(rc, sd, session, stream_id) < 0)
+        goto done;
+    retval = 0;
+ done:
+    clixon_debug(CLIXON_DBG_RESTCONF, "retval:%d", retval);
+    return retval;
+}
 
-    /* If body, add a content-length header 
-     *    A server MUST NOT send a Content-Length header field in any response
-     * with a status code of 1xx (Informational) or 204 (No Content).  A
-     * server MUST NOT send a Content-Length header field in any 2xx
-     * (Successful) response to a CONNECT request (Section 4.3.6 of
-     * [RFC7231]).
-     */
-    if (sd->sd_code != 204 && sd->sd_code > 199 && sd->sd_body_len)
-        if (restconf_reply_header(sd, "Content-Length", "%zu", sd->sd_body_len) < 0)
+/*! Send the reply of a request that was deferred while waiting for the backend
+ *
+ * @param[in] sd        Restconf native stream struct
+ * @retval    0         OK
+ * @retval   -1         Error
+ * @see restconf_reply_resume
+ */
+int
+http2_resume(restconf_stream_data *sd)
+{
+    int            retval = -1;
+    restconf_conn *rc = sd->sd_conn;
+    nghttp2_error  ngerr;
+
+    clixon_debug(CLIXON_DBG_RESTCONF, "%d", sd->sd_stream_id);
+    if (rc->rc_ngsession == NULL){
+        clixon_err(OE_RESTCONF, EINVAL, "No nghttp2 session");
+        goto done;
+    }
+    if (http2_reply(rc, sd, rc->rc_ngsession, sd->sd_stream_id) < 0)
+        goto done;
+    /* Not called from http2_recv, send the reply here */
+    clixon_err_reset();
+    if ((ngerr = nghttp2_session_send(rc->rc_ngsession)) != 0){
+        if (clixon_err_category())
             goto done;
-    if (sd->sd_code){
-        if (restconf_submit_response(session, rc, stream_id, sd) < 0)
+        if (restconf_close_ssl_socket(rc, __func__, 0) < 0) /* Not fatal error */
             goto done;
     }
-    else {
-        /* 500 Internal server error ? */
-    }
     retval = 0;
  done:
     clixon_debug(CLIXON_DBG_RESTCONF, "retval:%d", retval);
@@ -880,8 +940,33 @@ send_data_callback(nghttp2_session     *session,
                    nghttp2_data_source *source,
                    void                *user_data)
 {
-    //    restconf_conn *rc = (restconf_conn *)user_data;
-    clixon_debug(CLIXON_DBG_RESTCONF, "");
+    restconf_stream_data *sd = (restconf_stream_data *)source->ptr;
+    size_t                padlen;
+    uint8_t               padbuf[256] = {0,};
+
+    clixon_debug(CLIXON_DBG_RESTCONF, "length:%zu offset:%zu", length, sd->sd_body_offset);
+    padlen = frame->data.padlen;
+    /* 9-byte frame header */
+    if (session_send_callback(session, framehd, 9, 0, user_data) < 0)
+        return NGHTTP2_ERR_CALLBACK_FAILURE;
+    /* Pad length field, padlen includes it */
+    if (padlen > 0){
+        padbuf[0] = (uint8_t)(padlen - 1);
+        if (session_send_callback(session, padbuf, 1, 0, user_data) < 0)
+            return NGHTTP2_ERR_CALLBACK_FAILURE;
+        padbuf[0] = 0;
+    }
+    /* Body directly from sd_body, see restconf_sd_read */
+    if (length > 0 &&
+        session_send_callback(session,
+                              (uint8_t*)cbuf_get(sd->sd_body) + sd->sd_body_offset,
+                              length, 0, user_data) < 0)
+        return NGHTTP2_ERR_CALLBACK_FAILURE;
+    sd->sd_body_offset += length;
+    /* Padding */
+    if (padlen > 1 &&
+        session_send_callback(session, padbuf, padlen - 1, 0, user_data) < 0)
+        return NGHTTP2_ERR_CALLBACK_FAILURE;
     return 0;
 }
 
@@ -42,7 +42,9 @@
 #include <pwd.h>
 #include <syslog.h>
 #include <errno.h>
+#include <stdint.h>
 #include <sys/types.h>
+#include <sys/time.h>
 #include <signal.h>
 
 /* net-snmp */
@@ -60,10 +62,41 @@
 #include "snmp_register.h"
 #include "snmp_handler.h"
 
+/*! Index entry of a getnext cache: OID of one column of one row of a table
+ */
+struct snmp_getnext_oid {
+    oid           *so_oid;    /* Column OID with key OID appended, malloced */
+    size_t         so_oidlen;
+    cxobj         *so_xcol;   /* XML of column in sg_xml */
+    yang_stmt     *so_ycol;   /* YANG of column */
+    int            so_asn1type; /* ASN.1 type of column, see type_yang2asn1 */
+    char          *so_defval; /* SMI default value of column, or NULL */
+};
+
+/*! Getnext cache entry of one table
+ */
 struct snmp_getnext_cache {
-    cxobj         *sg_xml;
-    char          *sg_xpath;
-    struct timeval sg_timer;
+    qelem_t                  sg_qelem;    /* List header */
+    char                    *sg_xpath;    /* XPath of table, key of cache */
+    cxobj                   *sg_xml;      /* XML tree of last rpc of xpath */
+    struct timeval           sg_timer;    /* Time of last rpc */
+    long                     sg_reqid;    /* Request id of SNMP PDU of last rpc */
+    yang_stmt               *sg_ylist;    /* YANG list of sg_index */
+    struct snmp_getnext_oid *sg_index;    /* OIDs of sg_xml sorted, binary searched by getnext */
+    int                      sg_indexlen;
+};
+
+/* Accumulated wall time in clixon handlers, see CLICON_SNMP_TIMING */
+static uint64_t _snmp_handler_usec = 0;
+
+/*! Edits of one SNMP SET PDU, sent to the backend as one edit-config, validate and commit
+ */
+struct snmp_set_batch {
+    long                     sb_reqid;    /* Request id of SNMP SET PDU */
+    cxobj                   *sb_xedit;    /* Merged edits, top is NETCONF_INPUT_CONFIG */
+    int                      sb_nvb;      /* Number of varbinds handled in ACTION */
+    int                      sb_sent;     /* Edits sent and validated */
+    int                      sb_done;     /* Committed or discarded */
 };
 
 /*! Common code for handling incoming SNMP request
@@ -128,8 +161,14 @@ snmp_common_handler(netsnmp_mib_handler          *handler,
     return retval;
 }
 
-/*! scalar return
+/*! Scalar return with precomputed ASN.1 type and SMI default value
  *
+ * @param[in]  xs           XML of value, or NULL
+ * @param[in]  ys           YANG of value
+ * @param[in]  asn1type     ASN.1 type of ys, see type_yang2asn1
+ * @param[in]  defaultval   SMI default value of ys, or NULL
+ * @param[in]  oidc         OID of value
+ * @param[in]  oidclen      OID length
  * @param[in]  reqinfo      Agent transaction request structure
  * @param[in]  request     The netsnmp request info structure.
  * @retval     0            OK
@@ -138,15 +177,15 @@ snmp_common_handler(netsnmp_mib_handler          *handler,
 static int
 snmp_scalar_return(cxobj                      *xs,
                    yang_stmt                  *ys,
+                   int                         asn1type,
+                   char                       *defaultval,
                    oid                        *oidc,
                    size_t                      oidclen,
                    netsnmp_agent_request_info *reqinfo,
                    netsnmp_request_info       *request)
 {
     int                    retval = -1;
-    int                    asn1type;
     char                  *xmlstr = NULL;
-    char                  *defaultval = NULL;
     u_char                *snmpval = NULL;
     size_t                 snmplen = 0;
     char                  *reason = NULL;
@@ -154,10 +193,6 @@ snmp_scalar_return(cxobj                      *xs,
     char                  *body = NULL;
     int                    ret;
 
-    /* SMI default value, How is this different from yang defaults?
-     */
-    if (yang_extension_value_opt(ys, "smiv2:defval", NULL, &defaultval) < 0)
-        goto done;
     if (xs != NULL && (body = xml_body(xs)) != NULL){
         if ((ret = type_xml2snmp_pre(body, ys, &xmlstr)) < 0) // XXX <---
             goto done;
@@ -182,8 +217,6 @@ snmp_scalar_return(cxobj                      *xs,
         }
         goto ok;
     }
-    if (type_yang2asn1(ys, &asn1type, 1) < 0)
-        goto done;
     if ((ret = type_xml2snmp(xmlstr, ys, &asn1type, &snmpval, &snmplen, &reason)) < 0)
         goto done;
     if (ret == 0){
@@ -218,10 +251,12 @@ snmp_scalar_return(cxobj                      *xs,
 
 /*! Scalar handler, set a value to clixon 
  *
- * get xpath: see yang2api_path_fmt / api_path2xpath
+ * Namespace context, xpath and type are precomputed, see snmp_handle_compile
  * @param[in]  h          Clixon handle
  * @param[in]  ys         Yang node
- * @param[in]  cvk        Vector of index/Key variables, if any
+ * @param[in]  nsc        Namespace context of xpath
+ * @param[in]  xpath      XPath of value, with keys if any
+ * @param[in]  asn1type   ASN.1 type of ys, see type_yang2asn1
  * @param[in]  defaultval Default value
  * @param[in]  reqinfo    Agent transaction request structure
  * @param[in]  request    The netsnmp request info structure.
@@ -231,21 +266,20 @@ snmp_scalar_return(cxobj                      *xs,
 static int
 snmp_scalar_get(clixon_handle               h,
                 yang_stmt                  *ys,
-                cvec                       *cvk,
+                cvec                       *nsc,
+                char                       *xpath,
+                int                         asn1type,
                 char                       *defaultval,
                 netsnmp_agent_request_info *reqinfo,
                 netsnmp_request_info       *request)
 {
     int     retval = -1;
-    cvec   *nsc = NULL;
-    char   *xpath = NULL;
     cxobj  *xt = NULL;
     cxobj  *xerr;
     cxobj  *x = NULL;
     char   *xmlstr = NULL;
     u_char *snmpval = NULL;
     size_t  snmplen = 0;
-    int     asn1type;
     char   *reason = NULL;
     netsnmp_variable_list *requestvb = request->requestvb;
     cxobj  *xcache = NULL;
@@ -253,14 +287,6 @@ snmp_scalar_get(clixon_handle               h,
     int     ret;
 
     clixon_debug(CLIXON_DBG_SNMP, "");
-    /* Prepare backend call by constructing namespace context */
-    if (xml_nsctx_yang(ys, &nsc) < 0)
-        goto done;
-    /* Create xpath from yang */
-    if (snmp_yang2xpath(ys, cvk, &xpath) < 0)
-        goto done;
-    if (type_yang2asn1(ys, &asn1type, 1) < 0)
-        goto done;
     /* First try cache */
     clicon_ptr_get(h, "snmp-rowstatus-tree", (void**)&xcache);
     if (xcache==NULL || (x = xpath_first(xcache, nsc, "%s", xpath)) == NULL){
@@ -331,10 +357,6 @@ snmp_scalar_get(clixon_handle               h,
         free(snmpval);
     if (xt)
         xml_free(xt);
-    if (xpath)
-        free(xpath);
-    if (nsc)
-        xml_nsctx_free(nsc);
     return retval;
 }
 
@@ -383,6 +405,250 @@ snmp_yang2xml(cxobj     *xtop,
     return retval;
 }
 
+/*! Get set batch of current SNMP SET PDU, reset it if it belongs to an earlier PDU
+ *
+ * @param[in]  h       Clixon handle
+ * @param[in]  reqinfo Agent transaction request structure
+ * @param[out] sbp     Set batch, dont free
+ * @retval     0       OK
+ * @retval    -1       Error
+ */
+static int
+snmp_set_batch_get(clixon_handle               h,
+                   netsnmp_agent_request_info *reqinfo,
+                   struct snmp_set_batch     **sbp)
+{
+    int                    retval = -1;
+    struct snmp_set_batch *sb = NULL;
+    long                   reqid = -1;
+
+    if (reqinfo->asp && reqinfo->asp->pdu)
+        reqid = reqinfo->asp->pdu->reqid;
+    clicon_ptr_get(h, "snmp-set-batch", (void**)&sb);
+    if (sb == NULL){
+        if ((sb = malloc(sizeof(*sb))) == NULL){
+            clixon_err(OE_UNIX, errno, "malloc");
+            goto done;
+        }
+        memset(sb, 0, sizeof(*sb));
+        sb->sb_reqid = -1;
+        clicon_ptr_set(h, "snmp-set-batch", sb);
+    }
+    if (sb->sb_reqid != reqid || reqid == -1){
+        if (sb->sb_xedit){
+            xml_free(sb->sb_xedit);
+            sb->sb_xedit = NULL;
+        }
+        sb->sb_reqid = reqid;
+        sb->sb_nvb = 0;
+        sb->sb_sent = 0;
+        sb->sb_done = 0;
+    }
+    *sbp = sb;
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Add an edit to the set batch of current SNMP SET PDU instead of an edit-config RPC
+ *
+ * @param[in]  h       Clixon handle
+ * @param[in]  reqinfo Agent transaction request structure
+ * @param[in]  xtop    Edit, top is NETCONF_INPUT_CONFIG, children are moved to the batch
+ * @retval     0       OK
+ * @retval    -1       Error
+ * @see snmp_set_batch_action  where the batch is sent
+ */
+static int
+snmp_set_batch_edit(clixon_handle               h,
+                    netsnmp_agent_request_info *reqinfo,
+                    cxobj                      *xtop)
+{
+    int                    retval = -1;
+    struct snmp_set_batch *sb;
+    char                  *reason = NULL;
+    int                    ret;
+
+    if (snmp_set_batch_get(h, reqinfo, &sb) < 0)
+        goto done;
+    if (sb->sb_xedit == NULL){
+        if ((sb->sb_xedit = xml_new(NETCONF_INPUT_CONFIG, NULL, CX_ELMNT)) == NULL)
+            goto done;
+    }
+    if ((ret = xml_merge1(sb->sb_xedit, xtop, clicon_dbspec_yang(h), 0, &reason)) < 0)
+        goto done;
+    if (ret == 0){
+        clixon_err(OE_XML, 0, "Merge SNMP set: %s", reason);
+        goto done;
+    }
+    retval = 0;
+ done:
+    if (reason)
+        free(reason);
+    return retval;
+}
+
+/*! Send the set batch to the backend and validate it
+ *
+ * @param[in]  h       Clixon handle
+ * @param[in]  sb      Set batch
+ * @param[in]  request The netsnmp request info structure, error is set here
+ * @retval     1       OK
+ * @retval     0       Validation failed, candidate discarded, error set in request
+ * @retval    -1       Error
+ */
+static int
+snmp_set_batch_send(clixon_handle          h,
+                    struct snmp_set_batch *sb,
+                    netsnmp_request_info  *request)
+{
+    int   retval = -1;
+    cbuf *cb = NULL;
+    int   ret;
+
+    sb->sb_sent = 1;
+    if (sb->sb_xedit && xml_child_nr_type(sb->sb_xedit, CX_ELMNT)){
+        if ((cb = cbuf_new()) == NULL){
+            clixon_err(OE_UNIX, errno, "cbuf_new");
+            goto done;
+        }
+        if (clixon_xml2cbuf(cb, sb->sb_xedit, 0, 0, NULL, -1, 0) < 0)
+            goto done;
+        if (clicon_rpc_edit_config(h, "candidate", OP_MERGE, cbuf_get(cb)) < 0)
+            goto done;
+    }
+    /*
+     * There does not seem to be a separate validation action and commit does not
+     * return an error.
+     * Therefore validation is done here directly as well as discard if it fails.
+     */
+    if ((ret = clicon_rpc_validate(h, "candidate")) < 0)
+        goto done;
+    if (ret == 0){
+        clicon_rpc_discard_changes(h);
+        sb->sb_done = 1;
+        netsnmp_request_set_error(request, SNMP_ERR_COMMITFAILED);
+        goto fail;
+    }
+    retval = 1;
+ done:
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! SET ACTION of one varbind is done, send batch when all varbinds of the PDU are done
+ *
+ * The edits of all varbinds of a PDU are sent as one edit-config and validated once,
+ * in the ACTION of the last varbind so that a validation error is returned to the client.
+ * @param[in]  h       Clixon handle
+ * @param[in]  reqinfo Agent transaction request structure
+ * @param[in]  request The netsnmp request info structure.
+ * @retval     1       OK
+ * @retval     0       Validation failed, error set in request
+ * @retval    -1       Error
+ */
+static int
+snmp_set_batch_action(clixon_handle               h,
+                      netsnmp_agent_request_info *reqinfo,
+                      netsnmp_request_info       *request)
+{
+    int                    retval = -1;
+    struct snmp_set_batch *sb;
+    int                    nvb = 1;
+
+    if (snmp_set_batch_get(h, reqinfo, &sb) < 0)
+        goto done;
+    if (reqinfo->asp)
+        nvb = reqinfo->asp->vbcount;
+    sb->sb_nvb++;
+    if (sb->sb_nvb < nvb || sb->sb_sent){
+        retval = 1;
+        goto done;
+    }
+    retval = snmp_set_batch_send(h, sb, request);
+ done:
+    return retval;
+}
+
+/*! SET COMMIT, commit the set batch once per PDU
+ *
+ * If an ACTION failed before all varbinds were handled, the batch is sent here
+ * @param[in]  h       Clixon handle
+ * @param[in]  reqinfo Agent transaction request structure
+ * @param[in]  request The netsnmp request info structure.
+ * @retval     1       OK
+ * @retval     0       Commit failed, error set in request
+ * @retval    -1       Error
+ */
+static int
+snmp_set_batch_commit(clixon_handle               h,
+                      netsnmp_agent_request_info *reqinfo,
+                      netsnmp_request_info       *request)
+{
+    int                    retval = -1;
+    struct snmp_set_batch *sb;
+    int                    ret;
+
+    if (snmp_set_batch_get(h, reqinfo, &sb) < 0)
+        goto done;
+    if (sb->sb_done)
+        goto ok;
+    if (!sb->sb_sent){
+        if ((ret = snmp_set_batch_send(h, sb, request)) < 0)
+            goto done;
+        if (ret == 0)
+            goto fail;
+    }
+    sb->sb_done = 1;
+    if ((ret = clicon_rpc_commit(h, 0, 0, 0, NULL, NULL)) < 0)
+        goto done;
+    if (ret == 0){
+        /* Note that error given in commit is not propagated to the snmp client,
+         * therefore validation is in the ACTION instead
+         */
+        clicon_rpc_discard_changes(h);
+        netsnmp_request_set_error(request, SNMP_ERR_COMMITFAILED);
+        goto fail;
+    }
+ ok:
+    retval = 1;
+ done:
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! SET UNDO, discard the set batch once per PDU
+ *
+ * @param[in]  h       Clixon handle
+ * @param[in]  reqinfo Agent transaction request structure
+ * @retval     0       OK
+ * @retval    -1       Error
+ */
+static int
+snmp_set_batch_undo(clixon_handle               h,
+                    netsnmp_agent_request_info *reqinfo)
+{
+    int                    retval = -1;
+    struct snmp_set_batch *sb;
+
+    if (snmp_set_batch_get(h, reqinfo, &sb) < 0)
+        goto done;
+    if (!sb->sb_done){
+        sb->sb_done = 1;
+        if (sb->sb_sent && clicon_rpc_discard_changes(h) < 0)
+            goto done;
+    }
+    retval = 0;
+ done:
+    return retval;
+}
+
 /*! Scalar handler, get a value from clixon
  *
  * @param[in]  h          Clixon handle
@@ -408,10 +674,8 @@ snmp_scalar_set(clixon_handle               h,
     cxobj     *xbot = NULL;
     cxobj     *xb;
     char      *valstr = NULL;
-    cbuf      *cb = NULL;
     netsnmp_variable_list *requestvb = request->requestvb;
     int        asn1_type;
-    enum operation_type op = OP_MERGE;
     int        ret;
 
     clixon_debug(CLIXON_DBG_SNMP, "");
@@ -436,19 +700,11 @@ snmp_scalar_set(clixon_handle               h,
         if (xml_value_set(xb, valstr) < 0)
             goto done;
     }
-    if ((cb = cbuf_new()) == NULL){
-        clixon_err(OE_UNIX, errno, "cbuf_new");
-        goto done;
-    }
-    if (clixon_xml2cbuf(cb, xtop, 0, 0, NULL, -1, 0) < 0)
-        goto done;
-    if (clicon_rpc_edit_config(h, "candidate", op, cbuf_get(cb)) < 0)
+    if (snmp_set_batch_edit(h, reqinfo, xtop) < 0)
         goto done;
  ok:
     retval = 0;
  done:
-    if (cb)
-        cbuf_free(cb);
     if (xtop)
         xml_free(xtop);
     if (valstr)
@@ -459,26 +715,27 @@ snmp_scalar_set(clixon_handle               h,
 /* Make cache row operation: move to backend, remove altogether
  *
  * Remove row from cache, then make merge or delete operation on backend.
- * @param[in]  h     Clixon handle
- * @param[in]  yp    Yang statement of list / parent of leaf
- * @param[in]  cvk   Vector of index/Key variables
- * @param[in]  opstr Operation on row: merge or delete
- * @param[in]  rpc   If 0: do not make backend RPC, 1: do make backend RPC
- * @retval     0     OK
- * @retval    -1     Error
+ * @param[in]  h       Clixon handle
+ * @param[in]  yp      Yang statement of list / parent of leaf
+ * @param[in]  cvk     Vector of index/Key variables
+ * @param[in]  opstr   Operation on row: merge or delete
+ * @param[in]  rpc     If 0: do not make backend edit, 1: add edit to set batch
+ * @param[in]  reqinfo Agent transaction request structure
+ * @retval     0       OK
+ * @retval    -1       Error
  */
 static int
-snmp_cache_row_op(clixon_handle h,
-                  yang_stmt    *yp,
-                  cvec         *cvk,
-                  char         *opstr,
-                  int           rpc)
+snmp_cache_row_op(clixon_handle               h,
+                  yang_stmt                  *yp,
+                  cvec                       *cvk,
+                  char                       *opstr,
+                  int                         rpc,
+                  netsnmp_agent_request_info *reqinfo)
 {
     int    retval = -1;
-    char  *xpath;
+    char  *xpath = NULL;
     cxobj *xrow = NULL;
     cvec  *nsc = NULL;
-    cbuf  *cb = NULL;
     cxobj *xtop = NULL;
     cxobj *xbot = NULL;
     cxobj *xa;
@@ -506,13 +763,7 @@ snmp_cache_row_op(clixon_handle h,
                 goto done;
             if (xml_addsub(xbot, xrow) < 0)
                 goto done;
-            if ((cb = cbuf_new()) == NULL){
-                clixon_err(OE_UNIX, errno, "cbuf_new");
-                goto done;
-            }
-            if (clixon_xml2cbuf(cb, xtop, 0, 0, NULL, -1, 0) < 0)
-                goto done;
-            if (clicon_rpc_edit_config(h, "candidate", OP_NONE, cbuf_get(cb)) < 0)
+            if (snmp_set_batch_edit(h, reqinfo, xtop) < 0)
                 goto done;
         }
         else
@@ -524,8 +775,6 @@ snmp_cache_row_op(clixon_handle h,
         xml_nsctx_free(nsc);
     if (xtop)
         xml_free(xtop);
-    if (cb)
-        cbuf_free(cb);
     if (xpath)
         free(xpath);
     return retval;
@@ -603,13 +852,13 @@ snmp_cache_set(clixon_handle               h,
         }
         else if (strcmp(valstr, "active") == 0){
             if (rowstatus == 5) /* createAndWait */
-                if (snmp_cache_row_op(h, yang_parent_get(ys), cvk, "merge", 1) < 0)
+                if (snmp_cache_row_op(h, yang_parent_get(ys), cvk, "merge", 1, reqinfo) < 0)
                     goto done;
         }
         else if (strcmp(valstr, "destroy") == 0){
             clixon_debug(CLIXON_DBG_SNMP, "%d", rowstatus);
             /* Don't send delete to backend if notInService(2)  */
-            if (snmp_cache_row_op(h, yang_parent_get(ys), cvk, "delete", rowstatus!=2) < 0)
+            if (snmp_cache_row_op(h, yang_parent_get(ys), cvk, "delete", rowstatus!=2, reqinfo) < 0)
                 goto done;
         }
     }
@@ -717,7 +966,12 @@ clixon_snmp_scalar_handler1(netsnmp_mib_handler          *handler,
     /* see net-snmp/agent/snmp_agent.h / net-snmp/library/snmp.h */
     switch (reqinfo->mode) {
     case MODE_GET:          /* 160 */
-        if (snmp_scalar_get(sh->sh_h, sh->sh_ys, sh->sh_cvk_orig,
+        if (sh->sh_asn1type == -1 &&
+            type_yang2asn1(sh->sh_ys, &sh->sh_asn1type, 1) < 0){
+            sh->sh_asn1type = -1;
+            goto done;
+        }
+        if (snmp_scalar_get(sh->sh_h, sh->sh_ys, sh->sh_nsc, sh->sh_xpath, sh->sh_asn1type,
                             sh->sh_default, reqinfo, request) < 0)
             goto done;
         break;
@@ -745,35 +999,22 @@ clixon_snmp_scalar_handler1(netsnmp_mib_handler          *handler,
     case MODE_SET_ACTION:   /* 2 */
         if (snmp_scalar_set(sh->sh_h, sh->sh_ys, NULL, NULL, reqinfo, request) < 0)
             goto done;
-        /*
-         * There does not seem to be a separate validation action and commit does not
-         * return an error.
-         * Therefore validation is done here directly as well as discard if it fails.
-         */
-        if ((ret = clicon_rpc_validate(sh->sh_h, "candidate")) < 0)
+        /* Edits are batched, sent and validated after last varbind of PDU */
+        if ((ret = snmp_set_batch_action(sh->sh_h, reqinfo, request)) < 0)
             goto done;
-        if (ret == 0){
-            clicon_rpc_discard_changes(sh->sh_h);
-            netsnmp_request_set_error(request, SNMP_ERR_COMMITFAILED);
+        if (ret == 0)
             goto done;
-        }
         break;
     case MODE_SET_COMMIT:   /* 3 */
-        if ((ret = clicon_rpc_commit(sh->sh_h, 0, 0, 0, NULL, NULL)) < 0)
+        if ((ret = snmp_set_batch_commit(sh->sh_h, reqinfo, request)) < 0)
             goto done;
-        if (ret == 0){
-            /* Note that error given in commit is not propagated to the snmp client,
-             * therefore validation is in the ACTION instead
-             */
-            clicon_rpc_discard_changes(sh->sh_h);
-            netsnmp_request_set_error(request, SNMP_ERR_COMMITFAILED);
+        if (ret == 0)
             goto done;
-        }
         break;
     case MODE_SET_FREE:     /* 4 */
         break;
     case MODE_SET_UNDO:     /* 5 */
-        if (clicon_rpc_discard_changes(sh->sh_h) < 0)
+        if (snmp_set_batch_undo(sh->sh_h, reqinfo) < 0)
             goto done;
         break;
     }
@@ -784,6 +1025,33 @@ clixon_snmp_scalar_handler1(netsnmp_mib_handler          *handler,
     return retval;
 }
 
+/*! Add wall time since t0 to accumulated handler time
+ *
+ * @param[in]  t0   Start time
+ */
+static void
+snmp_handler_usec_add(struct timeval *t0)
+{
+    struct timeval t;
+
+    gettimeofday(&t, NULL);
+    timersub(&t, t0, &t);
+    _snmp_handler_usec += (uint64_t)t.tv_sec*1000000 + t.tv_usec;
+}
+
+/*! Get accumulated wall time of clixon scalar and table handlers
+ *
+ * Includes getnext cache handling and backend rpcs made by the handlers.
+ * A caller may take the difference of two calls.
+ * @param[out]  usec  Wall time in microseconds
+ * @see clicon_rpc_stats_get  for the backend rpc part
+ */
+void
+clixon_snmp_handler_usec(uint64_t *usec)
+{
+    *usec = _snmp_handler_usec;
+}
+
 /*! Top level scalar request handler, loop over individual request
  *
  * @param[in]  handler      Registered MIB handler structure
@@ -802,9 +1070,11 @@ clixon_snmp_scalar_handler(netsnmp_mib_handler          *handler,
 {
     int                   retval = -1;
     netsnmp_request_info *req;
+    struct timeval        t0;
     int                   ret;
 
     clixon_debug(CLIXON_DBG_SNMP, "");
+    gettimeofday(&t0, NULL);
     for (req = requests; req; req = req->next){
         ret = clixon_snmp_scalar_handler1(handler, nhreg, reqinfo, req);
         if (ret != SNMP_ERR_NOERROR){
@@ -815,18 +1085,18 @@ clixon_snmp_scalar_handler(netsnmp_mib_handler          *handler,
     }
     retval = SNMP_ERR_NOERROR;
  done:
+    snmp_handler_usec_add(&t0);
     return retval;
 }
 
 /*! Create xpath from YANG table OID + 1 + n + cvk/key = requestvb->name 
  *
- * Get yang of leaf from first part of OID
+ * Get column of leaf from first part of OID
  * Create xpath with right keys from later part of OID
  * Query clixon if object exists, if so return value
+ * Columns and keys are precomputed, see snmp_handle_compile
  * @param[in]  h        Clixon handle
- * @param[in]  yt       Yang of table (of list type)
- * @param[in]  oidt     OID of registered top container object (above list), may be different from yt
- * @param[in]  oidtlen  OID length of list object OID
+ * @param[in]  sh       Clixon snmp handle of table
  * @param[in]  oids     OID of ultimate scalar value
  * @param[in]  oidslen  OID length of scalar
  * @param[in]  reqinfo  Agent transaction request structure
@@ -837,59 +1107,41 @@ clixon_snmp_scalar_handler(netsnmp_mib_handler          *handler,
  */
 static int
 snmp_table_get(clixon_handle               h,
-               yang_stmt                  *yt,
-               oid                        *oidt,
-               size_t                      oidtlen,
+               clixon_snmp_handle         *sh,
                oid                        *oids,
                size_t                      oidslen,
                netsnmp_agent_request_info *reqinfo,
                netsnmp_request_info       *request)
 {
-    int        retval = -1;
-    oid        oidleaf[MAX_OID_LEN] = {0,}; /* Leaf */
-    size_t     oidleaflen = MAX_OID_LEN;
-    oid       *oidi;
-    size_t     oidilen;
-    yang_stmt *ys;
-    yang_stmt *yk;
-    char      *xpath = NULL;
-    cvec      *cvk_orig;
-    cvec      *cvk_val = NULL;
-    int        i;
-    cg_var    *cv;
-    char      *defaultval = NULL;
-    int        inext;
-    int        ret;
+    int                 retval = -1;
+    size_t              oidtlen = sh->sh_oid2len; /* OID of registered top container */
+    oid                *oidi;
+    size_t              oidilen;
+    struct snmp_column *sc = NULL;
+    cvec               *cvk_orig;
+    cvec               *cvk_val = NULL;
+    cbuf               *cb = NULL;
+    int                 asn1type;
+    int                 i;
+    cg_var             *cv;
 
-    /* Get yang of leaf from first part of OID */
-    inext = 0;
-    while ((ys = yn_iter(yt, &inext)) != NULL) {
-        if (yang_keyword_get(ys) != Y_LEAF)
-            continue;
-        /* reset oid */
-        oidleaflen = MAX_OID_LEN;
-        if ((ret = yangext_oid_get(ys, oidleaf, &oidleaflen, NULL)) < 0)
-            goto done;
-        if (ret == 0)
-            continue;
-        if (oidtlen + 1 != oidleaflen) /* Indexes may be from other OID scope, skip those */
+    /* Get column of leaf from first part of OID */
+    for (i=0; i<sh->sh_ncols; i++){
+        sc = &sh->sh_cols[i];
+        if (oidtlen + 1 != sc->sc_oidlen) /* Indexes may be from other OID scope, skip those */
             continue;
-        if (oids[oidleaflen-1] == oidleaf[oidleaflen-1])
+        if (oidslen >= sc->sc_oidlen &&
+            oids[sc->sc_oidlen-1] == sc->sc_oid[sc->sc_oidlen-1])
             break;
     }
-    if (ys == NULL){
+    if (i == sh->sh_ncols){
         /* No leaf with matching OID */
         goto fail;
     }
-    /* SMI default value, How is this different from yang defaults?
-     */
-    if (yang_extension_value_opt(ys, "smiv2:defval", NULL, &defaultval) < 0)
-        goto done;
-
     /* Create xpath with right keys from later part of OID 
      * Inverse of snmp_str2oid
      */
-    if ((cvk_orig = yang_cvec_get(yt)) == NULL){
+    if ((cvk_orig = yang_cvec_get(sh->sh_ys)) == NULL){
         clixon_err(OE_YANG, 0, "No keys");
         goto done;
     }
@@ -901,22 +1153,35 @@ snmp_table_get(clixon_handle               h,
     oidilen = oidslen-(oidtlen+1);
     oidi = oids+oidtlen+1;
     /* Add keys */
-    for (i=0; i<cvec_len(cvk_val); i++){
+    for (i=0; i<sh->sh_nkeys; i++){
         cv = cvec_i(cvk_val, i);
-        if ((yk = yang_find(yt, Y_LEAF, cv_string_get(cv))) == NULL){
-            clixon_err(OE_YANG, 0, "List key %s not found", cv_string_get(cv));
-            goto done;
-        }
-        if (snmp_oid2str(&oidi, &oidilen, yk, cv) < 0)
+        if (snmp_oid2str(&oidi, &oidilen, sh->sh_keys[i], cv) < 0)
             goto done;
     }
     if (oidilen != 0){
         clixon_err(OE_YANG, 0, "Expected oidlen 0 but is %zu", oidilen);
         goto fail;
     }
+    if ((cb = cbuf_new()) == NULL){
+        clixon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    cprintf(cb, "%s", sh->sh_xpath);
+    for (i=0; i<sh->sh_nkeys; i++){
+        cprintf(cb, "[");
+        if (sh->sh_keyprefix)
+            cprintf(cb, "%s:", sh->sh_keyprefix);
+        cprintf(cb, "%s='%s']", cv_string_get(cvec_i(cvk_orig, i)), cv_string_get(cvec_i(cvk_val, i)));
+    }
+    cprintf(cb, "/");
+    if (sc->sc_prefix)
+        cprintf(cb, "%s:", sc->sc_prefix);
+    cprintf(cb, "%s", yang_argument_get(sc->sc_ys));
+    if (snmp_column_asn1type(sc, &asn1type) < 0)
+        goto done;
     /* Get scalar value */
-    if (snmp_scalar_get(h, ys, cvk_val,
-                        defaultval,
+    if (snmp_scalar_get(h, sc->sc_ys, sc->sc_nsc, cbuf_get(cb), asn1type,
+                        sc->sc_defval,
                         reqinfo,
                         request) < 0)
         goto done;
@@ -925,8 +1190,8 @@ snmp_table_get(clixon_handle               h,
  done:
     if (cvk_val)
         cvec_free(cvk_val);
-    if (xpath)
-        free(xpath);
+    if (cb)
+        cbuf_free(cb);
     return retval;
  fail:
     retval = 0;
@@ -1149,77 +1414,296 @@ snmp_table_set(clixon_handle               h,
     goto done;
 }
 
+/*! Free OID index of a getnext cache entry
+ *
+ * @param[in]  sg   Getnext cache entry
+ */
+static void
+table_getnext_index_free(struct snmp_getnext_cache *sg)
+{
+    int i;
+
+    if (sg->sg_index){
+        for (i=0; i<sg->sg_indexlen; i++)
+            if (sg->sg_index[i].so_oid)
+                free(sg->sg_index[i].so_oid);
+        free(sg->sg_index);
+        sg->sg_index = NULL;
+    }
+    sg->sg_indexlen = 0;
+    sg->sg_ylist = NULL;
+}
+
+/*! Free index and XML of a getnext cache entry
+ *
+ * @param[in]  sg   Getnext cache entry
+ */
+static void
+table_getnext_cache_clear(struct snmp_getnext_cache *sg)
+{
+    table_getnext_index_free(sg);
+    if (sg->sg_xml){
+        xml_free(sg->sg_xml);
+        sg->sg_xml = NULL;
+    }
+    timerclear(&sg->sg_timer);
+}
+
+/*! Get cache time-to-live of the tables of a MIB in us
+ *
+ * CLICON_SNMP_CACHE_TTL is a list of ms, where a plain number is the default and
+ * <MIB>=<ms> is for a specific MIB, eg: "1000 IF-MIB=5000"
+ * @param[in]  h      Clixon handle
+ * @param[in]  ylist  YANG of table
+ * @param[out] ttl    Time-to-live in us
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+static int
+table_getnext_ttl(clixon_handle h,
+                  yang_stmt    *ylist,
+                  int64_t      *ttl)
+{
+    int        retval = -1;
+    char      *str;
+    char     **vec = NULL;
+    int        nvec;
+    char      *v;
+    char      *mib = NULL;
+    char      *eq;
+    yang_stmt *ymod;
+    int        i;
+    uint32_t   ms = 1000;
+    char      *reason = NULL;
+    int        ret;
+
+    if ((ymod = ys_module(ylist)) != NULL)
+        mib = yang_argument_get(ymod);
+    if ((str = clicon_option_str(h, "CLICON_SNMP_CACHE_TTL")) != NULL){
+        if ((vec = clixon_strsep3(str, " ", &nvec)) == NULL)
+            goto done;
+        for (i=0; i<nvec; i++){
+            v = vec[i];
+            if (*v == '\0')
+                continue;
+            if ((eq = index(v, '=')) != NULL){
+                if (mib == NULL || strlen(mib) != eq - v || strncmp(mib, v, eq - v) != 0)
+                    continue;
+                v = eq + 1;
+            }
+            if ((ret = parse_uint32(v, &ms, &reason)) < 0){
+                clixon_err(OE_CFG, errno, "parse_uint32");
+                goto done;
+            }
+            if (ret == 0){
+                clixon_err(OE_CFG, EINVAL, "CLICON_SNMP_CACHE_TTL: %s: %s", vec[i], reason);
+                goto done;
+            }
+            if (eq != NULL)
+                break; /* MIB-specific value takes precedence */
+        }
+    }
+    *ttl = (int64_t)ms*1000;
+    retval = 0;
+ done:
+    if (reason)
+        free(reason);
+    if (vec)
+        free(vec);
+    return retval;
+}
+
+/*! Compare two getnext cache index entries, for qsort
+ */
+static int
+table_getnext_oid_cmp(const void *a,
+                      const void *b)
+{
+    const struct snmp_getnext_oid *so0 = a;
+    const struct snmp_getnext_oid *so1 = b;
+
+    return oid_eq(so0->so_oid, so0->so_oidlen, so1->so_oid, so1->so_oidlen);
+}
+
+/*! Build sorted OID index of all columns of all rows of a cached table
+ *
+ * @param[in]  sg     Getnext cache entry
+ * @param[in]  sh     Clixon snmp handle of table
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+static int
+table_getnext_index(struct snmp_getnext_cache *sg,
+                    clixon_snmp_handle        *sh)
+{
+    int                      retval = -1;
+    yang_stmt               *ylist = sh->sh_ys;
+    cxobj                   *xtable;
+    cxobj                   *xrow;
+    cxobj                   *xcol;
+    yang_stmt               *ycol;
+    cvec                    *cvk_name;
+    oid                      oidc[MAX_OID_LEN] = {0,}; /* Table / list oid */
+    size_t                   oidclen = MAX_OID_LEN;
+    oid                      oidk[MAX_OID_LEN] = {0,}; /* Key oid */
+    size_t                   oidklen = MAX_OID_LEN;
+    struct snmp_getnext_oid *so;
+    int                      len = 0;
+    yang_stmt               *yprev = NULL;
+    struct snmp_column      *sc = NULL;
+    int                      asn1type = 0;
+    int                      ret;
+
+    sg->sg_ylist = ylist;
+    /* Rows are the children of the table container */
+    if ((xrow = xpath_first(sg->sg_xml, sh->sh_nsc, "%s", sg->sg_xpath)) == NULL ||
+        (xtable = xml_parent(xrow)) == NULL)
+        goto ok;
+    /* Make a clone of key-list, but replace names with values */
+    if ((cvk_name = yang_cvec_get(ylist)) == NULL){
+        clixon_err(OE_YANG, 0, "No keys");
+        goto done;
+    }
+    xrow = NULL;
+    while ((xrow = xml_child_each(xtable, xrow, CX_ELMNT)) != NULL)
+        len += xml_child_nr_type(xrow, CX_ELMNT);
+    if (len == 0)
+        goto ok;
+    if ((sg->sg_index = calloc(len, sizeof(*sg->sg_index))) == NULL){
+        clixon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    xrow = NULL;
+    while ((xrow = xml_child_each(xtable, xrow, CX_ELMNT)) != NULL) {
+        /* Get key part of OID from XML list entry */
+        if ((ret = snmp_xmlkey2val_oid(xrow, cvk_name, NULL, oidk, &oidklen)) < 0)
+            goto done;
+        if (ret == 0)
+            continue; /* skip row, not all indexes */
+        xcol = NULL;
+        while ((xcol = xml_child_each(xrow, xcol, CX_ELMNT)) != NULL) {
+            if ((ycol = xml_spec(xcol)) == NULL)
+                continue;
+            if (yang_keyword_get(ycol) != Y_LEAF)
+                continue;
+            /* Columns are mostly in the same order in each row */
+            if (ycol != yprev){
+                if ((sc = snmp_column_find(sh, ycol)) == NULL)
+                    continue; /* No OID */
+                if (snmp_column_asn1type(sc, &asn1type) < 0)
+                    goto done;
+                yprev = ycol;
+            }
+            /* Append key oid */
+            memcpy(oidc, sc->sc_oid, sc->sc_oidlen*sizeof(*oidc));
+            oidclen = sc->sc_oidlen;
+            if (oid_append(oidc, &oidclen, oidk, oidklen) < 0)
+                goto done;
+            so = &sg->sg_index[sg->sg_indexlen];
+            if ((so->so_oid = malloc(oidclen*sizeof(*oidc))) == NULL){
+                clixon_err(OE_UNIX, errno, "malloc");
+                goto done;
+            }
+            memcpy(so->so_oid, oidc, oidclen*sizeof(*oidc));
+            so->so_oidlen = oidclen;
+            so->so_xcol = xcol;
+            so->so_ycol = ycol;
+            so->so_asn1type = asn1type;
+            so->so_defval = sc->sc_defval;
+            sg->sg_indexlen++;
+        } /* while xcol */
+    } /* while xrow */
+    qsort(sg->sg_index, sg->sg_indexlen, sizeof(*sg->sg_index), table_getnext_oid_cmp);
+ ok:
+    retval = 0;
+ done:
+    return retval;
+}
+
 /*! Use a cache for getnext tables instead of an RPC to the backend every time
  *
- * The cache works as follows:
- * It has three parts:
- * - xpath     Of the requested YANG
+ * The cache has one entry per table xpath, each with:
  * - xml tree  Saved from previous rpc to this xpath
  * - timestamp Time of last rpc call for this xpath
- * On a new call, the cache is used if:
- * - the cache exist, and
- * - the xpath is the same as the requested xpath, and
- * - the age of the cache entry is less than a threshold
+ * - index     OIDs of all columns of all rows, sorted
+ * On a new call, the entry is used if:
+ * - the entry exists, and
+ * - the age of the entry is not more than the TTL of its MIB, see CLICON_SNMP_CACHE_TTL, or
+ *   the entry was fetched for the same SNMP PDU, eg the repetitions of a GETBULK
+ * All entries are invalidated on commit, see clixon_snmp_table_invalidate
  * @param[in]  h      Clixon handle
- * @param[in]  xpath  XPath of requetsed YANG
- * @param[in]  nsc    Namespace context
- * @param[out] xt     XML, either cached or new, dont free
+ * @param[in]  sh     Clixon snmp handle of table
+ * @param[in]  reqid  Request id of SNMP PDU
+ * @param[out] sgp    Cache entry, either cached or new, dont free
  * @retval     0      OK
  * @retval    -1      Error
  */
-#define GETNEXT_THRESHOLD_US 1000000
 static int
-table_getnext_cache(clixon_handle h,
-                    char         *xpath,
-                    cvec         *nsc,
-                    cxobj       **xtp)
+table_getnext_cache(clixon_handle               h,
+                    clixon_snmp_handle         *sh,
+                    long                        reqid,
+                    struct snmp_getnext_cache **sgp)
 {
     int                        retval = -1;
+    char                      *xpath = sh->sh_xpath;
     cxobj                     *xerr;
     cxobj                     *xt = NULL;
     int64_t                    tdiff_us = 0;
+    int64_t                    ttl_us;
     struct timeval             now;
     struct timeval             td;
-    struct snmp_getnext_cache *sg = NULL;
+    struct snmp_getnext_cache *sglist = NULL;
+    struct snmp_getnext_cache *sg;
 
-    clicon_ptr_get(h, "snmp-getnext-cache", (void**)&sg);
+    clicon_ptr_get(h, "snmp-getnext-cache", (void**)&sglist);
+    if ((sg = sglist) != NULL){
+        do {
+            if (strcmp(xpath, sg->sg_xpath) == 0)
+                break;
+            sg = NEXTQ(struct snmp_getnext_cache *, sg);
+        } while (sg != sglist);
+        if (strcmp(xpath, sg->sg_xpath) != 0)
+            sg = NULL;
+    }
     if (sg == NULL){
         if ((sg = calloc(1, sizeof(*sg))) == NULL){
             clixon_err(OE_UNIX, errno, "calloc");
             goto done;
         }
-        clicon_ptr_set(h, "snmp-getnext-cache", sg);
+        if ((sg->sg_xpath = strdup(xpath)) == NULL){
+            clixon_err(OE_UNIX, errno, "strdup");
+            free(sg);
+            goto done;
+        }
+        ADDQ(sg, sglist);
+        clicon_ptr_set(h, "snmp-getnext-cache", sglist);
     }
+    if (table_getnext_ttl(h, sh->sh_ys, &ttl_us) < 0)
+        goto done;
     if (timerisset(&sg->sg_timer)){
         gettimeofday(&now, NULL);
         timersub(&now, &sg->sg_timer, &td);
         tdiff_us = 1000000*td.tv_sec + td.tv_usec;
     }
-    if (sg->sg_xml == NULL || sg->sg_xpath == NULL ||
-        strcmp(xpath, sg->sg_xpath) != 0 || tdiff_us > 1000000){ // gettime
-        if (sg->sg_xml){
-            xml_free(sg->sg_xml);
-            sg->sg_xml = NULL;
-        }
-        if (sg->sg_xpath){
-            free(sg->sg_xpath);
-            sg->sg_xpath = NULL;
-        }
-        if (clicon_rpc_get(h, xpath, nsc, CONTENT_ALL, -1, NULL, &xt) < 0)
+    if (sg->sg_xml == NULL || (tdiff_us > ttl_us && reqid != sg->sg_reqid)){
+        table_getnext_cache_clear(sg);
+        if (clicon_rpc_get(h, xpath, sh->sh_nsc, CONTENT_ALL, -1, NULL, &xt) < 0)
             goto done;
         if ((xerr = xpath_first(xt, NULL, "/rpc-error")) != NULL){
             clixon_err_netconf(h, OE_NETCONF, 0, xerr, "Get configuration");
             goto done;
         }
         gettimeofday(&sg->sg_timer, NULL);
-        if ((sg->sg_xpath = strdup(xpath)) == NULL){
-            clixon_err(OE_UNIX, errno, "strdup");
-            goto done;
-        }
+        sg->sg_reqid = reqid;
         sg->sg_xml = xt;
         xt = NULL;
     }
-    *xtp = sg->sg_xml;
+    if (sg->sg_ylist != sh->sh_ys){
+        table_getnext_index_free(sg);
+        if (table_getnext_index(sg, sh) < 0)
+            goto done;
+    }
+    *sgp = sg;
     retval = 0;
  done:
     if (xt)
@@ -1229,8 +1713,11 @@ table_getnext_cache(clixon_handle h,
 
 /*! Find "next" object from oids minus key and return that.
  *
+ * Binary search in the sorted OID index of the cached table.
+ * GETBULK is made by netsnmp as repeated GETNEXT in the same PDU, which use the same
+ * cached table.
  * @param[in]  h        Clixon handle
- * @param[in]  ylist    Yang of table (of list type)
+ * @param[in]  sh       Clixon snmp handle of table
  * @param[in]  oids     OID of ultimate scalar value
  * @param[in]  oidslen  OID length of scalar
  * @param[in]  reqinfo  Agent transaction request structure
@@ -1238,107 +1725,59 @@ table_getnext_cache(clixon_handle h,
  * @retval     1        OK
  * @retval     0        Failed
  * @retval    -1        Error
- * XXX: merge with cache
  */
 static int
 snmp_table_getnext(clixon_handle               h,
-                   yang_stmt                  *ylist,
+                   clixon_snmp_handle         *sh,
                    oid                        *oids,
                    size_t                      oidslen,
                    netsnmp_agent_request_info *reqinfo,
                    netsnmp_request_info       *request)
 {
-    int        retval = -1;
-    cvec      *nsc = NULL;
-    char      *xpath = NULL;
-    cxobj     *xt = NULL;
-    cxobj     *xtable;
-    cxobj     *xrow;
-    cxobj     *xcol;
-    yang_stmt *ycol;
-    yang_stmt *ys;
-    cvec      *cvk_name;
-    oid        oidc[MAX_OID_LEN] = {0,}; /* Table / list oid */
-    size_t     oidclen = MAX_OID_LEN;
-    oid        oidk[MAX_OID_LEN] = {0,}; /* Key oid */
-    size_t     oidklen = MAX_OID_LEN;
-    oid        oidnext[MAX_OID_LEN] = {0x7fffffff,}; /* Next oid: start with high value */
-    size_t     oidnextlen = MAX_OID_LEN;
-    int        found = 0;
-    cxobj     *xnext = NULL;
-    yang_stmt *ynext = NULL;
-    cbuf      *cb = NULL;
-    int        ret;
+    int                        retval = -1;
+    struct snmp_getnext_cache *sg = NULL;
+    struct snmp_getnext_oid   *so;
+    long                       reqid = 0;
+    int                        lo;
+    int                        hi;
+    int                        mid;
+    int                        found = 0;
+    cbuf                      *cb = NULL;
 
     clixon_debug(CLIXON_DBG_SNMP, "");
-    if ((ys = yang_parent_get(ylist)) == NULL ||
-        yang_keyword_get(ys) != Y_CONTAINER){
-        clixon_err(OE_YANG, EINVAL, "ylist parent is not list");
-        goto done;
-    }
-    if (xml_nsctx_yang(ys, &nsc) < 0)
-        goto done;
-    if (snmp_yang2xpath(ys, NULL, &xpath) < 0)
-        goto done;
+    if (reqinfo->asp && reqinfo->asp->pdu)
+        reqid = reqinfo->asp->pdu->reqid;
     /* Get next via cache */
-    if (table_getnext_cache(h, xpath, nsc, &xt) < 0)
+    if (table_getnext_cache(h, sh, reqid, &sg) < 0)
         goto done;
-    if ((xtable = xpath_first(xt, nsc, "%s", xpath)) != NULL) {
-        /* Make a clone of key-list, but replace names with values */
-        if ((cvk_name = yang_cvec_get(ylist)) == NULL){
-            clixon_err(OE_YANG, 0, "No keys");
-            goto done;
-        }
-        xrow = NULL;
-        while ((xrow = xml_child_each(xtable, xrow, CX_ELMNT)) != NULL) {
-            /* Get key part of OID from XML list entry */
-            if ((ret = snmp_xmlkey2val_oid(xrow, cvk_name, NULL, /*&cvk_oid,*/ oidk, &oidklen)) < 0)
-                goto done;
-            if (ret == 0)
-                continue; /* skip row, not all indexes */
-            xcol = NULL;
-            while ((xcol = xml_child_each(xrow, xcol, CX_ELMNT)) != NULL) {
-                if ((ycol = xml_spec(xcol)) == NULL)
-                    continue;
-                if (yang_keyword_get(ycol) != Y_LEAF)
-                    continue;
-                if ((ret = yangext_oid_get(ycol, oidc, &oidclen, NULL)) < 0)
-                    goto done;
-                if (ret == 0)
-                    continue;
-                /* Append key oid */
-                if (oid_append(oidc, &oidclen, oidk, oidklen) < 0)
-                    goto done;
-                /* Get smallest larger */
-                if (oid_eq(oidc, oidclen, oids, oidslen) > 0 &&
-                    oid_eq(oidc, oidclen, oidnext, oidnextlen) < 0){
-                    memcpy(oidnext, oidc, oidclen*sizeof(*oidnext));
-                    oidnextlen = oidclen;
-                    xnext = xcol;
-                    ynext = ycol;
-                    found++;
-                }
-            } /* while xcol */
-        } /* while xrow */
-    }
-    if (found){
-        if (snmp_scalar_return(xnext, ynext, oidnext, oidnextlen, reqinfo, request) < 0)
+    /* Find first index entry larger than oids */
+    lo = 0;
+    hi = sg->sg_indexlen;
+    while (lo < hi){
+        mid = lo + (hi - lo)/2;
+        so = &sg->sg_index[mid];
+        if (oid_eq(so->so_oid, so->so_oidlen, oids, oidslen) <= 0)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    if (lo < sg->sg_indexlen){
+        found = 1;
+        so = &sg->sg_index[lo];
+        if (snmp_scalar_return(so->so_xcol, so->so_ycol, so->so_asn1type, so->so_defval,
+                               so->so_oid, so->so_oidlen, reqinfo, request) < 0)
             goto done;
         if ((cb = cbuf_new()) == NULL){
             clixon_err(OE_UNIX, errno, "cbuf_new");
             goto done;
         }
-        oid_cbuf(cb, oidnext, oidnextlen);
+        oid_cbuf(cb, so->so_oid, so->so_oidlen);
         clixon_debug(CLIXON_DBG_SNMP, "next: %s", cbuf_get(cb));
     }
     retval = found;
  done:
-    if (xpath)
-        free(xpath);
     if (cb)
         cbuf_free(cb);
-    if (nsc)
-        xml_nsctx_free(nsc);
     return retval;
 }
 
@@ -1378,8 +1817,7 @@ clixon_snmp_table_handler1(netsnmp_mib_handler          *handler,
     case MODE_GET: // 160
         /* Create xpath from YANG table OID + 1 + n + cvk/key = requestvb->name 
          */
-        if ((ret = snmp_table_get(sh->sh_h, sh->sh_ys,
-                                  sh->sh_oid2, sh->sh_oid2len,
+        if ((ret = snmp_table_get(sh->sh_h, sh,
                                   requestvb->name, requestvb->name_length,
                                   reqinfo, request)) < 0)
             goto done;
@@ -1393,7 +1831,7 @@ clixon_snmp_table_handler1(netsnmp_mib_handler          *handler,
         break;
     case MODE_GETNEXT: // 161
         /* Register table sub-oid:s of existing entries in clixon */
-        if ((ret = snmp_table_getnext(sh->sh_h, sh->sh_ys,
+        if ((ret = snmp_table_getnext(sh->sh_h, sh,
                                       requestvb->name, requestvb->name_length,
                                       reqinfo, request)) < 0)
             goto done;
@@ -1427,32 +1865,22 @@ clixon_snmp_table_handler1(netsnmp_mib_handler          *handler,
             }
             clixon_debug(CLIXON_DBG_SNMP, "Nosuchinstance");
         }
-        /*
-         * There does not seem to be a separate validation action and commit does not 
-         * return an error.
-         * Therefore validation is done here directly as well as discard if it fails.
-         */
-        if ((ret = clicon_rpc_validate(sh->sh_h, "candidate")) < 0)
+        /* Edits are batched, sent and validated after last varbind of PDU */
+        if ((ret = snmp_set_batch_action(sh->sh_h, reqinfo, request)) < 0)
             goto done;
-        if (ret == 0){
-            clicon_rpc_discard_changes(sh->sh_h);
-            netsnmp_request_set_error(request, SNMP_ERR_COMMITFAILED);
+        if (ret == 0)
             goto done;
-        }
         break;
     case MODE_SET_COMMIT:   // 3
-        if ((ret = clicon_rpc_commit(sh->sh_h, 0, 0, 0, NULL, NULL)) < 0)
+        if ((ret = snmp_set_batch_commit(sh->sh_h, reqinfo, request)) < 0)
             goto done;
-        if (ret == 0){
-            clicon_rpc_discard_changes(sh->sh_h);
-            netsnmp_request_set_error(request, SNMP_ERR_COMMITFAILED);
+        if (ret == 0)
             goto done;
-        }
         break;
     case MODE_SET_FREE:     // 4
         break;
     case MODE_SET_UNDO  :   // 5
-        if (clicon_rpc_discard_changes(sh->sh_h) < 0)
+        if (snmp_set_batch_undo(sh->sh_h, reqinfo) < 0)
             goto done;
         break;
     }
@@ -1486,9 +1914,11 @@ clixon_snmp_table_handler(netsnmp_mib_handler          *handler,
 {
     int                   retval = -1;
     netsnmp_request_info *req;
+    struct timeval        t0;
     int                   ret;
 
     clixon_debug(CLIXON_DBG_SNMP, "");
+    gettimeofday(&t0, NULL);
     for (req = requests; req; req = req->next){
         ret = clixon_snmp_table_handler1(handler, nhreg, reqinfo, req);
         if (ret != SNMP_ERR_NOERROR){
@@ -1499,22 +1929,55 @@ clixon_snmp_table_handler(netsnmp_mib_handler          *handler,
     }
     retval = SNMP_ERR_NOERROR;
  done:
+    snmp_handler_usec_add(&t0);
     return retval;
 }
 
+/*! Invalidate all getnext cache entries, eg on commit
+ *
+ * @param[in]  h   Clixon handle
+ * @retval     0   OK
+ */
+int
+clixon_snmp_table_invalidate(clixon_handle h)
+{
+    struct snmp_getnext_cache *sglist = NULL;
+    struct snmp_getnext_cache *sg;
+
+    if (clicon_ptr_get(h, "snmp-getnext-cache", (void**)&sglist) == 0 &&
+        (sg = sglist) != NULL){
+        do {
+            table_getnext_cache_clear(sg);
+            sg = NEXTQ(struct snmp_getnext_cache *, sg);
+        } while (sg != sglist);
+    }
+    return 0;
+}
+
 /*! Clear cache
  */
 int
 clixon_snmp_table_exit(clixon_handle h)
 {
-    struct snmp_getnext_cache *sg = NULL;
+    struct snmp_getnext_cache *sglist = NULL;
+    struct snmp_getnext_cache *sg;
+    struct snmp_set_batch     *sb = NULL;
 
-    if (clicon_ptr_get(h, "snmp-getnext-cache", (void**)&sg) == 0 && sg){
-        if (sg->sg_xml)
-            xml_free(sg->sg_xml);
-        if (sg->sg_xpath)
-            free(sg->sg_xpath);
-        free(sg);
+    if (clicon_ptr_get(h, "snmp-getnext-cache", (void**)&sglist) == 0){
+        while ((sg = sglist) != NULL){
+            DELQ(sg, sglist, struct snmp_getnext_cache *);
+            table_getnext_cache_clear(sg);
+            if (sg->sg_xpath)
+                free(sg->sg_xpath);
+            free(sg);
+        }
+        clicon_ptr_del(h, "snmp-getnext-cache");
+    }
+    if (clicon_ptr_get(h, "snmp-set-batch", (void**)&sb) == 0 && sb != NULL){
+        if (sb->sb_xedit)
+            xml_free(sb->sb_xedit);
+        free(sb);
+        clicon_ptr_del(h, "snmp-set-batch");
     }
     return 0;
 }
@@ -52,6 +52,8 @@ int clixon_snmp_scalar_handler(netsnmp_mib_handler          *handler,
                                netsnmp_handler_registration *nhreg,
                                netsnmp_agent_request_info   *reqinfo,
                                netsnmp_request_info         *requests);
+int clixon_snmp_table_invalidate(clixon_handle h);
+void clixon_snmp_handler_usec(uint64_t *usec);
 int clixon_snmp_table_exit(clixon_handle h);
 
 #endif /* _SNMP_HANDLER_H_ */
@@ -551,10 +551,23 @@ void
 snmp_handle_free(void *arg)
 {
     clixon_snmp_handle *sh = (clixon_snmp_handle *)arg;
+    int                 i;
 
     if (sh != NULL){
         if (sh->sh_cvk_orig)
             cvec_free(sh->sh_cvk_orig);
+        if (sh->sh_nsc)
+            xml_nsctx_free(sh->sh_nsc);
+        if (sh->sh_xpath)
+            free(sh->sh_xpath);
+        if (sh->sh_keys)
+            free(sh->sh_keys);
+        if (sh->sh_cols){
+            for (i=0; i<sh->sh_ncols; i++)
+                if (sh->sh_cols[i].sc_nsc)
+                    xml_nsctx_free(sh->sh_cols[i].sc_nsc);
+            free(sh->sh_cols);
+        }
         if (sh->sh_table_info){
             if (sh->sh_table_info->indexes){
                 snmp_free_varbind(sh->sh_table_info->indexes);
@@ -565,6 +578,156 @@ snmp_handle_free(void *arg)
     }
 }
 
+/*! Precompute OID, type and xpath translations of a registered handler
+ *
+ * Done once at registration instead of on each request.
+ * For a scalar (leaf): namespace context and xpath of the leaf
+ * For a table (list): namespace context of the table container, xpath of the list
+ * without keys, key leafs, and for each column leaf: OID, SMI default, prefix and
+ * namespace context. ASN.1 types are computed on first use.
+ * @param[in]  sh   Clixon snmp handle, sh_ys and sh_cvk_orig set
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+int
+snmp_handle_compile(clixon_snmp_handle *sh)
+{
+    int                 retval = -1;
+    yang_stmt          *ys = sh->sh_ys;
+    yang_stmt          *yp;
+    yang_stmt          *yc;
+    cvec               *cvk;
+    struct snmp_column *sc;
+    char               *xpath = NULL;
+    cbuf               *cb = NULL;
+    int                 inext;
+    int                 i;
+    int                 ret;
+
+    sh->sh_asn1type = -1;
+    if (yang_keyword_get(ys) != Y_LIST){
+        if (xml_nsctx_yang(ys, &sh->sh_nsc) < 0)
+            goto done;
+        if (snmp_yang2xpath(ys, sh->sh_cvk_orig, &sh->sh_xpath) < 0)
+            goto done;
+        goto ok;
+    }
+    if ((yp = yang_parent_get(ys)) == NULL ||
+        yang_keyword_get(yp) != Y_CONTAINER){
+        clixon_err(OE_YANG, EINVAL, "ylist parent is not container");
+        goto done;
+    }
+    if (xml_nsctx_yang(yp, &sh->sh_nsc) < 0)
+        goto done;
+    if (snmp_yang2xpath(yp, NULL, &xpath) < 0)
+        goto done;
+    if ((cb = cbuf_new()) == NULL){
+        clixon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    sh->sh_keyprefix = yang_find_myprefix(ys);
+    cprintf(cb, "%s/", xpath);
+    if (sh->sh_keyprefix)
+        cprintf(cb, "%s:", sh->sh_keyprefix);
+    cprintf(cb, "%s", yang_argument_get(ys));
+    if ((sh->sh_xpath = strdup(cbuf_get(cb))) == NULL){
+        clixon_err(OE_UNIX, errno, "strdup");
+        goto done;
+    }
+    /* Keys */
+    if ((cvk = yang_cvec_get(ys)) == NULL){
+        clixon_err(OE_YANG, 0, "No keys");
+        goto done;
+    }
+    if ((sh->sh_keys = calloc(cvec_len(cvk)+1, sizeof(*sh->sh_keys))) == NULL){
+        clixon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    for (i=0; i<cvec_len(cvk); i++){
+        if ((sh->sh_keys[i] = yang_find(ys, Y_LEAF, cv_string_get(cvec_i(cvk, i)))) == NULL){
+            clixon_err(OE_YANG, 0, "List key %s not found", cv_string_get(cvec_i(cvk, i)));
+            goto done;
+        }
+    }
+    sh->sh_nkeys = cvec_len(cvk);
+    /* Columns */
+    inext = 0;
+    while ((yc = yn_iter(ys, &inext)) != NULL)
+        if (yang_keyword_get(yc) == Y_LEAF)
+            sh->sh_ncols++;
+    if ((sh->sh_cols = calloc(sh->sh_ncols+1, sizeof(*sh->sh_cols))) == NULL){
+        clixon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    sh->sh_ncols = 0;
+    inext = 0;
+    while ((yc = yn_iter(ys, &inext)) != NULL){
+        if (yang_keyword_get(yc) != Y_LEAF)
+            continue;
+        sc = &sh->sh_cols[sh->sh_ncols];
+        sc->sc_oidlen = MAX_OID_LEN;
+        if ((ret = yangext_oid_get(yc, sc->sc_oid, &sc->sc_oidlen, NULL)) < 0)
+            goto done;
+        if (ret == 0)
+            continue;
+        sc->sc_ys = yc;
+        sc->sc_asn1type = -1;
+        if (yang_extension_value_opt(yc, "smiv2:defval", NULL, &sc->sc_defval) < 0)
+            goto done;
+        sc->sc_prefix = yang_find_myprefix(yc);
+        if (xml_nsctx_yang(yc, &sc->sc_nsc) < 0)
+            goto done;
+        sh->sh_ncols++;
+    }
+ ok:
+    retval = 0;
+ done:
+    if (xpath)
+        free(xpath);
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+}
+
+/*! Get ASN.1 type of a table column, computed on first use
+ *
+ * @param[in]  sc        Table column
+ * @param[out] asn1type  ASN.1 type id (extended)
+ * @retval     0         OK
+ * @retval    -1         Error
+ */
+int
+snmp_column_asn1type(struct snmp_column *sc,
+                     int                *asn1type)
+{
+    if (sc->sc_asn1type == -1 &&
+        type_yang2asn1(sc->sc_ys, &sc->sc_asn1type, 1) < 0){
+        sc->sc_asn1type = -1;
+        return -1;
+    }
+    *asn1type = sc->sc_asn1type;
+    return 0;
+}
+
+/*! Find table column of YANG leaf
+ *
+ * @param[in]  sh   Clixon snmp handle of table
+ * @param[in]  ys   YANG leaf
+ * @retval     sc   Table column
+ * @retval     NULL Not a column of the table
+ */
+struct snmp_column *
+snmp_column_find(clixon_snmp_handle *sh,
+                 yang_stmt          *ys)
+{
+    int i;
+
+    for (i=0; i<sh->sh_ncols; i++)
+        if (sh->sh_cols[i].sc_ys == ys)
+            return &sh->sh_cols[i];
+    return NULL;
+}
+
 /*! Translate from YANG to SNMP asn1.1 type ids (not value)
  *
  * @param[in]    ys         YANG leaf node
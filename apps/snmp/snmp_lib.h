@@ -65,6 +65,18 @@ extern "C" {
  */
 /* Userdata to pass around in netsmp callbacks
  */
+/*! Column of a table handler, precomputed at registration, see snmp_handle_compile
+ */
+struct snmp_column {
+    yang_stmt    *sc_ys;               /* YANG leaf of column */
+    oid           sc_oid[MAX_OID_LEN]; /* OID of column */
+    size_t        sc_oidlen;
+    int           sc_asn1type;         /* ASN.1 type (extended), -1 until first use */
+    char         *sc_defval;           /* SMI default value, or NULL */
+    char         *sc_prefix;           /* Prefix of column in xpath, or NULL */
+    cvec         *sc_nsc;              /* Namespace context of column */
+};
+
 struct clixon_snmp_handle {
     clixon_handle sh_h;
     yang_stmt    *sh_ys;               /* Leaf for scalar, list for table */
@@ -76,6 +88,15 @@ struct clixon_snmp_handle {
     cvec         *sh_cvk_orig;         /* Index/Key variable values (original) */
     netsnmp_table_registration_info *sh_table_info; /* To mimic table-handler in libnetsnmp code
                                                      * save only to free properly */
+    /* Precomputed at registration, see snmp_handle_compile */
+    cvec         *sh_nsc;              /* Namespace context of leaf, or container of table */
+    char         *sh_xpath;            /* XPath of leaf, or of list without keys for table */
+    int           sh_asn1type;         /* ASN.1 type (extended) of leaf, -1 until first use */
+    yang_stmt   **sh_keys;             /* Key leafs of table in key order */
+    int           sh_nkeys;
+    char         *sh_keyprefix;        /* Prefix of keys in xpath, or NULL */
+    struct snmp_column *sh_cols;       /* Columns of table in YANG order */
+    int           sh_ncols;
 };
 typedef struct clixon_snmp_handle clixon_snmp_handle;
 
@@ -94,6 +115,9 @@ int    snmp_access_str2int(char *modes_str);
 const char *snmp_msg_int2str(int msg);
 void  *snmp_handle_clone(void *arg);
 void   snmp_handle_free(void *arg);
+int    snmp_handle_compile(clixon_snmp_handle *sh);
+int    snmp_column_asn1type(struct snmp_column *sc, int *asn1type);
+struct snmp_column *snmp_column_find(clixon_snmp_handle *sh, yang_stmt *ys);
 int    type_yang2asn1(yang_stmt *ys, int *asn1_type, int extended);
 int    type_snmp2xml(yang_stmt                  *ys,
                      int                        *asn1type,
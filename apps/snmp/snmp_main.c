@@ -51,9 +51,12 @@
 #include <pwd.h>
 #include <syslog.h>
 #include <errno.h>
+#include <stdint.h>
+#include <inttypes.h>
 #include <signal.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/time.h>
 
 /* net-snmp */
 #include <net-snmp/net-snmp-config.h>
@@ -77,6 +80,41 @@
 /* Forward */
 static int clixon_snmp_input_cb(int s, void *arg);
 
+/*! Accumulated time of SNMP input, see CLICON_SNMP_TIMING
+ */
+struct snmp_timing {
+    uint64_t st_reads;        /* Number of snmp_read calls, typically one PDU each */
+    uint64_t st_read_usec;    /* Wall time of snmp_read, ie all PDU processing */
+    uint64_t st_handler_usec; /* Part of st_read_usec in clixon handlers */
+    uint64_t st_rpc_nr;       /* Number of backend rpcs of handlers */
+    uint64_t st_rpc_usec;     /* Part of st_handler_usec in backend rpcs */
+};
+
+static struct snmp_timing *_snmp_timing = NULL;
+
+/*! Log accumulated SNMP timing
+ *
+ * net-snmp is time in the agent library outside clixon handlers, cache is time in
+ * clixon handlers outside backend rpcs, eg getnext cache lookup and type translation
+ * @param[in]  st   SNMP timing
+ */
+static void
+clixon_snmp_timing_log(struct snmp_timing *st)
+{
+    uint64_t n = st->st_reads ? st->st_reads : 1;
+
+    clixon_log(NULL, LOG_NOTICE, "SNMP timing: %" PRIu64 " reads, %" PRIu64 " rpcs, "
+               "total %" PRIu64 " us: net-snmp %" PRIu64 " cache %" PRIu64 " backend %" PRIu64 " us, "
+               "per read: net-snmp %" PRIu64 " cache %" PRIu64 " backend %" PRIu64 " us",
+               st->st_reads, st->st_rpc_nr, st->st_read_usec,
+               st->st_read_usec - st->st_handler_usec,
+               st->st_handler_usec - st->st_rpc_usec,
+               st->st_rpc_usec,
+               (st->st_read_usec - st->st_handler_usec)/n,
+               (st->st_handler_usec - st->st_rpc_usec)/n,
+               st->st_rpc_usec/n);
+}
+
 /*! Return (hardcoded) pid file
  */
 static char*
@@ -113,6 +151,10 @@ snmp_terminate(clixon_handle h)
     cxobj     *x = NULL;
     char      *pidfile = clicon_snmp_pidfile(h);
 
+    if (_snmp_timing){
+        free(_snmp_timing);
+        _snmp_timing = NULL;
+    }
     clixon_snmp_stream_shutdown(h);
     snmp_shutdown(__func__);
     shutdown_agent();
@@ -129,8 +171,12 @@ snmp_terminate(clixon_handle h)
     if ((x = clicon_conf_xml(h)) != NULL)
         xml_free(x);
     xpath_optimize_exit();
+    xpath_parse_cache_exit();
+    api_path_cache_exit();
+    regex_cache_exit();
     clixon_event_exit();
     clixon_handle_exit(h);
+    xml_exit();
     clixon_debug_exit();
     clixon_err_exit();
     clixon_log_exit();
@@ -201,15 +247,40 @@ static int
 clixon_snmp_input_cb(int   s,
                      void *arg)
 {
-    int            retval = -1;
-    fd_set         readfds;
-    clixon_handle  h = (clixon_handle)arg;
-    int            ret;
+    int                 retval = -1;
+    fd_set              readfds;
+    clixon_handle       h = (clixon_handle)arg;
+    struct snmp_timing *st = _snmp_timing;
+    struct timeval      t0;
+    struct timeval      t1;
+    uint64_t            hu0 = 0;
+    uint64_t            hu1;
+    uint64_t            rn0 = 0;
+    uint64_t            rn1;
+    uint64_t            ru0 = 0;
+    uint64_t            ru1;
+    int                 ret;
 
     clixon_debug(CLIXON_DBG_SNMP | CLIXON_DBG_DETAIL, "%d", s);
     FD_ZERO(&readfds);
     FD_SET(s, &readfds);
+    if (st){
+        clixon_snmp_handler_usec(&hu0);
+        clicon_rpc_stats_get(&rn0, &ru0);
+        gettimeofday(&t0, NULL);
+    }
     (void)snmp_read(&readfds);
+    if (st){
+        gettimeofday(&t1, NULL);
+        timersub(&t1, &t0, &t1);
+        clixon_snmp_handler_usec(&hu1);
+        clicon_rpc_stats_get(&rn1, &ru1);
+        st->st_reads++;
+        st->st_read_usec += (uint64_t)t1.tv_sec*1000000 + t1.tv_usec;
+        st->st_handler_usec += hu1 - hu0;
+        st->st_rpc_nr += rn1 - rn0;
+        st->st_rpc_usec += ru1 - ru0;
+    }
     if (clixon_event_poll(s) < 0){
         if (errno == EBADF){
             clixon_err_reset();
@@ -608,6 +679,12 @@ main(int    argc,
     /* init snmp stream (traps) */
     if (clixon_snmp_stream_init(h) < 0)
         goto done;
+    if (clicon_option_bool(h, "CLICON_SNMP_TIMING")){
+        if ((_snmp_timing = calloc(1, sizeof(*_snmp_timing))) == NULL){
+            clixon_err(OE_UNIX, errno, "calloc");
+            goto done;
+        }
+    }
 
     /* Write pid-file */
     if (pidfile_write(pidfile) <  0)
@@ -616,6 +693,8 @@ main(int    argc,
     /* main event loop */
     if (clixon_event_loop(h) < 0)
         goto done;
+    if (_snmp_timing)
+        clixon_snmp_timing_log(_snmp_timing);
  ok:
     retval = 0;
  done:
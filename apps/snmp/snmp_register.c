@@ -168,6 +168,8 @@ mibyang_leaf_register(clixon_handle h,
         clixon_err(OE_UNIX, errno, "cvec_dup");
         goto done;
     }
+    if (snmp_handle_compile(sh) < 0)
+        goto done;
     /* Stateless function, just returns ptr */
     if ((nhreg = netsnmp_handler_registration_create(name, handler,
                                                      oid1, oid1len,
@@ -264,6 +266,8 @@ mibyang_table_register(clixon_handle h,
     sh->sh_oidlen = oid1len;
     memcpy(sh->sh_oid2, oid2, sizeof(*oid2)*oid2len);
     sh->sh_oid2len = oid2len;
+    if (snmp_handle_compile(sh) < 0)
+        goto done;
 
     if ((handler = netsnmp_create_handler(name, clixon_snmp_table_handler)) == NULL){
         clixon_err(OE_XML, errno, "netsnmp_create_handler");
@@ -54,6 +54,7 @@
 #include <net-snmp/agent/net-snmp-agent-includes.h>
 
 #include "snmp_lib.h"
+#include "snmp_handler.h"
 
 /* SNMP v2 notification OID
  */
@@ -315,6 +316,12 @@ snmp_stream_cb(int   s,
     /* forward notification(s) as snmp trap */
     while ((xncont = xml_child_each(xtop, xncont, CX_ELMNT)) != NULL){
         if (strcmp(xml_name(xncont), "notification") == 0) {
+            /* Commit on CONFIG-CHANGE stream: invalidate table cache, no trap */
+            if (xml_find_type(xncont, NULL, "config-change", CX_ELMNT) != NULL){
+                if (clixon_snmp_table_invalidate(h) < 0)
+                    goto done;
+                continue;
+            }
             if(snmp_publish_notification(h, xncont) < 0)
                 goto done;
         }
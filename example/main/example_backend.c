@@ -49,6 +49,8 @@
   *  -U  general-purpose upgrade
   *  -t  enable transaction logging (call syslog for every transaction)
   *  -V <xpath> Failing validate and commit if <xpath> is present (synthetic error)
+  *  -C <xpath> Failing commit whenever <xpath> is present (synthetic error)
+  *  -P  Transaction validate and commit callbacks are parallel-safe, see CA_PARALLEL_*
  * Note example_backend uses -v
  */
 #include <stdio.h>
@@ -73,7 +75,7 @@
 #include <clixon/clixon_backend.h>
 
 /* Command line options to be passed to getopt(3) */
-#define BACKEND_EXAMPLE_OPTS "a:m:M:n:o:O:rsS:x:iuUtV:"
+#define BACKEND_EXAMPLE_OPTS "a:A:B:cC:D:m:M:n:o:O:PrsS:T:x:iuUtV:"
 
 /* Enabling this improves performance in tests, but there may trigger the "double XPath"
  * problem.
@@ -89,6 +91,22 @@
  */
 static char *_action_instanceid = NULL;
 
+/*! Asynchronous example rpc
+ *
+ * Start backend with -- -A <ms>
+ * where <ms> is the delay of the reply of the example rpc, while other clients are served
+ * The rpc times out after twice the delay. If input x is "timeout" no reply is made.
+ */
+static int _rpc_async_ms = 0;
+
+/*! Slow plugin start in the background
+ *
+ * Start backend with -- -B <sec>
+ * where <sec> is the time the start callback takes, while read-only rpcs are served
+ * Do not combine with -a since the action is registered by the start callback
+ */
+static int _start_background_s = 0;
+
 /*! Yang schema mount
  *
  * Start backend with -- -m <yang> -M <namespace>
@@ -164,6 +182,30 @@ static int _state_file_cached = 0;
 static cxobj *_state_xml_cache = NULL; /* XML cache */
 static int _state_file_transaction = 0;
 
+/*! Count interface rows made by the state callback, for tests of state data caching
+ *
+ * If set, my-status/int of an interface is the number of rows made so far, instead of 42,
+ * and cached state data of the plugin is invalidated on commit
+ * Start backend with -- -sc
+ */
+static int _state_count = 0;
+static int _state_rows = 0;
+
+/*! Asynchronous state data
+ *
+ * Start backend with -- -sD <ms>
+ * where <ms> is the delay of the state data, while other clients are served
+ */
+static int _state_async_ms = 0;
+
+/*! State data subtree of the plugin, for tests of state data pruning
+ *
+ * Start backend with -- -sT <path>, eg -T /ietf-interfaces:interfaces
+ * The state callback is then only called for requests in or above <path>, and only makes
+ * the interface row of the request, if a name is given
+ */
+static const char *_state_subtrees[] = {NULL, NULL};
+
 /*! Variable to control module-specific upgrade callbacks.
  *
  * If set, call test-case for upgrading ietf-interfaces, otherwise call
@@ -200,6 +242,12 @@ static char *_validate_fail_xpath = NULL;
  */
 static int   _validate_fail_toggle = 0; /* fail at validate and commit */
 
+/*! Variable to trigger commit errors without sub state, for parallel-safe callbacks
+ *
+ * Start backend with -- -C <xpath>
+ */
+static char *_commit_fail_xpath = NULL;
+
 /* forward */
 static int example_stream_timer_setup(clixon_handle h, int sec);
 static int main_system_only_commit(clixon_handle h, transaction_data td);
@@ -275,6 +323,11 @@ main_commit(clixon_handle    h,
             goto done; /* simulate fail */
         }
     }
+    if (_commit_fail_xpath &&
+        xpath_first(transaction_target(td), NULL, "%s", _commit_fail_xpath)){
+        clixon_err(OE_XML, 0, "User commit error");
+        goto done; /* simulate fail */
+    }
 
     /* Create namespace context for xpath */
     if ((nsc = xml_nsctx_init(NULL, "urn:ietf:params:xml:ns:yang:ietf-interfaces")) == NULL)
@@ -299,6 +352,19 @@ main_commit(clixon_handle    h,
 int
 main_commit_done(clixon_handle    h,
                  transaction_data td)
+{
+    if (_transaction_log)
+        transaction_log(h, td, LOG_NOTICE, __func__);
+    /* Interface state depends on running */
+    if (_state_count &&
+        clixon_plugin_statedata_invalidate(h, "example_backend") < 0)
+        return -1;
+    return 0;
+}
+
+int
+main_commit_failed(clixon_handle    h,
+                   transaction_data td)
 {
     if (_transaction_log)
         transaction_log(h, td, LOG_NOTICE, __func__);
@@ -429,6 +495,81 @@ example_rpc(clixon_handle h,            /* Clixon handle */
     return retval;
 }
 
+/*! Deferred reply of asynchronous example rpc
+ */
+struct example_async {
+    clixon_handle ea_h;
+    void         *ea_req;   /* Request handle of clixon_plugin_rpc_async */
+    cbuf         *ea_reply;
+};
+
+/*! Delay of asynchronous example rpc has expired, send its reply
+ */
+static int
+example_rpc_async_timer(int   fd,
+                        void *arg)
+{
+    struct example_async *ea = (struct example_async *)arg;
+    int                   retval;
+
+    retval = clixon_plugin_rpc_async_done(ea->ea_h, ea->ea_req, ea->ea_reply);
+    cbuf_free(ea->ea_reply);
+    free(ea);
+    return retval;
+}
+
+/*! Example RPC replied asynchronously after a delay
+ *
+ * The reply is made as example_rpc but sent later from a timer
+ */
+static int
+example_rpc_async(clixon_handle h,            /* Clixon handle */
+                  cxobj        *xe,           /* Request: <rpc><xn></rpc> */
+                  cbuf         *cbret,        /* Reply eg <rpc-reply>... */
+                  void         *arg,          /* client_entry */
+                  void         *regarg)       /* Argument given at register */
+{
+    int                   retval = -1;
+    struct example_async *ea = NULL;
+    char                 *x;
+    struct timeval        t;
+
+    if ((ea = calloc(1, sizeof(*ea))) == NULL){
+        clixon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    ea->ea_h = h;
+    if ((ea->ea_reply = cbuf_new()) == NULL){
+        clixon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    if (example_rpc(h, xe, ea->ea_reply, arg, regarg) < 0)
+        goto done;
+    if ((ea->ea_req = clixon_plugin_rpc_async(h, arg, 2*_rpc_async_ms)) == NULL)
+        goto done;
+    if ((x = xml_find_body(xe, "x")) != NULL && strcmp(x, "timeout") == 0)
+        goto ok;
+    gettimeofday(&t, NULL);
+    t.tv_sec += _rpc_async_ms/1000;
+    t.tv_usec += (_rpc_async_ms%1000)*1000;
+    if (t.tv_usec >= 1000000){
+        t.tv_sec++;
+        t.tv_usec -= 1000000;
+    }
+    if (clixon_event_reg_timeout(t, example_rpc_async_timer, ea, "example rpc async") < 0)
+        goto done;
+    ea = NULL;
+ ok:
+    retval = 0;
+ done:
+    if (ea){
+        if (ea->ea_reply)
+            cbuf_free(ea->ea_reply);
+        free(ea);
+    }
+    return retval;
+}
+
 /*! This will be called as a hook right after the original system copy-config
  */
 static int
@@ -504,11 +645,14 @@ example_statedata(clixon_handle h,
     char      *name;
     cvec      *nsc1 = NULL;
     yang_stmt *yspec = NULL;
+    cvec      *keys = NULL;
+    cbuf      *cbxp = NULL;
     int        ret;
 
     if (!_state)
         goto ok;
-    if ((cb = cbuf_new()) == NULL){
+    if ((cb = cbuf_new()) == NULL ||
+        (cbxp = cbuf_new()) == NULL){
         clixon_err(OE_UNIX, errno, "cbuf_new");
         goto done;
     }
@@ -516,23 +660,31 @@ example_statedata(clixon_handle h,
     /* Example of statedata, in this case merging state data with
      * state information. In this case adding dummy interface operation state
      * to configured interfaces.
-     * Get config according to xpath */
+     * Get config according to xpath, only the requested interface if given and -T */
+    cprintf(cbxp, "/interfaces/interface");
+    if (_state_subtrees[0] &&
+        (ret = clixon_plugin_statedata_keys(h, nsc, xpath, &keys)) < 0)
+        goto done;
+    if (keys && (name = cvec_find_str(keys, "name")) != NULL)
+        cprintf(cbxp, "[name='%s']", name);
+    cprintf(cbxp, "/name");
     if ((nsc1 = xml_nsctx_init(NULL, "urn:ietf:params:xml:ns:yang:ietf-interfaces")) == NULL)
         goto done;
-    if ((ret = xmldb_get0(h, "running", YB_MODULE, nsc1, "/interfaces/interface/name", 1, 0, &xt, NULL, NULL)) < 0)
+    if ((ret = xmldb_get0(h, "running", YB_MODULE, nsc1, cbuf_get(cbxp), 1, 0, &xt, NULL, NULL)) < 0)
         goto done;
     if (ret == 0){
         clixon_err(OE_DB, 0, "Error when reading from running, unknown error");
         goto done;
     }
-    if (xpath_vec(xt, nsc1, "/interfaces/interface/name", &xvec, &xlen) < 0)
+    if (xpath_vec(xt, nsc1, "%s", &xvec, &xlen, cbuf_get(cbxp)) < 0)
         goto done;
     if (xlen){
         cprintf(cb, "<interfaces xmlns=\"urn:ietf:params:xml:ns:yang:ietf-interfaces\">");
         for (i=0; i<xlen; i++){
             name = xml_body(xvec[i]);
             cprintf(cb, "<interface xmlns:ex=\"urn:example:clixon\"><name>%s</name><type>ex:eth</type><oper-status>up</oper-status>", name);
-            cprintf(cb, "<ex:my-status><ex:int>42</ex:int><ex:str>foo</ex:str></ex:my-status>");
+            cprintf(cb, "<ex:my-status><ex:int>%d</ex:int><ex:str>foo</ex:str></ex:my-status>",
+                    _state_count ? ++_state_rows : 42);
             cprintf(cb, "</interface>");
         }
         cprintf(cb, "</interfaces>");
@@ -566,6 +718,10 @@ example_statedata(clixon_handle h,
  ok:
     retval = 0;
  done:
+    if (keys)
+        cvec_free(keys);
+    if (cbxp)
+        cbuf_free(cbxp);
     if (nsc1)
         xml_nsctx_free(nsc1);
     if (xt)
@@ -577,6 +733,78 @@ example_statedata(clixon_handle h,
     return retval;
 }
 
+/*! Asynchronous state data of the example, delivered after a delay
+ */
+struct example_state_async {
+    clixon_handle esa_h;
+    void         *esa_req;   /* Request handle of ca_statedata_async */
+    cxobj        *esa_x;     /* State tree */
+};
+
+/*! Delay of asynchronous example state data has expired, deliver it
+ */
+static int
+example_statedata_async_timer(int   fd,
+                              void *arg)
+{
+    struct example_state_async *esa = (struct example_state_async *)arg;
+    int                         retval;
+
+    retval = clixon_plugin_statedata_async_done(esa->esa_h, esa->esa_req, esa->esa_x);
+    free(esa);
+    return retval;
+}
+
+/*! Called to get state data from plugin asynchronously
+ *
+ * The state is made as example_statedata but delivered later from a timer
+ * @param[in]    h        Clixon handle
+ * @param[in]    nsc      External XML namespace context, or NULL
+ * @param[in]    xpath    String with XPATH syntax. or NULL for all
+ * @param[in]    req      Request handle
+ * @retval       0        OK
+ * @retval      -1        Error
+ */
+static int
+example_statedata_async(clixon_handle h,
+                        cvec         *nsc,
+                        char         *xpath,
+                        void         *req)
+{
+    int                         retval = -1;
+    struct example_state_async *esa = NULL;
+    struct timeval              t;
+
+    if ((esa = calloc(1, sizeof(*esa))) == NULL){
+        clixon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    esa->esa_h = h;
+    esa->esa_req = req;
+    if ((esa->esa_x = xml_new(DATASTORE_TOP_SYMBOL, NULL, CX_ELMNT)) == NULL)
+        goto done;
+    if (example_statedata(h, nsc, xpath, esa->esa_x) < 0)
+        goto done;
+    gettimeofday(&t, NULL);
+    t.tv_sec += _state_async_ms/1000;
+    t.tv_usec += (_state_async_ms%1000)*1000;
+    if (t.tv_usec >= 1000000){
+        t.tv_sec++;
+        t.tv_usec -= 1000000;
+    }
+    if (clixon_event_reg_timeout(t, example_statedata_async_timer, esa, "example state async") < 0)
+        goto done;
+    esa = NULL;
+    retval = 0;
+ done:
+    if (esa){
+        if (esa->esa_x)
+            xml_free(esa->esa_x);
+        free(esa);
+    }
+    return retval;
+}
+
 /*! Called to get state data from plugin by reading a file, also pagination
  *
  * The example shows how to read and parse a state XML file, (which is cached in the -i case).
@@ -1481,6 +1709,9 @@ example_start(clixon_handle h)
     yang_stmt *yspec;
     yang_stmt *ya = NULL;
 
+    /* Eg initialize hardware, in the background with CA_START_BACKGROUND */
+    if (_start_background_s)
+        sleep(_start_background_s);
     /* Register action callback, example from RFC7950 7.15
      * Can not be made in _init since YANG is not loaded
      * Note that callback is hardcoded here since it is C, but YANG and name of action
@@ -1573,6 +1804,7 @@ static clixon_plugin_api api = {
     .ca_trans_complete=main_complete,       /* trans complete */
     .ca_trans_commit=main_commit,           /* trans commit */
     .ca_trans_commit_done=main_commit_done, /* trans commit done */
+    .ca_trans_commit_failed=main_commit_failed, /* trans commit failed */
     .ca_trans_revert=main_revert,           /* trans revert */
     .ca_trans_end=main_end,                 /* trans end */
     .ca_trans_abort=main_abort,             /* trans abort */
@@ -1608,6 +1840,15 @@ clixon_plugin_init(clixon_handle h)
         case 'a':
             _action_instanceid = optarg;
             break;
+        case 'A':
+            _rpc_async_ms = atoi(optarg);
+            break;
+        case 'B':
+            _start_background_s = atoi(optarg);
+            break;
+        case 'c': /* count state rows (requires -s) */
+            _state_count = 1;
+            break;
         case 'm':
             _mount_yang = optarg;
             break;
@@ -1650,11 +1891,29 @@ clixon_plugin_init(clixon_handle h)
         case 'V': /* validate fail */
             _validate_fail_xpath = optarg;
             break;
+        case 'C': /* commit fail */
+            _commit_fail_xpath = optarg;
+            break;
+        case 'D': /* asynchronous state data (requires -s) */
+            _state_async_ms = atoi(optarg);
+            break;
+        case 'T': /* state subtree (requires -s) */
+            _state_subtrees[0] = optarg;
+            break;
+        case 'P': /* parallel-safe transaction callbacks */
+            api.ca_trans_parallel = CA_PARALLEL_VALIDATE | CA_PARALLEL_COMMIT;
+            break;
         }
     if ((_mount_yang && !_mount_namespace) || (!_mount_yang && _mount_namespace)){
         clixon_err(OE_PLUGIN, EINVAL, "Both -m and -M must be given for mounts");
         goto done;
     }
+    if (_start_background_s)
+        api.ca_start_flags = CA_START_BACKGROUND;
+    if (_state_async_ms)
+        api.ca_statedata_async = example_statedata_async;
+    if (_state_subtrees[0])
+        api.ca_state_subtrees = _state_subtrees;
     if (_state_file){
         api.ca_statedata = example_statefile; /* Switch state data callback */
         if (_state_xpath){
@@ -1703,7 +1962,7 @@ clixon_plugin_init(clixon_handle h)
                               ) < 0)
         goto done;
         /* Same as example but with optional input/output */
-    if (rpc_callback_register(h, example_rpc,
+    if (rpc_callback_register(h, _rpc_async_ms ? example_rpc_async : example_rpc,
                               NULL,
                               "urn:example:clixon",
                               "example"/* Xml tag when callback is made */
@@ -39,6 +39,7 @@
  * - transaction test
  *  -t  enable transaction logging (call syslog for every transaction)
  *  -v <xpath> Failing validate and commit if <xpath> is present (synthetic error)
+ *  -P  Transaction validate and commit callbacks are parallel-safe, see CA_PARALLEL_*
  * Note example_backend uses -V
  */
 #include <stdio.h>
@@ -60,7 +61,7 @@
 #include <clixon/clixon_backend.h>
 
 /* Command line options to be passed to getopt(3) */
-#define BACKEND_NACM_OPTS "tv:"
+#define BACKEND_NACM_OPTS "Ptv:w:"
 
 /*! Variable to control transaction logging (for debug)
  *
@@ -84,6 +85,13 @@ static char *_validate_fail_xpath = NULL;
  */
 static int   _validate_fail_toggle = 0; /* fail at validate and commit */
 
+/*! Transaction subtree of the plugin, for tests of transaction dispatch by subtree
+ *
+ * The transaction callbacks of the plugin only see changes in or above <path>
+ * Start backend with -- -w <path>, eg -w /trans:x/y
+ */
+static const char *_trans_subtrees[] = {NULL, NULL};
+
 int
 nacm_begin(clixon_handle    h,
            transaction_data td)
@@ -264,7 +272,15 @@ clixon_plugin_init(clixon_handle h)
         case 'v': /* validate fail */
             _validate_fail_xpath = optarg;
             break;
+        case 'P': /* parallel-safe transaction callbacks */
+            api.ca_trans_parallel = CA_PARALLEL_VALIDATE | CA_PARALLEL_COMMIT;
+            break;
+        case 'w': /* transaction subtree */
+            _trans_subtrees[0] = optarg;
+            break;
         }
+    if (_trans_subtrees[0])
+        api.ca_trans_subtrees = _trans_subtrees;
 
     nacm_mode = clicon_option_str(h, "CLICON_NACM_MODE");
     if (nacm_mode==NULL || strcmp(nacm_mode, "disabled") == 0){
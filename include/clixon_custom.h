@@ -45,21 +45,87 @@
 
 /*! Optimize special list key searches in XPath finds
  *
- * Identify xpaths that search for exactly a list key, eg: "y[k='3']" and then call
+ * Identify xpath steps that search for list keys, eg: "y[k='3']" and then call
  * binary search. This only works if "y" has proper yang binding and is sorted by system
- * Dont optimize on "hierarchical" lists such as: a/y[k='3'], where a is another list.
+ * Applies to steps at any level, eg a/y[k='3'] where a is another list, to multiple keys
+ * in any order, eg y[k2='b'][k1='a'] or y[k1='a' and k2='b'], to a prefix of the keys, and
+ * to key values given by current() or absolute paths, eg y[k=current()/../x]
  */
 #define XPATH_LIST_OPTIMIZE
 
+/*! Cache parsed XPath trees, value is max number of cached XPath strings
+ *
+ * YANG when, must and leafref paths, and NACM paths, are evaluated many times with the
+ * same XPath strings. With the cache, xpath_vec_ctx and functions using it, such as
+ * xpath_first and xpath_vec, parse each string once. The parse tree does not depend
+ * on namespace context, so the XPath string is the key.
+ * Least recently used entries are evicted when full.
+ * Disabled at runtime with CLICON_XPATH_PARSE_CACHE
+ */
+#define XPATH_PARSE_CACHE 512
+
+/*! Cache resolved api-path templates, value is max number of cached api-path shapes
+ *
+ * RESTCONF and CLI requests repeat a few api-path shapes with different keys, such as
+ * /ietf-interfaces:interfaces/interface=<name>. The shape, ie the api-path with key values
+ * removed, is resolved to YANG nodes and XPath prefixes once. api_path2xpath and api_path2xml
+ * then only substitute key values.
+ * Instance-identifiers of clixon_xml_find_instance_id are cached parsed and resolved in the
+ * same way.
+ * Api-paths with mount-points are not cached.
+ * Least recently used entries are evicted when full.
+ */
+#define API_PATH_CACHE 128
+
+/*! Evaluate XPath predicates over large node-sets in parallel, value is min node-set size
+ *
+ * The node-set is split into shards evaluated by forked worker processes, which see a
+ * copy-on-write image of the XML tree. The results are merged in document order.
+ * Enabled at runtime by setting CLICON_XPATH_PARALLEL to the number of processes.
+ * @see xpath_parallel_set
+ */
+#define XPATH_PARALLEL_MIN 10000
+
+/*! Validate children of XML nodes with many children in parallel, value is min number of children
+ *
+ * The children, eg the entries of a large list, are split into shards validated by forked
+ * worker processes, which see a copy-on-write image of the XML tree. The first error in
+ * document order is reported, as in sequential validation.
+ * Enabled at runtime by setting CLICON_VALIDATE_PARALLEL to the number of processes.
+ * @see xml_yang_validate_parallel_set
+ */
+#define VALIDATE_PARALLEL_MIN 10000
+
 /*! Add explicit search indexes, so that binary search can be made for non-key list indexes
  *
  * This also applies if there are multiple keys and you want to search on only the second for
  * example.
- * There may be some cases where the index vector is not updated, need to verify before
- * enabling this completely.
+ * Declare index variables with the clixon-config search_index extension. The index vectors
+ * are updated when list entries or index variables are added, removed or change value.
+ * Sizes are shown by the stats rpc with xml-type search-index.
  */
 #define XML_EXPLICIT_INDEX
 
+/*! Intern XML element/attribute names and prefixes in a shared string table
+ *
+ * Each distinct name or prefix is stored once with a reference count instead of one strdup
+ * per XML node, eg a list with many entries stores its list and leaf names once.
+ * Interned names are equal iff their pointers are equal, which is used as a fast path in name
+ * comparisons.
+ * Names returned by xml_name() and xml_prefix() must not be modified.
+ */
+#define XML_NAME_INTERN
+
+/*! Compute typed values of list keys and leaf-lists when binding yang to XML
+ *
+ * Integer and decimal64 values are parsed into the cligen variable cache of
+ * the XML node in xml_bind_yang() instead of lazily on first comparison in xml_cmp().
+ * Binary search and sorted insert then compare machine values directly.
+ * String-typed keys are not cached since they are compared as strings anyway.
+ * Values that fail to parse are left uncached and reported as before on comparison/validation.
+ */
+#define XML_BIND_CV_CACHE
+
 /*! Let state data be ordered-by system
  *
  * RFC 7950 is cryptic about this
@@ -87,6 +153,19 @@
  */
 #define HTTP_DATA_INTERNAL_REDIRECT "index.html"
 
+/*! Max total size of files in the static http data cache of restconf
+ *
+ * Files are memory-mapped and revalidated with stat() on every request.
+ * Larger files are not cached but mapped for each request.
+ */
+#define HTTP_DATA_CACHE_MAX (16*1024*1024)
+
+/*! Cache-Control of static http data files
+ *
+ * no-cache: clients may store files but revalidate with ETag or Last-Modified before use
+ */
+#define HTTP_DATA_CACHE_CONTROL "no-cache"
+
 /*! Set a temporary parent for use in special case "when" xpath calls
  *
  * Problem is when changing an existing (candidate) in-memory datastore that yang "when" conditionals
@@ -223,18 +302,72 @@
  */
 #define XML_DEFAULT_WHEN_TWICE
 
-/*! If set, make optimized lookup of yspec + namespace -> module
+/*! If set, make optimization of non-presence default container
  *
- * see yang_find_module_by_namespace
+ * Save the default XML in YANG and reuse next time
+ * see xml_default
+ * Cannot be combined with YANG_DEFAULT_TEMPLATE which uses the same yang container field
+ * and covers non-presence containers as well.
  */
-#undef OPTIMIZE_YSPEC_NAMESPACE
+#undef OPTIMIZE_NO_PRESENCE_CONTAINER
 
-/*! If set, make optimization of non-presence default container
+/*! Precompute which yang children give default values, once per yang node
  *
- * Save the default XML in YANG and reuse next time
+ * Each container, list, case, input and output keeps a template of the children that may
+ * give defaults: leafs with default values, non-presence containers with such leafs and
+ * choices with such cases, separately for config and state.
+ * Default expansion of an XML node then only visits those children, and skips nodes
+ * without defaults directly.
  * see xml_default
  */
-#define OPTIMIZE_NO_PRESENCE_CONTAINER
+#define YANG_DEFAULT_TEMPLATE
+
+/*! Sorted index of data-node children of yang nodes, see yang_find_datanode
+ *
+ * Built after each yang_parse_post for yang nodes with many data-node children, including
+ * those under choice/case and input/output, and cleared when children are added or removed.
+ * Lookup of a data node by name is then a binary search instead of a linear scan.
+ * Adds one pointer to each yang statement.
+ */
+#define YANG_CHILD_INDEX
+
+/*! Share YANG argument strings of parse cache files between processes
+ *
+ * Parse cache files (see CLICON_YANG_PARSE_CACHE_DIR) are mapped with mmap instead of read,
+ * and YANG arguments, including description texts, point into the mapping instead of
+ * being copied. All clixon processes loading the same YANG then share those pages.
+ * The mappings are kept until yang_exit.
+ */
+#define YANG_PARSE_CACHE_SHARED
+
+/*! Share immutable sub-statements of expanded uses and augment nodes with the original
+ *
+ * When a grouping is expanded (or an augment is applied), description, reference, must and
+ * type sub-statements are not copied. Instead the copy points to the original sub-tree and
+ * its reference count (ys_ref) is incremented, the parent of a shared sub-tree is the original.
+ * When the reference count is saturated, a private copy is made instead.
+ * Refine and deviations remove shared sub-statements from the copy and insert new private ones.
+ */
+#define YANG_USES_SHARED
+
+/*! Index of RFC 8528 mount-points by instance xpath
+ *
+ * Mounted yspecs are found by the canonical xpath of the XML mount-point in a hash table
+ * in the top-level yang mounts node, instead of by a linear search of the xpaths of all
+ * mounted yspecs, see yang_mount_get.
+ * Also, the search for XML mount-points does not descend into a mounted tree whose yspec
+ * has no mount-points itself.
+ */
+#define YANG_SCHEMA_MOUNT_INDEX
+
+/*! Allocate string-only YANG statements without the tail of struct yang_stmt
+ *
+ * Statements such as description, reference, contact, organization, units and presence
+ * never have a cv, cvec, orig-pointer or keyword-specific field. They are allocated
+ * without these fields, which are accessed only via functions that check the keyword.
+ * See also CLICON_YANG_DOCUMENTATION to drop documentation statements altogether.
+ */
+#define YANG_COMPACT
 
 /*! Fix startup mem issue of end callback: copy target db before writing to running
  *
@@ -268,10 +401,31 @@
  * Caveat: to find out whether all elements are one list a relatively costly
  * loop is made once per yang, this could possibly change and the loop could
  * be improved.
-
+ *
+ * 3) Third, absolute paths not using current() have the same result for all
+ * leafrefs. The target values are hashed into a set once per validation pass
+ * and each leafref is checked against the set.
  */
 #define LEAFREF_OPTIMIZE
 
+/*! Incremental must/when validation on commit and validate
+ *
+ * Running is valid, so a must or when expression of an existing node needs only be
+ * re-evaluated if any of the nodes it reads has changed.
+ * The node names read by an expression are derived from its XPath parse tree, and
+ * compared with the names of the added, deleted and changed nodes, their ancestors
+ * and their descendants. Expressions that use wildcards, deref(), position() or
+ * other constructs not covered by names are always evaluated.
+ * Likewise, mandatory, unique and min/max-elements are only checked for nodes with
+ * added, deleted or changed children.
+ * An unchanged subtree is skipped as a whole if none of the must, when and leafref
+ * expressions of its YANG subtree reads a changed node.
+ * Not used in startup, or if CLICON_VALIDATE_TARGET_STATE is set.
+ * Disabled at runtime with CLICON_VALIDATE_INCREMENTAL
+ * @see xml_yang_validate_incr_add
+ */
+#define VALIDATE_INCREMENTAL
+
 /*! Enable anydata as child in augments
  *
  * RFC 7950 Sec 7.17 does not include anydata in nodes that can be used within
@@ -304,6 +458,114 @@
  */
 #undef XMLDB_CANDIDATE_INMEM
 
+/*! Log edited subtrees of candidate, value is max number of logged nodes
+ *
+ * Commit computes diffs only in the edited subtrees instead of the whole trees.
+ * The log is dropped (full diff) on other than merge edits, on too many nodes,
+ * or if running changes.
+ * Enabled at runtime by setting CLICON_XMLDB_EDIT_LOG, which is off by default since defaults
+ * created by when-conditions outside the edited subtrees are not logged.
+ */
+#define XMLDB_EDIT_LOG 10000
+
+/*! Chunk size when printing XML and JSON to a file
+ *
+ * Output is printed to a buffer which is given to the file print function each time it has
+ * grown to the chunk size, so the whole output of eg a large datastore is not kept in memory.
+ * @see clixon_xml2file_stream
+ */
+#define XML2FILE_STREAM 65536
+
+/*! Print XML that is not pretty-printed with a compact printer
+ *
+ * Backend replies and datastores that are not pretty-printed are printed without
+ * indentation bookkeeping and per-element pretty-print and with-defaults decisions.
+ * Undefine to benchmark against the general printer, see test/test_perf_compact.sh
+ * @see xml2cbuf_compact
+ */
+#define XML2CBUF_COMPACT
+
+/*! Compile the resolved type of a leaf into a validator cached on the leaf
+ *
+ * The validator holds the resolved type, range/length, compiled regexps and fraction digits,
+ * and for unions one such validator per member type, as well as leafref targets.
+ * Thereby ys_cv_validate does not resolve types or allocate pattern vectors per value.
+ * Unions try the member that matched last time first, unless the matching member is requested.
+ */
+#define YANG_TYPE_VALIDATOR
+
+/*! Number identities and keep derived identities of a base identity in a bitset
+ *
+ * Each identity is given a dense number from its <module>:<id> name when populated.
+ * Identityref validation and XPath derived-from() are then a bit test in the bitset of
+ * the base identity, instead of a search in its list of derived identity names.
+ */
+#define YANG_IDENTITY_BITSET
+
+/*! Number of backend connections of asynchronous requests, see clicon_rpc_msg_async
+ *
+ * Each connection has a backend session of its own and is opened when first needed.
+ * A request is sent on the connection with fewest requests waiting for replies.
+ */
+#define RPC_ASYNC_CONNECTIONS 4
+
+/*! Max number of cached expansions of CLI datastore variables, see expand_dbvar
+ *
+ * An expansion of a datastore xpath is reused while the generation of the datastore is
+ * unchanged, so a TAB on a large list does not get and parse the list every time.
+ * The cache is cleared when full.
+ */
+#define CLI_EXPAND_CACHE_MAX 64
+
+/*! Number of list entries per page of CLI show output, see cli_show_common
+ *
+ * If a CLI show selects a config list, the entries are requested page by page with
+ * list-pagination and shown as they arrive. The next page is requested when the previous is
+ * shown, and not at all if the output is quit.
+ * Undefine to get and show the whole list at once.
+ */
+#define CLI_SHOW_PAGE_SIZE 100
+
+/*! Map autocli cache files of the backend instead of reading the clispec in the reply
+ *
+ * If clispec-cache is read and the backend is on a local socket, the CLI asks for the name of
+ * the cache file and maps it read-only. Concurrent CLI sessions share the pages, and the clispec
+ * is not escaped, sent and unescaped as XML.
+ * Undefine to always read the clispec in the reply
+ */
+#define AUTOCLI_CACHE_MMAP
+
+/*! Number of last CLI commands whose timing is kept, see CLICON_CLI_TIMING
+ *
+ * @see cli_show_timing
+ */
+#define CLI_TIMING_HISTORY 64
+
+/*! Max number of events queued for a publish POST of a stream, see stream_publish
+ *
+ * Events are queued while a POST is in progress, and then posted together.
+ * If the publish server does not keep up, new events are dropped.
+ * Only if configured with --enable-publish
+ */
+#define STREAM_PUBLISH_QUEUE_MAX 1000
+
+/*! Timeout in seconds of a publish POST of a stream, see stream_publish
+ */
+#define STREAM_PUBLISH_TIMEOUT 10
+
+/*! Size in bytes of the in-memory log ring of a process, see CLIXON_LOG_RING
+ *
+ * Oldest messages are overwritten. Dumped with clixon_log_ring_dump, in the backend on SIGUSR1
+ */
+#define LOG_RING_SIZE (256*1024)
+
+/*! Number of trace spans in the in-memory trace buffer of a process, see CLICON_TRACE
+ *
+ * Oldest spans are overwritten. The buffer is allocated on the first traced span,
+ * each span is 80 bytes.
+ */
+#define TRACE_RING_SIZE (16*1024)
+
 /*! Relax YANG validation for debugging
  *
  * Mainly for debugging but can be useful when bringing up new YANGs, use with care
@@ -79,6 +79,7 @@ int autocli_enabled(clixon_handle h, int *enablep);
 int autocli_module(clixon_handle h, const char *modname, int *enable);
 int autocli_completion(clixon_handle h, int *completion);
 int autocli_grouping_treeref(clixon_handle h, int *grouping_treeref);
+int autocli_toplevel_treeref(clixon_handle h, int *toplevel_treeref);
 int autocli_list_keyword(clixon_handle h, autocli_listkw_t *listkw);
 int autocli_compress(clixon_handle h, yang_stmt *ys, int *compress);
 int autocli_treeref_state(clixon_handle h, int *treeref_state);
@@ -70,6 +70,7 @@ int yang2cli_treeref_encode(cbuf *cb, const char *delim, const char *domain, con
 int yang2cli_treeref_decode(const char *str, const char *delim, char **domain, char **spec, char **module,
                             char **revision, char **keyword, char **argument);
 int yang2cli_grouping(clixon_handle h, yang_stmt *ys, yang_stmt *ymod, const char *domain, const char *treename, cbuf *cb);
+int yang2cli_toplevel(clixon_handle h, yang_stmt *ys, cbuf *cb);
 int yang2cli_stmt(clixon_handle h, yang_stmt *ys, int level, cbuf *cb);
 
 #endif  /* _CLIXON_AUTOCLI_GENERATE_H_ */
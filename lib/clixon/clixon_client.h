@@ -82,6 +82,7 @@ int   clixon_client_get_uint8(clixon_client_handle ch, uint8_t *rval, const char
 int   clixon_client_get_uint16(clixon_client_handle ch, uint16_t *rval, const char *xnamespace, const char *xpath);
 int   clixon_client_get_uint32(clixon_client_handle ch, uint32_t *rval, const char *xnamespace, const char *xpath);
 int   clixon_client_get_uint64(clixon_client_handle ch, uint64_t *rval, const char *xnamespace, const char *xpath);
+int   clixon_client_get_batch(clixon_client_handle ch, const char *xnamespace, const char **xpaths, int n, char **vals);
 
 /* Access functions */
 int   clixon_client_socket_get(clixon_client_handle ch);
@@ -57,7 +57,13 @@ char    *xmldb_name_get(db_elmnt *de);
 uint32_t xmldb_id_get(db_elmnt *de);
 int      xmldb_id_set(db_elmnt *de, uint32_t id);
 cxobj   *xmldb_cache_get(db_elmnt *de);
+cxobj   *xmldb_cache_read(db_elmnt *de);
+int      xmldb_cache_shared(db_elmnt *de);
 int      xmldb_cache_set(db_elmnt *de, cxobj *xml);
+int      xmldb_cache_detach(clixon_handle h, db_elmnt *de, cxobj **xtp);
+uint64_t xmldb_generation_get(db_elmnt *de);
+int      xmldb_generation_time(db_elmnt *de, struct timeval *tv);
+uint64_t xmldb_generation_base(db_elmnt *de);
 int      xmldb_modified_get(db_elmnt *de);
 int      xmldb_modified_set(db_elmnt *de, int value);
 int      xmldb_empty_get(db_elmnt *de);
@@ -66,12 +72,25 @@ int      xmldb_candidate_get(db_elmnt *de);
 int      xmldb_candidate_set(db_elmnt *de, int value);
 int      xmldb_volatile_get(db_elmnt *de);
 int      xmldb_volatile_set(db_elmnt *de, int value);
+uint32_t xmldb_journal_nr_get(db_elmnt *de);
+int      xmldb_journal_nr_set(db_elmnt *de, uint32_t nr);
 
 /* Creator */
 db_elmnt *xmldb_new(clixon_handle h, const char *db);
 db_elmnt *xmldb_find(clixon_handle h, const char *db);
 int xmldb_db2file(clixon_handle h, const char *db, char **filename);
 int xmldb_db2subdir(clixon_handle h, const char *db, char **dir);
+int xmldb_db2journal(clixon_handle h, const char *db, char **filename);
+int xmldb_journal_reset(clixon_handle h, const char *db);
+int xmldb_persist_deferred(clixon_handle h);
+int xmldb_persist(clixon_handle h, const char *db);
+int xmldb_persist_sync(clixon_handle h);
+#ifdef XMLDB_EDIT_LOG
+int xmldb_editlog_valid(clixon_handle h, db_elmnt *de);
+int xmldb_editlog_add(clixon_handle h, db_elmnt *de, int valid, cxobj *x1);
+void xmldb_editlog_done(db_elmnt *de, int ok);
+int xmldb_editlog_get(clixon_handle h, const char *db, cxobj **xlp);
+#endif
 int xmldb_connect(clixon_handle h);
 int xmldb_disconnect(clixon_handle h);
 
@@ -81,12 +100,22 @@ int xmldb_get0(clixon_handle h, const char *db, int yb,
                cvec *nsc, const char *xpath, int copy, withdefaults_type wdef,
                cxobj **xret, void *md, cxobj **xerr);
 int xmldb_get_cache(clixon_handle h, const char *db, cxobj **xtp, cxobj **xerr);
+int xmldb_get_detach(clixon_handle h, const char *db, cxobj **xtp, cxobj **xerr);
+int xmldb_get_depth(clixon_handle h, const char *db, cvec *nsc, const char *xpath, int32_t depth,
+                    withdefaults_type wdef, cxobj **xret, cxobj **xerr);
+int xmldb_get_borrow(clixon_handle h, const char *db, cvec *nsc, const char *xpath,
+                     cxobj **xtp, cxobj ***xvecp, size_t *xlenp, uint64_t *genp, cxobj **xerr);
+int xmldb_get_release(clixon_handle h, const char *db, cxobj **xvec, size_t xlen, uint64_t gen);
 int xmldb_get_cache_from_file(clixon_handle h, db_elmnt *de, cxobj **xtp, cxobj **xerr);
 
 /* in clixon_datastore_write.[ch]: */
 int xmldb_put(clixon_handle h, const char *db, enum operation_type op, cxobj *xt, const char *username, cbuf *cbret);
 int xmldb_dump(clixon_handle h, FILE *f, cxobj *xt, enum format_enum format, int pretty, withdefaults_type wdef, int multi, const char *multidb);
 int xmldb_write_cache2file(clixon_handle h, const char *db);
+int xmldb_journal_enabled(clixon_handle h);
+int xmldb_journal_diff(clixon_handle h, cxobj *x0, cxobj *x1, cbuf **cbp);
+int xmldb_journal_append(clixon_handle h, const char *db, cbuf *cb);
+int xmldb_journal_replay(clixon_handle h, db_elmnt *de, cxobj *xt);
 
 int xmldb_copy_file(clixon_handle h, const char *from, const char *to);
 int xmldb_copy(clixon_handle h, const char *from, const char *to);
@@ -109,6 +138,7 @@ int xmldb_populate(clixon_handle h, const char *db);
 int xmldb_multi_upgrade(clixon_handle h, const char *db);
 int xmldb_drop_priv(clixon_handle h, const char *db, uid_t uid, gid_t gid);
 int xmldb_system_only_config(clixon_handle h, const char *xpath, cvec *nsc, cxobj **xret);
+int xmldb_system_only_reset(clixon_handle h);
 int xmldb_candidate_find(clixon_handle h, const char *name, uint32_t ceid, db_elmnt **dep, char **db);
 int xmldb_post_commit(clixon_handle h, uint32_t ceid);
 
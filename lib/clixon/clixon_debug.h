@@ -96,47 +96,68 @@
 /*
  * Macros
  */
+/* The debug mask is checked inline, arguments are not evaluated unless the message is logged */
 #if defined(__GNUC__)
 #define clixon_debug(l, _fmt, args...) \
 	do { \
+		if (clixon_debug_isset(l)) { \
 		_Pragma("GCC diagnostic push") \
 		_Pragma("GCC diagnostic ignored \"-Wformat-zero-length\"") \
 		clixon_debug_fn(NULL, __func__, __LINE__, (l), NULL, _fmt, ##args); \
 		_Pragma("GCC diagnostic pop") \
+		} \
 	} while (0)
 
 #define clixon_debug_xml(l, x, _fmt, args...) \
 	do { \
+		if (clixon_debug_isset(l)) { \
 		_Pragma("GCC diagnostic push") \
 		_Pragma("GCC diagnostic ignored \"-Wformat-zero-length\"") \
 		clixon_debug_fn(NULL, __func__, __LINE__, (l), (x), _fmt, ##args); \
 		_Pragma("GCC diagnostic pop") \
+		} \
 	} while (0)
 
 #elif defined(__clang__)
 #define clixon_debug(l, _fmt, args...) \
 	do { \
+		if (clixon_debug_isset(l)) { \
 		_Pragma("clang diagnostic push") \
 		_Pragma("clangGCC diagnostic ignored \"-Wformat-zero-length\"") \
 		clixon_debug_fn(NULL, __func__, __LINE__, (l), NULL, _fmt, ##args); \
 		_Pragma("clangGCC diagnostic pop") \
+		} \
 	} while (0)
 
 #define clixon_debug_xml(l, x, _fmt, args...) \
 	do { \
+		if (clixon_debug_isset(l)) { \
 		_Pragma("clangGCC diagnostic push") \
 		_Pragma("clangGCC diagnostic ignored \"-Wformat-zero-length\"") \
 		clixon_debug_fn(NULL, __func__, __LINE__, (l), (x), _fmt, ##args); \
 		_Pragma("clangGCC diagnostic pop") \
+		} \
 	} while (0)
 
 #else
 #define clixon_debug(l, _fmt, args...) \
-		clixon_debug_fn(NULL, __func__, __LINE__, (l), NULL, _fmt, ##args)
+	do { \
+		if (clixon_debug_isset(l)) \
+			clixon_debug_fn(NULL, __func__, __LINE__, (l), NULL, _fmt, ##args); \
+	} while (0)
 #define clixon_debug_xml(l, x, _fmt, args...) \
-		clixon_debug_fn(NULL, __func__, __LINE__, (l), (x), _fmt, ##args)
+	do { \
+		if (clixon_debug_isset(l)) \
+			clixon_debug_fn(NULL, __func__, __LINE__, (l), (x), _fmt, ##args); \
+	} while (0)
 #endif
 
+/*
+ * Variables
+ */
+/* Global debug level, read inline by clixon_debug_isset(), set with clixon_debug_init() */
+extern int _clixon_debug_level;
+
 /*
  * Prototypes
  */
@@ -153,7 +174,7 @@ int clixon_debug_fn(clixon_handle h, const char *fn, const int line, int dbgleve
 /* Is subject set ? */
 static inline int clixon_debug_isset(unsigned n)
 {
-    unsigned level = clixon_debug_get();
+    unsigned level = _clixon_debug_level;
     unsigned detail = (n & CLIXON_DBG_DMASK) >> CLIXON_DBG_DSHIFT;
     unsigned subject = (n & CLIXON_DBG_SMASK);
 
@@ -166,7 +187,7 @@ static inline int clixon_debug_isset(unsigned n)
 /* Is detail set ?, return detail level 0-7 */
 static inline int clixon_debug_detail(void)
 {
-    unsigned level = clixon_debug_get();
+    unsigned level = _clixon_debug_level;
 
     return (level & CLIXON_DBG_DMASK) >> CLIXON_DBG_DSHIFT;
 }
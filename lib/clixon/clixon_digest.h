@@ -38,6 +38,16 @@
 #ifndef _CLIXON_DIGEST_H_
 #define _CLIXON_DIGEST_H_
 
+/*
+ * Constants
+ */
+/* Length of binary digest, SHA256 length. Shorter SHA1 digests are zero-padded */
+#define CLIXON_DIGEST_LEN 32
+
+/*
+ * Prototypes
+ */
 int clixon_digest_hex(const char *string, char **hexstrp);
+int clixon_digest_buf(const char *buf, size_t len, unsigned char *md);
 
 #endif /* _CLIXON_DIGEST_H_ */
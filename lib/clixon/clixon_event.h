@@ -52,7 +52,10 @@ int clicon_sig_ignore_set(int val);
 int clicon_sig_ignore_get(void);
 int clixon_event_reg_fd(int fd, int (*fn)(int, void*), void *arg, const char *str);
 int clixon_event_reg_fd_prio(int fd, int (*fn)(int, void*), void *arg, const char *str, int prio);
+int clixon_event_reg_fd_out(int fd, int (*fn)(int, void*), void *arg, const char *str);
 int clixon_event_unreg_fd(int s, int (*fn)(int, void*));
+int clixon_event_fd_class(int fd, int cls);
+int clixon_event_fd_ready(int fd);
 int clixon_event_reg_timeout(struct timeval t,  int (*fn)(int, void*),
                              void *arg, const char *str);
 int clixon_event_unreg_timeout(int (*fn)(int, void*), void *arg);
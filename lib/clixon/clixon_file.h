@@ -44,7 +44,10 @@ int clicon_file_dirent(const char *dir, struct dirent **ent,
 int clicon_files_recursive(const char *dir, const char *regexp, cvec *cvv);
 int clicon_file_copy(const char *src, const char *target);
 int clicon_dir_copy(const char *src, const char *target);
+int clicon_dir_sync(const char *src, const char *target);
 int clicon_file_cbuf(const char *filename, cbuf *cb);
 int clixon_dir_remove_files(const char *dir, const char *subdir, const char *pattern);
+FILE *clicon_file_zfdopen(int fd, const char *mode, int level);
+FILE *clicon_file_zfopen(const char *filename, const char *mode, int level);
 
 #endif /* _CLIXON_FILE_H_ */
@@ -80,6 +80,10 @@ int clixon_handle_check(clixon_handle h);
 /* Return clicon options (hash-array) given a handle.*/
 clicon_hash_t *clicon_options(clixon_handle h);
 
+/* Return/set typed option values given a handle, see clicon_option_bool_id */
+void *clicon_option_values(clixon_handle h);
+int clicon_option_values_set(clixon_handle h, void *optv);
+
 /* Return internal clicon data (hash-array) given a handle.*/
 clicon_hash_t *clicon_data(clixon_handle h);
 
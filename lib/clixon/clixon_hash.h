@@ -39,7 +39,6 @@
 #define _CLIXON_HASH_H_
 
 struct clicon_hash {
-    qelem_t     h_qelem;
     /*
      * Key must be NULL-terminated string unless clicon_hash_add_ptr function
      * is used to add keys.
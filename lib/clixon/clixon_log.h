@@ -54,6 +54,7 @@
 #define CLIXON_LOG_STDERR 0x02 /* print logs on stderr */
 #define CLIXON_LOG_STDOUT 0x04 /* print logs on stdout */
 #define CLIXON_LOG_FILE   0x08 /* print logs on clixon_log_file() */
+#define CLIXON_LOG_RING   0x10 /* keep logs in memory, see clixon_log_ring_dump() */
 
 /* What kind of log (only for customizable error/logs) */
 enum clixon_log_type{
@@ -85,6 +86,7 @@ size_t   clixon_log_string_limit_get(void);
 uint16_t clixon_logflags_get(void);
 int      clixon_logflags_set(uint16_t flags);
 int      clixon_log_str(int level, char *msg);
+int      clixon_log_ring_dump(FILE *f);
 int      clixon_log_fn(clixon_handle h, int user, int level, cxobj *x, const char *format, ...) __attribute__ ((format (printf, 5, 6)));
 
 #endif  /* _CLIXON_LOG_H_ */
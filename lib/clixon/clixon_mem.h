@@ -0,0 +1,67 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+ 
+  Copyright (C) 2026 Olof Hagsand
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2, 
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+
+ * Memory accounting per subsystem with tagged allocations
+ * Allocations made with the clixon_mem_* wrappers are counted per tag, and memory
+ * that is not allocated by the wrappers may be added with clixon_mem_account().
+ * XML and YANG trees are not tagged, they are measured with xml_stats() and yang_stats()
+ */
+
+#ifndef _CLIXON_MEM_H_
+#define _CLIXON_MEM_H_
+
+/*
+ * Types
+ */
+/* Memory accounting categories, see memtagmap */
+enum clixon_mem_tag {
+    CLIXON_MEM_OTHER = 0,    /* Not in any other category */
+    CLIXON_MEM_NACM,         /* Compiled NACM rules */
+    CLIXON_MEM_STREAM,       /* Notification streams and replay buffers */
+    CLIXON_MEM_TRANSACTION,  /* Backend transactions */
+    CLIXON_MEM_PLUGIN,       /* Plugins, and plugin state allocated by plugins */
+    CLIXON_MEM_NR            /* Number of tags, not a tag */
+};
+
+/*
+ * Prototypes
+ */
+void       *clixon_mem_malloc(enum clixon_mem_tag tag, size_t size);
+void       *clixon_mem_calloc(enum clixon_mem_tag tag, size_t nmemb, size_t size);
+void       *clixon_mem_realloc(enum clixon_mem_tag tag, void *ptr, size_t size);
+void        clixon_mem_free(void *ptr);
+void        clixon_mem_account(enum clixon_mem_tag tag, int64_t nr, int64_t bytes);
+int         clixon_mem_stats(enum clixon_mem_tag tag, uint64_t *nrp, uint64_t *bytesp, uint64_t *maxp);
+const char *clixon_mem_tag2str(enum clixon_mem_tag tag);
+
+#endif /* _CLIXON_MEM_H_ */
@@ -60,6 +60,9 @@ int nacm_proxyuser_add(clixon_handle h, const char *user);
 int nacm_rpc(const char *rpc, const char *module, const char *username, cxobj *xnacm, cbuf *cbret);
 int nacm_datanode_read1(clixon_handle h, cxobj *xt, const char *username, cxobj *nacm_xtree);
 int nacm_datanode_read_prune(clixon_handle h, cxobj *xt);
+int nacm_datanode_read_filtered(const char *username, cxobj *xnacm);
+int nacm_datanode_read_filter(clixon_handle h, cbuf *cb, cxobj *xt, const char *username,
+                              cxobj *xnacm, int32_t depth, withdefaults_type wdef);
 int nacm_datanode_write(clixon_handle h, cxobj *xr, cxobj *xt,
                         enum nacm_access access,
                         const char *username, cxobj *xnacm, cbuf *cbret);
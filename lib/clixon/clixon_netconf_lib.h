@@ -105,6 +105,16 @@
 /* NETCONF and RESTCONF Private Candidate Datastores draft-ietf-netconf-privcand-08
  */
 #define NETCONF_PRIVATE_CANDIDATE_CAPABILITY "urn:ietf:params:netconf:capability:private-candidate:1.0"
+
+/* RFC 5717 Partial Lock Remote Procedure Call (RPC) for NETCONF
+ */
+#define NETCONF_PARTIAL_LOCK_NAMESPACE "urn:ietf:params:xml:ns:netconf:partial-lock:1.0"
+#define NETCONF_PARTIAL_LOCK_CAPABILITY "urn:ietf:params:netconf:capability:partial-lock:1.0"
+
+/* Clixon internal capability: client accepts binary encoded replies on CLICON_SOCK
+ * @see clixon_xml2bin_reply
+ */
+#define CLIXON_BIN_CAPABILITY "http://clicon.org/clixon-bin:1.0"
 /*
  * Types
  */
@@ -94,6 +94,31 @@ enum regexp_mode{
     REGEXP_LIBXML2
 };
 
+/*! Options with typed values cached in the handle, see clicon_option_bool_id
+ *
+ * For options read per request or per node, others use the string API.
+ * Values are read from the option hash on first use after load or change.
+ * @see optid2name  If you change here you must also change optid2name
+ */
+enum clicon_option_id{
+    CO_AUTOLOCK,
+    CO_BACKEND_SLICE,
+    CO_NACM_DISABLED_ON_EMPTY,
+    CO_NACM_MODE,
+    CO_SOCK_PRIO,
+    CO_VALIDATE_STATE_XML,
+    CO_XMLDB_FORMAT,
+    CO_XMLDB_MODIFY_BULK,
+    CO_XMLDB_MULTI,
+    CO_XMLDB_PRETTY,
+    CO_XMLDB_PRIVATE_CANDIDATE,
+    CO_XMLDB_SYSTEM_ONLY_CONFIG,
+    CO_YANG_SCHEMA_MOUNT,
+    CO_YANG_UNKNOWN_ANYDATA,
+    CO_YANG_USE_ORIGINAL,
+    CO_NR               /* Number of typed options, not an option */
+};
+
 /*
  * Prototypes
  */
@@ -133,6 +158,11 @@ int clicon_option_bool_set(clixon_handle h, const char *name, int val);
 /* Delete a single option via handle */
 int clicon_option_del(clixon_handle h, const char *name);
 
+/* Typed option values by id, same defaults as string API */
+char *clicon_option_str_id(clixon_handle h, enum clicon_option_id id);
+int clicon_option_int_id(clixon_handle h, enum clicon_option_id id);
+int clicon_option_bool_id(clixon_handle h, enum clicon_option_id id);
+
 /*-- Standard option access functions for YANG options --*/
 static inline char *clicon_configfile(clixon_handle h){
     return clicon_option_str(h, "CLICON_CONFIGFILE");
@@ -102,12 +102,16 @@ int api_path2xml_mnt(const char *api_path, yang_stmt *yspec, cxobj *xtop,
                      yang_class nodeclass, int strict,
                      api_path_mnt_cb_t mnt_cb, void *arg,
                      cxobj **xpathp, yang_stmt **ypathp, cxobj **xerr);
+int api_path_cache_flush(yang_stmt *yspec);
+int api_path_cache_stats(int *nr, int *hits, int *misses);
+void api_path_cache_exit(void);
 int xml2api_path_one(cxobj *x, cbuf *cb);
 int xml2api_path(cxobj *x, uint16_t flag, cbuf *cb);
 int clixon_xml_find_api_path(cxobj *xt, yang_stmt *yt, cxobj ***xvec, int *xlen, const char *format,
                      ...) __attribute__ ((format (printf, 5, 6)));
 int clixon_xml_find_instance_id(cxobj *xt, yang_stmt *yt, cxobj ***xvec, int *xlen, const char *format,
                      ...) __attribute__ ((format (printf, 5, 6)));
+int clixon_xml_find_instance_path(cxobj *xt, yang_stmt *yt, clixon_path *cplist, clixon_xvec **xvec);
 int clixon_instance_id_bind(yang_stmt *yt, cvec *nsctx, const char *format, ...) __attribute__ ((format (printf, 3, 4)));
 int clixon_instance_id_parse(yang_stmt *yt, clixon_path **cplistp, cxobj **xerr, const char *format, ...) __attribute__ ((format (printf, 4, 5)));
 
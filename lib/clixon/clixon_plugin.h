@@ -229,6 +229,23 @@ typedef int (plgreset_t)(clixon_handle h, const char *db);
  */
 typedef int (plgstatedata_t)(clixon_handle h, cvec *nsc, char *xpath, cxobj *xconfig);
 
+/*! Asynchronous state data callback
+ *
+ * Start collecting state data, eg by sending a request to a remote daemon, and return
+ * without waiting. Complete later from a fd or timer callback by calling
+ * clixon_plugin_statedata_async_done() with req and the state tree.
+ * Other clients are served while state data is collected.
+ * Only used for get requests from clients, otherwise ca_statedata is used, if set.
+ * @param[in]  h      Clixon handle
+ * @param[in]  nsc    XPath namespace context.
+ * @param[in]  xpath  Part of state requested
+ * @param[in]  req    Request handle
+ * @retval     0      OK, collecting
+ * @retval    -1      Failed, clixon_err called
+ * @see CLICON_STATE_ASYNC_TIMEOUT  Deadline
+ */
+typedef int (plgstatedata_async_t)(clixon_handle h, cvec *nsc, char *xpath, void *req);
+
 /*! Pagination-data type
  *
  * @see pagination_data_t in for full pagination data structure
@@ -425,6 +442,7 @@ struct clixon_plugin_api{
             plgreset_t       *cb_reset;          /* Reset system status */
             plgstatedata_t   *cb_statedata;      /* Provide state data XML from plugin */
             plgstatedata_t   *cb_system_only;    /* Provide system-only config XML from plugin */
+            plgstatedata_async_t *cb_statedata_async; /* Provide state data XML asynchronously */
             plglockdb_t      *cb_lockdb;         /* Database lock changed state */
             trans_cb_t       *cb_trans_begin;    /* Transaction start */
             trans_cb_t       *cb_trans_validate; /* Transaction validation */
@@ -436,6 +454,10 @@ struct clixon_plugin_api{
             trans_cb_t       *cb_trans_end;      /* Transaction completed  */
             trans_cb_t       *cb_trans_abort;    /* Transaction aborted */
             datastore_upgrade_t *cb_datastore_upgrade; /* General-purpose datastore upgrade */
+            int               cb_trans_parallel; /* Parallel-safe transaction callbacks, see CA_PARALLEL_* */
+            const char      **cb_trans_subtrees; /* Transaction subtrees, NULL-terminated vector of paths */
+            const char      **cb_state_subtrees; /* State data subtrees, NULL-terminated vector of paths */
+            int               cb_start_flags; /* Start callback flags, see CA_START_* */
         } cau_backend;
     } u;
 };
@@ -449,6 +471,7 @@ struct clixon_plugin_api{
 #define ca_reset          u.cau_backend.cb_reset
 #define ca_statedata      u.cau_backend.cb_statedata
 #define ca_system_only    u.cau_backend.cb_system_only
+#define ca_statedata_async u.cau_backend.cb_statedata_async
 #define ca_lockdb         u.cau_backend.cb_lockdb
 #define ca_trans_begin    u.cau_backend.cb_trans_begin
 #define ca_trans_validate u.cau_backend.cb_trans_validate
@@ -460,12 +483,49 @@ struct clixon_plugin_api{
 #define ca_trans_end      u.cau_backend.cb_trans_end
 #define ca_trans_abort    u.cau_backend.cb_trans_abort
 #define ca_datastore_upgrade  u.cau_backend.cb_datastore_upgrade
+#define ca_trans_parallel u.cau_backend.cb_trans_parallel
+#define ca_trans_subtrees u.cau_backend.cb_trans_subtrees
+#define ca_state_subtrees u.cau_backend.cb_state_subtrees
+#define ca_start_flags    u.cau_backend.cb_start_flags
+
+/* Flags of ca_trans_parallel: transaction callbacks that may run concurrently with the same
+ * callback of other plugins in forked worker processes.
+ * A parallel-safe callback runs on a copy of the backend: it should only read the transaction
+ * and make external changes. Changes of plugin memory and transaction_arg_set() are lost.
+ * The return value, clixon_err() and clixon_plugin_rpc_err() are sent back to the backend.
+ * ca_trans_complete may change the transaction and is never parallel.
+ */
+#define CA_PARALLEL_VALIDATE 0x01 /* ca_trans_validate */
+#define CA_PARALLEL_COMMIT   0x04 /* ca_trans_commit */
+
+/* Flags of ca_start_flags
+ * With CA_START_BACKGROUND the backend does not wait for the start callback before serving
+ * clients. Until it is done, a forked copy of the backend serves only read-only rpcs and does
+ * not call the state data callbacks of the plugin. The start callback is called after
+ * daemonization and after ca_daemon, see clixon_plugin_start_background().
+ * Sessions opened during the start are handed over to the backend when it is done.
+ */
+#define CA_START_BACKGROUND  0x01 /* ca_start while serving read-only rpcs */
+
+/* ca_trans_subtrees: if set, the transaction callbacks of the plugin only see changes in or
+ * above the given subtrees, and are not called at all if there are none.
+ * Paths are on the form /module:name/name, eg "/ietf-interfaces:interfaces".
+ */
+
+/* ca_state_subtrees: if set, the statedata callback of the plugin is only called for
+ * requests in or above the given subtrees, same form as ca_trans_subtrees.
+ * See clixon_plugin_statedata_keys() for the list keys of a request.
+ */
 
 /*
  * Macros
  */
 #define upgrade_callback_register(h, cb, ns, arg) upgrade_callback_reg_fn((h), (cb), #cb, (ns), (arg))
 
+/*! Key of a plugin callback in clixon_plugin_index(), eg CLIXON_PLUGIN_CB(ca_extension)
+ */
+#define CLIXON_PLUGIN_CB(cb) offsetof(clixon_plugin_api, cb)
+
 typedef struct clixon_plugin_api clixon_plugin_api;
 
 /* This is the external handle type exposed in the API.
@@ -519,6 +579,10 @@ clixon_plugin_t *clixon_plugin_each(clixon_handle h, clixon_plugin_t *cpprev);
 
 clixon_plugin_t *clixon_plugin_each_revert(clixon_handle h, clixon_plugin_t *cpprev, int nr);
 
+int              clixon_plugin_nr_get(clixon_plugin_t *cp);
+int              clixon_plugin_index(clixon_handle h, size_t cb, clixon_plugin_t ***vecp, int *lenp);
+int              clixon_plugin_index_reset(clixon_handle h);
+
 clixon_plugin_t *clixon_plugin_find(clixon_handle h, const char *name);
 
 int clixon_plugins_load(clixon_handle h, const char *function, const char *dir, const char *regexp);
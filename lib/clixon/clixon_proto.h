@@ -40,6 +40,20 @@
 #ifndef _CLIXON_PROTO_H_
 #define _CLIXON_PROTO_H_
 
+/*
+ * Types
+ */
+/*! Callback with a span of data of a relayed message
+ *
+ * @param[in]  arg   Argument given when relaying
+ * @param[in]  data  Message data, not NULL-terminated
+ * @param[in]  len   Length of data
+ * @retval     0     OK
+ * @retval    -1     Error, relay is aborted
+ * @see clixon_msg_rcv11_relay
+ */
+typedef int (clixon_msg_relay_cb)(void *arg, const char *data, size_t len);
+
 /*
  * Prototypes
  */
@@ -60,10 +74,13 @@ int clixon_rpc10(int sock, const char *descr, cbuf *msgin, cbuf **msgret, int *e
 
 /* NETCONF 1.1 */
 int clixon_msg_rcv11(int s, const char *descr, int intr, cbuf **msg, int *eof);
+int clixon_msg_rcv11_relay(int s, const char *descr, clixon_msg_relay_cb *fn, void *arg, int *eof);
 int clixon_rpc11(int sock, const char *descr, cbuf *msg, cbuf **msgret, int *eof);
 int clixon_msg_send11(int s, const char *descr, cbuf *msg);
+int clixon_msg_send11_chunk(int s, const char *data, size_t len, int last);
 
 int clixon_msg_send(int s, const char *descr, cbuf *cb);
+int clixon_msg_pending(int s);
 int send_msg_reply(int s, const char *descr, char *data, uint32_t datalen);
 int send_msg_notify_xml(clixon_handle h, int s, const char *descr, cxobj *xev);
 
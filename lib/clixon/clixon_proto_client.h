@@ -42,23 +42,54 @@
 #ifndef _CLIXON_PROTO_CLIENT_H_
 #define _CLIXON_PROTO_CLIENT_H_
 
+/*
+ * Types
+ */
+/*! Reply callback of asynchronous request
+ *
+ * @param[in]  h     Clixon handle
+ * @param[in]  xret  Reply from backend, not to be freed. NULL if no reply will arrive
+ * @param[in]  arg   Argument given when request was sent
+ * @retval     0     OK
+ * @retval    -1     Fatal error
+ * @see clicon_rpc_msg_async
+ */
+typedef int (clicon_rpc_async_cb)(clixon_handle h, cxobj *xret, void *arg);
+
+/*
+ * Prototypes
+ */
+
 int clicon_rpc_msg(clixon_handle h, cbuf *cbsend, cxobj **xret0);
 int clicon_rpc_msg_persistent(clixon_handle h, cbuf *cbsend, cxobj **xret0, int *sock0);
+void clicon_rpc_stats_get(uint64_t *nr, uint64_t *usec);
+int clicon_rpc_msg_send(clixon_handle h, cbuf *cbsend, uint32_t *id);
+int clicon_rpc_msg_recv(clixon_handle h, uint32_t id, cxobj **xret0);
+int clicon_rpc_msg_async(clixon_handle h, cbuf *cbsend, clicon_rpc_async_cb *fn, void *arg);
+int clicon_rpc_async_cancel(clixon_handle h, void *arg);
+int clicon_rpc_async_exit(clixon_handle h);
 int clicon_rpc_netconf(clixon_handle h, char *xmlst, cxobj **xret, int *sp);
 int clicon_rpc_netconf_xml(clixon_handle h, cxobj *xml, cxobj **xret, int *sp);
+int clicon_rpc_netconf_split(clixon_handle h, const char *head, const char *body, size_t len, cxobj **xret);
+int clicon_rpc_netconf_relay(clixon_handle h, const char *xmlstr, clixon_msg_relay_cb *fn, void *arg);
 int clixon_rpc_get_config1(clixon_handle h, char *username, char *db, char *xpath, cvec *nsc, char *defaults, yang_bind yb ,cxobj **xret);
 int clicon_rpc_edit_config(clixon_handle h, char *db, enum operation_type op,
                            char *xml);
+int clicon_rpc_edit_config_send(clixon_handle h, char *db, enum operation_type op,
+                                char *xmlstr, uint32_t *id);
+int clicon_rpc_edit_config_file(clixon_handle h, char *db, enum operation_type op, FILE *fp);
 int clicon_rpc_copy_config(clixon_handle h, char *db1, char *db2);
 int clicon_rpc_delete_config(clixon_handle h, char *db);
 int clicon_rpc_lock(clixon_handle h, char *db);
 int clicon_rpc_unlock(clixon_handle h, char *db);
 int clixon_rpc_get1(clixon_handle h, char *xpath, cvec *nsc, netconf_content content, int32_t depth, char *defaults, yang_bind yb, cxobj **xret);
+int clixon_rpc_get_reply(clixon_handle h, cxobj *xret, yang_bind yb, cxobj **xt);
+int clixon_rpc_get_async(clixon_handle h, char *xpath, cvec *nsc, netconf_content content, int32_t depth, char *defaults, clicon_rpc_async_cb *fn, void *arg);
 int clicon_rpc_get_pageable_list(clixon_handle h, char *datastore, char *xpath,
                                  cvec *nsc, netconf_content content, int32_t depth, char *defaults,
                                  uint32_t offset, uint32_t limit,
                                  char *direction, char *sort, char *where,
-                                 cxobj **xt);
+                                 char *cursor, cxobj **xt);
 int clicon_rpc_close_session(clixon_handle h);
 int clicon_rpc_kill_session(clixon_handle h, uint32_t session_id);
 int clicon_rpc_validate(clixon_handle h, char *db);
@@ -70,6 +101,7 @@ int clicon_rpc_debug(clixon_handle h, int level);
 int clicon_rpc_restconf_debug(clixon_handle h, int level);
 int clicon_hello_req(clixon_handle h, char *transport, char *source_host, uint32_t *id);
 int clixon_rpc_clixon_cache(clixon_handle h, const char *op, const char *type, const char *domain, const char *spec, const char *module, const char *revision, const char *keyword, const char *argument, cbuf *data);
+int clixon_rpc_clixon_cache_file(clixon_handle h, const char *domain, const char *spec, const char *module, const char *revision, const char *keyword, const char *argument, char **filename);
 int clixon_rpc_config_path_info(clixon_handle h, const char *api_path, int strict, const char *xpath, cvec *nsc0,
                                 int leafref_refer, const char *body, cxobj *xtop,
                                 char **api_path1, char **xpath1, cvec **nsc1,
@@ -78,6 +110,10 @@ int clixon_rpc_api_path2xml(clixon_handle h, const char *api_path, const char *b
 int clixon_rpc_translate_format(clixon_handle h, enum format_enum format, const char *xpath, cvec *nsc,
                                 cxobj *xt, int pretty, int skiptop, int cli_aware, const char *prepend, cbuf *cb);
 int clicon_rpc_restart_plugin(clixon_handle h, char *plugin);
+int clicon_rpc_count(clixon_handle h, char *db, char *xpath, cvec *nsc, int exists, uint32_t *count);
+int clicon_rpc_generation(clixon_handle h, char *db, uint64_t *gen, struct timeval *tv);
+int clicon_rpc_list_keys(clixon_handle h, char *db, char *xpath, cvec *nsc, char *prefix, uint32_t max,
+                         cvec **keys, int *more);
 
 /*-- Backward compatible 7.6 --*/
 static inline int
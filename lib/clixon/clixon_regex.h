@@ -42,8 +42,9 @@
  * Prototypes
  */
 int regexp_xsd2posix(const char *xsd, char **posix);
-int regex_compile(clixon_handle h, const char *regexp, void **recomp);
 int regex_exec(clixon_handle h, void *recomp, const char *string);
-int regex_free(clixon_handle h, void *recomp);
+int regex_cache_compile(int mode, const char *regexp, void **recomp);
+int regex_cache_exec(int mode, void *recomp, const char *string);
+int regex_cache_exit(void);
 
 #endif  /* _CLIXON_REGEX_H_ */
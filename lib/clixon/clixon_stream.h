@@ -59,17 +59,25 @@ struct stream_subscription{
     qelem_t                     ss_q;   /* queue header */
     char                       *ss_stream; /* Name of associated stream */
     char                       *ss_xpath;  /* Filter selector as xpath */
+    struct xpath_tree          *ss_xptree; /* Parsed filter selector */
+    const char                 *ss_event;  /* Notification child name required by filter, or NULL */
     struct timeval              ss_starttime; /* Replay starttime */
     struct timeval              ss_stoptime; /* Replay stoptime */
     stream_fn_t                 ss_fn;     /* Callback when event occurs */
     void                       *ss_arg;    /* Callback argument */
 };
 
-/* Replay time-series */
+/* Replay time-series entry, event serialized as XML */
 struct stream_replay{
-    qelem_t        r_q;   /* queue header */
     struct timeval r_tv;  /* time index */
-    cxobj         *r_xml; /* event in xml form */
+    char          *r_str; /* event serialized as XML */
+    size_t         r_len; /* length of r_str */
+};
+
+/* Vector of subscriptions, see es_ss_index */
+struct stream_ss_vec{
+    struct stream_subscription **sv_vec;
+    size_t                       sv_len;
 };
 
 /* See RFC8040 9.3, stream list, no replay support for now
@@ -79,10 +87,20 @@ struct event_stream{
     char                *es_name; /* name of notification event stream */
     char                *es_description;
     struct stream_subscription *es_subscription;
+    clicon_hash_t       *es_ss_index; /* Subscriptions by ss_event as struct stream_ss_vec */
+    struct stream_ss_vec es_ss_any;   /* Subscriptions without ss_event */
     int                  es_replay_enabled; /* set if replay is enables */
     struct timeval       es_retention; /* replay retention - how much to save */
-    struct stream_replay *es_replay;
-
+    struct stream_replay *es_replay;      /* Ring buffer of replay events in time order */
+    uint32_t             es_replay_size;  /* Allocated entries of es_replay */
+    uint32_t             es_replay_first; /* Index of oldest event */
+    uint32_t             es_replay_nr;    /* Number of events */
+    size_t               es_replay_bytes; /* Size of serialized events */
+    uint32_t             es_replay_max;   /* Max number of events, 0: no limit */
+    size_t               es_replay_max_bytes; /* Max size of events, 0: no limit */
+    char                *es_replay_file;  /* Segment file, see CLICON_STREAM_REPLAY_DIR */
+    FILE                *es_replay_f;     /* Segment file opened for append */
+    uint32_t             es_replay_dropped; /* Events dropped since segment file was written */
 };
 typedef struct event_stream event_stream_t;
 
@@ -105,6 +123,7 @@ struct stream_subscription *stream_ss_find(event_stream_t *es,
 int stream_ss_delete_all(clixon_handle h, stream_fn_t fn, void *arg);
 int stream_ss_delete(clixon_handle h, const char *name, stream_fn_t fn, void *arg);
 
+uint64_t stream_event_seq(void);
 int stream_notify_xml(clixon_handle h, const char *stream, cxobj *xml);
 int stream_notify(clixon_handle h, const char *stream, const char *event, ...)  __attribute__ ((format (printf, 3, 4)));
 
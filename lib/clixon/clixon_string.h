@@ -78,6 +78,10 @@ char  *clixon_trim2(char *str, const char *trims);
 int    clicon_strcmp(const char *s1, const char *s2);
 int    clixon_unicode2utf8(const char *ucstr, char *utfstr, size_t utflen);
 int    clixon_str_subst(char *str, cvec *cvv, cbuf *cb);
+char  *clixon_str_intern(const char *str);
+int    clixon_str_intern_free(char *istr);
+int    clixon_str_intern_stats(uint64_t *nrp, size_t *szp);
+int    clixon_str_intern_exit(void);
 
 #ifndef HAVE_STRNDUP
 char *clicon_strndup (const char *, size_t);
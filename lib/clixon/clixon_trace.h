@@ -0,0 +1,98 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+ 
+  Copyright (C) 2026 Olof Hagsand
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2, 
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+ * Trace spans of major operations, eg parse, bind, xpath, validate, diff, plugin callbacks
+ * and datastore I/O, recorded in an in-memory buffer per process.
+ * Spans are selected by CLIXON_DBG_* subject, which is also the category of a span.
+ * The buffers can be exported as Chrome trace event JSON (also read by perfetto) or as
+ * folded stacks for flamegraphs.
+ * Example:
+ *   clixon_trace_t tr = clixon_trace_begin(CLIXON_DBG_XML);
+ *   ...
+ *   clixon_trace_end(tr, CLIXON_DBG_XML, __func__, NULL);
+ */
+
+#ifndef _CLIXON_TRACE_H_
+#define _CLIXON_TRACE_H_
+
+/*
+ * Types
+ */
+/* Start of a span in nanoseconds, 0 if the span is not traced */
+typedef uint64_t clixon_trace_t;
+
+/*
+ * Variables
+ */
+/* CLIXON_DBG_* subjects that are traced, 0 if tracing is disabled */
+extern uint32_t _clixon_trace_mask;
+
+/*
+ * Prototypes
+ */
+uint64_t clixon_trace_now(void);
+void     clixon_trace_record(clixon_trace_t t, uint32_t cat, const char *name, const char *detail);
+int      clixon_trace_init(clixon_handle h);
+int      clixon_trace_mask_set(uint32_t mask);
+int      clixon_trace_print(cbuf *cb, const char *format);
+int      clixon_trace_clear(void);
+int      clixon_trace_exit(void);
+
+/*! Begin a trace span, cheap if the category is not traced
+ *
+ * @param[in]  cat  CLIXON_DBG_* subject of span
+ * @retval     t    Start of span, give to clixon_trace_end
+ */
+static inline clixon_trace_t
+clixon_trace_begin(uint32_t cat)
+{
+    return (_clixon_trace_mask & cat) ? clixon_trace_now() : 0;
+}
+
+/*! End a trace span and record it in the trace buffer
+ *
+ * @param[in]  t      Start of span from clixon_trace_begin, no-op if 0
+ * @param[in]  cat    CLIXON_DBG_* subject of span
+ * @param[in]  name   Name of span, eg function name
+ * @param[in]  detail Extra name of span, eg plugin or XPath, or NULL
+ */
+static inline void
+clixon_trace_end(clixon_trace_t t,
+                 uint32_t       cat,
+                 const char    *name,
+                 const char    *detail)
+{
+    if (t)
+        clixon_trace_record(t, cat, name, detail);
+}
+
+#endif  /* _CLIXON_TRACE_H_ */
@@ -49,7 +49,10 @@ int xml_yang_validate_add(clixon_handle h, cxobj *xt, cxobj **xret);
 int xml_yang_validate_list_key_only(cxobj *xt, cxobj **xret);
 int xml_yang_validate_all(clixon_handle h, cxobj *xt, int state, cxobj **xret);
 int xml_yang_validate_all_state(clixon_handle h, cxobj *xt, int state, cxobj **xret);
+int xml_yang_validate_incr_add(cxobj *x);
+int xml_yang_validate_incr_reset(void);
 int xml_yang_validate_exit(clixon_handle h);
+int xml_yang_validate_parallel_set(int workers);
 int rpc_reply_check(clixon_handle h, const char *rpcname, cbuf *cbret);
 
 /*-- Backward compatible 7.7 --*/
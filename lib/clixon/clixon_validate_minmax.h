@@ -45,5 +45,6 @@
  */
 int xml_yang_validate_minmax(cxobj *xt, int presence, cxobj **xret);
 int xml_duplicate_detect(cxobj *xt, int rm, cxobj **xret);
+int xml_yang_validate_minmax_incr_set(int on);
 
 #endif  /* _CLIXON_VALIDATE_MINMAX_H_ */
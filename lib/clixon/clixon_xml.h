@@ -171,6 +171,7 @@ typedef enum yang_bind yang_bind;
 #define CX_ANY CX_ERROR /* catch all and error is same */
 
 typedef struct xml cxobj; /* struct defined in clicon_xml.c */
+struct xml_nsscope;        /* struct defined in clixon_xml_nsctx.c */
 
 /*! Callback function type for xml_apply
  *
@@ -196,7 +197,8 @@ enum format_enum{
     FORMAT_CLI,
     FORMAT_NETCONF,  /* Last concrete format, used in code */
     FORMAT_DEFAULT,  /* Indirect: actual value in CLICON_CLI_OUTPUT_FORMAT */
-    FORMAT_PIPE_XML_DEFAULT /* Meta: If pipe, xml, if not default */
+    FORMAT_PIPE_XML_DEFAULT, /* Meta: If pipe, xml, if not default */
+    FORMAT_BINARY    /* Datastore only, see clixon_xml_bin.c */
 };
 
 /*! Detail statistics about XML objects, used for debugging and optimization purposes
@@ -234,14 +236,20 @@ typedef enum xml_stats_enum xml_stats_enum;
 #define XML_FLAG_CACHE_DIRTY 0x400 /* This part of XML tree is not synced to disk */
 #define XML_FLAG_SKIP      0x800 /* Node is skipped in xml_diff */
 #define XML_FLAG_DENY     0x1000 /* Marked as read denied by NACM  */
+#define XML_FLAG_HINDEX   0x2000 /* Entry is hashed in hash index of parent, see CLICON_XML_HASH_INDEX */
+#define XML_FLAG_DIGEST   0x4000 /* Subtree digest is valid, see xml_digest */
+#define XML_FLAG_SLAB     0x8000 /* Node is allocated from slab, see xml_slab_set */
 
 /*
  * Prototypes
  */
 const char *xml_type2str(enum cxobj_type type);
 xml_stats_enum xml_stats_str2type(const char *str);
+int       xml_childvec_chunk_set(int enable);
 int       xml_stats_global(uint64_t *nr);
 int       xml_stats(cxobj *xt, xml_stats_enum type, uint64_t *nrp, size_t *szp);
+int       xml_slab_set(int enable);
+int       xml_exit(void);
 char     *xml_name(cxobj *xn);
 int       xml_name_set(cxobj *xn, const char *name);
 char     *xml_prefix(cxobj *xn);
@@ -252,6 +260,9 @@ cvec     *nscache_get_all(cxobj *x);
 int       nscache_set(cxobj *x, const char *prefix, const char *ns);
 int       nscache_clear(cxobj *x);
 int       nscache_replace(cxobj *x, cvec *ns);
+uint64_t  xml_nsscope_gen(void);
+struct xml_nsscope *nsscope_get(cxobj *x);
+int       nsscope_set(cxobj *x, struct xml_nsscope *nss);
 cxobj    *xml_parent(cxobj *xn);
 int       xml_parent_set(cxobj *xn, cxobj *parent);
 #ifdef XML_PARENT_CANDIDATE
@@ -262,10 +273,13 @@ int       xml_parent_candidate_set(cxobj *xn, cxobj *parent);
 uint16_t  xml_flag(cxobj *xn, uint16_t flag);
 int       xml_flag_set(cxobj *xn, uint16_t flag);
 int       xml_flag_reset(cxobj *xn, uint16_t flag);
+int       xml_flag_reset_tree(cxobj *xt, uint16_t flag);
 
 char     *xml_value(cxobj *xn);
 int       xml_value_set(cxobj *xn, const char *val);
 int       xml_value_append(cxobj *xn, const char *val);
+int       xml_value_shared_set(size_t len);
+int       xml_value_enc(cxobj *xn, char **encp);
 enum cxobj_type xml_type(cxobj *xn);
 enum cxobj_type xml_type_set(cxobj *xn, enum cxobj_type type);
 int       xml_child_nr(cxobj *xn);
@@ -279,6 +293,7 @@ int       xml_child_order(cxobj *xn, cxobj *xc);
 int       xml_vector_decrement(cxobj *x, int nr);
 cxobj    *xml_child_each(cxobj *xparent, cxobj *xprev,  enum cxobj_type type);
 cxobj    *xml_child_each_attr(cxobj *xparent, cxobj *xprev);
+cxobj    *xml_child_iter(cxobj *xparent, int *inext, enum cxobj_type type);
 int       xml_child_insert_pos(cxobj *x, cxobj *xc, int pos);
 int       xml_childvec_set(cxobj *x, int len);
 cxobj   **xml_childvec_get(cxobj *x);
@@ -315,6 +330,7 @@ int       xml_free0(cxobj *x);
 int       xml_free(cxobj *xn);
 int       xml_copy_one(cxobj *xn0, cxobj *xn1);
 int       xml_copy(cxobj *x0, cxobj *x1);
+int       xml_copy_skip(cxobj *x0, cxobj *x1, uint16_t skip);
 cxobj    *xml_dup(cxobj *x0);
 int       cxvec_dup(cxobj **vec0, int len0, cxobj ***vec1, int *len1);
 int       cxvec_append(cxobj *x, cxobj ***vec, size_t *len);
@@ -337,5 +353,8 @@ int       xml_search_child_rm(cxobj *xp, cxobj *x);
 cxobj    *xml_child_index_each(cxobj *xparent, const char *name, cxobj *xprev, enum cxobj_type type);
 
 #endif
+int       xml_digest_set(int enable);
+int       xml_digest(cxobj *x, unsigned char **mdp);
+int       xml_digest_equal(cxobj *x0, cxobj *x1);
 
 #endif /* _CLIXON_XML_H */
@@ -49,6 +49,7 @@ int xml_bind_yang_mnt(clixon_handle h, cxobj *xt, yang_bind yb, yang_stmt *yspec
                       int jsonenc, int skip_mnt, cxobj **xerr);
 int xml_bind_yang0(clixon_handle h, cxobj *xt, yang_bind yb, yang_stmt *yspec,
                    int jsonenc, int skip_mnt, cxobj **xerr);
+int xml_bind_yang0_sort(clixon_handle h, cxobj *xt, yang_bind yb, yang_stmt *yspec, cxobj **xerr);
 int xml_bind_yang_rpc_method(clixon_handle h, cxobj *xrpc, yang_stmt *yspec, cxobj **xerr);
 int xml_bind_yang_rpc(clixon_handle h, cxobj *xrpc, yang_stmt *yspec, cxobj **xerr);
 int xml_bind_yang_rpc_reply(clixon_handle h, cxobj *xrpc, const char *name, yang_stmt *yspec, cxobj **xerr);
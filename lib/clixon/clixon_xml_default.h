@@ -55,5 +55,6 @@ int xml_default_nopresence(cxobj *xn, int mode, int flag);
 int xml_add_default_tag(cxobj *x, uint16_t flags);
 int xml_flag_state_default_value(cxobj *x, uint16_t flag);
 int xml_flag_default_value(cxobj *x, uint16_t flag);
+void xml_default_template_free(void *arg);
 
 #endif  /* _CLIXON_XML_DEFAULT_H_ */
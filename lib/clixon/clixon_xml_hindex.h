@@ -1,7 +1,9 @@
 /*
  *
   ***** BEGIN LICENSE BLOCK *****
- 
+
+  Copyright (C) 2009-2016 Olof Hagsand and Benny Holmgren
+  Copyright (C) 2017-2019 Olof Hagsand
   Copyright (C) 2020-2022 Olof Hagsand and Rubicon Communications, LLC(Netgate)
 
   This file is part of CLIXON.
@@ -23,7 +25,7 @@
   in which case the provisions of the GPL are applicable instead
   of those above. If you wish to allow use of your version of this file only
   under the terms of the GPL, and not to allow others to
-  use your version of this file under the terms of Apache License version 2, 
+  use your version of this file under the terms of Apache License version 2,
   indicate your decision by deleting the provisions above and replace them with
   the  notice and other provisions required by the GPL. If you do not delete
   the provisions above, a recipient may use your version of this file under
@@ -31,40 +33,29 @@
 
   ***** END LICENSE BLOCK *****
 
- * HTTP/1.1 parser according to RFC 7230
+ * Hash index of YANG list entries keyed by full key tuple
+ * Used as an alternative to binary search for exact key lookups in large lists
+ * @see CLICON_XML_HASH_INDEX
  */
-#ifndef _CLIXON_HTTP1_PARSE_H_
-#define _CLIXON_HTTP1_PARSE_H_
+#ifndef _CLIXON_XML_HINDEX_H
+#define _CLIXON_XML_HINDEX_H
 
 /*
  * Types
  */
-struct clixon_http1_yacc {
-    const char   *hy_name;         /* Name of syntax (for error string) */
-    clixon_handle hy_h;            /* Clixon handle */
-    restconf_conn *hy_rc;          /* Connection handle */
-    int           hy_linenum;      /* Number of \n in parsed buffer */
-    char         *hy_parse_string; /* original (copy of) parse string */
-    void         *hy_lexbuf;       /* internal parse buffer from lex */
-};
-typedef struct clixon_http1_yacc clixon_http1_yacc;
-
-/*
- * Variables
- */
-extern char *clixon_http1_parsetext;
+struct xml_hindex; /* struct defined in clixon_xml_hindex.c */
 
 /*
  * Prototypes
  */
-int http1_scan_init(clixon_http1_yacc *);
-int http1_scan_exit(clixon_http1_yacc *);
-
-int http1_parse_init(clixon_http1_yacc *);
-int http1_parse_exit(clixon_http1_yacc *);
-
-int clixon_http1_parselex(void *);
-int clixon_http1_parseparse(void *);
-void clixon_http1_parseerror(void *, char*);
-
-#endif  /* _CLIXON_HTTP1_PARSE_H_ */
+int    xml_hindex_enable_set(int enable);
+struct xml_hindex *xml_hindex(cxobj *x);
+int    xml_hindex_set(cxobj *x, struct xml_hindex *xh);
+int    xml_hindex_search(cxobj *xp, cxobj *x1, yang_stmt *yc, clixon_xvec *xvec);
+int    xml_hindex_child_add(cxobj *xp, cxobj *xc);
+int    xml_hindex_child_rm(cxobj *xp, cxobj *xc);
+int    xml_hindex_key_change(cxobj *xe, cxobj *xk);
+int    xml_hindex_free(cxobj *xp);
+size_t xml_hindex_size(cxobj *xp);
+
+#endif /* _CLIXON_XML_HINDEX_H */
@@ -40,9 +40,43 @@
 #ifndef _CLIXON_XML_IO_H_
 #define _CLIXON_XML_IO_H_
 
+/*
+ * Types
+ */
+/*! Flush function of streamed XML output, see clixon_xml2cbuf_stream
+ *
+ * @param[in]  buf   Output
+ * @param[in]  len   Length of output
+ * @param[in]  arg   Argument given to clixon_xml2cbuf_stream
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+typedef int (clixon_xml_flush_fn)(char *buf, size_t len, void *arg);
+
+/*! Filter function of XML output, see clixon_xml2cbuf_filter
+ *
+ * @param[in]  x     XML element
+ * @param[in]  arg   Argument given to clixon_xml2cbuf_filter
+ * @retval     2     Print element and filter its children
+ * @retval     1     Print element and its subtree
+ * @retval     0     Leave out element and its subtree
+ * @retval    -1     Error
+ */
+typedef int (clixon_xml_filter_fn)(cxobj *x, void *arg);
+
+/*! Print function to a cligen buffer, see clixon_xml2file_stream
+ *
+ * @param[in]  cb    Cligen buffer
+ * @param[in]  arg   Argument given to clixon_xml2file_stream
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+typedef int (clixon_xml_print_fn)(cbuf *cb, void *arg);
+
 /*
  * Prototypes
  */
+int   xml2output_wdef(cxobj *x, withdefaults_type wdef, int *tag);
 int   clixon_xml2file1(FILE *f, cxobj *xn, int level, int pretty, const char *prefix,
                        clicon_output_cb *fn, int skiptop, int autocliext, withdefaults_type wdef,
                        int multi, int system_only);
@@ -52,6 +86,15 @@ int   xml_print1(FILE *f, cxobj *xn);
 int   xml_dump(FILE  *f, cxobj *x);
 int   clixon_xml2cbuf1(cbuf *cb, cxobj *x, int level, int prettyprint, const char *prefix,
                        int32_t depth, int skiptop, int autocliext, withdefaults_type wdef);
+int   clixon_xml2cbuf_marked(cbuf *cb, cxobj *xn, int level, int pretty, int32_t depth,
+                             int skiptop, withdefaults_type wdef);
+int   clixon_xml2cbuf_filter(cbuf *cb, cxobj *xn, int level, int pretty, int32_t depth,
+                             int skiptop, withdefaults_type wdef, clixon_xml_filter_fn *fn, void *arg);
+int   clixon_xml2cbuf_stream(cbuf *cb, clixon_xml_flush_fn *fn, void *arg, size_t size);
+size_t clixon_xml2cbuf_stream_flushed(void);
+size_t clixon_xml2cbuf_pos(cbuf *cb);
+int   clixon_xml2cbuf_stream_flush(cbuf *cb);
+int   clixon_xml2file_stream(FILE *f, clicon_output_cb *fn, clixon_xml_print_fn *pfn, void *arg);
 int   xmltree2cbuf(cbuf *cb, cxobj *x, int level);
 int   clixon_xml_parse_file(FILE *f, yang_bind yb, yang_stmt *yspec, cxobj **xt, cxobj **xerr);
 int   clixon_xml_parse_string1(clixon_handle h, const char *str, yang_bind yb, yang_stmt *yspec, cxobj **xt, cxobj **xerr);
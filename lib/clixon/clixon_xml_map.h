@@ -63,6 +63,7 @@ int xmlns_assign(cxobj *x);
 int xml2cvec(cxobj *xt, yang_stmt *ys, cvec **cvv0);
 int cvec2xml_1(cvec *cvv, const char *toptag, cxobj *xp, cxobj **xt0);
 int xml_tree_prune_flagged_sub(cxobj *xt, int flag, int test, int *upmark);
+int xml_tree_prune_marked(cxobj *xt, cxobj **xvec, size_t xlen);
 int xml_tree_mark_flagged_sub(cxobj *xt, int flag, int test, int delmark, int *upmark);
 int xml_tree_prune_flags(cxobj *xt, int flags, int mask);
 int xml_tree_prune_flags1(cxobj *xt, int flags, int mask, int recurse, int *removed);
@@ -80,6 +81,7 @@ int yang_enum2valstr(yang_stmt *ytype, const char *enumstr, char **valstr);
 int yang_enum2int(yang_stmt *ytype, const char *enumstr, int32_t *val);
 int yang_enum_int_value(cxobj *node, int32_t *val);
 int xml_copy_marked(cxobj *x0, cxobj *x1);
+int xml_copy_marked_skip(cxobj *x0, cxobj *x1, uint16_t skip);
 int yang_check_when_xpath(cxobj *xn, cxobj *xp, yang_stmt *yn, int *hit, int *nrp, char **xpathp);
 int yang_xml_mandatory(cxobj *xt, yang_stmt *ys);
 int xml_rpc_isaction(cxobj *xn);
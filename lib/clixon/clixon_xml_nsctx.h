@@ -53,6 +53,7 @@ int     xml_nsctx_free(cvec *nsc);
 char   *xml_nsctx_get(cvec *nsc, const char *prefix);
 int     xml_nsctx_get_prefix(cvec *cvv, const char *ns, char **prefix);
 int     xml_nsctx_add(cvec *nsc, const char *prefix, const char *ns);
+int     xml_nsscope_free(struct xml_nsscope *nss);
 int     xml_nsctx_node(cxobj *x, cvec **ncp);
 int     xml_nsctx_yang(yang_stmt *yn, cvec **ncp);
 int     xml_nsctx_yangspec(yang_stmt *yspec, cvec **ncp);
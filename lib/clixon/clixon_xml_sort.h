@@ -41,12 +41,17 @@
 /*
  * Prototypes
  */
+int xml_cv_cache(cxobj *x, cg_var **cvp);
 int xml_cmp(cxobj *x1, cxobj *x2, int same, int skip1, const char *expl);
 int xml_sort(cxobj *x);
 int xml_sort_by(cxobj *x, char *indexvar);
+int xml_sort_children(cxobj *xn);
 int xml_sort_recurse(cxobj *xn);
 int xml_insert(cxobj *xp, cxobj *xc, enum insert_type ins, const char *key_val, cvec *nsckey);
 int xml_sort_verify(cxobj *x, void *arg);
+#ifdef XML_BIND_CV_CACHE
+int xml_cv_bind(cxobj *x);
+#endif
 #ifdef XML_EXPLICIT_INDEX
 int xml_search_indexvar_binary_pos(cxobj *xp, const char *indexvar, clixon_xvec *xvec,
                                    int low, int upper, int max, int *eq);
@@ -134,7 +134,16 @@ int   xpath_tree_eq(xpath_tree *xt1, xpath_tree *xt2, xpath_tree ***vec, size_t
 xpath_tree *xpath_tree_traverse(xpath_tree *xt, ...);
 int   xpath_tree_free(xpath_tree *xs);
 int   xpath_parse(const char *xpath, xpath_tree **xptree);
+int   xpath_parse_cache_set(int enable);
+int   xpath_parse_cache_stats(int *nr, int *hits, int *misses);
+void  xpath_parse_cache_exit(void);
+int   xpath_profile_set(int enable);
+void  xpath_profile_step(int nodes, int optimized);
+int   xpath_profile_print(cbuf *cb);
+void  xpath_profile_exit(void);
+int   xpath_parallel_set(int workers);
 int   xpath_vec_ctx(cxobj *xcur, cvec *nsc, const char *xpath, int localonly, xp_ctx **xrp);
+int   xpath_tree_ctx(cxobj *xcur, cvec *nsc, xpath_tree *xptree, int localonly, xp_ctx **xrp);
 
 int    xpath_vec_bool(cxobj *xcur, cvec *nsc, const char *xpformat, ...) __attribute__ ((format (printf, 3, 4)));
 int    xpath_vec_flag(cxobj *xcur, cvec *nsc, const char *xpformat, uint16_t flags,
@@ -146,6 +155,7 @@ int    xpath_vec_flag(cxobj *xcur, cvec *nsc, const char *xpformat, uint16_t fla
  * If you do not know what a namespace context is, see README.md#xml-and-xpath
  */
 cxobj *xpath_first(cxobj *xcur, cvec *nsc, const char *xpformat,  ...) __attribute__ ((format (printf, 3, 4)));
+cxobj *xpath_first_tree(cxobj *xcur, cvec *nsc, xpath_tree *xptree);
 cxobj *xpath_first_localonly(cxobj *xcur, const char *xpformat,  ...) __attribute__ ((format (printf, 2, 3)));
 int    xpath_vec(cxobj *xcur, cvec *nsc, const char *xpformat, cxobj ***vec, size_t *veclen, ...) __attribute__ ((format (printf, 3, 6)));
 
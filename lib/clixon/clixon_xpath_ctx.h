@@ -87,6 +87,8 @@ struct xp_ctx{
     cxobj          *xc_node;    /* Node in nodeset XXX maybe not needed*/
     cxobj          *xc_initial; /* RFC 7960 10.1.1 extension: for current() */
     int             xc_descendant;  /* // */
+    int             xc_limit;   /* If >0, step xc_last may stop after this many nodes */
+    struct xpath_tree *xc_last; /* Last step of top-level location path, see xc_limit */
     /* NYI: a set of variable bindings, set of namespace declarations */
 };
 typedef struct xp_ctx xp_ctx;
@@ -101,6 +103,7 @@ extern const map_str2int ctxmap[];
  */
 int ctx_free(xp_ctx *xc);
 xp_ctx *ctx_dup(xp_ctx *xc);
+xp_ctx *ctx_dup_empty(xp_ctx *xc);
 int ctx_nodeset_replace(xp_ctx *xc, cxobj **vec, size_t veclen);
 int ctx_print_cb(cbuf *cb, xp_ctx *xc, int indent, const char *str);
 int ctx_print(FILE *f, xp_ctx *xc, const char *str);
@@ -41,6 +41,7 @@
 int  xpath_list_optimize_stats(int *hits);
 int  xpath_list_optimize_set(int enable);
 void xpath_optimize_exit(void);
-int  xpath_optimize_check(xpath_tree *xs, cxobj *xv, cxobj ***xvec0, int *xlen0);
+int  xpath_optimize_check(xpath_tree *xs, cxobj *xv, cxobj *xinit, cvec *nsc, int localonly,
+                          cxobj ***xvec0, int *xlen0);
 
 #endif /* _CLIXON_XPATH_OPTIMIZE_H */
@@ -232,6 +232,17 @@ typedef struct yang_stmt yang_stmt;
  */
 typedef int (yang_applyfn_t)(yang_stmt *ys, void *arg);
 
+/* Phases of YANG load profile, see CLICON_YANG_PROFILE */
+enum yang_profile_phase{
+    YANG_PROF_PARSE,    /* Lex and parse YANG files, or read parse cache */
+    YANG_PROF_EXPAND,   /* Grouping/uses expansion */
+    YANG_PROF_AUGMENT,  /* Top-level augments */
+    YANG_PROF_POST,     /* Other post steps, eg populate, resolve types, deviations */
+    YANG_PROF_AUTOCLI,  /* Autocli generation */
+    YANG_PROF_BIND,     /* Bind datastore XML to YANG */
+    YANG_PROF_MAX
+};
+
 /* Validation level at commit */
 enum validate_level_t {
     VL_FULL = 0, /* Do full RFC 7950 validation , 0 : backward-compatible */
@@ -296,12 +307,19 @@ uint32_t   yang_linenum_get(yang_stmt *ys);
 int        yang_linenum_set(yang_stmt *ys, uint32_t linenum);
 void      *yang_typecache_get(yang_stmt *ys);
 int        yang_typecache_set(yang_stmt *ys, void *ycache);
+void      *yang_validator_get(yang_stmt *ys);
+int        yang_validator_set(yang_stmt *ys, void *yv);
+int        yang_identity_derived(yang_stmt *ybaseid, const char *idref);
 yang_stmt* yang_mymodule_get(yang_stmt *ys);
 int        yang_mymodule_set(yang_stmt *ys, yang_stmt *ym);
 
 /* Stats */
 int        yang_stats_global(uint64_t *nr);
 int        yang_stats(yang_stmt *y, enum rfc_6020 keyw, uint64_t *nrp, size_t *szp);
+int        yang_profile_set(int enable);
+void       yang_profile_start(struct timeval *tv);
+void       yang_profile_stop(enum yang_profile_phase phase, struct timeval *tv0);
+int        yang_profile_log(clixon_handle h, yang_stmt *yspec);
 
 /* Other functions */
 yang_stmt *yspec_new(clixon_handle h, const char *name);
@@ -372,6 +390,18 @@ int        yang_action_cb_add(yang_stmt *ys, void *rc);
 void      *yang_nopresence_cache_get(yang_stmt *ys);
 int        yang_nopresence_cache_set(yang_stmt *ys, void *x);
 #endif
+#ifdef YANG_DEFAULT_TEMPLATE
+void      *yang_defaults_get(yang_stmt *ys);
+int        yang_defaults_set(yang_stmt *ys, void *dt);
+#endif
+#ifdef YANG_CHILD_INDEX
+int        yang_child_index_clear(yang_stmt *ys);
+int        yang_child_index_build(yang_stmt *ys, void *arg);
+#endif
+#ifdef YANG_SCHEMA_MOUNT_INDEX
+void      *yang_mount_index_get(yang_stmt *ymounts);
+int        yang_mount_index_set(yang_stmt *ymounts, void *index);
+#endif
 int        ys_populate_feature(clixon_handle h, yang_stmt *ys);
 int        yang_init(clixon_handle h);
 int        yang_start(clixon_handle h);
@@ -62,13 +62,19 @@ int        yang_spec_parse_module(clixon_handle h, const char *module,
 yang_stmt *yang_parse_str(const char *str, const char *name, yang_stmt *yspec);
 int        yang_spec_parse_file(clixon_handle h, const char *filename, yang_stmt *yspec);
 int        yang_spec_load_dir(clixon_handle h, const char *dir, yang_stmt *yspec);
+yang_stmt *yang_lazy_load(yang_stmt *yspec, const char *ns, const char *name);
+void       yang_lazy_rm(yang_stmt *yspec);
 int        ys_parse_date_arg(const char *datearg, uint32_t *dateint);
 cg_var    *ys_parse(yang_stmt *ys, enum cv_type cvtype);
 int        ys_parse_sub(yang_stmt *ys, const char *filename, char *extra);
-#ifdef OPTIMIZE_YSPEC_NAMESPACE
+#ifdef YANG_PARSE_CACHE_SHARED
+int        yang_parse_cache_shared(const char *str);
+int        yang_parse_cache_exit(void);
+#endif
 int        yspec_nscache_clear(yang_stmt *yspec);
 yang_stmt *yspec_nscache_get(yang_stmt *yspec, const char *ns);
 int        yspec_nscache_new(yang_stmt *yspec);
-#endif
+yang_stmt *yspec_nscache_prefix_get(yang_stmt *yspec, const char *key);
+int        yspec_nscache_prefix_set(yang_stmt *yspec, const char *key, yang_stmt *ymod);
 
 #endif  /* _CLIXON_YANG_LIB_H_ */
@@ -57,6 +57,7 @@ typedef struct yang_type_cache yang_type_cache;
  * Prototypes
  */
 int        ys_resolve_type(yang_stmt *ys, void *arg);
+void       yang_validator_free(void *arg);
 int        yang2cv_type(const char *ytype, enum cv_type *cv_type);
 char      *cv2yang_type(enum cv_type cv_type);
 yang_stmt *yang_find_identity(yang_stmt *ys, const char *identity);
@@ -40,6 +40,7 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <stdint.h>
 #include <errno.h>
 #include <fcntl.h>
 #include <syslog.h>
@@ -481,6 +482,50 @@ autocli_grouping_treeref(clixon_handle h,
     return retval;
 }
 
+/*! Return autocli top-level treeref option
+ *
+ * When true, the children of top-level containers and lists are generated as separate trees
+ * referenced with @treeref, and generated first when used
+ * @param[in]  h          Clixon handle
+ * @param[out] treeref    Top-level treerefs enabled
+ * @retval     0          OK
+ * @retval    -1          Error
+ */
+int
+autocli_toplevel_treeref(clixon_handle h,
+                         int          *treeref)
+{
+    int     retval = -1;
+    char   *str;
+    uint8_t val;
+    char   *reason = NULL;
+    cxobj  *xautocli;
+    int     ret;
+
+    if (treeref == NULL){
+        clixon_err(OE_YANG, EINVAL, "Argument is NULL");
+        goto done;
+    }
+    if ((xautocli = clicon_conf_autocli(h)) == NULL){
+        clixon_err(OE_YANG, 0, "No clixon-autocli");
+        goto done;
+    }
+    if ((str = xml_find_body(xautocli, "toplevel-treeref")) == NULL){
+        clixon_err(OE_XML, EINVAL, "No toplevel-treeref rule");
+        goto done;
+    }
+    if ((ret = parse_bool(str, &val, &reason)) < 0){
+        clixon_err(OE_CFG, errno, "parse_bool");
+        goto done;
+    }
+    *treeref = val;
+    retval = 0;
+ done:
+    if (reason)
+        free(reason);
+    return retval;
+}
+
 /*! Return default autocli list keyword setting
  *
  * Currently only returns list-keyword-default, could be extended to rules
@@ -641,260 +686,262 @@ autocli_cache(clixon_handle    h,
     return retval;
 }
 
-/*! Translate to CLI commands in cbuf
+/* Number of entries of yang node cache of CLI output, power of two */
+#define CLI_YCACHE_SIZE 128
+
+/* Flush CLI output buffer to file when it exceeds this size */
+#define CLI_EMIT_FLUSH 4096
+
+/*! Yang node info for CLI output, computed once per yang node and output
+ */
+struct cli_ynode {
+    yang_stmt *cn_ys;       /* Yang node, key of cache */
+    int        cn_hide;     /* Hidden by autocli hide-show extension */
+    char      *cn_alias;    /* Name given by autocli alias extension, or NULL */
+    int        cn_compress; /* Skip keyword of non-leaf, see autocli_compress */
+};
+
+/*! State of one CLI output
+ *
+ * All output is made to a buffer. If a file is given, the buffer is flushed to it in
+ * chunks. The prepend string of each level is kept in one buffer which is extended
+ * before, and truncated after, each level.
+ */
+struct cli_emit {
+    clixon_handle     ce_h;
+    cbuf             *ce_cb;       /* Output buffer */
+    FILE             *ce_f;        /* File to flush to, or NULL */
+    clicon_output_cb *ce_fn;       /* Print function of file */
+    autocli_listkw_t  ce_listkw;   /* List keyword setting */
+    cbuf             *ce_pre;      /* Prepend string of current level */
+    struct cli_ynode *ce_ycache;   /* Yang node cache of CLI_YCACHE_SIZE */
+};
+
+/*! Get yang node info for CLI output, from cache if possible
+ *
+ * @param[in]  ce   CLI output state
+ * @param[in]  ys   Yang node
+ * @param[out] cn   Yang node info, in cache
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+cli_ynode_get(struct cli_emit   *ce,
+              yang_stmt         *ys,
+              struct cli_ynode **cn)
+{
+    struct cli_ynode *c;
+    int               exist;
+    char             *name = NULL;
+
+    c = &ce->ce_ycache[((uintptr_t)ys >> 4) & (CLI_YCACHE_SIZE-1)];
+    if (c->cn_ys == ys){
+        *cn = c;
+        return 0;
+    }
+    c->cn_ys = NULL;
+    c->cn_hide = 0;
+    c->cn_alias = NULL;
+    c->cn_compress = 0;
+    exist = 0;
+    if (yang_extension_value(ys, "hide-show", CLIXON_AUTOCLI_NS, &exist, NULL) < 0)
+        return -1;
+    c->cn_hide = exist;
+    exist = 0;
+    if (yang_extension_value(ys, "alias", CLIXON_AUTOCLI_NS, &exist, &name) < 0)
+        return -1;
+    if (exist)
+        c->cn_alias = name;
+    if (yang_keyword_get(ys) != Y_LEAF &&
+        yang_keyword_get(ys) != Y_LEAF_LIST){
+        /* If non-presence container && HIDE mode && only child is
+         * a list, then skip container keyword
+         * See also yang2cli_container */
+        if (autocli_compress(ce->ce_h, ys, &c->cn_compress) < 0)
+            return -1;
+    }
+    c->cn_ys = ys;
+    *cn = c;
+    return 0;
+}
+
+/*! Flush CLI output buffer to file
+ *
+ * @param[in]  ce    CLI output state
+ * @param[in]  force If 0 only flush if buffer exceeds CLI_EMIT_FLUSH
+ */
+static void
+cli_emit_flush(struct cli_emit *ce,
+               int              force)
+{
+    if (ce->ce_fn == NULL || cbuf_len(ce->ce_cb) == 0)
+        return;
+    if (force || cbuf_len(ce->ce_cb) >= CLI_EMIT_FLUSH){
+        (*ce->ce_fn)(ce->ce_f, "%s", cbuf_get(ce->ce_cb));
+        cbuf_reset(ce->ce_cb);
+    }
+}
+
+/*! Print a leaf line: prepend, name and body
+ */
+static void
+cli_emit_leaf(struct cli_emit *ce,
+              const char      *name,
+              cxobj           *xn)
+{
+    cbuf *cb = ce->ce_cb;
+    char *body;
+
+    cprintf(cb, "%s", cbuf_get(ce->ce_pre));
+    if (ce->ce_listkw != AUTOCLI_LISTKW_NONE)
+        cprintf(cb, "%s ", name);
+    if ((body = xml_body(xn)) != NULL){
+        if (index(body, ' '))
+            cprintf(cb, "\"%s\"", body);
+        else
+            cprintf(cb, "%s", body);
+    }
+    cprintf(cb, "\n");
+}
+
+/*! Translate from XML to CLI commands, internal
  *
  * Howto: join strings and pass them down.
  * Identify unique/index keywords for correct set syntax.
- * @param[in]     h       Clixon handle
- * @param[in,out] cb      Cligen buffer to write to
- * @param[in]     xn      XML Parse-tree (to translate)
- * @param[in]     prepend Print this text in front of all commands.
- * @retval        0       OK
- * @retval       -1       Error
- * @see clixon_cli2file
+ * @param[in] ce       CLI output state, ce_pre is prepend string of this level
+ * @param[in] xn       XML Parse-tree (to translate)
+ * @retval    0        OK
+ * @retval   -1        Error
  */
 static int
-cli2cbuf(clixon_handle h,
-         cbuf         *cb,
-         cxobj        *xn,
-         const char   *prepend)
+cli2emit(struct cli_emit *ce,
+         cxobj           *xn)
 {
-    int              retval = -1;
-    cxobj           *xe = NULL;
-    cbuf            *cbpre = NULL;
-    yang_stmt       *ys;
-    int              match;
-    char            *body;
-    int              compress = 0;
-    autocli_listkw_t listkw;
-    int              exist = 0;
-    char            *name;
-
-    if (autocli_list_keyword(h, &listkw) < 0)
-        goto done;
+    int               retval = -1;
+    cxobj            *xe = NULL;
+    cbuf             *cbpre = ce->ce_pre;
+    size_t            prelen;
+    yang_stmt        *ys;
+    int               match;
+    struct cli_ynode *cn;
+    enum rfc_6020     keyw;
+    char             *name;
+
     if (xml_type(xn)==CX_ATTR)
         goto ok;
     if ((ys = xml_spec(xn)) == NULL)
         goto ok;
-    if (yang_extension_value(ys, "hide-show", CLIXON_AUTOCLI_NS, &exist, NULL) < 0)
+    if (cli_ynode_get(ce, ys, &cn) < 0)
         goto done;
-    if (exist)
+    if (cn->cn_hide)
         goto ok;
-    exist = 0;
-    if (yang_extension_value(ys, "alias", CLIXON_AUTOCLI_NS, &exist, &name) < 0)
-        goto done;
-    if (!exist)
-        name = xml_name(xn);
+    keyw = yang_keyword_get(ys);
     /* If leaf/leaf-list or presence container, then print line */
-    if (yang_keyword_get(ys) == Y_LEAF ||
-        yang_keyword_get(ys) == Y_LEAF_LIST){
-        if (prepend)
-            cprintf(cb, "%s", prepend);
-        if (listkw != AUTOCLI_LISTKW_NONE)
-            cprintf(cb, "%s ", name);
-        if ((body = xml_body(xn)) != NULL){
-            if (index(body, ' '))
-                cprintf(cb, "\"%s\"", body);
-            else
-                cprintf(cb, "%s", body);
-        }
-        cprintf(cb, "\n");
+    if (keyw == Y_LEAF || keyw == Y_LEAF_LIST){
+        name = cn->cn_alias ? cn->cn_alias : xml_name(xn);
+        cli_emit_leaf(ce, name, xn);
         goto ok;
     }
-    /* Create prepend variable string */
-    if ((cbpre = cbuf_new()) == NULL){
-        clixon_err(OE_PLUGIN, errno, "cbuf_new");
-        goto done;
-    }
-    if (prepend)
-        cprintf(cbpre, "%s", prepend);
-
-    /* If non-presence container && HIDE mode && only child is
-     * a list, then skip container keyword
-     * See also yang2cli_container */
-    if (autocli_compress(h, ys, &compress) < 0)
-        goto done;
-    if (!compress)
+    /* If presence container, then print as leaf (but continue to children) */
+    if (keyw == Y_CONTAINER && yang_find(ys, Y_PRESENCE, NULL) != NULL)
+        cli_emit_leaf(ce, xml_name(xn), xn);
+    /* Extend prepend variable string, truncated when done */
+    prelen = cbuf_len(cbpre);
+    if (!cn->cn_compress)
         cprintf(cbpre, "%s ", xml_name(xn));
-
     /* If list then first loop through keys */
-    if (yang_keyword_get(ys) == Y_LIST){
+    if (keyw == Y_LIST){
         xe = NULL;
         while ((xe = xml_child_each(xn, xe, -1)) != NULL){
             if ((match = yang_key_match(ys, xml_name(xe), NULL)) < 0)
                 goto done;
             if (!match)
                 continue;
-            if (listkw == AUTOCLI_LISTKW_ALL)
+            if (ce->ce_listkw == AUTOCLI_LISTKW_ALL)
                 cprintf(cbpre, "%s ", xml_name(xe));
             cprintf(cbpre, "%s ", xml_body(xe));
         }
+        /* For lists, print cbpre before its elements */
+        cprintf(ce->ce_cb, "%s\n", cbuf_get(cbpre));
     }
-    else if ((yang_keyword_get(ys) == Y_CONTAINER) &&
-             yang_find(ys, Y_PRESENCE, NULL) != NULL){
-        /* If presence container, then print as leaf (but continue to children) */
-        if (prepend)
-            cprintf(cb, "%s", prepend);
-        if (listkw != AUTOCLI_LISTKW_NONE)
-            cprintf(cb, "%s ", xml_name(xn));
-        if ((body = xml_body(xn)) != NULL){
-            if (index(body, ' '))
-                cprintf(cb, "\"%s\"", body);
-            else
-                cprintf(cb, "%s", body);
-        }
-        cprintf(cb, "\n");
-    }
-
-    /* For lists, print cbpre before its elements */
-    if (yang_keyword_get(ys) == Y_LIST)
-        cprintf(cb, "%s\n", cbuf_get(cbpre));
     /* Then loop through all other (non-keys) */
     xe = NULL;
     while ((xe = xml_child_each(xn, xe, -1)) != NULL){
-        if (yang_keyword_get(ys) == Y_LIST){
+        if (keyw == Y_LIST){
             if ((match = yang_key_match(ys, xml_name(xe), NULL)) < 0)
                 goto done;
             if (match)
                 continue; /* Not key itself */
         }
-        if (cli2cbuf(h, cb, xe, cbuf_get(cbpre)) < 0)
+        if (cli2emit(ce, xe) < 0)
             goto done;
     }
+    cbuf_trunc(cbpre, prelen);
+    cli_emit_flush(ce, 0);
  ok:
     retval = 0;
  done:
-    if (cbpre)
-        cbuf_free(cbpre);
     return retval;
 }
 
-/*! Translate from XML to CLI commands, internal
+/*! Translate from XML to CLI commands to a buffer and optionally a file
  *
- * Howto: join strings and pass them down.
- * Identify unique/index keywords for correct set syntax.
  * @param[in] h        Clixon handle
- * @param[in] f        Output FILE (eg stdout)
+ * @param[in] cb       Output buffer
+ * @param[in] f        Output FILE to flush cb to, or NULL
+ * @param[in] fn       File print function, or NULL
  * @param[in] xn       XML Parse-tree (to translate)
  * @param[in] prepend  Print this text in front of all commands.
- * @param[in] fn       Callback to make print function
+ * @param[in] skiptop  0: Include top object 1: Skip top-object, only children,
  * @retval    0        OK
  * @retval   -1        Error
  */
 static int
-cli2file(clixon_handle     h,
-         FILE             *f,
-         cxobj            *xn,
-         const char       *prepend,
-         clicon_output_cb *fn)
+cli2emit_top(clixon_handle     h,
+             cbuf             *cb,
+             FILE             *f,
+             clicon_output_cb *fn,
+             cxobj            *xn,
+             const char       *prepend,
+             int               skiptop)
 {
     int              retval = -1;
-    cxobj           *xe = NULL;
-    cbuf            *cbpre = NULL;
-    yang_stmt       *ys;
-    int              match;
-    char            *body;
-    int              compress = 0;
-    autocli_listkw_t listkw;
-    int              exist = 0;
-    char            *name;
-
-    if (autocli_list_keyword(h, &listkw) < 0)
-        goto done;
-    if (xml_type(xn)==CX_ATTR)
-        goto ok;
-    if ((ys = xml_spec(xn)) == NULL)
-        goto ok;
-    if (yang_extension_value(ys, "hide-show", CLIXON_AUTOCLI_NS, &exist, NULL) < 0)
-        goto done;
-    if (exist)
-        goto ok;
-    exist = 0;
-    if (yang_extension_value(ys, "alias", CLIXON_AUTOCLI_NS, &exist, &name) < 0)
+    cxobj           *xc;
+    struct cli_emit  ce = {0,};
+    struct cli_ynode ycache[CLI_YCACHE_SIZE] = {{0,}};
+
+    if (xn == NULL){
+        clixon_err(OE_XML, EINVAL, "xn is NULL");
         goto done;
-    if (!exist)
-        name = xml_name(xn);
-    /* If leaf/leaf-list or presence container, then print line */
-    if (yang_keyword_get(ys) == Y_LEAF ||
-        yang_keyword_get(ys) == Y_LEAF_LIST){
-        if (prepend)
-            (*fn)(f, "%s", prepend);
-        if (listkw != AUTOCLI_LISTKW_NONE)
-            (*fn)(f, "%s ", name);
-        if ((body = xml_body(xn)) != NULL){
-            if (index(body, ' '))
-                (*fn)(f, "\"%s\"", body);
-            else
-                (*fn)(f, "%s", body);
-        }
-        (*fn)(f, "\n");
-        goto ok;
     }
-    /* Create prepend variable string */
-    if ((cbpre = cbuf_new()) == NULL){
+    ce.ce_h = h;
+    ce.ce_cb = cb;
+    ce.ce_f = f;
+    ce.ce_fn = fn;
+    ce.ce_ycache = ycache;
+    if (autocli_list_keyword(h, &ce.ce_listkw) < 0)
+        goto done;
+    if ((ce.ce_pre = cbuf_new()) == NULL){
         clixon_err(OE_PLUGIN, errno, "cbuf_new");
         goto done;
     }
     if (prepend)
-        cprintf(cbpre, "%s", prepend);
-
-    /* If non-presence container && HIDE mode && only child is
-     * a list, then skip container keyword
-     * See also yang2cli_container */
-    if (autocli_compress(h, ys, &compress) < 0)
-        goto done;
-    if (!compress)
-        cprintf(cbpre, "%s ", xml_name(xn));
-
-    /* If list then first loop through keys */
-    if (yang_keyword_get(ys) == Y_LIST){
-        xe = NULL;
-        while ((xe = xml_child_each(xn, xe, -1)) != NULL){
-            if ((match = yang_key_match(ys, xml_name(xe), NULL)) < 0)
+        cprintf(ce.ce_pre, "%s", prepend);
+    if (skiptop){
+        xc = NULL;
+        while ((xc = xml_child_each(xn, xc, CX_ELMNT)) != NULL)
+            if (cli2emit(&ce, xc) < 0)
                 goto done;
-            if (!match)
-                continue;
-            if (listkw == AUTOCLI_LISTKW_ALL)
-                cprintf(cbpre, "%s ", xml_name(xe));
-            cprintf(cbpre, "%s ", xml_body(xe));
-        }
-    }
-    else if ((yang_keyword_get(ys) == Y_CONTAINER) &&
-             yang_find(ys, Y_PRESENCE, NULL) != NULL){
-        /* If presence container, then print as leaf (but continue to children) */
-        if (prepend)
-            (*fn)(f, "%s", prepend);
-        if (listkw != AUTOCLI_LISTKW_NONE)
-            (*fn)(f, "%s ", xml_name(xn));
-        if ((body = xml_body(xn)) != NULL){
-            if (index(body, ' '))
-                (*fn)(f, "\"%s\"", body);
-            else
-                (*fn)(f, "%s", body);
-        }
-        (*fn)(f, "\n");
     }
-
-    /* For lists, print cbpre before its elements */
-    if (yang_keyword_get(ys) == Y_LIST)
-        (*fn)(f, "%s\n", cbuf_get(cbpre));
-    /* Then loop through all other (non-keys) */
-    xe = NULL;
-    while ((xe = xml_child_each(xn, xe, -1)) != NULL){
-        if (yang_keyword_get(ys) == Y_LIST){
-            if ((match = yang_key_match(ys, xml_name(xe), NULL)) < 0)
-                goto done;
-            if (match)
-                continue; /* Not key itself */
-        }
-        if (cli2file(h, f, xe, cbuf_get(cbpre), fn) < 0)
+    else {
+        if (cli2emit(&ce, xn) < 0)
             goto done;
     }
- ok:
+    cli_emit_flush(&ce, 1);
     retval = 0;
  done:
-    if (cbpre)
-        cbuf_free(cbpre);
+    if (ce.ce_pre)
+        cbuf_free(ce.ce_pre);
     return retval;
 }
 
@@ -902,6 +949,7 @@ cli2file(clixon_handle     h,
  *
  * Howto: join strings and pass them down.
  * Identify unique/index keywords for correct set syntax.
+ * Output is buffered and printed with fn in chunks
  * @param[in] h        Clixon handle
  * @param[in] f        Output FILE (eg stdout)
  * @param[in] xn       XML Parse-tree (to translate)
@@ -920,23 +968,19 @@ clixon_cli2file(clixon_handle     h,
                 clicon_output_cb *fn,
                 int               skiptop)
 {
-    int   retval = 1;
-    cxobj *xc;
+    int   retval = -1;
+    cbuf *cb = NULL;
 
-    if (fn == NULL)
-        fn = fprintf;
-    if (skiptop){
-        xc = NULL;
-        while ((xc = xml_child_each(xn, xc, CX_ELMNT)) != NULL)
-            if (cli2file(h, f, xc, prepend, fn) < 0)
-                goto done;
-    }
-    else {
-        if (cli2file(h, f, xn, prepend, fn) < 0)
-            goto done;
+    if ((cb = cbuf_new()) == NULL){
+        clixon_err(OE_PLUGIN, errno, "cbuf_new");
+        goto done;
     }
+    if (cli2emit_top(h, cb, f, fn ? fn : fprintf, xn, prepend, skiptop) < 0)
+        goto done;
     retval = 0;
  done:
+    if (cb)
+        cbuf_free(cb);
     return retval;
 }
 
@@ -945,10 +989,9 @@ clixon_cli2file(clixon_handle     h,
  * Howto: join strings and pass them down.
  * Identify unique/index keywords for correct set syntax.
  * @param[in] h        Clixon handle
- * @param[in] f        Output FILE (eg stdout)
+ * @param[in] cb       Cligen buffer to write to
  * @param[in] xn       XML Parse-tree (to translate)
  * @param[in] prepend  Print this text in front of all commands.
- * @param[in] fn       File print function (if NULL, use fprintf)
  * @param[in] skiptop  0: Include top object 1: Skip top-object, only children,
  * @retval    0        OK
  * @retval   -1        Error
@@ -961,20 +1004,5 @@ clixon_cli2cbuf(clixon_handle h,
                 const char   *prepend,
                 int           skiptop)
 {
-    int   retval = 1;
-    cxobj *xc;
-
-    if (skiptop){
-        xc = NULL;
-        while ((xc = xml_child_each(xn, xc, CX_ELMNT)) != NULL)
-            if (cli2cbuf(h, cb, xc, prepend) < 0)
-                goto done;
-    }
-    else {
-        if (cli2cbuf(h, cb, xn, prepend) < 0)
-            goto done;
-    }
-    retval = 0;
- done:
-    return retval;
+    return cli2emit_top(h, cb, NULL, NULL, xn, prepend, skiptop);
 }
@@ -111,6 +111,7 @@ You can see which CLISPEC it generates via clixon_cli -D 2:
 #include "clixon_yang_module.h"
 #include "clixon_yang_schema_mount.h"
 #include "clixon_netconf_lib.h"
+#include "clixon_proto.h"
 #include "clixon_proto_client.h"
 //#include "clixon_plugin.h"
 #include "clixon_options.h"
@@ -1232,6 +1233,136 @@ yang2cli_leaf(clixon_handle h,
     return retval;
 }
 
+/*! Check if yang statement is a top-level node, ie directly under module or submodule
+ *
+ * @param[in]  ys    Yang statement
+ * @retval     1     Top-level
+ * @retval     0     Not top-level
+ */
+static int
+yang2cli_toplevel_p(yang_stmt *ys)
+{
+    yang_stmt *yp;
+
+    if ((yp = yang_parent_get(ys)) == NULL)
+        return 0;
+    return yang_keyword_get(yp) == Y_MODULE || yang_keyword_get(yp) == Y_SUBMODULE;
+}
+
+/*! Generate treeref to the children of a top-level container or list
+ *
+ * The referenced tree is generated when first resolved
+ * @param[in]  ys    Top-level yang container or list
+ * @param[in]  level Indentation level
+ * @param[out] cb    Buffer where cligen code is written
+ * @retval     0     OK
+ * @retval    -1     Error
+ * @see yang2cli_toplevel  Generates the referenced tree
+ */
+static int
+yang2cli_toplevel_treeref(yang_stmt *ys,
+                          int        level,
+                          cbuf      *cb)
+{
+    int        retval = -1;
+    yang_stmt *ymod;
+    yang_stmt *yrev;
+    cbuf      *cbtree = NULL;
+
+    if ((cbtree = cbuf_new()) == NULL){
+        clixon_err(OE_XML, errno, "cbuf_new");
+        goto done;
+    }
+    ymod = yang_parent_get(ys); /* module or submodule where ys is found */
+    yrev = yang_find(ymod, Y_REVISION, NULL);
+    if (yang2cli_treeref_encode(cbtree, AUTOCLI_CMD_DELIM,
+                                yang_argument_get(ys_domain(ys)),
+                                yang_argument_get(ys_spec(ys)),
+                                yang_argument_get(ymod),
+                                yrev?yang_argument_get(yrev):NULL,
+                                yang_key2str(yang_keyword_get(ys)),
+                                yang_argument_get(ys)) < 0)
+        goto done;
+    cprintf(cb, "%*s@%s;\n", level*3, "", cbuf_get(cbtree));
+    retval = 0;
+ done:
+    if (cbtree)
+        cbuf_free(cbtree);
+    return retval;
+}
+
+/*! Generate CLI code for the children of a Yang container statement
+ *
+ * @param[in]  h     Clixon handle
+ * @param[in]  ys    Yang container statement
+ * @param[in]  level Indentation level of children
+ * @param[out] cb    Buffer where cligen code is written
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+static int
+yang2cli_container_children(clixon_handle h,
+                            yang_stmt    *ys,
+                            int           level,
+                            cbuf         *cb)
+{
+    int        retval = -1;
+    yang_stmt *yc;
+    int        inext;
+
+    inext = 0;
+    while ((yc = yn_iter(ys, &inext)) != NULL)
+        if (yang2cli_stmt(h, yc, level, cb) < 0)
+            goto done;
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Generate CLI code for the non-key children of a Yang list statement
+ *
+ * @param[in]  h     Clixon handle
+ * @param[in]  ys    Yang list statement
+ * @param[in]  level Indentation level of children
+ * @param[out] cb    Buffer where cligen code is written
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+static int
+yang2cli_list_children(clixon_handle h,
+                       yang_stmt    *ys,
+                       int           level,
+                       cbuf         *cb)
+{
+    int        retval = -1;
+    yang_stmt *yc;
+    cvec      *cvk;
+    cg_var    *cvi;
+    char      *keyname;
+    int        inext;
+
+    cvk = yang_cvec_get(ys); /* Use Y_LIST cache, see ys_populate_list() */
+    inext = 0;
+    while ((yc = yn_iter(ys, &inext)) != NULL) {
+        /*  cvk is a cvec of strings containing variable names
+            yc is a leaf that may match one of the values of cvk.
+        */
+        cvi = NULL;
+        while ((cvi = cvec_each(cvk, cvi)) != NULL) {
+            keyname = cv_string_get(cvi);
+            if (strcmp(keyname, yang_argument_get(yc)) == 0)
+                break;
+        }
+        if (cvi != NULL)
+            continue;
+        if (yang2cli_stmt(h, yc, level, cb) < 0)
+            goto done;
+    }
+    retval = 0;
+ done:
+    return retval;
+}
+
 /*! Generate CLI code for Yang container statement
  *
  * @param[in]  h     Clixon handle
@@ -1248,14 +1379,13 @@ yang2cli_container(clixon_handle h,
                    cbuf         *cb)
 {
     int           retval = -1;
-    yang_stmt    *yc;
     yang_stmt    *yd;
     char         *helptext = NULL;
     char         *s;
     int           compress = 0;
+    int           treeref = 0;
     yang_stmt    *ymod = NULL;
     int           extvalue = 0;
-    int           inext;
     int           ret;
 
     if (ys_real_module(ys, &ymod) < 0)
@@ -1296,10 +1426,16 @@ yang2cli_container(clixon_handle h,
             cprintf(cb, "%*s%s", (level+1)*3, "", "@mountpoint;\n");
         }
     }
-    inext = 0;
-    while ((yc = yn_iter(ys, &inext)) != NULL)
-        if (yang2cli_stmt(h, yc, level+1, cb) < 0)
+    if (!compress && yang2cli_toplevel_p(ys)){
+        if (autocli_toplevel_treeref(h, &treeref) < 0)
+            goto done;
+    }
+    if (treeref){
+        if (yang2cli_toplevel_treeref(ys, level+1, cb) < 0)
             goto done;
+    }
+    else if (yang2cli_container_children(h, ys, level+1, cb) < 0)
+        goto done;
     if (!compress)
         cprintf(cb, "%*s}\n", level*3, "");
     retval = 0;
@@ -1325,7 +1461,6 @@ yang2cli_list(clixon_handle h,
               cbuf         *cb)
 {
     int           retval = -1;
-    yang_stmt    *yc;
     yang_stmt    *yd;
     yang_stmt    *yleaf;
     cg_var       *cvi;
@@ -1336,7 +1471,7 @@ yang2cli_list(clixon_handle h,
     int           last_key = 0;
     int           exist = 0;
     int           keynr = 0;
-    int           inext;
+    int           treeref = 0;
 
     cprintf(cb, "%*s%s", level*3, "", yang_argument_get(ys));
     if ((yd = yang_find(ys, Y_DESCRIPTION, NULL)) != NULL){
@@ -1387,22 +1522,16 @@ yang2cli_list(clixon_handle h,
         keynr++;
     }
     cprintf(cb, "{\n");
-    inext = 0;
-    while ((yc = yn_iter(ys, &inext)) != NULL) {
-        /*  cvk is a cvec of strings containing variable names
-            yc is a leaf that may match one of the values of cvk.
-        */
-        cvi = NULL;
-        while ((cvi = cvec_each(cvk, cvi)) != NULL) {
-            keyname = cv_string_get(cvi);
-            if (strcmp(keyname, yang_argument_get(yc)) == 0)
-                break;
-        }
-        if (cvi != NULL)
-            continue;
-        if (yang2cli_stmt(h, yc, level+1, cb) < 0)
+    if (yang2cli_toplevel_p(ys)){
+        if (autocli_toplevel_treeref(h, &treeref) < 0)
             goto done;
     }
+    if (treeref){
+        if (yang2cli_toplevel_treeref(ys, level+1, cb) < 0)
+            goto done;
+    }
+    else if (yang2cli_list_children(h, ys, level+1, cb) < 0)
+        goto done;
     cprintf(cb, "%*s}\n", level*3, "");
     /* Close with } for each key */
     while (keynr--)
@@ -1589,6 +1718,45 @@ yang2cli_grouping(clixon_handle h,
     goto done;
 }
 
+/*! Generate clispec for the children of a top-level container or list
+ *
+ * Called when resolving a treeref of a top-level node, see autocli_toplevel_treeref
+ * @param[in]  h         Clixon handle
+ * @param[in]  ys        Top-level yang container or list
+ * @param[out] cb        Buffer where cligen code is written
+ * @retval     1         OK
+ * @retval     0         OK but not a container or list, no tree produced
+ * @retval    -1         Error
+ * @see yang2cli_grouping
+ */
+int
+yang2cli_toplevel(clixon_handle h,
+                  yang_stmt    *ys,
+                  cbuf         *cb)
+{
+    int retval = -1;
+
+    switch (yang_keyword_get(ys)){
+    case Y_CONTAINER:
+        if (yang2cli_container_children(h, ys, 1, cb) < 0)
+            goto done;
+        break;
+    case Y_LIST:
+        if (yang2cli_list_children(h, ys, 1, cb) < 0)
+            goto done;
+        break;
+    default:
+        goto empty;
+        break;
+    }
+    retval = 1;
+ done:
+    return retval;
+ empty:
+    retval = 0;
+    goto done;
+}
+
 /*! Generate CLI code for Yang statement
  *
  * @param[in]  h     Clixon handle
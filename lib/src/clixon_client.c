@@ -801,6 +801,87 @@ clixon_client_get_uint64(clixon_client_handle  ch,
     return retval;
 }
 
+/*! Client-api get values of several xpaths in one request
+ *
+ * The xpaths are combined into one union xpath and sent as a single get-config, instead
+ * of one round-trip per value as with clixon_client_get_uint32 and others.
+ * @param[in]  ch        Clixon client handle
+ * @param[in]  namespace Default namespace used for non-prefixed entries in xpaths.
+ * @param[in]  xpaths    Vector of XPaths
+ * @param[in]  n         Length of xpaths and vals
+ * @param[out] vals      Vector of values, or NULL if not found. Free each with free
+ * @retval     0         OK
+ * @retval    -1         Error
+ * @code
+ *   const char *xpaths[] = {"/c/a", "/c/b"};
+ *   char       *vals[2];
+ *   if (clixon_client_get_batch(ch, "urn:example:clixon", xpaths, 2, vals) < 0)
+ *      err;
+ * @endcode
+ */
+int
+clixon_client_get_batch(clixon_client_handle ch,
+                        const char          *namespace,
+                        const char         **xpaths,
+                        int                  n,
+                        char               **vals)
+{
+    int                          retval = -1;
+    struct clixon_client_handle *cch = chandle(ch);
+    cbuf                        *cb = NULL;
+    cxobj                       *xdata = NULL;
+    cxobj                       *x;
+    cxobj                       *xobj;
+    cvec                        *nsc = NULL;
+    char                        *val;
+    int                          i;
+
+    clixon_debug(CLIXON_DBG_DEFAULT, "");
+    for (i=0; i<n; i++)
+        vals[i] = NULL;
+    if (n == 0)
+        goto ok;
+    if ((cb = cbuf_new()) == NULL){
+        clixon_err(OE_PLUGIN, errno, "cbuf_new");
+        goto done;
+    }
+    for (i=0; i<n; i++)
+        cprintf(cb, "%s%s", i?" | ":"", xpaths[i]);
+    if (clixon_client_get_xdata(cch->cch_h, cch->cch_socket, cch->cch_descr,
+                                namespace, cbuf_get(cb), &xdata) < 0)
+        goto done;
+    if ((nsc = xml_nsctx_init(NULL, namespace)) == NULL)
+        goto done;
+    for (i=0; i<n; i++){
+        if ((x = xpath_first(xdata, nsc, "%s", xpaths[i])) == NULL)
+            continue;
+        if (clixon_xml_bottom(x, &xobj) < 0)
+            goto done;
+        if ((val = xml_body(xobj)) != NULL &&
+            (vals[i] = strdup(val)) == NULL){
+            clixon_err(OE_UNIX, errno, "strdup");
+            goto done;
+        }
+    }
+ ok:
+    retval = 0;
+ done:
+    clixon_debug(CLIXON_DBG_DEFAULT, "retval:%d", retval);
+    if (retval < 0)
+        for (i=0; i<n; i++)
+            if (vals[i]){
+                free(vals[i]);
+                vals[i] = NULL;
+            }
+    if (nsc)
+        cvec_free(nsc);
+    if (xdata)
+        xml_free(xdata);
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+}
+
 /* Access functions */
 /*! Client-api get uint64
  *
@@ -64,6 +64,7 @@
 
 /* clixon */
 #include "clixon_queue.h"
+#include "clixon_map.h"
 #include "clixon_hash.h"
 #include "clixon_handle.h"
 #include "clixon_yang.h"
@@ -74,6 +75,7 @@
 #include "clixon_uid.h"
 #include "clixon_string.h"
 #include "clixon_file.h"
+#include "clixon_event.h"
 #include "clixon_yang_module.h"
 #include "clixon_plugin.h"
 #include "clixon_options.h"
@@ -82,6 +84,10 @@
 #include "clixon_xml_bind.h"
 #include "clixon_xml_default.h"
 #include "clixon_xml_io.h"
+#include "clixon_xml_map.h"
+#include "clixon_xml_sort.h"
+#include "clixon_xpath_ctx.h"
+#include "clixon_xpath.h"
 #include "clixon_json.h"
 #include "clixon_datastore.h"
 #include "clixon_datastore_write.h"
@@ -105,8 +111,390 @@ struct db_elmnt {
     int            de_candidate; /* Is shared/private candidate */
     int            de_volatile; /* Disable auto-sync of cache to disk on every update (ie xmldb_put)
                                  * Objects are marked with XML_FLAG_CACHE_DIRTY that are not written */
+    uint64_t       de_gen;      /* Generation, set when the cache may have changed */
+    struct timeval de_gen_tv;   /* Time when generation was set */
+    uint64_t       de_base_gen; /* Generation of source when copied, 0 if changed since */
+    uint32_t       de_journal_nr; /* Records in journal since last full write, see CLICON_XMLDB_JOURNAL */
+    int            de_persist;  /* Cache not yet written to file, see CLICON_XMLDB_DURABILITY
+                                 * 1: pending, 2: being written by writer process */
+    db_elmnt      *de_cow;      /* If set, share XML cache of this datastore, de_xml is NULL */
+    db_elmnt      *de_cow_deps; /* List of datastores sharing XML cache of this datastore */
+    db_elmnt      *de_cow_next; /* Next in list of datastores sharing same XML cache */
+#ifdef XMLDB_EDIT_LOG
+    cxobj         *de_editlog;  /* Subtrees edited since equal to running, or NULL if unknown */
+    uint32_t       de_editlog_nr; /* Number of nodes in edit log */
+    uint64_t       de_editlog_gen; /* Generation of datastore after last logged edit */
+    uint64_t       de_editlog_rgen; /* Generation of running when datastore was equal to it */
+#endif
 };
 
+/* Last generation of any datastore, see xmldb_generation_get */
+static uint64_t _xmldb_generation = 0;
+
+/* Datastore persistence, see CLICON_XMLDB_DURABILITY */
+#define XMLDB_PERSIST_PENDING  1 /* Cache is not written to file */
+#define XMLDB_PERSIST_WRITING  2 /* Cache is being written by writer process */
+
+/* Writer process of asynchronous datastore persistence, or 0 */
+static pid_t _xmldb_writer_pid = 0;
+
+/* Read end of pipe from writer process, closed when writer exits */
+static int _xmldb_writer_fd = -1;
+
+/* Set if group-commit timeout is registered */
+static int _xmldb_persist_timer = 0;
+
+/*! Set new generation of datastore since its XML cache may change
+ *
+ * @param[in]  de    XMLDB element
+ */
+static void
+xmldb_gen_bump(db_elmnt *de)
+{
+    de->de_gen = ++_xmldb_generation;
+    gettimeofday(&de->de_gen_tv, NULL);
+}
+
+/*! Stop sharing XML cache without copying it
+ *
+ * @param[in]  de    XMLDB element sharing cache with another
+ */
+static void
+xmldb_cow_unlink(db_elmnt *de)
+{
+    db_elmnt **dp;
+
+    if (de->de_cow == NULL)
+        return;
+    for (dp = &de->de_cow->de_cow_deps; *dp != NULL; dp = &(*dp)->de_cow_next)
+        if (*dp == de){
+            *dp = de->de_cow_next;
+            break;
+        }
+    de->de_cow = NULL;
+    de->de_cow_next = NULL;
+}
+
+/*! Make a private copy of a shared XML cache
+ *
+ * @param[in]  de    XMLDB element sharing cache with another
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+static int
+xmldb_cow_break(db_elmnt *de)
+{
+    int    retval = -1;
+    cxobj *x = NULL;
+
+    if (de->de_cow == NULL)
+        goto ok;
+    clixon_debug(CLIXON_DBG_DATASTORE | CLIXON_DBG_DETAIL, "copy %s cache to %s",
+                 de->de_cow->de_name, de->de_name);
+    if (de->de_cow->de_xml != NULL &&
+        (x = xml_dup(de->de_cow->de_xml)) == NULL)
+        goto done;
+    xmldb_cow_unlink(de);
+    de->de_xml = x;
+    xmldb_gen_bump(de);
+ ok:
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Make private copies for all datastores sharing the XML cache of this datastore
+ *
+ * @param[in]  de    XMLDB element whose cache is about to change
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+static int
+xmldb_cow_break_deps(db_elmnt *de)
+{
+    while (de->de_cow_deps != NULL)
+        if (xmldb_cow_break(de->de_cow_deps) < 0)
+            return -1;
+    return 0;
+}
+
+#ifdef XMLDB_EDIT_LOG
+/*! Free edit log of datastore, changes are not known after this
+ *
+ * @param[in]  de    XMLDB element
+ */
+static void
+xmldb_editlog_free(db_elmnt *de)
+{
+    if (de->de_editlog){
+        xml_free(de->de_editlog);
+        de->de_editlog = NULL;
+    }
+    de->de_editlog_nr = 0;
+}
+
+/*! Get generation of running, or 0 if no running
+ */
+static uint64_t
+xmldb_editlog_rgen(clixon_handle h)
+{
+    db_elmnt *de;
+
+    if ((de = xmldb_find(h, "running")) == NULL)
+        return 0;
+    return xmldb_generation_get(de);
+}
+
+/*! Start new empty edit log of candidate datastore that is equal to running
+ *
+ * No edit log is started unless CLICON_XMLDB_EDIT_LOG is set
+ * @param[in]  h     Clixon handle
+ * @param[in]  de    XMLDB element
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+static int
+xmldb_editlog_reset(clixon_handle h,
+                    db_elmnt     *de)
+{
+    xmldb_editlog_free(de);
+    if (!xmldb_candidate_get(de) ||
+        !clicon_option_bool(h, "CLICON_XMLDB_EDIT_LOG"))
+        return 0;
+    if ((de->de_editlog = xml_new(NETCONF_INPUT_CONFIG, NULL, CX_ELMNT)) == NULL)
+        return -1;
+    de->de_editlog_gen = xmldb_generation_get(de);
+    de->de_editlog_rgen = xmldb_editlog_rgen(h);
+    return 0;
+}
+
+/*! Check if edit log of datastore covers all changes relative to running
+ *
+ * Any other change of the datastore or of running sets a new generation
+ * @param[in]  h     Clixon handle
+ * @param[in]  de    XMLDB element
+ * @retval     1     Valid
+ * @retval     0     Not valid or no edit log
+ */
+int
+xmldb_editlog_valid(clixon_handle h,
+                    db_elmnt     *de)
+{
+    return de->de_editlog != NULL &&
+        de->de_editlog_gen == xmldb_generation_get(de) &&
+        de->de_editlog_rgen == xmldb_editlog_rgen(h);
+}
+
+/*! Check if the parent of an edit node must be compared as a whole
+ *
+ * This is the case if the edit node is a leaf or leaf-list, since eg defaults of siblings
+ * may change, or if other choice cases or ordered-by user siblings may be affected.
+ * @param[in]  x1c   Node of edit request
+ * @retval     1     Compare parent as a whole
+ * @retval     0     No
+ */
+static int
+xmldb_editlog_parent_whole(cxobj *x1c)
+{
+    yang_stmt *yc;
+    yang_stmt *yp;
+
+    if ((yc = xml_spec(x1c)) == NULL)
+        return 1;
+    yp = yang_parent_get(yc);
+    switch (yang_keyword_get(yc)){
+    case Y_LEAF:
+        if (yp && yang_keyword_get(yp) == Y_LIST &&
+            yang_key_match(yp, xml_name(x1c), NULL) == 1)
+            return 0;
+        return 1;
+    case Y_LEAF_LIST:
+    case Y_ANYDATA:
+    case Y_ANYXML:
+        return 1;
+    default:
+        break;
+    }
+    if (yp && (yang_keyword_get(yp) == Y_CASE || yang_keyword_get(yp) == Y_CHOICE))
+        return 1;
+    if (yang_find(yc, Y_ORDERED_BY, "user") != NULL)
+        return 1;
+    return 0;
+}
+
+/*! Count nodes of edit log subtree, not including keys
+ *
+ * @param[in]  xs    Edit log node
+ * @retval     nr    Number of nodes
+ */
+static uint32_t
+xmldb_editlog_count(cxobj *xs)
+{
+    cxobj   *xsc = NULL;
+    uint32_t nr = 1;
+
+    while ((xsc = xml_child_each(xs, xsc, CX_ELMNT)) != NULL)
+        if (yang_keyword_get(xml_spec(xsc)) != Y_LEAF)
+            nr += xmldb_editlog_count(xsc);
+    return nr;
+}
+
+/*! Merge structure of edit request into edit log, internal recursive function
+ *
+ * The edit log is a skeleton of containers and list entries (with keys) of all edits.
+ * Edited subtrees that are compared as a whole are marked with XML_FLAG_CHANGE.
+ * @param[in]  xs    Edit log node
+ * @param[in]  x1    Edit request node, yang bound
+ * @param[in,out] nr Number of nodes in edit log
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+static int
+xmldb_editlog_merge(cxobj    *xs,
+                    cxobj    *x1,
+                    uint32_t *nr)
+{
+    int        retval = -1;
+    cxobj     *x1c;
+    cxobj     *xsc;
+    cxobj     *xk;
+    yang_stmt *yc;
+    int        sub;
+    int        i;
+
+    if (xml_flag(xs, XML_FLAG_CHANGE))
+        goto ok;
+    /* First check if this node must be compared as a whole */
+    x1c = NULL;
+    sub = 0;
+    while ((x1c = xml_child_each(x1, x1c, CX_ELMNT)) != NULL){
+        if (xmldb_editlog_parent_whole(x1c))
+            goto whole;
+        yc = xml_spec(x1c);
+        if (yang_keyword_get(yc) != Y_LEAF) /* not key */
+            sub++;
+    }
+    if (sub == 0 || xml_find_type(x1, NULL, "operation", CX_ATTR) != NULL)
+        goto whole;
+    x1c = NULL;
+    while ((x1c = xml_child_each(x1, x1c, CX_ELMNT)) != NULL){
+        yc = xml_spec(x1c);
+        if (yang_keyword_get(yc) == Y_LEAF) /* key */
+            continue;
+        if (match_base_child(xs, x1c, yc, &xsc) < 0)
+            goto done;
+        if (xsc == NULL){
+            if ((xsc = xml_new(xml_name(x1c), xs, CX_ELMNT)) == NULL)
+                goto done;
+            xml_spec_set(xsc, yc);
+            (*nr)++;
+            if (yang_keyword_get(yc) == Y_LIST){
+                /* Copy keys for matching */
+                xk = NULL;
+                while ((xk = xml_child_each(x1c, xk, CX_ELMNT)) != NULL){
+                    if (yang_keyword_get(xml_spec(xk)) != Y_LEAF)
+                        continue;
+                    if (xml_addsub(xsc, xml_dup(xk)) < 0)
+                        goto done;
+                }
+            }
+            if (xml_sort(xs) < 0)
+                goto done;
+        }
+        if (xmldb_editlog_merge(xsc, x1c, nr) < 0)
+            goto done;
+    }
+ ok:
+    retval = 0;
+ done:
+    return retval;
+ whole:
+    /* Children except keys are covered by comparing this node */
+    for (i=xml_child_nr_type(xs, CX_ELMNT)-1; i>=0; i--){
+        xsc = xml_child_i_type(xs, i, CX_ELMNT);
+        if (yang_keyword_get(xml_spec(xsc)) == Y_LEAF)
+            continue;
+        *nr -= xmldb_editlog_count(xsc);
+        if (xml_purge(xsc) < 0)
+            goto done;
+    }
+    xml_flag_set(xs, XML_FLAG_CHANGE);
+    goto ok;
+}
+
+/*! Add edit request to edit log of candidate datastore before the edit is made
+ *
+ * The edit request must be yang bound and not yet applied, since operation attributes
+ * are stripped when applied.
+ * @param[in]  h     Clixon handle
+ * @param[in]  de    XMLDB element
+ * @param[in]  valid Edit log was valid before the edit, see xmldb_editlog_valid
+ * @param[in]  x1    Edit request, top-level is NETCONF_INPUT_CONFIG
+ * @retval     0     OK
+ * @retval    -1     Error
+ * @see xmldb_editlog_done  to call after the edit
+ */
+int
+xmldb_editlog_add(clixon_handle h,
+                  db_elmnt     *de,
+                  int           valid,
+                  cxobj        *x1)
+{
+    if (!valid || x1 == NULL || de->de_editlog == NULL){
+        xmldb_editlog_free(de);
+        return 0;
+    }
+    if (xmldb_editlog_merge(de->de_editlog, x1, &de->de_editlog_nr) < 0)
+        return -1;
+    if (de->de_editlog_nr > XMLDB_EDIT_LOG)
+        xmldb_editlog_free(de);
+    return 0;
+}
+
+/*! Edit of candidate datastore is done
+ *
+ * @param[in]  de    XMLDB element
+ * @param[in]  ok    Edit was made, otherwise the datastore may be partially edited
+ * @see xmldb_editlog_add
+ */
+void
+xmldb_editlog_done(db_elmnt *de,
+                   int       ok)
+{
+    if (!ok)
+        xmldb_editlog_free(de);
+    else if (de->de_editlog)
+        de->de_editlog_gen = xmldb_generation_get(de);
+}
+
+/*! Get edit log of candidate datastore if it covers all changes relative to running
+ *
+ * Must be called before the datastore cache is accessed for writing, which sets a new
+ * generation.
+ * @param[in]  h     Clixon handle
+ * @param[in]  db    Name of datastore
+ * @param[out] xlp   Copy of edit log, or NULL if not valid. Free with xml_free
+ * @retval     0     OK
+ * @retval    -1     Error
+ * @see xml_diff_select  Compute differences of edited subtrees only
+ */
+int
+xmldb_editlog_get(clixon_handle h,
+                  const char   *db,
+                  cxobj       **xlp)
+{
+    db_elmnt *de;
+
+    *xlp = NULL;
+    if ((de = xmldb_find(h, db)) == NULL ||
+        !xmldb_editlog_valid(h, de))
+        return 0;
+    if ((*xlp = xml_dup(de->de_editlog)) == NULL)
+        return -1;
+    return 0;
+}
+#endif /* XMLDB_EDIT_LOG */
+
 /*-------------- Access functions ----------------*/
 /*! Get datastore name
  *
@@ -151,9 +539,95 @@ xmldb_id_set(db_elmnt *de,
 cxobj *
 xmldb_cache_get(db_elmnt *de)
 {
+    /* Caller may modify the cache, stop sharing it */
+    if (xmldb_cow_break(de) < 0)
+        return NULL;
+    if (xmldb_cow_break_deps(de) < 0)
+        return NULL;
+    xmldb_gen_bump(de);
+    de->de_base_gen = 0;
+    return de->de_xml;
+}
+
+/*! Get datastore XML cache for reading only
+ *
+ * @param[in]  de    XMLDB element
+ * @retval     xml   XML cached tree or NULL, do not modify
+ * @see xmldb_cache_get  If the cache may be modified
+ * @see CLICON_XMLDB_CANDIDATE_COW  where the cache may be shared with another datastore
+ */
+cxobj *
+xmldb_cache_read(db_elmnt *de)
+{
+    if (de->de_cow)
+        return de->de_cow->de_xml;
     return de->de_xml;
 }
 
+/*! Get if datastore shares XML cache with another datastore
+ *
+ * @param[in]  de    XMLDB element
+ * @retval     1     Shares cache, see CLICON_XMLDB_CANDIDATE_COW
+ * @retval     0     Own cache or no cache
+ */
+int
+xmldb_cache_shared(db_elmnt *de)
+{
+    return de->de_cow != NULL;
+}
+
+/*! Get generation of datastore XML cache
+ *
+ * The generation is a global counter set when the cache may have changed, ie when it is
+ * set, cleared, copied or accessed with xmldb_cache_get. If equal, the cache is unchanged.
+ * Clients get it in the clixon-lib stats and change-feed RPCs.
+ * @param[in]  de    XMLDB element
+ * @retval     gen   Generation, larger than that of any earlier change of any datastore
+ */
+uint64_t
+xmldb_generation_get(db_elmnt *de)
+{
+    if (de->de_cow && de->de_cow->de_gen > de->de_gen)
+        return de->de_cow->de_gen;
+    return de->de_gen;
+}
+
+/*! Get time of last generation of datastore XML cache
+ *
+ * Ie when the cache may last have changed, eg as Last-Modified in RESTCONF
+ * @param[in]  de    XMLDB element
+ * @param[out] tv    Time when generation was set, zero if never
+ * @retval     0     OK
+ * @see xmldb_generation_get
+ */
+int
+xmldb_generation_time(db_elmnt       *de,
+                      struct timeval *tv)
+{
+    if (de->de_cow && de->de_cow->de_gen > de->de_gen){
+        *tv = de->de_cow->de_gen_tv;
+        return 0;
+    }
+    *tv = de->de_gen_tv;
+    return 0;
+}
+
+/*! Get generation of the datastore a copy was made from
+ *
+ * Set by xmldb_copy to the generation of the source datastore, reset when the cache
+ * may have changed otherwise. If the source generation is still the same, the
+ * datastores are equal.
+ * @param[in]  de    XMLDB element
+ * @retval     gen   Generation of source when copied
+ * @retval     0     Not a copy, or changed since copied
+ * @see xmldb_generation_get
+ */
+uint64_t
+xmldb_generation_base(db_elmnt *de)
+{
+    return de->de_base_gen;
+}
+
 /*! Set datastore XML cache
  *
  * @param[in]  de    XMLDB element
@@ -164,7 +638,41 @@ xmldb_cache_set(db_elmnt *de,
                 cxobj    *xml)
 
 {
+    xmldb_cow_unlink(de);
+    if (xml != de->de_xml && xmldb_cow_break_deps(de) < 0)
+        return -1;
     de->de_xml = xml;
+    xmldb_gen_bump(de);
+    de->de_base_gen = 0;
+    return 0;
+}
+
+/*! Detach datastore XML cache, the caller takes over the tree
+ *
+ * The datastore is left without cache and is read from file on next access.
+ * Pending writes are written first. Not detached if the datastore is not backed by
+ * a file, ie candidate or volatile, or if it shares the cache of another datastore.
+ * @param[in]  h     Clixon handle
+ * @param[in]  de    XMLDB element
+ * @param[out] xtp   XML tree, free with xml_free, or NULL if not detached
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+int
+xmldb_cache_detach(clixon_handle h,
+                   db_elmnt     *de,
+                   cxobj       **xtp)
+{
+    *xtp = NULL;
+    if (de->de_xml == NULL || de->de_candidate || de->de_volatile)
+        return 0;
+    if (de->de_persist && xmldb_persist_sync(h) < 0)
+        return -1;
+    if (xmldb_cow_break_deps(de) < 0)
+        return -1;
+    *xtp = de->de_xml;
+    de->de_xml = NULL;
+    xmldb_gen_bump(de);
     return 0;
 }
 
@@ -285,6 +793,32 @@ xmldb_volatile_set(db_elmnt *de,
     return 0;
 }
 
+/*! Get number of records in datastore journal since last full write
+ *
+ * @param[in]  de    XMLDB element
+ * @retval     nr    Number of journal records
+ * @see CLICON_XMLDB_JOURNAL
+ */
+uint32_t
+xmldb_journal_nr_get(db_elmnt *de)
+{
+    return de->de_journal_nr;
+}
+
+/*! Set number of records in datastore journal since last full write
+ *
+ * @param[in]  de    XMLDB element
+ * @param[in]  nr    Number of journal records
+ * @retval     0     OK
+ */
+int
+xmldb_journal_nr_set(db_elmnt *de,
+                     uint32_t  nr)
+{
+    de->de_journal_nr = nr;
+    return 0;
+}
+
 /*! Create new xmldb object
  *
  * @param[in]  h   Clixon handle
@@ -310,6 +844,7 @@ xmldb_new(clixon_handle h,
         de = NULL;
         goto done;
     }
+    xmldb_gen_bump(de);
     clicon_hash_add(clicon_db_elmnt(h), de->de_name, &de, sizeof(de));
  done:
     return de;
@@ -327,10 +862,17 @@ xmldb_free(db_elmnt *de)
         free(de->de_name);
         de->de_name = NULL;
     }
+    /* Datastores are freed in any order, sharing datastores lose the cache */
+    xmldb_cow_unlink(de);
+    while (de->de_cow_deps)
+        xmldb_cow_unlink(de->de_cow_deps);
     if (de->de_xml){
         xml_free(de->de_xml);
         de->de_xml = NULL;
     }
+#ifdef XMLDB_EDIT_LOG
+    xmldb_editlog_free(de);
+#endif
     free(de);
     return 0;
 }
@@ -377,6 +919,7 @@ xmldb_db2file1(clixon_handle h,
     int   retval = -1;
     cbuf *cb = NULL;
     char *dir;
+    char *formatstr;
 
     if ((cb = cbuf_new()) == NULL){
         clixon_err(OE_XML, errno, "cbuf_new");
@@ -386,11 +929,14 @@ xmldb_db2file1(clixon_handle h,
         clixon_err(OE_XML, errno, "CLICON_XMLDB_DIR not set");
         goto done;
     }
-    /* Multi: write (root) to: <db>.d/0.xml
+    /* Multi: write (root) to: <db>.d/0.xml or <db>.d/0.json
      * Classic: write to: <db>_db
      */
-    if (multi)
-        cprintf(cb, "%s/%s.d/0.xml", dir, db); /* Hardcoded to XML, XXX: JSON? */
+    if (multi){
+        formatstr = clicon_option_str_id(h, CO_XMLDB_FORMAT);
+        cprintf(cb, "%s/%s.d/0.%s", dir, db,
+                (formatstr && strcmp(formatstr, "json") == 0) ? "json" : "xml");
+    }
     else
         cprintf(cb, "%s/%s_db", dir, db);
     if ((*filename = strdup4(cbuf_get(cb))) == NULL){
@@ -421,7 +967,7 @@ xmldb_db2file(clixon_handle  h,
               const char    *db,
               char         **filename)
 {
-    return xmldb_db2file1(h, db, clicon_option_bool(h, "CLICON_XMLDB_MULTI"), filename);
+    return xmldb_db2file1(h, db, clicon_option_bool_id(h, CO_XMLDB_MULTI), filename);
 }
 
 /*! Translate from symbolic database name to sub-directory of configure sub-files, no checks
@@ -468,6 +1014,392 @@ xmldb_db2subdir(clixon_handle h,
     return retval;
 }
 
+/*! Translate from symbolic database name to journal filename in file-system
+ *
+ * The journal is placed next to the datastore file: <db>_db.journal
+ * @param[in]   h        Clixon handle
+ * @param[in]   db       Symbolic database name, eg "candidate", "running"
+ * @param[out]  filename Filename. Unallocate after use with free()
+ * @retval      0        OK
+ * @retval     -1        Error
+ * @see CLICON_XMLDB_JOURNAL
+ */
+int
+xmldb_db2journal(clixon_handle h,
+                 const char   *db,
+                 char        **filename)
+{
+    int   retval = -1;
+    cbuf *cb = NULL;
+    char *dir;
+
+    if ((cb = cbuf_new()) == NULL){
+        clixon_err(OE_XML, errno, "cbuf_new");
+        goto done;
+    }
+    if ((dir = clicon_xmldb_dir(h)) == NULL){
+        clixon_err(OE_XML, errno, "CLICON_XMLDB_DIR not set");
+        goto done;
+    }
+    cprintf(cb, "%s/%s_db.journal", dir, db);
+    if ((*filename = strdup4(cbuf_get(cb))) == NULL){
+        clixon_err(OE_UNIX, errno, "strdup");
+        goto done;
+    }
+    retval = 0;
+ done:
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+}
+
+/*! Remove datastore journal, typically after the datastore file has been fully written
+ *
+ * @param[in]  h   Clixon handle
+ * @param[in]  db  Database
+ * @retval     0   OK
+ * @retval    -1   Error
+ * @see CLICON_XMLDB_JOURNAL
+ */
+int
+xmldb_journal_reset(clixon_handle h,
+                    const char   *db)
+{
+    int       retval = -1;
+    char     *filename = NULL;
+    db_elmnt *de;
+
+    if ((de = xmldb_find(h, db)) != NULL)
+        de->de_journal_nr = 0;
+    if (xmldb_db2journal(h, db, &filename) < 0)
+        goto done;
+    if (unlink(filename) < 0 && errno != ENOENT){
+        clixon_err(OE_DB, errno, "unlink %s", filename);
+        goto done;
+    }
+    retval = 0;
+ done:
+    if (filename)
+        free(filename);
+    return retval;
+}
+
+/*! Get durability mode of datastore writes
+ *
+ * @param[in]  h   Clixon handle
+ * @retval     0   sync: write to file before returning
+ * @retval     1   group: write pending datastores every CLICON_XMLDB_DURABILITY_INTERVAL ms
+ * @retval     2   async: write pending datastores as soon as possible
+ * @see CLICON_XMLDB_DURABILITY
+ */
+static int
+xmldb_durability(clixon_handle h)
+{
+    char *str;
+
+    if ((str = clicon_option_str(h, "CLICON_XMLDB_DURABILITY")) == NULL)
+        return 0;
+    if (strcmp(str, "group") == 0)
+        return 1;
+    if (strcmp(str, "async") == 0)
+        return 2;
+    return 0;
+}
+
+/*! Apply function on all datastores with given persist state
+ *
+ * @param[in]  h      Clixon handle
+ * @param[in]  state  Persist state of datastore, or -1 for any non-zero state
+ * @param[in]  fn     Function called for each datastore, non-zero return stops
+ * @param[in]  arg    Argument to fn
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+static int
+xmldb_persist_each(clixon_handle h,
+                   int           state,
+                   int         (*fn)(clixon_handle, db_elmnt *, void *),
+                   void         *arg)
+{
+    int            retval = -1;
+    char         **keys = NULL;
+    size_t         klen;
+    int            i;
+    db_elmnt      *de;
+    clicon_hash_t *cdat = clicon_db_elmnt(h);
+
+    if (clicon_hash_keys(cdat, &keys, &klen) < 0)
+        goto done;
+    for (i = 0; i < klen; i++){
+        if ((de = xmldb_find(h, keys[i])) == NULL || de->de_persist == 0)
+            continue;
+        if (state != -1 && de->de_persist != state)
+            continue;
+        if ((*fn)(h, de, arg) < 0)
+            goto done;
+    }
+    retval = 0;
+ done:
+    if (keys)
+        free(keys);
+    return retval;
+}
+
+/*! Write datastore cache to file, datastore persist callback
+ */
+static int
+xmldb_persist_write_fn(clixon_handle h,
+                       db_elmnt     *de,
+                       void         *arg)
+{
+    if (xmldb_cache_read(de) != NULL &&
+        xmldb_write_cache2file(h, de->de_name) < 0)
+        return -1;
+    de->de_persist = 0;
+    return 0;
+}
+
+/*! Set datastore persist state, datastore persist callback
+ *
+ * Dirty flags in the cache are cleared when handed over to the writer process and
+ * restored if it fails, since sub-files in CLICON_XMLDB_MULTI are only written if dirty
+ */
+static int
+xmldb_persist_state_fn(clixon_handle h,
+                       db_elmnt     *de,
+                       void         *arg)
+{
+    int    state = (intptr_t)arg;
+    cxobj *xt;
+
+    if ((xt = xmldb_cache_read(de)) != NULL){
+        if (state == XMLDB_PERSIST_WRITING){
+            if (xml_apply(xt, CX_ELMNT, (xml_applyfn_t*)xml_flag_reset, (void*)XML_FLAG_CACHE_DIRTY) < 0)
+                return -1;
+        }
+        else if (state == XMLDB_PERSIST_PENDING){
+            if (xml_apply0(xt, CX_ELMNT, (xml_applyfn_t*)xml_flag_set, (void*)XML_FLAG_CACHE_DIRTY) < 0)
+                return -1;
+        }
+    }
+    de->de_persist = state;
+    return 0;
+}
+
+/*! Count pending datastores, datastore persist callback
+ */
+static int
+xmldb_persist_count_fn(clixon_handle h,
+                       db_elmnt     *de,
+                       void         *arg)
+{
+    (*(int*)arg)++;
+    return 0;
+}
+
+static int xmldb_persist_flush(clixon_handle h);
+static int xmldb_persist_reap_cb(int fd, void *arg);
+
+/*! Group-commit timeout: write pending datastores
+ */
+static int
+xmldb_persist_timeout(int   fd,
+                      void *arg)
+{
+    _xmldb_persist_timer = 0;
+    return xmldb_persist_flush((clixon_handle)arg);
+}
+
+/*! Schedule writing of pending datastores according to durability mode
+ *
+ * @param[in]  h   Clixon handle
+ * @retval     0   OK
+ * @retval    -1   Error
+ */
+static int
+xmldb_persist_schedule(clixon_handle h)
+{
+    struct timeval t;
+    struct timeval t1;
+    uint32_t       ms;
+
+    if (xmldb_durability(h) == 2)
+        return xmldb_persist_flush(h);
+    if (_xmldb_persist_timer)
+        return 0;
+    ms = clicon_option_int(h, "CLICON_XMLDB_DURABILITY_INTERVAL");
+    gettimeofday(&t, NULL);
+    t1.tv_sec = ms/1000;
+    t1.tv_usec = (ms%1000)*1000;
+    timeradd(&t, &t1, &t);
+    if (clixon_event_reg_timeout(t, xmldb_persist_timeout, h, "datastore group-commit") < 0)
+        return -1;
+    _xmldb_persist_timer = 1;
+    return 0;
+}
+
+/*! Wait for writer process and update datastore persist state
+ *
+ * @param[in]  h   Clixon handle
+ * @retval     0   OK
+ * @retval    -1   Error
+ */
+static int
+xmldb_persist_reap(clixon_handle h)
+{
+    int  status = 0;
+    char c = 1;
+    int  ok;
+
+    if (_xmldb_writer_fd != -1){
+        clixon_event_unreg_fd(_xmldb_writer_fd, xmldb_persist_reap_cb);
+        while (read(_xmldb_writer_fd, &c, 1) < 0 && errno == EINTR)
+            ;
+        close(_xmldb_writer_fd);
+        _xmldb_writer_fd = -1;
+    }
+    while (waitpid(_xmldb_writer_pid, &status, 0) < 0 && errno == EINTR)
+        ;
+    _xmldb_writer_pid = 0;
+    ok = c == 0 && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    if (!ok)
+        clixon_log(h, LOG_WARNING, "Datastore writer process failed, datastores will be written again");
+    return xmldb_persist_each(h, XMLDB_PERSIST_WRITING, xmldb_persist_state_fn,
+                              (void*)(intptr_t)(ok ? 0 : XMLDB_PERSIST_PENDING));
+}
+
+/*! Writer process has exited, reap it and write any datastores pending since it started
+ */
+static int
+xmldb_persist_reap_cb(int   fd,
+                      void *arg)
+{
+    clixon_handle h = (clixon_handle)arg;
+    int           n = 0;
+
+    if (xmldb_persist_reap(h) < 0)
+        return -1;
+    if (xmldb_persist_each(h, XMLDB_PERSIST_PENDING, xmldb_persist_count_fn, &n) < 0)
+        return -1;
+    if (n)
+        return xmldb_persist_schedule(h);
+    return 0;
+}
+
+/*! Write pending datastores in a writer process
+ *
+ * The writer process serializes a copy-on-write snapshot of the datastore caches while
+ * the parent continues. Only one writer process runs at a time, datastores that become
+ * pending meanwhile are written when it exits.
+ * @param[in]  h   Clixon handle
+ * @retval     0   OK
+ * @retval    -1   Error
+ */
+static int
+xmldb_persist_flush(clixon_handle h)
+{
+    int   retval = -1;
+    int   fd[2] = {-1, -1};
+    int   n = 0;
+    pid_t pid;
+    char  c;
+
+    if (_xmldb_writer_pid != 0) /* Rescheduled when writer exits */
+        goto ok;
+    if (xmldb_persist_each(h, XMLDB_PERSIST_PENDING, xmldb_persist_count_fn, &n) < 0)
+        goto done;
+    if (n == 0)
+        goto ok;
+    if (pipe(fd) < 0 || (pid = fork()) < 0){
+        clixon_log(h, LOG_WARNING, "Datastore writer process: %s, writing synchronously", strerror(errno));
+        if (fd[0] != -1){
+            close(fd[0]);
+            close(fd[1]);
+        }
+        if (xmldb_persist_each(h, XMLDB_PERSIST_PENDING, xmldb_persist_write_fn, NULL) < 0)
+            goto done;
+        goto ok;
+    }
+    if (pid == 0){ /* Writer process */
+        close(fd[0]);
+        c = xmldb_persist_each(h, XMLDB_PERSIST_PENDING, xmldb_persist_write_fn, NULL) < 0;
+        if (write(fd[1], &c, 1) < 0)
+            c = 1;
+        _exit(c); /* Dont exit() here, parent state must not be flushed */
+    }
+    close(fd[1]);
+    _xmldb_writer_pid = pid;
+    _xmldb_writer_fd = fd[0];
+    if (xmldb_persist_each(h, XMLDB_PERSIST_PENDING, xmldb_persist_state_fn,
+                           (void*)XMLDB_PERSIST_WRITING) < 0)
+        goto done;
+    if (clixon_event_reg_fd(fd[0], xmldb_persist_reap_cb, h, "datastore writer") < 0)
+        goto done;
+ ok:
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Are datastore writes deferred to a writer process?
+ *
+ * @param[in]  h   Clixon handle
+ * @retval     1   Deferred, CLICON_XMLDB_DURABILITY is group or async
+ * @retval     0   Written synchronously
+ */
+int
+xmldb_persist_deferred(clixon_handle h)
+{
+    return xmldb_durability(h) != 0;
+}
+
+/*! Write datastore cache to file according to durability mode
+ *
+ * In sync mode the cache is written before return. Otherwise the datastore is marked
+ * as pending and written later by a writer process, see CLICON_XMLDB_DURABILITY
+ * @param[in]  h   Clixon handle
+ * @param[in]  db  Datastore
+ * @retval     0   OK
+ * @retval    -1   Error
+ * @see xmldb_persist_sync  Write all pending datastores
+ */
+int
+xmldb_persist(clixon_handle h,
+              const char   *db)
+{
+    db_elmnt *de;
+
+    if (xmldb_durability(h) == 0 ||
+        (de = xmldb_find(h, db)) == NULL)
+        return xmldb_write_cache2file(h, db);
+    if (de->de_persist != XMLDB_PERSIST_WRITING)
+        de->de_persist = XMLDB_PERSIST_PENDING;
+    else if (xmldb_persist_state_fn(h, de, (void*)XMLDB_PERSIST_PENDING) < 0)
+        return -1; /* Modified while written: write all again */
+    return xmldb_persist_schedule(h);
+}
+
+/*! Write all pending datastores to file synchronously
+ *
+ * Wait for writer process, if any, and write remaining pending datastores.
+ * Used before datastore files are accessed directly, and on exit.
+ * @param[in]  h   Clixon handle
+ * @retval     0   OK
+ * @retval    -1   Error
+ * @see CLICON_XMLDB_DURABILITY
+ */
+int
+xmldb_persist_sync(clixon_handle h)
+{
+    if (_xmldb_persist_timer){
+        clixon_event_unreg_timeout(xmldb_persist_timeout, h);
+        _xmldb_persist_timer = 0;
+    }
+    if (_xmldb_writer_pid != 0 && xmldb_persist_reap(h) < 0)
+        return -1;
+    return xmldb_persist_each(h, XMLDB_PERSIST_PENDING, xmldb_persist_write_fn, NULL);
+}
+
 /*! Connect to a datastore plugin, allocate resources to be used in API calls
  *
  * @param[in]  h    Clixon handle
@@ -496,11 +1428,14 @@ xmldb_disconnect(clixon_handle h)
     db_elmnt      *de;
     clicon_hash_t *cdat = clicon_db_elmnt(h);
 
+    if (xmldb_persist_sync(h) < 0)
+        goto done;
     if (clicon_hash_keys(cdat, &keys, &klen) < 0)
         goto done;
     for (i = 0; i < klen; i++)
         if ((de = xmldb_find(h, keys[i])) != NULL)
             xmldb_free(de);
+    xmldb_system_only_reset(h);
     retval = 0;
  done:
     if (keys)
@@ -571,13 +1506,20 @@ xmldb_copy_file(clixon_handle h,
                 const char   *from,
                 const char   *to)
 {
-    int   retval = -1;
-    char *fromfile = NULL;
-    char *tofile = NULL;
-    char *fromdir = NULL;
-    char *todir = NULL;
-
-    if (clicon_option_bool(h, "CLICON_XMLDB_MULTI")){
+    int       retval = -1;
+    char     *fromfile = NULL;
+    char     *tofile = NULL;
+    char     *fromdir = NULL;
+    char     *todir = NULL;
+    char     *fromjournal = NULL;
+    char     *tojournal = NULL;
+    db_elmnt *de1;
+    db_elmnt *de2;
+
+    /* Files must be up-to-date, see CLICON_XMLDB_DURABILITY */
+    if (xmldb_persist_sync(h) < 0)
+        goto done;
+    if (clicon_option_bool_id(h, CO_XMLDB_MULTI)){
         if (check_create_multidir(h, to) < 0)
             goto done;
     }
@@ -590,12 +1532,27 @@ xmldb_copy_file(clixon_handle h,
         goto done;
     if (clicon_file_copy(fromfile, tofile) < 0)
         goto done;
-    if (clicon_option_bool(h, "CLICON_XMLDB_MULTI")) {
+    /* The journal of source is part of its content, see CLICON_XMLDB_JOURNAL */
+    if (xmldb_db2journal(h, from, &fromjournal) < 0)
+        goto done;
+    if (access(fromjournal, F_OK) == 0){
+        if (xmldb_db2journal(h, to, &tojournal) < 0)
+            goto done;
+        if (clicon_file_copy(fromjournal, tojournal) < 0)
+            goto done;
+        if ((de1 = xmldb_find(h, from)) != NULL &&
+            (de2 = xmldb_find(h, to)) != NULL)
+            de2->de_journal_nr = de1->de_journal_nr;
+    }
+    else if (xmldb_journal_reset(h, to) < 0)
+        goto done;
+    if (clicon_option_bool_id(h, CO_XMLDB_MULTI)) {
         if (xmldb_db2subdir(h, from, &fromdir) < 0)
             goto done;
         if (xmldb_db2subdir(h, to, &todir) < 0)
             goto done;
-        if (clicon_dir_copy(fromdir, todir) < 0)
+        /* Only rewrite changed sub-files */
+        if (clicon_dir_sync(fromdir, todir) < 0)
             goto done;
     }
     retval = 0;
@@ -608,6 +1565,10 @@ xmldb_copy_file(clixon_handle h,
         free(fromdir);
     if (todir)
         free(todir);
+    if (fromjournal)
+        free(fromjournal);
+    if (tojournal)
+        free(tojournal);
     return retval;
 }
 
@@ -621,14 +1582,54 @@ xmldb_copy_de(clixon_handle h,
     cxobj *x2 = NULL;  /* to */
     char  *from;
     char  *to;
+    cbuf  *cbj = NULL;
+    int    journal = 0;
     int    ret;
+    db_elmnt *src;
 
     /* Copy in-memory cache */
     /* 1. "to" xml tree in x1 */
     from = xmldb_name_get(de1);
     to = xmldb_name_get(de2);
-    x1 = xmldb_cache_get(de1);
+    /* Append difference to journal of destination instead of copying file */
+    if (!de2->de_volatile && !de1->de_volatile && de1 != de2 &&
+        xmldb_journal_enabled(h) &&
+        (x2 = xmldb_cache_read(de2)) != NULL &&
+        (x1 = xmldb_cache_read(de1)) != NULL &&
+        x1 != x2){
+        if ((ret = xmldb_journal_diff(h, x2, x1, &cbj)) < 0)
+            goto done;
+        journal = ret;
+    }
+    x1 = x2 = NULL;
+    /* Candidate shares cache with source instead of copying it */
+    if (clicon_option_bool(h, "CLICON_XMLDB_CANDIDATE_COW") &&
+        xmldb_candidate_get(de2) && de2->de_cow_deps == NULL && de1 != de2){
+        if (xmldb_cache_read(de1) == NULL){
+            if ((ret = xmldb_get_cache(h, from, &x1, NULL)) < 0)
+                goto done;
+            if (ret == 0){
+                clixon_err(OE_XML, 0, "Error when reading cache");
+                goto done;
+            }
+        }
+        src = de1->de_cow ? de1->de_cow : de1;
+        if (de2->de_cow != src){
+            xmldb_cow_unlink(de2);
+            if (de2->de_xml){
+                xml_free(de2->de_xml);
+                de2->de_xml = NULL;
+            }
+            de2->de_cow = src;
+            de2->de_cow_next = src->de_cow_deps;
+            src->de_cow_deps = de2;
+            xmldb_gen_bump(de2);
+        }
+        goto file;
+    }
+    /* Get "to" first: it may be shared by "from" and must then be copied */
     x2 = xmldb_cache_get(de2);
+    x1 = xmldb_cache_read(de1);
     if (x1 == NULL && x2 == NULL){
         if ((ret = xmldb_get_cache(h, from, &x1, NULL)) < 0)
             goto done;
@@ -669,22 +1670,49 @@ xmldb_copy_de(clixon_handle h,
             goto done;
     }
     de2->de_xml = x2;
+    xmldb_gen_bump(de2);
+ file:
     /* If destination is not volatile, then copy file, or dump from cache if
      * src is volatile
      */
     if (!de2->de_volatile){
-        if (de1->de_volatile){
+        if (journal){
+            if (cbj && xmldb_journal_append(h, to, cbj) < 0)
+                goto done;
+        }
+        else if (de1->de_volatile || xmldb_durability(h) != 0){
+            /* Dump from cache, in the writer process unless sync durability */
             if (xmldb_populate(h, to) < 0)
                 goto done;
-            if (xmldb_write_cache2file(h, to) < 0)
+            /* Existing sub-files of destination are not in sync with copied tree */
+            if (clicon_option_bool_id(h, CO_XMLDB_MULTI) && de2->de_xml &&
+                xml_apply0(de2->de_xml, CX_ELMNT, (xml_applyfn_t*)xml_flag_set, (void*)XML_FLAG_CACHE_DIRTY) < 0)
+                goto done;
+            if (xmldb_persist(h, to) < 0)
                 goto done;
         }
         else if (xmldb_copy_file(h, from, to) < 0)
             goto done;
     }
+#ifdef XMLDB_EDIT_LOG
+    /* Destination is now equal to source */
+    if (strcmp(from, "running") == 0){
+        if (xmldb_editlog_reset(h, de2) < 0)
+            goto done;
+    }
+    else if (strcmp(to, "running") == 0){
+        if (xmldb_editlog_reset(h, de1) < 0)
+            goto done;
+    }
+    else
+        xmldb_editlog_free(de2);
+#endif
+    de2->de_base_gen = xmldb_generation_get(de1);
     retval = 0;
  done:
     clixon_debug(CLIXON_DBG_DATASTORE | CLIXON_DBG_DETAIL, "retval:%d", retval);
+    if (cbj)
+        cbuf_free(cbj);
     return retval;
 }
 
@@ -884,10 +1912,17 @@ xmldb_clear(clixon_handle h,
     db_elmnt *de = NULL;
 
     if ((de = xmldb_find(h, db)) != NULL){
+        /* Write pending cache before it is cleared */
+        if (de->de_persist && xmldb_persist_sync(h) < 0)
+            return -1;
+        xmldb_cow_unlink(de);
+        if (xmldb_cow_break_deps(de) < 0)
+            return -1;
         if ((xt = de->de_xml) != NULL){
             xml_free(xt);
             de->de_xml = NULL;
         }
+        xmldb_gen_bump(de);
         de->de_modified = 0;
         de->de_id = 0;
         memset(&de->de_tv, 0, sizeof(struct timeval));
@@ -921,9 +1956,14 @@ xmldb_delete(clixon_handle h,
     int            del = 0;
 
     clixon_debug(CLIXON_DBG_DATASTORE | CLIXON_DBG_DETAIL, "%s", db);
+    /* Pending cache is not written, but the writer process must not recreate files */
+    if ((de = xmldb_find(h, db)) != NULL)
+        de->de_persist = 0;
+    if (xmldb_persist_sync(h) < 0)
+        goto done;
     if (xmldb_clear(h, db) < 0)
         goto done;
-    if (clicon_option_bool(h, "CLICON_XMLDB_MULTI")){
+    if (clicon_option_bool_id(h, CO_XMLDB_MULTI)){
         if (xmldb_db2subdir(h, db, &subdir) < 0)
             goto done;
         if (stat(subdir, &st) == 0){
@@ -937,7 +1977,7 @@ xmldb_delete(clixon_handle h,
         }
     }
     else {
-        if (clicon_option_bool(h, "CLICON_XMLDB_PRIVATE_CANDIDATE")) {
+        if (clicon_option_bool_id(h, CO_XMLDB_PRIVATE_CANDIDATE)) {
             if ((de = xmldb_find(h, db)) != NULL)
                 del = xmldb_candidate_get(de);
         }
@@ -959,6 +1999,8 @@ xmldb_delete(clixon_handle h,
                 }
             }
         }
+        if (xmldb_journal_reset(h, db) < 0)
+            goto done;
     }
     retval = 0;
  done:
@@ -998,6 +2040,8 @@ xmldb_delete_candidates(clixon_handle h)
         clixon_err(OE_FATAL, 0, "CLICON_XMLDB_DIR not set");
         goto done;
     }
+    if (xmldb_persist_sync(h) < 0)
+        goto done;
     /* shared is candidate_db; privcand is candidate.56_db and candidate-orig.56_db */
     if (clixon_dir_remove_files(dir, NULL, "^candidate") < 0)
         goto done;
@@ -1009,7 +2053,7 @@ xmldb_delete_candidates(clixon_handle h)
     if ((ndp = clicon_file_dirent(dir, &dp, "^candidate", S_IFDIR)) < 0)
         goto done;
     for (i = 0; i < ndp; i++) {
-        if (clixon_dir_remove_files(dir, dp[i].d_name, "\\.xml") < 0)
+        if (clixon_dir_remove_files(dir, dp[i].d_name, "\\.(xml|json)$") < 0)
             goto done;
         cbuf_reset(cb);
         cprintf(cb, "%s/%s", dir, dp[i].d_name);
@@ -1049,12 +2093,16 @@ xmldb_create(clixon_handle h,
 
     clixon_debug(CLIXON_DBG_DATASTORE | CLIXON_DBG_DETAIL, "%s", db);
     if ((de = xmldb_find(h, db)) != NULL){
+        xmldb_cow_unlink(de);
+        if (xmldb_cow_break_deps(de) < 0)
+            goto done;
         if ((xt = de->de_xml) != NULL){
             xml_free(xt);
             de->de_xml = NULL;
         }
+        xmldb_gen_bump(de);
     }
-    if (clicon_option_bool(h, "CLICON_XMLDB_MULTI")){
+    if (clicon_option_bool_id(h, CO_XMLDB_MULTI)){
         if (check_create_multidir(h, db) < 0)
             goto done;
     }
@@ -1116,6 +2164,8 @@ xmldb_print(clixon_handle h,
         fprintf(f, "Datastore:  %s\n", keys[i]);
         fprintf(f, "  Session:  %u\n", de->de_id);
         fprintf(f, "  XML:      %p\n", de->de_xml);
+        if (de->de_cow)
+            fprintf(f, "  Shared:   %s\n", de->de_cow->de_name);
         fprintf(f, "  Modified: %d\n", de->de_modified);
         fprintf(f, "  Empty:    %d\n", de->de_empty);
     }
@@ -1145,6 +2195,7 @@ xmldb_rename(clixon_handle h,
     int    retval = -1;
     char  *old;
     char  *fname = NULL;
+    char  *journal = NULL;
     cbuf  *cb = NULL;
 
     if ((xmldb_db2file(h, db, &old)) < 0)
@@ -1159,16 +2210,30 @@ xmldb_rename(clixon_handle h,
     if (suffix)
         cprintf(cb, "%s", suffix);
     fname = cbuf_get(cb);
+    if (xmldb_persist_sync(h) < 0)
+        goto done;
     if ((rename(old, fname)) < 0) {
         clixon_err(OE_UNIX, errno, "rename: %s", strerror(errno));
         goto done;
     };
+    /* Rename journal along with datastore file, see CLICON_XMLDB_JOURNAL */
+    if (xmldb_db2journal(h, db, &journal) < 0)
+        goto done;
+    if (access(journal, F_OK) == 0){
+        cprintf(cb, ".journal");
+        if ((rename(journal, cbuf_get(cb))) < 0) {
+            clixon_err(OE_UNIX, errno, "rename: %s", strerror(errno));
+            goto done;
+        }
+    }
     retval = 0;
  done:
     if (cb)
         cbuf_free(cb);
     if (old)
         free(old);
+    if (journal)
+        free(journal);
     return retval;
 }
 
@@ -1215,9 +2280,9 @@ xmldb_populate(clixon_handle h,
 /*! Upgrade datastore from original non-multi to multi/split mode
  *
  * This is for upgrading the datastores on startup using CLICON_XMLDB_MULTI
- * (1) If <db>.d/0.xml does not exist AND
+ * (1) If <db>.d/0.xml (or 0.json) does not exist AND
  * (2) <db>_db does exist and is a regular file
- * (3) THEN copy file from <db>_db to <db>.d/0.xml
+ * (3) THEN copy file from <db>_db to <db>.d/0.xml (or 0.json)
  * @param[in]  h   Clixon handle
  * @param[in]  db  Datastore
  */
@@ -1283,8 +2348,84 @@ xmldb_drop_priv(clixon_handle h,
     return retval;
 }
 
+/*! Merge the subtrees of the system-only overlay selected by xpath
+ *
+ * @param[in]     h       Clixon handle
+ * @param[in]     yspec   Top-level yang spec
+ * @param[in]     xo      System-only overlay
+ * @param[in]     xpath   XPath selection
+ * @param[in]     nsc     XML Namespace context for xpath
+ * @param[in,out] xret    Existing XML tree, merge selected subtrees into this
+ * @retval        1       OK
+ * @retval        0       Merge failed (error in xret)
+ * @retval       -1       Error (fatal)
+ */
+static int
+xmldb_system_only_merge(clixon_handle h,
+                        yang_stmt    *yspec,
+                        cxobj        *xo,
+                        const char   *xpath,
+                        cvec         *nsc,
+                        cxobj       **xret)
+{
+    int     retval = -1;
+    cxobj **xvec = NULL;
+    size_t  xlen;
+    cxobj  *x1t = NULL;
+    size_t  i;
+    int     ret;
+
+    if (xml_child_nr_type(xo, CX_ELMNT) == 0)
+        goto ok;
+    if (xpath_vec(xo, nsc, "%s", &xvec, &xlen, xpath?xpath:"/") < 0)
+        goto done;
+    if (xlen == 0)
+        goto ok;
+    if ((x1t = xml_new(xml_name(xo), NULL, CX_ELMNT)) == NULL)
+        goto done;
+    xml_flag_set(x1t, XML_FLAG_TOP);
+    xml_spec_set(x1t, xml_spec(xo));
+    for (i=0; i<xlen; i++){
+        if (xvec[i] == xo)
+            break;
+        xml_flag_set(xvec[i], XML_FLAG_MARK);
+        xml_apply_ancestor(xvec[i], (xml_applyfn_t*)xml_flag_set, (void*)XML_FLAG_CHANGE);
+    }
+    if (i < xlen){ /* Top selected */
+        if (xml_flag_reset_tree(xo, XML_FLAG_MARK|XML_FLAG_CHANGE) < 0)
+            goto done;
+        if (xml_copy(xo, x1t) < 0)
+            goto done;
+    }
+    else {
+        if (xml_copy_marked(xo, x1t) < 0)
+            goto done;
+        if (xml_flag_reset_tree(xo, XML_FLAG_MARK|XML_FLAG_CHANGE) < 0)
+            goto done;
+        if (xml_flag_reset_tree(x1t, XML_FLAG_MARK|XML_FLAG_CHANGE) < 0)
+            goto done;
+    }
+    if ((ret = netconf_trymerge(x1t, yspec, xret)) < 0)
+        goto done;
+    if (ret == 0)
+        goto fail;
+ ok:
+    retval = 1;
+ done:
+    if (xvec)
+        free(xvec);
+    if (x1t)
+        xml_free(x1t);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
 /*! Get system-only config data by calling user callback
  *
+ * If CLICON_XMLDB_SYSTEM_ONLY_CACHE is set, the callbacks are called once and the result
+ * is kept as an overlay, of which only the subtrees selected by xpath are merged.
  * @param[in]     h       Clixon handle
  * @param[in]     xpath   XPath selection, may be used to filter early
  * @param[in]     nsc     XML Namespace context for xpath
@@ -1292,6 +2433,7 @@ xmldb_drop_priv(clixon_handle h,
  * @retval        1       OK
  * @retval        0       Statedata callback failed (error in xret)
  * @retval       -1       Error (fatal)
+ * @see xmldb_system_only_reset
  */
 int
 xmldb_system_only_config(clixon_handle h,
@@ -1301,6 +2443,7 @@ xmldb_system_only_config(clixon_handle h,
 {
     int        retval = -1;
     yang_stmt *yspec;
+    cxobj     *xo = NULL;
     int        ret;
 
     clixon_debug(CLIXON_DBG_BACKEND, "");
@@ -1308,10 +2451,32 @@ xmldb_system_only_config(clixon_handle h,
         clixon_err(OE_YANG, ENOENT, "No yang spec");
         goto done;
     }
-    if ((ret = clixon_plugin_system_only_all(h, yspec, nsc, (char*)xpath, xret)) < 0)
+    if (!clicon_option_bool(h, "CLICON_XMLDB_SYSTEM_ONLY_CACHE")){
+        if ((ret = clixon_plugin_system_only_all(h, yspec, nsc, (char*)xpath, xret)) < 0)
+            goto done;
+        if (ret == 0)
+            goto fail;
+        goto ok;
+    }
+    if (clicon_ptr_get(h, "system-only-overlay", (void**)&xo) < 0 || xo == NULL){
+        if ((xo = xml_new(DATASTORE_TOP_SYMBOL, NULL, CX_ELMNT)) == NULL)
+            goto done;
+        xml_flag_set(xo, XML_FLAG_TOP);
+        if ((ret = clixon_plugin_system_only_all(h, yspec, NULL, "/", &xo)) < 0)
+            goto done;
+        if (ret == 0){ /* xo is rpc-error */
+            xml_free(*xret);
+            *xret = xo;
+            xo = NULL;
+            goto fail;
+        }
+        clicon_ptr_set(h, "system-only-overlay", xo);
+    }
+    if ((ret = xmldb_system_only_merge(h, yspec, xo, xpath, nsc, xret)) < 0)
         goto done;
     if (ret == 0)
         goto fail;
+ ok:
     retval = 1; /* OK */
  done:
     return retval;
@@ -1320,6 +2485,25 @@ xmldb_system_only_config(clixon_handle h,
     goto done;
 }
 
+/*! Clear the system-only overlay, it is re-read on next access
+ *
+ * Call after commit, or if system-only config changes outside of commits
+ * @param[in]  h   Clixon handle
+ * @retval     0   OK
+ * @see CLICON_XMLDB_SYSTEM_ONLY_CACHE
+ */
+int
+xmldb_system_only_reset(clixon_handle h)
+{
+    cxobj *xo = NULL;
+
+    if (clicon_ptr_get(h, "system-only-overlay", (void**)&xo) == 0 && xo != NULL){
+        xml_free(xo);
+        clicon_ptr_del(h, "system-only-overlay");
+    }
+    return 0;
+}
+
 /*! Get candidate datastore, if privcand return private, otherwise shared
  *
  * @param[in]  h     Clixon handle
@@ -1342,7 +2526,7 @@ xmldb_candidate_find(clixon_handle h,
     db_elmnt *de = NULL;
     int       privcand;
 
-    privcand = clicon_option_bool(h, "CLICON_XMLDB_PRIVATE_CANDIDATE");
+    privcand = clicon_option_bool_id(h, CO_XMLDB_PRIVATE_CANDIDATE);
     if ((cb = cbuf_new()) == NULL){
         clixon_err(OE_XML, errno, "cbuf_new");
         goto done;
@@ -1374,7 +2558,7 @@ xmldb_post_commit(clixon_handle h,
     char *db0 = NULL;
     char *db1 = NULL;
 
-    if (clicon_option_bool(h, "CLICON_XMLDB_PRIVATE_CANDIDATE")){
+    if (clicon_option_bool_id(h, CO_XMLDB_PRIVATE_CANDIDATE)){
         if (xmldb_candidate_find(h, "candidate", ceid, NULL, &db0) < 0)
             goto done;
         /* Remove candidate and candidate-orig*/
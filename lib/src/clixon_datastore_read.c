@@ -49,8 +49,12 @@
 #include <assert.h>
 #include <syslog.h>
 #include <fcntl.h>
+#include <signal.h>
+#include <poll.h>
 #include <sys/types.h>
 #include <sys/param.h>
+#include <sys/time.h>
+#include <sys/wait.h>
 
 /* cligen */
 #include <cligen/cligen.h>
@@ -65,6 +69,7 @@
 #include "clixon_err.h"
 #include "clixon_log.h"
 #include "clixon_debug.h"
+#include "clixon_trace.h"
 #include "clixon_file.h"
 #include "clixon_xml_sort.h"
 #include "clixon_xml_bind.h"
@@ -73,9 +78,10 @@
 #include "clixon_xpath_ctx.h"
 #include "clixon_xpath.h"
 #include "clixon_json.h"
+#include "clixon_netconf_lib.h"
 #include "clixon_nacm.h"
 #include "clixon_path.h"
-#include "clixon_netconf_lib.h"
+#include "clixon_xml_bin.h"
 #include "clixon_yang_module.h"
 #include "clixon_plugin.h"
 #include "clixon_yang_parse_lib.h"
@@ -83,6 +89,7 @@
 #include "clixon_xml_default.h"
 #include "clixon_xml_io.h"
 #include "clixon_xml_nsctx.h"
+#include "clixon_xml_vec.h"
 #include "clixon_datastore.h"
 #include "clixon_datastore_read.h"
 
@@ -97,6 +104,16 @@ struct xmldb_multi_read_arg {
     yang_stmt       *mr_yspec;
     enum format_enum mr_format;
     cxobj          **mr_xerr;
+    int              mr_workers; /* Number of processes parsing linked files, see CLICON_XMLDB_MULTI_PARALLEL */
+};
+
+/* Buffer of records read from a xmldb-multi parse worker */
+struct xmldb_multi_worker {
+    pid_t   mw_pid;
+    int     mw_fd;
+    char   *mw_buf;
+    size_t  mw_len;
+    size_t  mw_max;
 };
 
 /*! Ensure that xt only has a single sub-element and that is "config"
@@ -229,24 +246,152 @@ xml_copy_bottom_recurse(cxobj  *x0t,
     return retval;
 }
 
+/*! Copy element child x0c of x0 to x1 and continue copying with depth
+ */
+static int
+xml_copy_depth_child(cxobj            *x0c,
+                     cxobj            *x1,
+                     uint16_t          skip,
+                     int32_t           depth,
+                     withdefaults_type wdef);
+
+/*! Copy xml tree x0 to existing x1 but only depth levels of element children
+ *
+ * Element children below depth are not copied, with the following exceptions that keep
+ * the output of the depth-limited tree identical to the complete tree:
+ * - Key leafs of list entries, they are also needed for instance-id lookups, eg NACM paths
+ * - One element child, or for non-presence containers with EXPLICIT or TRIM one element
+ *   child that is output, so that empty and non-empty nodes are told apart
+ * @param[in]  x0    Source XML tree
+ * @param[in]  x1    Destination XML tree (must exist)
+ * @param[in]  skip  Do not copy element children with any of these flags
+ * @param[in]  depth Levels of element children to copy, 0 means only the exceptions above
+ * @param[in]  wdef  With-defaults parameter used when printing, see xml2output_wdef
+ * @retval     0     OK
+ * @retval    -1     Error
+ * @see xml_copy_skip
+ */
+static int
+xml_copy_depth(cxobj            *x0,
+               cxobj            *x1,
+               uint16_t          skip,
+               int32_t           depth,
+               withdefaults_type wdef)
+{
+    int        retval = -1;
+    cxobj     *x;
+    cxobj     *xw = NULL;
+    cxobj     *xcopy;
+    yang_stmt *y;
+    cvec      *cvk;
+    cg_var    *cvi;
+    int        keys = 0;
+    int        ret;
+
+    if (xml_copy_one(x0, x1) <0)
+        goto done;
+    x = NULL;
+    while ((x = xml_child_each(x0, x, -1)) != NULL) {
+        if (xml_type(x) == CX_ELMNT){
+            if (skip && xml_flag(x, skip))
+                continue;
+            if (depth > 0){
+                if (xml_copy_depth_child(x, x1, skip, depth-1, wdef) < 0)
+                    goto done;
+            }
+            else if (xw == NULL)
+                xw = x;
+            continue;
+        }
+        if ((xcopy = xml_new(xml_name(x), x1, xml_type(x))) == NULL)
+            goto done;
+        if (xml_copy_one(x, xcopy) < 0)
+            goto done;
+    }
+    if (depth > 0 || xw == NULL)
+        goto ok;
+    y = xml_spec(x0);
+    if (y && yang_keyword_get(y) == Y_LIST){
+        cvk = yang_cvec_get(y); /* Use Y_LIST cache, see ys_populate_list() */
+        cvi = NULL;
+        while ((cvi = cvec_each(cvk, cvi)) != NULL) {
+            if ((x = xml_find_type(x0, NULL, cv_string_get(cvi), CX_ELMNT)) == NULL)
+                continue;
+            if (xml_copy_depth_child(x, x1, skip, 0, wdef) < 0)
+                goto done;
+            keys++;
+        }
+        if (keys)
+            goto ok;
+    }
+    if ((wdef == WITHDEFAULTS_EXPLICIT || wdef == WITHDEFAULTS_TRIM) &&
+        y && yang_keyword_get(y) == Y_CONTAINER &&
+        yang_find(y, Y_PRESENCE, NULL) == NULL){
+        x = NULL;
+        while ((x = xml_child_each(x0, x, CX_ELMNT)) != NULL) {
+            if (skip && xml_flag(x, skip))
+                continue;
+            if ((ret = xml2output_wdef(x, wdef, NULL)) < 0)
+                goto done;
+            if (ret == 1){
+                xw = x;
+                break;
+            }
+        }
+    }
+    if (xml_copy_depth_child(xw, x1, skip, 0, wdef) < 0)
+        goto done;
+ ok:
+    retval = 0;
+ done:
+    return retval;
+}
+
+static int
+xml_copy_depth_child(cxobj            *x0c,
+                     cxobj            *x1,
+                     uint16_t          skip,
+                     int32_t           depth,
+                     withdefaults_type wdef)
+{
+    cxobj *xcopy;
+
+    if ((xcopy = xml_new(xml_name(x0c), x1, CX_ELMNT)) == NULL)
+        return -1;
+    return xml_copy_depth(x0c, xcopy, skip, depth, wdef);
+}
+
 /*! Copy an XML tree bottom-up
  *
- * @retval   0    OK
- * @retval  -1    Error
+ * @param[in]  x0t   Top of source tree
+ * @param[in]  x0    Source node to copy with its ancestors
+ * @param[in]  x1t   Top of target tree
+ * @param[in]  skip  Do not copy elements with any of these flags
+ * @param[in]  depth Max depth from x0t of copied elements, or -1 for no limit
+ * @param[in]  wdef  With-defaults parameter used when printing, if depth is limited
+ * @retval     0     OK
+ * @retval    -1     Error
+ * @see xml_copy_depth
  */
 static int
-xml_copy_from_bottom(cxobj *x0t,
-                     cxobj *x0,
-                     cxobj *x1t)
+xml_copy_from_bottom(cxobj            *x0t,
+                     cxobj            *x0,
+                     cxobj            *x1t,
+                     uint16_t          skip,
+                     int32_t           depth,
+                     withdefaults_type wdef)
 {
     int        retval = -1;
     cxobj     *x1p    = NULL;
     cxobj     *x0p    = NULL;
     cxobj     *x1     = NULL;
     yang_stmt *y      = NULL;
+    int32_t    k;
 
     if (x0 == x0t)
         goto ok;
+    if (skip && xml_flag(x0, skip))
+        goto ok;
     x0p = xml_parent(x0);
     if (xml_copy_bottom_recurse(x0t, x0p, x1t, &x1p) < 0)
         goto done;
@@ -258,7 +403,19 @@ xml_copy_from_bottom(cxobj *x0t,
     if (x1 == NULL){ /* If not, create it and copy complete tree */
         if ((x1 = xml_new(xml_name(x0), x1p, CX_ELMNT)) == NULL)
             goto done;
-        if (xml_copy(x0, x1) < 0)
+        if (depth >= 0){
+            /* Levels left below x0 */
+            k = 1;
+            for (x0p = xml_parent(x0); x0p && x0p != x0t; x0p = xml_parent(x0p))
+                k++;
+            if (xml_copy_depth(x0, x1, skip, depth>k?depth-k:0, wdef) < 0)
+                goto done;
+        }
+        else if (skip){
+            if (xml_copy_skip(x0, x1, skip) < 0)
+                goto done;
+        }
+        else if (xml_copy(x0, x1) < 0)
             goto done;
     }
  ok:
@@ -267,12 +424,19 @@ xml_copy_from_bottom(cxobj *x0t,
     return retval;
 }
 
+/* System module in the module-state comparison of text_read_modstate */
+struct modstate_sys {
+    cxobj *ms_x;    /* Module in system module-set */
+    int    ms_seen; /* Module is also in file module-set */
+};
+
 /*! Read module-state in an XML tree
  *
  * @param[in]  th     Datastore text handle
  * @param[in]  yspec  Top-level yang spec
  * @param[in]  xt     XML tree
  * @param[out] msdiff Modules-state differences
+ * @param[out] xmodfilep If set, module-set of file removed from xt, free with xml_free
  * @retval     0      OK
  * @retval    -1      Error
  *
@@ -294,12 +458,15 @@ xml_copy_from_bottom(cxobj *x0t,
  *    3d) File module-state changes its namespace -> add to list mark as CHANGE
  * 4) For each module state s in the system
  *    4a) If there is no such module in the file -> add to list mark as ADD
+ * System modules are looked up by name in a hash, so the comparison is one pass over
+ * the file modules and one over the system modules.
  */
 static int
 text_read_modstate(clixon_handle    h,
                    yang_stmt       *yspec,
                    cxobj           *xt,
-                   modstate_diff_t *msdiff)
+                   modstate_diff_t *msdiff,
+                   cxobj          **xmodfilep)
 {
     int    retval = -1;
     cxobj *xmodfile = NULL;   /* modstate of system (loaded yang modules in runtime) */
@@ -316,6 +483,9 @@ text_read_modstate(clixon_handle    h,
     char  *fns;               /* file namespace */
     char  *sns;               /* system namespace */
     int    rfc7895=0;         /* backward-compatible: old version */
+    clicon_hash_t *sysmods = NULL; /* System module name -> struct modstate_sys */
+    struct modstate_sys  ms;
+    struct modstate_sys *msp;
 
     /* Read module-state as computed at startup, see startup_module_state() */
     if ((xmodcache = clicon_modst_cache_get(h, 1)) != NULL)
@@ -345,6 +515,22 @@ text_read_modstate(clixon_handle    h,
                 }
             }
         }
+        /* Index system modules by name */
+        if ((sysmods = clicon_hash_init()) == NULL)
+            goto done;
+        xs = NULL;
+        while ((xs = xml_child_each(xmodsystem, xs, CX_ELMNT)) != NULL) {
+            if (strcmp(xml_name(xs), "module"))
+                continue;
+            if ((name = xml_find_body(xs, "name")) == NULL)
+                continue;
+            if (clicon_hash_value(sysmods, name, NULL) != NULL)
+                continue; /* Keep first, as xpath_first */
+            ms.ms_x = xs;
+            ms.ms_seen = 0;
+            if (clicon_hash_add(sysmods, name, &ms, sizeof(ms)) == NULL)
+                goto done;
+        }
         /* 3) For each module state m in the file */
         xf = NULL;
         while ((xf = xml_child_each(xmodfile, xf, CX_ELMNT)) != NULL) {
@@ -362,7 +548,7 @@ text_read_modstate(clixon_handle    h,
             if ((name = xml_find_body(xf, "name")) == NULL)
                 continue;
             /* 3a) There is no such module in the system */
-            if ((xs = xpath_first(xmodsystem, NULL, "module[name=\"%s\"]", name)) == NULL){
+            if ((msp = clicon_hash_value(sysmods, name, NULL)) == NULL){
                 if ((xf2 = xml_dup(xf)) == NULL)          /* Make a copy of this modstate */
                     goto done;
                 if (xml_addsub(msdiff->md_diff, xf2) < 0)   /* Add it to modstatediff */
@@ -370,6 +556,8 @@ text_read_modstate(clixon_handle    h,
                 xml_flag_set(xf2, XML_FLAG_DEL);
                 continue;
             }
+            xs = msp->ms_x;
+            msp->ms_seen++;
             /* These two shouldnt happen since revision is key, just ignore */
             if ((frev = xml_find_body(xf, "revision")) == NULL)
                 continue;
@@ -411,7 +599,8 @@ text_read_modstate(clixon_handle    h,
             if ((name = xml_find_body(xs, "name")) == NULL)
                 continue;
             /* 4a) If there is no such module in the file -> add to list mark as ADD */
-            if ((xf = xpath_first(xmodfile, NULL, "module[name=\"%s\"]", name)) == NULL){
+            if ((msp = clicon_hash_value(sysmods, name, NULL)) == NULL ||
+                msp->ms_seen == 0){
                 if ((xs2 = xml_dup(xs)) == NULL)          /* Make a copy of this modstate */
                     goto done;
                 if (xml_addsub(msdiff->md_diff, xs2) < 0)   /* Add it to modstatediff */
@@ -425,17 +614,22 @@ text_read_modstate(clixon_handle    h,
      * in all cases, whether CLICON_XMLDB_MODSTATE is on or not.
      * Clixon systems with CLICON_XMLDB_MODSTATE disabled ignores it
      */
-    if (rfc7895){
-        if (xmodfile){
-            if (xml_purge(xmodfile) < 0)
-                goto done;
-        }
+    if (xmodfile && xmodfilep){
+        if (xml_rm(xmodfile) < 0)
+            goto done;
+        *xmodfilep = xmodfile;
+    }
+    else if (rfc7895 && xmodfile){
+        if (xml_purge(xmodfile) < 0)
+            goto done;
     }
-    else if (xyanglib)
+    if (!rfc7895 && xyanglib)
         if (xml_purge(xyanglib) < 0)
                 goto done;
     retval = 0;
  done:
+    if (sysmods)
+        clicon_hash_free(sysmods);
     return retval;
 }
 
@@ -486,6 +680,74 @@ disable_nacm_on_empty(cxobj     *xt,
     return retval;
 }
 
+/*! Callback function for translating JSON xmldb-multi links to link attributes
+ *
+ * In JSON, a split-point is written as an object with a single clixon-lib:link member.
+ * Translate it to the same link attribute as in XML
+ * @param[in]  x    XML node
+ * @param[in]  arg  Not used
+ * @retval     2    Link node, do not descend
+ * @retval     0    OK, continue
+ * @retval    -1    Error
+ * @see xml2json1_cbuf
+ */
+static int
+xmldb_multi_json_link_applyfn(cxobj *x,
+                              void  *arg)
+{
+    cxobj *xl;
+    cxobj *xa;
+    char  *ns = NULL;
+
+    if (xml_child_nr_type(x, CX_ELMNT) != 1 ||
+        (xl = xml_find_type(x, NULL, "link", CX_ELMNT)) == NULL)
+        return 0;
+    if (xml2ns(xl, NULL, &ns) < 0)
+        return -1;
+    if (ns == NULL || strcmp(ns, CLIXON_LIB_NS) != 0)
+        return 0;
+    if ((xa = xml_new("link", x, CX_ATTR)) == NULL)
+        return -1;
+    if (xml_prefix_set(xa, CLIXON_LIB_PREFIX) < 0)
+        return -1;
+    if (xml_value_set(xa, xml_body(xl)) < 0)
+        return -1;
+    if (xmlns_set(x, CLIXON_LIB_PREFIX, CLIXON_LIB_NS) < 0)
+        return -1;
+    if (xml_purge(xl) < 0)
+        return -1;
+    return 2;
+}
+
+/*! Move children of a JSON sub-file split-point to x
+ *
+ * A JSON sub-file contains the split-point itself, unlike XML which contains its children
+ * @param[in]  xt   Top of parsed JSON sub-file
+ * @param[in]  x    Split-point in datastore, may be xt
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+xmldb_multi_json_lift(cxobj *xt,
+                      cxobj *x)
+{
+    cxobj *xs;
+    cxobj *xc;
+    int    i = 0;
+
+    if ((xs = xml_child_i_type(xt, 0, CX_ELMNT)) == NULL)
+        return 0;
+    while ((xc = xml_child_i(xs, i)) != NULL){
+        if (xml_type(xc) == CX_ATTR){
+            i++;
+            continue;
+        }
+        if (xml_addsub(x, xc) < 0)
+            return -1;
+    }
+    return xml_purge(xs);
+}
+
 /*! Callback function for xmldb-multi read
  *
  * Look for link attribute in XML, and if found open the linked file for parsing
@@ -507,6 +769,7 @@ xmldb_multi_read_applyfn(cxobj *x,
     cbuf                   *cb = NULL;
     char                   *dbfile;
     FILE                   *fp = NULL;
+    cxobj                  *xt = NULL;
 
     if ((xa = xml_find_type(x, CLIXON_LIB_PREFIX, "link", CX_ATTR)) != NULL &&
         (filename = xml_value(xa)) != NULL){
@@ -520,13 +783,13 @@ xmldb_multi_read_applyfn(cxobj *x,
             xml_purge(xa);
         dbfile = cbuf_get(cb);
         clixon_debug(CLIXON_DBG_DATASTORE, "Parsing: %s", dbfile);
-        if ((fp = fopen(dbfile, "r")) == NULL){
-            clixon_err(OE_CFG, errno, "fopen(%s)", dbfile);
+        if ((fp = clicon_file_zfopen(dbfile, "r", 0)) == NULL)
             goto done;
-        }
         switch (mr->mr_format){
         case FORMAT_JSON:
-            if (clixon_json_parse_file(fp, 1, YB_NONE, mr->mr_yspec, &x, mr->mr_xerr) < 0)
+            if (clixon_json_parse_file(fp, 1, YB_NONE, mr->mr_yspec, &xt, mr->mr_xerr) < 0)
+                goto done;
+            if (xmldb_multi_json_lift(xt, x) < 0)
                 goto done;
             break;
         case FORMAT_XML:
@@ -541,6 +804,8 @@ xmldb_multi_read_applyfn(cxobj *x,
     }
     retval = 0;
  done:
+    if (xt)
+        xml_free(xt);
     if (cb)
         cbuf_free(cb);
     if (fp)
@@ -548,6 +813,339 @@ xmldb_multi_read_applyfn(cxobj *x,
     return retval;
 }
 
+/*! Callback function for collecting xmldb-multi link nodes
+ *
+ * @param[in]  x    XML node
+ * @param[in]  arg  XML vector of link nodes
+ * @retval     2    Link node, do not descend
+ * @retval     0    OK, continue
+ * @retval    -1    Error
+ */
+static int
+xmldb_multi_link_applyfn(cxobj *x,
+                         void  *arg)
+{
+    clixon_xvec *xv = (clixon_xvec *)arg;
+
+    if (xml_find_type(x, CLIXON_LIB_PREFIX, "link", CX_ATTR) == NULL)
+        return 0;
+    if (clixon_xvec_append(xv, x) < 0)
+        return -1;
+    return 2;
+}
+
+/*! Parse worker: parse linked files of a shard and write them in binary format to fd
+ *
+ * Each record is: index, length of binary tree, binary tree, padded to 8 bytes
+ * @param[in]  mr   Multi read argument
+ * @param[in]  xv   Link nodes
+ * @param[in]  w    Worker number, parses nodes with index w, w+nw,...
+ * @param[in]  nw   Number of workers
+ * @param[in]  fd   Write end of pipe
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+xmldb_multi_read_worker(struct xmldb_multi_read_arg *mr,
+                        clixon_xvec                 *xv,
+                        int                          w,
+                        int                          nw,
+                        int                          fd)
+{
+    int      retval = -1;
+    FILE    *f = NULL;
+    FILE    *fm = NULL;
+    FILE    *fp = NULL;
+    char    *buf = NULL;
+    size_t   blen = 0;
+    cxobj   *xa;
+    cxobj   *xt = NULL;
+    cbuf    *cb = NULL;
+    uint64_t rec[2];
+    char     pad[8] = {0,};
+    int      i;
+
+    if ((f = fdopen(fd, "w")) == NULL)
+        goto done;
+    if ((cb = cbuf_new()) == NULL)
+        goto done;
+    for (i=w; i<clixon_xvec_len(xv); i+=nw){
+        if ((xa = xml_find_type(clixon_xvec_i(xv, i), CLIXON_LIB_PREFIX, "link", CX_ATTR)) == NULL ||
+            xml_value(xa) == NULL)
+            continue;
+        cbuf_reset(cb);
+        cprintf(cb, "%s/%s", mr->mr_subdir, xml_value(xa));
+        if ((fp = clicon_file_zfopen(cbuf_get(cb), "r", 0)) == NULL)
+            goto done;
+        switch (mr->mr_format){
+        case FORMAT_JSON:
+            if (clixon_json_parse_file(fp, 1, YB_NONE, mr->mr_yspec, &xt, NULL) < 0)
+                goto done;
+            if (xmldb_multi_json_lift(xt, xt) < 0)
+                goto done;
+            break;
+        case FORMAT_XML:
+            if (clixon_xml_parse_file(fp, YB_NONE, mr->mr_yspec, &xt, NULL) < 0)
+                goto done;
+            break;
+        default:
+            goto done;
+            break;
+        }
+        fclose(fp);
+        fp = NULL;
+        if ((fm = open_memstream(&buf, &blen)) == NULL)
+            goto done;
+        if (clixon_xml2bin_file(fm, xt, NULL, WITHDEFAULTS_REPORT_ALL, 0) < 0)
+            goto done;
+        if (fclose(fm) != 0){
+            fm = NULL;
+            goto done;
+        }
+        fm = NULL;
+        rec[0] = i;
+        rec[1] = blen;
+        if (fwrite(rec, sizeof(rec), 1, f) != 1 ||
+            fwrite(buf, 1, blen, f) != blen ||
+            fwrite(pad, 1, (8 - blen%8)%8, f) != (8 - blen%8)%8)
+            goto done;
+        free(buf);
+        buf = NULL;
+        xml_free(xt);
+        xt = NULL;
+    }
+    if (fflush(f) != 0)
+        goto done;
+    retval = 0;
+ done:
+    if (f)
+        fclose(f);
+    if (fm)
+        fclose(fm);
+    if (fp)
+        fclose(fp);
+    if (buf)
+        free(buf);
+    if (xt)
+        xml_free(xt);
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+}
+
+/*! Stitch records from a parse worker into link nodes
+ *
+ * @param[in]  mw   Worker buffer
+ * @param[in]  xv   Link nodes
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+xmldb_multi_read_stitch(struct xmldb_multi_worker *mw,
+                        clixon_xvec               *xv)
+{
+    int       retval = -1;
+    size_t    pos = 0;
+    uint64_t  rec[2];
+    cxobj    *x;
+    cxobj    *xb = NULL;
+    cxobj    *xtop;
+    cxobj    *xc;
+    cxobj    *xa;
+    int       bound;
+
+    while (pos + sizeof(rec) <= mw->mw_len){
+        memcpy(rec, mw->mw_buf + pos, sizeof(rec));
+        pos += sizeof(rec);
+        if (rec[0] >= clixon_xvec_len(xv) || rec[1] > mw->mw_len - pos){
+            clixon_err(OE_DB, EINVAL, "Invalid record from parse worker");
+            goto done;
+        }
+        if (clixon_bin_parse_buf(mw->mw_buf + pos, rec[1], NULL, &xb, &bound) < 0)
+            goto done;
+        pos += rec[1] + (8 - rec[1]%8)%8;
+        x = clixon_xvec_i(xv, rec[0]);
+        if ((xtop = xml_child_i(xb, 0)) != NULL)
+            while ((xc = xml_child_i(xtop, 0)) != NULL)
+                if (xml_addsub(x, xc) < 0)
+                    goto done;
+        if ((xa = xml_find_type(x, CLIXON_LIB_PREFIX, "link", CX_ATTR)) != NULL)
+            xml_purge(xa);
+        if ((xa = xml_find_type(x, "xmlns", CLIXON_LIB_PREFIX, CX_ATTR)) != NULL)
+            xml_purge(xa);
+        xml_free(xb);
+        xb = NULL;
+    }
+    retval = 0;
+ done:
+    if (xb)
+        xml_free(xb);
+    return retval;
+}
+
+/*! Parse xmldb-multi linked files in parallel worker processes
+ *
+ * Link nodes are split into one shard per worker. Each worker parses its files on a
+ * copy-on-write image of the tree and sends them in binary format back on a pipe. The
+ * parsed trees are stitched into the link nodes, which are then no longer links.
+ * Files of workers that can not be forked or that fail, and links in linked files, are
+ * left for the sequential pass, which also reports errors.
+ * Clixon is not thread-safe (eg parser and error state), therefore processes are used.
+ * @param[in]  mr   Multi read argument
+ * @param[in]  x0   XML tree with link nodes
+ * @retval     0    OK
+ * @retval    -1    Error
+ * @see CLICON_XMLDB_MULTI_PARALLEL
+ */
+static int
+xmldb_multi_read_parallel(struct xmldb_multi_read_arg *mr,
+                          cxobj                       *x0)
+{
+    int                        retval = -1;
+    clixon_xvec               *xv = NULL;
+    struct xmldb_multi_worker *mwv = NULL;
+    struct pollfd             *pfd = NULL;
+    int                        nw;
+    int                        w;
+    int                        fd[2];
+    int                        nopen;
+    int                        status;
+    ssize_t                    len;
+    char                      *buf;
+
+    if ((xv = clixon_xvec_new()) == NULL)
+        goto done;
+    if (xml_apply(x0, CX_ELMNT, xmldb_multi_link_applyfn, xv) < 0)
+        goto done;
+    if ((nw = mr->mr_workers) > clixon_xvec_len(xv))
+        nw = clixon_xvec_len(xv);
+    if (nw < 2)
+        goto ok;
+    if ((mwv = calloc(nw, sizeof(*mwv))) == NULL ||
+        (pfd = calloc(nw, sizeof(*pfd))) == NULL){
+        clixon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    for (w=0; w<nw; w++)
+        mwv[w].mw_fd = -1;
+    for (w=0; w<nw; w++){
+        if (pipe(fd) < 0)
+            break;
+        if ((mwv[w].mw_pid = fork()) < 0){
+            mwv[w].mw_pid = 0;
+            close(fd[0]);
+            close(fd[1]);
+            break;
+        }
+        if (mwv[w].mw_pid == 0){ /* Worker */
+            close(fd[0]);
+            for (nopen=0; nopen<w; nopen++)
+                close(mwv[nopen].mw_fd);
+            if (xmldb_multi_read_worker(mr, xv, w, nw, fd[1]) < 0)
+                _exit(1);
+            _exit(0); /* Dont exit() here, parent state must not be flushed */
+        }
+        close(fd[1]);
+        mwv[w].mw_fd = fd[0];
+    }
+    /* Read all workers concurrently so that none blocks on a full pipe */
+    do {
+        nopen = 0;
+        for (w=0; w<nw; w++){
+            if (mwv[w].mw_fd == -1)
+                continue;
+            pfd[nopen].fd = mwv[w].mw_fd;
+            pfd[nopen].events = POLLIN;
+            pfd[nopen].revents = 0;
+            nopen++;
+        }
+        if (nopen == 0)
+            break;
+        if (poll(pfd, nopen, -1) < 0){
+            if (errno == EINTR)
+                continue;
+            clixon_err(OE_UNIX, errno, "poll");
+            goto done;
+        }
+        for (w=0; w<nw; w++){
+            if (mwv[w].mw_fd == -1)
+                continue;
+            for (nopen=0; pfd[nopen].fd != mwv[w].mw_fd; nopen++);
+            if (pfd[nopen].revents == 0)
+                continue;
+            if (mwv[w].mw_len + 65536 > mwv[w].mw_max){
+                mwv[w].mw_max = mwv[w].mw_max ? 2*mwv[w].mw_max : 65536*2;
+                if ((buf = realloc(mwv[w].mw_buf, mwv[w].mw_max)) == NULL){
+                    clixon_err(OE_UNIX, errno, "realloc");
+                    goto done;
+                }
+                mwv[w].mw_buf = buf;
+            }
+            if ((len = read(mwv[w].mw_fd, mwv[w].mw_buf + mwv[w].mw_len, 65536)) < 0){
+                if (errno == EINTR)
+                    continue;
+                len = 0;
+            }
+            if (len == 0){
+                close(mwv[w].mw_fd);
+                mwv[w].mw_fd = -1;
+            }
+            mwv[w].mw_len += len;
+        }
+    } while (1);
+    for (w=0; w<nw; w++){
+        if (mwv[w].mw_pid == 0)
+            continue;
+        if (waitpid(mwv[w].mw_pid, &status, 0) == mwv[w].mw_pid &&
+            WIFEXITED(status) && WEXITSTATUS(status) == 0){
+            if (xmldb_multi_read_stitch(&mwv[w], xv) < 0){
+                mwv[w].mw_pid = 0;
+                goto done;
+            }
+        }
+        else
+            clixon_debug(CLIXON_DBG_DATASTORE, "parse worker %d failed, parsing its files sequentially", w);
+        mwv[w].mw_pid = 0;
+    }
+ ok:
+    retval = 0;
+ done:
+    for (w=0; mwv && w<nw; w++){
+        if (mwv[w].mw_fd != -1)
+            close(mwv[w].mw_fd);
+        if (mwv[w].mw_pid != 0){
+            kill(mwv[w].mw_pid, SIGKILL);
+            waitpid(mwv[w].mw_pid, &status, 0);
+        }
+        if (mwv[w].mw_buf)
+            free(mwv[w].mw_buf);
+    }
+    if (mwv)
+        free(mwv);
+    if (pfd)
+        free(pfd);
+    if (xv)
+        clixon_xvec_free(xv);
+    return retval;
+}
+
+/*! Check if any plugin has a general-purpose datastore upgrade callback
+ *
+ * @param[in]  h   Clixon handle
+ * @retval     1   Yes
+ * @retval     0   No
+ */
+static int
+xmldb_upgrade_plugin_exists(clixon_handle h)
+{
+    clixon_plugin_t *cp = NULL;
+
+    while ((cp = clixon_plugin_each(h, cp)) != NULL)
+        if (clixon_plugin_api_get(cp)->ca_datastore_upgrade != NULL)
+            return 1;
+    return 0;
+}
+
 /*! Common read function that reads an XML tree from file
  *
  * @param[in]  th     Datastore text handle
@@ -557,6 +1155,8 @@ xmldb_multi_read_applyfn(cxobj *x,
  * @param[out] xp     XML tree read from file
  * @param[out] de     If set, return db-element status (eg empty flag)
  * @param[out] msdiff If set, return modules-state differences
+ * @param[out] bound  If set, binary format may bind yang when loading, set to 1 if tree is
+ *                    bound to yang and sorted
  * @param[out] xerr   XML error if retval is 0
  * @retval     1      OK
  * @retval     0      Parse OK but yang assigment not made (or only partial) and xerr set
@@ -573,6 +1173,7 @@ xmldb_readfile(clixon_handle     h,
                cxobj           **xp,
                db_elmnt         *de,
                modstate_diff_t **msdiff0,
+               int              *bound,
                cxobj           **xerr)
 {
     int              retval = -1;
@@ -586,8 +1187,12 @@ xmldb_readfile(clixon_handle     h,
     cxobj           *x;
     yang_stmt       *yspec1 = NULL;
     struct xmldb_multi_read_arg mr = {0, };
+    int              bound1 = 0;
     int              ret;
+    struct timeval   tv;
+    clixon_trace_t   tr;
 
+    tr = clixon_trace_begin(CLIXON_DBG_DATASTORE);
     if (yb != YB_MODULE && yb != YB_NONE){
         clixon_err(OE_XML, EINVAL, "yb is %d but should be module or none", yb);
         goto done;
@@ -598,7 +1203,7 @@ xmldb_readfile(clixon_handle     h,
         clixon_err(OE_XML, 0, "dbfile NULL");
         goto done;
     }
-    if ((formatstr = clicon_option_str(h, "CLICON_XMLDB_FORMAT")) == NULL){
+    if ((formatstr = clicon_option_str_id(h, CO_XMLDB_FORMAT)) == NULL){
         clixon_err(OE_CFG, ENOENT, "No CLICON_XMLDB_FORMAT");
         goto done;
     }
@@ -608,11 +1213,10 @@ xmldb_readfile(clixon_handle     h,
     }
     format = ret;
     clixon_debug(CLIXON_DBG_DATASTORE, "Reading datastore %s using %s", dbfile, formatstr);
-    /* Parse file into internal XML tree from different formats */
-    if ((fp = fopen(dbfile, "r")) == NULL) {
-        clixon_err(OE_UNIX, errno, "open(%s)", dbfile);
+    /* Parse file into internal XML tree from different formats
+     * A zstd compressed file is detected and decompressed while parsing */
+    if ((fp = clicon_file_zfopen(dbfile, "r", 0)) == NULL)
         goto done;
-    }
     /* Read whole datastore file on the form:
      * <config>
      *   modstate*  # this is analyzed, stripped and returned as msdiff in text_read_modstate
@@ -628,17 +1232,28 @@ xmldb_readfile(clixon_handle     h,
         if (clixon_xml_parse_file(fp, YB_NONE, yspec, &x0, xerr) < 0)
             goto done;
         break;
+    case FORMAT_BINARY:
+        if (clixon_bin_parse_file(fp, (bound || yb == YB_MODULE)?yspec:NULL, &x0, &bound1) < 0)
+            goto done;
+        break;
     default:
         clixon_err(OE_DB, 0, "Format %s not supported", formatstr);
         goto done;
         break;
     }
-    if (clicon_option_bool(h, "CLICON_XMLDB_MULTI")){
+    if (clicon_option_bool_id(h, CO_XMLDB_MULTI)){
         if (xmldb_db2subdir(h, db, &mr.mr_subdir) < 0)
             goto done;
         mr.mr_format = format;
         mr.mr_yspec = yspec;
         mr.mr_xerr = xerr;
+        mr.mr_workers = clicon_option_int(h, "CLICON_XMLDB_MULTI_PARALLEL");
+        if (format == FORMAT_JSON &&
+            xml_apply(x0, CX_ELMNT, xmldb_multi_json_link_applyfn, NULL) < 0)
+            goto done;
+        if (mr.mr_workers > 1 &&
+            xmldb_multi_read_parallel(&mr, x0) < 0)
+            goto done;
         if (xml_apply(x0, CX_ELMNT, (xml_applyfn_t*)xmldb_multi_read_applyfn, &mr) < 0)
             goto done;
     }
@@ -668,27 +1283,24 @@ xmldb_readfile(clixon_handle     h,
     if (clicon_option_bool(h, "CLICON_XMLDB_MODSTATE"))
         if ((msdiff = modstate_diff_new()) == NULL)
             goto done;
-    /* First try RFC8525, but also backward compatible RFC7895 */
-    if ((x = xpath_first(x0, NULL, "yang-library/module-set")) != NULL ||
-        (x = xml_find_type(x0, NULL, "modules-state", CX_ELMNT)) != NULL){
-        if ((xmodfile = xml_dup(x)) == NULL)
-            goto done;
-    }
     /* Datastore files may contain module-state defining
      * which modules are used in the file.
      * Strip module-state, analyze it with CHANGE/ADD/RM and return msdiff
+     * The module-set of the file is taken out of the tree, not copied
      */
-    if (text_read_modstate(h, yspec, x0, msdiff) < 0)
+    if (text_read_modstate(h, yspec, x0, msdiff, msdiff?&xmodfile:NULL) < 0)
         goto done;
     if (msdiff && xmodfile){
         msdiff->md_xmodfile = xmodfile;
         xmodfile = NULL;
     }
-    if (yb == YB_MODULE){
+    if (yb == YB_MODULE && !bound1){
         /* xml looks like: <top><config><x>... actually YB_MODULE_NEXT
          */
+        yang_profile_start(&tv);
         if ((ret = xml_bind_yang(h, x0, YB_MODULE, yspec1?yspec1:yspec, 0, xerr)) < 0)
             goto done;
+        yang_profile_stop(YANG_PROF_BIND, &tv);
         if (ret == 0)
             goto fail;
         if (xml_sort_recurse(x0) < 0)
@@ -702,6 +1314,8 @@ xmldb_readfile(clixon_handle     h,
         *msdiff0 = msdiff;
         msdiff = NULL;
     }
+    if (bound)
+        *bound = bound1;
     retval = 1;
  done:
     if (mr.mr_subdir)
@@ -716,6 +1330,7 @@ xmldb_readfile(clixon_handle     h,
         free(dbfile);
     if (x0)
         xml_free(x0);
+    clixon_trace_end(tr, CLIXON_DBG_DATASTORE, "xmldb_readfile", db);
     return retval;
  fail:
     retval = 0;
@@ -743,8 +1358,8 @@ xmldb_upgrade(clixon_handle    h,
     }
     xt = xmldb_cache_get(de);
     db = xmldb_name_get(de);
-    xml_apply0(xt, CX_ELMNT, (xml_applyfn_t*)xml_flag_reset,
-               (void*)(XML_FLAG_MARK|XML_FLAG_CHANGE));
+    if (xml_flag_reset_tree(xt, XML_FLAG_MARK|XML_FLAG_CHANGE) < 0)
+        goto done;
         /* Here xt is old syntax */
     /* General purpose datastore upgrade */
     if (clixon_plugin_datastore_upgrade_all(h, db, xt, msdiff) < 0)
@@ -885,7 +1500,11 @@ xmldb_get_cache_from_file(clixon_handle h,
     cxobj           *xt = NULL;
     modstate_diff_t *msdiff = NULL;
     char            *db;
+    int              prebind;
+    int              bound = 0;
+    int              changed;
     int              ret;
+    struct timeval   tv;
 
     db = xmldb_name_get(de);
     clixon_debug(CLIXON_DBG_DATASTORE | CLIXON_DBG_DETAIL, "%s", db);
@@ -893,9 +1512,14 @@ xmldb_get_cache_from_file(clixon_handle h,
         clixon_err(OE_YANG, ENOENT, "No yang spec");
         goto done;
     }
+    /* Binary format may bind on load, unless upgrade callbacks expect old syntax
+     * or binding needs schema mount */
+    prebind = !clicon_option_bool_id(h, CO_YANG_SCHEMA_MOUNT) &&
+        !xmldb_upgrade_plugin_exists(h);
     /* If there is no xml x0 tree (in cache), then read it from file */
     /* xml looks like: <top><config><x>... where "x" is a top-level symbol in a module */
-    if ((ret = xmldb_readfile(h, db, YB_NONE, yspec0, &xt, de, &msdiff, xerr)) < 0)
+    if ((ret = xmldb_readfile(h, db, YB_NONE, yspec0, &xt, de, &msdiff,
+                              prebind?&bound:NULL, xerr)) < 0)
         goto done;
     if (ret == 0)
         goto fail;
@@ -903,15 +1527,26 @@ xmldb_get_cache_from_file(clixon_handle h,
      * No, argument against: we may want to have a semantically wrong file and wish to edit?
      */
     xmldb_cache_set(de, xt);
-    if (clicon_option_bool(h, "CLICON_XMLDB_UPGRADE_CHECKOLD")){
-        if (msdiff){
+    /* Any module added, deleted or changed since the file was written */
+    changed = msdiff && xml_child_nr_type(msdiff->md_diff, CX_ELMNT) > 0;
+    if (bound && !changed){
+        /* Bound and sorted on load, and no module upgrade callbacks will be made */
+        if ((ret = xmldb_upgrade(h, de, msdiff, xerr)) < 0)
+            goto done;
+        if (ret == 0)
+            goto fail;
+    }
+    else if (clicon_option_bool(h, "CLICON_XMLDB_UPGRADE_CHECKOLD")){
+        if (changed){
             if ((ret = xmldb_msdiff(h, msdiff, yspec0, xerr, &yspec1)) < 0)
                 goto done;
             if (ret == 0)
                 goto fail;
         }
+        yang_profile_start(&tv);
         if ((ret = xml_bind_yang(h, xt, YB_MODULE, yspec1?yspec1:yspec0, 0, xerr)) < 0)
             goto done;
+        yang_profile_stop(YANG_PROF_BIND, &tv);
         if (ret == 0)
             goto fail;
         if ((ret = xmldb_upgrade(h, de, msdiff, xerr)) < 0)
@@ -924,12 +1559,18 @@ xmldb_get_cache_from_file(clixon_handle h,
             goto done;
         if (ret == 0)
             goto fail;
+        yang_profile_start(&tv);
         if ((ret = xml_bind_yang(h, xt, YB_MODULE, yspec1?yspec1:yspec0, 0, xerr)) < 0)
             goto done;
+        yang_profile_stop(YANG_PROF_BIND, &tv);
         if (ret == 0)
             goto fail;
     }
-    if (xml_sort_recurse(xt) < 0)
+    if (!bound || changed)
+        if (xml_sort_recurse(xt) < 0)
+            goto done;
+    /* Replay edits made since datastore file was written, see CLICON_XMLDB_JOURNAL */
+    if (xmldb_journal_replay(h, de, xt) < 0)
         goto done;
     /* Add default global values (to make xpath below include defaults) */
     if (xml_global_defaults(h, xt, NULL, "/", yspec0, 0) < 0)
@@ -979,7 +1620,7 @@ xmldb_get_cache(clixon_handle h,
         if ((de = xmldb_new(h, db)) == NULL)
             goto done;
     }
-    if ((xt = xmldb_cache_get(de)) == NULL){
+    if ((xt = xmldb_cache_read(de)) == NULL){
         if (xmldb_candidate_get(de)){
             clixon_err(OE_DB, 0, "Candidate db cache is NULL");
             goto done;
@@ -998,6 +1639,167 @@ xmldb_get_cache(clixon_handle h,
     goto done;
 }
 
+/*! Borrow datastore cache for reading, mark sub-trees matching xpath
+ *
+ * Zero-copy alternative to xmldb_get0 for callers that only read the result.
+ * The matching nodes are marked with XML_FLAG_MARK and their ancestors with XML_FLAG_CHANGE
+ * in the cache itself. Print the result with clixon_xml2cbuf_marked, then call
+ * xmldb_get_release before any datastore is changed.
+ * With-defaults is report-all, mask with-defaults when printing.
+ * Does not add system-only-config and does not disable NACM on empty config
+ * @param[in]  h      Clixon handle
+ * @param[in]  db     Name of datastore, eg "running"
+ * @param[in]  nsc    External XML namespace context, or NULL
+ * @param[in]  xpath  String with XPath syntax. or NULL for all
+ * @param[out] xtp    Top-level XML tree, direct cache pointer, do not modify
+ * @param[out] xvecp  Vector of matches, free with xmldb_get_release
+ * @param[out] xlenp  Length of xvec
+ * @param[out] genp   Generation of datastore when borrowed
+ * @param[out] xerr   XML error if retval is 0
+ * @retval     1      OK
+ * @retval     0      Parse OK but yang assigment not made (or only partial) and xerr set
+ * @retval    -1      Error
+ * @code
+ *   if ((ret = xmldb_get_borrow(h, "running", nsc, xpath, &xt, &xvec, &xlen, &gen, &xerr)) < 0)
+ *      err;
+ *   if (ret == 1){
+ *      clixon_xml2cbuf_marked(cb, xt, 0, 0, -1, 1, wdef);
+ *      xmldb_get_release(h, "running", xvec, xlen, gen);
+ *   }
+ * @endcode
+ * @see xmldb_get0  Copy version
+ */
+int
+xmldb_get_borrow(clixon_handle h,
+                 const char   *db,
+                 cvec         *nsc,
+                 const char   *xpath,
+                 cxobj       **xtp,
+                 cxobj      ***xvecp,
+                 size_t       *xlenp,
+                 uint64_t     *genp,
+                 cxobj       **xerr)
+{
+    int        retval = -1;
+    cxobj     *xt = NULL;
+    cxobj    **xvec = NULL;
+    size_t     xlen = 0;
+    db_elmnt  *de;
+    int        i;
+    int        ret;
+
+    clixon_debug(CLIXON_DBG_DATASTORE, "Borrow %s db", db);
+    if ((ret = xmldb_get_cache(h, db, &xt, xerr)) < 0)
+        goto done;
+    if (ret == 0)
+        goto fail;
+    if ((de = xmldb_find(h, db)) == NULL){
+        clixon_err(OE_DB, ENOENT, "No such datastore: %s", db);
+        goto done;
+    }
+    if (xpath_vec(xt, nsc, "%s", &xvec, &xlen, xpath?xpath:"/") < 0)
+        goto done;
+    for (i=0; i<xlen; i++){
+        xml_flag_set(xvec[i], XML_FLAG_MARK);
+        xml_apply_ancestor(xvec[i], (xml_applyfn_t*)xml_flag_set, (void*)XML_FLAG_CHANGE);
+    }
+    *xtp = xt;
+    *xvecp = xvec;
+    xvec = NULL;
+    *xlenp = xlen;
+    *genp = xmldb_generation_get(de);
+    retval = 1;
+ done:
+    if (xvec)
+        free(xvec);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! Release borrowed datastore cache, reset marks
+ *
+ * @param[in]  h      Clixon handle
+ * @param[in]  db     Name of datastore, eg "running"
+ * @param[in]  xvec   Vector of matches from xmldb_get_borrow, is freed
+ * @param[in]  xlen   Length of xvec
+ * @param[in]  gen    Generation from xmldb_get_borrow
+ * @retval     0      OK
+ * @retval    -1      Error, datastore changed while borrowed
+ * @see xmldb_get_borrow
+ */
+int
+xmldb_get_release(clixon_handle h,
+                  const char   *db,
+                  cxobj       **xvec,
+                  size_t        xlen,
+                  uint64_t      gen)
+{
+    int       retval = -1;
+    db_elmnt *de;
+    int       i;
+
+    if ((de = xmldb_find(h, db)) == NULL ||
+        xmldb_generation_get(de) != gen){
+        clixon_err(OE_DB, 0, "Datastore %s changed while borrowed", db);
+        goto done;
+    }
+    for (i=0; i<xlen; i++){
+        xml_flag_reset(xvec[i], XML_FLAG_MARK);
+        xml_apply_ancestor(xvec[i], (xml_applyfn_t*)xml_flag_reset, (void*)XML_FLAG_CHANGE);
+    }
+    retval = 0;
+ done:
+    if (xvec)
+        free(xvec);
+    return retval;
+}
+
+/*! Add system-only-config and disable NACM on empty config to a datastore get result
+ *
+ * @param[in]     h      Clixon handle
+ * @param[in]     db     Name of datastore, eg "running"
+ * @param[in]     nsc    External XML namespace context, or NULL
+ * @param[in]     xpath  String with XPath syntax. or NULL for all
+ * @param[in]     yspec  Top-level yang spec
+ * @param[in,out] xtp    Result XML tree (not cache)
+ * @retval        0      OK
+ * @retval       -1      Error
+ * @see xmldb_get_copy
+ */
+static int
+xmldb_get_post(clixon_handle h,
+               const char   *db,
+               cvec         *nsc,
+               const char   *xpath,
+               yang_stmt    *yspec,
+               cxobj       **xtp)
+{
+    int       retval = -1;
+    db_elmnt *de;
+
+    /* Unless a modified/locked candidate, add system-only-config data */
+    if ((de = xmldb_find(h, db)) != NULL){
+        if (xmldb_candidate_get(de) == 0 ||
+            (xmldb_modified_get(de) == 0 &&
+             xmldb_islocked(h, db) == 0)){
+            if (clicon_option_bool_id(h, CO_XMLDB_SYSTEM_ONLY_CONFIG))
+                if (xmldb_system_only_config(h, xpath?xpath:"/", nsc, xtp) < 0)
+                    goto done;
+        }
+    }
+    /* If empty NACM config, then disable NACM if loaded
+     */
+    if (clicon_option_bool_id(h, CO_NACM_DISABLED_ON_EMPTY)){
+        if (disable_nacm_on_empty(*xtp, yspec) < 0)
+            goto done;
+    }
+    retval = 0;
+ done:
+    return retval;
+}
+
 /*! Get a copy of datastore cache using xpath. return a set of matching sub-trees
  *
  * The function returns a minimal tree that includes all sub-trees that match
@@ -1008,6 +1810,9 @@ xmldb_get_cache(clixon_handle h,
  * @param[in]  yb     How to bind yang to XML top-level when parsing
  * @param[in]  nsc    External XML namespace context, or NULL
  * @param[in]  xpath  String with XPath syntax. or NULL for all
+ * @param[in]  skip   Do not copy elements with any of these flags, eg XML_FLAG_DEFAULT
+ * @param[in]  depth  Max depth of copied elements, or -1 for no limit, see xml_copy_depth
+ * @param[in]  wdef   With-defaults parameter used when printing, if depth is limited
  * @param[out] xret   Single return XML tree. Free with xml_free()
  * @param[out] xerr   XML error if retval is 0
  * @retval     1      OK
@@ -1016,12 +1821,15 @@ xmldb_get_cache(clixon_handle h,
  * @see xmldb_get_cache
  */
 static int
-xmldb_get_copy(clixon_handle h,
-               const char   *db,
-               cvec         *nsc,
-               const char   *xpath,
-               cxobj       **xret,
-               cxobj       **xerr)
+xmldb_get_copy(clixon_handle     h,
+               const char       *db,
+               cvec             *nsc,
+               const char       *xpath,
+               uint16_t          skip,
+               int32_t           depth,
+               withdefaults_type wdef,
+               cxobj           **xret,
+               cxobj           **xerr)
 {
     int        retval = -1;
     yang_stmt *yspec0;
@@ -1031,7 +1839,6 @@ xmldb_get_copy(clixon_handle h,
     size_t     xlen;
     int        i;
     cxobj     *x1t = NULL;
-    db_elmnt  *de;
     int        ret;
 
     clixon_debug(CLIXON_DBG_DATASTORE, "Get copy of %s db", db);
@@ -1071,12 +1878,12 @@ xmldb_get_copy(clixon_handle h,
          */
         for (i=0; i<xlen; i++){
             x0 = xvec[i];
-            if (xml_copy_from_bottom(x0t, x0, x1t) < 0) /* config */
+            if (xml_copy_from_bottom(x0t, x0, x1t, skip, depth, wdef) < 0) /* config */
                 goto done;
         }
     }
     else {
-        /* Iterate through the match vector
+        /* Iterate through the match vector, depth is not applied (superset)
          * For every node found in x0, mark the tree up to t1
          * XXX can we do this directly from xvec?
          */
@@ -1085,29 +1892,15 @@ xmldb_get_copy(clixon_handle h,
             xml_flag_set(x0, XML_FLAG_MARK);
             xml_apply_ancestor(x0, (xml_applyfn_t*)xml_flag_set, (void*)XML_FLAG_CHANGE);
         }
-        if (xml_copy_marked(x0t, x1t) < 0) /* config */
-            goto done;
-        if (xml_apply(x0t, CX_ELMNT, (xml_applyfn_t*)xml_flag_reset, (void*)(XML_FLAG_MARK|XML_FLAG_CHANGE)) < 0)
+        if (xml_copy_marked_skip(x0t, x1t, skip) < 0) /* config */
             goto done;
-        if (xml_apply(x1t, CX_ELMNT, (xml_applyfn_t*)xml_flag_reset, (void*)(XML_FLAG_MARK|XML_FLAG_CHANGE)) < 0)
+        if (xml_flag_reset_tree(x0t, XML_FLAG_MARK|XML_FLAG_CHANGE) < 0)
             goto done;
-    }
-    /* Unless a modified/locked candidate, add system-only-config data */
-    if ((de = xmldb_find(h, db)) != NULL){
-        if (xmldb_candidate_get(de) == 0 ||
-            (xmldb_modified_get(de) == 0 &&
-             xmldb_islocked(h, db) == 0)){
-            if (clicon_option_bool(h, "CLICON_XMLDB_SYSTEM_ONLY_CONFIG"))
-                if (xmldb_system_only_config(h, xpath?xpath:"/", nsc, &x1t) < 0)
-                    goto done;
-        }
-    }
-    /* If empty NACM config, then disable NACM if loaded
-     */
-    if (clicon_option_bool(h, "CLICON_NACM_DISABLED_ON_EMPTY")){
-        if (disable_nacm_on_empty(x1t, yspec0) < 0)
+        if (xml_flag_reset_tree(x1t, XML_FLAG_MARK|XML_FLAG_CHANGE) < 0)
             goto done;
     }
+    if (xmldb_get_post(h, db, nsc, xpath, yspec0, &x1t) < 0)
+        goto done;
     clixon_debug_xml(CLIXON_DBG_DATASTORE | CLIXON_DBG_DETAIL, x1t, "");
     *xret = x1t;
     retval = 1;
@@ -1213,12 +2006,13 @@ xmldb_get0(clixon_handle     h,
     int    ret;
 
     if (wdef != WITHDEFAULTS_EXPLICIT)
-        return xmldb_get_copy(h, db, nsc, xpath, xret, xerr);
-    if ((ret = xmldb_get_copy(h, db, nsc, xpath, &x, xerr)) < 0)
+        return xmldb_get_copy(h, db, nsc, xpath, 0x0, -1, wdef, xret, xerr);
+    /* Default nodes are not copied, only non-presence containers left empty are removed */
+    if ((ret = xmldb_get_copy(h, db, nsc, xpath, XML_FLAG_DEFAULT, -1, wdef, &x, xerr)) < 0)
         goto done;
     if (ret == 0)
         goto fail;
-    if (xml_default_nopresence(x, 2, 0) < 0)
+    if (xml_default_nopresence(x, 3, 0) < 0)
         goto done;
     *xret = x;
     x = NULL;
@@ -1231,3 +2025,99 @@ xmldb_get0(clixon_handle     h,
     retval = 0;
     goto done;
 }
+
+/*! Get content of datastore limited to a max depth of elements
+ *
+ * Same as xmldb_get0 with WITHDEFAULTS_REPORT_ALL, but only elements down to depth from
+ * the top of the tree are copied, together with the matches of xpath and their ancestors.
+ * Elements below depth are not copied, except a few that keep the output identical when
+ * the tree is printed with the same depth and wdef, see xml_copy_depth.
+ * Use when a reply is printed with a depth limit, eg RESTCONF depth, to avoid copying
+ * large sub-trees that are not printed.
+ * @param[in]  h      Clixon handle
+ * @param[in]  db     Name of datastore, eg "running"
+ * @param[in]  nsc    External XML namespace context, or NULL
+ * @param[in]  xpath  String with XPath syntax. or NULL for all
+ * @param[in]  depth  Max depth of copied elements from top, or -1 for no limit
+ * @param[in]  wdef   With-defaults parameter used when printing the tree
+ * @param[out] xret   Single return XML tree. Free with xml_free()
+ * @param[out] xerr   XML error if retval is 0
+ * @retval     1      OK
+ * @retval     0      Parse OK but yang assigment not made (or only partial) and xerr set
+ * @retval    -1      Error
+ * @note xpath is evaluated on the complete tree, but predicates referring to elements
+ *       below depth cannot be evaluated again on the returned tree
+ * @see xmldb_get0
+ */
+int
+xmldb_get_depth(clixon_handle     h,
+                const char       *db,
+                cvec             *nsc,
+                const char       *xpath,
+                int32_t           depth,
+                withdefaults_type wdef,
+                cxobj           **xret,
+                cxobj           **xerr)
+{
+    return xmldb_get_copy(h, db, nsc, xpath, 0x0, depth, wdef, xret, xerr);
+}
+
+/*! Get complete content of datastore and take over its cache instead of copying it
+ *
+ * Same result as xmldb_get0 with xpath "/", but avoids a full copy of large datastores
+ * that are read once, eg startup. The datastore cache is detached and the
+ * datastore is read from file on next access.
+ * If the cache cannot be detached, eg a candidate, a copy is made.
+ * @param[in]  h      Clixon handle
+ * @param[in]  db     Name of datastore, eg "startup"
+ * @param[out] xtp    XML tree. Free with xml_free()
+ * @param[out] xerr   XML error if retval is 0
+ * @retval     1      OK
+ * @retval     0      Parse OK but yang assigment not made (or only partial) and xerr set
+ * @retval    -1      Error
+ * @see xmldb_get0
+ * @see xmldb_cache_detach
+ */
+int
+xmldb_get_detach(clixon_handle h,
+                 const char   *db,
+                 cxobj       **xtp,
+                 cxobj       **xerr)
+{
+    int        retval = -1;
+    yang_stmt *yspec;
+    cxobj     *xt = NULL;
+    db_elmnt  *de;
+    int        ret;
+
+    clixon_debug(CLIXON_DBG_DATASTORE, "Detach %s db", db);
+    if ((yspec = clicon_dbspec_yang(h)) == NULL){
+        clixon_err(OE_YANG, ENOENT, "No yang spec");
+        goto done;
+    }
+    if ((ret = xmldb_get_cache(h, db, &xt, xerr)) < 0)
+        goto done;
+    if (ret == 0)
+        goto fail;
+    xt = NULL;
+    if ((de = xmldb_find(h, db)) == NULL){
+        clixon_err(OE_DB, ENOENT, "No such datastore: %s", db);
+        goto done;
+    }
+    if (xmldb_cache_detach(h, de, &xt) < 0)
+        goto done;
+    if (xt == NULL)
+        return xmldb_get_copy(h, db, NULL, "/", 0x0, -1, WITHDEFAULTS_REPORT_ALL, xtp, xerr);
+    if (xmldb_get_post(h, db, NULL, "/", yspec, &xt) < 0)
+        goto done;
+    *xtp = xt;
+    xt = NULL;
+    retval = 1;
+ done:
+    if (xt)
+        xml_free(xt);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
@@ -67,6 +67,7 @@
 #include "clixon_err.h"
 #include "clixon_log.h"
 #include "clixon_debug.h"
+#include "clixon_trace.h"
 #include "clixon_file.h"
 #include "clixon_xml_sort.h"
 #include "clixon_options.h"
@@ -74,8 +75,9 @@
 #include "clixon_xpath_ctx.h"
 #include "clixon_xpath.h"
 #include "clixon_json.h"
-#include "clixon_nacm.h"
 #include "clixon_netconf_lib.h"
+#include "clixon_nacm.h"
+#include "clixon_xml_bin.h"
 #include "clixon_yang_type.h"
 #include "clixon_yang_module.h"
 #include "clixon_yang_schema_mount.h"
@@ -84,6 +86,7 @@
 #include "clixon_xml_bind.h"
 #include "clixon_xml_default.h"
 #include "clixon_xml_map.h"
+#include "clixon_xml_diff.h"
 #include "clixon_datastore.h"
 #include "clixon_datastore_write.h"
 #include "clixon_datastore_read.h"
@@ -98,6 +101,7 @@ struct xmldb_multi_write_arg {
     int               mw_pretty;
     withdefaults_type mw_wdef;
     enum format_enum  mw_format;
+    int               mw_compress; /* zstd compression level, 0 is no compression */
 };
 
 /*! Given an attribute name and its expected namespace, find its value
@@ -566,6 +570,241 @@ choice_other_match(cxobj              *x0,
     goto done;
 }
 
+static int text_modify(clixon_handle h, cxobj *x0, cxobj *x0p, cxobj *x0t, cxobj *x1, cxobj *x1t,
+                       yang_stmt *y0, enum operation_type op, const char *username,
+                       cxobj *xnacm, int permit, cbuf *cbret);
+
+/*! Check if YANG list entries can be copied as-is in a bulk merge
+ *
+ * Not if the entries contain choices, anydata or bodies that need trimming or namespace checks
+ * @param[in]  ys   YANG list or container
+ * @retval     1    Yes
+ * @retval     0    No
+ * @retval    -1    Error
+ */
+static int
+text_modify_bulk_yang(yang_stmt *ys)
+{
+    yang_stmt *yc;
+    yang_stmt *yrestype;
+    char      *restype;
+    int        inext;
+    int        ret;
+
+    inext = 0;
+    while ((yc = yn_iter(ys, &inext)) != NULL) {
+        switch (yang_keyword_get(yc)){
+        case Y_LEAF:
+        case Y_LEAF_LIST:
+            yrestype = NULL;
+            if (yang_type_get(yc, NULL, &yrestype, NULL, NULL, NULL, NULL, NULL) < 0)
+                return -1;
+            if (yrestype == NULL)
+                return 0;
+            restype = yang_argument_get(yrestype);
+            if (strcmp(restype, "identityref") == 0 ||
+                strcmp(restype, "enumeration") == 0 ||
+                strcmp(restype, "bits") == 0)
+                return 0;
+            break;
+        case Y_CONTAINER:
+        case Y_LIST:
+            if ((ret = text_modify_bulk_yang(yc)) <= 0)
+                return ret;
+            break;
+        case Y_CHOICE:
+        case Y_CASE:
+        case Y_ANYXML:
+        case Y_ANYDATA:
+            return 0;
+        default:
+            break;
+        }
+    }
+    return 1;
+}
+
+/*! Check if XML subtree of a modification can be copied as-is in a bulk merge
+ *
+ * All nodes are bound to YANG, unprefixed and without attributes, ie no operations and
+ * no namespace declarations
+ * @param[in]  x    XML node of modification tree
+ * @retval     1    Yes
+ * @retval     0    No
+ */
+static int
+text_modify_bulk_xml(cxobj *x)
+{
+    cxobj *xc;
+
+    if (xml_spec(x) == NULL ||
+        xml_prefix(x) != NULL ||
+        xml_child_nr_type(x, CX_ATTR) != 0)
+        return 0;
+    xc = NULL;
+    while ((xc = xml_child_each(x, xc, CX_ELMNT)) != NULL)
+        if (text_modify_bulk_xml(xc) == 0)
+            return 0;
+    return 1;
+}
+
+/*! Merge a large sorted list of a modification in one pass over the base list
+ *
+ * Applies if all children of x1 are entries of the same ordered-by system list, at least
+ * CLICON_XMLDB_MODIFY_BULK of them, sorted on keys and eligible according to text_modify_bulk_yang
+ * and text_modify_bulk_xml.
+ * New entries are copied from x1 and inserted at the merge position with one NACM check per
+ * entry, existing entries are merged with text_modify.
+ * "when" conditions of new entries are not checked here but at validation.
+ * @param[in]  h        Clixon handle
+ * @param[in]  x0       Base xml tree, parent of list entries
+ * @param[in]  x0p      Parent of x0
+ * @param[in]  x0t      Top level of existing tree, eg needed for NACM rules
+ * @param[in]  x1       XML tree which modifies base, parent of list entries
+ * @param[in]  x1t      Request root node (nacm needs this)
+ * @param[in]  username User name of requestor for nacm
+ * @param[in]  xnacm    NACM XML tree (only if !permit)
+ * @param[in]  permit   If set, no NACM tests using xnacm required
+ * @param[out] cbret    Initialized cligen buffer. Contains return XML if retval is 0.
+ * @retval     2        Not applicable, use regular merge
+ * @retval     1        OK
+ * @retval     0        Failed (cbret set)
+ * @retval    -1        Error
+ * @see text_modify
+ */
+static int
+text_modify_bulk(clixon_handle h,
+                 cxobj        *x0,
+                 cxobj        *x0p,
+                 cxobj        *x0t,
+                 cxobj        *x1,
+                 cxobj        *x1t,
+                 const char   *username,
+                 cxobj        *xnacm,
+                 int           permit,
+                 cbuf         *cbret)
+{
+    int        retval = -1;
+    yang_stmt *yc;
+    cxobj     *x1c;
+    cxobj     *x1prev;
+    cxobj     *x0c;
+    cxobj     *xd = NULL;
+    cg_var    *cvi;
+    char      *ns = NULL;
+    char      *ns0 = NULL;
+    char      *myns;
+    int        lo;
+    int        hi;
+    int        k;
+    int        n;
+    int        cmp;
+    int        ret;
+
+    if ((n = clicon_option_int_id(h, CO_XMLDB_MODIFY_BULK)) <= 0 ||
+        xml_child_nr_type(x1, CX_ELMNT) < n ||
+        clicon_option_bool_id(h, CO_YANG_SCHEMA_MOUNT))
+        goto skip;
+    if ((x1c = xml_child_each(x1, NULL, CX_ELMNT)) == NULL ||
+        (yc = xml_spec(x1c)) == NULL ||
+        yang_keyword_get(yc) != Y_LIST ||
+        yang_find(yc, Y_ORDERED_BY, "user") != NULL ||
+        yang_config_ancestor(yc) == 0)
+        goto skip;
+    if ((ret = text_modify_bulk_yang(yc)) < 0)
+        goto done;
+    if (ret == 0)
+        goto skip;
+    /* Entries inherit the default namespace of x1 and are inserted without declarations */
+    myns = yang_find_mynamespace(yc);
+    if (xml2ns(x1c, NULL, &ns) < 0)
+        goto done;
+    if (xml2ns(x0, NULL, &ns0) < 0)
+        goto done;
+    if (ns0 == NULL && xml_parent(x0) == NULL &&
+        xml2ns(x0p, NULL, &ns0) < 0)
+        goto done;
+    if (myns == NULL || ns == NULL || ns0 == NULL ||
+        strcmp(myns, ns) != 0 || strcmp(myns, ns0) != 0)
+        goto skip;
+    /* All entries of same list, with keys, and strictly sorted */
+    x1prev = NULL;
+    x1c = NULL;
+    while ((x1c = xml_child_each(x1, x1c, CX_ELMNT)) != NULL) {
+        if (xml_spec(x1c) != yc ||
+            text_modify_bulk_xml(x1c) == 0)
+            goto skip;
+        cvi = NULL;
+        while ((cvi = cvec_each(yang_cvec_get(yc), cvi)) != NULL)
+            if (xml_find_type(x1c, NULL, cv_string_get(cvi), CX_ELMNT) == NULL)
+                goto skip;
+        if (x1prev && xml_cmp(x1prev, x1c, 0, 0, NULL) >= 0)
+            goto skip;
+        x1prev = x1c;
+    }
+    /* Existing entries of the list are contiguous and sorted in x0 */
+    n = xml_child_nr(x0);
+    for (lo=0; lo<n; lo++)
+        if (xml_spec(xml_child_i(x0, lo)) == yc)
+            break;
+    for (hi=lo; hi<n; hi++)
+        if (xml_spec(xml_child_i(x0, hi)) != yc)
+            break;
+    /* Merge join */
+    k = lo;
+    x1c = NULL;
+    while ((x1c = xml_child_each(x1, x1c, CX_ELMNT)) != NULL) {
+        cmp = 1;
+        while (k < hi && (cmp = xml_cmp(xml_child_i(x0, k), x1c, 0, 0, NULL)) < 0)
+            k++;
+        if (k < hi && cmp == 0){
+            x0c = xml_child_i(x0, k++);
+            if ((ret = text_modify(h, x0c, x0, x0t, x1c, x1t, yc, OP_MERGE,
+                                   username, xnacm, permit, cbret)) < 0)
+                goto done;
+            if (ret == 0)
+                goto fail;
+            continue;
+        }
+        if (!permit && xnacm){
+            if ((ret = nacm_datanode_write(h, x1c, x1t, NACM_CREATE, username, xnacm, cbret)) < 0)
+                goto done;
+            if (ret == 0)
+                goto fail;
+        }
+        if ((xd = xml_dup(x1c)) == NULL)
+            goto done;
+        xml_apply0(xd, CX_ELMNT, (xml_applyfn_t*)xml_flag_set, (void*)XML_FLAG_ADD);
+        if (lo == hi){
+            /* First entry of list: find position by yang order */
+            if (xml_insert(x0, xd, INS_LAST, NULL, NULL) < 0)
+                goto done;
+            for (lo=0; xml_child_i(x0, lo) != xd; lo++);
+            hi = k = lo;
+        }
+        else{
+            if (xml_child_insert_pos(x0, xd, k) < 0)
+                goto done;
+            xml_parent_set(xd, x0);
+            nscache_clear(xd);
+        }
+        xd = NULL;
+        k++;
+        hi++;
+    }
+    retval = 1;
+ done:
+    if (xd)
+        xml_free(xd);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+ skip:
+    retval = 2;
+    goto done;
+}
+
 /*! Modify a base tree x0 with x1 with yang spec y according to operation op
  *
  * @param[in]  h        Clixon handle
@@ -1000,6 +1239,15 @@ text_modify(clixon_handle       h,
                 if (op==OP_NONE)
                     xml_flag_set(x0, XML_FLAG_NONE); /* Mark for potential deletion */
             }
+            if (op == OP_MERGE){
+                if ((ret = text_modify_bulk(h, x0, x0p, x0t, x1, x1t,
+                                            username, xnacm, permit, cbret)) < 0)
+                    goto done;
+                if (ret == 0)
+                    goto fail;
+                if (ret == 1)
+                    goto merged;
+            }
             /* First pass: Loop through children of the x1 modification tree
              * collect matching nodes from x0 in x0vec (no changes to x0 children)
              */
@@ -1016,10 +1264,10 @@ text_modify(clixon_handle       h,
                 if (xml2ns(x1c, xml_prefix(x1c), &ns) < 0)
                     goto done;
                 if ((yc = yang_find_datanode_ns(y0, x1cname, ns)) == NULL){
-                    if (clicon_option_bool(h, "CLICON_YANG_SCHEMA_MOUNT"))
+                    if (clicon_option_bool_id(h, CO_YANG_SCHEMA_MOUNT))
                         yc = xml_spec(x1c);
                     if (yc == NULL){
-                        if (clicon_option_bool(h, "CLICON_YANG_UNKNOWN_ANYDATA") == 1){
+                        if (clicon_option_bool_id(h, CO_YANG_UNKNOWN_ANYDATA) == 1){
                             /* Add dummy Y_ANYDATA yang stmt, see ysp_add */
                             if (NULL == (yc = yang_anydata_add(y0, x1cname)))
                                 goto done;
@@ -1076,10 +1324,10 @@ text_modify(clixon_handle       h,
                 if (xml2ns(x1c, xml_prefix(x1c), &ns) < 0)
                     goto done;
                 if ((yc = yang_find_datanode_ns(y0, x1cname, ns)) == NULL) {
-                    if (clicon_option_bool(h, "CLICON_YANG_SCHEMA_MOUNT"))
+                    if (clicon_option_bool_id(h, CO_YANG_SCHEMA_MOUNT))
                         yc = xml_spec(x1c);
                 }
-                if (clicon_option_bool(h, "CLICON_YANG_SCHEMA_MOUNT")){
+                if (clicon_option_bool_id(h, CO_YANG_SCHEMA_MOUNT)){
                     /* Check if xc is unresolved mountpoint, ie no yang mount binding yet */
                     if ((ismount = xml_yang_mount_get(h, x1c, NULL, NULL, &mount_yspec)) < 0)
                         goto done;
@@ -1102,6 +1350,7 @@ text_modify(clixon_handle       h,
                 if (ret == 0)
                     goto fail;
             }
+        merged:
             if (changed){
                 /* Add to parent unless tree is 100% none */
                 if (xml_tree_prune_flagged_sub(x0, XML_FLAG_NONE, 0, NULL) < 0)
@@ -1294,7 +1543,7 @@ text_modify_top(clixon_handle       h,
             yc = yang_find_datanode(ymod, x1cname);
         if (yc == NULL){
             if (ymod != NULL &&
-                clicon_option_bool(h, "CLICON_YANG_UNKNOWN_ANYDATA") == 1){
+                clicon_option_bool_id(h, CO_YANG_UNKNOWN_ANYDATA) == 1){
                 /* Add dummy Y_ANYDATA yang stmt, see ysp_add */
                 if (NULL == (yc = yang_anydata_add(ymod, x1cname)))
                     goto done;
@@ -1378,6 +1627,676 @@ xml_mark_cache_dirty(cxobj *x,
     return 2;
 }
 
+/*! Is datastore journal enabled?
+ *
+ * Journal is not supported with split datastores, system-only config or deferred writes
+ * @param[in]  h   Clixon handle
+ * @retval     1   Enabled
+ * @retval     0   Disabled
+ * @see CLICON_XMLDB_JOURNAL
+ */
+int
+xmldb_journal_enabled(clixon_handle h)
+{
+    return clicon_option_int(h, "CLICON_XMLDB_JOURNAL") > 0 &&
+        !clicon_option_bool_id(h, CO_XMLDB_MULTI) &&
+        !xmldb_persist_deferred(h) &&
+        !clicon_option_bool_id(h, CO_XMLDB_SYSTEM_ONLY_CONFIG);
+}
+
+/*! Append a record to the journal of a datastore, write full datastore if journal is full
+ *
+ * A record is an edit-config <config> tree preceded by its length in bytes on a separate
+ * line. The record is synced to disk before return.
+ * If the datastore file does not exist, or if the journal has CLICON_XMLDB_JOURNAL records, the
+ * cache is instead written to the datastore file and the journal is removed.
+ * @param[in]  h   Clixon handle
+ * @param[in]  db  Datastore
+ * @param[in]  cb  Journal record
+ * @retval     0   OK
+ * @retval    -1   Error
+ * @see xmldb_journal_replay
+ */
+int
+xmldb_journal_append(clixon_handle h,
+                     const char   *db,
+                     cbuf         *cb)
+{
+    int       retval = -1;
+    db_elmnt *de;
+    char     *dbfile = NULL;
+    char     *journal = NULL;
+    FILE     *f = NULL;
+    uint32_t  nr;
+
+    if ((de = xmldb_find(h, db)) == NULL){
+        clixon_err(OE_XML, 0, "Datastore %s not found", db);
+        goto done;
+    }
+    if (xmldb_db2file(h, db, &dbfile) < 0)
+        goto done;
+    nr = xmldb_journal_nr_get(de);
+    if (access(dbfile, F_OK) < 0 ||
+        nr >= clicon_option_int(h, "CLICON_XMLDB_JOURNAL")){
+        if (xmldb_write_cache2file(h, db) < 0)
+            goto done;
+        goto ok;
+    }
+    if (xmldb_db2journal(h, db, &journal) < 0)
+        goto done;
+    if ((f = fopen(journal, "a")) == NULL){
+        clixon_err(OE_CFG, errno, "fopen(%s)", journal);
+        goto done;
+    }
+    if (fprintf(f, "%zu\n%s", cbuf_len(cb), cbuf_get(cb)) < 0 ||
+        fflush(f) != 0 ||
+        fsync(fileno(f)) < 0){
+        clixon_err(OE_UNIX, errno, "write(%s)", journal);
+        goto done;
+    }
+    xmldb_journal_nr_set(de, nr + 1);
+ ok:
+    retval = 0;
+ done:
+    if (f)
+        fclose(f);
+    if (dbfile)
+        free(dbfile);
+    if (journal)
+        free(journal);
+    return retval;
+}
+
+/*! Rewrite create and delete operations as merge and remove so that a journal record can be replayed twice
+ *
+ * A record may be replayed on a datastore file that already contains it, if the
+ * journal could not be removed after a full write.
+ * @param[in]  x    XML node
+ * @param[in]  arg  Not used
+ * @retval     0    OK, continue
+ * @retval    -1    Error
+ */
+static int
+xmldb_journal_idempotent(cxobj *x,
+                         void  *arg)
+{
+    int    retval = -1;
+    cxobj *xa = NULL;
+    char  *ns;
+    char  *val;
+
+    while ((xa = xml_child_each(x, xa, CX_ATTR)) != NULL) {
+        if (strcmp(xml_name(xa), "operation") != 0)
+            continue;
+        ns = NULL;
+        if (xml2ns(x, xml_prefix(xa), &ns) < 0)
+            goto done;
+        if (ns == NULL || strcmp(ns, NETCONF_BASE_NAMESPACE) != 0)
+            continue;
+        if ((val = xml_value(xa)) == NULL)
+            continue;
+        if (strcmp(val, "create") == 0){
+            if (xml_value_set(xa, "merge") < 0)
+                goto done;
+        }
+        else if (strcmp(val, "delete") == 0){
+            if (xml_value_set(xa, "remove") < 0)
+                goto done;
+        }
+    }
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Make a journal record of an edit made by xmldb_put
+ *
+ * Must be called before the edit is made since it strips operation attributes
+ * @param[in]  x1   Edit with top-level <config>
+ * @param[in]  op   Top-level operation
+ * @param[out] cbp  Journal record, free with cbuf_free
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+xmldb_journal_edit(cxobj              *x1,
+                   enum operation_type op,
+                   cbuf              **cbp)
+{
+    int    retval = -1;
+    cxobj *xr = NULL;
+    cbuf  *cb = NULL;
+    cvec  *nsc = NULL;
+
+    if ((xr = xml_dup(x1)) == NULL)
+        goto done;
+    /* Namespaces may be declared in enclosing rpc */
+    if (xml_nsctx_node(x1, &nsc) < 0)
+        goto done;
+    if (xmlns_set_all(xr, nsc) < 0)
+        goto done;
+    if (xml_sort(xr) < 0)
+        goto done;
+    if (op != OP_MERGE &&
+        xml_find_type(xr, NULL, "operation", CX_ATTR) == NULL &&
+        xml_find_type(xr, NETCONF_BASE_PREFIX, "operation", CX_ATTR) == NULL){
+        if (xml_add_attr(xr, "operation", xml_operation2str(op),
+                         NETCONF_BASE_PREFIX, NETCONF_BASE_NAMESPACE) == NULL)
+            goto done;
+    }
+    if (xml_apply0(xr, CX_ELMNT, xmldb_journal_idempotent, NULL) < 0)
+        goto done;
+    if ((cb = cbuf_new()) == NULL){
+        clixon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    if (clixon_xml2cbuf(cb, xr, 0, 0, NULL, -1, 0) < 0)
+        goto done;
+    *cbp = cb;
+    cb = NULL;
+    retval = 0;
+ done:
+    if (nsc)
+        cvec_free(nsc);
+    if (cb)
+        cbuf_free(cb);
+    if (xr)
+        xml_free(xr);
+    return retval;
+}
+
+/* Path from datastore top to a node in the new tree when comparing with the old.
+ * The corresponding node in the journal record is created on demand
+ */
+struct journal_path {
+    cxobj               *jp_x;    /* Node in new tree */
+    cxobj               *jp_xe;   /* Corresponding node in journal record, or NULL */
+    struct journal_path *jp_up;   /* Parent, NULL if top */
+};
+
+/*! Add namespace declarations of original node to node in journal record
+ *
+ * @param[in]  x   Original XML node in datastore
+ * @param[in]  xe  Copy of x in journal record
+ * @retval     0   OK
+ * @retval    -1   Error
+ */
+static int
+journal_node_ns(cxobj *x,
+                cxobj *xe)
+{
+    int     retval = -1;
+    cvec   *nsc = NULL;
+    cg_var *cv = NULL;
+    char   *pf;
+    char   *ns;
+
+    if (xml_nsctx_node(x, &nsc) < 0)
+        goto done;
+    while ((cv = cvec_each(nsc, cv)) != NULL){
+        pf = cv_name_get(cv);
+        /* Skip if already declared or if same declaration is inherited */
+        if (pf != NULL)
+            ns = xml_find_type_value(xe, "xmlns", pf, CX_ATTR);
+        else
+            ns = xml_find_type_value(xe, NULL, "xmlns", CX_ATTR);
+        if (ns)
+            continue;
+        if (xml2ns(xml_parent(xe), pf, &ns) < 0)
+            goto done;
+        if (ns && cv_string_get(cv) && strcmp(ns, cv_string_get(cv)) == 0)
+            continue;
+        if (xmlns_set(xe, pf, cv_string_get(cv)) < 0)
+            goto done;
+    }
+    if (xml_sort(xe) < 0)
+        goto done;
+    retval = 0;
+ done:
+    if (nsc)
+        cvec_free(nsc);
+    return retval;
+}
+
+/*! Copy a node one level only, including attributes and list keys, to journal record
+ *
+ * @param[in]  x    XML node in datastore
+ * @param[in]  xep  Parent in journal record
+ * @param[out] xep  Created node in journal record
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+journal_node_copy(cxobj  *x,
+                  cxobj  *xep,
+                  cxobj **xp)
+{
+    int        retval = -1;
+    cxobj     *xe;
+    cxobj     *xa;
+    cxobj     *xk;
+    cxobj     *xc;
+    yang_stmt *y;
+    cg_var    *cvi;
+
+    if ((xe = xml_new(xml_name(x), xep, CX_ELMNT)) == NULL)
+        goto done;
+    if (xml_copy_one(x, xe) < 0)
+        goto done;
+    xa = NULL;
+    while ((xa = xml_child_each(x, xa, CX_ATTR)) != NULL) {
+        if ((xc = xml_new(xml_name(xa), xe, CX_ATTR)) == NULL)
+            goto done;
+        if (xml_copy_one(xa, xc) < 0)
+            goto done;
+    }
+    if ((y = xml_spec(x)) != NULL && yang_keyword_get(y) == Y_LIST){
+        cvi = NULL;
+        while ((cvi = cvec_each(yang_cvec_get(y), cvi)) != NULL) {
+            if ((xk = xml_find_type(x, NULL, cv_string_get(cvi), CX_ELMNT)) == NULL)
+                continue;
+            if ((xc = xml_dup(xk)) == NULL)
+                goto done;
+            if (xml_addsub(xe, xc) < 0)
+                goto done;
+        }
+    }
+    if (journal_node_ns(x, xe) < 0)
+        goto done;
+    *xp = xe;
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Get node in journal record corresponding to path, create it and its ancestors if needed
+ *
+ * @param[in]  jp   Path
+ * @param[out] xep  Node in journal record
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+journal_path_get(struct journal_path *jp,
+                 cxobj              **xep)
+{
+    int    retval = -1;
+    cxobj *xp;
+
+    if (jp->jp_xe == NULL){
+        if (journal_path_get(jp->jp_up, &xp) < 0)
+            goto done;
+        if (journal_node_copy(jp->jp_x, xp, &jp->jp_xe) < 0)
+            goto done;
+    }
+    *xep = jp->jp_xe;
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Add a complete copy of a datastore node to journal record
+ *
+ * Default values are not copied, they are added when the journal is replayed
+ * @param[in]  x    XML node in datastore
+ * @param[in]  jp   Path of parent
+ * @param[in]  op   Operation attribute, or NULL for merge
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+journal_node_dup(cxobj               *x,
+                 struct journal_path *jp,
+                 const char          *op)
+{
+    int    retval = -1;
+    cxobj *xep;
+    cxobj *xe;
+
+    if (journal_path_get(jp, &xep) < 0)
+        goto done;
+    if ((xe = xml_dup(x)) == NULL)
+        goto done;
+    if (xml_addsub(xep, xe) < 0)
+        goto done;
+    if (xml_tree_prune_flags(xe, XML_FLAG_DEFAULT, XML_FLAG_DEFAULT) < 0)
+        goto done;
+    if (journal_node_ns(x, xe) < 0)
+        goto done;
+    if (op && xml_add_attr(xe, "operation", op, NETCONF_BASE_PREFIX, NULL) == NULL)
+        goto done;
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Add removal of a datastore node to journal record
+ *
+ * @param[in]  x    XML node in old datastore
+ * @param[in]  jp   Path of parent
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+journal_node_remove(cxobj               *x,
+                    struct journal_path *jp)
+{
+    int        retval = -1;
+    yang_stmt *y;
+    cxobj     *xep;
+    cxobj     *xe;
+
+    if ((y = xml_spec(x)) == NULL ||
+        yang_keyword_get(y) == Y_LEAF ||
+        yang_keyword_get(y) == Y_LEAF_LIST){
+        if (journal_node_dup(x, jp, "remove") < 0)
+            goto done;
+        goto ok;
+    }
+    if (journal_path_get(jp, &xep) < 0)
+        goto done;
+    if (journal_node_copy(x, xep, &xe) < 0)
+        goto done;
+    if (xml_add_attr(xe, "operation", "remove", NETCONF_BASE_PREFIX, NULL) == NULL)
+        goto done;
+ ok:
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Get next child of datastore node, skip default values
+ */
+static cxobj *
+journal_child_next(cxobj *x,
+                   cxobj *xc)
+{
+    while ((xc = xml_child_each(x, xc, CX_ELMNT)) != NULL)
+        if (!xml_flag(xc, XML_FLAG_DEFAULT))
+            break;
+    return xc;
+}
+
+/*! Add differences between old and new datastore node to journal record, recursive
+ *
+ * Same algorithm as xml_diff but nodes are not skipped (eg ignore-compare)
+ * @param[in]  x0   Old XML node
+ * @param[in]  jp   Path of corresponding new XML node
+ * @retval     1    OK
+ * @retval     0    Difference cannot be recorded, full write is needed
+ * @retval    -1    Error
+ * @see xml_diff1
+ */
+static int
+journal_diff(cxobj               *x0,
+             struct journal_path *jp)
+{
+    int                 retval = -1;
+    cxobj              *x1 = jp->jp_x;
+    cxobj              *x0c;
+    cxobj              *x1c;
+    yang_stmt          *y0c;
+    yang_stmt          *y1c;
+    enum rfc_6020       keyw;
+    struct journal_path jpc;
+    char               *b0;
+    char               *b1;
+    int                 eq;
+    int                 ret;
+
+    x0c = journal_child_next(x0, NULL);
+    x1c = journal_child_next(x1, NULL);
+    while (x0c != NULL || x1c != NULL){
+        if (x0c == NULL)
+            eq = 1;
+        else if (x1c == NULL)
+            eq = -1;
+        else
+            eq = xml_cmp(x0c, x1c, 0, 0, NULL);
+        y0c = x0c ? xml_spec(x0c) : NULL;
+        y1c = x1c ? xml_spec(x1c) : NULL;
+        /* Ordered-by user list has changed order or members, replace parent */
+        if (eq && y0c && y0c == y1c && yang_find(y0c, Y_ORDERED_BY, "user")){
+            if (jp->jp_up == NULL)
+                goto full;
+            if (jp->jp_xe){
+                xml_purge(jp->jp_xe);
+                jp->jp_xe = NULL;
+            }
+            if (journal_node_dup(x1, jp->jp_up, "replace") < 0)
+                goto done;
+            break;
+        }
+        if (eq < 0){
+            if (journal_node_remove(x0c, jp) < 0)
+                goto done;
+            x0c = journal_child_next(x0, x0c);
+            continue;
+        }
+        else if (eq > 0){
+            if (journal_node_dup(x1c, jp, NULL) < 0)
+                goto done;
+            x1c = journal_child_next(x1, x1c);
+            continue;
+        }
+        if (y0c != y1c){ /* choice */
+            if (journal_node_remove(x0c, jp) < 0)
+                goto done;
+            if (journal_node_dup(x1c, jp, NULL) < 0)
+                goto done;
+        }
+        else if (y0c == NULL ||
+                 (keyw = yang_keyword_get(y0c)) == Y_ANYDATA || keyw == Y_ANYXML){
+            if (xml_tree_equal(x0c, x1c) != 0)
+                if (journal_node_dup(x1c, jp, "replace") < 0)
+                    goto done;
+        }
+        else if (keyw == Y_LEAF){
+            b0 = xml_body(x0c);
+            b1 = xml_body(x1c);
+            if ((b0 == NULL) != (b1 == NULL) ||
+                (b0 && b1 && strcmp(b0, b1) != 0))
+                if (journal_node_dup(x1c, jp, NULL) < 0)
+                    goto done;
+        }
+        else if (keyw != Y_LEAF_LIST){
+            jpc.jp_x = x1c;
+            jpc.jp_xe = NULL;
+            jpc.jp_up = jp;
+            if ((ret = journal_diff(x0c, &jpc)) < 0)
+                goto done;
+            if (ret == 0)
+                goto full;
+        }
+        x0c = journal_child_next(x0, x0c);
+        x1c = journal_child_next(x1, x1c);
+    }
+    retval = 1;
+ done:
+    return retval;
+ full:
+    retval = 0;
+    goto done;
+}
+
+/*! Make a journal record of the difference between old and new datastore trees
+ *
+ * Used when copying a datastore, eg on commit, so that only the difference is
+ * appended to the journal of the destination instead of copying the whole file.
+ * @param[in]  h    Clixon handle
+ * @param[in]  x0   Old datastore cache
+ * @param[in]  x1   New datastore cache
+ * @param[out] cbp  Journal record, or NULL if no difference. Free with cbuf_free
+ * @retval     1    OK
+ * @retval     0    Difference cannot be recorded, full write is needed
+ * @retval    -1    Error
+ * @see xmldb_journal_append
+ */
+int
+xmldb_journal_diff(clixon_handle h,
+                   cxobj        *x0,
+                   cxobj        *x1,
+                   cbuf        **cbp)
+{
+    int                 retval = -1;
+    struct journal_path jp = {0,};
+    cbuf               *cb = NULL;
+    int                 ret;
+
+    *cbp = NULL;
+    jp.jp_x = x1;
+    if ((jp.jp_xe = xml_new(NETCONF_INPUT_CONFIG, NULL, CX_ELMNT)) == NULL)
+        goto done;
+    if (xmlns_set(jp.jp_xe, NETCONF_BASE_PREFIX, NETCONF_BASE_NAMESPACE) < 0)
+        goto done;
+    if ((ret = journal_diff(x0, &jp)) < 0)
+        goto done;
+    if (ret == 0)
+        goto full;
+    if (xml_child_nr_type(jp.jp_xe, CX_ELMNT) == 0)
+        goto ok;
+    if ((cb = cbuf_new()) == NULL){
+        clixon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    if (clixon_xml2cbuf(cb, jp.jp_xe, 0, 0, NULL, -1, 0) < 0)
+        goto done;
+    *cbp = cb;
+    cb = NULL;
+ ok:
+    retval = 1;
+ done:
+    if (cb)
+        cbuf_free(cb);
+    if (jp.jp_xe)
+        xml_free(jp.jp_xe);
+    return retval;
+ full:
+    retval = 0;
+    goto done;
+}
+
+/*! Replay journal of datastore on the tree read from the datastore file
+ *
+ * A partially written record at the end of the journal, eg after a crash, is
+ * skipped and truncated.
+ * @param[in]  h    Clixon handle
+ * @param[in]  de   Datastore
+ * @param[in]  xt   XML tree read from the datastore file, yang bound
+ * @retval     0    OK
+ * @retval    -1    Error
+ * @see xmldb_journal_append
+ */
+int
+xmldb_journal_replay(clixon_handle h,
+                     db_elmnt     *de,
+                     cxobj        *xt)
+{
+    int        retval = -1;
+    char      *db;
+    char      *journal = NULL;
+    FILE      *f = NULL;
+    yang_stmt *yspec;
+    char      *buf = NULL;
+    size_t     len;
+    long       pos = 0;
+    uint32_t   nr = 0;
+    int        torn = 0;
+    cxobj     *xr = NULL;
+    cxobj     *xerr = NULL;
+    cbuf      *cbret = NULL;
+    int        ret;
+
+    db = xmldb_name_get(de);
+    if (xmldb_db2journal(h, db, &journal) < 0)
+        goto done;
+    if ((f = fopen(journal, "r")) == NULL){
+        if (errno == ENOENT)
+            goto ok;
+        clixon_err(OE_UNIX, errno, "fopen(%s)", journal);
+        goto done;
+    }
+    if ((yspec = clicon_dbspec_yang(h)) == NULL){
+        clixon_err(OE_YANG, ENOENT, "No yang spec");
+        goto done;
+    }
+    if ((cbret = cbuf_new()) == NULL){
+        clixon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    clixon_debug(CLIXON_DBG_DATASTORE, "Replay journal %s", journal);
+    for (;;){
+        if ((ret = fscanf(f, "%zu\n", &len)) != 1){
+            if (ret != EOF)
+                torn++;
+            break;
+        }
+        if ((buf = malloc(len + 1)) == NULL){
+            clixon_err(OE_UNIX, errno, "malloc");
+            goto done;
+        }
+        if (fread(buf, 1, len, f) != len){
+            torn++;
+            break;
+        }
+        buf[len] = '\0';
+        if ((ret = clixon_xml_parse_string(buf, YB_NONE, yspec, &xr, &xerr)) < 0)
+            goto done;
+        if (ret == 0 || xml_rootchild(xr, 0, &xr) < 0){
+            clixon_err(OE_DB, 0, "Journal %s: record %u parse error", journal, nr);
+            goto done;
+        }
+        if ((ret = xml_bind_yang(h, xr, YB_MODULE, yspec, 0, &xerr)) < 0)
+            goto done;
+        if (ret == 1)
+            ret = text_modify_top(h, xt, xr, yspec, OP_MERGE, NULL, NULL, 1, cbret);
+        if (ret < 0)
+            goto done;
+        if (ret == 0){
+            clixon_err(OE_DB, 0, "Journal %s: record %u could not be replayed", journal, nr);
+            goto done;
+        }
+        xml_free(xr);
+        xr = NULL;
+        free(buf);
+        buf = NULL;
+        nr++;
+        pos = ftell(f);
+    }
+    if (torn){
+        clixon_log(h, LOG_WARNING, "Journal %s: truncated after record %u", journal, nr);
+        if (truncate(journal, pos) < 0){
+            clixon_err(OE_UNIX, errno, "truncate(%s)", journal);
+            goto done;
+        }
+    }
+    if (xml_tree_prune_flagged_sub(xt, XML_FLAG_NONE, 0, NULL) <0)
+        goto done;
+    if (xml_default_nopresence(xt, 3, 0) < 0)
+        goto done;
+    if (xml_apply(xt, CX_ELMNT, (xml_applyfn_t*)xml_flag_reset,
+                  (void*)(XML_FLAG_NONE|XML_FLAG_ADD|XML_FLAG_DEL|XML_FLAG_CHANGE)) < 0)
+        goto done;
+    xmldb_journal_nr_set(de, nr);
+    xmldb_empty_set(de, xml_child_nr(xt) == 0);
+ ok:
+    retval = 0;
+ done:
+    if (f)
+        fclose(f);
+    if (journal)
+        free(journal);
+    if (buf)
+        free(buf);
+    if (xr)
+        xml_free(xr);
+    if (xerr)
+        xml_free(xerr);
+    if (cbret)
+        cbuf_free(cbret);
+    return retval;
+}
+
 /*! Modify database given an xml tree and an operation
  *
  * @param[in]  h      CLICON handle
@@ -1419,6 +2338,10 @@ xmldb_put(clixon_handle       h,
     int         permit = 0; /* nacm permit all */
     cvec       *nsc = NULL; /* nacm namespace context */
     cxobj      *xerr = NULL;
+    cbuf       *cbj = NULL; /* journal record */
+#ifdef XMLDB_EDIT_LOG
+    int         editlog = 0;
+#endif
     int         ret;
 
     clixon_debug(CLIXON_DBG_DATASTORE|CLIXON_DBG_DETAIL, "db %s", db);
@@ -1439,6 +2362,10 @@ xmldb_put(clixon_handle       h,
         if ((de = xmldb_new(h, db)) == NULL)
             goto done;
     }
+#ifdef XMLDB_EDIT_LOG
+    /* Check before cache access sets new generation */
+    editlog = xmldb_editlog_valid(h, de);
+#endif
     x0 = xmldb_cache_get(de); /* XXX flag is not XML_FLAG_TOP */
     /* If there is no xml x0 tree (in cache), then read it from file */
     if (x0 == NULL){
@@ -1446,6 +2373,9 @@ xmldb_put(clixon_handle       h,
             /* Copy from running */
             if (xmldb_copy(h, "running", db) < 0)
                 goto done;
+#ifdef XMLDB_EDIT_LOG
+            editlog = 1; /* New edit log */
+#endif
             if ((x0 = xmldb_cache_get(de)) == NULL){
                 if ((x0 = xml_new(DATASTORE_TOP_SYMBOL, NULL, CX_ELMNT)) == NULL)
                     goto done;
@@ -1486,6 +2416,17 @@ xmldb_put(clixon_handle       h,
     permit = (xnacm==NULL);
     /* Here assume if xnacm is set and !permit do NACM */
     clicon_data_del(h, "objectexisted");
+    /* Record edit before it is made since operation attributes are stripped */
+    if (x1 && xmldb_volatile_get(de) == 0 && xmldb_journal_enabled(h)){
+        if (xmldb_journal_edit(x1, op, &cbj) < 0)
+            goto done;
+    }
+#ifdef XMLDB_EDIT_LOG
+    /* Other top-level operations than merge and none may change any data */
+    if (xmldb_candidate_get(de) &&
+        xmldb_editlog_add(h, de, editlog && (op == OP_MERGE || op == OP_NONE), x1) < 0)
+        goto done;
+#endif
     /*
      * Modify base tree x with modification x1. This is where the
      * new tree is made.
@@ -1525,11 +2466,16 @@ xmldb_put(clixon_handle       h,
     xmldb_empty_set(de, xml_child_nr(xmldb_cache_get(de)) == 0);
     /* Write cache to file unless volatile (ie stop syncing to store) */
     if (xmldb_volatile_get(de) == 0){
-        if (xmldb_write_cache2file(h, db) < 0)
+        if (cbj){
+            if (xmldb_journal_append(h, db, cbj) < 0)
+                goto done;
+        }
+        else if (xmldb_persist(h, db) < 0)
             goto done;
-        /* Clear flags from previous steps + dirty */
+        /* Clear flags from previous steps + dirty, unless not yet written */
         if (xml_apply(x0, CX_ELMNT, (xml_applyfn_t*)xml_flag_reset,
-                      (void*)(XML_FLAG_NONE|XML_FLAG_ADD|XML_FLAG_DEL|XML_FLAG_CHANGE|XML_FLAG_CACHE_DIRTY)) < 0)
+                      (void*)(intptr_t)(XML_FLAG_NONE|XML_FLAG_ADD|XML_FLAG_DEL|XML_FLAG_CHANGE|
+                                        (xmldb_persist_deferred(h)?0:XML_FLAG_CACHE_DIRTY))) < 0)
             goto done;
     }
     else {
@@ -1540,7 +2486,13 @@ xmldb_put(clixon_handle       h,
     }
     retval = 1;
  done:
+#ifdef XMLDB_EDIT_LOG
+    if (de && xmldb_candidate_get(de))
+        xmldb_editlog_done(de, retval == 1);
+#endif
     clixon_debug(CLIXON_DBG_DATASTORE | CLIXON_DBG_DETAIL, "retval:%d", retval);
+    if (cbj)
+        cbuf_free(cbj);
     if (xerr)
         xml_free(xerr);
     if (nsc)
@@ -1553,7 +2505,9 @@ xmldb_put(clixon_handle       h,
 
 /*! Callback function for xmldb-multi write
  *
- * Look for link attribute in XML, and if found open the linked file for parsing
+ * Look for split-points in XML, and if found write the sub-tree to a linked file if it
+ * is marked as dirty or if the file does not exist.
+ * The file is written in XML or JSON (sub-tree including the split-point) and synced to disk
  * @param[in]  x    XML node
  * @param[in]  arg
  * @retval     2    Locally abort this subtree, continue with others
@@ -1577,7 +2531,9 @@ xmldb_multi_write_applyfn(cxobj *x,
     char         *dbfile;
     struct stat   st = {0,};
     int           fd = -1;
+    int           fd1;
     FILE         *fsub = NULL;
+    int           ret;
 
     if (xml_child_nr_type(x, CX_ELMNT) > 0 &&
         (y = xml_spec(x)) != NULL){
@@ -1594,7 +2550,7 @@ xmldb_multi_write_applyfn(cxobj *x,
                 clixon_err(OE_XML, errno, "cbuf_new");
                 goto done;
             }
-            cprintf(cb, "%s/%s.xml", subdir, hexstr);
+            cprintf(cb, "%s/%s.%s", subdir, hexstr, mw->mw_format == FORMAT_JSON ? "json" : "xml");
             dbfile = cbuf_get(cb);
             if (xml_flag(x, XML_FLAG_CACHE_DIRTY) ||
                 lstat(dbfile, &st) < 0){
@@ -1603,13 +2559,28 @@ xmldb_multi_write_applyfn(cxobj *x,
                     clixon_err(OE_UNIX, errno, "open(%s)", dbfile);
                     goto done;
                 }
-                if ((fsub = fdopen(fd, "w")) == NULL){
-                    clixon_err(OE_CFG, errno, "fdopen(%s)", dbfile);
+                /* Stream closes a duplicate, a compressed frame is ended on close before sync */
+                if ((fd1 = dup(fd)) < 0){
+                    clixon_err(OE_UNIX, errno, "dup");
+                    goto done;
+                }
+                if ((fsub = clicon_file_zfdopen(fd1, "w", mw->mw_compress)) == NULL){
+                    close(fd1);
                     goto done;
                 }
                 /* Dont recurse multi-file yet */
-                if (clixon_xml2file1(fsub, x, 0, mw->mw_pretty, NULL, fprintf, 1, 0, mw->mw_wdef, 0, 0) < 0)
+                if (mw->mw_format == FORMAT_JSON){
+                    if (clixon_json2file1(fsub, x, mw->mw_pretty, fprintf, 0, 0, 0, 0) < 0)
+                        goto done;
+                }
+                else if (clixon_xml2file1(fsub, x, 0, mw->mw_pretty, NULL, fprintf, 1, 0, mw->mw_wdef, 0, 0) < 0)
+                    goto done;
+                ret = fclose(fsub);
+                fsub = NULL;
+                if (ret != 0 || fsync(fd) < 0){
+                    clixon_err(OE_UNIX, errno, "fsync(%s)", dbfile);
                     goto done;
+                }
             }
             retval = 2; /* Locally abort */
             goto done;
@@ -1619,6 +2590,8 @@ xmldb_multi_write_applyfn(cxobj *x,
  done:
     if (fsub != NULL)
         fclose(fsub);
+    if (fd != -1)
+        close(fd);
     if (cb)
         cbuf_free(cb);
     if (subdir)
@@ -1676,25 +2649,21 @@ xmldb_dump(clixon_handle     h,
     switch (format){
     case FORMAT_XML:
         if (clixon_xml2file1(f, xt, 0, pretty, NULL, fprintf, 0, 0, wdef, multi,
-                             clicon_option_bool(h, "CLICON_XMLDB_SYSTEM_ONLY_CONFIG")) < 0)
+                             clicon_option_bool_id(h, CO_XMLDB_SYSTEM_ONLY_CONFIG)) < 0)
             goto done;
-        if (multi){
-            mw.mw_h = h;
-            mw.mw_db = multidb;
-            mw.mw_pretty = pretty;
-            mw.mw_wdef = wdef;
-            mw.mw_format = format;
-            if (xml_apply(xt, CX_ELMNT, (xml_applyfn_t*)xmldb_multi_write_applyfn, &mw) < 0)
-                goto done;
-        }
         break;
     case FORMAT_JSON:
+        if (clixon_json2file1(f, xt, pretty, fprintf, 0, 0, multi,
+                              clicon_option_bool_id(h, CO_XMLDB_SYSTEM_ONLY_CONFIG)) < 0)
+            goto done;
+        break;
+    case FORMAT_BINARY:
         if (multi){
-            clixon_err(OE_CFG, errno, "JSON+multi not supported");
+            clixon_err(OE_CFG, errno, "Binary+multi not supported");
             goto done;
         }
-        if (clixon_json2file(f, xt, pretty, fprintf, 0, 0,
-                             clicon_option_bool(h, "CLICON_XMLDB_SYSTEM_ONLY_CONFIG")) < 0)
+        if (clixon_xml2bin_file(f, xt, clicon_dbspec_yang(h), wdef,
+                                clicon_option_bool_id(h, CO_XMLDB_SYSTEM_ONLY_CONFIG)) < 0)
             goto done;
         break;
     default:
@@ -1702,6 +2671,16 @@ xmldb_dump(clixon_handle     h,
         goto done;
         break;
     }
+    if (multi){
+        mw.mw_h = h;
+        mw.mw_db = multidb;
+        mw.mw_pretty = pretty;
+        mw.mw_wdef = wdef;
+        mw.mw_format = format;
+        mw.mw_compress = clicon_option_int(h, "CLICON_XMLDB_COMPRESS");
+        if (xml_apply(xt, CX_ELMNT, (xml_applyfn_t*)xmldb_multi_write_applyfn, &mw) < 0)
+            goto done;
+    }
     /* Remove modules state after writing to file */
     if (xmodst && xml_purge(xmodst) < 0)
         goto done;
@@ -1734,16 +2713,19 @@ xmldb_write_cache2file(clixon_handle h,
     FILE             *f = NULL;
     char             *dbfile = NULL;
     db_elmnt         *de;
+    clixon_trace_t    tr;
+    int               compress = 0;
     int               ret;
 
+    tr = clixon_trace_begin(CLIXON_DBG_DATASTORE);
     if ((de = xmldb_find(h, db)) == NULL ||
         (xt = xmldb_cache_get(de)) == NULL){
         clixon_err(OE_XML, 0, "XML cache not found");
         goto done;
     }
-    pretty = clicon_option_bool(h, "CLICON_XMLDB_PRETTY");
-    multi = clicon_option_bool(h, "CLICON_XMLDB_MULTI");
-    if ((formatstr = clicon_option_str(h, "CLICON_XMLDB_FORMAT")) != NULL){
+    pretty = clicon_option_bool_id(h, CO_XMLDB_PRETTY);
+    multi = clicon_option_bool_id(h, CO_XMLDB_MULTI);
+    if ((formatstr = clicon_option_str_id(h, CO_XMLDB_FORMAT)) != NULL){
         if ((ret = format_str2int(formatstr)) < 0){
             clixon_err(OE_XML, 0, "Format %s invalid", formatstr);
             goto done;
@@ -1752,17 +2734,28 @@ xmldb_write_cache2file(clixon_handle h,
     }
     if (xmldb_db2file(h, db, &dbfile) < 0)
         goto done;
-    if ((f = fopen(dbfile, "w")) == NULL){
-        clixon_err(OE_CFG, errno, "fopen(%s)", dbfile);
+    /* Binary format is not compressed, it is mapped into memory on read */
+    if (format != FORMAT_BINARY)
+        compress = clicon_option_int(h, "CLICON_XMLDB_COMPRESS");
+    if ((f = clicon_file_zfopen(dbfile, "w", compress)) == NULL)
         goto done;
-    }
     if (xmldb_dump(h, f, xt, format, pretty, wdef, multi, db) < 0)
         goto done;
+    ret = fclose(f);
+    f = NULL;
+    if (ret != 0){
+        clixon_err(OE_UNIX, errno, "fclose(%s)", dbfile);
+        goto done;
+    }
+    /* Full datastore written, journal is obsolete */
+    if (xmldb_journal_reset(h, db) < 0)
+        goto done;
     retval = 0;
  done:
     if (dbfile)
         free(dbfile);
     if (f)
         fclose(f);
+    clixon_trace_end(tr, CLIXON_DBG_DATASTORE, "xmldb_write_cache2file", db);
     return retval;
 }
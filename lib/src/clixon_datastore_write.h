@@ -47,6 +47,10 @@
  */
 int xmldb_put(clixon_handle h, const char *db, enum operation_type op, cxobj *xt, const char *username, cbuf *cbret);
 int xmldb_write_cache2file(clixon_handle h, const char *db);
+int xmldb_journal_enabled(clixon_handle h);
+int xmldb_journal_diff(clixon_handle h, cxobj *x0, cxobj *x1, cbuf **cbp);
+int xmldb_journal_append(clixon_handle h, const char *db, cbuf *cb);
+int xmldb_journal_replay(clixon_handle h, db_elmnt *de, cxobj *xt);
 int xmldb_dump(clixon_handle h, FILE *f, cxobj *xt, enum format_enum format, int pretty, withdefaults_type wdef, int multi, const char *multidb);
 
 #endif /* _CLIXON_DATASTORE_WRITE_H */
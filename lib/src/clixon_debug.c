@@ -90,8 +90,9 @@ static clixon_handle _debug_clixon_h    = NULL;
  * usefulness, since not all functions have access to a handle.
  * A compromise solution is now in place where h can be provided in the function call, but
  * tolerates NULL, in which case a cached handle is used.
+ * Not static so that clixon_debug_isset() can check it inline, do not set directly
  */
-static int _debug_level = 0;
+int _clixon_debug_level = 0;
 
 /* If explicitly called with CLIXON_DBG_TRUNC debug to this length, see also generic in clixon_log.[ch] */
 static int _debug_explicit_trunc = CLIXON_DBG_EXPLICIT_TRUNC_DEFAULT;
@@ -257,7 +258,7 @@ clixon_debug_init(clixon_handle h,
                   int           dbglevel)
 {
     _debug_clixon_h = h;
-    _debug_level = dbglevel; /* Global variable */
+    _clixon_debug_level = dbglevel; /* Global variable */
     return 0;
 }
 
@@ -278,7 +279,7 @@ clixon_debug_exit(void)
 int
 clixon_debug_get(void)
 {
-    return _debug_level;
+    return _clixon_debug_level;
 }
 
 /*! Print a debug message with debug-level. Settings determine where msg appears.
@@ -110,3 +110,30 @@ clixon_digest_hex(const char *str,
         free(md);
     return retval;
 }
+
+/*! Compute binary SHA digest of a buffer
+ *
+ * @param[in]  buf     Input buffer
+ * @param[in]  len     Length of buf
+ * @param[out] md      Digest of CLIXON_DIGEST_LEN bytes, zero-padded if SHA1
+ * @retval     0       OK
+ * @retval    -1       Error
+ * @see clixon_digest_hex  For hex string digest
+ */
+int
+clixon_digest_buf(const char    *buf,
+                  size_t         len,
+                  unsigned char *md)
+{
+    memset(md, 0, CLIXON_DIGEST_LEN);
+#ifdef USE_SHA256
+    if (SHA256((unsigned char *)buf, len, md) == NULL)
+#else
+    if (SHA1((unsigned char *)buf, len, md) == NULL)
+#endif
+        {
+        clixon_err(OE_UNIX, 0, "SHA256 error");
+        return -1;
+    }
+    return 0;
+}
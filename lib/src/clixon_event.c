@@ -54,6 +54,9 @@
 #include <sys/param.h>
 #include <sys/types.h>
 #include <sys/time.h>
+#ifdef HAVE_EPOLL_CREATE1
+#include <sys/epoll.h>
+#endif
 
 #include <cligen/cligen.h>
 
@@ -88,6 +91,13 @@ struct event_data{
     void                       *e_arg;                  /* Function argument */
     char                        e_descr[EVENT_STRLEN]; /* String for debugging */
     struct pollfd              *e_pollfd;               /* Pointer to pull struct */
+    int                         e_prio;                 /* Prioritized file event */
+    int                         e_out;                  /* Wait for output instead of input */
+    int                         e_hidx;                 /* Index in timer heap */
+    uint64_t                    e_seq;                  /* Timer registration order */
+    int                         e_class;                /* Dispatch class of unprio file event */
+    int                         e_ready;                /* Input buffered by application */
+    uint64_t                    e_served;               /* Dispatch order when last served */
 };
 
 /*
@@ -109,8 +119,27 @@ static int _ee_nr = 0;
 static struct event_data *_ee_prio = NULL;
 static int _ee_prio_nr = 0;
 
-/* Timer event handlers */
-static struct event_data *_ee_timers = NULL;
+/* Number of un-prioritized file events marked ready, @see clixon_event_fd_ready */
+static int _ee_ready_nr = 0;
+
+/* Dispatch counter of un-prioritized file events, for least-recently served order */
+static uint64_t _ee_served = 0;
+
+/* Timer event handlers as a binary min-heap ordered by time and registration order */
+static struct event_data **_ee_timers = NULL;
+static int _ee_timers_nr = 0;
+static int _ee_timers_max = 0;
+static uint64_t _ee_timers_seq = 0;
+
+#ifdef HAVE_EPOLL_CREATE1
+/* Epoll file descriptor with persistent registrations of all file events, or -1
+ * @see  CLICON_EVENT_EPOLL in clixon-config.yang
+ */
+static int _event_epoll = -1;
+
+/* Process that created _event_epoll, a forked child creates its own */
+static pid_t _event_epoll_pid = 0;
+#endif
 
 /* Set if element in _ee is deleted (clixon_event_unreg_fd). Check in _ee loops
  * XXX: algorithm has flaw: which _ee is unregged?
@@ -187,37 +216,201 @@ clicon_sig_ignore_get(void)
     return _clicon_sig_ignore;
 }
 
-/*! Register a callback function to be called on input on a file descriptor.
+/*! Timer a is due before timer b
+ *
+ * Timers with same time are due in registration order
+ */
+static inline int
+event_timer_before(struct event_data *a,
+                   struct event_data *b)
+{
+    if (timercmp(&a->e_time, &b->e_time, !=))
+        return timercmp(&a->e_time, &b->e_time, <);
+    return a->e_seq < b->e_seq;
+}
+
+/*! Set timer at heap index i and update its index
+ */
+static inline void
+event_timer_set(int                i,
+                struct event_data *e)
+{
+    _ee_timers[i] = e;
+    e->e_hidx = i;
+}
+
+/*! Move timer at heap index i up or down until heap order is restored
+ */
+static void
+event_timer_sift(int i)
+{
+    struct event_data *e = _ee_timers[i];
+    int                j;
+
+    while (i > 0 && event_timer_before(e, _ee_timers[(i-1)/2])){
+        event_timer_set(i, _ee_timers[(i-1)/2]);
+        i = (i-1)/2;
+    }
+    while ((j = 2*i+1) < _ee_timers_nr){
+        if (j+1 < _ee_timers_nr && event_timer_before(_ee_timers[j+1], _ee_timers[j]))
+            j++;
+        if (!event_timer_before(_ee_timers[j], e))
+            break;
+        event_timer_set(i, _ee_timers[j]);
+        i = j;
+    }
+    event_timer_set(i, e);
+}
+
+/*! Add timer to heap
+ *
+ * @param[in]  e   Timer event
+ * @retval     0   OK
+ * @retval    -1   Error
+ */
+static int
+event_timer_push(struct event_data *e)
+{
+    if (_ee_timers_nr == _ee_timers_max){
+        _ee_timers_max = _ee_timers_max ? 2*_ee_timers_max : 16;
+        if ((_ee_timers = realloc(_ee_timers, _ee_timers_max*sizeof(*_ee_timers))) == NULL){
+            clixon_err(OE_UNIX, errno, "realloc");
+            return -1;
+        }
+    }
+    e->e_seq = _ee_timers_seq++;
+    event_timer_set(_ee_timers_nr++, e);
+    event_timer_sift(e->e_hidx);
+    return 0;
+}
+
+/*! Remove timer at heap index i from heap
+ *
+ * @param[in]  i   Heap index, 0 is next timer due
+ * @retval     e   Removed timer event, free with free()
+ */
+static struct event_data *
+event_timer_rm(int i)
+{
+    struct event_data *e = _ee_timers[i];
+
+    if (i != --_ee_timers_nr){
+        event_timer_set(i, _ee_timers[_ee_timers_nr]);
+        event_timer_sift(i);
+    }
+    return e;
+}
+
+/*! Get poll/epoll timeout in ms until next timer, or -1 if no timers
+ */
+static int
+event_timer_timeout(void)
+{
+    struct timeval t0;
+    struct timeval t;
+    int64_t        tdiff;
+
+    if (_ee_timers_nr == 0)
+        return -1;
+    gettimeofday(&t0, NULL);
+    timersub(&_ee_timers[0]->e_time, &t0, &t);
+    tdiff = t.tv_sec * 1000 + t.tv_usec / 1000;
+    if (tdiff < 0)
+        return 0;
+    return (int)tdiff;
+}
+
+#ifdef HAVE_EPOLL_CREATE1
+/*! Add file event to epoll set
+ *
+ * @param[in]  e   File event
+ * @retval     0   OK
+ * @retval    -1   Error
+ */
+static int
+event_epoll_add(struct event_data *e)
+{
+    struct epoll_event ev = {0,};
+
+    ev.events = e->e_out ? EPOLLOUT : EPOLLIN;
+    ev.data.ptr = e;
+    if (epoll_ctl(_event_epoll, EPOLL_CTL_ADD, e->e_fd, &ev) < 0){
+        clixon_err(OE_EVENTS, errno, "epoll_ctl add %s fd %d", e->e_descr, e->e_fd);
+        return -1;
+    }
+    return 0;
+}
+
+/*! Create epoll set and add all registered file events
+ *
+ * Also called in a forked child which must not share the epoll set of its parent
+ * @retval     0   OK
+ * @retval    -1   Error
+ */
+static int
+event_epoll_open(void)
+{
+    struct event_data *e;
+
+    if (_event_epoll != -1)
+        close(_event_epoll);
+    if ((_event_epoll = epoll_create1(EPOLL_CLOEXEC)) < 0){
+        clixon_err(OE_EVENTS, errno, "epoll_create1");
+        return -1;
+    }
+    _event_epoll_pid = getpid();
+    for (e = _ee_prio; e; e = e->e_next)
+        if (event_epoll_add(e) < 0)
+            return -1;
+    for (e = _ee; e; e = e->e_next)
+        if (event_epoll_add(e) < 0)
+            return -1;
+    return 0;
+}
+
+/*! Remove file event from epoll set unless another registration has the same fd
+ *
+ * Errors are ignored since the fd may have been closed which removes it from the set
+ * @param[in]  e   File event, already removed from its list
+ */
+static void
+event_epoll_del(struct event_data *e)
+{
+    struct event_data *e1;
+
+    if (_event_epoll_pid != getpid())
+        return; /* Set is re-created in event loop */
+    for (e1 = _ee_prio; e1; e1 = e1->e_next)
+        if (e1->e_fd == e->e_fd)
+            return;
+    for (e1 = _ee; e1; e1 = e1->e_next)
+        if (e1->e_fd == e->e_fd)
+            return;
+    epoll_ctl(_event_epoll, EPOLL_CTL_DEL, e->e_fd, NULL);
+}
+#endif /* HAVE_EPOLL_CREATE1 */
+
+/*! Create and register a file event
  *
- * Prio is primitive, non-preemptive as follows:
- * If several file events are active, then the prioritized are served first.
- * If a non-prioritized is running, and a prioritized becomes active, then the
- * running un-prioritized handler will run to completion (not pre-empted) and then
- * the priorizited events will run.
- * A timeout will always run.
  * @param[in]  fd   File descriptor
- * @param[in]  fn   Function to call when input available on fd
+ * @param[in]  fn   Function to call when fd is ready
  * @param[in]  arg  Argument to function fn
  * @param[in]  str  Describing string for logging
  * @param[in]  prio Priority (0 or 1)
- * @code
- *   static int fn(int fd, void *arg){}
- *   clixon_event_reg_fd(fd, fn, (void*)42, "call fn on input on fd", 0);
- * @endcode
- * @see clixon_event_loop
+ * @param[in]  out  0: Wait for input, 1: wait for output
+ * @retval     0    OK
+ * @retval    -1    Error
  */
-int
-clixon_event_reg_fd_prio(int         fd,
-                         int       (*fn)(int, void*),
-                         void       *arg,
-                         const char *str,
-                         int         prio)
+static int
+event_reg_fd(int         fd,
+             int       (*fn)(int, void*),
+             void       *arg,
+             const char *str,
+             int         prio,
+             int         out)
 {
     struct event_data *e;
 
-    if (_event_select){
-        return clixon_event_select_reg_fd_prio(fd, fn, arg, str, prio);
-    }
     if ((e = (struct event_data *)malloc(sizeof(struct event_data))) == NULL){
         clixon_err(OE_EVENTS, errno, "malloc");
         return -1;
@@ -228,6 +421,15 @@ clixon_event_reg_fd_prio(int         fd,
     e->e_fn = fn;
     e->e_arg = arg;
     e->e_type = EVENT_FD;
+    e->e_prio = prio;
+    e->e_out = out;
+#ifdef HAVE_EPOLL_CREATE1
+    if (_event_epoll != -1 && _event_epoll_pid == getpid() &&
+        event_epoll_add(e) < 0){
+        free(e);
+        return -1;
+    }
+#endif
     if (prio){
         e->e_next = _ee_prio;
         _ee_prio = e;
@@ -242,6 +444,65 @@ clixon_event_reg_fd_prio(int         fd,
     return 0;
 }
 
+/*! Register a callback function to be called on input on a file descriptor.
+ *
+ * Prio is primitive, non-preemptive as follows:
+ * If several file events are active, then the prioritized are served first.
+ * If a non-prioritized is running, and a prioritized becomes active, then the
+ * running un-prioritized handler will run to completion (not pre-empted) and then
+ * the priorizited events will run.
+ * A timeout will always run.
+ * @param[in]  fd   File descriptor
+ * @param[in]  fn   Function to call when input available on fd
+ * @param[in]  arg  Argument to function fn
+ * @param[in]  str  Describing string for logging
+ * @param[in]  prio Priority (0 or 1)
+ * @code
+ *   static int fn(int fd, void *arg){}
+ *   clixon_event_reg_fd(fd, fn, (void*)42, "call fn on input on fd", 0);
+ * @endcode
+ * @see clixon_event_loop
+ */
+int
+clixon_event_reg_fd_prio(int         fd,
+                         int       (*fn)(int, void*),
+                         void       *arg,
+                         const char *str,
+                         int         prio)
+{
+    if (_event_select){
+        return clixon_event_select_reg_fd_prio(fd, fn, arg, str, prio);
+    }
+    return event_reg_fd(fd, fn, arg, str, prio, 0);
+}
+
+/*! Register a callback function to be called when output is possible on a file descriptor
+ *
+ * Used to write buffered output to a non-blocking peer when it is able to receive.
+ * Unregister with clixon_event_unreg_fd when all output has been written, otherwise
+ * fn is called in every event loop.
+ * With epoll, a file descriptor can only be registered once, use a dup of a socket
+ * that is also registered for input.
+ * @param[in]  fd   File descriptor
+ * @param[in]  fn   Function to call when fd is writable
+ * @param[in]  arg  Argument to function fn
+ * @param[in]  str  Describing string for logging
+ * @retval     0    OK
+ * @retval    -1    Error
+ * @see clixon_event_reg_fd  for input
+ */
+int
+clixon_event_reg_fd_out(int         fd,
+                        int       (*fn)(int, void*),
+                        void       *arg,
+                        const char *str)
+{
+    if (_event_select){
+        return clixon_event_select_reg_fd_out(fd, fn, arg, str);
+    }
+    return event_reg_fd(fd, fn, arg, str, 0, 1);
+}
+
 /*! Register un-prioritized file event callback
  *
  * @see clixon_event_unreg_fd_prio
@@ -285,6 +546,10 @@ clixon_event_unreg_fd(int   s,
             *e_prev = e->e_next;
             _ee_prio_nr--;
             _ee_unreg++;
+#ifdef HAVE_EPOLL_CREATE1
+            if (_event_epoll != -1)
+                event_epoll_del(e);
+#endif
             free(e);
             break;
         }
@@ -298,6 +563,12 @@ clixon_event_unreg_fd(int   s,
                 *e_prev = e->e_next;
                 _ee_nr--;
                 _ee_unreg++;
+                if (e->e_ready)
+                    _ee_ready_nr--;
+#ifdef HAVE_EPOLL_CREATE1
+                if (_event_epoll != -1)
+                    event_epoll_del(e);
+#endif
                 free(e);
                 break;
             }
@@ -307,6 +578,80 @@ clixon_event_unreg_fd(int   s,
     return found?0:-1;
 }
 
+/*! Find un-prioritized file event waiting for input on a file descriptor
+ *
+ * @param[in]  fd  File descriptor
+ * @retval     e   File event
+ * @retval     NULL Not found
+ */
+static struct event_data *
+event_fd_find(int fd)
+{
+    struct event_data *e;
+
+    for (e = _ee; e; e = e->e_next)
+        if (e->e_type == EVENT_FD && e->e_fd == fd && e->e_out == 0)
+            return e;
+    return NULL;
+}
+
+/*! Set dispatch class of an un-prioritized file event
+ *
+ * When several un-prioritized file events are ready, events of the highest class are
+ * served first, and within a class the least recently served event is served first.
+ * After the ready events of the highest class, at most one event of a lower class is
+ * served before the file descriptors are polled again, so that a lower class is not
+ * starved.
+ * Classes are not used by the select event loop.
+ * @param[in]  fd   File descriptor registered with clixon_event_reg_fd
+ * @param[in]  cls  Class, higher is served first, default 0
+ * @retval     0    OK
+ * @retval    -1    Error: fd not registered
+ * @see clixon_event_reg_fd_prio  for prioritized file events
+ */
+int
+clixon_event_fd_class(int fd,
+                      int cls)
+{
+    struct event_data *e;
+
+    if (_event_select)
+        return 0;
+    if ((e = event_fd_find(fd)) == NULL){
+        clixon_err(OE_EVENTS, 0, "fd %d not registered", fd);
+        return -1;
+    }
+    e->e_class = cls;
+    return 0;
+}
+
+/*! Mark an un-prioritized file event as ready even if no input is available on fd
+ *
+ * Used when a callback has read input it has not served, to let other file events be
+ * served before it continues. The callback is called again as if input was available.
+ * @param[in]  fd   File descriptor registered with clixon_event_reg_fd
+ * @retval     1    OK, callback will be called
+ * @retval     0    Not supported by the select event loop, caller needs to serve input
+ * @retval    -1    Error: fd not registered
+ */
+int
+clixon_event_fd_ready(int fd)
+{
+    struct event_data *e;
+
+    if (_event_select)
+        return 0;
+    if ((e = event_fd_find(fd)) == NULL){
+        clixon_err(OE_EVENTS, 0, "fd %d not registered", fd);
+        return -1;
+    }
+    if (e->e_ready == 0){
+        e->e_ready = 1;
+        _ee_ready_nr++;
+    }
+    return 1;
+}
+
 /*! Call a callback function at an absolute time
  *
  * @param[in]  t   Absolute (not relative!) timestamp when callback is called
@@ -339,8 +684,6 @@ clixon_event_reg_timeout(struct timeval t,
 {
     int                 retval = -1;
     struct event_data  *e;
-    struct event_data  *e1;
-    struct event_data **e_prev;
 
     if (_event_select){
         return clixon_event_select_reg_timeout(t, fn, arg, str);
@@ -359,15 +702,10 @@ clixon_event_reg_timeout(struct timeval t,
     e->e_arg = arg;
     e->e_type = EVENT_TIME;
     e->e_time = t;
-    /* Sort into right place */
-    e_prev = &_ee_timers;
-    for (e1=_ee_timers; e1; e1=e1->e_next){
-        if (timercmp(&e->e_time, &e1->e_time, <))
-            break;
-        e_prev = &e1->e_next;
+    if (event_timer_push(e) < 0){
+        free(e);
+        goto done;
     }
-    e->e_next = e1;
-    *e_prev = e;
     clixon_debug(CLIXON_DBG_EVENT | CLIXON_DBG_DETAIL, "%s", str);
     retval = 0;
  done:
@@ -391,23 +729,19 @@ clixon_event_unreg_timeout(int (*fn)(int, void*),
                            void *arg)
 {
     struct event_data  *e;
-    int                 found = 0;
-    struct event_data **e_prev;
+    int                 i;
 
     if (_event_select){
         return clixon_event_select_unreg_timeout(fn, arg);
     }
-    e_prev = &_ee_timers;
-    for (e = _ee_timers; e; e = e->e_next){
+    for (i = 0; i < _ee_timers_nr; i++){
+        e = _ee_timers[i];
         if (fn == e->e_fn && arg == e->e_arg) {
-            found++;
-            *e_prev = e->e_next;
-            free(e);
-            break;
+            free(event_timer_rm(i));
+            return 0;
         }
-        e_prev = &e->e_next;
     }
-    return found?0:-1;
+    return -1;
 }
 
 /*! Poll to see if there is any data available on this file descriptor.
@@ -485,22 +819,110 @@ event_handle_eintr(clixon_handle h)
     goto done;
 }
 
+/*! Compare ready file events: higher class first, then least recently served
+ */
+static int
+event_ready_cmp(const void *a,
+                const void *b)
+{
+    struct event_data *ea = *(struct event_data **)a;
+    struct event_data *eb = *(struct event_data **)b;
+
+    if (ea->e_class != eb->e_class)
+        return ea->e_class > eb->e_class ? -1 : 1;
+    if (ea->e_served != eb->e_served)
+        return ea->e_served < eb->e_served ? -1 : 1;
+    return 0;
+}
+
+/*! Call callbacks of ready un-prioritized file events in class order
+ *
+ * All ready events of the highest class are served, and at most one of a lower class.
+ * Dispatch stops when a callback unregisters any file event, or if prioritized events
+ * exist after one event. Events not served are served in a later loop.
+ * @param[in]  rdy   Vector of ready events, is sorted
+ * @param[in]  nr    Number of ready events
+ * @retval     0     OK
+ * @retval    -1     Error
+ * @see clixon_event_fd_class
+ */
+static int
+event_dispatch_ready(struct event_data **rdy,
+                     int                 nr)
+{
+    struct event_data *e;
+    int                cls;
+    int                i;
+
+    if (nr == 0)
+        return 0;
+    if (nr > 1)
+        qsort(rdy, nr, sizeof(*rdy), event_ready_cmp);
+    cls = rdy[0]->e_class;
+    for (i = 0; i < nr; i++){
+        e = rdy[i];
+        if (e->e_ready){
+            e->e_ready = 0;
+            _ee_ready_nr--;
+        }
+        e->e_served = ++_ee_served;
+        clixon_debug(CLIXON_DBG_EVENT, "fd %s class:%d", e->e_descr, e->e_class);
+        _ee_unreg = 0;
+        if ((*e->e_fn)(e->e_fd, e->e_arg) < 0) {
+            clixon_debug(CLIXON_DBG_EVENT, "Error in: %s", e->e_descr);
+            return -1;
+        }
+        if (_ee_unreg){ /* e or any other event may be freed */
+            _ee_unreg = 0;
+            break;
+        }
+        if (_ee_prio_nr > 0) /* Prioritized exists, break unprio fairness */
+            break;
+        if (e->e_class < cls) /* One event of lower class */
+            break;
+    }
+    return 0;
+}
+
+/*! Call callbacks of file events with given priority returned by poll
+ *
+ * Un-prioritized events are collected in rdy and dispatched in class order
+ * @param[in]  ee       List of file events
+ * @param[in]  prio     Priority of events
+ * @param[in]  rdy      Vector of un-prioritized ready events (prio=0)
+ * @param[in]  rdy_max  Size of rdy
+ * @retval     0        OK
+ * @retval    -1        Error
+ */
 static int
-event_handle_fds(struct event_data *ee,
-                 int                prio)
+event_handle_fds(struct event_data  *ee,
+                 int                 prio,
+                 struct event_data **rdy,
+                 int                 rdy_max)
 {
     int                retval = -1;
     struct pollfd     *pfd;
     struct event_data *e = NULL;
+    int                nr = 0;
 
     for (e = ee; e; e = e->e_next) {
         if (e->e_type != EVENT_FD)
             continue;
         clixon_debug(CLIXON_DBG_EVENT | CLIXON_DBG_DETAIL, "check s:%d prio:%d fd %s", e->e_fd, prio, e->e_descr);
+        if (e->e_ready){
+            if (nr < rdy_max)
+                rdy[nr++] = e;
+            continue;
+        }
         if ((pfd = e->e_pollfd) == NULL) /* Could be added after poll regitsration */
             continue;
         if (pfd->revents != 0) { /* returned events */
-            if (pfd->revents & POLLIN || pfd->revents & POLLHUP) {
+            if (pfd->revents & (e->e_out ? (POLLOUT|POLLHUP|POLLERR) : (POLLIN|POLLHUP))) {
+                if (prio == 0){
+                    if (nr < rdy_max)
+                        rdy[nr++] = e;
+                    continue;
+                }
                 clixon_debug(CLIXON_DBG_EVENT, "fd %s", e->e_descr);
                 _ee_unreg = 0;
                 if ((*e->e_fn)(e->e_fd, e->e_arg) < 0) {
@@ -511,8 +933,6 @@ event_handle_fds(struct event_data *ee,
                     _ee_unreg = 0;
                     break;
                 }
-                if (prio == 0 && _ee_prio_nr > 0) /* Prioritized exists, break unprio fairness */
-                    break;
             }
             else if (pfd->revents & POLLNVAL) { /* fd not open */
                 clixon_err(OE_EVENTS, 0, "poll: Invalid request: %s fd %d not open",
@@ -526,11 +946,176 @@ event_handle_fds(struct event_data *ee,
             }
         }
     }
+    if (event_dispatch_ready(rdy, nr) < 0)
+        goto done;
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Call the next timer callback
+ *
+ * @retval     0   OK
+ * @retval    -1   Error in callback
+ */
+static int
+event_handle_timeout(void)
+{
+    int                retval = -1;
+    struct event_data *e;
+
+    if (_ee_timers_nr == 0) /* Can be unregistered while waiting, eg in a signal handler */
+        return 0;
+    e = event_timer_rm(0);
+    clixon_debug(CLIXON_DBG_EVENT | CLIXON_DBG_DETAIL, "timeout: %s", e->e_descr);
+    if ((*e->e_fn)(0, e->e_arg) < 0)
+        goto done;
     retval = 0;
  done:
+    free(e);
     return retval;
 }
 
+#ifdef HAVE_EPOLL_CREATE1
+/*! Call callbacks of ready file events with given priority
+ *
+ * Registrations are level-triggered: events not served are returned again by next
+ * epoll_wait. Therefore dispatch stops when a callback unregisters any file event
+ * since a ready event may refer to it.
+ * Un-prioritized events, and events marked ready, are collected in rdy and dispatched
+ * in class order.
+ * @param[in]  evs   Ready events from epoll_wait
+ * @param[in]  n     Number of ready events
+ * @param[in]  prio  Priority of events to serve
+ * @param[in]  rdy   Vector of un-prioritized ready events (prio=0)
+ * @param[in]  rdy_max  Size of rdy
+ * @retval     1     OK, continue with next priority
+ * @retval     0     OK, stop, an event was unregistered or prioritized events exist
+ * @retval    -1     Error
+ */
+static int
+event_epoll_dispatch(struct epoll_event *evs,
+                     int                 n,
+                     int                 prio,
+                     struct event_data **rdy,
+                     int                 rdy_max)
+{
+    struct event_data *e;
+    int                i;
+    int                nr = 0;
+
+    if (prio == 0 && _ee_ready_nr > 0){
+        for (e = _ee; e && nr < rdy_max; e = e->e_next)
+            if (e->e_ready)
+                rdy[nr++] = e;
+    }
+    for (i = 0; i < n; i++){
+        e = (struct event_data *)evs[i].data.ptr;
+        if (e->e_prio != prio)
+            continue;
+        if ((evs[i].events & (e->e_out ? (EPOLLOUT|EPOLLHUP|EPOLLERR) : (EPOLLIN|EPOLLHUP))) == 0){
+            clixon_debug(CLIXON_DBG_EVENT | CLIXON_DBG_DETAIL,
+                         "%s %d events:0x%x", e->e_descr, e->e_fd, evs[i].events);
+            return -1;
+        }
+        if (prio == 0){
+            if (e->e_ready == 0 && nr < rdy_max) /* Already collected if ready */
+                rdy[nr++] = e;
+            continue;
+        }
+        clixon_debug(CLIXON_DBG_EVENT, "fd %s", e->e_descr);
+        _ee_unreg = 0;
+        if ((*e->e_fn)(e->e_fd, e->e_arg) < 0) {
+            clixon_debug(CLIXON_DBG_EVENT, "Error in: %s", e->e_descr);
+            return -1;
+        }
+        if (_ee_unreg){
+            _ee_unreg = 0;
+            return 0;
+        }
+    }
+    if (prio == 0 && event_dispatch_ready(rdy, nr) < 0)
+        return -1;
+    return 1;
+}
+
+/*! Epoll event loop with persistent registrations, dispatch is O(ready events)
+ *
+ * @param[in] h  Clixon handle
+ * @retval    0  OK
+ * @retval   -1  Error: eg epoll_wait, callback, timer,
+ * @see clixon_event_loop  for poll
+ */
+static int
+event_epoll_loop(clixon_handle h)
+{
+    int                 retval = -1;
+    struct epoll_event *evs = NULL;
+    struct event_data **rdy = NULL;
+    int                 evs_max = 0;
+    int                 timeout;
+    int                 n;
+    int                 ret;
+
+    while (clixon_exit_get() != 1) {
+        if (_event_epoll_pid != getpid() && event_epoll_open() < 0)
+            goto done;
+        if (_ee_prio_nr + _ee_nr + 1 > evs_max){
+            evs_max = _ee_prio_nr + _ee_nr + 1;
+            if ((evs = realloc(evs, evs_max*sizeof(struct epoll_event))) == NULL){
+                clixon_err(OE_UNIX, errno, "realloc");
+                goto done;
+            }
+            if ((rdy = realloc(rdy, evs_max*sizeof(struct event_data *))) == NULL){
+                clixon_err(OE_UNIX, errno, "realloc");
+                goto done;
+            }
+        }
+        /* Do not wait if events are marked ready */
+        timeout = _ee_ready_nr ? 0 : event_timer_timeout();
+        clixon_debug(CLIXON_DBG_EVENT | CLIXON_DBG_DETAIL, "epoll timeout: %d", timeout);
+        n = epoll_wait(_event_epoll, evs, evs_max, timeout);
+        if (n == -1) {
+            if (errno == EINTR){
+                if (clixon_exit_get() == 1){
+                    clixon_err(OE_EVENTS, errno, "epoll_wait");
+                    goto ok;
+                }
+                if ((ret = event_handle_eintr(h)) < 0)
+                    goto done;
+                if (ret == 0){ // exit
+                    retval = 0;
+                    goto done;
+                }
+                continue;
+            }
+            clixon_err(OE_EVENTS, errno, "epoll_wait");
+            goto done;
+        }
+        if (n == 0 && (_ee_ready_nr == 0 || event_timer_timeout() == 0)) { /* timeout */
+            clixon_debug(CLIXON_DBG_EVENT | CLIXON_DBG_DETAIL, "n=0 Timeout");
+            if (event_handle_timeout() < 0)
+                goto done;
+        }
+        if ((ret = event_epoll_dispatch(evs, n, 1, NULL, 0)) < 0)
+            goto done;
+        if (ret == 1 && event_epoll_dispatch(evs, n, 0, rdy, evs_max) < 0)
+            goto done;
+        clixon_exit_decr(); /* If exit is set and > 1, decrement it (and exit when 1) */
+    }
+ ok:
+    if (clixon_exit_get() == 1)
+        retval = 0;
+ done:
+    clixon_debug(CLIXON_DBG_EVENT, "retval:%d", retval);
+    if (evs)
+        free(evs);
+    if (rdy)
+        free(rdy);
+    return retval;
+}
+#endif /* HAVE_EPOLL_CREATE1 */
+
 /*! Dispatch file descriptor events (and timeouts) by invoking callbacks.
  *
  * @param[in] h  Clixon handle
@@ -548,11 +1133,9 @@ clixon_event_loop(clixon_handle h)
     struct event_data *e = NULL;
     struct pollfd     *fds = NULL;
     struct pollfd     *pfd;
+    struct event_data **rdy = NULL;
     uint32_t           nfds_max = 0;
     int                nfds = 0;
-    struct timeval     t0;
-    struct timeval     t;
-    int64_t            tdiff;
     int                timeout;
     int                n;
     int                ret;
@@ -560,6 +1143,10 @@ clixon_event_loop(clixon_handle h)
     if (_event_select){
         return clixon_event_select_loop(h);
     }
+#ifdef HAVE_EPOLL_CREATE1
+    if (_event_epoll != -1)
+        return event_epoll_loop(h);
+#endif
     while (clixon_exit_get() != 1) {
         nfds = _ee_prio_nr + _ee_nr;
         if (nfds > nfds_max){
@@ -568,6 +1155,10 @@ clixon_event_loop(clixon_handle h)
                 clixon_err(OE_UNIX, errno, "realloc");
                 goto done;
             }
+            if ((rdy = realloc(rdy, nfds_max*sizeof(struct event_data *))) == NULL){
+                clixon_err(OE_UNIX, errno, "realloc");
+                goto done;
+            }
         }
         nfds = 0;
         clixon_debug(CLIXON_DBG_EVENT | CLIXON_DBG_DETAIL, "register prio");
@@ -587,7 +1178,7 @@ clixon_event_loop(clixon_handle h)
             if (e->e_type == EVENT_FD) {
                 pfd = &fds[nfds];
                 pfd->fd = e->e_fd;
-                pfd->events = POLLIN; /* requested event */
+                pfd->events = e->e_out ? POLLOUT : POLLIN; /* requested event */
                 e->e_pollfd = pfd;
                 clixon_debug(CLIXON_DBG_EVENT | CLIXON_DBG_DETAIL, "register fd %s nr:%d",
                              e->e_descr, nfds);
@@ -598,17 +1189,8 @@ clixon_event_loop(clixon_handle h)
             clixon_err(OE_EVENTS, 0, "File descriptor mismatch");
             goto done;
         }
-        timeout = -1;
-        clixon_debug(CLIXON_DBG_EVENT | CLIXON_DBG_DETAIL, "timeout");
-        if (_ee_timers != NULL) {
-            gettimeofday(&t0, NULL);
-            timersub(&_ee_timers->e_time, &t0, &t);
-            tdiff = t.tv_sec * 1000 + t.tv_usec / 1000;
-            if (tdiff < 0)
-                timeout = 0;
-            else
-                timeout = (int)tdiff;
-        }
+        /* Do not wait if events are marked ready */
+        timeout = _ee_ready_nr ? 0 : event_timer_timeout();
         clixon_debug(CLIXON_DBG_EVENT | CLIXON_DBG_DETAIL, "poll timeout: %d", timeout);
         n = poll(fds, nfds, timeout);
         if (n == -1) {
@@ -631,22 +1213,16 @@ clixon_event_loop(clixon_handle h)
                 clixon_err(OE_EVENTS, errno, "poll");
             goto done;
         }
-        if (n == 0) { /* timeout */
+        if (n == 0 && (_ee_ready_nr == 0 || event_timer_timeout() == 0)) { /* timeout */
             clixon_debug(CLIXON_DBG_EVENT | CLIXON_DBG_DETAIL, "n=0 Timeout");
-            e = _ee_timers;
-            _ee_timers = _ee_timers->e_next;
-            clixon_debug(CLIXON_DBG_EVENT | CLIXON_DBG_DETAIL, "timeout: %s", e->e_descr);
-            if ((*e->e_fn)(0, e->e_arg) < 0) {
-                free(e);
+            if (event_handle_timeout() < 0)
                 goto done;
-            }
-            free(e);
         }
         /* Prio files */
-        if ((ret = event_handle_fds(_ee_prio, 1)) < 0)
+        if ((ret = event_handle_fds(_ee_prio, 1, NULL, 0)) < 0)
             goto done;
         /* Unprio files */
-        if ((ret = event_handle_fds(_ee, 0)) < 0)
+        if ((ret = event_handle_fds(_ee, 0, rdy, nfds_max)) < 0)
             goto done;
         clixon_exit_decr(); /* If exit is set and > 1, decrement it (and exit when 1) */
   }
@@ -657,6 +1233,8 @@ clixon_event_loop(clixon_handle h)
     clixon_debug(CLIXON_DBG_EVENT, "retval:%d", retval);
     if (fds)
         free(fds);
+    if (rdy)
+        free(rdy);
     return retval;
 }
 
@@ -683,22 +1261,41 @@ clixon_event_exit(void)
     }
     _ee = NULL;
 
-    e_next = _ee_timers;
-    while ((e = e_next) != NULL){
-        e_next = e->e_next;
-        free(e);
-    }
+    while (_ee_timers_nr > 0)
+        free(_ee_timers[--_ee_timers_nr]);
+    if (_ee_timers)
+        free(_ee_timers);
     _ee_timers = NULL;
+    _ee_timers_max = 0;
+#ifdef HAVE_EPOLL_CREATE1
+    if (_event_epoll != -1 && _event_epoll_pid == getpid())
+        close(_event_epoll);
+    _event_epoll = -1;
+#endif
     return 0;
 }
 
 /*! Init clixon event handling
  *
- * Set which event handler to use: original select or new poll
+ * Set which event handler to use: original select, poll or epoll
+ * If epoll is not available on the platform or fails, poll is used.
+ * @param[in]  h   Clixon handle
+ * @retval     0   OK
  */
 int
 clixon_event_init(clixon_handle h)
 {
     _event_select = clicon_option_bool(h, "CLICON_EVENT_SELECT");
+#ifdef HAVE_EPOLL_CREATE1
+    if (!_event_select && clicon_option_bool(h, "CLICON_EVENT_EPOLL") &&
+        _event_epoll == -1 &&
+        event_epoll_open() < 0){
+        clixon_log(h, LOG_WARNING, "epoll: %s, using poll", clixon_err_reason());
+        clixon_err_reset();
+        if (_event_epoll != -1)
+            close(_event_epoll);
+        _event_epoll = -1;
+    }
+#endif
     return 0;
 }
@@ -84,6 +84,7 @@ struct event_data{
     enum {EVENT_FD, EVENT_TIME} e_type;                 /* Type of event */
     int                         e_fd;                   /* File descriptor */
     int                         e_prio;                 /* 1: high-prio FD:s only*/
+    int                         e_out;                  /* Wait for output instead of input */
     struct timeval              e_time;                 /* Timeout */
     void                       *e_arg;                  /* Function argument */
     char                        e_string[EVENT_STRLEN]; /* String for debugging */
@@ -139,6 +140,26 @@ clixon_event_select_reg_fd_prio(int         fd,
     return 0;
 }
 
+/*! Register a callback function to be called when output is possible on a file descriptor
+ *
+ * @param[in]  fd   File descriptor
+ * @param[in]  fn   Function to call when fd is writable
+ * @param[in]  arg  Argument to function fn
+ * @param[in]  str  Describing string for logging
+ * @see clixon_event_reg_fd_out
+ */
+int
+clixon_event_select_reg_fd_out(int         fd,
+                               int       (*fn)(int, void*),
+                               void       *arg,
+                               const char *str)
+{
+    if (clixon_event_select_reg_fd_prio(fd, fn, arg, str, 0) < 0)
+        return -1;
+    ee->e_out = 1;
+    return 0;
+}
+
 /*! Deregister a file descriptor callback
  *
  * @param[in]  s   File descriptor
@@ -307,11 +328,13 @@ clixon_event_select_loop(clixon_handle h)
     struct timeval     t0;
     struct timeval     tnull = {0,};
     fd_set             fdset;
+    fd_set             wrset;
     int                retval = -1;
     struct event_data *e_next;
 
     while (clixon_exit_get() != 1){
         FD_ZERO(&fdset);
+        FD_ZERO(&wrset);
         if (clicon_sig_child_get()){
             /* Go through processes and wait for child processes */
             if (clixon_process_waitpid(h) < 0)
@@ -320,17 +343,17 @@ clixon_event_select_loop(clixon_handle h)
         }
         for (e=ee; e; e=e->e_next)
             if (e->e_type == EVENT_FD)
-                FD_SET(e->e_fd, &fdset);
+                FD_SET(e->e_fd, e->e_out?&wrset:&fdset);
         if (ee_timers != NULL){
             gettimeofday(&t0, NULL);
             timersub(&ee_timers->e_time, &t0, &t);
             if (t.tv_sec < 0)
-                n = select(FD_SETSIZE, &fdset, NULL, NULL, &tnull);
+                n = select(FD_SETSIZE, &fdset, &wrset, NULL, &tnull);
             else
-                n = select(FD_SETSIZE, &fdset, NULL, NULL, &t);
+                n = select(FD_SETSIZE, &fdset, &wrset, NULL, &t);
         }
         else
-            n = select(FD_SETSIZE, &fdset, NULL, NULL, NULL);
+            n = select(FD_SETSIZE, &fdset, &wrset, NULL, NULL);
         if (clixon_exit_get() == 1){
             break;
         }
@@ -385,7 +408,7 @@ clixon_event_select_loop(clixon_handle h)
                 if (clixon_exit_get() == 1)
                     break;
                 e_next = e->e_next;
-                if (e->e_type == EVENT_FD && FD_ISSET(e->e_fd, &fdset) && e->e_prio){
+                if (e->e_type == EVENT_FD && e->e_prio && FD_ISSET(e->e_fd, &fdset)){
                     clixon_debug(CLIXON_DBG_EVENT, "FD_ISSET: %s prio:%d", e->e_string, e->e_prio);
                     if ((*e->e_fn)(e->e_fd, e->e_arg) < 0){
                         clixon_debug(CLIXON_DBG_EVENT, "Error in: %s", e->e_string);
@@ -405,7 +428,7 @@ clixon_event_select_loop(clixon_handle h)
             if (clixon_exit_get() == 1)
                 break;
             e_next = e->e_next;
-            if (e->e_type == EVENT_FD && FD_ISSET(e->e_fd, &fdset) && e->e_prio==0){
+            if (e->e_type == EVENT_FD && FD_ISSET(e->e_fd, e->e_out?&wrset:&fdset) && e->e_prio==0){
                 clixon_debug(CLIXON_DBG_EVENT, "FD_ISSET: %s", e->e_string);
                 if ((*e->e_fn)(e->e_fd, e->e_arg) < 0){
                     clixon_debug(CLIXON_DBG_EVENT, "Error in: %s", e->e_string);
@@ -44,6 +44,7 @@
  * Prototypes
  */
 int clixon_event_select_reg_fd_prio(int fd, int (*fn)(int, void*), void *arg, const char *str, int prio);
+int clixon_event_select_reg_fd_out(int fd, int (*fn)(int, void*), void *arg, const char *str);
 int clixon_event_select_unreg_fd(int s, int (*fn)(int, void*));
 int clixon_event_select_reg_timeout(struct timeval t,  int (*fn)(int, void*),
                              void *arg, const char *str);
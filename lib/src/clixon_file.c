@@ -38,6 +38,9 @@
 #include "clixon_config.h"
 #endif
 
+#ifdef HAVE_FOPENCOOKIE /* for zstd compressed streams */
+#define _GNU_SOURCE
+#endif
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -51,6 +54,9 @@
 #include <unistd.h>
 #include <netinet/in.h>
 #include <stddef.h>
+#if defined(HAVE_LIBZSTD) && defined(HAVE_FOPENCOOKIE)
+#include <zstd.h>
+#endif
 
 /* cligen */
 #include <cligen/cligen.h>
@@ -416,6 +422,140 @@ clicon_dir_copy(const char *srcdir,
     return retval;
 }
 
+/*! Check if two files have equal content
+ *
+ * @param[in]  file1   First filename
+ * @param[in]  file2   Second filename
+ * @retval     1       Equal
+ * @retval     0       Not equal, or second file does not exist
+ * @retval    -1       Error
+ */
+static int
+clicon_file_equal(const char *file1,
+                  const char *file2)
+{
+    int         retval = -1;
+    int         fd1 = -1;
+    int         fd2 = -1;
+    struct stat st1;
+    struct stat st2;
+    char        buf1[4096];
+    char        buf2[4096];
+    ssize_t     len1;
+    ssize_t     len2;
+
+    if (stat(file1, &st1) != 0){
+        clixon_err(OE_UNIX, errno, "stat(%s)", file1);
+        goto done;
+    }
+    if (stat(file2, &st2) != 0 || st1.st_size != st2.st_size)
+        goto noteq;
+    if ((fd1 = open(file1, O_RDONLY)) < 0){
+        clixon_err(OE_UNIX, errno, "open(%s) for read", file1);
+        goto done;
+    }
+    if ((fd2 = open(file2, O_RDONLY)) < 0)
+        goto noteq;
+    while ((len1 = read(fd1, buf1, sizeof(buf1))) > 0){
+        if ((len2 = read(fd2, buf2, len1)) != len1 ||
+            memcmp(buf1, buf2, len1) != 0)
+            goto noteq;
+    }
+    if (len1 < 0){
+        clixon_err(OE_UNIX, errno, "read(%s)", file1);
+        goto done;
+    }
+    retval = 1;
+ done:
+    if (fd1 != -1)
+        close(fd1);
+    if (fd2 != -1)
+        close(fd2);
+    return retval;
+ noteq:
+    retval = 0;
+    goto done;
+}
+
+/*! Synchronize destination directory with source directory, non-recursive
+ *
+ * Only files that differ or are missing in destination are copied, and they are synced
+ * to disk. Files in destination that do not exist in source are removed.
+ * @param[in]  srcdir  Source dirname
+ * @param[out] dstdir  Destination dirname
+ * @retval     0       OK
+ * @retval    -1       Error
+ * @see clicon_dir_copy  which copies all files
+ */
+int
+clicon_dir_sync(const char *srcdir,
+                const char *dstdir)
+{
+    int            retval = -1;
+    struct dirent *dent = NULL;
+    DIR           *dirp = NULL;
+    char           srcfile[MAXPATHLEN];
+    char           dstfile[MAXPATHLEN];
+    struct stat    st;
+    int            stset;
+    unsigned char  d_type;
+    int            fd;
+    int            ret;
+
+    if (srcdir == NULL || dstdir == NULL){
+        clixon_err(OE_UNIX, EINVAL, "Requires src and dst dir != NULL");
+        goto done;
+    }
+    if ((dirp = opendir(srcdir)) != NULL){
+        while ((dent = readdir(dirp)) != NULL) {
+            snprintf(srcfile, MAXPATHLEN-1, "%s/%s", srcdir, dent->d_name);
+            if (clixon_filetype(dent, srcfile, &d_type, &st, &stset) < 0) /* Adjust d_type */
+                goto done;
+            if (d_type != DT_REG)
+                continue;
+            snprintf(dstfile, MAXPATHLEN-1, "%s/%s", dstdir, dent->d_name);
+            if ((ret = clicon_file_equal(srcfile, dstfile)) < 0)
+                goto done;
+            if (ret == 1)
+                continue;
+            if (clicon_file_copy(srcfile, dstfile) < 0)
+                goto done;
+            if ((fd = open(dstfile, O_RDONLY)) < 0){
+                clixon_err(OE_UNIX, errno, "open(%s)", dstfile);
+                goto done;
+            }
+            if (fsync(fd) < 0){
+                clixon_err(OE_UNIX, errno, "fsync(%s)", dstfile);
+                close(fd);
+                goto done;
+            }
+            close(fd);
+        }
+        closedir(dirp);
+        dirp = NULL;
+    }
+    /* Remove stale files */
+    if ((dirp = opendir(dstdir)) != NULL){
+        while ((dent = readdir(dirp)) != NULL) {
+            snprintf(dstfile, MAXPATHLEN-1, "%s/%s", dstdir, dent->d_name);
+            if (clixon_filetype(dent, dstfile, &d_type, &st, &stset) < 0)
+                goto done;
+            if (d_type != DT_REG)
+                continue;
+            snprintf(srcfile, MAXPATHLEN-1, "%s/%s", srcdir, dent->d_name);
+            if (access(srcfile, F_OK) < 0 && unlink(dstfile) < 0){
+                clixon_err(OE_UNIX, errno, "unlink(%s)", dstfile);
+                goto done;
+            }
+        }
+    }
+    retval = 0;
+ done:
+    if (dirp)
+        closedir(dirp);
+    return retval;
+}
+
 /*! Read content of file into cbuf
  *
  * @param[in]   filename
@@ -503,3 +643,308 @@ clixon_dir_remove_files(const char *dir,
         cbuf_free(cb);
     return retval;
 }
+
+/* zstd frame magic number 0xFD2FB528, first bytes of a compressed file */
+static const unsigned char zfile_magic[] = {0x28, 0xb5, 0x2f, 0xfd};
+
+#if defined(HAVE_LIBZSTD) && defined(HAVE_FOPENCOOKIE)
+/*! Cookie of a zstd compressed stream, see clicon_file_zfdopen
+ */
+struct zfile {
+    int            zf_fd;     /* Underlying file descriptor */
+    ZSTD_CStream  *zf_cs;     /* Compression stream, if written */
+    ZSTD_DStream  *zf_ds;     /* Decompression stream, if read */
+    char          *zf_buf;    /* Chunk of compressed data */
+    size_t         zf_buflen; /* Size of chunk */
+    ZSTD_inBuffer  zf_in;     /* Read: compressed data in chunk not yet decompressed */
+    size_t         zf_hint;   /* Read: 0 if at end of frame */
+};
+
+/*! Write all of a buffer to a file descriptor
+ */
+static int
+zfile_writen(int         fd,
+             const char *buf,
+             size_t      len)
+{
+    ssize_t n;
+
+    while (len > 0){
+        if ((n = write(fd, buf, len)) < 0){
+            if (errno == EINTR)
+                continue;
+            return -1;
+        }
+        buf += n;
+        len -= n;
+    }
+    return 0;
+}
+
+/*! Compress and write a buffer, fopencookie write function
+ */
+static ssize_t
+zfile_write(void       *cookie,
+            const char *buf,
+            size_t      size)
+{
+    struct zfile  *zf = (struct zfile *)cookie;
+    ZSTD_inBuffer  in = {buf, size, 0};
+    ZSTD_outBuffer out;
+    size_t         ret;
+
+    while (in.pos < in.size){
+        out.dst = zf->zf_buf;
+        out.size = zf->zf_buflen;
+        out.pos = 0;
+        ret = ZSTD_compressStream2(zf->zf_cs, &out, &in, ZSTD_e_continue);
+        if (ZSTD_isError(ret)){
+            errno = EIO;
+            return -1;
+        }
+        if (zfile_writen(zf->zf_fd, zf->zf_buf, out.pos) < 0)
+            return -1;
+    }
+    return size;
+}
+
+/*! Read and decompress into a buffer, fopencookie read function
+ *
+ * @retval  n  Number of decompressed bytes, 0 at end of file
+ * @retval -1  Error, including a truncated file
+ */
+static ssize_t
+zfile_read(void   *cookie,
+           char   *buf,
+           size_t  size)
+{
+    struct zfile  *zf = (struct zfile *)cookie;
+    ZSTD_outBuffer out = {buf, size, 0};
+    size_t         ret;
+    size_t         pos;
+    ssize_t        n;
+
+    for (;;){
+        /* Also called with empty input to flush output buffered in the stream */
+        pos = zf->zf_in.pos;
+        ret = ZSTD_decompressStream(zf->zf_ds, &out, &zf->zf_in);
+        if (ZSTD_isError(ret)){
+            errno = EIO;
+            return -1;
+        }
+        if (zf->zf_in.pos != pos || out.pos > 0) /* Hint of empty call is of next frame */
+            zf->zf_hint = ret;
+        if (out.pos > 0)
+            break;
+        if (zf->zf_in.pos < zf->zf_in.size)
+            continue;
+        if ((n = read(zf->zf_fd, zf->zf_buf, zf->zf_buflen)) < 0){
+            if (errno == EINTR)
+                continue;
+            return -1;
+        }
+        if (n == 0){
+            if (zf->zf_hint != 0){ /* Truncated frame */
+                errno = EIO;
+                return -1;
+            }
+            break;
+        }
+        zf->zf_in.src = zf->zf_buf;
+        zf->zf_in.size = n;
+        zf->zf_in.pos = 0;
+    }
+    return out.pos;
+}
+
+/*! End compressed frame, free stream and close file, fopencookie close function
+ */
+static int
+zfile_close(void *cookie)
+{
+    struct zfile  *zf = (struct zfile *)cookie;
+    ZSTD_inBuffer  in = {NULL, 0, 0};
+    ZSTD_outBuffer out;
+    size_t         ret = 0;
+    int            retval = 0;
+
+    if (zf->zf_cs){
+        do {
+            out.dst = zf->zf_buf;
+            out.size = zf->zf_buflen;
+            out.pos = 0;
+            ret = ZSTD_compressStream2(zf->zf_cs, &out, &in, ZSTD_e_end);
+            if (ZSTD_isError(ret)){
+                errno = EIO;
+                retval = -1;
+                break;
+            }
+            if (zfile_writen(zf->zf_fd, zf->zf_buf, out.pos) < 0){
+                retval = -1;
+                break;
+            }
+        } while (ret != 0);
+        ZSTD_freeCStream(zf->zf_cs);
+    }
+    if (zf->zf_ds)
+        ZSTD_freeDStream(zf->zf_ds);
+    if (zf->zf_buf)
+        free(zf->zf_buf);
+    if (close(zf->zf_fd) < 0)
+        retval = -1;
+    free(zf);
+    return retval;
+}
+
+/*! Open a zstd compressed stream on a file descriptor
+ *
+ * @param[in]  fd     File descriptor
+ * @param[in]  write  If set, compress with level, else decompress
+ * @param[in]  level  zstd compression level
+ * @retval     f      Stream
+ * @retval     NULL   Error
+ */
+static FILE *
+zfile_open(int fd,
+           int write,
+           int level)
+{
+    FILE                  *f = NULL;
+    struct zfile          *zf;
+    cookie_io_functions_t  iofn = {zfile_read, zfile_write, NULL, zfile_close};
+    size_t                 ret;
+
+    if ((zf = calloc(1, sizeof(*zf))) == NULL){
+        clixon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    zf->zf_hint = 1;
+    if (write){
+        zf->zf_buflen = ZSTD_CStreamOutSize();
+        if ((zf->zf_cs = ZSTD_createCStream()) == NULL){
+            clixon_err(OE_UNIX, ENOMEM, "ZSTD_createCStream");
+            goto done;
+        }
+        ret = ZSTD_CCtx_setParameter(zf->zf_cs, ZSTD_c_compressionLevel, level);
+        if (ZSTD_isError(ret)){
+            clixon_err(OE_UNIX, EINVAL, "ZSTD_CCtx_setParameter: %s", ZSTD_getErrorName(ret));
+            goto done;
+        }
+    }
+    else{
+        zf->zf_buflen = ZSTD_DStreamInSize();
+        if ((zf->zf_ds = ZSTD_createDStream()) == NULL){
+            clixon_err(OE_UNIX, ENOMEM, "ZSTD_createDStream");
+            goto done;
+        }
+    }
+    if ((zf->zf_buf = malloc(zf->zf_buflen)) == NULL){
+        clixon_err(OE_UNIX, errno, "malloc");
+        goto done;
+    }
+    zf->zf_fd = fd;
+    if ((f = fopencookie(zf, write?"w":"r", iofn)) == NULL){
+        clixon_err(OE_UNIX, errno, "fopencookie");
+        goto done;
+    }
+    zf = NULL; /* Owned by f */
+ done:
+    if (zf){
+        if (zf->zf_cs)
+            ZSTD_freeCStream(zf->zf_cs);
+        if (zf->zf_ds)
+            ZSTD_freeDStream(zf->zf_ds);
+        if (zf->zf_buf)
+            free(zf->zf_buf);
+        free(zf);
+    }
+    return f;
+}
+#endif /* HAVE_LIBZSTD && HAVE_FOPENCOOKIE */
+
+/*! Open a stream on a file descriptor with optional zstd compression
+ *
+ * A read stream is decompressed if the file starts with the zstd magic number, otherwise it
+ * is read as is. Data is (de)compressed in chunks as it is read or written, the whole
+ * uncompressed text is not kept in memory.
+ * @param[in]  fd     Open file descriptor of a regular file at offset 0, closed by fclose
+ * @param[in]  mode   "r" or "w"
+ * @param[in]  level  Write: zstd compression level, 0 is no compression. Read: not used
+ * @retval     f      Stream, close with fclose(). Close of a compressed stream ends the frame
+ * @retval     NULL   Error, fd is not closed
+ * @see clicon_file_zfopen
+ */
+FILE *
+clicon_file_zfdopen(int         fd,
+                    const char *mode,
+                    int         level)
+{
+    FILE         *f = NULL;
+    unsigned char magic[sizeof(zfile_magic)];
+    ssize_t       n;
+
+    if (*mode == 'r'){
+        if ((n = pread(fd, magic, sizeof(magic), 0)) < 0){
+            clixon_err(OE_UNIX, errno, "pread");
+            goto done;
+        }
+        if (n == sizeof(magic) && memcmp(magic, zfile_magic, sizeof(magic)) == 0){
+#if defined(HAVE_LIBZSTD) && defined(HAVE_FOPENCOOKIE)
+            f = zfile_open(fd, 0, 0);
+#else
+            clixon_err(OE_UNIX, ENOTSUP, "File is zstd compressed but zstd is not supported, see configure");
+#endif
+            goto done;
+        }
+    }
+    else if (level != 0){
+#if defined(HAVE_LIBZSTD) && defined(HAVE_FOPENCOOKIE)
+        f = zfile_open(fd, 1, level);
+#else
+        clixon_err(OE_UNIX, ENOTSUP, "zstd compression is not supported, see configure");
+#endif
+        goto done;
+    }
+    if ((f = fdopen(fd, mode)) == NULL)
+        clixon_err(OE_UNIX, errno, "fdopen");
+ done:
+    return f;
+}
+
+/*! Open a file for reading or writing with optional zstd compression
+ *
+ * @param[in]  filename  File
+ * @param[in]  mode      "r" or "w"
+ * @param[in]  level     Write: zstd compression level, 0 is no compression. Read: not used
+ * @retval     f         Stream, close with fclose()
+ * @retval     NULL      Error
+ * @code
+ *   if ((f = clicon_file_zfopen(filename, "w", 3)) == NULL)
+ *      err;
+ *   fprintf(f, ...);
+ *   if (fclose(f) != 0)
+ *      err;
+ * @endcode
+ * @see clicon_file_zfdopen
+ */
+FILE *
+clicon_file_zfopen(const char *filename,
+                   const char *mode,
+                   int         level)
+{
+    FILE *f = NULL;
+    int   fd;
+
+    if (*mode == 'r')
+        fd = open(filename, O_RDONLY);
+    else
+        fd = open(filename, O_WRONLY|O_CREAT|O_TRUNC, 0666);
+    if (fd < 0){
+        clixon_err(OE_UNIX, errno, "open(%s)", filename);
+        goto done;
+    }
+    if ((f = clicon_file_zfdopen(fd, mode, level)) == NULL)
+        close(fd);
+ done:
+    return f;
+}
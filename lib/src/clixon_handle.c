@@ -93,6 +93,7 @@ struct clixon_handle {
     clicon_hash_t    *ch_data;     /* internal clicon data (HDR) */
     clicon_hash_t    *ch_db_elmnt; /* xml datastore element cache data */
     event_stream_t   *ch_stream;   /* notification streams, see clixon_stream.[ch] */
+    void             *ch_optv;     /* typed option values, see clicon_option_bool_id */
 };
 
 /*! Internal call to allocate a CLICON handle. 
@@ -167,6 +168,8 @@ clixon_handle_exit(clixon_handle h)
         clicon_hash_free(ha);
     if ((ha = clicon_db_elmnt(h)) != NULL)
         clicon_hash_free(ha);
+    if (ch->ch_optv)
+        free(ch->ch_optv);
     free(ch);
     retval = 0;
     return retval;
@@ -199,6 +202,34 @@ clicon_options(clixon_handle h)
     return ch->ch_copt;
 }
 
+/*! Return typed option values given a handle, or NULL
+ *
+ * @param[in]  h        Clixon handle
+ * @see clicon_option_bool_id
+ */
+void *
+clicon_option_values(clixon_handle h)
+{
+    struct clixon_handle *ch = handle(h);
+
+    return ch->ch_optv;
+}
+
+/*! Set typed option values of a handle, freed in clixon_handle_exit
+ *
+ * @param[in]  h        Clixon handle
+ * @param[in]  optv     Malloced option values
+ */
+int
+clicon_option_values_set(clixon_handle h,
+                         void         *optv)
+{
+    struct clixon_handle *ch = handle(h);
+
+    ch->ch_optv = optv;
+    return 0;
+}
+
 /*! Return clicon data (hash-array) given a handle.
  *
  * @param[in]  h        Clixon handle
@@ -39,6 +39,7 @@
  * A simple implementation of a associative array style data store. Keys
  * are always strings while values can be some arbitrary data referenced
  * by void*.
+ * The table uses open addressing with linear probing and is resized on load factor.
  *
  * XXX: functions such as hash_keys(), hash_value() etc are currently returning
  * pointers to the actual data storage. Should probably make copies.
@@ -94,40 +95,178 @@
 #include <cligen/cligen.h>
 
 /* clixon */
-#include "clixon_queue.h"
 #include "clixon_hash.h"
 #include "clixon_handle.h"
 #include "clixon_yang.h"
 #include "clixon_xml.h"
 #include "clixon_err.h"
 
-#define HASH_SIZE       1031    /* Number of hash buckets. Should be a prime */
+#define HASH_SIZE0      16      /* Initial number of slots, power of two */
 #define HASH_NO_PTR     SIZE_MAX
 #define align4(s) (((s)/4)*4 + 4)
 
-/*! A very simplistic algorithm to calculate a hash bucket index
+/* Multiplication constants of string hash */
+#define HASH_M1         0x9e3779b97f4a7c15ULL
+#define HASH_M2         0xbf58476d1ce4e5b9ULL
+#define HASH_M3         0x94d049bb133111ebULL
+
+/*! Slot of open addressing hash table
+ */
+struct hash_slot {
+    size_t                hs_hash;  /* Hash value of key */
+    struct clicon_hash   *hs_entry; /* Entry, or NULL if slot is empty */
+};
+
+/*! Hash table with open addressing and linear probing
+ *
+ * Returned by clicon_hash_init as clicon_hash_t *
+ * Entries are allocated separately so that entry pointers are stable when the table is
+ * resized. The table is doubled when it is more than 3/4 full.
+ */
+struct hash_table {
+    struct hash_slot *ht_slots; /* Vector of slots */
+    size_t            ht_size;  /* Number of slots, power of two */
+    size_t            ht_nr;    /* Number of entries */
+};
+
+/*! Final avalanche of a 64-bit hash value (splitmix64)
  */
-static uint32_t
-hash_bucket(const char *str)
+static inline uint64_t
+hash_mix(uint64_t h)
 {
-    uint32_t n = 0;
+    h ^= h >> 30;
+    h *= HASH_M2;
+    h ^= h >> 27;
+    h *= HASH_M3;
+    h ^= h >> 31;
+    return h;
+}
 
-    while(*str)
-        n += (uint32_t)*str++;
-    return n % HASH_SIZE;
+/*! Hash a string, eight bytes at a time
+ *
+ * Similar keys such as "eth1" and "eth2", or permutations, get unrelated values
+ */
+static size_t
+hash_string(const char *str)
+{
+    size_t   len = strlen(str);
+    uint64_t h = HASH_M1 ^ len;
+    uint64_t k;
+
+    while (len >= 8){
+        memcpy(&k, str, 8);
+        h ^= hash_mix(k);
+        h = ((h << 27) | (h >> 37)) * HASH_M1;
+        str += 8;
+        len -= 8;
+    }
+    if (len){
+        k = 0;
+        memcpy(&k, str, len);
+        h ^= hash_mix(k);
+        h = ((h << 27) | (h >> 37)) * HASH_M1;
+    }
+    return (size_t)hash_mix(h);
 }
 
-static uint32_t
+/*! Hash a pointer
+ */
+static size_t
 hash_ptr(void *p)
 {
-    uint32_t n = 0;
-    uintptr_t h = (uintptr_t)p;
+    return (size_t)hash_mix((uint64_t)(uintptr_t)p);
+}
+
+/*! Find slot of key or empty slot where key is inserted
+ *
+ * @param[in]  ht    Hash table
+ * @param[in]  hval  Hash value of key
+ * @param[in]  key   Key
+ * @param[in]  ptr   If set, compare key as pointer, otherwise as string
+ * @retval     slot  Slot of key if found, otherwise empty slot
+ */
+static struct hash_slot *
+hash_slot_find(struct hash_table *ht,
+               size_t             hval,
+               const void        *key,
+               int                ptr)
+{
+    size_t            mask = ht->ht_size - 1;
+    size_t            i;
+    struct hash_slot *hs;
+
+    for (i = hval & mask; ; i = (i + 1) & mask){
+        hs = &ht->ht_slots[i];
+        if (hs->hs_entry == NULL)
+            break;
+        if (hs->hs_hash == hval &&
+            (ptr ? hs->hs_entry->h_key == key : strcmp(hs->hs_entry->h_key, key) == 0))
+            break;
+    }
+    return hs;
+}
+
+/*! Double the number of slots of a hash table
+ *
+ * @param[in]  ht   Hash table
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+hash_grow(struct hash_table *ht)
+{
+    struct hash_slot *old = ht->ht_slots;
+    size_t            oldsize = ht->ht_size;
+    size_t            mask;
+    size_t            i;
+    size_t            j;
+
+    if ((ht->ht_slots = calloc(oldsize*2, sizeof(struct hash_slot))) == NULL){
+        clixon_err(OE_UNIX, errno, "calloc");
+        ht->ht_slots = old;
+        return -1;
+    }
+    ht->ht_size = oldsize*2;
+    mask = ht->ht_size - 1;
+    for (i = 0; i < oldsize; i++){
+        if (old[i].hs_entry == NULL)
+            continue;
+        for (j = old[i].hs_hash & mask; ht->ht_slots[j].hs_entry; j = (j + 1) & mask)
+            ;
+        ht->ht_slots[j] = old[i];
+    }
+    free(old);
+    return 0;
+}
 
-    for (size_t i = 0; i < sizeof(h); i++) {
-        n += (uint8_t)h;
-        h >>= 8;
+/*! Remove entry of slot from hash table by shifting following entries back
+ *
+ * Linear probing without tombstones: entries after the removed slot that would
+ * otherwise not be found are moved back
+ * @param[in]  ht   Hash table
+ * @param[in]  hs   Slot of entry to remove
+ */
+static void
+hash_slot_rm(struct hash_table *ht,
+             struct hash_slot  *hs)
+{
+    size_t mask = ht->ht_size - 1;
+    size_t i;
+    size_t j;
+    size_t k;
+
+    i = hs - ht->ht_slots;
+    for (j = (i + 1) & mask; ht->ht_slots[j].hs_entry; j = (j + 1) & mask){
+        k = ht->ht_slots[j].hs_hash & mask; /* Home slot of entry j */
+        /* Move if home slot is not cyclically in (i, j] */
+        if (i <= j ? (k <= i || k > j) : (k <= i && k > j)){
+            ht->ht_slots[i] = ht->ht_slots[j];
+            i = j;
+        }
     }
-    return n % HASH_SIZE;
+    ht->ht_slots[i].hs_entry = NULL;
+    ht->ht_slots[i].hs_hash = 0;
+    ht->ht_nr--;
 }
 
 /*! Initialize hash table.
@@ -139,14 +278,20 @@ hash_ptr(void *p)
 clicon_hash_t *
 clicon_hash_init(void)
 {
-  clicon_hash_t *hash;
-
-  if ((hash = (clicon_hash_t *)malloc(sizeof(clicon_hash_t) * HASH_SIZE)) == NULL){
-      clixon_err(OE_UNIX, errno, "malloc");
-      return NULL;
-  }
-  memset(hash, 0, sizeof(clicon_hash_t)*HASH_SIZE);
-  return hash;
+    struct hash_table *ht;
+
+    if ((ht = (struct hash_table *)malloc(sizeof(*ht))) == NULL){
+        clixon_err(OE_UNIX, errno, "malloc");
+        return NULL;
+    }
+    memset(ht, 0, sizeof(*ht));
+    if ((ht->ht_slots = calloc(HASH_SIZE0, sizeof(struct hash_slot))) == NULL){
+        clixon_err(OE_UNIX, errno, "calloc");
+        free(ht);
+        return NULL;
+    }
+    ht->ht_size = HASH_SIZE0;
+    return (clicon_hash_t *)ht;
 }
 
 /*! Free hash table.
@@ -158,21 +303,21 @@ clicon_hash_init(void)
 int
 clicon_hash_free(clicon_hash_t *hash)
 {
-    int i;
-    clicon_hash_t tmp;
-
-    for (i = 0; i < HASH_SIZE; i++) {
-        while (hash[i]) {
-            tmp = hash[i];
-            DELQ(tmp, hash[i], clicon_hash_t);
-            if (tmp->h_vlen != HASH_NO_PTR) {
-              free(tmp->h_key);
-              free(tmp->h_val);
-            }
-            free(tmp);
+    struct hash_table *ht = (struct hash_table *)hash;
+    clicon_hash_t      h;
+    size_t             i;
+
+    for (i = 0; i < ht->ht_size; i++) {
+        if ((h = ht->ht_slots[i].hs_entry) == NULL)
+            continue;
+        if (h->h_vlen != HASH_NO_PTR) {
+            free(h->h_key);
+            free(h->h_val);
         }
+        free(h);
     }
-    free(hash);
+    free(ht->ht_slots);
+    free(ht);
     return 0;
 }
 
@@ -187,38 +332,18 @@ clicon_hash_t
 clicon_hash_lookup(clicon_hash_t *hash,
                    const char    *key)
 {
-    uint32_t      bkt;
-    clicon_hash_t h;
+    struct hash_table *ht = (struct hash_table *)hash;
 
-    bkt = hash_bucket(key);
-    h = hash[bkt];
-    if (h) {
-        do {
-            if (!strcmp(h->h_key, key))
-                return h;
-            h = NEXTQ(clicon_hash_t, h);
-        } while (h != hash[bkt]);
-    }
-    return NULL;
+    return hash_slot_find(ht, hash_string(key), key, 0)->hs_entry;
 }
 
 clicon_hash_t
 clicon_hash_lookup_ptr(clicon_hash_t *hash,
                        void          *key)
 {
-    uint32_t      bkt;
-    clicon_hash_t h;
+    struct hash_table *ht = (struct hash_table *)hash;
 
-    bkt = hash_ptr(key);
-    h = hash[bkt];
-    if (h) {
-        do {
-            if (h->h_key == key)
-                return h;
-            h = NEXTQ(clicon_hash_t, h);
-        } while (h != hash[bkt]);
-    }
-    return NULL;
+    return hash_slot_find(ht, hash_ptr(key), key, 1)->hs_entry;
 }
 
 /*! Get value of hash
@@ -266,6 +391,32 @@ clicon_hash_ptr_value(clicon_hash_t *hash,
     return h->h_val;
 }
 
+/*! Insert new entry in hash table, grow table first if needed
+ *
+ * @param[in]  ht    Hash table
+ * @param[in]  hval  Hash value of key
+ * @param[in]  h     New entry, key not in table
+ * @param[in]  ptr   If set, key is a pointer, otherwise a string
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+static int
+hash_insert(struct hash_table *ht,
+            size_t             hval,
+            clicon_hash_t      h,
+            int                ptr)
+{
+    struct hash_slot *hs;
+
+    if ((ht->ht_nr + 1)*4 > ht->ht_size*3 && hash_grow(ht) < 0)
+        return -1;
+    hs = hash_slot_find(ht, hval, h->h_key, ptr);
+    hs->hs_hash = hval;
+    hs->hs_entry = h;
+    ht->ht_nr++;
+    return 0;
+}
+
 /*! Copy value and add hash entry.
  *
  * @param[in] hash   Hash table
@@ -285,6 +436,7 @@ clicon_hash_add(clicon_hash_t *hash,
     void         *newval = NULL;
     clicon_hash_t h;
     clicon_hash_t new = NULL;
+    size_t        hval;
 
     if (hash == NULL){
         clixon_err(OE_UNIX, EINVAL, "hash is NULL");
@@ -297,7 +449,8 @@ clicon_hash_add(clicon_hash_t *hash,
         goto catch;
     }
     /* If variable exist, don't allocate a new. just replace value */
-    h = clicon_hash_lookup(hash, key);
+    hval = hash_string(key);
+    h = hash_slot_find((struct hash_table *)hash, hval, key, 0)->hs_entry;
     if (h == NULL) {
         if ((new = (clicon_hash_t)malloc(sizeof(*new))) == NULL){
             clixon_err(OE_UNIX, errno, "malloc");
@@ -320,19 +473,20 @@ clicon_hash_add(clicon_hash_t *hash,
         }
         memcpy(newval, val, vlen);
     }
+    /* Add to table only if new variable */
+    if (new &&
+        hash_insert((struct hash_table *)hash, hval, new, 0) < 0)
+        goto catch;
     /* Free old value if existing variable */
     if (h->h_val)
         free(h->h_val);
     h->h_val = newval;
     h->h_vlen =  vlen;
-
-    /* Add to list only if new variable */
-    if (new)
-        INSQ(h, hash[hash_bucket(key)]);
-
     return h;
 
 catch:
+    if (newval)
+        free(newval);
     if (new) {
         if (new->h_key)
             free(new->h_key);
@@ -349,13 +503,15 @@ clicon_hash_add_ptr(clicon_hash_t *hash,
 {
     clicon_hash_t h;
     clicon_hash_t new = NULL;
+    size_t        hval;
 
     if (hash == NULL){
         clixon_err(OE_UNIX, EINVAL, "hash is NULL");
         return NULL;
     }
     /* If variable exist, don't allocate a new. just replace value */
-    h = clicon_hash_lookup_ptr(hash, key);
+    hval = hash_ptr(key);
+    h = hash_slot_find((struct hash_table *)hash, hval, key, 1)->hs_entry;
     if (h == NULL) {
         if ((new = (clicon_hash_t)malloc(sizeof(*new))) == NULL){
             clixon_err(OE_UNIX, errno, "malloc");
@@ -364,18 +520,16 @@ clicon_hash_add_ptr(clicon_hash_t *hash,
         memset(new, 0, sizeof(*new));
         new->h_key = key;
         if (new->h_key == NULL){
-            clixon_err(OE_UNIX, errno, "strdup");
+            clixon_err(OE_UNIX, EINVAL, "key is NULL");
             goto catch;
         }
+        /* Add to table only if new variable */
+        if (hash_insert((struct hash_table *)hash, hval, new, 1) < 0)
+            goto catch;
         h = new;
     }
     h->h_val = val;
     h->h_vlen =  HASH_NO_PTR;
-
-    /* Add to list only if new variable */
-    if (new)
-        INSQ(h, hash[hash_ptr(key)]);
-
     return h;
 
 catch:
@@ -396,16 +550,18 @@ int
 clicon_hash_del(clicon_hash_t *hash,
                 const char    *key)
 {
-    clicon_hash_t h;
+    struct hash_table *ht = (struct hash_table *)hash;
+    struct hash_slot  *hs;
+    clicon_hash_t      h;
 
     if (hash == NULL){
         clixon_err(OE_UNIX, EINVAL, "hash is NULL");
         return -1;
     }
-    h = clicon_hash_lookup(hash, key);
-    if (h == NULL)
+    hs = hash_slot_find(ht, hash_string(key), key, 0);
+    if ((h = hs->hs_entry) == NULL)
         return -1;
-    DELQ(h, hash[hash_bucket(key)], clicon_hash_t);
+    hash_slot_rm(ht, hs);
     free(h->h_key);
     free(h->h_val);
     free(h);
@@ -417,16 +573,18 @@ int
 clicon_hash_del_ptr(clicon_hash_t *hash,
                     void          *key)
 {
-    clicon_hash_t h;
+    struct hash_table *ht = (struct hash_table *)hash;
+    struct hash_slot  *hs;
+    clicon_hash_t      h;
 
     if (hash == NULL){
         clixon_err(OE_UNIX, EINVAL, "hash is NULL");
         return -1;
     }
-    h = clicon_hash_lookup_ptr(hash, key);
-    if (h == NULL)
+    hs = hash_slot_find(ht, hash_ptr(key), key, 1);
+    if ((h = hs->hs_entry) == NULL)
         return -1;
-    DELQ(h, hash[hash_ptr(key)], clicon_hash_t);
+    hash_slot_rm(ht, hs);
     free(h);
 
     return 0;
@@ -446,42 +604,29 @@ clicon_hash_keys(clicon_hash_t *hash,
                  char        ***vector,
                  size_t        *nkeys)
 {
-    int           retval = -1;
-    int           bkt;
-    clicon_hash_t h;
-    char        **tmp;
-    char        **keys = NULL;
+    struct hash_table *ht = (struct hash_table *)hash;
+    char             **keys = NULL;
+    size_t             i;
 
     if (hash == NULL){
         clixon_err(OE_UNIX, EINVAL, "hash is NULL");
         return -1;
     }
     *nkeys = 0;
-    for (bkt = 0; bkt < HASH_SIZE; bkt++) {
-        h = hash[bkt];
-        do {
-            if (h == NULL)
-                break;
-            tmp = realloc(keys, ((*nkeys)+1) * sizeof(char *));
-            if (tmp == NULL){
-                clixon_err(OE_UNIX, errno, "realloc");
-                goto catch;
-            }
-            keys = tmp;
-            keys[*nkeys] = h->h_key;
-            (*nkeys)++;
-            h = NEXTQ(clicon_hash_t, h);
-        } while (h != hash[bkt]);
+    if (ht->ht_nr > 0){
+        if ((keys = malloc(ht->ht_nr * sizeof(char *))) == NULL){
+            clixon_err(OE_UNIX, errno, "malloc");
+            return -1;
+        }
+        for (i = 0; i < ht->ht_size; i++)
+            if (ht->ht_slots[i].hs_entry)
+                keys[(*nkeys)++] = ht->ht_slots[i].hs_entry->h_key;
     }
-    if (vector){
+    if (vector)
         *vector = keys;
-        keys = NULL;
-    }
-    retval = 0;
-catch:
-    if (keys)
+    else if (keys)
         free(keys);
-    return retval;
+    return 0;
 }
 
 /*! Dump contents of hash to FILE pointer.
@@ -60,6 +60,7 @@
 /* clixon */
 #include "clixon_queue.h"
 #include "clixon_string.h"
+#include "clixon_map.h"
 #include "clixon_hash.h"
 #include "clixon_handle.h"
 #include "clixon_yang.h"
@@ -74,8 +75,12 @@
 #include "clixon_xml_bind.h"
 #include "clixon_xml_map.h"
 #include "clixon_xml_nsctx.h" /* namespace context */
+#include "clixon_xpath_ctx.h"
+#include "clixon_xpath.h"
 #include "clixon_yang_schema_mount.h"
 #include "clixon_netconf_lib.h"
+#include "clixon_digest.h"
+#include "clixon_xml_io.h"
 #include "clixon_json.h"
 #include "clixon_json_parse.h"
 
@@ -253,41 +258,43 @@ static int
 json_str_escape_cdata(cbuf *cb,
                       char *str)
 {
-    int    retval = -1;
-    size_t len;
-    int    i;
+    char  *s = str;
+    size_t n;
 
-    len = strlen(str);
-    for (i=0; i<len; i++)
-        switch (str[i]){
+    /* Copy runs of characters not escaped in bulk, strcspn is vectorized in libc */
+    while (*s != '\0'){
+        if ((n = strcspn(s, "\"\\\b\f\n\r\t")) > 0){
+            cbuf_append_buf(cb, s, n);
+            s += n;
+        }
+        switch (*s){
+        case '\0':
+            continue;
         case '\"':
-            cprintf(cb, "\\\"");
+            cbuf_append_str(cb, "\\\"");
             break;
         case '\\':
-            cprintf(cb, "\\\\");
+            cbuf_append_str(cb, "\\\\");
             break;
         case '\b':
-            cprintf(cb, "\\b");
+            cbuf_append_str(cb, "\\b");
             break;
         case '\f':
-            cprintf(cb, "\\f");
+            cbuf_append_str(cb, "\\f");
             break;
         case '\n':
-            cprintf(cb, "\\n");
+            cbuf_append_str(cb, "\\n");
             break;
         case '\r':
-            cprintf(cb, "\\r");
+            cbuf_append_str(cb, "\\r");
             break;
         case '\t':
-            cprintf(cb, "\\t");
-            break;
-        default: /* fall thru */
-            cprintf(cb, "%c", str[i]);
+            cbuf_append_str(cb, "\\t");
             break;
         }
-    retval = 0;
-    // done:
-    return retval;
+        s++;
+    }
+    return 0;
 }
 
 /*! Decode types from JSON to XML identityrefs
@@ -795,6 +802,7 @@ xml2json_encode_attr(cxobj     *xa,
  * @param[in]   level     Indentation level
  * @param[in]   pretty    Pretty-print output (2 means debug)
  * @param[in]   flat      Dont print NO_ARRAY object name (for _vec call)
+ * @param[in]   multi     Multi-file split datastore, see CLICON_XMLDB_MULTI
  * @param[in]   system_only Enable checks for system-only-config extension
  * @param[in]   modname0
  * @param[out]  metacbp   Meta encoding of attribute
@@ -836,6 +844,7 @@ xml2json1_cbuf(cbuf                   *cb,
                int                     level,
                int                     pretty,
                int                     flat,
+               int                     multi,
                int                     system_only,
                char                   *modname0,
                cbuf                   *metacbp)
@@ -853,6 +862,9 @@ xml2json1_cbuf(cbuf                   *cb,
     char            *modname = NULL;
     cbuf            *metacbc = NULL;
     int              exist;
+    int              subfile = 0;
+    char            *xpath = NULL;
+    char            *hexstr = NULL;
 
     if ((ys = xml_spec(x)) != NULL){
         if (ys_real_module(ys, &ymod) < 0)
@@ -870,6 +882,17 @@ xml2json1_cbuf(cbuf                   *cb,
             modname0 = modname; /* modname0 is ancestor ns passed to child */
     }
     childt = child_type(x);
+    /* Check if this is a multi-file split-point, then only write link to sub-file */
+    if (multi && ys != NULL && childt == ANY_CHILD){
+        if (yang_extension_value(ys, "xmldb-split", CLIXON_LIB_NS, &subfile, NULL) < 0)
+            goto done;
+        if (subfile){
+            if (xml2xpath(x, NULL, 1, 0, &xpath) < 0)
+                goto done;
+            if (clixon_digest_hex(xpath, &hexstr) < 0)
+                goto done;
+        }
+    }
     if (pretty==2)
         cprintf(cb, "#%s_array, %s_child ",
                 arraytype2str(arraytype),
@@ -955,8 +978,13 @@ xml2json1_cbuf(cbuf                   *cb,
      * arraytype=* but child-type is BODY_CHILD
      * This is code for writing <a>42</a> as "a":42 and not "a":"42"
      */
+    if (subfile){
+        cprintf(cb, "%*s\"clixon-lib:link\":%s\"%s.json\"",
+                pretty?((level+1)*PRETTYPRINT_INDENT):0, "",
+                pretty?" ":"", hexstr);
+    }
     commas = xml_child_nr_notype(x, CX_ATTR) - 1;
-    for (i=0; i<xml_child_nr(x); i++){
+    for (i=0; i<xml_child_nr(x) && !subfile; i++){
         xc = xml_child_i(x, i);
         if (xml_type(xc) == CX_ATTR){
             if (metacbp &&
@@ -978,13 +1006,15 @@ xml2json1_cbuf(cbuf                   *cb,
             if (xml2json1_cbuf(cb,
                                xc,
                                xc_arraytype,
-                               level+1, pretty, 0, system_only, modname0,
+                               level+1, pretty, 0, multi, system_only, modname0,
                                metacbc) < 0)
                 goto done;
             if (commas > 0) {
                 cprintf(cb, ",%s", pretty?"\n":"");
                 --commas;
             }
+            if (clixon_xml2cbuf_stream_flush(cb) < 0)
+                goto done;
         }
     }
     if (cbuf_len(metacbc)){
@@ -1049,6 +1079,10 @@ xml2json1_cbuf(cbuf                   *cb,
     }
     retval = 0;
  done:
+    if (xpath)
+        free(xpath);
+    if (hexstr)
+        free(hexstr);
     if (metacbc)
         cbuf_free(metacbc);
     return retval;
@@ -1062,6 +1096,7 @@ xml2json1_cbuf(cbuf                   *cb,
  * @param[in]     x           XML tree to translate from
  * @param[in]     pretty      Set if output is pretty-printed
  * @param[in]     autocliext  How to handle autocli extensions: 0: ignore 1: follow
+ * @param[in]     multi       Multi-file split datastore, see CLICON_XMLDB_MULTI
  * @param[in]     system_only Enable checks for system-only-config extension
  * @retval        0           OK
  * @retval       -1           Error
@@ -1074,6 +1109,7 @@ xml2json_cbuf1(cbuf  *cb,
                cxobj *x,
                int    pretty,
                int    autocliext,
+               int    multi,
                int    system_only)
 {
     int                     retval = 1;
@@ -1110,6 +1146,7 @@ xml2json_cbuf1(cbuf  *cb,
                        level+1,
                        pretty,
                        0,
+                       multi,
                        system_only,
                        NULL, /* ancestor modname / namespace */
                        NULL) < 0)
@@ -1124,6 +1161,69 @@ xml2json_cbuf1(cbuf  *cb,
     return retval;
 }
 
+/*! Translate an XML tree to JSON in a CLIgen buffer, internal function
+ *
+ * @param[in]     multi       Multi-file split datastore, see CLICON_XMLDB_MULTI
+ * @see clixon_json2cbuf for the other parameters
+ */
+static int
+json2cbuf1(cbuf  *cb,
+           cxobj *xt,
+           int    pretty,
+           int    skiptop,
+           int    autocliext,
+           int    multi,
+           int    system_only)
+{
+    int    retval = -1;
+    cxobj *xc;
+    int    i=0;
+
+    if (skiptop){
+        xc = NULL;
+        while ((xc = xml_child_each(xt, xc, CX_ELMNT)) != NULL){
+            if (i++)
+                cprintf(cb, ",");
+            if (xml2json_cbuf1(cb, xc, pretty, autocliext, multi, system_only) < 0)
+                goto done;
+        }
+    }
+    else {
+        if (xml2json_cbuf1(cb, xt, pretty, autocliext, multi, system_only) < 0)
+            goto done;
+    }
+    retval = 0;
+ done:
+    return retval;
+}
+
+/* Parameters of clixon_json2file1 given to json2file_print_cb */
+struct json2file_print {
+    cxobj *jp_x;
+    int    jp_pretty;
+    int    jp_skiptop;
+    int    jp_autocliext;
+    int    jp_multi;
+    int    jp_system_only;
+};
+
+/*! Print JSON of clixon_json2file1 to streamed cligen buffer
+ *
+ * @param[in,out] cb   Cligen buffer
+ * @param[in]     arg  struct json2file_print
+ * @retval        0    OK
+ * @retval       -1    Error
+ */
+static int
+json2file_print_cb(cbuf *cb,
+                   void *arg)
+{
+    struct json2file_print *jp = (struct json2file_print *)arg;
+
+    return json2cbuf1(cb, jp->jp_x, jp->jp_pretty, jp->jp_skiptop, jp->jp_autocliext,
+                      jp->jp_multi, jp->jp_system_only);
+}
+
 /*! Translate an XML tree to JSON in a CLIgen buffer skip top-level object
  *
  * XML-style namespace notation in tree, but RFC7951 in output assume yang
@@ -1152,26 +1252,7 @@ clixon_json2cbuf(cbuf  *cb,
                  int    autocliext,
                  int    system_only)
 {
-    int    retval = -1;
-    cxobj *xc;
-    int    i=0;
-
-    if (skiptop){
-        xc = NULL;
-        while ((xc = xml_child_each(xt, xc, CX_ELMNT)) != NULL){
-            if (i++)
-                cprintf(cb, ",");
-            if (xml2json_cbuf1(cb, xc, pretty, autocliext, system_only) < 0)
-                goto done;
-        }
-    }
-    else {
-        if (xml2json_cbuf1(cb, xt, pretty, autocliext, system_only) < 0)
-            goto done;
-    }
-    retval = 0;
- done:
-    return retval;
+    return json2cbuf1(cb, xt, pretty, skiptop, autocliext, 0, system_only);
 }
 
 /*! Translate a vector of xml objects to JSON Cligen buffer.
@@ -1239,7 +1320,7 @@ xml2json_cbuf_vec(cbuf      *cb,
                        NO_ARRAY,
                        level,
                        pretty,
-                       1, 0, NULL, NULL) < 0)
+                       1, 0, 0, NULL, NULL) < 0)
         goto done;
 
     if (0){
@@ -1265,6 +1346,7 @@ xml2json_cbuf_vec(cbuf      *cb,
  * @param[in]  fn          File print function
  * @param[in]  skiptop 0:  Include top object 1: Skip top-object, only children,
  * @param[in]  autocliext  How to handle autocli extensions: 0: ignore 1: follow
+ * @param[in]  multi       Multi-file split datastore, see CLICON_XMLDB_MULTI
  * @param[in]  system_only Enable checks for system-only-config extension
  * @retval     0           OK
  * @retval    -1           Error
@@ -1272,11 +1354,39 @@ xml2json_cbuf_vec(cbuf      *cb,
  * @note yang is necessary to translate to one-member lists,
  * eg if a is a yang LIST <a>0</a> -> {"a":["0"]} and not {"a":"0"}
  * @code
- * if (clixon_json2file(stderr, xn, 0, fprintf, 0, 0, 0) < 0)
+ * if (clixon_json2file1(stderr, xn, 0, fprintf, 0, 0, 0, 0) < 0)
  *   goto err;
  * @endcode
  */
 int
+clixon_json2file1(FILE             *f,
+                  cxobj            *xn,
+                  int               pretty,
+                  clicon_output_cb *fn,
+                  int               skiptop,
+                  int               autocliext,
+                  int               multi,
+                  int               system_only)
+{
+    struct json2file_print jp = {xn, pretty, skiptop, autocliext, multi, system_only};
+
+    return clixon_xml2file_stream(f, fn, json2file_print_cb, &jp);
+}
+
+/*! Translate from xml tree to JSON and print to file using a callback
+ *
+ * @param[in]  f           File to print to
+ * @param[in]  xn          XML tree to translate from
+ * @param[in]  pretty      Set if output is pretty-printed
+ * @param[in]  fn          File print function
+ * @param[in]  skiptop 0:  Include top object 1: Skip top-object, only children,
+ * @param[in]  autocliext  How to handle autocli extensions: 0: ignore 1: follow
+ * @param[in]  system_only Enable checks for system-only-config extension
+ * @retval     0           OK
+ * @retval    -1           Error
+ * @see clixon_json2file1 with multi-file split datastore
+ */
+int
 clixon_json2file(FILE             *f,
                  cxobj            *xn,
                  int               pretty,
@@ -1285,23 +1395,7 @@ clixon_json2file(FILE             *f,
                  int               autocliext,
                  int               system_only)
 {
-    int   retval = 1;
-    cbuf *cb = NULL;
-
-    if (fn == NULL)
-        fn = fprintf;
-    if ((cb = cbuf_new()) ==NULL){
-        clixon_err(OE_XML, errno, "cbuf_new");
-        goto done;
-    }
-    if (clixon_json2cbuf(cb, xn, pretty, skiptop, autocliext, system_only) < 0)
-        goto done;
-    (*fn)(f, "%s", cbuf_get(cb));
-    retval = 0;
- done:
-    if (cb)
-        cbuf_free(cb);
-    return retval;
+    return clixon_json2file1(f, xn, pretty, fn, skiptop, autocliext, 0, system_only);
 }
 
 /*! Print an XML tree structure to an output stream as JSON
@@ -1438,8 +1532,8 @@ json_xmlns_translate(yang_stmt *yspec,
 
 /*! Parse a string containing JSON and return an XML tree
  *
- * Parsing using yacc according to JSON syntax. Names with <prefix>:<id>
- * are split and interpreted as in RFC7951
+ * Parsing using the hand-written scanner according to JSON syntax, and the yacc parser if
+ * not accepted by the scanner. Names with <prefix>:<id> are split and interpreted as in RFC7951
  * @param[in]  h      Clixon handle sometimes NULL
  * @param[in]  str    Input string containing JSON
  * @param[in]  jsonenc JSON encoding according to RFC7951, prefixes are module-names
@@ -1452,6 +1546,7 @@ json_xmlns_translate(yang_stmt *yspec,
  * @retval    -1      Error
  *
  * @see _xml_parse for XML variant
+ * @see clixon_json_scan
  * @see http://www.ecma-international.org/publications/files/ECMA-ST/ECMA-404.pdf
  * @see RFC 7951
  */
@@ -1471,6 +1566,7 @@ _json_parse(clixon_handle h,
     int              i;
     int              failed = 0; /* yang assignment */
     yang_stmt       *yt = NULL;
+    int              yacc = 0;
     int              ret;
 
     if (clixon_debug_get() & CLIXON_DBG_DETAIL)
@@ -1481,15 +1577,20 @@ _json_parse(clixon_handle h,
     jy.jy_linenum = 1;
     jy.jy_current = xt;
     jy.jy_xtop = xt;
-    if (json_scan_init(&jy) < 0)
-        goto done;
-    if (json_parse_init(&jy) < 0)
-        goto done;
-    if (clixon_json_parseparse(&jy) != 0) { /* yacc returns 1 on error */
-        clixon_log(NULL, LOG_NOTICE, "JSON error: line %d", jy.jy_linenum);
-        if (clixon_err_category() == 0)
-            clixon_err(OE_JSON, 0, "JSON parser error with no error code (should not happen)");
+    if ((ret = clixon_json_scan(&jy, str, strlen(str))) < 0)
         goto done;
+    if (ret == 0){ /* Not accepted by scanner */
+        yacc++;
+        if (json_scan_init(&jy) < 0)
+            goto done;
+        if (json_parse_init(&jy) < 0)
+            goto done;
+        if (clixon_json_parseparse(&jy) != 0) { /* yacc returns 1 on error */
+            clixon_log(NULL, LOG_NOTICE, "JSON error: line %d", jy.jy_linenum);
+            if (clixon_err_category() == 0)
+                clixon_err(OE_JSON, 0, "JSON parser error with no error code (should not happen)");
+            goto done;
+        }
     }
 
     if ((yt = xml_spec(xt)) != NULL)
@@ -1576,8 +1677,10 @@ _json_parse(clixon_handle h,
     clixon_debug(CLIXON_DBG_PARSE|CLIXON_DBG_DETAIL, "retval:%d", retval);
     if (cberr)
         cbuf_free(cberr);
-    json_parse_exit(&jy);
-    json_scan_exit(&jy);
+    if (yacc){
+        json_parse_exit(&jy);
+        json_scan_exit(&jy);
+    }
     if (jy.jy_xvec)
         free(jy.jy_xvec);
     return retval;
@@ -1677,8 +1780,7 @@ clixon_json_parse_file(FILE      *fp,
     int       jsonbuflen = BUFLEN; /* start size */
     int       oldjsonbuflen;
     char     *ptr;
-    char      ch;
-    int       len = 0;
+    size_t    len = 0;
     size_t    sz;
     int       ret;
 
@@ -1693,11 +1795,10 @@ clixon_json_parse_file(FILE      *fp,
     memset(jsonbuf, 0, jsonbuflen);
     ptr = jsonbuf;
     while (1){
-        sz = fread(&ch, 1, 1, fp);
-        if (sz == 1){
-            jsonbuf[len++] = ch;
-        }
-        else if (sz == 0 && feof(fp)){
+        /* Read in blocks, one byte of space left for the null character */
+        sz = fread(jsonbuf+len, 1, jsonbuflen-1-len, fp);
+        len += sz;
+        if (sz == 0 && feof(fp)){
             if (*xt == NULL)
                 if ((*xt = xml_new(JSON_TOP_SYMBOL, NULL, CX_ELMNT)) == NULL)
                     goto done;
@@ -1709,8 +1810,8 @@ clixon_json_parse_file(FILE      *fp,
             }
             break;
         }
-        else {
-            clixon_err(OE_JSON, errno, "fread sz=%lu", sz);
+        else if (sz == 0){
+            clixon_err(OE_JSON, errno, "fread");
             goto done;
         }
         if (len >= jsonbuflen-1){ /* Space: one for the null character */
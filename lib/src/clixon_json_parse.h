@@ -70,4 +70,6 @@ int clixon_json_parselex(void *);
 int clixon_json_parseparse(void *);
 void clixon_json_parseerror(void *, char*);
 
+int clixon_json_scan(clixon_json_yacc *jy, const char *str, size_t len);
+
 #endif  /* _CLIXON_JSON_PARSE_H_ */
@@ -0,0 +1,484 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+
+  Copyright (C) 2009-2016 Olof Hagsand and Benny Holmgren
+  Copyright (C) 2017-2019 Olof Hagsand
+  Copyright (C) 2020-2022 Olof Hagsand and Rubicon Communications, LLC (Netgate)
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2,
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+
+
+ * Hand-written non-recursive JSON scanner
+ * Builds the same XML tree as the yacc parser in clixon_json_parse.[ly] directly:
+ * - Objects and arrays are kept on an explicit stack, not by recursion
+ * - Strings are scanned to the next '"' or '\' and escapes are decoded on the fly
+ * - Member names "module:name" are split in place into prefix and name
+ * Only a top-level object is accepted. Input that the scanner does not accept is not an
+ * error: the partial result is removed and the caller parses the input with the yacc parser,
+ * which gives the same result or the same error message as before.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "clixon_config.h" /* generated by config & autoconf */
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+
+/* cligen */
+#include <cligen/cligen.h>
+
+/* clixon */
+#include "clixon_queue.h"
+#include "clixon_hash.h"
+#include "clixon_handle.h"
+#include "clixon_yang.h"
+#include "clixon_xml.h"
+#include "clixon_err.h"
+#include "clixon_string.h"
+#include "clixon_xml_vec.h"
+#include "clixon_json_parse.h"
+
+/*! Scanner state
+ */
+struct json_scan {
+    const char *js_p;      /* Current position */
+    const char *js_end;    /* End of string */
+    cbuf       *js_str;    /* Current string */
+    char       *js_stack;  /* Open objects '{' and arrays '[' */
+    int         js_depth;  /* Depth of stack */
+    int         js_max;    /* Allocated size of stack */
+};
+
+/* Same as whitespace in clixon_json_parse.l */
+#define JS_WS(c) ((c) == ' ' || (c) == '\t' || (c) == '\n' || (c) == '\r')
+
+/*! Skip whitespace between tokens
+ */
+static inline void
+js_ws(struct json_scan *js)
+{
+    while (js->js_p < js->js_end && JS_WS(*js->js_p))
+        js->js_p++;
+}
+
+/*! Push open object or array
+ *
+ * @retval  0  OK
+ * @retval -1  Error
+ */
+static int
+js_push(struct json_scan *js,
+        char              c)
+{
+    if (js->js_depth >= js->js_max){
+        js->js_max = js->js_max ? js->js_max*2 : 32;
+        if ((js->js_stack = realloc(js->js_stack, js->js_max)) == NULL){
+            clixon_err(OE_JSON, errno, "realloc");
+            return -1;
+        }
+    }
+    js->js_stack[js->js_depth++] = c;
+    return 0;
+}
+
+/*! Scan string after '"' into js_str, decode escapes
+ *
+ * @retval  1  OK
+ * @retval  0  Not accepted
+ * @retval -1  Error
+ */
+static int
+js_string(struct json_scan *js)
+{
+    const char *p;
+    char        hex[5] = {0,};
+    char        buf[5] = {0,};
+    char        c;
+
+    cbuf_reset(js->js_str);
+    while (1){
+        /* Plain characters, same as STRING state in clixon_json_parse.l */
+        p = js->js_p;
+        while (p < js->js_end &&
+               (c = *p) != '"' && c != '\\' &&
+               c != '\b' && c != '\f' && c != '\n' && c != '\r' && c != '\t')
+            p++;
+        if (p > js->js_p)
+            cbuf_append_buf(js->js_str, (void*)js->js_p, p - js->js_p);
+        js->js_p = p;
+        if (p >= js->js_end)
+            return 0;
+        if (*p == '"'){
+            js->js_p++;
+            break;
+        }
+        if (*p != '\\')
+            return 0;
+        if (++p >= js->js_end)
+            return 0;
+        switch (*p){
+        case '"':
+        case '\\':
+        case '/':
+            cbuf_append(js->js_str, *p);
+            break;
+        case 'b':
+            cbuf_append(js->js_str, '\b');
+            break;
+        case 'f':
+            cbuf_append(js->js_str, '\f');
+            break;
+        case 'n':
+            cbuf_append(js->js_str, '\n');
+            break;
+        case 'r':
+            cbuf_append(js->js_str, '\r');
+            break;
+        case 't':
+            cbuf_append(js->js_str, '\t');
+            break;
+        case 'u':
+            if (js->js_end - p < 5)
+                return 0;
+            memcpy(hex, p+1, 4);
+            if (clixon_unicode2utf8(hex, buf, 5) < 0){
+                clixon_err_reset();
+                return 0;
+            }
+            cbuf_append_str(js->js_str, buf);
+            p += 4;
+            break;
+        default:
+            return 0;
+        }
+        js->js_p = p + 1;
+    }
+    return 1;
+}
+
+/*! Scan number, same as J_NUMBER in clixon_json_parse.l
+ *
+ * @retval  1  OK, number is in js_str
+ * @retval  0  Not accepted
+ */
+static int
+js_number(struct json_scan *js)
+{
+    const char *p = js->js_p;
+    const char *e;
+    int         nd = 0;
+
+    if (p < js->js_end && *p == '-')
+        p++;
+    while (p < js->js_end && *p >= '0' && *p <= '9'){
+        p++;
+        nd++;
+    }
+    if (p < js->js_end && *p == '.'){
+        p++;
+        while (p < js->js_end && *p >= '0' && *p <= '9'){
+            p++;
+            nd++;
+        }
+    }
+    if (nd == 0)
+        return 0;
+    /* Exponent sign is mandatory */
+    if (js->js_end - p >= 3 && (*p == 'e' || *p == 'E') &&
+        (p[1] == '+' || p[1] == '-') && p[2] >= '0' && p[2] <= '9'){
+        e = p + 3;
+        while (e < js->js_end && *e >= '0' && *e <= '9')
+            e++;
+        p = e;
+    }
+    cbuf_reset(js->js_str);
+    cbuf_append_buf(js->js_str, (void*)js->js_p, p - js->js_p);
+    js->js_p = p;
+    return 1;
+}
+
+/*! Create body of current element, same as json_current_body
+ *
+ * @param[in]  x      Current element
+ * @param[in]  value  Value, or NULL for null
+ */
+static int
+js_body(cxobj *x,
+        char  *value)
+{
+    cxobj *xb;
+
+    if ((xb = xml_new("body", x, CX_BODY)) == NULL)
+        return -1;
+    if (value && xml_value_append(xb, value) < 0)
+        return -1;
+    return 0;
+}
+
+/*! Create element with prefix from member name in js_str, same as json_current_new
+ *
+ * @param[in]  js     Scanner state, js_str is "prefix:name" or "name"
+ * @param[in]  jy     Parse state, for top and top-level vector
+ * @param[in]  xp     Parent
+ * @param[in]  prefix Prefix, or NULL if name in js_str is to be split
+ * @param[in]  name   Name, or NULL if name in js_str is to be split
+ * @retval     x      New element
+ * @retval     NULL   Error
+ */
+static cxobj *
+js_element(struct json_scan *js,
+           clixon_json_yacc *jy,
+           cxobj            *xp,
+           char             *prefix,
+           char             *name)
+{
+    cxobj *x;
+    char  *colon;
+
+    if (name == NULL){
+        name = cbuf_get(js->js_str);
+        if ((colon = strchr(name, ':')) != NULL){
+            *colon = '\0';
+            prefix = name;
+            name = colon + 1;
+        }
+    }
+    if ((x = xml_new(name, xp, CX_ELMNT)) == NULL)
+        return NULL;
+    if (prefix && xml_prefix_set(x, prefix) < 0)
+        return NULL;
+    /* If topmost, add to top-list created list */
+    if (xp == jy->jy_xtop &&
+        cxvec_append(x, &jy->jy_xvec, &jy->jy_xlen) < 0)
+        return NULL;
+    return x;
+}
+
+/*! Scan member name and ':' after '"', create element under x
+ *
+ * @retval  1  OK, *x is new element
+ * @retval  0  Not accepted
+ * @retval -1  Error
+ */
+static int
+js_member(struct json_scan *js,
+          clixon_json_yacc *jy,
+          cxobj           **x)
+{
+    int ret;
+
+    if ((ret = js_string(js)) <= 0)
+        return ret;
+    if ((*x = js_element(js, jy, *x, NULL, NULL)) == NULL)
+        return -1;
+    js_ws(js);
+    if (js->js_p >= js->js_end || *js->js_p != ':')
+        return 0;
+    js->js_p++;
+    return 1;
+}
+
+/*! Scan JSON string and build XML tree under jy_xtop, without yacc parser
+ *
+ * Non-recursive: the current element is x, its parent is found with xml_parent.
+ * Every member creates an element which is current until its value is done. Each value
+ * of an array after the first creates a copy of the current element, as the yacc parser.
+ * @param[in]  jy    Parse state, jy_xtop is set, jy_xvec is set to new top-level elements
+ * @param[in]  str   JSON string
+ * @param[in]  len   Length of str
+ * @retval     1     OK
+ * @retval     0     Not accepted, nothing added to jy_xtop, parse with yacc parser
+ * @retval    -1     Error
+ * @see _json_parse
+ */
+int
+clixon_json_scan(clixon_json_yacc *jy,
+                 const char       *str,
+                 size_t            len)
+{
+    int              retval = -1;
+    struct json_scan js = {0,};
+    cxobj           *xt = jy->jy_xtop;
+    cxobj           *x;
+    cxobj           *xp;
+    int              value;  /* Expect value, else expect ',' or end of object/array */
+    int              i;
+    int              ret;
+
+    js.js_p = str;
+    js.js_end = str + len;
+    if ((js.js_str = cbuf_new()) == NULL){
+        clixon_err(OE_JSON, errno, "cbuf_new");
+        goto done;
+    }
+    js_ws(&js);
+    /* Only top-level object, other values are added to top by the yacc parser */
+    if (js.js_p >= js.js_end || *js.js_p != '{')
+        goto fail;
+    x = xt;
+    value = 1;
+    while (1){
+        js_ws(&js);
+        if (value){
+            if (js.js_p >= js.js_end)
+                goto fail;
+            switch (*js.js_p){
+            case '{':
+                js.js_p++;
+                if (js_push(&js, '{') < 0)
+                    goto done;
+                js_ws(&js);
+                if (js.js_p < js.js_end && *js.js_p == '}'){
+                    js.js_p++;
+                    js.js_depth--;
+                    value = 0;
+                    break;
+                }
+                if (js.js_p >= js.js_end || *js.js_p != '"')
+                    goto fail;
+                js.js_p++;
+                if ((ret = js_member(&js, jy, &x)) < 0)
+                    goto done;
+                if (ret == 0)
+                    goto fail;
+                break;
+            case '[':
+                js.js_p++;
+                if (js_push(&js, '[') < 0)
+                    goto done;
+                js_ws(&js);
+                if (js.js_p < js.js_end && *js.js_p == ']'){
+                    js.js_p++;
+                    js.js_depth--;
+                    value = 0;
+                }
+                break;
+            case '"':
+                js.js_p++;
+                if ((ret = js_string(&js)) < 0)
+                    goto done;
+                if (ret == 0)
+                    goto fail;
+                if (js_body(x, cbuf_get(js.js_str)) < 0)
+                    goto done;
+                value = 0;
+                break;
+            case 't':
+            case 'f':
+            case 'n':{
+                char *lit = *js.js_p == 't' ? "true" : *js.js_p == 'f' ? "false" : "null";
+                size_t ll = strlen(lit);
+
+                if ((size_t)(js.js_end - js.js_p) < ll || memcmp(js.js_p, lit, ll) != 0)
+                    goto fail;
+                js.js_p += ll;
+                if (js_body(x, *lit == 'n' ? NULL : lit) < 0)
+                    goto done;
+                value = 0;
+                break;
+            }
+            default:
+                if (js_number(&js) == 0)
+                    goto fail;
+                if (js_body(x, cbuf_get(js.js_str)) < 0)
+                    goto done;
+                value = 0;
+                break;
+            }
+            continue;
+        }
+        /* After value */
+        if (js.js_depth == 0){
+            if (js.js_p < js.js_end) /* Only one top-level value */
+                goto fail;
+            break;
+        }
+        if (js.js_p >= js.js_end)
+            goto fail;
+        if (js.js_stack[js.js_depth-1] == '{'){
+            /* Member value done */
+            x = xml_parent(x);
+            if (*js.js_p == '}'){
+                js.js_p++;
+                js.js_depth--;
+                continue;
+            }
+            if (*js.js_p != ',')
+                goto fail;
+            js.js_p++;
+            js_ws(&js);
+            if (js.js_p >= js.js_end || *js.js_p != '"')
+                goto fail;
+            js.js_p++;
+            if ((ret = js_member(&js, jy, &x)) < 0)
+                goto done;
+            if (ret == 0)
+                goto fail;
+            value = 1;
+        }
+        else {
+            if (*js.js_p == ']'){
+                js.js_p++;
+                js.js_depth--;
+                continue;
+            }
+            if (*js.js_p != ',')
+                goto fail;
+            js.js_p++;
+            /* Next value in a copy of current element, same as json_current_clone */
+            if ((xp = xml_parent(x)) == NULL)
+                goto fail;
+            if ((x = js_element(&js, jy, xp, xml_prefix(x), xml_name(x))) == NULL)
+                goto done;
+            value = 1;
+        }
+    }
+    retval = 1;
+ done:
+    if (js.js_str)
+        cbuf_free(js.js_str);
+    if (js.js_stack)
+        free(js.js_stack);
+    return retval;
+ fail:
+    /* Remove partial result */
+    for (i = 0; i < jy->jy_xlen; i++)
+        xml_purge(jy->jy_xvec[i]);
+    if (jy->jy_xvec){
+        free(jy->jy_xvec);
+        jy->jy_xvec = NULL;
+    }
+    jy->jy_xlen = 0;
+    retval = 0;
+    goto done;
+}
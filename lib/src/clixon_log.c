@@ -91,6 +91,16 @@ static int _log_openlog = 0;
 /* Truncate debug strings to this length. 0 means unlimited */
 static int _log_trunc = 0;
 
+/*! In-memory log ring of the process, see CLIXON_LOG_RING
+ */
+struct log_ring {
+    size_t           lr_pos;    /* Total number of bytes written, mod LOG_RING_SIZE is offset */
+    char             lr_buf[LOG_RING_SIZE];
+};
+
+/* Log ring, created on first write */
+static struct log_ring *_log_ring = NULL;
+
 /*! Mapping between Clixon debug symbolic names <--> bitfields
  *
  * Also inclode shorthands: s|e|o|f|n
@@ -106,6 +116,8 @@ static const map_str2int logdstmap[] = {
     {"o",        CLIXON_LOG_STDOUT},
     {"file",     CLIXON_LOG_FILE},
     {"f",        CLIXON_LOG_FILE},
+    {"ring",     CLIXON_LOG_RING},
+    {"r",        CLIXON_LOG_RING},
     {"n",        0x0},
     {NULL,       -1}
 };
@@ -174,6 +186,10 @@ clixon_log_init(clixon_handle h,
 int
 clixon_log_exit(void)
 {
+    if (_log_ring){
+        free(_log_ring);
+        _log_ring = NULL;
+    }
     if (_log_file)
         fclose(_log_file);
     if (_log_openlog){
@@ -185,8 +201,8 @@ clixon_log_exit(void)
 
 /*! Utility function to set log destination/flag using command-line option
  *
- * @param[in]  c  Log option,one of s,f,e,o
- * @retval     0  One of CLIXON_LOG_SYSLOG|STDERR|STDOUT|FILE
+ * @param[in]  c  Log option,one of s,f,e,o,r
+ * @retval     0  One of CLIXON_LOG_SYSLOG|STDERR|STDOUT|FILE|RING
  * @retval    -1  No match
  */
 int
@@ -207,6 +223,9 @@ clixon_log_opt(char c)
     case 'f':
         logdst = CLIXON_LOG_FILE;
         break;
+    case 'r':
+        logdst = CLIXON_LOG_RING;
+        break;
     case 'n':
         logdst = 0;
         break;
@@ -340,6 +359,93 @@ slogtime(void)
 }
 #endif
 
+/*! Append a message to the log ring
+ *
+ * @param[in]  msg  Message without trailing newline
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+log_ring_write(const char *msg)
+{
+    struct log_ring *lr;
+    struct timeval   tv;
+    char             hdr[32];
+    size_t           pos;
+    size_t           len;
+    size_t           n;
+    int              i;
+
+    if ((lr = _log_ring) == NULL){
+        if ((lr = calloc(1, sizeof(*lr))) == NULL){
+            fprintf(stderr, "%s: calloc: %s\n", __func__, strerror(errno));
+            return -1;
+        }
+        _log_ring = lr;
+    }
+    gettimeofday(&tv, NULL);
+    snprintf(hdr, sizeof(hdr), "%ld.%06ld: ", (long)tv.tv_sec, (long)tv.tv_usec);
+    pos = lr->lr_pos;
+    for (i=0; i<3; i++){
+        const char *s = i==0?hdr:i==1?msg:"\n";
+
+        len = strlen(s);
+        if (len > LOG_RING_SIZE){ /* Keep the end */
+            s += len - LOG_RING_SIZE;
+            len = LOG_RING_SIZE;
+        }
+        while (len){
+            n = LOG_RING_SIZE - pos%LOG_RING_SIZE;
+            if (n > len)
+                n = len;
+            memcpy(&lr->lr_buf[pos%LOG_RING_SIZE], s, n);
+            pos += n;
+            s += n;
+            len -= n;
+        }
+    }
+    lr->lr_pos = pos;
+    return 0;
+}
+
+/*! Dump the in-memory log ring, oldest message first
+ *
+ * The ring is not cleared.
+ * @param[in]  f    Output file, or NULL for the log file if set, otherwise stderr
+ * @retval     0    OK
+ * @see CLIXON_LOG_RING
+ */
+int
+clixon_log_ring_dump(FILE *f)
+{
+    struct log_ring *lr;
+    size_t           pos;
+    size_t           off;
+    char            *nl;
+
+    if (f == NULL)
+        f = _log_file ? _log_file : stderr;
+    if ((lr = _log_ring) == NULL)
+        goto ok;
+    pos = lr->lr_pos;
+    if (pos <= LOG_RING_SIZE){
+        fwrite(lr->lr_buf, 1, pos, f);
+        goto ok;
+    }
+    /* Wrapped: skip the partly overwritten oldest message */
+    off = pos % LOG_RING_SIZE;
+    if ((nl = memchr(&lr->lr_buf[off], '\n', LOG_RING_SIZE - off)) != NULL)
+        fwrite(nl + 1, 1, &lr->lr_buf[LOG_RING_SIZE] - (nl + 1), f);
+    else if ((nl = memchr(lr->lr_buf, '\n', off)) != NULL){
+        fwrite(nl + 1, 1, &lr->lr_buf[off] - (nl + 1), f);
+        goto ok;
+    }
+    fwrite(lr->lr_buf, 1, off, f);
+ ok:
+    fflush(f);
+    return 0;
+}
+
 /*! Make a logging call to syslog (or stderr).
  *
  * @param[in]   level log level, eg LOG_DEBUG,LOG_INFO,...,LOG_EMERG. Thisis OR:d with facility == LOG_USER
@@ -381,6 +487,8 @@ clixon_log_str(int  level,
         fprintf(_log_file, "%s\n", msg);
         fflush(_log_file);
     }
+    if (_log_flags & CLIXON_LOG_RING)
+        log_ring_write(msg);
     /* Enable this if you want syslog in a stream. But there are problems with
      * recursion
      */
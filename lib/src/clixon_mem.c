@@ -0,0 +1,252 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+ 
+  Copyright (C) 2026 Olof Hagsand
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2, 
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+
+ * Memory accounting per subsystem with tagged allocations
+ * Each tagged allocation has a small header with size and tag before the returned
+ * memory, so that free and realloc find the counter to decrement.
+ * Counters are per process
+ * Example:
+ *   if ((p = clixon_mem_malloc(CLIXON_MEM_PLUGIN, sizeof(*p))) == NULL){
+ *      clixon_err(OE_UNIX, errno, "clixon_mem_malloc");
+ *      goto done;
+ *   }
+ *   ...
+ *   clixon_mem_free(p);
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "clixon_config.h" /* generated by config & autoconf */
+#endif
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <errno.h>
+#include <string.h>
+#include <assert.h>
+
+/* cligen */
+#include <cligen/cligen.h>
+
+/* clixon */
+#include "clixon_map.h"
+#include "clixon_mem.h"
+
+/* Allocation header before tagged memory, size is a multiple of 16 to keep alignment */
+struct mem_hdr {
+    size_t   mh_size;   /* Size of memory after header */
+    uint32_t mh_tag;    /* enum clixon_mem_tag */
+    uint32_t mh_magic;  /* MEM_MAGIC, check that memory is tagged */
+};
+
+#define MEM_MAGIC 0xc1c0a11c
+
+/* Counters of a tag */
+struct mem_counter {
+    uint64_t mc_nr;     /* Number of allocations */
+    uint64_t mc_bytes;  /* Bytes allocated */
+    uint64_t mc_max;    /* Maximum of mc_bytes */
+};
+
+static struct mem_counter _mem_counters[CLIXON_MEM_NR] = {{0,},};
+
+/* Tag names, as in clixon-lib memory-stats */
+static const map_str2int memtagmap[] = {
+    {"other",       CLIXON_MEM_OTHER},
+    {"nacm",        CLIXON_MEM_NACM},
+    {"stream",      CLIXON_MEM_STREAM},
+    {"transaction", CLIXON_MEM_TRANSACTION},
+    {"plugin",      CLIXON_MEM_PLUGIN},
+    {NULL,          -1}
+};
+
+/*! Add allocations and bytes to counters of a tag
+ *
+ * @param[in]  tag    Memory tag
+ * @param[in]  nr     Number of allocations, negative when freed
+ * @param[in]  bytes  Number of bytes, negative when freed
+ */
+void
+clixon_mem_account(enum clixon_mem_tag tag,
+                   int64_t             nr,
+                   int64_t             bytes)
+{
+    struct mem_counter *mc;
+
+    if (tag >= CLIXON_MEM_NR)
+        tag = CLIXON_MEM_OTHER;
+    mc = &_mem_counters[tag];
+    mc->mc_nr += nr;
+    mc->mc_bytes += bytes;
+    if (mc->mc_bytes > mc->mc_max)
+        mc->mc_max = mc->mc_bytes;
+}
+
+/*! Allocate tagged memory
+ *
+ * @param[in]  tag   Memory tag
+ * @param[in]  size  Size in bytes
+ * @retval     ptr   Memory, free with clixon_mem_free
+ * @retval     NULL  Error, errno set as malloc
+ */
+void *
+clixon_mem_malloc(enum clixon_mem_tag tag,
+                  size_t              size)
+{
+    struct mem_hdr *mh;
+
+    if (size > SIZE_MAX - sizeof(*mh)){
+        errno = ENOMEM;
+        return NULL;
+    }
+    if ((mh = malloc(sizeof(*mh) + size)) == NULL)
+        return NULL;
+    mh->mh_size = size;
+    mh->mh_tag = tag < CLIXON_MEM_NR ? tag : CLIXON_MEM_OTHER;
+    mh->mh_magic = MEM_MAGIC;
+    clixon_mem_account(mh->mh_tag, 1, size);
+    return mh + 1;
+}
+
+/*! Allocate zeroed tagged memory
+ *
+ * @param[in]  tag    Memory tag
+ * @param[in]  nmemb  Number of elements
+ * @param[in]  size   Size in bytes of each element
+ * @retval     ptr    Memory, free with clixon_mem_free
+ * @retval     NULL   Error, errno set as calloc
+ */
+void *
+clixon_mem_calloc(enum clixon_mem_tag tag,
+                  size_t              nmemb,
+                  size_t              size)
+{
+    void *ptr;
+
+    if (size && nmemb > SIZE_MAX / size){
+        errno = ENOMEM;
+        return NULL;
+    }
+    if ((ptr = clixon_mem_malloc(tag, nmemb * size)) == NULL)
+        return NULL;
+    memset(ptr, 0, nmemb * size);
+    return ptr;
+}
+
+/*! Reallocate tagged memory
+ *
+ * @param[in]  tag   Memory tag, used if ptr is NULL, otherwise the tag of ptr is kept
+ * @param[in]  ptr   Memory allocated with clixon_mem_*, or NULL
+ * @param[in]  size  New size in bytes
+ * @retval     ptr   Memory, free with clixon_mem_free
+ * @retval     NULL  Error, errno set as realloc, and ptr is not freed
+ */
+void *
+clixon_mem_realloc(enum clixon_mem_tag tag,
+                   void               *ptr,
+                   size_t              size)
+{
+    struct mem_hdr *mh;
+    size_t          size0;
+
+    if (ptr == NULL)
+        return clixon_mem_malloc(tag, size);
+    if (size > SIZE_MAX - sizeof(*mh)){
+        errno = ENOMEM;
+        return NULL;
+    }
+    mh = (struct mem_hdr *)ptr - 1;
+    assert(mh->mh_magic == MEM_MAGIC);
+    size0 = mh->mh_size;
+    if ((mh = realloc(mh, sizeof(*mh) + size)) == NULL)
+        return NULL;
+    mh->mh_size = size;
+    clixon_mem_account(mh->mh_tag, 0, (int64_t)size - (int64_t)size0);
+    return mh + 1;
+}
+
+/*! Free tagged memory
+ *
+ * @param[in]  ptr   Memory allocated with clixon_mem_*, or NULL
+ * @note Memory not allocated with clixon_mem_* must not be freed with this function
+ */
+void
+clixon_mem_free(void *ptr)
+{
+    struct mem_hdr *mh;
+
+    if (ptr == NULL)
+        return;
+    mh = (struct mem_hdr *)ptr - 1;
+    assert(mh->mh_magic == MEM_MAGIC); /* Not tagged or freed twice */
+    mh->mh_magic = 0;
+    clixon_mem_account(mh->mh_tag, -1, -(int64_t)mh->mh_size);
+    free(mh);
+}
+
+/*! Get counters of a tag
+ *
+ * @param[in]  tag     Memory tag
+ * @param[out] nrp     Number of allocations (if not NULL)
+ * @param[out] bytesp  Bytes allocated (if not NULL)
+ * @param[out] maxp    Maximum of bytes allocated (if not NULL)
+ * @retval     0       OK
+ * @retval    -1       Invalid tag
+ */
+int
+clixon_mem_stats(enum clixon_mem_tag tag,
+                 uint64_t           *nrp,
+                 uint64_t           *bytesp,
+                 uint64_t           *maxp)
+{
+    if (tag >= CLIXON_MEM_NR)
+        return -1;
+    if (nrp)
+        *nrp = _mem_counters[tag].mc_nr;
+    if (bytesp)
+        *bytesp = _mem_counters[tag].mc_bytes;
+    if (maxp)
+        *maxp = _mem_counters[tag].mc_max;
+    return 0;
+}
+
+/*! Name of tag
+ *
+ * @param[in]  tag   Memory tag
+ * @retval     name  Name of tag, eg "nacm"
+ * @retval     NULL  Invalid tag
+ */
+const char *
+clixon_mem_tag2str(enum clixon_mem_tag tag)
+{
+    return clicon_int2str(memtagmap, tag);
+}
@@ -46,6 +46,7 @@
 #include <string.h>
 #include <limits.h>
 #include <stdint.h>
+#include <inttypes.h>
 #include <assert.h>
 #include <syslog.h>
 #include <sys/time.h>
@@ -78,6 +79,8 @@
 #include "clixon_path.h"
 #include "clixon_xml_vec.h"
 #include "clixon_yang_parse_lib.h"
+#include "clixon_yang_schema_mount.h"
+#include "clixon_mem.h"
 #include "clixon_nacm.h"
 
 /* NACM namespace for use with xml namespace contexts and xpath */
@@ -146,554 +149,864 @@ nacm_proxyuser_member(clixon_handle h,
         return 0;
 }
 
-/*! Match nacm access operations according to RFC8341 3.4.4.  
+/*---------------------------------------------------------------
+ * Compiled NACM rules
+ */
+
+/* Access operation bit of compiled NACM rule, see enum nacm_access */
+#define NACM_BIT(a) (1 << (a))
+
+/* Action of compiled NACM rule */
+#define NACM_ACTION_PERMIT 1
+#define NACM_ACTION_DENY   2
+
+/*! Compiled NACM rule
  *
- * Incoming RPC Message Validation Step 7 (c)
- *  The rule's "access-operations" leaf has the "exec" bit set or
- *  has the special value "*".
- * @param[in] accops Access operations
- * @param[in] mode   Primary mode, eg read, create, update, delete, exec
- * @param[in] mode2  Secondary mode, eg "write"
- * @retval    1      Match
- * @retval    0      No match
- * @note access_operations is bit-fields
+ * Strings refer to the NACM tree the rule is compiled from
  */
-static int
-match_access(char *accops,
-             char *mode,
-             char *mode2)
+typedef struct {
+    char        *nr_module;   /* module-name, "*" is any module */
+    char        *nr_rpc;      /* rpc-name, or NULL */
+    char        *nr_path;     /* path, or NULL */
+    int          nr_haspath;  /* path is set (rule-type is data-node) */
+    int          nr_notif;    /* notification-name is set */
+    int          nr_access;   /* Access operations, see NACM_BIT */
+    int          nr_action;   /* NACM_ACTION_PERMIT or NACM_ACTION_DENY, 0 if not set */
+    int          nr_resolved; /* 0: path not resolved yet, 1: resolved, -1: did not resolve */
+    clixon_path *nr_cplist;   /* Parsed and resolved path */
+    yang_stmt   *nr_ypath;    /* Schema node of path */
+} nacm_rule;
+
+/*! Rules of a user that may apply to the data nodes of a schema node, in order
+ */
+typedef struct {
+    qelem_t     ym_q;
+    int        *ym_vec;       /* Index of rules in nu_rules */
+    int         ym_len;
+    int         ym_below;     /* Rules may apply to descendants: 1, not: 0, not known: -1 */
+} nacm_ymatch;
+
+/*! Compiled NACM rules of a user
+ *
+ * Rules of the rule-lists of the groups of a user. Rpc decisions and rules that may
+ * apply to a schema node are computed on first use and then looked up.
+ */
+typedef struct {
+    qelem_t        nu_q;
+    int            nu_groups;  /* Number of groups of the user */
+    nacm_rule     *nu_rules;   /* Rules of the rule-lists of the groups, in order */
+    int            nu_len;     /* Length of nu_rules */
+    clicon_hash_t *nu_rpc;     /* module:rpc -> index+1 of first matching rule, 0 if none */
+    clicon_hash_t *nu_ymap[NACM_EXEC]; /* Per data access: schema node -> nacm_ymatch */
+    nacm_ymatch   *nu_ymlist;  /* All nacm_ymatch of nu_ymap */
+} nacm_user;
+
+/*! Compiled NACM rules of a NACM tree
+ */
+typedef struct {
+    cxobj         *nc_xnacm;   /* NACM tree, root is "nacm", or NULL if no NACM config */
+    int            nc_owner;   /* nc_xnacm is freed with compiled rules */
+    cxobj         *nc_xext;    /* External NACM tree compiled from, or NULL if running */
+    uint64_t       nc_gen;     /* Generation of running compiled from */
+    clicon_hash_t *nc_users;   /* username -> nacm_user */
+    nacm_user     *nc_ulist;   /* All nacm_user of nc_users */
+} nacm_compiled;
+
+/* NACM rules of running or of the external NACM file, compiled on first access after
+ * a change of NACM config, see nacm_access_pre */
+static nacm_compiled *_nacm_compiled = NULL;
+
+/*! Free compiled rules of a user
+ */
+static void
+nacm_user_free(nacm_user *nu)
 {
-    if (accops==NULL)
-        return 0;
-    if (strcmp(accops, "*")==0)
-        return 1;
-    if (strstr(accops, mode) != NULL)
-        return 1;
-    if (mode2 && strstr(accops, mode2)!=NULL)
-        return 1;
-    return 0;
+    nacm_ymatch *ym;
+    int          i;
+
+    for (i=0; i<nu->nu_len; i++)
+        if (nu->nu_rules[i].nr_cplist)
+            clixon_path_free(nu->nu_rules[i].nr_cplist);
+    if (nu->nu_rules)
+        clixon_mem_free(nu->nu_rules);
+    if (nu->nu_rpc)
+        clicon_hash_free(nu->nu_rpc);
+    for (i=0; i<NACM_EXEC; i++)
+        if (nu->nu_ymap[i])
+            clicon_hash_free(nu->nu_ymap[i]);
+    while ((ym = nu->nu_ymlist) != NULL) {
+        DELQ(ym, nu->nu_ymlist, nacm_ymatch *);
+        if (ym->ym_vec)
+            clixon_mem_free(ym->ym_vec);
+        clixon_mem_free(ym);
+    }
+    clixon_mem_free(nu);
 }
 
-/*! Match nacm single rule. Either match with access or deny. Or not match.
+/*! Free compiled NACM rules
+ */
+static void
+nacm_compiled_free(nacm_compiled *nc)
+{
+    nacm_user *nu;
+
+    while ((nu = nc->nc_ulist) != NULL) {
+        DELQ(nu, nc->nc_ulist, nacm_user *);
+        nacm_user_free(nu);
+    }
+    if (nc->nc_users)
+        clicon_hash_free(nc->nc_users);
+    if (nc->nc_owner && nc->nc_xnacm)
+        xml_free(nc->nc_xnacm);
+    clixon_mem_free(nc);
+}
+
+/*! Create compiled NACM rules of a NACM tree, users are compiled on first use
  *
- * @param[in]  rpc    rpc name
- * @param[in]  module Yang module name
- * @param[in]  xrule  NACM rule XML tree
- * @param[out] cbret  Cligen buffer result. Set to an error msg if retval=0.
- * @retval     2      No matching rule Goto step 10
- * @retval     1      Matching rule AND Access
- * @retval     0      Matching rule AND Not access and cbret set
- * @retval    -1      Error
- * @see RFC8341 3.4.4.  Incoming RPC Message Validation
- 7.(cont) A rule matches if all of the following criteria are met: 
-        *  The rule's "module-name" leaf is "*" or equals the name of
-           the YANG module where the protocol operation is defined.
+ * @param[in]  xnacm  NACM tree, root is "nacm", or NULL
+ * @param[in]  owner  Free xnacm with compiled rules
+ * @retval     nc     Compiled NACM rules, free with nacm_compiled_free
+ * @retval     NULL   Error
+ */
+static nacm_compiled *
+nacm_compiled_new(cxobj *xnacm,
+                  int    owner)
+{
+    nacm_compiled *nc;
 
-        *  Either (1) the rule does not have a "rule-type" defined or
-           (2) the "rule-type" is "protocol-operation" and the
-           "rpc-name" is "*" or equals the name of the requested
-           protocol operation.
+    if ((nc = clixon_mem_calloc(CLIXON_MEM_NACM, 1, sizeof(*nc))) == NULL){
+        clixon_err(OE_UNIX, errno, "clixon_mem_calloc");
+        return NULL;
+    }
+    if ((nc->nc_users = clicon_hash_init()) == NULL){
+        clixon_mem_free(nc);
+        return NULL;
+    }
+    nc->nc_xnacm = xnacm;
+    nc->nc_owner = owner;
+    return nc;
+}
 
-        *  The rule's "access-operations" leaf has the "exec" bit set or
-           has the special value "*".
+/*! Get compiled NACM rules of a NACM tree
+ *
+ * The NACM tree returned by nacm_access_pre has compiled rules, any other tree is
+ * compiled for this call only.
+ * @param[in]  xnacm  NACM tree
+ * @retval     nc     Compiled NACM rules, free with nacm_compiled_free if not _nacm_compiled
+ * @retval     NULL   Error
+ */
+static nacm_compiled *
+nacm_compiled_get(cxobj *xnacm)
+{
+    if (_nacm_compiled && _nacm_compiled->nc_xnacm == xnacm)
+        return _nacm_compiled;
+    return nacm_compiled_new(xnacm, 0);
+}
+
+/*! Compile a NACM rule
+ *
+ * The path is resolved when first used for data access
+ * @param[in]  xrule  NACM rule
+ * @param[out] nr     Compiled rule
+ */
+static void
+nacm_rule_compile(cxobj     *xrule,
+                  nacm_rule *nr)
+{
+    char  *accops;
+    char  *action;
+    cxobj *xpath;
+
+    memset(nr, 0, sizeof(*nr));
+    nr->nr_module = xml_find_body(xrule, "module-name");
+    nr->nr_rpc = xml_find_body(xrule, "rpc-name");
+    nr->nr_notif = xml_find_body(xrule, "notification-name") != NULL;
+    if ((xpath = xml_find_type(xrule, NULL, "path", CX_ELMNT)) != NULL){
+        nr->nr_haspath = 1;
+        if (xml_body(xpath) != NULL)
+            nr->nr_path = clixon_trim2(xml_body(xpath), " \t\n");
+        else
+            nr->nr_resolved = -1;
+    }
+    /* access-operations is bits, "write" is short-hand for create, update and delete */
+    if ((accops = xml_find_body(xrule, "access-operations")) != NULL){
+        if (strcmp(accops, "*") == 0)
+            nr->nr_access = NACM_BIT(NACM_CREATE) | NACM_BIT(NACM_READ) |
+                NACM_BIT(NACM_UPDATE) | NACM_BIT(NACM_DELETE) | NACM_BIT(NACM_EXEC);
+        else {
+            if (strstr(accops, "create") != NULL)
+                nr->nr_access |= NACM_BIT(NACM_CREATE);
+            if (strstr(accops, "read") != NULL)
+                nr->nr_access |= NACM_BIT(NACM_READ);
+            if (strstr(accops, "update") != NULL)
+                nr->nr_access |= NACM_BIT(NACM_UPDATE);
+            if (strstr(accops, "delete") != NULL)
+                nr->nr_access |= NACM_BIT(NACM_DELETE);
+            if (strstr(accops, "exec") != NULL)
+                nr->nr_access |= NACM_BIT(NACM_EXEC);
+            if (strstr(accops, "write") != NULL)
+                nr->nr_access |= NACM_BIT(NACM_CREATE) | NACM_BIT(NACM_UPDATE) |
+                    NACM_BIT(NACM_DELETE);
+        }
+    }
+    if ((action = xml_find_body(xrule, "action")) != NULL){
+        if (strcmp(action, "deny") == 0)
+            nr->nr_action = NACM_ACTION_DENY;
+        else if (strcmp(action, "permit") == 0)
+            nr->nr_action = NACM_ACTION_PERMIT;
+    }
+}
+
+/*! Check if a rule-list applies to any of a set of groups
+ *
+ * @param[in]  xrlist  NACM rule-list
+ * @param[in]  gvec    Group names
+ * @param[in]  glen    Length of gvec
+ * @retval     1       Yes
+ * @retval     0       No
  */
 static int
-nacm_rule_rpc(const char *rpc,
-              const char *module,
-              cxobj      *xrule)
+nacm_rulelist_group(cxobj  *xrlist,
+                    char  **gvec,
+                    int     glen)
 {
-    int   retval = -1;
-    char *module_rule; /* rule module name */
-    char *rpc_rule;
-    char *access_operations;
+    cxobj *x = NULL;
+    char  *gname;
+    int    i;
 
-    /*  7a) The rule's "module-name" leaf is "*" or equals the name of
-        the YANG module where the protocol operation is defined. */
-    if ((module_rule = xml_find_body(xrule, "module-name")) == NULL)
-        goto nomatch;
-    if (strcmp(module_rule,"*") && strcmp(module_rule,module))
-        goto nomatch;
-    /*  7b) Either (1) the rule does not have a "rule-type" defined or
-        (2) the "rule-type" is "protocol-operation" and the
-        "rpc-name" is "*" or equals the name of the requested
-        protocol operation. */
-    if ((rpc_rule = xml_find_body(xrule, "rpc-name")) == NULL){
-        if (xml_find_body(xrule, "path") || xml_find_body(xrule, "notification-name"))
-            goto nomatch;
+    while ((x = xml_child_each(xrlist, x, CX_ELMNT)) != NULL) {
+        if (strcmp(xml_name(x), "group") != 0 || (gname = xml_body(x)) == NULL)
+            continue;
+        for (i=0; i<glen; i++)
+            if (gvec[i] && strcmp(gvec[i], gname) == 0)
+                return 1;
     }
-    if (rpc_rule && (strcmp(rpc_rule, "*") && strcmp(rpc_rule, rpc)))
-        goto nomatch;
-    /* 7c) The rule's "access-operations" leaf has the "exec" bit set or
-        has the special value "*". */
-    access_operations = xml_find_body(xrule, "access-operations");
-    if (!match_access(access_operations, "exec", NULL))
-        goto nomatch;
-    retval = 1;
- done:
-    return retval;
- nomatch:
-    retval = 0;
-    goto done;
+    return 0;
 }
 
-/*! Process nacm incoming RPC message validation steps
+/*! Get compiled rules of a user, compile on first use
  *
- * @param[in]  rpc      rpc name
- * @param[in]  module   Yang module name
- * @param[in]  username User name of requestor
- * @param[in]  xnacm    NACM xml tree
- * @param[out] cbret    Cligen buffer result. Set to an error msg if retval=0.
- * @retval     1        Access
- * @retval     0        Not access and cbret set
+ * See RFC8341 3.4.4 and 3.4.5: Check all the "group" entries to see if any of them
+ * contain a "user-name" entry that equals the username. Then process all rule-list
+ * entries whose "group" leaf-list matches any of the user's groups in order.
+ * @param[in]  nc       Compiled NACM rules
+ * @param[in]  username User name
+ * @param[out] nup      Compiled rules of user
+ * @retval     0        OK
  * @retval    -1        Error
- * @see RFC8341 3.4.4.  Incoming RPC Message Validation
- * @see nacm_datanode_write
- * @see nacm_datanode_read
  */
-int
-nacm_rpc(const char *rpc,
-         const char *module,
-         const char *username,
-         cxobj      *xnacm,
-         cbuf       *cbret)
+static int
+nacm_user_get(nacm_compiled *nc,
+              const char    *username,
+              nacm_user    **nup)
 {
-    int     retval = -1;
-    cxobj  *xrule;
-    cxobj **gvec = NULL; /* groups */
-    size_t  glen;
-    cxobj  *rlist;
-    cxobj **rlistvec = NULL; /* rule-list */
-    size_t  rlistlen;
-    cxobj **rvec = NULL; /* rules */
-    size_t  rlen;
-    int     i, j;
-    char   *exec_default = NULL;
-    char   *gname;
-    char   *action;
-    int     match= 0;
-    cvec   *nsc = NULL;
-
-    /* Create namespace context for with nacm namespace as default */
-    if ((nsc = xml_nsctx_init(NULL, NACM_NS)) == NULL)
-        goto done;
-    /* 3.   If the requested operation is the NETCONF <close-session>
-       protocol operation, then the protocol operation is permitted.
-    */
-    if (strcmp(rpc, "close-session") == 0)
-        goto permit;
-    /* 4.   Check all the "group" entries to see if any of them contain a
-       "user-name" entry that equals the username for the session
-       making the request.  (If the "enable-external-groups" leaf is
-       "true", add to these groups the set of groups provided by the
-       transport layer.)               */
-    if (username == NULL){
-        clixon_debug(CLIXON_DBG_NACM, "NACM rpc deny: No user in message");
-        goto step10;
+    int         retval = -1;
+    nacm_user **nupp;
+    nacm_user  *nu = NULL;
+    nacm_rule  *rules;
+    cxobj      *xgroups;
+    cxobj      *xg;
+    cxobj      *xu;
+    cxobj      *xrlist;
+    cxobj      *xrule;
+    char      **gvec = NULL;
+    char      **gvec1;
+    int         glen = 0;
+    char       *body;
+
+    if ((nupp = clicon_hash_value(nc->nc_users, username, NULL)) != NULL){
+        *nup = *nupp;
+        return 0;
     }
-    /* User's group */
-    if (xpath_vec(xnacm, nsc, "groups/group[user-name='%s']", &gvec, &glen, username) < 0)
+    if ((nu = clixon_mem_calloc(CLIXON_MEM_NACM, 1, sizeof(*nu))) == NULL){
+        clixon_err(OE_UNIX, errno, "clixon_mem_calloc");
         goto done;
-    /* 5. If no groups are found, continue with step 10. */
-    if (glen == 0)
-        goto step10;
-    /* 6. Process all rule-list entries, in the order they appear in the
-        configuration.  If a rule-list's "group" leaf-list does not
-        match any of the user's groups, proceed to the next rule-list
-        entry. */
-    if (xpath_vec(xnacm, nsc, "rule-list", &rlistvec, &rlistlen) < 0)
+    }
+    if ((nu->nu_rpc = clicon_hash_init()) == NULL)
         goto done;
-    for (i=0; i<rlistlen; i++){
-        rlist = rlistvec[i];
-        /* Loop through user's group to find match in this rule-list */
-        for (j=0; j<glen; j++){
-            gname = xml_find_body(gvec[j], "name");
-            if (xpath_first(rlist, nsc, ".[group='%s']", gname)!=NULL)
-                break; /* found */
-        }
-        if (j==glen) /* not found */
-            continue;
-        /* 7. For each rule-list entry found, process all rules, in order,
-           until a rule that matches the requested access operation is
-           found.
-        */
-        if (xpath_vec(rlist, nsc, "rule", &rvec, &rlen) < 0)
-            goto done;
-        for (j=0; j<rlen; j++){
-            xrule = rvec[j];
-            if ((match = nacm_rule_rpc(rpc, module, xrule)) < 0)
+    /* User's groups */
+    if (nc->nc_xnacm &&
+        (xgroups = xml_find_type(nc->nc_xnacm, NULL, "groups", CX_ELMNT)) != NULL){
+        xg = NULL;
+        while ((xg = xml_child_each(xgroups, xg, CX_ELMNT)) != NULL) {
+            if (strcmp(xml_name(xg), "group") != 0)
+                continue;
+            xu = NULL;
+            while ((xu = xml_child_each(xg, xu, CX_ELMNT)) != NULL)
+                if (strcmp(xml_name(xu), "user-name") == 0 &&
+                    (body = xml_body(xu)) != NULL && strcmp(body, username) == 0)
+                    break;
+            if (xu == NULL)
+                continue;
+            if ((gvec1 = realloc(gvec, (glen+1)*sizeof(char *))) == NULL){
+                clixon_err(OE_UNIX, errno, "realloc");
                 goto done;
-            if (match)
-                break;
-        }
-        if (match)
-            break;
-        if (rvec){
-            free(rvec);
-            rvec=NULL;
+            }
+            gvec = gvec1;
+            gvec[glen++] = xml_find_body(xg, "name");
         }
     }
-    if (match){
-        if ((action = xml_find_body(xrule, "action")) == NULL)
-            goto step10;
-        if (strcmp(action, "deny") == 0){
-            clixon_debug(CLIXON_DBG_NACM, "NACM rpc deny: %s:%s", module, rpc);
-            if (netconf_access_denied(cbret, "application", "access denied") < 0)
+    nu->nu_groups = glen;
+    /* Rules of rule-lists of user's groups, in order */
+    xrlist = NULL;
+    while (glen && (xrlist = xml_child_each(nc->nc_xnacm, xrlist, CX_ELMNT)) != NULL) {
+        if (strcmp(xml_name(xrlist), "rule-list") != 0 ||
+            nacm_rulelist_group(xrlist, gvec, glen) == 0)
+            continue;
+        xrule = NULL;
+        while ((xrule = xml_child_each(xrlist, xrule, CX_ELMNT)) != NULL) {
+            if (strcmp(xml_name(xrule), "rule") != 0)
+                continue;
+            if ((rules = clixon_mem_realloc(CLIXON_MEM_NACM, nu->nu_rules,
+                                            (nu->nu_len+1)*sizeof(nacm_rule))) == NULL){
+                clixon_err(OE_UNIX, errno, "clixon_mem_realloc");
                 goto done;
-            goto deny;
+            }
+            nu->nu_rules = rules;
+            nacm_rule_compile(xrule, &nu->nu_rules[nu->nu_len++]);
         }
-        else if (strcmp(action, "permit")==0)
-            goto permit;
-
     }
- step10:
-    /*   10.  If the requested protocol operation is defined in a YANG module
-        advertised in the server capabilities and the "rpc" statement
-        contains a "nacm:default-deny-all" statement, then the protocol
-        operation is denied. */
-    /* 11.  If the requested protocol operation is the NETCONF
-        <kill-session> or <delete-config>, then the protocol operation
-        is denied. */
-    if (strcmp(rpc, "kill-session")==0 || strcmp(rpc, "delete-config")==0){
-        if (netconf_access_denied(cbret, "application", "default deny") < 0)
-            goto done;
-        goto deny;
-    }
-    /*   12.  If the "exec-default" leaf is set to "permit", then permit the
-         protocol operation; otherwise, deny the request. */
-    exec_default = xml_find_body(xnacm, "exec-default");
-    if (exec_default ==NULL || strcmp(exec_default, "permit")==0)
-        goto permit;
-    clixon_debug(CLIXON_DBG_NACM, "NACM rpc default deny");
-    if (netconf_access_denied(cbret, "application", "default deny") < 0)
+    if (clicon_hash_add(nc->nc_users, username, &nu, sizeof(nu)) == NULL)
         goto done;
-    goto deny;
- permit:
-    retval = 1;
+    ADDQ(nu, nc->nc_ulist);
+    clixon_debug(CLIXON_DBG_NACM | CLIXON_DBG_DETAIL, "Compiled user %s: %d groups %d rules",
+                 username, nu->nu_groups, nu->nu_len);
+    *nup = nu;
+    nu = NULL;
+    retval = 0;
  done:
-    clixon_debug(CLIXON_DBG_NACM | CLIXON_DBG_DETAIL, "%s %s:%s: %s",
-                 username, module, rpc, retval==1?"permit":retval==0?"deny":"error");
-    if (nsc)
-        xml_nsctx_free(nsc);
+    if (nu)
+        nacm_user_free(nu);
     if (gvec)
         free(gvec);
-    if (rlistvec)
-        free(rlistvec);
-    if (rvec)
-        free(rvec);
     return retval;
- deny: /* Here, cbret must contain a netconf error msg */
-    assert(cbuf_len(cbret));
+}
+
+/*! Resolve path of a compiled rule to a parsed path and a schema node
+ *
+ * If the path does not resolve, it is instead looked up with clixon_xml_find_instance_id
+ * on every access, since a mounted yang spec may not yet exist.
+ * @param[in]  nr     Compiled rule with path
+ * @param[in]  yspec  Top-level yang spec
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+static int
+nacm_rule_resolve(nacm_rule *nr,
+                  yang_stmt *yspec)
+{
+    int          retval = -1;
+    clixon_path *cp;
+    int          ret;
+
+    if ((ret = clixon_instance_id_parse(yspec, &nr->nr_cplist, NULL, "%s", nr->nr_path)) < 0)
+        goto done;
+    if (ret == 1 && (cp = PREVQ(clixon_path *, nr->nr_cplist)) != NULL){
+        nr->nr_ypath = cp->cp_yang;
+        nr->nr_resolved = 1;
+    }
+    else
+        nr->nr_resolved = -1;
     retval = 0;
-    goto done;
+ done:
+    return retval;
 }
 
-/*! Prepared compiled data for NACM data patch code
+/*! Check if the path of a compiled rule may select an ancestor-or-self of a data node
  *
- * Precomputed rules + paths that apply to user group
+ * @param[in]  nr    Compiled rule with path
+ * @param[in]  ys    Yang spec of data node, or NULL
+ * @retval     1     Path schema node is ancestor-or-self of ys, or not known
+ * @retval     0     No
  */
-struct prepvec{
-    qelem_t       pv_q;
-    cxobj        *pv_xrule;
-    clixon_xvec  *pv_xpathvec;
-};
-typedef struct prepvec prepvec;
-
-/*! Delete all Upgrade callbacks
+static int
+nacm_rule_ancestor(nacm_rule *nr,
+                   yang_stmt *ys)
+{
+    yang_stmt *y;
+
+    if (nr->nr_resolved != 1)
+        return 1;
+    for (y = ys; y != NULL; y = yang_parent_get(y)){
+        if (y == nr->nr_ypath)
+            return 1;
+        /* Data in another mounted yang spec may be below the path */
+        if (yang_keyword_get(y) == Y_SPEC)
+            return y != ys_spec(nr->nr_ypath);
+    }
+    return 1;
+}
+
+/*! Compute rules of a user that may apply to a data node for a data access
  *
- * @param[in]  pv_list  Precomputed rules + paths that apply to this user group
- * @retval     0        OK
+ * 6a) The rule's "module-name" leaf is "*" or equals the name of the YANG module where
+ *     the requested data node is defined.
+ * 6b) Either (1) the rule does not have a "rule-type" defined or (2) the "rule-type" is
+ *     "data-node" and the "path" matches the requested data node.
+ * 6c-f) The rule's "access-operations" has the bit of the access set or is "*"
+ * Only the schema node of the path is checked, its instances are checked per data node.
+ * @param[in]  nu      Compiled rules of user
+ * @param[in]  access  Data access
+ * @param[in]  ys      Yang spec of data node, or NULL
+ * @param[in]  ymod    Module of data node, or NULL
+ * @param[out] ym      Rules, ym_vec should have room for nu_len rules
  */
-int
-prepvec_free(prepvec *pv_list)
+static void
+nacm_ymatch_compute(nacm_user       *nu,
+                    enum nacm_access access,
+                    yang_stmt       *ys,
+                    yang_stmt       *ymod,
+                    nacm_ymatch     *ym)
 {
-    prepvec *pv;
+    nacm_rule *nr;
+    int        i;
 
-    while((pv = pv_list) != NULL) {
-        DELQ(pv, pv_list, prepvec *);
-        if (pv->pv_xpathvec)
-            clixon_xvec_free(pv->pv_xpathvec);
-        free(pv);
+    ym->ym_len = 0;
+    for (i=0; i<nu->nu_len; i++){
+        nr = &nu->nu_rules[i];
+        if ((nr->nr_access & NACM_BIT(access)) == 0)
+            continue;
+        if (!nr->nr_haspath && (nr->nr_rpc || nr->nr_notif))
+            continue;
+        if (nr->nr_module == NULL)
+            continue;
+        /* Read requires a module, a write of a node without module is not checked */
+        if (strcmp(nr->nr_module, "*") != 0){
+            if (ymod == NULL){
+                if (access == NACM_READ)
+                    continue;
+            }
+            else if (strcmp(yang_argument_get(ymod), nr->nr_module) != 0)
+                continue;
+        }
+        if (nr->nr_haspath && nacm_rule_ancestor(nr, ys) == 0)
+            continue;
+        ym->ym_vec[ym->ym_len++] = i;
     }
-    return 0;
 }
 
-/*! Add rule to prepvec
+/*! Get rules of a user that may apply to a data node for a data access
  *
- * @param[in]  pv_list  Precomputed rules + paths that apply to user group
- * @param[in]  xrule    NACM rule
+ * Looked up by schema node, computed on first use
+ * @param[in]  nu      Compiled rules of user
+ * @param[in]  access  Data access
+ * @param[in]  ys      Yang spec of data node
+ * @param[in]  xn      XML data node, or NULL to get module from the namespace of ys
+ * @param[in]  yspec   Top-level yang spec
+ * @param[out] ymp     Rules that may apply
+ * @retval     0       OK
+ * @retval    -1       Error
  */
-prepvec *
-prepvec_add(prepvec **pv_listp,
-            cxobj    *xrule)
+static int
+nacm_ymatch_get(nacm_user       *nu,
+                enum nacm_access access,
+                yang_stmt       *ys,
+                cxobj           *xn,
+                yang_stmt       *yspec,
+                nacm_ymatch    **ymp)
 {
-    prepvec *pv;
+    int          retval = -1;
+    yang_stmt   *ymod = NULL;
+    nacm_ymatch *ym = NULL;
+    char        *ns;
+    int         *vec;
 
-    if ((pv = malloc(sizeof(*pv))) == NULL){
-        clixon_err(OE_UNIX, errno, "malloc");
-        return NULL;
+    if (nu->nu_ymap[access] == NULL &&
+        (nu->nu_ymap[access] = clicon_hash_init()) == NULL)
+        goto done;
+    if ((ym = clicon_hash_ptr_value(nu->nu_ymap[access], ys)) == NULL){
+        if (xn != NULL){
+            if (ys_module_by_xml(yspec, xn, &ymod) < 0)
+                goto done;
+        }
+        else if ((ns = yang_find_mynamespace(ys)) != NULL)
+            ymod = yang_find_module_by_namespace(yspec, ns);
+        if ((ym = clixon_mem_calloc(CLIXON_MEM_NACM, 1, sizeof(*ym))) == NULL){
+            clixon_err(OE_UNIX, errno, "clixon_mem_calloc");
+            goto done;
+        }
+        ym->ym_below = -1;
+        ADDQ(ym, nu->nu_ymlist);
+        if ((ym->ym_vec = clixon_mem_calloc(CLIXON_MEM_NACM, nu->nu_len+1, sizeof(int))) == NULL){
+            clixon_err(OE_UNIX, errno, "clixon_mem_calloc");
+            goto done;
+        }
+        nacm_ymatch_compute(nu, access, ys, ymod, ym);
+        /* Most schema nodes have few rules */
+        if ((vec = clixon_mem_realloc(CLIXON_MEM_NACM, ym->ym_vec, (ym->ym_len+1)*sizeof(int))) != NULL)
+            ym->ym_vec = vec;
+        if (clicon_hash_add_ptr(nu->nu_ymap[access], ys, ym) == NULL)
+            goto done;
     }
-    memset(pv, 0, sizeof(*pv));
-    ADDQ(pv, *pv_listp);
-    pv->pv_xrule = xrule;
-    if ((pv->pv_xpathvec = clixon_xvec_new()) == NULL)
-        return NULL;
-    return pv;
+    *ymp = ym;
+    retval = 0;
+ done:
+    return retval;
 }
 
-/*! Prepare datastructures before running through XML tree
+/*! Check if rules of a user may apply to any descendant of a schema node
  *
- * Save rules in a "cache"
- * These rules match:
- *  - user/group
- *  - have read access-op, etc
- * Also make instance-id lookups on top object for each rule. Assume at most one result
- * @param[in]  h        Clixon handle
+ * Computed on first use from the schema children, so that data subtrees without
+ * applicable rules are not traversed.
+ * Data below anydata, anyxml and mount-points is not known and may have rules.
+ * @param[in]  nu      Compiled rules of user
+ * @param[in]  access  Data access
+ * @param[in]  ys      Yang spec of data node
+ * @param[in]  ym      Rules of ys
+ * @param[in]  yspec   Top-level yang spec
+ * @retval     1       Rules may apply to descendants
+ * @retval     0       No rule applies to any descendant
+ * @retval    -1       Error
+ */
+static int
+nacm_ymatch_below(nacm_user       *nu,
+                  enum nacm_access access,
+                  yang_stmt       *ys,
+                  nacm_ymatch     *ym,
+                  yang_stmt       *yspec)
+{
+    yang_stmt   *yc;
+    nacm_ymatch *ymc;
+    int          inext;
+    int          ret;
+
+    if (ym->ym_below != -1)
+        return ym->ym_below;
+    ym->ym_below = 0;
+    if (yang_keyword_get(ys) == Y_ANYDATA || yang_keyword_get(ys) == Y_ANYXML ||
+        yang_schema_mount_point(ys) == 1){
+        ym->ym_below = 1;
+        return 1;
+    }
+    inext = 0;
+    while ((yc = yn_iter(ys, &inext)) != NULL) {
+        if (!yang_datanode(yc) &&
+            yang_keyword_get(yc) != Y_CHOICE && yang_keyword_get(yc) != Y_CASE)
+            continue;
+        if (nacm_ymatch_get(nu, access, yc, NULL, yspec, &ymc) < 0)
+            return -1;
+        if (ymc->ym_len){
+            ym->ym_below = 1;
+            break;
+        }
+        if ((ret = nacm_ymatch_below(nu, access, yc, ymc, yspec)) < 0)
+            return -1;
+        if (ret == 1){
+            ym->ym_below = 1;
+            break;
+        }
+    }
+    return ym->ym_below;
+}
+
+/*! Free instances of rule paths
+ */
+static void
+nacm_xpv_free(clixon_xvec **xpv,
+              int           len)
+{
+    int i;
+
+    for (i=0; i<len; i++)
+        if (xpv[i])
+            clixon_xvec_free(xpv[i]);
+    free(xpv);
+}
+
+/*! Look up instances of rule paths in a request tree
+ *
+ * Instances are looked up on top object for each rule with a path and the access.
  * @param[in]  xt       XML request root tree with "config" label at top.
- * @param[in]  access   NACM access of xreq
- * @param[in]  gvec     Vector of groups
- * @param[in]  glen     Length of gvec
- * @param[in]  rlistvec Rule-list entries
- * @param[in]  rlistlen Length of rlistvec
- * @param[in]  nsc      Namespace context of rule-list
- * @param[out] pv_listp Precomputed rules + paths that apply to user group
+ * @param[in]  yspec    Top-level yang spec
+ * @param[in]  nu       Compiled rules of user
+ * @param[in]  access   Data access
+ * @param[out] xpvp     Per rule: instances of its path, or NULL. Free with nacm_xpv_free
  * @retval     0        OK
  * @retval    -1        Error
  */
 static int
-nacm_datanode_prepare(clixon_handle    h,
-                      cxobj           *xt,
+nacm_datanode_prepare(cxobj           *xt,
+                      yang_stmt       *yspec,
+                      nacm_user       *nu,
                       enum nacm_access access,
-                      cxobj          **gvec,
-                      size_t           glen,
-                      cxobj          **rlistvec,
-                      size_t           rlistlen,
-                      cvec            *nsc,
-                      prepvec        **pv_listp)
+                      clixon_xvec   ***xpvp)
 {
-    int        retval = -1;
-    cxobj     *rlist;
-    int        i;
-    int        j;
-    int        k;
-    char      *gname;
-    cxobj    **rvec = NULL; /* rules */
-    size_t     rlen;
-    cxobj     *xrule;
-    cxobj     *pathobj;
-    char      *access_operations;
-    char      *path0;         /* Non-canonical path */
-    char      *path=NULL;     /* Canonical path */
-    cvec      *nsc0 = NULL;   /* Non-canonical namespace context */
-    yang_stmt *yspec;
-    cxobj   **xvec = NULL;
-    int       xlen = 0;
-    prepvec  *pv;
-    int       ret;
+    int           retval = -1;
+    clixon_xvec **xpv = NULL;
+    nacm_rule    *nr;
+    cxobj       **xvec = NULL;
+    int           xlen = 0;
+    int           i;
+    int           k;
+    int           ret;
 
-    yspec = clicon_dbspec_yang(h);
-    for (i=0; i<rlistlen; i++){         /* Loop through rule list */
-        rlist = rlistvec[i];
-        /* Loop through user's group to find match in this rule-list */
-        for (j=0; j<glen; j++){
-            gname = xml_find_body(gvec[j], "name");
-            if (xpath_first(rlist, nsc, ".[group='%s']", gname)!=NULL)
-                break; /* found */
+    if (access >= NACM_EXEC){
+        clixon_err(OE_XML, EINVAL, "Access %d unupported (shouldnt happen)", access);
+        goto done;
+    }
+    if ((xpv = calloc(nu->nu_len+1, sizeof(clixon_xvec *))) == NULL){
+        clixon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    for (i=0; i<nu->nu_len; i++){
+        nr = &nu->nu_rules[i];
+        if (!nr->nr_haspath || (nr->nr_access & NACM_BIT(access)) == 0)
+            continue;
+        if (nr->nr_resolved == 0 && nacm_rule_resolve(nr, yspec) < 0)
+            goto done;
+        if (nr->nr_resolved == 1){
+            if ((ret = clixon_xml_find_instance_path(xt, yspec, nr->nr_cplist, &xpv[i])) < 0)
+                goto done;
+            continue;
         }
-        if (j==glen) /* not found */
+        if (nr->nr_path == NULL)
             continue;
-        /* 6. For each rule-list entry found, process all rules, in order,
-           until a rule that matches the requested access operation is
-           found. (see 6 sub rules in nacm_rule_datanode
-        */
-        if (xpath_vec(rlist, nsc, "rule", &rvec, &rlen) < 0)
+        /* Path did not resolve when compiled */
+        if ((ret = clixon_xml_find_instance_id(xt, yspec, &xvec, &xlen, "%s", nr->nr_path)) < 0)
             goto done;
-        for (j=0; j<rlen; j++){ /* Loop through rules */
-            xrule = rvec[j];
-            /* 6c) For a "read" access operation, the rule's "access-operations"
-               leaf has the "read" bit set or has the special value "*" */
-            access_operations = xml_find_body(xrule, "access-operations");
-            switch (access){
-            case NACM_READ:
-                /* 6c) For a "read" access operation, the rule's "access-operations"
-                   leaf has the "read" bit set or has the special value "*" */
-                if (!match_access(access_operations, "read", NULL))
-                    continue;
-                break;
-            case NACM_CREATE:
-                /* 6d) For a "create" access operation, the rule's "access-operations"
-                   leaf has the "create" bit set or has the special value "*". */
-                if (!match_access(access_operations, "create", "write"))
-                    continue;
-                break;
-            case NACM_DELETE:
-                /* 6e) For a "delete" access operation, the rule's "access-operations" 
-                   leaf has the "delete" bit set or has the  special value "*". */
-                if (!match_access(access_operations, "delete", "write"))
-                    continue;
-                break;
-            case NACM_UPDATE:
-                /* 6f) For an "update" access operation, the rule's "access-operations"
-                   leaf has the "update" bit set or has the special value "*". */ 
-                if (!match_access(access_operations, "update", "write"))
-                    continue;
-                break;
-            default:
-                clixon_err(OE_XML, EINVAL, "Access %d unupported (shouldnt happen)", access);
+        if (ret == 1 && xlen){
+            if ((xpv[i] = clixon_xvec_new()) == NULL)
                 goto done;
-                break;
-            }
-            /*  6b) Either (1) the rule does not have a "rule-type" defined or
-                (2) the "rule-type" is "data-node" and the "path" matches the
-                requested data node, action node, or notification node. */
-            if ((pathobj = xml_find_type(xrule, NULL, "path", CX_ELMNT)) == NULL){
-                if (xml_find_body(xrule, "rpc-name") || xml_find_body(xrule, "notification-name"))
-                    continue;
-                /* Here a new xrule is found, add it */
-                if (prepvec_add(pv_listp, xrule) == NULL)
-                    goto done;
-            }
-            else{
-                path0 = clixon_trim2(xml_body(pathobj), " \t\n");
-                /* Get canonical namespace context for nacm paths */
-                if ((path = strdup(path0)) == NULL){
-                    clixon_err(OE_UNIX, errno, "strdup");
-                    goto done;
-                }
-#if 0
-                /* See https://github.com/clicon/clixon/issues/129:
-                 * If this is enabled, you are back to the problem of JSON encodings
-                 */
-                /* Create namespace context for with nacm namespace as default */
-                if (xml_nsctx_node(pathobj, &nsc0) < 0)
-                    goto done;
-                /* instance-id requires canonical paths */
-                if (xpath2canonical(path0, nsc0, yspec, &path, NULL) < 0)
-                    goto done;
-#endif
-                if ((ret = clixon_xml_find_instance_id(xt, yspec, &xvec, &xlen, "%s", path)) < 0)
+            for (k=0; k<xlen; k++)
+                if (clixon_xvec_append(xpv[i], xvec[k]) < 0)
                     goto done;
-                if (ret == 0)
-                    continue;
-                /* Here a new xrule is found, add it */
-                if ((pv = prepvec_add(pv_listp, xrule)) == NULL)
-                    goto done;
-                for (k=0; k<xlen; k++){
-                    if (clixon_xvec_append(pv->pv_xpathvec, xvec[k]) < 0)
-                        goto done;
-                }
-                if (xvec){
-                    free(xvec);
-                    xvec = NULL;
-                }
-                if (nsc0){
-                    cvec_free(nsc0);
-                    nsc0 = NULL;
-                }
-                if (path){
-                    free(path);
-                    path = NULL;
-                }
-            }
         }
-        if (rvec){
-            free(rvec);
-            rvec=NULL;
+        if (xvec){
+            free(xvec);
+            xvec = NULL;
         }
     }
+    *xpvp = xpv;
+    xpv = NULL;
     retval = 0;
  done:
     if (xvec)
         free(xvec);
-    if (path)
-        free(path);
-    if (nsc0)
-        cvec_free(nsc0);
+    if (xpv)
+        nacm_xpv_free(xpv, nu->nu_len);
     return retval;
 }
 
-/*---------------------------------------------------------------
- * Datanode write
- */
-
-/*! Match specific rule to specific requested node
+/*! Find first rule of a user matching a data node
  *
+ * @param[in]  nu     Compiled rules of user
+ * @param[in]  ym     Rules that may apply to the node
+ * @param[in]  xpv    Instances of rule paths in request
  * @param[in]  xn     XML node (requested node)
- * @param[in]  xrule  NACM rule
- * @param[in]  xpathvec XPath match
- * @param[in]  yspec  YANG spec
- * @param[out] xpathp If deny, pointer to failing XPath
- * @retval     2      OK and rule matches permit
- * @retval     1      OK and rule matches deny
- * @retval     0      OK and rule does not match
- * @retval    -1      Error
+ * @retval     nr     First matching rule
+ * @retval     NULL   No rule matches
  */
-static int
-nacm_data_write_xrule_xml(cxobj       *xn,
-                          cxobj       *xrule,
-                          clixon_xvec *xpathvec,
-                          yang_stmt   *yspec,
-                          char       **xpathp)
+static nacm_rule *
+nacm_datanode_match(nacm_user    *nu,
+                    nacm_ymatch  *ym,
+                    clixon_xvec **xpv,
+                    cxobj        *xn)
 {
-    int        retval = -1;
-    yang_stmt *ymod;
-    char      *module_pattern; /* rule module name */
-    char      *action;
+    nacm_rule *nr;
     cxobj     *xp;
-    cxobj     *xpath;
     int        i;
+    int        j;
+    int        k;
 
-    if ((module_pattern = xml_find_body(xrule, "module-name")) == NULL)
-        goto nomatch;
-    /* 6a) The rule's "module-name" leaf is "*" or equals the name of
-     * the YANG module where the requested data node is defined. 
-     */
-    if (strcmp(module_pattern, "*") != 0){
-        if (ys_module_by_xml(yspec, xn, &ymod) < 0)
+    for (i=0; i<ym->ym_len; i++){
+        k = ym->ym_vec[i];
+        nr = &nu->nu_rules[k];
+        if (!nr->nr_haspath)
+            return nr;
+        if (xpv[k] == NULL)
+            continue;
+        for (j=0; j<clixon_xvec_len(xpv[k]); j++){
+            xp = clixon_xvec_i(xpv[k], j);
+            /* Check if ancestor is xp */
+            if (xn == xp || xml_isancestor(xn, xp))
+                return nr;
+        }
+    }
+    return NULL;
+}
+
+/*! Match nacm single rule. Either match with access or deny. Or not match.
+ *
+ * @param[in]  rpc    rpc name
+ * @param[in]  module Yang module name
+ * @param[in]  nr     Compiled NACM rule
+ * @retval     1      Matching rule
+ * @retval     0      No matching rule
+ * @see RFC8341 3.4.4.  Incoming RPC Message Validation
+ 7.(cont) A rule matches if all of the following criteria are met:
+        *  The rule's "module-name" leaf is "*" or equals the name of
+           the YANG module where the protocol operation is defined.
+
+        *  Either (1) the rule does not have a "rule-type" defined or
+           (2) the "rule-type" is "protocol-operation" and the
+           "rpc-name" is "*" or equals the name of the requested
+           protocol operation.
+
+        *  The rule's "access-operations" leaf has the "exec" bit set or
+           has the special value "*".
+ */
+static int
+nacm_rule_rpc(const char *rpc,
+              const char *module,
+              nacm_rule  *nr)
+{
+    /*  7a) The rule's "module-name" leaf is "*" or equals the name of
+        the YANG module where the protocol operation is defined. */
+    if (nr->nr_module == NULL)
+        return 0;
+    if (strcmp(nr->nr_module, "*") && strcmp(nr->nr_module, module))
+        return 0;
+    /*  7b) Either (1) the rule does not have a "rule-type" defined or
+        (2) the "rule-type" is "protocol-operation" and the
+        "rpc-name" is "*" or equals the name of the requested
+        protocol operation. */
+    if (nr->nr_rpc == NULL){
+        if (nr->nr_haspath || nr->nr_notif)
+            return 0;
+    }
+    else if (strcmp(nr->nr_rpc, "*") && strcmp(nr->nr_rpc, rpc))
+        return 0;
+    /* 7c) The rule's "access-operations" leaf has the "exec" bit set or
+        has the special value "*". */
+    if ((nr->nr_access & NACM_BIT(NACM_EXEC)) == 0)
+        return 0;
+    return 1;
+}
+
+/*! Process nacm incoming RPC message validation steps
+ *
+ * The first matching rule of a user is looked up by module and rpc name
+ * @param[in]  rpc      rpc name
+ * @param[in]  module   Yang module name
+ * @param[in]  username User name of requestor
+ * @param[in]  xnacm    NACM xml tree
+ * @param[out] cbret    Cligen buffer result. Set to an error msg if retval=0.
+ * @retval     1        Access
+ * @retval     0        Not access and cbret set
+ * @retval    -1        Error
+ * @see RFC8341 3.4.4.  Incoming RPC Message Validation
+ * @see nacm_datanode_write
+ * @see nacm_datanode_read
+ */
+int
+nacm_rpc(const char *rpc,
+         const char *module,
+         const char *username,
+         cxobj      *xnacm,
+         cbuf       *cbret)
+{
+    int            retval = -1;
+    nacm_compiled *nc = NULL;
+    nacm_user     *nu;
+    nacm_rule     *nr;
+    cbuf          *cbkey = NULL;
+    int           *ip;
+    int            i;
+    char          *exec_default = NULL;
+
+    /* 3.   If the requested operation is the NETCONF <close-session>
+       protocol operation, then the protocol operation is permitted.
+    */
+    if (strcmp(rpc, "close-session") == 0)
+        goto permit;
+    /* 4.   Check all the "group" entries to see if any of them contain a
+       "user-name" entry that equals the username for the session
+       making the request.  (If the "enable-external-groups" leaf is
+       "true", add to these groups the set of groups provided by the
+       transport layer.)               */
+    if (username == NULL){
+        clixon_debug(CLIXON_DBG_NACM, "NACM rpc deny: No user in message");
+        goto step10;
+    }
+    if ((nc = nacm_compiled_get(xnacm)) == NULL)
+        goto done;
+    if (nacm_user_get(nc, username, &nu) < 0)
+        goto done;
+    /* 5. If no groups are found, continue with step 10. */
+    if (nu->nu_groups == 0)
+        goto step10;
+    /* 6. Process all rule-list entries, in the order they appear in the
+        configuration.  If a rule-list's "group" leaf-list does not
+        match any of the user's groups, proceed to the next rule-list
+        entry.
+       7. For each rule-list entry found, process all rules, in order,
+           until a rule that matches the requested access operation is
+           found.
+    */
+    if ((cbkey = cbuf_new()) == NULL){
+        clixon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    cprintf(cbkey, "%s:%s", module, rpc);
+    if ((ip = clicon_hash_value(nu->nu_rpc, cbuf_get(cbkey), NULL)) != NULL)
+        i = *ip;
+    else {
+        for (i=0; i<nu->nu_len; i++)
+            if (nacm_rule_rpc(rpc, module, &nu->nu_rules[i]))
+                break;
+        i = i<nu->nu_len ? i+1 : 0;
+        if (clicon_hash_add(nu->nu_rpc, cbuf_get(cbkey), &i, sizeof(i)) == NULL)
             goto done;
-        /* ymod is NULL (xn is "config") Can this breach the NACM rule? */
-        if (ymod && strcmp(yang_argument_get(ymod), module_pattern) != 0)
-            goto nomatch;
-    }
-    action = xml_find_body(xrule, "action"); /* mandatory */
-    /*  6b) Either (1) the rule does not have a "rule-type" defined or
-        (2) the "rule-type" is "data-node" and the "path" matches the
-        Requested data node, action node, or notification node. */
-    if ((xpath = xml_find_type(xrule, NULL, "path", CX_ELMNT)) == NULL){
-        if (strcmp(action, "deny")==0){
-            *xpathp = NULL;
+    }
+    if (i > 0){
+        nr = &nu->nu_rules[i-1];
+        if (nr->nr_action == NACM_ACTION_DENY){
+            clixon_debug(CLIXON_DBG_NACM, "NACM rpc deny: %s:%s", module, rpc);
+            if (netconf_access_denied(cbret, "application", "access denied") < 0)
+                goto done;
             goto deny;
         }
-        goto permit;
-    }
-    for (i=0; i<clixon_xvec_len(xpathvec); i++){
-        xp = clixon_xvec_i(xpathvec, i);
-        /* Check if ancestor is xp (for every xpathvec?) */
-        if (xn == xp || xml_isancestor(xn, xp)){
-            if (strcmp(action, "deny") == 0){
-                *xpathp = xml_body(xpath);
-                goto deny;
-            }
+        else if (nr->nr_action == NACM_ACTION_PERMIT)
             goto permit;
-        }
     }
-    goto nomatch;
+ step10:
+    /*   10.  If the requested protocol operation is defined in a YANG module
+        advertised in the server capabilities and the "rpc" statement
+        contains a "nacm:default-deny-all" statement, then the protocol
+        operation is denied. */
+    /* 11.  If the requested protocol operation is the NETCONF
+        <kill-session> or <delete-config>, then the protocol operation
+        is denied. */
+    if (strcmp(rpc, "kill-session")==0 || strcmp(rpc, "delete-config")==0){
+        if (netconf_access_denied(cbret, "application", "default deny") < 0)
+            goto done;
+        goto deny;
+    }
+    /*   12.  If the "exec-default" leaf is set to "permit", then permit the
+         protocol operation; otherwise, deny the request. */
+    exec_default = xml_find_body(xnacm, "exec-default");
+    if (exec_default ==NULL || strcmp(exec_default, "permit")==0)
+        goto permit;
+    clixon_debug(CLIXON_DBG_NACM, "NACM rpc default deny");
+    if (netconf_access_denied(cbret, "application", "default deny") < 0)
+        goto done;
+    goto deny;
  permit:
-    retval = 2;       /* rule match and permit */
+    retval = 1;
  done:
+    clixon_debug(CLIXON_DBG_NACM | CLIXON_DBG_DETAIL, "%s %s:%s: %s",
+                 username, module, rpc, retval==1?"permit":retval==0?"deny":"error");
+    if (cbkey)
+        cbuf_free(cbkey);
+    if (nc && nc != _nacm_compiled)
+        nacm_compiled_free(nc);
     return retval;
- nomatch :  /* rule does not match */
+ deny: /* Here, cbret must contain a netconf error msg */
+    assert(cbuf_len(cbret));
     retval = 0;
     goto done;
- deny:      /* rule match and deny */
-    retval = 1;
-    goto done;
 }
 
+/*---------------------------------------------------------------
+ * Datanode write
+ */
+
 /*! Recursive check for NACM write rules among all XML nodes
  *
- * @param[in]  h         Clixon handle
  * @param[in]  xn        XML node (requested node)
- * @param[in]  pv_list   Precomputed rules + paths that apply to user group
+ * @param[in]  nu        Compiled rules of user
+ * @param[in]  access    NACM access of xn
+ * @param[in]  xpv       Instances of rule paths in request
  * @param[in]  defpermit 0 if default deny, 1 is default permit
  * @param[in]  yspec     YANG spec
  * @param[out] cbret     Error message if retval = 0
@@ -701,65 +1014,77 @@ nacm_data_write_xrule_xml(cxobj       *xn,
  * @retval     1         OK and accept
  * @retval     0         Deny and cbret set
  * @retval    -1         Error
- * XXX differentiate between nomatch: default. or match deny, match accept 
  * nomatch: check write-default rules, next v
  * accept:  Hunky dory
  * deny:    Send error message
  */
 static int
-nacm_datanode_write_recurse(clixon_handle h,
-                            cxobj        *xn,
-                            prepvec      *pv_list,
-                            int           defpermit,
-                            yang_stmt    *yspec,
-                            cbuf         *cbret,
-                            char        **xpathp)
+nacm_datanode_write_recurse(cxobj           *xn,
+                            nacm_user       *nu,
+                            enum nacm_access access,
+                            clixon_xvec    **xpv,
+                            int              defpermit,
+                            yang_stmt       *yspec,
+                            cbuf            *cbret,
+                            char           **xpathp)
 {
-    int      retval = -1;
-    cxobj   *x;
-    int      ret = 0;
-    prepvec *pv;
-
-    pv = pv_list;
-    if (pv){
-        do {
-            /* return values: -1:Error /0:no match /1: deny /2: permit
-             */
-            if ((ret = nacm_data_write_xrule_xml(xn, pv->pv_xrule, pv->pv_xpathvec, yspec, xpathp)) < 0)
-                goto done;
-            switch(ret){
-            case 0: /* No match, continue with next rule */
-                break;
-            case 1: /* Match and deny: break all traversal and send error back to client */
-                if (netconf_access_denied(cbret, "application", "access denied") < 0)
-                    goto done;
-                goto deny;
-                break;
-            case 2: /* Match and permit: break rule processing but continue recursion */
-                break;
-            }
-            if (ret == 2)
-                break;
-            pv = NEXTQ(prepvec *, pv);
-        } while (pv && pv != pv_list);
+    int          retval = -1;
+    cxobj       *x;
+    nacm_ymatch *ym = NULL;
+    nacm_ymatch  ym0 = {{0},};
+    yang_stmt   *ys;
+    yang_stmt   *ymod = NULL;
+    nacm_rule   *nr;
+    int          ret;
+
+    if ((ys = xml_spec(xn)) != NULL){
+        if (nacm_ymatch_get(nu, access, ys, xn, yspec, &ym) < 0)
+            goto done;
+    }
+    else { /* eg "config", not looked up */
+        if (ys_module_by_xml(yspec, xn, &ymod) < 0)
+            goto done;
+        if ((ym0.ym_vec = calloc(nu->nu_len+1, sizeof(int))) == NULL){
+            clixon_err(OE_UNIX, errno, "calloc");
+            goto done;
+        }
+        nacm_ymatch_compute(nu, access, NULL, ymod, &ym0);
+        ym = &ym0;
+    }
+    if ((nr = nacm_datanode_match(nu, ym, xpv, xn)) != NULL &&
+        nr->nr_action != NACM_ACTION_PERMIT){
+        /* Match and deny: break all traversal and send error back to client */
+        *xpathp = nr->nr_path;
+        if (netconf_access_denied(cbret, "application", "access denied") < 0)
+            goto done;
+        goto deny;
     }
     /* If no rule match, check default rule: if deny then break traversal and send error */
-    if (ret == 0 && !defpermit){
+    if (nr == NULL && !defpermit){
         if (netconf_access_denied(cbret, "application", "default deny") < 0)
             goto done;
         goto deny;
     }
-    /* If node should be purged, dont recurse and defer removal to caller */
+    /* If default permit and no rule applies below, all descendants are accepted */
+    if (ys != NULL && defpermit){
+        if ((ret = nacm_ymatch_below(nu, access, ys, ym, yspec)) < 0)
+            goto done;
+        if (ret == 0)
+            goto ok;
+    }
     x = NULL;   /* Recursively check XML */
     while ((x = xml_child_each(xn, x, CX_ELMNT)) != NULL) {
-        if ((ret = nacm_datanode_write_recurse(h, x, pv_list,
+        if ((ret = nacm_datanode_write_recurse(x, nu, access, xpv,
                                                defpermit, yspec, cbret, xpathp)) < 0)
             goto done;
         if (ret == 0)
             goto deny;
     }
+ ok:
     retval = 1; /* accept */
  done:
+    if (ym0.ym_vec)
+        free(ym0.ym_vec);
     return retval;
  deny:
     retval = 0; /* deny */
@@ -794,21 +1119,15 @@ nacm_datanode_write(clixon_handle    h,
                     cxobj           *xnacm,
                     cbuf            *cbret)
 {
-    int      retval = -1;
-    cxobj  **gvec = NULL; /* groups */
-    size_t   glen;
-    cxobj  **rlistvec = NULL; /* rule-list */
-    size_t   rlistlen;
-    cxobj  **rvec = NULL; /* rules */
-    char    *write_default = NULL;
-    cvec    *nsc = NULL;
-    prepvec *pv_list = NULL;
-    char    *xpath = NULL;
-    int      ret;
+    int            retval = -1;
+    char          *write_default = NULL;
+    nacm_compiled *nc = NULL;
+    nacm_user     *nu = NULL;
+    clixon_xvec  **xpv = NULL;
+    char          *xpath = NULL;
+    yang_stmt     *yspec;
+    int            ret;
 
-    /* Create namespace context for with nacm namespace as default */
-    if ((nsc = xml_nsctx_init(NULL, NACM_NS)) == NULL)
-        goto done;
     if (xnacm == NULL)
         goto permit;
     /* write-default (create, update, or delete) has default deny so should never be NULL */
@@ -823,26 +1142,26 @@ nacm_datanode_write(clixon_handle    h,
        transport layer.)               */
     if (username == NULL)
         goto step9;
-    /* User's group */
-    if (xpath_vec(xnacm, nsc, "groups/group[user-name='%s']", &gvec, &glen, username) < 0)
+    if ((nc = nacm_compiled_get(xnacm)) == NULL)
+        goto done;
+    if (nacm_user_get(nc, username, &nu) < 0)
         goto done;
     /* 4. If no groups are found, continue with step 9. */
-    if (glen == 0)
+    if (nu->nu_groups == 0)
         goto step9;
     /* 5. Process all rule-list entries, in the order they appear in the
         configuration.  If a rule-list's "group" leaf-list does not
         match any of the user's groups, proceed to the next rule-list
         entry. */
-    if (xpath_vec(xnacm, nsc, "rule-list", &rlistvec, &rlistlen) < 0)
-        goto done;
-    /* First run through rules and cache rules as well as lookup objects in xt. 
+    yspec = clicon_dbspec_yang(h);
+    /* First lookup objects in xt of rules with paths
      */
-    if (nacm_datanode_prepare(h, xt, access, gvec, glen, rlistvec, rlistlen, nsc, &pv_list) < 0)
+    if (nacm_datanode_prepare(xt, yspec, nu, access, &xpv) < 0)
         goto done;
     /* Then recursively traverse all requested nodes */
-    if ((ret = nacm_datanode_write_recurse(h, xreq, pv_list,
+    if ((ret = nacm_datanode_write_recurse(xreq, nu, access, xpv,
                                            strcmp(write_default, "deny"),
-                                           clicon_dbspec_yang(h),
+                                           yspec,
                                            cbret, &xpath)) < 0)
         goto done;
     if (ret == 0) /* deny */
@@ -874,16 +1193,10 @@ nacm_datanode_write(clixon_handle    h,
     if (retval != 0)
         clixon_debug_xml(CLIXON_DBG_NACM | CLIXON_DBG_DETAIL, xreq, "Write %s: %s",
                          username, retval==1?"permit":retval==0?"deny":"error");
-    if (pv_list)
-        prepvec_free(pv_list);
-    if (nsc)
-        xml_nsctx_free(nsc);
-    if (gvec)
-        free(gvec);
-    if (rlistvec)
-        free(rlistvec);
-    if (rvec)
-        free(rvec);
+    if (xpv)
+        nacm_xpv_free(xpv, nu->nu_len);
+    if (nc && nc != _nacm_compiled)
+        nacm_compiled_free(nc);
     return retval;
  deny: /* Here, cbret must contain a netconf error msg */
     if (xpath)
@@ -901,144 +1214,72 @@ nacm_datanode_write(clixon_handle    h,
 
 /*! Perform NACM action: mark if permit, del if deny
  *
- * @param[in]  xrule  NACM rule
+ * @param[in]  nr     Compiled NACM rule
  * @param[in]  xn     XML node (requested node)
- * @retval     0      OK
- * @retval    -1      Error
  */
-static int
-nacm_data_read_action(cxobj *xrule,
-                      cxobj *xn,
-                      char  *xpath)
+static void
+nacm_data_read_action(nacm_rule *nr,
+                      cxobj     *xn)
 {
-    int   retval = -1;
-    char *action;
-
-    if ((action = xml_find_body(xrule, "action")) != NULL){
-        if (strcmp(action, "deny")==0){
-            if (xpath)
-                clixon_debug_xml(CLIXON_DBG_NACM, xn, "NACM data node read deny path:%s", xpath);
-            else
-                clixon_debug(CLIXON_DBG_NACM, "NACM data node read deny");
-            xml_flag_set(xn, XML_FLAG_DENY);
-        }
-        else if (strcmp(action, "permit")==0)
-            xml_flag_set(xn, XML_FLAG_ADD);
+    if (nr->nr_action == NACM_ACTION_DENY){
+        if (nr->nr_path)
+            clixon_debug_xml(CLIXON_DBG_NACM, xn, "NACM data node read deny path:%s", nr->nr_path);
+        else
+            clixon_debug(CLIXON_DBG_NACM, "NACM data node read deny");
+        xml_flag_set(xn, XML_FLAG_DENY);
     }
-    retval = 0;
-    //done:
-    return retval;
+    else if (nr->nr_action == NACM_ACTION_PERMIT)
+        xml_flag_set(xn, XML_FLAG_ADD);
 }
 
-/*! Match specific rule to specific requested node
+/*! Recursive check and mark with DEL flag for NACM read rules among all XML nodes
  *
- * @param[in]  xn       XML node (requested node)
- * @param[in]  xrule    NACM rule
- * @param[in]  xpathvec
- * @param[in]  yspec    YANG spec
- * @retval     1        OK and rule matches
- * @retval     0        OK and rule does not match
- * @retval    -1        Error
  * Two distinct cases:
  * (1) read_default is permit
  *     mark all deny rules and remove them
  * (2) read_default is deny:
  *     mark all permit rules and ancestors, remove everything else
- */
-static int
-nacm_data_read_xrule_xml(cxobj       *xn,
-                         cxobj       *xrule,
-                         clixon_xvec *xpathvec,
-                         yang_stmt   *yspec)
-{
-    int        retval = -1;
-    yang_stmt *ymod;
-    char      *module_pattern; /* rule module name */
-    cxobj     *xp;
-    cxobj     *xpath;
-    int        i;
-
-    if ((module_pattern = xml_find_body(xrule, "module-name")) == NULL)
-        goto nomatch;
-    /* 6a) The rule's "module-name" leaf is "*" or equals the name of
-     * the YANG module where the requested data node is defined. 
-     */
-    if (strcmp(module_pattern, "*") != 0){
-        if (ys_module_by_xml(yspec, xn, &ymod) < 0)
-            goto done;
-        if (ymod==NULL || strcmp(yang_argument_get(ymod), module_pattern) != 0)
-            goto nomatch;
-    }
-    /*  6b) Either (1) the rule does not have a "rule-type" defined or
-        (2) the "rule-type" is "data-node" and the "path" matches the
-        requested data node, action node, or notification node. */
-    if ((xpath = xml_find_type(xrule, NULL, "path", CX_ELMNT)) == NULL){
-        if (nacm_data_read_action(xrule, xn, NULL) < 0)
-            goto done;
-        goto match;
-    }
-    for (i=0; i<clixon_xvec_len(xpathvec); i++){
-        xp = clixon_xvec_i(xpathvec, i);
-        /* Check if ancestor is xp (for every xpathvec?) */
-        if (xn == xp || xml_isancestor(xn, xp)){
-            if (nacm_data_read_action(xrule, xn, xml_body(xpath)) < 0)
-                goto done;
-            goto match;
-        }
-    }
- nomatch:
-    retval = 0;
- done:
-    return retval;
- match:
-    retval = 1; /* match */
-    goto done;
-}
-
-/*! Recursive check and mark with DEL flag for NACM read rules among all XML nodes
- *
- * @param[in]  h        Clixon handle
  * @param[in]  xn       XML node (requested node)
- * @param[in]  pv_list  Precomputed rules + paths that apply to this user group
+ * @param[in]  nu       Compiled rules of user
+ * @param[in]  xpv      Instances of rule paths in request
  * @param[in]  yspec    YANG spec
  * @retval     0        OK
  * @retval    -1        Error
  */
 static int
-nacm_datanode_read_recurse(clixon_handle h,
-                           cxobj        *xn,
-                           prepvec      *pv_list,
+nacm_datanode_read_recurse(cxobj        *xn,
+                           nacm_user    *nu,
+                           clixon_xvec **xpv,
                            yang_stmt    *yspec)
 {
-    int      retval = -1;
-    cxobj   *x;
-    prepvec *pv;
-    int      ret;
+    int          retval = -1;
+    cxobj       *x;
+    nacm_ymatch *ym;
+    nacm_rule   *nr;
+    yang_stmt   *ys;
+    int          ret;
 
-    if (xml_spec(xn)){ /* Check this node */
-        pv = pv_list;
-        if (pv){
-            do {
-                /* Marks xn with ADD/DENY */
-                if ((ret = nacm_data_read_xrule_xml(xn,
-                                                    pv->pv_xrule,
-                                                    pv->pv_xpathvec,
-                                                    yspec)) < 0)
-                    goto done;
-                if (ret == 1)
-                    break; /* stop at first match */
-                pv = NEXTQ(prepvec *, pv);
-            } while (pv && pv != pv_list);
-        }
+    if ((ys = xml_spec(xn)) != NULL){ /* Check this node */
+        if (nacm_ymatch_get(nu, NACM_READ, ys, xn, yspec, &ym) < 0)
+            goto done;
+        /* Marks xn with ADD/DENY, stop at first match */
+        if ((nr = nacm_datanode_match(nu, ym, xpv, xn)) != NULL)
+            nacm_data_read_action(nr, xn);
+        /* No rule applies below, descendants are not marked */
+        if ((ret = nacm_ymatch_below(nu, NACM_READ, ys, ym, yspec)) < 0)
+            goto done;
+        if (ret == 0)
+            goto ok;
     }
     /* If node should be purged, dont recurse and defer removal to caller */
     if (xml_flag(xn, XML_FLAG_DENY) == 0){
         x = NULL;       /* Recursively check XML */
         while ((x = xml_child_each(xn, x, CX_ELMNT)) != NULL) {
-            if (nacm_datanode_read_recurse(h, x, pv_list, yspec) < 0)
+            if (nacm_datanode_read_recurse(x, nu, xpv, yspec) < 0)
                 goto done;
         }
     }
+ ok:
     retval = 0;
  done:
     return retval;
@@ -1048,8 +1289,8 @@ nacm_datanode_read_recurse(clixon_handle h,
  *
  * Mark nodes with XML_FLAG_DENY that fail validation (dont send netconf error message)
  * @param[in]  h        Clixon handle
- * @param[in]  xt       XML root tree with "config" label 
- * @param[in]  username 
+ * @param[in]  xt       XML root tree with "config" label
+ * @param[in]  username
  * @param[in]  xnacm    NACM xml tree
  * @retval     1        Access
  * @retval     0        Not access and cbret set
@@ -1064,7 +1305,7 @@ nacm_datanode_read_recurse(clixon_handle h,
  * Suppose a tree is accessed. Is "the data node" just the top of the tree?
  * (1) Or is it all nodes, recursively, in the data-tree?
  * (2) Or is the datanode only the requested tree, NOT the whole datatree?
- * Example: 
+ * Example:
  * - r0 default permit/deny *
  * - rule r1 to permit/deny /a
  * - rule r2 to permit/deny /a/b
@@ -1075,7 +1316,7 @@ nacm_datanode_read_recurse(clixon_handle h,
  * 1. The requested node is a set of nodes in a tree (not just the top-node)
  * 2. Any node descendants of a deny is denied (except default)
  * 3. First rule matching a node is the active rule
- * 
+ *
  * Algorithm:  Select either (A) or (B)
  *
  * 1. Select next node N in the requested node tree:
@@ -1087,6 +1328,7 @@ nacm_datanode_read_recurse(clixon_handle h,
  * 7. If remaining nodes, goto 1
  * 8(B) If default rule is deny, recursively remove all subtrees that are not marked
  *
+ * The applicable rules of step 2 are looked up by the schema node of N
  * @see RFC8341 3.4.5.  Data Node Access Validation
  * @see nacm_datanode_prune   Call this function if you actually want to prune DELs
  * @see nacm_datanode_write
@@ -1098,19 +1340,14 @@ nacm_datanode_read1(clixon_handle h,
                     const char   *username,
                     cxobj        *xnacm)
 {
-    int      retval = -1;
-    cxobj  **gvec = NULL; /* groups */
-    size_t   glen;
-    cxobj  **rlistvec = NULL; /* rule-list */
-    size_t   rlistlen;
-    char    *read_default = NULL;
-    cvec    *nsc = NULL;
-    prepvec *pv_list = NULL;
+    int            retval = -1;
+    char          *read_default = NULL;
+    nacm_compiled *nc = NULL;
+    nacm_user     *nu = NULL;
+    clixon_xvec  **xpv = NULL;
+    yang_stmt     *yspec;
 
     xml_apply(xt, CX_ELMNT, (xml_applyfn_t*)xml_flag_reset, (void*)(XML_FLAG_DENY|XML_FLAG_ADD));
-    /* Create namespace context for with nacm namespace as default */
-    if ((nsc = xml_nsctx_init(NULL, NACM_NS)) == NULL)
-        goto done;
     /* 3.   Check all the "group" entries to see if any of them contain a
        "user-name" entry that equals the username for the session
        making the request.  (If the "enable-external-groups" leaf is
@@ -1118,29 +1355,29 @@ nacm_datanode_read1(clixon_handle h,
        transport layer.)               */
     if (username == NULL)
         goto step9;
-    /* User's group */
-    if (xpath_vec(xnacm, nsc, "groups/group[user-name='%s']", &gvec, &glen, username) < 0)
+    /* read-default has default permit so should never be NULL */
+    if ((read_default = xml_find_body(xnacm, "read-default")) == NULL){
+        clixon_err(OE_XML, EINVAL, "No nacm read-default rule");
         goto done;
-    /* 4. If no groups are found (glen=0), continue and check read-default 
-          in step 11. */
-    /* 5. Process all rule-list entries, in the order they appear in the
+    }
+    /* 4. If no groups are found (nu_groups=0), continue and check read-default
+          in step 11.
+       5. Process all rule-list entries, in the order they appear in the
         configuration.  If a rule-list's "group" leaf-list does not
         match any of the user's groups, proceed to the next rule-list
         entry. */
-    if (xpath_vec(xnacm, nsc, "rule-list", &rlistvec, &rlistlen) < 0)
+    if ((nc = nacm_compiled_get(xnacm)) == NULL)
         goto done;
-    /* read-default has default permit so should never be NULL */
-    if ((read_default = xml_find_body(xnacm, "read-default")) == NULL){
-        clixon_err(OE_XML, EINVAL, "No nacm read-default rule");
+    if (nacm_user_get(nc, username, &nu) < 0)
         goto done;
-    }
-    /* First run through rules and cache rules as well as lookup objects in xt. 
+    yspec = clicon_dbspec_yang(h);
+    /* First lookup objects in xt of rules with paths.
      * DANGER: objects could be stale if they are removed?
      */
-    if (nacm_datanode_prepare(h, xt, NACM_READ, gvec, glen, rlistvec, rlistlen, nsc, &pv_list) < 0)
+    if (nacm_datanode_prepare(xt, yspec, nu, NACM_READ, &xpv) < 0)
         goto done;
     /* Then recursively traverse all nodes */
-    if (nacm_datanode_read_recurse(h, xt, pv_list, clicon_dbspec_yang(h)) < 0)
+    if (nacm_datanode_read_recurse(xt, nu, xpv, yspec) < 0)
         goto done;
     /* Step 8(B) above:
      * If default rule is deny, recursively remove all subtrees that are not marked
@@ -1175,14 +1412,125 @@ nacm_datanode_read1(clixon_handle h,
  done:
     if (xt)
         xml_apply(xt, CX_ELMNT, (xml_applyfn_t*)xml_flag_reset, (void*)XML_FLAG_ADD);
-    if (pv_list)
-        prepvec_free(pv_list);
-    if (nsc)
-        xml_nsctx_free(nsc);
-    if (gvec)
-        free(gvec);
-    if (rlistvec)
-        free(rlistvec);
+    if (xpv)
+        nacm_xpv_free(xpv, nu->nu_len);
+    if (nc && nc != _nacm_compiled)
+        nacm_compiled_free(nc);
+    return retval;
+}
+
+/*! Argument of NACM read filter, see nacm_datanode_read_filter
+ */
+typedef struct {
+    nacm_user    *nf_nu;    /* Compiled rules of user */
+    clixon_xvec **nf_xpv;   /* Instances of rule paths in tree */
+    yang_stmt    *nf_yspec; /* Top-level yang spec */
+} nacm_filter_arg;
+
+/*! Filter function of NACM read access, see clixon_xml2cbuf_filter
+ *
+ * Same decision as nacm_datanode_read_recurse with read-default permit: leave out the
+ * first node matching a deny rule
+ * @param[in]  x    XML element
+ * @param[in]  arg  NACM filter argument
+ * @retval     2    Print element and filter its children
+ * @retval     1    Print element and its subtree
+ * @retval     0    Leave out element and its subtree
+ * @retval    -1    Error
+ */
+static int
+nacm_datanode_read_fn(cxobj *x,
+                      void  *arg)
+{
+    nacm_filter_arg *nf = (nacm_filter_arg *)arg;
+    yang_stmt       *ys;
+    nacm_ymatch     *ym;
+    nacm_rule       *nr;
+    int              ret;
+
+    if ((ys = xml_spec(x)) == NULL)
+        return 2;
+    if (nacm_ymatch_get(nf->nf_nu, NACM_READ, ys, x, nf->nf_yspec, &ym) < 0)
+        return -1;
+    if ((nr = nacm_datanode_match(nf->nf_nu, ym, nf->nf_xpv, x)) != NULL &&
+        nr->nr_action == NACM_ACTION_DENY){
+        clixon_debug(CLIXON_DBG_NACM | CLIXON_DBG_DETAIL, "NACM data node read deny %s", xml_name(x));
+        return 0;
+    }
+    if ((ret = nacm_ymatch_below(nf->nf_nu, NACM_READ, ys, ym, nf->nf_yspec)) < 0)
+        return -1;
+    return ret == 0 ? 1 : 2;
+}
+
+/*! Check if NACM read access can be applied while printing, with nacm_datanode_read_filter
+ *
+ * This is the case if a user is given and read-default is permit. Otherwise, a node is
+ * only printed if a descendant is permitted, use nacm_datanode_read1 and prune.
+ * @param[in]  username User name
+ * @param[in]  xnacm    NACM xml tree
+ * @retval     1        Yes, use nacm_datanode_read_filter
+ * @retval     0        No, use nacm_datanode_read1 and nacm_datanode_read_prune
+ */
+int
+nacm_datanode_read_filtered(const char *username,
+                            cxobj      *xnacm)
+{
+    char *read_default;
+
+    if (username == NULL || xnacm == NULL)
+        return 0;
+    if ((read_default = xml_find_body(xnacm, "read-default")) == NULL)
+        return 0;
+    return strcmp(read_default, "permit") == 0;
+}
+
+/*! Print XML tree with NACM read access applied, without modifying the tree
+ *
+ * Same output as nacm_datanode_read1 and nacm_datanode_read_prune followed by
+ * clixon_xml2cbuf1, but denied subtrees are not printed instead of removed.
+ * @param[in]  h        Clixon handle
+ * @param[out] cb       Cligen buffer to write to
+ * @param[in]  xt       XML root tree
+ * @param[in]  username User name
+ * @param[in]  xnacm    NACM xml tree
+ * @param[in]  depth    Nr of levels to print, -1 is all, 0 is none
+ * @param[in]  wdef     With-defaults parameter
+ * @retval     0        OK
+ * @retval    -1        Error
+ * @note Only if nacm_datanode_read_filtered returns 1
+ * @see nacm_datanode_read1
+ */
+int
+nacm_datanode_read_filter(clixon_handle     h,
+                          cbuf             *cb,
+                          cxobj            *xt,
+                          const char       *username,
+                          cxobj            *xnacm,
+                          int32_t           depth,
+                          withdefaults_type wdef)
+{
+    int             retval = -1;
+    nacm_compiled  *nc = NULL;
+    nacm_user      *nu = NULL;
+    nacm_filter_arg nf = {0,};
+
+    if ((nc = nacm_compiled_get(xnacm)) == NULL)
+        goto done;
+    if (nacm_user_get(nc, username, &nu) < 0)
+        goto done;
+    nf.nf_nu = nu;
+    nf.nf_yspec = clicon_dbspec_yang(h);
+    /* First lookup objects in xt of rules with paths */
+    if (nacm_datanode_prepare(xt, nf.nf_yspec, nu, NACM_READ, &nf.nf_xpv) < 0)
+        goto done;
+    if (clixon_xml2cbuf_filter(cb, xt, 0, 0, depth, 0, wdef, nacm_datanode_read_fn, &nf) < 0)
+        goto done;
+    retval = 0;
+ done:
+    if (nf.nf_xpv)
+        nacm_xpv_free(nf.nf_xpv, nu->nu_len);
+    if (nc && nc != _nacm_compiled)
+        nacm_compiled_free(nc);
     return retval;
 }
 
@@ -1299,15 +1647,78 @@ nacm_access_check(clixon_handle h,
     goto done;
 }
 
+/*! Get generation of running, or 0 if no running
+ */
+static uint64_t
+nacm_running_gen(clixon_handle h)
+{
+    db_elmnt *de;
+
+    if ((de = xmldb_find(h, "running")) == NULL)
+        return 0;
+    return xmldb_generation_get(de);
+}
+
+/*! Replace compiled NACM rules with rules of a new NACM tree
+ *
+ * Rules of users are compiled on first use
+ * @param[in]  xt    XML tree with "nacm" top-level child, or NULL. Consumed
+ * @param[in]  xext  External NACM tree xt is a copy of, or NULL if running
+ * @param[in]  gen   Generation of running xt is read from
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+static int
+nacm_compiled_load(cxobj   *xt,
+                   cxobj   *xext,
+                   uint64_t gen)
+{
+    int    retval = -1;
+    cxobj *xnacm = NULL;
+    cvec  *nsc = NULL;
+
+    if (_nacm_compiled){
+        nacm_compiled_free(_nacm_compiled);
+        _nacm_compiled = NULL;
+    }
+    if (xt != NULL){
+        if ((nsc = xml_nsctx_init(NULL, NACM_NS)) == NULL)
+            goto done;
+        if ((xnacm = xpath_first(xt, nsc, "nacm")) != NULL){
+            if (xml_rootchild_node(xt, xnacm) < 0)
+                goto done;
+            xt = NULL;
+        }
+    }
+    /* If config does not exist, rules are compiled with no NACM tree */
+    if ((_nacm_compiled = nacm_compiled_new(xnacm, 1)) == NULL)
+        goto done;
+    xnacm = NULL;
+    _nacm_compiled->nc_xext = xext;
+    _nacm_compiled->nc_gen = gen;
+    clixon_debug(CLIXON_DBG_NACM | CLIXON_DBG_DETAIL, "NACM rules compiled, gen:%" PRIu64, gen);
+    retval = 0;
+ done:
+    if (nsc)
+        xml_nsctx_free(nsc);
+    if (xt)
+        xml_free(xt);
+    else if (xnacm)
+        xml_free(xnacm);
+    return retval;
+}
+
 /*! NACM intial pre- access control enforcements
  *
  * Initial NACM steps and common to all NACM access validation.
  * If retval=0 continue with next NACM step, eg rpc, module, 
  * etc. If retval = 1 access is OK and skip next NACM step.
+ * The NACM tree is read and its rules compiled only when NACM config has changed, ie
+ * when the external NACM tree is new or running has a new generation.
  * @param[in]  h        Clixon handle
  * @param[in]  peername Peer username if any
  * @param[in]  username User name of requestor
- * @param[out] xnacm    NACM XML tree, set if retval=0. Free after use
+ * @param[out] xnacm    NACM XML tree, set if retval=0. Owned by NACM, do not free
  * @param[out] cbret    Error if ret == 2
  * @retval     2        Failed on reading NACM from running (internal), cbret has error
  * @retval     1        OK permitted. You do not need to do next NACM step.
@@ -1319,9 +1730,9 @@ nacm_access_check(clixon_handle h,
  *     err;
  *   if (ret == 0){
  *      // Next step NACM processing
- *      xml_free(xnacm);
  *   }
  * @endcode
+ * @note xnacm is valid until the next call
  * @see RFC8341 3.4 Access Control Enforcement Procedures
  */
 int
@@ -1331,67 +1742,71 @@ nacm_access_pre(clixon_handle h,
                 cxobj       **xnacmp,
                 cbuf         *cbret)
 {
-    int    retval = -1;
-    char  *mode;
-    cxobj *x;
-    cxobj *xnacm0 = NULL;
-    cxobj *xnacm = NULL;
-    cvec  *nsc = NULL;
-    cxobj *xerr = NULL;
-    int    ret;
+    int      retval = -1;
+    char    *mode;
+    cxobj   *x;
+    cxobj   *xnacm0 = NULL;
+    cxobj   *xnacm;
+    cvec    *nsc = NULL;
+    cxobj   *xerr = NULL;
+    uint64_t gen;
+    int      ret;
 
     /* Check clixon option: disabled, external tree or internal */
-    mode = clicon_option_str(h, "CLICON_NACM_MODE");
+    mode = clicon_option_str_id(h, CO_NACM_MODE);
     if (mode == NULL)
         goto permit;
     else if (strcmp(mode, "disabled")==0)
         goto permit;
     else if (strcmp(mode, "external")==0){
-        if ((x = clicon_nacm_ext(h)))
+        /* If config does not exist then the operation is permitted(?) */
+        if ((x = clicon_nacm_ext(h)) == NULL)
+            goto permit;
+        if (_nacm_compiled == NULL || _nacm_compiled->nc_xext != x){
             if ((xnacm0 = xml_dup(x)) == NULL)
                 goto done;
+            ret = nacm_compiled_load(xnacm0, x, 0);
+            xnacm0 = NULL;
+            if (ret < 0)
+                goto done;
+        }
     }
     else if (strcmp(mode, "internal")==0){
-        if ((ret = xmldb_get0(h, "running", YB_MODULE, nsc, "nacm", 1, 0, &xnacm0, NULL, &xerr)) < 0)
-            goto done;
-        if (ret == 0){
-            if (clixon_xml2cbuf(cbret, xerr, 0, 0, NULL, -1, 0) < 0)
+        gen = nacm_running_gen(h);
+        if (_nacm_compiled == NULL || _nacm_compiled->nc_xext != NULL ||
+            gen == 0 || _nacm_compiled->nc_gen != gen){
+            if ((ret = xmldb_get0(h, "running", YB_MODULE, nsc, "nacm", 1, 0, &xnacm0, NULL, &xerr)) < 0)
+                goto done;
+            if (ret == 0){
+                if (clixon_xml2cbuf(cbret, xerr, 0, 0, NULL, -1, 0) < 0)
+                    goto done;
+                goto fail;
+            }
+            /* Reading running may set its cache */
+            ret = nacm_compiled_load(xnacm0, NULL, nacm_running_gen(h));
+            xnacm0 = NULL;
+            if (ret < 0)
                 goto done;
-            goto fail;
         }
     }
     else{
         clixon_err(OE_XML, 0, "Invalid NACM mode: %s", mode);
         goto done;
     }
-    if ((nsc = xml_nsctx_init(NULL, NACM_NS)) == NULL)
-        goto done;
-    /* If config does not exist then the operation is permitted(?) */
-    if (xnacm0 == NULL)
-        goto permit;
     /* If config does not exist then the operation is permitted(?) */
-    if ((xnacm = xpath_first(xnacm0, nsc, "nacm")) == NULL)
+    if ((xnacm = _nacm_compiled->nc_xnacm) == NULL)
         goto permit;
-    if (xml_rootchild_node(xnacm0, xnacm) < 0)
-        goto done;
-    xnacm0 = NULL;
     /* Initial NACM steps and common to all NACM access validation. */
     if ((retval = nacm_access_check(h, xnacm, peername, username)) < 0)
         goto done;
-    if (retval == 0){ /* if retval == 0 then return an xml nacm tree */
+    if (retval == 0) /* if retval == 0 then return an xml nacm tree */
         *xnacmp = xnacm;
-        xnacm = NULL;
-    }
  done:
     clixon_debug(CLIXON_DBG_NACM | CLIXON_DBG_DETAIL, "%s %s", mode?mode:"NULL",
                  retval==2?"fail":retval==1?"permit":retval==0?"ok":"error");
     if (nsc)
         xml_nsctx_free(nsc);
-    if (xnacm0)
-        xml_free(xnacm0);
-    else if (xnacm)
-        xml_free(xnacm);
-    else if (xerr)
+    if (xerr)
         xml_free(xerr);
     return retval;
  permit:
@@ -1558,7 +1973,7 @@ nacm_init(clixon_handle h)
     /* Check external mode, if so load NACM file
      * Note, loads yang -> extensions -> plugins
      */
-    nacm_mode = clicon_option_str(h, "CLICON_NACM_MODE");
+    nacm_mode = clicon_option_str_id(h, CO_NACM_MODE);
     if (nacm_mode && strcmp(nacm_mode, "external") == 0){
         if (nacm_load_external(h) < 0)
             goto done;
@@ -1583,6 +1998,10 @@ nacm_exit(clixon_handle h)
     cxobj *x;
     cvec  *cvv = NULL;
 
+    if (_nacm_compiled){
+        nacm_compiled_free(_nacm_compiled);
+        _nacm_compiled = NULL;
+    }
     if ((x = clicon_nacm_ext(h)) != NULL)
         xml_free(x);
     if (clicon_ptr_get(h, "nacm-proxyuser", (void**)&cvv) == 0 &&
@@ -166,6 +166,44 @@ netconf_input_read2(int            s,
     return retval;
 }
 
+/*! Get length of input data that can be appended to message as a whole
+ *
+ * That is chunk-data in chunked framing, or data before a possible end-of-message
+ * delimiter in EOM framing. In EOM framing, stops at NULL chars which are skipped one at
+ * a time. Chunk-data is length-delimited and may contain NULL chars, eg binary replies.
+ * @param[in]  buf          Input data
+ * @param[in]  len          Data len
+ * @param[in]  framing_type EOM or chunked framing
+ * @param[in]  frame_state  Framing state depending on type
+ * @param[in]  frame_size   Chunked framing size parameter
+ * @retval     n            Number of bytes, 0 if next byte needs framing state machine
+ */
+static size_t
+netconf_input_span(unsigned char       *buf,
+                   size_t               len,
+                   netconf_framing_type framing_type,
+                   int                  frame_state,
+                   size_t               frame_size)
+{
+    unsigned char *q;
+
+    if (framing_type == NETCONF_SSH_CHUNKED){
+        if (frame_state != 4 || frame_size == 0)
+            return 0;
+        if (len > frame_size)
+            len = frame_size;
+    }
+    else {
+        if (frame_state != 0)
+            return 0;
+        if ((q = memchr(buf, ']', len)) != NULL)
+            len = q - buf;
+        if ((q = memchr(buf, '\0', len)) != NULL)
+            len = q - buf;
+    }
+    return len;
+}
+
 /*! Get netconf message using NETCONF framing
  *
  * @param[in,out] bufp         Input data, incremented as read
@@ -182,6 +220,7 @@ netconf_input_read2(int            s,
  * - bufp/lenp
  * - cbmsg
  * - frame_state/frame_size
+ * Data is appended to cbmsg in whole spans, only framing chars are handled one at a time
  */
 int
 netconf_input_msg2(unsigned char      **bufp,
@@ -193,16 +232,28 @@ netconf_input_msg2(unsigned char      **bufp,
                    int                 *eom)
 {
     int       retval = -1;
-    int       i;
+    size_t    i;
     int       found = 0;
     size_t    len;
+    size_t    n;
     char      ch;
     int       ret;
 
     clixon_debug(CLIXON_DBG_DEFAULT | CLIXON_DBG_DETAIL, "");
     len = *lenp;
-    for (i=0; i<len; i++){
-        if ((ch = (*bufp)[i]) == 0)
+    i = 0;
+    while (i < len){
+        if ((n = netconf_input_span(*bufp + i, len - i, framing_type, *frame_state, *frame_size)) > 0){
+            if (cbuf_append_buf(cbmsg, *bufp + i, n) < 0){
+                clixon_err(OE_UNIX, errno, "cbuf_append_buf");
+                goto done;
+            }
+            if (framing_type == NETCONF_SSH_CHUNKED)
+                *frame_size -= n;
+            i += n;
+            continue;
+        }
+        if ((ch = (*bufp)[i++]) == 0)
             continue; /* Skip NULL chars (eg from terminals) */
         if (framing_type == NETCONF_SSH_CHUNKED){
             /* Track chunked framing defined in RFC6242 */
@@ -232,11 +283,9 @@ netconf_input_msg2(unsigned char      **bufp,
                 found++;
             }
         }
-        if (found){
-            i++;
+        if (found)
             break;
-        }
-    } /* for */
+    } /* while */
     *bufp += i;
     *lenp -= i;
     *eom = found;
@@ -1893,6 +1893,10 @@ netconf_module_load(clixon_handle h)
     /* draft-ietf-netconf-privcand.txt */
     if (yang_spec_parse_module(h, "ietf-netconf-private-candidate", NULL, yspec)< 0)
         goto done;
+    /* RFC 5717 Partial Lock */
+    if (clicon_option_bool(h, "CLICON_NETCONF_PARTIAL_LOCK") &&
+        yang_spec_parse_module(h, "ietf-netconf-partial-lock", NULL, yspec)< 0)
+        goto done;
     /* Framing: If hello protocol skipped, set framing direct, ie fix chunked framing if NETCONF-1.1
      * But start with default: RFC 4741 EOM ]]>]]>
      * For now this only applies to external protocol
@@ -2069,6 +2073,9 @@ netconf_capabilites(clixon_handle h,
     if (clicon_option_bool(h, "CLICON_XMLDB_PRIVATE_CANDIDATE")) {
         cprintf(cb, "<capability>%s%s</capability>", NETCONF_PRIVATE_CANDIDATE_CAPABILITY, "?supported-resolution-modes=revert-on-conflict");
     }
+    /* RFC 5717 Partial Lock */
+    if (clicon_option_bool(h, "CLICON_NETCONF_PARTIAL_LOCK"))
+        cprintf(cb, "<capability>%s</capability>", NETCONF_PARTIAL_LOCK_CAPABILITY);
     cprintf(cb, "</capabilities>");
     retval = 0;
  done:
@@ -138,6 +138,7 @@ static const map_str2int _FORMATS[] = {
     {"netconf",          FORMAT_NETCONF},
     {"default",          FORMAT_DEFAULT},
     {"pipe-xml-default", FORMAT_PIPE_XML_DEFAULT},
+    {"binary",           FORMAT_BINARY},
     {NULL,      -1}
 };
 
@@ -163,6 +164,80 @@ format_str2int(const char *str)
     return clicon_str2int(_FORMATS, str);
 }
 
+/*! Typed value of an option, see enum clicon_option_id
+ */
+struct option_value {
+    int   ov_valid;  /* Read from option hash since last change */
+    char *ov_str;    /* Value in option hash, or NULL */
+    int   ov_int;    /* As clicon_option_int */
+    int   ov_bool;   /* As clicon_option_bool */
+};
+
+/*! Names of typed options
+ *
+ * @see enum clicon_option_id  If you change here you must also change the enum
+ */
+static const char *optid2name[CO_NR] = {
+    "CLICON_AUTOLOCK",
+    "CLICON_BACKEND_SLICE",
+    "CLICON_NACM_DISABLED_ON_EMPTY",
+    "CLICON_NACM_MODE",
+    "CLICON_SOCK_PRIO",
+    "CLICON_VALIDATE_STATE_XML",
+    "CLICON_XMLDB_FORMAT",
+    "CLICON_XMLDB_MODIFY_BULK",
+    "CLICON_XMLDB_MULTI",
+    "CLICON_XMLDB_PRETTY",
+    "CLICON_XMLDB_PRIVATE_CANDIDATE",
+    "CLICON_XMLDB_SYSTEM_ONLY_CONFIG",
+    "CLICON_YANG_SCHEMA_MOUNT",
+    "CLICON_YANG_UNKNOWN_ANYDATA",
+    "CLICON_YANG_USE_ORIGINAL",
+};
+
+/*! Invalidate typed option values after an option is changed
+ *
+ * String values point into the option hash, and are not valid after a change
+ * @param[in] h     Clixon handle
+ */
+static void
+option_values_reset(clixon_handle h)
+{
+    struct option_value *ovv;
+
+    if ((ovv = clicon_option_values(h)) != NULL)
+        memset(ovv, 0, CO_NR*sizeof(*ovv));
+}
+
+/*! Get typed option value, read from option hash if not valid
+ *
+ * @param[in] h     Clixon handle
+ * @param[in] id    Option id
+ * @retval    ov    Typed option value
+ * @retval    NULL  Out of memory, use string API
+ */
+static struct option_value *
+option_value_get(clixon_handle         h,
+                 enum clicon_option_id id)
+{
+    struct option_value *ovv;
+    struct option_value *ov;
+
+    if ((ovv = clicon_option_values(h)) == NULL){
+        if ((ovv = calloc(CO_NR, sizeof(*ovv))) == NULL)
+            return NULL;
+        clicon_option_values_set(h, ovv);
+    }
+    ov = &ovv[id];
+    if (!ov->ov_valid){
+        ov->ov_str = clicon_option_str(h, optid2name[id]);
+        ov->ov_int = clicon_option_int(h, optid2name[id]);
+        ov->ov_bool = clicon_option_bool(h, optid2name[id]);
+        ov->ov_valid = 1;
+    }
+    return ov;
+}
+
 static int
 cmpstringp(const void *p1,
            const void *p2)
@@ -558,6 +633,7 @@ parse_configfile(clixon_handle  h,
                             strlen(body)+1) == NULL)
             goto done;
     }
+    option_values_reset(h);
     xml_sort_recurse(xt);
     retval = 0;
     *xconfig = xt;
@@ -638,6 +714,7 @@ clicon_option_add(clixon_handle h,
                             value,
                             strlen(value)+1) == NULL)
             goto done;
+        option_values_reset(h);
         /* Add/change in clicon_conf_xml */
         if ((xopt = xpath_first(xconfig, 0, "%s", name)) != NULL)
             xml_purge(xopt);
@@ -676,6 +753,7 @@ clicon_options_main(clixon_handle h)
     yang_stmt     *yspec = NULL;
     char          *extraconfdir = NULL;
     char          *yangspec = "clixon-config";
+    int            i;
 
     /* Create configure yang-spec */
     if ((yspec = yspec_new1(h, YANG_DOMAIN_TOP, YANG_CONFIG_TOP)) == NULL)
@@ -754,6 +832,12 @@ clicon_options_main(clixon_handle h)
     xml_sort(xconfig);
     if (clicon_conf_xml_set(h, xconfig) < 0)
         goto done;
+    /* Read typed option values once after load */
+    for (i=0; i<CO_NR; i++)
+        if (option_value_get(h, i) == NULL){
+            clixon_err(OE_UNIX, errno, "calloc");
+            goto done;
+        }
     retval = 0;
  done:
     if (extraconfdir)
@@ -894,6 +978,7 @@ clicon_option_str_set(clixon_handle h,
 {
     clicon_hash_t *copt = clicon_options(h);
 
+    option_values_reset(h);
     return clicon_hash_add(copt, name, val, strlen(val)+1)==NULL?-1:0;
 }
 
@@ -1009,9 +1094,71 @@ clicon_option_del(clixon_handle h,
 {
     clicon_hash_t *copt = clicon_options(h);
 
+    option_values_reset(h);
     return clicon_hash_del(copt, name);
 }
 
+/*! Get a typed option as string, without hash lookup
+ *
+ * Same as clicon_option_str but only for options in enum clicon_option_id
+ * @param[in] h       Clixon handle
+ * @param[in] id      Option id, eg CO_XMLDB_FORMAT
+ * @retval    string  Value of option if found
+ * @retval    NULL    If option not found
+ */
+char *
+clicon_option_str_id(clixon_handle         h,
+                     enum clicon_option_id id)
+{
+    struct option_value *ov;
+
+    if ((ov = option_value_get(h, id)) == NULL)
+        return clicon_option_str(h, optid2name[id]);
+    return ov->ov_str;
+}
+
+/*! Get a typed option as int, without hash lookup
+ *
+ * Same as clicon_option_int but only for options in enum clicon_option_id
+ * @param[in] h    Clixon handle
+ * @param[in] id   Option id
+ * @retval    int  An integer as a result of atoi
+ * @retval   -1    If option does not exist
+ */
+int
+clicon_option_int_id(clixon_handle         h,
+                     enum clicon_option_id id)
+{
+    struct option_value *ov;
+
+    if ((ov = option_value_get(h, id)) == NULL)
+        return clicon_option_int(h, optid2name[id]);
+    return ov->ov_int;
+}
+
+/*! Get a typed option as bool, without hash lookup
+ *
+ * Same as clicon_option_bool but only for options in enum clicon_option_id
+ * @param[in] h    Clixon handle
+ * @param[in] id   Option id, eg CO_YANG_SCHEMA_MOUNT
+ * @retval    1    true
+ * @retval    0    false, or does not exist
+ * @code
+ *  if (clicon_option_bool_id(h, CO_YANG_SCHEMA_MOUNT))
+ *      ...
+ * @endcode
+ */
+int
+clicon_option_bool_id(clixon_handle         h,
+                      enum clicon_option_id id)
+{
+    struct option_value *ov;
+
+    if ((ov = option_value_get(h, id)) == NULL)
+        return clicon_option_bool(h, optid2name[id]);
+    return ov->ov_bool;
+}
+
 /*-----------------------------------------------------------------
  * Specific option access functions for YANG configuration variables.
  * Sometimes overridden by command-line options, 
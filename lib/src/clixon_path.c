@@ -103,11 +103,59 @@
 #include "clixon_xml_map.h"
 #include "clixon_yang_module.h"
 #include "clixon_yang_schema_mount.h"
+#include "clixon_proto.h"
 #include "clixon_proto_client.h"
 #include "clixon_path.h"
 #include "clixon_api_path_parse.h"
 #include "clixon_instance_id_parse.h"
 
+/*! Resolved step of an api-path template
+ *
+ * Strings point into YANG or into the namespace context of the template
+ */
+struct api_path_step{
+    yang_stmt *as_y;       /* Yang data or schema node of step */
+    char      *as_ns;      /* Namespace if api-path step has module name, else NULL */
+    char      *as_xprefix; /* XPath prefix of step, see api_path2xpath_cvv */
+};
+typedef struct api_path_step api_path_step;
+
+#ifdef API_PATH_CACHE
+/*! Api-path template cache entry
+ *
+ * The shape of an api-path is the api-path with key values removed, eg
+ * /ietf-interfaces:interfaces/interface=/name
+ * Instance-identifiers are also cached, with node class YC_NONE and the instance-identifier
+ * as shape, see clixon_xml_find_instance_id
+ * Entries are in a LRU queue where the head is least recently used, and in a hash chain
+ * keyed by yang spec, node class and shape.
+ */
+struct api_path_template{
+    qelem_t                   at_q;     /* LRU queue, least recently used first */
+    struct api_path_template *at_hnext; /* Next in hash chain */
+    yang_stmt                *at_yspec; /* Top-level yang spec */
+    yang_class                at_class; /* Schema or data nodes */
+    char                     *at_shape; /* Api-path shape (key) */
+    uint32_t                  at_hash;  /* Hash of at_shape */
+    int                       at_len;   /* Number of steps */
+    api_path_step            *at_steps; /* Resolved steps */
+    cvec                     *at_nsc;   /* Namespace context of XPath */
+    clixon_path              *at_cplist; /* Parsed and resolved instance-identifier */
+};
+typedef struct api_path_template api_path_template;
+
+/*
+ * Variables
+ */
+static api_path_template  *_api_path_lru = NULL;  /* LRU queue */
+static api_path_template **_api_path_hash = NULL; /* Hash buckets */
+static int                 _api_path_nr = 0;      /* Number of entries */
+static int                 _api_path_hits = 0;
+static int                 _api_path_misses = 0;
+
+static int instance_id_resolve(clixon_path *cplist, yang_stmt *yt);
+#endif /* API_PATH_CACHE */
+
 /*! Given api-path, parse it, and return a clixon-path struct
  *
  * @param[in]  api_path  String with api-path syntax according to RESTCONF RFC8040
@@ -714,6 +762,517 @@ api_path_fmt2xpath(const char *api_path_fmt,
     return retval;
 }
 
+/*! Append XPath predicates of list keys or leaf-list value of an api-path step
+ *
+ * @param[in]  xpath    XPath as cbuf
+ * @param[in]  y        Yang node of api-path step
+ * @param[in]  xprefix  XPath prefix of keys, or NULL
+ * @param[in]  cv       Api-path step value, uri percent encoded, eg x%2Cy,z
+ * @retval     0        OK
+ * @retval    -1        Error
+ */
+static int
+api_path2xpath_keys(cbuf      *xpath,
+                    yang_stmt *y,
+                    char      *xprefix,
+                    cg_var    *cv)
+{
+    int     retval = -1;
+    char   *val = NULL;
+    char  **valvec = NULL;
+    int     nvalvec;
+    int     vi;
+    cvec   *cvk;
+    cg_var *cvi;
+    char   *decval = NULL;
+
+    /* val is uri percent encoded, eg x%2Cy,z */
+    if ((val = cv2str_dup(cv)) == NULL)
+        goto done;
+    switch (yang_keyword_get(y)){
+    case Y_LIST:
+        /* Transform value "a,b,c" to "a" "b" "c" (nvalvec=3)
+         * Note that vnr can be < length of cvk, due to empty or unset values
+         */
+        if ((valvec = clixon_strsep1(val, ",", &nvalvec)) == NULL)
+            goto done;
+        cvk = yang_cvec_get(y); /* Use Y_LIST cache, see ys_populate_list() */
+        cvi = NULL;
+        /* Iterate over individual yang keys  */
+        vi = 0;
+        while ((cvi = cvec_each(cvk, cvi)) != NULL && vi<nvalvec){
+            cprintf(xpath, "[");
+            if (xprefix)
+                cprintf(xpath, "%s:", xprefix);
+            /* valvec is uri encoded, needs decoding */
+            if (uri_percent_decode(valvec[vi++], &decval) < 0)
+                goto done;
+            cprintf(xpath, "%s='%s']", cv_string_get(cvi), decval);
+            if (decval){
+                free(decval);
+                decval = NULL;
+            }
+        }
+        break;
+    case Y_LEAF_LIST: /* XXX: LOOP? */
+        if (uri_percent_decode(val, &decval) < 0)
+            goto done;
+        cprintf(xpath, "[.='%s']", decval);
+        break;
+    default:
+        break;
+    }
+    retval = 0;
+ done:
+    if (decval)
+        free(decval);
+    if (valvec)
+        free(valvec);
+    if (val)
+        free(val);
+    return retval;
+}
+
+#ifdef API_PATH_CACHE
+/*! Hash function of api-path shape (FNV-1a)
+ */
+static uint32_t
+api_path_cache_hashfn(const char *str)
+{
+    uint32_t h = 2166136261U;
+
+    while (*str){
+        h ^= (uint8_t)*str++;
+        h *= 16777619U;
+    }
+    return h;
+}
+
+/*! Free an api-path template
+ *
+ * @param[in]  at  Api-path template, not in cache
+ * @see api_path_template_rm
+ */
+static void
+api_path_template_free(api_path_template *at)
+{
+    if (at->at_cplist)
+        clixon_path_free(at->at_cplist);
+    if (at->at_nsc)
+        cvec_free(at->at_nsc);
+    if (at->at_steps)
+        free(at->at_steps);
+    if (at->at_shape)
+        free(at->at_shape);
+    free(at);
+}
+
+/*! Remove and free a cache entry
+ *
+ * @param[in]  at  Api-path template in cache
+ */
+static void
+api_path_template_rm(api_path_template *at)
+{
+    api_path_template **atp;
+
+    atp = &_api_path_hash[at->at_hash % API_PATH_CACHE];
+    while (*atp != at)
+        atp = &(*atp)->at_hnext;
+    *atp = at->at_hnext;
+    DELQ(at, _api_path_lru, api_path_template *);
+    _api_path_nr--;
+    api_path_template_free(at);
+}
+
+/*! Resolve api-path shape of a template to YANG nodes and XPath prefixes
+ *
+ * Follows api_path2xpath_cvv and api_path2xml_vec for api-paths without mount-points.
+ * Errors in the api-path are not reported here, the api-path is instead translated
+ * without template, which reports the error.
+ * @param[in]  yspec     Yang spec
+ * @param[in]  nodeclass Schema or data nodes
+ * @param[in]  at        Api-path template with shape set
+ * @retval     1         OK, steps resolved
+ * @retval     0         Invalid api-path or api-path with mount-point
+ * @retval    -1         Error
+ */
+static int
+api_path_template_resolve(yang_stmt         *yspec,
+                          yang_class         nodeclass,
+                          api_path_template *at)
+{
+    int            retval = -1;
+    char         **vec = NULL;
+    int            nvec;
+    int            i;
+    size_t         len;
+    char          *nodeid;
+    char          *prefix = NULL;
+    char          *name = NULL;
+    char          *namespace = NULL;
+    char          *xprefix;
+    yang_stmt     *y0;
+    yang_stmt     *y;
+    yang_stmt     *ymod;
+    api_path_step *as;
+    int            ret;
+
+    if ((vec = clixon_strsep1(at->at_shape, "/", &nvec)) == NULL)
+        goto done;
+    if ((at->at_steps = calloc(nvec, sizeof(*at->at_steps))) == NULL){
+        clixon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    if ((at->at_nsc = xml_nsctx_init(NULL, NULL)) == NULL)
+        goto done;
+    y0 = yspec;
+    /* vec[0] is empty string before first '/' */
+    for (i=1; i<nvec; i++){
+        nodeid = vec[i];
+        if ((len = strlen(nodeid)) > 0 && nodeid[len-1] == '=')
+            nodeid[len-1] = '\0';
+        if (nodeid_split(nodeid, &prefix, &name) < 0)
+            goto done;
+        as = &at->at_steps[at->at_len];
+        if (prefix){
+            if ((ymod = yang_find_module_by_name(yspec, prefix)) == NULL)
+                goto fail;
+            namespace = yang_find_mynamespace(ymod);
+            as->as_ns = namespace;
+            if (yang_keyword_get(y0) == Y_SPEC)
+                y0 = ymod;
+        }
+        else if (yang_keyword_get(y0) == Y_SPEC)
+            goto fail;
+        y = (nodeclass==YC_SCHEMANODE)?
+            yang_find_schemanode(y0, name):
+            yang_find_datanode(y0, name);
+        if (y == NULL)
+            goto fail;
+        /* Yang below mount-points depends on data */
+        if ((ret = yang_schema_mount_point(y)) < 0)
+            goto done;
+        if (ret == 1)
+            goto fail;
+        if (xml_nsctx_get_prefix(at->at_nsc, namespace, &xprefix) == 0){
+            xprefix = yang_find_myprefix(y);
+            if (xml_nsctx_add(at->at_nsc, xprefix, namespace) < 0)
+                goto done;
+            /* Point to copy in namespace context */
+            if (xml_nsctx_get_prefix(at->at_nsc, namespace, &xprefix) == 0)
+                xprefix = NULL;
+        }
+        as->as_y = y;
+        as->as_xprefix = xprefix;
+        at->at_len++;
+        y0 = y;
+        free(prefix);
+        prefix = NULL;
+        free(name);
+        name = NULL;
+    }
+    retval = 1;
+ done:
+    if (prefix)
+        free(prefix);
+    if (name)
+        free(name);
+    if (vec)
+        free(vec);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! Parse and resolve instance-identifier of a template
+ *
+ * Errors are not reported here, see api_path_template_resolve
+ * @param[in]  yspec     Yang spec
+ * @param[in]  at        Api-path template with instance-identifier as shape
+ * @retval     1         OK
+ * @retval     0         Invalid instance-identifier or instance-identifier with mount-point
+ * @retval    -1         Error
+ */
+static int
+instance_id_template_resolve(yang_stmt         *yspec,
+                             api_path_template *at)
+{
+    int          retval = -1;
+    clixon_path *cp;
+    int          ret;
+
+    if (instance_id_parse(at->at_shape, &at->at_cplist) < 0)
+        goto done;
+    if ((ret = instance_id_resolve(at->at_cplist, yspec)) < 0)
+        goto done;
+    if (ret == 0)
+        goto fail;
+    /* Yang below mount-points depends on data */
+    if ((cp = at->at_cplist) != NULL){
+        do {
+            if (ys_spec(cp->cp_yang) != yspec)
+                goto fail;
+            cp = NEXTQ(clixon_path *, cp);
+        } while (cp != at->at_cplist);
+    }
+    retval = 1;
+ done:
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! Get api-path template of shape from cache, resolve and add to cache if not found
+ *
+ * @param[in]  yspec     Yang spec
+ * @param[in]  nodeclass Schema or data nodes, or YC_NONE for instance-identifier
+ * @param[in]  shape     Api-path shape, or instance-identifier
+ * @param[out] atp       Api-path template, or NULL if api-path can not be templated
+ * @retval     0         OK
+ * @retval    -1         Error
+ */
+static int
+api_path_template_get(yang_stmt          *yspec,
+                      yang_class          nodeclass,
+                      const char         *shape,
+                      api_path_template **atp)
+{
+    int                retval = -1;
+    api_path_template *at = NULL;
+    uint32_t           h;
+    int                ret;
+
+    *atp = NULL;
+    if (yspec == NULL || yang_keyword_get(yspec) != Y_SPEC)
+        goto ok;
+    if (_api_path_hash == NULL){
+        if ((_api_path_hash = calloc(API_PATH_CACHE, sizeof(*_api_path_hash))) == NULL){
+            clixon_err(OE_UNIX, errno, "calloc");
+            goto done;
+        }
+    }
+    h = api_path_cache_hashfn(shape);
+    for (at = _api_path_hash[h % API_PATH_CACHE]; at; at = at->at_hnext)
+        if (at->at_hash == h && at->at_yspec == yspec && at->at_class == nodeclass &&
+            strcmp(at->at_shape, shape) == 0)
+            break;
+    if (at != NULL){
+        _api_path_hits++;
+        /* Move to most recently used */
+        DELQ(at, _api_path_lru, api_path_template *);
+        ADDQ(at, _api_path_lru);
+        *atp = at;
+        goto ok;
+    }
+    _api_path_misses++;
+    if ((at = calloc(1, sizeof(*at))) == NULL){
+        clixon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    at->at_yspec = yspec;
+    at->at_class = nodeclass;
+    if ((at->at_shape = strdup(shape)) == NULL){
+        clixon_err(OE_UNIX, errno, "strdup");
+        goto done;
+    }
+    if (nodeclass == YC_NONE)
+        ret = instance_id_template_resolve(yspec, at);
+    else
+        ret = api_path_template_resolve(yspec, nodeclass, at);
+    if (ret < 0)
+        goto done;
+    if (ret == 0)
+        goto ok;
+    /* Evict least recently used */
+    while (_api_path_nr >= API_PATH_CACHE)
+        api_path_template_rm(_api_path_lru);
+    at->at_hash = h;
+    at->at_hnext = _api_path_hash[h % API_PATH_CACHE];
+    _api_path_hash[h % API_PATH_CACHE] = at;
+    ADDQ(at, _api_path_lru);
+    _api_path_nr++;
+    *atp = at;
+    at = NULL;
+ ok:
+    retval = 0;
+ done:
+    if (at && *atp != at)
+        api_path_template_free(at);
+    return retval;
+}
+
+/*! Translate api-path to XPath using api-path template
+ *
+ * @param[in]  api_path  URI-encoded path expression as cvec, see api_path2xpath_cvv
+ * @param[in]  yspec     Yang spec
+ * @param[out] xpath     The xpath as cbuf
+ * @param[out] nscp      Namespace context of xpath
+ * @retval     1         OK
+ * @retval     0         No template, use api_path2xpath_cvv
+ * @retval    -1         Error
+ */
+static int
+api_path2xpath_template(cvec      *api_path,
+                        yang_stmt *yspec,
+                        cbuf      *xpath,
+                        cvec     **nscp)
+{
+    int                retval = -1;
+    api_path_template *at;
+    api_path_step     *as;
+    cbuf              *cbs = NULL;
+    cg_var            *cv;
+    int                i;
+
+    if ((cbs = cbuf_new()) == NULL){
+        clixon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    cv = NULL;
+    while ((cv = cvec_each(api_path, cv)) != NULL)
+        cprintf(cbs, "/%s%s", cv_name_get(cv), cv_type_get(cv) == CGV_STRING?"=":"");
+    if (api_path_template_get(yspec, YC_DATANODE, cbuf_get(cbs), &at) < 0)
+        goto done;
+    if (at == NULL || at->at_len != cvec_len(api_path)){
+        retval = 0;
+        goto done;
+    }
+    cprintf(xpath, "/");
+    for (i=0; i<at->at_len; i++){
+        as = &at->at_steps[i];
+        cv = cvec_i(api_path, i);
+        if (i > 0)
+            cprintf(xpath, "/");
+        if (as->as_xprefix)
+            cprintf(xpath, "%s:", as->as_xprefix);
+        cprintf(xpath, "%s", yang_argument_get(as->as_y));
+        if (cv_type_get(cv) == CGV_STRING &&
+            api_path2xpath_keys(xpath, as->as_y, as->as_xprefix, cv) < 0)
+            goto done;
+    }
+    if (nscp && (*nscp = cvec_dup(at->at_nsc)) == NULL){
+        clixon_err(OE_UNIX, errno, "cvec_dup");
+        goto done;
+    }
+    retval = 1;
+ done:
+    if (cbs)
+        cbuf_free(cbs);
+    return retval;
+}
+
+/*! Get resolved api-path template steps of api-path vector
+ *
+ * @param[in]  vec       Api-path as NULL-terminated vector, see api_path2xml_vec
+ * @param[in]  yspec     Yang spec
+ * @param[in]  nodeclass Schema or data nodes
+ * @param[out] steps     Resolved steps, or NULL if api-path can not be templated
+ * @retval     0         OK
+ * @retval    -1         Error
+ */
+static int
+api_path2xml_template(char          **vec,
+                      yang_stmt      *yspec,
+                      yang_class      nodeclass,
+                      api_path_step **steps)
+{
+    int                retval = -1;
+    api_path_template *at;
+    cbuf              *cbs = NULL;
+    char              *restval;
+    int                i;
+
+    *steps = NULL;
+    if ((cbs = cbuf_new()) == NULL){
+        clixon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    /* api_path2xml_vec stops at empty element */
+    for (i=0; vec[i] != NULL && strlen(vec[i]); i++){
+        if ((restval = index(vec[i], '=')) != NULL)
+            cprintf(cbs, "/%.*s=", (int)(restval - vec[i]), vec[i]);
+        else
+            cprintf(cbs, "/%s", vec[i]);
+    }
+    if (api_path_template_get(yspec, nodeclass, cbuf_get(cbs), &at) < 0)
+        goto done;
+    if (at != NULL && at->at_len == i)
+        *steps = at->at_steps;
+    retval = 0;
+ done:
+    if (cbs)
+        cbuf_free(cbs);
+    return retval;
+}
+#endif /* API_PATH_CACHE */
+
+/*! Free api-path templates of a yang spec
+ *
+ * Called when modules are added to or removed from the yang spec, and when it is freed
+ * @param[in]  yspec  Yang spec, or NULL for all
+ * @retval     0      OK
+ */
+int
+api_path_cache_flush(yang_stmt *yspec)
+{
+#ifdef API_PATH_CACHE
+    api_path_template *at;
+    api_path_template *an;
+    int                i;
+
+    at = _api_path_lru;
+    for (i = _api_path_nr; i > 0; i--){
+        an = NEXTQ(api_path_template *, at);
+        if (yspec == NULL || at->at_yspec == yspec)
+            api_path_template_rm(at);
+        at = an;
+    }
+#endif
+    return 0;
+}
+
+/*! Get statistics of api-path template cache and reset hit counters
+ *
+ * @param[out] nr      Number of cached api-path templates
+ * @param[out] hits    Number of cache hits since last call
+ * @param[out] misses  Number of cache misses (ie resolved api-path shapes) since last call
+ * @retval     0       OK
+ */
+int
+api_path_cache_stats(int *nr,
+                     int *hits,
+                     int *misses)
+{
+#ifdef API_PATH_CACHE
+    if (nr)
+        *nr = _api_path_nr;
+    if (hits)
+        *hits = _api_path_hits;
+    if (misses)
+        *misses = _api_path_misses;
+    _api_path_hits = 0;
+    _api_path_misses = 0;
+#endif
+    return 0;
+}
+
+/*! Free all api-path templates in the cache
+ */
+void
+api_path_cache_exit(void)
+{
+#ifdef API_PATH_CACHE
+    api_path_cache_flush(NULL);
+    if (_api_path_hash){
+        free(_api_path_hash);
+        _api_path_hash = NULL;
+    }
+#endif
+}
+
 /*! Translate from restconf api-path(cvv) to xml xpath(cbuf) and namespace context
  *
  * Iterative function
@@ -764,24 +1323,24 @@ api_path2xpath_cvv(cvec      *api_path,
     char      *prefix = NULL;  /* api-path (module) prefix */
     char      *xprefix = NULL; /* xml xpath prefix */
     char      *name = NULL;
-    cvec      *cvk = NULL; /* vector of index keys */
     yang_stmt *y = NULL;
     yang_stmt *y1;
     yang_stmt *ymod = NULL;
-    char      *val;
-    cg_var    *cvi;
-    char     **valvec = NULL;
-    int        vi;
-    int        nvalvec;
     cbuf      *cberr = NULL;
     char      *namespace = NULL;
     cvec      *nsc = NULL;
-    char      *val1;
-    char      *decval;
     int        root;
     int        ymtpoint; /* y is potential mount-point */
     int        ret;
 
+#ifdef API_PATH_CACHE
+    if ((ret = api_path2xpath_template(api_path, yspec, xpath, nscp)) < 0)
+        goto done;
+    if (ret == 1){
+        retval = 1;
+        goto done;
+    }
+#endif
     cprintf(xpath, "/");
     /* Initialize namespace context */
     if ((nsc = xml_nsctx_init(NULL, NULL)) == NULL)
@@ -874,59 +1433,9 @@ api_path2xpath_cvv(cvec      *api_path,
                 goto done;
         }
         /* Check if has value, means '=' */
-        if (cv_type_get(cv) == CGV_STRING){
-            /* val is uri percent encoded, eg x%2Cy,z */
-            if ((val = cv2str_dup(cv)) == NULL)
-                goto done;
-            switch (yang_keyword_get(y)){
-            case Y_LIST:
-                /* Transform value "a,b,c" to "a" "b" "c" (nvalvec=3)
-                 * Note that vnr can be < length of cvk, due to empty or unset values
-                 */
-                if (valvec){ /* loop, valvec may have been used before */
-                    free(valvec);
-                    valvec = NULL;
-                }
-                if ((valvec = clixon_strsep1(val, ",", &nvalvec)) == NULL)
-                    goto done;
-                cvk = yang_cvec_get(y); /* Use Y_LIST cache, see ys_populate_list() */
-                cvi = NULL;
-                /* Iterate over individual yang keys  */
-                vi = 0;
-                while ((cvi = cvec_each(cvk, cvi)) != NULL && vi<nvalvec){
-                    cprintf(xpath, "[");
-                    if (xprefix)
-                        cprintf(xpath, "%s:", xprefix);
-                    val1 = valvec[vi++];
-                    /* valvec is uri encoded, needs decoding */
-                    if (uri_percent_decode(val1, &decval) < 0)
-                        goto done;
-                    cprintf(xpath, "%s='%s']", cv_string_get(cvi), decval);
-                    if (decval){
-                        free(decval);
-                        decval = NULL;
-                    }
-                }
-                break;
-            case Y_LEAF_LIST: /* XXX: LOOP? */
-                if (val){
-                    if (uri_percent_decode(val, &decval) < 0)
-                        goto done;
-                    cprintf(xpath, "[.='%s']", decval);
-                    if (decval){
-                        free(decval);
-                        decval = NULL;
-                    }
-                }
-                else
-                    cprintf(xpath, "[.='']");
-                break;
-            default:
-                break;
-            }
-            if (val)
-                free(val);
-        }
+        if (cv_type_get(cv) == CGV_STRING &&
+            api_path2xpath_keys(xpath, y, xprefix, cv) < 0)
+            goto done;
         if (prefix){
             free(prefix);
             prefix = NULL;
@@ -945,8 +1454,6 @@ api_path2xpath_cvv(cvec      *api_path,
     clixon_debug(CLIXON_DBG_XPATH | CLIXON_DBG_DETAIL, "retval:%d", retval);
     if (cberr)
         cbuf_free(cberr);
-    if (valvec)
-        free(valvec);
     if (prefix)
         free(prefix);
     if (nsc)
@@ -1044,6 +1551,7 @@ api_path2xpath(const char *api_path,
  * @param[in]   strict    Break if api-path is not "complete" otherwise ignore and continue
  * @param[in]   mnt_cb    Callback to mount new yang if mount-point is empty
  * @param[in]   arg       Argument to callback
+ * @param[in]   steps     Resolved api-path template steps of vec, or NULL
  * @param[out]  xbotp     Resulting xml tree
  * @param[out]  ybotp     Yang spec matching xpathp
  * @param[out]  xerr      Netconf error message (if retval=0)
@@ -1064,6 +1572,7 @@ api_path2xml_vec(char            **vec,
                  int               strict,
                  api_path_mnt_cb_t mnt_cb,
                  void             *arg,
+                 api_path_step    *steps,
                  cxobj           **xbotp,
                  yang_stmt       **ybotp,
                  cxobj           **xerr)
@@ -1110,62 +1619,73 @@ api_path2xml_vec(char            **vec,
         *restval = '\0';
         restval++;
     }
-    /* Split into prefix and localname */
-    if (nodeid_split(nodeid, &prefix, &name) < 0)
-        goto done;
-    if ((ymtpoint = yang_schema_mount_point(y0)) < 0)
-        goto done;
-    if (yang_keyword_get(y0) == Y_SPEC || ymtpoint){
-        if (prefix == NULL){
-            cprintf(cberr, "api-path element '%s', expected prefix:name", nodeid);
-            if (xerr &&
-                netconf_invalid_value_xml(xerr, "application", cbuf_get(cberr)) < 0)
-                goto done;
-            goto fail;
+    if (steps != NULL){
+        /* Resolved by api-path template */
+        y = steps->as_y;
+        namespace = steps->as_ns;
+        if ((name = strdup(yang_argument_get(y))) == NULL){
+            clixon_err(OE_UNIX, errno, "strdup");
+            goto done;
         }
-        if (ymtpoint){
-            if ((ret = yang_mount_get_yspec_any(y0, &y0)) < 0)
-                goto done;
-            if (ret == 0 && mnt_cb != NULL){
-                if ((ret = mnt_cb(arg, x0, &y0, xerr)) < 0)
+    }
+    else {
+        /* Split into prefix and localname */
+        if (nodeid_split(nodeid, &prefix, &name) < 0)
+            goto done;
+        if ((ymtpoint = yang_schema_mount_point(y0)) < 0)
+            goto done;
+        if (yang_keyword_get(y0) == Y_SPEC || ymtpoint){
+            if (prefix == NULL){
+                cprintf(cberr, "api-path element '%s', expected prefix:name", nodeid);
+                if (xerr &&
+                    netconf_invalid_value_xml(xerr, "application", cbuf_get(cberr)) < 0)
                     goto done;
-                if (ret == 0)
-                    goto fail;
+                goto fail;
             }
+            if (ymtpoint){
+                if ((ret = yang_mount_get_yspec_any(y0, &y0)) < 0)
+                    goto done;
+                if (ret == 0 && mnt_cb != NULL){
+                    if ((ret = mnt_cb(arg, x0, &y0, xerr)) < 0)
+                        goto done;
+                    if (ret == 0)
+                        goto fail;
+                }
+            }
+            if ((ymod = yang_find_module_by_name(y0, prefix)) == NULL){
+                cprintf(cberr, "No such yang module prefix");
+                if (xerr &&
+                    netconf_unknown_element_xml(xerr, "application", prefix, cbuf_get(cberr)) < 0)
+                    goto done;
+                goto fail;
+            }
+            namespace = yang_find_mynamespace(ymod);
+            y0 = ymod;
         }
-        if ((ymod = yang_find_module_by_name(y0, prefix)) == NULL){
-            cprintf(cberr, "No such yang module prefix");
-            if (xerr &&
-                netconf_unknown_element_xml(xerr, "application", prefix, cbuf_get(cberr)) < 0)
+        y = (nodeclass==YC_SCHEMANODE)?
+            yang_find_schemanode(y0, name):
+            yang_find_datanode(y0, name); // <--
+        if (y == NULL){
+            char *nameenc = NULL;
+            if (xml_chardata_encode(&nameenc, 0, "%s", name) < 0)
                 goto done;
-            goto fail;
-        }
-        namespace = yang_find_mynamespace(ymod);
-        y0 = ymod;
-    }
-    y = (nodeclass==YC_SCHEMANODE)?
-        yang_find_schemanode(y0, name):
-        yang_find_datanode(y0, name); // <--
-    if (y == NULL){
-        char *nameenc = NULL;
-        if (xml_chardata_encode(&nameenc, 0, "%s", name) < 0)
-            goto done;
-        if (xerr &&
-            netconf_unknown_element_xml(xerr, "application", nameenc, "Unknown element") < 0)
-            goto done;
-        if (nameenc)
-            free(nameenc);
-        goto fail;
-    }
-    if (prefix && namespace == NULL){
-        if ((ymod = yang_find_module_by_name(ys_spec(y0), prefix)) == NULL){
-            cprintf(cberr, "api-path element prefix: '%s', no such yang module", prefix);
             if (xerr &&
-                netconf_invalid_value_xml(xerr, "application", cbuf_get(cberr)) < 0)
+                netconf_unknown_element_xml(xerr, "application", nameenc, "Unknown element") < 0)
                 goto done;
+            if (nameenc)
+                free(nameenc);
             goto fail;
         }
-        namespace = yang_find_mynamespace(ymod);
+        if (prefix && namespace == NULL){
+            if ((ymod = yang_find_module_by_name(ys_spec(y0), prefix)) == NULL){
+                cprintf(cberr, "api-path element prefix: '%s', no such yang module", prefix);
+                if (xerr &&
+                    netconf_invalid_value_xml(xerr, "application", cbuf_get(cberr)) < 0)
+                    goto done;
+                goto fail;
+            }
+            namespace = yang_find_mynamespace(ymod);
+        }
     }
     switch (yang_keyword_get(y)){
     case Y_LEAF_LIST:
@@ -1279,7 +1799,8 @@ api_path2xml_vec(char            **vec,
             goto done;
     }
     /* If x/y is mountpoint, pass mount yspec to children */
-    if ((ymtpoint = yang_schema_mount_point(y)) < 0)
+    ymtpoint = 0;
+    if (steps == NULL && (ymtpoint = yang_schema_mount_point(y)) < 0)
         goto done;
     if (ymtpoint){
         y1 = NULL;
@@ -1301,6 +1822,7 @@ api_path2xml_vec(char            **vec,
                                    x, y,
                                    nodeclass, strict,
                                    mnt_cb, arg,
+                                   steps?steps+1:NULL,
                                    xbotp, ybotp, xerr)) < 1)
         goto done;
  ok:
@@ -1409,11 +1931,12 @@ api_path2xml_mnt(const char       *api_path,
                  yang_stmt       **ybotp,
                  cxobj           **xerr)
 {
-    int    retval = -1;
-    char **vec = NULL;
-    int    nvec;
-    cxobj *xroot;
-    cbuf  *cberr = NULL;
+    int            retval = -1;
+    char         **vec = NULL;
+    int            nvec;
+    cxobj         *xroot;
+    cbuf          *cberr = NULL;
+    api_path_step *steps = NULL;
 
     clixon_debug(CLIXON_DBG_XML | CLIXON_DBG_DETAIL, "api_path:%s", api_path);
     if ((cberr = cbuf_new()) == NULL){
@@ -1438,9 +1961,14 @@ api_path2xml_mnt(const char       *api_path,
         goto fail;
     }
     nvec--; /* NULL-terminated */
+#ifdef API_PATH_CACHE
+    if (api_path2xml_template(vec+1, yspec, nodeclass, &steps) < 0)
+        goto done;
+#endif
     if ((retval = api_path2xml_vec(vec+1, nvec,
                                    xtop, yspec, nodeclass, strict,
                                    mnt_cb, arg,
+                                   steps,
                                    xbotp, ybotp, xerr)) < 1)
         goto done;
     /* Fix namespace */
@@ -2042,7 +2570,11 @@ clixon_xml_find_instance_id(cxobj      *xt,
     size_t       len;
     char        *path = NULL;
     clixon_path *cplist = NULL;
+    clixon_path *cplist0 = NULL; /* Cached, not freed */
     clixon_xvec *xv = NULL;
+#ifdef API_PATH_CACHE
+    api_path_template *at;
+#endif
     int          ret;
 
     va_start(ap, format);
@@ -2061,18 +2593,27 @@ clixon_xml_find_instance_id(cxobj      *xt,
         goto done;
     }
     va_end(ap);
-    if (instance_id_parse(path, &cplist) < 0)
+#ifdef API_PATH_CACHE
+    if (api_path_template_get(yt, YC_NONE, path, &at) < 0)
         goto done;
+    if (at != NULL)
+        cplist0 = at->at_cplist;
+#endif
+    if (cplist0 == NULL){
+        if (instance_id_parse(path, &cplist) < 0)
+            goto done;
 #if 0
-    if (clixon_debug_get())
-        clixon_path_print(stderr, cplist);
+        if (clixon_debug_get())
+            clixon_path_print(stderr, cplist);
 #endif
-    /* Resolve module:name to pointer to yang-stmt, fail if not successful */
-    if ((ret = instance_id_resolve(cplist, yt)) < 0)
-        goto done;
-    if (ret == 0)
-        goto fail;
-    if ((ret = clixon_path_search(xt, yt, cplist, &xv)) < 0)
+        /* Resolve module:name to pointer to yang-stmt, fail if not successful */
+        if ((ret = instance_id_resolve(cplist, yt)) < 0)
+            goto done;
+        if (ret == 0)
+            goto fail;
+        cplist0 = cplist;
+    }
+    if ((ret = clixon_path_search(xt, yt, cplist0, &xv)) < 0)
         goto done;
     if (ret == 0)
         goto fail;
@@ -2093,6 +2634,46 @@ clixon_xml_find_instance_id(cxobj      *xt,
     goto done;
 }
 
+/*! Given parsed (instance-id) path and XML tree, return matching xml node vector
+ *
+ * Same as clixon_xml_find_instance_id but with a path parsed and resolved once with
+ * clixon_instance_id_parse, for paths that are searched many times
+ * @param[in]  xt       Top xml-tree where to search
+ * @param[in]  yt       Yang statement of top symbol (can be yang-spec if top-level)
+ * @param[in]  cplist   Path parsed with clixon_instance_id_parse
+ * @param[out] xvec     Vector of xml-trees, or NULL if none. Free with clixon_xvec_free
+ * @retval     1        OK with found xml nodes in xvec (if any)
+ * @retval     0        Non-fatal failure, yang bind failures, etc,
+ * @retval    -1        Error
+ * @see clixon_xml_find_instance_id
+ */
+int
+clixon_xml_find_instance_path(cxobj        *xt,
+                              yang_stmt    *yt,
+                              clixon_path  *cplist,
+                              clixon_xvec **xvec)
+{
+    int          retval = -1;
+    clixon_xvec *xv = NULL;
+    int          ret;
+
+    *xvec = NULL;
+    if ((ret = clixon_path_search(xt, yt, cplist, &xv)) < 0)
+        goto done;
+    if (ret == 0)
+        goto fail;
+    *xvec = xv;
+    xv = NULL;
+    retval = 1;
+ done:
+    if (xv)
+        clixon_xvec_free(xv);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
 /*! Given (instance-id) path and YANG, parse path, resolve YANG and return namespace binding
  *
  * Instance-identifier is a subset of XML XPaths and defined in Yang, used in NACM for
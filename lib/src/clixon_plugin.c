@@ -40,6 +40,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <stddef.h>
 #include <stdint.h>
 #include <string.h>
 #include <errno.h>
@@ -78,6 +79,7 @@
 #include "clixon_validate.h"
 #include "clixon_proc.h"
 #include "clixon_data.h"
+#include "clixon_mem.h"
 #include "clixon_plugin.h"
 
 /*
@@ -92,9 +94,17 @@ struct clixon_plugin{
     qelem_t           cp_q;                /* queue header */
     char              cp_name[MAXPATHLEN]; /* Plugin filename. Note api ca_name is given by plugin itself */
     plghndl_t         cp_handle;  /* Handle to plugin using dlopen(3) */
+    int               cp_nr;      /* Position in plugin list, from 0 */
     clixon_plugin_api cp_api;
 };
 
+/* Plugins implementing a callback, see clixon_plugin_index() */
+typedef struct {
+    size_t            pi_cb;      /* Offset of callback in clixon_plugin_api */
+    clixon_plugin_t **pi_vec;     /* Plugins with the callback set, in plugin order */
+    int               pi_len;     /* Length of pi_vec */
+} plugin_index_t;
+
 /*
  * Upgrade callbacks for backend upgrade of datastore
  * Register upgrade callbacks in plugin_init() with a module and a "from" and "to"
@@ -114,7 +124,10 @@ typedef struct {
  */
 struct plugin_module_struct {
     clixon_plugin_t    *ms_plugin_list;
-    rpc_callback_t     *ms_rpc_callbacks;
+    int                 ms_plugin_nr;    /* Number of plugins in list */
+    plugin_index_t     *ms_index;        /* Callback index, built on demand */
+    int                 ms_index_len;    /* Length of ms_index */
+    clicon_hash_t      *ms_rpc_callbacks; /* RPC name -> list of rpc_callback_t */
     upgrade_callback_t *ms_upgrade_callbacks;
 };
 typedef struct plugin_module_struct plugin_module_struct;
@@ -273,6 +286,117 @@ clixon_plugin_each_revert(clixon_handle    h,
     return cpnext;
 }
 
+/*! Get position of plugin in plugin list
+ *
+ * @param[in]  cp   Clixon plugin handle
+ * @retval     nr   Position, first plugin is 0
+ */
+int
+clixon_plugin_nr_get(clixon_plugin_t *cp)
+{
+    return cp->cp_nr;
+}
+
+/*! Get the plugins implementing a callback
+ *
+ * Use this instead of clixon_plugin_each() to dispatch a callback to the plugins
+ * implementing it only. The vector of each callback is built on first use after the
+ * plugins are loaded, and is valid until a plugin is added or removed.
+ * @param[in]  h     Clixon handle
+ * @param[in]  cb    Callback, use CLIXON_PLUGIN_CB(), eg CLIXON_PLUGIN_CB(ca_extension)
+ * @param[out] vecp  Vector of plugins with the callback set, in plugin order. Do not free
+ * @param[out] lenp  Length of vector
+ * @retval     0     OK
+ * @retval    -1     Error
+ * @code
+ *   clixon_plugin_t **cpv;
+ *   int               cpn;
+ *   if (clixon_plugin_index(h, CLIXON_PLUGIN_CB(ca_extension), &cpv, &cpn) < 0)
+ *      err;
+ *   for (i=0; i<cpn; i++)
+ *      ... cpv[i]
+ * @endcode
+ * @note A callback set with clixon_plugin_api_get() after the first dispatch requires
+ *       a call to clixon_plugin_index_reset()
+ * @note Do not add plugins while iterating over the vector
+ */
+int
+clixon_plugin_index(clixon_handle      h,
+                    size_t             cb,
+                    clixon_plugin_t ***vecp,
+                    int               *lenp)
+{
+    int                   retval = -1;
+    plugin_module_struct *ms = plugin_module_struct_get(h);
+    plugin_index_t       *pi;
+    clixon_plugin_t      *cp;
+    int                   i;
+
+    *vecp = NULL;
+    *lenp = 0;
+    /* ms == NULL means plugins are not yet initialized */
+    if (ms == NULL)
+        goto ok;
+    for (i=0; i<ms->ms_index_len; i++){
+        pi = &ms->ms_index[i];
+        if (pi->pi_cb == cb){
+            *vecp = pi->pi_vec;
+            *lenp = pi->pi_len;
+            goto ok;
+        }
+    }
+    if ((pi = realloc(ms->ms_index, (ms->ms_index_len+1)*sizeof(*pi))) == NULL){
+        clixon_err(OE_UNIX, errno, "realloc");
+        goto done;
+    }
+    ms->ms_index = pi;
+    pi = &ms->ms_index[ms->ms_index_len];
+    memset(pi, 0, sizeof(*pi));
+    pi->pi_cb = cb;
+    if ((pi->pi_vec = calloc(ms->ms_plugin_nr+1, sizeof(*pi->pi_vec))) == NULL){
+        clixon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    ms->ms_index_len++;
+    if ((cp = ms->ms_plugin_list) != NULL){
+        do {
+            if (*(void **)((char *)&cp->cp_api + cb) != NULL)
+                pi->pi_vec[pi->pi_len++] = cp;
+            cp = NEXTQ(clixon_plugin_t *, cp);
+        } while (cp != ms->ms_plugin_list);
+    }
+    *vecp = pi->pi_vec;
+    *lenp = pi->pi_len;
+ ok:
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Clear the callback index, it is rebuilt on next clixon_plugin_index()
+ *
+ * Called when plugins are added or removed. Call it if plugin callbacks are changed
+ * after they have been dispatched.
+ * @param[in]  h     Clixon handle
+ * @retval     0     OK
+ */
+int
+clixon_plugin_index_reset(clixon_handle h)
+{
+    plugin_module_struct *ms = plugin_module_struct_get(h);
+    int                   i;
+
+    if (ms == NULL)
+        return 0;
+    for (i=0; i<ms->ms_index_len; i++)
+        free(ms->ms_index[i].pi_vec);
+    if (ms->ms_index)
+        free(ms->ms_index);
+    ms->ms_index = NULL;
+    ms->ms_index_len = 0;
+    return 0;
+}
+
 /*! Find plugin by name
  *
  * @param[in]  h    Clixon handle
@@ -333,8 +457,8 @@ plugin_add_one(clixon_handle       h,
     }
 
     /* Note: sizeof clixon_plugin_api which is largest of clixon_plugin_api:s */
-    if ((cp = (clixon_plugin_t *)malloc(sizeof(*cp))) == NULL){
-        clixon_err(OE_UNIX, errno, "malloc");
+    if ((cp = (clixon_plugin_t *)clixon_mem_malloc(CLIXON_MEM_PLUGIN, sizeof(*cp))) == NULL){
+        clixon_err(OE_UNIX, errno, "clixon_mem_malloc");
         goto done;
     }
     memset(cp, 0, sizeof(struct clixon_plugin));
@@ -343,7 +467,9 @@ plugin_add_one(clixon_handle       h,
     snprintf(cp->cp_name, sizeof(cp->cp_name), "%s", name);
     if (api)
         cp->cp_api = *api;
+    cp->cp_nr = ms->ms_plugin_nr++;
     ADDQ(cp, ms->ms_plugin_list);
+    clixon_plugin_index_reset(h);
     if (cpp)
         *cpp = cp;
     retval = 0;
@@ -493,6 +619,7 @@ done:
  *     err;
  *   cp->cp_api.ca_extension = my_ext_cb;
  * @endcode
+ * @note Set callbacks before they are dispatched, see clixon_plugin_index()
  */
 int
 clixon_pseudo_plugin(clixon_handle     h,
@@ -616,11 +743,13 @@ clixon_plugin_exit_all(clixon_handle h)
     plugin_module_struct *ms = plugin_module_struct_get(h);
 
     if (ms != NULL){
+        clixon_plugin_index_reset(h);
         while ((cp = ms->ms_plugin_list) != NULL){
             DELQ(cp, ms->ms_plugin_list, clixon_plugin_t *);
+            ms->ms_plugin_nr--;
             if (clixon_plugin_exit_one(cp, h) < 0)
                 goto done;
-            free(cp);
+            clixon_mem_free(cp);
         }
     }
     retval = 0;
@@ -697,9 +826,11 @@ clixon_plugin_auth_all(clixon_handle      h,
                        clixon_auth_type_t auth_type,
                        char             **authp)
 {
-    int              retval = -1;
-    clixon_plugin_t *cp = NULL;
-    int              ret = 0;
+    int               retval = -1;
+    clixon_plugin_t **cpv;
+    int               cpn;
+    int               i;
+    int               ret = 0;
 
     clixon_debug(CLIXON_DBG_DEFAULT, "");
     if (authp == NULL){
@@ -708,8 +839,10 @@ clixon_plugin_auth_all(clixon_handle      h,
     }
     *authp = NULL;
     ret = 0; /* ignore */
-    while ((cp = clixon_plugin_each(h, cp)) != NULL) {
-        if ((ret = clixon_plugin_auth_one(cp, h, req, auth_type, authp)) < 0)
+    if (clixon_plugin_index(h, CLIXON_PLUGIN_CB(ca_auth), &cpv, &cpn) < 0)
+        goto done;
+    for (i=0; i<cpn; i++) {
+        if ((ret = clixon_plugin_auth_one(cpv[i], h, req, auth_type, authp)) < 0)
             goto done;
         if (ret == 1)
             break; /* result, not ignored */
@@ -778,11 +911,15 @@ clixon_plugin_extension_all(clixon_handle h,
                             yang_stmt    *yext,
                             yang_stmt    *ys)
 {
-    int            retval = -1;
-    clixon_plugin_t *cp = NULL;
+    int               retval = -1;
+    clixon_plugin_t **cpv;
+    int               cpn;
+    int               i;
 
-    while ((cp = clixon_plugin_each(h, cp)) != NULL) {
-        if (clixon_plugin_extension_one(cp, h, yext, ys) < 0)
+    if (clixon_plugin_index(h, CLIXON_PLUGIN_CB(ca_extension), &cpv, &cpn) < 0)
+        goto done;
+    for (i=0; i<cpn; i++) {
+        if (clixon_plugin_extension_one(cpv[i], h, yext, ys) < 0)
             goto done;
     }
     retval = 0;
@@ -1386,20 +1523,35 @@ clixon_plugin_userdef_all(clixon_handle h,
 static int
 rpc_callback_dump(clixon_handle h)
 {
-    rpc_callback_t *rc;
+    rpc_callback_t      **rcp;
+    rpc_callback_t       *rc;
+    char                **keys = NULL;
+    size_t                klen = 0;
+    size_t                i;
     plugin_module_struct *ms = plugin_module_struct_get(h);
 
     clixon_debug(CLIXON_DBG_RPC, "--------------");
-    if ((rc = ms->ms_rpc_callbacks) != NULL)
-        do {
-            clixon_debug(CLIXON_DBG_RPC, "%s", rc->rc_name);
-            rc = NEXTQ(rpc_callback_t *, rc);
-        } while (rc != ms->ms_rpc_callbacks);
+    if (ms->ms_rpc_callbacks &&
+        clicon_hash_keys(ms->ms_rpc_callbacks, &keys, &klen) < 0)
+        return -1;
+    for (i=0; i<klen; i++){
+        rcp = clicon_hash_value(ms->ms_rpc_callbacks, keys[i], NULL);
+        if ((rc = *rcp) != NULL)
+            do {
+                clixon_debug(CLIXON_DBG_RPC, "%s:%s", rc->rc_namespace, rc->rc_name);
+                rc = NEXTQ(rpc_callback_t *, rc);
+            } while (rc != *rcp);
+    }
+    if (keys)
+        free(keys);
     return 0;
 }
 #endif
 
 /*! Register a RPC callback by appending a new RPC to a global list
+ *
+ * Callbacks are kept in a hash table keyed by RPC name, each entry with a list of the
+ * callbacks of that name in registration order.
  *
  * @param[in]  h         clicon handle
  * @param[in]  cb        Callback called 
@@ -1418,6 +1570,8 @@ rpc_callback_register(clixon_handle  h,
                       const char    *name)
 {
     rpc_callback_t       *rc = NULL;
+    rpc_callback_t      **rcp;
+    rpc_callback_t       *head = NULL;
     plugin_module_struct *ms = plugin_module_struct_get(h);
 
     clixon_debug(CLIXON_DBG_RPC, "%s", name);
@@ -1438,7 +1592,17 @@ rpc_callback_register(clixon_handle  h,
     rc->rc_arg  = arg;
     rc->rc_namespace  = strdup(ns);
     rc->rc_name  = strdup(name);
-    ADDQ(rc, ms->ms_rpc_callbacks);
+    if (ms->ms_rpc_callbacks == NULL &&
+        (ms->ms_rpc_callbacks = clicon_hash_init()) == NULL)
+        goto done;
+    if ((rcp = clicon_hash_value(ms->ms_rpc_callbacks, name, NULL)) != NULL){
+        ADDQ(rc, *rcp);
+    }
+    else {
+        ADDQ(rc, head);
+        if (clicon_hash_add(ms->ms_rpc_callbacks, name, &head, sizeof(head)) == NULL)
+            goto done;
+    }
     return 0;
  done:
     if (rc){
@@ -1456,18 +1620,33 @@ rpc_callback_register(clixon_handle  h,
 static int
 rpc_callback_delete_all(clixon_handle h)
 {
-    rpc_callback_t *rc;
+    rpc_callback_t      **rcp;
+    rpc_callback_t       *rc;
+    char                **keys = NULL;
+    size_t                klen = 0;
+    size_t                i;
     plugin_module_struct *ms = plugin_module_struct_get(h);
 
-    if (ms != NULL)
-        while((rc = ms->ms_rpc_callbacks) != NULL) {
-            DELQ(rc, ms->ms_rpc_callbacks, rpc_callback_t *);
+    if (ms == NULL || ms->ms_rpc_callbacks == NULL)
+        return 0;
+    if (clicon_hash_keys(ms->ms_rpc_callbacks, &keys, &klen) < 0)
+        return -1;
+    for (i=0; i<klen; i++){
+        if ((rcp = clicon_hash_value(ms->ms_rpc_callbacks, keys[i], NULL)) == NULL)
+            continue;
+        while((rc = *rcp) != NULL) {
+            DELQ(rc, *rcp, rpc_callback_t *);
             if (rc->rc_namespace)
                 free(rc->rc_namespace);
             if (rc->rc_name)
                 free(rc->rc_name);
             free(rc);
         }
+    }
+    if (keys)
+        free(keys);
+    clicon_hash_free(ms->ms_rpc_callbacks);
+    ms->ms_rpc_callbacks = NULL;
     return 0;
 }
 
@@ -1495,6 +1674,7 @@ rpc_callback_call(clixon_handle h,
                   cbuf         *cbret)
 {
     int                   retval = -1;
+    rpc_callback_t      **rcp;
     rpc_callback_t       *rc;
     char                 *name;
     char                 *prefix;
@@ -1511,10 +1691,11 @@ rpc_callback_call(clixon_handle h,
     name = xml_name(xe);
     prefix = xml_prefix(xe);
     xml2ns(xe, prefix, &ns);
-    if ((rc = ms->ms_rpc_callbacks) != NULL)
+    if (ns && ms->ms_rpc_callbacks &&
+        (rcp = clicon_hash_value(ms->ms_rpc_callbacks, name, NULL)) != NULL &&
+        (rc = *rcp) != NULL)
         do {
-            if (strcmp(rc->rc_name, name) == 0 &&
-                ns && rc->rc_namespace &&
+            if (rc->rc_namespace &&
                 strcmp(rc->rc_namespace, ns) == 0){
                 wh = NULL;
                 if (clixon_resource_check(h, &wh, rc->rc_name, __func__) < 0)
@@ -1538,7 +1719,7 @@ rpc_callback_call(clixon_handle h,
                     break;
             }
             rc = NEXTQ(rpc_callback_t *, rc);
-        } while (rc != ms->ms_rpc_callbacks);
+        } while (rc != *rcp);
     /* action reply checked in action_callback_call */
     if (nr &&
         strcmp(name, "hello") != 0 &&
@@ -2096,6 +2277,7 @@ clixon_plugin_module_exit(clixon_handle h)
     upgrade_callback_delete_all(h);
     /* Delete plugin_module itself */
     if ((ph = plugin_module_struct_get(h)) != NULL){
+        clixon_plugin_index_reset(h);
         free(ph);
         plugin_module_struct_set(h, NULL);
     }
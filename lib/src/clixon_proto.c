@@ -56,6 +56,7 @@
 #include <sys/time.h>
 #include <sys/socket.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
 #include <sys/param.h>
 #include <netinet/in.h>
 #include <sys/un.h>
@@ -84,6 +85,131 @@
 
 static int _atomicio_sig = 0;
 
+/* Bytes read after the end of a message, kept for the next message on the same socket */
+struct msg_rest {
+    int            mr_fd;   /* Socket */
+    ino_t          mr_ino;  /* Socket inode, since fd may be closed and reused */
+    unsigned char *mr_buf;  /* Remaining bytes, malloced */
+    size_t         mr_len;  /* Number of remaining bytes */
+};
+static struct msg_rest *_msg_rest = NULL;
+static int              _msg_rest_nr = 0;
+
+/*! Find remaining bytes of socket, discard stale entries of closed sockets
+ *
+ * @param[in]  s   Socket
+ * @retval     mr  Remaining bytes of socket
+ * @retval     NULL None
+ */
+static struct msg_rest *
+msg_rest_find(int s)
+{
+    struct msg_rest *mr;
+    struct stat      st;
+    int              i;
+
+    for (i=0; i<_msg_rest_nr; i++){
+        mr = &_msg_rest[i];
+        if (mr->mr_fd != s)
+            continue;
+        if (fstat(s, &st) == 0 && st.st_ino == mr->mr_ino)
+            return mr;
+        free(mr->mr_buf);
+        _msg_rest[i] = _msg_rest[--_msg_rest_nr];
+        break;
+    }
+    return NULL;
+}
+
+/*! Get remaining bytes of socket instead of reading it
+ *
+ * @param[in]  s       Socket
+ * @param[out] buf     Packet buffer
+ * @param[in]  buflen  Length of packet buffer
+ * @retval     n       Number of bytes copied to buf, 0 if none
+ */
+static size_t
+msg_rest_get(int            s,
+             unsigned char *buf,
+             size_t         buflen)
+{
+    struct msg_rest *mr;
+    size_t           n;
+
+    if (_msg_rest_nr == 0 || (mr = msg_rest_find(s)) == NULL)
+        return 0;
+    n = mr->mr_len < buflen ? mr->mr_len : buflen;
+    memcpy(buf, mr->mr_buf, n);
+    if ((mr->mr_len -= n) > 0)
+        memmove(mr->mr_buf, mr->mr_buf + n, mr->mr_len);
+    else {
+        free(mr->mr_buf);
+        *mr = _msg_rest[--_msg_rest_nr];
+    }
+    return n;
+}
+
+/*! Save bytes read after the end of a message for the next message of socket
+ *
+ * @param[in]  s    Socket
+ * @param[in]  buf  Remaining bytes
+ * @param[in]  len  Number of remaining bytes
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+msg_rest_save(int            s,
+              unsigned char *buf,
+              size_t         len)
+{
+    struct msg_rest *mr;
+    struct stat      st;
+    unsigned char   *b;
+
+    if ((mr = msg_rest_find(s)) == NULL){
+        if (fstat(s, &st) < 0){
+            clixon_err(OE_UNIX, errno, "fstat");
+            return -1;
+        }
+        if ((mr = realloc(_msg_rest, (_msg_rest_nr+1)*sizeof(*mr))) == NULL){
+            clixon_err(OE_UNIX, errno, "realloc");
+            return -1;
+        }
+        _msg_rest = mr;
+        mr = &_msg_rest[_msg_rest_nr++];
+        memset(mr, 0, sizeof(*mr));
+        mr->mr_fd = s;
+        mr->mr_ino = st.st_ino;
+    }
+    /* Bytes are saved when a message ends, so they precede any earlier rest */
+    if ((b = malloc(len + mr->mr_len)) == NULL){
+        clixon_err(OE_UNIX, errno, "malloc");
+        return -1;
+    }
+    memcpy(b, buf, len);
+    if (mr->mr_len)
+        memcpy(b + len, mr->mr_buf, mr->mr_len);
+    if (mr->mr_buf)
+        free(mr->mr_buf);
+    mr->mr_buf = b;
+    mr->mr_len += len;
+    return 0;
+}
+
+/*! Check if bytes of a next message have already been read from socket
+ *
+ * A caller receiving messages from an event loop should then receive again since
+ * the socket may not become readable
+ * @param[in]  s   Socket
+ * @retval     1   Yes, call clixon_msg_rcv11 or clixon_msg_rcv10 again
+ * @retval     0   No
+ */
+int
+clixon_msg_pending(int s)
+{
+    return _msg_rest_nr && msg_rest_find(s) != NULL;
+}
+
 /*! Given family, addr str, port, return sockaddr and length
  *
  * @param[in]  addrtype  Address family: inet:ipv4-address or inet:ipv6-address
@@ -353,6 +479,80 @@ atomicio(ssize_t (*fn) (int, void *, size_t),
     return (pos);
 }
 
+/*! Ensure all writev data is written, unless error
+ *
+ * Same as atomicio for write but with a vector of buffers, the vector is modified
+ * @param[in]     fd      File descriptor
+ * @param[in,out] iov     Vector of buffers
+ * @param[in]     iovcnt  Number of buffers
+ * @retval        n       Number of bytes written
+ * @retval        0       Peer closed
+ * @retval       -1       Error
+ * @see atomicio
+ */
+static ssize_t
+atomicio_writev(int           fd,
+                struct iovec *iov,
+                int           iovcnt)
+{
+    ssize_t res;
+    ssize_t pos = 0;
+
+    while (iovcnt > 0) {
+        _atomicio_sig = 0;
+        if ((res = writev(fd, iov, iovcnt)) < 0){
+            if (errno == EINTR){
+                if (_atomicio_sig == 0)
+                    continue;
+            }
+            else if (errno == EAGAIN)
+                continue;
+            else if (errno == ECONNRESET || /* Connection reset by peer */
+                     errno == EPIPE ||      /* Client shutdown */
+                     errno == EBADF)        /* client shutdown - freebsd */
+                res = 0;
+            return res;
+        }
+        if (res == 0)
+            return 0;
+        pos += res;
+        /* Skip written buffers and advance into partially written buffer */
+        while (iovcnt > 0 && (size_t)res >= iov->iov_len){
+            res -= iov->iov_len;
+            iov++;
+            iovcnt--;
+        }
+        if (iovcnt > 0){
+            iov->iov_base = (char*)iov->iov_base + res;
+            iov->iov_len -= res;
+        }
+    }
+    return pos;
+}
+
+/*! Debug log of sent message
+ *
+ * @param[in]  descr Description of peer for logging
+ * @param[in]  str   Message
+ */
+static void
+msg_send_debug(const char *descr,
+               const char *str)
+{
+    if (descr){
+        if (clixon_debug_detail())
+            clixon_debug(CLIXON_DBG_MSG | CLIXON_DBG_DETAIL, "Send [%s] %s", descr, str);
+        else
+            clixon_debug(CLIXON_DBG_MSG | CLIXON_DBG_TRUNC, "Send [%s] %s", descr, str);
+    }
+    else{
+        if (clixon_debug_detail())
+            clixon_debug(CLIXON_DBG_MSG | CLIXON_DBG_DETAIL, "Send %s", str);
+        else
+            clixon_debug(CLIXON_DBG_MSG | CLIXON_DBG_TRUNC, "Send %s", str);
+    }
+}
+
 /*! Send a message using NETCONF without encapsulation
  *
  * That is, NETCONF 1.0 / 1.1 encapsulation must have been done
@@ -369,19 +569,7 @@ clixon_msg_send(int         s,
 {
     int retval = -1;
 
-    if (descr){
-        if (clixon_debug_detail())
-            clixon_debug(CLIXON_DBG_MSG | CLIXON_DBG_DETAIL, "Send [%s] %s", descr, cbuf_get(cb));
-        else
-            clixon_debug(CLIXON_DBG_MSG | CLIXON_DBG_TRUNC, "Send [%s] %s", descr, cbuf_get(cb));
-    }
-    else{
-        if (clixon_debug_detail())
-            clixon_debug(CLIXON_DBG_MSG | CLIXON_DBG_DETAIL, "Send %s", cbuf_get(cb));
-        else
-            clixon_debug(CLIXON_DBG_MSG | CLIXON_DBG_TRUNC, "Send %s", cbuf_get(cb));
-    }
-
+    msg_send_debug(descr, cbuf_get(cb));
     if (atomicio((ssize_t (*)(int, void *, size_t))write,
                  s, cbuf_get(cb), cbuf_len(cb)) < 0){
         clixon_err(OE_CFG, errno, "atomicio");
@@ -412,44 +600,48 @@ clixon_msg_rcv10(int         s,
                  cbuf      **msg,
                  int        *eof)
 {
-    int           retval = -1;
-    unsigned char buf[BUFSIZ];
-    int           i;
-    int           len;
-    int           xml_state = 0;
-    int           poll;
-    cbuf         *cbmsg = NULL;
+    int            retval = -1;
+    unsigned char  buf[BUFSIZ];
+    unsigned char *p;
+    size_t         plen;
+    ssize_t        len;
+    int            frame_state = 0;
+    size_t         frame_size = 0;
+    int            eom = 0;
+    int            poll;
+    cbuf          *cbmsg = NULL;
 
     clixon_debug(CLIXON_DBG_MSG | CLIXON_DBG_DETAIL, "");
     *eof = 0;
-    memset(buf, 0, sizeof(buf));
     if ((cbmsg = cbuf_new()) == NULL){
         clixon_err(OE_XML, errno, "cbuf_new");
         goto done;
     }
     while (1){
-        if ((len = netconf_input_read2(s, buf, sizeof(buf), eof)) < 0)
+        if ((len = msg_rest_get(s, buf, sizeof(buf))) == 0 &&
+            (len = netconf_input_read2(s, buf, sizeof(buf), eof)) < 0)
             goto done;
-        for (i=0; i<len; i++){
-            if (buf[i] == 0)
-                continue; /* Skip NULL chars (eg from terminals) */
-            cprintf(cbmsg, "%c", buf[i]);
-            if (detect_endtag("]]>]]>",
-                              buf[i],
-                              &xml_state)) {
-                /* OK, we have an xml string from a client */
-                /* Remove trailer */
-                *(((char*)cbuf_get(cbmsg)) + cbuf_len(cbmsg) - strlen("]]>]]>")) = '\0';
-                goto ok;
-            }
+        p = buf;
+        plen = len;
+        if (netconf_input_msg2(&p, &plen, cbmsg, NETCONF_SSH_EOM,
+                               &frame_state, &frame_size, &eom) < 0)
+            goto done;
+        if (eom){
+            /* Keep bytes of next message */
+            if (plen > 0 && msg_rest_save(s, p, plen) < 0)
+                goto done;
+            break;
         }
+        if (*eof)
+            break;
         /* poll==1 if more, poll==0 if none */
+        if (clixon_msg_pending(s))
+            continue;
         if ((poll = clixon_event_poll(s)) < 0)
             goto done;
         if (poll == 0)
             break; /* No data to read */
     } /* while */
- ok:
     if (*eof){
         if (descr)
             clixon_debug(CLIXON_DBG_MSG, "Recv [%s]: EOF", descr);
@@ -547,7 +739,10 @@ clixon_rpc10(int         sock,
  *
  * @param[in]  s      socket (unix or inet) to communicate with backend
  * @param[in]  descr  Description of peer for logging
- * @param[out] msg    Outgoing Cbuf
+ * @param[in]  msg    Outgoing Cbuf, not modified
+ * @retval     0      OK
+ * @retval    -1      Error
+ * The message is written together with the framing, without copying it
  * @see clixon_msg_send10  1.0 EOM
  * @see clixon_msg_send    No encapsulation
  */
@@ -556,14 +751,52 @@ clixon_msg_send11(int         s,
                   const char *descr,
                   cbuf       *msg)
 {
-    int retval = -1;
+    msg_send_debug(descr, cbuf_get(msg));
+    return clixon_msg_send11_chunk(s, cbuf_get(msg), strlen(cbuf_get(msg)), 1);
+}
 
-    if (netconf_output_encap(NETCONF_SSH_CHUNKED, msg) < 0)
-        goto done;
-    if (clixon_msg_send(s, descr, msg) < 0)
+/*! Send a chunk of a message using NETCONF 1.1 chunked framing
+ *
+ * Chunk header, data and end-of-chunks are written with one writev without copying
+ * the data. A large message may be sent in several chunks while it is produced.
+ * @param[in]  s     Socket
+ * @param[in]  data  Chunk data
+ * @param[in]  len   Length of chunk data, if 0 no chunk is sent
+ * @param[in]  last  If set, end message with end-of-chunks
+ * @retval     0     OK
+ * @retval    -1     Error
+ * @see clixon_xml2cbuf_stream  For streaming XML output in chunks
+ */
+int
+clixon_msg_send11_chunk(int         s,
+                        const char *data,
+                        size_t      len,
+                        int         last)
+{
+    int          retval = -1;
+    struct iovec iov[3];
+    int          iovcnt = 0;
+    char         hdr[32];
+
+    clixon_debug(CLIXON_DBG_MSG | CLIXON_DBG_DETAIL, "len:%zu last:%d", len, last);
+    if (len > 0){
+        snprintf(hdr, sizeof(hdr), "\n#%zu\n", len);
+        iov[iovcnt].iov_base = hdr;
+        iov[iovcnt++].iov_len = strlen(hdr);
+        iov[iovcnt].iov_base = (void*)data;
+        iov[iovcnt++].iov_len = len;
+    }
+    if (last){
+        iov[iovcnt].iov_base = "\n##\n";
+        iov[iovcnt++].iov_len = strlen("\n##\n");
+    }
+    if (iovcnt && atomicio_writev(s, iov, iovcnt) < 0){
+        clixon_err(OE_CFG, errno, "atomicio_writev");
+        clixon_log(NULL, LOG_WARNING, "%s: writev: %s", __func__, strerror(errno));
         goto done;
+    }
     retval = 0;
-  done:
+ done:
     return retval;
 }
 
@@ -623,26 +856,27 @@ clixon_msg_rcv11(int         s,
         goto done;
     }
     while (*eof == 0 && eom == 0) {
-        /* Read input data from socket and append to cbbuf */
-        if ((len = netconf_input_read2(s, buf, buflen, eof)) < 0)
+        /* Read input data from socket, or bytes remaining from previous message */
+        if ((len = msg_rest_get(s, buf, buflen)) == 0 &&
+            (len = netconf_input_read2(s, buf, buflen, eof)) < 0)
             goto done;
         p = buf;
         plen = len;
-        while (!(*eof)  && plen > 0){
-            if (netconf_input_msg2(&p, &plen,
-                                   cbmsg,
-                                   NETCONF_SSH_CHUNKED,
-                                   &frame_state,
-                                   &frame_size,
-                                   &eom) < 0){
-                /* Errors from input are only framing errors, non-fatal, return eof */
-                *eof = 1;
-                cbuf_reset(cbmsg);
-                break;
-            }
-            if (eom == 0)
-                continue;
+        if (!(*eof) && plen > 0 &&
+            netconf_input_msg2(&p, &plen,
+                               cbmsg,
+                               NETCONF_SSH_CHUNKED,
+                               &frame_state,
+                               &frame_size,
+                               &eom) < 0){
+            /* Errors from input are only framing errors, non-fatal, return eof */
+            *eof = 1;
+            cbuf_reset(cbmsg);
+            break;
         }
+        /* Keep bytes of next message */
+        if (eom && plen > 0 && msg_rest_save(s, p, plen) < 0)
+            goto done;
     }
     if (*eof ){
         if (descr)
@@ -685,6 +919,79 @@ clixon_msg_rcv11(int         s,
     return retval;
 }
 
+/*! Receive a message using NETCONF 1.1 chunked framing and relay its data as it arrives
+ *
+ * The message is not reassembled, the chunk-data of each read is passed to a callback
+ * in spans, so memory is constant regardless of message size.
+ * @param[in]   s      Socket (unix or inet) to communicate with backend
+ * @param[in]   descr  Description of peer for logging
+ * @param[in]   fn     Called with each span of message data, in order
+ * @param[in]   arg    Argument to fn
+ * @param[out]  eof    Set if eof or framing error encountered
+ * @retval      0      OK (check eof)
+ * @retval     -1      Error, or error from fn
+ * @see clixon_msg_rcv11  Message reassembled in a cbuf
+ */
+int
+clixon_msg_rcv11_relay(int                  s,
+                       const char          *descr,
+                       clixon_msg_relay_cb *fn,
+                       void                *arg,
+                       int                 *eof)
+{
+    int            retval = -1;
+    unsigned char  buf[BUFSIZ];
+    unsigned char *p;
+    size_t         plen;
+    ssize_t        len;
+    int            frame_state = 0;
+    size_t         frame_size = 0;
+    size_t         n;
+    size_t         total = 0;
+    int            eom = 0;
+    int            ret;
+
+    *eof = 0;
+    while (*eof == 0 && eom == 0) {
+        /* Read input data from socket, or bytes remaining from previous message */
+        if ((len = msg_rest_get(s, buf, sizeof(buf))) == 0 &&
+            (len = netconf_input_read2(s, buf, sizeof(buf), eof)) < 0)
+            goto done;
+        p = buf;
+        plen = len;
+        while (*eof == 0 && eom == 0 && plen > 0){
+            if (frame_state == 4 && frame_size > 0){ /* chunk-data */
+                n = plen < frame_size ? plen : frame_size;
+                if (fn(arg, (const char*)p, n) < 0)
+                    goto done;
+                frame_size -= n;
+                total += n;
+                p += n;
+                plen -= n;
+                continue;
+            }
+            plen--;
+            if ((ret = netconf_input_chunked_framing(*p++, &frame_state, &frame_size)) < 0){
+                /* Errors from input are only framing errors, non-fatal, return eof */
+                *eof = 1;
+                break;
+            }
+            if (ret == 2)
+                eom++;
+        }
+        /* Keep bytes of next message */
+        if (eom && plen > 0 && msg_rest_save(s, p, plen) < 0)
+            goto done;
+    }
+    if (descr)
+        clixon_debug(CLIXON_DBG_MSG, "Recv [%s]: %s%zu bytes relayed", descr, *eof?"EOF ":"", total);
+    else
+        clixon_debug(CLIXON_DBG_MSG, "Recv: %s%zu bytes relayed", *eof?"EOF ":"", total);
+    retval = 0;
+ done:
+    return retval;
+}
+
 /*! Send a netconf message and recieve result using NETCONF 1.1 framing
  *
  * This is mainly used by the client API.
@@ -732,24 +1039,9 @@ send_msg_reply(int         s,
                char       *data,
                uint32_t    datalen)
 {
-    int                retval = -1;
-    cbuf          *cb = NULL;
-
-    if ((cb = cbuf_new()) == NULL){
-        clixon_err(OE_UNIX, errno, "cbuf_new");
-        goto done;
-    }
-    if (cbuf_append_buf(cb, data, datalen) < 0){
-        clixon_err(OE_UNIX, errno, "cbuf_append_buf");
-        goto done;
-    }
-    if (clixon_msg_send11(s, descr, cb) < 0)
-        goto done;
-    retval = 0;
- done:
-    if (cb)
-        cbuf_free(cb);
-    return retval;
+    msg_send_debug(descr, data);
+    /* Data is sent directly, datalen may include a terminating null char */
+    return clixon_msg_send11_chunk(s, data, strnlen(data, datalen), 1);
 }
 
 /*! Send a NETCONF NOTIFY message asynchronously to client
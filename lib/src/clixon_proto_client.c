@@ -47,9 +47,11 @@
 #include <stdio.h>
 #include <string.h>
 #include <errno.h>
+#include <inttypes.h>
 #include <assert.h>
 #include <unistd.h>
 #include <sys/param.h>
+#include <sys/time.h>
 #include <sys/stat.h>
 #include <sys/socket.h>
 #include <sys/syslog.h>
@@ -83,6 +85,7 @@
 #include "clixon_xml_sort.h"
 #include "clixon_netconf_lib.h"
 #include "clixon_xml_io.h"
+#include "clixon_xml_bin.h"
 #include "clixon_proto_client.h"
 
 #define PERSIST_ID_XML_FMT "<persist-id>%s</persist-id>"
@@ -131,8 +134,12 @@ create_hello(clixon_handle h,
     if (clixon_lib)
         cprintf(cb, " xmlns:%s=\"%s\"", CLIXON_LIB_PREFIX, CLIXON_LIB_NS);
     cprintf(cb, ">");
-    cprintf(cb, "<capabilities><capability>%s</capability></capabilities>",
-            NETCONF_BASE_CAPABILITY_1_1);
+    cprintf(cb, "<capabilities><capability>%s</capability>", NETCONF_BASE_CAPABILITY_1_1);
+    /* Binary records are in host byte order */
+    if (clicon_option_bool(h, "CLICON_SOCK_BINARY") &&
+        clicon_sock_family(h) == AF_UNIX)
+        cprintf(cb, "<capability>%s</capability>", CLIXON_BIN_CAPABILITY);
+    cprintf(cb, "</capabilities>");
     cprintf(cb, "</hello>");
     return 0;
 }
@@ -166,6 +173,88 @@ parse_hello(clixon_handle h,
     return retval;
 }
 
+/*! Check if data of a reply is already bound to yang, eg a binary reply
+ *
+ * @param[in]  xd  Data node of reply
+ * @retval     1   Bound, data was decoded from binary reply
+ * @retval     0   Not bound
+ * @see clixon_bin_parse_buf
+ */
+static int
+reply_data_bound(cxobj *xd)
+{
+    cxobj *xc;
+
+    if ((xc = xml_child_i_type(xd, 0, CX_ELMNT)) == NULL)
+        return 0;
+    return xml_spec(xc) != NULL;
+}
+
+/*! Parse reply from backend, XML or binary
+ *
+ * @param[in]   h      Clixon handle
+ * @param[in]   cbrcv  Received message
+ * @param[out]  xret   Reply as xml tree. Free w xml_free
+ * @retval      0      OK
+ * @retval     -1      Error
+ */
+static int
+rpc_reply_parse(clixon_handle h,
+                cbuf         *cbrcv,
+                cxobj       **xret)
+{
+    int bound;
+
+    if (clixon_bin_magic(cbuf_get(cbrcv), cbuf_len(cbrcv))){
+        /* Binary reply, bound to yang if same modules, see CLIXON_BIN_CAPABILITY */
+        if (clixon_bin_parse_buf(cbuf_get(cbrcv), cbuf_len(cbrcv), clicon_dbspec_yang(h),
+                                 xret, &bound) < 0)
+            return -1;
+    }
+    else if (cbuf_get(cbrcv)){
+        /* NONE: Cannot bind yang, need to know RPC name (eg "lock") */
+        if (clixon_xml_parse_string(cbuf_get(cbrcv), YB_NONE, NULL, xret, NULL) < 0)
+            return -1;
+    }
+    return 0;
+}
+
+/* Number and wall time of rpcs waiting for a reply, see clicon_rpc_stats_get */
+static uint64_t _rpc_stats_nr = 0;
+static uint64_t _rpc_stats_usec = 0;
+
+/*! Get accumulated number and wall time of client rpcs to the backend
+ *
+ * Counts requests where the client waits for the reply, including hello.
+ * A caller may take the difference of two calls to get the rpcs of an operation.
+ * @param[out]  nr    Number of rpcs
+ * @param[out]  usec  Wall time in microseconds
+ */
+void
+clicon_rpc_stats_get(uint64_t *nr,
+                     uint64_t *usec)
+{
+    if (nr)
+        *nr = _rpc_stats_nr;
+    if (usec)
+        *usec = _rpc_stats_usec;
+}
+
+/*! Add wall time since t0 to client rpc stats
+ *
+ * @param[in]  t0   Start time
+ */
+static void
+rpc_stats_add(struct timeval *t0)
+{
+    struct timeval t;
+
+    gettimeofday(&t, NULL);
+    timersub(&t, t0, &t);
+    _rpc_stats_nr++;
+    _rpc_stats_usec += (uint64_t)t.tv_sec*1000000 + t.tv_usec;
+}
+
 /*! Send internal netconf rpc from client to backend, opt return new socket
  *
  * Some complexity in trying to restart socket if (cached) returns eof
@@ -193,23 +282,23 @@ clixon_rpc_msg2(clixon_handle h,
     cbuf  *cbrcv = NULL;
     cxobj *xret = NULL;
     int    eof = 0;
+    struct timeval t0;
 
     clixon_debug(CLIXON_DBG_DEFAULT | CLIXON_DBG_DETAIL, "");
     if (s < 0){
         clixon_err(OE_NETCONF, EINVAL, "s is < 0");
         goto done;
     }
+    gettimeofday(&t0, NULL);
     if (clixon_rpc11(s, clicon_sock_str(h), cbsend, &cbrcv, &eof) < 0){
         /* 2. check socket shutdown AFTER rpc */
         goto done;
     }
+    rpc_stats_add(&t0);
     if (eof)
         goto eof;
-    if (cbrcv && cbuf_get(cbrcv)){
-        /* NONE: Cannot bind yang, need to know RPC name (eg "lock") */
-        if (clixon_xml_parse_string(cbuf_get(cbrcv), YB_NONE, NULL, &xret, NULL) < 0)
-            goto done;
-    }
+    if (cbrcv && rpc_reply_parse(h, cbrcv, &xret) < 0)
+        goto done;
     if (xret0){
         *xret0 = xret;
         xret = NULL;
@@ -227,6 +316,55 @@ clixon_rpc_msg2(clixon_handle h,
     goto done;
 }
 
+/*! Connect to backend and send hello
+ *
+ * @param[in]   h      Clixon handle
+ * @param[out]  sock   Socket to backend
+ * @retval      0      OK
+ * @retval     -1      Error
+ */
+static int
+rpc_connect_hello(clixon_handle h,
+                  int          *sock)
+{
+    int      retval = -1;
+    int      s = -1;
+    cbuf    *cb = NULL;
+    cxobj   *xret = NULL;
+    uint32_t id;
+    int      ret;
+
+    if (clixon_rpc_connect(h, &s) < 0)
+        goto done;
+    if ((cb = cbuf_new()) == NULL){
+        clixon_err(OE_XML, errno, "cbuf_new");
+        goto done;
+    }
+    if (create_hello(h, cb, NULL, NULL) < 0)
+        goto done;
+    if ((ret = clixon_rpc_msg2(h, cb, s, &xret)) < 0)
+        goto done;
+    if (ret == 0){
+        clixon_err(OE_PROTO, ESHUTDOWN, "NETCONF Hello to backend failed with EOF.");
+        goto done;
+    }
+    if (parse_hello(h, xret, &id) < 0)
+        goto done;
+    *sock = s;
+    s = -1;
+    retval = 0;
+ done:
+    if (s != -1)
+        close(s);
+    if (xret)
+        xml_free(xret);
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+}
+
+static int rpc_pipeline_drain(clixon_handle h, int s);
+
 /*! Send internal netconf rpc from client to backend
  *
  * @param[in]    h      Clixon handle
@@ -244,35 +382,20 @@ clicon_rpc_msg(clixon_handle h,
 {
     int      retval = -1;
     int      s = -1;
-    cbuf    *cb = NULL;
     cbuf    *cbrcv = NULL;
-    cxobj   *xret = NULL;
-    uint32_t id;
     int      cached = 1;
     int      ret;
 
     if ((s = clicon_client_socket_get(h)) < 0){
         cached = 0;
-        if (clixon_rpc_connect(h, &s) < 0)
-            goto done;
-        if ((cb = cbuf_new()) == NULL){
-            clixon_err(OE_XML, errno, "cbuf_new");
-            goto done;
-        }
-        if (create_hello(h, cb, NULL, NULL) < 0)
-            goto done;
-        if ((ret = clixon_rpc_msg2(h, cb, s, &xret)) < 0){
-            close(s); s = -1;
-            goto done;
-        }
-        if (ret == 0){
-            clixon_err(OE_PROTO, ESHUTDOWN, "NETCONF Hello to backend failed with EOF.");
-            close(s); s = -1;
-            goto done;
-        }
-        if (parse_hello(h, xret, &id) < 0)
+        if (rpc_connect_hello(h, &s) < 0)
             goto done;
     }
+    /* Read replies of pipelined requests first, see clicon_rpc_msg_send */
+    else if (rpc_pipeline_drain(h, s) < 0){
+        close(s); s = -1;
+        goto done;
+    }
     if ((ret = clixon_rpc_msg2(h, cbsend, s, xret0)) < 0){
         close(s); s = -1;
         goto done;
@@ -315,10 +438,6 @@ clicon_rpc_msg(clixon_handle h,
     retval = 0;
  done:
     clicon_client_socket_set(h, s);
-    if (xret)
-        xml_free(xret);
-    if (cb)
-        cbuf_free(cb);
     if (cbrcv)
         cbuf_free(cbrcv);
     return retval;
@@ -392,6 +511,517 @@ clicon_rpc_msg_persistent(clixon_handle h,
     return retval;
 }
 
+/*! Pipelined requests on the cached client socket
+ *
+ * The backend replies to the requests of a session in the order they are received, so
+ * replies are matched to requests by order.
+ * @see clicon_rpc_msg_send
+ */
+struct rpc_pipeline {
+    int       rp_s;        /* Socket requests are sent on */
+    uint32_t  rp_sent;     /* Id of last sent request */
+    uint32_t  rp_rcvd;     /* Id of last received reply */
+    uint32_t *rp_ids;      /* Ids of received replies not yet read */
+    cxobj   **rp_xrets;    /* Received replies not yet read */
+    int       rp_len;
+};
+
+/*! Get pipeline state of client socket
+ *
+ * @param[in]  h    Clixon handle
+ * @retval     rp   Pipeline state
+ * @retval     NULL No pipelined requests
+ */
+static struct rpc_pipeline *
+rpc_pipeline_get(clixon_handle h)
+{
+    void *p = NULL;
+
+    if (clicon_ptr_get(h, "rpc-pipeline", &p) < 0)
+        return NULL;
+    return (struct rpc_pipeline *)p;
+}
+
+/*! Free pipeline state and unread replies
+ *
+ * @param[in]  h    Clixon handle
+ */
+static void
+rpc_pipeline_free(clixon_handle h)
+{
+    struct rpc_pipeline *rp;
+    int                  i;
+
+    if ((rp = rpc_pipeline_get(h)) == NULL)
+        return;
+    for (i=0; i<rp->rp_len; i++)
+        if (rp->rp_xrets[i])
+            xml_free(rp->rp_xrets[i]);
+    if (rp->rp_ids)
+        free(rp->rp_ids);
+    if (rp->rp_xrets)
+        free(rp->rp_xrets);
+    free(rp);
+    clicon_ptr_set(h, "rpc-pipeline", NULL);
+}
+
+/*! Receive next reply of pipelined requests and keep it until read
+ *
+ * @param[in]  h    Clixon handle
+ * @param[in]  rp   Pipeline state
+ * @retval     0    OK
+ * @retval    -1    Error, including EOF
+ */
+static int
+rpc_pipeline_rcv(clixon_handle        h,
+                 struct rpc_pipeline *rp)
+{
+    int       retval = -1;
+    cbuf     *cbrcv = NULL;
+    cxobj    *xret = NULL;
+    uint32_t *ids;
+    cxobj   **xrets;
+    int       eof = 0;
+
+    if (clixon_msg_rcv11(rp->rp_s, clicon_sock_str(h), 0, &cbrcv, &eof) < 0)
+        goto done;
+    if (eof){
+        clixon_err(OE_PROTO, ESHUTDOWN, "Unexpected close of CLICON_SOCK. Clixon backend daemon may have crashed.");
+        goto done;
+    }
+    if (cbrcv && rpc_reply_parse(h, cbrcv, &xret) < 0)
+        goto done;
+    if ((ids = realloc(rp->rp_ids, (rp->rp_len+1)*sizeof(*ids))) == NULL){
+        clixon_err(OE_UNIX, errno, "realloc");
+        goto done;
+    }
+    rp->rp_ids = ids;
+    if ((xrets = realloc(rp->rp_xrets, (rp->rp_len+1)*sizeof(*xrets))) == NULL){
+        clixon_err(OE_UNIX, errno, "realloc");
+        goto done;
+    }
+    rp->rp_xrets = xrets;
+    rp->rp_ids[rp->rp_len] = ++rp->rp_rcvd;
+    rp->rp_xrets[rp->rp_len++] = xret;
+    xret = NULL;
+    retval = 0;
+ done:
+    if (cbrcv)
+        cbuf_free(cbrcv);
+    if (xret)
+        xml_free(xret);
+    return retval;
+}
+
+/*! Receive all outstanding replies of pipelined requests before a synchronous request
+ *
+ * @param[in]  h    Clixon handle
+ * @param[in]  s    Client socket
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+rpc_pipeline_drain(clixon_handle h,
+                   int           s)
+{
+    struct rpc_pipeline *rp;
+
+    if ((rp = rpc_pipeline_get(h)) == NULL)
+        return 0;
+    if (rp->rp_s != s){ /* Socket has been closed */
+        rpc_pipeline_free(h);
+        return 0;
+    }
+    while (rp->rp_rcvd != rp->rp_sent)
+        if (rpc_pipeline_rcv(h, rp) < 0){
+            rpc_pipeline_free(h);
+            return -1;
+        }
+    return 0;
+}
+
+/*! Send internal netconf rpc from client to backend without waiting for the reply
+ *
+ * Several requests may be sent before their replies are read with clicon_rpc_msg_recv,
+ * which saves one round-trip per request.
+ * Uses the same cached socket as clicon_rpc_msg.
+ * @param[in]   h      Clixon handle
+ * @param[in]   cbsend NETCONF Message buffer
+ * @param[out]  id     Request id, to read the reply with clicon_rpc_msg_recv
+ * @retval      0      OK
+ * @retval     -1      Error
+ * @code
+ *   if (clicon_rpc_msg_send(h, cb1, &id1) < 0 ||
+ *       clicon_rpc_msg_send(h, cb2, &id2) < 0)
+ *      err;
+ *   if (clicon_rpc_msg_recv(h, id1, &xret1) < 0 ||
+ *       clicon_rpc_msg_recv(h, id2, &xret2) < 0)
+ *      err;
+ * @endcode
+ * @see clicon_rpc_msg  Synchronous request
+ */
+int
+clicon_rpc_msg_send(clixon_handle h,
+                    cbuf         *cbsend,
+                    uint32_t     *id)
+{
+    int                  retval = -1;
+    int                  s;
+    struct rpc_pipeline *rp;
+
+    if ((s = clicon_client_socket_get(h)) < 0){
+        rpc_pipeline_free(h);
+        if (rpc_connect_hello(h, &s) < 0)
+            goto done;
+        clicon_client_socket_set(h, s);
+    }
+    if ((rp = rpc_pipeline_get(h)) != NULL && rp->rp_s != s){
+        rpc_pipeline_free(h);
+        rp = NULL;
+    }
+    if (rp == NULL){
+        if ((rp = calloc(1, sizeof(*rp))) == NULL){
+            clixon_err(OE_UNIX, errno, "calloc");
+            goto done;
+        }
+        rp->rp_s = s;
+        if (clicon_ptr_set(h, "rpc-pipeline", rp) < 0){
+            free(rp);
+            goto done;
+        }
+    }
+    if (clixon_msg_send11(s, clicon_sock_str(h), cbsend) < 0){
+        rpc_pipeline_free(h);
+        close(s);
+        clicon_client_socket_set(h, -1);
+        goto done;
+    }
+    *id = ++rp->rp_sent;
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Read reply of a request sent with clicon_rpc_msg_send
+ *
+ * Replies of earlier requests that have not been read are received and kept
+ * @param[in]   h      Clixon handle
+ * @param[in]   id     Request id from clicon_rpc_msg_send
+ * @param[out]  xret0  Return value from backend as xml tree. Free w xml_free
+ * @retval      0      OK
+ * @retval     -1      Error
+ */
+int
+clicon_rpc_msg_recv(clixon_handle h,
+                    uint32_t      id,
+                    cxobj       **xret0)
+{
+    int                  retval = -1;
+    struct rpc_pipeline *rp;
+    int                  i;
+    struct timeval       t0;
+
+    if ((rp = rpc_pipeline_get(h)) == NULL ||
+        id == 0 || id > rp->rp_sent){
+        clixon_err(OE_PROTO, EINVAL, "No request with id %u", id);
+        goto done;
+    }
+    gettimeofday(&t0, NULL);
+    while (rp->rp_rcvd < id)
+        if (rpc_pipeline_rcv(h, rp) < 0){
+            if (rp->rp_s == clicon_client_socket_get(h)){
+                close(rp->rp_s);
+                clicon_client_socket_set(h, -1);
+            }
+            rpc_pipeline_free(h);
+            goto done;
+        }
+    rpc_stats_add(&t0);
+    for (i=0; i<rp->rp_len; i++)
+        if (rp->rp_ids[i] == id)
+            break;
+    if (i == rp->rp_len){
+        clixon_err(OE_PROTO, EINVAL, "Reply of request %u already read", id);
+        goto done;
+    }
+    if (xret0)
+        *xret0 = rp->rp_xrets[i];
+    else if (rp->rp_xrets[i])
+        xml_free(rp->rp_xrets[i]);
+    rp->rp_len--;
+    memmove(&rp->rp_ids[i], &rp->rp_ids[i+1], (rp->rp_len-i)*sizeof(*rp->rp_ids));
+    memmove(&rp->rp_xrets[i], &rp->rp_xrets[i+1], (rp->rp_len-i)*sizeof(*rp->rp_xrets));
+    /* Free state when all replies are read */
+    if (rp->rp_len == 0 && rp->rp_rcvd == rp->rp_sent)
+        rpc_pipeline_free(h);
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Asynchronous request waiting for its reply
+ */
+struct rpc_async_req {
+    qelem_t              ar_qelem;  /* List header */
+    clicon_rpc_async_cb *ar_fn;     /* Reply callback, NULL if cancelled */
+    void                *ar_arg;    /* Argument of reply callback */
+};
+
+/*! Backend connection of asynchronous requests
+ *
+ * Each connection has a backend session of its own. The backend replies to the requests
+ * of a session in the order they are received, so replies are matched to requests by order.
+ * @see clicon_rpc_msg_async
+ */
+struct rpc_async_conn {
+    clixon_handle         ac_h;     /* Clixon handle */
+    int                   ac_s;     /* Socket to backend, -1 if not connected */
+    int                   ac_len;   /* Nr of requests waiting for reply */
+    struct rpc_async_req *ac_reqs;  /* Requests waiting for reply, in the order sent */
+};
+
+/*! Get backend connections of asynchronous requests, create them if not found
+ *
+ * @param[in]  h    Clixon handle
+ * @retval     acv  Vector of RPC_ASYNC_CONNECTIONS connections
+ * @retval     NULL Error
+ */
+static struct rpc_async_conn *
+rpc_async_get(clixon_handle h)
+{
+    void                  *p = NULL;
+    struct rpc_async_conn *acv;
+    int                    i;
+
+    if (clicon_ptr_get(h, "rpc-async", &p) == 0 && p != NULL)
+        return (struct rpc_async_conn *)p;
+    if ((acv = calloc(RPC_ASYNC_CONNECTIONS, sizeof(*acv))) == NULL){
+        clixon_err(OE_UNIX, errno, "calloc");
+        return NULL;
+    }
+    for (i=0; i<RPC_ASYNC_CONNECTIONS; i++){
+        acv[i].ac_h = h;
+        acv[i].ac_s = -1;
+    }
+    if (clicon_ptr_set(h, "rpc-async", acv) < 0){
+        free(acv);
+        return NULL;
+    }
+    return acv;
+}
+
+static int rpc_async_cb(int s, void *arg);
+
+/*! Close backend connection of asynchronous requests and fail its waiting requests
+ *
+ * The callbacks of the waiting requests are called with xret NULL
+ * @param[in]  ac   Backend connection
+ * @retval     0    OK
+ * @retval    -1    Error in a callback
+ */
+static int
+rpc_async_close(struct rpc_async_conn *ac)
+{
+    int                   retval = 0;
+    struct rpc_async_req *ar;
+
+    if (ac->ac_s != -1){
+        clixon_event_unreg_fd(ac->ac_s, rpc_async_cb);
+        close(ac->ac_s);
+        ac->ac_s = -1;
+    }
+    while ((ar = ac->ac_reqs) != NULL){
+        DELQ(ar, ac->ac_reqs, struct rpc_async_req *);
+        ac->ac_len--;
+        if (ar->ar_fn && ar->ar_fn(ac->ac_h, NULL, ar->ar_arg) < 0)
+            retval = -1;
+        free(ar);
+    }
+    return retval;
+}
+
+/*! Receive replies of asynchronous requests and call their callbacks
+ *
+ * Registered in the event loop for each backend connection of asynchronous requests.
+ * @param[in]  s    Socket to backend
+ * @param[in]  arg  Backend connection
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+rpc_async_cb(int   s,
+             void *arg)
+{
+    int                    retval = -1;
+    struct rpc_async_conn *ac = (struct rpc_async_conn *)arg;
+    struct rpc_async_req  *ar;
+    cbuf                  *cbrcv = NULL;
+    cxobj                 *xret = NULL;
+    int                    eof = 0;
+
+    do {
+        if (clixon_msg_rcv11(s, clicon_sock_str(ac->ac_h), 0, &cbrcv, &eof) < 0 ||
+            eof ||
+            (ar = ac->ac_reqs) == NULL ||
+            (cbrcv && rpc_reply_parse(ac->ac_h, cbrcv, &xret) < 0)){
+            if (eof)
+                clixon_err(OE_PROTO, ESHUTDOWN, "Unexpected close of CLICON_SOCK. Clixon backend daemon may have crashed.");
+            else if (ac->ac_reqs == NULL)
+                clixon_err(OE_PROTO, EINVAL, "Unexpected reply from backend");
+            retval = rpc_async_close(ac);
+            goto done;
+        }
+        DELQ(ar, ac->ac_reqs, struct rpc_async_req *);
+        ac->ac_len--;
+        if (ar->ar_fn && ar->ar_fn(ac->ac_h, xret, ar->ar_arg) < 0){
+            free(ar);
+            goto done;
+        }
+        free(ar);
+        if (xret){
+            xml_free(xret);
+            xret = NULL;
+        }
+        if (cbrcv){
+            cbuf_free(cbrcv);
+            cbrcv = NULL;
+        }
+    } while (ac->ac_s == s && clixon_msg_pending(s));
+    retval = 0;
+ done:
+    if (xret)
+        xml_free(xret);
+    if (cbrcv)
+        cbuf_free(cbrcv);
+    return retval;
+}
+
+/*! Send internal netconf rpc from client to backend and call a callback when the reply arrives
+ *
+ * The request is sent on the least loaded of RPC_ASYNC_CONNECTIONS backend connections,
+ * each with a backend session of its own, not on the cached socket of clicon_rpc_msg.
+ * The reply is received from the event loop, which thereby is not blocked while the
+ * backend serves the request.
+ * The callback is called with the rpc-reply, which it should not free, or with xret
+ * NULL if the connection to the backend is lost or the request is cancelled.
+ * @param[in]  h      Clixon handle
+ * @param[in]  cbsend NETCONF Message buffer
+ * @param[in]  fn     Reply callback
+ * @param[in]  arg    Argument of reply callback
+ * @retval     0      OK
+ * @retval    -1      Error, callback is not called
+ * @see clicon_rpc_async_cancel
+ */
+int
+clicon_rpc_msg_async(clixon_handle        h,
+                     cbuf                *cbsend,
+                     clicon_rpc_async_cb *fn,
+                     void                *arg)
+{
+    int                    retval = -1;
+    struct rpc_async_conn *acv;
+    struct rpc_async_conn *ac = NULL;
+    struct rpc_async_req  *ar = NULL;
+    int                    i;
+
+    if ((acv = rpc_async_get(h)) == NULL)
+        goto done;
+    for (i=0; i<RPC_ASYNC_CONNECTIONS; i++)
+        if (ac == NULL || acv[i].ac_len < ac->ac_len)
+            ac = &acv[i];
+    if (ac->ac_s == -1){
+        if (rpc_connect_hello(h, &ac->ac_s) < 0)
+            goto done;
+        if (clixon_event_reg_fd(ac->ac_s, rpc_async_cb, ac, "backend async reply") < 0){
+            close(ac->ac_s);
+            ac->ac_s = -1;
+            goto done;
+        }
+    }
+    if ((ar = calloc(1, sizeof(*ar))) == NULL){
+        clixon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    ar->ar_fn = fn;
+    ar->ar_arg = arg;
+    if (clixon_msg_send11(ac->ac_s, clicon_sock_str(h), cbsend) < 0){
+        rpc_async_close(ac);
+        goto done;
+    }
+    ADDQ(ar, ac->ac_reqs);
+    ac->ac_len++;
+    ar = NULL;
+    retval = 0;
+ done:
+    if (ar)
+        free(ar);
+    return retval;
+}
+
+/*! Cancel asynchronous requests with a callback argument
+ *
+ * The callback is called with xret NULL and is not called when the reply arrives.
+ * @param[in]  h    Clixon handle
+ * @param[in]  arg  Argument of reply callback
+ * @retval     0    OK
+ * @retval    -1    Error in callback
+ */
+int
+clicon_rpc_async_cancel(clixon_handle h,
+                        void         *arg)
+{
+    int                    retval = 0;
+    void                  *p = NULL;
+    struct rpc_async_conn *acv;
+    struct rpc_async_req  *ar;
+    clicon_rpc_async_cb   *fn;
+    int                    i;
+
+    if (clicon_ptr_get(h, "rpc-async", &p) < 0 || p == NULL)
+        return 0;
+    acv = (struct rpc_async_conn *)p;
+    for (i=0; i<RPC_ASYNC_CONNECTIONS; i++){
+        if ((ar = acv[i].ac_reqs) == NULL)
+            continue;
+        do {
+            if (ar->ar_fn && ar->ar_arg == arg){
+                fn = ar->ar_fn;
+                ar->ar_fn = NULL;
+                if (fn(h, NULL, arg) < 0)
+                    retval = -1;
+            }
+            ar = NEXTQ(struct rpc_async_req *, ar);
+        } while (ar && ar != acv[i].ac_reqs);
+    }
+    return retval;
+}
+
+/*! Close backend connections of asynchronous requests
+ *
+ * Waiting requests are cancelled
+ * @param[in]  h    Clixon handle
+ * @retval     0    OK
+ * @retval    -1    Error in callback
+ */
+int
+clicon_rpc_async_exit(clixon_handle h)
+{
+    int                    retval = 0;
+    void                  *p = NULL;
+    struct rpc_async_conn *acv;
+    int                    i;
+
+    if (clicon_ptr_get(h, "rpc-async", &p) < 0 || p == NULL)
+        return 0;
+    acv = (struct rpc_async_conn *)p;
+    for (i=0; i<RPC_ASYNC_CONNECTIONS; i++)
+        if (rpc_async_close(&acv[i]) < 0)
+            retval = -1;
+    free(acv);
+    clicon_ptr_set(h, "rpc-async", NULL);
+    return retval;
+}
+
 /*! Check if there is a valid (cached) session-id. If not, send a hello request to backend
  *
  * Session-ids survive TCP sessions that are created for each message sent to the backend.
@@ -549,6 +1179,121 @@ clicon_rpc_netconf_xml(clixon_handle  h,
     return retval;
 }
 
+/*! Send netconf rpc given as a head and the rest of the message, without copying the rest
+ *
+ * The message is sent in two chunks, eg when the start tag of a large incoming message is
+ * modified and the rest is passed through as is.
+ * @param[in]  h     Clixon handle
+ * @param[in]  head  Start of message, eg rpc start tag
+ * @param[in]  body  Rest of message
+ * @param[in]  len   Length of body
+ * @param[out] xret  Return XML netconf tree, error or OK (need to be freed)
+ * @retval     0     OK
+ * @retval    -1     Error
+ * @see clicon_rpc_netconf  Message as a single string
+ */
+int
+clicon_rpc_netconf_split(clixon_handle h,
+                         const char   *head,
+                         const char   *body,
+                         size_t        len,
+                         cxobj       **xret)
+{
+    int      retval = -1;
+    int      s = -1;
+    uint32_t session_id;
+    cbuf    *cbrcv = NULL;
+    int      eof = 0;
+
+    if (session_id_check(h, &session_id) < 0)
+        goto done;
+    if ((s = clicon_client_socket_get(h)) < 0){
+        if (rpc_connect_hello(h, &s) < 0)
+            goto done;
+    }
+    else if (rpc_pipeline_drain(h, s) < 0){
+        close(s); s = -1;
+        goto done;
+    }
+    clixon_debug(CLIXON_DBG_MSG, "Send [%s] %zu bytes", head, strlen(head) + len);
+    if (clixon_msg_send11_chunk(s, head, strlen(head), 0) < 0 ||
+        clixon_msg_send11_chunk(s, body, len, 1) < 0){
+        close(s); s = -1;
+        goto done;
+    }
+    if (clixon_msg_rcv11(s, clicon_sock_str(h), 0, &cbrcv, &eof) < 0){
+        close(s); s = -1;
+        goto done;
+    }
+    if (eof){
+        clixon_err(OE_PROTO, ESHUTDOWN, "Unexpected close of CLICON_SOCK. Clixon backend daemon may have crashed.");
+        close(s); s = -1;
+        goto done;
+    }
+    if (cbrcv && rpc_reply_parse(h, cbrcv, xret) < 0)
+        goto done;
+    retval = 0;
+ done:
+    clicon_client_socket_set(h, s);
+    if (cbrcv)
+        cbuf_free(cbrcv);
+    return retval;
+}
+
+/*! Send netconf rpc and relay the reply from the backend as it arrives
+ *
+ * The reply is neither reassembled nor parsed, its data is passed to a callback in the
+ * order it is received, eg to write it to a client while the rest is being read.
+ * @param[in]  h       Clixon handle
+ * @param[in]  xmlstr  XML netconf rpc as string
+ * @param[in]  fn      Called with each span of reply data
+ * @param[in]  arg     Argument to fn
+ * @retval     0       OK
+ * @retval    -1       Error
+ * @see clicon_rpc_netconf  Reply parsed as XML tree
+ */
+int
+clicon_rpc_netconf_relay(clixon_handle        h,
+                         const char          *xmlstr,
+                         clixon_msg_relay_cb *fn,
+                         void                *arg)
+{
+    int      retval = -1;
+    int      s = -1;
+    uint32_t session_id;
+    int      eof = 0;
+
+    if (session_id_check(h, &session_id) < 0)
+        goto done;
+    if ((s = clicon_client_socket_get(h)) < 0){
+        if (rpc_connect_hello(h, &s) < 0)
+            goto done;
+    }
+    else if (rpc_pipeline_drain(h, s) < 0){
+        close(s); s = -1;
+        goto done;
+    }
+    clixon_debug(CLIXON_DBG_MSG, "Send [%s] %s", clicon_sock_str(h), xmlstr);
+    if (clixon_msg_send11_chunk(s, xmlstr, strlen(xmlstr), 1) < 0){
+        close(s); s = -1;
+        goto done;
+    }
+    /* Socket is in the middle of a message if relay fails */
+    if (clixon_msg_rcv11_relay(s, clicon_sock_str(h), fn, arg, &eof) < 0){
+        close(s); s = -1;
+        goto done;
+    }
+    if (eof){
+        clixon_err(OE_PROTO, ESHUTDOWN, "Unexpected close of CLICON_SOCK. Clixon backend daemon may have crashed.");
+        close(s); s = -1;
+        goto done;
+    }
+    retval = 0;
+ done:
+    clicon_client_socket_set(h, s);
+    return retval;
+}
+
 /*! Get database configuration
  *
  * Same as clicon_proto_change just with a cvec instead of lvec
@@ -647,7 +1392,7 @@ clixon_rpc_get_config1(clixon_handle h,
     else{
         if (xml_bind_special(xd, yspec, "/nc:get-config/output/data") < 0)
             goto done;
-        if (yb != YB_NONE){
+        if (yb != YB_NONE && !reply_data_bound(xd)){
             if ((ret = xml_bind_yang(h, xd, yb, yspec, 0, &xerr)) < 0)
                 goto done;
             if (ret == 0){
@@ -707,17 +1452,135 @@ clixon_rpc_get_config1(clixon_handle h,
  * @endcode
  */
 int
-clicon_rpc_edit_config(clixon_handle       h,
-                       char               *db,
-                       enum operation_type op,
-                       char               *xmlstr)
+clicon_rpc_edit_config(clixon_handle       h,
+                       char               *db,
+                       enum operation_type op,
+                       char               *xmlstr)
+{
+    int      retval = -1;
+    cbuf    *cb = NULL;
+    cxobj   *xret = NULL;
+    cxobj   *xerr;
+    char    *username;
+    uint32_t session_id;
+
+    if (session_id_check(h, &session_id) < 0)
+        goto done;
+    if ((cb = cbuf_new()) == NULL){
+        clixon_err(OE_XML, errno, "cbuf_new");
+        goto done;
+    }
+    cprintf(cb, "<rpc xmlns=\"%s\"", NETCONF_BASE_NAMESPACE);
+    cprintf(cb, " xmlns:%s=\"%s\"", NETCONF_BASE_PREFIX, NETCONF_BASE_NAMESPACE);
+    if ((username = clicon_username_get(h)) != NULL){
+        cprintf(cb, " %s:username=\"%s\"", CLIXON_LIB_PREFIX, username);
+        cprintf(cb, " xmlns:%s=\"%s\"", CLIXON_LIB_PREFIX, CLIXON_LIB_NS);
+    }
+    cprintf(cb, " %s", NETCONF_MESSAGE_ID_ATTR); /* XXX: use incrementing sequence */
+    cprintf(cb, "><edit-config><target><%s/></target>", db);
+    cprintf(cb, "<default-operation>%s</default-operation>",
+            xml_operation2str(op));
+    if (xmlstr)
+        cprintf(cb, "%s", xmlstr);
+    cprintf(cb, "</edit-config></rpc>");
+    if (clicon_rpc_msg(h, cb, &xret) < 0)
+        goto done;
+    if ((xerr = xpath_first(xret, NULL, "//rpc-error")) != NULL){
+        clixon_err_netconf(h, OE_NETCONF, 0, xerr, "Editing configuration");
+        goto done;
+    }
+    retval = 0;
+  done:
+    if (xret)
+        xml_free(xret);
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+}
+
+/*! Send database entries as XML to backend daemon without waiting for the reply
+ *
+ * Several edits may be sent before their replies are read, which saves one round-trip
+ * per edit. The backend applies them in order.
+ * @param[in]  h       Clixon handle
+ * @param[in]  db      Name of database
+ * @param[in]  op      Operation on database item: OP_MERGE, OP_REPLACE
+ * @param[in]  xmlstr  XML string with <config> as top element
+ * @param[out] id      Request id, read reply with clicon_rpc_msg_recv
+ * @retval     0       OK
+ * @retval    -1       Error and logged to syslog
+ * @see clicon_rpc_edit_config  Synchronous edit
+ */
+int
+clicon_rpc_edit_config_send(clixon_handle       h,
+                            char               *db,
+                            enum operation_type op,
+                            char               *xmlstr,
+                            uint32_t           *id)
+{
+    int      retval = -1;
+    cbuf    *cb = NULL;
+    char    *username;
+    uint32_t session_id;
+
+    if (session_id_check(h, &session_id) < 0)
+        goto done;
+    if ((cb = cbuf_new()) == NULL){
+        clixon_err(OE_XML, errno, "cbuf_new");
+        goto done;
+    }
+    cprintf(cb, "<rpc xmlns=\"%s\"", NETCONF_BASE_NAMESPACE);
+    cprintf(cb, " xmlns:%s=\"%s\"", NETCONF_BASE_PREFIX, NETCONF_BASE_NAMESPACE);
+    if ((username = clicon_username_get(h)) != NULL){
+        cprintf(cb, " %s:username=\"%s\"", CLIXON_LIB_PREFIX, username);
+        cprintf(cb, " xmlns:%s=\"%s\"", CLIXON_LIB_PREFIX, CLIXON_LIB_NS);
+    }
+    cprintf(cb, " %s", NETCONF_MESSAGE_ID_ATTR); /* XXX: use incrementing sequence */
+    cprintf(cb, "><edit-config><target><%s/></target>", db);
+    cprintf(cb, "<default-operation>%s</default-operation>",
+            xml_operation2str(op));
+    if (xmlstr)
+        cprintf(cb, "%s", xmlstr);
+    cprintf(cb, "</edit-config></rpc>");
+    if (clicon_rpc_msg_send(h, cb, id) < 0)
+        goto done;
+    retval = 0;
+  done:
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+}
+
+/*! Send edit-config with config read from a file without parsing it
+ *
+ * The file is sent from its current position to end-of-file in chunks of BUFSIZ bytes as
+ * they are read, so that neither the file nor the message is held in memory.
+ * The file should contain a <config> element.
+ * @param[in]  h        Clixon handle
+ * @param[in]  db       Name of database
+ * @param[in]  op       Operation on database item: OP_MERGE, OP_REPLACE
+ * @param[in]  fp       Open file positioned at the config element
+ * @retval     0        OK
+ * @retval    -1        Error and logged to syslog
+ * @see clicon_rpc_edit_config  Config given as string
+ */
+int
+clicon_rpc_edit_config_file(clixon_handle       h,
+                            char               *db,
+                            enum operation_type op,
+                            FILE               *fp)
 {
     int      retval = -1;
+    int      s = -1;
     cbuf    *cb = NULL;
+    cbuf    *cbrcv = NULL;
     cxobj   *xret = NULL;
     cxobj   *xerr;
     char    *username;
     uint32_t session_id;
+    char     buf[BUFSIZ];
+    size_t   len;
+    int      eof = 0;
 
     if (session_id_check(h, &session_id) < 0)
         goto done;
@@ -735,19 +1598,57 @@ clicon_rpc_edit_config(clixon_handle       h,
     cprintf(cb, "><edit-config><target><%s/></target>", db);
     cprintf(cb, "<default-operation>%s</default-operation>",
             xml_operation2str(op));
-    if (xmlstr)
-        cprintf(cb, "%s", xmlstr);
-    cprintf(cb, "</edit-config></rpc>");
-    if (clicon_rpc_msg(h, cb, &xret) < 0)
+    if ((s = clicon_client_socket_get(h)) < 0){
+        if (rpc_connect_hello(h, &s) < 0)
+            goto done;
+    }
+    else if (rpc_pipeline_drain(h, s) < 0){
+        close(s); s = -1;
+        goto done;
+    }
+    clixon_debug(CLIXON_DBG_MSG, "Send [%s] %s<file>", clicon_sock_str(h), cbuf_get(cb));
+    if (clixon_msg_send11_chunk(s, cbuf_get(cb), cbuf_len(cb), 0) < 0){
+        close(s); s = -1;
+        goto done;
+    }
+    /* Socket is in the middle of a message if a send fails */
+    while ((len = fread(buf, 1, sizeof(buf), fp)) > 0){
+        if (clixon_msg_send11_chunk(s, buf, len, 0) < 0){
+            close(s); s = -1;
+            goto done;
+        }
+    }
+    if (ferror(fp)){
+        clixon_err(OE_UNIX, errno, "fread");
+        close(s); s = -1;
+        goto done;
+    }
+    if (clixon_msg_send11_chunk(s, "</edit-config></rpc>", strlen("</edit-config></rpc>"), 1) < 0){
+        close(s); s = -1;
+        goto done;
+    }
+    if (clixon_msg_rcv11(s, clicon_sock_str(h), 0, &cbrcv, &eof) < 0){
+        close(s); s = -1;
+        goto done;
+    }
+    if (eof){
+        clixon_err(OE_PROTO, ESHUTDOWN, "Unexpected close of CLICON_SOCK. Clixon backend daemon may have crashed.");
+        close(s); s = -1;
+        goto done;
+    }
+    if (cbrcv && rpc_reply_parse(h, cbrcv, &xret) < 0)
         goto done;
     if ((xerr = xpath_first(xret, NULL, "//rpc-error")) != NULL){
         clixon_err_netconf(h, OE_NETCONF, 0, xerr, "Editing configuration");
         goto done;
     }
     retval = 0;
-  done:
+ done:
+    clicon_client_socket_set(h, s);
     if (xret)
         xml_free(xret);
+    if (cbrcv)
+        cbuf_free(cbrcv);
     if (cb)
         cbuf_free(cb);
     return retval;
@@ -961,72 +1862,30 @@ clicon_rpc_unlock(clixon_handle h,
     return retval;
 }
 
-/*! Get database configuration and state data (please use instead of clicon_rpc_get)
- *
- * @param[in]  h         Clixon handle
- * @param[in]  xpath     XPath in a filter stmt (or NULL/"" for no filter)
- * @param[in]  namespace Namespace associated w xpath
- * @param[in]  nsc       Namespace context for filter
- * @param[in]  content   Clixon extension: all, config, noconfig. -1 means all
- * @param[in]  depth     Nr of XML levels to get, -1 is all, 0 is none
- * @param[in]  defaults  Value of the with-defaults mode, rfc6243, or NULL
- * @param[in]  yb        Automatic yang bind: YB_MODULE or none: YB_NONE
- * @param[out] xt        XML tree. Free with xml_free.
- *                       Either <config> or <rpc-reply><rpc-error>.
- * @retval     0         OK
- * @retval    -1         Error, fatal or xml
- * @note if xpath is set but namespace is NULL, the default, netconf base
- *       namespace will be used which is most probably wrong.
- * @code
- *  cxobj *xt = NULL;
- *  cvec *nsc = NULL;
+/*! Create get request message
  *
- *  if ((nsc = xml_nsctx_init(NULL, "urn:example:hello")) == NULL)
- *     err;
- *  if (clicon_rpc_get(h, "/hello/world", nsc, CONTENT_ALL, -1, &xt) < 0)
- *     err;
- *  if ((xerr = xpath_first(xt, NULL, "/rpc-error")) != NULL){
- *     clixon_err_netconf(h, OE_NETCONF, 0, xerr, "Get configuration");
- *     err;
- *  }
- *  if (xt)
- *     xml_free(xt);
- *  if (nsc)
- *     xml_nsctx_free(nsc);
- * @endcode
- * @see clixon_rpc_get_config1 which is almost the same as with content=config, but you can also select dbname
- * @see clixon_err_netconf
- * @note the netconf return message is yang populated, as well as the return data
+ * @param[in]  h        Clixon handle
+ * @param[in]  xpath    XPath in a filter stmt (or NULL/"" for no filter)
+ * @param[in]  nsc      Namespace context for filter
+ * @param[in]  content  Clixon extension: all, config, noconfig. -1 means all
+ * @param[in]  depth    Nr of XML levels to get, -1 is all, 0 is none
+ * @param[in]  defaults Value of the with-defaults parameter
+ * @param[out] cb       Request message
+ * @retval     0        OK
+ * @retval    -1        Error
  */
-int
-clixon_rpc_get1(clixon_handle   h,
-                char           *xpath,
-                cvec           *nsc, /* namespace context for filter */
-                netconf_content content,
-                int32_t         depth,
-                char           *defaults,
-                yang_bind       yb,
-                cxobj         **xt)
+static int
+rpc_get_msg(clixon_handle   h,
+            char           *xpath,
+            cvec           *nsc,
+            netconf_content content,
+            int32_t         depth,
+            char           *defaults,
+            cbuf           *cb)
 {
-    int        retval = -1;
-    cbuf      *cb = NULL;
-    cxobj     *xret = NULL;
-    cxobj     *xerr = NULL;
-    cxobj     *xd = NULL;
-    char      *username;
-    uint32_t   session_id;
-    yang_stmt *yspec;
-    cvec      *nscd = NULL;
-    int        xdnew = 0;
-    int        ret;
+    int   retval = -1;
+    char *username;
 
-    clixon_debug(CLIXON_DBG_DEFAULT | CLIXON_DBG_DETAIL, "");
-    if (session_id_check(h, &session_id) < 0)
-        goto done;
-    if ((cb = cbuf_new()) == NULL){
-        clixon_err(OE_XML, errno, "cbuf_new");
-        goto done;
-    }
     cprintf(cb, "<rpc xmlns=\"%s\"", NETCONF_BASE_NAMESPACE);
     cprintf(cb, " xmlns:%s=\"%s\"", NETCONF_BASE_PREFIX, NETCONF_BASE_NAMESPACE);
     if ((username = clicon_username_get(h)) != NULL){
@@ -1064,8 +1923,37 @@ clixon_rpc_get1(clixon_handle   h,
                 IETF_NETCONF_WITH_DEFAULTS_YANG_NAMESPACE,
                 defaults);
     cprintf(cb, "</get></rpc>");
-    if (clicon_rpc_msg(h, cb, &xret) < 0)
-        goto done;
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Get data or error from the reply of a get request
+ *
+ * @param[in]  h     Clixon handle
+ * @param[in]  xret  Reply from backend, rpc-reply
+ * @param[in]  yb    How to bind yang to XML top-level when parsing (if YB_NONE, no duplicate check)
+ * @param[out] xt    XML tree. Free with xml_free.
+ *                   Either <config> or <rpc-error>.
+ * @retval     0     OK
+ * @retval    -1     Error, fatal or xml
+ * @see clixon_rpc_get1
+ * @see clixon_rpc_get_async
+ */
+int
+clixon_rpc_get_reply(clixon_handle h,
+                     cxobj        *xret,
+                     yang_bind     yb,
+                     cxobj       **xt)
+{
+    int        retval = -1;
+    cxobj     *xerr = NULL;
+    cxobj     *xd = NULL;
+    yang_stmt *yspec;
+    cvec      *nscd = NULL;
+    int        xdnew = 0;
+    int        ret;
+
     yspec = clicon_dbspec_yang(h);
     /* Send xml error back: first check error, then ok */
     if ((xd = xpath_first(xret, NULL, "/rpc-reply/rpc-error")) != NULL)
@@ -1080,7 +1968,7 @@ clixon_rpc_get1(clixon_handle   h,
     else{
         if (xml_bind_special(xd, yspec, "/nc:get/output/data") < 0)
             goto done;
-        if (yb != YB_NONE){
+        if (yb != YB_NONE && !reply_data_bound(xd)){
             if ((ret = xml_bind_yang(h, xd, yb, yspec, 0, &xerr)) < 0)
                 goto done;
             if (ret == 0){
@@ -1090,6 +1978,7 @@ clixon_rpc_get1(clixon_handle   h,
                     goto done;
                 xd = xerr;
                 xerr = NULL;
+                xdnew++;
             }
         }
     }
@@ -1107,23 +1996,138 @@ clixon_rpc_get1(clixon_handle   h,
     }
     retval = 0;
   done:
-    clixon_debug(CLIXON_DBG_DEFAULT | CLIXON_DBG_DETAIL, "retval:%d", retval);
     if (nscd)
         cvec_free(nscd);
-    if (cb)
-        cbuf_free(cb);
     if (xerr)
         xml_free(xerr);
-    if (xret)
-        xml_free(xret);
     if (xdnew && xd)
         xml_free(xd);
     return retval;
 }
 
+/*! Get database configuration and state data (please use instead of clicon_rpc_get)
+ *
+ * @param[in]  h         Clixon handle
+ * @param[in]  xpath     XPath in a filter stmt (or NULL/"" for no filter)
+ * @param[in]  namespace Namespace associated w xpath
+ * @param[in]  nsc       Namespace context for filter
+ * @param[in]  content   Clixon extension: all, config, noconfig. -1 means all
+ * @param[in]  depth     Nr of XML levels to get, -1 is all, 0 is none
+ * @param[in]  defaults  Value of the with-defaults mode, rfc6243, or NULL
+ * @param[in]  yb        Automatic yang bind: YB_MODULE or none: YB_NONE
+ * @param[out] xt        XML tree. Free with xml_free.
+ *                       Either <config> or <rpc-reply><rpc-error>.
+ * @retval     0         OK
+ * @retval    -1         Error, fatal or xml
+ * @note if xpath is set but namespace is NULL, the default, netconf base
+ *       namespace will be used which is most probably wrong.
+ * @code
+ *  cxobj *xt = NULL;
+ *  cvec *nsc = NULL;
+ *
+ *  if ((nsc = xml_nsctx_init(NULL, "urn:example:hello")) == NULL)
+ *     err;
+ *  if (clicon_rpc_get(h, "/hello/world", nsc, CONTENT_ALL, -1, &xt) < 0)
+ *     err;
+ *  if ((xerr = xpath_first(xt, NULL, "/rpc-error")) != NULL){
+ *     clixon_err_netconf(h, OE_NETCONF, 0, xerr, "Get configuration");
+ *     err;
+ *  }
+ *  if (xt)
+ *     xml_free(xt);
+ *  if (nsc)
+ *     xml_nsctx_free(nsc);
+ * @endcode
+ * @see clixon_rpc_get_config1 which is almost the same as with content=config, but you can also select dbname
+ * @see clixon_err_netconf
+ * @note the netconf return message is yang populated, as well as the return data
+ */
+int
+clixon_rpc_get1(clixon_handle   h,
+                char           *xpath,
+                cvec           *nsc, /* namespace context for filter */
+                netconf_content content,
+                int32_t         depth,
+                char           *defaults,
+                yang_bind       yb,
+                cxobj         **xt)
+{
+    int        retval = -1;
+    cbuf      *cb = NULL;
+    cxobj     *xret = NULL;
+    uint32_t   session_id;
+
+    clixon_debug(CLIXON_DBG_DEFAULT | CLIXON_DBG_DETAIL, "");
+    if (session_id_check(h, &session_id) < 0)
+        goto done;
+    if ((cb = cbuf_new()) == NULL){
+        clixon_err(OE_XML, errno, "cbuf_new");
+        goto done;
+    }
+    if (rpc_get_msg(h, xpath, nsc, content, depth, defaults, cb) < 0)
+        goto done;
+    if (clicon_rpc_msg(h, cb, &xret) < 0)
+        goto done;
+    if (clixon_rpc_get_reply(h, xret, yb, xt) < 0)
+        goto done;
+    retval = 0;
+  done:
+    clixon_debug(CLIXON_DBG_DEFAULT | CLIXON_DBG_DETAIL, "retval:%d", retval);
+    if (cb)
+        cbuf_free(cb);
+    if (xret)
+        xml_free(xret);
+    return retval;
+}
+
+/*! Send a get request to the backend and call a callback when the reply arrives
+ *
+ * Asynchronous variant of clixon_rpc_get1. The callback gets the rpc-reply, from which
+ * data or error is taken with clixon_rpc_get_reply.
+ * @param[in]  h        Clixon handle
+ * @param[in]  xpath    XPath in a filter stmt (or NULL/"" for no filter)
+ * @param[in]  nsc      Namespace context for filter
+ * @param[in]  content  Clixon extension: all, config, noconfig. -1 means all
+ * @param[in]  depth    Nr of XML levels to get, -1 is all, 0 is none
+ * @param[in]  defaults Value of the with-defaults parameter
+ * @param[in]  fn       Reply callback
+ * @param[in]  arg      Argument of reply callback
+ * @retval     0        OK
+ * @retval    -1        Error, callback is not called
+ * @see clicon_rpc_msg_async
+ */
+int
+clixon_rpc_get_async(clixon_handle        h,
+                     char                *xpath,
+                     cvec                *nsc,
+                     netconf_content      content,
+                     int32_t              depth,
+                     char                *defaults,
+                     clicon_rpc_async_cb *fn,
+                     void                *arg)
+{
+    int   retval = -1;
+    cbuf *cb = NULL;
+
+    if ((cb = cbuf_new()) == NULL){
+        clixon_err(OE_XML, errno, "cbuf_new");
+        goto done;
+    }
+    if (rpc_get_msg(h, xpath, nsc, content, depth, defaults, cb) < 0)
+        goto done;
+    if (clicon_rpc_msg_async(h, cb, fn, arg) < 0)
+        goto done;
+    retval = 0;
+ done:
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+}
+
 /*! Get database configuration and state data collection
  *
  * @param[in]  h         Clixon handle
+ * @param[in]  datastore running, or other datastore using get-config
  * @param[in]  xpath     To identify a list/leaf-list
  * @param[in]  namespace Namespace associated w xpath
  * @param[in]  nsc       Namespace context for filter
@@ -1135,6 +2139,7 @@ clixon_rpc_get1(clixon_handle   h,
  * @param[in]  direction Collection/clixon extension
  * @param[in]  sort      Collection/clixon extension
  * @param[in]  where     Collection/clixon extension
+ * @param[in]  cursor    Opaque cursor from "next" annotation of previous page, or NULL
  * @param[out] xt        XML tree. Free with xml_free.
  *                       Either <config> or <rpc-error>.
  * @retval     0         OK
@@ -1156,6 +2161,7 @@ clicon_rpc_get_pageable_list(clixon_handle   h,
                              char           *direction,
                              char           *sort,
                              char           *where,
+                             char           *cursor,
                              cxobj         **xt)
 {
     int        retval = -1;
@@ -1187,9 +2193,13 @@ clicon_rpc_get_pageable_list(clixon_handle   h,
     cprintf(cb, " xmlns:%s=\"%s\"",
             NETCONF_BASE_PREFIX, NETCONF_BASE_NAMESPACE);
     cprintf(cb, " %s", NETCONF_MESSAGE_ID_ATTR);  /* XXX: use incrementing sequence */
-    cprintf(cb, "><get ");
+    /* Other datastores than running only have config */
+    if (strcmp(datastore, "running") != 0)
+        cprintf(cb, "><get-config ");
+    else
+        cprintf(cb, "><get ");
     /* Clixon extension, content=all,config, or nonconfig */
-    if ((int)content != -1)
+    if ((int)content != -1 && strcmp(datastore, "running") == 0)
         cprintf(cb, " %s:content=\"%s\" xmlns:%s=\"%s\"",
                 CLIXON_LIB_PREFIX,
                 netconf_content_int2str(content),
@@ -1202,6 +2212,8 @@ clicon_rpc_get_pageable_list(clixon_handle   h,
                 CLIXON_LIB_PREFIX, CLIXON_LIB_NS);
     /* declare lp prefix in get, so sub-elements dont need to */
     cprintf(cb, ">"); /* get */
+    if (strcmp(datastore, "running") != 0)
+        cprintf(cb, "<source><%s/></source>", datastore);
     /* If xpath, add a filter */
     if (xpath && strlen(xpath)) {
         cprintf(cb, "<%s:filter %s:type=\"xpath\" %s:select=\"",
@@ -1229,8 +2241,17 @@ clicon_rpc_get_pageable_list(clixon_handle   h,
         cprintf(cb, "<sort>%s</sort>", sort);
     if (where)
         cprintf(cb, "<where>%s</where>", where);
+    if (cursor){
+        cprintf(cb, "<cursor>");
+        if (xml_chardata_cbuf_append(cb, 0, cursor) < 0)
+            goto done;
+        cprintf(cb, "</cursor>");
+    }
     cprintf(cb, "</list-pagination>");
-    cprintf(cb, "</get>");
+    if (strcmp(datastore, "running") != 0)
+        cprintf(cb, "</get-config>");
+    else
+        cprintf(cb, "</get>");
     cprintf(cb, "</rpc>");
     if (clicon_rpc_msg(h, cb, &xret) < 0)
         goto done;
@@ -1878,7 +2899,7 @@ clicon_hello_req(clixon_handle h,
     return retval;
 }
 
-/*! Make a clixon cache rpc call from client to backend server
+/*! Send clixon cache rpc from client to backend server and return reply
  *
  * @param[in]     h        Clixon handle
  * @param[in]     op       Operation: read, write, clear
@@ -1889,22 +2910,25 @@ clicon_hello_req(clixon_handle h,
  * @param[in]     revision Yang module revision
  * @param[in]     keyword  Yang node keyword
  * @param[in]     argument Yang argument name
- * @param[out]    data     Cache data
+ * @param[in]     file     Request name of cache file instead of data
+ * @param[out]    xreply   Bound rpc-reply, or NULL. Free xret after use
+ * @param[out]    xret     Reply, free with xml_free
  * @retval        0        OK
  * @retval       -1        Error and logged to syslog
- * @see rpc clixon-cache in clixon-lib.yang
  */
-int
-clixon_rpc_clixon_cache(clixon_handle h,
-                        const char   *op,
-                        const char   *type,
-                        const char   *domain,
-                        const char   *spec,
-                        const char   *module,
-                        const char   *revision,
-                        const char   *keyword,
-                        const char   *argument,
-                        cbuf         *cbdata)
+static int
+clixon_rpc_clixon_cache1(clixon_handle h,
+                         const char   *op,
+                         const char   *type,
+                         const char   *domain,
+                         const char   *spec,
+                         const char   *module,
+                         const char   *revision,
+                         const char   *keyword,
+                         const char   *argument,
+                         int           file,
+                         cxobj       **xreplyp,
+                         cxobj       **xretp)
 {
     int        retval = -1;
     cxobj     *xrpc = NULL;
@@ -1915,13 +2939,13 @@ clixon_rpc_clixon_cache(clixon_handle h,
     uint32_t   session_id;
     cbuf      *cb = NULL;
     yang_stmt *yspec;
-    char      *str;
     int        ret;
 
     if (op == NULL || type == NULL){
         clixon_err(OE_XML, EINVAL, "op or type not given");
         goto done;
     }
+    *xreplyp = NULL;
     yspec = clicon_dbspec_yang(h);
     if (session_id_check(h, &session_id) < 0)
         goto done;
@@ -1952,6 +2976,8 @@ clixon_rpc_clixon_cache(clixon_handle h,
         cprintf(cb, "<keyword>%s</keyword>", keyword);
     if (argument)
         cprintf(cb, "<argument>%s</argument>", argument);
+    if (file)
+        cprintf(cb, "<file>true</file>");
     cprintf(cb, "</clixon-cache>");
     cprintf(cb, "</rpc>");
     /* Create XML from cbuf */
@@ -1980,11 +3006,11 @@ clixon_rpc_clixon_cache(clixon_handle h,
                 xerr = NULL;
             }
         }
-        else{
-            if ((str = xml_find_body(xreply, "data")) != NULL)
-                cbuf_append_str(cbdata, str);
-        }
+        else
+            *xreplyp = xreply;
     }
+    *xretp = xret;
+    xret = NULL;
     retval = 0;
  done:
     if (cb)
@@ -1996,6 +3022,98 @@ clixon_rpc_clixon_cache(clixon_handle h,
     return retval;
 }
 
+/*! Make a clixon cache rpc call from client to backend server
+ *
+ * @param[in]     h        Clixon handle
+ * @param[in]     op       Operation: read, write, clear
+ * @param[in]     type     Cache type: autocli, yang-domain, xmldb
+ * @param[in]     domain   Domain string
+ * @param[in]     spec     Spec name
+ * @param[in]     module   Yang module
+ * @param[in]     revision Yang module revision
+ * @param[in]     keyword  Yang node keyword
+ * @param[in]     argument Yang argument name
+ * @param[out]    data     Cache data
+ * @retval        0        OK
+ * @retval       -1        Error and logged to syslog
+ * @see rpc clixon-cache in clixon-lib.yang
+ */
+int
+clixon_rpc_clixon_cache(clixon_handle h,
+                        const char   *op,
+                        const char   *type,
+                        const char   *domain,
+                        const char   *spec,
+                        const char   *module,
+                        const char   *revision,
+                        const char   *keyword,
+                        const char   *argument,
+                        cbuf         *cbdata)
+{
+    int    retval = -1;
+    cxobj *xret = NULL;
+    cxobj *xreply = NULL;
+    char  *str;
+
+    if (clixon_rpc_clixon_cache1(h, op, type, domain, spec, module, revision, keyword, argument,
+                                 0, &xreply, &xret) < 0)
+        goto done;
+    if (xreply != NULL && (str = xml_find_body(xreply, "data")) != NULL)
+        cbuf_append_str(cbdata, str);
+    retval = 0;
+ done:
+    if (xret)
+        xml_free(xret);
+    return retval;
+}
+
+/*! Make a clixon cache autocli read rpc call returning the name of the cache file
+ *
+ * The backend generates the file if it does not exist. The file is terminated by NUL.
+ * @param[in]     h        Clixon handle
+ * @param[in]     domain   Domain string
+ * @param[in]     spec     Spec name
+ * @param[in]     module   Yang module
+ * @param[in]     revision Yang module revision
+ * @param[in]     keyword  Yang node keyword
+ * @param[in]     argument Yang argument name
+ * @param[out]    filename Name of cache file, or NULL if not returned. Free after use
+ * @retval        0        OK
+ * @retval       -1        Error and logged to syslog
+ * @see clixon_rpc_clixon_cache  Returns the data instead
+ */
+int
+clixon_rpc_clixon_cache_file(clixon_handle h,
+                             const char   *domain,
+                             const char   *spec,
+                             const char   *module,
+                             const char   *revision,
+                             const char   *keyword,
+                             const char   *argument,
+                             char        **filename)
+{
+    int    retval = -1;
+    cxobj *xret = NULL;
+    cxobj *xreply = NULL;
+    char  *str;
+
+    *filename = NULL;
+    if (clixon_rpc_clixon_cache1(h, "read", "autocli", domain, spec, module, revision, keyword, argument,
+                                 1, &xreply, &xret) < 0)
+        goto done;
+    if (xreply != NULL && (str = xml_find_body(xreply, "file")) != NULL){
+        if ((*filename = strdup(str)) == NULL){
+            clixon_err(OE_UNIX, errno, "strdup");
+            goto done;
+        }
+    }
+    retval = 0;
+ done:
+    if (xret)
+        xml_free(xret);
+    return retval;
+}
+
 /*! Make a clixon config-path-info rpc call from client to backend server
  *
  * Note only one of xpath and api-path should be given
@@ -2421,3 +3539,313 @@ clicon_rpc_restart_plugin(clixon_handle h,
         xml_free(xret);
     return retval;
 }
+
+/*! Count nodes selected by an XPath in a datastore of the backend, or check if any exists
+ *
+ * Evaluated by the backend on its datastore cache, no data is copied or sent.
+ * @param[in]  h        Clixon handle
+ * @param[in]  db       Name of datastore: running, candidate or startup
+ * @param[in]  xpath    XPath selecting nodes
+ * @param[in]  nsc      Namespace context of xpath, or NULL
+ * @param[in]  exists   If set, stop at first selected node, count is 0 or 1
+ * @param[out] count    Number of selected nodes
+ * @retval     0        OK
+ * @retval    -1        Error and logged to syslog
+ * @code
+ *   uint32_t count;
+ *   if (clicon_rpc_count(h, "running", "/ex:table/ex:parameter", nsc, 0, &count) < 0)
+ *      err;
+ * @endcode
+ */
+int
+clicon_rpc_count(clixon_handle h,
+                 char         *db,
+                 char         *xpath,
+                 cvec         *nsc,
+                 int           exists,
+                 uint32_t     *count)
+{
+    int      retval = -1;
+    cxobj   *xret = NULL;
+    cxobj   *xerr;
+    char    *username;
+    char    *str;
+    char    *reason = NULL;
+    uint32_t session_id;
+    cbuf    *cb = NULL;
+    cg_var  *cv;
+    int      ret;
+
+    if (session_id_check(h, &session_id) < 0)
+        goto done;
+    if ((cb = cbuf_new()) == NULL){
+        clixon_err(OE_XML, errno, "cbuf_new");
+        goto done;
+    }
+    cprintf(cb, "<rpc xmlns=\"%s\"", NETCONF_BASE_NAMESPACE);
+    cprintf(cb, " xmlns:%s=\"%s\"", NETCONF_BASE_PREFIX, NETCONF_BASE_NAMESPACE);
+    if ((username = clicon_username_get(h)) != NULL){
+        cprintf(cb, " %s:username=\"%s\"", CLIXON_LIB_PREFIX, username);
+        cprintf(cb, " xmlns:%s=\"%s\"", CLIXON_LIB_PREFIX, CLIXON_LIB_NS);
+    }
+    cprintf(cb, " %s", NETCONF_MESSAGE_ID_ATTR); /* XXX: use incrementing sequence */
+    cprintf(cb, ">");
+    cprintf(cb, "<count xmlns=\"%s\">", CLIXON_LIB_NS);
+    cprintf(cb, "<datastore>%s</datastore>", db);
+    cprintf(cb, "<xpath>");
+    if (xml_chardata_cbuf_append(cb, 0, xpath) < 0)
+        goto done;
+    cprintf(cb, "</xpath>");
+    if (nsc && cvec_len(nsc)){
+        cprintf(cb, "<namespace-context>");
+        cv = NULL;
+        while ((cv = cvec_each(nsc, cv)) != NULL) {
+            cprintf(cb, "<namespace>");
+            cprintf(cb, "<prefix>%s</prefix>", cv_name_get(cv)?cv_name_get(cv):"");
+            cprintf(cb, "<ns>%s</ns>", cv_string_get(cv));
+            cprintf(cb, "</namespace>");
+        }
+        cprintf(cb, "</namespace-context>");
+    }
+    if (exists)
+        cprintf(cb, "<exists>true</exists>");
+    cprintf(cb, "</count>");
+    cprintf(cb, "</rpc>");
+    if (clicon_rpc_msg(h, cb, &xret) < 0)
+        goto done;
+    if ((xerr = xpath_first(xret, NULL, "//rpc-error")) != NULL){
+        clixon_err_netconf(h, OE_NETCONF, 0, xerr, "Count");
+        goto done;
+    }
+    if ((str = xml_find_body(xpath_first(xret, NULL, "rpc-reply"), "count")) == NULL){
+        clixon_err(OE_XML, 0, "rpc error: no count in reply");
+        goto done;
+    }
+    if ((ret = parse_uint32(str, count, &reason)) < 0){
+        clixon_err(OE_XML, errno, "parse_uint32");
+        goto done;
+    }
+    if (ret == 0){
+        clixon_err(OE_XML, 0, "count: %s", reason);
+        goto done;
+    }
+    retval = 0;
+ done:
+    if (reason)
+        free(reason);
+    if (cb)
+        cbuf_free(cb);
+    if (xret)
+        xml_free(xret);
+    return retval;
+}
+
+/*! Get generation of a datastore of the backend and when it last may have changed
+ *
+ * No data is read or sent. If the generation is equal to an earlier, the datastore is unchanged.
+ * @param[in]  h        Clixon handle
+ * @param[in]  db       Name of datastore: running, candidate or startup
+ * @param[out] gen      Generation of datastore
+ * @param[out] tv       Time when generation was set
+ * @retval     0        OK
+ * @retval    -1        Error and logged to syslog
+ * @code
+ *   uint64_t       gen;
+ *   struct timeval tv;
+ *   if (clicon_rpc_generation(h, "running", &gen, &tv) < 0)
+ *      err;
+ * @endcode
+ */
+int
+clicon_rpc_generation(clixon_handle   h,
+                      char           *db,
+                      uint64_t       *gen,
+                      struct timeval *tv)
+{
+    int      retval = -1;
+    cxobj   *xret = NULL;
+    cxobj   *xerr;
+    cxobj   *xr;
+    char    *username;
+    char    *str;
+    char    *reason = NULL;
+    uint32_t session_id;
+    cbuf    *cb = NULL;
+    int      ret;
+
+    if (session_id_check(h, &session_id) < 0)
+        goto done;
+    if ((cb = cbuf_new()) == NULL){
+        clixon_err(OE_XML, errno, "cbuf_new");
+        goto done;
+    }
+    cprintf(cb, "<rpc xmlns=\"%s\"", NETCONF_BASE_NAMESPACE);
+    cprintf(cb, " xmlns:%s=\"%s\"", NETCONF_BASE_PREFIX, NETCONF_BASE_NAMESPACE);
+    if ((username = clicon_username_get(h)) != NULL){
+        cprintf(cb, " %s:username=\"%s\"", CLIXON_LIB_PREFIX, username);
+        cprintf(cb, " xmlns:%s=\"%s\"", CLIXON_LIB_PREFIX, CLIXON_LIB_NS);
+    }
+    cprintf(cb, " %s", NETCONF_MESSAGE_ID_ATTR); /* XXX: use incrementing sequence */
+    cprintf(cb, ">");
+    cprintf(cb, "<generation xmlns=\"%s\">", CLIXON_LIB_NS);
+    cprintf(cb, "<datastore>%s</datastore>", db);
+    cprintf(cb, "</generation>");
+    cprintf(cb, "</rpc>");
+    if (clicon_rpc_msg(h, cb, &xret) < 0)
+        goto done;
+    if ((xerr = xpath_first(xret, NULL, "//rpc-error")) != NULL){
+        clixon_err_netconf(h, OE_NETCONF, 0, xerr, "Generation");
+        goto done;
+    }
+    xr = xpath_first(xret, NULL, "rpc-reply");
+    if ((str = xml_find_body(xr, "generation")) == NULL){
+        clixon_err(OE_XML, 0, "rpc error: no generation in reply");
+        goto done;
+    }
+    if ((ret = parse_uint64(str, gen, &reason)) < 0){
+        clixon_err(OE_XML, errno, "parse_uint64");
+        goto done;
+    }
+    if (ret == 0){
+        clixon_err(OE_XML, 0, "generation: %s", reason);
+        goto done;
+    }
+    if ((str = xml_find_body(xr, "last-modified")) == NULL){
+        clixon_err(OE_XML, 0, "rpc error: no last-modified in reply");
+        goto done;
+    }
+    if (str2time(str, tv) < 0){
+        clixon_err(OE_XML, errno, "str2time: %s", str);
+        goto done;
+    }
+    retval = 0;
+ done:
+    if (reason)
+        free(reason);
+    if (cb)
+        cbuf_free(cb);
+    if (xret)
+        xml_free(xret);
+    return retval;
+}
+
+/*! Get keys of list entries or leaf-list values in a datastore of the backend
+ *
+ * Only the keys are sent, not the list entries.
+ * @param[in]  h        Clixon handle
+ * @param[in]  db       Name of datastore: running, candidate or startup
+ * @param[in]  xpath    XPath selecting the first key leaf of a list, or a leaf-list
+ * @param[in]  nsc      Namespace context of xpath, or NULL
+ * @param[in]  prefix   Only keys starting with prefix, or NULL
+ * @param[in]  max      Max number of keys, 0 is unlimited
+ * @param[out] keys     Keys as string variables in datastore order, free with cvec_free
+ * @param[out] more     Set if max was reached and there are more keys, or NULL
+ * @retval     0        OK
+ * @retval    -1        Error and logged to syslog
+ * @code
+ *   cvec *keys = NULL;
+ *   if (clicon_rpc_list_keys(h, "running", "/ex:table/ex:parameter/ex:name", nsc, "a", 0, &keys, NULL) < 0)
+ *      err;
+ *   cvec_free(keys);
+ * @endcode
+ */
+int
+clicon_rpc_list_keys(clixon_handle h,
+                     char         *db,
+                     char         *xpath,
+                     cvec         *nsc,
+                     char         *prefix,
+                     uint32_t      max,
+                     cvec        **keys,
+                     int          *more)
+{
+    int      retval = -1;
+    cxobj   *xret = NULL;
+    cxobj   *xerr;
+    cxobj   *xr;
+    cxobj   *x;
+    char    *username;
+    char    *str;
+    uint32_t session_id;
+    cbuf    *cb = NULL;
+    cvec    *cvv = NULL;
+    cg_var  *cv;
+
+    if (session_id_check(h, &session_id) < 0)
+        goto done;
+    if ((cb = cbuf_new()) == NULL){
+        clixon_err(OE_XML, errno, "cbuf_new");
+        goto done;
+    }
+    cprintf(cb, "<rpc xmlns=\"%s\"", NETCONF_BASE_NAMESPACE);
+    cprintf(cb, " xmlns:%s=\"%s\"", NETCONF_BASE_PREFIX, NETCONF_BASE_NAMESPACE);
+    if ((username = clicon_username_get(h)) != NULL){
+        cprintf(cb, " %s:username=\"%s\"", CLIXON_LIB_PREFIX, username);
+        cprintf(cb, " xmlns:%s=\"%s\"", CLIXON_LIB_PREFIX, CLIXON_LIB_NS);
+    }
+    cprintf(cb, " %s", NETCONF_MESSAGE_ID_ATTR); /* XXX: use incrementing sequence */
+    cprintf(cb, ">");
+    cprintf(cb, "<list-keys xmlns=\"%s\">", CLIXON_LIB_NS);
+    cprintf(cb, "<datastore>%s</datastore>", db);
+    cprintf(cb, "<xpath>");
+    if (xml_chardata_cbuf_append(cb, 0, xpath) < 0)
+        goto done;
+    cprintf(cb, "</xpath>");
+    if (nsc && cvec_len(nsc)){
+        cprintf(cb, "<namespace-context>");
+        cv = NULL;
+        while ((cv = cvec_each(nsc, cv)) != NULL) {
+            cprintf(cb, "<namespace>");
+            cprintf(cb, "<prefix>%s</prefix>", cv_name_get(cv)?cv_name_get(cv):"");
+            cprintf(cb, "<ns>%s</ns>", cv_string_get(cv));
+            cprintf(cb, "</namespace>");
+        }
+        cprintf(cb, "</namespace-context>");
+    }
+    if (prefix){
+        cprintf(cb, "<prefix>");
+        if (xml_chardata_cbuf_append(cb, 0, prefix) < 0)
+            goto done;
+        cprintf(cb, "</prefix>");
+    }
+    if (max)
+        cprintf(cb, "<max>%" PRIu32 "</max>", max);
+    cprintf(cb, "</list-keys>");
+    cprintf(cb, "</rpc>");
+    if (clicon_rpc_msg(h, cb, &xret) < 0)
+        goto done;
+    if ((xerr = xpath_first(xret, NULL, "//rpc-error")) != NULL){
+        clixon_err_netconf(h, OE_NETCONF, 0, xerr, "List keys");
+        goto done;
+    }
+    if ((xr = xpath_first(xret, NULL, "rpc-reply")) == NULL){
+        clixon_err(OE_XML, 0, "rpc error: no rpc-reply");
+        goto done;
+    }
+    if ((cvv = cvec_new(0)) == NULL){
+        clixon_err(OE_UNIX, errno, "cvec_new");
+        goto done;
+    }
+    x = NULL;
+    while ((x = xml_child_each(xr, x, CX_ELMNT)) != NULL) {
+        if (strcmp(xml_name(x), "key") != 0)
+            continue;
+        if (cvec_add_string(cvv, NULL, (str = xml_body(x)) != NULL ? str : "") < 0){
+            clixon_err(OE_UNIX, errno, "cvec_add_string");
+            goto done;
+        }
+    }
+    if (more)
+        *more = (str = xml_find_body(xr, "more")) != NULL && strcmp(str, "true") == 0;
+    *keys = cvv;
+    cvv = NULL;
+    retval = 0;
+ done:
+    if (cvv)
+        cvec_free(cvv);
+    if (cb)
+        cbuf_free(cb);
+    if (xret)
+        xml_free(xret);
+    return retval;
+}
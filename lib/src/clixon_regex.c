@@ -384,27 +384,31 @@ regexp_xsd2posix(const char *xsd,
 
 /*-------------------------- Generic API functions ------------------------*/
 
-/*! Compilation of regular expression / pattern
+/*! Cache of compiled regular expressions shared by all users, see regex_cache_compile
  *
- * @param[in]   h       Clixon handle
+ * Key is "<mode> <regexp>", value is the pointer to the compiled regexp, or NULL if
+ * the regexp could not be compiled
+ */
+static clicon_hash_t *regex_cache = NULL;
+
+/*! Compilation of regular expression / pattern with given regexp mode
+ *
+ * @param[in]   mode    Regexp engine
  * @param[in]   regexp  Regular expression string in XSD regex format
  * @param[out]  recomp  Compiled regular expression (malloc:d, should be freed)
  * @retval      1       OK
  * @retval      0       Invalid regular expression (syntax error?)
  * @retval     -1       Error
- * @note Clixon supports Yang's XSD regexp only. But CLIgen can support both
- *       POSIX and XSD(using libxml2). But to use CLIgen's POSIX, Clixon must
- *       translate from XSD to POSIX.
  */
-int
-regex_compile(clixon_handle h,
-              const char   *regexp,
-              void        **recomp)
+static int
+regex_compile_mode(enum regexp_mode mode,
+                   const char      *regexp,
+                   void           **recomp)
 {
-    int              retval = -1;
-    char            *posix = NULL;    /* Transform to posix regex */
+    int   retval = -1;
+    char *posix = NULL;    /* Transform to posix regex */
 
-    switch (clicon_yang_regexp(h)){
+    switch (mode){
     case REGEXP_POSIX:
         if (regexp_xsd2posix(regexp, &posix) < 0)
             goto done;
@@ -414,7 +418,7 @@ regex_compile(clixon_handle h,
         retval = cligen_regex_libxml2_compile(regexp, recomp);
         break;
     default:
-        clixon_err(OE_CFG, 0, "clicon_yang_regexp invalid value: %d", clicon_yang_regexp(h));
+        clixon_err(OE_CFG, 0, "clicon_yang_regexp invalid value: %d", mode);
         break;
     }
     /* retval from fns above */
@@ -424,22 +428,23 @@ regex_compile(clixon_handle h,
     return retval;
 }
 
-/*! Execution of (pre-compiled) regular expression / pattern
+/*! Execution of (pre-compiled) regular expression / pattern with given regexp mode
  *
- * @param[in]  h       Clixon handle
- * @param[in]  recomp  Compiled regular expression 
+ * @param[in]  mode    Regexp engine
+ * @param[in]  recomp  Compiled regular expression
  * @param[in]  string  Content string to match
- * @retval     0       OK
+ * @retval     1       Match
+ * @retval     0       No match
  * @retval    -1       Error
  */
-int
-regex_exec(clixon_handle h,
-           void         *recomp,
-           const char   *string)
+static int
+regex_exec_mode(enum regexp_mode mode,
+                void            *recomp,
+                const char      *string)
 {
     int   retval = -1;
 
-    switch (clicon_yang_regexp(h)){
+    switch (mode){
     case REGEXP_POSIX:
         retval = cligen_regex_posix_exec(recomp, string);
         break;
@@ -447,29 +452,26 @@ regex_exec(clixon_handle h,
         retval = cligen_regex_libxml2_exec(recomp, string);
         break;
     default:
-        clixon_err(OE_CFG, 0, "clicon_yang_regexp invalid value: %d",
-                   clicon_yang_regexp(h));
-        goto done;
+        clixon_err(OE_CFG, 0, "clicon_yang_regexp invalid value: %d", mode);
+        break;
     }
-    /* retval from fns above */
- done:
     return retval;
 }
 
-/*! Free of (pre-compiled) regular expression / pattern
+/*! Free of (pre-compiled) regular expression / pattern with given regexp mode
  *
- * @param[in]  h       Clixon handle
- * @param[in]  recomp  Compiled regular expression 
+ * @param[in]  mode    Regexp engine
+ * @param[in]  recomp  Compiled regular expression
  * @retval     0       OK
  * @retval    -1       Error
  */
-int
-regex_free(clixon_handle h,
-           void         *recomp)
+static int
+regex_free_mode(enum regexp_mode mode,
+                void            *recomp)
 {
     int   retval = -1;
 
-    switch (clicon_yang_regexp(h)){
+    switch (mode){
     case REGEXP_POSIX:
         retval = cligen_regex_posix_free(recomp);
         break;
@@ -477,10 +479,134 @@ regex_free(clixon_handle h,
         retval = cligen_regex_libxml2_free(recomp);
         break;
     default:
-        clixon_err(OE_CFG, 0, "clicon_yang_regexp invalid value: %d", clicon_yang_regexp(h));
+        clixon_err(OE_CFG, 0, "clicon_yang_regexp invalid value: %d", mode);
+        break;
+    }
+    return retval;
+}
+
+/*! Execution of (pre-compiled) regular expression / pattern
+ *
+ * @param[in]  h       Clixon handle
+ * @param[in]  recomp  Compiled regular expression 
+ * @param[in]  string  Content string to match
+ * @retval     0       OK
+ * @retval    -1       Error
+ */
+int
+regex_exec(clixon_handle h,
+           void         *recomp,
+           const char   *string)
+{
+    return regex_exec_mode(clicon_yang_regexp(h), recomp, string);
+}
+
+/*! Get a shared compiled regular expression, compile and cache if not found
+ *
+ * Compiled regexps are cached on mode and regexp string, so that the same pattern in
+ * different YANG types, and XPath re-match() literals, are compiled once.
+ * @param[in]   mode    Regexp engine, enum regexp_mode, eg clicon_yang_regexp(h)
+ * @param[in]   regexp  Regular expression string in XSD regex format
+ * @param[out]  recomp  Compiled regular expression. Do not free, owned by the cache
+ * @retval      1       OK
+ * @retval      0       Invalid regular expression (syntax error?)
+ * @retval     -1       Error
+ * @note Only use for regexps given by YANG or XPath literals, since entries are not
+ *       removed until regex_cache_exit
+ * @see regex_exec_mode  for executing with the same mode
+ */
+int
+regex_cache_compile(int          mode,
+                    const char  *regexp,
+                    void       **recomp)
+{
+    int     retval = -1;
+    cbuf   *cb = NULL;
+    void  **vp;
+    void   *re = NULL;
+    int     ret;
+
+    if (regex_cache == NULL &&
+        (regex_cache = clicon_hash_init()) == NULL)
+        goto done;
+    if ((cb = cbuf_new()) == NULL){
+        clixon_err(OE_UNIX, errno, "cbuf_new");
         goto done;
     }
-    /* retval from fns above */
+    cprintf(cb, "%d %s", mode, regexp);
+    if ((vp = clicon_hash_value(regex_cache, cbuf_get(cb), NULL)) != NULL)
+        re = *vp;
+    else {
+        if ((ret = regex_compile_mode(mode, regexp, &re)) < 0)
+            goto done;
+        if (ret == 0 && re != NULL){
+            regex_free_mode(mode, re);
+            if (mode == REGEXP_POSIX)
+                free(re);
+            re = NULL;
+        }
+        if (clicon_hash_add(regex_cache, cbuf_get(cb), &re, sizeof(re)) == NULL){
+            if (re){
+                regex_free_mode(mode, re);
+                if (mode == REGEXP_POSIX)
+                    free(re);
+            }
+            goto done;
+        }
+    }
+    *recomp = re;
+    retval = re ? 1 : 0;
  done:
+    if (cb)
+        cbuf_free(cb);
     return retval;
 }
+
+/*! Execution of regular expression from regex_cache_compile
+ *
+ * @param[in]  mode    Regexp engine, same as when compiled
+ * @param[in]  recomp  Compiled regular expression
+ * @param[in]  string  Content string to match
+ * @retval     1       Match
+ * @retval     0       No match
+ * @retval    -1       Error
+ */
+int
+regex_cache_exec(int         mode,
+                 void       *recomp,
+                 const char *string)
+{
+    return regex_exec_mode(mode, recomp, string);
+}
+
+/*! Free all cached compiled regular expressions
+ *
+ * Call on exit after freeing YANG specs
+ */
+int
+regex_cache_exit(void)
+{
+    char   **keys = NULL;
+    size_t   nkeys = 0;
+    size_t   i;
+    void   **vp;
+    int      mode;
+
+    if (regex_cache == NULL)
+        return 0;
+    if (clicon_hash_keys(regex_cache, &keys, &nkeys) == 0){
+        for (i=0; i<nkeys; i++){
+            if ((vp = clicon_hash_value(regex_cache, keys[i], NULL)) == NULL || *vp == NULL)
+                continue;
+            mode = atoi(keys[i]);
+            regex_free_mode(mode, *vp);
+            if (mode == REGEXP_POSIX)
+                free(*vp);
+        }
+        if (keys)
+            free(keys);
+    }
+    clicon_hash_free(regex_cache);
+    regex_cache = NULL;
+    return 0;
+}
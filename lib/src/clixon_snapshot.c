@@ -0,0 +1,403 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+
+  Copyright (C) 2009-2019 Olof Hagsand
+  Copyright (C) 2020-2022 Olof Hagsand and Rubicon Communications, LLC(Netgate)
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2,
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+ *
+ * Read-only snapshot of running for co-located readers
+ * The backend publishes running as an immutable file in binary datastore format after each
+ * change, see CLICON_XMLDB_SNAPSHOT:
+ *   header | binary datastore, see clixon_xml_bin.c
+ * The header contains a generation number which is incremented for each publication and
+ * kept across backend restarts.
+ * A new snapshot is written to a temporary file which is then renamed, so that a snapshot
+ * file is never modified once published. A reader maps the file, and a reader that already
+ * has it mapped keeps the old version until it maps again.
+ * Readers on the same host, such as the CLI, clixon_snmp or monitoring daemons, read the
+ * snapshot and evaluate XPaths locally instead of sending get-config to the backend:
+ *   if (clixon_snapshot_get(h, &xt, &gen) < 0)
+ *      err;
+ *   xpath_vec(xt, nsc, "/ex:table/ex:parameter", &vec, &veclen);
+ * @note NACM is not applied, access is controlled by file permissions of the snapshot
+ */
+#ifdef HAVE_CONFIG_H
+#include "clixon_config.h" /* generated by config & autoconf */
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+
+/* cligen */
+#include <cligen/cligen.h>
+
+/* clixon */
+#include "clixon_queue.h"
+#include "clixon_hash.h"
+#include "clixon_handle.h"
+#include "clixon_yang.h"
+#include "clixon_xml.h"
+#include "clixon_err.h"
+#include "clixon_log.h"
+#include "clixon_debug.h"
+#include "clixon_data.h"
+#include "clixon_options.h"
+#include "clixon_yang_module.h"
+#include "clixon_netconf_lib.h"
+#include "clixon_xml_io.h"
+#include "clixon_xml_bin.h"
+#include "clixon_snapshot.h"
+
+/* Snapshot magic and version */
+#define SNAPSHOT_MAGIC   "CLIXONSS"
+#define SNAPSHOT_VERSION 1
+
+/* Snapshot file mode, NACM is not applied to readers */
+#define SNAPSHOT_MODE    0640
+
+/*! Snapshot file header, followed by binary datastore
+ */
+struct snapshot_header {
+    char     sh_magic[8];  /* SNAPSHOT_MAGIC */
+    uint32_t sh_version;   /* SNAPSHOT_VERSION */
+    uint32_t sh_pad;
+    uint64_t sh_gen;       /* Generation */
+};
+
+/*! Snapshot kept by reader, see clixon_snapshot_get
+ */
+struct snapshot_cache {
+    cxobj   *sc_xt;        /* Parsed snapshot */
+    uint64_t sc_gen;       /* Generation of sc_xt */
+};
+
+/*! Check snapshot header
+ *
+ * @param[in]  sh    Header
+ * @param[in]  path  Snapshot file, for error message
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+static int
+snapshot_header_check(const struct snapshot_header *sh,
+                      const char                   *path)
+{
+    if (memcmp(sh->sh_magic, SNAPSHOT_MAGIC, sizeof(sh->sh_magic)) != 0){
+        clixon_err(OE_XML, EINVAL, "%s: bad magic, not a snapshot", path);
+        return -1;
+    }
+    if (sh->sh_version != SNAPSHOT_VERSION){
+        clixon_err(OE_XML, EINVAL, "%s: snapshot version %u not supported", path, sh->sh_version);
+        return -1;
+    }
+    return 0;
+}
+
+/*! Publish XML tree as a new snapshot
+ *
+ * Written to a temporary file in the same directory which is renamed to the snapshot file
+ * @param[in]  path        Snapshot file
+ * @param[in]  xt          XML tree, eg top of running
+ * @param[in]  yspec       Yang spec XML tree is bound to, for schema id
+ * @param[in]  system_only Enable checks for system-only-config extension
+ * @param[in]  gen         Generation of snapshot
+ * @retval     0           OK
+ * @retval    -1           Error
+ * @see clixon_snapshot_read
+ */
+int
+clixon_snapshot_write(const char *path,
+                      cxobj      *xt,
+                      yang_stmt  *yspec,
+                      int         system_only,
+                      uint64_t    gen)
+{
+    int                    retval = -1;
+    struct snapshot_header sh;
+    cbuf                  *cb = NULL;
+    FILE                  *f = NULL;
+    int                    fd = -1;
+    int                    ret;
+
+    if ((cb = cbuf_new()) == NULL){
+        clixon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    cprintf(cb, "%s.tmp", path);
+    if ((fd = open(cbuf_get(cb), O_WRONLY|O_CREAT|O_TRUNC, SNAPSHOT_MODE)) < 0){
+        clixon_err(OE_UNIX, errno, "open(%s)", cbuf_get(cb));
+        goto done;
+    }
+    if ((f = fdopen(fd, "w")) == NULL){
+        clixon_err(OE_UNIX, errno, "fdopen(%s)", cbuf_get(cb));
+        goto done;
+    }
+    fd = -1;
+    memset(&sh, 0, sizeof(sh));
+    memcpy(sh.sh_magic, SNAPSHOT_MAGIC, sizeof(sh.sh_magic));
+    sh.sh_version = SNAPSHOT_VERSION;
+    sh.sh_gen = gen;
+    if (fwrite(&sh, sizeof(sh), 1, f) != 1){
+        clixon_err(OE_UNIX, errno, "fwrite(%s)", cbuf_get(cb));
+        goto done;
+    }
+    if (clixon_xml2bin_file(f, xt, yspec, WITHDEFAULTS_EXPLICIT, system_only) < 0)
+        goto done;
+    ret = fclose(f);
+    f = NULL;
+    if (ret != 0){
+        clixon_err(OE_UNIX, errno, "fclose(%s)", cbuf_get(cb));
+        goto done;
+    }
+    if (rename(cbuf_get(cb), path) < 0){
+        clixon_err(OE_UNIX, errno, "rename(%s, %s)", cbuf_get(cb), path);
+        goto done;
+    }
+    clixon_debug(CLIXON_DBG_DATASTORE, "%s generation %" PRIu64, path, gen);
+    retval = 0;
+ done:
+    if (f)
+        fclose(f);
+    if (fd != -1)
+        close(fd);
+    if (retval < 0 && cb)
+        unlink(cbuf_get(cb));
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+}
+
+/*! Get generation of published snapshot without reading it
+ *
+ * Used by readers to detect a new snapshot
+ * @param[in]  path  Snapshot file
+ * @param[out] gen   Generation
+ * @retval     1     OK
+ * @retval     0     No snapshot published
+ * @retval    -1     Error
+ */
+int
+clixon_snapshot_generation(const char *path,
+                           uint64_t   *gen)
+{
+    int                    retval = -1;
+    struct snapshot_header sh;
+    int                    fd = -1;
+    ssize_t                n;
+
+    if ((fd = open(path, O_RDONLY)) < 0){
+        if (errno == ENOENT)
+            goto fail;
+        clixon_err(OE_UNIX, errno, "open(%s)", path);
+        goto done;
+    }
+    if ((n = pread(fd, &sh, sizeof(sh), 0)) < 0){
+        clixon_err(OE_UNIX, errno, "pread(%s)", path);
+        goto done;
+    }
+    if (n != sizeof(sh)){
+        clixon_err(OE_XML, EINVAL, "%s: snapshot too short", path);
+        goto done;
+    }
+    if (snapshot_header_check(&sh, path) < 0)
+        goto done;
+    *gen = sh.sh_gen;
+    retval = 1;
+ done:
+    if (fd != -1)
+        close(fd);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! Map published snapshot and parse it to XML tree
+ *
+ * If the snapshot was written with the same yang as yspec, the tree is bound and sorted
+ * as running, but without default values.
+ * @param[in]  path  Snapshot file
+ * @param[in]  yspec Yang spec to bind to, or NULL for no binding
+ * @param[out] xtp   XML tree, free with xml_free
+ * @param[out] gen   Generation (if not NULL)
+ * @retval     1     OK
+ * @retval     0     No snapshot published
+ * @retval    -1     Error
+ * @see clixon_snapshot_write
+ */
+int
+clixon_snapshot_read(const char *path,
+                     yang_stmt  *yspec,
+                     cxobj     **xtp,
+                     uint64_t   *gen)
+{
+    int                           retval = -1;
+    const struct snapshot_header *sh;
+    struct stat                   st;
+    void                         *map = MAP_FAILED;
+    cxobj                        *xt = NULL;
+    int                           fd = -1;
+    int                           bound;
+
+    if ((fd = open(path, O_RDONLY)) < 0){
+        if (errno == ENOENT)
+            goto fail;
+        clixon_err(OE_UNIX, errno, "open(%s)", path);
+        goto done;
+    }
+    if (fstat(fd, &st) < 0){
+        clixon_err(OE_UNIX, errno, "fstat(%s)", path);
+        goto done;
+    }
+    if (st.st_size < (off_t)sizeof(*sh)){
+        clixon_err(OE_XML, EINVAL, "%s: snapshot too short", path);
+        goto done;
+    }
+    /* Published snapshots are never modified, so the mapping can be shared */
+    if ((map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0)) == MAP_FAILED){
+        clixon_err(OE_UNIX, errno, "mmap(%s)", path);
+        goto done;
+    }
+    sh = (const struct snapshot_header *)map;
+    if (snapshot_header_check(sh, path) < 0)
+        goto done;
+    if (clixon_bin_parse_buf((const char *)(sh + 1), st.st_size - sizeof(*sh),
+                             yspec, &xt, &bound) < 0)
+        goto done;
+    if (gen)
+        *gen = sh->sh_gen;
+    *xtp = xt;
+    xt = NULL;
+    retval = 1;
+ done:
+    if (xt)
+        xml_free(xt);
+    if (map != MAP_FAILED)
+        munmap(map, st.st_size);
+    if (fd != -1)
+        close(fd);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! Get latest published snapshot of running, read again only if there is a new generation
+ *
+ * The snapshot is kept in the handle. It is replaced on a later call if a new snapshot
+ * has been published.
+ * @param[in]  h     Clixon handle
+ * @param[out] xtp   XML tree, direct pointer, do not modify or free
+ * @param[out] gen   Generation (if not NULL)
+ * @retval     1     OK
+ * @retval     0     No snapshot published
+ * @retval    -1     Error
+ * @see CLICON_XMLDB_SNAPSHOT
+ * @see clixon_snapshot_free
+ */
+int
+clixon_snapshot_get(clixon_handle h,
+                    cxobj       **xtp,
+                    uint64_t     *gen)
+{
+    int                    retval = -1;
+    struct snapshot_cache *sc = NULL;
+    char                  *path;
+    cxobj                 *xt = NULL;
+    uint64_t               gen1 = 0;
+    int                    ret;
+
+    if ((path = clicon_option_str(h, "CLICON_XMLDB_SNAPSHOT")) == NULL){
+        clixon_err(OE_CFG, ENOENT, "CLICON_XMLDB_SNAPSHOT not set");
+        goto done;
+    }
+    if (clicon_ptr_get(h, "snapshot-cache", (void**)&sc) < 0 || sc == NULL){
+        if ((sc = calloc(1, sizeof(*sc))) == NULL){
+            clixon_err(OE_UNIX, errno, "calloc");
+            goto done;
+        }
+        if (clicon_ptr_set(h, "snapshot-cache", sc) < 0){
+            free(sc);
+            goto done;
+        }
+    }
+    if ((ret = clixon_snapshot_generation(path, &gen1)) < 0)
+        goto done;
+    if (ret == 0)
+        goto fail;
+    if (sc->sc_xt == NULL || sc->sc_gen != gen1){
+        /* May have been published again since generation was read */
+        if ((ret = clixon_snapshot_read(path, clicon_dbspec_yang(h), &xt, &gen1)) < 0)
+            goto done;
+        if (ret == 0)
+            goto fail;
+        if (sc->sc_xt)
+            xml_free(sc->sc_xt);
+        sc->sc_xt = xt;
+        sc->sc_gen = gen1;
+    }
+    *xtp = sc->sc_xt;
+    if (gen)
+        *gen = sc->sc_gen;
+    retval = 1;
+ done:
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! Free snapshot kept in the handle
+ *
+ * @param[in]  h     Clixon handle
+ * @retval     0     OK
+ * @see clixon_snapshot_get
+ */
+int
+clixon_snapshot_free(clixon_handle h)
+{
+    struct snapshot_cache *sc = NULL;
+
+    if (clicon_ptr_get(h, "snapshot-cache", (void**)&sc) == 0 && sc != NULL){
+        if (sc->sc_xt)
+            xml_free(sc->sc_xt);
+        free(sc);
+        clicon_ptr_del(h, "snapshot-cache");
+    }
+    return 0;
+}
@@ -86,11 +86,24 @@
 #include "clixon_data.h"
 #include "clixon_xpath_ctx.h"
 #include "clixon_xpath.h"
+#include "clixon_mem.h"
 #include "clixon_stream.h"
 
 /* Go through and timeout subscription timers [s] */
 #define STREAM_TIMER_TIMEOUT_S 5
 
+/* Sequence number of event being notified, see stream_event_seq */
+static uint64_t _stream_event_seq = 0;
+
+/* Initial number of entries of replay ring buffer */
+#define STREAM_REPLAY_SIZE0 64
+
+/* Min number of dropped events before replay segment file is rewritten */
+#define STREAM_REPLAY_COMPACT_MIN 1024
+
+/* Get replay entry of stream given its position in time order */
+#define stream_replay_at(es, i) (&(es)->es_replay[((es)->es_replay_first + (i)) % (es)->es_replay_size])
+
 /*! Find an event notification stream given name
  *
  * @param[in]  h    Clixon handle
@@ -115,6 +128,446 @@ stream_find(clixon_handle h,
     return NULL;
 }
 
+/*! Drop oldest event of replay buffer
+ *
+ * @param[in]  es   Event notification stream structure
+ */
+static void
+stream_replay_drop(event_stream_t *es)
+{
+    struct stream_replay *r;
+
+    if (es->es_replay_nr == 0)
+        return;
+    r = stream_replay_at(es, 0);
+    es->es_replay_bytes -= r->r_len;
+    clixon_mem_account(CLIXON_MEM_STREAM, -1, -(int64_t)(r->r_len + 1));
+    free(r->r_str);
+    r->r_str = NULL;
+    es->es_replay_first = (es->es_replay_first + 1) % es->es_replay_size;
+    es->es_replay_nr--;
+    es->es_replay_dropped++;
+}
+
+/*! Free replay buffer and close segment file of stream
+ *
+ * @param[in]  es   Event notification stream structure
+ */
+static void
+stream_replay_free(event_stream_t *es)
+{
+    while (es->es_replay_nr)
+        stream_replay_drop(es);
+    if (es->es_replay)
+        clixon_mem_free(es->es_replay);
+    es->es_replay = NULL;
+    es->es_replay_size = 0;
+    es->es_replay_first = 0;
+    if (es->es_replay_f){
+        fclose(es->es_replay_f);
+        es->es_replay_f = NULL;
+    }
+    if (es->es_replay_file){
+        free(es->es_replay_file);
+        es->es_replay_file = NULL;
+    }
+}
+
+/*! Insert serialized event last in replay buffer, drop oldest events to keep within limits
+ *
+ * @param[in]  es   Event notification stream structure
+ * @param[in]  tv   Timestamp
+ * @param[in]  str  Event serialized as XML, consumed also on error
+ * @param[in]  len  Length of str
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+stream_replay_insert(event_stream_t *es,
+                     struct timeval *tv,
+                     char           *str,
+                     size_t          len)
+{
+    struct stream_replay *r;
+    struct stream_replay *ring;
+    uint32_t              size;
+    uint32_t              i;
+
+    while (es->es_replay_nr > 0 &&
+           ((es->es_replay_max && es->es_replay_nr >= es->es_replay_max) ||
+            (es->es_replay_max_bytes && es->es_replay_bytes + len > es->es_replay_max_bytes)))
+        stream_replay_drop(es);
+    if (es->es_replay_nr == es->es_replay_size){ /* Full: grow and unwrap */
+        size = es->es_replay_size ? 2*es->es_replay_size : STREAM_REPLAY_SIZE0;
+        if (es->es_replay_max && size > es->es_replay_max)
+            size = es->es_replay_max;
+        if ((ring = clixon_mem_calloc(CLIXON_MEM_STREAM, size, sizeof(*ring))) == NULL){
+            clixon_err(OE_UNIX, errno, "clixon_mem_calloc");
+            free(str);
+            return -1;
+        }
+        for (i=0; i<es->es_replay_nr; i++)
+            ring[i] = *stream_replay_at(es, i);
+        if (es->es_replay)
+            clixon_mem_free(es->es_replay);
+        es->es_replay = ring;
+        es->es_replay_size = size;
+        es->es_replay_first = 0;
+    }
+    r = stream_replay_at(es, es->es_replay_nr);
+    r->r_tv = *tv;
+    /* Keep time order for seek, eg if clock is set back */
+    if (es->es_replay_nr > 0 &&
+        timercmp(tv, &stream_replay_at(es, es->es_replay_nr - 1)->r_tv, <))
+        r->r_tv = stream_replay_at(es, es->es_replay_nr - 1)->r_tv;
+    r->r_str = str;
+    r->r_len = len;
+    /* Event strings are allocated by the caller, account for them here */
+    clixon_mem_account(CLIXON_MEM_STREAM, 1, len + 1);
+    es->es_replay_nr++;
+    es->es_replay_bytes += len;
+    return 0;
+}
+
+/*! Find first event in replay buffer not earlier than a given time
+ *
+ * Binary search in time index
+ * @param[in]  es   Event notification stream structure
+ * @param[in]  tv   Start time
+ * @retval     i    Position of event in time order, or es_replay_nr if none
+ */
+static uint32_t
+stream_replay_seek(event_stream_t *es,
+                   struct timeval *tv)
+{
+    uint32_t lo = 0;
+    uint32_t hi = es->es_replay_nr;
+    uint32_t mid;
+
+    while (lo < hi){
+        mid = lo + (hi - lo)/2;
+        if (timercmp(&stream_replay_at(es, mid)->r_tv, tv, <))
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+/*! Write replay event record to segment file
+ *
+ * A record is a line with timestamp and length, followed by the event and newline
+ * @param[in]  f    Segment file
+ * @param[in]  r    Replay event
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+stream_replay_record_write(FILE                 *f,
+                           struct stream_replay *r)
+{
+    if (fprintf(f, "%ld.%06ld %zu\n", (long)r->r_tv.tv_sec, (long)r->r_tv.tv_usec, r->r_len) < 0 ||
+        fwrite(r->r_str, 1, r->r_len, f) != r->r_len ||
+        fputc('\n', f) == EOF){
+        clixon_err(OE_UNIX, errno, "replay segment write");
+        return -1;
+    }
+    return 0;
+}
+
+/*! Write all events of replay buffer to segment file, and open it for append
+ *
+ * Events are written to a temporary file which then replaces the segment file
+ * @param[in]  es   Event notification stream structure
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+stream_replay_file_write(event_stream_t *es)
+{
+    int                   retval = -1;
+    cbuf                 *cb = NULL;
+    FILE                 *f = NULL;
+    uint32_t              i;
+
+    if (es->es_replay_f){
+        fclose(es->es_replay_f);
+        es->es_replay_f = NULL;
+    }
+    if ((cb = cbuf_new()) == NULL){
+        clixon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    cprintf(cb, "%s.tmp", es->es_replay_file);
+    if ((f = fopen(cbuf_get(cb), "w")) == NULL){
+        clixon_err(OE_UNIX, errno, "fopen(%s)", cbuf_get(cb));
+        goto done;
+    }
+    for (i=0; i<es->es_replay_nr; i++)
+        if (stream_replay_record_write(f, stream_replay_at(es, i)) < 0)
+            goto done;
+    if (fclose(f) < 0){
+        f = NULL;
+        clixon_err(OE_UNIX, errno, "fclose(%s)", cbuf_get(cb));
+        goto done;
+    }
+    f = NULL;
+    if (rename(cbuf_get(cb), es->es_replay_file) < 0){
+        clixon_err(OE_UNIX, errno, "rename(%s)", es->es_replay_file);
+        goto done;
+    }
+    if ((es->es_replay_f = fopen(es->es_replay_file, "a")) == NULL){
+        clixon_err(OE_UNIX, errno, "fopen(%s)", es->es_replay_file);
+        goto done;
+    }
+    es->es_replay_dropped = 0;
+    retval = 0;
+ done:
+    if (f)
+        fclose(f);
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+}
+
+/*! Rewrite segment file if it mostly consists of dropped events
+ *
+ * @param[in]  es   Event notification stream structure
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+stream_replay_compact(event_stream_t *es)
+{
+    if (es->es_replay_f == NULL ||
+        es->es_replay_dropped < STREAM_REPLAY_COMPACT_MIN ||
+        es->es_replay_dropped < es->es_replay_nr)
+        return 0;
+    return stream_replay_file_write(es);
+}
+
+/*! Load events from segment file into replay buffer
+ *
+ * Events older than retention are skipped. A truncated last record is ignored.
+ * @param[in]  es   Event notification stream structure
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+stream_replay_file_load(event_stream_t *es)
+{
+    int            retval = -1;
+    FILE          *f;
+    long           sec;
+    long           usec;
+    size_t         len;
+    char          *str = NULL;
+    struct timeval tv;
+    struct timeval now;
+    struct timeval tret;
+
+    if ((f = fopen(es->es_replay_file, "r")) == NULL){
+        if (errno == ENOENT)
+            goto ok;
+        clixon_err(OE_UNIX, errno, "fopen(%s)", es->es_replay_file);
+        goto done;
+    }
+    timerclear(&tret);
+    if (timerisset(&es->es_retention)){
+        gettimeofday(&now, NULL);
+        timersub(&now, &es->es_retention, &tret);
+    }
+    while (fscanf(f, "%ld.%ld %zu", &sec, &usec, &len) == 3 &&
+           fgetc(f) == '\n'){
+        if ((str = malloc(len + 1)) == NULL){
+            clixon_err(OE_UNIX, errno, "malloc");
+            goto done;
+        }
+        if (fread(str, 1, len, f) != len || fgetc(f) != '\n')
+            break;
+        str[len] = '\0';
+        tv.tv_sec = sec;
+        tv.tv_usec = usec;
+        if (timercmp(&tv, &tret, <)){
+            free(str);
+            str = NULL;
+            continue;
+        }
+        if (stream_replay_insert(es, &tv, str, len) < 0){
+            str = NULL;
+            goto done;
+        }
+        str = NULL;
+    }
+    clixon_debug(CLIXON_DBG_STREAM, "%s: %u events", es->es_replay_file, es->es_replay_nr);
+ ok:
+    retval = 0;
+ done:
+    if (str)
+        free(str);
+    if (f)
+        fclose(f);
+    return retval;
+}
+
+/*! Get name of notification child an XPath filter requires for a match
+ *
+ * That is, the filter is a relative location path whose first step is a child step
+ * with a name, eg event or ex:event[event-class='fault']/severity.
+ * Then only notifications with such a child may match.
+ * @param[in]  xs    Parsed XPath filter
+ * @retval     name  Local name of child
+ * @retval     NULL  Any notification may match
+ */
+static const char *
+stream_filter_event(xpath_tree *xs)
+{
+    /* Skip single-child expression nodes down to location path */
+    while (xs && xs->xs_type != XP_LOCPATH){
+        if (xs->xs_c1 != NULL)
+            return NULL;
+        switch (xs->xs_type){
+        case XP_EXP:
+        case XP_AND:
+        case XP_RELEX:
+        case XP_ADD:
+        case XP_UNION:
+        case XP_PATHEXPR:
+            xs = xs->xs_c0;
+            break;
+        default:
+            return NULL;
+        }
+    }
+    if (xs == NULL || (xs = xs->xs_c0) == NULL || xs->xs_type != XP_RELLOCPATH)
+        return NULL;
+    /* First step is leftmost */
+    while (xs && xs->xs_type == XP_RELLOCPATH)
+        xs = xs->xs_c0;
+    if (xs == NULL || xs->xs_type != XP_STEP || xs->xs_int != A_CHILD)
+        return NULL;
+    if ((xs = xs->xs_c0) == NULL || xs->xs_type != XP_NODE ||
+        xs->xs_s1 == NULL || strcmp(xs->xs_s1, "*") == 0)
+        return NULL;
+    return xs->xs_s1;
+}
+
+/*! Get vector of subscriptions in subscription index of a stream
+ *
+ * @param[in]  es     Event stream
+ * @param[in]  event  Notification child name, or NULL for subscriptions without
+ * @param[in]  create Create empty vector if not found
+ * @retval     sv     Subscription vector
+ * @retval     NULL   Not found, or error if create
+ */
+static struct stream_ss_vec *
+stream_ss_index_get(event_stream_t *es,
+                    const char     *event,
+                    int             create)
+{
+    struct stream_ss_vec sv0 = {NULL, 0};
+
+    if (event == NULL)
+        return &es->es_ss_any;
+    if (es->es_ss_index == NULL){
+        if (!create)
+            return NULL;
+        if ((es->es_ss_index = clicon_hash_init()) == NULL)
+            return NULL;
+    }
+    if (create &&
+        clicon_hash_value(es->es_ss_index, event, NULL) == NULL &&
+        clicon_hash_add(es->es_ss_index, event, &sv0, sizeof(sv0)) == NULL)
+        return NULL;
+    return clicon_hash_value(es->es_ss_index, event, NULL);
+}
+
+/*! Add subscription to subscription index of its stream
+ *
+ * @param[in]  es   Event stream
+ * @param[in]  ss   Stream subscription
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+stream_ss_index_add(event_stream_t             *es,
+                    struct stream_subscription *ss)
+{
+    int                          retval = -1;
+    struct stream_ss_vec        *sv;
+    struct stream_subscription **vec;
+
+    if ((sv = stream_ss_index_get(es, ss->ss_event, 1)) == NULL)
+        goto done;
+    if ((vec = realloc(sv->sv_vec, (sv->sv_len+1)*sizeof(*vec))) == NULL){
+        clixon_err(OE_UNIX, errno, "realloc");
+        goto done;
+    }
+    vec[sv->sv_len++] = ss;
+    sv->sv_vec = vec;
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Remove subscription from subscription index of its stream
+ *
+ * Order of remaining subscriptions is kept
+ * @param[in]  es   Event stream
+ * @param[in]  ss   Stream subscription
+ */
+static void
+stream_ss_index_rm(event_stream_t             *es,
+                   struct stream_subscription *ss)
+{
+    struct stream_ss_vec *sv;
+    size_t                i;
+
+    if ((sv = stream_ss_index_get(es, ss->ss_event, 0)) == NULL)
+        return;
+    for (i=0; i<sv->sv_len; i++)
+        if (sv->sv_vec[i] == ss)
+            break;
+    if (i == sv->sv_len)
+        return;
+    sv->sv_len--;
+    memmove(&sv->sv_vec[i], &sv->sv_vec[i+1], (sv->sv_len-i)*sizeof(*sv->sv_vec));
+    if (sv->sv_len == 0){
+        free(sv->sv_vec);
+        sv->sv_vec = NULL;
+    }
+}
+
+/*! Free subscription index of a stream
+ *
+ * @param[in]  es   Event stream
+ */
+static void
+stream_ss_index_free(event_stream_t *es)
+{
+    char                **keys = NULL;
+    size_t                nkeys = 0;
+    size_t                i;
+    struct stream_ss_vec *sv;
+
+    if (es->es_ss_index){
+        if (clicon_hash_keys(es->es_ss_index, &keys, &nkeys) == 0)
+            for (i=0; i<nkeys; i++)
+                if ((sv = clicon_hash_value(es->es_ss_index, keys[i], NULL)) != NULL &&
+                    sv->sv_vec)
+                    free(sv->sv_vec);
+        if (keys)
+            free(keys);
+        clicon_hash_free(es->es_ss_index);
+        es->es_ss_index = NULL;
+    }
+    if (es->es_ss_any.sv_vec){
+        free(es->es_ss_any.sv_vec);
+        es->es_ss_any.sv_vec = NULL;
+    }
+    es->es_ss_any.sv_len = 0;
+}
+
 /*! Delete event stream core components 
  *
  * @param[in]     es   Event notification stream structure
@@ -122,6 +575,8 @@ stream_find(clixon_handle h,
 static int
 stream_delete(event_stream_t *es)
 {
+    stream_replay_free(es);
+    stream_ss_index_free(es);
     if (es->es_name)
         free(es->es_name);
     if (es->es_description)
@@ -149,6 +604,9 @@ stream_add(clixon_handle   h,
 {
     int             retval = -1;
     event_stream_t *es = NULL;
+    char           *dir;
+    cbuf           *cb = NULL;
+    int             i;
 
     if ((es = stream_find(h, name)) != NULL)
         goto ok;
@@ -168,11 +626,35 @@ stream_add(clixon_handle   h,
     es->es_replay_enabled = replay_enabled;
     if (retention)
         es->es_retention = *retention;
+    if (replay_enabled){
+        if ((i = clicon_option_int(h, "CLICON_STREAM_REPLAY_MAX")) > 0)
+            es->es_replay_max = i;
+        if ((i = clicon_option_int(h, "CLICON_STREAM_REPLAY_BYTES")) > 0)
+            es->es_replay_max_bytes = i;
+        /* Replay across restarts */
+        if ((dir = clicon_option_str(h, "CLICON_STREAM_REPLAY_DIR")) != NULL){
+            if ((cb = cbuf_new()) == NULL){
+                clixon_err(OE_UNIX, errno, "cbuf_new");
+                goto done;
+            }
+            cprintf(cb, "%s/%s.replay", dir, name);
+            if ((es->es_replay_file = strdup(cbuf_get(cb))) == NULL){
+                clixon_err(OE_UNIX, errno, "strdup");
+                goto done;
+            }
+            if (stream_replay_file_load(es) < 0)
+                goto done;
+            if (stream_replay_file_write(es) < 0)
+                goto done;
+        }
+    }
     clicon_stream_append(h, es);
     es = NULL;
  ok:
     retval = 0;
  done:
+    if (cb)
+        cbuf_free(cb);
     if (es)
         stream_delete(es);
     return retval;
@@ -190,7 +672,6 @@ stream_delete_all(clixon_handle h,
                   int           force)
 {
     int                   retval = -1;
-    struct stream_replay *r;
     struct stream_subscription *ss;
     event_stream_t       *es;
     event_stream_t       *head = clicon_stream(h);
@@ -202,12 +683,6 @@ stream_delete_all(clixon_handle h,
             if (stream_ss_rm(h, es, ss, force) < 0)
                 goto done;
         }
-        while ((r = es->es_replay) != NULL){
-            DELQ(r, es->es_replay, struct stream_replay *);
-            if (r->r_xml)
-                xml_free(r->r_xml);
-            free(r);
-        }
         if (stream_delete(es) < 0)
             goto done;
     }
@@ -280,8 +755,6 @@ stream_timer_setup(int   fd,
     event_stream_t              *es;
     struct stream_subscription  *ss;
     struct stream_subscription  *ss1;
-    struct stream_replay        *r;
-    struct stream_replay        *r1;
 
     clixon_debug(CLIXON_DBG_STREAM|CLIXON_DBG_DETAIL, "");
     /* Go thru callbacks and see if any have timed out, if so remove them 
@@ -309,22 +782,14 @@ stream_timer_setup(int   fd,
                         ss = NEXTQ(struct stream_subscription *, ss);
                 } while (ss && ss != es->es_subscription);
   /* 2) Go throughreplay buffer and remove entries with passed retention time */
-            if (timerisset(&es->es_retention) &&
-                (r = es->es_replay) != NULL){
+            if (timerisset(&es->es_retention)){
                 timersub(&now, &es->es_retention, &tret);
-                do {
-                    if (timercmp(&r->r_tv, &tret, <)){
-                        r1 = NEXTQ(struct stream_replay *, r);
-                        DELQ(r, es->es_replay, struct stream_replay *);
-                        if (r->r_xml)
-                            xml_free(r->r_xml);
-                        free(r);
-                        r = r1;
-                    }
-                    else
-                        r = NEXTQ(struct stream_replay *, r);
-                } while (r && r!=es->es_replay);
+                while (es->es_replay_nr > 0 &&
+                       timercmp(&stream_replay_at(es, 0)->r_tv, &tret, <))
+                    stream_replay_drop(es);
             }
+            if (stream_replay_compact(es) < 0)
+                goto done;
             es = NEXTQ(struct event_stream *, es);
         } while (es && es != clicon_stream(h));
     }
@@ -349,8 +814,8 @@ stream_timer_setup(int   fd,
  * @param[in]  stoptime If set, dont continue past this time
  * @param[in]  fn       Callback when event occurs
  * @param[in]  arg      Argument to use with callback. Also handle when deleting
- * @retval     0        OK
- * @retval    -1        Error, ie no such stream 
+ * @retval     ss       Stream subscription
+ * @retval     NULL     Error, ie no such stream or invalid xpath
  */
 struct stream_subscription *
 stream_ss_add(clixon_handle     h,
@@ -386,13 +851,28 @@ stream_ss_add(clixon_handle     h,
         clixon_err(OE_CFG, errno, "strdup");
         goto done;
     }
+    /* Parse filter once here, not for every event */
+    if (xpath && strlen(xpath)){
+        if (xpath_parse(xpath, &ss->ss_xptree) < 0)
+            goto done;
+        ss->ss_event = stream_filter_event(ss->ss_xptree);
+    }
     ss->ss_fn     = fn;
     ss->ss_arg    = arg;
+    if (stream_ss_index_add(es, ss) < 0)
+        goto done;
     ADDQ(ss, es->es_subscription);
     return ss;
   done:
-    if (ss)
+    if (ss){
+        if (ss->ss_stream)
+            free(ss->ss_stream);
+        if (ss->ss_xpath)
+            free(ss->ss_xpath);
+        if (ss->ss_xptree)
+            xpath_tree_free(ss->ss_xptree);
         free(ss);
+    }
     return NULL;
 }
 
@@ -413,6 +893,7 @@ stream_ss_rm(clixon_handle               h,
 {
     clixon_debug(CLIXON_DBG_STREAM, "");
     DELQ(ss, es->es_subscription, struct stream_subscription *);
+    stream_ss_index_rm(es, ss);
     /* Remove from upper layers - close socket etc. */
     (*ss->ss_fn)(h, 1, NULL, ss->ss_arg);
     if (force){
@@ -420,6 +901,8 @@ stream_ss_rm(clixon_handle               h,
             free(ss->ss_stream);
         if (ss->ss_xpath)
             free(ss->ss_xpath);
+        if (ss->ss_xptree)
+            xpath_tree_free(ss->ss_xptree);
         free(ss);
     }
     clixon_debug(CLIXON_DBG_STREAM, "retval: 0");
@@ -544,8 +1027,134 @@ stream_ss_delete(clixon_handle h,
     return retval;
 }
 
+/*! Get sequence number of the event currently notified to subscription callbacks
+ *
+ * The number is the same in all callbacks of one event, eg for a callback to
+ * serialize an event once and share it with other subscriptions.
+ * @retval  seq  Event sequence number
+ */
+uint64_t
+stream_event_seq(void)
+{
+    return _stream_event_seq;
+}
+
+/*! Get name of the notification child of an event
+ *
+ * @param[in]  xevent  Notification as xml tree
+ * @retval     name    Name of single child except eventTime
+ * @retval     NULL    No or several such children
+ */
+static const char *
+stream_event_name(cxobj *xevent)
+{
+    cxobj      *x = NULL;
+    const char *name = NULL;
+
+    while ((x = xml_child_each(xevent, x, CX_ELMNT)) != NULL){
+        if (strcmp(xml_name(x), "eventTime") == 0)
+            continue;
+        if (name != NULL)
+            return NULL;
+        name = xml_name(x);
+    }
+    return name;
+}
+
+/*! Notify event to a single subscription if its filter matches
+ *
+ * @param[in]  h       Clixon handle
+ * @param[in]  es      Event stream
+ * @param[in]  tv      Timestamp. Remove subscription if its stoptime<tv
+ * @param[in]  xevent  Notification as xml tree
+ * @param[in]  ss      Stream subscription
+ * @param[in,out] xmatch Match of each distinct filter of this event, or NULL
+ * @retval     1       OK, subscription removed
+ * @retval     0       OK
+ * @retval    -1       Error
+ */
+static int
+stream_notify_ss(clixon_handle               h,
+                 event_stream_t             *es,
+                 struct timeval             *tv,
+                 cxobj                      *xevent,
+                 struct stream_subscription *ss,
+                 clicon_hash_t             **xmatch)
+{
+    int  retval = -1;
+    int  match;
+    int *mp;
+
+    if (timerisset(&ss->ss_stoptime) && /* stoptime has passed */
+        timercmp(&ss->ss_stoptime, tv, <)){
+        /* Signal to remove stream for upper levels */
+        if (stream_ss_rm(h, es, ss, 1) < 0)
+            goto done;
+        retval = 1;
+        goto done;
+    }
+    /* xpath match, evaluated once for subscriptions with identical filters */
+    if (ss->ss_xptree == NULL)
+        match = 1;
+    else if (*xmatch &&
+             (mp = clicon_hash_value(*xmatch, ss->ss_xpath, NULL)) != NULL)
+        match = *mp;
+    else {
+        match = xpath_first_tree(xevent, NULL, ss->ss_xptree) != NULL;
+        if (*xmatch == NULL &&
+            (*xmatch = clicon_hash_init()) == NULL)
+            goto done;
+        if (clicon_hash_add(*xmatch, ss->ss_xpath, &match, sizeof(match)) == NULL)
+            goto done;
+    }
+    if (match &&
+        (*ss->ss_fn)(h, 0, xevent, ss->ss_arg) < 0)
+        goto done;
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Notify event to subscriptions in a subscription vector
+ *
+ * @param[in]  h       Clixon handle
+ * @param[in]  es      Event stream
+ * @param[in]  tv      Timestamp
+ * @param[in]  xevent  Notification as xml tree
+ * @param[in]  event   Notification child name of vector, or NULL
+ * @param[in,out] xmatch Match of each distinct filter of this event, or NULL
+ * @retval     0       OK
+ * @retval    -1       Error
+ */
+static int
+stream_notify_vec(clixon_handle   h,
+                  event_stream_t *es,
+                  struct timeval *tv,
+                  cxobj          *xevent,
+                  const char     *event,
+                  clicon_hash_t **xmatch)
+{
+    int                   retval = -1;
+    struct stream_ss_vec *sv;
+    size_t                i = 0;
+    int                   ret;
+
+    /* Vector may shrink if subscriptions are removed, or move if added */
+    while ((sv = stream_ss_index_get(es, event, 0)) != NULL && i < sv->sv_len){
+        if ((ret = stream_notify_ss(h, es, tv, xevent, sv->sv_vec[i], xmatch)) < 0)
+            goto done;
+        if (ret == 0)
+            i++;
+    }
+    retval = 0;
+ done:
+    return retval;
+}
+
 /*! Stream notify event and distribute to all registered callbacks
  *
+ * Only subscriptions whose filter may match the notification child of the event
+ * are evaluated, see es_ss_index
  * @param[in]  h       Clixon handle
  * @param[in]  stream  Name of event stream. CLICON is predefined as LOG stream
  * @param[in]  tv      Timestamp. Dont notify if subscription has stoptime<tv
@@ -563,31 +1172,31 @@ stream_notify1(clixon_handle   h,
 {
     int                         retval = -1;
     struct stream_subscription *ss;
+    struct stream_subscription *ss1;
+    clicon_hash_t              *xmatch = NULL; /* Match of each distinct filter */
+    const char                 *event;
 
     clixon_debug(CLIXON_DBG_STREAM, "");
-    /* Go thru all subscriptions and find matches */
-    if ((ss = es->es_subscription) != NULL)
+    _stream_event_seq++;
+    if ((event = stream_event_name(xevent)) != NULL){
+        /* Subscriptions that may match any event, then those that may match this */
+        if (stream_notify_vec(h, es, tv, xevent, NULL, &xmatch) < 0)
+            goto done;
+        if (stream_notify_vec(h, es, tv, xevent, event, &xmatch) < 0)
+            goto done;
+    }
+    else if ((ss = es->es_subscription) != NULL)
+        /* Go thru all subscriptions and find matches */
         do {
-            if (timerisset(&ss->ss_stoptime) && /* stoptime has passed */
-                timercmp(&ss->ss_stoptime, tv, <)){
-                struct stream_subscription *ss1;
-                ss1 = NEXTQ(struct stream_subscription *, ss);
-                /* Signal to remove stream for upper levels */
-                if (stream_ss_rm(h, es, ss, 1) < 0)
-                    goto done;
-                ss = ss1;
-            }
-            else{  /* xpath match */
-                if (ss->ss_xpath == NULL ||
-                    strlen(ss->ss_xpath)==0 ||
-                    xpath_first(xevent, NULL, "%s", ss->ss_xpath) != NULL)
-                    if ((*ss->ss_fn)(h, 0, xevent, ss->ss_arg) < 0)
-                        goto done;
-                ss = NEXTQ(struct stream_subscription *, ss);
-            }
+            ss1 = NEXTQ(struct stream_subscription *, ss);
+            if (stream_notify_ss(h, es, tv, xevent, ss, &xmatch) < 0)
+                goto done;
+            ss = ss1;
         } while (es->es_subscription && ss != es->es_subscription);
     retval = 0;
   done:
+    if (xmatch)
+        clicon_hash_free(xmatch);
     return retval;
 }
 
@@ -659,7 +1268,6 @@ stream_notify(clixon_handle h,
     if (es->es_replay_enabled){
         if (stream_replay_add(es, &tv, xev) < 0)
             goto done;
-        xev = NULL; /* xml stored in replay_add and should not be freed */
     }
  ok:
     retval = 0;
@@ -729,7 +1337,6 @@ stream_notify_xml(clixon_handle h,
     if (es->es_replay_enabled){
         if (stream_replay_add(es, &tv, xev) < 0)
             goto done;
-        xev = NULL; /* xml stored in replay_add and should not be freed */
     }
  ok:
     retval = 0;
@@ -776,43 +1383,48 @@ stream_replay_notify(clixon_handle               h,
 {
     int                   retval = -1;
     struct stream_replay *r;
+    uint32_t              i;
+    cxobj                *xev = NULL;
 
     /* If <startTime> is not present, this is not a replay */
     if (!timerisset(&ss->ss_starttime))
         goto ok;
     if (!es->es_replay_enabled)
         goto ok;
-    /* Get replay linked list */
-    if ((r = es->es_replay) == NULL)
-        goto ok;
-    /* First loop to skip until start */
-    do {
-        if (timercmp(&r->r_tv, &ss->ss_starttime, >=))
-            break;
-        r = NEXTQ(struct stream_replay *, r);
-    } while (r && r!=es->es_replay);
-    if (r == NULL)
-        goto ok; /* No samples to replay */
-    /* Then notify until stop */
-    do {
+    /* Seek start in time index, then notify until stop */
+    for (i = stream_replay_seek(es, &ss->ss_starttime); i < es->es_replay_nr; i++){
+        r = stream_replay_at(es, i);
         if (timerisset(&ss->ss_stoptime) &&
             timercmp(&r->r_tv, &ss->ss_stoptime, >))
             break;
-        if ((*ss->ss_fn)(h, 0, r->r_xml, ss->ss_arg) < 0)
+        if (clixon_xml_parse_string(r->r_str, YB_NONE, NULL, &xev, NULL) < 0)
+            goto done;
+        if (xml_rootchild(xev, 0, &xev) < 0)
             goto done;
-        r = NEXTQ(struct stream_replay *, r);
-    } while (r && r!=es->es_replay);
+        if (ss->ss_xptree == NULL ||
+            xpath_first_tree(xev, NULL, ss->ss_xptree) != NULL){
+            _stream_event_seq++;
+            if ((*ss->ss_fn)(h, 0, xev, ss->ss_arg) < 0)
+                goto done;
+        }
+        xml_free(xev);
+        xev = NULL;
+    }
  ok:
     retval = 0;
  done:
+    if (xev)
+        xml_free(xev);
     return retval;
 }
 
 /*! Add replay sample to stream with timestamp
  *
+ * The event is serialized and stored in the replay ring buffer of the stream, and
+ * appended to the segment file if any. Oldest events are dropped if the buffer is full.
  * @param[in] es   Stream
  * @param[in] tv   Timestamp
- * @param[in] xv   XML
+ * @param[in] xv   XML, not consumed
  * @retval    0    OK
  * @retval   -1    Error
  */
@@ -821,19 +1433,33 @@ stream_replay_add(event_stream_t *es,
                   struct timeval *tv,
                   cxobj          *xv)
 {
-    int                   retval = -1;
-    struct stream_replay *new;
+    int   retval = -1;
+    cbuf *cb = NULL;
+    char *str;
 
-    if ((new = malloc(sizeof *new)) == NULL){
-        clixon_err(OE_UNIX, errno, "malloc");
+    if ((cb = cbuf_new()) == NULL){
+        clixon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    if (clixon_xml2cbuf(cb, xv, 0, 0, NULL, -1, 0) < 0)
+        goto done;
+    if ((str = strdup(cbuf_get(cb))) == NULL){
+        clixon_err(OE_UNIX, errno, "strdup");
         goto done;
     }
-    memset(new, 0, (sizeof *new));
-    new->r_tv = *tv;
-    new->r_xml = xv;
-    ADDQ(new, es->es_replay);
+    if (stream_replay_insert(es, tv, str, cbuf_len(cb)) < 0)
+        goto done;
+    if (es->es_replay_f){
+        if (stream_replay_record_write(es->es_replay_f, stream_replay_at(es, es->es_replay_nr - 1)) < 0)
+            goto done;
+        fflush(es->es_replay_f);
+        if (stream_replay_compact(es) < 0)
+            goto done;
+    }
     retval = 0;
  done:
+    if (cb)
+        cbuf_free(cb);
     return retval;
 }
 
@@ -931,110 +1557,260 @@ stream_replay_trigger(clixon_handle h,
 /* SSE support using Nginx Nchan. This code needs to be enabled at configure 
  * time using: --enable-publish configure option
  * It uses CURL and autoconf needs to set that dependency
+ * Events are posted with the curl multi interface driven by the event loop, so that
+ * a slow or dead publish server does not block the process.
  */
 
 #include <curl/curl.h>
 
-/*
- * Types (curl)
+/*! Publisher of a stream
+ *
+ * Events are queued while a POST is in progress and sent together in the next POST
  */
-struct curlbuf{
-    size_t b_len;
-    char  *b_buf;
+struct stream_pub{
+    qelem_t        sp_q;       /* queue header */
+    char          *sp_url;     /* Publish url: CLICON_STREAM_PUB/<stream> */
+    cbuf          *sp_queue;   /* Serialized events waiting to be posted */
+    uint32_t       sp_nr;      /* Number of events in sp_queue */
+    uint32_t       sp_dropped; /* Events dropped since last POST */
+    CURL          *sp_curl;    /* POST in progress, or NULL */
+    cbuf          *sp_post;    /* Data of POST in progress */
+    char           sp_err[CURL_ERROR_SIZE];
 };
 
-/*
- * For the asynchronous case. I think we must handle the case where of many of these
- * come in before we can handle them in the upper-level polling routine.
- * realloc. Therefore, we append new data to the userdata buffer.
+/* Curl multi handle of all publish POSTs */
+static CURLM *_stream_pub_multi = NULL;
+
+/* List of stream publishers */
+static struct stream_pub *_stream_pub_list = NULL;
+
+static int stream_publish_post(struct stream_pub *sp);
+
+/*! Discard data returned by publish server
  */
 static size_t
-curl_get_cb(void  *ptr,
-            size_t size,
-            size_t nmemb,
-            void  *userdata)
+curl_discard_cb(void  *ptr,
+                size_t size,
+                size_t nmemb,
+                void  *userdata)
+{
+    return size*nmemb;
+}
+
+/*! Handle finished publish POSTs and start next POST of a publisher if events are queued
+ *
+ * @retval   0   OK
+ * @retval  -1   Error
+ */
+static int
+stream_publish_done(void)
 {
-    struct curlbuf *buf = (struct curlbuf *)userdata;
-    int len;
+    int                retval = -1;
+    CURLMsg           *msg;
+    int                nmsg;
+    struct stream_pub *sp = NULL;
+
+    while ((msg = curl_multi_info_read(_stream_pub_multi, &nmsg)) != NULL){
+        if (msg->msg != CURLMSG_DONE)
+            continue;
+        curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, (char**)&sp);
+        if (msg->data.result != CURLE_OK)
+            clixon_log(NULL, LOG_WARNING, "Stream publish to %s: %s",
+                       sp->sp_url, sp->sp_err[0] ? sp->sp_err : curl_easy_strerror(msg->data.result));
+        curl_multi_remove_handle(_stream_pub_multi, sp->sp_curl);
+        curl_easy_cleanup(sp->sp_curl);
+        sp->sp_curl = NULL;
+        cbuf_reset(sp->sp_post);
+        if (sp->sp_nr && stream_publish_post(sp) < 0)
+            goto done;
+    }
+    retval = 0;
+ done:
+    return retval;
+}
 
-    len = size*nmemb;
-    if ((buf->b_buf = realloc(buf->b_buf, buf->b_len+len+1)) == NULL)
+/*! Let curl act on a socket or timeout, then handle finished POSTs
+ *
+ * @param[in]  s     Socket, or CURL_SOCKET_TIMEOUT
+ * @param[in]  ev    CURL_CSELECT_IN, CURL_CSELECT_OUT or 0
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+static int
+stream_publish_action(curl_socket_t s,
+                      int           ev)
+{
+    int running = 0;
+
+    if (curl_multi_socket_action(_stream_pub_multi, s, ev, &running) != CURLM_OK){
+        clixon_err(OE_UNIX, 0, "curl_multi_socket_action");
+        return -1;
+    }
+    return stream_publish_done();
+}
+
+static int
+stream_publish_in(int   s,
+                  void *arg)
+{
+    return stream_publish_action(s, CURL_CSELECT_IN);
+}
+
+static int
+stream_publish_out(int   s,
+                   void *arg)
+{
+    return stream_publish_action(s, CURL_CSELECT_OUT);
+}
+
+static int
+stream_publish_timeout(int   s,
+                       void *arg)
+{
+    return stream_publish_action(CURL_SOCKET_TIMEOUT, 0);
+}
+
+/*! Curl multi socket callback: register socket in event loop as curl wants
+ *
+ * A socket is registered either for input or for output, INOUT as output.
+ * @see CURLMOPT_SOCKETFUNCTION
+ */
+static int
+curl_pub_socket_cb(CURL          *curl,
+                   curl_socket_t  s,
+                   int            what,
+                   void          *userp,
+                   void          *socketp)
+{
+    intptr_t old = (intptr_t)socketp; /* Earlier what, or 0 */
+
+    if (old == CURL_POLL_IN)
+        clixon_event_unreg_fd(s, stream_publish_in);
+    else if (old == CURL_POLL_OUT || old == CURL_POLL_INOUT)
+        clixon_event_unreg_fd(s, stream_publish_out);
+    switch (what){
+    case CURL_POLL_IN:
+        if (clixon_event_reg_fd(s, stream_publish_in, NULL, "stream publish") < 0)
+            return -1;
+        break;
+    case CURL_POLL_OUT:
+    case CURL_POLL_INOUT:
+        if (clixon_event_reg_fd_out(s, stream_publish_out, NULL, "stream publish") < 0)
+            return -1;
+        break;
+    default: /* CURL_POLL_REMOVE */
+        what = 0;
+        break;
+    }
+    curl_multi_assign(_stream_pub_multi, s, (void*)(intptr_t)what);
+    return 0;
+}
+
+/*! Curl multi timer callback: register timeout in event loop
+ *
+ * @see CURLMOPT_TIMERFUNCTION
+ */
+static int
+curl_pub_timer_cb(CURLM *multi,
+                  long   timeout_ms,
+                  void  *userp)
+{
+    struct timeval t;
+    struct timeval t1;
+
+    clixon_event_unreg_timeout(stream_publish_timeout, NULL);
+    if (timeout_ms < 0)
         return 0;
-    memcpy(buf->b_buf+buf->b_len, ptr, len);
-    buf->b_len += len;
-    buf->b_buf[buf->b_len] = '\0';
-    return len;
+    gettimeofday(&t, NULL);
+    t1.tv_sec = timeout_ms/1000;
+    t1.tv_usec = (timeout_ms%1000)*1000;
+    timeradd(&t, &t1, &t);
+    if (clixon_event_reg_timeout(t, stream_publish_timeout, NULL, "stream publish timer") < 0)
+        return -1;
+    return 0;
 }
 
-/*! Send a curl POST request
+/*! Start POST of queued events of a publisher
  *
- * @retval   1   ok
- * @retval   0   expect set but did not expected return or other non-fatal error
- * @retval  -1   fatal error
- * Note: curl_easy_perform blocks
- * Note: New handle is created every time, the handle can be re-used for better TCP performance
- * @see same function (url_post) in grideye_curl.c
+ * @param[in]  sp   Stream publisher, no POST in progress
+ * @retval     0    OK
+ * @retval    -1    Error
  */
 static int
-url_post(char *url,
-         char *postfields,
-         char **getdata)
+stream_publish_post(struct stream_pub *sp)
 {
-    int            retval = -1;
-    CURL          *curl = NULL;
-    char          *err = NULL;
-    struct curlbuf cb = {0, };
-    CURLcode       errcode;
-
-    /* Try it with  curl -X PUT -d '*/
-    clixon_debug(CLIXON_DBG_STREAM, "curl -X POST -d '%s' %s",
-        postfields, url);
-    /* Set up curl for doing the communication with the controller */
-    if ((curl = curl_easy_init()) == NULL) {
-        clixon_debug(CLIXON_DBG_STREAM, "curl_easy_init");
-        goto done;
+    int   retval = -1;
+    CURL *curl = NULL;
+    cbuf *cb;
+
+    if (sp->sp_dropped){
+        clixon_log(NULL, LOG_WARNING, "Stream publish to %s: %u events dropped",
+                   sp->sp_url, sp->sp_dropped);
+        sp->sp_dropped = 0;
     }
-    if ((err = malloc(CURL_ERROR_SIZE)) == NULL) {
-        clixon_debug(CLIXON_DBG_STREAM, "malloc");
+    /* Swap buffers: queued events are posted, new events are queued */
+    cb = sp->sp_post;
+    sp->sp_post = sp->sp_queue;
+    sp->sp_queue = cb;
+    clixon_debug(CLIXON_DBG_STREAM, "curl -X POST %s: %u events", sp->sp_url, sp->sp_nr);
+    sp->sp_nr = 0;
+    if ((curl = curl_easy_init()) == NULL) {
+        clixon_err(OE_UNIX, 0, "curl_easy_init");
         goto done;
     }
-    curl_easy_setopt(curl, CURLOPT_URL, url);
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, curl_get_cb);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &cb);
-    curl_easy_setopt(curl, CURLOPT_ERRORBUFFER, err);
+    sp->sp_err[0] = '\0';
+    curl_easy_setopt(curl, CURLOPT_URL, sp->sp_url);
+    curl_easy_setopt(curl, CURLOPT_PRIVATE, sp);
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, curl_discard_cb);
+    curl_easy_setopt(curl, CURLOPT_ERRORBUFFER, sp->sp_err);
     curl_easy_setopt(curl, CURLOPT_POST, 1);
-    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, postfields);
-    curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, strlen(postfields));
-
+    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, cbuf_get(sp->sp_post));
+    curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, (long)cbuf_len(sp->sp_post));
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT, (long)STREAM_PUBLISH_TIMEOUT);
+    curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
     if (clixon_debug_get())
         curl_easy_setopt(curl, CURLOPT_VERBOSE, 1);
-    if ((errcode = curl_easy_perform(curl)) != CURLE_OK){
-        clixon_debug(CLIXON_DBG_STREAM, "curl: %s(%d)", err, errcode);
-        retval = 0;
+    if (curl_multi_add_handle(_stream_pub_multi, curl) != CURLM_OK){
+        clixon_err(OE_UNIX, 0, "curl_multi_add_handle");
         goto done;
     }
-    if (getdata && cb.b_buf){
-        *getdata = cb.b_buf;
-        cb.b_buf = NULL;
-    }
-    retval = 1;
-  done:
-    if (err)
-        free(err);
-    if (cb.b_buf)
-        free(cb.b_buf);
+    sp->sp_curl = curl;
+    curl = NULL;
+    retval = 0;
+ done:
     if (curl)
-        curl_easy_cleanup(curl);   /* cleanup */
+        curl_easy_cleanup(curl);
     return retval;
 }
 
-/*! Stream callback for example stream notification 
+/*! Free stream publisher, abort POST in progress
+ */
+static void
+stream_publish_free(struct stream_pub *sp)
+{
+    if (sp->sp_curl){
+        if (_stream_pub_multi)
+            curl_multi_remove_handle(_stream_pub_multi, sp->sp_curl);
+        curl_easy_cleanup(sp->sp_curl);
+    }
+    if (sp->sp_url)
+        free(sp->sp_url);
+    if (sp->sp_queue)
+        cbuf_free(sp->sp_queue);
+    if (sp->sp_post)
+        cbuf_free(sp->sp_post);
+    free(sp);
+}
+
+/*! Stream callback for publishing stream notifications
  *
- * Push via curl_post to publish stream event
+ * Queue event and post it if no POST is in progress, otherwise it is posted with other
+ * queued events when the POST is done.
+ * If STREAM_PUBLISH_QUEUE_MAX events are queued, new events are dropped.
  * @param[in]  h     Clixon handle
  * @param[in]  op    Operation: 0 OK, 1 Close
  * @param[in]  event Event as XML
- * @param[in]  arg   Extra argument provided in stream_ss_add
+ * @param[in]  arg   Stream publisher
  * @retval     0     OK
  * @retval    -1     Error
  * @see stream_ss_add
@@ -1045,65 +1821,81 @@ stream_publish_cb(clixon_handle h,
                   cxobj        *event,
                   void         *arg)
 {
-    int   retval = -1;
-    cbuf *u = NULL; /* stream pub (push) url */
-    cbuf *d = NULL; /* (XML) data to push */
-    char *pub_prefix;
-    char *result = NULL;
-    char *stream = (char*)arg;
+    int                retval = -1;
+    struct stream_pub *sp = (struct stream_pub *)arg;
 
     clixon_debug(CLIXON_DBG_STREAM, "");
-    if (op != 0)
+    if (op != 0){
+        DELQ(sp, _stream_pub_list, struct stream_pub *);
+        stream_publish_free(sp);
         goto ok;
-    /* Create pub url */
-    if ((u = cbuf_new()) == NULL){
-        clixon_err(OE_XML, errno, "cbuf_new");
-        goto done;
     }
-    if ((pub_prefix = clicon_option_str(h, "CLICON_STREAM_PUB")) == NULL){
-        clixon_err(OE_CFG, ENOENT, "CLICON_STREAM_PUB not defined");
-        goto done;
-    }
-    cprintf(u, "%s/%s", pub_prefix, stream);
-    /* Create XML data as string */
-    if ((d = cbuf_new()) == NULL){
-        clixon_err(OE_XML, errno, "cbuf_new");
-        goto done;
+    if (_stream_pub_multi == NULL)
+        goto ok;
+    if (sp->sp_nr >= STREAM_PUBLISH_QUEUE_MAX){
+        sp->sp_dropped++;
+        goto ok;
     }
-    if (clixon_xml2cbuf(d, event, 0, 0, NULL, -1, 0) < 0)
+    if (clixon_xml2cbuf(sp->sp_queue, event, 0, 0, NULL, -1, 0) < 0)
         goto done;
-    if (url_post(cbuf_get(u),     /* url+stream */
-                 cbuf_get(d),     /* postfields */
-                 &result) < 0)    /* result as xml */
+    sp->sp_nr++;
+    /* Curl calls back for sockets and timeouts of the POST */
+    if (sp->sp_curl == NULL &&
+        stream_publish_post(sp) < 0)
         goto done;
-    if (result)
-        clixon_debug(CLIXON_DBG_STREAM, "%s", result);
  ok:
     retval = 0;
  done:
-    if (u)
-        cbuf_free(u);
-    if (d)
-        cbuf_free(d);
-    if (result)
-        free(result);
     return retval;
 }
 #endif /* CLIXON_PUBLISH_STREAMS */
 
 /*! Publish all streams on a pubsub channel, eg using SSE
+ *
+ * Events are posted to CLICON_STREAM_PUB/<stream> without blocking
  */
 int
 stream_publish(clixon_handle h,
                char         *stream)
 {
 #ifdef CLIXON_PUBLISH_STREAMS
-    int retval = -1;
+    int                retval = -1;
+    struct stream_pub *sp = NULL;
+    char              *pub_prefix;
+    cbuf              *cb = NULL;
 
-    if (stream_ss_add(h, stream, NULL, NULL, NULL, stream_publish_cb, (void*)stream) < 0)
+    if ((pub_prefix = clicon_option_str(h, "CLICON_STREAM_PUB")) == NULL){
+        clixon_err(OE_CFG, ENOENT, "CLICON_STREAM_PUB not defined");
+        goto done;
+    }
+    if ((sp = calloc(1, sizeof(*sp))) == NULL){
+        clixon_err(OE_UNIX, errno, "calloc");
         goto done;
+    }
+    if ((cb = cbuf_new()) == NULL){
+        clixon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    cprintf(cb, "%s/%s", pub_prefix, stream);
+    if ((sp->sp_url = strdup(cbuf_get(cb))) == NULL){
+        clixon_err(OE_UNIX, errno, "strdup");
+        goto done;
+    }
+    if ((sp->sp_queue = cbuf_new()) == NULL ||
+        (sp->sp_post = cbuf_new()) == NULL){
+        clixon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    if (stream_ss_add(h, stream, NULL, NULL, NULL, stream_publish_cb, (void*)sp) == NULL)
+        goto done;
+    ADDQ(sp, _stream_pub_list);
+    sp = NULL;
     retval = 0;
  done:
+    if (sp)
+        stream_publish_free(sp);
+    if (cb)
+        cbuf_free(cb);
     return retval;
 #else
     clixon_log(h, LOG_WARNING, "%s called but CLIXON_PUBLISH_STREAMS not enabled (enable with configure --enable-publish)", __func__);
@@ -1122,6 +1914,12 @@ stream_publish_init()
         clixon_err(OE_PLUGIN, errno, "curl_global_init");
         goto done;
     }
+    if ((_stream_pub_multi = curl_multi_init()) == NULL){
+        clixon_err(OE_PLUGIN, 0, "curl_multi_init");
+        goto done;
+    }
+    curl_multi_setopt(_stream_pub_multi, CURLMOPT_SOCKETFUNCTION, curl_pub_socket_cb);
+    curl_multi_setopt(_stream_pub_multi, CURLMOPT_TIMERFUNCTION, curl_pub_timer_cb);
     retval = 0;
  done:
     return retval;
@@ -1130,10 +1928,30 @@ stream_publish_init()
 #endif
 }
 
+/*! Abort publish POSTs in progress and clean up curl
+ *
+ * Stream publishers are freed when their subscriptions are removed
+ */
 int
 stream_publish_exit()
 {
 #ifdef CLIXON_PUBLISH_STREAMS
+    struct stream_pub *sp;
+
+    if ((sp = _stream_pub_list) != NULL)
+        do {
+            if (sp->sp_curl){
+                curl_multi_remove_handle(_stream_pub_multi, sp->sp_curl);
+                curl_easy_cleanup(sp->sp_curl);
+                sp->sp_curl = NULL;
+            }
+            sp = NEXTQ(struct stream_pub *, sp);
+        } while (sp && sp != _stream_pub_list);
+    if (_stream_pub_multi){
+        curl_multi_cleanup(_stream_pub_multi);
+        _stream_pub_multi = NULL;
+    }
+    clixon_event_unreg_timeout(stream_publish_timeout, NULL);
     curl_global_cleanup();
 #endif
     return 0;
@@ -42,6 +42,7 @@
 #include <string.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include <stddef.h>
 #include <errno.h>
 #include <ctype.h>
 
@@ -556,13 +557,8 @@ xml_chardata_encode(char      **escp,
     int     retval = -1;
     char   *str = NULL;  /* Expanded format string w stdarg */
     int     fmtlen;
-    char   *esc = NULL;
-    int     l;
-    int     len;
-    int     i, j;
-    int     cdata; /* when set, skip encoding */
+    cbuf   *cb = NULL;
     va_list args;
-    size_t  slen;
 
     /* Two steps: (1) read in the complete format string */
     va_start(args, fmt); /* dryrun */
@@ -576,129 +572,23 @@ xml_chardata_encode(char      **escp,
     va_start(args, fmt); /* real */
     fmtlen = vsnprintf(str, fmtlen, fmt, args) + 1;
     va_end(args);
-    /* Now str is the combined fmt + ... 
-     * Step (2) encode and expand str --> enc
-     * First compute length (do nothing) */
-    len = 0; cdata = 0;
-    slen = strlen(str);
-    for (i=0; i<slen; i++){
-        if (cdata){
-            if (strncmp(&str[i], "]]>", strlen("]]>")) == 0)
-                cdata = 0;
-            len++;
-        }
-        else
-            switch (str[i]){
-            case '&':
-                len += strlen("&amp;");
-                break;
-            case '<':
-                if (strncmp(&str[i], "<![CDATA[", strlen("<![CDATA[")) == 0){
-                    len++;
-                    cdata++;
-                }
-                else
-                    len += strlen("&lt;");
-                break;
-            case '>':
-                len += strlen("&gt;");
-                break;
-            case '\'':
-                if (quote)
-                    len += strlen("&apos;");
-                else
-                    len++;
-            break;
-            case '"':
-                if (quote)
-                    len += strlen("&quot;");
-                else
-                    len++;
-                break;
-            default:
-                len++;
-            }
-    }
-    len++; /* trailing \0 */
-    /* We know length, allocate encoding buffer  */
-    if ((esc = malloc(len)) == NULL){
-        clixon_err(OE_UNIX, errno, "malloc");
+    /* Step (2) encode and expand str --> esc */
+    if ((cb = cbuf_new()) == NULL){
+        clixon_err(OE_UNIX, errno, "cbuf_new");
         goto done;
     }
-    memset(esc, 0, len);
-    /* Same code again, but now actually encode into output buffer */
-    j = 0; cdata = 0;
-    slen = strlen(str);
-    for (i=0; i<slen; i++){
-        if (cdata){
-            if (strncmp(&str[i], "]]>", strlen("]]>")) == 0){
-                cdata = 0;
-                esc[j++] = str[i++];
-                esc[j++] = str[i++];
-            }
-            esc[j++] = str[i];
-        }
-        else
-        switch (str[i]){
-        case '&':
-            if ((l=snprintf(&esc[j], 6, "&amp;")) < 0){
-                clixon_err(OE_UNIX, errno, "snprintf");
-                goto done;
-            }
-            j += l;
-            break;
-        case '<':
-            if (strncmp(&str[i], "<![CDATA[", strlen("<![CDATA[")) == 0){
-                esc[j++] = str[i];
-                cdata++;
-                break;
-            }
-            if ((l=snprintf(&esc[j], 5, "&lt;")) < 0){
-                clixon_err(OE_UNIX, errno, "snprintf");
-                goto done;
-            }
-            j += l;
-            break;
-        case '>':
-            if ((l=snprintf(&esc[j], 5, "&gt;")) < 0){
-                clixon_err(OE_UNIX, errno, "snprintf");
-                goto done;
-            }
-            j += l;
-            break;
-        case '\'':
-            if (quote){
-                if ((l=snprintf(&esc[j], 7, "&apos;")) < 0){
-                    clixon_err(OE_UNIX, errno, "snprintf");
-                    goto done;
-                }
-                j += l;
-            }
-            else
-                esc[j++] = str[i];
-            break;
-        case '"':
-            if (quote){
-                if ((l=snprintf(&esc[j], 7, "&quot;")) < 0){
-                    clixon_err(OE_UNIX, errno, "snprintf");
-                    goto done;
-                }
-                j += l;
-            }
-            else
-                esc[j++] = str[i];
-            break;
-        default:
-            esc[j++] = str[i];
-        }
+    if (xml_chardata_cbuf_append(cb, quote, str) < 0)
+        goto done;
+    if ((*escp = strdup(cbuf_get(cb))) == NULL){
+        clixon_err(OE_UNIX, errno, "strdup");
+        goto done;
     }
-    *escp = esc;
     retval = 0;
  done:
     if (str)
         free(str);
-    if (retval < 0 && esc)
-        free(esc);
+    if (cb)
+        cbuf_free(cb);
     return retval;
 }
 
@@ -715,59 +605,48 @@ xml_chardata_cbuf_append(cbuf       *cb,
                          int         quote,
                          const char *str)
 {
-    int    retval = -1;
-    int    i;
-    int    cdata; /* when set, skip encoding */
-    size_t len;
+    const char *s = str;
+    const char *e;
+    size_t      n;
 
-    /* The original of this code is in xml_chardata_encode */
-    /* Step: encode and expand str --> enc */
-    /* Same code again, but now actually encode into output buffer */
-    cdata = 0;
-    len = strlen(str);
-    for (i=0; i<len; i++){
-        if (cdata){
-            if (strncmp(&str[i], "]]>", strlen("]]>")) == 0){
-                cdata = 0;
-                cbuf_append(cb, str[i++]);
-                cbuf_append(cb, str[i++]);
-            }
-            cbuf_append(cb, str[i]);
+    /* Copy runs of characters not encoded in bulk, strcspn is vectorized in libc */
+    while (*s != '\0'){
+        if ((n = strcspn(s, quote ? "&<>'\"" : "&<>")) > 0){
+            cbuf_append_buf(cb, (void*)s, n);
+            s += n;
         }
-        else
-            switch (str[i]){
-            case '&':
-                cbuf_append_str(cb, "&amp;");
-                break;
-            case '<':
-                if (strncmp(&str[i], "<![CDATA[", strlen("<![CDATA[")) == 0){
-                    cbuf_append(cb, str[i]);
-                    cdata++;
-                    break;
-                }
-                cbuf_append_str(cb, "&lt;");
-                break;
-            case '>':
-                cbuf_append_str(cb, "&gt;");
-                break;
-            case '\'':
-                if (quote)
-                    cbuf_append_str(cb, "&apos;");
-                else
-                    cbuf_append(cb, str[i]);
-                break;
-            case '"':
-                if (quote)
-                    cbuf_append_str(cb, "&quot;");
+        switch (*s){
+        case '\0':
+            continue;
+        case '&':
+            cbuf_append_str(cb, "&amp;");
+            break;
+        case '<':
+            if (strncmp(s, "<![CDATA[", strlen("<![CDATA[")) == 0){
+                /* CDATA is not encoded, up to and including "]]>" */
+                if ((e = strstr(s, "]]>")) != NULL)
+                    e += strlen("]]>");
                 else
-                    cbuf_append(cb, str[i]);
-                break;
-            default:
-                cbuf_append(cb, str[i]);
+                    e = s + strlen(s);
+                cbuf_append_buf(cb, (void*)s, e - s);
+                s = e;
+                continue;
             }
+            cbuf_append_str(cb, "&lt;");
+            break;
+        case '>':
+            cbuf_append_str(cb, "&gt;");
+            break;
+        case '\'':
+            cbuf_append_str(cb, "&apos;");
+            break;
+        case '"':
+            cbuf_append_str(cb, "&quot;");
+            break;
+        }
+        s++;
     }
-    retval = 0;
-    return retval;
+    return 0;
 }
 
 /*! xml decode &...; 
@@ -1291,6 +1170,197 @@ clicon_strndup(const char *str,
 }
 #endif /* ! HAVE_STRNDUP */
 
+/*! Interned string entry, the string itself is allocated inline after the header
+ *
+ * @see clixon_str_intern
+ */
+struct intern_entry{
+    struct intern_entry *ie_next;   /* Next entry in hash bucket */
+    uint32_t             ie_hash;   /* Full hash value of string */
+    uint32_t             ie_refcnt; /* Number of references */
+    char                 ie_str[];  /* Null-terminated string */
+};
+
+/* Initial number of intern hash buckets, power of two */
+#define INTERN_BUCKETS_START 1024
+
+/* Interned string hash table, grows when load factor exceeds 2 */
+static struct intern_entry **_intern_vec = NULL;
+static uint32_t              _intern_size = 0; /* Number of buckets */
+static uint64_t              _intern_nr = 0;   /* Number of entries */
+
+/*! FNV-1a hash of string
+ */
+static uint32_t
+intern_hash(const char *str)
+{
+    uint32_t h = 2166136261u;
+
+    while (*str){
+        h ^= (uint8_t)*str++;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+/*! Double the number of hash buckets and rehash all entries
+ *
+ * @retval  0   OK
+ * @retval -1   Error
+ */
+static int
+intern_grow(void)
+{
+    struct intern_entry **vec;
+    struct intern_entry  *ie;
+    uint32_t              size;
+    uint32_t              i;
+    uint32_t              b;
+
+    size = _intern_size ? 2*_intern_size : INTERN_BUCKETS_START;
+    if ((vec = calloc(size, sizeof(struct intern_entry *))) == NULL){
+        clixon_err(OE_UNIX, errno, "calloc");
+        return -1;
+    }
+    for (i=0; i<_intern_size; i++){
+        while ((ie = _intern_vec[i]) != NULL){
+            _intern_vec[i] = ie->ie_next;
+            b = ie->ie_hash & (size-1);
+            ie->ie_next = vec[b];
+            vec[b] = ie;
+        }
+    }
+    if (_intern_vec)
+        free(_intern_vec);
+    _intern_vec = vec;
+    _intern_size = size;
+    return 0;
+}
+
+/*! Intern a string: return a shared, reference-counted copy of the string
+ *
+ * Equal strings return the same pointer, which means two interned strings are equal iff
+ * their pointers are equal.
+ * @param[in]  str  String to intern
+ * @retval     istr Interned string, do not modify, free with clixon_str_intern_free
+ * @retval     NULL Error
+ * @code
+ *   char *s;
+ *   if ((s = clixon_str_intern("name")) == NULL)
+ *      err;
+ *   ...
+ *   clixon_str_intern_free(s);
+ * @endcode
+ */
+char *
+clixon_str_intern(const char *str)
+{
+    struct intern_entry *ie;
+    uint32_t             h;
+    size_t               len;
+
+    if (str == NULL){
+        clixon_err(OE_UNIX, EINVAL, "str is NULL");
+        return NULL;
+    }
+    if (_intern_nr >= 2*(uint64_t)_intern_size && intern_grow() < 0)
+        return NULL;
+    h = intern_hash(str);
+    for (ie = _intern_vec[h & (_intern_size-1)]; ie; ie = ie->ie_next)
+        if (ie->ie_hash == h && strcmp(ie->ie_str, str) == 0){
+            ie->ie_refcnt++;
+            return ie->ie_str;
+        }
+    len = strlen(str) + 1;
+    if ((ie = malloc(align4(sizeof(struct intern_entry) + len))) == NULL){
+        clixon_err(OE_UNIX, errno, "malloc");
+        return NULL;
+    }
+    ie->ie_hash = h;
+    ie->ie_refcnt = 1;
+    memcpy(ie->ie_str, str, len);
+    ie->ie_next = _intern_vec[h & (_intern_size-1)];
+    _intern_vec[h & (_intern_size-1)] = ie;
+    _intern_nr++;
+    return ie->ie_str;
+}
+
+/*! Release a reference to an interned string, free it when last reference is released
+ *
+ * @param[in]  istr  String returned by clixon_str_intern
+ * @retval     0     OK
+ */
+int
+clixon_str_intern_free(char *istr)
+{
+    struct intern_entry  *ie;
+    struct intern_entry **iep;
+
+    if (istr == NULL)
+        return 0;
+    ie = (struct intern_entry *)(istr - offsetof(struct intern_entry, ie_str));
+    if (--ie->ie_refcnt > 0)
+        return 0;
+    for (iep = &_intern_vec[ie->ie_hash & (_intern_size-1)]; *iep; iep = &(*iep)->ie_next)
+        if (*iep == ie){
+            *iep = ie->ie_next;
+            break;
+        }
+    free(ie);
+    _intern_nr--;
+    return 0;
+}
+
+/*! Get statistics of interned strings
+ *
+ * @param[out] nrp  Number of distinct interned strings
+ * @param[out] szp  Allocated memory of table and strings
+ * @retval     0    OK
+ */
+int
+clixon_str_intern_stats(uint64_t *nrp,
+                        size_t   *szp)
+{
+    struct intern_entry *ie;
+    size_t               sz;
+    uint32_t             i;
+
+    if (nrp)
+        *nrp = _intern_nr;
+    if (szp){
+        sz = _intern_size*sizeof(struct intern_entry *);
+        for (i=0; i<_intern_size; i++)
+            for (ie = _intern_vec[i]; ie; ie = ie->ie_next)
+                sz += align4(sizeof(struct intern_entry) + strlen(ie->ie_str) + 1);
+        *szp = sz;
+    }
+    return 0;
+}
+
+/*! Free intern table including all remaining strings
+ *
+ * Call at exit, no interned strings may be accessed after this
+ * @retval  0   OK
+ */
+int
+clixon_str_intern_exit(void)
+{
+    struct intern_entry *ie;
+    uint32_t             i;
+
+    for (i=0; i<_intern_size; i++)
+        while ((ie = _intern_vec[i]) != NULL){
+            _intern_vec[i] = ie->ie_next;
+            free(ie);
+        }
+    if (_intern_vec)
+        free(_intern_vec);
+    _intern_vec = NULL;
+    _intern_size = 0;
+    _intern_nr = 0;
+    return 0;
+}
+
 /*
  * Turn this on for uni-test programs
  * Usage: clixon_string join
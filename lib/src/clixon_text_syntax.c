@@ -147,8 +147,10 @@ text_wdef(cxobj            *x,
                     if ((yc = xml_spec(xc)) != NULL){
                         if ((ret = text_wdef(xc, yc, wdef)) < 0)
                             goto done;
-                        if (ret == 1)
+                        if (ret == 1){
                             keep = 1;
+                            break;
+                        }
                     }
                 }
             }
@@ -189,182 +191,6 @@ text_wdef(cxobj            *x,
     return retval;
 }
 
-/*! Translate XML to a "pseudo-code" textual format using a callback - internal function
- *
- * @param[in]     xn       XML object to print
- * @param[in]     fn       Callback to make print function
- * @param[in]     f        File to print to
- * @param[in]     level    Print PRETTYPRINT_INDENT spaces per level in front of each line
- * @param[in]     autocliext How to handle autocli extensions: 0: ignore 1: follow
- * @param[in]     wdef     With-defaults parameter
- * @param[in,out] leafl    Leaflist state for keeping track of when [] ends
- * @param[in,out] leaflname Leaflist state for []
- * @retval        0        OK
- * @retval       -1        Error
- * leaflist state:
- * 0: No leaflist
- * 1: In leaflist
- * @see text2cbuf to buffer (slower)
- * XXX No with-defaults support as in xml2cbuf
- */
-static int
-text2file(cxobj            *xn,
-          clicon_output_cb *fn,
-          FILE             *f,
-          int               level,
-          int               autocliext,
-          withdefaults_type wdef,
-          int              *leafl,
-          char            **leaflname)
-
-{
-    int        retval = -1;
-    cxobj     *xc = NULL;
-    int        children=0;
-    yang_stmt *yn;
-    char      *value;
-    cg_var    *cvi;
-    cvec      *cvk = NULL; /* vector of index keys */
-    cbuf      *cbb = NULL;
-#ifndef TEXT_SYNTAX_NOPREFIX
-    yang_stmt *yp = NULL;
-    yang_stmt *ymod;
-    yang_stmt *ypmod;
-    char      *prefix = NULL;
-#endif
-    int        ret;
-
-    if (xn == NULL || fn == NULL){
-        clixon_err(OE_XML, EINVAL, "xn or fn is NULL");
-        goto done;
-    }
-    if ((yn = xml_spec(xn)) != NULL){
-        if ((ret = text_wdef(xn, yn, wdef)) < 0)
-            goto done;
-        if (ret == 0)
-            goto ok;
-        if (autocliext){
-            ret = 0;
-            if (yang_extension_value(yn, "hide-show", CLIXON_AUTOCLI_NS, &ret, NULL) < 0)
-                goto done;
-            if (ret)
-                goto ok;
-        }
-#ifndef TEXT_SYNTAX_NOPREFIX
-        /* Find out prefix if needed: topmost or new module a la API-PATH */
-        if (ys_real_module(yn, &ymod) < 0)
-            goto done;
-        if ((yp = yang_parent_get(yn)) != NULL &&
-            yp != ymod){
-            if (ys_real_module(yp, &ypmod) < 0)
-                goto done;
-            if (ypmod != ymod)
-                prefix = yang_argument_get(ymod);
-        }
-        else
-            prefix = yang_argument_get(ymod);
-#endif
-        if (yang_keyword_get(yn) == Y_LIST){
-            if ((cvk = yang_cvec_get(yn)) == NULL){
-                clixon_err(OE_YANG, 0, "No keys");
-                goto done;
-            }
-        }
-    }
-    if (*leafl && yn){
-        if (yang_keyword_get(yn) == Y_LEAF_LIST && strcmp(*leaflname, yang_argument_get(yn)) == 0)
-            ;
-        else{
-            *leafl = 0;
-            *leaflname = NULL;
-            (*fn)(f, "%*s]\n", PRETTYPRINT_INDENT*(level), "");
-        }
-    }
-    xc = NULL;     /* count children (elements and bodies, not attributes) */
-    while ((xc = xml_child_each(xn, xc, -1)) != NULL)
-        if (xml_type(xc) == CX_ELMNT || xml_type(xc) == CX_BODY)
-            children++;
-    if (children == 0){ /* If no children print line */
-        switch (xml_type(xn)){
-        case CX_BODY:{
-            if ((cbb = cbuf_new()) == NULL){
-                clixon_err(OE_UNIX, errno, "cbuf_new");
-                goto done;
-            }
-            value = xml_value(xn);
-            if (index(value, ' ') != NULL)
-                cprintf(cbb, "\"%s\"", value);
-            else
-                cprintf(cbb, "%s", value);
-            if (*leafl)                            /* Skip keyword if leaflist */
-                (*fn)(f, "%*s%s\n", PRETTYPRINT_INDENT*level, "", cbuf_get(cbb));
-            else
-                (*fn)(f, "%s;\n", cbuf_get(cbb));
-            break;
-        }
-        case CX_ELMNT:
-            (*fn)(f, "%*s%s", PRETTYPRINT_INDENT*level, "", xml_name(xn));
-            cvi = NULL;             /* Lists only */
-            while ((cvi = cvec_each(cvk, cvi)) != NULL) {
-                if ((xc = xml_find_type(xn, NULL, cv_string_get(cvi), CX_ELMNT)) != NULL)
-                    (*fn)(f, " %s", xml_body(xc));
-            }
-            (*fn)(f, ";\n");
-            break;
-        default:
-            break;
-        }
-        goto ok;
-    }
-    if (*leafl == 0){
-        (*fn)(f, "%*s", PRETTYPRINT_INDENT*level, "");
-#ifndef TEXT_SYNTAX_NOPREFIX
-        if (prefix)
-            (*fn)(f, "%s:", prefix);
-#endif
-        (*fn)(f, "%s", xml_name(xn));
-    }
-    cvi = NULL;         /* Lists only */
-    while ((cvi = cvec_each(cvk, cvi)) != NULL) {
-        if ((xc = xml_find_type(xn, NULL, cv_string_get(cvi), CX_ELMNT)) != NULL)
-            (*fn)(f, " %s", xml_body(xc));
-    }
-    if (yn && yang_keyword_get(yn) == Y_LEAF_LIST && *leafl){
-        ;
-    }
-    else if (yn && yang_keyword_get(yn) == Y_LEAF_LIST && *leafl == 0){
-        *leafl = 1;
-        *leaflname = yang_argument_get(yn);
-        (*fn)(f, " [\n");
-    }
-    else if (!tleaf(xn))
-        (*fn)(f, " {\n");
-    else
-        (*fn)(f, " ");
-    xc = NULL;
-    while ((xc = xml_child_each(xn, xc, -1)) != NULL){
-        if (xml_type(xc) == CX_ELMNT || xml_type(xc) == CX_BODY){
-            if (yn && yang_key_match(yn, xml_name(xc), NULL))
-                continue; /* Skip keys, already printed */
-            if (text2file(xc, fn, f, level+1, autocliext, wdef, leafl, leaflname) < 0)
-                break;
-        }
-    }
-    /* Stop leaf-list printing (ie []) if no longer leaflist and same name */
-    if (yn && yang_keyword_get(yn) != Y_LEAF_LIST && *leafl != 0){
-        *leafl = 0;
-        (*fn)(f, "%*s]\n", PRETTYPRINT_INDENT*(level+1), "");
-    }
-    if (!tleaf(xn))
-        (*fn)(f, "%*s}\n", PRETTYPRINT_INDENT*level, "");
- ok:
-    retval = 0;
- done:
-    if (cbb)
-        cbuf_free(cbb);
-    return retval;
-}
-
 #ifndef TEXT_SYNTAX_NOPREFIX
 static char *
 get_prefix(yang_stmt *yn)
@@ -390,69 +216,164 @@ get_prefix(yang_stmt *yn)
 }
 #endif
 
-/*! Translate XML to a "pseudo-code" textual format using a callback - internal function
+/* Number of entries of yang node cache of text output, power of two */
+#define TEXT_YCACHE_SIZE 128
+
+/* Flush output buffer to file when it exceeds this size */
+#define TEXT_EMIT_FLUSH 4096
+
+/*! Yang node info for text output, computed once per yang node and output
+ */
+struct text_ynode {
+    yang_stmt *tn_ys;      /* Yang node, key of cache */
+    char      *tn_prefix;  /* Module prefix if topmost or new module, else NULL */
+    int        tn_hide;    /* Hidden by autocli hide-show extension */
+};
+
+/*! State of one text output
+ *
+ * All output is made to a buffer. If a file is given, the buffer is flushed to it in
+ * chunks, so that each line is not a separate print call.
+ */
+struct text_emit {
+    cbuf              *te_cb;         /* Output buffer */
+    FILE              *te_f;          /* File to flush to, or NULL */
+    clicon_output_cb  *te_fn;         /* Print function of file */
+    int                te_autocliext; /* How to handle autocli extensions: 0: ignore 1: follow */
+    withdefaults_type  te_wdef;       /* With-defaults parameter */
+    int                te_leafl;      /* Leaflist state: 1 if in leaflist */
+    char              *te_leaflname;  /* Leaflist state: name of leaflist */
+    struct text_ynode *te_ycache;     /* Yang node cache of TEXT_YCACHE_SIZE, or NULL */
+};
+
+/*! Get yang node info for text output, from cache if possible
+ *
+ * @param[in]  te   Text output state
+ * @param[in]  ys   Yang node
+ * @param[out] tn   Yang node info, in cache or in tn0
+ * @param[in]  tn0  Storage if no cache
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+text_ynode_get(struct text_emit   *te,
+               yang_stmt          *ys,
+               struct text_ynode  *tn0,
+               struct text_ynode **tn)
+{
+    struct text_ynode *t;
+    int                ret;
+
+    if (te->te_ycache){
+        t = &te->te_ycache[((uintptr_t)ys >> 4) & (TEXT_YCACHE_SIZE-1)];
+        if (t->tn_ys == ys){
+            *tn = t;
+            return 0;
+        }
+    }
+    else
+        t = tn0;
+    t->tn_ys = ys;
+    t->tn_prefix = NULL;
+    t->tn_hide = 0;
+#ifndef TEXT_SYNTAX_NOPREFIX
+    t->tn_prefix = get_prefix(ys);
+#endif
+    if (te->te_autocliext){
+        ret = 0;
+        if (yang_extension_value(ys, "hide-show", CLIXON_AUTOCLI_NS, &ret, NULL) < 0){
+            t->tn_ys = NULL;
+            return -1;
+        }
+        t->tn_hide = ret;
+    }
+    *tn = t;
+    return 0;
+}
+
+/*! Flush text output buffer to file
  *
+ * @param[in]  te    Text output state
+ * @param[in]  force If 0 only flush if buffer exceeds TEXT_EMIT_FLUSH
+ */
+static void
+text_emit_flush(struct text_emit *te,
+                int               force)
+{
+    if (te->te_fn == NULL || cbuf_len(te->te_cb) == 0)
+        return;
+    if (force || cbuf_len(te->te_cb) >= TEXT_EMIT_FLUSH){
+        (*te->te_fn)(te->te_f, "%s", cbuf_get(te->te_cb));
+        cbuf_reset(te->te_cb);
+    }
+}
+
+/*! Print end of leaf-list
+ *
+ * File output puts the bracket after the indentation, buffer output right-aligns it in
+ * the indentation, which is kept as is.
+ */
+static void
+text_emit_leafl_end(struct text_emit *te,
+                    char             *prepend,
+                    int               level1)
+{
+    if (prepend)
+        cprintf(te->te_cb, "%s", prepend);
+    if (te->te_f)
+        cprintf(te->te_cb, "%*s]\n", level1, "");
+    else
+        cprintf(te->te_cb, "%*s\n", level1, "]");
+}
+
+/*! Translate XML to a "pseudo-code" textual format - internal function
+ *
+ * @param[in]     te       Text output state
  * @param[in]     xn       XML object to print
- * @param[in]     fn       Callback to make print function
- * @param[in]     f        File to print to
  * @param[in]     level    Print PRETTYPRINT_INDENT spaces per level in front of each line
- * @param[in]     prefix   Add string to beginning of each line (or NULL)
- * @param[in]     autocliext How to handle autocli extensions: 0: ignore 1: follow
- * @param[in]     wdef     With-defaults parameter
- * @param[in,out] leafl    Leaflist state for keeping track of when [] ends
- * @param[in,out] leaflname Leaflist state for []
+ * @param[in]     prepend  Add string to beginning of each line (or NULL)
  * @retval        0        OK
  * @retval       -1        Error
- * leaflist state:
- * 0: No leaflist
- * 1: In leaflist
- * @see text2file but to file (faster)
  * @see xml2cbuf_recurse
  */
 static int
-text2cbuf(cbuf             *cb,
+text2emit(struct text_emit *te,
           cxobj            *xn,
           int               level,
-          char             *prepend,
-          int               autocliext,
-          withdefaults_type wdef,
-          int              *leafl,
-          char            **leaflname)
+          char             *prepend)
 {
-    int        retval = -1;
-    cxobj     *xc = NULL;
-    int        children=0;
-    yang_stmt *yn;
-    char      *value;
-    cg_var    *cvi;
-    cvec      *cvk = NULL; /* vector of index keys */
-    cbuf      *cbb = NULL;
-    int        level1;
-    char      *prefix = NULL;
-    int        ret;
+    int                retval = -1;
+    cbuf              *cb = te->te_cb;
+    cxobj             *xc = NULL;
+    int                children=0;
+    yang_stmt         *yn;
+    char              *value;
+    cg_var            *cvi;
+    cvec              *cvk = NULL; /* vector of index keys */
+    int                level1;
+    char              *prefix = NULL;
+    struct text_ynode  tn0;
+    struct text_ynode *tn;
+    int                leaf;
+    int                ret;
 
-    if (xn == NULL || cb == NULL){
-        clixon_err(OE_XML, EINVAL, "xn or cb is NULL");
+    if (xn == NULL){
+        clixon_err(OE_XML, EINVAL, "xn is NULL");
         goto done;
     }
     level1 = level*PRETTYPRINT_INDENT;
     if (prepend)
         level1 -= strlen(prepend);
     if ((yn = xml_spec(xn)) != NULL){
-        if ((ret = text_wdef(xn, yn, wdef)) < 0)
+        if ((ret = text_wdef(xn, yn, te->te_wdef)) < 0)
             goto done;
         if (ret == 0)
             goto ok;
-        if (autocliext){
-            ret = 0;
-            if (yang_extension_value(yn, "hide-show", CLIXON_AUTOCLI_NS, &ret, NULL) < 0)
-                goto done;
-            if (ret)
-                goto ok;
-        }
-#ifndef TEXT_SYNTAX_NOPREFIX
-        prefix = get_prefix(yn);
-#endif
+        if (text_ynode_get(te, yn, &tn0, &tn) < 0)
+            goto done;
+        if (tn->tn_hide)
+            goto ok;
+        prefix = tn->tn_prefix;
         if (yang_keyword_get(yn) == Y_LIST){
             if ((cvk = yang_cvec_get(yn)) == NULL){
                 clixon_err(OE_YANG, 0, "No keys");
@@ -460,15 +381,13 @@ text2cbuf(cbuf             *cb,
             }
         }
     }
-    if (*leafl && yn){
-        if (yang_keyword_get(yn) == Y_LEAF_LIST && strcmp(*leaflname, yang_argument_get(yn)) == 0)
+    if (te->te_leafl && yn){
+        if (yang_keyword_get(yn) == Y_LEAF_LIST && strcmp(te->te_leaflname, yang_argument_get(yn)) == 0)
             ;
         else{
-            *leafl = 0;
-            *leaflname = NULL;
-            if (prepend)
-                cprintf(cb, "%s", prepend);
-            cprintf(cb, "%*s\n", level1, "]");
+            te->te_leafl = 0;
+            te->te_leaflname = NULL;
+            text_emit_leafl_end(te, prepend, level1);
         }
     }
     xc = NULL;     /* count children (elements and bodies, not attributes) */
@@ -477,25 +396,19 @@ text2cbuf(cbuf             *cb,
             children++;
     if (children == 0){ /* If no children print line */
         switch (xml_type(xn)){
-        case CX_BODY:{
-            if ((cbb = cbuf_new()) == NULL){
-                clixon_err(OE_UNIX, errno, "cbuf_new");
-                goto done;
-            }
+        case CX_BODY:
             value = xml_value(xn);
-            if (index(value, ' ') != NULL)
-                cprintf(cbb, "\"%s\"", value);
-            else
-                cprintf(cbb, "%s", value);
-            if (*leafl){                            /* Skip keyword if leaflist */
+            if (te->te_leafl){                    /* Skip keyword if leaflist */
                 if (prepend)
                     cprintf(cb, "%s", prepend);
-                cprintf(cb, "%*s%s\n", level1, "", cbuf_get(cbb));
+                cprintf(cb, "%*s", level1, "");
             }
+            if (index(value, ' ') != NULL)
+                cprintf(cb, "\"%s\"", value);
             else
-                cprintf(cb, "%s;\n", cbuf_get(cbb));
+                cprintf(cb, "%s", value);
+            cprintf(cb, te->te_leafl ? "\n" : ";\n");
             break;
-        }
         case CX_ELMNT:
             if (prepend)
                 cprintf(cb, "%s", prepend);
@@ -512,7 +425,7 @@ text2cbuf(cbuf             *cb,
         }
         goto ok;
     }
-    if (*leafl == 0){
+    if (te->te_leafl == 0){
         if (prepend)
             cprintf(cb, "%s", prepend);
         cprintf(cb, "%*s", level1, "");
@@ -525,15 +438,16 @@ text2cbuf(cbuf             *cb,
         if ((xc = xml_find_type(xn, NULL, cv_string_get(cvi), CX_ELMNT)) != NULL)
             cprintf(cb, " %s", xml_body(xc));
     }
-    if (yn && yang_keyword_get(yn) == Y_LEAF_LIST && *leafl){
+    leaf = tleaf(xn);
+    if (yn && yang_keyword_get(yn) == Y_LEAF_LIST && te->te_leafl){
         ;
     }
-    else if (yn && yang_keyword_get(yn) == Y_LEAF_LIST && *leafl == 0){
-        *leafl = 1;
-        *leaflname = yang_argument_get(yn);
+    else if (yn && yang_keyword_get(yn) == Y_LEAF_LIST && te->te_leafl == 0){
+        te->te_leafl = 1;
+        te->te_leaflname = yang_argument_get(yn);
         cprintf(cb, " [\n");
     }
-    else if (!tleaf(xn))
+    else if (!leaf)
         cprintf(cb, " {\n");
     else
         cprintf(cb, " ");
@@ -542,32 +456,74 @@ text2cbuf(cbuf             *cb,
         if (xml_type(xc) == CX_ELMNT || xml_type(xc) == CX_BODY){
             if (yn && yang_key_match(yn, xml_name(xc), NULL))
                 continue; /* Skip keys, already printed */
-            if (text2cbuf(cb, xc, level+1, prepend, autocliext, wdef, leafl, leaflname) < 0)
+            if (text2emit(te, xc, level+1, prepend) < 0)
                 break;
         }
     }
     /* Stop leaf-list printing (ie []) if no longer leaflist and same name */
-    if (yn && yang_keyword_get(yn) != Y_LEAF_LIST && *leafl != 0){
-        *leafl = 0;
-        if (prepend)
-            cprintf(cb, "%s", prepend);
-        cprintf(cb, "%*s\n", level1 + PRETTYPRINT_INDENT, "]");
+    if (yn && yang_keyword_get(yn) != Y_LEAF_LIST && te->te_leafl != 0){
+        te->te_leafl = 0;
+        text_emit_leafl_end(te, prepend, level1 + PRETTYPRINT_INDENT);
     }
-    if (!tleaf(xn)){
+    if (!leaf){
         if (prepend)
             cprintf(cb, "%s", prepend);
         cprintf(cb, "%*s}\n", level1, "");
     }
+    text_emit_flush(te, 0);
  ok:
     retval = 0;
  done:
-    if (cbb)
-        cbuf_free(cbb);
+    return retval;
+}
+
+/*! Translate XML to a "pseudo-code" textual format to a cbuf - internal function
+ *
+ * @param[in]     cb       Buffer to print to
+ * @param[in]     xn       XML object to print
+ * @param[in]     level    Print PRETTYPRINT_INDENT spaces per level in front of each line
+ * @param[in]     prepend  Add string to beginning of each line (or NULL)
+ * @param[in]     autocliext How to handle autocli extensions: 0: ignore 1: follow
+ * @param[in]     wdef     With-defaults parameter
+ * @param[in,out] leafl    Leaflist state for keeping track of when [] ends
+ * @param[in,out] leaflname Leaflist state for []
+ * @retval        0        OK
+ * @retval       -1        Error
+ * leaflist state:
+ * 0: No leaflist
+ * 1: In leaflist
+ */
+static int
+text2cbuf(cbuf             *cb,
+          cxobj            *xn,
+          int               level,
+          char             *prepend,
+          int               autocliext,
+          withdefaults_type wdef,
+          int              *leafl,
+          char            **leaflname)
+{
+    struct text_emit te = {0,};
+    int              retval;
+
+    if (cb == NULL){
+        clixon_err(OE_XML, EINVAL, "cb is NULL");
+        return -1;
+    }
+    te.te_cb = cb;
+    te.te_autocliext = autocliext;
+    te.te_wdef = wdef;
+    te.te_leafl = *leafl;
+    te.te_leaflname = *leaflname;
+    retval = text2emit(&te, xn, level, prepend);
+    *leafl = te.te_leafl;
+    *leaflname = te.te_leaflname;
     return retval;
 }
 
 /*! Translate XML to a "pseudo-code" textual format using a callback
  *
+ * Output is buffered and printed with fn in chunks
  * @param[in]  f        File to print to
  * @param[in]  xn       XML object to print
  * @param[in]  level    Print PRETTYPRINT_INDENT spaces per level in front of each line
@@ -585,25 +541,39 @@ clixon_text2file(FILE             *f,
                  int               skiptop,
                  int               autocliext)
 {
-    int    retval = 1;
-    cxobj *xc;
-    int    leafl = 0;
-    char  *leaflname = NULL;
+    int               retval = -1;
+    cxobj            *xc;
+    struct text_emit  te = {0,};
+    struct text_ynode ycache[TEXT_YCACHE_SIZE] = {{0,}};
 
-    if (fn == NULL)
-        fn = fprintf;
+    if (xn == NULL){
+        clixon_err(OE_XML, EINVAL, "xn is NULL");
+        goto done;
+    }
+    if ((te.te_cb = cbuf_new()) == NULL){
+        clixon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    te.te_f = f;
+    te.te_fn = fn ? fn : fprintf;
+    te.te_autocliext = autocliext;
+    te.te_wdef = WITHDEFAULTS_EXPLICIT;
+    te.te_ycache = ycache;
     if (skiptop){
         xc = NULL;
         while ((xc = xml_child_each(xn, xc, CX_ELMNT)) != NULL)
-            if (text2file(xc, fn, f, level, autocliext, WITHDEFAULTS_EXPLICIT, &leafl, &leaflname) < 0)
+            if (text2emit(&te, xc, level, NULL) < 0)
                 goto done;
     }
     else {
-        if (text2file(xn, fn, f, level, autocliext, WITHDEFAULTS_EXPLICIT, &leafl, &leaflname) < 0)
+        if (text2emit(&te, xn, level, NULL) < 0)
             goto done;
     }
+    text_emit_flush(&te, 1);
     retval = 0;
  done:
+    if (te.te_cb)
+        cbuf_free(te.te_cb);
     return retval;
 }
 
@@ -624,19 +594,27 @@ clixon_text2cbuf(cbuf             *cb,
                  int               skiptop,
                  int               autocliext)
 {
-    int    retval = 1;
-    cxobj *xc;
-    int    leafl = 0;
-    char  *leaflname = NULL;
+    int               retval = -1;
+    cxobj            *xc;
+    struct text_emit  te = {0,};
+    struct text_ynode ycache[TEXT_YCACHE_SIZE] = {{0,}};
 
+    if (cb == NULL || xn == NULL){
+        clixon_err(OE_XML, EINVAL, "cb or xn is NULL");
+        goto done;
+    }
+    te.te_cb = cb;
+    te.te_autocliext = autocliext;
+    te.te_wdef = WITHDEFAULTS_EXPLICIT;
+    te.te_ycache = ycache;
     if (skiptop){
         xc = NULL;
         while ((xc = xml_child_each(xn, xc, CX_ELMNT)) != NULL)
-            if (text2cbuf(cb, xc, level, NULL, autocliext, WITHDEFAULTS_EXPLICIT, &leafl, &leaflname) < 0)
+            if (text2emit(&te, xc, level, NULL) < 0)
                 goto done;
     }
     else {
-        if (text2cbuf(cb, xn, level, NULL, autocliext, WITHDEFAULTS_EXPLICIT, &leafl, &leaflname) < 0)
+        if (text2emit(&te, xn, level, NULL) < 0)
             goto done;
     }
     retval = 0;
@@ -0,0 +1,474 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+ 
+  Copyright (C) 2026 Olof Hagsand
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2, 
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+ * Trace spans of major operations, recorded in an in-memory buffer per process
+ * Spans are properly nested since they begin and end in the same function,
+ * nesting is reconstructed from start and end times when exported as folded stacks.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "clixon_config.h" /* generated by config & autoconf */
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+
+/* cligen */
+#include <cligen/cligen.h>
+
+/* clixon */
+#include "clixon_queue.h"
+#include "clixon_hash.h"
+#include "clixon_handle.h"
+#include "clixon_yang.h"
+#include "clixon_xml.h"
+#include "clixon_err.h"
+#include "clixon_log.h"
+#include "clixon_debug.h"
+#include "clixon_options.h"
+#include "clixon_data.h"
+#include "clixon_xml_map.h"
+#include "clixon_trace.h"
+
+/* Max length of span name including detail, longer names are truncated */
+#define TRACE_NAME_LEN 56
+
+/* Max nesting depth of spans in folded stacks, deeper spans are attributed to their parent */
+#define TRACE_DEPTH_MAX 64
+
+/* One recorded span */
+struct trace_event {
+    uint64_t te_start;                /* Start in nanoseconds, monotonic clock */
+    uint64_t te_end;                  /* End in nanoseconds */
+    uint32_t te_cat;                  /* CLIXON_DBG_* subject */
+    char     te_name[TRACE_NAME_LEN]; /* <name>[:<detail>] */
+};
+
+/* Trace buffer of the process, see TRACE_RING_SIZE */
+struct trace_ring {
+    size_t             tr_pos;    /* Total number of events, mod TRACE_RING_SIZE is index */
+    size_t             tr_first;  /* Events before this position are cleared */
+    struct trace_event tr_ev[TRACE_RING_SIZE];
+};
+
+/* CLIXON_DBG_* subjects that are traced, 0 if tracing is disabled */
+uint32_t _clixon_trace_mask = 0;
+
+/* Trace ring, created on first span */
+static struct trace_ring *_trace_ring = NULL;
+
+/*! Get current time of monotonic clock
+ *
+ * @retval  ns  Nanoseconds
+ */
+uint64_t
+clixon_trace_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec*1000000000 + ts.tv_nsec;
+}
+
+/*! Record a span in the trace ring
+ *
+ * Tracing is best effort, if the ring cannot be allocated the span is dropped
+ * @param[in]  t      Start of span from clixon_trace_begin
+ * @param[in]  cat    CLIXON_DBG_* subject of span
+ * @param[in]  name   Name of span, eg function name
+ * @param[in]  detail Extra name of span, eg plugin or XPath, or NULL
+ * @see clixon_trace_end  Use this instead
+ */
+void
+clixon_trace_record(clixon_trace_t t,
+                    uint32_t       cat,
+                    const char    *name,
+                    const char    *detail)
+{
+    struct trace_ring  *tr;
+    struct trace_event *te;
+    uint64_t            end;
+    size_t              pos;
+
+    end = clixon_trace_now();
+    if ((tr = _trace_ring) == NULL){
+        if ((tr = calloc(1, sizeof(*tr))) == NULL)
+            return;
+        _trace_ring = tr;
+    }
+    pos = tr->tr_pos;
+    te = &tr->tr_ev[pos % TRACE_RING_SIZE];
+    te->te_start = t;
+    te->te_end = end;
+    te->te_cat = cat;
+    if (detail)
+        snprintf(te->te_name, sizeof(te->te_name), "%s:%s", name, detail);
+    else
+        snprintf(te->te_name, sizeof(te->te_name), "%s", name);
+    tr->tr_pos = pos + 1;
+}
+
+/*! Set traced categories from CLICON_TRACE option
+ *
+ * @param[in]  h   Clixon handle
+ * @retval     0   OK
+ * @retval    -1   Error
+ * @see CLICON_TRACE
+ */
+int
+clixon_trace_init(clixon_handle h)
+{
+    int        retval = -1;
+    char      *str;
+    yang_stmt *ymod;
+    yang_stmt *ytype;
+    yang_stmt *ybits;
+    uint32_t   mask = 0;
+    int        ret;
+
+    if ((str = clicon_option_str(h, "CLICON_TRACE")) != NULL && strlen(str)){
+        /* Direct access of clixon_debug_t type */
+        if ((ymod = yang_find(clicon_config_yang(h), Y_MODULE, "clixon-lib")) == NULL ||
+            (ytype = yang_find(ymod, Y_TYPEDEF, "clixon_debug_t")) == NULL ||
+            (ybits = yang_find(ytype, Y_TYPE, "bits")) == NULL){
+            clixon_err(OE_YANG, 0, "clixon_debug_t not found in clixon-lib.yang");
+            goto done;
+        }
+        if ((ret = yang_bitsstr2flags(ybits, str, &mask)) < 0)
+            goto done;
+        if (ret == 0){
+            clixon_err(OE_CFG, EINVAL, "CLICON_TRACE: no bit match: %s", str);
+            goto done;
+        }
+    }
+    clixon_trace_mask_set(mask & CLIXON_DBG_SMASK);
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Set traced categories
+ *
+ * @param[in]  mask  CLIXON_DBG_* subjects, 0 disables tracing
+ * @retval     0     OK
+ */
+int
+clixon_trace_mask_set(uint32_t mask)
+{
+    _clixon_trace_mask = mask;
+    return 0;
+}
+
+/*! Copy the events of a ring that are not overwritten or cleared
+ *
+ * @param[in]  tr    Trace ring
+ * @param[out] vecp  Events, free with free
+ * @param[out] lenp  Number of events
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+static int
+trace_ring_copy(struct trace_ring   *tr,
+                struct trace_event **vecp,
+                size_t              *lenp)
+{
+    struct trace_event *vec = NULL;
+    size_t              pos;
+    size_t              first;
+    size_t              i;
+
+    pos = tr->tr_pos;
+    first = tr->tr_first;
+    if (pos > TRACE_RING_SIZE && first < pos - TRACE_RING_SIZE)
+        first = pos - TRACE_RING_SIZE;
+    if (pos > first){
+        if ((vec = malloc((pos - first)*sizeof(*vec))) == NULL){
+            clixon_err(OE_UNIX, errno, "malloc");
+            return -1;
+        }
+        for (i = first; i < pos; i++)
+            vec[i - first] = tr->tr_ev[i % TRACE_RING_SIZE];
+    }
+    *vecp = vec;
+    *lenp = pos > first ? pos - first : 0;
+    return 0;
+}
+
+/*! Sort events on start time, and enclosing span first if equal
+ */
+static int
+trace_event_cmp(const void *a,
+                const void *b)
+{
+    const struct trace_event *e1 = a;
+    const struct trace_event *e2 = b;
+
+    if (e1->te_start != e2->te_start)
+        return e1->te_start < e2->te_start ? -1 : 1;
+    if (e1->te_end != e2->te_end)
+        return e1->te_end > e2->te_end ? -1 : 1;
+    return 0;
+}
+
+/*! Append span name as JSON string contents
+ */
+static void
+trace_json_name(cbuf       *cb,
+                const char *name)
+{
+    const char *s;
+
+    for (s = name; *s; s++){
+        if (*s == '"' || *s == '\\')
+            cprintf(cb, "\\%c", *s);
+        else if ((unsigned char)*s < 0x20)
+            cprintf(cb, "\\u%04x", (unsigned char)*s);
+        else
+            cprintf(cb, "%c", *s);
+    }
+}
+
+/*! Print events of one ring as Chrome trace events
+ *
+ * Complete events (ph X), time stamps and durations in microseconds
+ * @param[in]     cb    Output buffer
+ * @param[in]     tr    Trace ring
+ * @param[in]     vec   Events of ring
+ * @param[in]     len   Number of events
+ * @param[in,out] nr    Number of events printed so far
+ */
+static void
+trace_print_chrome(cbuf               *cb,
+                   struct trace_event *vec,
+                   size_t              len,
+                   size_t             *nr)
+{
+    struct trace_event *te;
+    const char         *cat;
+    size_t              i;
+
+    for (i = 0; i < len; i++){
+        te = &vec[i];
+        if ((cat = clixon_debug_key2str(te->te_cat)) == NULL)
+            cat = "default";
+        cprintf(cb, "%s\n{\"name\":\"", (*nr)++ ? "," : "");
+        trace_json_name(cb, te->te_name);
+        cprintf(cb, "\",\"cat\":\"%s\",\"ph\":\"X\"", cat);
+        cprintf(cb, ",\"ts\":%" PRIu64 ".%03u", te->te_start/1000, (unsigned)(te->te_start%1000));
+        cprintf(cb, ",\"dur\":%" PRIu64 ".%03u",
+                (te->te_end - te->te_start)/1000, (unsigned)((te->te_end - te->te_start)%1000));
+        cprintf(cb, ",\"pid\":%d,\"tid\":%d}", (int)getpid(), (int)getpid());
+    }
+}
+
+/*! Aggregate events as folded stacks with self time
+ *
+ * Events are sorted, nesting is given by a stack of enclosing spans.
+ * @param[in]  vec   Events of ring, sorted
+ * @param[in]  len   Number of events
+ * @param[in]  stacks Hash of folded stack to self time in nanoseconds
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+static int
+trace_fold(struct trace_event *vec,
+           size_t              len,
+           clicon_hash_t      *stacks)
+{
+    int       retval = -1;
+    size_t    stack[TRACE_DEPTH_MAX];
+    int       depth = 0;
+    uint64_t *child = NULL; /* Time in child spans per event */
+    uint64_t  self;
+    uint64_t *v;
+    cbuf     *cb = NULL;
+    char     *s;
+    size_t    i;
+    int       j;
+
+    if (len == 0)
+        return 0;
+    if ((child = calloc(len, sizeof(*child))) == NULL){
+        clixon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    if ((cb = cbuf_new()) == NULL){
+        clixon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    /* First pass: time of child spans, children follow their parent when sorted */
+    for (i = 0; i < len; i++){
+        while (depth && vec[stack[depth-1]].te_end <= vec[i].te_start)
+            depth--;
+        if (depth)
+            child[stack[depth-1]] += vec[i].te_end - vec[i].te_start;
+        if (depth < TRACE_DEPTH_MAX)
+            stack[depth++] = i;
+    }
+    /* Second pass: folded stack of each span with self time */
+    depth = 0;
+    for (i = 0; i < len; i++){
+        while (depth && vec[stack[depth-1]].te_end <= vec[i].te_start)
+            depth--;
+        if (depth < TRACE_DEPTH_MAX)
+            stack[depth++] = i;
+        else
+            continue;
+        self = vec[i].te_end - vec[i].te_start;
+        self = self > child[i] ? self - child[i] : 0;
+        cbuf_reset(cb);
+        cprintf(cb, "pid%d", (int)getpid());
+        for (j = 0; j < depth; j++){
+            cprintf(cb, ";");
+            /* Semicolon separates frames */
+            for (s = vec[stack[j]].te_name; *s; s++)
+                cprintf(cb, "%c", *s == ';' ? ':' : *s);
+        }
+        if ((v = clicon_hash_value(stacks, cbuf_get(cb), NULL)) != NULL)
+            *v += self;
+        else if (clicon_hash_add(stacks, cbuf_get(cb), &self, sizeof(self)) == NULL)
+            goto done;
+    }
+    retval = 0;
+ done:
+    if (cb)
+        cbuf_free(cb);
+    if (child)
+        free(child);
+    return retval;
+}
+
+/*! Print trace buffer
+ *
+ * Formats:
+ *   chrome   Chrome trace event JSON, can be loaded in perfetto or chrome://tracing
+ *   folded   Folded stacks, one line per stack: "pid<n>;<span>;<span> <self ns>", input to
+ *            flamegraph.pl
+ * @param[in]  cb      Output buffer
+ * @param[in]  format  "chrome" or "folded"
+ * @retval     0       OK
+ * @retval    -1       Error
+ */
+int
+clixon_trace_print(cbuf       *cb,
+                   const char *format)
+{
+    int                 retval = -1;
+    struct trace_ring  *tr;
+    struct trace_event *vec = NULL;
+    size_t              len;
+    size_t              nr = 0;
+    int                 folded;
+    clicon_hash_t      *stacks = NULL;
+    char              **keys = NULL;
+    size_t              klen;
+    uint64_t           *v;
+    size_t              i;
+
+    if (format == NULL || strcmp(format, "chrome") == 0)
+        folded = 0;
+    else if (strcmp(format, "folded") == 0)
+        folded = 1;
+    else {
+        clixon_err(OE_CFG, EINVAL, "Trace format %s, expected chrome or folded", format);
+        goto done;
+    }
+    if (folded){
+        if ((stacks = clicon_hash_init()) == NULL)
+            goto done;
+    }
+    else
+        cprintf(cb, "{\"traceEvents\":[");
+    if ((tr = _trace_ring) != NULL){
+        if (trace_ring_copy(tr, &vec, &len) < 0)
+            goto done;
+        if (len > 1)
+            qsort(vec, len, sizeof(*vec), trace_event_cmp);
+        if (folded){
+            if (trace_fold(vec, len, stacks) < 0)
+                goto done;
+        }
+        else
+            trace_print_chrome(cb, vec, len, &nr);
+    }
+    if (folded){
+        if (clicon_hash_keys(stacks, &keys, &klen) < 0)
+            goto done;
+        for (i = 0; i < klen; i++)
+            if ((v = clicon_hash_value(stacks, keys[i], NULL)) != NULL)
+                cprintf(cb, "%s %" PRIu64 "\n", keys[i], *v);
+    }
+    else
+        cprintf(cb, "\n],\"displayTimeUnit\":\"ns\"}\n");
+    retval = 0;
+ done:
+    if (keys)
+        free(keys);
+    if (stacks)
+        clicon_hash_free(stacks);
+    if (vec)
+        free(vec);
+    return retval;
+}
+
+/*! Clear trace buffer
+ *
+ * @retval  0  OK
+ */
+int
+clixon_trace_clear(void)
+{
+    if (_trace_ring)
+        _trace_ring->tr_first = _trace_ring->tr_pos;
+    return 0;
+}
+
+/*! Disable tracing and free trace buffer
+ *
+ * @retval  0  OK
+ */
+int
+clixon_trace_exit(void)
+{
+    clixon_trace_mask_set(0);
+    if (_trace_ring){
+        free(_trace_ring);
+        _trace_ring = NULL;
+    }
+    return 0;
+}
@@ -48,8 +48,10 @@
 #include <string.h>
 #include <syslog.h>
 #include <fcntl.h>
+#include <signal.h>
 #include <arpa/inet.h>
 #include <sys/param.h>
+#include <sys/wait.h>
 #include <netinet/in.h>
 
 /* cligen */
@@ -66,6 +68,7 @@
 #include "clixon_err.h"
 #include "clixon_log.h"
 #include "clixon_debug.h"
+#include "clixon_trace.h"
 #include "clixon_data.h"
 #include "clixon_netconf_lib.h"
 #include "clixon_options.h"
@@ -73,6 +76,7 @@
 #include "clixon_xml_io.h"
 #include "clixon_xpath_ctx.h"
 #include "clixon_xpath.h"
+#include "clixon_xpath_function.h"
 #include "clixon_yang_module.h"
 #include "clixon_yang_type.h"
 #include "clixon_yang_schema_mount.h"
@@ -86,6 +90,18 @@
 
 #ifdef LEAFREF_OPTIMIZE
 
+/* Set of target values of one absolute leafref path, built once per validation pass
+ * Open addressing over body strings of the (unmodified) validated tree
+ */
+struct leafref_set {
+    struct leafref_set *ls_next;
+    yang_stmt          *ls_ypath; /* YANG path statement */
+    yang_stmt          *ls_ymod;  /* Module of referring node, decides prefixes */
+    cxobj              *ls_xtop;  /* Top of tree the path was evaluated in */
+    char              **ls_vec;   /* Hash table of body strings, NULL is empty slot */
+    uint32_t            ls_size;  /* Size of ls_vec, power of 2 */
+};
+
 /* Global cache data only directly used in validate_leafref()
  */
 struct leafref_opt {
@@ -96,6 +112,8 @@ struct leafref_opt {
     char      *lc_cache_xpath;  /* Cached xpath to distinguish union branches */
     int        lc_bin_search;  /* Result is binary searchable */
     cxobj     *lc_bin_x0;      /* First object hit, derive y and parent */
+    int        lc_pass;        /* Inside validation pass, see leafref_opt_init */
+    struct leafref_set *lc_sets; /* Target value sets of absolute paths */
 };
 struct leafref_opt leafref_opt = {0,};
 
@@ -507,6 +525,123 @@ leafref_opt_search(char      *xpath,
     goto done;
 }
 
+/*! FNV-1a hash of body string
+ */
+static uint32_t
+leafref_set_hash(char *str)
+{
+    uint32_t h = 2166136261u;
+
+    while (*str){
+        h ^= (uint8_t)*str++;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+/*! Build set of target values of an absolute leafref path
+ *
+ * The path is evaluated once and the bodies of all hits are hashed
+ * @param[in]  xt     Leafref XML node, context of path
+ * @param[in]  nsc    Namespace context of path
+ * @param[in]  xpath  Absolute leafref path
+ * @param[out] ls     Set, ls_vec and ls_size are filled in
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+static int
+leafref_set_build(cxobj              *xt,
+                  cvec               *nsc,
+                  char               *xpath,
+                  struct leafref_set *ls)
+{
+    int      retval = -1;
+    cxobj  **xvec = NULL;
+    size_t   xlen = 0;
+    size_t   i;
+    uint32_t size = 16;
+    uint32_t j;
+    char    *body;
+
+    if (xpath_vec(xt, nsc, "%s", &xvec, &xlen, xpath) < 0)
+        goto done;
+    while (size < 2*xlen)
+        size <<= 1;
+    if ((ls->ls_vec = calloc(size, sizeof(char*))) == NULL){
+        clixon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    ls->ls_size = size;
+    for (i = 0; i < xlen; i++){
+        if ((body = xml_body(xvec[i])) == NULL)
+            continue;
+        j = leafref_set_hash(body) & (size - 1);
+        while (ls->ls_vec[j] != NULL && strcmp(ls->ls_vec[j], body) != 0)
+            j = (j + 1) & (size - 1);
+        ls->ls_vec[j] = body;
+    }
+    retval = 0;
+ done:
+    if (xvec)
+        free(xvec);
+    return retval;
+}
+
+/*! Check leafref value against the target value set of an absolute path
+ *
+ * The set is looked up, or built on first use in this validation pass
+ * @param[in]  xt     Leafref XML node
+ * @param[in]  yt     YANG of leafref XML node
+ * @param[in]  ypath  YANG path statement
+ * @param[in]  nsc    Namespace context of path
+ * @param[in]  body   Leafref value
+ * @retval     1      Value found
+ * @retval     0      Value not found
+ * @retval    -1      Error
+ */
+static int
+leafref_opt_set_check(cxobj     *xt,
+                      yang_stmt *yt,
+                      yang_stmt *ypath,
+                      cvec      *nsc,
+                      char      *body)
+{
+    struct leafref_set *ls;
+    yang_stmt          *ymod;
+    cxobj              *xtop;
+    uint32_t            j;
+
+    ymod = ys_module(yt);
+    xtop = xt;
+    while (xml_parent(xtop) != NULL)
+        xtop = xml_parent(xtop);
+    for (ls = leafref_opt.lc_sets; ls; ls = ls->ls_next)
+        if (ls->ls_ypath == ypath && ls->ls_ymod == ymod && ls->ls_xtop == xtop)
+            break;
+    if (ls == NULL){
+        if ((ls = calloc(1, sizeof(*ls))) == NULL){
+            clixon_err(OE_UNIX, errno, "calloc");
+            return -1;
+        }
+        ls->ls_ypath = ypath;
+        ls->ls_ymod = ymod;
+        ls->ls_xtop = xtop;
+        if (leafref_set_build(xt, nsc, yang_argument_get(ypath), ls) < 0){
+            free(ls);
+            return -1;
+        }
+        ls->ls_next = leafref_opt.lc_sets;
+        leafref_opt.lc_sets = ls;
+    }
+    j = leafref_set_hash(body) & (ls->ls_size - 1);
+    while (ls->ls_vec[j] != NULL){
+        if (strcmp(ls->ls_vec[j], body) == 0)
+            return 1;
+        j = (j + 1) & (ls->ls_size - 1);
+    }
+    return 0;
+}
+
 /*! Leafref optimization init
  *
  * @param[in]  h  Clixon handle
@@ -515,6 +650,7 @@ leafref_opt_search(char      *xpath,
 static int
 leafref_opt_init(clixon_handle h)
 {
+    leafref_opt.lc_pass = 1;
     return 0;
 }
 
@@ -526,12 +662,529 @@ leafref_opt_init(clixon_handle h)
 int
 leafref_opt_exit(clixon_handle h)
 {
+    struct leafref_set *ls;
+
     leafref_opt_free(&leafref_opt);
+    while ((ls = leafref_opt.lc_sets) != NULL){
+        leafref_opt.lc_sets = ls->ls_next;
+        if (ls->ls_vec)
+            free(ls->ls_vec);
+        free(ls);
+    }
+    leafref_opt.lc_pass = 0;
     return 0;
 }
 
 #endif /* LEAFREF_OPTIMIZE */
 
+#ifdef VALIDATE_INCREMENTAL
+/* Kind of node set that an XPath (sub)expression evaluates to, see xpath_deps_walk */
+#define VI_KIND_TOP   0 /* The context node of the expression */
+#define VI_KIND_NAMED 1 /* Nodes selected by a name test */
+#define VI_KIND_OTHER 2 /* Other nodes, eg parent or root */
+
+/* Dependency flags of an XPath expression, first character of cached value */
+#define VI_DEP_NAMES  'n' /* Depends only on nodes with names following */
+#define VI_DEP_SELF   's' /* Also depends on the context node itself */
+#define VI_DEP_ANY    'a' /* May depend on any node */
+
+/* Global incremental validation state, only set during commit/validate transactions
+ */
+struct validate_incr {
+    clicon_hash_t *vi_names; /* Names of changed nodes, of their ancestors and descendants */
+    clicon_hash_t *vi_deps;  /* XPath string -> dependencies: flag followed by names */
+    clicon_hash_t *vi_trees; /* YANG node -> dependencies of all expressions in its subtree */
+};
+static struct validate_incr validate_incr = {NULL, NULL, NULL};
+
+static int xpath_deps_walk(xpath_tree *xs, int kind, cbuf *cb, char *dep);
+
+/*! Node set kind at the end of a location path, check if it reads an unnamed node
+ *
+ * @param[in]     kind  Node set kind of the final step
+ * @param[in,out] dep   Dependency flag
+ */
+static void
+xpath_deps_terminal(int   kind,
+                    char *dep)
+{
+    if (kind == VI_KIND_TOP){
+        if (*dep == VI_DEP_NAMES)
+            *dep = VI_DEP_SELF;
+    }
+    else if (kind == VI_KIND_OTHER)
+        *dep = VI_DEP_ANY;
+}
+
+/*! Walk a relative location path and return the node set kind of its last step
+ *
+ * @param[in]     xs    XPath parse tree of type XP_RELLOCPATH
+ * @param[in]     kind  Node set kind of the step context
+ * @param[in,out] cb    Names read, separated by space
+ * @param[in,out] dep   Dependency flag
+ * @retval        kind  Node set kind of the last step
+ */
+static int
+xpath_deps_rellocpath(xpath_tree *xs,
+                      int         kind,
+                      cbuf       *cb,
+                      char       *dep)
+{
+    xpath_tree *xstep;
+    xpath_tree *xn;
+    xpath_tree *xp;
+
+    if (xs->xs_c1 == NULL)
+        xstep = xs->xs_c0;
+    else {
+        kind = xpath_deps_rellocpath(xs->xs_c0, kind, cb, dep);
+        if (xs->xs_int == A_DESCENDANT_OR_SELF)
+            kind = VI_KIND_OTHER;
+        xstep = xs->xs_c1;
+    }
+    if (xstep == NULL || xstep->xs_type != XP_STEP){
+        *dep = VI_DEP_ANY;
+        return VI_KIND_OTHER;
+    }
+    switch (xstep->xs_int){
+    case A_ATTRIBUTE:
+    case A_FOLLOWING:
+    case A_FOLLOWING_SIBLING:
+    case A_NAMESPACE:
+    case A_PRECEDING:
+    case A_PRECEDING_SIBLING:
+        *dep = VI_DEP_ANY; /* Attributes or order not covered by names */
+        break;
+    default:
+        break;
+    }
+    if ((xn = xstep->xs_c0) == NULL){       /* Abbreviated . or .. */
+        if (xstep->xs_int != A_SELF)
+            kind = VI_KIND_OTHER;
+    }
+    else if (xn->xs_type == XP_NODE){
+        if (xn->xs_s1 == NULL || strcmp(xn->xs_s1, "*") == 0)
+            *dep = VI_DEP_ANY;
+        else
+            cprintf(cb, " %s", xn->xs_s1);
+        kind = VI_KIND_NAMED;
+    }
+    else if (xn->xs_type == XP_NODE_FN &&
+             xn->xs_int == XPATHFN_NODE && xstep->xs_int == A_SELF)
+        ; /* self::node() */
+    else {
+        *dep = VI_DEP_ANY;                  /* Eg text() */
+        kind = VI_KIND_OTHER;
+    }
+    /* Predicates are evaluated with the step result as context */
+    for (xp = xstep->xs_c1; xp != NULL; xp = xp->xs_c0)
+        xpath_deps_walk(xp->xs_c1, kind, cb, dep);
+    return kind;
+}
+
+/*! Walk an XPath parse tree and collect the node names it reads
+ *
+ * @param[in]     xs    XPath parse tree
+ * @param[in]     kind  Node set kind of the expression context
+ * @param[in,out] cb    Names read, separated by space
+ * @param[in,out] dep   Dependency flag, see VI_DEP_*
+ * @retval        0     OK
+ * The walk is conservative: constructs that may read nodes whose names are not
+ * part of the expression sets the dependency flag to VI_DEP_ANY.
+ */
+static int
+xpath_deps_walk(xpath_tree *xs,
+                int         kind,
+                cbuf       *cb,
+                char       *dep)
+{
+    int k;
+
+    if (xs == NULL || *dep == VI_DEP_ANY)
+        return 0;
+    switch (xs->xs_type){
+    case XP_LOCPATH:
+        if (xs->xs_c0 && xs->xs_c0->xs_type == XP_RELLOCPATH)
+            xpath_deps_terminal(xpath_deps_rellocpath(xs->xs_c0, kind, cb, dep), dep);
+        else
+            xpath_deps_walk(xs->xs_c0, kind, cb, dep);
+        break;
+    case XP_ABSPATH:
+        if (xs->xs_c0 == NULL)
+            *dep = VI_DEP_ANY; /* The root node */
+        else
+            xpath_deps_terminal(xpath_deps_rellocpath(xs->xs_c0, VI_KIND_OTHER, cb, dep), dep);
+        break;
+    case XP_PATHEXPR:
+        if (xs->xs_c1 == NULL)
+            xpath_deps_walk(xs->xs_c0, kind, cb, dep);
+        else {
+            /* filterexpr / rellocpath */
+            xpath_deps_walk(xs->xs_c0, kind, cb, dep);
+            k = VI_KIND_OTHER;
+            if (xs->xs_c0 && xs->xs_c0->xs_c0 &&
+                xs->xs_c0->xs_c0->xs_type == XP_PRIME_FN &&
+                xs->xs_c0->xs_c0->xs_int == XPATHFN_CURRENT)
+                k = VI_KIND_TOP;
+            xpath_deps_terminal(xpath_deps_rellocpath(xs->xs_c1, k, cb, dep), dep);
+        }
+        break;
+    case XP_PRIME_FN:
+        switch (xs->xs_int){
+        case XPATHFN_CURRENT:
+            xpath_deps_terminal(VI_KIND_TOP, dep);
+            break;
+        case XPATHFN_DEREF:
+        case XPATHFN_LAST:
+        case XPATHFN_POSITION:
+        case XPATHFN_ID:
+            *dep = VI_DEP_ANY;
+            break;
+        default:
+            if (xs->xs_c0 == NULL) /* Eg string() reads the context node */
+                xpath_deps_terminal(kind, dep);
+            else
+                xpath_deps_walk(xs->xs_c0, kind, cb, dep);
+            break;
+        }
+        break;
+    case XP_PRIME_NR:
+    case XP_PRIME_STR:
+        break;
+    case XP_STEP:
+    case XP_NODE:
+    case XP_NODE_FN:
+    case XP_PRED:
+    case XP_RELLOCPATH:
+        *dep = VI_DEP_ANY; /* Not expected outside location paths */
+        break;
+    default: /* Operators, filter and parenthesis */
+        xpath_deps_walk(xs->xs_c0, kind, cb, dep);
+        xpath_deps_walk(xs->xs_c1, kind, cb, dep);
+        break;
+    }
+    return 0;
+}
+
+/*! Get dependencies of an XPath expression, compute and cache if not found
+ *
+ * @param[in]  xpath  XPath string
+ * @retval     deps   Dependency flag followed by space-separated names
+ * @retval     NULL   Error
+ */
+static char *
+validate_incr_deps(const char *xpath)
+{
+    char       *deps;
+    xpath_tree *xptree = NULL;
+    cbuf       *cbn = NULL;
+    cbuf       *cb = NULL;
+    char        dep = VI_DEP_NAMES;
+
+    if ((deps = clicon_hash_value(validate_incr.vi_deps, xpath, NULL)) != NULL)
+        goto done;
+    if ((cbn = cbuf_new()) == NULL || (cb = cbuf_new()) == NULL){
+        clixon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    /* Parse errors are reported when the expression is evaluated */
+    if (xpath_parse(xpath, &xptree) < 0){
+        clixon_err_reset();
+        dep = VI_DEP_ANY;
+    }
+    else
+        xpath_deps_walk(xptree, VI_KIND_TOP, cbn, &dep);
+    cprintf(cb, "%c%s", dep, cbuf_get(cbn));
+    if (clicon_hash_add(validate_incr.vi_deps, xpath, cbuf_get(cb), cbuf_len(cb)+1) == NULL)
+        goto done;
+    deps = clicon_hash_value(validate_incr.vi_deps, xpath, NULL);
+ done:
+    if (xptree)
+        xpath_tree_free(xptree);
+    if (cbn)
+        cbuf_free(cbn);
+    if (cb)
+        cbuf_free(cb);
+    return deps;
+}
+
+/*! Check if a must or when expression needs to be evaluated in incremental validation
+ *
+ * @param[in]  xt     XML node of the must or when statement
+ * @param[in]  xpath  XPath expression
+ * @param[in]  when   If set, the context node may also be the parent of xt
+ * @retval     1      Evaluate expression
+ * @retval     0      Skip, expression does not read any changed node
+ * @retval    -1      Error
+ */
+static int
+validate_incr_check(cxobj      *xt,
+                    const char *xpath,
+                    int         when)
+{
+    char  *deps;
+    char  *s;
+    char  *e;
+    char   c;
+    cxobj *xp;
+    int    found;
+
+    if (validate_incr.vi_names == NULL)
+        return 1;
+    if (xml_flag(xt, XML_FLAG_ADD)) /* New node, never evaluated */
+        return 1;
+    if ((deps = validate_incr_deps(xpath)) == NULL)
+        return -1;
+    switch (deps[0]){
+    case VI_DEP_ANY:
+        return 1;
+    case VI_DEP_SELF:
+        if (xml_flag(xt, XML_FLAG_CHANGE))
+            return 1;
+        if (when && (xp = xml_parent(xt)) != NULL &&
+            xml_flag(xp, XML_FLAG_ADD|XML_FLAG_CHANGE))
+            return 1;
+        break;
+    default:
+        break;
+    }
+    s = deps + 1;
+    while (*s == ' '){
+        s++;
+        if ((e = strchr(s, ' ')) == NULL)
+            e = s + strlen(s);
+        c = *e;
+        *e = '\0';
+        found = clicon_hash_lookup(validate_incr.vi_names, s) != NULL;
+        *e = c;
+        if (found)
+            return 1;
+        s = e;
+    }
+    return 0;
+}
+
+/*! Check if the when expression of a node needs to be evaluated in incremental validation
+ *
+ * @param[in]  xt  XML node
+ * @param[in]  yt  YANG node of xt
+ * @retval     1   Evaluate when expression
+ * @retval     0   Skip, no when expression or it does not read any changed node
+ * @retval    -1   Error
+ * @see yang_check_when_xpath  for the when variants
+ */
+static int
+validate_incr_when(cxobj     *xt,
+                   yang_stmt *yt)
+{
+    yang_stmt *yw;
+
+    if ((yw = yang_when_get(NULL, yt)) == NULL &&
+        (yw = yang_find(yt, Y_WHEN, NULL)) == NULL)
+        return 0;
+    return validate_incr_check(xt, yang_argument_get(yw), 1);
+}
+
+/*! Add dependencies of one XPath expression to subtree dependencies
+ *
+ * @param[in]     xpath  XPath expression
+ * @param[in,out] cb     Names read, separated by space
+ * @param[in,out] dep    Dependency flag, VI_DEP_ANY if any expression may read any node
+ * @retval        0      OK
+ * @retval       -1      Error
+ */
+static int
+validate_incr_tree_xpath(const char *xpath,
+                         cbuf       *cb,
+                         char       *dep)
+{
+    char *deps;
+
+    if ((deps = validate_incr_deps(xpath)) == NULL)
+        return -1;
+    if (deps[0] == VI_DEP_ANY)
+        *dep = VI_DEP_ANY;
+    else
+        cprintf(cb, "%s", deps + 1);
+    return 0;
+}
+
+/*! Add dependencies of leafref paths of a resolved type to subtree dependencies
+ *
+ * @param[in]     ys        Leaf or leaf-list
+ * @param[in]     yrestype  Resolved type, leafref paths of union members are also added
+ * @param[in,out] cb        Names read, separated by space
+ * @param[in,out] dep       Dependency flag
+ * @retval        0         OK
+ * @retval       -1         Error
+ */
+static int
+validate_incr_tree_type(yang_stmt *ys,
+                        yang_stmt *yrestype,
+                        cbuf      *cb,
+                        char      *dep)
+{
+    yang_stmt *ytsub;
+    yang_stmt *ytype;
+    yang_stmt *yc;
+    cg_var    *cv;
+    char      *restype;
+    int        inext;
+
+    if (yrestype == NULL || (restype = yang_argument_get(yrestype)) == NULL)
+        return 0;
+    if (strcmp(restype, "leafref") == 0){
+        if ((yc = yang_find(yrestype, Y_REQUIRE_INSTANCE, NULL)) != NULL &&
+            (cv = yang_cv_get(yc)) != NULL && cv_bool_get(cv) == 0)
+            return 0;
+        if ((yc = yang_find(yrestype, Y_PATH, NULL)) != NULL &&
+            validate_incr_tree_xpath(yang_argument_get(yc), cb, dep) < 0)
+            return -1;
+    }
+    else if (strcmp(restype, "union") == 0){
+        inext = 0;
+        while ((ytsub = yn_iter(yrestype, &inext)) != NULL){
+            if (yang_keyword_get(ytsub) != Y_TYPE)
+                continue;
+            if (yang_type_resolve(ys, ys, ytsub, &ytype, NULL, NULL, NULL, NULL, NULL) < 0)
+                return -1;
+            if (validate_incr_tree_type(ys, ytype, cb, dep) < 0)
+                return -1;
+        }
+    }
+    return 0;
+}
+
+/*! Collect dependencies of must, when and leafref expressions in a YANG subtree
+ *
+ * @param[in]     ys     YANG node
+ * @param[in,out] cb     Names read, separated by space
+ * @param[in,out] dep    Dependency flag
+ * @retval        0      OK
+ * @retval       -1      Error
+ */
+static int
+validate_incr_tree1(yang_stmt *ys,
+                    cbuf      *cb,
+                    char      *dep)
+{
+    yang_stmt    *yc;
+    enum rfc_6020 keyw;
+    int           inext;
+
+    if (yang_schema_mount_point(ys)){
+        *dep = VI_DEP_ANY;
+        return 0;
+    }
+    if ((yc = yang_when_get(NULL, ys)) != NULL &&
+        validate_incr_tree_xpath(yang_argument_get(yc), cb, dep) < 0)
+        return -1;
+    keyw = yang_keyword_get(ys);
+    if (keyw == Y_LEAF || keyw == Y_LEAF_LIST){
+        if (yang_type_get(ys, NULL, &yc, NULL, NULL, NULL, NULL, NULL) < 0)
+            return -1;
+        if (validate_incr_tree_type(ys, yc, cb, dep) < 0)
+            return -1;
+    }
+    inext = 0;
+    while ((yc = yn_iter(ys, &inext)) != NULL && *dep != VI_DEP_ANY){
+        switch (yang_keyword_get(yc)){
+        case Y_MUST:
+        case Y_WHEN:
+            if (validate_incr_tree_xpath(yang_argument_get(yc), cb, dep) < 0)
+                return -1;
+            break;
+        case Y_CHOICE:
+        case Y_CASE:
+            if (validate_incr_tree1(yc, cb, dep) < 0)
+                return -1;
+            break;
+        default:
+            if (yang_datanode(yc) && validate_incr_tree1(yc, cb, dep) < 0)
+                return -1;
+            break;
+        }
+    }
+    return 0;
+}
+
+/*! Check if a subtree needs to be validated in incremental validation
+ *
+ * A subtree of an unchanged node is as in running, which is valid. It needs only be
+ * validated if a must, when or leafref expression in it reads a changed node.
+ * The dependencies of all expressions in a YANG subtree are cached per transaction.
+ * @param[in]  yt  YANG node of an XML node whose parent is not added or changed
+ * @retval     1   Validate subtree
+ * @retval     0   Skip subtree
+ * @retval    -1   Error
+ */
+static int
+validate_incr_tree(yang_stmt *yt)
+{
+    int    retval = -1;
+    char   key[32];
+    char  *deps;
+    char  *s;
+    char  *e;
+    char   c;
+    cbuf  *cbn = NULL;
+    cbuf  *cb = NULL;
+    char   dep = VI_DEP_NAMES;
+    int    found;
+
+    if (validate_incr.vi_trees == NULL &&
+        (validate_incr.vi_trees = clicon_hash_init()) == NULL)
+        goto done;
+    snprintf(key, sizeof(key), "%p", yt);
+    if ((deps = clicon_hash_value(validate_incr.vi_trees, key, NULL)) == NULL){
+        if ((cbn = cbuf_new()) == NULL || (cb = cbuf_new()) == NULL){
+            clixon_err(OE_UNIX, errno, "cbuf_new");
+            goto done;
+        }
+        if (validate_incr_tree1(yt, cbn, &dep) < 0)
+            goto done;
+        cprintf(cb, "%c%s", dep, dep == VI_DEP_ANY ? "" : cbuf_get(cbn));
+        if (clicon_hash_add(validate_incr.vi_trees, key, cbuf_get(cb), cbuf_len(cb)+1) == NULL)
+            goto done;
+        deps = clicon_hash_value(validate_incr.vi_trees, key, NULL);
+    }
+    retval = 1;
+    if (deps[0] == VI_DEP_ANY)
+        goto done;
+    s = deps + 1;
+    while (*s == ' '){
+        s++;
+        if ((e = strchr(s, ' ')) == NULL)
+            e = s + strlen(s);
+        c = *e;
+        *e = '\0';
+        found = clicon_hash_lookup(validate_incr.vi_names, s) != NULL;
+        *e = c;
+        if (found)
+            goto done;
+        s = e;
+    }
+    retval = 0;
+ done:
+    if (cbn)
+        cbuf_free(cbn);
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+}
+
+/*! Register name of a changed XML node, xml_apply callback
+ */
+static int
+validate_incr_name_add(cxobj *x,
+                       void  *arg)
+{
+    if (clicon_hash_add(validate_incr.vi_names, xml_name(x), NULL, 0) == NULL)
+        return -1;
+    return 0;
+}
+#endif /* VALIDATE_INCREMENTAL */
+
 /*! Validate xml node of type leafref, ensure the value is one of that path's reference
  *
  * @param[in]  xt    XML leaf node of type leafref
@@ -614,6 +1267,19 @@ validate_leafref(cxobj     *xt,
     if (xml_nsctx_yang(yt, &nsc) < 0)
         goto done;
 #ifdef LEAFREF_OPTIMIZE
+    /* Absolute paths without current() have the same targets for all leafrefs */
+    if (leafref_opt.lc_pass &&
+        xpath[0] == '/' &&
+        strstr(xpath, "current()") == NULL){
+        if ((ret = leafref_opt_set_check(xt, yt, ypath, nsc, leafrefbody)) < 0)
+            goto done;
+        if (ret == 0){
+            if (validate_leafref_err(xpath, xt, yt, ytype, xret) < 0)
+                goto done;
+            goto fail;
+        }
+        goto ok;
+    }
     if (yt == leafref_opt.lc_cache_yang &&
         leafref_opt.lc_cache_x0 &&
         leafref_opt.lc_cache_xpath &&
@@ -720,7 +1386,6 @@ validate_identityref(cxobj     *xt,
     char       *id = NULL;
     cbuf       *cberr = NULL;
     cbuf       *cb = NULL;
-    cvec       *idrefvec; /* Derived identityref list: (module:id)**/
     yang_stmt  *ymod;
     char       *ns = NULL;
 
@@ -779,11 +1444,10 @@ validate_identityref(cxobj     *xt,
     }
     cprintf(cb, "%s:%s", yang_argument_get(ymod), id);
     idref = cbuf_get(cb);
-    /* Here check if node is in the derived node list of the base identity
-     * The derived node list is a cvec computed XXX
+    /* Here check if node is in the derived identities of the base identity
+     * @see ys_populate_identity
      */
-    idrefvec = yang_cvec_get(ybaseid);
-    if (cvec_find(idrefvec, idref) == NULL){
+    if (!yang_identity_derived(ybaseid, idref)){
         cprintf(cberr, "Identityref validation failed, %s not derived from %s ",
                 node,
                 yang_argument_get(ybaseid));
@@ -1480,7 +2144,7 @@ xml_yang_validate_add(clixon_handle h,
     cbuf          *cb = NULL;
     int            ret;
 
-    if (clicon_option_bool(h, "CLICON_YANG_SCHEMA_MOUNT")){
+    if (clicon_option_bool_id(h, CO_YANG_SCHEMA_MOUNT)){
         if ((ret = xml_yang_mount_get(h, xt, &vl, NULL, NULL)) < 0)
             goto done;
         /* Check if validate beyond mountpoints */
@@ -1723,6 +2387,252 @@ xml_yang_validate_leaf_union(clixon_handle h,
     goto done;
 }
 
+#ifdef VALIDATE_PARALLEL_MIN
+/* Number of processes validating children of a node with many children, 0 or 1 is sequential */
+static int _validate_parallel = 0;
+#endif
+
+/*! Set number of processes validating children of XML nodes with many children
+ *
+ * Cant use option directly since it is set in the backend only
+ * @param[in]  workers  Number of processes including the calling, 0 or 1 is sequential
+ * @retval     0        OK
+ * @see VALIDATE_PARALLEL_MIN
+ * @see CLICON_VALIDATE_PARALLEL
+ */
+int
+xml_yang_validate_parallel_set(int workers)
+{
+#ifdef VALIDATE_PARALLEL_MIN
+    _validate_parallel = workers;
+#endif
+    return 0;
+}
+
+#ifdef VALIDATE_PARALLEL_MIN
+static int xml_yang_validate_all1(clixon_handle h, cxobj *xt, int state, cxobj **xret);
+
+/*! Validate a range of a vector of XML nodes
+ *
+ * @param[in]  h     Clixon handle
+ * @param[in]  vec   Vector of XML nodes
+ * @param[in]  from  First position of range
+ * @param[in]  to    Position after range
+ * @param[in]  state 0: ignore state, 1: also validate state (non-config)
+ * @param[out] xret  Error XML tree of first failing node (if retval=0)
+ * @retval     1     Validation OK
+ * @retval     0     Validation failed (xret set)
+ * @retval    -1     Error
+ */
+static int
+validate_all_range(clixon_handle h,
+                   cxobj       **vec,
+                   int           from,
+                   int           to,
+                   int           state,
+                   cxobj       **xret)
+{
+    int i;
+    int ret;
+
+    for (i=from; i<to; i++)
+        if ((ret = xml_yang_validate_all1(h, vec[i], state, xret)) < 1)
+            return ret;
+    return 1;
+}
+
+/*! Validate children of an XML node with many children in parallel worker processes
+ *
+ * The children are split into one shard per process. The first shard is validated by the
+ * calling process, the others by forked workers, which validate a copy-on-write image of
+ * the XML tree and send an empty reply if OK, or the error of their first failing child.
+ * Shards are then checked in order, so that the first error is the same as in a sequential
+ * validation. Shards of workers that can not be forked or that fail are validated by the
+ * calling process.
+ * @param[in]  h     Clixon handle
+ * @param[in]  xt    XML node whose children are validated
+ * @param[in]  state 0: ignore state, 1: also validate state (non-config)
+ * @param[out] xret  Error XML tree (if retval=0). Free with xml_free after use
+ * @retval     2     Not applicable, validate sequentially
+ * @retval     1     Validation OK
+ * @retval     0     Validation failed (xret set)
+ * @retval    -1     Error
+ * @see VALIDATE_PARALLEL_MIN
+ */
+static int
+validate_all_parallel(clixon_handle h,
+                      cxobj        *xt,
+                      int           state,
+                      cxobj       **xret)
+{
+    int        retval = -1;
+    int        nw;
+    cxobj    **vec = NULL;
+    size_t     veclen = 0;
+    cxobj     *x;
+    yang_stmt *yc;
+    int        shard;
+    int        w;
+    int        wn;
+    int        from;
+    int        to;
+    int        fd[2];
+    int       *fdv = NULL;
+    pid_t     *pidv = NULL;
+    pid_t      pid;
+    cbuf      *cb = NULL;
+    char       buf[1024];
+    ssize_t    len;
+    size_t     n;
+    int        status;
+    int        ok;
+    int        ret;
+
+    if ((nw = _validate_parallel) < 2 ||
+        xml_child_nr_type(xt, CX_ELMNT) < VALIDATE_PARALLEL_MIN)
+        return 2;
+    x = NULL;
+    while ((x = xml_child_each(xt, x, CX_ELMNT)) != NULL) {
+        if (!state && (yc = xml_spec(x)) != NULL && yang_config(yc) == 0)
+            continue; /* skip if non-config */
+        if (cxvec_append(x, &vec, &veclen) < 0)
+            goto done;
+    }
+    shard = (veclen + nw - 1) / nw;
+    if ((fdv = calloc(nw, sizeof(*fdv))) == NULL ||
+        (pidv = calloc(nw, sizeof(*pidv))) == NULL){
+        clixon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    if ((cb = cbuf_new()) == NULL){
+        clixon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    for (w=0; w<nw; w++)
+        fdv[w] = -1;
+    _validate_parallel = 0; /* No nested workers */
+    for (wn=1; wn<nw; wn++){
+        from = wn*shard;
+        to = from + shard < veclen ? from + shard : veclen;
+        if (from >= to)
+            break;
+        if (pipe(fd) < 0)
+            break;
+        if ((pid = fork()) < 0){
+            close(fd[0]);
+            close(fd[1]);
+            break;
+        }
+        if (pid == 0){ /* Worker */
+            close(fd[0]);
+            xpath_parallel_set(0);
+            if ((ret = validate_all_range(h, vec, from, to, state, xret)) < 0)
+                _exit(1);
+            /* Reply: '1' if OK, else '0' followed by errors */
+            cprintf(cb, "%d", ret);
+            if (ret == 0 && xret && *xret){
+                x = NULL;
+                while ((x = xml_child_each(*xret, x, CX_ELMNT)) != NULL)
+                    if (clixon_xml2cbuf1(cb, x, 0, 0, NULL, -1, 0, 0, WITHDEFAULTS_REPORT_ALL) < 0)
+                        _exit(1);
+            }
+            n = 0;
+            while (n < cbuf_len(cb)){
+                if ((len = write(fd[1], cbuf_get(cb)+n, cbuf_len(cb)-n)) < 0){
+                    if (errno == EINTR)
+                        continue;
+                    _exit(1);
+                }
+                n += len;
+            }
+            close(fd[1]);
+            _exit(0); /* Dont exit() here, parent state must not be flushed */
+        }
+        close(fd[1]);
+        fdv[wn] = fd[0];
+        pidv[wn] = pid;
+    }
+    /* First shard is validated here */
+    if ((ret = validate_all_range(h, vec, 0, shard < veclen ? shard : veclen, state, xret)) < 0)
+        goto done;
+    if (ret == 0)
+        goto fail;
+    /* Then shards of workers in order */
+    for (w=1; w<wn; w++){
+        from = w*shard;
+        to = from + shard < veclen ? from + shard : veclen;
+        cbuf_reset(cb);
+        while ((len = read(fdv[w], buf, sizeof(buf))) != 0){
+            if (len < 0){
+                if (errno == EINTR)
+                    continue;
+                break;
+            }
+            if (cbuf_append_buf(cb, buf, len) < 0){
+                clixon_err(OE_UNIX, errno, "cbuf_append_buf");
+                goto done;
+            }
+        }
+        close(fdv[w]);
+        fdv[w] = -1;
+        ok = (waitpid(pidv[w], &status, 0) == pidv[w] &&
+              WIFEXITED(status) && WEXITSTATUS(status) == 0);
+        pidv[w] = 0;
+        if (len < 0 || !ok || cbuf_len(cb) == 0){
+            clixon_debug(CLIXON_DBG_DEFAULT, "worker %d failed, validating shard sequentially", w);
+            if ((ret = validate_all_range(h, vec, from, to, state, xret)) < 0)
+                goto done;
+            if (ret == 0)
+                goto fail;
+        }
+        else if (cbuf_get(cb)[0] == '0'){
+            if (xret){
+                if (*xret == NULL){
+                    if ((*xret = xml_new("rpc-reply", NULL, CX_ELMNT)) == NULL)
+                        goto done;
+                    if (xml_add_attr(*xret, "xmlns", NETCONF_BASE_NAMESPACE, NULL, NULL) == NULL)
+                        goto done;
+                }
+                if (clixon_xml_parse_string(cbuf_get(cb)+1, YB_NONE, NULL, xret, NULL) < 0)
+                    goto done;
+            }
+            goto fail;
+        }
+    }
+    /* Shards without workers are validated here */
+    if (wn < nw &&
+        (ret = validate_all_range(h, vec, wn*shard < veclen ? wn*shard : veclen, veclen,
+                                  state, xret)) < 1){
+        if (ret < 0)
+            goto done;
+        goto fail;
+    }
+    retval = 1;
+ done:
+    _validate_parallel = nw;
+    for (w=1; pidv && w<nw; w++){
+        if (fdv[w] != -1)
+            close(fdv[w]);
+        if (pidv[w] != 0){
+            kill(pidv[w], SIGKILL);
+            waitpid(pidv[w], &status, 0);
+        }
+    }
+    if (pidv)
+        free(pidv);
+    if (fdv)
+        free(fdv);
+    if (cb)
+        cbuf_free(cb);
+    if (vec)
+        free(vec);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+#endif /* VALIDATE_PARALLEL_MIN */
+
 /*! Validate a single XML node with yang specification for all (not only added) entries
  *
  * @param[in]  h     Clixon handle
@@ -1768,7 +2678,7 @@ xml_yang_validate_all1(clixon_handle h,
     int        inext;
     int        ret;
 
-    if (clicon_option_bool(h, "CLICON_YANG_SCHEMA_MOUNT")){
+    if (clicon_option_bool_id(h, CO_YANG_SCHEMA_MOUNT)){
         if ((ret = xml_yang_mount_get(h, xt, &vl, NULL, NULL)) < 0)
             goto done;
         /* Check if validate beyond mountpoints */
@@ -1778,7 +2688,7 @@ xml_yang_validate_all1(clixon_handle h,
     /* if not given by argument (overide) use default link
        and !Node has a config sub-statement and it is false */
     if ((yt = xml_spec(xt)) == NULL){
-        if (clicon_option_bool(h, "CLICON_YANG_UNKNOWN_ANYDATA") == 1) {
+        if (clicon_option_bool_id(h, CO_YANG_UNKNOWN_ANYDATA) == 1) {
             clixon_log(h, LOG_WARNING,
                        "%s: %d: No YANG spec for %s, validation skipped",
                        __func__, __LINE__, xml_name(xt));
@@ -1800,7 +2710,25 @@ xml_yang_validate_all1(clixon_handle h,
         clixon_debug(CLIXON_DBG_YANG, "Unknown XML element: %s", cbuf_get(cb));
         goto fail;
     }
+#ifdef VALIDATE_INCREMENTAL
+    /* Unchanged subtree whose expressions do not read changed nodes is as in running */
+    if (validate_incr.vi_names != NULL &&
+        !xml_flag(xt, XML_FLAG_ADD|XML_FLAG_CHANGE) &&
+        (xp = xml_parent(xt)) != NULL &&
+        !xml_flag(xp, XML_FLAG_ADD|XML_FLAG_CHANGE)){
+        if ((ret = validate_incr_tree(yt)) < 0)
+            goto done;
+        if (ret == 0)
+            goto ok;
+    }
+#endif
     if (yang_config(yt) != 0){
+#ifdef VALIDATE_INCREMENTAL
+        if ((ret = validate_incr_when(xt, yt)) < 0)
+            goto done;
+        if (ret == 0) /* Not affected by changes */
+            goto when_ok;
+#endif
         ret = yang_check_when_xpath(xt, xml_parent(xt), yt, &hit, &nr, &xpath1);
         clixon_debug(CLIXON_DBG_XPATH|CLIXON_DBG_DETAIL, "nr:%d xpath:%s return:%d", nr, xpath1, ret);
         if (ret < 0)
@@ -1822,10 +2750,19 @@ xml_yang_validate_all1(clixon_handle h,
                 goto done;
             goto fail;
         }
+#ifdef VALIDATE_INCREMENTAL
+    when_ok:
+        /* Children of unchanged nodes are as in running */
+        if (validate_incr.vi_names == NULL ||
+            xml_flag(xt, XML_FLAG_ADD|XML_FLAG_CHANGE)){
+#endif
         if ((ret = check_mandatory(xt, yt, xret)) < 0)
             goto done;
         if (ret == 0)
             goto fail;
+#ifdef VALIDATE_INCREMENTAL
+        }
+#endif
         /* Node-specific validation */
         switch (yang_keyword_get(yt)){
         case Y_ANYXML:
@@ -1877,6 +2814,12 @@ xml_yang_validate_all1(clixon_handle h,
             saw_node = 1;
 
             xpath = yang_argument_get(yc); /* "must" has xpath argument */
+#ifdef VALIDATE_INCREMENTAL
+            if ((ret = validate_incr_check(xt, xpath, 0)) < 0)
+                goto done;
+            if (ret == 0) /* Not affected by changes */
+                continue;
+#endif
             clixon_debug(CLIXON_DBG_XPATH, "xpath '%s'", xpath);
             /* the context node is the node in the accessible tree for
              * which the "must" statement is defined.
@@ -1919,6 +2862,15 @@ xml_yang_validate_all1(clixon_handle h,
             }
         }
     }
+#ifdef VALIDATE_PARALLEL_MIN
+    /* Many children may be split over several processes */
+    if ((ret = validate_all_parallel(h, xt, state, xret)) < 0)
+        goto done;
+    if (ret == 0)
+        goto fail;
+    if (ret == 1)
+        goto children_ok;
+#endif
     x = NULL;
     while ((x = xml_child_each(xt, x, CX_ELMNT)) != NULL) {
         if (!state && (yc = xml_spec(x)) != NULL && yang_config(yc) == 0)
@@ -1928,6 +2880,9 @@ xml_yang_validate_all1(clixon_handle h,
         if (ret == 0)
             goto fail;
     }
+#ifdef VALIDATE_PARALLEL_MIN
+ children_ok:
+#endif
     /* Check unique and min-max after choice test for example*/
     if (yang_config(yt) != 0){
         /* Checks if next level contains any unique list constraints */
@@ -1996,20 +2951,88 @@ xml_yang_validate_all_state(clixon_handle h,
                             int           state,
                             cxobj       **xret)
 {
-    cxobj     *x;
-    yang_stmt *y;
-    int        ret;
+    int            retval;
+    cxobj         *x;
+    yang_stmt     *y;
+    clixon_trace_t tr;
 
+    tr = clixon_trace_begin(CLIXON_DBG_YANG);
     x = NULL;
     while ((x = xml_child_each(xt, x, CX_ELMNT)) != NULL) {
         if (!state && (y = xml_spec(x)) != NULL && yang_config(y) == 0)
             continue; /* skip if non-config */
-        if ((ret = xml_yang_validate_all(h, x, state, xret)) < 1)
-            return ret;
+        if ((retval = xml_yang_validate_all(h, x, state, xret)) < 1)
+            goto done;
     }
-    if ((ret = xml_yang_validate_minmax(xt, 0, xret)) < 1)
-        return ret;
-    return 1;
+    retval = xml_yang_validate_minmax(xt, 0, xret);
+ done:
+    clixon_trace_end(tr, CLIXON_DBG_YANG, "xml_yang_validate_all", NULL);
+    return retval;
+}
+
+/*! Register a changed XML node for incremental must/when validation
+ *
+ * The names of the node, its ancestors and descendants are registered as changed.
+ * Thereafter, xml_yang_validate_all only evaluates must and when expressions of
+ * existing nodes if they read a registered name, until xml_yang_validate_incr_reset.
+ * Assumes that the tree to validate has XML_FLAG_ADD and XML_FLAG_CHANGE set as
+ * in a commit transaction, and that its unchanged parts are valid.
+ * @param[in]  x   Added, deleted or changed XML node
+ * @retval     0   OK
+ * @retval    -1   Error
+ * @see VALIDATE_INCREMENTAL
+ */
+int
+xml_yang_validate_incr_add(cxobj *x)
+{
+    int    retval = -1;
+#ifdef VALIDATE_INCREMENTAL
+    cxobj *xa;
+
+    if (validate_incr.vi_names == NULL &&
+        (validate_incr.vi_names = clicon_hash_init()) == NULL)
+        goto done;
+    if (validate_incr.vi_deps == NULL &&
+        (validate_incr.vi_deps = clicon_hash_init()) == NULL)
+        goto done;
+    for (xa = xml_parent(x); xa != NULL; xa = xml_parent(xa))
+        if (validate_incr_name_add(xa, NULL) < 0)
+            goto done;
+    if (xml_apply0(x, CX_ELMNT, validate_incr_name_add, NULL) < 0)
+        goto done;
+    xml_yang_validate_minmax_incr_set(1);
+#endif
+    retval = 0;
+#ifdef VALIDATE_INCREMENTAL
+ done:
+#endif
+    return retval;
+}
+
+/*! Stop incremental must/when validation and free registered names
+ *
+ * @retval     0   OK
+ * @see xml_yang_validate_incr_add
+ */
+int
+xml_yang_validate_incr_reset(void)
+{
+#ifdef VALIDATE_INCREMENTAL
+    if (validate_incr.vi_names){
+        clicon_hash_free(validate_incr.vi_names);
+        validate_incr.vi_names = NULL;
+    }
+    if (validate_incr.vi_deps){
+        clicon_hash_free(validate_incr.vi_deps);
+        validate_incr.vi_deps = NULL;
+    }
+    if (validate_incr.vi_trees){
+        clicon_hash_free(validate_incr.vi_trees);
+        validate_incr.vi_trees = NULL;
+    }
+    xml_yang_validate_minmax_incr_set(0);
+#endif
+    return 0;
 }
 
 /*! Exit validation module
@@ -2020,6 +3043,7 @@ xml_yang_validate_exit(clixon_handle h)
 #ifdef LEAFREF_OPTIMIZE
     leafref_opt_exit(h);
 #endif
+    xml_yang_validate_incr_reset();
     return 0;
 }
 
@@ -95,6 +95,73 @@ struct vec_order {
     size_t        vo_slen;   /* Length of vo_strvec (is actually global to vector) */
 };
 
+/* Only check lists with added or changed entries, see xml_yang_validate_minmax_incr_set */
+static int _minmax_incr = 0;
+
+/*! Hash of a tuple of unique values: FNV-1a over the bodies with a separator
+ *
+ * @param[in]  vec   Vector of tuples
+ * @param[in]  i     Tuple index
+ * @param[in]  vlen  Length of each tuple
+ */
+static uint32_t
+unique_tuple_hash(char **vec,
+                  int    i,
+                  int    vlen)
+{
+    uint32_t h = 2166136261u;
+    char    *b;
+    int      v;
+
+    for (v=0; v<vlen; v++){
+        for (b = vec[i*vlen+v]; *b; b++)
+            h = (h ^ (uint8_t)*b) * 16777619u;
+        h = (h ^ 0xff) * 16777619u;
+    }
+    return h;
+}
+
+/*! Insert tuple in hash set of tuples, return error if already exists
+ *
+ * Replaces the quadratic search of check_insert_duplicate for lists not sorted on the
+ * values, ie unique statements and lists ordered-by user
+ * @param[in]  vec    Vector of tuples
+ * @param[in]  i1     The new tuple is vec[i1]
+ * @param[in]  vlen   Length of each tuple
+ * @param[in]  tab    Hash table of tuple indexes, -1 is empty
+ * @param[in]  size   Size of tab, power of 2
+ * @param[out] dupl   Index of duplicated tuple (if retval = -1)
+ * @retval     0      OK, tuple is unique and inserted
+ * @retval    -1      Duplicate detected
+ */
+static int
+unique_tuple_insert(char **vec,
+                    int    i1,
+                    int    vlen,
+                    int   *tab,
+                    size_t size,
+                    int   *dupl)
+{
+    size_t j;
+    int    i;
+    int    v;
+
+    j = unique_tuple_hash(vec, i1, vlen) & (size - 1);
+    while ((i = tab[j]) != -1){
+        for (v=0; v<vlen; v++)
+            if (strcmp(vec[i*vlen+v], vec[i1*vlen+v]) != 0)
+                break;
+        if (v == vlen){
+            if (dupl)
+                *dupl = i;
+            return -1;
+        }
+        j = (j + 1) & (size - 1);
+    }
+    tab[j] = i1;
+    return 0;
+}
+
 /*! New element last in list, check if already exists if so return -1
  *
  * @param[in]  vec   Vector of existing entries (new is last)
@@ -255,6 +322,8 @@ check_unique_list_direct(cxobj     *x,
     char     *str;
     cvec     *cvk;
     int       dupl;
+    int      *tab = NULL; /* Hash set of tuples if not sorted */
+    size_t    size = 16;
 
     /* If list and is sorted by system, then it is assumed elements are in key-order which is optimized
      * Other cases are "unique" constraint or list sorted by user which is quadratic in complexity
@@ -280,6 +349,15 @@ check_unique_list_direct(cxobj     *x,
         clixon_err(OE_UNIX, errno, "calloc");
         goto done;
     }
+    if (!sorted){
+        while (size < 2*(size_t)xml_child_nr(xt))
+            size <<= 1;
+        if ((tab = malloc(size*sizeof(int))) == NULL){
+            clixon_err(OE_UNIX, errno, "malloc");
+            goto done;
+        }
+        memset(tab, 0xff, size*sizeof(int)); /* -1 */
+    }
     /* Loop over children, then over each key, then search "backwards" */
     i = 0; /* x element index */
     do {
@@ -318,7 +396,8 @@ check_unique_list_direct(cxobj     *x,
         }
         if (cvi==NULL){
             /* Last element (i) is newly inserted, see if it is already there */
-            if (check_insert_duplicate(vec, i, clen, sorted, &dupl) < 0){
+            if ((sorted ? check_insert_duplicate(vec, i, clen, sorted, &dupl) :
+                 unique_tuple_insert(vec, i, clen, tab, size, &dupl)) < 0){
                 if (xret && netconf_data_not_unique_xml(xret, x, cvk) < 0)
                     goto done;
                 goto fail;
@@ -331,6 +410,8 @@ check_unique_list_direct(cxobj     *x,
     /* It would be possible to cache vec here as an optimization */
     retval = 1;
  done:
+    if (tab)
+        free(tab);
     if (xvec)
         free(xvec);
     if (vec)
@@ -635,6 +716,43 @@ xml_yang_minmax_gap_analysis(cxobj      *xt,
     goto done;
 }
 
+/*! Check if any entry of a list has been added or changed
+ *
+ * @param[in]  x     The first element in the list
+ * @param[in]  xt    The parent of x
+ * @param[in]  y     Its yang spec (Y_LIST)
+ * @retval     1     At least one entry is added or changed
+ * @retval     0     No entry is added or changed
+ */
+static int
+list_changed(cxobj     *x,
+             cxobj     *xt,
+             yang_stmt *y)
+{
+    do {
+        if (xml_flag(x, XML_FLAG_ADD|XML_FLAG_CHANGE))
+            return 1;
+        x = xml_child_each(xt, x, CX_ELMNT);
+    } while (x && y == xml_spec(x));
+    return 0;
+}
+
+/*! Only check unique and min/max of added or changed nodes
+ *
+ * Running is valid, so only lists with added or changed entries, or with deleted
+ * entries, may violate unique or min/max-elements constraints. These are marked with
+ * XML_FLAG_ADD or XML_FLAG_CHANGE, on the entries and on all their ancestors, in a
+ * commit transaction.
+ * @param[in]  on  1: check only changed nodes, 0: check all
+ * @see xml_yang_validate_incr_add
+ */
+int
+xml_yang_validate_minmax_incr_set(int on)
+{
+    _minmax_incr = on;
+    return 0;
+}
+
 /*! YANG Minmax check, no recursion
  *
  * Assume xt:s children are sorted and yang populated.
@@ -718,6 +836,8 @@ xml_yang_validate_minmax(cxobj  *xt,
     int           inext = 0;
     int           ret;
 
+    if (_minmax_incr && !xml_flag(xt, XML_FLAG_ADD|XML_FLAG_CHANGE))
+        goto ok; /* Nothing changed below xt */
     yt = xml_spec(xt); /* If yt == NULL, then no gap-analysis is done */
     while ((x = xml_child_each(xt, x, CX_ELMNT)) != NULL){
         if ((y = xml_spec(x)) == NULL)
@@ -743,7 +863,8 @@ xml_yang_validate_minmax(cxobj  *xt,
             nr=1;
             /* new list check */
             if (ret){
-                if (keyw == Y_LIST){
+                if (keyw == Y_LIST &&
+                    (!_minmax_incr || list_changed(x, xt, y))){
                     if ((ret = check_unique_list_direct(x, xt, y, y, xret)) < 0)
                         goto done;
                     if (ret == 0)
@@ -819,6 +940,7 @@ xml_yang_validate_minmax(cxobj  *xt,
     }
     if (ret == 0)
         goto fail;
+ ok:
     retval = 1;
  done:
     return retval;
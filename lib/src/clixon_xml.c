@@ -47,6 +47,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
+#include <stddef.h>
 #include <inttypes.h>
 #include <unistd.h>
 #include <errno.h>
@@ -76,6 +77,9 @@
 #include "clixon_xml_io.h"
 #include "clixon_xml_parse.h"
 #include "clixon_xml_nsctx.h"
+#include "clixon_string.h"
+#include "clixon_xml_hindex.h"
+#include "clixon_digest.h"
 
 /*
  * Constants
@@ -89,18 +93,54 @@
 #define XML_CHILDVEC_SIZE_START_ELMNT 16
 #define XML_CHILDVEC_SIZE_THRESHOLD 65536
 
+/* Children are split in chunks when inserting in the middle of a vector of this length */
+#define XML_CHILDVEC_CHUNK_THRESHOLD 4096
+/* Max number of children per chunk */
+#define XML_CHILDVEC_CHUNK_SIZE 1024
+
+/* Max length of body/attribute values stored inline in struct xmlbody, including
+ * terminating null. Longer values are allocated separately */
+#define XML_VALUE_INLINE_LEN 16
+
+/* xb_value_max of shared values, see struct xml_value_shared */
+#define XML_VALUE_SHARED_MARK UINT32_MAX
+
+/* Number of XML nodes allocated in each slab chunk */
+#define XML_SLAB_CHUNK_NR 1024
+
+/* Number of frames on the C stack in iterative tree traversal, deeper trees use the heap */
+#define XML_FRAME_NR 32
+
+/* Flags that are valid only if the epoch of the node is the epoch of its tree
+ * These flags are reset in a whole tree by incrementing the tree epoch
+ * @see xml_flag_reset_tree
+ */
+#define XML_FLAG_EPOCH (XML_FLAG_MARK|XML_FLAG_CHANGE)
+
 /* Intention of these macros is to guard against access of type-specific fields 
  * As debug they can contain an assert.
  */
 #define is_element(x) (xml_type(x)==CX_ELMNT)
 #define is_bodyattr(x) (xml_type(x)==CX_BODY || xml_type(x)==CX_ATTR)
 
+/* Access body/attribute fields of an XML node, see struct xmlbody */
+#define xml_bodyattr(x) ((struct xmlbody *)(x))
+
 /*
  * Types
  */
 
+struct xmlbody;
+
+static size_t xml_childvec_size(cxobj *x);
+static size_t xml_value_size(struct xmlbody *xb);
+static void xml_digest_reset(cxobj *x);
 #ifdef XML_EXPLICIT_INDEX
 static int xml_search_index_free(cxobj *x);
+static size_t xml_search_index_size(cxobj *x, uint64_t *nr);
+static int xml_search_index_child_add(cxobj *xp, cxobj *xc);
+static int xml_search_index_child_rm(cxobj *xp, cxobj *xc);
+static int xml_search_index_leaf(cxobj *xi, int add);
 
 /* A search index pair consisting of a name of an (index) variable and a vector of xml children
  * the variable should be a potential child of the XML node
@@ -125,9 +165,25 @@ struct search_index{
     qelem_t      si_q;    /* Queue header */
     char        *si_name; /* Name of index variable (must be (potential) child of xml node at hand */
     clixon_xvec *si_xvec; /* Sorted vector of xml object pointers (should be of YANG type LIST) */
+    int          si_cursor; /* Position of last object returned by xml_child_index_each */
 };
 #endif
 
+/*! Child vector split in chunks, used for large lists with inserts in the middle
+ *
+ * x_childvec_len is the total number of children, and xk_start[k] is the position of the
+ * first child of chunk k.
+ * @see CLICON_XML_CHILDVEC_CHUNK
+ */
+struct xml_chunkvec{
+    cxobj  ***xk_vec;    /* Vector of chunks, each of XML_CHILDVEC_CHUNK_SIZE */
+    int      *xk_len;    /* Number of children of each chunk */
+    size_t   *xk_start;  /* Position of first child of each chunk */
+    int       xk_nr;     /* Number of chunks */
+    int       xk_max;    /* Allocated length of chunk vectors */
+    int       xk_last;   /* Last accessed chunk, for sequential access */
+};
+
 /*! xml tree node, with name, type, parent, children, etc 
  *
  * Note that this is a private type not visible from externally, use
@@ -165,55 +221,126 @@ struct search_index{
  */
 struct xml{
     enum cxobj_type   x_type;       /* type of node: element, attribute, body */
+    uint16_t          x_flags;      /* Flags according to XML_FLAG_* */
+    uint16_t          x_epoch;      /* Epoch of XML_FLAG_EPOCH flags, tree epoch if root */
     char             *x_name;       /* name of node */
     char             *x_prefix;     /* namespace localname N, called prefix */
-    uint16_t          x_flags;      /* Flags according to XML_FLAG_* */
     struct xml       *x_up;         /* parent node in hierarchy if any */
 #ifdef XML_PARENT_CANDIDATE
     struct xml       *x_up_candidate; /* Candidate parent node for special cases (when+xpath) */
 #endif
-    int              _x_vector_i;   /* internal use: xml_child_each */
     int              _x_i;          /* internal use for stable sorting:
                                        see xml_enumerate_children and xml_cmp */
-    /*----- next is body/attribute only */
-    cbuf             *x_value_cb;  /* attribute and body nodes have values (XXX: this consumes 
-                                       memory) cv? */
-    /*----- up to here is common to all next is element only */
+    /*----- up to here is common to all next is element only, see struct xmlbody */
+    int               x_childvec_len;/* Number of children (fills padding after _x_i) */
     struct xml      **x_childvec;   /* vector of children nodes (XXX: use clixon_vec ) */
-    size_t            x_childvec_len;/* Number of children */
     int               x_childvec_max;/* Length of allocated vector */
-
-    cvec             *x_ns_cache;   /* Cached vector of namespaces (set by bind-yang) */
+    int               x_child_cursor;/* Position of last child returned by xml_child_each */
     yang_stmt        *x_spec;       /* Pointer to specification, eg yang, 
                                        by reference, dont free */
-    cg_var           *x_cv;         /* Cached value as cligen variable (set by xml_cmp) */
+    /*----- up to here is used in tree traversal, fits in one 64 byte cache line */
+    cg_var           *x_cv;         /* Cached value as cligen variable (set by xml_cmp or bind) */
+    struct xml       *x_eroot;      /* Cached root of tree, valid if x_eroot_gen is _tree_gen */
+    uint64_t          x_eroot_gen;  /* Tree generation of x_eroot, see xml_epoch_root */
+    struct xml_chunkvec *x_chunks;  /* If set, children are in chunks instead of x_childvec */
+    struct xml_cold  *x_cold;       /* Rarely used fields, allocated on first use */
+};
+
+/*! Rarely set fields of XML element, kept out of struct xml
+ *
+ * Most nodes have none of these set, allocated by xml_cold_get on first set and freed
+ * with the node.
+ */
+struct xml_cold{
+    cvec             *xc_ns_cache;   /* Cached vector of namespaces (set by bind-yang) */
+    struct xml_nsscope *xc_nsscope;  /* Shared namespace context, see xml_nsscope_get */
+    struct xml_hindex *xc_hindex;    /* Hash index of list children, see clixon_xml_hindex.c */
 #ifdef XML_EXPLICIT_INDEX
-    struct search_index *x_search_index; /* explicit search index vectors */
+    struct search_index *xc_search_index; /* explicit search index vectors */
 #endif
+    unsigned char   *xc_digest;      /* Subtree digest if XML_FLAG_DIGEST, see xml_digest */
 };
 
+/* Read field of the cold part of an XML element, NULL if not allocated */
+#define XML_COLD(x, field) ((x)->x_cold ? (x)->x_cold->field : NULL)
+
 /* Variant of struct xml for use by non-elements to save space
+ *
+ * Short values (most leaf values) are stored inline in xb_value_inline, longer values
+ * are allocated and grown by xml_value_append
  * @see struct xml  For XML elements
  */
 struct xmlbody{
     enum cxobj_type   xb_type;       /* type of node: element, attribute, body */
+    uint16_t          xb_flags;      /* Flags according to XML_FLAG_* */
+    uint16_t          xb_epoch;      /* Epoch of XML_FLAG_EPOCH flags, see x_epoch */
     char             *xb_name;       /* name of node */
     char             *xb_prefix;     /* namespace localname N, called prefix */
-    uint16_t          xb_flags;      /* Flags according to XML_FLAG_* */
     struct xml       *xb_up;         /* parent node in hierarchy if any */
 #ifdef XML_PARENT_CANDIDATE
     struct xml       *xb_up_candidate; /* Candidate parent node for special cases (when+xpath) */
 #endif
-    int              _xb_vector_i;   /* internal use: xml_child_each */
     int              _xb_i;          /* internal use for sorting: 
                                        see xml_enumerate and xml_cmp */
-    cbuf             *xb_value_cb;  /* attribute and body nodes have values */
+    /*----- up to here is common to all next is body/attribute only */
+    char             *xb_value;      /* Value, points to xb_value_inline or allocated, or NULL */
+    uint32_t          xb_value_len;  /* Length of value (strlen) */
+    uint32_t          xb_value_max;  /* Allocated size of value, 0 if inline */
+    char              xb_value_inline[XML_VALUE_INLINE_LEN]; /* Inline storage of short values */
+};
+
+/*! Large body/attribute value shared by copies of an XML node
+ *
+ * Made shared when a node with a large value is copied, see xml_value_shared_set.
+ * A shared value is immutable: a node gets a private copy before its value is modified.
+ * xb_value points to xs_data and xb_value_max is XML_VALUE_SHARED_MARK.
+ */
+struct xml_value_shared{
+    uint32_t          xs_refcnt;     /* Number of nodes referencing the value */
+    uint32_t          xs_len;        /* Length of value (strlen) */
+    char             *xs_enc;        /* Cached XML-encoded value, or NULL */
+    char              xs_data[];     /* Value, null-terminated */
+};
+
+/* Get shared value of a body/attribute node with xb_value_max == XML_VALUE_SHARED_MARK */
+#define XML_VALUE_SHARED_GET(xb) \
+    ((struct xml_value_shared *)((xb)->xb_value - offsetof(struct xml_value_shared, xs_data)))
+
+/*! Free-list slab of fixed-size XML node structs
+ *
+ * Nodes are allocated in chunks of XML_SLAB_CHUNK_NR nodes. Unused nodes are linked in a
+ * free-list through their first word.
+ * @see xml_slab_set
+ */
+struct xml_slab{
+    size_t        xs_size;     /* Size of one node: sizeof struct xml or struct xmlbody */
+    void         *xs_free;     /* Free-list of unused nodes */
+    void        **xs_chunkvec; /* Vector of allocated chunks */
+    int           xs_chunklen; /* Number of allocated chunks */
+};
+
+/*! Frame of explicit stack in iterative tree traversal
+ *
+ * @see xml_copy, xml_apply
+ */
+struct xml_frame{
+    cxobj        *xf_x0;       /* Node whose children are traversed, source of copy */
+    cxobj        *xf_x1;       /* Destination node of copy */
+    int           xf_i;        /* Index of next child of xf_x0 */
+    int           xf_flag;     /* Copy: destination was empty */
 };
 
 /*
  * Variables
  */
 
+/* One slab for element nodes and one for body/attribute nodes */
+static struct xml_slab _slab_elmnt = {sizeof(struct xml), NULL, NULL, 0};
+static struct xml_slab _slab_body = {sizeof(struct xmlbody), NULL, NULL, 0};
+
+/* Allocate new XML nodes from slabs, see xml_slab_set */
+static int _xml_slab = 0;
+
 /*! Mapping between xml type string and integer
  */
 static const map_str2int xsmap[] = {
@@ -263,6 +390,35 @@ xml_stats_str2type(const char *str)
 /* Stats (too low-level to hang it on handle) */
 static uint64_t _stats_xml_nr = 0;
 
+/* Namespace generation, incremented when an element gets a new parent or a namespace
+ * declaration or cache changes in any tree. Shared namespace contexts of another
+ * generation are not valid, see xml_nsscope_gen
+ */
+static uint64_t _nsscope_gen = 0;
+
+/* Tree generation, incremented when a node with children gets a new parent. Cached roots of
+ * another generation are not valid, see xml_epoch_root
+ */
+static uint64_t _tree_gen = 1;
+
+/* Split child vectors of large lists in chunks, see xml_childvec_chunk_set */
+static int _childvec_chunk = 0;
+
+/*! Enable split of child vectors of large lists in chunks
+ *
+ * Cant use option directly since there is no handle in xml functions.
+ * Vectors already split are kept chunked if disabled.
+ * @param[in]  enable  If set, split on insert in the middle of a large child vector
+ * @retval     0       OK
+ * @see CLICON_XML_CHILDVEC_CHUNK
+ */
+int
+xml_childvec_chunk_set(int enable)
+{
+    _childvec_chunk = enable;
+    return 0;
+}
+
 /*! Get global statistics about XML objects
  *
  * @param[out]  nr  Number of existing XML objects (created - freed)
@@ -295,33 +451,33 @@ xml_stats_one(cxobj         *x,
     switch (type){
     case XML_STATS_ALL:
         nr++;
+#ifndef XML_NAME_INTERN /* Interned names are shared, see clixon_str_intern_stats */
         if (x->x_name)
             sz += strlen(x->x_name) + 1;
         if (x->x_prefix)
             sz += strlen(x->x_prefix) + 1;
+#endif
         switch (xml_type(x)){
         case CX_ELMNT:
             sz += sizeof(struct xml);
-            sz += x->x_childvec_max*sizeof(struct xml*);
-            if (x->x_ns_cache)
-                sz += cvec_size(x->x_ns_cache);
+            sz += xml_childvec_size(x);
+            if (x->x_cold)
+                sz += sizeof(struct xml_cold);
+            if (XML_COLD(x, xc_digest))
+                sz += CLIXON_DIGEST_LEN;
+            if (XML_COLD(x, xc_ns_cache))
+                sz += cvec_size(x->x_cold->xc_ns_cache);
             if (x->x_cv)
                 sz += cv_size(x->x_cv);
+            sz += xml_hindex_size(x);
 #ifdef XML_EXPLICIT_INDEX
-            if (x->x_search_index){
-                sz += sizeof(struct search_index);
-                if (x->x_search_index->si_name)
-                    sz += strlen(x->x_search_index->si_name)+1;
-                if (x->x_search_index->si_xvec)
-                    sz += clixon_xvec_len(x->x_search_index->si_xvec)*sizeof(struct cxobj*);
-            }
+            sz += xml_search_index_size(x, NULL);
 #endif
             break;
         case CX_BODY:
         case CX_ATTR:
             sz += sizeof(struct xmlbody);
-            if (x->x_value_cb)
-                sz += cbuf_buflen(x->x_value_cb);
+            sz += xml_value_size(xml_bodyattr(x));
             break;
         default:
             break;
@@ -348,26 +504,30 @@ xml_stats_one(cxobj         *x,
     case XML_STATS_NAME:
         if (x->x_name){
             nr++;
+#ifndef XML_NAME_INTERN
             sz += strlen(x->x_name) + 1;
+#endif
         }
         break;
     case XML_STATS_PREFIX:
         if (x->x_prefix){
             nr++;
+#ifndef XML_NAME_INTERN
             sz += strlen(x->x_prefix) + 1;
+#endif
         }
         break;
     case XML_STATS_CHILDVEC:
         if (xml_type(x) == CX_ELMNT){
             if (x->x_childvec_len)
                 nr++;
-            sz += x->x_childvec_max*sizeof(struct xml*);
+            sz += xml_childvec_size(x);
         }
         break;
     case XML_STATS_NS_CACHE:
-        if (xml_type(x) == CX_ELMNT && x->x_ns_cache){
+        if (xml_type(x) == CX_ELMNT && XML_COLD(x, xc_ns_cache)){
             nr++;
-            sz += cvec_size(x->x_ns_cache);
+            sz += cvec_size(x->x_cold->xc_ns_cache);
         }
         break;
     case XML_STATS_CV:
@@ -378,21 +538,15 @@ xml_stats_one(cxobj         *x,
         break;
     case XML_STATS_SEARCH_INDEX:
 #ifdef XML_EXPLICIT_INDEX
-        if (xml_type(x) == CX_ELMNT && x->x_search_index){
-            nr++;
-            sz += sizeof(struct search_index);
-            if (x->x_search_index->si_name)
-                sz += strlen(x->x_search_index->si_name)+1;
-            if (x->x_search_index->si_xvec)
-                sz += clixon_xvec_len(x->x_search_index->si_xvec)*sizeof(struct cxobj*);
-        }
+        if (xml_type(x) == CX_ELMNT)
+            sz += xml_search_index_size(x, &nr);
 #endif
         break;
     case XML_STATS_VALUE:
         if ((xml_type(x) == CX_BODY || xml_type(x) == CX_ATTR) &&
-            x->x_value_cb){
+            xml_bodyattr(x)->xb_value){
             nr++;
-            sz += cbuf_buflen(x->x_value_cb);
+            sz += xml_value_size(xml_bodyattr(x));
         }
         break;
     }
@@ -422,6 +576,7 @@ xml_stats(cxobj          *xt,
     uint64_t nr = 0;
     size_t   sz = 0;
     cxobj   *xc;
+    int      inext;
 
     if (xt == NULL){
         clixon_err(OE_XML, EINVAL, "xml node is NULL");
@@ -432,8 +587,8 @@ xml_stats(cxobj          *xt,
         *nrp += nr;
     if (szp)
         *szp += sz;
-    xc = NULL;
-    while ((xc = xml_child_each(xt, xc, -1)) != NULL) {
+    inext = 0;
+    while ((xc = xml_child_iter(xt, &inext, -1)) != NULL) {
         nr=0;
         sz=0;
         xml_stats(xc, type, &nr, &sz);
@@ -447,6 +602,103 @@ xml_stats(cxobj          *xt,
     return retval;
 }
 
+/*! Enable allocation of XML nodes from free-list slabs instead of one malloc per node
+ *
+ * Cant use option directly since there is no handle in xml functions.
+ * Nodes allocated from slabs are marked with XML_FLAG_SLAB and returned to their slab when
+ * freed, also if disabled later.
+ * @param[in]  enable  If set, xml_new allocates nodes from slabs
+ * @retval     0       OK
+ * @see CLICON_XML_SLAB_ALLOC
+ */
+int
+xml_slab_set(int enable)
+{
+    _xml_slab = enable;
+    return 0;
+}
+
+/*! Get a node from a slab, allocate a new chunk if the free-list is empty
+ *
+ * @param[in]  xs   XML slab
+ * @retval     x    Uninitialized node of size xs_size
+ * @retval     NULL Error
+ */
+static void *
+xml_slab_alloc(struct xml_slab *xs)
+{
+    char  *chunk;
+    void **vec;
+    void  *x;
+    int    i;
+
+    if (xs->xs_free == NULL){
+        if ((chunk = malloc(XML_SLAB_CHUNK_NR*xs->xs_size)) == NULL){
+            clixon_err(OE_XML, errno, "malloc");
+            return NULL;
+        }
+        if ((vec = realloc(xs->xs_chunkvec, (xs->xs_chunklen+1)*sizeof(void*))) == NULL){
+            clixon_err(OE_XML, errno, "realloc");
+            free(chunk);
+            return NULL;
+        }
+        xs->xs_chunkvec = vec;
+        xs->xs_chunkvec[xs->xs_chunklen++] = chunk;
+        /* Link nodes in reverse so that they are handed out in address order */
+        for (i=XML_SLAB_CHUNK_NR-1; i>=0; i--){
+            x = chunk + i*xs->xs_size;
+            *(void**)x = xs->xs_free;
+            xs->xs_free = x;
+        }
+    }
+    x = xs->xs_free;
+    xs->xs_free = *(void**)x;
+    return x;
+}
+
+/*! Return a node to its slab free-list
+ *
+ * @param[in]  xs   XML slab
+ * @param[in]  x    Node previously allocated with xml_slab_alloc from xs
+ */
+static void
+xml_slab_release(struct xml_slab *xs,
+                 void            *x)
+{
+    *(void**)x = xs->xs_free;
+    xs->xs_free = x;
+}
+
+/*! Free global XML resources: node slab chunks and interned names
+ *
+ * Call at exit after all XML trees have been freed, no XML nodes may be accessed after this
+ * @retval  0   OK
+ * @see xml_slab_set
+ * @see XML_NAME_INTERN
+ */
+int
+xml_exit(void)
+{
+    struct xml_slab *xs;
+    int              i;
+
+    xs = &_slab_elmnt;
+    do {
+        for (i=0; i<xs->xs_chunklen; i++)
+            free(xs->xs_chunkvec[i]);
+        if (xs->xs_chunkvec)
+            free(xs->xs_chunkvec);
+        xs->xs_chunkvec = NULL;
+        xs->xs_chunklen = 0;
+        xs->xs_free = NULL;
+        xs = (xs == &_slab_elmnt) ? &_slab_body : NULL;
+    } while (xs != NULL);
+#ifdef XML_NAME_INTERN
+    clixon_str_intern_exit();
+#endif
+    return 0;
+}
+
 /*
  * Access functions
  */
@@ -476,6 +728,19 @@ int
 xml_name_set(cxobj      *xn,
              const char *name)
 {
+    xml_digest_reset(xn);
+    if (xml_type(xn) == CX_ATTR)
+        _nsscope_gen++;
+#ifdef XML_NAME_INTERN
+    char *iname = NULL;
+
+    /* Intern new name before releasing old, name may be the old name */
+    if (name && (iname = clixon_str_intern(name)) == NULL)
+        return -1;
+    if (xn->x_name)
+        clixon_str_intern_free(xn->x_name);
+    xn->x_name = iname;
+#else
     if (xn->x_name){
         free(xn->x_name);
         xn->x_name = NULL;
@@ -486,6 +751,7 @@ xml_name_set(cxobj      *xn,
             return -1;
         }
     }
+#endif
     return 0;
 }
 
@@ -511,6 +777,18 @@ int
 xml_prefix_set(cxobj      *xn,
                const char *prefix)
 {
+    xml_digest_reset(xn);
+    if (xml_type(xn) == CX_ATTR)
+        _nsscope_gen++;
+#ifdef XML_NAME_INTERN
+    char *iprefix = NULL;
+
+    if (prefix && (iprefix = clixon_str_intern(prefix)) == NULL)
+        return -1;
+    if (xn->x_prefix)
+        clixon_str_intern_free(xn->x_prefix);
+    xn->x_prefix = iprefix;
+#else
     if (xn->x_prefix){
         free(xn->x_prefix);
         xn->x_prefix = NULL;
@@ -521,6 +799,208 @@ xml_prefix_set(cxobj      *xn,
             return -1;
         }
     }
+#endif
+    return 0;
+}
+
+/*! Get cold part of XML element, allocate if not present
+ *
+ * @param[in] x   XML element
+ * @retval    xc  Cold fields of x
+ * @retval    NULL Error
+ */
+static struct xml_cold *
+xml_cold_get(cxobj *x)
+{
+    if (x->x_cold == NULL){
+        if ((x->x_cold = malloc(sizeof(struct xml_cold))) == NULL){
+            clixon_err(OE_XML, errno, "malloc");
+            return NULL;
+        }
+        memset(x->x_cold, 0, sizeof(struct xml_cold));
+    }
+    return x->x_cold;
+}
+
+/* Compare XML subtrees by digest, see xml_digest_set */
+static int _xml_digest = 0;
+
+/*! Enable comparison of XML subtrees by digest
+ *
+ * Cant use option directly since there is no handle in xml functions.
+ * @param[in]  enable  If set, xml_digest_equal compares digests
+ * @retval     0       OK
+ * @see CLICON_XML_DIGEST
+ */
+int
+xml_digest_set(int enable)
+{
+    _xml_digest = enable;
+    return 0;
+}
+
+/*! Reset digest of XML node and its ancestors when the subtree is modified
+ *
+ * An element only has a valid digest if all its element children have, so stop at
+ * first element without valid digest.
+ * @param[in] x   XML node, or NULL
+ */
+static void
+xml_digest_reset(cxobj *x)
+{
+    while (x != NULL && xml_flag(x, XML_FLAG_DIGEST)){
+        xml_flag_reset(x, XML_FLAG_DIGEST);
+        x = xml_parent(x);
+    }
+}
+
+/*! Append length-prefixed string to digest input, NULL is distinct from empty
+ *
+ * @param[in] cb   Digest input buffer
+ * @param[in] str  String or NULL
+ * @retval    0    OK
+ * @retval   -1    Error
+ */
+static int
+xml_digest_str(cbuf       *cb,
+               const char *str)
+{
+    uint32_t len;
+
+    len = str ? strlen(str) : UINT32_MAX;
+    if (cbuf_append_buf(cb, &len, sizeof(len)) < 0)
+        return -1;
+    if (str && cbuf_append_buf(cb, (void*)str, len) < 0)
+        return -1;
+    return 0;
+}
+
+/*! Get digest of XML subtree, compute it if not valid
+ *
+ * The digest covers name, prefix, body values and the digests of element children in
+ * order, ie a Merkle tree, but not attributes, flags or yang binding.
+ * It is kept in the node and reset up to the top when the subtree is modified. Copies keep
+ * the digest.
+ * @param[in]  x    XML element
+ * @param[out] mdp  Digest of CLIXON_DIGEST_LEN bytes, valid until x is modified
+ * @retval     0    OK
+ * @retval    -1    Error
+ * @see xml_digest_equal
+ */
+int
+xml_digest(cxobj          *x,
+           unsigned char **mdp)
+{
+    int              retval = -1;
+    struct xml_cold *xco;
+    cbuf            *cb = NULL;
+    cxobj           *xc;
+    unsigned char   *md;
+    int              inext;
+
+    if (!is_element(x)){
+        clixon_err(OE_XML, EINVAL, "Not an element");
+        goto done;
+    }
+    if ((xco = xml_cold_get(x)) == NULL)
+        goto done;
+    if (xco->xc_digest == NULL &&
+        (xco->xc_digest = malloc(CLIXON_DIGEST_LEN)) == NULL){
+        clixon_err(OE_UNIX, errno, "malloc");
+        goto done;
+    }
+    if (xml_flag(x, XML_FLAG_DIGEST) == 0){
+        if ((cb = cbuf_new()) == NULL){
+            clixon_err(OE_XML, errno, "cbuf_new");
+            goto done;
+        }
+        if (xml_digest_str(cb, xml_name(x)) < 0 ||
+            xml_digest_str(cb, xml_prefix(x)) < 0)
+            goto done;
+        inext = 0;
+        while ((xc = xml_child_iter(x, &inext, -1)) != NULL) {
+            switch (xml_type(xc)){
+            case CX_ELMNT:
+                if (xml_digest(xc, &md) < 0)
+                    goto done;
+                cbuf_append(cb, 'e');
+                if (cbuf_append_buf(cb, md, CLIXON_DIGEST_LEN) < 0)
+                    goto done;
+                break;
+            case CX_BODY:
+                cbuf_append(cb, 'b');
+                if (xml_digest_str(cb, xml_value(xc)) < 0)
+                    goto done;
+                break;
+            default:
+                break;
+            }
+        }
+        if (clixon_digest_buf(cbuf_get(cb), cbuf_len(cb), xco->xc_digest) < 0)
+            goto done;
+        xml_flag_set(x, XML_FLAG_DIGEST);
+    }
+    *mdp = xco->xc_digest;
+    retval = 0;
+ done:
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+}
+
+/*! Compare two XML subtrees by digest, compute digests if not valid
+ *
+ * xml_diff(), xml_tree_equal(), compare and xml_rebase() skip subtrees with equal digests,
+ * so diffing a candidate copied from running after a small edit only walks the edited paths.
+ * @param[in]  x0   First XML element
+ * @param[in]  x1   Second XML element
+ * @retval     1    Equal digests, the subtrees are equal
+ * @retval     0    Not equal, or digests not enabled
+ * @retval    -1    Error
+ * @see xml_digest_set
+ */
+int
+xml_digest_equal(cxobj *x0,
+                 cxobj *x1)
+{
+    unsigned char *md0;
+    unsigned char *md1;
+
+    if (x0 == x1)
+        return 1;
+    if (!_xml_digest)
+        return 0;
+    if (xml_digest(x0, &md0) < 0 ||
+        xml_digest(x1, &md1) < 0)
+        return -1;
+    return memcmp(md0, md1, CLIXON_DIGEST_LEN) == 0;
+}
+
+/*! Copy valid digest of XML element to an exact copy
+ *
+ * @param[in]  x0   Source XML element with valid digest
+ * @param[in]  x1   Copy of x0
+ * @retval     0    OK
+ * @retval    -1    Error
+ * @see xml_copy
+ */
+static int
+xml_digest_copy(cxobj *x0,
+                cxobj *x1)
+{
+    struct xml_cold *xco;
+
+    if (!is_element(x1))
+        return 0;
+    if ((xco = xml_cold_get(x1)) == NULL)
+        return -1;
+    if (xco->xc_digest == NULL &&
+        (xco->xc_digest = malloc(CLIXON_DIGEST_LEN)) == NULL){
+        clixon_err(OE_UNIX, errno, "malloc");
+        return -1;
+    }
+    memcpy(xco->xc_digest, x0->x_cold->xc_digest, CLIXON_DIGEST_LEN);
+    xml_flag_set(x1, XML_FLAG_DIGEST);
     return 0;
 }
 
@@ -538,8 +1018,8 @@ nscache_get(cxobj      *x,
 {
     if (!is_element(x))
         return NULL;
-    if (x->x_ns_cache != NULL)
-        return xml_nsctx_get(x->x_ns_cache, prefix);
+    if (XML_COLD(x, xc_ns_cache) != NULL)
+        return xml_nsctx_get(x->x_cold->xc_ns_cache, prefix);
     return NULL;
 }
 
@@ -558,8 +1038,8 @@ nscache_get_prefix(cxobj      *x,
 {
     if (!is_element(x))
         return 0;
-    if (x->x_ns_cache != NULL)
-        return xml_nsctx_get_prefix(x->x_ns_cache, namespace, prefix);
+    if (XML_COLD(x, xc_ns_cache) != NULL)
+        return xml_nsctx_get_prefix(x->x_cold->xc_ns_cache, namespace, prefix);
     return 0;
 }
 
@@ -575,7 +1055,7 @@ nscache_get_all(cxobj *x)
 {
     if (!is_element(x))
         return NULL;
-    return x->x_ns_cache;
+    return XML_COLD(x, xc_ns_cache);
 }
 
 /*! Set cached namespace for specific namespace. Replace if necessary
@@ -592,16 +1072,20 @@ nscache_set(cxobj      *x,
             const char *prefix,
             const char *namespace)
 {
-    int     retval = -1;
+    int               retval = -1;
+    struct xml_cold *xc;
 
     if (!is_element(x))
         return 0;
-    if (x->x_ns_cache == NULL){
-        if ((x->x_ns_cache = xml_nsctx_init(prefix, namespace)) == NULL)
+    if ((xc = xml_cold_get(x)) == NULL)
+        goto done;
+    _nsscope_gen++;
+    if (xc->xc_ns_cache == NULL){
+        if ((xc->xc_ns_cache = xml_nsctx_init(prefix, namespace)) == NULL)
             goto done;
     }
     else
-        return xml_nsctx_add(x->x_ns_cache, prefix, namespace);
+        return xml_nsctx_add(xc->xc_ns_cache, prefix, namespace);
     retval = 0;
  done:
     return retval;
@@ -619,17 +1103,23 @@ int
 nscache_replace(cxobj *x,
                 cvec  *nsc)
 {
-    int     retval = -1;
+    int               retval = -1;
+    struct xml_cold *xc;
 
     if (!is_element(x))
         return 0;
-    if (x->x_ns_cache != NULL){
-        xml_nsctx_free(x->x_ns_cache);
-        x->x_ns_cache = NULL;
+    if (nsc == NULL && x->x_cold == NULL)
+        return 0;
+    if ((xc = xml_cold_get(x)) == NULL)
+        goto done;
+    _nsscope_gen++;
+    if (xc->xc_ns_cache != NULL){
+        xml_nsctx_free(xc->xc_ns_cache);
+        xc->xc_ns_cache = NULL;
     }
-    x->x_ns_cache = nsc;
+    xc->xc_ns_cache = nsc;
     retval = 0;
-    // done:
+ done:
     return retval;
 }
 
@@ -647,13 +1137,64 @@ nscache_clear(cxobj *x)
 
     if (!is_element(x))
         return 0;
-    if (x->x_ns_cache != NULL){
-        xml_nsctx_free(x->x_ns_cache);
-        x->x_ns_cache = NULL;
+    if (XML_COLD(x, xc_ns_cache) != NULL){
+        xml_nsctx_free(x->x_cold->xc_ns_cache);
+        x->x_cold->xc_ns_cache = NULL;
+        _nsscope_gen++;
     }
     return 0;
 }
 
+/*! Get namespace generation
+ *
+ * A shared namespace context computed in another generation is not valid
+ * @retval    gen   Namespace generation
+ * @see xml_nsctx_scope
+ */
+uint64_t
+xml_nsscope_gen(void)
+{
+    return _nsscope_gen;
+}
+
+/*! Get shared namespace context of XML element, valid or not
+ *
+ * @param[in] x    XML node
+ * @retval    nss  Shared namespace context
+ * @retval    NULL Not set, or not element
+ * @see xml_nsscope_gen  to check if it is valid
+ */
+struct xml_nsscope *
+nsscope_get(cxobj *x)
+{
+    if (!is_element(x))
+        return NULL;
+    return XML_COLD(x, xc_nsscope);
+}
+
+/*! Set shared namespace context of XML element, release the previous
+ *
+ * @param[in] x    XML element
+ * @param[in] nss  Shared namespace context, reference taken by caller, or NULL
+ * @retval    0    OK
+ * @retval   -1    Error
+ */
+int
+nsscope_set(cxobj              *x,
+            struct xml_nsscope *nss)
+{
+    struct xml_cold *xc;
+
+    if (!is_element(x))
+        return 0;
+    if ((xc = xml_cold_get(x)) == NULL)
+        return -1;
+    if (xc->xc_nsscope)
+        xml_nsscope_free(xc->xc_nsscope);
+    xc->xc_nsscope = nss;
+    return 0;
+}
+
 /*! Get parent of xnode
  *
  * @param[in]  xn    xml node
@@ -668,8 +1209,115 @@ xml_parent(cxobj *xn)
     return xn->x_up;
 }
 
+/*! Get root of the tree of an xml node, the root holds the epoch of the tree
+ *
+ * Constant time if the root was cached by xml_epoch_root_cache() and no node has changed
+ * parent since, otherwise the tree is walked up. Does not change the tree.
+ * @param[in]  x   XML node
+ * @retval     xr  Root of tree
+ */
+static cxobj *
+xml_epoch_root(cxobj *x)
+{
+    cxobj *xe;
+
+    if (x->x_up == NULL)
+        return x;
+    xe = is_element(x) ? x : x->x_up;
+    if (xe->x_eroot_gen == _tree_gen)
+        return xe->x_eroot;
+    while (x->x_up != NULL)
+        x = x->x_up;
+    return x;
+}
+
+/*! Get root of the tree of an xml node and cache it in the node, or its parent if not element
+ *
+ * @param[in]  x   XML node
+ * @retval     xr  Root of tree
+ * @see xml_epoch_root
+ */
+static cxobj *
+xml_epoch_root_cache(cxobj *x)
+{
+    cxobj *xe;
+    cxobj *xr;
+
+    if (x->x_up == NULL)
+        return x;
+    xe = is_element(x) ? x : x->x_up;
+    if (xe->x_eroot_gen != _tree_gen){
+        for (xr = xe; xr->x_up != NULL; xr = xr->x_up)
+            ;
+        xe->x_eroot = xr;
+        xe->x_eroot_gen = _tree_gen;
+    }
+    return xe->x_eroot;
+}
+
+/*! Restamp flagged node of a subtree moved to a tree with another epoch
+ *
+ * @param[in]  x    XML node
+ * @param[in]  arg  Vector of old and new epoch
+ * @retval     0    OK
+ */
+static int
+xml_epoch_restamp(cxobj *x,
+                  void  *arg)
+{
+    uint16_t *ev = (uint16_t *)arg;
+
+    if (x->x_flags & XML_FLAG_EPOCH){
+        if (x->x_epoch == ev[0])
+            x->x_epoch = ev[1];
+        else /* Stale */
+            x->x_flags &= ~XML_FLAG_EPOCH;
+    }
+    return 0;
+}
+
+/*! Keep XML_FLAG_EPOCH flags of a subtree when it is moved to a new parent
+ *
+ * A flag in XML_FLAG_EPOCH is valid if the epoch of the node equals the epoch of the root of
+ * its tree. When xn is removed from its parent it becomes a root with the epoch of its old tree.
+ * When it is added to a tree with another epoch, the flagged nodes of the subtree are
+ * restamped, unless one of the trees never had such flags.
+ * @param[in]  xn      XML node, before x_up is set
+ * @param[in]  parent  New parent, or NULL
+ * @see xml_flag_reset_tree
+ */
+static void
+xml_epoch_move(cxobj *xn,
+               cxobj *parent)
+{
+    cxobj   *xr;
+    uint16_t ev[2]; /* old and new epoch */
+
+    if (xn->x_up == NULL)
+        ev[0] = xn->x_epoch;
+    else {
+        ev[0] = xml_epoch_root(xn)->x_epoch;
+        if (xn->x_epoch != ev[0]){ /* Own flags are stale */
+            xn->x_flags &= ~XML_FLAG_EPOCH;
+            xn->x_epoch = ev[0];
+        }
+    }
+    if (parent == NULL || ev[0] == 0) /* Epoch 0: no flags in subtree */
+        return;
+    xr = xml_epoch_root(parent);
+    if ((ev[1] = xr->x_epoch) == ev[0])
+        return;
+    if (ev[1] == 0)                    /* No flags in new tree: adopt epoch */
+        xr->x_epoch = ev[0];
+    else
+        xml_apply0(xn, CX_ERROR, xml_epoch_restamp, ev);
+}
+
 /*! Set parent of xml node.
  *
+ * The cached root of xn is invalidated. Cached roots of other nodes are only invalidated if xn
+ * has children, since a node without children is not the cached root of any other node.
+ * Adding new leaf nodes, as when building or modifying a tree top-down, keeps cached roots.
  * @param[in]  xn      xml node
  * @param[in]  parent  pointer to new parent xml node
  * @retval     0       OK
@@ -679,7 +1327,16 @@ int
 xml_parent_set(cxobj *xn,
                cxobj *parent)
 {
+    if (xml_type(xn) != CX_BODY)
+        _nsscope_gen++;
+    if (xn->x_up != NULL || xn->x_epoch != 0)
+        xml_epoch_move(xn, parent);
     xn->x_up = parent;
+    if (is_element(xn)){
+        xn->x_eroot_gen = 0;
+        if (xml_child_nr(xn) > 0)
+            _tree_gen++;
+    }
     return 0;
 }
 
@@ -715,6 +1372,7 @@ xml_parent_candidate_set(cxobj *xn,
 
 /*! Get xml node flags, used for internal algorithms
  *
+ * Flags in XML_FLAG_EPOCH of another epoch than the tree are stale and not returned
  * @param[in]  xn    xml node
  * @retval     flag  Flag value(s), see XML_FLAG_MARK et al
  */
@@ -722,7 +1380,12 @@ uint16_t
 xml_flag(cxobj   *xn,
          uint16_t flag)
 {
-    return xn->x_flags&flag;
+    uint16_t f = xn->x_flags & flag;
+
+    if ((f & XML_FLAG_EPOCH) && xn->x_up != NULL &&
+        xn->x_epoch != xml_epoch_root(xn)->x_epoch)
+        f &= ~XML_FLAG_EPOCH; /* Stale, reset by xml_flag_reset_tree */
+    return f;
 }
 
 /*! Set xml node flags, used for internal algorithms
@@ -734,6 +1397,17 @@ int
 xml_flag_set(cxobj   *xn,
              uint16_t flag)
 {
+    cxobj *xr;
+
+    if (flag & XML_FLAG_EPOCH){
+        xr = xml_epoch_root_cache(xn);
+        if (xr->x_epoch == 0)
+            xr->x_epoch = 1;
+        if (xn->x_epoch != xr->x_epoch){
+            xn->x_flags &= ~XML_FLAG_EPOCH; /* Stale */
+            xn->x_epoch = xr->x_epoch;
+        }
+    }
     xn->x_flags |= flag;
     return 0;
 }
@@ -751,6 +1425,38 @@ xml_flag_reset(cxobj   *xn,
     return 0;
 }
 
+/*! Reset xml node flags in a tree, including the top node
+ *
+ * Same as xml_apply0(xt, CX_ELMNT, xml_flag_reset, flag), but if xt is a root, XML_FLAG_MARK
+ * and XML_FLAG_CHANGE are reset in constant time by incrementing the epoch of the tree, which
+ * makes those flags of all other nodes stale.
+ * @param[in]  xt      XML tree
+ * @param[in]  flag    Flag value(s) to reset, see XML_FLAG_*
+ * @retval     0       OK
+ * @retval    -1       Error
+ */
+int
+xml_flag_reset_tree(cxobj   *xt,
+                    uint16_t flag)
+{
+    if (xt->x_up == NULL && (flag & XML_FLAG_EPOCH) == XML_FLAG_EPOCH){
+        if (xt->x_epoch == UINT16_MAX){ /* Wrap: stale stamps may become valid */
+            if (xml_apply0(xt, CX_ERROR, (xml_applyfn_t*)xml_flag_reset,
+                           (void*)XML_FLAG_EPOCH) < 0)
+                return -1;
+            xt->x_epoch = 1;
+        }
+        else if (xt->x_epoch != 0) /* Epoch 0: no such flags in tree */
+            xt->x_epoch++;
+        xt->x_flags &= ~XML_FLAG_EPOCH;
+        if ((flag &= ~XML_FLAG_EPOCH) == 0)
+            return 0;
+    }
+    if (xml_apply0(xt, CX_ELMNT, (xml_applyfn_t*)xml_flag_reset, (void*)(uintptr_t)flag) < 0)
+        return -1;
+    return 0;
+}
+
 /*! Get value of xnode
  *
  * @param[in]  xn    xml node
@@ -761,7 +1467,270 @@ xml_value(cxobj *xn)
 {
     if (!is_bodyattr(xn))
         return NULL;
-    return xn->x_value_cb?cbuf_get(xn->x_value_cb):NULL;
+    return xml_bodyattr(xn)->xb_value;
+}
+
+/*! Ensure value storage of body/attribute node is large enough for a value of length len
+ *
+ * Existing value is kept. Inline storage is used as long as the value fits
+ * @param[in]  xb   XML body or attribute node
+ * @param[in]  len  Required value length (excluding terminating null)
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+xml_value_alloc(struct xmlbody *xb,
+                size_t          len)
+{
+    char  *v;
+    size_t max;
+
+    if (xb->xb_value_max == 0 && len < XML_VALUE_INLINE_LEN){
+        if (xb->xb_value == NULL){
+            xb->xb_value = xb->xb_value_inline;
+            xb->xb_value_inline[0] = '\0';
+            xb->xb_value_len = 0;
+        }
+        return 0;
+    }
+    if (len < xb->xb_value_max)
+        return 0;
+    /* Exact size on first allocation, then double for appends */
+    max = xb->xb_value_max ? 2*(len + 1) : len + 1;
+    if (max > UINT32_MAX){
+        clixon_err(OE_XML, EINVAL, "value too long");
+        return -1;
+    }
+    if ((v = malloc(max)) == NULL){
+        clixon_err(OE_XML, errno, "malloc");
+        return -1;
+    }
+    if (xb->xb_value)
+        memcpy(v, xb->xb_value, xb->xb_value_len + 1);
+    else{
+        v[0] = '\0';
+        xb->xb_value_len = 0;
+    }
+    if (xb->xb_value_max)
+        free(xb->xb_value);
+    xb->xb_value = v;
+    xb->xb_value_max = max;
+    return 0;
+}
+
+/*! Clear typed value cache of parent element when its body changes
+ *
+ * @param[in]  xn    xml body node
+ * @see xml_cv_set
+ */
+static void
+xml_value_cv_clear(cxobj *xn)
+{
+    cxobj *xp;
+
+    if (xml_type(xn) == CX_BODY &&
+        (xp = xml_parent(xn)) != NULL &&
+        xp->x_cv != NULL){
+        cv_free(xp->x_cv);
+        xp->x_cv = NULL;
+    }
+}
+
+/*! Body of list key is about to change, update hash index of list parent
+ *
+ * @param[in]  xn    xml body node
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+static int
+xml_value_hindex(cxobj *xn)
+{
+    cxobj *xk;
+    cxobj *xe;
+
+    if (xml_type(xn) == CX_BODY &&
+        (xk = xml_parent(xn)) != NULL &&
+        (xe = xml_parent(xk)) != NULL &&
+        xml_flag(xe, XML_FLAG_HINDEX))
+        return xml_hindex_key_change(xe, xk);
+    return 0;
+}
+
+/* Min length of body/attribute values that are shared between copies, 0 if not shared */
+static size_t _xml_value_shared = 0;
+
+/*! Share large body and attribute values between copies of XML trees
+ *
+ * Cant use option directly since there is no handle in xml functions.
+ * Values already shared stay shared if disabled.
+ * @param[in]  len  Min length of shared values, 0 disables
+ * @retval     0    OK
+ * @see CLICON_XML_VALUE_SHARED
+ */
+int
+xml_value_shared_set(size_t len)
+{
+    _xml_value_shared = len;
+    return 0;
+}
+
+/*! Release reference to shared value, free it if last
+ *
+ * @param[in]  xs   Shared value
+ */
+static void
+xml_value_shared_free(struct xml_value_shared *xs)
+{
+    if (--xs->xs_refcnt == 0){
+        if (xs->xs_enc)
+            free(xs->xs_enc);
+        free(xs);
+    }
+}
+
+/*! Stop sharing value of body/attribute node before it is modified
+ *
+ * The shared value is returned and should be released with xml_value_shared_free
+ * after the modification, since the new value may point into it.
+ * @param[in]  xb    XML body or attribute node
+ * @param[in]  keep  0: Value is cleared, 1: Value is copied to a private buffer
+ * @param[out] xsp   Shared value to release, or NULL if not shared
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+static int
+xml_value_unshare(struct xmlbody           *xb,
+                  int                       keep,
+                  struct xml_value_shared **xsp)
+{
+    char *v = NULL;
+
+    *xsp = NULL;
+    if (xb->xb_value_max != XML_VALUE_SHARED_MARK)
+        return 0;
+    if (keep){
+        if ((v = malloc(xb->xb_value_len + 1)) == NULL){
+            clixon_err(OE_XML, errno, "malloc");
+            return -1;
+        }
+        memcpy(v, xb->xb_value, xb->xb_value_len + 1);
+    }
+    *xsp = XML_VALUE_SHARED_GET(xb);
+    xb->xb_value = v;
+    xb->xb_value_max = v ? xb->xb_value_len + 1 : 0;
+    if (v == NULL)
+        xb->xb_value_len = 0;
+    return 0;
+}
+
+/*! Get shared value of body/attribute node, make the existing value shared if needed
+ *
+ * The private buffer is reallocated in place, the value is not copied to a new buffer
+ * @param[in]  xb   XML body or attribute node with allocated value
+ * @retval     xs   Shared value
+ * @retval     NULL Error
+ */
+static struct xml_value_shared *
+xml_value_shared_make(struct xmlbody *xb)
+{
+    struct xml_value_shared *xs;
+    size_t                   hdr = offsetof(struct xml_value_shared, xs_data);
+    uint32_t                 len = xb->xb_value_len;
+
+    if (xb->xb_value_max == XML_VALUE_SHARED_MARK)
+        return XML_VALUE_SHARED_GET(xb);
+    if ((xs = realloc(xb->xb_value, hdr + len + 1)) == NULL){
+        clixon_err(OE_XML, errno, "realloc");
+        return NULL;
+    }
+    /* Move value after header before the header is written */
+    memmove(xs->xs_data, (char*)xs, len + 1);
+    xs->xs_refcnt = 1;
+    xs->xs_len = len;
+    xs->xs_enc = NULL;
+    xb->xb_value = xs->xs_data;
+    xb->xb_value_max = XML_VALUE_SHARED_MARK;
+    return xs;
+}
+
+/*! Get allocated size of value of body/attribute node
+ *
+ * @param[in]  xb   XML body or attribute node
+ * @retval     size Allocated size, share of size if shared, 0 if inline
+ */
+static size_t
+xml_value_size(struct xmlbody *xb)
+{
+    if (xb->xb_value_max == XML_VALUE_SHARED_MARK)
+        return (offsetof(struct xml_value_shared, xs_data) + xb->xb_value_len + 1)/
+            XML_VALUE_SHARED_GET(xb)->xs_refcnt;
+    return xb->xb_value_max;
+}
+
+/*! Set value of xml node, copy value or reference shared value
+ *
+ * @param[in]  xn     xml node
+ * @param[in]  val    new value, null-terminated string, copied by function
+ * @param[in]  xshare If set, reference this shared value instead of copying val
+ * @retval     0      OK
+ * @retval    -1      On error with clicon-err set
+ */
+static int
+xml_value_set1(cxobj      *xn,
+               const char *val,
+               void       *xshare)
+{
+    int                      retval = -1;
+    struct xmlbody          *xb;
+    size_t                   len;
+    struct xml_value_shared *xs0 = NULL;
+    struct xml_value_shared *xs = xshare;
+
+    if (!is_bodyattr(xn))
+        return 0;
+    if (val == NULL){
+        clixon_err(OE_XML, EINVAL, "value is NULL");
+        goto done;
+    }
+    xb = xml_bodyattr(xn);
+    if (xml_type(xn) == CX_ATTR)
+        _nsscope_gen++;
+    len = xs ? xs->xs_len : strlen(val);
+    if (xml_type(xn) == CX_BODY)
+        xml_digest_reset(xml_parent(xn));
+    if (xml_value_hindex(xn) < 0)
+        goto done;
+#ifdef XML_EXPLICIT_INDEX
+    if (xml_type(xn) == CX_BODY && xml_search_index_leaf(xml_parent(xn), 0) < 0)
+        goto done;
+#endif
+    if (xml_value_unshare(xb, 0, &xs0) < 0)
+        goto done;
+    if (xs){
+        if (xb->xb_value_max)
+            free(xb->xb_value);
+        xs->xs_refcnt++;
+        xb->xb_value = xs->xs_data;
+        xb->xb_value_len = len;
+        xb->xb_value_max = XML_VALUE_SHARED_MARK;
+    }
+    else
+    {
+        if (xml_value_alloc(xb, len) < 0)
+            goto done;
+        memmove(xb->xb_value, val, len + 1); /* val may be the existing value */
+        xb->xb_value_len = len;
+    }
+    xml_value_cv_clear(xn);
+#ifdef XML_EXPLICIT_INDEX
+    if (xml_type(xn) == CX_BODY && xml_search_index_leaf(xml_parent(xn), 1) < 0)
+        goto done;
+#endif
+    retval = 0;
+ done:
+    if (xs0)
+        xml_value_shared_free(xs0);
+    return retval;
 }
 
 /*! Set value of xml node, value is copied
@@ -775,28 +1744,38 @@ int
 xml_value_set(cxobj      *xn,
               const char *val)
 {
-    int    retval = -1;
-    size_t sz;
+    return xml_value_set1(xn, val, NULL);
+}
+
+/*! Get XML-encoded value of body node if it is a large shared value
+ *
+ * The encoded value is computed once and kept with the shared value, so that large
+ * values are not encoded again on every print
+ * @param[in]  xn    xml body node
+ * @param[out] encp  Encoded value, do not free, or NULL if value is not shared
+ * @retval     0     OK
+ * @retval    -1     Error
+ * @see xml_chardata_encode
+ */
+int
+xml_value_enc(cxobj *xn,
+              char **encp)
+{
+    struct xmlbody          *xb;
+    struct xml_value_shared *xs;
 
+    *encp = NULL;
     if (!is_bodyattr(xn))
         return 0;
-    if (val == NULL){
-        clixon_err(OE_XML, EINVAL, "value is NULL");
-        goto done;
-    }
-    sz = strlen(val)+1;
-    if (xn->x_value_cb == NULL){
-        if ((xn->x_value_cb = cbuf_new_alloc(sz + 1)) == NULL){
-            clixon_err(OE_XML, errno, "cbuf_new");
-            goto done;
-        }
-    }
-    else
-        cbuf_reset(xn->x_value_cb);
-    cbuf_append_str(xn->x_value_cb, val);
-    retval = 0;
- done:
-    return retval;
+    xb = xml_bodyattr(xn);
+    if (xb->xb_value_max != XML_VALUE_SHARED_MARK)
+        return 0;
+    xs = XML_VALUE_SHARED_GET(xb);
+    if (xs->xs_enc == NULL &&
+        xml_chardata_encode(&xs->xs_enc, 0, "%s", xs->xs_data) < 0)
+        return -1;
+    *encp = xs->xs_enc;
+    return 0;
 }
 
 /*! Append value of xnode, value is copied
@@ -810,8 +1789,11 @@ int
 xml_value_append(cxobj      *xn,
                  const char *val)
 {
-    int    retval = -1;
-    size_t sz;
+    int             retval = -1;
+    struct xmlbody *xb;
+    size_t          len;
+    ptrdiff_t       off = -1;
+    struct xml_value_shared *xs0 = NULL;
 
     if (!is_bodyattr(xn))
         return 0;
@@ -819,19 +1801,38 @@ xml_value_append(cxobj      *xn,
         clixon_err(OE_XML, EINVAL, "value is NULL");
         goto done;
     }
-    sz = strlen(val)+1;
-    if (xn->x_value_cb == NULL){
-        if ((xn->x_value_cb = cbuf_new_alloc(sz)) == NULL){
-            clixon_err(OE_XML, errno, "cbuf_new");
-            goto done;
-        }
-    }
-    if (cbuf_append_str(xn->x_value_cb, val) < 0){
-        clixon_err(OE_XML, errno, "cprintf");
+    xb = xml_bodyattr(xn);
+    if (xml_type(xn) == CX_ATTR)
+        _nsscope_gen++;
+    len = strlen(val);
+    if (xml_type(xn) == CX_BODY)
+        xml_digest_reset(xml_parent(xn));
+    if (xml_value_hindex(xn) < 0)
         goto done;
-    }
+#ifdef XML_EXPLICIT_INDEX
+    if (xml_type(xn) == CX_BODY && xml_search_index_leaf(xml_parent(xn), 0) < 0)
+        goto done;
+#endif
+    if (xml_value_unshare(xb, 1, &xs0) < 0)
+        goto done;
+    /* val may point into the existing value which may be reallocated */
+    if (xb->xb_value && val >= xb->xb_value && val <= xb->xb_value + xb->xb_value_len)
+        off = val - xb->xb_value;
+    if (xml_value_alloc(xb, xb->xb_value_len + len) < 0)
+        goto done;
+    if (off >= 0)
+        val = xb->xb_value + off;
+    memmove(xb->xb_value + xb->xb_value_len, val, len + 1);
+    xb->xb_value_len += len;
+    xml_value_cv_clear(xn);
+#ifdef XML_EXPLICIT_INDEX
+    if (xml_type(xn) == CX_BODY && xml_search_index_leaf(xml_parent(xn), 1) < 0)
+        goto done;
+#endif
     retval = 0;
  done:
+    if (xs0)
+        xml_value_shared_free(xs0);
     return retval;
 }
 
@@ -865,6 +1866,286 @@ xml_type_set(cxobj          *xn,
     return old;
 }
 
+/*! Find chunk of child position i
+ *
+ * @param[in]  xk  Chunk vector
+ * @param[in]  i   Child position, less than number of children
+ * @retval     k   Chunk number
+ */
+static int
+xml_chunk_find(struct xml_chunkvec *xk,
+               size_t               i)
+{
+    int k;
+    int lo;
+    int hi;
+
+    k = xk->xk_last;
+    if (i >= xk->xk_start[k] && i < xk->xk_start[k] + xk->xk_len[k])
+        return k;
+    k++; /* Sequential access, eg xml_child_each */
+    if (k < xk->xk_nr && i >= xk->xk_start[k] && i < xk->xk_start[k] + xk->xk_len[k]){
+        xk->xk_last = k;
+        return k;
+    }
+    lo = 0;
+    hi = xk->xk_nr-1;
+    while (lo < hi){
+        k = (lo + hi + 1)/2;
+        if (xk->xk_start[k] <= i)
+            lo = k;
+        else
+            hi = k-1;
+    }
+    xk->xk_last = lo;
+    return lo;
+}
+
+/*! Get pointer to child slot at position i of chunked child vector
+ */
+static cxobj **
+xml_chunk_slot(cxobj *x,
+               size_t i)
+{
+    struct xml_chunkvec *xk = x->x_chunks;
+    int                  k;
+
+    k = xml_chunk_find(xk, i);
+    return &xk->xk_vec[k][i - xk->xk_start[k]];
+}
+
+/*! Free chunked child vector, not the children
+ */
+static void
+xml_chunk_free(struct xml_chunkvec *xk)
+{
+    int k;
+
+    for (k=0; k<xk->xk_nr; k++)
+        free(xk->xk_vec[k]);
+    free(xk->xk_vec);
+    free(xk->xk_len);
+    free(xk->xk_start);
+    free(xk);
+}
+
+/*! Ensure chunk vectors have room for nr chunks
+ */
+static int
+xml_chunk_grow(struct xml_chunkvec *xk,
+               int                  nr)
+{
+    int retval = -1;
+
+    if (nr <= xk->xk_max)
+        goto ok;
+    while (xk->xk_max < nr)
+        xk->xk_max = xk->xk_max?2*xk->xk_max:8;
+    if ((xk->xk_vec = realloc(xk->xk_vec, xk->xk_max*sizeof(cxobj**))) == NULL ||
+        (xk->xk_len = realloc(xk->xk_len, xk->xk_max*sizeof(int))) == NULL ||
+        (xk->xk_start = realloc(xk->xk_start, xk->xk_max*sizeof(size_t))) == NULL){
+        clixon_err(OE_XML, errno, "realloc");
+        goto done;
+    }
+ ok:
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Split flat child vector of x into half-full chunks
+ *
+ * @param[in]  x   XML node
+ * @retval     0   OK
+ * @retval    -1   Error
+ */
+static int
+xml_chunk_make(cxobj *x)
+{
+    int                  retval = -1;
+    struct xml_chunkvec *xk = NULL;
+    size_t               per = XML_CHILDVEC_CHUNK_SIZE/2;
+    size_t               i;
+    int                  k;
+    int                  nr;
+
+    if ((xk = calloc(1, sizeof(*xk))) == NULL){
+        clixon_err(OE_XML, errno, "calloc");
+        goto done;
+    }
+    nr = (x->x_childvec_len + per - 1)/per;
+    if (nr == 0)
+        nr = 1;
+    if (xml_chunk_grow(xk, nr) < 0)
+        goto done;
+    for (k=0, i=0; k<nr; k++){
+        if ((xk->xk_vec[k] = malloc(XML_CHILDVEC_CHUNK_SIZE*sizeof(cxobj*))) == NULL){
+            clixon_err(OE_XML, errno, "malloc");
+            goto done;
+        }
+        xk->xk_nr++;
+        xk->xk_start[k] = i;
+        xk->xk_len[k] = (x->x_childvec_len - i < per) ? x->x_childvec_len - i : per;
+        memcpy(xk->xk_vec[k], &x->x_childvec[i], xk->xk_len[k]*sizeof(cxobj*));
+        i += xk->xk_len[k];
+    }
+    if (x->x_childvec)
+        free(x->x_childvec);
+    x->x_childvec = NULL;
+    x->x_childvec_max = 0;
+    x->x_chunks = xk;
+    xk = NULL;
+    retval = 0;
+ done:
+    if (xk)
+        xml_chunk_free(xk);
+    return retval;
+}
+
+/*! Merge chunked child vector of x into a flat vector
+ *
+ * @param[in]  x   XML node
+ * @retval     0   OK
+ * @retval    -1   Error
+ */
+static int
+xml_chunk_flat(cxobj *x)
+{
+    struct xml_chunkvec *xk = x->x_chunks;
+    cxobj              **vec;
+    size_t               max;
+    int                  k;
+
+    max = x->x_childvec_len?x->x_childvec_len:1;
+    if ((vec = malloc(max*sizeof(cxobj*))) == NULL){
+        clixon_err(OE_XML, errno, "malloc");
+        return -1;
+    }
+    for (k=0; k<xk->xk_nr; k++)
+        memcpy(&vec[xk->xk_start[k]], xk->xk_vec[k], xk->xk_len[k]*sizeof(cxobj*));
+    xml_chunk_free(xk);
+    x->x_chunks = NULL;
+    x->x_childvec = vec;
+    x->x_childvec_max = max;
+    return 0;
+}
+
+/*! Insert child in chunked child vector at position pos, split chunk if full
+ *
+ * @param[in]  x   XML parent node
+ * @param[in]  xc  XML child
+ * @param[in]  pos Position, at most number of children
+ * @retval     0   OK
+ * @retval    -1   Error
+ */
+static int
+xml_chunk_insert(cxobj *x,
+                 cxobj *xc,
+                 size_t pos)
+{
+    int                  retval = -1;
+    struct xml_chunkvec *xk = x->x_chunks;
+    cxobj              **vec;
+    int                  half = XML_CHILDVEC_CHUNK_SIZE/2;
+    int                  k;
+    int                  j;
+    size_t               off;
+
+    if (pos >= x->x_childvec_len)
+        k = xk->xk_nr-1;
+    else
+        k = xml_chunk_find(xk, pos);
+    off = pos - xk->xk_start[k];
+    if (xk->xk_len[k] == XML_CHILDVEC_CHUNK_SIZE){ /* Split chunk k in two */
+        if (xml_chunk_grow(xk, xk->xk_nr+1) < 0)
+            goto done;
+        if ((vec = malloc(XML_CHILDVEC_CHUNK_SIZE*sizeof(cxobj*))) == NULL){
+            clixon_err(OE_XML, errno, "malloc");
+            goto done;
+        }
+        memmove(&xk->xk_vec[k+2], &xk->xk_vec[k+1], (xk->xk_nr-k-1)*sizeof(cxobj**));
+        memmove(&xk->xk_len[k+2], &xk->xk_len[k+1], (xk->xk_nr-k-1)*sizeof(int));
+        memmove(&xk->xk_start[k+2], &xk->xk_start[k+1], (xk->xk_nr-k-1)*sizeof(size_t));
+        xk->xk_nr++;
+        xk->xk_vec[k+1] = vec;
+        memcpy(vec, &xk->xk_vec[k][half], (XML_CHILDVEC_CHUNK_SIZE-half)*sizeof(cxobj*));
+        xk->xk_len[k+1] = XML_CHILDVEC_CHUNK_SIZE - half;
+        xk->xk_len[k] = half;
+        xk->xk_start[k+1] = xk->xk_start[k] + half;
+        if (off > half){
+            k++;
+            off -= half;
+        }
+    }
+    vec = xk->xk_vec[k];
+    memmove(&vec[off+1], &vec[off], (xk->xk_len[k]-off)*sizeof(cxobj*));
+    vec[off] = xc;
+    xk->xk_len[k]++;
+    for (j=k+1; j<xk->xk_nr; j++)
+        xk->xk_start[j]++;
+    xk->xk_last = k;
+    x->x_childvec_len++;
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Remove child at position i from chunked child vector
+ *
+ * Empty chunks are removed, and the vector is made flat if it becomes small
+ * @param[in]  x   XML parent node
+ * @param[in]  i   Position
+ * @retval     0   OK
+ * @retval    -1   Error
+ */
+static int
+xml_chunk_rm(cxobj *x,
+             size_t i)
+{
+    struct xml_chunkvec *xk = x->x_chunks;
+    cxobj              **vec;
+    int                  k;
+    int                  j;
+    size_t               off;
+
+    k = xml_chunk_find(xk, i);
+    off = i - xk->xk_start[k];
+    vec = xk->xk_vec[k];
+    memmove(&vec[off], &vec[off+1], (xk->xk_len[k]-off-1)*sizeof(cxobj*));
+    xk->xk_len[k]--;
+    for (j=k+1; j<xk->xk_nr; j++)
+        xk->xk_start[j]--;
+    x->x_childvec_len--;
+    if (xk->xk_len[k] == 0 && xk->xk_nr > 1){
+        free(vec);
+        memmove(&xk->xk_vec[k], &xk->xk_vec[k+1], (xk->xk_nr-k-1)*sizeof(cxobj**));
+        memmove(&xk->xk_len[k], &xk->xk_len[k+1], (xk->xk_nr-k-1)*sizeof(int));
+        memmove(&xk->xk_start[k], &xk->xk_start[k+1], (xk->xk_nr-k-1)*sizeof(size_t));
+        xk->xk_nr--;
+        xk->xk_last = 0;
+    }
+    if (x->x_childvec_len < XML_CHILDVEC_CHUNK_THRESHOLD/2)
+        return xml_chunk_flat(x);
+    return 0;
+}
+
+/*! Get pointer to child slot at position i, chunked or not */
+#define XML_CHILD_P(x, i) ((x)->x_chunks ? xml_chunk_slot((x), (i)) : &(x)->x_childvec[(i)])
+
+/*! Get child at position i, no range check */
+#define XML_CHILD_I(x, i) (*XML_CHILD_P((x), (i)))
+
+/*! Get memory size of child vector
+ */
+static size_t
+xml_childvec_size(cxobj *x)
+{
+    if (x->x_chunks)
+        return x->x_chunks->xk_nr*XML_CHILDVEC_CHUNK_SIZE*sizeof(cxobj*) +
+            x->x_chunks->xk_max*(sizeof(cxobj**)+sizeof(int)+sizeof(size_t));
+    return x->x_childvec_max*sizeof(struct xml*);
+}
+
 /*! Get number of children
  *
  * @param[in]  xn    xml node
@@ -897,6 +2178,9 @@ xml_child_nr_set(cxobj *xn,
         clixon_err(OE_XML, EINVAL, "xn is NULL or not element");
         return -1;
     }
+    xml_digest_reset(xn);
+    if (xn->x_chunks && xml_chunk_flat(xn) < 0)
+        return -1;
     if (nr <= xn->x_childvec_max)
         xn->x_childvec_len = nr;
     return 0;
@@ -916,10 +2200,12 @@ xml_child_nr_notype(cxobj          *xn,
 {
     cxobj *x = NULL;
     int    nr = 0;
+    int    inext;
 
     if (!is_element(xn))
         return 0;
-    while ((x = xml_child_each(xn, x, -1)) != NULL) {
+    inext = 0;
+    while ((x = xml_child_iter(xn, &inext, -1)) != NULL) {
         if (xml_type(x) != type)
             nr++;
     }
@@ -940,10 +2226,12 @@ xml_child_nr_type(cxobj          *xn,
 {
     cxobj *x = NULL;
     int    len = 0;
+    int    inext;
 
     if (!is_element(xn))
         return 0;
-    while ((x = xml_child_each(xn, x, type)) != NULL)
+    inext = 0;
+    while ((x = xml_child_iter(xn, &inext, type)) != NULL)
         len++;
     return len;
 }
@@ -967,7 +2255,7 @@ xml_child_i(cxobj *xn,
     if (!is_element(xn))
         return NULL;
     if (i < xn->x_childvec_len)
-        return xn->x_childvec[i];
+        return XML_CHILD_I(xn, i);
     return NULL;
 }
 
@@ -986,10 +2274,12 @@ xml_child_i_type(cxobj          *xn,
 {
     cxobj *x = NULL;
     int    it = 0;
+    int    inext;
 
     if (!is_element(xn))
         return NULL;
-    while ((x = xml_child_each(xn, x, type)) != NULL) {
+    inext = 0;
+    while ((x = xml_child_iter(xn, &inext, type)) != NULL) {
         if (x->x_type == type && (i == it++))
             return x;
     }
@@ -1010,13 +2300,19 @@ xml_child_i_set(cxobj *xt,
 {
     if (!is_element(xt))
         return NULL;
+    xml_digest_reset(xt);
+    xml_hindex_free(xt); /* Children are set directly */
     if (i < xt->x_childvec_len)
-        xt->x_childvec[i] = xc;
+        XML_CHILD_I(xt, i) = xc;
     return 0;
 }
 
 /*! Get the order of child
  *
+ * The enumeration of the child (see xml_enumerate_children) is used as a position hint.
+ * If the hint is stale, eg after an insert before the child, the children are
+ * enumerated again while searching, so that repeated calls are O(1) until the next such
+ * insert.
  * @param[in]  xp    xml parent node
  * @param[in]  xc    the xml child to look for
  * @retval     i     The order of the child
@@ -1027,29 +2323,70 @@ int
 xml_child_order(cxobj *xp,
                 cxobj *xc)
 {
-    cxobj *x = NULL;
-    int    i = 0;
+    int    i;
+    cxobj *x;
 
-    if (!is_element(xp))
+    if (!is_element(xp) || xc == NULL)
         return -1;
-    while ((x = xml_child_each(xp, x, -1)) != NULL) {
+    i = xc->_x_i;
+    if (i >= 0 && i < xp->x_childvec_len && XML_CHILD_I(xp, i) == xc)
+        return i;
+    for (i=0; i<xp->x_childvec_len; i++){
+        x = XML_CHILD_I(xp, i);
+        x->_x_i = i;
         if (x == xc)
             return i;
-        i++;
     }
     return -1;
 }
 
-/*! Advanced function to decrement _x_vector_i if objects have been removed
+/*! Advanced function to adjust xml_child_each cursor if objects have been removed
+ *
+ * @param[in]  x    Last child returned by xml_child_each
+ * @param[in]  nr   Number of children removed before x
+ * @note Not necessary: xml_child_each finds x anyway, but this avoids a search
  */
 int
 xml_vector_decrement(cxobj *x,
                      int    nr)
 {
-    x->_x_vector_i -= nr;
+    cxobj *xp;
+
+    if ((xp = xml_parent(x)) != NULL && xp->x_child_cursor >= nr)
+        xp->x_child_cursor -= nr;
     return 0;
 }
 
+/*! Get position to continue child iteration after xprev
+ *
+ * The cursor of the parent is the position of the last child returned, which is xprev
+ * unless the same parent is iterated in a nested loop, or children have been removed.
+ * @param[in]  xparent  XML parent
+ * @param[in]  xprev    Previous child, or NULL on init
+ * @retval     i        Position after xprev
+ */
+static int
+xml_child_each_next(cxobj *xparent,
+                    cxobj *xprev)
+{
+    int i;
+    int c;
+
+    if (xprev == NULL)
+        return 0;
+    c = xparent->x_child_cursor;
+    if (c < xparent->x_childvec_len){
+        if (XML_CHILD_I(xparent, c) == xprev)
+            return c+1;
+        if (c > 0 && XML_CHILD_I(xparent, c-1) == xprev)
+            return c;
+    }
+    if ((i = xml_child_order(xparent, xprev)) >= 0)
+        return i+1;
+    /* xprev removed from position c: next child, if any, is now at c */
+    return c;
+}
+
 /*! Iterator over xml children objects
  *
  * @param[in] xparent xml tree node whose children should be iterated
@@ -1063,10 +2400,11 @@ xml_vector_decrement(cxobj *x,
  *     ...
  *   }
  * @endcode
- * @note uses _x_vector_i as a shared resource: you cannot mix loops over same parent
- * Further, never manipulate the child-list during operation or using the
- * same object recursively, the function uses an internal field to remember the
- * index used. It works as long as the same object is not iterated concurrently. 
+ * @note The parent remembers the position of the last child returned. Nested loops over the
+ * same parent work but are slower since the position of xprev must then be searched for.
+ * Lookup functions such as xml_find and xml_find_body use xml_child_iter and do not move
+ * the position.
+ * The tree is modified, use xml_child_iter for read-only access, eg from several threads.
  * If you need to delete a node you can do something like:
  * @code
  *   cxobj *xprev = NULL;
@@ -1083,6 +2421,7 @@ xml_vector_decrement(cxobj *x,
  * @endcode
  * @see xml_child_index_each
  * @see xml_child_each_attr  hardcoded for sorted list and attributes
+ * @see xml_child_iter       with caller iterator state
  */
 cxobj *
 xml_child_each(cxobj          *xparent,
@@ -1096,8 +2435,8 @@ xml_child_each(cxobj          *xparent,
         return NULL;
     if (!is_element(xparent))
         return NULL;
-    for (i=xprev?xprev->_x_vector_i+1:0; i<xparent->x_childvec_len; i++){
-        xn = xparent->x_childvec[i];
+    for (i=xml_child_each_next(xparent, xprev); i<xparent->x_childvec_len; i++){
+        xn = XML_CHILD_I(xparent, i);
         if (xn == NULL)
             continue;
         if (type != CX_ERROR && xml_type(xn) != type)
@@ -1105,12 +2444,52 @@ xml_child_each(cxobj          *xparent,
         break; /* this is next object after previous */
     }
     if (i < xparent->x_childvec_len) /* found */
-        xn->_x_vector_i = i;
+        xparent->x_child_cursor = i;
     else
         xn = NULL;
     return xn;
 }
 
+/*! Iterate over xml children objects using an integer iterator
+ *
+ * Unlike xml_child_each, the iterator state is kept by the caller, which means that the
+ * same parent can be iterated in nested loops, and that the tree is not modified.
+ * @param[in]     xparent xml tree node whose children should be iterated
+ * @param[in,out] inext   Iterator, or 0 on init
+ * @param[in]     type    matching type or -1 for any
+ * @retval        xn      Next XML node
+ * @retval        NULL    End of list
+ * @code
+ *   cxobj *x;
+ *   int    inext = 0;
+ *   while ((x = xml_child_iter(x_top, &inext, CX_ELMNT)) != NULL) {
+ *     ...
+ *   }
+ * @endcode
+ * @note If the current child is removed in the loop, decrement inext
+ * @see yn_iter  Same for yang
+ */
+cxobj *
+xml_child_iter(cxobj          *xparent,
+               int            *inext,
+               enum cxobj_type type)
+{
+    cxobj *xn;
+
+    if (xparent == NULL || !is_element(xparent) || *inext < 0)
+        return NULL;
+    while (*inext < xparent->x_childvec_len){
+        xn = XML_CHILD_I(xparent, *inext);
+        (*inext)++;
+        if (xn == NULL)
+            continue;
+        if (type != CX_ERROR && xml_type(xn) != type)
+            continue;
+        return xn;
+    }
+    return NULL;
+}
+
 /*! Same as xml_child_each but hard-coded for attributes
  *
  * Assumes attributes are first in list, which they are if they are sorted, but there are
@@ -1133,8 +2512,8 @@ xml_child_each_attr(cxobj  *xparent,
         return NULL;
     if (!is_element(xparent))
         return NULL;
-    for (i=xprev?xprev->_x_vector_i+1:0; i<xparent->x_childvec_len; i++){
-        xn = xparent->x_childvec[i];
+    for (i=xml_child_each_next(xparent, xprev); i<xparent->x_childvec_len; i++){
+        xn = XML_CHILD_I(xparent, i);
         if (xn == NULL)
             continue;
         if (xml_type(xn) != CX_ATTR){
@@ -1143,7 +2522,7 @@ xml_child_each_attr(cxobj  *xparent,
         break; /* this is next object after previous */
     }
     if (i < xparent->x_childvec_len) /* found */
-        xn->_x_vector_i = i;
+        xparent->x_child_cursor = i;
     else
         xn = NULL;
     return xn;
@@ -1163,12 +2542,25 @@ xml_child_append(cxobj *xp,
 
     if (!is_element(xp))
         return 0;
+    if (xml_type(xc) != CX_ATTR)
+        xml_digest_reset(xp);
+    if (xml_flag(xp, XML_FLAG_HINDEX) && xml_hindex_key_change(xp, xc) < 0)
+        return -1;
+#ifdef XML_EXPLICIT_INDEX
+    if (xml_type(xc) == CX_BODY && xml_search_index_leaf(xp, 0) < 0)
+        return -1;
+#endif
     start = XML_CHILDVEC_SIZE_START;
     /* Heurestics: if child is body only single child is expected, but element children may
      * have siblings
      */
     if (xml_type(xc) == CX_ELMNT)
         start = XML_CHILDVEC_SIZE_START_ELMNT;
+    if (xp->x_chunks){
+        if (xml_chunk_insert(xp, xc, xp->x_childvec_len) < 0)
+            return -1;
+        goto ok;
+    }
     xp->x_childvec_len++;
     if (xp->x_childvec_len > xp->x_childvec_max){
         if (xp->x_childvec_len < XML_CHILDVEC_SIZE_THRESHOLD)
@@ -1182,6 +2574,13 @@ xml_child_append(cxobj *xp,
         }
     }
     xp->x_childvec[xp->x_childvec_len-1] = xc;
+ ok:
+    if (XML_COLD(xp, xc_hindex) && xml_type(xc) == CX_ELMNT && xml_hindex_child_add(xp, xc) < 0)
+        return -1;
+#ifdef XML_EXPLICIT_INDEX
+    if (xml_search_index_child_add(xp, xc) < 0)
+        return -1;
+#endif
     return 0;
 }
 
@@ -1204,6 +2603,26 @@ xml_child_insert_pos(cxobj *xp,
 
     if (!is_element(xp))
         return 0;
+    if (xml_type(xc) != CX_ATTR)
+        xml_digest_reset(xp);
+    if (xml_flag(xp, XML_FLAG_HINDEX) && xml_hindex_key_change(xp, xc) < 0)
+        return -1;
+#ifdef XML_EXPLICIT_INDEX
+    if (xml_type(xc) == CX_BODY && xml_search_index_leaf(xp, 0) < 0)
+        return -1;
+#endif
+    /* Insert in the middle of a large vector: split in chunks to avoid moving all children */
+    if (_childvec_chunk &&
+        xp->x_chunks == NULL &&
+        xp->x_childvec_len >= XML_CHILDVEC_CHUNK_THRESHOLD &&
+        pos < xp->x_childvec_len)
+        if (xml_chunk_make(xp) < 0)
+            return -1;
+    if (xp->x_chunks){
+        if (xml_chunk_insert(xp, xc, pos) < 0)
+            return -1;
+        goto ok;
+    }
     xp->x_childvec_len++;
     if (xp->x_childvec_len > xp->x_childvec_max){
         if (xp->x_childvec_len < XML_CHILDVEC_SIZE_THRESHOLD)
@@ -1219,6 +2638,13 @@ xml_child_insert_pos(cxobj *xp,
     size = (xml_child_nr(xp) - pos - 1)*sizeof(cxobj *);
     memmove(&xp->x_childvec[pos+1], &xp->x_childvec[pos], size);
     xp->x_childvec[pos] = xc;
+ ok:
+    if (XML_COLD(xp, xc_hindex) && xml_type(xc) == CX_ELMNT && xml_hindex_child_add(xp, xc) < 0)
+        return -1;
+#ifdef XML_EXPLICIT_INDEX
+    if (xml_search_index_child_add(xp, xc) < 0)
+        return -1;
+#endif
     return 0;
 }
 
@@ -1237,6 +2663,12 @@ xml_childvec_set(cxobj *x,
 {
     if (!is_element(x))
         return 0;
+    xml_digest_reset(x);
+    xml_hindex_free(x); /* Children are set directly */
+    if (x->x_chunks){
+        xml_chunk_free(x->x_chunks);
+        x->x_chunks = NULL;
+    }
     x->x_childvec_len = 0;
     x->x_childvec_max = len;
     if (x->x_childvec)
@@ -1257,6 +2689,9 @@ xml_childvec_get(cxobj *x)
 {
     if (!is_element(x))
         return NULL;
+    xml_digest_reset(x); /* Caller may reorder children, eg sort */
+    if (x->x_chunks && xml_chunk_flat(x) < 0)
+        return NULL;
     return x->x_childvec;
 }
 
@@ -1324,12 +2759,18 @@ xml_new(const char     *name,
         return NULL;
         break;
     }
-    if ((x = malloc(sz)) == NULL){
+    if (_xml_slab){
+        if ((x = xml_slab_alloc(type==CX_ELMNT?&_slab_elmnt:&_slab_body)) == NULL)
+            return NULL;
+    }
+    else if ((x = malloc(sz)) == NULL){
         clixon_err(OE_XML, errno, "malloc");
         return NULL;
     }
     memset(x, 0, sz);
     xml_type_set(x, type);
+    if (_xml_slab)
+        x->x_flags = XML_FLAG_SLAB;
     if (name && (xml_name_set(x, name)) < 0)
         return NULL;
     if (xp){
@@ -1397,6 +2838,12 @@ xml_spec_set(cxobj     *x,
 {
     if (!is_element(x))
         return 0;
+    if (x->x_up && XML_COLD(x->x_up, xc_hindex) && x->x_spec != spec){
+        if (xml_hindex_child_rm(x->x_up, x) < 0)
+            return -1;
+        x->x_spec = spec;
+        return xml_hindex_child_add(x->x_up, x);
+    }
     x->x_spec = spec;
     return 0;
 }
@@ -1439,6 +2886,43 @@ xml_cv_set(cxobj  *x,
     return 0;
 }
 
+/*! Get hash index of xml node
+ *
+ * @param[in]  x   XML node
+ * @retval     xh  Hash index (first table) or NULL
+ * @see clixon_xml_hindex.c
+ */
+struct xml_hindex *
+xml_hindex(cxobj *x)
+{
+    if (!is_element(x))
+        return NULL;
+    return XML_COLD(x, xc_hindex);
+}
+
+/*! Set hash index of xml node
+ *
+ * @param[in]  x   XML node
+ * @param[in]  xh  Hash index (first table) or NULL
+ * @retval     0   OK
+ * @see clixon_xml_hindex.c
+ */
+int
+xml_hindex_set(cxobj             *x,
+               struct xml_hindex *xh)
+{
+    struct xml_cold *xc;
+
+    if (!is_element(x))
+        return 0;
+    if (xh == NULL && x->x_cold == NULL)
+        return 0;
+    if ((xc = xml_cold_get(x)) == NULL)
+        return -1;
+    xc->xc_hindex = xh;
+    return 0;
+}
+
 /*! Find an XML node matching name among a parent's children.
  *
  * Get first XML node directly under x_up in the xml hierarchy with
@@ -1461,14 +2945,16 @@ xml_find(cxobj      *xp,
          const char *name)
 {
     cxobj *x = NULL;
+    int    inext;
 
     if (xp == NULL || name == NULL) {
         return NULL;
     }
     if (!is_element(xp))
         return NULL;
-    while ((x = xml_child_each(xp, x, -1)) != NULL)
-        if (strcmp(name, xml_name(x)) == 0)
+    inext = 0;
+    while ((x = xml_child_iter(xp, &inext, -1)) != NULL)
+        if (name == xml_name(x) || strcmp(name, xml_name(x)) == 0)
             break; /* x is set */
     return x;
 }
@@ -1526,10 +3012,6 @@ xml_addsub(cxobj *xp,
         }
         /* clear namespace context cache of child */
         nscache_clear(xc);
-#ifdef XML_EXPLICIT_INDEX
-    if (xml_search_index_p(xc))
-            xml_search_child_insert(xp, xc);
-#endif
     }
     retval = 0;
  done:
@@ -1649,16 +3131,31 @@ xml_child_rm(cxobj *xp,
         clixon_err(OE_XML, 0, "Child not found");
         goto done;
     }
-    xml_parent_set(xc, NULL);
-    xp->x_childvec[i] = NULL;
-    xp->x_childvec_len--;
-    if (i<xp->x_childvec_len)
-        memmove(&xp->x_childvec[i], &xp->x_childvec[i+1], (xp->x_childvec_len-i)*sizeof(cxobj*));
+    if (xml_type(xc) != CX_ATTR)
+        xml_digest_reset(xp);
+    if (xml_flag(xp, XML_FLAG_HINDEX) && xml_hindex_key_change(xp, xc) < 0)
+        goto done;
+    if (XML_COLD(xp, xc_hindex) && xml_type(xc) == CX_ELMNT && xml_hindex_child_rm(xp, xc) < 0)
+        goto done;
 #ifdef XML_EXPLICIT_INDEX
-    if (xml_type(xc) == CX_ELMNT){
-        if (xml_search_index_p(xc))
-            xml_search_child_rm(xp, xc);
+    if (xml_search_index_child_rm(xp, xc) < 0)
+        goto done;
+#endif
+    xml_parent_set(xc, NULL);
+    if (xp->x_chunks){
+        if (xml_chunk_rm(xp, i) < 0)
+            goto done;
+    }
+    else
+    {
+        xp->x_childvec[i] = NULL;
+        xp->x_childvec_len--;
+        if (i<xp->x_childvec_len)
+            memmove(&xp->x_childvec[i], &xp->x_childvec[i+1], (xp->x_childvec_len-i)*sizeof(cxobj*));
     }
+#ifdef XML_EXPLICIT_INDEX
+    if (xml_type(xc) == CX_BODY && xml_search_index_leaf(xp, 1) < 0)
+        goto done;
 #endif
     retval = 0;
  done:
@@ -1678,19 +3175,11 @@ xml_rm(cxobj *xc)
 {
     int    retval = -1;
     cxobj *xp;
-    cxobj *x;
     int    i;
 
     if ((xp = xml_parent(xc)) == NULL)
-        goto ok;
-    /* Find child in parent XXX: search? */
-    x = NULL; i = 0;
-    while ((x = xml_child_each(xp, x, -1)) != NULL) {
-        if (x == xc)
-            break;
-        i++;
-    }
-    if (x != NULL)
+        goto ok;
+    if ((i = xml_child_order(xp, xc)) >= 0)
         if (xml_child_rm(xp, i) < 0)
             goto done;
  ok:
@@ -1799,7 +3288,6 @@ xml_rootchild_node(cxobj  *xp,
                    cxobj  *xc)
 {
     int    retval = -1;
-    cxobj *x;
     int    i;
 
     if (!is_element(xp))
@@ -1808,11 +3296,9 @@ xml_rootchild_node(cxobj  *xp,
         clixon_err(OE_XML, 0, "Parent is not root");
         goto done;
     }
-    x = NULL; i = 0;
-    while ((x = xml_child_each(xp, x, -1)) != NULL) {
-        if (x == xc)
-            break;
-        i++;
+    if ((i = xml_child_order(xp, xc)) < 0){
+        clixon_err(OE_XML, 0, "Not a child of parent");
+        goto done;
     }
     if (xml_child_rm(xp, i) < 0)
         goto done;
@@ -1840,10 +3326,12 @@ xml_enumerate_children(cxobj *xp)
 {
     cxobj *x = NULL;
     int    i = 0;
+    int    inext;
 
     if (!is_element(xp))
         return 0;
-    while ((x = xml_child_each(xp, x, -1)) != NULL)
+    inext = 0;
+    while ((x = xml_child_iter(xp, &inext, -1)) != NULL)
         x->_x_i = i++;
     return 0;
 }
@@ -1854,10 +3342,12 @@ int
 xml_enumerate_reset(cxobj *xp)
 {
     cxobj *x = NULL;
+    int    inext;
 
     if (!is_element(xp))
         return 0;
-    while ((x = xml_child_each(xp, x, -1)) != NULL)
+    inext = 0;
+    while ((x = xml_child_iter(xp, &inext, -1)) != NULL)
         x->_x_i = 0;
     return 0;
 }
@@ -1892,10 +3382,12 @@ char *
 xml_body(cxobj *xn)
 {
     cxobj *xb = NULL;
+    int    inext;
 
     if (!is_element(xn))
         return NULL;
-    while ((xb = xml_child_each(xn, xb, CX_BODY)) != NULL)
+    inext = 0;
+    while ((xb = xml_child_iter(xn, &inext, CX_BODY)) != NULL)
         return xml_value(xb);
     return NULL;
 }
@@ -1911,10 +3403,12 @@ cxobj *
 xml_body_get(cxobj *xt)
 {
     cxobj *xb = NULL;
+    int    inext;
 
     if (!is_element(xt))
         return NULL;
-    while ((xb = xml_child_each(xt, xb, CX_BODY)) != NULL)
+    inext = 0;
+    while ((xb = xml_child_iter(xt, &inext, CX_BODY)) != NULL)
         return xb;
     return NULL;
 }
@@ -1973,17 +3467,19 @@ xml_find_type(cxobj          *xt,
     cxobj *x = NULL;
     int    pmatch;  /* prefix match */
     char  *xprefix; /* xprefix */
+    int    inext;
 
     if (!is_element(xt))
         return NULL;
-    while ((x = xml_child_each(xt, x, type)) != NULL) {
+    inext = 0;
+    while ((x = xml_child_iter(xt, &inext, type)) != NULL) {
         if (prefix){
             xprefix = xml_prefix(x);
             pmatch = xprefix ? strcmp(prefix,xprefix)==0 : 0;
         }
         else
             pmatch = 1;
-        if (pmatch && (name==NULL || strcmp(name, xml_name(x)) == 0))
+        if (pmatch && (name==NULL || name == xml_name(x) || strcmp(name, xml_name(x)) == 0))
             return x;
     }
     return NULL;
@@ -2009,10 +3505,12 @@ xml_find_value(cxobj      *xt,
                const char *name)
 {
     cxobj *x = NULL;
+    int    inext;
 
     if (!is_element(xt))
         return NULL;
-    while ((x = xml_child_each(xt, x, -1)) != NULL)
+    inext = 0;
+    while ((x = xml_child_iter(xt, &inext, -1)) != NULL)
         if (strcmp(name, xml_name(x)) == 0)
             return xml_value(x);
     return NULL;
@@ -2035,10 +3533,12 @@ xml_find_body(cxobj      *xt,
               const char *name)
 {
     cxobj *x=NULL;
+    int    inext;
 
     if (!is_element(xt))
         return NULL;
-    while ((x = xml_child_each(xt, x, -1)) != NULL)
+    inext = 0;
+    while ((x = xml_child_iter(xt, &inext, -1)) != NULL)
         if (strcmp(name, xml_name(x)) == 0)
             return xml_body(x);
     return NULL;
@@ -2065,10 +3565,12 @@ xml_find_body_obj(cxobj      *xt,
 {
     cxobj *x = NULL;
     char  *bstr;
+    int    inext;
 
     if (!is_element(xt))
         return NULL;
-    while ((x = xml_child_each(xt, x, CX_ELMNT)) != NULL) {
+    inext = 0;
+    while ((x = xml_child_iter(xt, &inext, CX_ELMNT)) != NULL) {
         if (strcmp(name, xml_name(x)))
             continue;
         if ((bstr = xml_body(x)) == NULL)
@@ -2079,59 +3581,128 @@ xml_find_body_obj(cxobj      *xt,
     return x;
 }
 
-/*! Free an xml sub-tree recursively, reset it, but not object itself, do not remove it from parent
+/*! Free name, values and other resources of a single xml node, and reset it
  *
- * @param[in]  x  the xml tree to be reset
- * @see xml_purge where x is also removed from parent
- * @see xml_free also free object
+ * Children are not freed, and not the object itself
+ * @param[in]  x  XML node
+ * @see xml_free0
  */
-int
-xml_free0(cxobj *x)
+static void
+xml_free_one(cxobj *x)
 {
-    int    i;
-    cxobj *xc;
-    size_t sz = 0;
+    size_t   sz = 0;
+    uint16_t slab;
 
-    if (x == NULL)
-        return 0;
+#ifdef XML_NAME_INTERN
+    if (x->x_name)
+        clixon_str_intern_free(x->x_name);
+    if (x->x_prefix)
+        clixon_str_intern_free(x->x_prefix);
+#else
     if (x->x_name)
         free(x->x_name);
     if (x->x_prefix)
         free(x->x_prefix);
+#endif
     switch (xml_type(x)){
     case CX_ELMNT:
         sz = sizeof(struct xml);
-        for (i=0; i<x->x_childvec_len; i++){
-            if ((xc = x->x_childvec[i]) != NULL){
-                xml_free(xc);
-                x->x_childvec[i] = NULL;
-            }
-        }
         if (x->x_childvec)
             free(x->x_childvec);
+        if (x->x_chunks)
+            xml_chunk_free(x->x_chunks);
         if (x->x_cv)
             cv_free(x->x_cv);
-        if (x->x_ns_cache)
-            xml_nsctx_free(x->x_ns_cache);
+        if (x->x_cold){
+            if (x->x_cold->xc_ns_cache)
+                xml_nsctx_free(x->x_cold->xc_ns_cache);
+            if (x->x_cold->xc_nsscope)
+                xml_nsscope_free(x->x_cold->xc_nsscope);
+            if (x->x_cold->xc_digest)
+                free(x->x_cold->xc_digest);
+            xml_hindex_free(x);
 #ifdef XML_EXPLICIT_INDEX
-        xml_search_index_free(x);
+            xml_search_index_free(x);
 #endif
+            free(x->x_cold);
+        }
         break;
     case CX_BODY:
     case CX_ATTR:
         sz = sizeof(struct xmlbody);
-        if (x->x_value_cb)
-            cbuf_free(x->x_value_cb);
+        if (xml_bodyattr(x)->xb_value_max == XML_VALUE_SHARED_MARK)
+            xml_value_shared_free(XML_VALUE_SHARED_GET(xml_bodyattr(x)));
+        else
+        if (xml_bodyattr(x)->xb_value_max)
+            free(xml_bodyattr(x)->xb_value);
         break;
     default:
         break;
     }
-    if (sz)
+    if (sz){
+        slab = x->x_flags & XML_FLAG_SLAB;
         memset(x, 0, sz);
+        x->x_flags = slab; /* Kept for xml_release */
+    }
+}
+
+/*! Release memory of a single xml node reset with xml_free_one
+ *
+ * @param[in]  x     XML node
+ * @param[in]  type  XML type of node before reset
+ */
+static void
+xml_release(cxobj          *x,
+            enum cxobj_type type)
+{
+    if (x->x_flags & XML_FLAG_SLAB)
+        xml_slab_release(type==CX_ELMNT?&_slab_elmnt:&_slab_body, x);
+    else
+        free(x);
+    _stats_xml_nr--;
+}
+
+/*! Free an xml sub-tree, reset it, but not object itself, do not remove it from parent
+ *
+ * The sub-tree is freed without recursion: descend to the last remaining child until
+ * a node without children is reached, free it and go back up to its parent.
+ * @param[in]  x  the xml tree to be reset
+ * @see xml_purge where x is also removed from parent
+ * @see xml_free also free object
+ */
+int
+xml_free0(cxobj *x)
+{
+    cxobj          *xn;
+    cxobj          *xc;
+    enum cxobj_type type;
+
+    if (x == NULL)
+        return 0;
+    xn = x;
+    for (;;){
+        if (xml_type(xn) == CX_ELMNT && xn->x_childvec_len > 0){
+            xc = XML_CHILD_I(xn, xn->x_childvec_len - 1);
+            xn->x_childvec_len--;
+            if (xc != NULL){
+                xc->x_up = xn; /* Way back up */
+                xn = xc;
+            }
+            continue;
+        }
+        if (xn == x)
+            break;
+        xc = xn;
+        xn = xn->x_up;
+        type = xml_type(xc); /* xml_free_one resets type */
+        xml_free_one(xc);
+        xml_release(xc, type);
+    }
+    xml_free_one(x);
     return 0;
 }
 
-/*! Free an xml sub-tree recursively, but do not remove it from parent
+/*! Free an xml sub-tree, but do not remove it from parent
  *
  * @param[in]  x  the xml tree to be freed.
  * @see xml_purge where x is also removed from parent
@@ -2139,11 +3710,62 @@ xml_free0(cxobj *x)
 int
 xml_free(cxobj *x)
 {
+    enum cxobj_type type;
+
     if (x == NULL)
         return 0;
+    type = xml_type(x); /* xml_free0 resets type */
     xml_free0(x);
-    free(x);
-    _stats_xml_nr--;
+    xml_release(x, type);
+    return 0;
+}
+
+/*! Push a frame on the explicit stack of an iterative tree traversal
+ *
+ * The first XML_FRAME_NR frames are in a vector provided by the caller, typically on the
+ * C stack, deeper trees allocate a larger vector, which the caller frees if it differs
+ * from the initial vector.
+ * @param[in,out] fv    Frame vector
+ * @param[in,out] len   Number of frames
+ * @param[in,out] max   Allocated number of frames
+ * @param[in]     fv0   Initial frame vector of XML_FRAME_NR frames
+ * @param[in]     x0    Node, or source node of copy
+ * @param[in]     x1    Destination node of copy, or NULL
+ * @param[in]     flag  Frame flag
+ * @retval        0     OK
+ * @retval       -1     Error
+ */
+static int
+xml_frame_push(struct xml_frame **fv,
+               int               *len,
+               int               *max,
+               struct xml_frame  *fv0,
+               cxobj             *x0,
+               cxobj             *x1,
+               int                flag)
+{
+    struct xml_frame *f;
+
+    if (*len == *max){
+        if (*fv == fv0){
+            if ((f = malloc(2 * (*max) * sizeof(*f))) == NULL){
+                clixon_err(OE_XML, errno, "malloc");
+                return -1;
+            }
+            memcpy(f, fv0, (*len) * sizeof(*f));
+        }
+        else if ((f = realloc(*fv, 2 * (*max) * sizeof(*f))) == NULL){
+            clixon_err(OE_XML, errno, "realloc");
+            return -1;
+        }
+        *fv = f;
+        *max *= 2;
+    }
+    f = &(*fv)[(*len)++];
+    f->xf_x0 = x0;
+    f->xf_x1 = x1;
+    f->xf_i = 0;
+    f->xf_flag = flag;
     return 0;
 }
 
@@ -2160,6 +3782,7 @@ xml_copy_one(cxobj *x0,
 {
     int   retval = -1;
     char *s;
+    struct xml_value_shared *xs;
 
     if (x0 == NULL || x1 == NULL){
         clixon_err(OE_XML, EINVAL, "x0 or x1 is NULL");
@@ -2178,6 +3801,15 @@ xml_copy_one(cxobj *x0,
         break;
     case CX_BODY:
     case CX_ATTR:
+        /* Large values are shared by the copies instead of copied */
+        if (_xml_value_shared &&
+            xml_bodyattr(x0)->xb_value_len >= _xml_value_shared){
+            if ((xs = xml_value_shared_make(xml_bodyattr(x0))) == NULL)
+                goto done;
+            if (xml_value_set1(x1, xs->xs_data, xs) < 0)
+                goto done;
+            break;
+        }
         if ((s = xml_value(x0))){ /* malloced string */
             if (xml_value_set(x1, s) < 0)
                 goto done;
@@ -2196,6 +3828,8 @@ xml_copy_one(cxobj *x0,
  *
  * x1 should be a created placeholder. If x1 is non-empty,
  * the copied tree is appended to the existing tree.
+ * The tree is copied depth-first without recursion, using an explicit stack. The child
+ * vector of each copied element is allocated once with the number of source children.
  * @param[in]  x0  Source XML tree
  * @param[in]  x1  Destination XML tree (must exist)
  * @retval     0   OK
@@ -2210,21 +3844,86 @@ xml_copy_one(cxobj *x0,
 int
 xml_copy(cxobj *x0,
          cxobj *x1)
+{
+    int               retval = -1;
+    struct xml_frame  fv0[XML_FRAME_NR];
+    struct xml_frame *fv = fv0;
+    struct xml_frame *f;
+    int               len = 0;
+    int               max = XML_FRAME_NR;
+    cxobj            *x;
+    cxobj            *xcopy;
+    int               empty;
+
+    empty = xml_child_nr(x1) == 0;
+    if (xml_copy_one(x0, x1) <0)
+        goto done;
+    if (!is_element(x0))
+        goto ok;
+    if (empty && xml_child_nr(x0) && xml_childvec_set(x1, xml_child_nr(x0)) < 0)
+        goto done;
+    /* Frame flag: destination was empty */
+    if (xml_frame_push(&fv, &len, &max, fv0, x0, x1, empty) < 0)
+        goto done;
+    while (len > 0){
+        f = &fv[len-1];
+        if (f->xf_i < xml_child_nr(f->xf_x0)){
+            if ((x = XML_CHILD_I(f->xf_x0, f->xf_i++)) == NULL)
+                continue;
+            if ((xcopy = xml_new(xml_name(x), f->xf_x1, xml_type(x))) == NULL)
+                goto done;
+            if (xml_type(x) == CX_ELMNT && xml_child_nr(x) &&
+                xml_childvec_set(xcopy, xml_child_nr(x)) < 0)
+                goto done;
+            if (xml_copy_one(x, xcopy) < 0)
+                goto done;
+            if (xml_type(x) == CX_ELMNT &&
+                xml_frame_push(&fv, &len, &max, fv0, x, xcopy, 1) < 0) /* f may move */
+                goto done;
+            continue;
+        }
+        /* An exact copy has the same digest, unless appended to existing children */
+        if (f->xf_flag && xml_flag(f->xf_x0, XML_FLAG_DIGEST) &&
+            xml_digest_copy(f->xf_x0, f->xf_x1) < 0)
+            goto done;
+        len--;
+    }
+ ok:
+    retval = 0;
+  done:
+    if (fv != fv0)
+        free(fv);
+    return retval;
+}
+
+/*! Copy xml tree x0 to other existing tree x1 except element sub-trees with flags set
+ *
+ * @param[in]  x0    Source XML tree
+ * @param[in]  x1    Destination XML tree (must exist)
+ * @param[in]  skip  Do not copy element children with any of these flags, eg XML_FLAG_DEFAULT
+ * @retval     0     OK
+ * @retval    -1     Error
+ * @see xml_copy
+ */
+int
+xml_copy_skip(cxobj   *x0,
+              cxobj   *x1,
+              uint16_t skip)
 {
     int    retval = -1;
     cxobj *x;
     cxobj *xcopy;
+    int    inext;
 
     if (xml_copy_one(x0, x1) <0)
         goto done;
-    x = NULL;
-    while ((x = xml_child_each(x0, x, -1)) != NULL) {
+    inext = 0;
+    while ((x = xml_child_iter(x0, &inext, -1)) != NULL) {
+        if (xml_type(x) == CX_ELMNT && xml_flag(x, skip))
+            continue;
         if ((xcopy = xml_new(xml_name(x), x1, xml_type(x))) == NULL)
             goto done;
-        if (xml_type(x) == CX_ELMNT && xml_child_nr(x)){
-            xml_childvec_set(xcopy, xml_child_nr(x));
-        }
-        if (xml_copy(x, xcopy) < 0) /* recursion */
+        if (xml_copy_skip(x, xcopy, skip) < 0) /* recursion */
             goto done;
     }
     retval = 0;
@@ -2340,7 +4039,7 @@ cxvec_prepend(cxobj   *x,
  * each object found. The function is called with the xml node and an 
  * argument as args.
  * The tree is traversed depth-first, which at least guarantees that a parent is
- * traversed before a child.
+ * traversed before a child. The traversal uses an explicit stack, not recursion.
  * @param[in]  xn   XML node
  * @param[in]  type Matching type or -1 for any
  * @param[in]  fn   Callback
@@ -2367,31 +4066,48 @@ xml_apply(cxobj          *xn,
           xml_applyfn_t   fn,
           void           *arg)
 {
-    int        retval = -1;
-    cxobj     *x;
-    int        ret;
+    int               retval = -1;
+    struct xml_frame  fv0[XML_FRAME_NR];
+    struct xml_frame *fv = fv0;
+    struct xml_frame *f;
+    int               len = 0;
+    int               max = XML_FRAME_NR;
+    cxobj            *x;
+    int               ret;
 
     if (!is_element(xn))
         return 0;
-    x = NULL;
-    while ((x = xml_child_each(xn, x, type)) != NULL) {
+    if (xml_frame_push(&fv, &len, &max, fv0, xn, NULL, 0) < 0)
+        goto done;
+    while (len > 0){
+        f = &fv[len-1];
+        if (f->xf_i >= xml_child_nr(f->xf_x0)){
+            len--;
+            continue;
+        }
+        if ((x = XML_CHILD_I(f->xf_x0, f->xf_i++)) == NULL)
+            continue;
+        if (type != CX_ERROR && xml_type(x) != type)
+            continue;
         if ((ret = fn(x, arg)) < 0)
             goto done;
+        /* x removed from parent by fn: next child, if any, is now at its position */
+        if (xml_child_i(f->xf_x0, f->xf_i-1) != x)
+            f->xf_i--;
         if (ret == 2)
             continue; /* Abort this node, dont recurse */
         else if (ret == 1){
             retval = 1;
             goto done;
         }
-        if ((ret = xml_apply(x, type, fn, arg)) < 0)
-            goto done;
-        if (ret == 1){
-            retval = 1;
+        if (is_element(x) &&
+            xml_frame_push(&fv, &len, &max, fv0, x, NULL, 0) < 0)
             goto done;
-        }
     }
     retval = 0;
   done:
+    if (fv != fv0)
+        free(fv);
     return retval;
 }
 
@@ -2694,8 +4410,8 @@ xml_search_index_free(cxobj *x)
 {
     struct search_index *si;
 
-    while ((si = x->x_search_index) != NULL) {
-        DELQ(si, x->x_search_index, struct search_index *);
+    while ((si = XML_COLD(x, xc_search_index)) != NULL) {
+        DELQ(si, x->x_cold->xc_search_index, struct search_index *);
         if (si->si_name)
             free(si->si_name);
         if (si->si_xvec)
@@ -2717,7 +4433,10 @@ xml_search_index_add(cxobj *x,
                      char  *name)
 {
     struct search_index *si = NULL;
+    struct xml_cold     *xc;
 
+    if ((xc = xml_cold_get(x)) == NULL)
+        goto done;
     if ((si = malloc(sizeof(struct search_index))) == NULL){
         clixon_err(OE_XML, errno, "malloc");
         goto done;
@@ -2735,7 +4454,7 @@ xml_search_index_add(cxobj *x,
         si = NULL;
         goto done;
     }
-    ADDQ(si, x->x_search_index);
+    ADDQ(si, xc->xc_search_index);
  done:
     return si;
 }
@@ -2753,14 +4472,14 @@ xml_search_index_get(cxobj *x,
 {
     struct search_index *si = NULL;
 
-    if ((si = x->x_search_index) != NULL) {
+    if ((si = XML_COLD(x, xc_search_index)) != NULL) {
         do {
             if (strcmp(si->si_name, name) == 0){
                 goto done;
                 break;
             }
             si = NEXTQ(struct search_index *, si);
-        } while (si && si != x->x_search_index);
+        } while (si && si != XML_COLD(x, xc_search_index));
     }
  done:
     return si;
@@ -2783,50 +4502,83 @@ xml_search_vector_get(cxobj        *xp,
     struct search_index *si;
 
     *xvec = NULL;
-    if ((si = xp->x_search_index) != NULL) {
+    if ((si = XML_COLD(xp, xc_search_index)) != NULL) {
         do {
             if (strcmp(si->si_name, name) == 0){
                 *xvec = si->si_xvec;
                 break;
             }
             si = NEXTQ(struct search_index *, si);
-        } while (si && si != xp->x_search_index);
+        } while (si && si != XML_COLD(xp, xc_search_index));
     }
     return 0;
 }
 
-/*! Insert a new cxobj into search index vector for list for variable "name"
+/*! Find position of list element in search index vector
  *
- * @param[in] xp  XML parent object (the list element)
- * @param[in] xi  XML index object (that should be added)
- * @retval    0   OK
- * @retval   -1   Error
+ * Non-key index variables need not be unique, look at all equal neighbours of pos
+ * @param[in] si   Search index
+ * @param[in] xp   XML list element
+ * @param[in] pos  Position of an element with equal index variable value
+ * @retval    i    Position of xp in search index vector
+ * @retval   -1    Not found
  */
-int
-xml_search_child_insert(cxobj *xp,
-                        cxobj *xi)
+static int
+xml_search_index_pos(struct search_index *si,
+                     cxobj               *xp,
+                     int                  pos)
+{
+    int    len;
+    int    i;
+    cxobj *x;
+
+    len = clixon_xvec_len(si->si_xvec);
+    for (i=pos; i>=0; i--){
+        if ((x = clixon_xvec_i(si->si_xvec, i)) == xp)
+            return i;
+        if (xml_cmp(xp, x, 0, 0, si->si_name) != 0)
+            break;
+    }
+    for (i=pos+1; i<len; i++){
+        if ((x = clixon_xvec_i(si->si_xvec, i)) == xp)
+            return i;
+        if (xml_cmp(xp, x, 0, 0, si->si_name) != 0)
+            break;
+    }
+    return -1;
+}
+
+/*! Insert list element in search index vector of its parent, unless already there
+ *
+ * @param[in] xpp      XML parent of list element
+ * @param[in] xp       XML list element
+ * @param[in] indexvar Name of index variable
+ * @retval    0        OK
+ * @retval   -1        Error
+ */
+static int
+xml_search_index_insert(cxobj *xpp,
+                        cxobj *xp,
+                        char  *indexvar)
 {
     int                  retval = -1;
-    char                *indexvar;
     struct search_index *si;
-    cxobj               *xpp;
     int                  i;
     int                  len;
+    int                  eq = 0;
 
-    indexvar = xml_name(xi);
-    if ((xpp = xml_parent(xp)) == NULL)
-        goto ok;
     /* Find base vector in grandparent */
     if ((si = xml_search_index_get(xpp, indexvar)) == NULL){
         /* If not found add base vector in grand-parent */
         if ((si = xml_search_index_add(xpp, indexvar)) == NULL)
             goto done;
     }
-    /* Find element position using binary search and then remove */
+    /* Find element position using binary search and then insert */
     len = clixon_xvec_len(si->si_xvec);
-    if ((i = xml_search_indexvar_binary_pos(xp, indexvar, si->si_xvec, 0, len, len, NULL)) < 0)
+    if ((i = xml_search_indexvar_binary_pos(xp, indexvar, si->si_xvec, 0, len, len, &eq)) < 0)
         goto done;
-    assert(clixon_xvec_i(si->si_xvec, i) != xp);
+    if (eq && xml_search_index_pos(si, xp, i) >= 0)
+        goto ok; /* Already indexed, eg both when added and when bound to yang */
     if (clixon_xvec_insert_pos(si->si_xvec, xp, i) < 0)
         goto done;
  ok:
@@ -2835,6 +4587,70 @@ xml_search_child_insert(cxobj *xp,
     return retval;
 }
 
+/*! Remove list element from search index vector of its parent
+ *
+ * @param[in] xpp      XML parent of list element
+ * @param[in] xp       XML list element
+ * @param[in] indexvar Name of index variable
+ * @retval    0        OK
+ * @retval   -1        Error
+ */
+static int
+xml_search_index_rm(cxobj *xpp,
+                    cxobj *xp,
+                    char  *indexvar)
+{
+    int                  retval = -1;
+    struct search_index *si;
+    int                  i;
+    int                  len;
+    int                  eq = 0;
+
+    if ((si = xml_search_index_get(xpp, indexvar)) == NULL)
+        goto ok;
+    /* Find element using binary search and then remove */
+    len = clixon_xvec_len(si->si_xvec);
+    if (len == 0)
+        goto ok;
+    if ((i = xml_search_indexvar_binary_pos(xp, indexvar, si->si_xvec, 0, len, len, &eq)) < 0)
+        goto done;
+    if (eq)
+        i = xml_search_index_pos(si, xp, i);
+    else
+        i = -1;
+    if (i < 0){ /* Not in sorted position: fall back to linear search to never leave a dangling entry */
+        for (i=0; i<len; i++)
+            if (clixon_xvec_i(si->si_xvec, i) == xp)
+                break;
+        if (i == len)
+            goto ok;
+    }
+    if (clixon_xvec_rm_pos(si->si_xvec, i) < 0)
+        goto done;
+ ok:
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Insert a new cxobj into search index vector for list for variable "name"
+ *
+ * @param[in] xp  XML parent object (the list element)
+ * @param[in] xi  XML index object (that should be added)
+ * @retval    0   OK
+ * @retval   -1   Error
+ */
+int
+xml_search_child_insert(cxobj *xp,
+                        cxobj *xi)
+{
+    cxobj *xpp;
+
+    if ((xpp = xml_parent(xp)) == NULL)
+        return 0;
+    return xml_search_index_insert(xpp, xp, xml_name(xi));
+}
+
 /*! Remove a single cxobj from search vector 
  *
  * @param[in] xp    XML parent object (the list element)
@@ -2846,35 +4662,156 @@ int
 xml_search_child_rm(cxobj *xp,
                     cxobj *xi)
 {
-    int                 retval = -1;
-    cxobj              *xpp;
-    char               *indexvar;
-    int                 i;
-    int                 len;
-    struct search_index *si;
-    int                  eq = 0;
+    cxobj *xpp;
 
-    indexvar = xml_name(xi);
     if ((xpp = xml_parent(xp)) == NULL)
+        return 0;
+    return xml_search_index_rm(xpp, xp, xml_name(xi));
+}
+
+/*! Value of index variable is about to change or has changed, update search index
+ *
+ * Call with add=0 before the change and add=1 after
+ * @param[in] xi   XML index variable, ie leaf in list element
+ * @param[in] add  0: remove list element from index, 1: insert it
+ * @retval    0    OK
+ * @retval   -1    Error
+ */
+static int
+xml_search_index_leaf(cxobj *xi,
+                      int    add)
+{
+    if (xi == NULL || !xml_search_index_p(xi))
+        return 0;
+    if (add)
+        return xml_search_child_insert(xml_parent(xi), xi);
+    else
+        return xml_search_child_rm(xml_parent(xi), xi);
+}
+
+/*! Child has been added to XML node, update search indexes
+ *
+ * Either xc is an index variable of list element xp, or xc is a list element of xp
+ * with index variable children, or xc is the body of index variable xp.
+ * @param[in] xp   XML parent
+ * @param[in] xc   XML child, xml_parent(xc) may not yet be set
+ * @retval    0    OK
+ * @retval   -1    Error
+ */
+static int
+xml_search_index_child_add(cxobj *xp,
+                           cxobj *xc)
+{
+    int        retval = -1;
+    yang_stmt *y;
+    yang_stmt *yp;
+    cxobj     *xpp;
+    cxobj     *xi;
+    int        i;
+
+    if (xml_type(xc) == CX_BODY){
+        if (xml_search_index_leaf(xp, 1) < 0)
+            goto done;
         goto ok;
-    /* Find base vector in grandparent */
-    if ((si = xml_search_index_get(xpp, indexvar)) == NULL)
+    }
+    if (xml_type(xc) != CX_ELMNT || (y = xml_spec(xc)) == NULL)
         goto ok;
+    if (yang_flag_get(y, YANG_FLAG_INDEX)){
+        if ((xpp = xml_parent(xp)) != NULL &&
+            (yp = xml_spec(xp)) != NULL &&
+            yang_keyword_get(yp) == Y_LIST)
+            if (xml_search_index_insert(xpp, xp, xml_name(xc)) < 0)
+                goto done;
+    }
+    else if (yang_keyword_get(y) == Y_LIST){
+        /* Not xml_child_each: it may be used by caller */
+        for (i=0; i<xml_child_nr(xc); i++){
+            xi = xml_child_i(xc, i);
+            if (xml_type(xi) == CX_ELMNT &&
+                (y = xml_spec(xi)) != NULL &&
+                yang_flag_get(y, YANG_FLAG_INDEX))
+                if (xml_search_index_insert(xp, xc, xml_name(xi)) < 0)
+                    goto done;
+        }
+    }
+ ok:
+    retval = 0;
+ done:
+    return retval;
+}
 
-    /* Find element using binary search and then remove */
-    len = clixon_xvec_len(si->si_xvec);
-    if ((i = xml_search_indexvar_binary_pos(xp, indexvar, si->si_xvec, 0, len, len, &eq)) < 0)
-        goto done;
-        //    if (clixon_xvec_i(si->si_xvec, i) == xp)
-    if (eq)
-        if (clixon_xvec_rm_pos(si->si_xvec, i) < 0)
+/*! Child is about to be removed from XML node, update search indexes
+ *
+ * @param[in] xp   XML parent
+ * @param[in] xc   XML child
+ * @retval    0    OK
+ * @retval   -1    Error
+ * @see xml_search_index_child_add
+ */
+static int
+xml_search_index_child_rm(cxobj *xp,
+                          cxobj *xc)
+{
+    int        retval = -1;
+    yang_stmt *y;
+    cxobj     *xi;
+    int        i;
+
+    if (xml_type(xc) == CX_BODY){
+        if (xml_search_index_leaf(xp, 0) < 0)
             goto done;
+        goto ok;
+    }
+    if (xml_type(xc) != CX_ELMNT || (y = xml_spec(xc)) == NULL)
+        goto ok;
+    if (yang_flag_get(y, YANG_FLAG_INDEX)){
+        if (xml_search_index_leaf(xc, 0) < 0)
+            goto done;
+    }
+    else if (yang_keyword_get(y) == Y_LIST && XML_COLD(xp, xc_search_index) != NULL){
+        for (i=0; i<xml_child_nr(xc); i++){
+            xi = xml_child_i(xc, i);
+            if (xml_type(xi) == CX_ELMNT &&
+                (y = xml_spec(xi)) != NULL &&
+                yang_flag_get(y, YANG_FLAG_INDEX))
+                if (xml_search_index_rm(xp, xc, xml_name(xi)) < 0)
+                    goto done;
+        }
+    }
  ok:
     retval = 0;
  done:
     return retval;
 }
 
+/*! Get memory size and number of search index vectors of XML node
+ *
+ * @param[in]     x   XML object
+ * @param[in,out] nr  Incremented with number of search index vectors, if given
+ * @retval        sz  Size in bytes
+ */
+static size_t
+xml_search_index_size(cxobj    *x,
+                      uint64_t *nr)
+{
+    struct search_index *si;
+    size_t               sz = 0;
+
+    if ((si = XML_COLD(x, xc_search_index)) != NULL) {
+        do {
+            if (nr)
+                (*nr)++;
+            sz += sizeof(struct search_index);
+            if (si->si_name)
+                sz += strlen(si->si_name)+1;
+            if (si->si_xvec)
+                sz += clixon_xvec_len(si->si_xvec)*sizeof(struct cxobj*);
+            si = NEXTQ(struct search_index *, si);
+        } while (si && si != XML_COLD(x, xc_search_index));
+    }
+    return sz;
+}
+
 /*! Iterator over xml children objects using (explicit) index variable
  *
  * @param[in] xparent xml tree node whose children should be iterated
@@ -2888,10 +4825,7 @@ xml_search_child_rm(cxobj *xp,
  *   }
  * @endcode
  * @see xml_child_each  for looping over structural children.
- * @note uses _x_vector_i as a shared resource: you cannot mix loops over same parent
- * Further, never manipulate the child-list during operation or using the
- * same object recursively, the function uses an internal field to remember the
- * index used. It works as long as the same object is not iterated concurrently. 
+ * @note The search index remembers the position of the last object returned, see xml_child_each
  * If you need to delete a node you can do somethjing like:
  */
 cxobj *
@@ -2900,27 +4834,40 @@ xml_child_index_each(cxobj          *xparent,
                      cxobj          *xprev,
                      enum cxobj_type type)
 {
-    cxobj        *xn = NULL;
-    clixon_xvec  *xv = NULL;
-    int           i;
+    cxobj               *xn = NULL;
+    struct search_index *si;
+    clixon_xvec         *xv;
+    int                  len;
+    int                  i = 0;
 
     if (xparent == NULL)
         return NULL;
     if (!is_element(xparent))
         return NULL;
-    if (xml_search_vector_get(xparent, name, &xv) < 0)
+    if ((si = xml_search_index_get(xparent, (char*)name)) == NULL)
         return NULL;
-    if (xv == NULL)
-        return NULL;
-    for (i=xprev?xprev->_x_vector_i+1:0; i<clixon_xvec_len(xv); i++){
+    xv = si->si_xvec;
+    len = clixon_xvec_len(xv);
+    if (xprev != NULL){
+        i = si->si_cursor;
+        if (i < len && clixon_xvec_i(xv, i) == xprev)
+            i++;
+        else {
+            for (i=0; i<len; i++)
+                if (clixon_xvec_i(xv, i) == xprev)
+                    break;
+            i = i<len ? i+1 : si->si_cursor;
+        }
+    }
+    for (; i<len; i++){
         if ((xn = clixon_xvec_i(xv, i)) == NULL)
             continue;
         if (type != CX_ERROR && xml_type(xn) != type)
             continue;
         break; /* this is next object after previous */
     }
-    if (i < clixon_xvec_len(xv)) /* found */
-        xn->_x_vector_i = i;
+    if (i < len) /* found */
+        si->si_cursor = i;
     else
         xn = NULL;
     return xn;
@@ -0,0 +1,998 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+ 
+  Copyright (C) 2009-2016 Olof Hagsand and Benny Holmgren
+  Copyright (C) 2017-2019 Olof Hagsand
+  Copyright (C) 2020-2022 Olof Hagsand and Rubicon Communications, LLC(Netgate)
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2, 
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+
+ * Binary datastore format
+ *
+ * A compact encoding of an XML tree bound to YANG, written and read as:
+ *   header | yang table | node records | string heap
+ * - The header has a magic, version, byte-order mark and a schema id computed from
+ *   the names and revisions of the loaded YANG modules
+ * - The yang table has one entry per distinct YANG node of the tree: parent entry,
+ *   keyword, name and namespace. Entries are resolved once against the YANG spec on load.
+ * - Node records are fixed-size and in document (pre-)order. Each record has a node type tag,
+ *   name, prefix and either a yang table index (element) or a value (attribute or body),
+ *   and elements the number of child records.
+ * - Strings are NULL-terminated in the string heap. Names, prefixes and namespaces are
+ *   stored once.
+ * The file is memory-mapped on load and XML nodes are created directly from the records,
+ * without tokenizing. If the schema id matches and all yang entries resolve, nodes are bound
+ * to YANG on creation. Since the datastore cache is written sorted, the tree is then also sorted.
+ * Otherwise the tree is returned without yang binding.
+ * Records are in host byte order, a file with other byte order is rejected.
+ * The same format is used for rpc replies on the internal socket, if negotiated in hello.
+ * @see CLICON_XMLDB_FORMAT
+ * @see CLIXON_BIN_CAPABILITY
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "clixon_config.h" /* generated by config & autoconf */
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+
+/* cligen */
+#include <cligen/cligen.h>
+
+/* clixon */
+#include "clixon_queue.h"
+#include "clixon_hash.h"
+#include "clixon_handle.h"
+#include "clixon_yang.h"
+#include "clixon_xml.h"
+#include "clixon_err.h"
+#include "clixon_log.h"
+#include "clixon_debug.h"
+#include "clixon_options.h"
+#include "clixon_yang_module.h"
+#include "clixon_xml_sort.h"
+#include "clixon_netconf_lib.h"
+#include "clixon_xml_io.h"
+#include "clixon_xml_bin.h"
+
+/* File magic and version */
+#define XBIN_MAGIC     "CLIXONDB"
+#define XBIN_VERSION   1
+
+/* Byte order mark, as written by host */
+#define XBIN_BOM       0x01020304
+
+/* No string or yang table index */
+#define XBIN_NONE      UINT32_MAX
+
+/* Max depth of XML tree on load */
+#define XBIN_DEPTH_MAX 1024
+
+/*! Binary file header
+ */
+struct xbin_header {
+    char     xh_magic[8];  /* XBIN_MAGIC */
+    uint32_t xh_version;   /* XBIN_VERSION */
+    uint32_t xh_bom;       /* XBIN_BOM */
+    uint64_t xh_schema;    /* Schema id of yang spec, see xbin_schema_id */
+    uint32_t xh_nyang;     /* Number of yang table entries */
+    uint32_t xh_pad;
+    uint64_t xh_nnodes;    /* Number of node records */
+    uint64_t xh_heaplen;   /* Length of string heap */
+};
+
+/*! Yang table entry, how to find yang node given yang node of parent
+ */
+struct xbin_yang {
+    uint32_t xy_parent;    /* Yang table index of parent, or XBIN_NONE if top-level */
+    uint32_t xy_keyword;   /* enum rfc_6020 */
+    uint32_t xy_name;      /* Heap offset of yang argument */
+    uint32_t xy_ns;        /* Heap offset of namespace */
+};
+
+/*! Node record
+ */
+struct xbin_node {
+    uint8_t  xn_type;      /* enum cxobj_type */
+    uint8_t  xn_pad[3];
+    uint32_t xn_name;      /* Heap offset of name */
+    uint32_t xn_prefix;    /* Heap offset of prefix, or XBIN_NONE */
+    uint32_t xn_value;     /* Element: yang table index or XBIN_NONE, else heap offset of value */
+    uint32_t xn_childnr;   /* Element: number of child records */
+};
+
+/*! Encoder state
+ */
+struct xbin_writer {
+    struct xbin_node *xw_nodes;    /* Node records */
+    size_t            xw_nnodes;
+    size_t            xw_nodesmax;
+    struct xbin_yang *xw_yang;     /* Yang table */
+    uint32_t          xw_nyang;
+    uint32_t          xw_yangmax;
+    char             *xw_heap;     /* String heap */
+    size_t            xw_heaplen;
+    size_t            xw_heapmax;
+    clicon_hash_t    *xw_names;    /* Name, prefix and namespace -> heap offset */
+    clicon_hash_t    *xw_yids;     /* yang_stmt -> yang table index + 1 */
+    withdefaults_type xw_wdef;
+    int               xw_system_only;
+    int               xw_marked;   /* Only marked parts, see clixon_xml2cbuf_marked */
+};
+
+/*! Decoder state
+ */
+struct xbin_reader {
+    struct xbin_yang *xr_yang;
+    uint32_t          xr_nyang;
+    struct xbin_node *xr_nodes;
+    uint64_t          xr_nnodes;
+    const char       *xr_heap;
+    uint64_t          xr_heaplen;
+    yang_stmt       **xr_yvec;     /* Resolved yang nodes or NULL if not bound */
+};
+
+/*! Compute schema id of a yang spec from names and revisions of its modules
+ *
+ * Independent of module order
+ * @param[in]  yspec  Yang spec
+ * @retval     id     Schema id
+ */
+static uint64_t
+xbin_schema_id(yang_stmt *yspec)
+{
+    uint64_t       id = 0;
+    uint64_t       h;
+    yang_stmt     *ymod;
+    yang_stmt     *yrev;
+    const char    *s;
+    int            inext;
+    int            i;
+
+    inext = 0;
+    while ((ymod = yn_iter(yspec, &inext)) != NULL) {
+        if (yang_keyword_get(ymod) != Y_MODULE &&
+            yang_keyword_get(ymod) != Y_SUBMODULE)
+            continue;
+        h = 14695981039346656037ULL; /* FNV-1a */
+        for (i=0; i<2; i++){
+            if (i == 0)
+                s = yang_argument_get(ymod);
+            else if ((yrev = yang_find(ymod, Y_REVISION, NULL)) != NULL)
+                s = yang_argument_get(yrev);
+            else
+                s = NULL;
+            for (; s && *s; s++){
+                h ^= (uint8_t)*s;
+                h *= 1099511628211ULL;
+            }
+            h ^= '@';
+            h *= 1099511628211ULL;
+        }
+        id += h;
+    }
+    return id;
+}
+
+/*! Append string to string heap
+ *
+ * @param[in]  xw   Encoder state
+ * @param[in]  str  String
+ * @param[out] off  Heap offset
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+xbin_heap_add(struct xbin_writer *xw,
+              const char         *str,
+              uint32_t           *off)
+{
+    size_t len;
+    char  *heap;
+
+    len = strlen(str) + 1;
+    if (xw->xw_heaplen + len >= XBIN_NONE){
+        clixon_err(OE_XML, EFBIG, "Binary format string heap full");
+        return -1;
+    }
+    if (xw->xw_heaplen + len > xw->xw_heapmax){
+        while (xw->xw_heaplen + len > xw->xw_heapmax)
+            xw->xw_heapmax = xw->xw_heapmax ? 2*xw->xw_heapmax : 4096;
+        if ((heap = realloc(xw->xw_heap, xw->xw_heapmax)) == NULL){
+            clixon_err(OE_UNIX, errno, "realloc");
+            return -1;
+        }
+        xw->xw_heap = heap;
+    }
+    memcpy(xw->xw_heap + xw->xw_heaplen, str, len);
+    *off = xw->xw_heaplen;
+    xw->xw_heaplen += len;
+    return 0;
+}
+
+/*! Add name to string heap unless already added
+ *
+ * @param[in]  xw   Encoder state
+ * @param[in]  name Name, prefix or namespace, or NULL
+ * @param[out] off  Heap offset, or XBIN_NONE if name is NULL
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+xbin_name_add(struct xbin_writer *xw,
+              const char         *name,
+              uint32_t           *off)
+{
+    uint32_t *offp;
+
+    if (name == NULL){
+        *off = XBIN_NONE;
+        return 0;
+    }
+    if ((offp = clicon_hash_value(xw->xw_names, name, NULL)) != NULL){
+        *off = *offp;
+        return 0;
+    }
+    if (xbin_heap_add(xw, name, off) < 0)
+        return -1;
+    if (clicon_hash_add(xw->xw_names, name, off, sizeof(*off)) == NULL)
+        return -1;
+    return 0;
+}
+
+/*! Get yang table index of yang node, add a new entry if not found
+ *
+ * @param[in]  xw   Encoder state
+ * @param[in]  ys   Yang node of XML node
+ * @param[in]  xp   XML parent
+ * @param[out] id   Yang table index
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+xbin_yang_id(struct xbin_writer *xw,
+             yang_stmt          *ys,
+             cxobj              *xp,
+             uint32_t           *id)
+{
+    struct xbin_yang *xy;
+    yang_stmt        *yp;
+    uintptr_t         v;
+
+    if ((v = (uintptr_t)clicon_hash_ptr_value(xw->xw_yids, ys)) != 0){
+        *id = v - 1;
+        return 0;
+    }
+    if (xw->xw_nyang >= xw->xw_yangmax){
+        xw->xw_yangmax = xw->xw_yangmax ? 2*xw->xw_yangmax : 64;
+        if ((xy = realloc(xw->xw_yang, xw->xw_yangmax*sizeof(*xy))) == NULL){
+            clixon_err(OE_UNIX, errno, "realloc");
+            return -1;
+        }
+        xw->xw_yang = xy;
+    }
+    xy = &xw->xw_yang[xw->xw_nyang];
+    memset(xy, 0, sizeof(*xy));
+    xy->xy_parent = XBIN_NONE;
+    if (xp && (yp = xml_spec(xp)) != NULL &&
+        (v = (uintptr_t)clicon_hash_ptr_value(xw->xw_yids, yp)) != 0)
+        xy->xy_parent = v - 1;
+    xy->xy_keyword = yang_keyword_get(ys);
+    if (xbin_name_add(xw, yang_argument_get(ys), &xy->xy_name) < 0)
+        return -1;
+    if (xbin_name_add(xw, yang_find_mynamespace(ys), &xy->xy_ns) < 0)
+        return -1;
+    *id = xw->xw_nyang++;
+    if (clicon_hash_add_ptr(xw->xw_yids, ys, (void*)(uintptr_t)(*id + 1)) == NULL)
+        return -1;
+    return 0;
+}
+
+/*! Append a node record
+ *
+ * @param[in]  xw     Encoder state
+ * @param[in]  type   XML node type
+ * @param[in]  name   Name
+ * @param[in]  prefix Prefix, or NULL
+ * @param[out] ip     Index of new node record
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+static int
+xbin_node_add(struct xbin_writer *xw,
+              enum cxobj_type     type,
+              const char         *name,
+              const char         *prefix,
+              size_t             *ip)
+{
+    struct xbin_node *xn;
+
+    if (xw->xw_nnodes >= xw->xw_nodesmax){
+        xw->xw_nodesmax = xw->xw_nodesmax ? 2*xw->xw_nodesmax : 1024;
+        if ((xn = realloc(xw->xw_nodes, xw->xw_nodesmax*sizeof(*xn))) == NULL){
+            clixon_err(OE_UNIX, errno, "realloc");
+            return -1;
+        }
+        xw->xw_nodes = xn;
+    }
+    *ip = xw->xw_nnodes++;
+    xn = &xw->xw_nodes[*ip];
+    memset(xn, 0, sizeof(*xn));
+    xn->xn_type = type;
+    xn->xn_value = XBIN_NONE;
+    if (xbin_name_add(xw, name, &xn->xn_name) < 0)
+        return -1;
+    if (xbin_name_add(xw, prefix, &xn->xn_prefix) < 0)
+        return -1;
+    return 0;
+}
+
+static int xbin_encode(struct xbin_writer *xw, cxobj *x);
+
+/*! Encode children of marked or ancestor node, see xml2cbuf_marked_children
+ *
+ * @param[in]  xw   Encoder state
+ * @param[in]  x    XML parent node
+ * @retval     n    Number of encoded children
+ * @retval    -1    Error
+ */
+static int
+xbin_encode_marked_children(struct xbin_writer *xw,
+                            cxobj              *x)
+{
+    yang_stmt *y;
+    cxobj     *xc;
+    int        all;
+    int        childnr = 0;
+    int        ret;
+
+    y = xml_spec(x);
+    all = xml_flag(x, XML_FLAG_MARK);
+    xc = NULL;
+    while ((xc = xml_child_each(x, xc, CX_ELMNT)) != NULL){
+        if (all ||
+            (y != NULL && yang_keyword_get(y) == Y_LIST &&
+             xml_flag(xc, XML_FLAG_MARK|XML_FLAG_CHANGE) == 0 &&
+             yang_key_match(y, xml_name(xc), NULL) == 1)){
+            xw->xw_marked = 0;
+            ret = xbin_encode(xw, xc);
+            xw->xw_marked = 1;
+        }
+        else
+            ret = xbin_encode(xw, xc);
+        if (ret < 0)
+            return -1;
+        childnr += ret;
+    }
+    return childnr;
+}
+
+/*! Encode XML node and its children as node records
+ *
+ * @param[in]  xw   Encoder state
+ * @param[in]  x    XML node
+ * @retval     1    Added
+ * @retval     0    Skipped
+ * @retval    -1    Error
+ */
+static int
+xbin_encode(struct xbin_writer *xw,
+            cxobj              *x)
+{
+    int               retval = -1;
+    yang_stmt        *y;
+    cxobj            *xc;
+    char             *val;
+    size_t            i;
+    uint32_t          childnr = 0;
+    uint32_t          id;
+    int               exist;
+    int               ret;
+
+    if (xw->xw_marked){
+        if (xml_flag(x, XML_FLAG_MARK)){
+            xw->xw_marked = 0;
+            ret = xbin_encode(xw, x);
+            xw->xw_marked = 1;
+            return ret;
+        }
+        if (xml_flag(x, XML_FLAG_CHANGE) == 0)
+            goto skip;
+    }
+    if ((y = xml_spec(x)) != NULL){
+        if (xw->xw_system_only){
+            exist = 0;
+            if (yang_extension_value(y, "system-only-config", CLIXON_LIB_NS, &exist, NULL) < 0)
+                goto done;
+            if (exist)
+                goto skip;
+        }
+        if ((ret = xml2output_wdef(x, xw->xw_wdef, NULL)) < 0)
+            goto done;
+        if (ret == 0)
+            goto skip;
+    }
+    if ((val = xml_value(x)) == NULL && xml_type(x) == CX_BODY) /* incomplete tree */
+        goto skip;
+    if (xbin_node_add(xw, xml_type(x), xml_name(x), xml_prefix(x), &i) < 0)
+        goto done;
+    switch (xml_type(x)){
+    case CX_ELMNT:
+        if (y != NULL){
+            if (xbin_yang_id(xw, y, xml_parent(x), &id) < 0)
+                goto done;
+            xw->xw_nodes[i].xn_value = id;
+        }
+        xc = NULL;
+        if (xw->xw_marked){
+            xw->xw_marked = 0;
+            while ((xc = xml_child_each(x, xc, CX_ATTR)) != NULL) {
+                if ((ret = xbin_encode(xw, xc)) < 0)
+                    goto done;
+                childnr += ret;
+            }
+            xw->xw_marked = 1;
+            if ((ret = xbin_encode_marked_children(xw, x)) < 0)
+                goto done;
+            childnr += ret;
+        }
+        else
+            while ((xc = xml_child_each(x, xc, -1)) != NULL) {
+                if ((ret = xbin_encode(xw, xc)) < 0)
+                    goto done;
+                childnr += ret;
+            }
+        xw->xw_nodes[i].xn_childnr = childnr; /* xn may be reallocated */
+        break;
+    default:
+        if (xbin_heap_add(xw, val?val:"", &id) < 0)
+            goto done;
+        xw->xw_nodes[i].xn_value = id;
+        break;
+    }
+    retval = 1;
+ done:
+    return retval;
+ skip:
+    retval = 0;
+    goto done;
+}
+
+/*! Initialize encoder state
+ *
+ * @param[out] xw          Encoder state, free with xbin_writer_free
+ * @param[in]  wdef        With-defaults parameter, see xml2output_wdef
+ * @param[in]  system_only Enable checks for system-only-config extension
+ * @retval     0           OK
+ * @retval    -1           Error
+ */
+static int
+xbin_writer_init(struct xbin_writer *xw,
+                 withdefaults_type   wdef,
+                 int                 system_only)
+{
+    memset(xw, 0, sizeof(*xw));
+    xw->xw_wdef = wdef;
+    xw->xw_system_only = system_only;
+    if ((xw->xw_names = clicon_hash_init()) == NULL)
+        return -1;
+    if ((xw->xw_yids = clicon_hash_init()) == NULL)
+        return -1;
+    return 0;
+}
+
+/*! Free encoder state
+ *
+ * @param[in]  xw   Encoder state
+ */
+static void
+xbin_writer_free(struct xbin_writer *xw)
+{
+    if (xw->xw_names)
+        clicon_hash_free(xw->xw_names);
+    if (xw->xw_yids)
+        clicon_hash_free(xw->xw_yids);
+    if (xw->xw_nodes)
+        free(xw->xw_nodes);
+    if (xw->xw_yang)
+        free(xw->xw_yang);
+    if (xw->xw_heap)
+        free(xw->xw_heap);
+}
+
+/*! Fill in header of encoded tree
+ *
+ * @param[in]  xw    Encoder state
+ * @param[in]  yspec Yang spec XML tree is bound to, for schema id
+ * @param[out] xh    Header
+ */
+static void
+xbin_header_set(struct xbin_writer *xw,
+                yang_stmt          *yspec,
+                struct xbin_header *xh)
+{
+    memset(xh, 0, sizeof(*xh));
+    memcpy(xh->xh_magic, XBIN_MAGIC, sizeof(xh->xh_magic));
+    xh->xh_version = XBIN_VERSION;
+    xh->xh_bom = XBIN_BOM;
+    xh->xh_schema = yspec ? xbin_schema_id(yspec) : 0;
+    xh->xh_nyang = xw->xw_nyang;
+    xh->xh_nnodes = xw->xw_nnodes;
+    xh->xh_heaplen = xw->xw_heaplen;
+}
+
+/*! Write XML tree in binary datastore format to file
+ *
+ * @param[in]  f           Output file
+ * @param[in]  xn          XML tree, eg datastore top <config>
+ * @param[in]  yspec       Yang spec XML tree is bound to, for schema id
+ * @param[in]  wdef        With-defaults parameter, see xml2output_wdef
+ * @param[in]  system_only Enable checks for system-only-config extension
+ * @retval     0           OK
+ * @retval    -1           Error
+ * @see clixon_bin_parse_file
+ */
+int
+clixon_xml2bin_file(FILE             *f,
+                    cxobj            *xn,
+                    yang_stmt        *yspec,
+                    withdefaults_type wdef,
+                    int               system_only)
+{
+    int                retval = -1;
+    struct xbin_writer xw;
+    struct xbin_header xh;
+
+    if (xbin_writer_init(&xw, wdef, system_only) < 0)
+        goto done;
+    if (xn && xbin_encode(&xw, xn) < 0)
+        goto done;
+    xbin_header_set(&xw, yspec, &xh);
+    if (fwrite(&xh, sizeof(xh), 1, f) != 1 ||
+        (xw.xw_nyang &&
+         fwrite(xw.xw_yang, sizeof(*xw.xw_yang), xw.xw_nyang, f) != xw.xw_nyang) ||
+        (xw.xw_nnodes &&
+         fwrite(xw.xw_nodes, sizeof(*xw.xw_nodes), xw.xw_nnodes, f) != xw.xw_nnodes) ||
+        (xw.xw_heaplen &&
+         fwrite(xw.xw_heap, 1, xw.xw_heaplen, f) != xw.xw_heaplen)){
+        clixon_err(OE_UNIX, errno, "fwrite");
+        goto done;
+    }
+    retval = 0;
+ done:
+    xbin_writer_free(&xw);
+    return retval;
+}
+
+/*! Write rpc-reply with data in binary format to cligen buffer
+ *
+ * Encodes <rpc-reply xmlns="base"><data>...</data></rpc-reply> where the children of
+ * data are the children of xn, as printed by clixon_xml2cbuf1 or clixon_xml2cbuf_marked
+ * with skiptop. Used for replies on the internal socket instead of printing XML, so that
+ * the client can read the reply without parsing and binding it.
+ * @param[in]  cb      Cligen buffer, data is appended and may contain NULL chars
+ * @param[in]  xn      XML tree, eg datastore top, or NULL for no data
+ * @param[in]  yspec   Yang spec XML tree is bound to, for schema id
+ * @param[in]  wdef    With-defaults parameter, see xml2output_wdef
+ * @param[in]  marked  0: Whole tree, 1: Only marked parts, see clixon_xml2cbuf_marked
+ * @retval     0       OK
+ * @retval    -1       Error
+ * @see clixon_bin_parse_buf
+ * @see CLIXON_BIN_CAPABILITY
+ */
+int
+clixon_xml2bin_reply(cbuf             *cb,
+                     cxobj            *xn,
+                     yang_stmt        *yspec,
+                     withdefaults_type wdef,
+                     int               marked)
+{
+    int                retval = -1;
+    struct xbin_writer xw;
+    struct xbin_header xh;
+    size_t             ireply;
+    size_t             idata;
+    size_t             i;
+    cxobj             *xc;
+    uint32_t           childnr = 0;
+    int                ret;
+
+    if (xbin_writer_init(&xw, wdef, 0) < 0)
+        goto done;
+    if (xbin_node_add(&xw, CX_ELMNT, "rpc-reply", NULL, &ireply) < 0)
+        goto done;
+    if (xbin_node_add(&xw, CX_ATTR, "xmlns", NULL, &i) < 0)
+        goto done;
+    if (xbin_name_add(&xw, NETCONF_BASE_NAMESPACE, &xw.xw_nodes[i].xn_value) < 0)
+        goto done;
+    if (xbin_node_add(&xw, CX_ELMNT, NETCONF_OUTPUT_DATA, NULL, &idata) < 0)
+        goto done;
+    xw.xw_nodes[ireply].xn_childnr = 2;
+    if (xn != NULL){
+        if (marked){
+            if (xml_flag(xn, XML_FLAG_MARK|XML_FLAG_CHANGE) != 0){
+                xw.xw_marked = 1;
+                if ((ret = xbin_encode_marked_children(&xw, xn)) < 0)
+                    goto done;
+                childnr = ret;
+            }
+        }
+        else {
+            xc = NULL;
+            while ((xc = xml_child_each(xn, xc, -1)) != NULL) {
+                if ((ret = xbin_encode(&xw, xc)) < 0)
+                    goto done;
+                childnr += ret;
+            }
+        }
+    }
+    xw.xw_nodes[idata].xn_childnr = childnr;
+    xbin_header_set(&xw, yspec, &xh);
+    if (cbuf_append_buf(cb, &xh, sizeof(xh)) < 0 ||
+        (xw.xw_nyang &&
+         cbuf_append_buf(cb, xw.xw_yang, xw.xw_nyang*sizeof(*xw.xw_yang)) < 0) ||
+        cbuf_append_buf(cb, xw.xw_nodes, xw.xw_nnodes*sizeof(*xw.xw_nodes)) < 0 ||
+        cbuf_append_buf(cb, xw.xw_heap, xw.xw_heaplen) < 0){
+        clixon_err(OE_UNIX, errno, "cbuf_append_buf");
+        goto done;
+    }
+    retval = 0;
+ done:
+    xbin_writer_free(&xw);
+    return retval;
+}
+
+/*! Check if buffer starts with binary format magic
+ *
+ * XML text does not start with the magic, so a message can be checked before parsing
+ * @param[in]  buf   Buffer
+ * @param[in]  len   Length of buffer
+ * @retval     1     Binary format
+ * @retval     0     Not binary format, eg XML
+ */
+int
+clixon_bin_magic(const char *buf,
+                 size_t      len)
+{
+    return len >= sizeof(struct xbin_header) &&
+        memcmp(buf, XBIN_MAGIC, strlen(XBIN_MAGIC)) == 0;
+}
+
+/*! Get string from heap offset
+ *
+ * @param[in]  xr   Decoder state
+ * @param[in]  off  Heap offset or XBIN_NONE
+ * @param[out] str  String, or NULL if XBIN_NONE
+ * @retval     0    OK
+ * @retval    -1    Error, offset out of range
+ */
+static int
+xbin_str(struct xbin_reader *xr,
+         uint32_t            off,
+         const char        **str)
+{
+    if (off == XBIN_NONE){
+        *str = NULL;
+        return 0;
+    }
+    if (off >= xr->xr_heaplen){
+        clixon_err(OE_XML, EINVAL, "Binary format: string offset %u out of range", off);
+        return -1;
+    }
+    *str = xr->xr_heap + off;
+    return 0;
+}
+
+/*! Resolve yang table entries to yang nodes
+ *
+ * @param[in]  xr    Decoder state
+ * @param[in]  yspec Yang spec
+ * @retval     1     All entries resolved, xr_yvec set
+ * @retval     0     At least one entry does not match yang spec
+ * @retval    -1     Error
+ */
+static int
+xbin_yang_resolve(struct xbin_reader *xr,
+                  yang_stmt          *yspec)
+{
+    struct xbin_yang *xy;
+    yang_stmt        *ymod;
+    yang_stmt        *y;
+    const char       *name;
+    const char       *ns;
+    const char       *nsy;
+    uint32_t          i;
+
+    for (i=0; i<xr->xr_nyang; i++){
+        xy = &xr->xr_yang[i];
+        if (xbin_str(xr, xy->xy_name, &name) < 0 ||
+            xbin_str(xr, xy->xy_ns, &ns) < 0)
+            return -1;
+        if (name == NULL || ns == NULL)
+            return 0;
+        if (xy->xy_parent == XBIN_NONE){
+            if ((ymod = yang_find_module_by_namespace(yspec, ns)) == NULL)
+                return 0;
+            y = yang_find_schemanode(ymod, name);
+        }
+        else if (xy->xy_parent < i)
+            y = yang_find_datanode_ns(xr->xr_yvec[xy->xy_parent], name, ns);
+        else
+            return 0;
+        if (y == NULL ||
+            yang_keyword_get(y) != xy->xy_keyword ||
+            (nsy = yang_find_mynamespace(y)) == NULL ||
+            strcmp(ns, nsy) != 0)
+            return 0;
+        xr->xr_yvec[i] = y;
+    }
+    return 1;
+}
+
+/*! Create XML node and its children from node records
+ *
+ * @param[in]     xr    Decoder state
+ * @param[in,out] i     Index of node record, incremented past node and its children
+ * @param[in]     xp    XML parent
+ * @param[in]     depth Tree depth
+ * @retval        0     OK
+ * @retval       -1     Error
+ */
+static int
+xbin_decode(struct xbin_reader *xr,
+            uint64_t           *i,
+            cxobj              *xp,
+            int                 depth)
+{
+    int               retval = -1;
+    struct xbin_node *xn;
+    cxobj            *x;
+    const char       *name;
+    const char       *prefix;
+    const char       *val;
+    yang_stmt        *y = NULL;
+    uint32_t          k;
+
+    if (*i >= xr->xr_nnodes){
+        clixon_err(OE_XML, EINVAL, "Binary format: node record %" PRIu64 " out of range", *i);
+        goto done;
+    }
+    if (depth > XBIN_DEPTH_MAX){
+        clixon_err(OE_XML, EINVAL, "Binary format: max depth %d exceeded", XBIN_DEPTH_MAX);
+        goto done;
+    }
+    xn = &xr->xr_nodes[(*i)++];
+    if (xbin_str(xr, xn->xn_name, &name) < 0 ||
+        xbin_str(xr, xn->xn_prefix, &prefix) < 0)
+        goto done;
+    if (name == NULL){
+        clixon_err(OE_XML, EINVAL, "Binary format: node without name");
+        goto done;
+    }
+    switch (xn->xn_type){
+    case CX_ELMNT:
+        if ((x = xml_new(name, xp, CX_ELMNT)) == NULL)
+            goto done;
+        if (prefix && xml_prefix_set(x, prefix) < 0)
+            goto done;
+        if (xr->xr_yvec && xn->xn_value != XBIN_NONE){
+            if (xn->xn_value >= xr->xr_nyang){
+                clixon_err(OE_XML, EINVAL, "Binary format: yang index %u out of range", xn->xn_value);
+                goto done;
+            }
+            y = xr->xr_yvec[xn->xn_value];
+            xml_spec_set(x, y);
+        }
+        for (k=0; k<xn->xn_childnr; k++)
+            if (xbin_decode(xr, i, x, depth+1) < 0)
+                goto done;
+        if (y != NULL){
+#ifdef XML_EXPLICIT_INDEX
+            if (xml_search_index_p(x) && xml_search_child_insert(xp, x) < 0)
+                goto done;
+#endif
+#ifdef XML_BIND_CV_CACHE
+            if (xml_cv_bind(x) < 0)
+                goto done;
+#endif
+        }
+        break;
+    case CX_ATTR:
+    case CX_BODY:
+        if (xbin_str(xr, xn->xn_value, &val) < 0)
+            goto done;
+        if ((x = xml_new(name, xp, xn->xn_type)) == NULL)
+            goto done;
+        if (prefix && xml_prefix_set(x, prefix) < 0)
+            goto done;
+        if (val && xml_value_set(x, val) < 0)
+            goto done;
+        break;
+    default:
+        clixon_err(OE_XML, EINVAL, "Binary format: invalid node type %d", xn->xn_type);
+        goto done;
+        break;
+    }
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Read XML tree in binary datastore format from memory buffer
+ *
+ * XML nodes are created directly from node records.
+ * If yspec is given, the buffer was written with the same yang modules and all yang nodes
+ * are found, the tree is bound to yang. It is then also sorted, since it was sorted when
+ * written.
+ * @param[in]     buf    Buffer as written by clixon_xml2bin_file
+ * @param[in]     len    Length of buffer
+ * @param[in]     yspec  Yang spec to bind to, or NULL for no binding
+ * @param[in,out] xt     XML tree. If NULL, a top node is created, free with xml_free
+ * @param[out]    bound  1: tree is bound to yang and sorted, 0: not bound
+ * @retval        0      OK
+ * @retval       -1      Error
+ * @see clixon_bin_parse_file
+ * @note An empty buffer is read as an empty tree
+ */
+int
+clixon_bin_parse_buf(const char *buf,
+                     size_t      len,
+                     yang_stmt  *yspec,
+                     cxobj     **xt,
+                     int        *bound)
+{
+    int                       retval = -1;
+    struct xbin_reader        xr = {0,};
+    const struct xbin_header *xh;
+    cxobj                    *xtop = NULL;
+    uint64_t                  i;
+    int                       ret;
+
+    *bound = 0;
+    if (*xt == NULL){
+        if ((xtop = xml_new(XML_TOP_SYMBOL, NULL, CX_ELMNT)) == NULL)
+            goto done;
+    }
+    else
+        xtop = *xt;
+    if (len == 0){
+        *bound = (yspec != NULL);
+        goto ok;
+    }
+    if (len < sizeof(*xh)){
+        clixon_err(OE_XML, EINVAL, "Binary format: file too short");
+        goto done;
+    }
+    xh = (const struct xbin_header *)buf;
+    if (memcmp(xh->xh_magic, XBIN_MAGIC, sizeof(xh->xh_magic)) != 0){
+        clixon_err(OE_XML, EINVAL, "Binary format: bad magic, not a binary datastore");
+        goto done;
+    }
+    if (xh->xh_bom != XBIN_BOM){
+        clixon_err(OE_XML, EINVAL, "Binary format: written with other byte order");
+        goto done;
+    }
+    if (xh->xh_version != XBIN_VERSION){
+        clixon_err(OE_XML, EINVAL, "Binary format: version %u not supported", xh->xh_version);
+        goto done;
+    }
+    len -= sizeof(*xh);
+    if (xh->xh_nnodes > len/sizeof(struct xbin_node) ||
+        xh->xh_heaplen > len ||
+        xh->xh_nyang*sizeof(struct xbin_yang) + xh->xh_nnodes*sizeof(struct xbin_node) +
+        xh->xh_heaplen != len ||
+        (xh->xh_heaplen && buf[sizeof(*xh) + len - 1] != '\0')){
+        clixon_err(OE_XML, EINVAL, "Binary format: file size does not match header");
+        goto done;
+    }
+    xr.xr_nyang = xh->xh_nyang;
+    xr.xr_yang = (struct xbin_yang *)(xh + 1);
+    xr.xr_nnodes = xh->xh_nnodes;
+    xr.xr_nodes = (struct xbin_node *)(xr.xr_yang + xr.xr_nyang);
+    xr.xr_heaplen = xh->xh_heaplen;
+    xr.xr_heap = (const char *)(xr.xr_nodes + xr.xr_nnodes);
+    if (yspec && xh->xh_schema == xbin_schema_id(yspec)){
+        if ((xr.xr_yvec = calloc(xr.xr_nyang + 1, sizeof(yang_stmt *))) == NULL){
+            clixon_err(OE_UNIX, errno, "calloc");
+            goto done;
+        }
+        if ((ret = xbin_yang_resolve(&xr, yspec)) < 0)
+            goto done;
+        if (ret == 0){
+            clixon_debug(CLIXON_DBG_DATASTORE, "Binary format: yang mismatch, not bound on load");
+            free(xr.xr_yvec);
+            xr.xr_yvec = NULL;
+        }
+    }
+    i = 0;
+    while (i < xr.xr_nnodes)
+        if (xbin_decode(&xr, &i, xtop, 0) < 0)
+            goto done;
+    *bound = (xr.xr_yvec != NULL);
+ ok:
+    *xt = xtop;
+    xtop = NULL;
+    retval = 0;
+ done:
+    if (xr.xr_yvec)
+        free(xr.xr_yvec);
+    if (xtop && *xt == NULL)
+        xml_free(xtop);
+    return retval;
+}
+
+/*! Read XML tree in binary datastore format from file
+ *
+ * The file is memory-mapped and read with clixon_bin_parse_buf
+ * @param[in]  fp     Input file
+ * @param[in]  yspec  Yang spec to bind to, or NULL for no binding
+ * @param[out] xt     XML top of tree, on the form <top><config>..., free with xml_free
+ * @param[out] bound  1: tree is bound to yang and sorted, 0: not bound
+ * @retval     0      OK
+ * @retval    -1      Error
+ * @see clixon_xml2bin_file
+ */
+int
+clixon_bin_parse_file(FILE       *fp,
+                      yang_stmt  *yspec,
+                      cxobj     **xt,
+                      int        *bound)
+{
+    int         retval = -1;
+    struct stat st;
+    void       *map = MAP_FAILED;
+
+    *bound = 0;
+    *xt = NULL;
+    if (fstat(fileno(fp), &st) < 0){
+        clixon_err(OE_UNIX, errno, "fstat");
+        goto done;
+    }
+    if (st.st_size > 0 &&
+        (map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fileno(fp), 0)) == MAP_FAILED){
+        clixon_err(OE_UNIX, errno, "mmap");
+        goto done;
+    }
+    if (clixon_bin_parse_buf(map != MAP_FAILED?map:"", st.st_size, yspec, xt, bound) < 0)
+        goto done;
+    retval = 0;
+ done:
+    if (map != MAP_FAILED)
+        munmap(map, st.st_size);
+    return retval;
+}
@@ -66,6 +66,7 @@
 #include "clixon_xml.h"
 #include "clixon_log.h"
 #include "clixon_debug.h"
+#include "clixon_trace.h"
 #include "clixon_err.h"
 #include "clixon_options.h"
 #include "clixon_data.h"
@@ -197,7 +198,7 @@ populate_self_parent(clixon_handle h,
         goto done;
     /* Special case since action is not a datanode */
     if ((y = yang_find(yparent, Y_ACTION, name)) == NULL){
-        if (h && clicon_option_bool(h, "CLICON_YANG_SCHEMA_MOUNT")){
+        if (h && clicon_option_bool_id(h, CO_YANG_SCHEMA_MOUNT)){
             if (yang_schema_mount_point(yparent)){
                 yspec1 = NULL;
                 if ((ret = yang_mount_get_yspec_any(yparent, &yspec1)) < 0)
@@ -492,10 +493,12 @@ xml_bind_yang_mnt(clixon_handle h,
                   int           skip_mnt,
                   cxobj       **xerr)
 {
-    int    retval = -1;
-    cxobj *xc;         /* xml child */
-    int    ret;
+    int            retval = -1;
+    cxobj         *xc;         /* xml child */
+    clixon_trace_t tr;
+    int            ret;
 
+    tr = clixon_trace_begin(CLIXON_DBG_XML);
     strip_body_objects(xt);
     if (jsonenc){
         if ((ret = translate_jsonenc_xml(xt, yspec, xerr)) < 0)
@@ -514,6 +517,7 @@ xml_bind_yang_mnt(clixon_handle h,
     }
     retval = 1;
  done:
+    clixon_trace_end(tr, CLIXON_DBG_XML, "xml_bind_yang", NULL);
     return retval;
  fail:
     retval = 0;
@@ -529,6 +533,7 @@ xml_bind_yang_mnt(clixon_handle h,
  * @param[in]   xsibling
  * @param[in]   jsonenc JSON encoding according to RFC7951, prefixes are module-names
  * @param[in]   skip_mnt If set, do not proceed binding across mount-points
+ * @param[in]   sort   If set, also sort children of each node after binding them
  * @param[out]  xerr   Reason for failure, or NULL
  * @retval      1      OK yang assignment made
  * @retval      0      Partial or no yang assigment made (at least one failed) and xerr set
@@ -542,6 +547,7 @@ xml_bind_yang0_opt(clixon_handle h,
                    cxobj        *xsibling,
                    int           jsonenc,
                    int           skip_mnt,
+                   int           sort,
                    cxobj       **xerr)
 {
     int        retval = -1;
@@ -581,17 +587,17 @@ xml_bind_yang0_opt(clixon_handle h,
         goto fail;
     }
     else if (ret == 2)     /* ret=2 for anyxml from parent^ */
-        goto ok;
+        goto unbound;
     strip_body_objects(xt);
     ybc = YB_PARENT;
-    if (h && clicon_option_bool(h, "CLICON_YANG_SCHEMA_MOUNT") &&
+    if (h && clicon_option_bool_id(h, CO_YANG_SCHEMA_MOUNT) &&
         xml_schema_mount_point(xt)){
         if ((ret = yang_schema_mount_yspec(h, xt, skip_mnt, &ybc, &yspec, xerr)) < 0)
             goto done;
         if (ret == 0)
-            goto ok;
+            goto unbound;
         if (skip_mnt)
-            goto ok;
+            goto unbound;
     }
     xc = NULL;     /* Apply on children */
     while ((xc = xml_child_each(xt, xc, CX_ELMNT)) != NULL) {
@@ -602,15 +608,15 @@ xml_bind_yang0_opt(clixon_handle h,
         if (yc0 != NULL &&
             clicon_strcmp(name0, name) == 0 &&
             clicon_strcmp(prefix0, prefix) == 0){
-            if ((ret = xml_bind_yang0_opt(h, xc, ybc, yspec, xc0, jsonenc, skip_mnt, xerr)) < 0)
+            if ((ret = xml_bind_yang0_opt(h, xc, ybc, yspec, xc0, jsonenc, skip_mnt, sort, xerr)) < 0)
                 goto done;
         }
         else if (xsibling &&
                  (xs = xml_find_type(xsibling, prefix, name, CX_ELMNT)) != NULL){
-            if ((ret = xml_bind_yang0_opt(h, xc, ybc, yspec, xs, jsonenc, skip_mnt, xerr)) < 0)
+            if ((ret = xml_bind_yang0_opt(h, xc, ybc, yspec, xs, jsonenc, skip_mnt, sort, xerr)) < 0)
                 goto done;
         }
-        else if ((ret = xml_bind_yang0_opt(h, xc, ybc, yspec, NULL, jsonenc, skip_mnt, xerr)) < 0)
+        else if ((ret = xml_bind_yang0_opt(h, xc, ybc, yspec, NULL, jsonenc, skip_mnt, sort, xerr)) < 0)
             goto done;
         if (ret == 0)
             goto fail;
@@ -619,6 +625,8 @@ xml_bind_yang0_opt(clixon_handle h,
         name0 = xml_name(xc);
         prefix0 = xml_prefix(xc);
     }
+    if (sort && xml_sort_children(xt) < 0)
+        goto done;
  ok:
     retval = 1;
  done:
@@ -626,6 +634,10 @@ xml_bind_yang0_opt(clixon_handle h,
  fail:
     retval = 0;
     goto done;
+ unbound: /* Children not bound, sort as after parsing */
+    if (sort && xml_sort_recurse(xt) < 0)
+        goto done;
+    goto ok;
 }
 
 /*! Find yang spec association of tree of XML nodes
@@ -636,21 +648,22 @@ xml_bind_yang0_opt(clixon_handle h,
  * @param[in]   yspec  Yang spec
  * @param[in]   jsonenc JSON encoding according to RFC7951, prefixes are module-names
  * @param[in]   skip_mnt If set, do not proceed binding across mount-points
+ * @param[in]   sort   If set, also sort children of each node after binding them
  * @param[out]  xerr   Reason for failure, or NULL (call xml_free() after use)
  * @retval      1      OK yang assignment made
  * @retval      0      Partial or no yang assigment made (at least one failed) and xerr set
  * @retval     -1      Error
- * Populate xt as top-level node
- * @see xml_bind_yang  If only children of xt should be populated, not xt itself
+ * @see xml_bind_yang0
  */
-int
-xml_bind_yang0(clixon_handle h,
-               cxobj        *xt,
-               yang_bind     yb,
-               yang_stmt    *yspec,
-               int           jsonenc,
-               int           skip_mnt,
-               cxobj       **xerr)
+static int
+xml_bind_yang0_sort1(clixon_handle h,
+                     cxobj        *xt,
+                     yang_bind     yb,
+                     yang_stmt    *yspec,
+                     int           jsonenc,
+                     int           skip_mnt,
+                     int           sort,
+                     cxobj       **xerr)
 {
     int        retval = -1;
     cxobj     *xc;           /* xml child */
@@ -684,26 +697,32 @@ xml_bind_yang0(clixon_handle h,
         goto fail;
     }
     else if (ret == 2)     /* ret=2 for anyxml from parent^ */
-        goto ok;
+        goto unbound;
     strip_body_objects(xt);
-    if (h && clicon_option_bool(h, "CLICON_YANG_SCHEMA_MOUNT")&&
+    if (h && clicon_option_bool_id(h, CO_YANG_SCHEMA_MOUNT)&&
         xml_schema_mount_point(xt)){
         if ((ret = yang_schema_mount_yspec(h, xt, skip_mnt,
                                            NULL, // &ybc,
                                            &yspec, xerr)) < 0)
             goto done;
         if (ret == 0)
-            goto ok;
+            goto unbound;
         if (skip_mnt)
-            goto ok;
+            goto unbound;
     }
     xc = NULL;     /* Apply on children */
     while ((xc = xml_child_each(xt, xc, CX_ELMNT)) != NULL) {
-        if ((ret = xml_bind_yang0_opt(h, xc, YB_PARENT, yspec, NULL, jsonenc, skip_mnt, xerr)) < 0)
+        if ((ret = xml_bind_yang0_opt(h, xc, YB_PARENT, yspec, NULL, jsonenc, skip_mnt, sort, xerr)) < 0)
             goto done;
         if (ret == 0)
             goto fail;
     }
+    if (sort && xml_sort_children(xt) < 0)
+        goto done;
+#ifdef XML_BIND_CV_CACHE
+    if (xml_cv_bind(xt) < 0)
+        goto done;
+#endif
  ok:
     retval = 1;
  done:
@@ -711,6 +730,62 @@ xml_bind_yang0(clixon_handle h,
  fail:
     retval = 0;
     goto done;
+ unbound: /* Children not bound, sort as after parsing */
+    if (sort && xml_sort_recurse(xt) < 0)
+        goto done;
+    goto ok;
+}
+
+/*! Find yang spec association of tree of XML nodes
+ *
+ * @param[in]   h      Clixon handle (sometimes NULL)
+ * @param[in]   xt     XML tree node
+ * @param[in]   yb     How to bind yang to XML top-level when parsing
+ * @param[in]   yspec  Yang spec
+ * @param[in]   jsonenc JSON encoding according to RFC7951, prefixes are module-names
+ * @param[in]   skip_mnt If set, do not proceed binding across mount-points
+ * @param[out]  xerr   Reason for failure, or NULL (call xml_free() after use)
+ * @retval      1      OK yang assignment made
+ * @retval      0      Partial or no yang assigment made (at least one failed) and xerr set
+ * @retval     -1      Error
+ * Populate xt as top-level node
+ * @see xml_bind_yang  If only children of xt should be populated, not xt itself
+ */
+int
+xml_bind_yang0(clixon_handle h,
+               cxobj        *xt,
+               yang_bind     yb,
+               yang_stmt    *yspec,
+               int           jsonenc,
+               int           skip_mnt,
+               cxobj       **xerr)
+{
+    return xml_bind_yang0_sort1(h, xt, yb, yspec, jsonenc, skip_mnt, 0, xerr);
+}
+
+/*! Find yang spec association of tree of XML nodes and sort it in the same traversal
+ *
+ * Same as xml_bind_yang0 followed by xml_sort_recurse, except that the parent of xt
+ * is not sorted, but in one traversal of the tree instead of two.
+ * Children of each node are sorted after they are bound, and only if not already sorted.
+ * @param[in]   h      Clixon handle (sometimes NULL)
+ * @param[in]   xt     XML tree node
+ * @param[in]   yb     How to bind yang to XML top-level when parsing
+ * @param[in]   yspec  Yang spec
+ * @param[out]  xerr   Reason for failure, or NULL (call xml_free() after use)
+ * @retval      1      OK yang assignment made
+ * @retval      0      Partial or no yang assigment made (at least one failed) and xerr set
+ * @retval     -1      Error
+ * @see _xml_parse
+ */
+int
+xml_bind_yang0_sort(clixon_handle h,
+                    cxobj        *xt,
+                    yang_bind     yb,
+                    yang_stmt    *yspec,
+                    cxobj       **xerr)
+{
+    return xml_bind_yang0_sort1(h, xt, yb, yspec, 0, 0, 1, xerr);
 }
 
 /*! RPC-specific
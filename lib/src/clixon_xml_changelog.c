@@ -79,12 +79,62 @@
 #include "clixon_xpath_ctx.h"
 #include "clixon_xpath.h"
 
+/*! Changelog step operation
+ */
+enum changelog_opcode{
+    CL_SKIP,    /* No op or no where: step is skipped */
+    CL_RENAME,
+    CL_REPLACE,
+    CL_INSERT,
+    CL_DELETE,
+    CL_MOVE,
+    CL_UNKNOWN, /* Error if there is a target */
+};
+
+/*! Compiled changelog step
+ *
+ * XPaths are parsed and the namespace context is computed once, when the changelog is
+ * first applied.
+ */
+struct changelog_step{
+    enum changelog_opcode cs_op;
+    char                 *cs_opstr;  /* Operation as in changelog */
+    xpath_tree           *cs_where;  /* Target nodes */
+    xpath_tree           *cs_when;   /* Condition evaluated on each target, or NULL */
+    xpath_tree           *cs_tag;    /* rename: new name evaluated on each target, or NULL */
+    xpath_tree           *cs_dst;    /* move: destination, or NULL */
+    cxobj                *cs_new;    /* insert, replace: new XML, or NULL */
+    cvec                 *cs_nsc;    /* Namespace context of step */
+};
+
+/*! Changelog of a namespace and revision interval
+ */
+struct changelog{
+    struct changelog      *cl_next;  /* Next changelog of same namespace, in changelog order */
+    cxobj                 *cl_xch;   /* Changelog XML */
+    uint32_t               cl_from;  /* revfrom on the form YYYYMMDD, or 0 */
+    uint32_t               cl_to;    /* revision on the form YYYYMMDD, or 0 */
+    struct changelog_step *cl_steps; /* Compiled steps, or NULL if not compiled */
+    int                    cl_len;   /* Number of steps */
+};
+
+/*! Changelogs indexed by namespace
+ *
+ * Built from the changelog XML on first upgrade, see changelog_index_get
+ */
+struct changelog_index{
+    cxobj                 *ci_xchlog; /* Changelog XML the index is built from */
+    clicon_hash_t         *ci_ns;     /* Namespace -> first struct changelog */
+    struct changelog      *ci_vec;    /* All changelogs */
+    int                    ci_len;
+};
+
 static int
 changelog_rename(clixon_handle h,
                  cxobj        *xt,
                  cxobj        *xw,
                  cvec         *nsc,
-                 char         *tag)
+                 xpath_tree   *tag)
 {
     int     retval = -1;
     xp_ctx *xctx = NULL;
@@ -94,7 +144,7 @@ changelog_rename(clixon_handle h,
         clixon_err(OE_XML, 0, "tag required");
         goto done;
     }
-    if (xpath_vec_ctx(xw, nsc, tag, 0, &xctx) < 0)
+    if (xpath_tree_ctx(xw, nsc, tag, 0, &xctx) < 0)
         goto done;
     if (ctx2string(xctx, &str) < 0)
         goto done;
@@ -201,12 +251,13 @@ changelog_move(clixon_handle h,
                cxobj        *xt,
                cxobj        *xw,
                cvec         *nsc,
-               char         *dst)
+               xpath_tree   *dst)
 {
     int    retval = -1;
-    cxobj *xp;       /* destination parent node */
+    cxobj *xp = NULL; /* destination parent node */
 
-    if ((xp = xpath_first(xt, nsc, "%s", dst)) == NULL){
+    if (dst == NULL ||
+        (xp = xpath_first_tree(xt, nsc, dst)) == NULL){
         clixon_err(OE_XML, 0, "path required");
         goto done;
     }
@@ -217,57 +268,138 @@ changelog_move(clixon_handle h,
     return retval;
 }
 
-/*! Perform a changelog operation
+/*! Free compiled changelog steps
+ */
+static void
+changelog_steps_free(struct changelog *cl)
+{
+    struct changelog_step *cs;
+    int                    i;
+
+    for (i=0; i<cl->cl_len; i++){
+        cs = &cl->cl_steps[i];
+        if (cs->cs_where)
+            xpath_tree_free(cs->cs_where);
+        if (cs->cs_when)
+            xpath_tree_free(cs->cs_when);
+        if (cs->cs_tag)
+            xpath_tree_free(cs->cs_tag);
+        if (cs->cs_dst)
+            xpath_tree_free(cs->cs_dst);
+        if (cs->cs_nsc)
+            xml_nsctx_free(cs->cs_nsc);
+    }
+    if (cl->cl_steps)
+        free(cl->cl_steps);
+    cl->cl_steps = NULL;
+    cl->cl_len = 0;
+}
+
+/*! Compile the steps of a changelog
+ *
+ * Parse XPaths, get namespace context and map operation of each step
+ * @param[in]  cl   Changelog
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+changelog_compile(struct changelog *cl)
+{
+    int                    retval = -1;
+    cxobj                **vec = NULL;
+    size_t                 veclen;
+    cxobj                 *xi;
+    struct changelog_step *cs;
+    char                  *str;
+    int                    i;
+
+    if (xpath_vec(cl->cl_xch, NULL, "step", &vec, &veclen) < 0)
+        goto done;
+    if (veclen && (cl->cl_steps = calloc(veclen, sizeof(*cl->cl_steps))) == NULL){
+        clixon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    cl->cl_len = veclen;
+    for (i=0; i<veclen; i++){
+        xi = vec[i];
+        cs = &cl->cl_steps[i];
+        /* Get namespace context from changelog item */
+        if (xml_nsctx_node(xi, &cs->cs_nsc) < 0)
+            goto done;
+        if ((cs->cs_opstr = xml_find_body(xi, "op")) == NULL)
+            continue; /* CL_SKIP */
+        if ((str = xml_find_body(xi, "where")) == NULL)
+            continue;
+        if (xpath_parse(str, &cs->cs_where) < 0)
+            goto done;
+        if ((str = xml_find_body(xi, "when")) != NULL &&
+            xpath_parse(str, &cs->cs_when) < 0)
+            goto done;
+        if ((str = xml_find_body(xi, "tag")) != NULL &&
+            xpath_parse(str, &cs->cs_tag) < 0)
+            goto done;
+        if ((str = xml_find_body(xi, "dst")) != NULL &&
+            xpath_parse(str, &cs->cs_dst) < 0)
+            goto done;
+        cs->cs_new = xml_find(xi, "new");
+        if (strcmp(cs->cs_opstr, "rename") == 0)
+            cs->cs_op = CL_RENAME;
+        else if (strcmp(cs->cs_opstr, "replace") == 0)
+            cs->cs_op = CL_REPLACE;
+        else if (strcmp(cs->cs_opstr, "insert") == 0)
+            cs->cs_op = CL_INSERT;
+        else if (strcmp(cs->cs_opstr, "delete") == 0)
+            cs->cs_op = CL_DELETE;
+        else if (strcmp(cs->cs_opstr, "move") == 0)
+            cs->cs_op = CL_MOVE;
+        else
+            cs->cs_op = CL_UNKNOWN;
+    }
+    retval = 0;
+ done:
+    if (retval < 0)
+        changelog_steps_free(cl);
+    if (vec)
+        free(vec);
+    return retval;
+}
+
+/*! Perform a compiled changelog step
  *
  * @param[in]  h   Clixon handle
  * @param[in]  xt  XML to upgrade
- * @param[in]  xi  Changelog item
- * @retval     0   OK
+ * @param[in]  cs  Compiled changelog step
+ * @retval     1   OK
+ * @retval     0   Failed
  * @retval    -1   Error
  * @note XXX error handling!
  * @note XXX xn --> xt  xpath may not match
 */
 static int
-changelog_op(clixon_handle h,
-             cxobj        *xt,
-             cxobj        *xi)
+changelog_op(clixon_handle          h,
+             cxobj                 *xt,
+             struct changelog_step *cs)
 
 {
     int     retval = -1;
-    char   *op;
-    char   *whenxpath;   /* xpath to when */
-    char   *tag;         /* xpath to extra path (move) */
-    char   *dst;         /* xpath to extra path (move) */
-    cxobj  *xnew;        /* new xml (insert, replace) */
-    char   *wxpath;      /* xpath to where (target-node) */
-    cxobj **wvec = NULL; /* Vector of where(target) nodes */
-    size_t  wlen;
+    xp_ctx *xwctx = NULL;/* Context of where(target) nodes */
     cxobj  *xw;
     xp_ctx *xctx = NULL;
     int     i;
-    cvec   *nsc = NULL;
     int     ret;
 
-    /* Get namespace context from changelog item */
-    if (xml_nsctx_node(xi, &nsc) < 0)
-        goto done;
-    if ((op = xml_find_body(xi, "op")) == NULL)
-        goto ok;
-    /* get common variables that may be used in the operations below */
-    tag = xml_find_body(xi, "tag");
-    dst = xml_find_body(xi, "dst");
-    xnew = xml_find(xi, "new");
-    whenxpath = xml_find_body(xi, "when");
-    if ((wxpath = xml_find_body(xi, "where")) == NULL)
+    if (cs->cs_op == CL_SKIP)
         goto ok;
-    /* Get vector of target nodes meeting the where requirement */
-    if (xpath_vec(xt, nsc, "%s", &wvec, &wlen, wxpath) < 0)
+    /* Get target nodes meeting the where requirement */
+    if (xpath_tree_ctx(xt, cs->cs_nsc, cs->cs_where, 0, &xwctx) < 0)
        goto done;
-   for (i=0; i<wlen; i++){
-       xw = wvec[i];
+    if (xwctx == NULL || xwctx->xc_type != XT_NODESET)
+        goto ok;
+   for (i=0; i<xwctx->xc_size; i++){
+       xw = xwctx->xc_nodeset[i];
        /* If 'when' exists and is false, skip this target */
-       if (whenxpath){
-           if (xpath_vec_ctx(xw, nsc, whenxpath, 0, &xctx) < 0)
+       if (cs->cs_when){
+           if (xpath_tree_ctx(xw, cs->cs_nsc, cs->cs_when, 0, &xctx) < 0)
                goto done;
            if ((ret = ctx2boolean(xctx)) < 0)
                goto done;
@@ -279,24 +411,26 @@ changelog_op(clixon_handle h,
                continue;
        }
        /* Now switch on operation */
-       if (strcmp(op, "rename") == 0){
-           ret = changelog_rename(h, xt, xw, nsc, tag);
-       }
-       else if (strcmp(op, "replace") == 0){
-           ret = changelog_replace(h, xt, xw, xnew);
-       }
-       else if (strcmp(op, "insert") == 0){
-           ret = changelog_insert(h, xt, xw, xnew);
-       }
-       else if (strcmp(op, "delete") == 0){
+       switch (cs->cs_op){
+       case CL_RENAME:
+           ret = changelog_rename(h, xt, xw, cs->cs_nsc, cs->cs_tag);
+           break;
+       case CL_REPLACE:
+           ret = changelog_replace(h, xt, xw, cs->cs_new);
+           break;
+       case CL_INSERT:
+           ret = changelog_insert(h, xt, xw, cs->cs_new);
+           break;
+       case CL_DELETE:
            ret = changelog_delete(h, xt, xw);
-       }
-       else if (strcmp(op, "move") == 0){
-           ret = changelog_move(h, xt, xw, nsc, dst);
-       }
-       else{
-           clixon_err(OE_XML, 0, "Unknown operation: %s", op);
+           break;
+       case CL_MOVE:
+           ret = changelog_move(h, xt, xw, cs->cs_nsc, cs->cs_dst);
+           break;
+       default:
+           clixon_err(OE_XML, 0, "Unknown operation: %s", cs->cs_opstr);
            goto done;
+           break;
        }
        if (ret < 0)
            goto done;
@@ -306,44 +440,41 @@ changelog_op(clixon_handle h,
  ok:
     retval = 1;
  done:
-    if (nsc)
-        xml_nsctx_free(nsc);
-    if (wvec)
-        free(wvec);
+    if (xwctx)
+        ctx_free(xwctx);
     if (xctx)
         ctx_free(xctx);
     return retval;
  fail:
     retval = 0;
-    clixon_debug(CLIXON_DBG_XML, "fail op:%s", op);
+    clixon_debug(CLIXON_DBG_XML, "fail op:%s", cs->cs_opstr);
     goto done;
 }
 
 /*! Iterate through one changelog item
  *
  * @param[in]  h   Clixon handle
- * @param[in]  xt  Changelog list
- * @param[in]  xn  XML to upgrade
- * @retval     0   OK
+ * @param[in]  xt  XML to upgrade
+ * @param[in]  cl  Changelog, steps are compiled on first use
+ * @retval     1   OK
+ * @retval     0   Failed
  * @retval    -1   Error
  */
 static int
-changelog_iterate(clixon_handle h,
-                  cxobj        *xt,
-                  cxobj        *xch)
+changelog_iterate(clixon_handle     h,
+                  cxobj            *xt,
+                  struct changelog *cl)
 
 {
     int        retval = -1;
-    cxobj    **vec = NULL;
-    size_t     veclen;
     int        i;
     int        ret;
 
-    if (xpath_vec(xch, NULL, "step", &vec, &veclen) < 0)
+    if (cl->cl_steps == NULL && changelog_compile(cl) < 0)
         goto done;
     /* Iterate through changelog items */
-    for (i=0; i<veclen; i++){
-        if ((ret = changelog_op(h, xt, vec[i])) < 0)
+    for (i=0; i<cl->cl_len; i++){
+        if ((ret = changelog_op(h, xt, &cl->cl_steps[i])) < 0)
             goto done;
         if (ret == 0)
             goto fail;
@@ -351,24 +482,122 @@ changelog_iterate(clixon_handle h,
     retval = 1;
  done:
     clixon_debug(CLIXON_DBG_XML, "retval: %d", retval);
-    if (vec)
-        free(vec);
     return retval;
  fail:
     retval = 0;
     goto done;
 }
 
+/*! Free changelog index
+ */
+static void
+changelog_index_free(struct changelog_index *ci)
+{
+    int i;
+
+    for (i=0; i<ci->ci_len; i++)
+        changelog_steps_free(&ci->ci_vec[i]);
+    if (ci->ci_vec)
+        free(ci->ci_vec);
+    if (ci->ci_ns)
+        clicon_hash_free(ci->ci_ns);
+    free(ci);
+}
+
+/*! Get changelog index, build it if changelog XML is new
+ *
+ * Changelogs are grouped by namespace, and revisions are parsed once
+ * @param[in]  h       Clixon handle
+ * @param[in]  xchlog  Changelog XML
+ * @param[out] cip     Changelog index
+ * @retval     0       OK
+ * @retval    -1       Error
+ */
+static int
+changelog_index_get(clixon_handle            h,
+                    cxobj                   *xchlog,
+                    struct changelog_index **cip)
+{
+    int                     retval = -1;
+    struct changelog_index *ci = NULL;
+    struct changelog       *cl;
+    struct changelog       *cl1;
+    cxobj                 **vec = NULL;
+    size_t                  veclen;
+    char                   *ns;
+    char                   *b;
+    void                   *p;
+    int                     i;
+
+    if (clicon_ptr_get(h, "xml-changelog-index", (void**)&ci) == 0 && ci != NULL){
+        if (ci->ci_xchlog == xchlog)
+            goto ok;
+        changelog_index_free(ci);
+        ci = NULL;
+        clicon_ptr_del(h, "xml-changelog-index");
+    }
+    if ((ci = calloc(1, sizeof(*ci))) == NULL){
+        clixon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    ci->ci_xchlog = xchlog;
+    if ((ci->ci_ns = clicon_hash_init()) == NULL)
+        goto done;
+    if (xpath_vec(xchlog, NULL, "changelog", &vec, &veclen) < 0)
+        goto done;
+    if (veclen && (ci->ci_vec = calloc(veclen, sizeof(*ci->ci_vec))) == NULL){
+        clixon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    for (i=0; i<veclen; i++){
+        if ((ns = xml_find_body(vec[i], "namespace")) == NULL)
+            continue;
+        cl = &ci->ci_vec[ci->ci_len++];
+        cl->cl_xch = vec[i];
+        if ((b = xml_find_body(cl->cl_xch, "revfrom")) != NULL)
+            if (ys_parse_date_arg(b, &cl->cl_from) < 0)
+                goto done;
+        if ((b = xml_find_body(cl->cl_xch, "revision")) != NULL)
+            if (ys_parse_date_arg(b, &cl->cl_to) < 0)
+                goto done;
+        /* Append last in list of namespace */
+        if ((p = clicon_hash_value(ci->ci_ns, ns, NULL)) == NULL){
+            if (clicon_hash_add(ci->ci_ns, ns, &cl, sizeof(cl)) == NULL)
+                goto done;
+        }
+        else{
+            cl1 = *(struct changelog **)p;
+            while (cl1->cl_next)
+                cl1 = cl1->cl_next;
+            cl1->cl_next = cl;
+        }
+    }
+    if (clicon_ptr_set(h, "xml-changelog-index", ci) < 0)
+        goto done;
+ ok:
+    *cip = ci;
+    ci = NULL;
+    retval = 0;
+ done:
+    if (ci)
+        changelog_index_free(ci);
+    if (vec)
+        free(vec);
+    return retval;
+}
+
 /*! Automatic upgrade using changelog
  *
- * @param[in]  h       Clixon handle 
+ * The changelogs of a namespace are found in an index, and the steps of a changelog are
+ * compiled on first use, see changelog_index_get.
+ * @param[in]  h       Clixon handle
  * @param[in]  xt      Top-level XML tree to be updated (includes other ns as well)
  * @param[in]  ns      Namespace of module (for info)
  * @param[in]  op      One of XML_FLAG_ADD, _DEL, _CHANGE
  * @param[in]  from    From revision on the form YYYYMMDD
  * @param[in]  to      To revision on the form YYYYMMDD (0 not in system)
- * @param[in]  arg     User argument given at rpc_callback_register() 
- * @param[out] cbret   Return xml tree, eg <rpc-reply>..., <rpc-error.. 
+ * @param[in]  arg     User argument given at rpc_callback_register()
+ * @param[out] cbret   Return xml tree, eg <rpc-reply>..., <rpc-error..
  * @retval     1       OK
  * @retval     0       Invalid
  * @retval    -1       Error
@@ -384,16 +613,12 @@ xml_changelog_upgrade(clixon_handle h,
                       void         *arg,
                       cbuf         *cbret)
 {
-    int        retval = -1;
-    cxobj     *xchlog; /* changelog */
-    cxobj    **vec = NULL;
-    cxobj     *xch;
-    size_t     veclen;
-    char      *b;
-    int        i;
-    uint32_t   f;
-    uint32_t   t;
-    int        ret;
+    int                     retval = -1;
+    cxobj                  *xchlog; /* changelog */
+    struct changelog_index *ci;
+    struct changelog       *cl;
+    void                   *p;
+    int                     ret;
 
     /* Check if changelog enabled */
     if (!clicon_option_bool(h, "CLICON_XML_CHANGELOG"))
@@ -401,27 +626,20 @@ xml_changelog_upgrade(clixon_handle h,
     /* Get changelog */
     if ((xchlog = clicon_xml_changelog_get(h)) == NULL)
         goto ok;
-
+    if (changelog_index_get(h, xchlog, &ci) < 0)
+        goto done;
     /* Iterate and find relevant changelog entries in the interval:
      * - find all changelogs in the interval: [from, to]
      * - note it t=0 then no changelog is applied
      */
-    if (xpath_vec(xchlog, NULL, "changelog[namespace=\"%s\"]",
-                  &vec, &veclen, ns) < 0)
-        goto done;
+    if (ns == NULL ||
+        (p = clicon_hash_value(ci->ci_ns, ns, NULL)) == NULL)
+        goto ok;
     /* Get all changelogs in the interval [from,to]*/
-    for (i=0; i<veclen; i++){
-        xch = vec[i];
-        f = t = 0;
-        if ((b = xml_find_body(xch, "revfrom")) != NULL)
-            if (ys_parse_date_arg(b, &f) < 0)
-                goto done;
-        if ((b = xml_find_body(xch, "revision")) != NULL)
-            if (ys_parse_date_arg(b, &t) < 0)
-                goto done;
-        if ((f && from>f) || to<t)
+    for (cl = *(struct changelog **)p; cl != NULL; cl = cl->cl_next){
+        if ((cl->cl_from && from>cl->cl_from) || to<cl->cl_to)
             continue;
-        if ((ret = changelog_iterate(h, xt, xch)) < 0)
+        if ((ret = changelog_iterate(h, xt, cl)) < 0)
             goto done;
         if (ret == 0)
             goto fail;
@@ -429,8 +647,6 @@ xml_changelog_upgrade(clixon_handle h,
  ok:
     retval = 1;
  done:
-    if (vec)
-        free(vec);
     return retval;
  fail:
     retval = 0;
@@ -489,6 +705,28 @@ clixon_xml_changelog_init(clixon_handle h)
     return retval;
 }
 
+/*! Free changelog and its index
+ *
+ * @param[in]  h   Clixon handle
+ * @retval     0   OK
+ */
+int
+clixon_xml_changelog_exit(clixon_handle h)
+{
+    struct changelog_index *ci = NULL;
+    cxobj                  *x;
+
+    if (clicon_ptr_get(h, "xml-changelog-index", (void**)&ci) == 0 && ci != NULL){
+        changelog_index_free(ci);
+        clicon_ptr_del(h, "xml-changelog-index");
+    }
+    if ((x = clicon_xml_changelog_get(h)) != NULL){
+        xml_free(x);
+        clicon_xml_changelog_set(h, NULL);
+    }
+    return 0;
+}
+
 /*! Given a top-level XML tree and a namespace, return a vector of matching XML nodes
  *
  * @param[in]  h         Clixon handle
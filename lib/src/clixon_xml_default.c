@@ -278,6 +278,244 @@ xml_nopresence_try(yang_stmt *yt,
     return retval;
 }
 
+#ifdef YANG_DEFAULT_TEMPLATE
+/*! Children of a yang node that may give default values, for config or state
+ *
+ * Stored on yang node, see yang_defaults_get
+ */
+struct default_tmpl{
+    int         dt_done;  /* Template is computed */
+    int         dt_len;   /* Length of dt_vec and dt_when */
+    yang_stmt **dt_vec;   /* Leafs w default, non-presence containers w defaults and choices */
+    uint8_t    *dt_when;  /* Child has when condition */
+};
+
+/* Forward */
+static struct default_tmpl *xml_default_template_get(yang_stmt *yt, int state);
+
+/*! Free default templates of a yang node
+ *
+ * @param[in]  arg  Config and state default templates
+ */
+void
+xml_default_template_free(void *arg)
+{
+    struct default_tmpl *dts = (struct default_tmpl *)arg;
+    int                  i;
+
+    if (dts == NULL)
+        return;
+    for (i=0; i<2; i++){
+        if (dts[i].dt_vec)
+            free(dts[i].dt_vec);
+        if (dts[i].dt_when)
+            free(dts[i].dt_when);
+    }
+    free(dts);
+}
+
+/*! Add yang child to default template
+ *
+ * @param[in]  dt    Default template
+ * @param[in]  yc    Yang child
+ * @param[in]  when  Child has when condition
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+static int
+xml_default_template_add(struct default_tmpl *dt,
+                         yang_stmt           *yc,
+                         int                  when)
+{
+    yang_stmt **vec;
+    uint8_t    *wvec;
+
+    if ((vec = realloc(dt->dt_vec, (dt->dt_len+1)*sizeof(*vec))) == NULL){
+        clixon_err(OE_UNIX, errno, "realloc");
+        return -1;
+    }
+    dt->dt_vec = vec;
+    if ((wvec = realloc(dt->dt_when, (dt->dt_len+1)*sizeof(*wvec))) == NULL){
+        clixon_err(OE_UNIX, errno, "realloc");
+        return -1;
+    }
+    dt->dt_when = wvec;
+    dt->dt_vec[dt->dt_len] = yc;
+    dt->dt_when[dt->dt_len] = when;
+    dt->dt_len++;
+    return 0;
+}
+
+/*! Compute default template of a yang node
+ *
+ * @param[in]  yt     Yang container, list, case, input or output
+ * @param[in]  state  Set if global state, otherwise config
+ * @param[in]  dt     Default template to fill in
+ * @retval     0      OK
+ * @retval    -1      Error
+ * @see xml_default  where the same children are considered
+ */
+static int
+xml_default_template_create(yang_stmt           *yt,
+                            int                  state,
+                            struct default_tmpl *dt)
+{
+    int                  retval = -1;
+    yang_stmt           *yc;
+    yang_stmt           *yca;
+    struct default_tmpl *dtc;
+    cg_var              *cv;
+    int                  when;
+    int                  create;
+    int                  inext;
+    int                  inext1;
+
+    inext = 0;
+    while ((yc = yn_iter(yt, &inext)) != NULL) {
+        if (!state && !yang_config(yc))
+            continue;
+        if (state && yang_config_ancestor(yc))
+            continue;
+        when = yang_when_get(NULL, yc) != NULL || yang_find(yc, Y_WHEN, NULL) != NULL;
+        switch (yang_keyword_get(yc)){
+        case Y_LEAF:
+            if ((cv = yang_cv_get(yc)) == NULL){
+                clixon_err(OE_YANG,0, "Internal error: yang leaf %s not populated with cv as it should",
+                           yang_argument_get(yc));
+                goto done;
+            }
+            if (!cv_flag(cv, V_UNSET) &&
+                xml_default_template_add(dt, yc, when) < 0)
+                goto done;
+            break;
+        case Y_CONTAINER:
+            if (yang_find(yc, Y_PRESENCE, NULL) != NULL)
+                break;
+            create = 0;
+            if (xml_nopresence_try(yc, state, &create) < 0)
+                goto done;
+            if (create &&
+                xml_default_template_add(dt, yc, when) < 0)
+                goto done;
+            break;
+        case Y_CHOICE: /* Only if a case gives default values */
+            inext1 = 0;
+            while ((yca = yn_iter(yc, &inext1)) != NULL) {
+                if (yang_keyword_get(yca) != Y_CASE)
+                    continue;
+                if ((dtc = xml_default_template_get(yca, state)) == NULL)
+                    goto done;
+                if (dtc->dt_len)
+                    break;
+            }
+            if (yca != NULL &&
+                xml_default_template_add(dt, yc, 0) < 0)
+                goto done;
+            break;
+        default:
+            break;
+        }
+    }
+    dt->dt_done = 1;
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Get default template of a yang node, compute it if not done
+ *
+ * @param[in]  yt     Yang container, list, case, input or output
+ * @param[in]  state  Set if global state, otherwise config
+ * @retval     dt     Default template
+ * @retval     NULL   Error
+ */
+static struct default_tmpl *
+xml_default_template_get(yang_stmt *yt,
+                         int        state)
+{
+    struct default_tmpl *dts;
+    struct default_tmpl *dt;
+
+    if ((dts = yang_defaults_get(yt)) == NULL){
+        if ((dts = calloc(2, sizeof(*dts))) == NULL){
+            clixon_err(OE_UNIX, errno, "calloc");
+            return NULL;
+        }
+        if (yang_defaults_set(yt, dts) < 0){
+            free(dts);
+            return NULL;
+        }
+    }
+    dt = &dts[state?1:0];
+    if (dt->dt_done == 0 &&
+        xml_default_template_create(yt, state, dt) < 0)
+        return NULL;
+    return dt;
+}
+
+/*! Ensure default values are set on children of one xml node using default template of its yang
+ *
+ * @param[in]   yt      Yang container, list, case, input or output
+ * @param[in]   xt      XML tree (with yt as spec of xt, informally)
+ * @param[in]   state   Set if global state, otherwise config
+ * @retval      0       OK
+ * @retval     -1       Error
+ * @see xml_default  without template
+ */
+static int
+xml_default_template(yang_stmt *yt,
+                     cxobj     *xt,
+                     int        state)
+{
+    int                  retval = -1;
+    struct default_tmpl *dt;
+    yang_stmt           *yc;
+    cxobj               *xc;
+    int                  nr = 0;
+    int                  hit = 0;
+    int                  i;
+
+    if ((dt = xml_default_template_get(yt, state)) == NULL)
+        goto done;
+    for (i=0; i<dt->dt_len; i++){
+        yc = dt->dt_vec[i];
+        if (dt->dt_when[i]){
+            if (yang_check_when_xpath(NULL, xt, yc, &hit, &nr, NULL) < 0)
+                goto done;
+            if (hit && nr == 0)
+                continue; /* Do not create default if xpath fails */
+        }
+        switch (yang_keyword_get(yc)){
+        case Y_LEAF:
+            if (xml_find_type(xt, NULL, yang_argument_get(yc), CX_ELMNT) == NULL){
+                if (xml_default_create(yc, xt, 0) < 0)
+                    goto done;
+                xml_sort(xt);
+            }
+            break;
+        case Y_CONTAINER: /* Non-presence container with default values */
+            if (xml_find_type(xt, NULL, yang_argument_get(yc), CX_ELMNT) == NULL){
+                if (xml_default_create1(yc, xt, &xc) < 0)
+                    goto done;
+                xml_sort(xt);
+                if (xml_default_template(yc, xc, state) < 0)
+                    goto done;
+            }
+            break;
+        case Y_CHOICE:
+            if (xml_default_choice(yc, xt, state) < 0)
+                goto done;
+            break;
+        default:
+            break;
+        }
+    }
+    retval = 0;
+ done:
+    return retval;
+}
+#endif /* YANG_DEFAULT_TEMPLATE */
+
 /*! Ensure default values are set on (children of) one single xml node
  *
  * Not recursive, except in one case with one or several non-presence containers, in which case
@@ -313,14 +551,26 @@ xml_default(yang_stmt *yt,
         goto done;
     }
     switch (yang_keyword_get(yt)){
+#ifdef YANG_DEFAULT_TEMPLATE
+    case Y_CONTAINER:
+    case Y_LIST:
+    case Y_INPUT:
+    case Y_OUTPUT:
+    case Y_CASE:
+        if (xml_default_template(yt, xt, state) < 0)
+            goto done;
+        break;
+#endif
     case Y_MODULE:
     case Y_SUBMODULE:
         top++;
+#ifndef YANG_DEFAULT_TEMPLATE
     case Y_CONTAINER: /* XXX maybe check for non-presence here as well */
     case Y_LIST:
     case Y_INPUT:
     case Y_OUTPUT:
     case Y_CASE:
+#endif
         inext = 0;
         while ((yc = yn_iter(yt, &inext)) != NULL) {
             // XXX consider only data nodes for optimization?
@@ -564,9 +814,9 @@ xml_global_defaults(clixon_handle h,
         goto done;
     if (xml_copy_marked(xcache, xpart) < 0) /* config */
         goto done;
-    if (xml_apply(xcache, CX_ELMNT, (xml_applyfn_t*)xml_flag_reset, (void*)(XML_FLAG_MARK|XML_FLAG_CHANGE)) < 0)
+    if (xml_flag_reset_tree(xcache, XML_FLAG_MARK|XML_FLAG_CHANGE) < 0)
         goto done;
-    if (xml_apply(xpart, CX_ELMNT, (xml_applyfn_t*)xml_flag_reset, (void*)(XML_FLAG_MARK|XML_FLAG_CHANGE)) < 0)
+    if (xml_flag_reset_tree(xpart, XML_FLAG_MARK|XML_FLAG_CHANGE) < 0)
         goto done;
     /* Merge global pruned tree with xt */
     if ((ret = xml_merge1(xt, xpart, yspec, 0, NULL)) < 1) /* XXX reason */
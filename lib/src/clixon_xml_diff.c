@@ -64,6 +64,7 @@
 #include "clixon_xml.h"
 #include "clixon_log.h"
 #include "clixon_debug.h"
+#include "clixon_trace.h"
 #include "clixon_err.h"
 #include "clixon_options.h"
 #include "clixon_data.h"
@@ -97,6 +98,9 @@ typedef struct  {
 
 /* Forward declaration */
 static int xml_diff2patch(cxobj *x1, cxobj *x2, uint16_t flags, cxobj *xpatch, int *nr);
+static int xml_diff1(cxobj *x0, cxobj *x1, int state, cxobj ***x0vec, size_t *x0veclen,
+                     cxobj ***x1vec, size_t *x1veclen, cxobj ***changed_x0, cxobj ***changed_x1,
+                     size_t *changedlen);
 
 /*! Compute if two XML trees are equal or not
  *
@@ -122,6 +126,8 @@ xml_tree_equal(cxobj *x0,
     cxobj     *x1c; /* x1 child */
     int        extflag = 0;
 
+    if (xml_digest_equal(x0, x1) == 1)
+        return 0;
     /* Traverse x0 and x1 in lock-step */
     x0c = x1c = NULL;
     x0c = xml_child_each(x0, x0c, CX_ELMNT);
@@ -199,45 +205,215 @@ xml_tree_equal(cxobj *x0,
     return retval;
 }
 
+/*! Hash of the keys of an ordered-by user list entry, or the value of a leaf-list entry
+ *
+ * FNV-1a of key bodies. Used for bucketing only, equality is decided by xml_cmp
+ * @param[in]  x     XML list or leaf-list entry
+ * @param[in]  yc    Yang of x
+ * @retval     hash
+ */
+static uint32_t
+xml_diff_key_hash(cxobj     *x,
+                  yang_stmt *yc)
+{
+    uint32_t hash = 2166136261U;
+    cvec    *cvk;
+    cg_var  *cvi = NULL;
+    char    *b;
+
+    if (yang_keyword_get(yc) == Y_LIST){
+        cvk = yang_cvec_get(yc);
+        while ((cvi = cvec_each(cvk, cvi)) != NULL){
+            if ((b = xml_find_body(x, cv_string_get(cvi))) != NULL)
+                for (; *b; b++)
+                    hash = (hash ^ (uint8_t)*b) * 16777619U;
+            hash = (hash ^ 0xff) * 16777619U; /* separator */
+        }
+    }
+    else if ((b = xml_body(x)) != NULL)
+        for (; *b; b++)
+            hash = (hash ^ (uint8_t)*b) * 16777619U;
+    return hash;
+}
+
 /*! Handle order-by user(leaf)list for xml_diff
  *
  * Loop over sublists started by x0c and x1c respectively until end or yang is no longer yc
- * Just mark all nodes from x0c to end as DEL and all nodes from x1c as ADD
- * @param[in]  x0    First XML tree
- * @param[in]  x1    Second XML tree
- * @param[in]  x0c   Start of sublist in first XML tree
- * @param[in]  x1c   Start of sublist in second XML tree
- * @param[in]  yc    Yang of ordered-by user (leaf)list
- * @retval     0     Ok
- * @retval    -1     rror
+ * Entries are matched by key using a hash table of the second sublist. The longest sequence
+ * of matched entries in the same order in both sublists is computed as a longest increasing
+ * subsequence (patience sorting), in O(N log N).
+ * Matched entries in that sequence are compared recursively. Other matched entries have
+ * moved and are both deleted and added, as are entries only in one sublist.
+ * @param[in]     x0         First XML tree
+ * @param[in]     x1         Second XML tree
+ * @param[in,out] x0cp       Start of sublist in first XML tree, out: first node after
+ * @param[in,out] x1cp       Start of sublist in second XML tree, out: first node after
+ * @param[in]     yc         Yang of ordered-by user (leaf)list
+ * @param[in]     state      0: ignore state, 1: include state (non-config)
+ * @param[out]    x0vec      Pointervector to XML nodes existing in only first tree
+ * @param[out]    x0veclen   Length of first vector
+ * @param[out]    x1vec      Pointervector to XML nodes existing in only second tree
+ * @param[out]    x1veclen   Length of x1vec vector
+ * @param[out]    changed_x0 Pointervector to XML nodes changed orig value
+ * @param[out]    changed_x1 Pointervector to XML nodes changed wanted value
+ * @param[out]    changedlen Length of changed vector
+ * @retval        0          Ok
+ * @retval       -1          Error
  */
 static int
 xml_diff_ordered_by_user(cxobj     *x0,
                          cxobj     *x1,
-                         cxobj     *x0c,
-                         cxobj     *x1c,
-                         yang_stmt *yc)
+                         cxobj    **x0cp,
+                         cxobj    **x1cp,
+                         yang_stmt *yc,
+                         int        state,
+                         cxobj   ***x0vec,
+                         size_t    *x0veclen,
+                         cxobj   ***x1vec,
+                         size_t    *x1veclen,
+                         cxobj   ***changed_x0,
+                         cxobj   ***changed_x1,
+                         size_t    *changedlen)
 {
-    int    retval = -1;
-    cxobj *xi;
-    cxobj *xj;
+    int      retval = -1;
+    cxobj  **av = NULL;  /* First sublist */
+    size_t   alen = 0;
+    cxobj  **bv = NULL;  /* Second sublist */
+    size_t   blen = 0;
+    int     *match = NULL; /* Index in bv of each entry in av, or -1 */
+    int     *ht = NULL;    /* Hash table of bv indexes, -1 is empty */
+    int     *tails = NULL; /* Index in av of last entry of increasing sequence of each length */
+    int     *prev = NULL;  /* Predecessor in av of each entry in increasing sequence */
+    uint8_t *inseq = NULL; /* Entry in bv is in longest common sequence */
+    size_t   hsize;
+    size_t   i;
+    int      j;
+    int      k;
+    int      n = 0;
+    int      lo;
+    int      hi;
+    cxobj   *xi;
 
-    /* Simpler algoithm: Just delete whole old list and add new list if ANY changes */
-    xi = x0c;
+    xi = *x0cp;
     do {
-        xml_flag_set(xi, XML_FLAG_DEL);
+        if (cxvec_append(xi, &av, &alen) < 0)
+            goto done;
     } while ((xi = xml_child_each(x0, xi, CX_ELMNT)) != NULL &&
-           xml_spec(xi) == yc);
-    xj = x1c;
+             xml_spec(xi) == yc);
+    *x0cp = xi;
+    xi = *x1cp;
     do {
-        xml_flag_set(xj, XML_FLAG_ADD);
-    } while ((xj = xml_child_each(x1, xj, CX_ELMNT)) != NULL &&
-             xml_spec(xj) == yc);
+        if (cxvec_append(xi, &bv, &blen) < 0)
+            goto done;
+    } while ((xi = xml_child_each(x1, xi, CX_ELMNT)) != NULL &&
+             xml_spec(xi) == yc);
+    *x1cp = xi;
+    for (hsize = 16; hsize < 2*blen; hsize *= 2);
+    if ((match = calloc(alen, sizeof(*match))) == NULL ||
+        (ht = calloc(hsize, sizeof(*ht))) == NULL ||
+        (tails = calloc(alen+1, sizeof(*tails))) == NULL ||
+        (prev = calloc(alen, sizeof(*prev))) == NULL ||
+        (inseq = calloc(blen, sizeof(*inseq))) == NULL){
+        clixon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    /* Hash table of second sublist with linear probing */
+    for (i=0; i<hsize; i++)
+        ht[i] = -1;
+    for (j=0; j<blen; j++){
+        for (i = xml_diff_key_hash(bv[j], yc) & (hsize-1); ht[i] != -1; i = (i+1) & (hsize-1));
+        ht[i] = j;
+    }
+    /* Match first sublist, and compute longest increasing subsequence of matches */
+    for (i=0; i<alen; i++){
+        match[i] = -1;
+        prev[i] = -1;
+        for (k = xml_diff_key_hash(av[i], yc) & (hsize-1); ht[k] != -1; k = (k+1) & (hsize-1))
+            if (xml_cmp(av[i], bv[ht[k]], 0, 0, NULL) == 0){
+                match[i] = ht[k];
+                break;
+            }
+        if (match[i] == -1)
+            continue;
+        lo = 0;
+        hi = n;
+        while (lo < hi){ /* First sequence whose last entry is not smaller */
+            j = (lo + hi)/2;
+            if (match[tails[j]] < match[i])
+                lo = j+1;
+            else
+                hi = j;
+        }
+        if (lo > 0)
+            prev[i] = tails[lo-1];
+        tails[lo] = i;
+        if (lo == n)
+            n++;
+    }
+    for (j = n ? tails[n-1] : -1; j != -1; j = prev[j])
+        inseq[match[j]] = 1;
+    for (i=0; i<alen; i++){
+        if (match[i] != -1 && inseq[match[i]]){
+            if (yang_keyword_get(yc) == Y_LIST &&
+                xml_diff1(av[i], bv[match[i]], state,
+                          x0vec, x0veclen,
+                          x1vec, x1veclen,
+                          changed_x0, changed_x1, changedlen) < 0)
+                goto done;
+        }
+        else if (cxvec_append(av[i], x0vec, x0veclen) < 0)
+            goto done;
+    }
+    for (j=0; j<blen; j++)
+        if (!inseq[j] && cxvec_append(bv[j], x1vec, x1veclen) < 0)
+            goto done;
     retval = 0;
-    // done:
+ done:
+    if (av)
+        free(av);
+    if (bv)
+        free(bv);
+    if (match)
+        free(match);
+    if (ht)
+        free(ht);
+    if (tails)
+        free(tails);
+    if (prev)
+        free(prev);
+    if (inseq)
+        free(inseq);
     return retval;
 }
 
+/*! Check if XML node is skipped when comparing trees
+ *
+ * @param[in]  x      XML node
+ * @param[in]  state  Set if state data is compared
+ * @retval     1      Skip: flagged with XML_FLAG_SKIP, state data, or cl:ignore-compare extension
+ * @retval     0      Compare
+ * @retval    -1      Error
+ */
+static int
+xml_diff_skip(cxobj *x,
+              int    state)
+{
+    yang_stmt *y;
+    int        extflag;
+
+    if (xml_flag(x, XML_FLAG_SKIP) != 0x0)
+        return 1;
+    if ((y = xml_spec(x)) != NULL){
+        if (!state && yang_config(y) == 0) /* skip state data if state is not included */
+            return 1;
+        if (yang_extension_value(y, "ignore-compare", CLIXON_LIB_NS, &extflag, NULL) < 0)
+            return -1;
+        if (extflag)
+            return 1;
+    }
+    return 0;
+}
+
 /*! Recursive help function to compute differences between two xml trees
  *
  * @param[in]  x0         First XML tree
@@ -270,7 +446,7 @@ xml_diff_ordered_by_user(cxobj     *x0,
  * @see xml_diff2cbuf, clixon_text_diff2cbuf  for +/- diff for XML and TEXT formats
  * @see text_diff2cbuf for curly
  * @see xml_tree_equal Equal or not
- * @note reordering in ordered-by user is NOT supported
+ * Ordered-by user entries that have moved are both in x0vec and x1vec
  */
 static int
 xml_diff1(cxobj     *x0,
@@ -292,10 +468,13 @@ xml_diff1(cxobj     *x0,
     char      *b0;
     char      *b1;
     int        eq;
-    cxobj     *xi;
-    cxobj     *xj;
-    int        extflag;
+    int        ret;
 
+    /* Equal subtrees have no differences */
+    if ((eq = xml_digest_equal(x0, x1)) < 0)
+        goto done;
+    if (eq == 1)
+        goto ok;
     /* Traverse x0 and x1 in lock-step */
     x0c = x1c = NULL;
     x0c = xml_child_each(x0, x0c, CX_ELMNT);
@@ -305,44 +484,23 @@ xml_diff1(cxobj     *x0,
             goto ok;
         y0c = NULL;
         y1c = NULL;
-        /* If cl:ignore-compare extension, return equal */
         if (x0c) {
-            if (xml_flag(x0c, XML_FLAG_SKIP) != 0x0){ /* skip */
+            if ((ret = xml_diff_skip(x0c, state)) < 0)
+                goto done;
+            if (ret == 1){
                 x0c = xml_child_each(x0, x0c, CX_ELMNT);
                 continue;
             }
-            else
-                if ((y0c = xml_spec(x0c)) != NULL){
-                    if (!state && yang_config(y0c) == 0){ /* skip state data if state is not included */
-                        x0c = xml_child_each(x0, x0c, CX_ELMNT);
-                        continue;
-                    }
-                    if (yang_extension_value(y0c, "ignore-compare", CLIXON_LIB_NS, &extflag, NULL) < 0)
-                        goto done;
-                    if (extflag){ /* skip */
-                        x0c = xml_child_each(x0, x0c, CX_ELMNT);
-                        continue;
-                    }
-                }
+            y0c = xml_spec(x0c);
         }
         if (x1c) {
-            if (xml_flag(x1c, XML_FLAG_SKIP) != 0x0){ /* skip */
+            if ((ret = xml_diff_skip(x1c, state)) < 0)
+                goto done;
+            if (ret == 1){
                 x1c = xml_child_each(x1, x1c, CX_ELMNT);
                 continue;
             }
-            else
-                if ((y1c = xml_spec(x1c)) != NULL){
-                    if (!state && yang_config(y1c) == 0){ /* skip state data if state is not included */
-                        x1c = xml_child_each(x1, x1c, CX_ELMNT);
-                        continue;
-                    }
-                    if (yang_extension_value(y1c, "ignore-compare", CLIXON_LIB_NS, &extflag, NULL) < 0)
-                        goto done;
-                    if (extflag){ /* skip */
-                        x1c = xml_child_each(x1, x1c, CX_ELMNT);
-                        continue;
-                    }
-                }
+            y1c = xml_spec(x1c);
         }
         if (x0c == NULL){
             if (cxvec_append(x1c, x1vec, x1veclen) < 0)
@@ -360,32 +518,11 @@ xml_diff1(cxobj     *x0,
         eq = xml_cmp(x0c, x1c, 0, 0, NULL);
         /* override ordered-by user with special look-ahead checks */
         if (eq && y0c && y1c && y0c == y1c && yang_find(y0c, Y_ORDERED_BY, "user")){
-            if (xml_diff_ordered_by_user(x0, x1, x0c, x1c, y0c) < 0)
+            if (xml_diff_ordered_by_user(x0, x1, &x0c, &x1c, y0c, state,
+                                         x0vec, x0veclen,
+                                         x1vec, x1veclen,
+                                         changed_x0, changed_x1, changedlen) < 0)
                 goto done;
-            /* Add all in x0 marked as DELETE in x0vec
-             * Flags can remain: XXX should apply to all
-             */
-            xi = x0c;
-            do {
-                if (xml_flag(xi, XML_FLAG_DEL)){
-                    if (cxvec_append(xi, x0vec, x0veclen) < 0)
-                        goto done;
-                }
-            }
-            while ((xi = xml_child_each(x0, xi, CX_ELMNT)) != NULL &&
-                   xml_spec(xi) == y0c);
-            x0c = xi;
-
-            /* Add all in x1 marked as ADD in x1vec */
-            xj = x1c;
-            do {
-                if (xml_flag(xj, XML_FLAG_ADD))
-                    if (cxvec_append(xj, x1vec, x1veclen) < 0)
-                        goto done;
-            }
-            while ((xj = xml_child_each(x1, xj, CX_ELMNT)) != NULL &&
-                   xml_spec(xj) == y1c);
-            x1c = xj;
             continue;
         }
         else if (eq < 0){
@@ -469,13 +606,15 @@ xml_diff(cxobj     *x0,
          cxobj   ***changed_x1,
          size_t    *changedlen)
 {
-    int retval = -1;
+    int            retval = -1;
+    clixon_trace_t tr;
 
     *firstlen = 0;
     *secondlen = 0;
     *changedlen = 0;
     if (x0 == NULL && x1 == NULL)
         return 0;
+    tr = clixon_trace_begin(CLIXON_DBG_XML);
     if (x1 == NULL){
         if (cxvec_append(x0, first, firstlen) < 0)
             goto done;
@@ -493,10 +632,206 @@ xml_diff(cxobj     *x0,
         goto done;
  ok:
     retval = 0;
+ done:
+    clixon_trace_end(tr, CLIXON_DBG_XML, "xml_diff", NULL);
+    return retval;
+}
+
+/*! Compute differences in selected subtrees of two xml trees, internal recursive function
+ *
+ * @param[in]  x0    First XML tree node
+ * @param[in]  x1    Second XML tree node
+ * @param[in]  xs    Selection node corresponding to x0 and x1
+ * @see xml_diff_select for the other parameters
+ */
+static int
+xml_diff_select1(cxobj     *x0,
+                 cxobj     *x1,
+                 cxobj     *xs,
+                 cxobj   ***first,
+                 size_t    *firstlen,
+                 cxobj   ***second,
+                 size_t    *secondlen,
+                 cxobj   ***changed_x0,
+                 cxobj   ***changed_x1,
+                 size_t    *changedlen)
+{
+    int        retval = -1;
+    cxobj     *xsc = NULL;
+    cxobj     *x0c;
+    cxobj     *x1c;
+    yang_stmt *yc;
+    char      *b0;
+    char      *b1;
+    int        ret;
+
+    while ((xsc = xml_child_each(xs, xsc, CX_ELMNT)) != NULL){
+        yc = xml_spec(xsc);
+        if (yc && yang_keyword_get(yc) == Y_LEAF) /* list key */
+            continue;
+        if (match_base_child(x0, xsc, yc, &x0c) < 0)
+            goto done;
+        if (x0c && (ret = xml_diff_skip(x0c, 0)) != 0){
+            if (ret < 0)
+                goto done;
+            x0c = NULL;
+        }
+        if (match_base_child(x1, xsc, yc, &x1c) < 0)
+            goto done;
+        if (x1c && (ret = xml_diff_skip(x1c, 0)) != 0){
+            if (ret < 0)
+                goto done;
+            x1c = NULL;
+        }
+        if (x0c == NULL && x1c == NULL)
+            continue;
+        if (x1c == NULL){
+            if (cxvec_append(x0c, first, firstlen) < 0)
+                goto done;
+        }
+        else if (x0c == NULL){
+            if (cxvec_append(x1c, second, secondlen) < 0)
+                goto done;
+        }
+        else if (!xml_flag(xsc, XML_FLAG_CHANGE)){
+            if (xml_diff_select1(x0c, x1c, xsc,
+                                 first, firstlen, second, secondlen,
+                                 changed_x0, changed_x1, changedlen) < 0)
+                goto done;
+        }
+        else if (yc && yang_keyword_get(yc) == Y_LEAF){
+            b0 = xml_body(x0c);
+            b1 = xml_body(x1c);
+            if ((b0 == NULL) != (b1 == NULL) ||
+                (b0 && strcmp(b0, b1) != 0)){
+                if (cxvec_append(x0c, changed_x0, changedlen) < 0)
+                    goto done;
+                (*changedlen)--; /* append two vectors */
+                if (cxvec_append(x1c, changed_x1, changedlen) < 0)
+                    goto done;
+            }
+        }
+        else if (xml_diff1(x0c, x1c, 0,
+                           first, firstlen, second, secondlen,
+                           changed_x0, changed_x1, changedlen) < 0)
+            goto done;
+    }
+    retval = 0;
  done:
     return retval;
 }
 
+/*! Compute differences between two xml trees in selected subtrees only
+ *
+ * Same result as xml_diff if all differences are in the selected subtrees, but only
+ * the selected subtrees are traversed.
+ * The selection is a tree of containers and list entries (with keys) corresponding to nodes
+ * in x0 and x1. Selection nodes flagged with XML_FLAG_CHANGE are compared as a whole,
+ * other selection nodes are only compared in their selected children.
+ * @param[in]  x0         First XML tree
+ * @param[in]  x1         Second XML tree
+ * @param[in]  xsel       Selection tree, top node corresponds to x0 and x1
+ * @param[out] first      Pointervector to XML nodes existing in only first tree
+ * @param[out] firstlen   Length of first vector
+ * @param[out] second     Pointervector to XML nodes existing in only second tree
+ * @param[out] secondlen  Length of second vector
+ * @param[out] changed_x0 Pointervector to XML nodes changed orig value
+ * @param[out] changed_x1 Pointervector to XML nodes changed wanted value
+ * @param[out] changedlen Length of changed vector
+ * @retval     0          OK
+ * @retval    -1          Error
+ * @see xml_diff  Compare whole trees
+ * @see xmldb_editlog_get  Edited subtrees of a candidate datastore
+ */
+int
+xml_diff_select(cxobj     *x0,
+                cxobj     *x1,
+                cxobj     *xsel,
+                cxobj   ***first,
+                size_t    *firstlen,
+                cxobj   ***second,
+                size_t    *secondlen,
+                cxobj   ***changed_x0,
+                cxobj   ***changed_x1,
+                size_t    *changedlen)
+{
+    if (x0 == NULL || x1 == NULL || xml_flag(xsel, XML_FLAG_CHANGE))
+        return xml_diff(x0, x1, first, firstlen, second, secondlen,
+                        changed_x0, changed_x1, changedlen);
+    *firstlen = 0;
+    *secondlen = 0;
+    *changedlen = 0;
+    return xml_diff_select1(x0, x1, xsel, first, firstlen, second, secondlen,
+                            changed_x0, changed_x1, changedlen);
+}
+
+/*! Find matching base child of x1c by walking the children of x0 in tandem with x1
+ *
+ * Both x0 and x1 children are sorted by xml_cmp, so a cursor in x0 only needs to move
+ * forward, making the lookups of one level O(n+m) instead of one search per child.
+ * Invariant: the cursor is at the first child of x0 not less than the previous joined child
+ * of x1.
+ * @param[in]     x0      Base tree node
+ * @param[in,out] x0jp    Cursor in x0 children, init to first element child of x0
+ * @param[in,out] x1prevp Previous joined child of x1, init to NULL
+ * @param[in]     x1c     Modification tree child
+ * @param[in]     yc      Yang spec of x1c
+ * @param[out]    x0cp    Matching base tree child (if any)
+ * @retval        1       OK, see x0cp
+ * @retval        0       Not applicable, eg ordered-by user or x1 not sorted, use match_base_child
+ * @see match_base_child  Lookup of one child
+ */
+static int
+merge_join_child(cxobj     *x0,
+                 cxobj    **x0jp,
+                 cxobj    **x1prevp,
+                 cxobj     *x1c,
+                 yang_stmt *yc,
+                 cxobj    **x0cp)
+{
+    cxobj  *x0j;
+    cvec   *cvk;
+    cg_var *cvi;
+    int     cmp = 1;
+
+    *x0cp = NULL;
+    if (yc == NULL || xml_spec(x1c) != yc)
+        return 0;
+#ifndef STATE_ORDERED_BY_SYSTEM
+    if (yang_config_ancestor(yc) == 0)
+        return 0;
+#endif
+    switch (yang_keyword_get(yc)){
+    case Y_LIST:
+        cvk = yang_cvec_get(yc);
+        cvi = NULL;
+        while ((cvi = cvec_each(cvk, cvi)) != NULL)
+            if (xml_find(x1c, cv_string_get(cvi)) == NULL) /* key absent */
+                return 0;
+        /* fall thru */
+    case Y_LEAF_LIST:
+        if (yang_find(yc, Y_ORDERED_BY, "user") != NULL)
+            return 0;
+        break;
+    default:
+        break;
+    }
+    /* x1 not sorted here, keep cursor for later children */
+    if (*x1prevp && xml_cmp(*x1prevp, x1c, 0, 0, NULL) > 0)
+        return 0;
+    x0j = *x0jp;
+    while (x0j && (cmp = xml_cmp(x0j, x1c, 0, 0, NULL)) < 0)
+        x0j = xml_child_each(x0, x0j, CX_ELMNT);
+    *x0jp = x0j;
+    *x1prevp = x1c;
+    if (x0j == NULL || cmp != 0)
+        return 1;
+    if (xml_spec(x0j) != yc) /* eg choice */
+        return 0;
+    *x0cp = x0j;
+    return 1;
+}
+
 /*! Merge a base tree x0 with x1 with yang spec y, internal recursive function
  *
  * @param[in]  x0     Base xml tree (can be NULL in add scenarios)
@@ -523,6 +858,8 @@ xml_merge_recurse(cxobj     *x0,  /* the target */
     cxobj          *x0c; /* base child */
     cxobj          *x0b; /* base body */
     cxobj          *x1c; /* mod child */
+    cxobj          *x0j; /* merge-join cursor in base children */
+    cxobj          *x1prev = NULL; /* previous merge-joined mod child */
     char           *x1bstr; /* mod body string */
     yang_stmt      *yc;  /* yang child */
     cbuf           *cbr = NULL; /* Reason buffer */
@@ -596,6 +933,7 @@ xml_merge_recurse(cxobj     *x0,  /* the target */
             goto done;
         }
         i = 0;
+        x0j = xml_child_each(x0, NULL, CX_ELMNT);
         /* Loop through children of the modification tree */
         x1c = NULL;
         while ((x1c = xml_child_each(x1, x1c, CX_ELMNT)) != NULL) {
@@ -631,9 +969,10 @@ xml_merge_recurse(cxobj     *x0,  /* the target */
                 }
                 goto fail;
             }
-            /* See if there is a corresponding node in the base tree */
-            x0c = NULL;
-            if (yc && match_base_child(x0, x1c, yc, &x0c) < 0)
+            /* See if there is a corresponding node in the base tree, walking both
+             * sorted child vectors in tandem if possible, otherwise search */
+            if (merge_join_child(x0, &x0j, &x1prev, x1c, yc, &x0c) == 0 &&
+                match_base_child(x0, x1c, yc, &x0c) < 0)
                 goto done;
             /* If x0 already has a value, do not replace it with a default value in x1 */
             if (x0c && xml_flag(x1c, XML_FLAG_DEFAULT))
@@ -1056,12 +1395,13 @@ xml_node_eq(cxobj *x0,
 
 /*! Rebase conflict, add netconf errmsg if first and print debug
  *
- * The values of the xpaths are context-dependent and dependent on the algorithm
- * The Error message gives some interpretation of the xpaths
+ * The nodes are context-dependent and dependent on the algorithm
+ * The Error message gives some interpretation of the xpaths of the nodes
+ * XPaths are only computed here, ie when a conflict occurs
  * @param[in]  h       Clixon handle
- * @param[in]  xpath0  XPath of origin
- * @param[in]  xpath1  XPath of candidate
- * @param[in]  xpath2  XPath of running
+ * @param[in]  x0      Node of origin, or NULL
+ * @param[in]  x1      Node of candidate, or NULL
+ * @param[in]  x2      Node of running, or NULL
  * @param[in]  value0  Value0
  * @param[in]  value1  Value1
  * @param[in]  msg     Error message
@@ -1071,9 +1411,9 @@ xml_node_eq(cxobj *x0,
  */
 static int
 xml_rebase_conflict(clixon_handle h,
-                    const char   *xpath0,
-                    const char   *xpath1,
-                    const char   *xpath2,
+                    cxobj        *x0,
+                    cxobj        *x1,
+                    cxobj        *x2,
                     const char   *value0,
                     const char   *value1,
                     const char   *msg,
@@ -1081,7 +1421,16 @@ xml_rebase_conflict(clixon_handle h,
 {
     int   retval = -1;
     cbuf *cb = NULL;
+    char *xpath0 = NULL;
+    char *xpath1 = NULL;
+    char *xpath2 = NULL;
 
+    if (x0 && xml2xpath(x0, NULL, 0, 0, &xpath0) < 0)
+        goto done;
+    if (x1 && xml2xpath(x1, NULL, 0, 0, &xpath1) < 0)
+        goto done;
+    if (x2 && xml2xpath(x2, NULL, 0, 0, &xpath2) < 0)
+        goto done;
     clixon_debug(CLIXON_DBG_XML, "Conflict occured: %s: xpath0:%s xpath1:%s xpath2:%s",
                  msg, xpath0?xpath0:"", xpath1?xpath1:"", xpath2?xpath2:"");
     if (cbret && cbuf_len(cbret) == 0){
@@ -1105,6 +1454,12 @@ xml_rebase_conflict(clixon_handle h,
     }
     retval = 0;
  done:
+    if (xpath0)
+        free(xpath0);
+    if (xpath1)
+        free(xpath1);
+    if (xpath2)
+        free(xpath2);
     if (cb)
         cbuf_free(cb);
     return retval;
@@ -1136,22 +1491,24 @@ xml_rebase_conflict(clixon_handle h,
  * @param[in]  x0       XML node of db0 (assumed original)
  * @param[in]  x1       XML node of db1 (assumed candidate)
  * @param[in]  x2       XML node of db2 (assumed running)
+ * @param[in]  marked   If set, only compare x0/x2 subtrees marked with XML_FLAG_MARK
  * @param[out] conflict Set to number of conflicts, if any
  * @param[out] cbret    If given, set to rpc-error if conflict>0 of first error
  * @param[out] dr       Diff rebase struct
  * @retval     0        OK
  * @retval    -1        Error
- * @see xml_tree_equal
- * @see xml_diff
+ * @see xml_rebase
+ * @see xml_rebase_marked
  */
-int
-xml_rebase(clixon_handle  h,
-           cxobj         *x0,
-           cxobj         *x1,
-           cxobj         *x2,
-           int           *conflictp,
-           cbuf          *cbret,
-           diff_rebase_t *dr)
+static int
+xml_rebase1(clixon_handle  h,
+            cxobj         *x0,
+            cxobj         *x1,
+            cxobj         *x2,
+            int            marked,
+            int           *conflictp,
+            cbuf          *cbret,
+            diff_rebase_t *dr)
 {
     int        retval = -1;
     cxobj     *x0c;
@@ -1163,45 +1520,45 @@ xml_rebase(clixon_handle  h,
     int        same10;
     int        same20;
     int        same12;
-    char      *xpath0 = NULL;
-    char      *xpath1 = NULL;
-    char      *xpath2 = NULL;
     int        eq1;
     int        eq2;
     char      *value0;
     char      *value1;
     int        conflict = 0;
+    int        ret;
 
+    /* Running is unchanged since origin: nothing to add and no conflicts */
+    if (x0 && x2){
+        if ((ret = xml_digest_equal(x0, x2)) < 0)
+            goto done;
+        if (ret == 1)
+            goto ok;
+    }
+    /* Running is unchanged since origin in this subtree */
+    if (marked && x0 && x2 &&
+        xml_flag(x0, XML_FLAG_MARK) == 0 && xml_flag(x2, XML_FLAG_MARK) == 0)
+        goto ok;
     x0c = x1c = x2c = NULL;
     x0c = xml_child_each(x0, x0c, CX_ELMNT);
     x1c = xml_child_each(x1, x1c, CX_ELMNT);
     x2c = xml_child_each(x2, x2c, CX_ELMNT);
     while (x0c != NULL || x1c != NULL || x2c != NULL){
-        if (x0c){
-            if (xml2xpath(x0c, NULL, 0, 0, &xpath0) < 0)
-                goto done;
+        if (x0c)
             y0c = xml_spec(x0c);
-        }
-        if (x1c){
-            if (xml2xpath(x1c, NULL, 0, 0, &xpath1) < 0)
-                goto done;
+        if (x1c)
             y1c = xml_spec(x1c);
-        }
-        if (x2c){
-            if (xml2xpath(x2c, NULL, 0, 0, &xpath2) < 0)
-                goto done;
-            // y2c = xml_spec(x2c);
-        }
+        // if (x2c)
+        //     y2c = xml_spec(x2c);
         /* Special error case if origin is not YANG bound */
         if (x0c && x1c && strcmp(xml_name(x0c), xml_name(x1c)) == 0){
             if (y0c == NULL && y1c != NULL){
-                if (xml_rebase_conflict(h, xpath0, NULL, NULL, NULL, NULL, "Origin is not bound to yang, but new is", cbret) < 0)
+                if (xml_rebase_conflict(h, x0c, NULL, NULL, NULL, NULL, "Origin is not bound to yang, but new is", cbret) < 0)
                     goto done;
                 conflict++;
                 break;
             }
             if (y0c != NULL && y1c == NULL){
-                if (xml_rebase_conflict(h, xpath0, NULL, NULL, NULL, NULL, "Orig node is bound to yang, but new is not", cbret) < 0)
+                if (xml_rebase_conflict(h, x0c, NULL, NULL, NULL, NULL, "Orig node is bound to yang, but new is not", cbret) < 0)
                     goto done;
                 conflict++;
                 break;
@@ -1219,13 +1576,13 @@ xml_rebase(clixon_handle  h,
             if (same20 < 0){
                 if (same12 == 0){
                     if (xml_tree_equal(x1c, x2c) != 0){
-                        if (xml_rebase_conflict(h, NULL, xpath1, NULL, NULL, NULL,
+                        if (xml_rebase_conflict(h, NULL, x1c, NULL, NULL, NULL,
                                                 "Cannot add node, it is already added", cbret) < 0)
                             goto done;
                         conflict++;
                     }
                     else if (y1c && yang_keyword_get(y1c) == Y_LEAF){
-                        if (xml_rebase_conflict(h, NULL, xpath1, NULL, NULL, NULL,
+                        if (xml_rebase_conflict(h, NULL, x1c, NULL, NULL, NULL,
                                                 "Cannot add leaf node, another leaf node is added", cbret) < 0)
                             goto done;
                         conflict++;
@@ -1233,7 +1590,7 @@ xml_rebase(clixon_handle  h,
                 }
 
                 else if (y1c && yang_keyword_get(y1c) == Y_LEAF_LIST){
-                    if (xml_rebase_conflict(h, NULL, xpath1, NULL, NULL, NULL,
+                    if (xml_rebase_conflict(h, NULL, x1c, NULL, NULL, NULL,
                                             "Cannot add leaf-list node, another leaf-list node is added", cbret) < 0)
                         goto done;
                     conflict++;
@@ -1253,6 +1610,14 @@ xml_rebase(clixon_handle  h,
                 goto next;
             }
             else if (same20 == 0){
+                if (marked &&
+                    xml_flag(x0c, XML_FLAG_MARK) == 0 && xml_flag(x2c, XML_FLAG_MARK) == 0){
+                    /* Unchanged in running: keep x1c as is */
+                    x0c = xml_child_each(x0, x0c, CX_ELMNT);
+                    x1c = xml_child_each(x1, x1c, CX_ELMNT);
+                    x2c = xml_child_each(x2, x2c, CX_ELMNT);
+                    goto next;
+                }
                 /* Same node, has value changed? */
                 eq1 = eq2 = 0;
                 if (xml_node_eq(x1c, x0c, &eq1, &value1, &value0) < 0)
@@ -1261,7 +1626,7 @@ xml_rebase(clixon_handle  h,
                     if (xml_node_eq(x2c, x0c, &eq2, NULL, NULL) < 0)
                         goto done;
                     if (eq2 == 0){
-                        if (xml_rebase_conflict(h, xpath0, NULL, NULL, value0, value1,
+                        if (xml_rebase_conflict(h, x0c, NULL, NULL, value0, value1,
                                                 "Cannot change node value, it is already changed", cbret) < 0)
                             goto done;
                         conflict++;
@@ -1284,7 +1649,7 @@ xml_rebase(clixon_handle  h,
                     }
                 }
                 else{ /* x2c deleted -> Conflict if to x1-x0 */
-                    if (xml_rebase_conflict(h, xpath0, NULL, NULL, NULL, NULL,
+                    if (xml_rebase_conflict(h, x0c, NULL, NULL, NULL, NULL,
                                             "Cannot change node value, node is removed", cbret) < 0)
                         goto done;
                     conflict++;
@@ -1300,7 +1665,7 @@ xml_rebase(clixon_handle  h,
             }
             else if (same20 == 0){
                 if (xml_tree_equal(x0c, x2c) != 0){
-                    if (xml_rebase_conflict(h, xpath0, NULL, NULL, NULL, NULL,
+                    if (xml_rebase_conflict(h, x0c, NULL, NULL, NULL, NULL,
                                             "Cannot remove node, node value has changed ", cbret) < 0)
                         goto done;
                     conflict++;
@@ -1309,7 +1674,7 @@ xml_rebase(clixon_handle  h,
                 x2c = xml_child_each(x2, x2c, CX_ELMNT);
             }
             else if (same20 > 0){ /* Deleted both in x1c and x2c */
-                if (xml_rebase_conflict(h, xpath0, NULL, NULL, NULL, NULL,
+                if (xml_rebase_conflict(h, x0c, NULL, NULL, NULL, NULL,
                                         "Cannot remove node, it is already removed", cbret) < 0)
                     goto done;
                 conflict++;
@@ -1317,41 +1682,79 @@ xml_rebase(clixon_handle  h,
             }
             goto next;
         }
-        if (xml_rebase(h, x0c, x1c, x2c, &conflict, cbret, dr) < 0)
+        if (xml_rebase1(h, x0c, x1c, x2c, marked, &conflict, cbret, dr) < 0)
             goto done;
         x0c = xml_child_each(x0, x0c, CX_ELMNT);
         x1c = xml_child_each(x1, x1c, CX_ELMNT);
         x2c = xml_child_each(x2, x2c, CX_ELMNT);
     next:
-        if (xpath0){
-            free(xpath0);
-            xpath0 = NULL;
-        }
-        if (xpath1){
-            free(xpath1);
-            xpath1 = NULL;
-        }
-        if (xpath2){
-            free(xpath2);
-            xpath2 = NULL;
-        }
         // y0c = NULL;
         y1c = NULL;
         // y2c = NULL;
     }
+ ok:
     if (conflictp)
         *conflictp += conflict;
     retval = 0;
  done:
-    if (xpath0)
-        free(xpath0);
-    if (xpath1)
-        free(xpath1);
-    if (xpath2)
-        free(xpath2);
     return retval;
 }
 
+/*! Check if conflict when rebasing tree x0 to x2 for x1
+ *
+ * @param[in]  h        Clixon handle
+ * @param[in]  x0       XML node of db0 (assumed original)
+ * @param[in]  x1       XML node of db1 (assumed candidate)
+ * @param[in]  x2       XML node of db2 (assumed running)
+ * @param[out] conflict Set to number of conflicts, if any
+ * @param[out] cbret    If given, set to rpc-error if conflict>0 of first error
+ * @param[out] dr       Diff rebase struct
+ * @retval     0        OK
+ * @retval    -1        Error
+ * @see xml_rebase1 for algorithm
+ * @see xml_tree_equal
+ * @see xml_diff
+ */
+int
+xml_rebase(clixon_handle  h,
+           cxobj         *x0,
+           cxobj         *x1,
+           cxobj         *x2,
+           int           *conflictp,
+           cbuf          *cbret,
+           diff_rebase_t *dr)
+{
+    return xml_rebase1(h, x0, x1, x2, 0, conflictp, cbret, dr);
+}
+
+/*! Incremental rebase restricted to nodes changed in running since origin
+ *
+ * Same as xml_rebase but only x0/x2 nodes marked with XML_FLAG_MARK, and their
+ * ancestors, are compared. The caller marks the nodes changed between x0 and x2,
+ * all other subtrees are assumed equal in x0 and x2 and are not traversed.
+ * @param[in]  h        Clixon handle
+ * @param[in]  x0       XML node of db0 (assumed original)
+ * @param[in]  x1       XML node of db1 (assumed candidate)
+ * @param[in]  x2       XML node of db2 (assumed running)
+ * @param[out] conflict Set to number of conflicts, if any
+ * @param[out] cbret    If given, set to rpc-error if conflict>0 of first error
+ * @param[out] dr       Diff rebase struct
+ * @retval     0        OK
+ * @retval    -1        Error
+ * @see xml_rebase
+ */
+int
+xml_rebase_marked(clixon_handle  h,
+                  cxobj         *x0,
+                  cxobj         *x1,
+                  cxobj         *x2,
+                  int           *conflictp,
+                  cbuf          *cbret,
+                  diff_rebase_t *dr)
+{
+    return xml_rebase1(h, x0, x1, x2, 1, conflictp, cbret, dr);
+}
+
 /*! xml_diff2patch helper function to create or delete node
  *
  * @param[in]  xn      XML tree
@@ -1589,6 +1992,11 @@ xml_diff2patch(cxobj   *x1,
     char      *b1;
     int        eq;
 
+    /* Equal subtrees have no differences */
+    if ((eq = xml_digest_equal(x1, x2)) < 0)
+        goto done;
+    if (eq == 1)
+        goto ok;
     /* Traverse x1 and x2 in lock-step */
     x1c = x2c = NULL;
     x1c = xml_child_each(x1, x1c, CX_ELMNT);
@@ -0,0 +1,874 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+ 
+  Copyright (C) 2009-2016 Olof Hagsand and Benny Holmgren
+  Copyright (C) 2017-2019 Olof Hagsand
+  Copyright (C) 2020-2022 Olof Hagsand and Rubicon Communications, LLC(Netgate)
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2, 
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+
+ * Hash index of YANG list entries keyed by full key tuple
+ *
+ * An index is a set of open-addressing hash tables hanging off an XML parent node, one table
+ * per YANG list (with keys) with children of that parent. A table is built lazily the first time
+ * an exact-key lookup is made on a parent with at least XML_HINDEX_THRESHOLD children, and is
+ * then maintained incrementally:
+ * - Children added (or bound to yang) after the table is built are put on a pending vector,
+ *   since their keys are typically not yet set. Pending entries are hashed at next lookup.
+ * - Children removed are removed from the table (or pending vector).
+ * - Key changes of hashed entries (key leaf value changed, key leaf added or removed) move
+ *   the entry back to the pending vector. This is done before the change, so that the old
+ *   hash can be computed.
+ * A child hashed in its parent's table is marked with XML_FLAG_HINDEX.
+ * Integer and decimal64 keys are hashed on their typed value so that the index matches
+ * xml_cmp() where eg "01" and "1" are equal uint8 keys.
+ * Costs one 16-byte slot (at most half full) per indexed list entry.
+ * @see CLICON_XML_HASH_INDEX
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "clixon_config.h" /* generated by config & autoconf */
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <errno.h>
+#include <string.h>
+
+/* cligen */
+#include <cligen/cligen.h>
+
+/* clixon */
+#include "clixon_queue.h"
+#include "clixon_hash.h"
+#include "clixon_handle.h"
+#include "clixon_yang.h"
+#include "clixon_xml.h"
+#include "clixon_err.h"
+#include "clixon_log.h"
+#include "clixon_debug.h"
+#include "clixon_yang_type.h"
+#include "clixon_xml_vec.h"
+#include "clixon_xml_hindex.h"
+
+
+/* Build index only if parent has at least this many children */
+#define XML_HINDEX_THRESHOLD  64
+
+/* Max number of keys in a list that can be indexed, otherwise revert to binary search */
+#define XML_HINDEX_KEYS_MAX    8
+
+/* Initial number of slots in a table, power of two */
+#define XML_HINDEX_SIZE_START 64
+
+/* Max pending entries (in addition to 1/8 of hashed entries) before a table is dropped */
+#define XML_HINDEX_PENDING_MIN 64
+
+/* Removed slot marker */
+#define HINDEX_TOMB ((cxobj*)1)
+
+/* Build hash tables on lookup, see xml_hindex_enable_set */
+static int _hindex_enable = 0;
+
+/*! Hash table slot
+ */
+struct hindex_slot{
+    cxobj    *hs_x;       /* XML list entry, NULL if empty, HINDEX_TOMB if removed */
+    uint64_t  hs_hash;    /* Hash of key tuple of hs_x */
+};
+
+/*! Key value of one key of a list entry
+ */
+struct hindex_key{
+    char     *hk_str;     /* String value, if not numeric */
+    uint64_t  hk_val;     /* Typed value, if numeric */
+};
+
+/*! Hash table of the entries of one yang list under one XML parent
+ */
+struct xml_hindex{
+    struct xml_hindex  *xh_next;     /* Next table (other list) of same parent */
+    yang_stmt          *xh_yang;     /* Yang list statement */
+    cvec               *xh_cvk;      /* Key names, Y_LIST cache */
+    int                 xh_nkeys;    /* Number of keys */
+    enum cv_type        xh_cvtype[XML_HINDEX_KEYS_MAX]; /* Key type, CGV_STRING if not numeric */
+    uint8_t             xh_fraction[XML_HINDEX_KEYS_MAX]; /* decimal64 fraction-digits */
+    struct hindex_slot *xh_slots;    /* Open-addressing slot vector */
+    size_t              xh_size;     /* Number of slots, power of two */
+    size_t              xh_count;    /* Number of hashed entries */
+    size_t              xh_used;     /* Number of hashed entries + removed slots */
+    cxobj             **xh_pending;  /* Entries added but not yet hashed */
+    size_t              xh_pending_len;
+    size_t              xh_pending_max;
+    int                 xh_disabled; /* Too many entries without valid keys, do not use */
+};
+
+/*! Find key child of a list entry by name without using xml_child_each
+ *
+ * xml_child_each can not be used since callers may be iterating over the same node
+ */
+static cxobj *
+hindex_key_child(cxobj      *xe,
+                 const char *kname)
+{
+    cxobj *xk;
+    char  *name;
+    int    i;
+
+    for (i=0; i<xml_child_nr(xe); i++){
+        if ((xk = xml_child_i(xe, i)) == NULL || xml_type(xk) != CX_ELMNT)
+            continue;
+        name = xml_name(xk);
+        if (name == kname || strcmp(name, kname) == 0)
+            return xk;
+    }
+    return NULL;
+}
+
+/*! Get integer or decimal64 value of cligen variable as 64-bit unsigned
+ */
+static uint64_t
+hindex_cv_val(cg_var *cv)
+{
+    switch (cv_type_get(cv)){
+    case CGV_INT8:
+        return (uint64_t)(int64_t)cv_int8_get(cv);
+    case CGV_INT16:
+        return (uint64_t)(int64_t)cv_int16_get(cv);
+    case CGV_INT32:
+        return (uint64_t)(int64_t)cv_int32_get(cv);
+    case CGV_INT64:
+        return (uint64_t)cv_int64_get(cv);
+    case CGV_UINT8:
+        return cv_uint8_get(cv);
+    case CGV_UINT16:
+        return cv_uint16_get(cv);
+    case CGV_UINT32:
+        return cv_uint32_get(cv);
+    case CGV_UINT64:
+        return cv_uint64_get(cv);
+    case CGV_DEC64:
+        return (uint64_t)cv_dec64_i_get(cv);
+    default:
+        break;
+    }
+    return 0;
+}
+
+/*! Get key tuple of a list entry
+ *
+ * @param[in]  xh    Hash table
+ * @param[in]  xe    XML list entry
+ * @param[out] keys  Key vector of length xh_nkeys
+ * @retval     1     OK
+ * @retval     0     Key missing or invalid, entry can not be hashed
+ * @retval    -1     Error
+ * @note typed value is cached in key node as in xml_cmp()
+ */
+static int
+hindex_keys(struct xml_hindex *xh,
+            cxobj             *xe,
+            struct hindex_key *keys)
+{
+    int     retval = -1;
+    cxobj  *xk;
+    char   *body;
+    cg_var *cv;
+    char   *reason = NULL;
+    int     i;
+    int     ret;
+
+    for (i=0; i<xh->xh_nkeys; i++){
+        if ((xk = hindex_key_child(xe, cv_string_get(cvec_i(xh->xh_cvk, i)))) == NULL)
+            goto fail;
+        if ((body = xml_body(xk)) == NULL)
+            body = ""; /* xml_cmp treats no body and empty body as equal */
+        if (xh->xh_cvtype[i] == CGV_STRING){
+            keys[i].hk_str = body;
+            continue;
+        }
+        if ((cv = xml_cv(xk)) == NULL || cv_type_get(cv) != xh->xh_cvtype[i]){
+            if ((cv = cv_new(xh->xh_cvtype[i])) == NULL){
+                clixon_err(OE_YANG, errno, "cv_new");
+                goto done;
+            }
+            if (xh->xh_cvtype[i] == CGV_DEC64)
+                cv_dec64_n_set(cv, xh->xh_fraction[i]);
+            if ((ret = cv_parse1(body, cv, &reason)) < 0){
+                clixon_err(OE_YANG, errno, "cv_parse1");
+                cv_free(cv);
+                goto done;
+            }
+            if (ret == 0){
+                cv_free(cv);
+                goto fail;
+            }
+            if (xml_cv_set(xk, cv) < 0)
+                goto done;
+        }
+        keys[i].hk_val = hindex_cv_val(cv);
+    }
+    retval = 1;
+ done:
+    if (reason)
+        free(reason);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! FNV-1a hash of key tuple
+ */
+static uint64_t
+hindex_hash(struct xml_hindex *xh,
+            struct hindex_key *keys)
+{
+    uint64_t       h = 14695981039346656037ULL;
+    unsigned char *p;
+    int            i;
+    int            j;
+
+    for (i=0; i<xh->xh_nkeys; i++){
+        if (xh->xh_cvtype[i] == CGV_STRING){
+            for (p = (unsigned char*)keys[i].hk_str; *p; p++){
+                h ^= *p;
+                h *= 1099511628211ULL;
+            }
+        }
+        else
+            for (j=0; j<8; j++){
+                h ^= (keys[i].hk_val >> (j*8)) & 0xff;
+                h *= 1099511628211ULL;
+            }
+        h ^= 0xff; /* key separator */
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+/*! Compare two key tuples
+ *
+ * @retval  1  Equal
+ * @retval  0  Not equal
+ */
+static int
+hindex_keys_eq(struct xml_hindex *xh,
+               struct hindex_key *k1,
+               struct hindex_key *k2)
+{
+    int i;
+
+    for (i=0; i<xh->xh_nkeys; i++){
+        if (xh->xh_cvtype[i] == CGV_STRING){
+            if (strcmp(k1[i].hk_str, k2[i].hk_str) != 0)
+                return 0;
+        }
+        else if (k1[i].hk_val != k2[i].hk_val)
+            return 0;
+    }
+    return 1;
+}
+
+/*! Put entry in slot vector without resize
+ */
+static void
+hindex_slot_put(struct hindex_slot *slots,
+                size_t              size,
+                cxobj              *x,
+                uint64_t            hash)
+{
+    size_t i;
+
+    i = hash & (size-1);
+    while (slots[i].hs_x != NULL && slots[i].hs_x != HINDEX_TOMB)
+        i = (i+1) & (size-1);
+    slots[i].hs_x = x;
+    slots[i].hs_hash = hash;
+}
+
+/*! Resize slot vector so that it is at most half full, and remove tombstones
+ */
+static int
+hindex_resize(struct xml_hindex *xh)
+{
+    int                 retval = -1;
+    struct hindex_slot *slots;
+    size_t              size;
+    size_t              i;
+
+    size = XML_HINDEX_SIZE_START;
+    while (size < 2*(xh->xh_count+1))
+        size *= 2;
+    if ((slots = calloc(size, sizeof(struct hindex_slot))) == NULL){
+        clixon_err(OE_XML, errno, "calloc");
+        goto done;
+    }
+    for (i=0; i<xh->xh_size; i++){
+        if (xh->xh_slots[i].hs_x != NULL && xh->xh_slots[i].hs_x != HINDEX_TOMB)
+            hindex_slot_put(slots, size, xh->xh_slots[i].hs_x, xh->xh_slots[i].hs_hash);
+    }
+    if (xh->xh_slots)
+        free(xh->xh_slots);
+    xh->xh_slots = slots;
+    xh->xh_size = size;
+    xh->xh_used = xh->xh_count;
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Hash list entry into table, or keep it pending if keys are not complete
+ *
+ * @param[in]  xh  Hash table
+ * @param[in]  xe  XML list entry
+ * @retval     1   Hashed
+ * @retval     0   Not hashed, keys are missing or invalid
+ * @retval    -1   Error
+ */
+static int
+hindex_insert(struct xml_hindex *xh,
+              cxobj             *xe)
+{
+    int               retval = -1;
+    struct hindex_key keys[XML_HINDEX_KEYS_MAX];
+    int               ret;
+
+    if ((ret = hindex_keys(xh, xe, keys)) < 0)
+        goto done;
+    if (ret == 0){
+        retval = 0;
+        goto done;
+    }
+    if (4*(xh->xh_used+1) > 3*xh->xh_size)
+        if (hindex_resize(xh) < 0)
+            goto done;
+    hindex_slot_put(xh->xh_slots, xh->xh_size, xe, hindex_hash(xh, keys));
+    xh->xh_count++;
+    xh->xh_used++;
+    xml_flag_set(xe, XML_FLAG_HINDEX);
+    retval = 1;
+ done:
+    return retval;
+}
+
+/*! Remove hashed list entry from table
+ *
+ * The hash is computed from the present keys of the entry, if not found, all slots are scanned
+ * @param[in]  xh  Hash table
+ * @param[in]  xe  XML list entry
+ * @retval     0   OK
+ * @retval    -1   Error
+ */
+static int
+hindex_remove(struct xml_hindex *xh,
+              cxobj             *xe)
+{
+    int               retval = -1;
+    struct hindex_key keys[XML_HINDEX_KEYS_MAX];
+    size_t            i;
+    int               ret;
+
+    xml_flag_reset(xe, XML_FLAG_HINDEX);
+    if (xh->xh_size == 0)
+        goto ok;
+    if ((ret = hindex_keys(xh, xe, keys)) < 0)
+        goto done;
+    if (ret == 1){
+        i = hindex_hash(xh, keys) & (xh->xh_size-1);
+        while (xh->xh_slots[i].hs_x != NULL){
+            if (xh->xh_slots[i].hs_x == xe)
+                goto found;
+            i = (i+1) & (xh->xh_size-1);
+        }
+    }
+    for (i=0; i<xh->xh_size; i++) /* Fallback */
+        if (xh->xh_slots[i].hs_x == xe)
+            goto found;
+ ok:
+    retval = 0;
+ done:
+    return retval;
+ found:
+    xh->xh_slots[i].hs_x = HINDEX_TOMB;
+    xh->xh_count--;
+    goto ok;
+}
+
+/*! Add entry to pending vector
+ */
+static int
+hindex_pending_add(struct xml_hindex *xh,
+                   cxobj             *xe)
+{
+    int retval = -1;
+
+    if (xh->xh_pending_len >= xh->xh_pending_max){
+        xh->xh_pending_max = xh->xh_pending_max?2*xh->xh_pending_max:XML_HINDEX_PENDING_MIN;
+        if ((xh->xh_pending = realloc(xh->xh_pending,
+                                      xh->xh_pending_max*sizeof(cxobj*))) == NULL){
+            clixon_err(OE_XML, errno, "realloc");
+            goto done;
+        }
+    }
+    xh->xh_pending[xh->xh_pending_len++] = xe;
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Remove entry from pending vector, search from end since recent entries are likely
+ */
+static void
+hindex_pending_rm(struct xml_hindex *xh,
+                  cxobj             *xe)
+{
+    size_t i;
+
+    for (i=xh->xh_pending_len; i>0; i--)
+        if (xh->xh_pending[i-1] == xe){
+            xh->xh_pending[i-1] = xh->xh_pending[--xh->xh_pending_len];
+            break;
+        }
+}
+
+/*! Free one hash table
+ */
+static void
+hindex_table_free(struct xml_hindex *xh)
+{
+    if (xh->xh_slots)
+        free(xh->xh_slots);
+    if (xh->xh_pending)
+        free(xh->xh_pending);
+    free(xh);
+}
+
+/*! Find hash table of yang list under XML parent
+ */
+static struct xml_hindex *
+hindex_table_get(cxobj     *xp,
+                 yang_stmt *y)
+{
+    struct xml_hindex *xh;
+
+    for (xh = xml_hindex(xp); xh; xh = xh->xh_next)
+        if (xh->xh_yang == y)
+            return xh;
+    return NULL;
+}
+
+/*! Reset index flag of all hashed children of XML parent
+ */
+static void
+hindex_flags_reset(cxobj             *xp,
+                   struct xml_hindex *xh)
+{
+    cxobj *xc;
+    int    i;
+
+    for (i=0; i<xml_child_nr(xp); i++)
+        if ((xc = xml_child_i(xp, i)) != NULL && xml_spec(xc) == xh->xh_yang)
+            xml_flag_reset(xc, XML_FLAG_HINDEX);
+}
+
+/*! Remove hash table from XML parent and free it, it is rebuilt at next lookup
+ */
+static void
+hindex_table_drop(cxobj             *xp,
+                  struct xml_hindex *xh)
+{
+    struct xml_hindex *xprev;
+
+    if (xml_hindex(xp) == xh)
+        xml_hindex_set(xp, xh->xh_next);
+    else {
+        for (xprev = xml_hindex(xp); xprev && xprev->xh_next != xh; xprev = xprev->xh_next);
+        if (xprev)
+            xprev->xh_next = xh->xh_next;
+    }
+    hindex_flags_reset(xp, xh);
+    hindex_table_free(xh);
+}
+
+/*! Disable hash table, entries are reverted to binary search
+ *
+ * Used if too many entries have missing or invalid keys, to not rebuild the table repeatedly
+ */
+static void
+hindex_table_disable(cxobj             *xp,
+                     struct xml_hindex *xh)
+{
+    hindex_flags_reset(xp, xh);
+    if (xh->xh_slots)
+        free(xh->xh_slots);
+    xh->xh_slots = NULL;
+    xh->xh_size = xh->xh_count = xh->xh_used = 0;
+    if (xh->xh_pending)
+        free(xh->xh_pending);
+    xh->xh_pending = NULL;
+    xh->xh_pending_len = xh->xh_pending_max = 0;
+    xh->xh_disabled = 1;
+}
+
+/*! Create and build hash table of yang list under XML parent
+ *
+ * @param[in]  xp   XML parent
+ * @param[in]  y    Yang list
+ * @param[out] xhp  Hash table, disabled if list can not be indexed
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+hindex_table_new(cxobj              *xp,
+                 yang_stmt          *y,
+                 struct xml_hindex **xhp)
+{
+    int                retval = -1;
+    struct xml_hindex *xh = NULL;
+    yang_stmt         *yk;
+    yang_stmt         *yrestype;
+    int                options;
+    uint8_t            fraction;
+    enum cv_type       cvtype;
+    cxobj             *xc;
+    int                i;
+    int                ret;
+
+    *xhp = NULL;
+    if ((xh = malloc(sizeof(*xh))) == NULL){
+        clixon_err(OE_XML, errno, "malloc");
+        goto done;
+    }
+    memset(xh, 0, sizeof(*xh));
+    xh->xh_yang = y;
+    xh->xh_cvk = yang_cvec_get(y); /* Use Y_LIST cache, see ys_populate_list() */
+    if ((xh->xh_nkeys = cvec_len(xh->xh_cvk)) == 0 ||
+        xh->xh_nkeys > XML_HINDEX_KEYS_MAX){
+        xh->xh_disabled = 1;
+        goto add;
+    }
+    for (i=0; i<xh->xh_nkeys; i++){
+        xh->xh_cvtype[i] = CGV_STRING;
+        if ((yk = yang_find(y, Y_LEAF, cv_string_get(cvec_i(xh->xh_cvk, i)))) == NULL)
+            continue;
+        yrestype = NULL;
+        options = 0;
+        fraction = 0;
+        if (yang_type_get(yk, NULL, &yrestype, &options, NULL, NULL, NULL, &fraction) < 0)
+            goto done;
+        if (yrestype == NULL)
+            continue;
+        yang2cv_type(yang_argument_get(yrestype), &cvtype);
+        if (cvtype >= CGV_INT8 && cvtype <= CGV_DEC64){
+            xh->xh_cvtype[i] = cvtype;
+            xh->xh_fraction[i] = fraction;
+        }
+    }
+    for (i=0; i<xml_child_nr(xp); i++){
+        if ((xc = xml_child_i(xp, i)) == NULL || xml_spec(xc) != y)
+            continue;
+        xml_flag_reset(xc, XML_FLAG_HINDEX);
+        if ((ret = hindex_insert(xh, xc)) < 0)
+            goto done;
+        if (ret == 0 && hindex_pending_add(xh, xc) < 0)
+            goto done;
+    }
+ add:
+    xh->xh_next = xml_hindex(xp);
+    xml_hindex_set(xp, xh);
+    *xhp = xh;
+    xh = NULL;
+    retval = 0;
+ done:
+    if (xh)
+        hindex_table_free(xh);
+    return retval;
+}
+
+/*! Hash pending entries whose keys are now complete
+ *
+ * @param[in]  xp   XML parent
+ * @param[in]  xh   Hash table
+ * @retval     1    OK
+ * @retval     0    Too many entries can not be hashed, table disabled
+ * @retval    -1    Error
+ */
+static int
+hindex_flush(cxobj             *xp,
+             struct xml_hindex *xh)
+{
+    int    retval = -1;
+    cxobj *xe;
+    size_t i;
+    size_t j;
+    int    ret;
+
+    for (i=0, j=0; i<xh->xh_pending_len; i++){
+        xe = xh->xh_pending[i];
+        if (xml_flag(xe, XML_FLAG_HINDEX))
+            continue;
+        if ((ret = hindex_insert(xh, xe)) < 0)
+            goto done;
+        if (ret == 0)
+            xh->xh_pending[j++] = xe;
+    }
+    xh->xh_pending_len = j;
+    if (j > XML_HINDEX_PENDING_MIN + xh->xh_count/8){
+        hindex_table_disable(xp, xh);
+        retval = 0;
+        goto done;
+    }
+    retval = 1;
+ done:
+    return retval;
+}
+
+/*! Enable hash index of list entries
+ *
+ * Cant use option directly since there is no handle in xml functions.
+ * Tables already built are kept and maintained if disabled.
+ * @param[in]  enable  If set, build hash tables on exact key lookups in large lists
+ * @retval     0       OK
+ * @see CLICON_XML_HASH_INDEX
+ */
+int
+xml_hindex_enable_set(int enable)
+{
+    _hindex_enable = enable;
+    return 0;
+}
+
+/*! Search for list entries with same key tuple as x1 among children of xp using hash index
+ *
+ * The index is created if enabled, it does not exist, and xp has enough children.
+ * @param[in]  xp    XML parent
+ * @param[in]  x1    XML list entry with the keys to search for
+ * @param[in]  yc    Yang list of x1
+ * @param[out] xvec  Vector of matching XML return objects (unchanged if 0 is returned)
+ * @retval     1     Index was used, see xvec (may be empty)
+ * @retval     0     Index not applicable, use binary or linear search instead
+ * @retval    -1     Error
+ */
+int
+xml_hindex_search(cxobj       *xp,
+                  cxobj       *x1,
+                  yang_stmt   *yc,
+                  clixon_xvec *xvec)
+{
+    int                retval = -1;
+    struct xml_hindex *xh;
+    struct hindex_key  keys[XML_HINDEX_KEYS_MAX];
+    struct hindex_key  keys1[XML_HINDEX_KEYS_MAX];
+    uint64_t           hash;
+    size_t             i;
+    cxobj             *xe;
+    int                ret;
+
+    if (yang_keyword_get(yc) != Y_LIST)
+        goto notapplicable;
+    if ((xh = hindex_table_get(xp, yc)) == NULL){
+        if (!_hindex_enable || xml_child_nr(xp) < XML_HINDEX_THRESHOLD)
+            goto notapplicable;
+        if (hindex_table_new(xp, yc, &xh) < 0)
+            goto done;
+    }
+    if (xh->xh_disabled)
+        goto notapplicable;
+    if ((ret = hindex_flush(xp, xh)) < 0)
+        goto done;
+    if (ret == 0)
+        goto notapplicable;
+    if ((ret = hindex_keys(xh, x1, keys1)) < 0)
+        goto done;
+    if (ret == 0)
+        goto notapplicable;
+    if (xh->xh_size == 0)
+        goto ok;
+    hash = hindex_hash(xh, keys1);
+    i = hash & (xh->xh_size-1);
+    while ((xe = xh->xh_slots[i].hs_x) != NULL){
+        if (xe != HINDEX_TOMB && xh->xh_slots[i].hs_hash == hash){
+            if ((ret = hindex_keys(xh, xe, keys)) < 0)
+                goto done;
+            if (ret == 1 && hindex_keys_eq(xh, keys, keys1))
+                if (clixon_xvec_append(xvec, xe) < 0)
+                    goto done;
+        }
+        i = (i+1) & (xh->xh_size-1);
+    }
+ ok:
+    retval = 1;
+ done:
+    return retval;
+ notapplicable:
+    retval = 0;
+    goto done;
+}
+
+/*! XML child has been added to parent or bound to yang, add it to pending if indexed
+ *
+ * @param[in]  xp  XML parent
+ * @param[in]  xc  XML child
+ * @retval     0   OK
+ * @retval    -1   Error
+ */
+int
+xml_hindex_child_add(cxobj *xp,
+                     cxobj *xc)
+{
+    int                retval = -1;
+    struct xml_hindex *xh;
+
+    xml_flag_reset(xc, XML_FLAG_HINDEX);
+    if (xml_spec(xc) == NULL ||
+        (xh = hindex_table_get(xp, xml_spec(xc))) == NULL ||
+        xh->xh_disabled)
+        goto ok;
+    if (xh->xh_pending_len >= XML_HINDEX_PENDING_MIN + xh->xh_count/8){
+        hindex_table_drop(xp, xh); /* Rebuilt at next lookup */
+        goto ok;
+    }
+    if (hindex_pending_add(xh, xc) < 0)
+        goto done;
+ ok:
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! XML child is about to be removed from parent, or its yang binding is about to change
+ *
+ * @param[in]  xp  XML parent
+ * @param[in]  xc  XML child
+ * @retval     0   OK
+ * @retval    -1   Error
+ */
+int
+xml_hindex_child_rm(cxobj *xp,
+                    cxobj *xc)
+{
+    int                retval = -1;
+    struct xml_hindex *xh;
+
+    if (xml_spec(xc) == NULL ||
+        (xh = hindex_table_get(xp, xml_spec(xc))) == NULL ||
+        xh->xh_disabled){
+        xml_flag_reset(xc, XML_FLAG_HINDEX);
+        goto ok;
+    }
+    if (xml_flag(xc, XML_FLAG_HINDEX)){
+        if (hindex_remove(xh, xc) < 0)
+            goto done;
+    }
+    else
+        hindex_pending_rm(xh, xc);
+ ok:
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Key of hashed list entry is about to change, move entry to pending
+ *
+ * @param[in]  xe  XML list entry
+ * @param[in]  xk  XML child of xe that is about to change (or be added/removed)
+ * @retval     0   OK
+ * @retval    -1   Error
+ */
+int
+xml_hindex_key_change(cxobj *xe,
+                      cxobj *xk)
+{
+    int                retval = -1;
+    struct xml_hindex *xh;
+    cxobj             *xp;
+    char              *name;
+    int                i;
+
+    if (!xml_flag(xe, XML_FLAG_HINDEX) ||
+        (xp = xml_parent(xe)) == NULL ||
+        (xh = hindex_table_get(xp, xml_spec(xe))) == NULL ||
+        xh->xh_disabled)
+        goto ok;
+    if (xml_type(xk) != CX_ELMNT)
+        goto ok;
+    name = xml_name(xk);
+    for (i=0; i<xh->xh_nkeys; i++)
+        if (strcmp(name, cv_string_get(cvec_i(xh->xh_cvk, i))) == 0)
+            break;
+    if (i == xh->xh_nkeys) /* Not a key */
+        goto ok;
+    if (hindex_remove(xh, xe) < 0)
+        goto done;
+    if (hindex_pending_add(xh, xe) < 0)
+        goto done;
+ ok:
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Free all hash tables of XML parent
+ *
+ * @param[in]  xp  XML parent
+ * @retval     0   OK
+ */
+int
+xml_hindex_free(cxobj *xp)
+{
+    struct xml_hindex *xh;
+
+    while ((xh = xml_hindex(xp)) != NULL){
+        xml_hindex_set(xp, xh->xh_next);
+        hindex_table_free(xh);
+    }
+    return 0;
+}
+
+/*! Get memory size of all hash tables of XML parent
+ *
+ * @param[in]  xp  XML parent
+ * @retval     sz  Size in bytes
+ */
+size_t
+xml_hindex_size(cxobj *xp)
+{
+    struct xml_hindex *xh;
+    size_t             sz = 0;
+
+    for (xh = xml_hindex(xp); xh; xh = xh->xh_next)
+        sz += sizeof(*xh) +
+            xh->xh_size*sizeof(struct hindex_slot) +
+            xh->xh_pending_max*sizeof(cxobj*);
+    return sz;
+}
+
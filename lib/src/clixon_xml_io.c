@@ -71,6 +71,7 @@
 #include "clixon_err.h"
 #include "clixon_log.h"
 #include "clixon_debug.h"
+#include "clixon_trace.h"
 #include "clixon_options.h"
 #include "clixon_yang_module.h"
 #include "clixon_yang_schema_mount.h"
@@ -94,6 +95,27 @@
 
 /* Forward */
 static int xml_diff2cbuf(cbuf *cb, cxobj *x0, cxobj *x1, int level, int skiptop);
+static int xml2file_print_cb(cbuf *cb, void *arg);
+
+/* Parameters of clixon_xml2file1 given to xml2file_print_cb */
+struct xml2file_print {
+    cxobj            *xp_x;
+    int               xp_level;
+    int               xp_pretty;
+    const char       *xp_prefix;
+    int               xp_skiptop;
+    int               xp_autocliext;
+    withdefaults_type xp_wdef;
+    int               xp_multi;
+    int               xp_system_only;
+};
+
+/* Streaming of XML printed to a cligen buffer, see clixon_xml2cbuf_stream */
+static cbuf                *_stream_cb = NULL;
+static clixon_xml_flush_fn *_stream_fn = NULL;
+static void                *_stream_arg = NULL;
+static size_t               _stream_size = 0;
+static size_t               _stream_flushed = 0;
 
 /*------------------------------------------------------------------------
  * XML printing functions. Output a parse tree to file, string cligen buf
@@ -108,7 +130,7 @@ static int xml_diff2cbuf(cbuf *cb, cxobj *x0, cxobj *x1, int level, int skiptop)
  * @retval      0    Remove it
  * @retval     -1    Error
  */
-static int
+int
 xml2output_wdef(cxobj            *x,
                 withdefaults_type wdef,
                 int              *tag)
@@ -192,213 +214,6 @@ xml2output_wdef(cxobj            *x,
     return retval;
 }
 
-/*! Print an XML tree structure to an output stream and encode chars "<>&"
- *
- * @param[in]   f          UNIX output stream
- * @param[in]   x          Clixon xml tree
- * @param[in]   level      How many spaces to insert before each line
- * @param[in]   pretty     Insert \n and spaces to make the xml more readable.
- * @param[in]   prefix     Add string to beginning of each line (if pretty)
- * @param[in]   fn         Callback to make print function
- * @param[in]   autocliext How to handle autocli extensions: 0: ignore 1: follow
- * @param[in]   wdef       With-defaults parameter, default is WITHDEFAULTS_REPORT_ALL
- * @param[in]   multi      Multi-file split datastore, see CLICON_XMLDB_MULTI
- * @param[in]   system_only Enable checks for system-only-config extension
- * @retval      0          OK
- * @retval     -1          Error
- * One can use clixon_xml2cbuf to get common code, but using fprintf is
- * much faster than using cbuf and then printing that,...
- * wdef changes the output as follows:
- * - WITHDEFAULTS_REPORT_ALL        - keep as-is
- * - WITHDEFAULTS_TRIM              - remove defaults + equal value, and no-presence
- * - WITHDEFAULTS_EXPLICIT          - remove defaults and no-presence
- * - WITHDEFAULTS_REPORT_ALL_TAGGED
- * @see xml2cbuf_recurse same with cbuf
- */
-static int
-xml2file_recurse(FILE                *f,
-                 cxobj               *x,
-                 int                  level,
-                 int                  pretty,
-                 const char          *prefix,
-                 clicon_output_cb    *fn,
-                 int                  autocliext,
-                 withdefaults_type    wdef,
-                 int                  multi,
-                 int                  system_only)
-{
-    int        retval = -1;
-    char      *name;
-    char      *namespace;
-    cxobj     *xc;
-    int        hasbody;
-    int        haselement;
-    char      *val;
-    char      *encstr = NULL; /* xml encoded string */
-    int        exist;
-    yang_stmt *y;
-    int        level1;
-    int        tag = 0;
-    int        subfile = 0;   /* File is split into subfile */
-    char      *xpath = NULL;
-    char      *hexstr = NULL;
-    int        ret;
-
-    if (x == NULL)
-        goto ok;
-    y = xml_spec(x);
-    /* Check if system-only, then do not write to datastore
-     */
-    if (y != NULL && system_only){
-        exist = 0;
-        if (yang_extension_value(y, "system-only-config", CLIXON_LIB_NS, &exist, NULL) < 0)
-            goto done;
-        if (exist){
-            goto ok;
-        }
-    }
-    level1 = level*PRETTYPRINT_INDENT;
-    if (y != NULL){
-        if (autocliext){
-            exist = 0;
-            if (yang_extension_value(y, "hide-show", CLIXON_AUTOCLI_NS, &exist, NULL) < 0)
-                goto done;
-            if (exist)
-                goto ok;
-        }
-        if ((ret = xml2output_wdef(x, wdef, &tag)) < 0)
-            goto done;
-        if (ret == 0)
-            goto ok;
-    }
-    name = xml_name(x);
-    namespace = xml_prefix(x);
-    switch(xml_type(x)){
-    case CX_BODY:
-        if ((val = xml_value(x)) == NULL) /* incomplete tree */
-            break;
-        if (xml_chardata_encode(&encstr, 0, "%s", val) < 0)
-            goto done;
-        (*fn)(f, "%s", encstr);
-        break;
-    case CX_ATTR:
-        (*fn)(f, " ");
-        if (namespace)
-            (*fn)(f, "%s:", namespace);
-        (*fn)(f, "%s=\"%s\"", name, xml_value(x));
-        break;
-    case CX_ELMNT:
-        if (pretty && prefix)
-            (*fn)(f, "%s", prefix);
-        (*fn)(f, "%*s<", pretty?level1:0, "");
-        if (namespace)
-            (*fn)(f, "%s:", namespace);
-        (*fn)(f, "%s", name);
-        if (tag) /* If default and WITHDEFAULTS_REPORT_ALL_TAGGED */
-            (*fn)(f, " wd:default=\"true\"");
-        hasbody = 0;
-        haselement = 0;
-        xc = NULL;
-        /* print attributes only */
-        while ((xc = xml_child_each(x, xc, -1)) != NULL) {
-            switch (xml_type(xc)){
-            case CX_ATTR:
-                if (xml2file_recurse(f, xc, level+1, pretty, prefix, fn, autocliext, wdef, multi, system_only) < 0)
-                    goto done;
-                break;
-            case CX_BODY:
-                hasbody=1;
-                break;
-            case CX_ELMNT:
-                haselement=1;
-                break;
-            default:
-                break;
-            }
-        }
-        /* Check for special case <a/> instead of <a></a>:
-         * Ie, no CX_BODY or CX_ELMNT child.
-         */
-        if (hasbody==0 && haselement==0)
-            (*fn)(f, "/>");
-        else{
-            /* Check if this is a multi-file split-point */
-            if (multi && (y = xml_spec(x)) != NULL){
-                if (yang_extension_value(y, "xmldb-split", CLIXON_LIB_NS, &exist, NULL) < 0)
-                    goto done;
-                if (exist){
-                    subfile++;
-                    if (xml2xpath(x, NULL, 1, 0, &xpath) < 0)
-                        goto done;
-                    if (clixon_digest_hex(xpath, &hexstr) < 0)
-                        goto done;
-                    (*fn)(f, " xmlns:%s=\"%s\"", CLIXON_LIB_PREFIX, CLIXON_LIB_NS);
-                    (*fn)(f, " %s:link=\"%s.xml\"", CLIXON_LIB_PREFIX, hexstr);
-                    (*fn)(f, "/>");
-                }
-            }
-            if (!subfile) {
-                (*fn)(f, ">");
-                if (pretty && hasbody == 0){
-                    (*fn)(f, "\n");
-                }
-            }
-            xc = NULL;
-            while ((xc = xml_child_each(x, xc, -1)) != NULL) {
-                cxobj *xa = NULL;
-                char  *ns = NULL;
-
-                if (wdef == WITHDEFAULTS_REPORT_ALL_TAGGED &&
-                    y == NULL &&
-                    xml_spec(xc) != NULL){
-                    if (xml2ns(xc, IETF_NETCONF_WITH_DEFAULTS_ATTR_PREFIX, &ns) < 0)
-                        goto done;
-                    if (ns == NULL){
-                        if (xmlns_set(xc, IETF_NETCONF_WITH_DEFAULTS_ATTR_PREFIX, IETF_NETCONF_WITH_DEFAULTS_ATTR_NAMESPACE) < 0)
-                            goto done;
-                        xa = xml_find_type(xc, IETF_NETCONF_WITH_DEFAULTS_ATTR_PREFIX, IETF_NETCONF_WITH_DEFAULTS_ATTR_NAMESPACE, CX_ATTR);
-                    }
-                }
-                if (xml_type(xc) != CX_ATTR && !subfile)
-                        if (xml2file_recurse(f, xc, level+1, pretty, prefix,
-                                             fn, autocliext, wdef, multi, system_only) <0)
-                            goto done;
-                if (xa){
-                    if (xml_purge(xa) < 0)
-                        goto done;
-                }
-            }
-            if (subfile == 0){
-                if (pretty && hasbody==0){
-                    if (pretty && prefix)
-                        (*fn)(f, "%s", prefix);
-                    (*fn)(f, "%*s", level1, "");
-                }
-                (*fn)(f, "</");
-                if (namespace)
-                    (*fn)(f, "%s:", namespace);
-                (*fn)(f, "%s>", name);
-            }
-        }
-        if (pretty){
-            (*fn)(f, "\n");
-        }
-        break;
-    default:
-        break;
-    }/* switch */
- ok:
-    retval = 0;
- done:
-    if (encstr)
-        free(encstr);
-    if (xpath)
-        free(xpath);
-    if (hexstr)
-        free(hexstr);
-    return retval;
-}
-
 /*! Print an XML tree structure to an output stream and encode chars "<>&"
  *
  * Extended version with with-defaults
@@ -417,6 +232,7 @@ xml2file_recurse(FILE                *f,
  * @retval     0          OK
  * @retval    -1          Error
  * @see clixon_xml2cbuf print to a cbuf string
+ * @see clixon_xml2file_stream
  * @note There is a slight "layer violation" with the autocli parameter: it should normally be set
  *       for CLI calls, but not for others.
  */
@@ -433,24 +249,9 @@ clixon_xml2file1(FILE                *f,
                  int                  multi,
                  int                  system_only)
 {
-    int   retval = 1;
-    cxobj *xc;
+    struct xml2file_print xp = {xn, level, pretty, prefix, skiptop, autocliext, wdef, multi, system_only};
 
-    if (fn == NULL)
-        fn = fprintf;
-    if (skiptop){
-        xc = NULL;
-        while ((xc = xml_child_each(xn, xc, CX_ELMNT)) != NULL)
-            if (xml2file_recurse(f, xc, level, pretty, prefix, fn, autocliext, wdef, multi, system_only) < 0)
-                goto done;
-    }
-    else {
-        if (xml2file_recurse(f, xn, level, pretty, prefix, fn, autocliext, wdef, multi, system_only) < 0)
-            goto done;
-    }
-    retval = 0;
- done:
-    return retval;
+    return clixon_xml2file_stream(f, fn, xml2file_print_cb, &xp);
 }
 
 /*! Print an XML tree structure to an output stream and encode chars "<>&"
@@ -496,7 +297,7 @@ int
 xml_print(FILE  *f,
           cxobj *x)
 {
-    return xml2file_recurse(f, x, 0, 1, NULL, fprintf, 0, WITHDEFAULTS_REPORT_ALL, 0, 0);
+    return clixon_xml2file1(f, x, 0, 1, NULL, fprintf, 0, 0, WITHDEFAULTS_REPORT_ALL, 0, 0);
 }
 
 /*! Print one-level XML tree
@@ -583,6 +384,130 @@ xml_dump(FILE  *f,
     return xml_dump1(f, x, 0);
 }
 
+/*! Stream XML printed to a cligen buffer in parts instead of as a whole
+ *
+ * When the buffer has grown to at least size bytes after an element has been printed,
+ * its contents is given to fn and the buffer is reset. This bounds the buffer when
+ * printing large trees, eg the output may be sent while it is being printed.
+ * Only one buffer is streamed at a time.
+ * @param[in]  cb    Cligen buffer to stream, or NULL to stop streaming
+ * @param[in]  fn    Flush function, called with contents of cb
+ * @param[in]  arg   Argument to fn
+ * @param[in]  size  Min number of bytes in cb before flush
+ * @retval     0     OK
+ * @code
+ *   clixon_xml2cbuf_stream(cb, myflush, arg, 65536);
+ *   if (clixon_xml2cbuf(cb, xn, 0, 0, NULL, -1, 0) < 0)
+ *     err;
+ *   flushed = clixon_xml2cbuf_stream_flushed();
+ *   clixon_xml2cbuf_stream(NULL, NULL, NULL, 0);
+ *   // Rest of output is in cb
+ * @endcode
+ * @see clixon_msg_send11_chunk
+ */
+int
+clixon_xml2cbuf_stream(cbuf                *cb,
+                       clixon_xml_flush_fn *fn,
+                       void                *arg,
+                       size_t               size)
+{
+    _stream_cb = fn ? cb : NULL;
+    _stream_fn = fn;
+    _stream_arg = arg;
+    _stream_size = size;
+    _stream_flushed = 0;
+    return 0;
+}
+
+/*! Get number of bytes flushed from the streamed cligen buffer
+ *
+ * @retval     n     Number of bytes flushed since clixon_xml2cbuf_stream
+ */
+size_t
+clixon_xml2cbuf_stream_flushed(void)
+{
+    return _stream_flushed;
+}
+
+/*! Get output position of cligen buffer, including bytes flushed if streamed
+ *
+ * Use instead of cbuf_len to check if something was printed to a buffer that may be streamed
+ * @param[in]  cb    Cligen buffer
+ * @retval     pos   Number of bytes printed
+ */
+size_t
+clixon_xml2cbuf_pos(cbuf *cb)
+{
+    if (cb == _stream_cb)
+        return _stream_flushed + cbuf_len(cb);
+    return cbuf_len(cb);
+}
+
+/*! Flush streamed cligen buffer if it is large enough
+ *
+ * Call only where the output so far is final, eg after an element, since a flushed part
+ * cannot be changed.
+ * @param[in]  cb    Cligen buffer
+ * @retval     0     OK
+ * @retval    -1    Error
+ * @see clixon_xml2cbuf_stream
+ */
+int
+clixon_xml2cbuf_stream_flush(cbuf *cb)
+{
+    size_t len;
+
+    if (cb != _stream_cb || (len = cbuf_len(cb)) < _stream_size)
+        return 0;
+    if ((*_stream_fn)(cbuf_get(cb), len, _stream_arg) < 0)
+        return -1;
+    _stream_flushed += len;
+    cbuf_reset(cb);
+    return 0;
+}
+
+/*! Print link to subfile if element is a multi-file split-point
+ *
+ * @param[in,out] cb    Cligen buffer to write to
+ * @param[in]     x     XML element after its attributes
+ * @param[in]     y     Yang of x
+ * @retval        1     Split-point, link printed instead of children
+ * @retval        0     Not split-point
+ * @retval       -1     Error
+ * @see CLICON_XMLDB_MULTI
+ */
+static int
+xml2cbuf_subfile(cbuf      *cb,
+                 cxobj     *x,
+                 yang_stmt *y)
+{
+    int   retval = -1;
+    int   exist = 0;
+    char *xpath = NULL;
+    char *hexstr = NULL;
+
+    if (yang_extension_value(y, "xmldb-split", CLIXON_LIB_NS, &exist, NULL) < 0)
+        goto done;
+    if (!exist){
+        retval = 0;
+        goto done;
+    }
+    if (xml2xpath(x, NULL, 1, 0, &xpath) < 0)
+        goto done;
+    if (clixon_digest_hex(xpath, &hexstr) < 0)
+        goto done;
+    cprintf(cb, " xmlns:%s=\"%s\"", CLIXON_LIB_PREFIX, CLIXON_LIB_NS);
+    cprintf(cb, " %s:link=\"%s.xml\"", CLIXON_LIB_PREFIX, hexstr);
+    cbuf_append_str(cb, "/>");
+    retval = 1;
+ done:
+    if (xpath)
+        free(xpath);
+    if (hexstr)
+        free(hexstr);
+    return retval;
+}
+
 /*! Internal: print XML tree structure to a cligen buffer and encode chars "<>&"
  *
  * @param[in,out] cb       Cligen buffer to write to
@@ -593,6 +518,10 @@ xml_dump(FILE  *f,
  * @param[in]     depth    Limit levels of child resources: -1 is all, 0 is none, 1 is node itself
  * @param[in]     cli_aware How to handle autocli extensions: 0: ignore 1: follow
  * @param[in]     wdef     With-defaults parameter, default is WITHDEFAULTS_REPORT_ALL
+ * @param[in]     fn       Filter function of elements, or NULL, see clixon_xml2cbuf_filter
+ * @param[in]     arg      Argument of filter function
+ * @param[in]     multi    Multi-file split datastore, see CLICON_XMLDB_MULTI
+ * @param[in]     system_only Enable checks for system-only-config extension
  * @retval        0        OK
  * @retval       -1        Error
  * wdef changes the output as follows:
@@ -600,17 +529,21 @@ xml_dump(FILE  *f,
  * - WITHDEFAULTS_TRIM              - remove defaults + equal value, and no-presence
  * - WITHDEFAULTS_EXPLICIT          - remove defaults and no-presence
  * - WITHDEFAULTS_REPORT_ALL_TAGGED
- * @see xml2file_recurse  same with FILE
+ * This is also used to print to file, see clixon_xml2file_stream
  */
 static int
-xml2cbuf_recurse(cbuf             *cb,
-                 cxobj            *x,
-                 int               level,
-                 int               pretty,
-                 const char       *prefix,
-                 int32_t           depth,
-                 int               cli_aware,
-                 withdefaults_type wdef)
+xml2cbuf_recurse(cbuf                 *cb,
+                 cxobj                *x,
+                 int                   level,
+                 int                   pretty,
+                 const char           *prefix,
+                 int32_t               depth,
+                 int                   cli_aware,
+                 withdefaults_type     wdef,
+                 clixon_xml_filter_fn *fn,
+                 void                 *arg,
+                 int                   multi,
+                 int                   system_only)
 {
     int        retval = -1;
     cxobj     *xc;
@@ -622,13 +555,32 @@ xml2cbuf_recurse(cbuf             *cb,
     int        level1;
     yang_stmt *y;
     int        tag = 0;
+    size_t     pos0 = 0;
+    size_t     len = 0;
+    int        exist;
     int        ret;
 
     if (depth == 0)
         goto ok;
+    if (fn && xml_type(x) == CX_ELMNT){
+        if ((ret = fn(x, arg)) < 0)
+            goto done;
+        if (ret == 0)
+            goto ok;
+        if (ret == 1) /* Rest of subtree is not filtered */
+            fn = NULL;
+    }
     if ((y = xml_spec(x)) != NULL){
+        /* Check if system-only, then do not write to datastore */
+        if (system_only){
+            exist = 0;
+            if (yang_extension_value(y, "system-only-config", CLIXON_LIB_NS, &exist, NULL) < 0)
+                goto done;
+            if (exist)
+                goto ok;
+        }
         if (cli_aware){
-            int exist = 0;
+            exist = 0;
             if (yang_extension_value(y, "hide-show", CLIXON_AUTOCLI_NS, &exist, NULL) < 0)
                 goto done;
             if (exist)
@@ -647,6 +599,16 @@ xml2cbuf_recurse(cbuf             *cb,
     case CX_BODY:
         if ((val = xml_value(x)) == NULL) /* incomplete tree */
             break;
+        {
+            char *enc;
+
+            if (xml_value_enc(x, &enc) < 0)
+                goto done;
+            if (enc){   /* Large shared value, encoded once */
+                cbuf_append_str(cb, enc);
+                break;
+            }
+        }
         if (xml_chardata_cbuf_append(cb, 0, val) < 0)
             goto done;
         break;
@@ -659,6 +621,7 @@ xml2cbuf_recurse(cbuf             *cb,
         cprintf(cb, "%s=\"%s\"", name, xml_value(x));
         break;
     case CX_ELMNT:
+        pos0 = clixon_xml2cbuf_pos(cb);
         if (pretty){
             if (prefix)
                 cprintf(cb, "%s", prefix);
@@ -680,7 +643,7 @@ xml2cbuf_recurse(cbuf             *cb,
         while ((xc = xml_child_each(x, xc, -1)) != NULL)
             switch (xml_type(xc)){
             case CX_ATTR:
-                if (xml2cbuf_recurse(cb, xc, level+1, pretty, prefix, -1, cli_aware, wdef) < 0)
+                if (xml2cbuf_recurse(cb, xc, level+1, pretty, prefix, -1, cli_aware, wdef, NULL, NULL, 0, 0) < 0)
                     goto done;
                 break;
             case CX_BODY:
@@ -695,10 +658,17 @@ xml2cbuf_recurse(cbuf             *cb,
         /* Check for special case <a/> instead of <a></a> */
         if (hasbody==0 && haselement==0)
             cbuf_append_str(cb, "/>");
+        else if (multi && y != NULL &&
+                 (ret = xml2cbuf_subfile(cb, x, y)) != 0){
+            /* Multi-file split-point, only link to subfile is printed */
+            if (ret < 0)
+                goto done;
+        }
         else{
             cbuf_append_str(cb, ">");
             if (pretty && hasbody == 0)
                 cbuf_append_str(cb, "\n");
+            len = clixon_xml2cbuf_pos(cb);
             xc = NULL;
             while ((xc = xml_child_each(x, xc, -1)) != NULL)
                 if (xml_type(xc) != CX_ATTR){
@@ -717,13 +687,29 @@ xml2cbuf_recurse(cbuf             *cb,
                             xa = xml_find_type(xc, IETF_NETCONF_WITH_DEFAULTS_ATTR_PREFIX, IETF_NETCONF_WITH_DEFAULTS_ATTR_NAMESPACE, CX_ATTR);
                         }
                     }
-                    if (xml2cbuf_recurse(cb, xc, level+1, pretty, prefix, depth-1, cli_aware, wdef) < 0)
+                    if (xml2cbuf_recurse(cb, xc, level+1, pretty, prefix, depth-1, cli_aware, wdef, fn, arg,
+                                         multi, system_only) < 0)
                         goto done;
                     if (xa){
                         if (xml_purge(xa) < 0)
                             goto done;
                     }
                 }
+            /* Special case <a/> if all children are filtered, not flushed */
+            if (fn && depth != 1 && clixon_xml2cbuf_pos(cb) == len){
+                /* Non-presence container without children is left out, see xml2output_wdef */
+                if ((wdef == WITHDEFAULTS_EXPLICIT || wdef == WITHDEFAULTS_TRIM) &&
+                    y != NULL && yang_keyword_get(y) == Y_CONTAINER &&
+                    yang_find(y, Y_PRESENCE, NULL) == NULL){
+                    cbuf_trunc(cb, cbuf_len(cb) - (len - pos0));
+                    break;
+                }
+                cbuf_trunc(cb, cbuf_len(cb) - ((pretty && hasbody == 0)?2:1));
+                cbuf_append_str(cb, "/>");
+                if (pretty)
+                    cbuf_append_str(cb, "\n");
+                break;
+            }
             if (pretty && hasbody == 0){
                 if (prefix)
                     cprintf(cb, "%s", prefix);
@@ -739,6 +725,8 @@ xml2cbuf_recurse(cbuf             *cb,
         }
         if (pretty)
             cbuf_append_str(cb, "\n");
+        if (_stream_cb && clixon_xml2cbuf_stream_flush(cb) < 0)
+            goto done;
         break;
     default:
         break;
@@ -749,6 +737,228 @@ xml2cbuf_recurse(cbuf             *cb,
     return retval;
 }
 
+#ifdef XML2CBUF_COMPACT
+/*! Internal: print XML tree structure compactly to a cligen buffer and encode chars "<>&"
+ *
+ * Fast path of xml2cbuf_recurse for machine-to-machine output: not pretty, with-defaults
+ * report-all, no filter, no autocli extensions and no multi-file datastore.
+ * There is no indentation and no with-defaults or filter decision per element.
+ * @param[in,out] cb       Cligen buffer to write to
+ * @param[in]     x        Clixon xml tree
+ * @param[in]     depth    Limit levels of child resources: -1 is all, 0 is none, 1 is node itself
+ * @param[in]     system_only Enable checks for system-only-config extension
+ * @retval        0        OK
+ * @retval       -1        Error
+ * @see xml2cbuf_recurse   with same output if pretty is 0 and wdef is WITHDEFAULTS_REPORT_ALL
+ */
+static int
+xml2cbuf_compact(cbuf   *cb,
+                 cxobj  *x,
+                 int32_t depth,
+                 int     system_only)
+{
+    int        retval = -1;
+    cxobj     *xc;
+    char      *name;
+    char      *namespace;
+    char      *val;
+    yang_stmt *y;
+    int        content;
+    int        exist;
+
+    if (depth == 0)
+        goto ok;
+    if (system_only && (y = xml_spec(x)) != NULL){
+        exist = 0;
+        if (yang_extension_value(y, "system-only-config", CLIXON_LIB_NS, &exist, NULL) < 0)
+            goto done;
+        if (exist)
+            goto ok;
+    }
+    namespace = xml_prefix(x);
+    switch(xml_type(x)){
+    case CX_BODY:
+        if ((val = xml_value(x)) == NULL) /* incomplete tree */
+            break;
+        {
+            char *enc;
+
+            if (xml_value_enc(x, &enc) < 0)
+                goto done;
+            if (enc){   /* Large shared value, encoded once */
+                cbuf_append_str(cb, enc);
+                break;
+            }
+        }
+        if (xml_chardata_cbuf_append(cb, 0, val) < 0)
+            goto done;
+        break;
+    case CX_ATTR:
+        cbuf_append_str(cb, " ");
+        if (namespace){
+            cbuf_append_str(cb, namespace);
+            cbuf_append_str(cb, ":");
+        }
+        cprintf(cb, "%s=\"%s\"", xml_name(x), xml_value(x));
+        break;
+    case CX_ELMNT:
+        name = xml_name(x);
+        cbuf_append_str(cb, "<");
+        if (namespace){
+            cbuf_append_str(cb, namespace);
+            cbuf_append_str(cb, ":");
+        }
+        cbuf_append_str(cb, name);
+        content = 0;
+        xc = NULL;
+        while ((xc = xml_child_each(x, xc, -1)) != NULL){
+            if (xml_type(xc) == CX_ATTR){
+                if (xml2cbuf_compact(cb, xc, -1, 0) < 0)
+                    goto done;
+            }
+            else if (xml_type(xc) == CX_BODY || xml_type(xc) == CX_ELMNT)
+                content = 1;
+        }
+        if (content == 0){
+            cbuf_append_str(cb, "/>");
+        }
+        else {
+            cbuf_append_str(cb, ">");
+            xc = NULL;
+            while ((xc = xml_child_each(x, xc, -1)) != NULL)
+                if (xml_type(xc) != CX_ATTR &&
+                    xml2cbuf_compact(cb, xc, depth-1, system_only) < 0)
+                    goto done;
+            cbuf_append_str(cb, "</");
+            if (namespace){
+                cbuf_append_str(cb, namespace);
+                cbuf_append_str(cb, ":");
+            }
+            cbuf_append_str(cb, name);
+            cbuf_append_str(cb, ">");
+        }
+        if (_stream_cb && clixon_xml2cbuf_stream_flush(cb) < 0)
+            goto done;
+        break;
+    default:
+        break;
+    }/* switch */
+ ok:
+    retval = 0;
+ done:
+    return retval;
+}
+#endif /* XML2CBUF_COMPACT */
+
+/*! Print XML of clixon_xml2file1 to streamed cligen buffer
+ *
+ * @param[in,out] cb   Cligen buffer
+ * @param[in]     arg  struct xml2file_print
+ * @retval        0    OK
+ * @retval       -1    Error
+ */
+static int
+xml2file_print_cb(cbuf *cb,
+                  void *arg)
+{
+    struct xml2file_print *xp = (struct xml2file_print *)arg;
+    cxobj                 *xc;
+
+    if (xp->xp_x == NULL)
+        return 0;
+#ifdef XML2CBUF_COMPACT
+    if (!xp->xp_pretty && !xp->xp_multi && !xp->xp_autocliext &&
+        xp->xp_wdef == WITHDEFAULTS_REPORT_ALL){
+        if (!xp->xp_skiptop)
+            return xml2cbuf_compact(cb, xp->xp_x, -1, xp->xp_system_only);
+        xc = NULL;
+        while ((xc = xml_child_each(xp->xp_x, xc, CX_ELMNT)) != NULL)
+            if (xml2cbuf_compact(cb, xc, -1, xp->xp_system_only) < 0)
+                return -1;
+        return 0;
+    }
+#endif
+    if (!xp->xp_skiptop)
+        return xml2cbuf_recurse(cb, xp->xp_x, xp->xp_level, xp->xp_pretty, xp->xp_prefix, -1,
+                                xp->xp_autocliext, xp->xp_wdef, NULL, NULL,
+                                xp->xp_multi, xp->xp_system_only);
+    xc = NULL;
+    while ((xc = xml_child_each(xp->xp_x, xc, CX_ELMNT)) != NULL)
+        if (xml2cbuf_recurse(cb, xc, xp->xp_level, xp->xp_pretty, xp->xp_prefix, -1,
+                             xp->xp_autocliext, xp->xp_wdef, NULL, NULL,
+                             xp->xp_multi, xp->xp_system_only) < 0)
+            return -1;
+    return 0;
+}
+
+/* File and print function of clixon_xml2file_stream */
+struct xml2file_sink {
+    FILE             *xs_f;
+    clicon_output_cb *xs_fn;
+};
+
+/*! Flush function of clixon_xml2file_stream: print buffer to file
+ */
+static int
+xml2file_flush(char  *buf,
+               size_t len,
+               void  *arg)
+{
+    struct xml2file_sink *xs = (struct xml2file_sink *)arg;
+
+    (*xs->xs_fn)(xs->xs_f, "%s", buf);
+    return 0;
+}
+
+/*! Print to a file in parts using a streamed cligen buffer
+ *
+ * The print function prints XML or JSON to a cligen buffer, which is given to the file
+ * print function each time it has grown to XML2FILE_STREAM bytes, and at the end.
+ * Printing to file and to a cligen buffer thereby share the same code, and the buffer
+ * does not hold the whole output.
+ * A stream of another cligen buffer, see clixon_xml2cbuf_stream, is restored after.
+ * @param[in]  f     Output file
+ * @param[in]  fn    File print function (if NULL, use fprintf)
+ * @param[in]  pfn   Print function to cligen buffer
+ * @param[in]  arg   Argument to pfn
+ * @retval     0     OK
+ * @retval    -1     Error
+ * @see clixon_xml2file1
+ * @see clixon_json2file1
+ */
+int
+clixon_xml2file_stream(FILE                *f,
+                       clicon_output_cb    *fn,
+                       clixon_xml_print_fn *pfn,
+                       void                *arg)
+{
+    int                  retval = -1;
+    cbuf                *cb = NULL;
+    struct xml2file_sink xs = {f, fn ? fn : fprintf};
+    cbuf                *cb0 = _stream_cb;
+    clixon_xml_flush_fn *fn0 = _stream_fn;
+    void                *arg0 = _stream_arg;
+    size_t               size0 = _stream_size;
+    size_t               flushed0 = _stream_flushed;
+
+    if ((cb = cbuf_new()) == NULL){
+        clixon_err(OE_XML, errno, "cbuf_new");
+        goto done;
+    }
+    clixon_xml2cbuf_stream(cb, xml2file_flush, &xs, XML2FILE_STREAM);
+    if ((*pfn)(cb, arg) < 0)
+        goto done;
+    if (cbuf_len(cb))
+        (*xs.xs_fn)(f, "%s", cbuf_get(cb));
+    retval = 0;
+ done:
+    clixon_xml2cbuf_stream(cb0, fn0, arg0, size0);
+    _stream_flushed = flushed0;
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+}
+
 /*! Print an XML tree structure to a cligen buffer and encode chars "<>&" 
  *
  * Extended version with with-defaults
@@ -787,21 +997,277 @@ clixon_xml2cbuf1(cbuf             *cb,
     int    retval = -1;
     cxobj *xc;
 
+#ifdef XML2CBUF_COMPACT
+    /* Fast path for machine-to-machine output */
+    if (!pretty && !cli_aware && wdef == WITHDEFAULTS_REPORT_ALL){
+        if (skiptop){
+            xc = NULL;
+            while ((xc = xml_child_each(xn, xc, CX_ELMNT)) != NULL)
+                if (xml2cbuf_compact(cb, xc, depth, 0) < 0)
+                    goto done;
+        }
+        else if (xml2cbuf_compact(cb, xn, depth, 0) < 0)
+            goto done;
+        goto ok;
+    }
+#endif
+    if (skiptop){
+        xc = NULL;
+        while ((xc = xml_child_each(xn, xc, CX_ELMNT)) != NULL)
+            if (xml2cbuf_recurse(cb, xc, level, pretty, prefix, depth, cli_aware, wdef, NULL, NULL, 0, 0) < 0)
+                goto done;
+    }
+    else {
+        if (xml2cbuf_recurse(cb, xn, level, pretty, prefix, depth, cli_aware, wdef, NULL, NULL, 0, 0) < 0)
+            goto done;
+    }
+#ifdef XML2CBUF_COMPACT
+ ok:
+#endif
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Print an XML tree structure to a cligen buffer, leaving out elements rejected by a filter
+ *
+ * Same output as first removing the rejected elements from the tree and then printing it
+ * with clixon_xml2cbuf1, without modifying the tree.
+ * The filter function is called for each element before it is printed, and returns:
+ *  0: leave out the element and its subtree
+ *  1: print the element and its subtree, no more filter calls in the subtree
+ *  2: print the element and call filter for its children
+ * @param[in,out] cb      Cligen buffer to write to
+ * @param[in]     xn      Top-level xml object
+ * @param[in]     level   Indentation level for pretty
+ * @param[in]     pretty  Insert \n and spaces to make the xml more readable.
+ * @param[in]     depth   Limit levels of child resources: -1: all, 0: none, 1: node itself
+ * @param[in]     skiptop 0: Include top object 1: Skip top-object, only children,
+ * @param[in]     wdef    With-defaults parameter
+ * @param[in]     fn      Filter function
+ * @param[in]     arg     Argument of filter function
+ * @retval        0       OK
+ * @retval       -1       Error
+ * @see clixon_xml2cbuf1
+ */
+int
+clixon_xml2cbuf_filter(cbuf                 *cb,
+                       cxobj                *xn,
+                       int                   level,
+                       int                   pretty,
+                       int32_t               depth,
+                       int                   skiptop,
+                       withdefaults_type     wdef,
+                       clixon_xml_filter_fn *fn,
+                       void                 *arg)
+{
+    int    retval = -1;
+    cxobj *xc;
+
     if (skiptop){
         xc = NULL;
         while ((xc = xml_child_each(xn, xc, CX_ELMNT)) != NULL)
-            if (xml2cbuf_recurse(cb, xc, level, pretty, prefix, depth, cli_aware, wdef) < 0)
+            if (xml2cbuf_recurse(cb, xc, level, pretty, NULL, depth, 0, wdef, fn, arg, 0, 0) < 0)
                 goto done;
     }
     else {
-        if (xml2cbuf_recurse(cb, xn, level, pretty, prefix, depth, cli_aware, wdef) < 0)
+        if (xml2cbuf_recurse(cb, xn, level, pretty, NULL, depth, 0, wdef, fn, arg, 0, 0) < 0)
+            goto done;
+    }
+    retval = 0;
+ done:
+    return retval;
+}
+
+static int xml2cbuf_marked_recurse(cbuf *cb, cxobj *x, int level, int pretty, int32_t depth, withdefaults_type wdef);
+
+/*! Print children of a marked or ancestor node, help function to clixon_xml2cbuf_marked
+ *
+ * All children of a marked node are printed, as well as the keys of an ancestor list entry.
+ * Other children are printed only if they are marked or ancestors of marked nodes.
+ * @param[in,out] cb      Cligen buffer to write to
+ * @param[in]     x       Parent XML node
+ * @param[in]     level   Indentation level for pretty
+ * @param[in]     pretty  Insert \n and spaces to make the xml more readable.
+ * @param[in]     depth   Limit levels of child resources: -1: all, 0: none, 1: node itself
+ * @param[in]     wdef    With-defaults parameter
+ * @retval        0       OK
+ * @retval       -1       Error
+ */
+static int
+xml2cbuf_marked_children(cbuf             *cb,
+                         cxobj            *x,
+                         int               level,
+                         int               pretty,
+                         int32_t           depth,
+                         withdefaults_type wdef)
+{
+    int        retval = -1;
+    yang_stmt *y;
+    cxobj     *xc;
+    cxobj     *xa;
+    char      *ns;
+    int        all;
+
+    y = xml_spec(x);
+    all = xml_flag(x, XML_FLAG_MARK);
+    xc = NULL;
+    while ((xc = xml_child_each(x, xc, CX_ELMNT)) != NULL){
+        xa = NULL;
+        ns = NULL;
+        /* If tagged withdefaults, see xml2cbuf_recurse */
+        if (wdef == WITHDEFAULTS_REPORT_ALL_TAGGED &&
+            y == NULL &&
+            xml_spec(xc) != NULL){
+            if (xml2ns(xc, IETF_NETCONF_WITH_DEFAULTS_ATTR_PREFIX, &ns) < 0)
+                goto done;
+            if (ns == NULL){
+                if (xmlns_set(xc, IETF_NETCONF_WITH_DEFAULTS_ATTR_PREFIX, IETF_NETCONF_WITH_DEFAULTS_ATTR_NAMESPACE) < 0)
+                    goto done;
+                xa = xml_find_type(xc, IETF_NETCONF_WITH_DEFAULTS_ATTR_PREFIX, IETF_NETCONF_WITH_DEFAULTS_ATTR_NAMESPACE, CX_ATTR);
+            }
+        }
+        if (all ||
+            (y != NULL && yang_keyword_get(y) == Y_LIST &&
+             xml_flag(xc, XML_FLAG_MARK|XML_FLAG_CHANGE) == 0 &&
+             yang_key_match(y, xml_name(xc), NULL) == 1)){
+            if (xml2cbuf_recurse(cb, xc, level, pretty, NULL, depth, 0, wdef, NULL, NULL, 0, 0) < 0)
+                goto done;
+        }
+        else if (xml2cbuf_marked_recurse(cb, xc, level, pretty, depth, wdef) < 0)
             goto done;
+        if (xa){
+            if (xml_purge(xa) < 0)
+                goto done;
+        }
     }
     retval = 0;
  done:
     return retval;
 }
 
+/*! Print marked part of XML tree, help function to clixon_xml2cbuf_marked
+ *
+ * @param[in,out] cb      Cligen buffer to write to
+ * @param[in]     x       XML node
+ * @param[in]     level   Indentation level for pretty
+ * @param[in]     pretty  Insert \n and spaces to make the xml more readable.
+ * @param[in]     depth   Limit levels of child resources: -1: all, 0: none, 1: node itself
+ * @param[in]     wdef    With-defaults parameter
+ * @retval        0       OK
+ * @retval       -1       Error
+ */
+static int
+xml2cbuf_marked_recurse(cbuf             *cb,
+                        cxobj            *x,
+                        int               level,
+                        int               pretty,
+                        int32_t           depth,
+                        withdefaults_type wdef)
+{
+    int    retval = -1;
+    cxobj *xc;
+    char  *namespace;
+    size_t len;
+    int    tag = 0;
+    int    ret;
+
+    if (depth == 0 || xml_type(x) != CX_ELMNT)
+        goto ok;
+    if (xml_flag(x, XML_FLAG_MARK)){
+        if (xml2cbuf_recurse(cb, x, level, pretty, NULL, depth, 0, wdef, NULL, NULL, 0, 0) < 0)
+            goto done;
+        goto ok;
+    }
+    if (xml_flag(x, XML_FLAG_CHANGE) == 0)
+        goto ok;
+    if (xml_spec(x) != NULL){
+        if ((ret = xml2output_wdef(x, wdef, &tag)) < 0)
+            goto done;
+        if (ret == 0)
+            goto ok;
+    }
+    namespace = xml_prefix(x);
+    if (pretty)
+        cprintf(cb, "%*s", level*PRETTYPRINT_INDENT, "");
+    cbuf_append_str(cb, "<");
+    if (namespace){
+        cbuf_append_str(cb, namespace);
+        cbuf_append_str(cb, ":");
+    }
+    cbuf_append_str(cb, xml_name(x));
+    if (tag)
+        cbuf_append_str(cb, " wd:default=\"true\"");
+    xc = NULL;
+    while ((xc = xml_child_each(x, xc, CX_ATTR)) != NULL)
+        if (xml2cbuf_recurse(cb, xc, level+1, pretty, NULL, -1, 0, wdef, NULL, NULL, 0, 0) < 0)
+            goto done;
+    cbuf_append_str(cb, ">");
+    if (pretty)
+        cbuf_append_str(cb, "\n");
+    len = clixon_xml2cbuf_pos(cb);
+    if (xml2cbuf_marked_children(cb, x, level+1, pretty, depth-1, wdef) < 0)
+        goto done;
+    if (clixon_xml2cbuf_pos(cb) == len){ /* Special case <a/> instead of <a></a>, not flushed */
+        cbuf_trunc(cb, cbuf_len(cb) - (pretty?2:1));
+        cbuf_append_str(cb, "/>");
+    }
+    else {
+        if (pretty)
+            cprintf(cb, "%*s", level*PRETTYPRINT_INDENT, "");
+        cbuf_append_str(cb, "</");
+        if (namespace){
+            cbuf_append_str(cb, namespace);
+            cbuf_append_str(cb, ":");
+        }
+        cbuf_append_str(cb, xml_name(x));
+        cbuf_append_str(cb, ">");
+    }
+    if (pretty)
+        cbuf_append_str(cb, "\n");
+    if (_stream_cb && clixon_xml2cbuf_stream_flush(cb) < 0)
+        goto done;
+ ok:
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Print the marked parts of an XML tree to a cligen buffer
+ *
+ * Print sub-trees marked with XML_FLAG_MARK and their ancestors marked with
+ * XML_FLAG_CHANGE, as well as the keys of ancestor list entries.
+ * This gives the same output as first copying the marked sub-trees to a new tree, but
+ * without modifying or copying the tree, eg a datastore cache.
+ * @param[in,out] cb      Cligen buffer to write to
+ * @param[in]     xn      Top-level xml object
+ * @param[in]     level   Indentation level for pretty
+ * @param[in]     pretty  Insert \n and spaces to make the xml more readable.
+ * @param[in]     depth   Limit levels of child resources: -1: all, 0: none, 1: node itself
+ * @param[in]     skiptop 0: Include top object 1: Skip top-object, only children,
+ * @param[in]     wdef    With-defaults parameter
+ * @retval        0       OK
+ * @retval       -1       Error
+ * @see xmldb_get_borrow  Marks datastore cache
+ * @see clixon_xml2cbuf1  Print complete tree
+ */
+int
+clixon_xml2cbuf_marked(cbuf             *cb,
+                       cxobj            *xn,
+                       int               level,
+                       int               pretty,
+                       int32_t           depth,
+                       int               skiptop,
+                       withdefaults_type wdef)
+{
+    if (skiptop){
+        if (xml_flag(xn, XML_FLAG_MARK|XML_FLAG_CHANGE) == 0)
+            return 0;
+        return xml2cbuf_marked_children(cb, xn, level, pretty, depth, wdef);
+    }
+    return xml2cbuf_marked_recurse(cb, xn, level, pretty, depth, wdef);
+}
+
 /*! Print an XML tree structure to a cligen buffer and encode chars "<>&"
  *
  * @param[in,out] cb      Cligen buffer to write to
@@ -877,11 +1343,13 @@ xmltree2cbuf(cbuf  *cb,
  * @param[in]     yspec Yang specification (only if bind is TOP or CONFIG)
  * @param[in,out] xtop  Top of XML parse tree. Assume created. Holds new tree.
  * @param[out]    xerr  Reason for failure (yang assignment not made)
+ * @param[in]     scan  Use hand-written scanner, fall back to yacc parser if not accepted
  * @retval        1     Parse OK and all yang assignment made
  * @retval        0     Parse OK but yang assigment not made (or only partial) and xerr set
  * @retval       -1     Error
  * @see clixon_xml_parse_file
  * @see clixon_xml_parse_string
+ * @see clixon_xml_scan
  * @see _json_parse
  * @note special case is empty XML where the parser is not invoked.
  * It is questionable empty XML is legal. From https://www.w3.org/TR/2008/REC-xml-20081126 Sec 2.1:
@@ -901,13 +1369,16 @@ _xml_parse(clixon_handle h,
            yang_bind     yb,
            yang_stmt    *yspec,
            cxobj        *xt,
-           cxobj       **xerr)
+           cxobj       **xerr,
+           int           scan)
 {
     int             retval = -1;
     clixon_xml_yacc xy = {0,};
     cxobj          *x;
     int             failed = 0; /* yang assignment */
+    int             yacc = 0;
     int             i;
+    clixon_trace_t  tr;
     int             ret;
 
     if (clixon_debug_get() & CLIXON_DBG_DETAIL)
@@ -921,16 +1392,24 @@ _xml_parse(clixon_handle h,
         clixon_err(OE_XML, errno, "Unexpected NULL XML");
         return -1;
     }
-    if ((xy.xy_parse_string = strdup(str)) == NULL){
-        clixon_err(OE_XML, errno, "strdup");
-        return -1;
-    }
+    tr = clixon_trace_begin(CLIXON_DBG_PARSE);
     xy.xy_xtop = xt;
     xy.xy_xparent = xt;
-    if (clixon_xml_parsel_init(&xy) < 0)
-        goto done;
-    if (clixon_xml_parseparse(&xy) != 0)  /* yacc returns 1 on error */
+    ret = 0;
+    if (scan &&
+        (ret = clixon_xml_scan(&xy, str, strlen(str))) < 0)
         goto done;
+    if (ret == 0){ /* Not scanned or not accepted by scanner */
+        if ((xy.xy_parse_string = strdup(str)) == NULL){
+            clixon_err(OE_XML, errno, "strdup");
+            goto done;
+        }
+        yacc++;
+        if (clixon_xml_parsel_init(&xy) < 0)
+            goto done;
+        if (clixon_xml_parseparse(&xy) != 0)  /* yacc returns 1 on error */
+            goto done;
+    }
     /* Purge all top-level body objects */
     x = NULL;
     while ((x = xml_find_type(xt, NULL, "body", CX_BODY)) != NULL)
@@ -950,7 +1429,7 @@ _xml_parse(clixon_handle h,
             /* xt:n         Has spec
              * x:   <a> <-- populate from parent
              */
-            if ((ret = xml_bind_yang0(h, x, YB_PARENT, NULL, 0, 0, xerr)) < 0)
+            if ((ret = xml_bind_yang0_sort(h, x, YB_PARENT, NULL, xerr)) < 0)
                 goto done;
             if (ret == 0)
                 failed++;
@@ -965,7 +1444,7 @@ _xml_parse(clixon_handle h,
             /* xt:<top>     nospec
              * x:   <a> <-- populate from modules
              */
-            if ((ret = xml_bind_yang0(h, x, YB_MODULE, yspec, 0, 0, xerr)) < 0)
+            if ((ret = xml_bind_yang0_sort(h, x, YB_MODULE, yspec, xerr)) < 0)
                 goto done;
             if (ret == 0)
                 failed++;
@@ -984,18 +1463,30 @@ _xml_parse(clixon_handle h,
     if (failed)
         goto fail;
     /* Sort the complete tree after parsing. Sorting is not really meaningful if Yang
-       not bound */
-    if (yb != YB_NONE)
+       not bound. New subtrees are already sorted when bound with YB_PARENT or YB_MODULE */
+    switch (yb){
+    case YB_NONE:
+        break;
+    case YB_PARENT:
+    case YB_MODULE:
+        if (xml_sort_children(xt) < 0)
+            goto done;
+        break;
+    default:
         if (xml_sort_recurse(xt) < 0)
             goto done;
+        break;
+    }
     retval = 1;
  done:
     clixon_debug(CLIXON_DBG_PARSE | CLIXON_DBG_DETAIL, "retval:%d", retval);
-    clixon_xml_parsel_exit(&xy);
+    if (yacc)
+        clixon_xml_parsel_exit(&xy);
     if (xy.xy_parse_string != NULL)
         free(xy.xy_parse_string);
     if (xy.xy_xvec)
         free(xy.xy_xvec);
+    clixon_trace_end(tr, CLIXON_DBG_PARSE, "xml_parse", NULL);
     return retval;
  fail: /* invalid */
     retval = 0;
@@ -1036,8 +1527,7 @@ clixon_xml_parse_file(FILE      *fp,
                       cxobj    **xerr)
 {
     int   retval = -1;
-    int   len = 0;
-    char  ch;
+    size_t len = 0;
     char *xmlbuf = NULL;
     char *ptr;
     int   xmlbuflen = BUFLEN; /* start size */
@@ -1063,22 +1553,21 @@ clixon_xml_parse_file(FILE      *fp,
     memset(xmlbuf, 0, xmlbuflen);
     ptr = xmlbuf;
     while (1){
-        sz = fread(&ch, 1, 1, fp);
-        if (sz == 1){
-            xmlbuf[len++] = ch;
-        }
-        else if (sz == 0 && feof(fp)) {
+        /* Read in blocks, one byte of space left for the null character */
+        sz = fread(xmlbuf+len, 1, xmlbuflen-1-len, fp);
+        len += sz;
+        if (sz == 0 && feof(fp)) {
             if (*xt == NULL)
                 if ((*xt = xml_new(XML_TOP_SYMBOL, NULL, CX_ELMNT)) == NULL)
                     goto done;
-            if ((ret = _xml_parse(NULL, ptr, yb, yspec, *xt, xerr)) < 0)
+            if ((ret = _xml_parse(NULL, ptr, yb, yspec, *xt, xerr, 1)) < 0)
                 goto done;
             if (ret == 0)
                 failed++;
             break;
         }
-        else {
-            clixon_err(OE_XML, 0, "fread %lu", sz);
+        else if (sz == 0) {
+            clixon_err(OE_XML, errno, "fread");
             goto done;
         }
         if (len >= xmlbuflen-1){ /* Space: one for the null character */
@@ -1151,7 +1640,7 @@ clixon_xml_parse_string1(clixon_handle h,
         if ((*xt = xml_new(XML_TOP_SYMBOL, NULL, CX_ELMNT)) == NULL)
             return -1;
     }
-    return _xml_parse(h, str, yb, yspec, *xt, xerr);
+    return _xml_parse(h, str, yb, yspec, *xt, xerr, 0);
 }
 
 /*! Read XML from var-arg list and parse it into xml tree
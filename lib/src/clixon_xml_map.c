@@ -135,6 +135,7 @@ xml2cvec(cxobj      *xt,
     char             *reason = NULL;
     char             *name;
     int               ret;
+    int               inext;
 
     xc = NULL;
     /* Tried to allocate whole cvv here, but some cg_vars may be invalid */
@@ -142,9 +143,9 @@ xml2cvec(cxobj      *xt,
         clixon_err(OE_UNIX, errno, "cvec_new");
         goto err;
     }
-    xc = NULL;
+    inext = 0;
     /* Go through all children of the xml tree */
-    while ((xc = xml_child_each(xt, xc, CX_ELMNT)) != NULL){
+    while ((xc = xml_child_iter(xt, &inext, CX_ELMNT)) != NULL){
         name = xml_name(xc);
         if ((ys = yang_find_datanode(yt, name)) == NULL){
             clixon_debug(CLIXON_DBG_ALWAYS, "yang sanity problem: %s in xml but not present in yang under %s",
@@ -293,20 +294,18 @@ xml_tree_prune_flagged_sub(cxobj *xt,
     int        submark;
     int        mark;
     cxobj     *x;
-    cxobj     *xprev;
+    int        inext;
     int        iskey;
     int        anykey=0;
     yang_stmt *yt;
 
     mark = 0;
     yt = xml_spec(xt); /* can be null */
-    x = NULL;
-    xprev = x = NULL;
-    while ((x = xml_child_each(xt, x, CX_ELMNT)) != NULL) {
+    inext = 0;
+    while ((x = xml_child_iter(xt, &inext, CX_ELMNT)) != NULL) {
         if (xml_flag(x, flag) == (test?flag:0)){
             /* Pass test */
             mark++;
-            xprev = x;
             continue; /* mark and stop here */
         }
         /* If it is key dont remove it yet (see second round) */
@@ -315,8 +314,7 @@ xml_tree_prune_flagged_sub(cxobj *xt,
                 goto done;
             if (iskey){
                 anykey++;
-                xprev = x; /* skip if this is key */
-                continue;
+                continue; /* skip if this is key */
             }
         }
         if (xml_tree_prune_flagged_sub(x, flag, test, &submark) < 0)
@@ -325,27 +323,97 @@ xml_tree_prune_flagged_sub(cxobj *xt,
          */
         if (submark)
             mark++;
-        else{ /* Safe with xml_child_each if last */
+        else{
             if (xml_purge(x) < 0)
                 goto done;
-            x = xprev;
+            inext--;
         }
-        xprev = x;
     }
     /* Second round: if any keys were found, and no marks detected, purge now */
     if (anykey && !mark){
-        x = NULL;
-        xprev = x = NULL;
-        while ((x = xml_child_each(xt, x, CX_ELMNT)) != NULL) {
+        inext = 0;
+        while ((x = xml_child_iter(xt, &inext, CX_ELMNT)) != NULL) {
             /* If it is key remove it here */
             if (yt){
                 if ((iskey = yang_key_match(yt, xml_name(x), NULL)) < 0)
                     goto done;
-                if (iskey && xml_purge(x) < 0)
+                if (iskey){
+                    if (xml_purge(x) < 0)
+                        goto done;
+                    inext--;
+                }
+            }
+        }
+    }
+    retval = 0;
+ done:
+    if (upmark)
+        *upmark = mark;
+    return retval;
+}
+
+/*! Prune children of xt that are not marked and have no marked descendants
+ *
+ * Help function to xml_tree_prune_marked. Nodes with marked descendants are flagged with
+ * XML_FLAG_TRANSIENT, other unmarked nodes are purged without being traversed.
+ * @param[in]   xt      XML tree
+ * @param[out]  upmark  Set if a child (recursively) is marked
+ * @retval      0       OK
+ * @retval     -1       Error
+ */
+static int
+xml_tree_prune_marked_sub(cxobj *xt,
+                          int   *upmark)
+{
+    int        retval = -1;
+    int        submark;
+    int        mark;
+    cxobj     *x;
+    int        inext;
+    int        iskey;
+    int        anykey=0;
+    yang_stmt *yt;
+
+    mark = 0;
+    yt = xml_spec(xt); /* can be null */
+    inext = 0;
+    while ((x = xml_child_iter(xt, &inext, CX_ELMNT)) != NULL) {
+        if (xml_flag(x, XML_FLAG_MARK)){
+            mark++;
+            continue;
+        }
+        /* If it is key dont remove it yet (see second round) */
+        if (yt){
+            if ((iskey = yang_key_match(yt, xml_name(x), NULL)) < 0)
+                goto done;
+            if (iskey){
+                anykey++;
+                continue;
+            }
+        }
+        if (xml_flag(x, XML_FLAG_TRANSIENT)){
+            if (xml_tree_prune_marked_sub(x, &submark) < 0)
+                goto done;
+            if (submark){
+                mark++;
+                continue;
+            }
+        }
+        if (xml_purge(x) < 0)
+            goto done;
+        inext--;
+    }
+    /* Second round: if any keys were found, and no marks detected, purge now */
+    if (anykey && !mark){
+        inext = 0;
+        while ((x = xml_child_iter(xt, &inext, CX_ELMNT)) != NULL) {
+            if ((iskey = yang_key_match(yt, xml_name(x), NULL)) < 0)
+                goto done;
+            if (iskey){
+                if (xml_purge(x) < 0)
                     goto done;
-                x = xprev;
+                inext--;
             }
-            xprev = x;
         }
     }
     retval = 0;
@@ -355,6 +423,66 @@ xml_tree_prune_flagged_sub(cxobj *xt,
     return retval;
 }
 
+/*! Prune everything that is not a node in a vector, or an ancestor or descendant of one
+ *
+ * Same result as setting XML_FLAG_MARK on the nodes in xvec, calling
+ * xml_tree_prune_flagged_sub(xt, XML_FLAG_MARK, 1, NULL) and resetting the marks, but only the
+ * ancestors of the nodes and their children are visited, not the whole tree.
+ * If xt itself is in xvec, nothing is pruned.
+ * @param[in]   xt      XML tree
+ * @param[in]   xvec    Vector of nodes to keep, NULL and non-element entries are ignored
+ * @param[in]   xlen    Length of xvec
+ * @retval      0       OK
+ * @retval     -1       Error
+ * @code
+ *    if (xpath_vec(xt, nsc, "%s", &xvec, &xlen, xpath) < 0)
+ *       goto done;
+ *    if (xml_tree_prune_marked(xt, xvec, xlen) < 0)
+ *       goto done;
+ * @endcode
+ * @see xml_tree_prune_flagged_sub  Where the nodes are marked in the tree
+ */
+int
+xml_tree_prune_marked(cxobj  *xt,
+                      cxobj **xvec,
+                      size_t  xlen)
+{
+    int    retval = -1;
+    int    keep = 0;
+    size_t i;
+    cxobj *x;
+    cxobj *xp;
+
+    /* Mark nodes, and ancestors up to xt as transient */
+    for (i=0; i<xlen; i++){
+        if ((x = xvec[i]) == NULL || xml_type(x) != CX_ELMNT)
+            continue;
+        if (x == xt)
+            keep++;
+        xml_flag_set(x, XML_FLAG_MARK);
+        xp = x;
+        while ((xp = xml_parent(xp)) != NULL && xp != xt &&
+               xml_flag(xp, XML_FLAG_TRANSIENT) == 0)
+            xml_flag_set(xp, XML_FLAG_TRANSIENT);
+    }
+    if (!keep &&
+        xml_tree_prune_marked_sub(xt, NULL) < 0)
+        goto done;
+    retval = 0;
+ done:
+    /* Reset flags on the same paths, marked nodes are not purged */
+    for (i=0; i<xlen; i++){
+        if ((x = xvec[i]) == NULL || xml_type(x) != CX_ELMNT)
+            continue;
+        xml_flag_reset(x, XML_FLAG_MARK);
+        xp = x;
+        while ((xp = xml_parent(xp)) != NULL &&
+               xml_flag(xp, XML_FLAG_TRANSIENT))
+            xml_flag_reset(xp, XML_FLAG_TRANSIENT);
+    }
+    return retval;
+}
+
 /*! Mark everything that does not pass test or have at least a child* does not
  *
  * @param[in]   xt      XML tree with some node marked
@@ -380,11 +508,12 @@ xml_tree_mark_flagged_sub(cxobj *xt,
     int        iskey;
     int        anykey=0;
     yang_stmt *yt;
+    int        inext;
 
     mark = 0;
     yt = xml_spec(xt); /* can be null */
-    x = NULL;
-    while ((x = xml_child_each(xt, x, CX_ELMNT)) != NULL) {
+    inext = 0;
+    while ((x = xml_child_iter(xt, &inext, CX_ELMNT)) != NULL) {
         if (xml_flag(x, flag) == (test?flag:0)){
             /* Pass test */
             mark++;
@@ -411,9 +540,8 @@ xml_tree_mark_flagged_sub(cxobj *xt,
     }
     /* Second round: if any keys were found, and no marks detected, purge now */
     if (anykey && !mark){
-        x = NULL;
-        x = NULL;
-        while ((x = xml_child_each(xt, x, CX_ELMNT)) != NULL) {
+        inext = 0;
+        while ((x = xml_child_iter(xt, &inext, CX_ELMNT)) != NULL) {
             /* If it is key remove it here */
             if (yt){
                 if ((iskey = yang_key_match(yt, xml_name(x), NULL)) < 0)
@@ -476,15 +604,14 @@ xml_tree_prune_flags1(cxobj *xt,
 {
     int     retval = -1;
     cxobj  *x;
-    cxobj  *xprev;
+    int     inext;
 
-    x = NULL;
-    xprev = NULL;
-    while ((x = xml_child_each(xt, x, CX_ELMNT)) != NULL) {
+    inext = 0;
+    while ((x = xml_child_iter(xt, &inext, CX_ELMNT)) != NULL) {
         if (xml_flag(x, mask) == flags){        /* Pass test means purge */
             if (xml_purge(x) < 0)
                 goto done;
-            x = xprev;
+            inext--;
             if (removed)
                 (*removed)++;
             continue;
@@ -492,7 +619,6 @@ xml_tree_prune_flags1(cxobj *xt,
         if (recursive)
             if (xml_tree_prune_flags1(x, flags, mask, 1, removed) < 0)
                 goto done;
-        xprev = x;
     }
     retval = 0;
  done:
@@ -597,9 +723,10 @@ xml_non_config_data(cxobj  *xt,
     yang_stmt *y;
     cbuf      *cb = NULL;
     int        ret;
+    int        inext;
 
-    x = NULL;
-    while ((x = xml_child_each(xt, x, CX_ELMNT)) != NULL) {
+    inext = 0;
+    while ((x = xml_child_iter(xt, &inext, CX_ELMNT)) != NULL) {
         if ((y = (yang_stmt*)xml_spec(x)) == NULL)
             goto ok;
         if (!yang_config(y)){ /* config == false means state data */
@@ -1365,10 +1492,28 @@ done:
  * @retval      0    OK
  * @retval     -1    Error
  *  @note you may want to check:!yang_config(ys)
+ * @see xml_copy_marked_skip
  */
 int
 xml_copy_marked(cxobj *x0,
                 cxobj *x1)
+{
+    return xml_copy_marked_skip(x0, x1, 0x0);
+}
+
+/*! Given XML tree x0 with marked nodes, copy marked nodes to new tree x1 except flagged nodes
+ *
+ * As xml_copy_marked but element nodes with any of the skip flags set are not copied
+ * @param[in]   x0    XML tree source
+ * @param[in]   x1    XML tree target
+ * @param[in]   skip  Do not copy elements with any of these flags, eg XML_FLAG_DEFAULT
+ * @retval      0     OK
+ * @retval     -1     Error
+ */
+int
+xml_copy_marked_skip(cxobj   *x0,
+                     cxobj   *x1,
+                     uint16_t skip)
 {
     int        retval = -1;
     int        mark;
@@ -1378,6 +1523,7 @@ xml_copy_marked(cxobj *x0,
     yang_stmt *yt;
     char      *name;
     char      *prefix;
+    int        inext;
 
     if (x0 == NULL || x1 == NULL){
         clixon_err(OE_UNIX, EINVAL, "x0 or x1 is NULL");
@@ -1404,21 +1550,27 @@ xml_copy_marked(cxobj *x0,
      * node in list is marked
      */
     mark = 0;
-    x = NULL;
-    while ((x = xml_child_each(x0, x, CX_ELMNT)) != NULL) {
+    inext = 0;
+    while ((x = xml_child_iter(x0, &inext, CX_ELMNT)) != NULL) {
         if (xml_flag(x, XML_FLAG_MARK|XML_FLAG_CHANGE)){
             mark++;
             break;
         }
     }
-    x = NULL;
-    while ((x = xml_child_each(x0, x, CX_ELMNT)) != NULL) {
+    inext = 0;
+    while ((x = xml_child_iter(x0, &inext, CX_ELMNT)) != NULL) {
+        if (skip && xml_flag(x, skip))
+            continue;
         name = xml_name(x);
         if (xml_flag(x, XML_FLAG_MARK)){
             /* (2) the complete subtree of that node is copied. */
             if ((xcopy = xml_new(name, x1, CX_ELMNT)) == NULL)
                 goto done;
-            if (xml_copy(x, xcopy) < 0)
+            if (skip){
+                if (xml_copy_skip(x, xcopy, skip) < 0)
+                    goto done;
+            }
+            else if (xml_copy(x, xcopy) < 0)
                 goto done;
             continue;
         }
@@ -1426,7 +1578,7 @@ xml_copy_marked(cxobj *x0,
             /*  Copy individual nodes marked with XML_FLAG_CHANGE */
             if ((xcopy = xml_new(name, x1, CX_ELMNT)) == NULL)
                 goto done;
-            if (xml_copy_marked(x, xcopy) < 0) /*  */
+            if (xml_copy_marked_skip(x, xcopy, skip) < 0) /*  */
                 goto done;
         }
         /* (3) Special case: key nodes in lists are copied if any 
@@ -1646,10 +1798,11 @@ xml_find_action(cxobj  *xn,
                 cxobj **xap)
 {
     int        retval = -1;
-    cxobj     *xc = NULL;
+    cxobj     *xc;
     yang_stmt *yc;
+    int        inext = 0;
 
-    while ((xc = xml_child_each(xn, xc, CX_ELMNT)) != NULL) {
+    while ((xc = xml_child_iter(xn, &inext, CX_ELMNT)) != NULL) {
         if ((yc = xml_spec(xc)) == NULL)
             continue;
         if (!top && yang_keyword_get(yc) == Y_ACTION){
@@ -1689,14 +1842,13 @@ purge_tagged_nodes(cxobj      *xn,
     int    retval = -1;
     cxobj *x;
     cxobj *xa;
-    cxobj *xprev;
     char  *prefix;
     char  *v;
     int    ret;
+    int    inext;
 
-    x = NULL;
-    xprev = NULL;
-    while ((x = xml_child_each(xn, x, CX_ELMNT)) != NULL) {
+    inext = 0;
+    while ((x = xml_child_iter(xn, &inext, CX_ELMNT)) != NULL) {
         if ((ret = xml2prefix(x, ns, &prefix)) < 0)
             goto done;
         if (ret == 0)
@@ -1706,14 +1858,13 @@ purge_tagged_nodes(cxobj      *xn,
                 (v = xml_value(xa)) != NULL &&
                 strcmp(v, value) == 0){
                 xml_purge(x);
-                x = xprev;
+                inext--;
                 continue;
             }
             xml_purge(xa); /* remove attribute regardless */
         }
         if (purge_tagged_nodes(x, ns, name, value, keepnode) < 0)
             goto done;
-        xprev = x;
     }
     retval = 0;
  done:
@@ -250,53 +250,201 @@ xml_nsctx_add(cvec       *cvv,
     return retval;
 }
 
+/*! Shared namespace context of XML elements
+ *
+ * An element declaring namespaces, with xmlns attributes or namespace cache entries, has
+ * a scope of its own, which its descendants without declarations share by reference.
+ * Prefixes and namespaces point into the XML tree, or are constant.
+ * A scope is only valid in the namespace generation it was computed, ie as long as no
+ * element has been moved and no namespace declaration has changed in any tree.
+ * @see xml_nsctx_scope
+ */
+struct xml_nsscope {
+    int          ns_refcnt; /* Number of elements referencing this scope */
+    uint64_t     ns_gen;    /* Namespace generation when computed, see xml_nsscope_gen */
+    int          ns_len;    /* Number of prefix:namespace pairs */
+    const char **ns_vec;    /* Pairs as prefix,namespace. NULL prefix is default namespace */
+};
+
+/*! Release reference to shared namespace context, free it if last
+ *
+ * @param[in]  nss  Shared namespace context
+ * @retval     0    OK
+ */
+int
+xml_nsscope_free(struct xml_nsscope *nss)
+{
+    if (nss && --nss->ns_refcnt <= 0){
+        if (nss->ns_vec)
+            free(nss->ns_vec);
+        free(nss);
+    }
+    return 0;
+}
+
+/*! Find namespace given prefix in shared namespace context
+ *
+ * @param[in]  nss     Shared namespace context
+ * @param[in]  prefix  Namespace prefix, or NULL for default
+ * @param[out] ns      Namespace
+ * @retval     1       Found
+ * @retval     0       Not found
+ */
 static int
-xml_nsctx_node1(cxobj *xn,
-                cvec  *nsc)
+xml_nsscope_find(struct xml_nsscope *nss,
+                 const char         *prefix,
+                 const char        **ns)
 {
-    int    retval = -1;
-    cxobj *xa = NULL;
-    char  *pf;  /* prefix */
-    char  *nm;  /* name */
-    char  *val; /* value */
-    cxobj *xp;  /* parent */
+    const char *pf;
+    int         i;
+
+    for (i=0; i<nss->ns_len; i++){
+        pf = nss->ns_vec[2*i];
+        if (pf == prefix || (pf && prefix && strcmp(pf, prefix) == 0)){
+            if (ns)
+                *ns = nss->ns_vec[2*i+1];
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/*! Add prefix:namespace pair to shared namespace context unless prefix exists
+ *
+ * @param[in]  nss     Shared namespace context
+ * @param[in]  prefix  Namespace prefix, or NULL for default, not copied
+ * @param[in]  ns      Namespace, not copied
+ * @retval     0       OK
+ * @retval    -1       Error
+ */
+static int
+xml_nsscope_add(struct xml_nsscope *nss,
+                const char         *prefix,
+                const char         *ns)
+{
+    const char **vec;
+
+    if (ns == NULL || xml_nsscope_find(nss, prefix, NULL) == 1)
+        return 0;
+    if ((vec = realloc(nss->ns_vec, 2*(nss->ns_len+1)*sizeof(char*))) == NULL){
+        clixon_err(OE_XML, errno, "realloc");
+        return -1;
+    }
+    nss->ns_vec = vec;
+    vec[2*nss->ns_len] = prefix;
+    vec[2*nss->ns_len+1] = ns;
+    nss->ns_len++;
+    return 0;
+}
+
+/*! Add namespace declarations of XML element to shared namespace context
+ *
+ * Namespace cache entries have precedence over xmlns attributes, as in xml2ns
+ * @param[in]  x    XML element
+ * @param[in]  nss  Shared namespace context, or NULL to only check if declarations exist
+ * @retval     1    Element has declarations
+ * @retval     0    No declarations
+ * @retval    -1    Error
+ */
+static int
+xml_nsscope_decl(cxobj              *x,
+                 struct xml_nsscope *nss)
+{
+    int     retval = 0;
+    cvec   *nsc;
+    cg_var *cv = NULL;
+    cxobj  *xa = NULL;
+    char   *pf;
 
+    if ((nsc = nscache_get_all(x)) != NULL)
+        while ((cv = cvec_each(nsc, cv)) != NULL){
+            if (nss == NULL)
+                return 1;
+            if (xml_nsscope_add(nss, cv_name_get(cv), cv_string_get(cv)) < 0)
+                return -1;
+            retval = 1;
+        }
     /* xmlns:t="<ns1>" prefix:xmlns, name:t
      * xmlns="<ns2>"   prefix:NULL   name:xmlns
      */
-    while ((xa = xml_child_each_attr(xn, xa)) != NULL){
-        pf = xml_prefix(xa);
-        nm = xml_name(xa);
-        if (pf == NULL){
-            if (strcmp(nm, "xmlns")==0 && /* set default namespace context */
-                xml_nsctx_get(nsc, NULL) == NULL){
-                val = xml_value(xa);
-                if (xml_nsctx_add(nsc, NULL, val) < 0)
-                    goto done;
-            }
+    while ((xa = xml_child_each_attr(x, xa)) != NULL){
+        if ((pf = xml_prefix(xa)) == NULL){
+            if (strcmp(xml_name(xa), "xmlns") != 0)
+                continue;
+            if (nss && xml_nsscope_add(nss, NULL, xml_value(xa)) < 0)
+                return -1;
+        }
+        else if (strcmp(pf, "xmlns") == 0){
+            if (nss && xml_nsscope_add(nss, xml_name(xa), xml_value(xa)) < 0)
+                return -1;
         }
         else
-            if (strcmp(pf, "xmlns")==0 && /* set prefixed namespace context */
-                xml_nsctx_get(nsc, nm) == NULL){
-                val = xml_value(xa);
-                if (xml_nsctx_add(nsc, nm, val) < 0)
-                    goto done;
-            }
+            continue;
+        if (nss == NULL)
+            return 1;
+        retval = 1;
     }
-    if ((xp = xml_parent(xn)) == NULL){
-        if (_USE_NAMESPACE_NETCONF_DEFAULT){
-            /* If not default namespace defined, use the base netconf ns as default */
-            if (xml_nsctx_get(nsc, NULL) == NULL)
-                if (xml_nsctx_add(nsc, NULL, NETCONF_BASE_NAMESPACE) < 0)
-                    goto done;
+    return retval;
+}
+
+/*! Get valid shared namespace context of XML element, compute it if necessary
+ *
+ * Elements with declarations, and elements with more than one child, keep a reference to
+ * their scope. Others compute it from their parent, which is quick.
+ * @param[in]  x    XML element
+ * @retval     nss  Shared namespace context, not to be freed
+ * @retval     NULL Error
+ */
+static struct xml_nsscope *
+xml_nsscope_get(cxobj *x)
+{
+    struct xml_nsscope *nss;
+    struct xml_nsscope *nssp = NULL;
+    cxobj              *xp;
+    uint64_t            gen;
+    int                 decl;
+    int                 i;
+
+    gen = xml_nsscope_gen();
+    if ((nss = nsscope_get(x)) != NULL && nss->ns_gen == gen)
+        return nss;
+    if ((decl = xml_nsscope_decl(x, NULL)) < 0)
+        return NULL;
+    if ((xp = xml_parent(x)) != NULL){
+        if ((nssp = xml_nsscope_get(xp)) == NULL)
+            return NULL;
+        if (!decl){ /* Share scope of parent */
+            if (xml_child_nr(x) > 1){
+                nssp->ns_refcnt++;
+                if (nsscope_set(x, nssp) < 0)
+                    return NULL;
+            }
+            return nssp;
         }
     }
-    else
-        if (xml_nsctx_node1(xp, nsc) < 0)
-            goto done;
-    retval = 0;
- done:
-    return retval;
+    if ((nss = malloc(sizeof(*nss))) == NULL){
+        clixon_err(OE_XML, errno, "malloc");
+        return NULL;
+    }
+    memset(nss, 0, sizeof(*nss));
+    nss->ns_refcnt = 1;
+    nss->ns_gen = gen;
+    if (nsscope_set(x, nss) < 0){
+        xml_nsscope_free(nss);
+        return NULL;
+    }
+    if (xml_nsscope_decl(x, nss) < 0)
+        return NULL;
+    if (nssp){
+        for (i=0; i<nssp->ns_len; i++)
+            if (xml_nsscope_add(nss, nssp->ns_vec[2*i], nssp->ns_vec[2*i+1]) < 0)
+                return NULL;
+    }
+    /* If not default namespace defined, use the base netconf ns as default */
+    else if (_USE_NAMESPACE_NETCONF_DEFAULT &&
+             xml_nsscope_add(nss, NULL, NETCONF_BASE_NAMESPACE) < 0)
+        return NULL;
+    return nss;
 }
 
 /*! Create and initialize XML namespace from XML node context
@@ -314,6 +462,7 @@ xml_nsctx_node1(cxobj *xn,
  * ...
  * xml_nsctx_free(nsc)
  * @endcode
+ * Copied from the shared namespace context of the node
  * @see xml_nsctx_init
  * @see xml_nsctx_free  Free the returned handle
  */
@@ -321,18 +470,28 @@ int
 xml_nsctx_node(cxobj *xn,
                cvec **ncp)
 {
-    int   retval = -1;
-    cvec *nc = NULL;
+    int                 retval = -1;
+    cvec               *nc = NULL;
+    struct xml_nsscope *nss;
+    int                 i;
 
+    if ((nss = xml_nsscope_get(xn)) == NULL)
+        goto done;
     if ((nc = cvec_new(0)) == NULL){
         clixon_err(OE_XML, errno, "cvec_new");
         goto done;
     }
-    if (xml_nsctx_node1(xn, nc) < 0)
-        goto done;
+    for (i=0; i<nss->ns_len; i++)
+        if (cvec_add_string(nc, (char*)nss->ns_vec[2*i], (char*)nss->ns_vec[2*i+1]) < 0){
+            clixon_err(OE_XML, errno, "cvec_add_string");
+            goto done;
+        }
     *ncp = nc;
+    nc = NULL;
     retval = 0;
  done:
+    if (nc)
+        cvec_free(nc);
     return retval;
 }
 
@@ -510,49 +669,37 @@ xml_nsctx_cbuf(cbuf *cb,
  *      err;
  * @endcode
  * @see xmlns_set cache is set
- * @note, this function uses a cache.
+ * @note, this function uses the namespace cache of x, and otherwise the shared namespace
+ *        context instead of walking up the ancestors, see xml_nsscope_get
  */
 int
 xml2ns(cxobj      *x,
        const char *prefix,
        char      **namespace)
 {
-    int    retval = -1;
-    char  *ns = NULL;
-    cxobj *xp;
+    int                 retval = -1;
+    const char         *ns = NULL;
+    cxobj              *xp;
+    struct xml_nsscope *nss;
 
     if ((ns = nscache_get(x, prefix)) != NULL)
         goto ok;
-    if (prefix != NULL) /* xmlns:<prefix>="<uri>" */
-        ns = xml_find_type_value(x, "xmlns", prefix, CX_ATTR);
-    else{                /* xmlns="<uri>" */
-        ns = xml_find_type_value(x, NULL, "xmlns", CX_ATTR);
-    }
-    /* namespace not found, try parent */
-    if (ns == NULL){
-        if ((xp = xml_parent(x)) != NULL){
-            if (xml2ns(xp, prefix, &ns) < 0)
-                goto done;
-        }
-        /* If no parent, return default namespace if defined */
-        else if (_USE_NAMESPACE_NETCONF_DEFAULT){
-            if (prefix == NULL)
+    if (xml_type(x) != CX_ELMNT){ /* Attribute or body: namespace context of parent */
+        if ((xp = xml_parent(x)) == NULL){
+            /* If no parent, return default namespace if defined */
+            if (_USE_NAMESPACE_NETCONF_DEFAULT && prefix == NULL)
                 ns = NETCONF_BASE_NAMESPACE;
-            else
-                ns = NULL;
+            goto ok;
         }
+        x = xp;
     }
-    /* Set default namespace cache (since code is at this point,
-     * no cache was found
-     * If not, this is devastating when populating deep yang structures
-     */
-    if (ns &&
-        xml_child_nr(x) > 1 &&  /* Dont set cache if few children: if 1 child typically a body */
-        nscache_set(x, prefix, ns) < 0)
+    /* Shared namespace context replaces walking up the ancestors */
+    if ((nss = xml_nsscope_get(x)) == NULL)
         goto done;
+    xml_nsscope_find(nss, prefix, &ns);
  ok:
     if (namespace)
-        *namespace = ns;
+        *namespace = (char*)ns;
     retval = 0;
  done:
     return retval;
@@ -572,9 +719,10 @@ xml2ns_recurse(cxobj *xt)
     cxobj *x;
     char  *prefix;
     char  *namespace;
+    int    inext;
 
-    x = NULL;
-    while ((x = xml_child_each(xt, x, CX_ELMNT)) != NULL) {
+    inext = 0;
+    while ((x = xml_child_iter(xt, &inext, CX_ELMNT)) != NULL) {
         if ((prefix = xml_prefix(x)) != NULL){
             namespace = NULL;
             if (xml2ns(x, prefix, &namespace) < 0)
@@ -795,14 +943,15 @@ xml_nsctx_parse(cxobj *xnsc,
     char  *prefix;
     char  *ns;
     cvec  *cvv;
+    int    inext;
 
     if ((cvv = cvec_new(0)) == NULL){
         clixon_err(OE_XML, errno, "cvec_new");
         goto done;
     }
     if ((xns = xml_find(xnsc, "namespace-context")) != NULL){
-        xn = NULL;
-        while ((xn = xml_child_each(xns, xn, CX_ELMNT)) != NULL) {
+        inext = 0;
+        while ((xn = xml_child_iter(xns, &inext, CX_ELMNT)) != NULL) {
             ns = xml_find_body(xn, "ns");
             prefix = xml_find_body(xn, "prefix");
             if (ns){
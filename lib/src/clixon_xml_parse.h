@@ -72,4 +72,6 @@ int clixon_xml_parsel_linenr(void);
 int clixon_xml_parselex(void *);
 int clixon_xml_parseparse(void *);
 
+int clixon_xml_scan(clixon_xml_yacc *xy, const char *str, size_t len);
+
 #endif  /* _CLIXON_XML_PARSE_H_ */
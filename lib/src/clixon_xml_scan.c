@@ -0,0 +1,630 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+
+  Copyright (C) 2009-2016 Olof Hagsand and Benny Holmgren
+  Copyright (C) 2017-2019 Olof Hagsand
+  Copyright (C) 2020-2022 Olof Hagsand and Rubicon Communications, LLC (Netgate)
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2,
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+
+ * Hand-written non-recursive XML scanner, used when parsing XML files, eg datastores
+ * Builds the same XML tree as the yacc parser in clixon_xml_parse.[ly] directly:
+ * - Text is scanned with memchr for '<', '&' and CR, and appended to one body per element
+ * - Entities are decoded on the fly, character references are kept as is
+ * - Bodies of elements with element children are not created (pretty-print)
+ * - Attribute values are not decoded
+ * Input that the scanner does not accept is not an error: the partial result is removed and
+ * the caller parses the input with the yacc parser, which gives the same result or the same
+ * error message as before.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "clixon_config.h" /* generated by config & autoconf */
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <strings.h>
+#include <errno.h>
+
+/* cligen */
+#include <cligen/cligen.h>
+
+/* clixon */
+#include "clixon_queue.h"
+#include "clixon_hash.h"
+#include "clixon_handle.h"
+#include "clixon_yang.h"
+#include "clixon_xml.h"
+#include "clixon_err.h"
+#include "clixon_string.h"
+#include "clixon_xml_vec.h"
+#include "clixon_xml_parse.h"
+
+/*! Scanner state
+ */
+struct xml_scan {
+    const char *xs_p;      /* Current position */
+    const char *xs_end;    /* End of string */
+    cbuf       *xs_text;   /* Text of current element */
+    cbuf       *xs_prefix; /* Scratch: prefix of name */
+    cbuf       *xs_name;   /* Scratch: name */
+    cbuf       *xs_value;  /* Scratch: attribute value */
+};
+
+/* Same as namestart and namechar in clixon_xml_parse.l */
+#define XS_NAMESTART(c) (((c) >= 'a' && (c) <= 'z') || ((c) >= 'A' && (c) <= 'Z') || (c) == '_')
+#define XS_NAMECHAR(c)  (XS_NAMESTART(c) || ((c) >= '0' && (c) <= '9') || (c) == '-' || (c) == '.')
+
+/*! Skip whitespace between tokens
+ */
+static inline void
+xs_ws(struct xml_scan *xs)
+{
+    while (xs->xs_p < xs->xs_end &&
+           (*xs->xs_p == ' ' || *xs->xs_p == '\t' || *xs->xs_p == '\n' || *xs->xs_p == '\r'))
+        xs->xs_p++;
+}
+
+/*! Check if string at current position starts with a constant string
+ */
+static inline int
+xs_is(struct xml_scan *xs,
+      const char      *s,
+      size_t           len)
+{
+    return (size_t)(xs->xs_end - xs->xs_p) >= len && memcmp(xs->xs_p, s, len) == 0;
+}
+
+/*! Find a three character string, eg "-->", from position
+ *
+ * @retval  p     Position of string
+ * @retval  NULL  Not found
+ */
+static const char *
+xs_find3(struct xml_scan *xs,
+         const char      *s)
+{
+    const char *p = xs->xs_p;
+
+    while ((p = memchr(p, s[0], xs->xs_end - p)) != NULL){
+        if (xs->xs_end - p < 3)
+            return NULL;
+        if (p[1] == s[1] && p[2] == s[2])
+            return p;
+        p++;
+    }
+    return NULL;
+}
+
+/*! Scan name into cbuf
+ *
+ * @retval  1  OK
+ * @retval  0  No name at position
+ */
+static int
+xs_name(struct xml_scan *xs,
+        cbuf            *cb)
+{
+    const char *p0 = xs->xs_p;
+
+    if (xs->xs_p >= xs->xs_end || !XS_NAMESTART(*xs->xs_p))
+        return 0;
+    xs->xs_p++;
+    while (xs->xs_p < xs->xs_end && XS_NAMECHAR(*xs->xs_p))
+        xs->xs_p++;
+    cbuf_reset(cb);
+    cbuf_append_buf(cb, (void*)p0, xs->xs_p - p0);
+    return 1;
+}
+
+/*! Scan qualified name: NAME or NAME ':' NAME
+ *
+ * @param[in]  xs      Scanner state
+ * @param[out] prefix  Prefix or NULL, points into xs_prefix
+ * @param[out] name    Name, points into xs_name
+ * @retval     1       OK
+ * @retval     0       Not accepted
+ */
+static int
+xs_qname(struct xml_scan *xs,
+         char           **prefix,
+         char           **name)
+{
+    if (xs_name(xs, xs->xs_name) == 0)
+        return 0;
+    xs_ws(xs);
+    if (xs->xs_p < xs->xs_end && *xs->xs_p == ':'){
+        xs->xs_p++;
+        xs_ws(xs);
+        cbuf_reset(xs->xs_prefix);
+        cprintf(xs->xs_prefix, "%s", cbuf_get(xs->xs_name));
+        if (xs_name(xs, xs->xs_name) == 0)
+            return 0;
+        *prefix = cbuf_get(xs->xs_prefix);
+    }
+    else
+        *prefix = NULL;
+    *name = cbuf_get(xs->xs_name);
+    return 1;
+}
+
+/*! Scan quoted string, eg attribute value, into xs_value
+ *
+ * @retval  1  OK
+ * @retval  0  Not accepted
+ */
+static int
+xs_quoted(struct xml_scan *xs)
+{
+    char        q;
+    const char *p1;
+
+    if (xs->xs_p >= xs->xs_end || (*xs->xs_p != '"' && *xs->xs_p != '\''))
+        return 0;
+    q = *xs->xs_p++;
+    if ((p1 = memchr(xs->xs_p, q, xs->xs_end - xs->xs_p)) == NULL)
+        return 0;
+    cbuf_reset(xs->xs_value);
+    cbuf_append_buf(xs->xs_value, (void*)xs->xs_p, p1 - xs->xs_p);
+    xs->xs_p = p1 + 1;
+    return 1;
+}
+
+/*! Scan text up to next '<', decode entities and line ends
+ *
+ * @param[in]  xs   Scanner state
+ * @param[in]  cb   Append text here, or NULL to only check it
+ * @retval     1    OK
+ * @retval     0    Not accepted
+ */
+static int
+xs_text(struct xml_scan *xs,
+        cbuf            *cb)
+{
+    const char *q;
+    const char *amp;
+    const char *cr;
+    const char *p1;
+    const char *e;
+
+    if ((q = memchr(xs->xs_p, '<', xs->xs_end - xs->xs_p)) == NULL)
+        return 0; /* End of input in element */
+    amp = memchr(xs->xs_p, '&', q - xs->xs_p);
+    cr = memchr(xs->xs_p, '\r', q - xs->xs_p);
+    while (xs->xs_p < q){
+        p1 = q;
+        if (amp && amp < p1)
+            p1 = amp;
+        if (cr && cr < p1)
+            p1 = cr;
+        if (cb && p1 > xs->xs_p)
+            cbuf_append_buf(cb, (void*)xs->xs_p, p1 - xs->xs_p);
+        xs->xs_p = p1;
+        if (p1 == q)
+            break;
+        if (p1 == cr){
+            if (cb)
+                cbuf_append(cb, '\n');
+            xs->xs_p++;
+            if (xs->xs_p < q && *xs->xs_p == '\n')
+                xs->xs_p++;
+            cr = memchr(xs->xs_p, '\r', q - xs->xs_p);
+            continue;
+        }
+        /* Entity, @see xml_chardata_encode */
+        xs->xs_p++;
+        if ((e = memchr(xs->xs_p, ';', q - xs->xs_p)) == NULL)
+            return 0;
+        if (e - xs->xs_p == 3 && strncmp(xs->xs_p, "amp", 3) == 0){
+            if (cb)
+                cbuf_append(cb, '&');
+        }
+        else if (e - xs->xs_p == 2 && strncmp(xs->xs_p, "lt", 2) == 0){
+            if (cb)
+                cbuf_append(cb, '<');
+        }
+        else if (e - xs->xs_p == 2 && strncmp(xs->xs_p, "gt", 2) == 0){
+            if (cb)
+                cbuf_append(cb, '>');
+        }
+        else if (e - xs->xs_p == 4 && strncmp(xs->xs_p, "apos", 4) == 0){
+            if (cb)
+                cbuf_append(cb, '\'');
+        }
+        else if (e - xs->xs_p == 4 && strncmp(xs->xs_p, "quot", 4) == 0){
+            if (cb)
+                cbuf_append(cb, '"');
+        }
+        else if (*xs->xs_p == '#'){ /* Character reference is kept: ISO/IEC 10646 */
+            const char *d = xs->xs_p + 1;
+
+            if (d < e && *d == 'x'){
+                for (d++; d < e; d++)
+                    if (!((*d >= '0' && *d <= '9') || (*d >= 'a' && *d <= 'f') || (*d >= 'A' && *d <= 'F')))
+                        break;
+                if (d != e || e - xs->xs_p == 2)
+                    return 0;
+            }
+            else{
+                for (; d < e; d++)
+                    if (*d < '0' || *d > '9')
+                        break;
+                if (d != e || e - xs->xs_p == 1)
+                    return 0;
+            }
+            if (cb){
+                cbuf_append(cb, '&');
+                cbuf_append_buf(cb, (void*)xs->xs_p, e + 1 - xs->xs_p);
+            }
+        }
+        else
+            return 0;
+        xs->xs_p = e + 1;
+        amp = memchr(xs->xs_p, '&', q - xs->xs_p);
+    }
+    return 1;
+}
+
+/*! Skip comment or processing instruction at '<'
+ *
+ * @retval  1  Skipped
+ * @retval  0  Not a comment or PI, or not accepted, see type
+ * @param[out] type  0: not comment or PI, 1: not accepted
+ */
+static int
+xs_misc(struct xml_scan *xs,
+        int             *type)
+{
+    const char *p1;
+
+    *type = 0;
+    if (xs_is(xs, "<!--", 4)){
+        *type = 1;
+        xs->xs_p += 4;
+        if ((p1 = xs_find3(xs, "-->")) == NULL)
+            return 0;
+        xs->xs_p = p1 + 3;
+        return 1;
+    }
+    if (xs_is(xs, "<?", 2)){
+        /* Same as yacc parser: <?NAME ?> or <?NAME STRING?> */
+        *type = 1;
+        if (xs_is(xs, "<?xml", 5))
+            return 0;
+        xs->xs_p += 2;
+        if (xs_name(xs, xs->xs_name) == 0)
+            return 0;
+        if (xs->xs_p >= xs->xs_end || (*xs->xs_p != ' ' && *xs->xs_p != '\t'))
+            return 0;
+        xs->xs_p++;
+        while (xs->xs_p < xs->xs_end && strchr("{?>}", *xs->xs_p) == NULL)
+            xs->xs_p++;
+        if (!xs_is(xs, "?>", 2))
+            return 0;
+        xs->xs_p += 2;
+        return 1;
+    }
+    return 0;
+}
+
+/*! Scan XML declaration: <?xml version="1.0" encoding="UTF-8" standalone="yes"?>
+ *
+ * @retval  1  OK
+ * @retval  0  Not accepted
+ */
+static int
+xs_xmldecl(struct xml_scan *xs)
+{
+    xs->xs_p += 5; /* <?xml */
+    xs_ws(xs);
+    if (!xs_is(xs, "version", 7))
+        return 0;
+    xs->xs_p += 7;
+    xs_ws(xs);
+    if (!xs_is(xs, "=", 1))
+        return 0;
+    xs->xs_p++;
+    xs_ws(xs);
+    if (xs_quoted(xs) == 0 || strcmp(cbuf_get(xs->xs_value), "1.0") != 0)
+        return 0;
+    xs_ws(xs);
+    if (xs_is(xs, "encoding", 8)){
+        xs->xs_p += 8;
+        xs_ws(xs);
+        if (!xs_is(xs, "=", 1))
+            return 0;
+        xs->xs_p++;
+        xs_ws(xs);
+        if (xs_quoted(xs) == 0 || strcasecmp(cbuf_get(xs->xs_value), "UTF-8") != 0)
+            return 0;
+        xs_ws(xs);
+    }
+    if (xs_is(xs, "standalone", 10)){
+        xs->xs_p += 10;
+        xs_ws(xs);
+        if (!xs_is(xs, "=", 1))
+            return 0;
+        xs->xs_p++;
+        xs_ws(xs);
+        if (xs_quoted(xs) == 0)
+            return 0;
+        xs_ws(xs);
+    }
+    if (!xs_is(xs, "?>", 2))
+        return 0;
+    xs->xs_p += 2;
+    return 1;
+}
+
+/*! Scan start tag after '<', create element and attributes
+ *
+ * @param[in]  xs     Scanner state
+ * @param[in]  xy     Parse state, for top and top-level vector
+ * @param[in]  xp     Parent
+ * @param[out] xn     New element
+ * @param[out] empty  Element is empty: <x/>
+ * @retval     1      OK
+ * @retval     0      Not accepted
+ * @retval    -1      Error
+ */
+static int
+xs_starttag(struct xml_scan *xs,
+            clixon_xml_yacc *xy,
+            cxobj           *xp,
+            cxobj          **xn,
+            int             *empty)
+{
+    cxobj *x;
+    cxobj *xa;
+    char  *prefix;
+    char  *name;
+
+    xs_ws(xs);
+    if (xs_qname(xs, &prefix, &name) == 0)
+        return 0;
+    if ((x = xml_new(name, xp, CX_ELMNT)) == NULL)
+        return -1;
+    if (prefix && xml_prefix_set(x, prefix) < 0)
+        return -1;
+    /* If topmost, add to top-list created list */
+    if (xp == xy->xy_xtop &&
+        cxvec_append(x, &xy->xy_xvec, &xy->xy_xlen) < 0)
+        return -1;
+    *xn = x;
+    while (1){
+        xs_ws(xs);
+        if (xs->xs_p >= xs->xs_end)
+            return 0;
+        if (*xs->xs_p == '>'){
+            xs->xs_p++;
+            *empty = 0;
+            break;
+        }
+        if (xs_is(xs, "/>", 2)){
+            xs->xs_p += 2;
+            *empty = 1;
+            break;
+        }
+        if (xs_qname(xs, &prefix, &name) == 0)
+            return 0;
+        xs_ws(xs);
+        if (!xs_is(xs, "=", 1))
+            return 0;
+        xs->xs_p++;
+        xs_ws(xs);
+        if (xs_quoted(xs) == 0)
+            return 0;
+        /* Duplicates of same attributes are replaced, as yacc parser */
+        if ((xa = xml_find_type(x, prefix, name, CX_ATTR)) == NULL){
+            if ((xa = xml_new(name, x, CX_ATTR)) == NULL)
+                return -1;
+            if (prefix && xml_prefix_set(xa, prefix) < 0)
+                return -1;
+        }
+        if (xml_value_set(xa, cbuf_get(xs->xs_value)) < 0)
+            return -1;
+    }
+    return 1;
+}
+
+/*! Scan end tag after "</" and check it matches element
+ *
+ * @retval  1  OK
+ * @retval  0  Not accepted, also if not matching, yacc parser gives error message
+ */
+static int
+xs_endtag(struct xml_scan *xs,
+          cxobj           *x)
+{
+    char *prefix;
+    char *name;
+
+    xs_ws(xs);
+    if (xs_qname(xs, &prefix, &name) == 0)
+        return 0;
+    xs_ws(xs);
+    if (!xs_is(xs, ">", 1))
+        return 0;
+    xs->xs_p++;
+    if (clicon_strcmp(xml_name(x), name) ||
+        clicon_strcmp(xml_prefix(x), prefix))
+        return 0;
+    return 1;
+}
+
+/*! Scan XML string and build XML tree under xy_xtop, without yacc parser
+ *
+ * Non-recursive: the current element is x, its parent is found with xml_parent.
+ * @param[in]  xy    Parse state, xy_xtop is set, xy_xvec is set to new top-level elements
+ * @param[in]  str   XML string
+ * @param[in]  len   Length of str
+ * @retval     1     OK
+ * @retval     0     Not accepted, nothing added to xy_xtop, parse with yacc parser
+ * @retval    -1     Error
+ * @see _xml_parse
+ */
+int
+clixon_xml_scan(clixon_xml_yacc *xy,
+                const char      *str,
+                size_t           len)
+{
+    int             retval = -1;
+    struct xml_scan xs = {0,};
+    cxobj          *xt = xy->xy_xtop;
+    cxobj          *x;          /* Current element */
+    cxobj          *xn;
+    cxobj          *xb;
+    int             haselem = 1; /* Current element has element children, skip text */
+    int             decl = 0;    /* XML declaration, then only one top element */
+    int             ntop = 0;
+    int             misc;        /* After comment or PI, no text until next tag */
+    int             empty;
+    int             type;
+    int             i;
+    int             ret;
+
+    xs.xs_p = str;
+    xs.xs_end = str + len;
+    if ((xs.xs_text = cbuf_new()) == NULL ||
+        (xs.xs_prefix = cbuf_new()) == NULL ||
+        (xs.xs_name = cbuf_new()) == NULL ||
+        (xs.xs_value = cbuf_new()) == NULL){
+        clixon_err(OE_XML, errno, "cbuf_new");
+        goto done;
+    }
+    xs_ws(&xs);
+    if (xs_is(&xs, "<?xml", 5)){
+        if (xs_xmldecl(&xs) == 0)
+            goto fail;
+        decl++;
+    }
+    x = xt;
+    misc = 0;
+    while (1){
+        if (x == xt){ /* Top-level: only whitespace, comments, PIs and elements */
+            xs_ws(&xs);
+            if (xs.xs_p >= xs.xs_end)
+                break;
+            if (*xs.xs_p != '<')
+                goto fail;
+        }
+        else if (xs.xs_p >= xs.xs_end) /* End of input in element */
+            goto fail;
+        else if (*xs.xs_p != '<' || misc){
+            if (misc){ /* Lexer is in START state after comment */
+                xs_ws(&xs);
+                if (xs.xs_p >= xs.xs_end || *xs.xs_p != '<' || xs_is(&xs, "<![", 3))
+                    goto fail;
+            }
+            else if (xs_text(&xs, haselem?NULL:xs.xs_text) == 0)
+                goto fail;
+            misc = 0;
+            continue;
+        }
+        /* At '<' */
+        if (xs_is(&xs, "</", 2)){
+            if (x == xt)
+                goto fail;
+            xs.xs_p += 2;
+            if (xs_endtag(&xs, x) == 0)
+                goto fail;
+            if (!haselem && cbuf_len(xs.xs_text)){
+                if ((xb = xml_new("body", x, CX_BODY)) == NULL)
+                    goto done;
+                if (xml_value_set(xb, cbuf_get(xs.xs_text)) < 0)
+                    goto done;
+            }
+            cbuf_reset(xs.xs_text);
+            x = xml_parent(x);
+            haselem = 1;
+            continue;
+        }
+        if ((ret = xs_misc(&xs, &type)) == 1){
+            misc = (x != xt);
+            continue;
+        }
+        if (type == 1)
+            goto fail;
+        if (xs_is(&xs, "<![CDATA[", 9)){
+            const char *p1;
+
+            if (x == xt)
+                goto fail;
+            if ((p1 = xs_find3(&xs, "]]>")) == NULL)
+                goto fail;
+            p1 += 3;
+            if (!haselem)
+                cbuf_append_buf(xs.xs_text, (void*)xs.xs_p, p1 - xs.xs_p);
+            xs.xs_p = p1;
+            continue;
+        }
+        if (xs_is(&xs, "<!", 2))
+            goto fail;
+        /* Start tag */
+        if (x == xt && decl && ntop++ > 0)
+            goto fail;
+        xs.xs_p++;
+        if ((ret = xs_starttag(&xs, xy, x, &xn, &empty)) < 0)
+            goto done;
+        if (ret == 0)
+            goto fail;
+        cbuf_reset(xs.xs_text);
+        if (empty)
+            haselem = 1;
+        else {
+            x = xn;
+            haselem = 0;
+        }
+    }
+    retval = 1;
+ done:
+    if (xs.xs_text)
+        cbuf_free(xs.xs_text);
+    if (xs.xs_prefix)
+        cbuf_free(xs.xs_prefix);
+    if (xs.xs_name)
+        cbuf_free(xs.xs_name);
+    if (xs.xs_value)
+        cbuf_free(xs.xs_value);
+    return retval;
+ fail:
+    /* Remove partial result */
+    for (i = 0; i < xy->xy_xlen; i++)
+        xml_purge(xy->xy_xvec[i]);
+    if (xy->xy_xvec){
+        free(xy->xy_xvec);
+        xy->xy_xvec = NULL;
+    }
+    xy->xy_xlen = 0;
+    retval = 0;
+    goto done;
+}
@@ -75,6 +75,7 @@
 #include "clixon_yang_module.h"
 #include "clixon_xml_vec.h"
 #include "clixon_xml_sort.h"
+#include "clixon_xml_hindex.h"
 
 /*! Get xml body value as cligen variable
  *
@@ -86,8 +87,9 @@
  * Move to clixon_xml.c?
  * As a side-effect sets the cache.
  * Clear cache with xml_cv_set(x, NULL)
+ * Also used by generated typed accessors, see clixon_yang2c.c
  */
-static int
+int
 xml_cv_cache(cxobj   *x,
              cg_var **cvp)
 {
@@ -146,13 +148,152 @@ xml_cv_cache(cxobj   *x,
     return retval;
 }
 
+#ifdef XML_BIND_CV_CACHE
+/*! Compute typed value cache of a bound leaf or leaf-list node if it is integer or decimal64
+ *
+ * @param[in]  x   XML node bound to a leaf or leaf-list
+ * @retval     0   OK, cache may be set or not
+ * @retval    -1   Error
+ * @note Parse errors are not reported here, only in the lazy cache (or validation)
+ */
+static int
+xml_cv_bind1(cxobj *x)
+{
+    int          retval = -1;
+    cg_var      *cv = NULL;
+    yang_stmt   *y;
+    yang_stmt   *yrestype = NULL;
+    enum cv_type cvtype;
+    int          options = 0;
+    uint8_t      fraction = 0;
+    char        *body;
+    char        *reason = NULL;
+    int          ret;
+
+    if (xml_cv(x) != NULL || (body = xml_body(x)) == NULL)
+        goto ok;
+    if ((y = xml_spec(x)) == NULL)
+        goto ok;
+    if (yang_type_get(y, NULL, &yrestype, &options, NULL, NULL, NULL, &fraction) < 0)
+        goto done;
+    if (yrestype == NULL)
+        goto ok;
+    yang2cv_type(yang_argument_get(yrestype), &cvtype);
+    if (cvtype < CGV_INT8 || cvtype > CGV_DEC64)
+        goto ok;
+    if ((cv = cv_new(cvtype)) == NULL){
+        clixon_err(OE_YANG, errno, "cv_new");
+        goto done;
+    }
+    if (cvtype == CGV_DEC64)
+        cv_dec64_n_set(cv, fraction);
+    if ((ret = cv_parse1(body, cv, &reason)) < 0){
+        clixon_err(OE_YANG, errno, "cv_parse1");
+        goto done;
+    }
+    if (ret == 0)
+        goto ok;
+    if (xml_cv_set(x, cv) < 0)
+        goto done;
+    cv = NULL;
+ ok:
+    retval = 0;
+ done:
+    if (reason)
+        free(reason);
+    if (cv)
+        cv_free(cv);
+    return retval;
+}
+
+/*! Compute typed value cache of list keys or leaf-list value of a yang-bound XML node
+ *
+ * Called when binding yang to XML so that subsequent xml_cmp() calls in binary search
+ * and sorted insert do not need to parse body strings.
+ * @param[in]  x   XML node bound to yang
+ * @retval     0   OK
+ * @retval    -1   Error
+ * @see XML_BIND_CV_CACHE
+ */
+int
+xml_cv_bind(cxobj *x)
+{
+    int        retval = -1;
+    yang_stmt *y;
+    cvec      *cvk;
+    cg_var    *cvi = NULL;
+    cxobj     *xk;
+
+    if ((y = xml_spec(x)) == NULL)
+        goto ok;
+    switch (yang_keyword_get(y)){
+    case Y_LEAF_LIST:
+        if (xml_cv_bind1(x) < 0)
+            goto done;
+        break;
+    case Y_LIST:
+        cvk = yang_cvec_get(y); /* Use Y_LIST cache, see ys_populate_list() */
+        while ((cvi = cvec_each(cvk, cvi)) != NULL) {
+            if ((xk = xml_find_type(x, NULL, cv_string_get(cvi), CX_ELMNT)) == NULL)
+                continue;
+            if (xml_cv_bind1(xk) < 0)
+                goto done;
+        }
+        break;
+    default:
+        break;
+    }
+ ok:
+    retval = 0;
+ done:
+    return retval;
+}
+#endif /* XML_BIND_CV_CACHE */
+
+/*! Compare two cached cligen values
+ *
+ * Fast path for integer types of the same type, otherwise cv_cmp
+ */
+static inline int
+xml_cv_cmp(cg_var *cv1,
+           cg_var *cv2)
+{
+    enum cv_type t;
+
+    if ((t = cv_type_get(cv1)) == cv_type_get(cv2)){
+        switch (t){
+        case CGV_INT8:
+            return (cv_int8_get(cv1) > cv_int8_get(cv2)) - (cv_int8_get(cv1) < cv_int8_get(cv2));
+        case CGV_INT16:
+            return (cv_int16_get(cv1) > cv_int16_get(cv2)) - (cv_int16_get(cv1) < cv_int16_get(cv2));
+        case CGV_INT32:
+            return (cv_int32_get(cv1) > cv_int32_get(cv2)) - (cv_int32_get(cv1) < cv_int32_get(cv2));
+        case CGV_INT64:
+            return (cv_int64_get(cv1) > cv_int64_get(cv2)) - (cv_int64_get(cv1) < cv_int64_get(cv2));
+        case CGV_UINT8:
+            return (cv_uint8_get(cv1) > cv_uint8_get(cv2)) - (cv_uint8_get(cv1) < cv_uint8_get(cv2));
+        case CGV_UINT16:
+            return (cv_uint16_get(cv1) > cv_uint16_get(cv2)) - (cv_uint16_get(cv1) < cv_uint16_get(cv2));
+        case CGV_UINT32:
+            return (cv_uint32_get(cv1) > cv_uint32_get(cv2)) - (cv_uint32_get(cv1) < cv_uint32_get(cv2));
+        case CGV_UINT64:
+            return (cv_uint64_get(cv1) > cv_uint64_get(cv2)) - (cv_uint64_get(cv1) < cv_uint64_get(cv2));
+        default:
+            break;
+        }
+    }
+    return cv_cmp(cv1, cv2);
+}
+
 static int
 xml_cv_cache_clear(cxobj *xt)
 {
     int    retval = -1;
     cxobj *x = NULL;
+    int    inext;
 
-    while ((x = xml_child_each(xt, x, CX_ELMNT)) != NULL)
+    inext = 0;
+    while ((x = xml_child_iter(xt, &inext, CX_ELMNT)) != NULL)
         if (xml_cv_set(x, NULL) < 0)
             goto done;
     retval = 0;
@@ -316,7 +457,7 @@ xml_cmp(cxobj      *x1,
             if (xml_cv_cache(x2, &cv2) < 0) /* error case */
                 goto done;
             if (cv1 != NULL && cv2 != NULL)
-                equal = cv_cmp(cv1, cv2);
+                equal = xml_cv_cmp(cv1, cv2);
             else if (cv1 == NULL && cv2 == NULL)
                 equal = 0;
             else if (cv1 == NULL)
@@ -350,7 +491,7 @@ xml_cmp(cxobj      *x1,
                         goto done;
                     if (xml_cv_cache(x2b, &cv2) < 0) /* error case */
                         goto done;
-                    equal = cv_cmp(cv1, cv2);
+                    equal = xml_cv_cmp(cv1, cv2);
                 }
             }
             if (equal)
@@ -393,7 +534,7 @@ xml_cmp(cxobj      *x1,
                             goto done;
                         if (xml_cv_cache(x2b, &cv2) < 0) /* error case */
                             goto done;
-                        equal = cv_cmp(cv1, cv2);
+                        equal = xml_cv_cmp(cv1, cv2);
                     }
                 }
                 if (equal)
@@ -473,33 +614,62 @@ xml_sort(cxobj *x)
     return 0;
 }
 
-/*! Recursively sort a tree 
+/*! Sort children of an XML node unless they are already sorted
  *
- * Alt to use xml_apply
+ * The children are verified in one linear pass, and only sorted if not in order, which
+ * is common for input that was printed sorted, eg datastores.
  * @param[in]  xn      XML node
- * @retval     0       OK
+ * @retval     1       Not sortable, neither are its children
+ * @retval     0       OK, children sorted
  * @retval    -1       Error
+ * @see xml_sort_recurse  which makes this for each node in a tree
  */
 int
-xml_sort_recurse(cxobj *xn)
+xml_sort_children(cxobj *xn)
 {
-    int    retval = -1;
-    cxobj *x;
-    int    ret;
+    int retval = -1;
+    int ret;
 
     ret = xml_sort_verify(xn, NULL);
     if (ret == 1) /* This node is not sortable */
-        goto ok;
+        goto notsortable;
     if (ret == -1){ /* not sorted */
         if ((ret = xml_sort(xn)) < 0)
             goto done;
         if (ret == 1) /* This node is not sortable */
-            goto ok;
+            goto notsortable;
     }
     if (xml_cv_cache_clear(xn) < 0)
         goto done;
-    x = NULL;
-    while ((x = xml_child_each(xn, x, CX_ELMNT)) != NULL) {
+    retval = 0;
+ done:
+    return retval;
+ notsortable:
+    retval = 1;
+    goto done;
+}
+
+/*! Recursively sort a tree 
+ *
+ * Alt to use xml_apply
+ * @param[in]  xn      XML node
+ * @retval     0       OK
+ * @retval    -1       Error
+ */
+int
+xml_sort_recurse(cxobj *xn)
+{
+    int    retval = -1;
+    cxobj *x;
+    int    ret;
+    int    inext;
+
+    if ((ret = xml_sort_children(xn)) < 0)
+        goto done;
+    if (ret == 1) /* This node is not sortable */
+        goto ok;
+    inext = 0;
+    while ((x = xml_child_iter(xn, &inext, CX_ELMNT)) != NULL) {
         if (xml_sort_recurse(x) < 0)
             goto done;
     }
@@ -568,8 +738,7 @@ xml_find_keys_notsorted(cxobj   *xp,
 
 /*! Find more equal objects in a vector up and down in the array of the present
  *
- * @param[in]  childvec  Vector of children of parent
- * @param[in]  childlen  Length of child vector
+ * @param[in]  xp        Parent XML node
  * @param[in]  x1        XML node to match
  * @param[in]  yangi     Yang order number (according to spec)
  * @param[in]  mid       Where to start from (may be in middle of interval)
@@ -578,8 +747,7 @@ xml_find_keys_notsorted(cxobj   *xp,
  * @retval    -1         Error
  */
 static int
-search_multi_equals(cxobj  **childvec,
-                    size_t   childlen,
+search_multi_equals(cxobj   *xp,
                     cxobj   *x1,
                     int      yangi,
                     int      mid,
@@ -593,7 +761,7 @@ search_multi_equals(cxobj  **childvec,
     int        yi;
 
     for (i=mid-1; i>=0; i--){ /* First decrement */
-        xc = childvec[i];
+        xc = xml_child_i(xp, i);
         yc = xml_spec(xc);
         if ((yi = yang_order(yc)) < -1)
             goto done;
@@ -604,8 +772,8 @@ search_multi_equals(cxobj  **childvec,
         if (clixon_xvec_prepend(xvec, xc) < 0)
             goto done;
     }
-    for (i=mid+1; i<childlen; i++){ /* Then increment */
-        xc = childvec[i];
+    for (i=mid+1; i<xml_child_nr(xp); i++){ /* Then increment */
+        xc = xml_child_i(xp, i);
         yc = xml_spec(xc);
         if ((yi = yang_order(yc)) < -1)
             goto done;
@@ -841,8 +1009,7 @@ xml_search_binary(cxobj   *xp,
         if (clixon_xvec_append(xvec, xc) < 0)
             goto done;
         /* there may be more? */
-        if (search_multi_equals(xml_childvec_get(xp), xml_child_nr(xp),
-                                x1, yangi, mid, skip1, xvec) < 0)
+        if (search_multi_equals(xp, x1, yangi, mid, skip1, xvec) < 0)
             goto done;
     }
     else if (cmp < 0)
@@ -904,10 +1071,19 @@ xml_search_yang(cxobj       *xp,
 #endif
         if (yang_keyword_get(yc) == Y_LIST || yang_keyword_get(yc) == Y_LEAF_LIST)
             sorted = (yang_find(yc, Y_ORDERED_BY, "user") == NULL);
+    if (indexvar == NULL){
+        int ret;
+        /* Exact key lookup, keys missing in x1 reverts to binary search */
+        if ((ret = xml_hindex_search(xp, x1, yc, xvec)) < 0)
+            goto done;
+        if (ret == 1)
+            goto ok;
+    }
     if ((yangi = yang_order(yc)) < -1)
         goto done;
     if (xml_search_binary(xp, x1, sorted, yangi, low, upper, skip1, indexvar, xvec) < 0)
         goto done;
+ ok:
     retval = 0;
  done:
     return retval;
@@ -932,6 +1108,9 @@ xml_search_yang(cxobj       *xp,
  * LEAF-LIST: RFC7950 7.7.9 
  *                       yang:insert="after"
  *                       yang:value="3des-cbc">blowfish-cbc</cipher>)
+ * @note The siblings with spec yn are adjacent, first and last are found with binary search.
+ *       The anchor of before/after is found by key with xpath, using the hash index if
+ *       CLICON_XML_HASH_INDEX is set, and its position with the position hint of xml_child_order
  */
 static int
 xml_insert_userorder(cxobj           *xp,
@@ -944,31 +1123,34 @@ xml_insert_userorder(cxobj           *xp,
 {
     int        retval = -1;
     int        i;
+    int        low;
+    int        upper;
     cxobj     *xc;
-    yang_stmt *yc;
 
     switch (ins){
-    case INS_FIRST:
-        for (i=mid-1; i>=0; i--){ /* decrement */
-            xc = xml_child_i(xp, i);
-            yc = xml_spec(xc);
-            if (yc != yn){
-                retval = i+1;
-                goto done;
-            }
+    case INS_FIRST: /* First i in [0,mid] with spec yn */
+        low = 0;
+        upper = mid;
+        while (low < upper){
+            i = (low + upper) / 2;
+            if (xml_spec(xml_child_i(xp, i)) == yn)
+                upper = i;
+            else
+                low = i+1;
         }
-        retval = i+1;
+        retval = low;
         break;
-    case INS_LAST:
-        for (i=mid+1; i<xml_child_nr(xp); i++){ /* First increment */
-            xc = xml_child_i(xp, i);
-            yc = xml_spec(xc);
-            if (yc != yn){
-                retval = i;
-                goto done;
-            }
+    case INS_LAST: /* First i in [mid+1,nr] without spec yn */
+        low = mid+1;
+        upper = xml_child_nr(xp);
+        while (low < upper){
+            i = (low + upper) / 2;
+            if (xml_spec(xml_child_i(xp, i)) == yn)
+                low = i+1;
+            else
+                upper = i;
         }
-        retval = i;
+        retval = low;
         break;
     case INS_BEFORE:
     case INS_AFTER: /* see retval handling different between before and after */
@@ -1003,7 +1185,6 @@ xml_insert_userorder(cxobj           *xp,
             } /* switch */
         }
     }
- done:
     return retval;
 }
 
@@ -1062,7 +1243,7 @@ xml_insert2(cxobj           *xp,
         cmp = 1;
     }
     if (yc == yn){ /* Same yang */
-        if (userorder){ /* append: increment linearly until no longer equal */
+        if (userorder){ /* first, last, before or after siblings with same yang */
             retval = xml_insert_userorder(xp, xn, yn, mid, ins, key_val, nsc_key);
             goto done;
         }
@@ -1184,6 +1365,7 @@ xml_sort_verify(cxobj *x0,
     int    retval = -1;
     cxobj *x = NULL;
     cxobj *xprev = NULL;
+    int    inext;
 #ifndef STATE_ORDERED_BY_SYSTEM
     yang_stmt *ys;
 
@@ -1195,7 +1377,8 @@ xml_sort_verify(cxobj *x0,
 #endif
     if (xml_type(x0) == CX_ELMNT){
         xml_enumerate_children(x0);
-        while ((x = xml_child_each(x0, x, -1)) != NULL) {
+        inext = 0;
+        while ((x = xml_child_iter(x0, &inext, -1)) != NULL) {
             if (xprev != NULL){ /* Check xprev <= x */
                 if (xml_cmp(xprev, x, 1, 0, NULL) > 0)
                     goto done;
@@ -1284,6 +1467,7 @@ xml_find_noyang_cvk(const char  *ns0,
     char   *keyname;
     char   *keyval;
     char   *body;
+    int     inext;
 
     cvi = NULL;
     /* Loop through index variables. xc should match all, on exit if cvi=NULL it macthes */
@@ -1300,8 +1484,8 @@ xml_find_noyang_cvk(const char  *ns0,
         else{
             /* Index variable on form <id>=<val>
              * Loop through children of the matched x (to match keyname and value) */
-            xcc = NULL;
-            while ((xcc = xml_child_each(xc, xcc, CX_ELMNT)) != NULL) {
+            inext = 0;
+            while ((xcc = xml_child_iter(xc, &inext, CX_ELMNT)) != NULL) {
                 if (xml2ns(xcc, xml_prefix(xcc), &ns) < 0)
                     goto done;
                 if (strcmp(ns0, ns) != 0) /* Namespace does not match, skip */
@@ -1341,14 +1525,15 @@ xml_find_noyang_name(cxobj       *xp,
     int     retval = -1;
     cxobj  *xc;
     char   *ns;
+    int     inext;
 
     if (name == NULL || ns0 == NULL){
         clixon_err(OE_XML, EINVAL, "name and namespace required");
         goto done;
     }
     /* Go through children linearly */
-    xc = NULL;
-    while ((xc = xml_child_each(xp, xc, CX_ELMNT)) != NULL) {
+    inext = 0;
+    while ((xc = xml_child_iter(xp, &inext, CX_ELMNT)) != NULL) {
         ns = NULL;
         if (xml2ns(xc, xml_prefix(xc), &ns) < 0)
             goto done;
@@ -1634,6 +1819,7 @@ clixon_xml_find_pos(cxobj        *xp,
     cxobj     *xc = NULL;
     char      *name;
     uint32_t   u;
+    int        inext;
 
     if (yc == NULL){
         clixon_err(OE_YANG, ENOENT, "yang spec not found");
@@ -1641,8 +1827,8 @@ clixon_xml_find_pos(cxobj        *xp,
     }
     name = yang_argument_get(yc);
     u = 0;
-    xc = NULL;
-    while ((xc = xml_child_each(xp, xc, CX_ELMNT)) != NULL) {
+    inext = 0;
+    while ((xc = xml_child_iter(xp, &inext, CX_ELMNT)) != NULL) {
         if (strcmp(name, xml_name(xc)))
             continue;
         if (pos == u++){ /* Found */
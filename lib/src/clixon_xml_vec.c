@@ -75,15 +75,38 @@
 
 /*! Clixon xml vector concrete implementaion of the abstract clixon_xvec type
  *
- * Contiguous vector (not linked list) so that binary search can be done by direct index access
+ * Gap buffer: a vector (not linked list) so that binary search can be done by direct index
+ * access, with the unused allocation as a gap at the last insert or remove position.
+ * Elements before xv_gap are at the start of xv_vec and the rest at the end. An insert or
+ * remove only moves the elements between the old and new gap position, which makes
+ * appends, repeated prepends and inserts near the last insert amortized O(1).
  */
 struct clixon_xml_vec {
     cxobj **xv_vec;   /* Sorted vector of xml object pointers */
     int     xv_len;   /* Length of vector */
     int     xv_max;   /* Vector allocation */
+    int     xv_gap;   /* Position of gap of xv_max-xv_len unused entries */
 };
 
-/*! Increment cxobj vector in an XML object vector
+/*! Move gap of XML object vector to position i
+ *
+ * @param[in]  xv    XML tree vector
+ * @param[in]  i     New gap position, 0 <= i <= xv_len
+ */
+static void
+clixon_xvec_gap_move(clixon_xvec *xv,
+                     int          i)
+{
+    int gsz = xv->xv_max - xv->xv_len;
+
+    if (gsz && i < xv->xv_gap)
+        memmove(&xv->xv_vec[i+gsz], &xv->xv_vec[i], sizeof(cxobj *) * (xv->xv_gap-i));
+    else if (gsz && i > xv->xv_gap)
+        memmove(&xv->xv_vec[xv->xv_gap], &xv->xv_vec[xv->xv_gap+gsz], sizeof(cxobj *) * (i-xv->xv_gap));
+    xv->xv_gap = i;
+}
+
+/*! Ensure there is room for one more element in XML object vector
  *
  * Exponential growth to a threshold, then linear
  * @param[in]  xv    XML tree vector
@@ -94,19 +117,24 @@ static int
 clixon_xvec_inc(clixon_xvec *xv)
 {
     int retval = -1;
-
-    xv->xv_len++;
-    if (xv->xv_len > xv->xv_max){
-        if (xv->xv_max < XVEC_MAX_DEFAULT)
-            xv->xv_max = XVEC_MAX_DEFAULT;
-        else if (xv->xv_max < XVEC_MAX_THRESHOLD)
-            xv->xv_max *= 2;                  /* Double the space - exponential */
+    int max;
+
+    if (xv->xv_len == xv->xv_max){ /* Gap is empty */
+        max = xv->xv_max;
+        if (max < XVEC_MAX_DEFAULT)
+            max = XVEC_MAX_DEFAULT;
+        else if (max < XVEC_MAX_THRESHOLD)
+            max *= 2;                  /* Double the space - exponential */
         else
-            xv->xv_max += XVEC_MAX_THRESHOLD; /* Add - linear growth */
-        if ((xv->xv_vec = realloc(xv->xv_vec, sizeof(cxobj *) * xv->xv_max)) == NULL){
+            max += XVEC_MAX_THRESHOLD; /* Add - linear growth */
+        if ((xv->xv_vec = realloc(xv->xv_vec, sizeof(cxobj *) * max)) == NULL){
             clixon_err(OE_XML, errno, "realloc");
             goto done;
         }
+        /* Move elements after gap to the end */
+        memmove(&xv->xv_vec[xv->xv_gap + max - xv->xv_len], &xv->xv_vec[xv->xv_gap],
+                sizeof(cxobj *) * (xv->xv_len - xv->xv_gap));
+        xv->xv_max = max;
     }
     retval = 0;
  done:
@@ -132,6 +160,7 @@ clixon_xvec_new(void)
     memset(xv, 0, sizeof(*xv));
     xv->xv_len = 0;
     xv->xv_max = 0;
+    xv->xv_gap = 0;
 
  done:
     return xv;
@@ -140,7 +169,7 @@ clixon_xvec_new(void)
 /*! Create and copy XML vector
  *
  * @param[in]  xv0    XML tree vector
- * @retval     xv1    Duplicated XML vector
+ * @retval     xv1    Duplicated XML vector, with gap at the end
  * @retval     NULL   Error
  */
 clixon_xvec *
@@ -159,7 +188,12 @@ clixon_xvec_dup(clixon_xvec *xv0)
         xv1 = NULL;
         goto done;
     }
-    memcpy(xv1->xv_vec, xv0->xv_vec, xv0->xv_len*sizeof(cxobj*));
+    if (xv0->xv_len){
+        memcpy(xv1->xv_vec, xv0->xv_vec, xv0->xv_gap*sizeof(cxobj*));
+        memcpy(&xv1->xv_vec[xv0->xv_gap], &xv0->xv_vec[xv0->xv_gap + xv0->xv_max - xv0->xv_len],
+               (xv0->xv_len - xv0->xv_gap)*sizeof(cxobj*));
+    }
+    xv1->xv_gap = xv1->xv_len;
  done:
     return xv1;
 }
@@ -197,10 +231,12 @@ cxobj*
 clixon_xvec_i(clixon_xvec *xv,
               int          i)
 {
-    if (i < xv->xv_len)
+    if (i < 0 || i >= xv->xv_len)
+        return NULL;
+    else if (i < xv->xv_gap)
         return xv->xv_vec[i];
     else
-        return NULL;
+        return xv->xv_vec[i + xv->xv_max - xv->xv_len];
 }
 
 /*! Return whole XML object vector and null it in original xvec, essentially moving it
@@ -225,6 +261,7 @@ clixon_xvec_extract(clixon_xvec *xv,
         clixon_err(OE_XML, EINVAL, "xv is NULL");
         goto done;
     }
+    clixon_xvec_gap_move(xv, xv->xv_len); /* Make elements contiguous */
     *xvec = xv->xv_vec;
     *xlen = xv->xv_len;
     if (xmax)
@@ -232,6 +269,7 @@ clixon_xvec_extract(clixon_xvec *xv,
     if (xv->xv_vec != NULL){
         xv->xv_len = 0;
         xv->xv_max = 0;
+        xv->xv_gap = 0;
         xv->xv_vec = NULL;
     }
     retval = 0;
@@ -255,14 +293,7 @@ int
 clixon_xvec_append(clixon_xvec *xv,
                    cxobj       *x)
 {
-    int retval = -1;
-
-    if (clixon_xvec_inc(xv) < 0)
-        goto done;
-    xv->xv_vec[xv->xv_len-1] = x;
-    retval = 0;
- done:
-    return retval;
+    return clixon_xvec_insert_pos(xv, x, xv->xv_len);
 }
 
 /*! Append a second clixon-xvec into a first
@@ -286,9 +317,8 @@ clixon_xvec_merge(clixon_xvec *xv0,
 
     for (i=0; i<clixon_xvec_len(xv1); i++){
         x = clixon_xvec_i(xv1, i);
-        if (clixon_xvec_inc(xv0) < 0)
+        if (clixon_xvec_append(xv0, x) < 0)
             goto done;
-        xv0->xv_vec[xv0->xv_len-1] = x;
     }
     retval = 0;
  done:
@@ -311,15 +341,7 @@ int
 clixon_xvec_prepend(clixon_xvec *xv,
                     cxobj       *x)
 {
-    int retval = -1;
-
-    if (clixon_xvec_inc(xv) < 0)
-        goto done;
-    memmove(&xv->xv_vec[1], &xv->xv_vec[0], sizeof(cxobj *) * (xv->xv_len-1));
-    xv->xv_vec[0] = x;
-    retval = 0;
- done:
-    return retval;
+    return clixon_xvec_insert_pos(xv, x, 0);
 }
 
 /*! Insert XML node x at position i in XML object vector
@@ -335,14 +357,17 @@ clixon_xvec_insert_pos(clixon_xvec *xv,
                        cxobj       *x,
                        int          i)
 {
-    int    retval = -1;
-    size_t size;
+    int retval = -1;
 
+    if (i < 0 || i > xv->xv_len){
+        clixon_err(OE_XML, EINVAL, "position %d out of range", i);
+        goto done;
+    }
     if (clixon_xvec_inc(xv) < 0)
         goto done;
-    size = (xv->xv_len - i -1)*sizeof(cxobj *);
-    memmove(&xv->xv_vec[i+1], &xv->xv_vec[i], size);
-    xv->xv_vec[i] = x;
+    clixon_xvec_gap_move(xv, i);
+    xv->xv_vec[xv->xv_gap++] = x;
+    xv->xv_len++;
     retval = 0;
  done:
     return retval;
@@ -359,10 +384,12 @@ int
 clixon_xvec_rm_pos(clixon_xvec *xv,
                    int          i)
 {
-    size_t size;
-
-    size = (xv->xv_len - i + 1)*sizeof(cxobj *);
-    memmove(&xv->xv_vec[i], &xv->xv_vec[i+1], size);
+    if (i < 0 || i >= xv->xv_len){
+        clixon_err(OE_XML, EINVAL, "position %d out of range", i);
+        return -1;
+    }
+    clixon_xvec_gap_move(xv, i+1);
+    xv->xv_gap--;
     xv->xv_len--;
     return 0;
 }
@@ -381,7 +408,7 @@ clixon_xvec_print(FILE        *f,
     int i;
 
     for (i=0; i<xv->xv_len; i++)
-        if (clixon_xml2file(f, xv->xv_vec[i], 0, 1, NULL, fprintf, 0, 0) < 0)
+        if (clixon_xml2file(f, clixon_xvec_i(xv, i), 0, 1, NULL, fprintf, 0, 0) < 0)
             return -1;
     return 0;
 }
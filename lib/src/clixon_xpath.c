@@ -78,7 +78,9 @@
 #include <stdint.h>
 #include <syslog.h>
 #include <fcntl.h>
+#include <inttypes.h>
 #include <math.h>  /* NaN */
+#include <sys/time.h>
 
 /* cligen */
 #include <cligen/cligen.h>
@@ -94,7 +96,9 @@
 #include "clixon_err.h"
 #include "clixon_log.h"
 #include "clixon_debug.h"
+#include "clixon_trace.h"
 #include "clixon_xml_nsctx.h"
+#include "clixon_options.h"
 #include "clixon_netconf_lib.h"
 #include "clixon_data.h"
 #include "clixon_yang_module.h"
@@ -112,10 +116,60 @@
  */
 #define XPATH_USE_APOSTROPHE
 
+/* Max number of distinct XPath strings in the XPath profile, further XPaths are not recorded
+ * @see xpath_profile_set
+ */
+#define XPATH_PROFILE_MAX 1024
+
+#ifdef XPATH_PARSE_CACHE
+/*! Parsed XPath tree cache entry
+ *
+ * Entries are in a LRU queue where the head is least recently used, and in a hash chain
+ * keyed by XPath string.
+ * Entries in use by an ongoing evaluation (xe_refs>0) are not evicted, since evaluation
+ * may itself parse XPaths, eg via deref() or when statements.
+ */
+struct xpath_cache_entry{
+    qelem_t                   xe_q;     /* LRU queue, least recently used first */
+    struct xpath_cache_entry *xe_hnext; /* Next in hash chain */
+    char                     *xe_str;   /* XPath string (key) */
+    uint32_t                  xe_hash;  /* Hash of xe_str */
+    xpath_tree               *xe_tree;  /* Parsed XPath tree */
+    int                       xe_refs;  /* In use by this number of evaluations */
+};
+typedef struct xpath_cache_entry xpath_cache_entry;
+#endif /* XPATH_PARSE_CACHE */
+
+/*! XPath profile entry, value of XPath profile hash keyed by XPath string
+ */
+struct xpath_profile_entry{
+    uint64_t xpe_calls;     /* Number of evaluations */
+    uint64_t xpe_usec;      /* Total evaluation time in microseconds */
+    uint64_t xpe_max_usec;  /* Max evaluation time in microseconds */
+    uint64_t xpe_nodes;     /* Total number of nodes visited */
+    uint64_t xpe_optimized; /* Number of evaluations where list optimization was made */
+};
+typedef struct xpath_profile_entry xpath_profile_entry;
+
 /*
  * Variables
  */
 
+#ifdef XPATH_PARSE_CACHE
+static int                 _xpath_cache_enable = 1;  /* See xpath_parse_cache_set */
+static xpath_cache_entry  *_xpath_cache_lru = NULL;  /* LRU queue */
+static xpath_cache_entry **_xpath_cache_hash = NULL; /* Hash buckets */
+static int                 _xpath_cache_nr = 0;      /* Number of entries */
+static int                 _xpath_cache_hits = 0;
+static int                 _xpath_cache_misses = 0;
+#endif /* XPATH_PARSE_CACHE */
+
+static int            _xpath_profile_enable = 0;
+static clicon_hash_t *_xpath_profile = NULL;      /* Profile entries keyed by XPath */
+static int            _xpath_profile_nr = 0;      /* Number of entries */
+static uint64_t       _xpath_profile_nodes = 0;   /* Nodes visited by ongoing evaluation */
+static uint64_t       _xpath_profile_opt = 0;     /* Optimizations of ongoing evaluation */
+
 /* Mapping between XPath_tree node name string <--> int
  * @see xpath_tree_int2str
  */
@@ -609,6 +663,496 @@ xpath_parse(const char  *xpath,
     return retval;
 }
 
+#ifdef XPATH_PARSE_CACHE
+/*! Hash function of XPath string (FNV-1a)
+ */
+static uint32_t
+xpath_cache_hashfn(const char *str)
+{
+    uint32_t h = 2166136261U;
+
+    while (*str){
+        h ^= (uint8_t)*str++;
+        h *= 16777619U;
+    }
+    return h;
+}
+
+/*! Remove and free a cache entry
+ *
+ * @param[in]  xe  Cache entry, not in use
+ */
+static void
+xpath_cache_entry_free(xpath_cache_entry *xe)
+{
+    xpath_cache_entry **xep;
+
+    xep = &_xpath_cache_hash[xe->xe_hash % XPATH_PARSE_CACHE];
+    while (*xep != xe)
+        xep = &(*xep)->xe_hnext;
+    *xep = xe->xe_hnext;
+    DELQ(xe, _xpath_cache_lru, xpath_cache_entry *);
+    _xpath_cache_nr--;
+    if (xe->xe_tree)
+        xpath_tree_free(xe->xe_tree);
+    if (xe->xe_str)
+        free(xe->xe_str);
+    free(xe);
+}
+
+/*! Get parsed XPath tree from cache, parse and add to cache if not found
+ *
+ * The entry is marked in use and must be released with xpath_cache_release
+ * @param[in]  xpath  String with XPath 1.0 syntax
+ * @param[out] xep    Cache entry, use xe_tree for the parsed tree
+ * @retval     0      OK
+ * @retval    -1      Error
+ * @see xpath_parse
+ */
+static int
+xpath_cache_get(const char         *xpath,
+                xpath_cache_entry **xep)
+{
+    int                retval = -1;
+    xpath_cache_entry *xe;
+    xpath_cache_entry *xn;
+    uint32_t           h;
+    int                i;
+
+    if (xpath == NULL){
+        clixon_err(OE_XML, EINVAL, "XPath is NULL");
+        goto done;
+    }
+    if (_xpath_cache_hash == NULL){
+        if ((_xpath_cache_hash = calloc(XPATH_PARSE_CACHE, sizeof(*_xpath_cache_hash))) == NULL){
+            clixon_err(OE_UNIX, errno, "calloc");
+            goto done;
+        }
+    }
+    h = xpath_cache_hashfn(xpath);
+    for (xe = _xpath_cache_hash[h % XPATH_PARSE_CACHE]; xe; xe = xe->xe_hnext)
+        if (xe->xe_hash == h && strcmp(xe->xe_str, xpath) == 0)
+            break;
+    if (xe != NULL){
+        _xpath_cache_hits++;
+        /* Move to most recently used */
+        DELQ(xe, _xpath_cache_lru, xpath_cache_entry *);
+        ADDQ(xe, _xpath_cache_lru);
+    }
+    else {
+        _xpath_cache_misses++;
+        /* Evict least recently used entries not in use */
+        xe = _xpath_cache_lru;
+        for (i = _xpath_cache_nr; i > 0 && _xpath_cache_nr >= XPATH_PARSE_CACHE; i--){
+            xn = NEXTQ(xpath_cache_entry *, xe);
+            if (xe->xe_refs == 0)
+                xpath_cache_entry_free(xe);
+            xe = xn;
+        }
+        if ((xe = malloc(sizeof(*xe))) == NULL){
+            clixon_err(OE_UNIX, errno, "malloc");
+            goto done;
+        }
+        memset(xe, 0, sizeof(*xe));
+        if ((xe->xe_str = strdup(xpath)) == NULL){
+            clixon_err(OE_UNIX, errno, "strdup");
+            free(xe);
+            goto done;
+        }
+        if (xpath_parse(xpath, &xe->xe_tree) < 0){
+            free(xe->xe_str);
+            free(xe);
+            goto done;
+        }
+        xe->xe_hash = h;
+        xe->xe_hnext = _xpath_cache_hash[h % XPATH_PARSE_CACHE];
+        _xpath_cache_hash[h % XPATH_PARSE_CACHE] = xe;
+        ADDQ(xe, _xpath_cache_lru);
+        _xpath_cache_nr++;
+    }
+    xe->xe_refs++;
+    *xep = xe;
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Release cache entry after use
+ *
+ * @param[in]  xe  Cache entry
+ */
+static void
+xpath_cache_release(xpath_cache_entry *xe)
+{
+    xe->xe_refs--;
+}
+#endif /* XPATH_PARSE_CACHE */
+
+/*! Enable cache of parsed XPath trees
+ *
+ * Cant use option directly since there is no handle in xpath functions.
+ * If disabled, each XPath is parsed on evaluation. Cached trees are kept until exit.
+ * @param[in]  enable  If set, use cache of parsed XPath trees
+ * @retval     0       OK
+ * @see XPATH_PARSE_CACHE
+ * @see CLICON_XPATH_PARSE_CACHE
+ */
+int
+xpath_parse_cache_set(int enable)
+{
+#ifdef XPATH_PARSE_CACHE
+    _xpath_cache_enable = enable;
+#endif
+    return 0;
+}
+
+/*! Get statistics of parsed XPath cache and reset hit counters
+ *
+ * @param[out] nr      Number of cached XPath trees
+ * @param[out] hits    Number of cache hits since last call
+ * @param[out] misses  Number of cache misses (ie parsed XPaths) since last call
+ * @retval     0       OK
+ */
+int
+xpath_parse_cache_stats(int *nr,
+                        int *hits,
+                        int *misses)
+{
+#ifdef XPATH_PARSE_CACHE
+    if (nr)
+        *nr = _xpath_cache_nr;
+    if (hits)
+        *hits = _xpath_cache_hits;
+    if (misses)
+        *misses = _xpath_cache_misses;
+    _xpath_cache_hits = 0;
+    _xpath_cache_misses = 0;
+#endif
+    return 0;
+}
+
+/*! Free all parsed XPath trees in the cache
+ *
+ * Entries in use are not freed
+ */
+void
+xpath_parse_cache_exit(void)
+{
+#ifdef XPATH_PARSE_CACHE
+    xpath_cache_entry *xe;
+    xpath_cache_entry *xn;
+    int                i;
+
+    xe = _xpath_cache_lru;
+    for (i = _xpath_cache_nr; i > 0; i--){
+        xn = NEXTQ(xpath_cache_entry *, xe);
+        if (xe->xe_refs == 0)
+            xpath_cache_entry_free(xe);
+        xe = xn;
+    }
+    if (_xpath_cache_nr == 0 && _xpath_cache_hash){
+        free(_xpath_cache_hash);
+        _xpath_cache_hash = NULL;
+    }
+#endif
+}
+
+/*! Enable or disable profiling of XPath evaluations
+ *
+ * When enabled, call count, evaluation time, nodes visited and list optimizations are
+ * recorded per XPath string.
+ * Cant use option directly since there is no handle in xpath functions
+ * @param[in]  enable  Set to 1 to enable, 0 to disable
+ * @retval     0       OK
+ * @see CLICON_XPATH_PROFILE
+ */
+int
+xpath_profile_set(int enable)
+{
+    _xpath_profile_enable = enable;
+    return 0;
+}
+
+/*! Count nodes visited and list optimizations of an XPath step in ongoing evaluation
+ *
+ * @param[in]  nodes      Number of nodes visited by the step
+ * @param[in]  optimized  Number of list optimizations made by the step
+ * @see xp_eval_step
+ */
+void
+xpath_profile_step(int nodes,
+                   int optimized)
+{
+    if (_xpath_profile_enable){
+        _xpath_profile_nodes += nodes;
+        _xpath_profile_opt += optimized;
+    }
+}
+
+/*! Record one evaluation of an XPath in the profile
+ *
+ * @param[in]  xpath  XPath string
+ * @param[in]  tv0    Start time of evaluation
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+static int
+xpath_profile_record(const char     *xpath,
+                     struct timeval *tv0)
+{
+    int                  retval = -1;
+    xpath_profile_entry *xpe;
+    xpath_profile_entry  xpe0 = {0,};
+    clicon_hash_t        hp;
+    struct timeval       tv;
+    uint64_t             usec;
+
+    gettimeofday(&tv, NULL);
+    timersub(&tv, tv0, &tv);
+    usec = (uint64_t)tv.tv_sec*1000000 + tv.tv_usec;
+    if (_xpath_profile == NULL &&
+        (_xpath_profile = clicon_hash_init()) == NULL)
+        goto done;
+    if ((xpe = clicon_hash_value(_xpath_profile, xpath, NULL)) == NULL){
+        if (_xpath_profile_nr >= XPATH_PROFILE_MAX)
+            goto ok;
+        if ((hp = clicon_hash_add(_xpath_profile, xpath, &xpe0, sizeof(xpe0))) == NULL)
+            goto done;
+        xpe = hp->h_val;
+        _xpath_profile_nr++;
+    }
+    xpe->xpe_calls++;
+    xpe->xpe_usec += usec;
+    if (usec > xpe->xpe_max_usec)
+        xpe->xpe_max_usec = usec;
+    xpe->xpe_nodes += _xpath_profile_nodes;
+    if (_xpath_profile_opt)
+        xpe->xpe_optimized++;
+ ok:
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Print XPath profile as clixon-lib xpath-stats XML state data
+ *
+ * @param[out] cb  CLIgen buf, XML is appended
+ * @retval     0   OK
+ * @retval    -1   Error
+ * @code
+ *   <xpath-stats xmlns="http://clicon.org/lib">
+ *     <xpath><expr>/a/b</expr><calls>2</calls>...</xpath>
+ *   </xpath-stats>
+ * @endcode
+ */
+int
+xpath_profile_print(cbuf *cb)
+{
+    int                  retval = -1;
+    char               **keys = NULL;
+    size_t               klen = 0;
+    xpath_profile_entry *xpe;
+    int                  i;
+
+    cprintf(cb, "<xpath-stats xmlns=\"%s\">", CLIXON_LIB_NS);
+    if (_xpath_profile != NULL){
+        if (clicon_hash_keys(_xpath_profile, &keys, &klen) < 0)
+            goto done;
+        for (i=0; i<klen; i++){
+            if ((xpe = clicon_hash_value(_xpath_profile, keys[i], NULL)) == NULL)
+                continue;
+            cprintf(cb, "<xpath><expr>");
+            if (xml_chardata_cbuf_append(cb, 0, keys[i]) < 0)
+                goto done;
+            cprintf(cb, "</expr>");
+            cprintf(cb, "<calls>%" PRIu64 "</calls>", xpe->xpe_calls);
+            cprintf(cb, "<total-usec>%" PRIu64 "</total-usec>", xpe->xpe_usec);
+            cprintf(cb, "<max-usec>%" PRIu64 "</max-usec>", xpe->xpe_max_usec);
+            cprintf(cb, "<nodes>%" PRIu64 "</nodes>", xpe->xpe_nodes);
+            cprintf(cb, "<optimized>%" PRIu64 "</optimized>", xpe->xpe_optimized);
+            cprintf(cb, "</xpath>");
+        }
+    }
+    cprintf(cb, "</xpath-stats>");
+    retval = 0;
+ done:
+    if (keys)
+        free(keys);
+    return retval;
+}
+
+/*! Free all XPath profile entries
+ */
+void
+xpath_profile_exit(void)
+{
+    if (_xpath_profile){
+        clicon_hash_free(_xpath_profile);
+        _xpath_profile = NULL;
+    }
+    _xpath_profile_nr = 0;
+}
+
+/*! Get last step of XPath if the result of the XPath is the nodeset of that step
+ *
+ * That is, the XPath is a location path whose last step is a child step without
+ * predicates, eg /a/b or a[k='x']/b, but not count(a), a/b[2] or a//b.
+ * Then evaluation of the last step may stop when enough nodes are found.
+ * @param[in]  xs    Parsed XPath tree
+ * @retval     xs    Last step
+ * @retval     NULL  Not applicable
+ */
+static xpath_tree *
+xpath_last_step(xpath_tree *xs)
+{
+    xpath_tree *xp;
+
+    /* Skip single-child expression nodes down to location path */
+    while (xs && xs->xs_type != XP_LOCPATH){
+        if (xs->xs_c1 != NULL)
+            return NULL;
+        switch (xs->xs_type){
+        case XP_EXP:
+        case XP_AND:
+        case XP_RELEX:
+        case XP_ADD:
+        case XP_UNION:
+        case XP_PATHEXPR:
+            xs = xs->xs_c0;
+            break;
+        default:
+            return NULL;
+        }
+    }
+    if (xs == NULL || (xs = xs->xs_c0) == NULL)
+        return NULL;
+    if (xs->xs_type == XP_ABSPATH){
+        if (xs->xs_int != A_ROOT || (xs = xs->xs_c0) == NULL)
+            return NULL;
+    }
+    if (xs->xs_type != XP_RELLOCPATH || xs->xs_int != A_NAN)
+        return NULL;
+    if (xs->xs_c1)
+        xs = xs->xs_c1;
+    else
+        xs = xs->xs_c0;
+    if (xs == NULL || xs->xs_type != XP_STEP || xs->xs_int != A_CHILD)
+        return NULL;
+    if ((xp = xs->xs_c1) != NULL && (xp->xs_c0 != NULL || xp->xs_c1 != NULL))
+        return NULL;
+    return xs;
+}
+
+/*! Eval parsed XPath, where only the first limit nodes of a nodeset result are needed
+ *
+ * @param[in]  xcur   XML-tree where to search
+ * @param[in]  nsc    External XML namespace context, or NULL
+ * @param[in]  xptree Parsed XPath tree
+ * @param[in]  localonly Skip prefix and namespace tests
+ * @param[in]  limit  If >0, nodeset result may be truncated to this length
+ * @param[out] xrp    Return XPath context
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+static int
+xpath_tree_ctx_limit(cxobj      *xcur,
+                     cvec       *nsc,
+                     xpath_tree *xptree,
+                     int         localonly,
+                     int         limit,
+                     xp_ctx    **xrp)
+{
+    int     retval = -1;
+    xp_ctx  xc = {0,};
+
+    xc.xc_type = XT_NODESET;
+    xc.xc_node = xcur;
+    xc.xc_initial = xcur;
+    if (limit > 0 && (xc.xc_last = xpath_last_step(xptree)) != NULL)
+        xc.xc_limit = limit;
+    if (cxvec_append(xcur, &xc.xc_nodeset, &xc.xc_size) < 0)
+        goto done;
+    if (xp_eval(&xc, xptree, nsc, localonly, xrp) < 0)
+        goto done;
+    retval = 0;
+ done:
+    if (xc.xc_nodeset)
+        free(xc.xc_nodeset);
+    return retval;
+}
+
+/*! Parse and eval XPath, where only the first limit nodes of a nodeset result are needed
+ *
+ * @param[in]  xcur   XML-tree where to search
+ * @param[in]  nsc    External XML namespace context, or NULL
+ * @param[in]  xpath  String with XPath 1.0 syntax
+ * @param[in]  localonly Skip prefix and namespace tests
+ * @param[in]  limit  If >0, nodeset result may be truncated to this length
+ * @param[out] xrp    Return XPath context
+ * @retval     0      OK
+ * @retval    -1      Error
+ * @see xpath_vec_ctx
+ */
+static int
+xpath_vec_ctx_limit(cxobj      *xcur,
+                    cvec       *nsc,
+                    const char *xpath,
+                    int         localonly,
+                    int         limit,
+                    xp_ctx    **xrp)
+{
+    int                retval = -1;
+    xpath_tree        *xptree = NULL;
+#ifdef XPATH_PARSE_CACHE
+    xpath_cache_entry *xe = NULL;
+#endif
+    int                profile;
+    uint64_t           nodes0 = 0;
+    uint64_t           opt0 = 0;
+    struct timeval     tv0;
+    clixon_trace_t     tr;
+
+    clixon_debug(CLIXON_DBG_XPATH | CLIXON_DBG_DETAIL, "%s", xpath);
+    tr = clixon_trace_begin(CLIXON_DBG_XPATH);
+    /* Save counters of enclosing evaluation, if any */
+    if ((profile = _xpath_profile_enable) != 0){
+        nodes0 = _xpath_profile_nodes;
+        opt0 = _xpath_profile_opt;
+        _xpath_profile_nodes = 0;
+        _xpath_profile_opt = 0;
+        gettimeofday(&tv0, NULL);
+    }
+#ifdef XPATH_PARSE_CACHE
+    if (_xpath_cache_enable){
+        if (xpath_cache_get(xpath, &xe) < 0)
+            goto done;
+        xptree = xe->xe_tree;
+    }
+    else
+#endif
+    if (xpath_parse(xpath, &xptree) < 0)
+        goto done;
+    if (xpath_tree_ctx_limit(xcur, nsc, xptree, localonly, limit, xrp) < 0)
+        goto done;
+    if (profile && xpath_profile_record(xpath, &tv0) < 0)
+        goto done;
+    retval = 0;
+ done:
+    if (profile){
+        _xpath_profile_nodes += nodes0;
+        _xpath_profile_opt += opt0;
+    }
+#ifdef XPATH_PARSE_CACHE
+    if (xe)
+        xpath_cache_release(xe);
+    else
+#endif
+    if (xptree)
+        xpath_tree_free(xptree);
+    clixon_trace_end(tr, CLIXON_DBG_XPATH, "xpath", xpath);
+    return retval;
+}
+
 /*! Given XML tree and XPath, parse XPath, eval it and return XPath context,
  *
  * This is a raw form of XPath where you can do type conversion of the return
@@ -635,29 +1179,29 @@ xpath_vec_ctx(cxobj      *xcur,
               int         localonly,
               xp_ctx    **xrp)
 {
-    int         retval = -1;
-    xpath_tree *xptree = NULL;
-    xp_ctx      xc = {0,};
+    return xpath_vec_ctx_limit(xcur, nsc, xpath, localonly, 0, xrp);
+}
 
-    clixon_debug(CLIXON_DBG_XPATH | CLIXON_DBG_DETAIL, "%s", xpath);
-    if (xpath_parse(xpath, &xptree) < 0)
-        goto done;
-    xc.xc_type = XT_NODESET;
-    xc.xc_node = xcur;
-    xc.xc_initial = xcur;
-    if (cxvec_append(xcur, &xc.xc_nodeset, &xc.xc_size) < 0)
-        goto done;
-    if (xp_eval(&xc, xptree, nsc, localonly, xrp) < 0)
-        goto done;
-    retval = 0;
- done:
-    if (xc.xc_nodeset){
-        free(xc.xc_nodeset);
-        xc.xc_nodeset = NULL;
-    }
-    if (xptree)
-        xpath_tree_free(xptree);
-    return retval;
+/*! Given XML tree and parsed XPath, eval it and return XPath context
+ *
+ * Same as xpath_vec_ctx but without parsing the XPath, eg for an XPath evaluated many times
+ * @param[in]  xcur   XML-tree where to search
+ * @param[in]  nsc    External XML namespace context, or NULL
+ * @param[in]  xptree Parsed XPath tree, see xpath_parse
+ * @param[in]  localonly Skip prefix and namespace tests
+ * @param[out] xrp    Return XPath context
+ * @retval     0      OK
+ * @retval    -1      Error
+ * @see xpath_vec_ctx
+ */
+int
+xpath_tree_ctx(cxobj      *xcur,
+               cvec       *nsc,
+               xpath_tree *xptree,
+               int         localonly,
+               xp_ctx    **xrp)
+{
+    return xpath_tree_ctx_limit(xcur, nsc, xptree, localonly, 0, xrp);
 }
 
 /*! XPath nodeset function where only the first matching entry is returned
@@ -709,7 +1253,7 @@ xpath_first(cxobj      *xcur,
         goto done;
     }
     va_end(ap);
-    if (xpath_vec_ctx(xcur, nsc, xpath, 0, &xr) < 0)
+    if (xpath_vec_ctx_limit(xcur, nsc, xpath, 0, 1, &xr) < 0)
         goto done;
     if (xr && xr->xc_type == XT_NODESET && xr->xc_size)
         cx = xr->xc_nodeset[0];
@@ -721,6 +1265,35 @@ xpath_first(cxobj      *xcur,
     return cx;
 }
 
+/*! XPath nodeset function on a parsed XPath where only the first matching entry is returned
+ *
+ * Same as xpath_first but without formatting and parsing the XPath, eg for an XPath
+ * evaluated many times
+ * @param[in]  xcur      XML tree where to search
+ * @param[in]  nsc       External XML namespace context, or NULL
+ * @param[in]  xptree    Parsed XPath tree, see xpath_parse
+ * @retval     xml-tree  XML tree of first match
+ * @retval     NULL      Error or not found
+ * @see xpath_first
+ */
+cxobj *
+xpath_first_tree(cxobj      *xcur,
+                 cvec       *nsc,
+                 xpath_tree *xptree)
+{
+    cxobj     *cx = NULL;
+    xp_ctx    *xr = NULL;
+
+    if (xpath_tree_ctx_limit(xcur, nsc, xptree, 0, 1, &xr) < 0)
+        goto done;
+    if (xr && xr->xc_type == XT_NODESET && xr->xc_size)
+        cx = xr->xc_nodeset[0];
+ done:
+    if (xr)
+        ctx_free(xr);
+    return cx;
+}
+
 /*! XPath nodeset function where prefixes are skipped, only first matching is returned
  *
  * Reason for skipping prefix/namespace check may be with incomplete tree, for example.
@@ -768,7 +1341,7 @@ xpath_first_localonly(cxobj      *xcur,
         goto done;
     }
     va_end(ap);
-    if (xpath_vec_ctx(xcur, NULL, xpath, 1, &xr) < 0)
+    if (xpath_vec_ctx_limit(xcur, NULL, xpath, 1, 1, &xr) < 0)
         goto done;
     if (xr && xr->xc_type == XT_NODESET && xr->xc_size)
         cx = xr->xc_nodeset[0];
@@ -969,7 +1542,7 @@ xpath_vec_bool(cxobj      *xcur,
         goto done;
     }
     va_end(ap);
-    if (xpath_vec_ctx(xcur, nsc, xpath, 0, &xr) < 0)
+    if (xpath_vec_ctx_limit(xcur, nsc, xpath, 0, 1, &xr) < 0)
         goto done;
     if (xr)
         retval = ctx2boolean(xr);
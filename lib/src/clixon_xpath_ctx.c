@@ -87,6 +87,31 @@ ctx_free(xp_ctx *xc)
     return 0;
 }
 
+/*! Duplicate xpath context but not its nodeset or string
+ *
+ * For use when the nodeset is replaced anyway, to avoid copying it
+ * @param[in]  xc0  XPath context
+ * @retval     xc   New XPath context with empty nodeset, free with ctx_free
+ * @retval     NULL Error
+ * @see ctx_dup
+ */
+xp_ctx *
+ctx_dup_empty(xp_ctx *xc0)
+{
+    xp_ctx *xc = NULL;
+
+    if ((xc = malloc(sizeof(*xc))) == NULL){
+        clixon_err(OE_UNIX, errno, "malloc");
+        goto done;
+    }
+    *xc = *xc0;
+    xc->xc_nodeset = NULL;
+    xc->xc_size = 0;
+    xc->xc_string = NULL;
+ done:
+    return xc;
+}
+
 /*! Duplicate xpath context */
 xp_ctx *
 ctx_dup(xp_ctx *xc0)
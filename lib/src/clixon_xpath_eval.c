@@ -67,7 +67,9 @@
 #include <stdint.h>
 #include <syslog.h>
 #include <fcntl.h>
+#include <signal.h>
 #include <math.h> /* NaN */
+#include <sys/wait.h>
 
 /* cligen */
 #include <cligen/cligen.h>
@@ -116,7 +118,7 @@ const map_str2int xpopmap[] = {
  * XML x    -> prefix1 + name1
  * XPATH xs -> prefix2 + name2
  * Unless name2=*, if name1 != name2 -> fail
- * Lookup(prefix1, XML) -> ns1
+ * Lookup(prefix1, XML) -> ns1, or namespace of yang module if x is bound to a data node
  * Lookup(prefix2, NSC) -> ns2
  * if ns1 = NULL -> fail
  * if ns2 = NULL -> fail (see  XPATH_NS_ACCEPT_UNRESOLVED)
@@ -134,13 +136,14 @@ nodetest_eval_namespace(cxobj      *x,
                         xpath_tree *xs,
                         cvec       *nsc)
 {
-    int   retval = -1;
-    char *name1;
-    char *prefix1;
-    char *prefix2;
-    char *name2;
-    char *ns1 = NULL; /* xml namespace */
-    char *ns2 = NULL; /* xpath namespace */
+    int        retval = -1;
+    char      *name1;
+    char      *prefix1;
+    char      *prefix2;
+    char      *name2;
+    char      *ns1 = NULL; /* xml namespace */
+    char      *ns2 = NULL; /* xpath namespace */
+    yang_stmt *y;
 
     /* Namespaces is s0, name is s1 */
     if (strcmp(xs->xs_s1, "*")==0)
@@ -157,8 +160,12 @@ nodetest_eval_namespace(cxobj      *x,
         if (strcmp(name1, name2) != 0)
             goto fail;
     }
-    /* get namespace of xml tree */
-    if (xml2ns(x, prefix1, &ns1) < 0)
+    /* Get namespace of xml node. If bound to a yang data node, it is the namespace of the
+     * yang module (considering augment), which avoids looking up xmlns attributes and
+     * namespace caches in XML ancestors */
+    if ((y = xml_spec(x)) != NULL && yang_datanode(y))
+        ns1 = yang_find_mynamespace(y);
+    if (ns1 == NULL && xml2ns(x, prefix1, &ns1) < 0)
         goto done;
     if (ns1 == NULL)
         goto fail;
@@ -170,7 +177,7 @@ nodetest_eval_namespace(cxobj      *x,
         goto fail;
 #endif
     }
-    else if (strcmp(ns1, ns2) != 0)
+    else if (ns1 != ns2 && strcmp(ns1, ns2) != 0)
         goto fail;
  ok:
     retval = 1;
@@ -275,7 +282,7 @@ nodetest_eval_localonly(cxobj      *x,
  * - node() is true for any node of any type whatsoever.
  * - text() is true for any text node.
  */
-static int
+int
 nodetest_eval(cxobj      *x,
               xpath_tree *xs,
               cvec       *nsc,
@@ -332,9 +339,10 @@ nodetest_recursive(cxobj      *xn,
     cxobj  *xsub;
     cxobj **vec = *vec0;
     size_t  veclen = *vec0len;
+    int     inext;
 
-    xsub = NULL;
-    while ((xsub = xml_child_each(xn, xsub, node_type)) != NULL) {
+    inext = 0;
+    while ((xsub = xml_child_iter(xn, &inext, node_type)) != NULL) {
         if (nodetest_eval(xsub, nodetest, nsc, localonly) == 1){
             clixon_debug(CLIXON_DBG_XPATH | CLIXON_DBG_DETAIL, "%x %x", flags, xml_flag(xsub, flags));
             if (flags==0x0 || xml_flag(xsub, flags))
@@ -385,10 +393,20 @@ xp_eval_step(xp_ctx     *xc0,
     xpath_tree *nodetest = xs->xs_c0;
     xp_ctx     *xc = NULL;
     int         ret;
+    int         limit = 0;
+    int         visits = 0;    /* Nodes visited, for profiling */
+    int         optimized = 0; /* List optimizations made, for profiling */
 
-    /* Create new xc */
-    if ((xc = ctx_dup(xc0)) == NULL)
+    /* Create new xc, the child and descendant axes replace the nodeset so dont copy it */
+    if (xs->xs_int == A_CHILD || xs->xs_int == A_DESCENDANT)
+        xc = ctx_dup_empty(xc0);
+    else
+        xc = ctx_dup(xc0);
+    if (xc == NULL)
         goto done;
+    /* Caller only needs the first nodes of the result, see xpath_vec_ctx */
+    if (xs == xc0->xc_last)
+        limit = xc0->xc_limit;
     switch (xs->xs_int){
     case A_ANCESTOR:
         break;
@@ -398,39 +416,45 @@ xp_eval_step(xp_ctx     *xc0,
         break;
     case A_CHILD:
         if (xc->xc_descendant){
-            for (i=0; i<xc->xc_size; i++){
-                xv = xc->xc_nodeset[i];
+            for (i=0; i<xc0->xc_size; i++){
+                xv = xc0->xc_nodeset[i];
                 if (nodetest_recursive(xv, nodetest, CX_ELMNT, 0x0, nsc, localonly, &vec, &veclen) < 0)
                     goto done;
             }
             xc->xc_descendant = 0;
+            visits += veclen;
         }
         else{
             // XXX The handling of vec/vec0 is too complex
-            for (i=0; i<xc->xc_size; i++){
+            for (i=0; i<xc0->xc_size && (limit == 0 || veclen < limit); i++){
                 cxobj **vec0 = NULL;
                 int     veclen0 = 0;
                 int     j;
+                int     inext = 0;
 
-                xv = xc->xc_nodeset[i];
-                x = NULL;
-                if ((ret = xpath_optimize_check(xs, xv, &vec0, &veclen0)) < 0)
+                xv = xc0->xc_nodeset[i];
+                if ((ret = xpath_optimize_check(xs, xv, xc->xc_initial, nsc, localonly, &vec0, &veclen0)) < 0)
                     goto done;
                 if (ret == 1){
-                    for (j=0; j<veclen0; j++){
-                        if (cxvec_append(vec0[0], &vec, &veclen) < 0)
+                    optimized++;
+                    visits += veclen0;
+                    for (j=0; j<veclen0 && (limit == 0 || veclen < limit); j++){
+                        if (cxvec_append(vec0[j], &vec, &veclen) < 0)
                             goto done;
                     }
                     if (vec0)
                         free(vec0);
                 }
                 else if (ret == 0){/* regular code, no optimization made */
-                    while ((x = xml_child_each(xv, x, CX_ELMNT)) != NULL) {
+                    while ((x = xml_child_iter(xv, &inext, CX_ELMNT)) != NULL) {
+                        visits++;
                         /* xs->xs_c0 is nodetest */
                         if (nodetest == NULL ||
                             nodetest_eval(x, nodetest, nsc, localonly) == 1){
                             if (cxvec_append(x, &vec, &veclen) < 0)
                                 goto done;
+                            if (limit && veclen >= limit)
+                                break;
                         }
                     }
                 }
@@ -446,6 +470,7 @@ xp_eval_step(xp_ctx     *xc0,
             if (nodetest_recursive(xv, xs->xs_c0, CX_ELMNT, 0x0, nsc, localonly, &vec, &veclen) < 0)
                 goto done;
         }
+        visits += veclen;
         for (i=0; i<veclen; i++){
             x = vec[i];
             if (cxvec_append(x, &xc->xc_nodeset, &xc->xc_size) < 0)
@@ -457,11 +482,12 @@ xp_eval_step(xp_ctx     *xc0,
         }
         break;
     case A_DESCENDANT:
-        for (i=0; i<xc->xc_size; i++){
-            xv = xc->xc_nodeset[i];
+        for (i=0; i<xc0->xc_size; i++){
+            xv = xc0->xc_nodeset[i];
             if (nodetest_recursive(xv, xs->xs_c0, CX_ELMNT, 0x0, nsc, localonly, &vec, &veclen) < 0)
                 goto done;
         }
+        visits += veclen;
         ctx_nodeset_replace(xc, vec, veclen);
         break;
     case A_FOLLOWING:
@@ -471,6 +497,7 @@ xp_eval_step(xp_ctx     *xc0,
     case A_NAMESPACE: /* principal node type is namespace */
         break;
     case A_PARENT:
+        visits += xc->xc_size;
         veclen = xc->xc_size;
         vec = xc->xc_nodeset;
         xc->xc_size = 0;
@@ -502,6 +529,7 @@ xp_eval_step(xp_ctx     *xc0,
         goto done;
         break;
     }
+    xpath_profile_step(visits, optimized);
     if (xs->xs_c1){
         if (xp_eval(xc, xs->xs_c1, nsc, localonly, xrp) < 0)
             goto done;
@@ -521,6 +549,266 @@ xp_eval_step(xp_ctx     *xc0,
     return retval;
 }
 
+#ifdef XPATH_PARALLEL_MIN
+/* Number of processes evaluating a predicate over a large node-set, 0 or 1 is sequential */
+static int _xpath_parallel = 0;
+#endif
+
+/*! Set number of processes evaluating XPath predicates over large node-sets
+ *
+ * Cant use option directly since there is no handle in xpath functions
+ * @param[in]  workers  Number of processes including the calling, 0 or 1 is sequential
+ * @retval     0        OK
+ * @see XPATH_PARALLEL_MIN
+ * @see CLICON_XPATH_PARALLEL
+ */
+int
+xpath_parallel_set(int workers)
+{
+#ifdef XPATH_PARALLEL_MIN
+    _xpath_parallel = workers;
+#endif
+    return 0;
+}
+
+/*! Evaluate a predicate expression with one node of a node-set as context node
+ *
+ * @param[in]  xc      Incoming context
+ * @param[in]  xs      XPath node tree of predicate expression
+ * @param[in]  nsc     XML Namespace context
+ * @param[in]  localonly Skip prefix and namespace tests (non-standard)
+ * @param[in]  x       Context node
+ * @param[in]  i       Position of x in node-set
+ * @param[out] match   1 if x is included in the resulting node-set, 0 if not
+ * @retval     0       OK
+ * @retval    -1       Error
+ */
+static int
+xp_eval_predicate_node(xp_ctx     *xc,
+                       xpath_tree *xs,
+                       cvec       *nsc,
+                       int         localonly,
+                       cxobj      *x,
+                       int         i,
+                       int        *match)
+{
+    int     retval = -1;
+    xp_ctx *xcc = NULL;
+    xp_ctx *xrc = NULL;
+
+    /* Create new context */
+    if ((xcc = malloc(sizeof(*xcc))) == NULL){
+        clixon_err(OE_XML, errno, "malloc");
+        goto done;
+    }
+    memset(xcc, 0, sizeof(*xcc));
+    xcc->xc_type = XT_NODESET;
+    xcc->xc_initial = xc->xc_initial;
+    xcc->xc_node = x;
+    xcc->xc_position = i;
+    /* For each node in the node-set to be filtered, the PredicateExpr is
+     * evaluated with that node as the context node */
+    if (cxvec_append(x, &xcc->xc_nodeset, &xcc->xc_size) < 0)
+        goto done;
+    if (xp_eval(xcc, xs, nsc, localonly, &xrc) < 0)
+        goto done;
+    if (xrc->xc_type == XT_NUMBER){
+        /* If the result is a number, the result will be converted to true
+           if the number is equal to the context position */
+        *match = ((int)xrc->xc_number == i);
+    }
+    else {
+        /* if PredicateExpr evaluates to true for that node, the node is
+           included in the new node-set */
+        *match = ctx2boolean(xrc);
+    }
+    retval = 0;
+ done:
+    if (xcc)
+        ctx_free(xcc);
+    if (xrc)
+        ctx_free(xrc);
+    return retval;
+}
+
+#ifdef XPATH_PARALLEL_MIN
+/*! Evaluate predicate over a range of a node-set
+ *
+ * @param[in]  xc      Incoming context
+ * @param[in]  xr0     Node-set to filter
+ * @param[in]  xs      XPath node tree of predicate expression
+ * @param[in]  nsc     XML Namespace context
+ * @param[in]  localonly Skip prefix and namespace tests (non-standard)
+ * @param[in]  from    First position of range
+ * @param[in]  to      Position after range
+ * @param[out] matchv  Vector of match results indexed by position
+ * @retval     0       OK
+ * @retval    -1       Error
+ */
+static int
+xp_eval_predicate_range(xp_ctx     *xc,
+                        xp_ctx     *xr0,
+                        xpath_tree *xs,
+                        cvec       *nsc,
+                        int         localonly,
+                        int         from,
+                        int         to,
+                        uint8_t    *matchv)
+{
+    int i;
+    int match;
+
+    for (i=from; i<to; i++){
+        if (xp_eval_predicate_node(xc, xs, nsc, localonly, xr0->xc_nodeset[i], i, &match) < 0)
+            return -1;
+        matchv[i] = match;
+    }
+    return 0;
+}
+
+/*! Evaluate predicate over a large node-set in parallel worker processes
+ *
+ * The node-set is split into one shard per process. The first shard is evaluated by the
+ * calling process, the others by forked workers, which evaluate on a copy-on-write image
+ * of the XML tree and send one match byte per node back on a pipe.
+ * Shards of workers that can not be forked or that fail are evaluated by the calling
+ * process. Side-effects of evaluation in workers, eg caches, are lost.
+ * @param[in]  xc      Incoming context
+ * @param[in]  xr0     Node-set to filter
+ * @param[in]  xs      XPath node tree of predicate expression
+ * @param[in]  nsc     XML Namespace context
+ * @param[in]  localonly Skip prefix and namespace tests (non-standard)
+ * @param[out] xr1     Resulting node-set in document order
+ * @retval     1       OK, xr1 is set
+ * @retval     0       Not applicable, evaluate sequentially
+ * @retval    -1       Error
+ * @see XPATH_PARALLEL_MIN
+ */
+static int
+xp_eval_predicate_parallel(xp_ctx     *xc,
+                           xp_ctx     *xr0,
+                           xpath_tree *xs,
+                           cvec       *nsc,
+                           int         localonly,
+                           xp_ctx     *xr1)
+{
+    int      retval = -1;
+    int      nw;
+    int      shard;
+    int      w;
+    int      i;
+    int      from;
+    int      to;
+    int      fd[2];
+    int     *fdv = NULL;
+    pid_t   *pidv = NULL;
+    pid_t    pid;
+    uint8_t *matchv = NULL;
+    ssize_t  len;
+    size_t   n;
+    int      status;
+    int      ok;
+
+    if ((nw = _xpath_parallel) < 2 || xr0->xc_size < XPATH_PARALLEL_MIN)
+        return 0;
+    shard = (xr0->xc_size + nw - 1) / nw;
+    if ((matchv = calloc(xr0->xc_size, sizeof(*matchv))) == NULL ||
+        (fdv = calloc(nw, sizeof(*fdv))) == NULL ||
+        (pidv = calloc(nw, sizeof(*pidv))) == NULL){
+        clixon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    for (w=0; w<nw; w++)
+        fdv[w] = -1;
+    for (w=1; w<nw; w++){
+        from = w*shard;
+        to = from + shard < xr0->xc_size ? from + shard : xr0->xc_size;
+        if (from >= to)
+            break;
+        if (pipe(fd) < 0)
+            break;
+        if ((pid = fork()) < 0){
+            close(fd[0]);
+            close(fd[1]);
+            break;
+        }
+        if (pid == 0){ /* Worker */
+            close(fd[0]);
+            _xpath_parallel = 0;
+            if (xp_eval_predicate_range(xc, xr0, xs, nsc, localonly, from, to, matchv) < 0)
+                _exit(1);
+            n = 0;
+            while (n < to-from){
+                if ((len = write(fd[1], matchv+from+n, to-from-n)) < 0){
+                    if (errno == EINTR)
+                        continue;
+                    _exit(1);
+                }
+                n += len;
+            }
+            close(fd[1]);
+            _exit(0); /* Dont exit() here, parent state must not be flushed */
+        }
+        close(fd[1]);
+        fdv[w] = fd[0];
+        pidv[w] = pid;
+    }
+    /* First shard and shards without workers are evaluated here */
+    if (xp_eval_predicate_range(xc, xr0, xs, nsc, localonly, 0, shard, matchv) < 0)
+        goto done;
+    if (w < nw && xp_eval_predicate_range(xc, xr0, xs, nsc, localonly, w*shard, xr0->xc_size, matchv) < 0)
+        goto done;
+    for (w=1; w<nw; w++){
+        if (pidv[w] == 0)
+            continue;
+        from = w*shard;
+        to = from + shard < xr0->xc_size ? from + shard : xr0->xc_size;
+        n = 0;
+        while (n < to-from){
+            if ((len = read(fdv[w], matchv+from+n, to-from-n)) < 0){
+                if (errno == EINTR)
+                    continue;
+                break;
+            }
+            if (len == 0) /* Worker exited early */
+                break;
+            n += len;
+        }
+        close(fdv[w]);
+        fdv[w] = -1;
+        ok = (waitpid(pidv[w], &status, 0) == pidv[w] &&
+              WIFEXITED(status) && WEXITSTATUS(status) == 0);
+        pidv[w] = 0;
+        if (n < to-from || !ok){
+            clixon_debug(CLIXON_DBG_XPATH, "worker %d failed, evaluating shard sequentially", w);
+            if (xp_eval_predicate_range(xc, xr0, xs, nsc, localonly, from, to, matchv) < 0)
+                goto done;
+        }
+    }
+    for (i=0; i<xr0->xc_size; i++)
+        if (matchv[i] &&
+            cxvec_append(xr0->xc_nodeset[i], &xr1->xc_nodeset, &xr1->xc_size) < 0)
+            goto done;
+    retval = 1;
+ done:
+    for (w=1; pidv && w<nw; w++){
+        if (fdv[w] != -1)
+            close(fdv[w]);
+        if (pidv[w] != 0){
+            kill(pidv[w], SIGKILL);
+            waitpid(pidv[w], &status, 0);
+        }
+    }
+    if (pidv)
+        free(pidv);
+    if (fdv)
+        free(fdv);
+    if (matchv)
+        free(matchv);
+    return retval;
+}
+#endif /* XPATH_PARALLEL_MIN */
+
 /*! Evaluate xpath predicates rule
  *
  * pred -> pred expr
@@ -557,10 +845,10 @@ xp_eval_predicate(xp_ctx     *xc,
     int      retval = -1;
     xp_ctx  *xr0 = NULL;
     xp_ctx  *xr1 = NULL;
-    xp_ctx  *xrc = NULL;
     int      i;
     cxobj   *x;
-    xp_ctx  *xcc = NULL;
+    int      match;
+    int      ret;
 
     if (xs->xs_c0 != NULL){ /* eval previous predicates */
         if (xp_eval(xc, xs->xs_c0, nsc, localonly, &xr0) < 0)
@@ -583,42 +871,22 @@ xp_eval_predicate(xp_ctx     *xc,
         xr1->xc_type = XT_NODESET;
         xr1->xc_node = xc->xc_node;
         xr1->xc_initial = xc->xc_initial;
-        for (i=0; i<xr0->xc_size; i++){
+        /* Eg [contains(a,'s')] is evaluated for the whole node-set at once */
+        if ((ret = xp_function_nodeset_filter(xr0, xs->xs_c1, nsc, localonly, xr1)) < 0)
+            goto done;
+#ifdef XPATH_PARALLEL_MIN
+        /* Large node-sets may be split over several processes */
+        if (ret == 0 &&
+            (ret = xp_eval_predicate_parallel(xc, xr0, xs->xs_c1, nsc, localonly, xr1)) < 0)
+            goto done;
+#endif
+        for (i=0; ret == 0 && i<xr0->xc_size; i++){
             x = xr0->xc_nodeset[i];
-            /* Create new context */
-            if ((xcc = malloc(sizeof(*xcc))) == NULL){
-                clixon_err(OE_XML, errno, "malloc");
+            if (xp_eval_predicate_node(xc, xs->xs_c1, nsc, localonly, x, i, &match) < 0)
                 goto done;
-            }
-            memset(xcc, 0, sizeof(*xcc));
-            xcc->xc_type = XT_NODESET;
-            xcc->xc_initial = xc->xc_initial;
-            xcc->xc_node = x;
-            xcc->xc_position = i;
-            /* For each node in the node-set to be filtered, the PredicateExpr is
-             * evaluated with that node as the context node */
-            if (cxvec_append(x, &xcc->xc_nodeset, &xcc->xc_size) < 0)
-                goto done;
-            if (xp_eval(xcc, xs->xs_c1, nsc, localonly, &xrc) < 0)
-                goto done;
-            ctx_free(xcc);
-            xcc = NULL;
-            if (xrc->xc_type == XT_NUMBER){
-                /* If the result is a number, the result will be converted to true
-                   if the number is equal to the context position */
-                if ((int)xrc->xc_number == i)
-                    if (cxvec_append(x, &xr1->xc_nodeset, &xr1->xc_size) < 0)
-                        goto done;
-            }
-            else {
-                /* if PredicateExpr evaluates to true for that node, the node is
-                   included in the new node-set */
-                if (ctx2boolean(xrc))
-                    if (cxvec_append(x, &xr1->xc_nodeset, &xr1->xc_size) < 0)
-                        goto done;
-            }
-            if (xrc)
-                ctx_free(xrc);
+            if (match)
+                if (cxvec_append(x, &xr1->xc_nodeset, &xr1->xc_size) < 0)
+                    goto done;
         }
     }
     if (xr0 == NULL && xr1 == NULL){
@@ -635,8 +903,6 @@ xp_eval_predicate(xp_ctx     *xc,
     }
     retval = 0;
  done:
-    if (xcc)
-        ctx_free(xcc);
     if (xr0)
         ctx_free(xr0);
     if (xr1)
@@ -763,77 +1029,6 @@ xp_numop(xp_ctx    *xc1,
     return retval;
 }
 
-/*! Get xml body value as cligen variable
- *
- * @param[in]  x   XML node (body and leaf/leaf-list)
- * @param[out] cvp Pointer to cligen variable containing value of x body
- * @retval     0   OK, cvp contains cv or NULL
- * @retval    -1   Error
- * @note only applicable if x is body and has yang-spec and is leaf or leaf-list
- * Move to clixon_xml.c?
- * As a side-effect sets the cache.
- * Clear cache with xml_cv_set(x, NULL)
- * @see xml_cv_cache.c duplicated function
- */
-static int
-xml_cv_cache(cxobj   *x,
-             cg_var **cvp)
-{
-    int          retval = -1;
-    cg_var      *cv = NULL;
-    yang_stmt   *y;
-    yang_stmt   *yrestype;
-    enum cv_type cvtype;
-    char        *reason=NULL;
-    int          options = 0;
-    uint8_t      fraction = 0;
-    char        *body;
-    int          ret;
-
-    if ((body = xml_body(x)) == NULL)
-        body="";
-    if ((cv = xml_cv(x)) != NULL)
-        goto ok;
-    if ((y = xml_spec(x)) == NULL){
-        clixon_err(OE_XML, EFAULT, "Yang binding missing for xml symbol %s, body:%s", xml_name(x), body);
-        goto done;
-    }
-    if (yang_type_get(y, NULL, &yrestype, &options, NULL, NULL, NULL, &fraction) < 0)
-        goto done;
-    yang2cv_type(yang_argument_get(yrestype), &cvtype);
-    if (cvtype==CGV_ERR){
-        clixon_err(OE_YANG, errno, "yang->cligen type %s mapping failed",
-                   yang_argument_get(yrestype));
-        goto done;
-    }
-    if ((cv = cv_new(cvtype)) == NULL){
-        clixon_err(OE_YANG, errno, "cv_new");
-        goto done;
-    }
-    if (cvtype == CGV_DEC64)
-        cv_dec64_n_set(cv, fraction);
-    if ((ret = cv_parse1(body, cv, &reason)) < 0){
-        clixon_err(OE_YANG, errno, "cv_parse1");
-        goto done;
-    }
-    if (ret == 0){
-        clixon_err(OE_YANG, EINVAL, "cv parse error: %s\n", reason);
-        goto done;
-    }
-    if (xml_cv_set(x, cv) < 0)
-        goto done;
- ok:
-    *cvp = cv;
-    cv = NULL;
-    retval = 0;
- done:
-    if (reason)
-        free(reason);
-    if (cv)
-        cv_free(cv);
-    return retval;
-}
-
 /*! Given two XPath contexts, eval relational operations: <>=
  *
  * A RelationalExpr is evaluated by comparing the objects that result from 
@@ -175,6 +175,80 @@ xp_function_current(xp_ctx            *xc0,
     return retval;
 }
 
+static struct xpath_tree *xp_unwrap(struct xpath_tree *xs);
+
+/* Regexp engine of XPath re-match, handle is not available */
+#ifdef HAVE_LIBXML2
+#define XP_REGEXP_MODE REGEXP_LIBXML2
+#else
+#define XP_REGEXP_MODE REGEXP_POSIX
+#endif
+
+/*! Compile an XSD regular expression for re-match
+ *
+ * @param[in]  regexp  XSD regular expression
+ * @param[in]  shared  Regexp is a literal: use shared compiled regexp, do not free
+ * @param[out] re      Compiled regex, free with xp_regex_free if not shared
+ * @retval     1       OK
+ * @retval     0       Compile fail
+ * @retval    -1       Error
+ * @note Uses xml2 regexp if libxml2 enabled, otherwise posix
+ */
+static int
+xp_regex_compile(char  *regexp,
+                 int    shared,
+                 void **re)
+{
+    int   retval = -1;
+    char *posix = NULL;
+
+    if (shared)
+        return regex_cache_compile(XP_REGEXP_MODE, regexp, re);
+#ifdef HAVE_LIBXML2
+    if ((retval = cligen_regex_libxml2_compile(regexp, re)) < 0)
+        goto done;
+#else
+    if (regexp_xsd2posix(regexp, &posix) < 0)
+        goto done;
+    if ((retval = cligen_regex_posix_compile(posix, re)) < 0)
+        goto done;
+#endif
+ done:
+    if (posix)
+        free(posix);
+    return retval;
+}
+
+/*! Match a string against a regex compiled with xp_regex_compile
+ *
+ * @param[in]  re   Compiled regex
+ * @param[in]  s    String
+ * @retval     1    Match
+ * @retval     0    No match
+ * @retval    -1    Error
+ */
+static int
+xp_regex_exec(void *re,
+              char *s)
+{
+    return regex_cache_exec(XP_REGEXP_MODE, re, s);
+}
+
+/*! Free a regex compiled with xp_regex_compile and not shared
+ *
+ * @param[in]  re   Compiled regex
+ */
+static void
+xp_regex_free(void *re)
+{
+#ifdef HAVE_LIBXML2
+    cligen_regex_libxml2_free(re);
+#else
+    cligen_regex_posix_free(re);
+    free(re);
+#endif
+}
+
 /*! Returns "true" if the "subject" string matches the regular expression "pattern";
  *
  * @param[in]  xc   Incoming context
@@ -189,6 +263,7 @@ xp_function_current(xp_ctx            *xc0,
  *       This means for xml2, you have to configure BOTH cligen and clixon with --with-libxml2
  * @note Compiling regexp takes a lot of resources, no caching is made of re here
  *       as is done for eg YANG patterns
+ * @see xp_function_nodeset_filter  compiles once when used as predicate over a node-set
  * Example: re-match("1.22.333", "\d{1,3}\.\d{1,3}\.\d{1,3}") returns true
  */
 int
@@ -204,8 +279,8 @@ xp_function_re_match(xp_ctx            *xc,
     xp_ctx *xr = NULL;
     char   *s0 = NULL;
     char   *regexp = NULL;
-    char   *posix = NULL;
     void   *re = NULL;
+    int     shared;
     int     ret;
 
     if (xs == NULL || xs->xs_c0 == NULL || xs->xs_c1 == NULL){
@@ -221,28 +296,19 @@ xp_function_re_match(xp_ctx            *xc,
         goto done;
     if (ctx2string(xr1, &regexp) < 0)
         goto done;
-#ifdef HAVE_LIBXML2
-    if ((ret = cligen_regex_libxml2_compile(regexp, &re)) < 0)
-        goto done;
-#else
-    if (regexp_xsd2posix(regexp, &posix) < 0)
+    /* Literal patterns are compiled once */
+    shared = xr1->xc_type == XT_STRING && xs->xs_c1->xs_type == XP_EXP &&
+        xp_unwrap(xs->xs_c1)->xs_type == XP_PRIME_STR;
+    if ((ret = xp_regex_compile(regexp, shared, &re)) < 0)
         goto done;
-    if ((ret = cligen_regex_posix_compile(posix, &re)) < 0)
-        goto done;
-#endif
     if (ret == 0){
         clixon_err(OE_YANG, 0, "regexp compile fail: \"%s\"", regexp);
         goto done;
     }
-    //    s0 = "1.22.333";
-#ifdef HAVE_LIBXML2
-    if ((ret = cligen_regex_libxml2_exec(re, s0)) < 0)
+    if ((ret = xp_regex_exec(re, s0)) < 0)
         goto done;
-
-#else
-    if ((ret = cligen_regex_posix_exec(re, s0)) < 0)
-        goto done;
-#endif
+    if (shared)
+        re = NULL;
     if ((xr = malloc(sizeof(*xr))) == NULL){
         clixon_err(OE_UNIX, errno, "malloc");
         goto done;
@@ -254,14 +320,8 @@ xp_function_re_match(xp_ctx            *xc,
     xr = NULL;
     retval = 0;
  done:
-    if (re){
-#ifdef HAVE_LIBXML2
-        cligen_regex_libxml2_free(re);
-#else
-        cligen_regex_posix_free(re);
-        free(re);
-#endif
-    }
+    if (re)
+        xp_regex_free(re);
     if (xr0)
         ctx_free(xr0);
     if (xr1)
@@ -270,8 +330,6 @@ xp_function_re_match(xp_ctx            *xc,
         free(s0);
     if (regexp)
         free(regexp);
-    if (posix)
-        free(posix);
     return retval;
 }
 
@@ -353,7 +411,6 @@ derived_from_one(char  *baseidentity,
     yang_stmt *ytype;
     yang_stmt *ybaseid;
     yang_stmt *ymod;
-    cvec      *idrefvec; /* Derived identityref list: (module:id)**/
     char      *node = NULL;
     char      *prefix = NULL;
     char      *id = NULL;
@@ -381,8 +438,6 @@ derived_from_one(char  *baseidentity,
     /* Just get the object corresponding to the base identity */
     if ((ybaseid = yang_find_identity_nsc(ys_spec(yleaf), baseidentity, nsc)) == NULL)
         goto nomatch;
-    /* Get its list of derived identities  */
-    idrefvec = yang_cvec_get(ybaseid);
     /* Get and split the leaf id reference */
     if ((node = xml_body(xleaf)) == NULL) /* It may not be empty */
         goto nomatch;
@@ -409,7 +464,7 @@ derived_from_one(char  *baseidentity,
             goto done;
         }
         cprintf(cb, "%s:%s", yang_argument_get(ymod), id);
-        if (cvec_find(idrefvec, cbuf_get(cb)) == NULL)
+        if (!yang_identity_derived(ybaseid, cbuf_get(cb)))
             goto nomatch;
     }
     retval = 1;
@@ -978,6 +1033,173 @@ xp_function_contains(xp_ctx            *xc,
     return retval;
 }
 
+/*! Skip XPath tree nodes that only wrap a single sub-expression
+ *
+ * @param[in]  xs   XPath tree
+ * @retval     xs   First node that is not a single-child wrapper
+ */
+static struct xpath_tree *
+xp_unwrap(struct xpath_tree *xs)
+{
+    while (xs != NULL && xs->xs_c0 != NULL && xs->xs_c1 == NULL){
+        switch (xs->xs_type){
+        case XP_EXP:
+        case XP_AND:
+        case XP_RELEX:
+        case XP_ADD:
+        case XP_UNION:
+        case XP_PATHEXPR:
+        case XP_FILTEREXPR:
+        case XP_PRI0:
+            xs = xs->xs_c0;
+            break;
+        default:
+            return xs;
+        }
+    }
+    return xs;
+}
+
+/*! Get string value of a node-set argument in place, as ctx2string would return it
+ *
+ * @param[in]  x     Context node
+ * @param[in]  xn    Node test of a child step, or NULL for the context node itself (".")
+ * @param[in]  nsc   XML Namespace context
+ * @param[in]  localonly Skip prefix and namespace tests (non-standard)
+ * @retval     str   String value, not copied
+ */
+static char *
+xp_nodeset_arg_string(cxobj             *x,
+                      struct xpath_tree *xn,
+                      cvec              *nsc,
+                      int                localonly)
+{
+    cxobj *xc;
+    char  *str = NULL;
+
+    if (xn == NULL)
+        str = xml_body(x);
+    else {
+        xc = NULL;
+        while ((xc = xml_child_each(x, xc, CX_ELMNT)) != NULL)
+            if (nodetest_eval(xc, xn, nsc, localonly) == 1){
+                str = xml_body(xc);
+                break;
+            }
+    }
+    return str ? str : "";
+}
+
+/*! Filter a node-set with a string function predicate, evaluated in one pass
+ *
+ * Handles predicates of the form [contains(a,'s')], [starts-with(a,'s')] and
+ * [re-match(a,'r')], where a is a child name or ".", and the second argument is a literal,
+ * eg /interfaces/interface[contains(description,'uplink')].
+ * The literal is prepared, or the regex compiled, once and the string values are matched in
+ * place, instead of evaluating the function with new contexts and string copies per node
+ * @param[in]  xc    Context with node-set to filter
+ * @param[in]  xs    XPath tree of predicate expression
+ * @param[in]  nsc   XML Namespace context
+ * @param[in]  localonly Skip prefix and namespace tests (non-standard)
+ * @param[in]  xr    Node-set context, nodes of xc for which predicate is true are appended
+ * @retval     1     OK, predicate evaluated
+ * @retval     0     Predicate not of this form, evaluate it per node
+ * @retval    -1     Error
+ * @see xp_eval_predicate
+ */
+int
+xp_function_nodeset_filter(xp_ctx            *xc,
+                           struct xpath_tree *xs,
+                           cvec              *nsc,
+                           int                localonly,
+                           xp_ctx            *xr)
+{
+    int                retval = -1;
+    struct xpath_tree *xfn;
+    struct xpath_tree *xargs;
+    struct xpath_tree *xa;
+    struct xpath_tree *xn = NULL;
+    struct xpath_tree *xlit;
+    char              *lit;
+    size_t             len;
+    void              *re = NULL;
+    cxobj             *x;
+    char              *str;
+    int                i;
+    int                ret;
+
+    /* Two arguments: args are XP_EXP(c0: XP_EXP(arg1), c1: arg2) */
+    if ((xfn = xp_unwrap(xs)) == NULL ||
+        xfn->xs_type != XP_PRIME_FN ||
+        (xargs = xfn->xs_c0) == NULL ||
+        xargs->xs_c0 == NULL || xargs->xs_c1 == NULL ||
+        xargs->xs_c0->xs_type != XP_EXP || xargs->xs_c0->xs_c1 != NULL)
+        goto skip;
+    switch (xfn->xs_int){
+    case XPATHFN_CONTAINS:
+    case XPATHFN_STARTS_WITH:
+    case XPATHFN_RE_MATCH:
+        break;
+    default:
+        goto skip;
+    }
+    /* Second argument: literal */
+    if ((xlit = xp_unwrap(xargs->xs_c1)) == NULL ||
+        xlit->xs_type != XP_PRIME_STR || (lit = xlit->xs_s0) == NULL)
+        goto skip;
+    /* First argument: single child step or ".", without predicates */
+    if ((xa = xp_unwrap(xargs->xs_c0->xs_c0)) == NULL ||
+        xa->xs_type != XP_LOCPATH ||
+        (xa = xa->xs_c0) == NULL ||
+        xa->xs_type != XP_RELLOCPATH || xa->xs_c1 != NULL ||
+        (xa = xa->xs_c0) == NULL ||
+        xa->xs_type != XP_STEP ||
+        (xa->xs_c1 != NULL && (xa->xs_c1->xs_c0 != NULL || xa->xs_c1->xs_c1 != NULL)))
+        goto skip;
+    if (xa->xs_int == A_SELF && xa->xs_c0 == NULL)
+        xn = NULL;
+    else if (xa->xs_int == A_CHILD &&
+             (xn = xa->xs_c0) != NULL &&
+             xn->xs_type == XP_NODE &&
+             xn->xs_s1 != NULL && strcmp(xn->xs_s1, "*") != 0)
+        ;
+    else
+        goto skip;
+    if (xfn->xs_int == XPATHFN_RE_MATCH){
+        if ((ret = xp_regex_compile(lit, 1, &re)) < 0)
+            goto done;
+        if (ret == 0){
+            clixon_err(OE_YANG, 0, "regexp compile fail: \"%s\"", lit);
+            goto done;
+        }
+    }
+    len = strlen(lit);
+    for (i=0; i<xc->xc_size; i++){
+        x = xc->xc_nodeset[i];
+        str = xp_nodeset_arg_string(x, xn, nsc, localonly);
+        switch (xfn->xs_int){
+        case XPATHFN_CONTAINS:
+            ret = (len == 0 || strstr(str, lit) != NULL);
+            break;
+        case XPATHFN_STARTS_WITH:
+            ret = (strncmp(str, lit, len) == 0);
+            break;
+        default: /* XPATHFN_RE_MATCH */
+            if ((ret = xp_regex_exec(re, str)) < 0)
+                goto done;
+            break;
+        }
+        if (ret && cxvec_append(x, &xr->xc_nodeset, &xr->xc_size) < 0)
+            goto done;
+    }
+    retval = 1;
+ done:
+    return retval;
+ skip:
+    retval = 0;
+    goto done;
+}
+
 /*! Eval xpath function contains sub-string
  *
  * @param[in]  xc   Incoming context
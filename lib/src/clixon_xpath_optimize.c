@@ -66,14 +66,14 @@
 #include "clixon_debug.h"
 #include "clixon_xml_vec.h"
 #include "clixon_xml_sort.h"
+#include "clixon_xml_nsctx.h"
 #include "clixon_xpath_ctx.h"
 #include "clixon_xpath.h"
+#include "clixon_xpath_function.h"
+#include "clixon_xpath_eval.h"
 #include "clixon_xpath_optimize.h"
 
 #ifdef XPATH_LIST_OPTIMIZE
-static xpath_tree *_xmtop = NULL; /* pattern match tree top */
-static xpath_tree *_xm = NULL;
-static xpath_tree *_xe = NULL;
 static int _optimize_enable = 1;
 static int _optimize_hits = 0;
 #endif /* XPATH_LIST_OPTIMIZE */
@@ -105,147 +105,294 @@ xpath_list_optimize_set(int enable)
 void
 xpath_optimize_exit(void)
 {
-#ifdef XPATH_LIST_OPTIMIZE
-    if (_xmtop)
-        xpath_tree_free(_xmtop);
-#endif
 }
 
 #ifdef XPATH_LIST_OPTIMIZE
-/*! Initialize xpath module
+/*! Skip single-child wrapper nodes of XPath tree down to a given type
  *
- * XXX move to clixon_xpath.c 
- * @see loop_preds
+ * The parser creates a chain of expr, andexpr, relexpr, etc, nodes also for simple
+ * expressions. Go down the chain as long as there is only one child.
+ * @param[in]  xs    XPath tree
+ * @param[in]  type  Stop at this type
+ * @retval     xs    XPath tree of type
+ * @retval     NULL  Not found, or a node with two children was encountered
  */
-int
-xpath_optimize_init(xpath_tree **xm,
-                    xpath_tree **xe)
+static xpath_tree *
+xpath_optimize_skip(xpath_tree  *xs,
+                    enum xp_type type)
+{
+    while (xs && xs->xs_type != type){
+        if (xs->xs_c1 != NULL)
+            return NULL;
+        xs = xs->xs_c0;
+    }
+    return xs;
+}
+
+/*! Get name of a single child step, eg the "k" of k='3'
+ *
+ * @param[in]  xs    XPath tree of type XP_ADD (left side of relexpr)
+ * @retval     name  Name of child node
+ * @retval     NULL  Not a single child step
+ */
+static char *
+xpath_optimize_keyname(xpath_tree *xs)
+{
+    xpath_tree *xn;
+
+    if ((xs = xpath_optimize_skip(xs, XP_RELLOCPATH)) == NULL)
+        return NULL;
+    if (xs->xs_c1 != NULL || (xs = xs->xs_c0) == NULL)
+        return NULL;
+    if (xs->xs_type != XP_STEP || xs->xs_int != A_CHILD)
+        return NULL;
+    if ((xn = xs->xs_c0) == NULL || xn->xs_type != XP_NODE || xn->xs_s1 == NULL)
+        return NULL;
+    /* No predicates on the key */
+    if (xs->xs_c1 && (xs->xs_c1->xs_c0 || xs->xs_c1->xs_c1))
+        return NULL;
+    return xn->xs_s1;
+}
+
+/*! Get value of right side of key predicate, eg the '3' of k='3'
+ *
+ * Literals and numbers are used as is. Paths starting with current() or the root are
+ * evaluated, since they do not depend on the list entry. They must result in one node.
+ * @param[in]  xs        XPath tree of type XP_ADD (right side of relexpr)
+ * @param[in]  xv        XML base node
+ * @param[in]  xinit     Initial XPath context node of current()
+ * @param[in]  nsc       XML Namespace context
+ * @param[in]  localonly Skip prefix and namespace tests
+ * @param[out] value     Value, static or pointing into XML tree
+ * @retval     2         Value evaluated to empty nodeset: predicate is false
+ * @retval     1         Value found
+ * @retval     0         Not a constant value, no optimization
+ * @retval    -1         Error
+ */
+static int
+xpath_optimize_keyval(xpath_tree *xs,
+                      cxobj      *xv,
+                      cxobj      *xinit,
+                      cvec       *nsc,
+                      int         localonly,
+                      char      **value)
 {
     int         retval = -1;
-    xpath_tree *xs;
+    xpath_tree *xp;
+    xpath_tree *xf;
+    xp_ctx      xc = {0,};
+    xp_ctx     *xr = NULL;
 
-    if (_xm == NULL){
-        /* Initialize xpath-tree */
-        if (xpath_parse("_x[_y='_z']", &_xmtop) < 0)
-            goto done;
-        /* Go down two steps */
-        if ((_xm = xpath_tree_traverse(_xmtop, 0, 0, -1)) == NULL)
-            goto done;
-        /* get nodetest tree (_x) */
-        if ((xs = xpath_tree_traverse(_xm, 0, -1)) == NULL)
-            goto done;
-        xs->xs_match++;
-        /* get predicates [_y=_z][z=2] */
-        if ((xs = xpath_tree_traverse(_xm, 1, -1)) == NULL)
-            goto done;
-        xs->xs_match++;
-        /* get expression [_y=_z] */
-        if ((_xe = xpath_tree_traverse(xs, 1, -1)) == NULL)
-            goto done;
-        /* get keyname (_y) */
-        if ((xs = xpath_tree_traverse(_xe, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, -1)) == NULL)
-            goto done;
-        xs->xs_match++; /* in loop_preds get name in xs_s1 XXX: leaf-list is different */
-        /* get keyval (_z) */
-        if ((xs = xpath_tree_traverse(_xe, 0, 0, 1, 0, 0, 0, 0, -1)) == NULL)
-            goto done;
-        xs->xs_match++; /* in loop_preds get value in xs_s0 or xs_strnr */
+    if ((xp = xpath_optimize_skip(xs, XP_PATHEXPR)) == NULL)
+        goto ok;
+    if ((xf = xp->xs_c0) == NULL)
+        goto ok;
+    if (xf->xs_type == XP_FILTEREXPR && xp->xs_c1 == NULL){
+        xf = xf->xs_c0;
+        if (xf && xf->xs_type == XP_PRIME_STR && xf->xs_s0){
+            *value = xf->xs_s0;
+            goto found;
+        }
+        if (xf && xf->xs_type == XP_PRIME_NR && xf->xs_strnr){
+            *value = xf->xs_strnr;
+            goto found;
+        }
     }
-    *xm = _xm;
-    *xe = _xe;
-    retval = 0;
+    /* current() or current()/.. */
+    if (xf->xs_type == XP_FILTEREXPR){
+        if (xf->xs_c0 == NULL || xf->xs_c0->xs_type != XP_PRIME_FN ||
+            xf->xs_c0->xs_int != XPATHFN_CURRENT)
+            goto ok;
+    }
+    /* /a/b */
+    else if (xf->xs_type != XP_LOCPATH || xf->xs_c0 == NULL || xf->xs_c0->xs_type != XP_ABSPATH)
+        goto ok;
+    if (xinit == NULL)
+        goto ok;
+    xc.xc_type = XT_NODESET;
+    xc.xc_node = xv;
+    xc.xc_initial = xinit;
+    if (cxvec_append(xv, &xc.xc_nodeset, &xc.xc_size) < 0)
+        goto done;
+    if (xp_eval(&xc, xs, nsc, localonly, &xr) < 0)
+        goto done;
+    if (xr == NULL || xr->xc_type != XT_NODESET || xr->xc_size > 1)
+        goto ok;
+    if (xr->xc_size == 0){
+        retval = 2;
+        goto done;
+    }
+    if ((*value = xml_body(xr->xc_nodeset[0])) == NULL)
+        goto ok;
+ found:
+    retval = 1;
  done:
+    if (xc.xc_nodeset)
+        free(xc.xc_nodeset);
+    if (xr)
+        ctx_free(xr);
     return retval;
+ ok: /* not a constant value */
+    retval = 0;
+    goto done;
 }
 
-/*! Recursive function to loop over all EXPR and pattern match them
+/*! Collect <keyname>=<keyval> pairs from and:ed equality expressions of one predicate
  *
- * @param[in]  xt    XPath tree of type PRED
- * @param[in]  xepat Pattern matching XPath tree of type EXPR
- * @param[out] cvk   Vector of <keyname>:<keyval> pairs
- * @retval     1     Match
- * @retval     0     No match
- * @retval    -1     Error
- * @see xpath_optimize_init
+ * Other parts of the expression are skipped, they are evaluated as predicates anyway.
+ * @param[in]  xs        XPath tree of predicate expression
+ * @param[in]  xv        XML base node
+ * @param[in]  xinit     Initial XPath context node of current()
+ * @param[in]  nsc       XML Namespace context
+ * @param[in]  localonly Skip prefix and namespace tests
+ * @param[out] cvk       Vector of <keyname>:<keyval> pairs
+ * @retval     2         A key evaluated to empty nodeset: no match
+ * @retval     1         Expression is boolean, pairs added to cvk
+ * @retval     0         Expression may not be boolean (eg positional) stop here
+ * @retval    -1         Error
  */
 static int
-loop_preds(xpath_tree *xt,
-           xpath_tree *xepat,
-           cvec       *cvk)
+xpath_optimize_conj(xpath_tree *xs,
+                    cxobj      *xv,
+                    cxobj      *xinit,
+                    cvec       *nsc,
+                    int         localonly,
+                    cvec       *cvk)
 {
-    int          retval = -1;
-    xpath_tree  *xe;
-    xpath_tree **vec = NULL;
-    size_t       veclen = 0;
-    cg_var      *cvi;
-    int          ret;
+    int     retval = -1;
+    char   *name;
+    char   *value = NULL;
+    cg_var *cvi;
+    int     ret;
 
-    if (xt->xs_type == XP_PRED && xt->xs_c0){
-        if ((ret = loop_preds(xt->xs_c0, xepat, cvk)) < 0)
-            goto done;
-        if (ret == 0)
+    switch (xs->xs_type){
+    case XP_EXP:
+    case XP_AND:
+        if (xs->xs_c1 == NULL){
+            if (xs->xs_c0 == NULL)
+                goto ok;
+            return xpath_optimize_conj(xs->xs_c0, xv, xinit, nsc, localonly, cvk);
+        }
+        if (xs->xs_int != XO_AND)
+            goto skip;
+        /* An and-expression is boolean regardless of its terms */
+        if ((ret = xpath_optimize_conj(xs->xs_c0, xv, xinit, nsc, localonly, cvk)) < 0 || ret == 2)
+            return ret;
+        if ((ret = xpath_optimize_conj(xs->xs_c1, xv, xinit, nsc, localonly, cvk)) < 0 || ret == 2)
+            return ret;
+        break;
+    case XP_RELEX:
+        if (xs->xs_c1 == NULL)
             goto ok;
-    }
-    if ((xe = xt->xs_c1) && (xe->xs_type == XP_EXP)){
-        if ((ret = xpath_tree_eq(xepat, xe, &vec, &veclen)) < 0)
+        if (xs->xs_int != XO_EQ)
+            goto skip;
+        if ((name = xpath_optimize_keyname(xs->xs_c0)) == NULL)
+            goto skip;
+        if ((ret = xpath_optimize_keyval(xs->xs_c1, xv, xinit, nsc, localonly, &value)) < 0)
             goto done;
         if (ret == 0)
-            goto ok;
-        if (veclen != 2)
-            goto ok;
+            goto skip;
+        if (ret == 2){
+            retval = 2;
+            goto done;
+        }
         if ((cvi = cvec_add(cvk, CGV_STRING)) == NULL){
             clixon_err(OE_XML, errno, "cvec_add");
             goto done;
         }
-        cv_name_set(cvi, vec[0]->xs_s1);
-        if (vec[1]->xs_type == XP_PRIME_NR)
-            cv_string_set(cvi, vec[1]->xs_strnr);
-        else
-            cv_string_set(cvi, vec[1]->xs_s0);
+        cv_name_set(cvi, name);
+        cv_string_set(cvi, value);
+        break;
+    default:
+        goto ok;
+        break;
     }
+ skip: /* boolean, but no key */
     retval = 1;
  done:
-    if (vec)
-        free(vec);
     return retval;
- ok: /* no match, not special case */
+ ok: /* may not be boolean */
     retval = 0;
     goto done;
 }
 
+/*! Collect key pairs from the leading boolean predicates of a step
+ *
+ * Predicates are evaluated left to right, so stop at the first predicate that may be
+ * positional, eg y[k='a'][2]
+ * @param[in]  xt        XPath tree of type XP_PRED
+ * @param[in]  xv        XML base node
+ * @param[in]  xinit     Initial XPath context node of current()
+ * @param[in]  nsc       XML Namespace context
+ * @param[in]  localonly Skip prefix and namespace tests
+ * @param[out] cvk       Vector of <keyname>:<keyval> pairs
+ * @retval     2         A key evaluated to empty nodeset: no match
+ * @retval     1         All predicates are boolean
+ * @retval     0         Stopped at non-boolean predicate
+ * @retval    -1         Error
+ */
+static int
+xpath_optimize_preds(xpath_tree *xt,
+                     cxobj      *xv,
+                     cxobj      *xinit,
+                     cvec       *nsc,
+                     int         localonly,
+                     cvec       *cvk)
+{
+    int ret;
+
+    if (xt == NULL || xt->xs_type != XP_PRED)
+        return 0;
+    if (xt->xs_c0){
+        if ((ret = xpath_optimize_preds(xt->xs_c0, xv, xinit, nsc, localonly, cvk)) != 1)
+            return ret;
+    }
+    if (xt->xs_c1 == NULL)
+        return 1;
+    return xpath_optimize_conj(xt->xs_c1, xv, xinit, nsc, localonly, cvk);
+}
+
 /*! Pattern matching to find fastpath
  *
- * @param[in]  xt     XPath tree
- * @param[in]  xv     XML base node
- * @param[out] xvec   Array of found nodes
- * @param[out] xlen   Len of xvec
- * @param[out] key
- * @param[out] keyval
- * @retval     1      Match
- * @retval     0      No match - use non-optimized lookup
- * @retval    -1      Error
+ * A step of the form <name>[<keyname>=<keyval>]... where name is a yang list. The pairs are
+ * taken from the leading predicates, and and:ed with other expressions, in any order.
+ * The keyval may be a literal, a number, or a path starting with current() or "/".
+ * If the pairs are a prefix of the list keys (or an explicit search index), the candidates
+ * are found with binary search. Since the predicates are evaluated on the result, it is
+ * sufficient that the result contains all matching entries.
+ * @param[in]  xt        XPath tree of type XP_STEP
+ * @param[in]  xv        XML base node
+ * @param[in]  xinit     Initial XPath context node of current()
+ * @param[in]  nsc       XML Namespace context
+ * @param[in]  localonly Skip prefix and namespace tests
+ * @param[out] xvec      Candidate nodes
+ * @retval     1         Match
+ * @retval     0         No match - use non-optimized lookup
+ * @retval    -1         Error
  *  XPath:
  *  y[k=3] # corresponds to: <name>[<keyname>=<keyval>]
+ *  y[k1='a'][k2=current()/../x]
  */
 static int
 xpath_list_optimize_fn(xpath_tree  *xt,
                        cxobj       *xv,
+                       cxobj       *xinit,
+                       cvec        *nsc,
+                       int          localonly,
                        clixon_xvec *xvec)
 {
     int          retval = -1;
-    xpath_tree  *xm = NULL;
-    xpath_tree  *xem = NULL;
+    xpath_tree  *xn;
     char        *name;
+    char        *ns;
     yang_stmt   *yp;
     yang_stmt   *yc;
-    cvec        *cvv = NULL;
-    xpath_tree **vec = NULL;
-    size_t       veclen = 0;
-    xpath_tree  *xtp;
-    cvec        *cvk = NULL; /* vector of index keys */
-    cg_var      *cvi;
-    int          i;
-    yang_stmt   *ypp;
+    cvec        *cvv;
+    cvec        *cvk = NULL; /* vector of key pairs from predicates */
+    cvec        *cvi = NULL; /* vector of index keys in key order */
+    cg_var      *cv;
+    cg_var      *cvp;
+    char        *kname;
     int          ret;
 
     /* revert to non-optimized if no yang */
@@ -254,63 +401,68 @@ xpath_list_optimize_fn(xpath_tree  *xt,
     /* or if not config data (state data should not be ordered) */
     if (yang_config_ancestor(yp) == 0)
         goto ok;
-    /* Check that there is no "outer" list. */
-    ypp = yp;
-    do {
-        if (yang_keyword_get(ypp) == Y_LIST)
-            goto ok;
-    } while((ypp = yang_parent_get(ypp)) != NULL);
-    /* Check yang and that only a list with key as index is a special case can do bin search 
-     * That is, ONLY check optimize cases of this type:_x[_y='_z']
-     * Should we extend this simple example and have more cases (all cases?)
-     */
-    xpath_optimize_init(&xm, &xem);
-    /* Here is where pattern is checked for equality and where variable binding is made (if
-     * equal) */
-    if ((ret = xpath_tree_eq(xm, xt, &vec, &veclen)) < 0)
-        goto done;
-    if (ret == 0)
-        goto ok; /* no match */
-    if (veclen != 2)
+    if (xt->xs_type != XP_STEP || xt->xs_int != A_CHILD)
+        goto ok;
+    if ((xn = xt->xs_c0) == NULL || xn->xs_type != XP_NODE || (name = xn->xs_s1) == NULL)
         goto ok;
-    name = vec[0]->xs_s1;
-    /* Extract variables */
     if ((yc = yang_find(yp, Y_LIST, name)) == NULL)
-#ifdef NOTYET /* leaf-list is not detected by xpath optimize detection */
-        if ((yc = yang_find(yp, Y_LEAF_LIST, name)) == NULL) /* XXX */
-#endif
+        goto ok;
+    /* The node test is replaced by the search, so check namespace here */
+    if (xn->xs_s0 && !localonly){
+        if ((ns = xml_nsctx_get(nsc, xn->xs_s0)) == NULL ||
+            yang_find_mynamespace(yc) == NULL ||
+            strcmp(ns, yang_find_mynamespace(yc)) != 0)
             goto ok;
-    /* Validate keys */
+    }
     if ((cvv = yang_cvec_get(yc)) == NULL)
         goto ok;
-    xtp = vec[1];
-    if ((cvk = cvec_new(0)) == NULL){
+    if ((cvk = cvec_new(0)) == NULL ||
+        (cvi = cvec_new(0)) == NULL){
         clixon_err(OE_YANG, errno, "cvec_new");
         goto done;
     }
-    if ((ret = loop_preds(xtp, xem, cvk)) < 0)
+    if ((ret = xpath_optimize_preds(xt->xs_c1, xv, xinit, nsc, localonly, cvk)) < 0)
         goto done;
-    if (ret == 0)
-        goto ok;
+    if (ret == 2) /* No entry can match */
+        goto match;
+    /* Arrange pairs in key order, as long as they are a prefix of the keys */
+    cv = NULL;
+    while ((cv = cvec_each(cvv, cv)) != NULL){
+        kname = cv_string_get(cv);
+        if ((cvp = cvec_find(cvk, kname)) == NULL)
+            break;
+        if (cvec_append_var(cvi, cvp) == NULL){
+            clixon_err(OE_YANG, errno, "cvec_append_var");
+            goto done;
+        }
+    }
+#ifdef XML_EXPLICIT_INDEX
+    if (cvec_len(cvi) == 0){
+        yang_stmt *yi;
 
-    if (cvec_len(cvv) != cvec_len(cvk))
-        goto ok;
-    i = 0;
-    cvi = NULL;
-    while ((cvi = cvec_each(cvk, cvi)) != NULL) {
-        if (strcmp(cv_name_get(cvi), cv_string_get(cvec_i(cvv,i))))
-            goto ok;
-        i++;
+        cv = NULL;
+        while ((cv = cvec_each(cvk, cv)) != NULL){
+            if ((yi = yang_find_datanode(yc, cv_name_get(cv))) != NULL &&
+                yang_flag_get(yi, YANG_FLAG_INDEX) != 0)
+                break;
+        }
+        if (cv && cvec_append_var(cvi, cv) == NULL){
+            clixon_err(OE_YANG, errno, "cvec_append_var");
+            goto done;
+        }
     }
-    /* Use 2a form since yc already given to compute cvk */
-    if (clixon_xml_find_index(xv, yp, NULL, name, cvk, xvec) < 0)
+#endif
+    if (cvec_len(cvi) == 0)
+        goto ok;
+    if (clixon_xml_find_index(xv, yp, NULL, name, cvi, xvec) < 0)
         goto done;
+ match:
     retval = 1; /* match */
  done:
-    if (vec)
-        free(vec);
     if (cvk)
         cvec_free(cvk);
+    if (cvi)
+        cvec_free(cvi);
     return retval;
  ok: /* no match, not special case */
     retval = 0;
@@ -320,6 +472,13 @@ xpath_list_optimize_fn(xpath_tree  *xt,
 
 /*! Identify XPath special cases and if match, use binary search.
  *
+ * @param[in]  xs        XPath tree of type XP_STEP
+ * @param[in]  xv        XML base node
+ * @param[in]  xinit     Initial XPath context node, for current()
+ * @param[in]  nsc       XML Namespace context
+ * @param[in]  localonly Skip prefix and namespace tests
+ * @param[out] xvec0     Candidate nodes, predicates of xs need to be evaluated on them
+ * @param[out] xlen0     Length of xvec0
  * @retval  1  Optimization made, special case, use x (found if != NULL)
  * @retval  0  Dont optimize: not special case, do normal processing
  * @retval -1  Error
@@ -328,6 +487,9 @@ xpath_list_optimize_fn(xpath_tree  *xt,
 int
 xpath_optimize_check(xpath_tree *xs,
                      cxobj      *xv,
+                     cxobj      *xinit,
+                     cvec       *nsc,
+                     int         localonly,
                      cxobj    ***xvec0,
                      int        *xlen0)
 {
@@ -341,7 +503,7 @@ xpath_optimize_check(xpath_tree *xs,
     else if ((xvec = clixon_xvec_new()) == NULL)
         goto done;
     /* Glue code since xpath code uses (old) cxobj ** and search code uses (new) clixon_xvec */
-    else if ((ret = xpath_list_optimize_fn(xs, xv, xvec)) < 0)
+    else if ((ret = xpath_list_optimize_fn(xs, xv, xinit, nsc, localonly, xvec)) < 0)
         goto done;
     else if (ret == 1){
         if (xvec0 && *xvec0){
@@ -43,6 +43,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <stddef.h>
 #include <errno.h>
 #include <limits.h>
 #include <ctype.h>
@@ -58,6 +59,8 @@
 #include <libgen.h>
 #include <sys/stat.h>
 #include <sys/param.h>
+#include <sys/time.h>
+#include <sys/resource.h>
 #include <netinet/in.h>
 
 /* cligen */
@@ -89,6 +92,8 @@
 #include "clixon_yang_cardinality.h"
 #include "clixon_yang_type.h"
 #include "clixon_yang_schema_mount.h"
+#include "clixon_xml_default.h"
+#include "clixon_path.h"
 #include "clixon_yang_internal.h" /* internal included by this file only, not API */
 
 /* Context for matching an import by module name and capturing its prefix */
@@ -209,10 +214,47 @@ static size_t       _yang_mymodule_map_len = 0;
 /* See option CLICON_YANG_USE_ORIGINAL */
 static int _yang_use_orig = 0;
 
+#ifdef YANG_IDENTITY_BITSET
+/* Dense identity numbers keyed by <module>:<id>, shared by all yang specs */
+static clicon_hash_t *_yang_identity_index = NULL;
+static uint32_t       _yang_identity_nr = 0;
+#endif
+
 /* Forward static */
 static int yang_type_cache_free(yang_type_cache *ycache);
 static int uses_orig_ptr(enum rfc_6020 keyword);
 
+#ifdef YANG_COMPACT
+/*! Statements allocated as compact yang_stmt, without cv, cvec, orig and union fields
+ *
+ * These are string-only statements, ie only keyword, argument and possibly extension
+ * children are used
+ * @param[in] keyw  Yang keyword
+ * @retval    1     Compact statement
+ * @retval    0     Full statement
+ * @see YANG_COMPACT_SIZE
+ */
+static int
+ys_compact_keyword(enum rfc_6020 keyw)
+{
+    switch (keyw){
+    case Y_CONTACT:
+    case Y_DESCRIPTION:
+    case Y_ERROR_APP_TAG:
+    case Y_ERROR_MESSAGE:
+    case Y_ORGANIZATION:
+    case Y_PRESENCE:
+    case Y_REFERENCE:
+    case Y_UNITS:
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+#define ys_compact(ys) ys_compact_keyword((ys)->ys_keyword)
+#endif /* YANG_COMPACT */
+
 /* Access functions
  */
 
@@ -314,6 +356,10 @@ yang_argument_dup(yang_stmt  *ys,
 yang_stmt *
 yang_orig_get(yang_stmt *ys)
 {
+#ifdef YANG_COMPACT
+    if (ys_compact(ys))
+        return NULL;
+#endif
     return ys->ys_orig;
 }
 
@@ -328,6 +374,10 @@ int
 yang_orig_set(yang_stmt *ys,
               yang_stmt *y0)
 {
+#ifdef YANG_COMPACT
+    if (ys_compact(ys) || ys_compact(y0)) /* Not kept for compact statements */
+        return 0;
+#endif
     if (y0->ys_orig){
         yang_orig_set(ys, y0->ys_orig);
     }
@@ -344,6 +394,10 @@ yang_orig_set(yang_stmt *ys,
 cg_var*
 yang_cv_get(yang_stmt *ys)
 {
+#ifdef YANG_COMPACT
+    if (ys_compact(ys))
+        return NULL;
+#endif
     return ys->ys_cv;
 }
 
@@ -358,6 +412,15 @@ int
 yang_cv_set(yang_stmt *ys,
             cg_var    *cv)
 {
+#ifdef YANG_COMPACT
+    if (ys_compact(ys)){
+        if (cv != NULL){
+            clixon_err(OE_YANG, EINVAL, "No cv in compact yang %s", yang_key2str(ys->ys_keyword));
+            return -1;
+        }
+        return 0;
+    }
+#endif
     if (cv != NULL && ys->ys_cv != NULL)
         cv_free(ys->ys_cv);
     ys->ys_cv = cv;
@@ -373,6 +436,10 @@ yang_cv_set(yang_stmt *ys,
 cvec*
 yang_cvec_get(yang_stmt *ys)
 {
+#ifdef YANG_COMPACT
+    if (ys_compact(ys))
+        return NULL;
+#endif
     return ys->ys_cvec;
 }
 
@@ -387,6 +454,15 @@ int
 yang_cvec_set(yang_stmt *ys,
               cvec      *cvv)
 {
+#ifdef YANG_COMPACT
+    if (ys_compact(ys)){
+        if (cvv != NULL){
+            clixon_err(OE_YANG, EINVAL, "No cvec in compact yang %s", yang_key2str(ys->ys_keyword));
+            return -1;
+        }
+        return 0;
+    }
+#endif
     if (ys->ys_cvec)
         cvec_free(ys->ys_cvec);
     ys->ys_cvec = cvv;
@@ -730,6 +806,41 @@ yang_typecache_set(yang_stmt *ys,
     return 0;
 }
 
+#ifdef YANG_TYPE_VALIDATOR
+/*! Get compiled type validator of leaf or leaf-list
+ *
+ * @param[in]  ys  Yang statement
+ * @retval     yv  Validator or NULL
+ * @see YANG_TYPE_VALIDATOR
+ */
+void *
+yang_validator_get(yang_stmt *ys)
+{
+    if (ys->ys_keyword != Y_LEAF && ys->ys_keyword != Y_LEAF_LIST)
+        return NULL;
+    return ys->ys_validator;
+}
+
+/*! Set compiled type validator of leaf or leaf-list
+ *
+ * @param[in]  ys  Yang statement
+ * @param[in]  yv  Validator
+ * @retval     0   OK
+ * @retval    -1   Error
+ */
+int
+yang_validator_set(yang_stmt *ys,
+                   void      *yv)
+{
+    if (ys->ys_keyword != Y_LEAF && ys->ys_keyword != Y_LEAF_LIST){
+        clixon_err(OE_YANG, EINVAL, "Expected leaf or leaf-list");
+        return -1;
+    }
+    ys->ys_validator = yv;
+    return 0;
+}
+#endif /* YANG_TYPE_VALIDATOR */
+
 /*! Get mymodule
  *
  * Shortcut to "my" module. Used by augmented and unknown nodes
@@ -791,6 +902,106 @@ yang_stats_global(uint64_t *nr)
     return 0;
 }
 
+/* YANG load profile per phase, see CLICON_YANG_PROFILE */
+struct yang_profile_entry{
+    uint64_t yp_calls;   /* Number of times phase was run */
+    uint64_t yp_usec;    /* Total time in microseconds */
+    uint64_t yp_nr;      /* Number of YANG statements after last run */
+    long     yp_maxrss;  /* Max resident set size in KB after last run */
+};
+
+static int                       _yang_profile_enable = 0;
+static struct yang_profile_entry _yang_profile[YANG_PROF_MAX] = {{0,},};
+static const char               *_yang_profile_names[YANG_PROF_MAX] = {
+    "parse", "expand", "augment", "post", "autocli", "bind"
+};
+
+/*! Enable or disable YANG load profile
+ *
+ * @param[in]  enable  0: disable, 1: enable
+ * @retval     0       OK
+ * @see CLICON_YANG_PROFILE
+ */
+int
+yang_profile_set(int enable)
+{
+    _yang_profile_enable = enable;
+    return 0;
+}
+
+/*! Start timing a YANG load phase
+ *
+ * @param[out] tv  Start time, cleared if profile is disabled
+ * @see yang_profile_stop
+ */
+void
+yang_profile_start(struct timeval *tv)
+{
+    if (_yang_profile_enable)
+        gettimeofday(tv, NULL);
+    else
+        timerclear(tv);
+}
+
+/*! Stop timing a YANG load phase and add to its profile
+ *
+ * Also record number of YANG statements and max resident set size
+ * @param[in]  phase  YANG load phase
+ * @param[in]  tv0    Start time from yang_profile_start
+ */
+void
+yang_profile_stop(enum yang_profile_phase phase,
+                  struct timeval         *tv0)
+{
+    struct yang_profile_entry *yp;
+    struct timeval             tv;
+    struct rusage              ru;
+
+    if (!_yang_profile_enable || !timerisset(tv0) || phase >= YANG_PROF_MAX)
+        return;
+    gettimeofday(&tv, NULL);
+    timersub(&tv, tv0, &tv);
+    yp = &_yang_profile[phase];
+    yp->yp_calls++;
+    yp->yp_usec += tv.tv_sec*1000000 + tv.tv_usec;
+    yp->yp_nr = _stats_yang_nr;
+    if (getrusage(RUSAGE_SELF, &ru) == 0)
+        yp->yp_maxrss = ru.ru_maxrss;
+}
+
+/*! Log YANG load profile, one line per phase
+ *
+ * @param[in]  h      Clixon handle
+ * @param[in]  yspec  Yang spec whose total memory is logged, or NULL
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+int
+yang_profile_log(clixon_handle h,
+                 yang_stmt    *yspec)
+{
+    struct yang_profile_entry *yp;
+    uint64_t                   nr = 0;
+    size_t                     sz = 0;
+    int                        i;
+
+    if (!_yang_profile_enable)
+        return 0;
+    for (i=0; i<YANG_PROF_MAX; i++){
+        yp = &_yang_profile[i];
+        if (yp->yp_calls == 0)
+            continue;
+        clixon_log(h, LOG_NOTICE, "YANG profile %s: calls:%" PRIu64 " usec:%" PRIu64 " statements:%" PRIu64 " maxrss:%ldKB",
+                   _yang_profile_names[i], yp->yp_calls, yp->yp_usec, yp->yp_nr, yp->yp_maxrss);
+    }
+    if (yspec){
+        if (yang_stats(yspec, 0, &nr, &sz) < 0)
+            return -1;
+        clixon_log(h, LOG_NOTICE, "YANG profile total: statements:%" PRIu64 " size:%zu", nr, sz);
+    }
+    return 0;
+}
+
 /*! Return the alloced memory of a single YANG obj
  *
  * @param[in]   y    YANG object
@@ -805,12 +1016,21 @@ yang_stats_one(yang_stmt *ys,
     size_t           sz = 0;
     yang_type_cache *yc;
 
-    sz += sizeof(struct yang_stmt);
+#ifdef YANG_COMPACT
+    if (ys_compact(ys))
+        sz += YANG_COMPACT_SIZE;
+    else
+#endif
+        sz += sizeof(struct yang_stmt);
     sz += ys->ys_len*sizeof(struct yang_stmt*);
-    if (ys->ys_argument)
+    if (ys->ys_argument
+#ifdef YANG_PARSE_CACHE_SHARED
+        && !yang_parse_cache_shared(ys->ys_argument) /* Not private */
+#endif
+        )
         sz += strlen(ys->ys_argument) + 1;
-    if (ys->ys_cvec)
-        sz += cvec_size(ys->ys_cvec);
+    if (yang_cvec_get(ys))
+        sz += cvec_size(yang_cvec_get(ys));
     switch (ys->ys_keyword) {
     case Y_TYPE:
         if ((yc = yang_typecache_get(ys)) != NULL){
@@ -868,6 +1088,10 @@ yang_stats(yang_stmt    *yt,
     }
     inext = 0;
     while ((ys = yn_iter(yt, &inext)) != NULL) {
+#ifdef YANG_USES_SHARED
+        if (yang_parent_get(ys) != yt) /* Shared, counted in original */
+            continue;
+#endif
         sz = 0;
         yang_stats(ys, keyw, nrp, &sz);
         if (szp)
@@ -1000,6 +1224,10 @@ ys_new_sz(enum rfc_6020 keyw,
 yang_stmt *
 ys_new(enum rfc_6020 keyw)
 {
+#ifdef YANG_COMPACT
+    if (ys_compact_keyword(keyw))
+        return ys_new_sz(keyw, YANG_COMPACT_SIZE);
+#endif
     return ys_new_sz(keyw, sizeof(struct yang_stmt));
 }
 
@@ -1019,6 +1247,19 @@ ys_free1(yang_stmt *ys,
     cg_var         *cv;
     cvec           *cvv;
 
+    if (ys->ys_argument){
+#ifdef YANG_PARSE_CACHE_SHARED
+        if (!yang_parse_cache_shared(ys->ys_argument))
+#endif
+            free(ys->ys_argument);
+        ys->ys_argument = NULL;
+    }
+    if (ys->ys_stmt)
+        free(ys->ys_stmt);
+#ifdef YANG_COMPACT
+    if (ys_compact(ys)) /* No fields below */
+        goto self;
+#endif
     if ((cv = ys->ys_cv) != NULL){
         ys->ys_cv = NULL;
         cv_free(cv);
@@ -1027,12 +1268,12 @@ ys_free1(yang_stmt *ys,
         ys->ys_cvec = NULL;
         cvec_free(cvv);
     }
-    if (ys->ys_argument){
-        free(ys->ys_argument);
-        ys->ys_argument = NULL;
+#ifdef YANG_CHILD_INDEX
+    if (ys->ys_index){
+        free(ys->ys_index);
+        ys->ys_index = NULL;
     }
-    if (ys->ys_stmt)
-        free(ys->ys_stmt);
+#endif
     switch (ys->ys_keyword) {     /* type-specifi union fields */
     case Y_ACTION:
         while((rc = ys->ys_action_cb) != NULL) {
@@ -1050,6 +1291,25 @@ ys_free1(yang_stmt *ys,
             ys->ys_typecache = NULL;
         }
         break;
+#ifdef YANG_TYPE_VALIDATOR
+    case Y_LEAF:
+    case Y_LEAF_LIST:
+        if (ys->ys_validator){
+            yang_validator_free(ys->ys_validator);
+            ys->ys_validator = NULL;
+        }
+        break;
+#endif
+#ifdef YANG_IDENTITY_BITSET
+    case Y_IDENTITY:
+        if (ys->ys_identity){
+            if (ys->ys_identity->yi_derived)
+                free(ys->ys_identity->yi_derived);
+            free(ys->ys_identity);
+            ys->ys_identity = NULL;
+        }
+        break;
+#endif
     case Y_MODULE:
     case Y_SUBMODULE:
         if (ys->ys_filename)
@@ -1061,15 +1321,38 @@ ys_free1(yang_stmt *ys,
             xml_free(ys->ys_nopres_cache);
         break;
 #endif
-#ifdef OPTIMIZE_YSPEC_NAMESPACE
+#ifdef YANG_DEFAULT_TEMPLATE
+    case Y_CONTAINER:
+    case Y_LIST:
+    case Y_CASE:
+    case Y_INPUT:
+    case Y_OUTPUT:
+        if (ys->ys_defaults){
+            xml_default_template_free(ys->ys_defaults);
+            ys->ys_defaults = NULL;
+        }
+        break;
+#endif
     case Y_SPEC:
-        if (ys->ys_nscache)
-            free(ys->ys_nscache);
+        yspec_nscache_clear(ys);
+        api_path_cache_flush(ys);
+        break;
+#ifdef YANG_SCHEMA_MOUNT_INDEX
+    case Y_MOUNTS:
+        if (ys->ys_mntindex){
+            clicon_hash_free(ys->ys_mntindex);
+            ys->ys_mntindex = NULL;
+        }
         break;
 #endif
     default:
         break;
     }
+    if (ys->ys_keyword == Y_SPEC)
+        yang_lazy_rm(ys);
+#ifdef YANG_COMPACT
+ self:
+#endif
     if (self){
         free(ys);
         _stats_yang_nr--;
@@ -1105,10 +1388,44 @@ ys_prune(yang_stmt *yp,
     }
     yp->ys_len--;
     yp->ys_stmt[yp->ys_len] = NULL;
+#ifdef YANG_CHILD_INDEX
+    yang_child_index_clear(yp);
+#endif
+    if (yp->ys_keyword == Y_SPEC){       /* Clear module and api-path caches */
+        yspec_nscache_clear(yp);
+        api_path_cache_flush(yp);
+    }
  done:
     return yc;
 }
 
+/*! Remove yang node from a given parent (dont free)
+ *
+ * Same as ys_prune_self but the parent is given, it may differ from the parent pointer
+ * of a shared sub-statement, see YANG_USES_SHARED
+ * @param[in]  yp   Yang parent node
+ * @param[in]  ys   Yang node to remove
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+ys_prune_child(yang_stmt *yp,
+               yang_stmt *ys)
+{
+    yang_stmt *yc;
+    int        inext;
+
+    inext = 0;
+    /* Find order of ys in child-list */
+    while ((yc = yn_iter(yp, &inext)) != NULL) {
+        if (ys == yc)
+            break;
+    }
+    if (yc != NULL)
+        ys_prune(yp, inext-1);
+    return 0;
+}
+
 /*! Remove yang node from parent (dont free)
  *
  * @param[in]  ys   Yang node to remove
@@ -1162,6 +1479,9 @@ ys_freechildren(yang_stmt *ys)
         free(ys->ys_stmt);
         ys->ys_stmt = NULL;
     }
+#ifdef YANG_CHILD_INDEX
+    yang_child_index_clear(ys);
+#endif
     return 0;
 }
 
@@ -1197,11 +1517,13 @@ yn_realloc(yang_stmt *yn)
         return -1;
     }
     yn->ys_stmt[yn->ys_len - 1] = NULL; /* init field */
-#ifdef OPTIMIZE_YSPEC_NAMESPACE
-    if (yn->ys_keyword == Y_SPEC && yn->ys_nscache){         /* Clear cache */
+#ifdef YANG_CHILD_INDEX
+    yang_child_index_clear(yn);
+#endif
+    if (yn->ys_keyword == Y_SPEC){       /* Clear module and api-path caches */
         yspec_nscache_clear(yn);
+        api_path_cache_flush(yn);
     }
-#endif
     return 0;
 }
 
@@ -1262,6 +1584,25 @@ uses_orig_ptr(enum rfc_6020 keyword)
         ;
 }
 
+#ifdef YANG_USES_SHARED
+/*! Sub-statements that are shared instead of copied in uses and augment expansion
+ *
+ * These are not modified after expansion, except by refine and deviations which replace
+ * them in the target node.
+ * @see YANG_USES_SHARED
+ */
+static int
+uses_shared(enum rfc_6020 keyword)
+{
+    return
+        keyword == Y_DESCRIPTION
+        || keyword == Y_REFERENCE
+        || keyword == Y_MUST
+        || keyword == Y_TYPE
+        ;
+}
+#endif /* YANG_USES_SHARED */
+
 /*! Copy single yang statement no children
  *
  * @param[in] ynew  New empty (but created) yang statement (to)
@@ -1284,10 +1625,19 @@ ys_cp_one(yang_stmt *ynew,
     cg_var *cvn;
     cg_var *cvo;
     size_t  sz;
+#ifdef YANG_IDENTITY_BITSET
+    yang_identity *yi;
+#endif
 
-    sz = sizeof(*yold);
+#ifdef YANG_COMPACT
+    if (ys_compact(yold))
+        sz = YANG_COMPACT_SIZE;
+    else
+#endif
+        sz = sizeof(*yold);
     memcpy(ynew, yold, sz);
     ynew->ys_parent = NULL;
+    ynew->ys_ref = 0;
     if (yold->ys_stmt)
         if ((ynew->ys_stmt = calloc(yold->ys_len, sizeof(yang_stmt *))) == NULL){
             clixon_err(OE_YANG, errno, "calloc");
@@ -1298,6 +1648,13 @@ ys_cp_one(yang_stmt *ynew,
             clixon_err(OE_YANG, errno, "strdup");
             goto done;
         }
+#ifdef YANG_COMPACT
+    if (ys_compact(yold))
+        goto ok;
+#endif
+#ifdef YANG_CHILD_INDEX
+    ynew->ys_index = NULL;
+#endif
     if ((cvo = yold->ys_cv) != NULL){ // Note direct access to avoid wrappings
         yang_cv_set(ynew, NULL);
         if ((cvn = cv_dup(cvo)) == NULL){
@@ -1319,19 +1676,56 @@ ys_cp_one(yang_stmt *ynew,
         if (yang_typecache_get(yold)) /* Dont copy type cache, use only original */
             yang_typecache_set(ynew, NULL);
         break;
+#ifdef YANG_TYPE_VALIDATOR
+    case Y_LEAF:
+    case Y_LEAF_LIST:
+        ynew->ys_validator = NULL; /* Compiled on first use */
+        break;
+#endif
+#ifdef YANG_IDENTITY_BITSET
+    case Y_IDENTITY:
+        ynew->ys_identity = NULL;
+        if ((yi = yold->ys_identity) != NULL){
+            if ((ynew->ys_identity = malloc(sizeof(*yi))) == NULL){
+                clixon_err(OE_YANG, errno, "malloc");
+                goto done;
+            }
+            memcpy(ynew->ys_identity, yi, sizeof(*yi));
+            ynew->ys_identity->yi_derived = NULL;
+            if (yi->yi_derived){
+                if ((ynew->ys_identity->yi_derived = malloc(yi->yi_words*sizeof(uint64_t))) == NULL){
+                    ynew->ys_identity->yi_words = 0;
+                    clixon_err(OE_YANG, errno, "malloc");
+                    goto done;
+                }
+                memcpy(ynew->ys_identity->yi_derived, yi->yi_derived, yi->yi_words*sizeof(uint64_t));
+            }
+        }
+        break;
+#endif
 #ifdef OPTIMIZE_NO_PRESENCE_CONTAINER
     case Y_CONTAINER:
         yold->ys_nopres_cache = NULL;
         break;
 #endif
-#ifdef OPTIMIZE_YSPEC_NAMESPACE
-    case Y_SPEC:
-        yold->ys_nscache = NULL;
+#ifdef YANG_DEFAULT_TEMPLATE
+    case Y_CONTAINER:
+    case Y_LIST:
+    case Y_CASE:
+    case Y_INPUT:
+    case Y_OUTPUT:
+        ynew->ys_defaults = NULL; /* Computed on first use */
         break;
 #endif
+    case Y_SPEC:
+        ynew->ys_nscache = NULL; /* Built on first use */
+        break;
     default:
         break;
     }
+#ifdef YANG_COMPACT
+ ok:
+#endif
     if (yang_flag_get(ynew, YANG_FLAG_WHEN) != 0x0)
         yang_when_set(NULL, ynew, yang_when_get(NULL, yold));
     if (yang_flag_get(yold, YANG_FLAG_MYMODULE) != 0x0)
@@ -1378,6 +1772,16 @@ ys_cp(yang_stmt *ynew,
             ynew->ys_len--;
             continue;
         }
+#ifdef YANG_USES_SHARED
+        /* 4: share immutable sub-objects, parent remains the original */
+        if (mini &&
+            uses_shared(yang_keyword_get(yco)) &&
+            yang_ref_get(yco) < UINT8_MAX){
+            yang_ref_inc(yco);
+            ynew->ys_stmt[j++] = yco;
+            continue;
+        }
+#endif
         if ((ycn = ys_dup(yco, orig, mini)) == NULL)
             goto done;
          ynew->ys_stmt[j++] = ycn;
@@ -1396,6 +1800,7 @@ ys_cp(yang_stmt *ynew,
  * 1) mini: Allocate a reduced object: yang_stmt_mini and set YANG_FLAG_MINI flag
  * 2) orig: Set back pointer to original object
  * 3) orig: Skip some sub-objects as given by uses_orig_ptr()
+ * 4) mini: Share some sub-objects as given by uses_shared(), see YANG_USES_SHARED
  * @param[in] old   Old existing yang statement (from)
  * @param[in] orig  Set an orig pointer from the new object to the existing, see CLICON_YANG_USE_ORIGINAL
  * @param[in] mini  Create a reduced yang object relying on the orig-pointer
@@ -1448,6 +1853,9 @@ ys_replace(yang_stmt *yorig,
     yang_stmt *yp; /* parent */
 
     yp = yang_parent_get(yorig);
+#ifdef YANG_CHILD_INDEX
+    yang_child_index_clear(yp); /* Argument may change */
+#endif
     /* Remove old yangs all children */
     ys_freechildren(yorig);
     ys_free1(yorig, 0); /* Remove all in yold except the actual object */
@@ -1527,6 +1935,246 @@ yn_iter(yang_stmt *yparent,
     return yc;
 }
 
+#ifdef YANG_CHILD_INDEX
+/* Min number of data-node children for building a child index */
+#define YANG_CHILD_INDEX_MIN 8
+
+/*! Entry in data-node child index
+ */
+struct yang_index_entry{
+    const char *yie_name;   /* Argument of data node */
+    yang_stmt  *yie_ys;     /* Data node */
+    uint32_t    yie_order;  /* Order in yang_find_datanode search, first of same name wins */
+};
+
+/*! Sorted index of data-node children, see YANG_CHILD_INDEX
+ */
+struct yang_index{
+    uint32_t                yx_len;
+    struct yang_index_entry yx_vec[];  /* Sorted on yie_name, unique */
+};
+
+/*! Add data node to child index vector
+ *
+ * @param[in]     ys     Yang data node
+ * @param[in,out] vec    Entry vector
+ * @param[in,out] len    Number of entries
+ * @param[in,out] alloc  Allocated entries
+ * @retval        0      OK
+ * @retval       -1      Error
+ */
+static int
+yang_child_index_add(yang_stmt                *ys,
+                     struct yang_index_entry **vec,
+                     uint32_t                 *len,
+                     uint32_t                 *alloc)
+{
+    struct yang_index_entry *v;
+
+    if (ys->ys_argument == NULL)
+        return 0;
+    if (*len == *alloc){
+        *alloc = *alloc ? 2 * *alloc : 16;
+        if ((v = realloc(*vec, *alloc*sizeof(*v))) == NULL){
+            clixon_err(OE_UNIX, errno, "realloc");
+            return -1;
+        }
+        *vec = v;
+    }
+    v = &(*vec)[*len];
+    v->yie_name = ys->ys_argument;
+    v->yie_ys = ys;
+    v->yie_order = *len;
+    (*len)++;
+    return 0;
+}
+
+/*! Collect data-node children in the same order as yang_find_datanode_ns searches them
+ *
+ * Submodules of modules are not included, they are searched after a miss
+ * @param[in]     yn     Yang node
+ * @param[in,out] vec    Entry vector
+ * @param[in,out] len    Number of entries
+ * @param[in,out] alloc  Allocated entries
+ * @retval        0      OK
+ * @retval       -1      Error
+ */
+static int
+yang_child_index_collect(yang_stmt                *yn,
+                         struct yang_index_entry **vec,
+                         uint32_t                 *len,
+                         uint32_t                 *alloc)
+{
+    yang_stmt *ys;
+    yang_stmt *yc;
+    int        i;
+    int        j;
+
+    for (i=0; i<yn->ys_len; i++){
+        ys = yn->ys_stmt[i];
+        if (ys->ys_keyword == Y_CHOICE){ /* Look for its children */
+            for (j=0; j<ys->ys_len; j++){
+                yc = ys->ys_stmt[j];
+                if (yc->ys_keyword == Y_CASE){
+                    if (yang_child_index_collect(yc, vec, len, alloc) < 0)
+                        return -1;
+                }
+                else if (yang_datanode(yc)){
+                    if (yang_child_index_add(yc, vec, len, alloc) < 0)
+                        return -1;
+                }
+            }
+        }
+        else if (ys->ys_keyword == Y_INPUT || ys->ys_keyword == Y_OUTPUT){
+            if (yang_child_index_collect(ys, vec, len, alloc) < 0)
+                return -1;
+        }
+        else if (yang_datanode(ys)){
+            if (yang_child_index_add(ys, vec, len, alloc) < 0)
+                return -1;
+        }
+    }
+    return 0;
+}
+
+/*! Sort child index entries on name, and on search order within same name
+ */
+static int
+yang_child_index_cmp(const void *a,
+                     const void *b)
+{
+    const struct yang_index_entry *ea = a;
+    const struct yang_index_entry *eb = b;
+    int                            eq;
+
+    if ((eq = strcmp(ea->yie_name, eb->yie_name)) != 0)
+        return eq;
+    return ea->yie_order < eb->yie_order ? -1 : ea->yie_order > eb->yie_order;
+}
+
+/*! Build data-node child index of a yang node, if it has many data-node children
+ *
+ * Can be used as yang_apply callback. Existing indexes are kept.
+ * @param[in]  ys   Yang node
+ * @param[in]  arg  Not used
+ * @retval     2    OK, do not descend (leaf or leaf-list)
+ * @retval     0    OK
+ * @retval    -1    Error
+ * @see yang_child_index_clear
+ */
+int
+yang_child_index_build(yang_stmt *ys,
+                       void      *arg)
+{
+    int                      retval = -1;
+    struct yang_index_entry *vec = NULL;
+    struct yang_index       *yx;
+    uint32_t                 len = 0;
+    uint32_t                 alloc = 0;
+    uint32_t                 i;
+    uint32_t                 j;
+
+    switch (ys->ys_keyword){
+    case Y_LEAF:
+    case Y_LEAF_LIST:
+        return 2;
+    case Y_CHOICE: /* Flattened into parent */
+        return 0;
+    default:
+        break;
+    }
+#ifdef YANG_COMPACT
+    if (ys_compact(ys))
+        return 0;
+#endif
+    if (ys->ys_index != NULL || ys->ys_len == 0)
+        return 0;
+    if (yang_child_index_collect(ys, &vec, &len, &alloc) < 0)
+        goto done;
+    if (len < YANG_CHILD_INDEX_MIN)
+        goto ok;
+    qsort(vec, len, sizeof(*vec), yang_child_index_cmp);
+    for (i=1, j=1; i<len; i++){ /* Keep first of each name */
+        if (strcmp(vec[i].yie_name, vec[j-1].yie_name) != 0)
+            vec[j++] = vec[i];
+    }
+    if ((yx = malloc(sizeof(*yx) + j*sizeof(*vec))) == NULL){
+        clixon_err(OE_UNIX, errno, "malloc");
+        goto done;
+    }
+    yx->yx_len = j;
+    memcpy(yx->yx_vec, vec, j*sizeof(*vec));
+    ys->ys_index = yx;
+ ok:
+    retval = 0;
+ done:
+    if (vec)
+        free(vec);
+    return retval;
+}
+
+/*! Clear data-node child index of a yang node whose children are changed
+ *
+ * Also clear indexes of ancestors which flatten this node (choice, case, input, output)
+ * @param[in]  ys   Yang node
+ * @retval     0    OK
+ */
+int
+yang_child_index_clear(yang_stmt *ys)
+{
+    while (ys != NULL){
+        if (
+#ifdef YANG_COMPACT
+            !ys_compact(ys) &&
+#endif
+            ys->ys_index){
+            free(ys->ys_index);
+            ys->ys_index = NULL;
+        }
+        switch (ys->ys_keyword){
+        case Y_CHOICE:
+        case Y_CASE:
+        case Y_INPUT:
+        case Y_OUTPUT:
+            ys = ys->ys_parent;
+            break;
+        default:
+            ys = NULL;
+            break;
+        }
+    }
+    return 0;
+}
+
+/*! Find data-node child by name using child index
+ *
+ * @param[in]  yx    Child index
+ * @param[in]  name  Argument of data node
+ * @retval     ys    First data node with that name in yang_find_datanode order
+ * @retval     NULL  Not found
+ */
+static yang_stmt *
+yang_child_index_find(struct yang_index *yx,
+                      const char        *name)
+{
+    int lo = 0;
+    int hi = yx->yx_len - 1;
+    int mid;
+    int eq;
+
+    while (lo <= hi){
+        mid = (lo + hi)/2;
+        if ((eq = strcmp(name, yx->yx_vec[mid].yie_name)) == 0)
+            return yx->yx_vec[mid].yie_ys;
+        if (eq < 0)
+            hi = mid - 1;
+        else
+            lo = mid + 1;
+    }
+    return NULL;
+}
+#endif /* YANG_CHILD_INDEX */
+
 /*! Find first child yang_stmt with matching keyword and argument
  *
  * Find child given keyword and argument.
@@ -1646,6 +2294,22 @@ yang_find_datanode_ns(yang_stmt  *yn,
     int        inext2;
     char      *arg;
 
+#ifdef YANG_CHILD_INDEX
+    if (argument != NULL &&
+#ifdef YANG_COMPACT
+        !ys_compact(yn) &&
+#endif
+        yn->ys_index != NULL){
+        if ((ys = yang_child_index_find(yn->ys_index, argument)) == NULL)
+            goto submodules;
+        if (namespace == NULL ||
+            ((ns = yang_find_mynamespace(ys)) != NULL && strcmp(namespace, ns) == 0)){
+            ysmatch = ys;
+            goto done;
+        }
+        /* First of that name is in other namespace: search all */
+    }
+#endif
     inext = 0;
     while ((ys = yn_iter(yn, &inext)) != NULL){
         if (yang_keyword_get(ys) == Y_CHOICE){ /* Look for its children */
@@ -1683,6 +2347,9 @@ yang_find_datanode_ns(yang_stmt  *yn,
                 goto done; // maybe break?
         }
     }
+#ifdef YANG_CHILD_INDEX
+ submodules:
+#endif
     /* Special case: if not match and yang node is module or submodule, extend
      * search to include submodules */
     if (ysmatch == NULL &&
@@ -2763,7 +3430,7 @@ yang_deviation(yang_stmt *ys,
                     }
                 }
                 /* Make a copy of deviate child and insert. */
-                if ((yc1 = ys_dup(yc, clicon_option_bool(h, "CLICON_YANG_USE_ORIGINAL"), 1)) == NULL)
+                if ((yc1 = ys_dup(yc, clicon_option_bool_id(h, CO_YANG_USE_ORIGINAL), 1)) == NULL)
                     goto done;
                 /* Special case: resolve types in temporary old deviation context */
                 if (yn_insert(yd, yc1) < 0)
@@ -2802,13 +3469,13 @@ yang_deviation(yang_stmt *ys,
                     ;
                 else {
                     /* Remove old */
-                    if (ys_prune_self(ytc) < 0)
+                    if (ys_prune_child(ytarget, ytc) < 0)
                         goto done;
                     if (ys_free(ytc) < 0)
                         goto done;
                 }
                 /* Make a copy of deviate child and insert. */
-                if ((yc1 = ys_dup(yc, clicon_option_bool(h, "CLICON_YANG_USE_ORIGINAL"), 1)) == NULL)
+                if ((yc1 = ys_dup(yc, clicon_option_bool_id(h, CO_YANG_USE_ORIGINAL), 1)) == NULL)
                     goto done;
                 /* Special case: resolve types in temporary old deviation context */
                 if (yn_insert(yd, yc1) < 0)
@@ -2838,7 +3505,7 @@ yang_deviation(yang_stmt *ys,
                                yang_argument_get(ytarget));
                     goto done;
                 }
-                if (ys_prune_self(ytc) < 0)
+                if (ys_prune_child(ytarget, ytc) < 0)
                     goto done;
                 if (ys_free(ytc) < 0)
                     goto done;
@@ -2897,7 +3564,10 @@ ys_populate_leaf1(clixon_handle h,
                 goto done;
             }
             snprintf(new, sz, "%s:%s", prefix1, id);
-            free(defarg);
+#ifdef YANG_PARSE_CACHE_SHARED
+            if (!yang_parse_cache_shared(defarg))
+#endif
+                free(defarg);
             yang_argument_set(ydef, new);
         }
     }
@@ -3303,6 +3973,150 @@ ys_populate_type(clixon_handle h,
     return retval;
 }
 
+#ifdef YANG_IDENTITY_BITSET
+/*! Get dense number of an identity given its canonical name
+ *
+ * @param[in]  idref   Identity on the form <module>:<id>
+ * @param[in]  create  If set, assign a new number if not found
+ * @param[out] nr      Identity number
+ * @retval     1       Found or created
+ * @retval     0       Not found
+ * @retval    -1       Error
+ */
+static int
+yang_identity_index(const char *idref,
+                    int         create,
+                    uint32_t   *nr)
+{
+    void *vp;
+
+    if (_yang_identity_index == NULL){
+        if (!create)
+            return 0;
+        if ((_yang_identity_index = clicon_hash_init()) == NULL)
+            return -1;
+    }
+    if ((vp = clicon_hash_value(_yang_identity_index, idref, NULL)) != NULL){
+        memcpy(nr, vp, sizeof(*nr));
+        return 1;
+    }
+    if (!create)
+        return 0;
+    *nr = _yang_identity_nr;
+    if (clicon_hash_add(_yang_identity_index, idref, nr, sizeof(*nr)) == NULL)
+        return -1;
+    _yang_identity_nr++;
+    return 1;
+}
+
+/*! Get identity number and derived bitset of identity statement, create if not exists
+ *
+ * @param[in]  ys     Yang identity statement
+ * @retval     yi     Identity struct
+ * @retval     NULL   Error
+ */
+static yang_identity *
+yang_identity_get(yang_stmt *ys)
+{
+    yang_identity *yi = NULL;
+    yang_stmt     *ymod;
+    char          *id = NULL;
+    cbuf          *cb = NULL;
+
+    if (ys->ys_identity != NULL)
+        return ys->ys_identity;
+    if ((ymod = ys_module(ys)) == NULL){
+        clixon_err(OE_YANG, ENOENT, "No module found");
+        goto done;
+    }
+    if (nodeid_split(yang_argument_get(ys), NULL, &id) < 0)
+        goto done;
+    if ((cb = cbuf_new()) == NULL){
+        clixon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    cprintf(cb, "%s:%s", yang_argument_get(ymod), id);
+    if ((yi = calloc(1, sizeof(*yi))) == NULL){
+        clixon_err(OE_YANG, errno, "calloc");
+        goto done;
+    }
+    if (yang_identity_index(cbuf_get(cb), 1, &yi->yi_nr) < 0){
+        free(yi);
+        yi = NULL;
+        goto done;
+    }
+    ys->ys_identity = yi;
+ done:
+    if (id)
+        free(id);
+    if (cb)
+        cbuf_free(cb);
+    return yi;
+}
+
+/*! Mark identity as derived from base identity in its bitset
+ *
+ * @param[in]  ybaseid  Base identity
+ * @param[in]  idref    Derived identity on the form <module>:<id>
+ * @retval     0        OK
+ * @retval    -1        Error
+ */
+static int
+yang_identity_derived_add(yang_stmt  *ybaseid,
+                          const char *idref)
+{
+    yang_identity *yi;
+    uint32_t       nr;
+    uint32_t       words;
+    uint64_t      *vec;
+
+    if ((yi = yang_identity_get(ybaseid)) == NULL)
+        return -1;
+    if (yang_identity_index(idref, 1, &nr) < 0)
+        return -1;
+    if (nr/64 >= yi->yi_words){
+        words = nr/64 + 1;
+        if ((vec = realloc(yi->yi_derived, words*sizeof(uint64_t))) == NULL){
+            clixon_err(OE_YANG, errno, "realloc");
+            return -1;
+        }
+        memset(&vec[yi->yi_words], 0, (words - yi->yi_words)*sizeof(uint64_t));
+        yi->yi_derived = vec;
+        yi->yi_words = words;
+    }
+    yi->yi_derived[nr/64] |= (uint64_t)1 << (nr%64);
+    return 0;
+}
+#endif /* YANG_IDENTITY_BITSET */
+
+/*! Check if an identity is derived from a base identity
+ *
+ * @param[in]  ybaseid  Base identity
+ * @param[in]  idref    Identity on the form <module>:<id>
+ * @retval     1        idref is derived from ybaseid
+ * @retval     0        idref is not derived from ybaseid
+ * @see ys_populate_identity  where derived identities are registered
+ */
+int
+yang_identity_derived(yang_stmt  *ybaseid,
+                      const char *idref)
+{
+#ifdef YANG_IDENTITY_BITSET
+    yang_identity *yi;
+    uint32_t       nr;
+
+    if ((yi = ybaseid->ys_identity) == NULL || yi->yi_derived == NULL)
+        return 0;
+    if (yang_identity_index(idref, 0, &nr) != 1)
+        return 0;
+    if (nr/64 >= yi->yi_words)
+        return 0;
+    return (yi->yi_derived[nr/64] & ((uint64_t)1 << (nr%64))) != 0;
+#else
+    return cvec_find(yang_cvec_get(ybaseid), idref) != NULL;
+#endif
+}
+
 /*! Sanity check yang identity statement recursively and create derived id list
  *
  * Find base identities if any and add this identity to derived identity list.
@@ -3329,7 +4143,6 @@ ys_populate_identity(clixon_handle h,
     char           *id = NULL;
     cbuf           *cb = NULL;
     yang_stmt      *ymod;
-    cvec           *idrefvec; /* Derived identityref list: (module:id)**/
     int             inext;
 
     /* Top-call (no recursion) create idref
@@ -3349,6 +4162,10 @@ ys_populate_identity(clixon_handle h,
         }
         cprintf(cb, "%s:%s", yang_argument_get(ymod), id);
         idref = cbuf_get(cb);
+#ifdef YANG_IDENTITY_BITSET
+        if (yang_identity_get(ys) == NULL)
+            goto done;
+#endif
     }
     /* Iterate through all base statements and check the base identity exists
      * AND populate the base identity recursively
@@ -3366,14 +4183,17 @@ ys_populate_identity(clixon_handle h,
         /* Check if derived id is already in base identifier
          * note that cvec is always created in ys_new()
          */
-        idrefvec = yang_cvec_get(ybaseid);
-        if (cvec_find(idrefvec, idref) != NULL)
+        if (yang_identity_derived(ybaseid, idref))
             continue;
         /* Add derived id to ybaseid */
         if (yang_cvec_add(ybaseid, CGV_STRING, idref) == NULL){
             clixon_err(OE_UNIX, errno, "cv_new");
             goto done;
         }
+#ifdef YANG_IDENTITY_BITSET
+        if (yang_identity_derived_add(ybaseid, idref) < 0)
+            goto done;
+#endif
         /* Transitive to the root */
         if (ys_populate_identity(h, ybaseid, idref) < 0)
             goto done;
@@ -3831,6 +4651,9 @@ yang_features(clixon_handle h,
                         yt->ys_stmt[j-1] = yt->ys_stmt[j];
                     yt->ys_len--;
                     yt->ys_stmt[yt->ys_len] = NULL;
+#ifdef YANG_CHILD_INDEX
+                    yang_child_index_clear(yt);
+#endif
                     ys_free(ys);
                     continue; /* Don't increment i */
                     break;
@@ -4443,36 +5266,16 @@ static int
 yang_type_cache_free(yang_type_cache *ycache)
 {
     cg_var *cv;
-    void   *p;
 
     if (ycache->yc_cvv)
         cvec_free(ycache->yc_cvv);
     if (ycache->yc_patterns)
         cvec_free(ycache->yc_patterns);
     if (ycache->yc_regexps){
+        /* Compiled regexps are owned by the regex cache, see regex_cache_compile */
         cv = NULL;
-        while ((cv = cvec_each(ycache->yc_regexps, cv)) != NULL){
-            /* need to store mode since clixon_handle is not available */
-            switch (ycache->yc_rxmode){
-            case REGEXP_POSIX:
-                cligen_regex_posix_free(cv_void_get(cv));
-                if ((p = cv_void_get(cv)) != NULL){
-                    free(p);
-                    cv_void_set(cv, NULL);
-                }
-                break;
-            case REGEXP_LIBXML2:
-                cligen_regex_libxml2_free(cv_void_get(cv));
-                /* Note, already freed in libxml2 case */
-                if ((p = cv_void_get(cv)) != NULL){
-                    cv_void_set(cv, NULL);
-                }
-                break;
-            default:
-                break;
-            }
-
-        }
+        while ((cv = cvec_each(ycache->yc_regexps, cv)) != NULL)
+            cv_void_set(cv, NULL);
         cvec_free(ycache->yc_regexps);
     }
     free(ycache);
@@ -4795,6 +5598,91 @@ yang_nopresence_cache_set(yang_stmt *ys,
 }
 #endif
 
+#ifdef YANG_DEFAULT_TEMPLATE
+/*! Get default template of yang node
+ *
+ * @param[in]  ys  Yang container, list, case, input or output
+ * @retval     dt  Default template
+ * @retval     NULL Not computed or other keyword
+ * @see xml_default
+ */
+void *
+yang_defaults_get(yang_stmt *ys)
+{
+    switch (ys->ys_keyword){
+    case Y_CONTAINER:
+    case Y_LIST:
+    case Y_CASE:
+    case Y_INPUT:
+    case Y_OUTPUT:
+        return ys->ys_defaults;
+    default:
+        return NULL;
+    }
+}
+
+/*! Set default template of yang node
+ *
+ * @param[in]  ys  Yang container, list, case, input or output
+ * @param[in]  dt  Default template, freed with xml_default_template_free
+ * @retval     0   OK
+ * @retval    -1   Error
+ */
+int
+yang_defaults_set(yang_stmt *ys,
+                  void      *dt)
+{
+    switch (ys->ys_keyword){
+    case Y_CONTAINER:
+    case Y_LIST:
+    case Y_CASE:
+    case Y_INPUT:
+    case Y_OUTPUT:
+        ys->ys_defaults = dt;
+        return 0;
+    default:
+        clixon_err(OE_YANG, EINVAL, "Unexpected keyword %s", yang_key2str(ys->ys_keyword));
+        return -1;
+    }
+}
+#endif /* YANG_DEFAULT_TEMPLATE */
+
+#ifdef YANG_SCHEMA_MOUNT_INDEX
+/*! Get mount-point index of top-level yang mounts node
+ *
+ * @param[in]  ymounts  Top-level yang mounts
+ * @retval     index    Hash of canonical xpath to mounted yspec
+ * @retval     NULL     Not created or other keyword
+ * @see yang_mount_get
+ */
+void *
+yang_mount_index_get(yang_stmt *ymounts)
+{
+    if (ymounts->ys_keyword != Y_MOUNTS)
+        return NULL;
+    return ymounts->ys_mntindex;
+}
+
+/*! Set mount-point index of top-level yang mounts node
+ *
+ * @param[in]  ymounts  Top-level yang mounts
+ * @param[in]  index    Hash of canonical xpath to mounted yspec, freed with ymounts
+ * @retval     0        OK
+ * @retval    -1        Error
+ */
+int
+yang_mount_index_set(yang_stmt *ymounts,
+                     void      *index)
+{
+    if (ymounts->ys_keyword != Y_MOUNTS){
+        clixon_err(OE_YANG, EINVAL, "Unexpected keyword %s", yang_key2str(ymounts->ys_keyword));
+        return -1;
+    }
+    ymounts->ys_mntindex = index;
+    return 0;
+}
+#endif /* YANG_SCHEMA_MOUNT_INDEX */
+
 /*! Init yang code. Called before any yang code, before options
  *
  * Add two external tables for YANGs
@@ -4833,7 +5721,8 @@ yang_init(clixon_handle h)
 int
 yang_start(clixon_handle h)
 {
-    _yang_use_orig = clicon_option_bool(h, "CLICON_YANG_USE_ORIGINAL");
+    _yang_use_orig = clicon_option_bool_id(h, CO_YANG_USE_ORIGINAL);
+    yang_profile_set(clicon_option_bool(h, "CLICON_YANG_PROFILE"));
     return 0;
 }
 
@@ -4854,9 +5743,19 @@ yang_exit(clixon_handle h)
         free(_yang_mymodule_map);
         _yang_mymodule_map = NULL;
     }
+#ifdef YANG_IDENTITY_BITSET
+    if (_yang_identity_index != NULL) {
+        clicon_hash_free(_yang_identity_index);
+        _yang_identity_index = NULL;
+    }
+#endif
     if ((ymounts = clixon_yang_mounts_get(h)) != NULL){
         ys_free(ymounts);
     }
     clixon_yang_mounts_set(h, NULL);
+    yang_lazy_rm(NULL);
+#ifdef YANG_PARSE_CACHE_SHARED
+    yang_parse_cache_exit(); /* After all yang specs are freed */
+#endif
     return 0;
 }
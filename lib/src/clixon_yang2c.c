@@ -0,0 +1,678 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+
+  Copyright (C) 2009-2019 Olof Hagsand
+  Copyright (C) 2020-2022 Olof Hagsand and Rubicon Communications, LLC(Netgate)
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2,
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+
+ *
+ * YANG generate C accessors
+ *   yang_spec                   C header
+ *  +-------------+   yang2c      +----------------+
+ *  |             | ------------> | enum, structs, |
+ *  | list{key A;}|               | get functions  |
+ *  +-------------+               +----------------+
+ *
+ * A header is generated for a YANG module at plugin build time, eg using clixon_backend -G,
+ * and included by plugin code that reads bound XML, such as transaction callbacks.
+ * The header contains:
+ *   - An enum of schema node ids of all data nodes of the module and their absolute
+ *     schema node identifiers. The ids are bound to yang specs once at runtime in an init
+ *     function, after which a child is matched by comparing its yang spec pointer.
+ *   - A struct per module, container and list with one field per child data node: typed
+ *     values for leafs and the first XML child for other nodes.
+ *   - A get function per struct reading all fields in one pass over the XML children.
+ *     Integer, boolean and decimal64 values are read from the cached cligen variable of the
+ *     node (see xml_cv_cache), string-like values are the XML body
+ *   - For C++, accessors indexed with constant expression schema node ids.
+ * Choice and case are transparent, as they are in the XML tree.
+ * Example:
+ *   struct clixon_example_table_parameter s;
+ *   if (clixon_example_table_parameter_get(x, &s) < 0)
+ *      err;
+ *   if (s.value_set)
+ *      printf("%d\n", s.value);
+ */
+#ifdef HAVE_CONFIG_H
+#include "clixon_config.h" /* generated by config & autoconf */
+#endif
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <ctype.h>
+#include <errno.h>
+#include <syslog.h>
+#include <sys/param.h>
+
+/* cligen */
+#include <cligen/cligen.h>
+
+/* clixon */
+#include "clixon_queue.h"
+#include "clixon_hash.h"
+#include "clixon_handle.h"
+#include "clixon_yang.h"
+#include "clixon_xml.h"
+#include "clixon_err.h"
+#include "clixon_log.h"
+#include "clixon_debug.h"
+#include "clixon_yang_type.h"
+#include "clixon_yang2c.h"
+
+/*! Generated data node
+ */
+struct yang2c_node {
+    yang_stmt *yn_ys;      /* Yang data node */
+    char      *yn_name;    /* C identifier relative to module, eg table_parameter */
+    char      *yn_field;   /* Struct field name in parent struct */
+    char      *yn_nodeid;  /* Absolute schema node id, eg /ex:table/ex:parameter */
+    int        yn_parent;  /* Index of parent container or list, -1 if top-level */
+};
+
+/*! Generated code of a leaf type
+ */
+struct yang2c_type {
+    const char *yt_ctype;  /* C type of field */
+    const char *yt_cvget;  /* Cligen variable get function, or NULL if xml body */
+    int         yt_empty;  /* Type is empty, value is 1 if present */
+};
+
+/* C and C++ keywords that cannot be struct field names */
+static const char *yang2c_keywords[] = {
+    "auto", "bool", "break", "case", "catch", "char", "class", "const", "continue",
+    "default", "delete", "do", "double", "else", "enum", "explicit", "export", "extern",
+    "false", "float", "for", "friend", "goto", "if", "inline", "int", "long", "mutable",
+    "namespace", "new", "operator", "private", "protected", "public", "register",
+    "restrict", "return", "short", "signed", "sizeof", "static", "struct", "switch",
+    "template", "this", "throw", "true", "try", "typedef", "typename", "union",
+    "unsigned", "using", "virtual", "void", "volatile", "while",
+    NULL
+};
+
+/*! Translate a YANG identifier to a C identifier, non-alphanumerics are replaced with '_'
+ *
+ * @param[in]  cb     Append C identifier to this buffer
+ * @param[in]  id     YANG identifier
+ * @param[in]  upper  If set, translate to upper-case
+ */
+static void
+yang2c_cid(cbuf       *cb,
+           const char *id,
+           int         upper)
+{
+    const char *s;
+
+    for (s = id; *s; s++){
+        if (isalnum((unsigned char)*s))
+            cprintf(cb, "%c", upper ? toupper((unsigned char)*s) : *s);
+        else
+            cprintf(cb, "_");
+    }
+}
+
+/*! Get C type of a leaf
+ *
+ * @param[in]  ys   Yang leaf
+ * @param[out] yt   Generated code of leaf type
+ * @retval     0    OK
+ * @retval    -1    Error
+ * Leafs of other types than integer, boolean, decimal64 and empty are read as strings
+ */
+static int
+yang2c_type_get(yang_stmt          *ys,
+                struct yang2c_type *yt)
+{
+    int          retval = -1;
+    yang_stmt   *yrestype = NULL;
+    enum cv_type cvtype = CGV_ERR;
+    char        *restype;
+
+    memset(yt, 0, sizeof(*yt));
+    yt->yt_ctype = "char *";
+    if (yang_type_get(ys, NULL, &yrestype, NULL, NULL, NULL, NULL, NULL) < 0)
+        goto done;
+    if (yrestype == NULL)
+        goto ok;
+    restype = yang_argument_get(yrestype);
+    if (strcmp(restype, "empty") == 0){
+        yt->yt_ctype = "int";
+        yt->yt_empty = 1;
+        goto ok;
+    }
+    if (yang2cv_type(restype, &cvtype) < 0)
+        goto done;
+    switch (cvtype){
+    case CGV_INT8:
+        yt->yt_ctype = "int8_t";
+        yt->yt_cvget = "cv_int8_get";
+        break;
+    case CGV_INT16:
+        yt->yt_ctype = "int16_t";
+        yt->yt_cvget = "cv_int16_get";
+        break;
+    case CGV_INT32:
+        yt->yt_ctype = "int32_t";
+        yt->yt_cvget = "cv_int32_get";
+        break;
+    case CGV_INT64:
+        yt->yt_ctype = "int64_t";
+        yt->yt_cvget = "cv_int64_get";
+        break;
+    case CGV_UINT8:
+        yt->yt_ctype = "uint8_t";
+        yt->yt_cvget = "cv_uint8_get";
+        break;
+    case CGV_UINT16:
+        yt->yt_ctype = "uint16_t";
+        yt->yt_cvget = "cv_uint16_get";
+        break;
+    case CGV_UINT32:
+        yt->yt_ctype = "uint32_t";
+        yt->yt_cvget = "cv_uint32_get";
+        break;
+    case CGV_UINT64:
+        yt->yt_ctype = "uint64_t";
+        yt->yt_cvget = "cv_uint64_get";
+        break;
+    case CGV_BOOL:
+        yt->yt_ctype = "int";
+        yt->yt_cvget = "cv_bool_get";
+        break;
+    case CGV_DEC64: /* Integer value, scaled by 10^fraction-digits */
+        yt->yt_ctype = "int64_t";
+        yt->yt_cvget = "cv_dec64_i_get";
+        break;
+    default:
+        break;
+    }
+ ok:
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Free vector of generated nodes
+ */
+static void
+yang2c_nodes_free(struct yang2c_node *nodes,
+                  int                 len)
+{
+    int i;
+
+    for (i=0; i<len; i++){
+        if (nodes[i].yn_name)
+            free(nodes[i].yn_name);
+        if (nodes[i].yn_field)
+            free(nodes[i].yn_field);
+        if (nodes[i].yn_nodeid)
+            free(nodes[i].yn_nodeid);
+    }
+    if (nodes)
+        free(nodes);
+}
+
+/*! Collect data nodes below a yang node in pre-order, choice and case are transparent
+ *
+ * @param[in]     yp      Yang parent: module, container, list, choice or case
+ * @param[in]     parent  Index of parent data node, -1 if top-level
+ * @param[in]     name    C identifier of parent, NULL if top-level
+ * @param[in]     nodeid  Schema node id of parent, "" if top-level
+ * @param[in,out] nodes   Vector of generated nodes
+ * @param[in,out] len     Length of vector
+ * @retval        0       OK
+ * @retval       -1       Error
+ */
+static int
+yang2c_nodes_collect(yang_stmt           *yp,
+                     int                  parent,
+                     const char          *name,
+                     const char          *nodeid,
+                     struct yang2c_node **nodes,
+                     int                 *len)
+{
+    int                 retval = -1;
+    yang_stmt          *yc;
+    int                 inext = 0;
+    enum rfc_6020       keyw;
+    struct yang2c_node *yn;
+    char               *prefix;
+    char               *arg;
+    cbuf               *cb = NULL;
+    const char        **kw;
+    int                 i;
+
+    if ((cb = cbuf_new()) == NULL){
+        clixon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    while ((yc = yn_iter(yp, &inext)) != NULL){
+        keyw = yang_keyword_get(yc);
+        if (keyw == Y_CHOICE || keyw == Y_CASE){
+            if (yang2c_nodes_collect(yc, parent, name, nodeid, nodes, len) < 0)
+                goto done;
+            continue;
+        }
+        if (!yang_datanode(yc))
+            continue;
+        arg = yang_argument_get(yc);
+        if ((prefix = yang_find_myprefix(yc)) == NULL)
+            goto done;
+        if ((*nodes = realloc(*nodes, (*len+1)*sizeof(struct yang2c_node))) == NULL){
+            clixon_err(OE_UNIX, errno, "realloc");
+            goto done;
+        }
+        i = (*len)++;
+        yn = &(*nodes)[i];
+        memset(yn, 0, sizeof(*yn));
+        yn->yn_ys = yc;
+        yn->yn_parent = parent;
+        cbuf_reset(cb);
+        if (name)
+            cprintf(cb, "%s_", name);
+        yang2c_cid(cb, arg, 0);
+        if ((yn->yn_name = strdup(cbuf_get(cb))) == NULL){
+            clixon_err(OE_UNIX, errno, "strdup");
+            goto done;
+        }
+        cbuf_reset(cb);
+        yang2c_cid(cb, arg, 0);
+        for (kw = yang2c_keywords; *kw; kw++)
+            if (strcmp(*kw, cbuf_get(cb)) == 0){
+                cprintf(cb, "_");
+                break;
+            }
+        if ((yn->yn_field = strdup(cbuf_get(cb))) == NULL){
+            clixon_err(OE_UNIX, errno, "strdup");
+            goto done;
+        }
+        cbuf_reset(cb);
+        cprintf(cb, "%s/%s:%s", nodeid, prefix, arg);
+        if ((yn->yn_nodeid = strdup(cbuf_get(cb))) == NULL){
+            clixon_err(OE_UNIX, errno, "strdup");
+            goto done;
+        }
+        if (keyw == Y_CONTAINER || keyw == Y_LIST){
+            /* yn may be moved by realloc, use index */
+            if (yang2c_nodes_collect(yc, i, (*nodes)[i].yn_name, (*nodes)[i].yn_nodeid,
+                                     nodes, len) < 0)
+                goto done;
+        }
+    }
+    retval = 0;
+ done:
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+}
+
+/*! Print struct and get function of a module, container or list
+ *
+ * @param[in]  f       Output file
+ * @param[in]  mname   C identifier of module, lower-case
+ * @param[in]  mupper  C identifier of module, upper-case
+ * @param[in]  nodes   Vector of generated nodes
+ * @param[in]  len     Length of vector
+ * @param[in]  parent  Index of container or list, or -1 for module
+ * @retval     0       OK
+ * @retval    -1       Error
+ */
+static int
+yang2c_struct_print(FILE               *f,
+                    const char         *mname,
+                    const char         *mupper,
+                    struct yang2c_node *nodes,
+                    int                 len,
+                    int                 parent)
+{
+    int                retval = -1;
+    struct yang2c_node *yn;
+    struct yang2c_type yt;
+    cbuf              *sname = NULL;
+    int                i;
+    int                children = 0;
+    int                cv = 0;
+    int                first = 1;
+
+    if ((sname = cbuf_new()) == NULL){
+        clixon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    cprintf(sname, "%s", mname);
+    if (parent != -1)
+        cprintf(sname, "_%s", nodes[parent].yn_name);
+    if (parent == -1)
+        fprintf(f, "/* Top-level data nodes of module */\n");
+    else
+        fprintf(f, "/* %s %s */\n", yang_key2str(yang_keyword_get(nodes[parent].yn_ys)),
+                nodes[parent].yn_nodeid);
+    fprintf(f, "struct %s {\n", cbuf_get(sname));
+    fprintf(f, "    cxobj *x; /* XML node */\n");
+    for (i=0; i<len; i++){
+        yn = &nodes[i];
+        if (yn->yn_parent != parent)
+            continue;
+        children++;
+        if (yang_keyword_get(yn->yn_ys) == Y_LEAF){
+            if (yang2c_type_get(yn->yn_ys, &yt) < 0)
+                goto done;
+            if (yt.yt_cvget)
+                cv++;
+            fprintf(f, "    %s%s%s; /* leaf %s */\n",
+                    yt.yt_ctype, yt.yt_ctype[strlen(yt.yt_ctype)-1]=='*'?"":" ",
+                    yn->yn_field, yang_argument_get(yn->yn_ys));
+            fprintf(f, "    unsigned int %s_set:1;\n", yn->yn_field);
+        }
+        else
+            fprintf(f, "    cxobj *%s; /* First %s %s */\n", yn->yn_field,
+                    yang_key2str(yang_keyword_get(yn->yn_ys)), yang_argument_get(yn->yn_ys));
+    }
+    fprintf(f, "};\n\n");
+    fprintf(f, "/*! Read children of bound XML node into struct %s\n", cbuf_get(sname));
+    fprintf(f, " *\n");
+    fprintf(f, " * @param[in]  x   XML node%s\n", parent==-1?" with top-level data nodes as children":"");
+    fprintf(f, " * @param[out] s   Struct with typed values of children\n");
+    fprintf(f, " * @retval     0   OK\n");
+    fprintf(f, " * @retval    -1   Error\n");
+    fprintf(f, " */\n");
+    fprintf(f, "static inline int\n");
+    fprintf(f, "%s_get(cxobj *x,\n", cbuf_get(sname));
+    fprintf(f, "%*s struct %s *s)\n", (int)cbuf_len(sname)+4, "", cbuf_get(sname));
+    fprintf(f, "{\n");
+    if (children){
+        fprintf(f, "    cxobj     *xc = NULL;\n");
+        fprintf(f, "    yang_stmt *yc;\n");
+        if (cv)
+            fprintf(f, "    cg_var    *cv;\n");
+        fprintf(f, "\n");
+    }
+    fprintf(f, "    memset(s, 0, sizeof(*s));\n");
+    fprintf(f, "    s->x = x;\n");
+    if (children){
+        fprintf(f, "    while ((xc = xml_child_each(x, xc, CX_ELMNT)) != NULL){\n");
+        fprintf(f, "        yc = xml_spec(xc);\n");
+        for (i=0; i<len; i++){
+            yn = &nodes[i];
+            if (yn->yn_parent != parent)
+                continue;
+            fprintf(f, "        %sif (yc == %s_yspecs[%s_%s]){\n",
+                    first?"":"else ", mname, mupper, yn->yn_name);
+            first = 0;
+            if (yang_keyword_get(yn->yn_ys) == Y_LEAF){
+                if (yang2c_type_get(yn->yn_ys, &yt) < 0)
+                    goto done;
+                if (yt.yt_empty)
+                    fprintf(f, "            s->%s = 1;\n", yn->yn_field);
+                else if (yt.yt_cvget){
+                    fprintf(f, "            if (xml_cv_cache(xc, &cv) < 0)\n");
+                    fprintf(f, "                return -1;\n");
+                    fprintf(f, "            s->%s = %s(cv);\n", yn->yn_field, yt.yt_cvget);
+                }
+                else
+                    fprintf(f, "            s->%s = xml_body(xc);\n", yn->yn_field);
+                fprintf(f, "            s->%s_set = 1;\n", yn->yn_field);
+            }
+            else{
+                fprintf(f, "            if (s->%s == NULL)\n", yn->yn_field);
+                fprintf(f, "                s->%s = xc;\n", yn->yn_field);
+            }
+            fprintf(f, "        }\n");
+        }
+        fprintf(f, "    }\n");
+    }
+    fprintf(f, "    return 0;\n");
+    fprintf(f, "}\n\n");
+    retval = 0;
+ done:
+    if (sname)
+        cbuf_free(sname);
+    return retval;
+}
+
+/*! Print C++ typed leaf accessor indexed by schema node id
+ *
+ * @param[in]  f       Output file
+ * @param[in]  mupper  C identifier of module, upper-case
+ * @param[in]  yn      Generated leaf node
+ * @retval     0       OK
+ * @retval    -1       Error
+ */
+static int
+yang2c_leaf_print(FILE               *f,
+                  const char         *mupper,
+                  struct yang2c_node *yn)
+{
+    int                retval = -1;
+    struct yang2c_type yt;
+
+    if (yang2c_type_get(yn->yn_ys, &yt) < 0)
+        goto done;
+    fprintf(f, "template <>\n");
+    fprintf(f, "struct leaf<%s_%s> {\n", mupper, yn->yn_name);
+    fprintf(f, "    typedef %s type;\n", yt.yt_ctype);
+    fprintf(f, "    static int value(cxobj *xc, type &v) {\n");
+    if (yt.yt_empty){
+        fprintf(f, "        (void)xc;\n");
+        fprintf(f, "        v = 1;\n");
+    }
+    else if (yt.yt_cvget){
+        fprintf(f, "        cg_var *cv;\n");
+        fprintf(f, "        if (xml_cv_cache(xc, &cv) < 0)\n");
+        fprintf(f, "            return -1;\n");
+        fprintf(f, "        v = %s(cv);\n", yt.yt_cvget);
+    }
+    else
+        fprintf(f, "        v = xml_body(xc);\n");
+    fprintf(f, "        return 0;\n");
+    fprintf(f, "    }\n");
+    fprintf(f, "};\n\n");
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Print a C/C++ header with typed accessors of the data nodes of a YANG module
+ *
+ * @param[in]  f     Output file
+ * @param[in]  ymod  Yang module
+ * @retval     0     OK
+ * @retval    -1    Error
+ * @see yang2c_nodeids_bind  Runtime binding of generated schema node ids
+ */
+int
+yang2c_module_print(FILE      *f,
+                    yang_stmt *ymod)
+{
+    int                 retval = -1;
+    struct yang2c_node *nodes = NULL;
+    int                 len = 0;
+    cbuf               *mname = NULL;
+    cbuf               *mupper = NULL;
+    char               *modname;
+    int                 i;
+
+    if (yang_keyword_get(ymod) != Y_MODULE){
+        clixon_err(OE_YANG, EINVAL, "Expected yang module");
+        goto done;
+    }
+    modname = yang_argument_get(ymod);
+    if ((mname = cbuf_new()) == NULL || (mupper = cbuf_new()) == NULL){
+        clixon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    yang2c_cid(mname, modname, 0);
+    yang2c_cid(mupper, modname, 1);
+    if (yang2c_nodes_collect(ymod, -1, NULL, "", &nodes, &len) < 0)
+        goto done;
+    fprintf(f, "/*\n");
+    fprintf(f, " * Typed accessors of YANG module %s, generated by clixon_backend -G\n", modname);
+    fprintf(f, " * Do not edit, regenerate when the YANG module changes.\n");
+    fprintf(f, " * Include after cligen/cligen.h and clixon/clixon.h and call\n");
+    fprintf(f, " * %s_yang2c_init() after the YANG modules are loaded, eg in plugin start\n", cbuf_get(mname));
+    fprintf(f, " */\n");
+    fprintf(f, "#ifndef _%s_YANG2C_H_\n", cbuf_get(mupper));
+    fprintf(f, "#define _%s_YANG2C_H_\n\n", cbuf_get(mupper));
+    fprintf(f, "#include <stdint.h>\n");
+    fprintf(f, "#include <string.h>\n\n");
+    /* Schema node ids */
+    fprintf(f, "/*\n * Schema node ids\n */\n");
+    fprintf(f, "enum %s_nodeid {\n", cbuf_get(mname));
+    for (i=0; i<len; i++)
+        fprintf(f, "    %s_%s,\n", cbuf_get(mupper), nodes[i].yn_name);
+    fprintf(f, "    %s_NODEID_MAX\n", cbuf_get(mupper));
+    fprintf(f, "};\n\n");
+    fprintf(f, "/* Absolute schema node identifiers, indexed by schema node id */\n");
+    fprintf(f, "static const char *%s_nodeids[%s_NODEID_MAX+1] = {\n",
+            cbuf_get(mname), cbuf_get(mupper));
+    for (i=0; i<len; i++)
+        fprintf(f, "    \"%s\",\n", nodes[i].yn_nodeid);
+    fprintf(f, "    NULL\n");
+    fprintf(f, "};\n\n");
+    fprintf(f, "/* Yang specs indexed by schema node id, set by %s_yang2c_init() */\n", cbuf_get(mname));
+    fprintf(f, "static yang_stmt *%s_yspecs[%s_NODEID_MAX+1];\n\n",
+            cbuf_get(mname), cbuf_get(mupper));
+    fprintf(f, "/*! Bind schema node ids to yang specs\n");
+    fprintf(f, " *\n");
+    fprintf(f, " * @param[in]  h   Clixon handle\n");
+    fprintf(f, " * @retval     0   OK\n");
+    fprintf(f, " * @retval    -1   Error, eg generated header does not match loaded YANG\n");
+    fprintf(f, " */\n");
+    fprintf(f, "static inline int\n");
+    fprintf(f, "%s_yang2c_init(clixon_handle h)\n", cbuf_get(mname));
+    fprintf(f, "{\n");
+    fprintf(f, "    return yang2c_nodeids_bind(clicon_dbspec_yang(h), %s_nodeids, %s_NODEID_MAX, %s_yspecs);\n",
+            cbuf_get(mname), cbuf_get(mupper), cbuf_get(mname));
+    fprintf(f, "}\n\n");
+    /* Structs and get functions */
+    if (yang2c_struct_print(f, cbuf_get(mname), cbuf_get(mupper), nodes, len, -1) < 0)
+        goto done;
+    for (i=0; i<len; i++){
+        if (yang_keyword_get(nodes[i].yn_ys) != Y_CONTAINER &&
+            yang_keyword_get(nodes[i].yn_ys) != Y_LIST)
+            continue;
+        if (yang2c_struct_print(f, cbuf_get(mname), cbuf_get(mupper), nodes, len, i) < 0)
+            goto done;
+    }
+    /* C++ accessors */
+    fprintf(f, "#ifdef __cplusplus\n");
+    fprintf(f, "namespace %s_yang2c {\n\n", cbuf_get(mname));
+    fprintf(f, "/*! Yang spec of schema node id */\n");
+    fprintf(f, "template <int Id>\n");
+    fprintf(f, "inline yang_stmt *\n");
+    fprintf(f, "yspec(void)\n");
+    fprintf(f, "{\n");
+    fprintf(f, "    static_assert(Id >= 0 && Id < %s_NODEID_MAX, \"Schema node id out of range\");\n",
+            cbuf_get(mupper));
+    fprintf(f, "    return %s_yspecs[Id];\n", cbuf_get(mname));
+    fprintf(f, "}\n\n");
+    fprintf(f, "/*! First XML child of x bound to schema node id, or NULL */\n");
+    fprintf(f, "template <int Id>\n");
+    fprintf(f, "inline cxobj *\n");
+    fprintf(f, "child(cxobj *x)\n");
+    fprintf(f, "{\n");
+    fprintf(f, "    cxobj *xc = NULL;\n\n");
+    fprintf(f, "    while ((xc = xml_child_each(x, xc, CX_ELMNT)) != NULL)\n");
+    fprintf(f, "        if (xml_spec(xc) == yspec<Id>())\n");
+    fprintf(f, "            break;\n");
+    fprintf(f, "    return xc;\n");
+    fprintf(f, "}\n\n");
+    fprintf(f, "/*! Typed leaf value, specialized for each leaf schema node id */\n");
+    fprintf(f, "template <int Id>\n");
+    fprintf(f, "struct leaf;\n\n");
+    for (i=0; i<len; i++){
+        if (yang_keyword_get(nodes[i].yn_ys) != Y_LEAF)
+            continue;
+        if (yang2c_leaf_print(f, cbuf_get(mupper), &nodes[i]) < 0)
+            goto done;
+    }
+    fprintf(f, "/*! Read typed value of leaf child of x\n");
+    fprintf(f, " *\n");
+    fprintf(f, " * @retval     1   OK, v is set\n");
+    fprintf(f, " * @retval     0   Leaf not present\n");
+    fprintf(f, " * @retval    -1   Error\n");
+    fprintf(f, " */\n");
+    fprintf(f, "template <int Id>\n");
+    fprintf(f, "inline int\n");
+    fprintf(f, "get(cxobj *x,\n");
+    fprintf(f, "    typename leaf<Id>::type &v)\n");
+    fprintf(f, "{\n");
+    fprintf(f, "    cxobj *xc;\n\n");
+    fprintf(f, "    if ((xc = child<Id>(x)) == NULL)\n");
+    fprintf(f, "        return 0;\n");
+    fprintf(f, "    if (leaf<Id>::value(xc, v) < 0)\n");
+    fprintf(f, "        return -1;\n");
+    fprintf(f, "    return 1;\n");
+    fprintf(f, "}\n\n");
+    fprintf(f, "} /* namespace %s_yang2c */\n", cbuf_get(mname));
+    fprintf(f, "#endif /* __cplusplus */\n\n");
+    fprintf(f, "#endif /* _%s_YANG2C_H_ */\n", cbuf_get(mupper));
+    retval = 0;
+ done:
+    yang2c_nodes_free(nodes, len);
+    if (mname)
+        cbuf_free(mname);
+    if (mupper)
+        cbuf_free(mupper);
+    return retval;
+}
+
+/*! Bind generated schema node ids to yang specs
+ *
+ * Called from the init function of a generated header.
+ * @param[in]  yspec    Top-level yang spec
+ * @param[in]  nodeids  Vector of absolute schema node identifiers
+ * @param[in]  len      Length of nodeids
+ * @param[out] yvec     Vector of yang specs, same length as nodeids
+ * @retval     0        OK
+ * @retval    -1        Error, including a schema node not found
+ * @see yang2c_module_print
+ */
+int
+yang2c_nodeids_bind(yang_stmt   *yspec,
+                    const char **nodeids,
+                    int          len,
+                    yang_stmt  **yvec)
+{
+    int retval = -1;
+    int i;
+
+    for (i=0; i<len; i++){
+        if (yang_abs_schema_nodeid(yspec, nodeids[i], &yvec[i]) < 0)
+            goto done;
+        if (yvec[i] == NULL){
+            clixon_err(OE_YANG, ENOENT, "Schema node %s not found, generated accessors do not match YANG",
+                       nodeids[i]);
+            goto done;
+        }
+    }
+    retval = 0;
+ done:
+    return retval;
+}
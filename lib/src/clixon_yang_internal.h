@@ -43,23 +43,35 @@
 
 /*! Yang type cache. Yang type statements can cache all typedef info here
  *
- * @note unions not cached
+ * A union is cached as resolved type only, each member type statement has its own cache.
+ * The member types of a union leaf are compiled together in its validator, see
+ * YANG_TYPE_VALIDATOR
 */
 struct yang_type_cache{
     uint8_t    yc_options;  /* See YANG_OPTIONS_* that determines pattern/
                                fraction fields. */
-    uint8_t    yc_rxmode;   /* Need to store mode for freeing since handle may not be
+    uint8_t    yc_rxmode;   /* Mode of compiled regexps, since handle may not be
                              * available. See enum regexp_mode */
     uint8_t    yc_fraction; /* Fraction digits for decimal64 (if YANG_OPTIONS_FRACTION_DIGITS */
     cvec      *yc_cvv;      /* Range and length restriction. (if YANG_OPTION_
                                LENGTH|RANGE. Can be a vector if multiple 
                                ranges */
     cvec      *yc_patterns; /* List of regexp, if cvec_len() > 0 */
-    cvec      *yc_regexps;  /* List of _compiled_ regexp, if cvec_len() > 0 */
+    cvec      *yc_regexps;  /* List of _compiled_ regexp, if cvec_len() > 0
+                             * Shared, owned by regex_cache_compile */
     yang_stmt *yc_resolved; /* Resolved type object, can be NULL - note direct ptr */
 };
 typedef struct yang_type_cache yang_type_cache;
 
+/*! Identity number and derived identities, see YANG_IDENTITY_BITSET
+ */
+struct yang_identity{
+    uint32_t   yi_nr;       /* Dense number of this identity from its <module>:<id> name */
+    uint32_t   yi_words;    /* Length of yi_derived in 64-bit words */
+    uint64_t  *yi_derived;  /* Bitset of identities derived from this, indexed by yi_nr */
+};
+typedef struct yang_identity yang_identity;
+
 /*! yang statement 
  *
  * This is an internal type, not exposed in the API
@@ -81,6 +93,7 @@ struct yang_stmt {
     struct yang_stmt **ys_stmt;      /* Vector of children statement pointers */
     struct yang_stmt  *ys_parent;    /* Backpointer to parent: yang-stmt or yang-spec */
     char              *ys_argument;  /* String / argument depending on keyword */
+    /* Fields below are not allocated for compact statements, see YANG_COMPACT */
     cg_var            *ys_cv;        /* cligen variable. See ys_populate()
                                         Following stmts have cv:s:
                                         Y_FEATURE: boolean true or false
@@ -109,15 +122,29 @@ struct yang_stmt {
                                         Y_UNKNOWN: app-dep: yang-mount-points
                                      */
     yang_stmt         *ys_orig;      /* Pointer to original (for uses/augment copies) */
+#ifdef YANG_CHILD_INDEX
+    struct yang_index *ys_index;     /* Sorted index of data-node children, see yang_find_datanode */
+#endif
     union {                          /* Depends on ys_keyword */
         rpc_callback_t  *ysu_action_cb; /* Y_ACTION: Action callback list*/
         char            *ysu_filename;  /* Y_MODULE/Y_SUBMODULE: For debug/errors: filename */
         yang_type_cache *ysu_typecache; /* Y_TYPE: cache all typedef data except unions */
-#ifdef OPTIMIZE_YSPEC_NAMESPACE
-        map_str2ptr     *ysu_nscache;   /* Y_SPEC: namespace to module cache */
+#ifdef YANG_TYPE_VALIDATOR
+        void            *ysu_validator; /* Y_LEAF/Y_LEAF_LIST: compiled type validator */
 #endif
+#ifdef YANG_IDENTITY_BITSET
+        yang_identity   *ysu_identity;  /* Y_IDENTITY: number and derived identities */
+#endif
+        struct yspec_nscache *ysu_nscache; /* Y_SPEC: namespace and prefix to module cache */
 #ifdef OPTIMIZE_NO_PRESENCE_CONTAINER
         cxobj           *ysu_nopres_cache; /* Y_CONTAINER: no-presence XML cache */
+#endif
+#ifdef YANG_DEFAULT_TEMPLATE
+        void            *ysu_defaults;  /* Y_CONTAINER/Y_LIST/Y_CASE/Y_INPUT/Y_OUTPUT:
+                                         * default template, see xml_default */
+#endif
+#ifdef YANG_SCHEMA_MOUNT_INDEX
+        clicon_hash_t   *ysu_mntindex;  /* Y_MOUNTS: mount-point xpath to yspec index */
 #endif
     } u;
 };
@@ -126,11 +153,30 @@ struct yang_stmt {
 #define ys_action_cb      u.ysu_action_cb
 #define ys_filename       u.ysu_filename
 #define ys_typecache      u.ysu_typecache
-#ifdef OPTIMIZE_YSPEC_NAMESPACE
-#define ys_nscache        u.ysu_nscache
+#ifdef YANG_TYPE_VALIDATOR
+#define ys_validator      u.ysu_validator
 #endif
+#ifdef YANG_IDENTITY_BITSET
+#define ys_identity       u.ysu_identity
+#endif
+#define ys_nscache        u.ysu_nscache
 #ifdef OPTIMIZE_NO_PRESENCE_CONTAINER
 #define ys_nopres_cache   u.ysu_nopres_cache
 #endif
+#ifdef YANG_DEFAULT_TEMPLATE
+#define ys_defaults       u.ysu_defaults
+#endif
+#ifdef YANG_SCHEMA_MOUNT_INDEX
+#define ys_mntindex       u.ysu_mntindex
+#endif
+
+#ifdef YANG_COMPACT
+/* Size of compact yang statement, ie without the fields from ys_cv */
+#define YANG_COMPACT_SIZE offsetof(struct yang_stmt, ys_cv)
+#endif
+
+#if defined(YANG_DEFAULT_TEMPLATE) && defined(OPTIMIZE_NO_PRESENCE_CONTAINER)
+#error "YANG_DEFAULT_TEMPLATE and OPTIMIZE_NO_PRESENCE_CONTAINER use the same yang field"
+#endif
 
 #endif  /* _CLIXON_YANG_INTERNAL_H_ */
@@ -644,6 +644,8 @@ yang_find_module_by_prefix(yang_stmt  *ys,
     yang_stmt *yscope_mod; /* lexical module/submodule */
     char      *yscope_prefix;
     struct import_prefix_ctx ctx;
+    char       key[128];  /* Prefix cache key: modules in scope and prefix */
+    int        cache = 0; /* Set if found module should be added to cache */
 
     yscope = yang_orig_get(ys) ? yang_orig_get(ys) : ys;
     yinst = ys;
@@ -651,16 +653,22 @@ yang_find_module_by_prefix(yang_stmt  *ys,
         clixon_err(OE_YANG, 0, "My yang spec not found");
         goto done;
     }
-    /* First try own module */
     if ((my_ymod = ys_module(yinst)) == NULL)
         goto done;
+    yscope_mod = ys_module(yscope);
+    /* Result only depends on modules of instance and lexical origin, so cache on those */
+    if (snprintf(key, sizeof(key), "%p/%p:%s", my_ymod, yscope_mod, prefix) < sizeof(key)){
+        if ((ymod = yspec_nscache_prefix_get(yspec, key)) != NULL)
+            goto done;
+        cache++;
+    }
+    /* First try own module */
     myprefix = yang_find_myprefix(yinst);
     if (myprefix && strcmp(myprefix, prefix) == 0){
         ymod = my_ymod;
         goto done;
     }
     /* If the lexical origin lives in another module, honor its own prefix too */
-    yscope_mod = ys_module(yscope);
     if (yscope_mod && yscope_mod != my_ymod){
         yscope_prefix = yang_find_myprefix(yscope);
         if (yscope_prefix && strcmp(yscope_prefix, prefix) == 0){
@@ -698,6 +706,9 @@ yang_find_module_by_prefix(yang_stmt  *ys,
             ymod = ctx.found;
     }
  done:
+    if (ymod && cache &&
+        yspec_nscache_prefix_set(yspec, key, ymod) < 0)
+        ymod = NULL;
     return ymod;
 }
 
@@ -711,13 +722,23 @@ yang_find_module_by_prefix_yspec(yang_stmt  *yspec,
     yang_stmt *ymod;
     yang_stmt *yprefix;
     int        inext;
+    char       key[128];  /* Prefix cache key, no module scope */
+    int        cache = 0;
 
+    if (snprintf(key, sizeof(key), ":%s", prefix) < sizeof(key)){
+        if ((ymod = yspec_nscache_prefix_get(yspec, key)) != NULL)
+            return ymod;
+        cache++;
+    }
     inext = 0;
     while ((ymod = yn_iter(yspec, &inext)) != NULL)
         if (yang_keyword_get(ymod) == Y_MODULE &&
             (yprefix = yang_find(ymod, Y_PREFIX, NULL)) != NULL &&
-            strcmp(yang_argument_get(yprefix), prefix) == 0)
+            strcmp(yang_argument_get(yprefix), prefix) == 0){
+            if (cache && yspec_nscache_prefix_set(yspec, key, ymod) < 0)
+                return NULL;
             return ymod;
+        }
     return NULL;
 }
 
@@ -727,6 +748,7 @@ yang_find_module_by_prefix_yspec(yang_stmt  *yspec,
  * @param[in]  ns         namespace
  * @retval     ymod       Yang module statement if found
  * @retval     NULL       not found
+ * @note A lazy module with this namespace is loaded, see CLICON_YANG_MAIN_LAZY
  * @see yang_find_module_by_name
  * @see yang_find_module_by_prefix    module-specific prefix
  * @see yang_find_prefix_by_namespace
@@ -735,22 +757,15 @@ yang_stmt *
 yang_find_module_by_namespace(yang_stmt  *yspec,
                               const char *ns)
 {
-#ifdef OPTIMIZE_YSPEC_NAMESPACE
-    return yspec_nscache_get(yspec, ns);
-#else
     yang_stmt *ymod = NULL;
-    int        inext;
 
     if (ns == NULL)
         goto done;
-    inext = 0;
-    while ((ymod = yn_iter(yspec, &inext)) != NULL) {
-        if (yang_find(ymod, Y_NAMESPACE, ns) != NULL)
-            break;
-    }
+    ymod = yspec_nscache_get(yspec, ns);
+    if (ymod == NULL) /* Not found: load if lazy, see CLICON_YANG_MAIN_LAZY */
+        ymod = yang_lazy_load(yspec, ns, NULL);
  done:
     return ymod;
-#endif
 }
 
 /*! Given a yang spec, a namespace and revision, return yang module 
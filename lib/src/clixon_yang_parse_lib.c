@@ -55,6 +55,8 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
 #include <errno.h>
 #include <limits.h>
 #include <ctype.h>
@@ -67,7 +69,12 @@
 #include <fcntl.h>
 #include <syslog.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
 #include <sys/param.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <poll.h>
+#include <signal.h>
 #include <netinet/in.h>
 #include <libgen.h>
 
@@ -380,7 +387,7 @@ yang_augment_node(clixon_handle h,
             break;
         }
         /* If expanded by uses / when */
-        if ((yc = ys_dup(yc0, clicon_option_bool(h, "CLICON_YANG_USE_ORIGINAL"), 1)) == NULL)
+        if ((yc = ys_dup(yc0, clicon_option_bool_id(h, CO_YANG_USE_ORIGINAL), 1)) == NULL)
             goto done;
 #ifdef YANG_GROUPING_AUGMENT_SKIP
         /* cornercase: always expand uses under augment */
@@ -487,7 +494,7 @@ ys_do_refine(clixon_handle h,
     while ((yrc = yn_iter(yr, &inext)) != NULL) {
         keyw = yang_keyword_get(yrc);
         /* Make copy */
-        if ((yrc1 = ys_dup(yrc, clicon_option_bool(h, "CLICON_YANG_USE_ORIGINAL"), 0)) == NULL)
+        if ((yrc1 = ys_dup(yrc, clicon_option_bool_id(h, CO_YANG_USE_ORIGINAL), 0)) == NULL)
             goto done;
         if (yn_insert(yt, yrc1) < 0)
             goto done;
@@ -624,7 +631,7 @@ yang_expand_uses_node(clixon_handle h,
 
         for (i=0; i<ygrouping2->ys_len; i++){
             yco = ygrouping->ys_stmt[i];
-            if ((ycn = ys_dup(yco, clicon_option_bool(h, "CLICON_YANG_USE_ORIGINAL"), 1)) == NULL)
+            if ((ycn = ys_dup(yco, clicon_option_bool_id(h, CO_YANG_USE_ORIGINAL), 1)) == NULL)
                 goto done;
             ygrouping2->ys_stmt[i] = ycn;
             ycn->ys_parent = ygrouping2;
@@ -653,6 +660,9 @@ yang_expand_uses_node(clixon_handle h,
             clixon_err(OE_YANG, errno, "realloc");
             goto done;
         }
+#ifdef YANG_CHILD_INDEX
+        yang_child_index_clear(yn);
+#endif
         /* Here, glen last elements are not initialized.
          * Zeroed here but will be assigned later in the "j" loop below
          */
@@ -861,109 +871,1265 @@ yang_parse_str(const char *str,
     clixon_yang_yacc yy = {0,};
     yang_stmt       *ymod = NULL;
 
-    clixon_debug(CLIXON_DBG_PARSE|CLIXON_DBG_DETAIL, "%s", str);
-    if (yspec == NULL){
-        clixon_err(OE_YANG, 0, "Yang parse need top level yang spec");
+    clixon_debug(CLIXON_DBG_PARSE|CLIXON_DBG_DETAIL, "%s", str);
+    if (yspec == NULL){
+        clixon_err(OE_YANG, 0, "Yang parse need top level yang spec");
+        goto done;
+    }
+    yy.yy_name         = (char*)name;
+    yy.yy_linenum      = 1;
+    yy.yy_parse_string = str;
+    yy.yy_stack        = NULL;
+    yy.yy_module       = NULL; /* this is the return value - the module/sub-module */
+    if (ystack_push(&yy, yspec) == NULL)
+        goto done;
+    if (strlen(str)){ /* Not empty */
+        if (yang_scan_init(&yy) < 0)
+            goto done;
+        if (yang_parse_init(&yy) < 0)
+            goto done;
+        if (clixon_yang_parseparse(&yy) != 0) { /* yacc returns 1 on error */
+            clixon_log(NULL, LOG_NOTICE, "Yang error: %s on line %d", name, yy.yy_linenum);
+            if (clixon_err_category() == 0)
+                clixon_err(OE_YANG, 0, "yang parser error with no error code (should not happen)");
+            yang_parse_exit(&yy);
+            yang_scan_exit(&yy);
+            goto done;
+        }
+        if (yang_parse_exit(&yy) < 0)
+            goto done;
+        if (yang_scan_exit(&yy) < 0)
+            goto done;
+    }
+    if ((ymod = yy.yy_module) == NULL){
+        clixon_err(OE_YANG, 0, "No module in YANG %s", name);
+        goto done;
+    }
+    /* Add filename for debugging and errors, see also ys_linenum on (each symbol?) */
+    if (yang_filename_set(ymod, name) < 0)
+        goto done;
+    yspec_nscache_clear(yspec);
+ done:
+    clixon_debug(CLIXON_DBG_PARSE|CLIXON_DBG_DETAIL, "retval:%p", ymod);
+    ystack_pop(&yy);
+    if (yy.yy_stack)
+        free (yy.yy_stack);
+    return ymod;  /* top-level (sub)module */
+}
+
+/*! Read a whole open file into a malloced string
+ *
+ * @param[in]  fp    Open file
+ * @param[out] bufp  File content, NUL-terminated, free with free()
+ * @param[out] lenp  Length of content
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+static int
+yang_parse_read(FILE   *fp,
+                char  **bufp,
+                size_t *lenp)
+{
+    int     retval = -1;
+    char   *buf = NULL;
+    size_t  len;
+    size_t  i;
+    size_t  sz;
+
+    len = BUFLEN; /* any number is fine */
+    if ((buf = malloc(len)) == NULL){
+        clixon_err(OE_XML, errno, "malloc");
+        goto done;
+    }
+    i = 0; /* position in buf */
+    while (1){ /* read the whole file */
+        if (i == len-1){
+            if ((buf = realloc(buf, 2*len)) == NULL){
+                clixon_err(OE_XML, errno, "realloc");
+                goto done;
+            }
+            len *= 2;
+        }
+        sz = fread(buf+i, 1, len-1-i, fp);
+        i += sz;
+        if (sz == 0){
+            if (ferror(fp)){
+                clixon_err(OE_XML, errno, "fread");
+                goto done;
+            }
+            break;
+        }
+    }
+    buf[i] = '\0';
+    *bufp = buf;
+    buf = NULL;
+    *lenp = i;
+    retval = 0;
+ done:
+    if (buf)
+        free(buf);
+    return retval;
+}
+
+/*! Parse yang spec from an open file descriptor
+ *
+ * @param[in] fd     File descriptor containing the YANG file as ASCII characters
+ * @param[in] name   For debug, eg filename
+ * @param[in] yspec  Yang specification. Should have been created by caller using yspec_new
+ * @retval ymod      Top-level yang (sub)module
+ * @retval NULL      Error
+ * @note this function simply parse a yang spec, no dependencies or checks
+ */
+yang_stmt *
+yang_parse_file(FILE       *fp,
+                const char *name,
+                yang_stmt  *yspec)
+{
+    char      *buf = NULL;
+    size_t     len;
+    yang_stmt *ymod = NULL;
+
+    if (yang_parse_read(fp, &buf, &len) < 0)
+        goto done;
+    if (NULL == (ymod = yang_parse_str(buf, name, yspec)))
+        goto done;
+  done:
+    if (buf != NULL)
+        free(buf);
+    return ymod; /* top-level (sub)module */
+}
+
+/* YANG parse cache file magic and version, see CLICON_YANG_PARSE_CACHE_DIR */
+#define YPC_MAGIC     "CLIXONYP"
+#define YPC_VERSION   1
+
+/* Byte order mark, as written by host */
+#define YPC_BOM       0x01020304
+
+/* No string */
+#define YPC_NONE      UINT32_MAX
+
+/* Max depth of YANG parse-tree on load */
+#define YPC_DEPTH_MAX 1024
+
+/*! YANG parse cache file header
+ *
+ * Followed by nnodes node records in pre-order and a string heap of heaplen bytes
+ */
+struct ypc_header {
+    char     yh_magic[8];  /* YPC_MAGIC */
+    uint32_t yh_version;   /* YPC_VERSION */
+    uint32_t yh_bom;       /* YPC_BOM */
+    uint32_t yh_clixon;    /* Clixon major/minor version, keyword enum may change */
+    uint32_t yh_pad;
+    uint64_t yh_digest;    /* Digest of YANG source, see ypc_digest */
+    uint64_t yh_srclen;    /* Length of YANG source */
+    uint32_t yh_nnodes;    /* Number of node records */
+    uint32_t yh_heaplen;   /* Length of string heap */
+};
+
+/*! YANG parse cache node record
+ */
+struct ypc_node {
+    uint32_t yn_keyword;   /* enum rfc_6020 */
+    uint32_t yn_linenum;   /* Line number in YANG source */
+    uint32_t yn_arg;       /* Heap offset of argument, or YPC_NONE */
+    uint32_t yn_extra;     /* Heap offset of unknown-statement argument, or YPC_NONE */
+    uint32_t yn_childnr;   /* Number of child records */
+};
+
+/*! YANG parse cache decoder state
+ */
+struct ypc_reader {
+    struct ypc_node *yr_nodes;   /* Node records */
+    uint32_t         yr_nnodes;  /* Number of node records */
+    uint32_t         yr_i;       /* Next node record */
+    char            *yr_heap;    /* String heap */
+    uint32_t         yr_heaplen; /* Length of string heap */
+    const char      *yr_name;    /* Filename of YANG source */
+    int              yr_shared;  /* Heap is mapped shared, arguments are not copied */
+};
+
+#ifdef YANG_PARSE_CACHE_SHARED
+/*! Mapped parse cache file, see YANG_PARSE_CACHE_SHARED
+ */
+struct ypc_map {
+    uint64_t  ym_digest;  /* Digest of YANG source */
+    char     *ym_base;    /* Start of mapping */
+    size_t    ym_len;     /* Length of mapping */
+};
+
+/* Mapped parse cache files, sorted on ym_base */
+static struct ypc_map *_ypc_maps = NULL;
+static int             _ypc_nmaps = 0;
+
+/*! Find mapped parse cache file of a YANG source digest
+ *
+ * @param[in]  digest  Digest of YANG source
+ * @retval     ym      Mapping
+ * @retval     NULL    Not found
+ */
+static struct ypc_map *
+ypc_map_find(uint64_t digest)
+{
+    int i;
+
+    for (i=0; i<_ypc_nmaps; i++)
+        if (_ypc_maps[i].ym_digest == digest)
+            return &_ypc_maps[i];
+    return NULL;
+}
+
+/*! Register a mapped parse cache file
+ *
+ * @param[in]  digest  Digest of YANG source
+ * @param[in]  base    Start of mapping
+ * @param[in]  len     Length of mapping
+ * @retval     0       OK
+ * @retval    -1       Error
+ */
+static int
+ypc_map_add(uint64_t digest,
+            char    *base,
+            size_t   len)
+{
+    struct ypc_map *maps;
+    int             i;
+
+    if ((maps = realloc(_ypc_maps, (_ypc_nmaps+1)*sizeof(*maps))) == NULL){
+        clixon_err(OE_UNIX, errno, "realloc");
+        return -1;
+    }
+    _ypc_maps = maps;
+    for (i=_ypc_nmaps; i>0 && maps[i-1].ym_base > base; i--)
+        maps[i] = maps[i-1];
+    maps[i].ym_digest = digest;
+    maps[i].ym_base = base;
+    maps[i].ym_len = len;
+    _ypc_nmaps++;
+    return 0;
+}
+
+/*! Check if a YANG argument points into a mapped parse cache file
+ *
+ * Such an argument is not malloced and must not be freed
+ * @param[in]  str  YANG argument
+ * @retval     1    Shared, in a mapped parse cache file
+ * @retval     0    Private, malloced
+ */
+int
+yang_parse_cache_shared(const char *str)
+{
+    int lo = 0;
+    int hi = _ypc_nmaps - 1;
+    int mid;
+
+    while (lo <= hi){
+        mid = (lo + hi)/2;
+        if (str < _ypc_maps[mid].ym_base)
+            hi = mid - 1;
+        else if (str >= _ypc_maps[mid].ym_base + _ypc_maps[mid].ym_len)
+            lo = mid + 1;
+        else
+            return 1;
+    }
+    return 0;
+}
+
+/*! Unmap all parse cache files
+ *
+ * Must be called after all YANG specs are freed
+ * @retval     0    OK
+ */
+int
+yang_parse_cache_exit(void)
+{
+    int i;
+
+    for (i=0; i<_ypc_nmaps; i++)
+        munmap(_ypc_maps[i].ym_base, _ypc_maps[i].ym_len);
+    if (_ypc_maps)
+        free(_ypc_maps);
+    _ypc_maps = NULL;
+    _ypc_nmaps = 0;
+    return 0;
+}
+
+/*! Map a parse cache file
+ *
+ * Mapped private copy-on-write: pages are shared with other processes as long as they
+ * are not written to.
+ * @param[in]  path   Cache file
+ * @param[out] basep  Start of mapping
+ * @param[out] lenp   Length of mapping
+ * @retval     1      OK
+ * @retval     0      No such file or it could not be mapped
+ */
+static int
+ypc_map_file(const char *path,
+             char      **basep,
+             size_t     *lenp)
+{
+    int         retval = 0;
+    int         fd;
+    struct stat st;
+    void       *base;
+
+    if ((fd = open(path, O_RDONLY)) < 0)
+        return 0;
+    if (fstat(fd, &st) < 0 || st.st_size < (off_t)sizeof(struct ypc_header))
+        goto done;
+    if ((base = mmap(NULL, st.st_size, PROT_READ|PROT_WRITE, MAP_PRIVATE, fd, 0)) == MAP_FAILED){
+        clixon_debug(CLIXON_DBG_YANG, "mmap(%s): %s", path, strerror(errno));
+        goto done;
+    }
+    *basep = base;
+    *lenp = st.st_size;
+    retval = 1;
+ done:
+    close(fd);
+    return retval;
+}
+#endif /* YANG_PARSE_CACHE_SHARED */
+
+/*! Compute digest of YANG source (FNV-1a) for parse cache
+ *
+ * @param[in]  str  YANG source
+ * @param[in]  len  Length of source
+ * @retval     digest
+ */
+static uint64_t
+ypc_digest(const char *str,
+           size_t      len)
+{
+    uint64_t h = 14695981039346656037ULL;
+    size_t   i;
+
+    for (i=0; i<len; i++){
+        h ^= (uint8_t)str[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+/*! Append string to heap of parse cache encoder
+ *
+ * @param[in]  cbh   String heap
+ * @param[in]  str   String, or NULL
+ * @param[out] off   Heap offset or YPC_NONE
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+static int
+ypc_heap_add(cbuf       *cbh,
+             const char *str,
+             uint32_t   *off)
+{
+    if (str == NULL){
+        *off = YPC_NONE;
+        return 0;
+    }
+    *off = cbuf_len(cbh);
+    if (cbuf_append_buf(cbh, (void*)str, strlen(str)+1) < 0){
+        clixon_err(OE_UNIX, errno, "cbuf_append_buf");
+        return -1;
+    }
+    return 0;
+}
+
+/*! Encode a YANG parse-tree in pre-order
+ *
+ * @param[in]  ys     YANG statement
+ * @param[in]  cbn    Node records
+ * @param[in]  cbh    String heap
+ * @param[out] nnodes Incremented with number of records
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+static int
+ypc_encode(yang_stmt *ys,
+           cbuf      *cbn,
+           cbuf      *cbh,
+           uint32_t  *nnodes)
+{
+    struct ypc_node yn = {0,};
+    yang_stmt      *yc;
+    cg_var         *cv;
+    const char     *extra = NULL;
+    int             inext;
+
+    yn.yn_keyword = yang_keyword_get(ys);
+    yn.yn_linenum = yang_linenum_get(ys);
+    if (yang_keyword_get(ys) == Y_UNKNOWN &&
+        (cv = yang_cv_get(ys)) != NULL)
+        extra = cv_string_get(cv);
+    if (ypc_heap_add(cbh, yang_argument_get(ys), &yn.yn_arg) < 0)
+        return -1;
+    if (ypc_heap_add(cbh, extra, &yn.yn_extra) < 0)
+        return -1;
+    yn.yn_childnr = yang_len_get(ys);
+    if (cbuf_append_buf(cbn, &yn, sizeof(yn)) < 0){
+        clixon_err(OE_UNIX, errno, "cbuf_append_buf");
+        return -1;
+    }
+    (*nnodes)++;
+    inext = 0;
+    while ((yc = yn_iter(ys, &inext)) != NULL)
+        if (ypc_encode(yc, cbn, cbh, nnodes) < 0)
+            return -1;
+    return 0;
+}
+
+/*! Encode a parse cache image of a YANG (sub)module: header, node records and string heap
+ *
+ * @param[in]  ymod    YANG (sub)module, as parsed
+ * @param[in]  digest  Digest of YANG source
+ * @param[in]  srclen  Length of YANG source
+ * @param[out] cb      Image is appended here
+ * @retval     0       OK
+ * @retval    -1       Error
+ */
+static int
+ypc_image(yang_stmt *ymod,
+          uint64_t   digest,
+          size_t     srclen,
+          cbuf      *cb)
+{
+    int               retval = -1;
+    struct ypc_header yh = {0,};
+    cbuf             *cbn = NULL;
+    cbuf             *cbh = NULL;
+    uint32_t          nnodes = 0;
+
+    if ((cbn = cbuf_new()) == NULL ||
+        (cbh = cbuf_new()) == NULL){
+        clixon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    if (ypc_encode(ymod, cbn, cbh, &nnodes) < 0)
+        goto done;
+    memcpy(yh.yh_magic, YPC_MAGIC, sizeof(yh.yh_magic));
+    yh.yh_version = YPC_VERSION;
+    yh.yh_bom = YPC_BOM;
+    yh.yh_clixon = (CLIXON_VERSION_MAJOR << 16) | CLIXON_VERSION_MINOR;
+    yh.yh_digest = digest;
+    yh.yh_srclen = srclen;
+    yh.yh_nnodes = nnodes;
+    yh.yh_heaplen = cbuf_len(cbh);
+    if (cbuf_append_buf(cb, &yh, sizeof(yh)) < 0 ||
+        cbuf_append_buf(cb, cbuf_get(cbn), cbuf_len(cbn)) < 0 ||
+        cbuf_append_buf(cb, cbuf_get(cbh), cbuf_len(cbh)) < 0){
+        clixon_err(OE_UNIX, errno, "cbuf_append_buf");
+        goto done;
+    }
+    retval = 0;
+ done:
+    if (cbn)
+        cbuf_free(cbn);
+    if (cbh)
+        cbuf_free(cbh);
+    return retval;
+}
+
+/*! Write parse cache file of a newly parsed YANG (sub)module
+ *
+ * Written to a temporary file that is renamed, so that concurrent readers see either
+ * no file or a complete file.
+ * Failure to write the file is not an error, the cache is then just not used.
+ * @param[in]  path    Cache file
+ * @param[in]  ymod    YANG (sub)module, as parsed
+ * @param[in]  digest  Digest of YANG source
+ * @param[in]  srclen  Length of YANG source
+ * @retval     0       OK
+ * @retval    -1       Error
+ */
+static int
+ypc_write(const char *path,
+          yang_stmt  *ymod,
+          uint64_t    digest,
+          size_t      srclen)
+{
+    int   retval = -1;
+    cbuf *cb = NULL;
+    cbuf *cbt = NULL;
+    FILE *fp = NULL;
+    int   ret;
+
+    if ((cb = cbuf_new()) == NULL ||
+        (cbt = cbuf_new()) == NULL){
+        clixon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    if (ypc_image(ymod, digest, srclen, cb) < 0)
+        goto done;
+    cprintf(cbt, "%s.%d", path, getpid());
+    if ((fp = fopen(cbuf_get(cbt), "w")) == NULL){
+        clixon_debug(CLIXON_DBG_YANG, "fopen(%s): %s", cbuf_get(cbt), strerror(errno));
+        goto ok;
+    }
+    ret = (fwrite(cbuf_get(cb), cbuf_len(cb), 1, fp) == 1);
+    if (fclose(fp) != 0)
+        ret = 0;
+    fp = NULL;
+    if (ret == 0){
+        clixon_debug(CLIXON_DBG_YANG, "write %s: %s", cbuf_get(cbt), strerror(errno));
+        unlink(cbuf_get(cbt));
+        goto ok;
+    }
+    if (rename(cbuf_get(cbt), path) < 0){
+        clixon_debug(CLIXON_DBG_YANG, "rename(%s): %s", path, strerror(errno));
+        unlink(cbuf_get(cbt));
+        goto ok;
+    }
+    clixon_debug(CLIXON_DBG_YANG, "wrote %s", path);
+ ok:
+    retval = 0;
+ done:
+    if (fp)
+        fclose(fp);
+    if (cb)
+        cbuf_free(cb);
+    if (cbt)
+        cbuf_free(cbt);
+    return retval;
+}
+
+/*! Get string from parse cache heap
+ *
+ * @param[in]  yr    Decoder state
+ * @param[in]  off   Heap offset
+ * @param[out] str   String or NULL if YPC_NONE
+ * @retval     1     OK
+ * @retval     0     Corrupt offset
+ */
+static int
+ypc_heap_get(struct ypc_reader *yr,
+             uint32_t           off,
+             char             **str)
+{
+    *str = NULL;
+    if (off == YPC_NONE)
+        return 1;
+    if (off >= yr->yr_heaplen ||
+        memchr(yr->yr_heap + off, '\0', yr->yr_heaplen - off) == NULL)
+        return 0;
+    *str = yr->yr_heap + off;
+    return 1;
+}
+
+/*! Decode a YANG statement and its children from parse cache
+ *
+ * Re-creates the statement-specific cv:s made by ys_parse_sub, other syntax checks
+ * were made when the cache file was written.
+ * @param[in]  yr     Decoder state
+ * @param[in]  depth  Tree depth
+ * @param[out] ysp    New YANG statement, free with ys_free
+ * @retval     1      OK
+ * @retval     0      Corrupt cache file
+ * @retval    -1      Error
+ */
+static int
+ypc_decode(struct ypc_reader *yr,
+           int                depth,
+           yang_stmt        **ysp)
+{
+    int              retval = -1;
+    struct ypc_node *yn;
+    yang_stmt       *ys = NULL;
+    yang_stmt       *yc = NULL;
+    char            *arg;
+    char            *extra;
+    char            *str;
+    uint32_t         i;
+    int              ret;
+
+    if (depth > YPC_DEPTH_MAX || yr->yr_i >= yr->yr_nnodes)
+        goto fail;
+    yn = &yr->yr_nodes[yr->yr_i++];
+    if (yn->yn_keyword >= Y_MOUNTS ||
+        yn->yn_childnr > yr->yr_nnodes - yr->yr_i)
+        goto fail;
+    if (ypc_heap_get(yr, yn->yn_arg, &arg) == 0 ||
+        ypc_heap_get(yr, yn->yn_extra, &extra) == 0)
+        goto fail;
+    if ((ys = ys_new(yn->yn_keyword)) == NULL)
+        goto done;
+    if (arg && yr->yr_shared)
+        yang_argument_set(ys, arg); /* In mapped heap, see yang_parse_cache_shared */
+    else if (arg){
+        if ((str = strdup(arg)) == NULL){
+            clixon_err(OE_UNIX, errno, "strdup");
+            goto done;
+        }
+        yang_argument_set(ys, str); /* consumed */
+    }
+    yang_linenum_set(ys, yn->yn_linenum);
+    switch (yn->yn_keyword){
+    case Y_FRACTION_DIGITS:
+    case Y_REVISION:
+    case Y_REVISION_DATE:
+    case Y_MAX_ELEMENTS:
+    case Y_MIN_ELEMENTS:
+        if (arg == NULL)
+            goto fail;
+        if (ys_parse_sub(ys, yr->yr_name, NULL) < 0)
+            goto done;
+        break;
+    case Y_UNKNOWN:
+        if (extra){
+            if ((str = strdup(extra)) == NULL){
+                clixon_err(OE_UNIX, errno, "strdup");
+                goto done;
+            }
+            if (ys_parse_sub(ys, yr->yr_name, str) < 0) /* str consumed */
+                goto done;
+        }
+        break;
+    default:
+        break;
+    }
+    for (i=0; i<yn->yn_childnr; i++){
+        if ((ret = ypc_decode(yr, depth+1, &yc)) < 0)
+            goto done;
+        if (ret == 0)
+            goto fail;
+        if (yn_insert(ys, yc) < 0)
+            goto done;
+        yc = NULL;
+    }
+    *ysp = ys;
+    ys = NULL;
+    retval = 1;
+ done:
+    if (yc)
+        ys_free(yc);
+    if (ys)
+        ys_free(ys);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! Check header and size of a parse cache image
+ *
+ * @param[in]  buf   Image
+ * @param[in]  len   Length of image
+ * @param[out] yh    Header
+ * @retval     1     OK
+ * @retval     0     Not a valid image of this clixon version
+ */
+static int
+ypc_header_check(const char        *buf,
+                 size_t             len,
+                 struct ypc_header *yh)
+{
+    if (len < sizeof(*yh))
+        return 0;
+    memcpy(yh, buf, sizeof(*yh));
+    if (memcmp(yh->yh_magic, YPC_MAGIC, sizeof(yh->yh_magic)) != 0 ||
+        yh->yh_version != YPC_VERSION ||
+        yh->yh_bom != YPC_BOM ||
+        yh->yh_clixon != ((CLIXON_VERSION_MAJOR << 16) | CLIXON_VERSION_MINOR) ||
+        yh->yh_nnodes == 0 ||
+        (len - sizeof(*yh)) / sizeof(struct ypc_node) < yh->yh_nnodes ||
+        len - sizeof(*yh) - (size_t)yh->yh_nnodes*sizeof(struct ypc_node) != yh->yh_heaplen)
+        return 0;
+    return 1;
+}
+
+/*! Decode a parse cache image with checked header
+ *
+ * @param[in]  buf     Image
+ * @param[in]  yh      Header, see ypc_header_check
+ * @param[in]  name    Filename of YANG source
+ * @param[in]  shared  Image is mapped and kept, arguments point into it
+ * @param[out] ymodp   YANG (sub)module, not yet inserted in yspec
+ * @retval     1       OK
+ * @retval     0       Corrupt image
+ * @retval    -1       Error
+ */
+static int
+ypc_image_decode(char              *buf,
+                 struct ypc_header *yh,
+                 const char        *name,
+                 int                shared,
+                 yang_stmt        **ymodp)
+{
+    int               retval = -1;
+    struct ypc_reader yr = {0,};
+    yang_stmt        *ymod = NULL;
+    int               ret;
+
+    /* Node records are copied out of buf to get proper alignment */
+    if ((yr.yr_nodes = malloc(yh->yh_nnodes*sizeof(struct ypc_node))) == NULL){
+        clixon_err(OE_UNIX, errno, "malloc");
+        goto done;
+    }
+    memcpy(yr.yr_nodes, buf + sizeof(*yh), yh->yh_nnodes*sizeof(struct ypc_node));
+    yr.yr_nnodes = yh->yh_nnodes;
+    yr.yr_heap = buf + sizeof(*yh) + yh->yh_nnodes*sizeof(struct ypc_node);
+    yr.yr_heaplen = yh->yh_heaplen;
+    yr.yr_name = name;
+    yr.yr_shared = shared;
+    if ((ret = ypc_decode(&yr, 0, &ymod)) < 0)
+        goto done;
+    if (ret == 0 || yr.yr_i != yr.yr_nnodes ||
+        (yang_keyword_get(ymod) != Y_MODULE && yang_keyword_get(ymod) != Y_SUBMODULE))
+        goto fail;
+    *ymodp = ymod;
+    ymod = NULL;
+    retval = 1;
+ done:
+    if (ymod)
+        ys_free(ymod);
+    if (yr.yr_nodes)
+        free(yr.yr_nodes);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! Read parse cache file of a YANG (sub)module
+ *
+ * @param[in]  path    Cache file
+ * @param[in]  name    Filename of YANG source
+ * @param[in]  digest  Digest of YANG source
+ * @param[in]  srclen  Length of YANG source
+ * @param[out] ymodp   YANG (sub)module, not yet inserted in yspec
+ * @retval     1       OK, cache hit
+ * @retval     0       No cache file, or it is stale or corrupt
+ * @retval    -1       Error
+ */
+static int
+ypc_read(const char *path,
+         const char *name,
+         uint64_t    digest,
+         size_t      srclen,
+         yang_stmt **ymodp)
+{
+    int               retval = -1;
+    FILE             *fp = NULL;
+    char             *buf = NULL;
+    size_t            len = 0;
+    struct ypc_header yh;
+    int               shared = 0;
+    int               ret;
+#ifdef YANG_PARSE_CACHE_SHARED
+    struct ypc_map   *ym;
+    int               mapped = 0; /* Mapped here, not yet registered */
+
+    if ((ym = ypc_map_find(digest)) != NULL){
+        buf = ym->ym_base;
+        len = ym->ym_len;
+    }
+    else {
+        if (ypc_map_file(path, &buf, &len) == 0)
+            goto fail;
+        mapped++;
+    }
+    shared = 1;
+#else
+    if ((fp = fopen(path, "r")) == NULL)
+        goto fail;
+    if (yang_parse_read(fp, &buf, &len) < 0)
+        goto done;
+#endif
+    if (ypc_header_check(buf, len, &yh) == 0 ||
+        yh.yh_digest != digest ||
+        yh.yh_srclen != srclen)
+        goto fail;
+#ifdef YANG_PARSE_CACHE_SHARED
+    if (mapped){ /* Register before decode, so that ys_free knows the arguments are shared */
+        if (ypc_map_add(digest, buf, len) < 0)
+            goto done;
+        mapped = 0;
+    }
+#endif
+    if ((ret = ypc_image_decode(buf, &yh, name, shared, ymodp)) < 0)
+        goto done;
+    if (ret == 0)
+        goto fail;
+    retval = 1;
+ done:
+#ifdef YANG_PARSE_CACHE_SHARED
+    if (mapped)
+        munmap(buf, len);
+#else
+    if (buf)
+        free(buf);
+#endif
+    if (fp)
+        fclose(fp);
+    return retval;
+ fail:
+    clixon_debug(CLIXON_DBG_YANG, "%s: no valid parse cache %s", name, path);
+    retval = 0;
+    goto done;
+}
+
+/*! Insert a decoded YANG (sub)module in yspec, as yang_parse_str does for a parsed
+ *
+ * @param[in]  yspec  Yang specification
+ * @param[in]  ymod   YANG (sub)module, consumed also on error
+ * @param[in]  name   Filename
+ * @retval     ymod   Top-level yang (sub)module
+ * @retval     NULL   Error
+ */
+static yang_stmt *
+ypc_insert(yang_stmt  *yspec,
+           yang_stmt  *ymod,
+           const char *name)
+{
+    if (yn_insert(yspec, ymod) < 0){
+        ys_free(ymod);
+        return NULL;
+    }
+    if (yang_filename_set(ymod, name) < 0)
+        return NULL;
+    yspec_nscache_clear(yspec);
+    return ymod;
+}
+
+/*! Parse yang spec from a string using parse cache
+ *
+ * Same as yang_parse_str, but first look for a cached parse-tree of a YANG source with the
+ * same digest, and if not found, parse and write a new cache file.
+ * @param[in] str    YANG source
+ * @param[in] len    Length of source
+ * @param[in] name   Filename
+ * @param[in] dir    Parse cache directory, see CLICON_YANG_PARSE_CACHE_DIR
+ * @param[in] yspec  Yang specification
+ * @retval    ymod   Top-level yang (sub)module
+ * @retval    NULL   Error
+ */
+static yang_stmt *
+yang_parse_str_cache(const char *str,
+                     size_t      len,
+                     const char *name,
+                     const char *dir,
+                     yang_stmt  *yspec)
+{
+    yang_stmt *ymod = NULL;
+    yang_stmt *ynew = NULL;
+    uint64_t   digest;
+    cbuf      *cb = NULL;
+    int        ret;
+
+    digest = ypc_digest(str, len);
+    if ((cb = cbuf_new()) == NULL){
+        clixon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    cprintf(cb, "%s/%016" PRIx64 ".ypc", dir, digest);
+    if ((ret = ypc_read(cbuf_get(cb), name, digest, len, &ynew)) < 0)
+        goto done;
+    if (ret == 1){
+        clixon_debug(CLIXON_DBG_YANG, "%s: parse cache hit %s", name, cbuf_get(cb));
+        ymod = ypc_insert(yspec, ynew, name);
+        ynew = NULL;
+        goto done;
+    }
+    if ((ymod = yang_parse_str(str, name, yspec)) == NULL)
+        goto done;
+    if (ypc_write(cbuf_get(cb), ymod, digest, len) < 0){
+        ymod = NULL;
+        goto done;
+    }
+ done:
+    if (ynew)
+        ys_free(ynew);
+    if (cb)
+        cbuf_free(cb);
+    return ymod;
+}
+
+/*! Parse yang spec from an open file using parse cache
+ *
+ * @param[in] fp     Open YANG file
+ * @param[in] name   Filename
+ * @param[in] dir    Parse cache directory, see CLICON_YANG_PARSE_CACHE_DIR
+ * @param[in] yspec  Yang specification
+ * @retval    ymod   Top-level yang (sub)module
+ * @retval    NULL   Error
+ * @see yang_parse_str_cache
+ */
+static yang_stmt *
+yang_parse_file_cache(FILE       *fp,
+                      const char *name,
+                      const char *dir,
+                      yang_stmt  *yspec)
+{
+    yang_stmt *ymod = NULL;
+    char      *buf = NULL;
+    size_t     len;
+
+    if (yang_parse_read(fp, &buf, &len) < 0)
+        goto done;
+    ymod = yang_parse_str_cache(buf, len, name, dir, yspec);
+ done:
+    if (buf)
+        free(buf);
+    return ymod;
+}
+
+/*! YANG file parsed by a worker process, see yang_parse_parallel
+ */
+struct ypc_prefetch {
+    char   *yp_name;   /* Filename */
+    char   *yp_image;  /* Parse cache image, see ypc_image */
+    size_t  yp_len;    /* Length of image */
+};
+
+/* YANG files parsed by workers, consumed by yang_parse_filename */
+static struct ypc_prefetch *_ypc_prefetch = NULL;
+static int                  _ypc_nprefetch = 0;
+
+/*! Parse worker buffer
+ */
+struct ypc_worker {
+    pid_t   yw_pid;
+    int     yw_fd;
+    char   *yw_buf;
+    size_t  yw_len;
+    size_t  yw_max;
+};
+
+/*! Free YANG files parsed by workers that were not consumed
+ */
+static void
+ypc_prefetch_free(void)
+{
+    int i;
+
+    for (i=0; i<_ypc_nprefetch; i++){
+        if (_ypc_prefetch[i].yp_name)
+            free(_ypc_prefetch[i].yp_name);
+        if (_ypc_prefetch[i].yp_image)
+            free(_ypc_prefetch[i].yp_image);
+    }
+    if (_ypc_prefetch)
+        free(_ypc_prefetch);
+    _ypc_prefetch = NULL;
+    _ypc_nprefetch = 0;
+}
+
+/*! Get YANG (sub)module of a file parsed by a worker
+ *
+ * The image is consumed
+ * @param[in]  name   Filename
+ * @param[in]  yspec  Yang specification
+ * @param[out] ymodp  Top-level yang (sub)module, inserted in yspec
+ * @retval     1      OK
+ * @retval     0      Not parsed by a worker, or invalid
+ * @retval    -1      Error
+ */
+static int
+ypc_prefetch_get(const char *name,
+                 yang_stmt  *yspec,
+                 yang_stmt **ymodp)
+{
+    int                  retval = -1;
+    struct ypc_prefetch *yp = NULL;
+    struct ypc_header    yh;
+    yang_stmt           *ymod = NULL;
+    int                  i;
+    int                  ret;
+
+    for (i=0; i<_ypc_nprefetch; i++)
+        if (_ypc_prefetch[i].yp_image != NULL &&
+            strcmp(_ypc_prefetch[i].yp_name, name) == 0){
+            yp = &_ypc_prefetch[i];
+            break;
+        }
+    if (yp == NULL)
+        return 0;
+    if (ypc_header_check(yp->yp_image, yp->yp_len, &yh) == 0)
+        goto fail;
+    if ((ret = ypc_image_decode(yp->yp_image, &yh, name, 0, &ymod)) < 0)
+        goto done;
+    if (ret == 0)
+        goto fail;
+    clixon_debug(CLIXON_DBG_YANG, "%s: parsed by worker", name);
+    if ((*ymodp = ypc_insert(yspec, ymod, name)) == NULL)
+        goto done;
+    retval = 1;
+ done:
+    free(yp->yp_image);
+    yp->yp_image = NULL;
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! Parse worker: parse YANG files of a shard and write parse cache images to fd
+ *
+ * Each record is: index, length of image, image, padded to 8 bytes.
+ * Files that fail to parse are skipped, they are parsed again sequentially, which also
+ * reports the error.
+ * @param[in]  h      Clixon handle
+ * @param[in]  files  YANG filenames
+ * @param[in]  nfiles Number of files
+ * @param[in]  w      Worker number, parses files with index w, w+nw,...
+ * @param[in]  nw     Number of workers
+ * @param[in]  fd     Write end of pipe
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+static int
+ypc_parallel_worker(clixon_handle h,
+                    char        **files,
+                    int           nfiles,
+                    int           w,
+                    int           nw,
+                    int           fd)
+{
+    int        retval = -1;
+    FILE      *f = NULL;
+    FILE      *fp = NULL;
+    char      *buf = NULL;
+    size_t     len;
+    yang_stmt *yspec = NULL;
+    yang_stmt *ymod;
+    cbuf      *cb = NULL;
+    uint64_t   rec[2];
+    char       pad[8] = {0,};
+    const char *dir;
+    int        i;
+
+    if ((f = fdopen(fd, "w")) == NULL)
         goto done;
-    }
-    yy.yy_name         = (char*)name;
-    yy.yy_linenum      = 1;
-    yy.yy_parse_string = str;
-    yy.yy_stack        = NULL;
-    yy.yy_module       = NULL; /* this is the return value - the module/sub-module */
-    if (ystack_push(&yy, yspec) == NULL)
+    if ((cb = cbuf_new()) == NULL)
         goto done;
-    if (strlen(str)){ /* Not empty */
-        if (yang_scan_init(&yy) < 0)
-            goto done;
-        if (yang_parse_init(&yy) < 0)
-            goto done;
-        if (clixon_yang_parseparse(&yy) != 0) { /* yacc returns 1 on error */
-            clixon_log(NULL, LOG_NOTICE, "Yang error: %s on line %d", name, yy.yy_linenum);
-            if (clixon_err_category() == 0)
-                clixon_err(OE_YANG, 0, "yang parser error with no error code (should not happen)");
-            yang_parse_exit(&yy);
-            yang_scan_exit(&yy);
+    if ((yspec = ys_new(Y_SPEC)) == NULL)
+        goto done;
+    dir = clicon_option_str(h, "CLICON_YANG_PARSE_CACHE_DIR");
+    for (i=w; i<nfiles; i+=nw){
+        if ((fp = fopen(files[i], "r")) == NULL)
+            continue;
+        if (yang_parse_read(fp, &buf, &len) < 0)
             goto done;
-        }
-        if (yang_parse_exit(&yy) < 0)
+        fclose(fp);
+        fp = NULL;
+        /* Parse, or get from and write to parse cache */
+        if (dir != NULL)
+            ymod = yang_parse_str_cache(buf, len, files[i], dir, yspec);
+        else
+            ymod = yang_parse_str(buf, files[i], yspec);
+        if (ymod == NULL)
+            goto next;
+        cbuf_reset(cb);
+        if (ypc_image(ymod, ypc_digest(buf, len), len, cb) < 0)
             goto done;
-        if (yang_scan_exit(&yy) < 0)
+        rec[0] = i;
+        rec[1] = cbuf_len(cb);
+        if (fwrite(rec, sizeof(rec), 1, f) != 1 ||
+            fwrite(cbuf_get(cb), 1, rec[1], f) != rec[1] ||
+            fwrite(pad, 1, (8 - rec[1]%8)%8, f) != (8 - rec[1]%8)%8)
             goto done;
+    next:
+        free(buf);
+        buf = NULL;
     }
-    if ((ymod = yy.yy_module) == NULL){
-        clixon_err(OE_YANG, 0, "No module in YANG %s", name);
-        goto done;
-    }
-    /* Add filename for debugging and errors, see also ys_linenum on (each symbol?) */
-    if (yang_filename_set(ymod, name) < 0)
+    if (fflush(f) != 0)
         goto done;
-#ifdef OPTIMIZE_YSPEC_NAMESPACE
-    yspec_nscache_clear(yspec);
-#endif
+    retval = 0;
  done:
-    clixon_debug(CLIXON_DBG_PARSE|CLIXON_DBG_DETAIL, "retval:%p", ymod);
-    ystack_pop(&yy);
-    if (yy.yy_stack)
-        free (yy.yy_stack);
-    return ymod;  /* top-level (sub)module */
+    if (f)
+        fclose(f);
+    if (fp)
+        fclose(fp);
+    if (buf)
+        free(buf);
+    if (cb)
+        cbuf_free(cb);
+    return retval;
 }
 
-/*! Parse yang spec from an open file descriptor
+/*! Collect parse cache images from a parse worker
  *
- * @param[in] fd     File descriptor containing the YANG file as ASCII characters
- * @param[in] name   For debug, eg filename
- * @param[in] yspec  Yang specification. Should have been created by caller using yspec_new
- * @retval ymod      Top-level yang (sub)module
- * @retval NULL      Error
- * @note this function simply parse a yang spec, no dependencies or checks
+ * @param[in]  yw     Worker buffer
+ * @param[in]  files  YANG filenames
+ * @param[in]  nfiles Number of files
+ * @retval     0      OK
+ * @retval    -1      Error
  */
-yang_stmt *
-yang_parse_file(FILE       *fp,
-                const char *name,
-                yang_stmt  *yspec)
+static int
+ypc_parallel_collect(struct ypc_worker *yw,
+                     char             **files,
+                     int                nfiles)
 {
-    char      *buf = NULL;
-    int        i;
-    char       c;
-    int        len;
-    yang_stmt *ymod = NULL;
-    size_t     sz;
+    size_t               pos = 0;
+    uint64_t             rec[2];
+    struct ypc_prefetch *yp;
+
+    while (pos + sizeof(rec) <= yw->yw_len){
+        memcpy(rec, yw->yw_buf + pos, sizeof(rec));
+        pos += sizeof(rec);
+        if (rec[0] >= nfiles || rec[1] > yw->yw_len - pos){
+            clixon_err(OE_YANG, EINVAL, "Invalid record from parse worker");
+            return -1;
+        }
+        yp = &_ypc_prefetch[rec[0]];
+        if ((yp->yp_name = strdup(files[rec[0]])) == NULL ||
+            (yp->yp_image = malloc(rec[1])) == NULL){
+            clixon_err(OE_UNIX, errno, "malloc");
+            return -1;
+        }
+        memcpy(yp->yp_image, yw->yw_buf + pos, rec[1]);
+        yp->yp_len = rec[1];
+        pos += rec[1] + (8 - rec[1]%8)%8;
+    }
+    return 0;
+}
 
-    len = BUFLEN; /* any number is fine */
-    if ((buf = malloc(len)) == NULL){
-        clixon_err(OE_XML, errno, "malloc");
+/*! Parse YANG files in parallel worker processes before they are loaded sequentially
+ *
+ * Files are split into one shard per worker. Each worker parses its files and sends them
+ * as parse cache images back on a pipe. yang_parse_filename then decodes a file parsed by
+ * a worker instead of parsing it. Files of workers that can not be forked or that fail are
+ * parsed sequentially, which also reports errors.
+ * Only the syntax parse of each file is made here, imports, expansion etc are sequential.
+ * Clixon is not thread-safe (eg parser and error state), therefore processes are used.
+ * @param[in]  h      Clixon handle
+ * @param[in]  files  YANG filenames
+ * @param[in]  nfiles Number of files
+ * @retval     0      OK
+ * @retval    -1      Error
+ * @see CLICON_YANG_PARSE_PARALLEL
+ */
+static int
+yang_parse_parallel(clixon_handle h,
+                    char        **files,
+                    int           nfiles)
+{
+    int                retval = -1;
+    struct ypc_worker *ywv = NULL;
+    struct pollfd     *pfd = NULL;
+    int                nw;
+    int                w;
+    int                fd[2];
+    int                nopen;
+    int                status;
+    ssize_t            len;
+    char              *buf;
+
+    if ((nw = clicon_option_int(h, "CLICON_YANG_PARSE_PARALLEL")) > nfiles)
+        nw = nfiles;
+    if (nw < 2)
+        goto ok;
+    ypc_prefetch_free();
+    if ((_ypc_prefetch = calloc(nfiles, sizeof(*_ypc_prefetch))) == NULL){
+        clixon_err(OE_UNIX, errno, "calloc");
         goto done;
     }
-    memset(buf, 0, len);
-    i = 0; /* position in buf */
-    while (1){ /* read the whole file */
-        sz = fread(&c, 1, 1, fp);
-        if (sz == 0 && feof(fp)){
+    _ypc_nprefetch = nfiles;
+    if ((ywv = calloc(nw, sizeof(*ywv))) == NULL ||
+        (pfd = calloc(nw, sizeof(*pfd))) == NULL){
+        clixon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    for (w=0; w<nw; w++)
+        ywv[w].yw_fd = -1;
+    for (w=0; w<nw; w++){
+        if (pipe(fd) < 0)
+            break;
+        if ((ywv[w].yw_pid = fork()) < 0){
+            ywv[w].yw_pid = 0;
+            close(fd[0]);
+            close(fd[1]);
+            break;
+        }
+        if (ywv[w].yw_pid == 0){ /* Worker */
+            close(fd[0]);
+            for (nopen=0; nopen<w; nopen++)
+                close(ywv[nopen].yw_fd);
+            if (ypc_parallel_worker(h, files, nfiles, w, nw, fd[1]) < 0)
+                _exit(1);
+            _exit(0); /* Dont exit() here, parent state must not be flushed */
+        }
+        close(fd[1]);
+        ywv[w].yw_fd = fd[0];
+    }
+    /* Read all workers concurrently so that none blocks on a full pipe */
+    do {
+        nopen = 0;
+        for (w=0; w<nw; w++){
+            if (ywv[w].yw_fd == -1)
+                continue;
+            pfd[nopen].fd = ywv[w].yw_fd;
+            pfd[nopen].events = POLLIN;
+            pfd[nopen].revents = 0;
+            nopen++;
+        }
+        if (nopen == 0)
             break;
+        if (poll(pfd, nopen, -1) < 0){
+            if (errno == EINTR)
+                continue;
+            clixon_err(OE_UNIX, errno, "poll");
+            goto done;
         }
-        else if (sz == 1) {
-            if (i == len-1){
-                if ((buf = realloc(buf, 2*len)) == NULL){
-                    clixon_err(OE_XML, errno, "realloc");
+        for (w=0; w<nw; w++){
+            if (ywv[w].yw_fd == -1)
+                continue;
+            for (nopen=0; pfd[nopen].fd != ywv[w].yw_fd; nopen++);
+            if (pfd[nopen].revents == 0)
+                continue;
+            if (ywv[w].yw_len + 65536 > ywv[w].yw_max){
+                ywv[w].yw_max = ywv[w].yw_max ? 2*ywv[w].yw_max : 65536*2;
+                if ((buf = realloc(ywv[w].yw_buf, ywv[w].yw_max)) == NULL){
+                    clixon_err(OE_UNIX, errno, "realloc");
                     goto done;
                 }
-                memset(buf+len, 0, len);
-                len *= 2;
+                ywv[w].yw_buf = buf;
             }
-            buf[i++] = (char)(c&0xff);
+            if ((len = read(ywv[w].yw_fd, ywv[w].yw_buf + ywv[w].yw_len, 65536)) < 0){
+                if (errno == EINTR)
+                    continue;
+                len = 0;
+            }
+            if (len == 0){
+                close(ywv[w].yw_fd);
+                ywv[w].yw_fd = -1;
+            }
+            ywv[w].yw_len += len;
         }
-        else {
-            clixon_err(OE_XML, errno, "fread %lu", sz);
-            goto done;
+    } while (1);
+    for (w=0; w<nw; w++){
+        if (ywv[w].yw_pid == 0)
+            continue;
+        if (waitpid(ywv[w].yw_pid, &status, 0) == ywv[w].yw_pid &&
+            WIFEXITED(status) && WEXITSTATUS(status) == 0){
+            if (ypc_parallel_collect(&ywv[w], files, nfiles) < 0){
+                ywv[w].yw_pid = 0;
+                goto done;
+            }
         }
-    } /* read a line */
-    if (NULL == (ymod = yang_parse_str(buf, name, yspec)))
-        goto done;
-  done:
-    if (buf != NULL)
-        free(buf);
-    return ymod; /* top-level (sub)module */
+        else
+            clixon_debug(CLIXON_DBG_YANG, "parse worker %d failed, parsing its files sequentially", w);
+        ywv[w].yw_pid = 0;
+    }
+ ok:
+    retval = 0;
+ done:
+    for (w=0; ywv && w<nw; w++){
+        if (ywv[w].yw_fd != -1)
+            close(ywv[w].yw_fd);
+        if (ywv[w].yw_pid != 0){
+            kill(ywv[w].yw_pid, SIGKILL);
+            waitpid(ywv[w].yw_pid, &status, 0);
+        }
+        if (ywv[w].yw_buf)
+            free(ywv[w].yw_buf);
+    }
+    if (ywv)
+        free(ywv);
+    if (pfd)
+        free(pfd);
+    return retval;
 }
 
 /*! Given a yang filename, extract the revision as an integer as YYYYMMDD
@@ -1160,22 +2326,36 @@ yang_parse_filename(clixon_handle h,
     yang_stmt    *ymod = NULL;
     FILE         *fp = NULL;
     struct stat   st;
+    const char   *dir;
+    int           ret;
+    struct timeval tv;
 
     clixon_debug(CLIXON_DBG_YANG, "%s", filename);
+    yang_profile_start(&tv);
     if (stat(filename, &st) < 0){
         clixon_err(OE_YANG, errno, "%s not found", filename);
         goto done;
     }
+    if ((ret = ypc_prefetch_get(filename, yspec, &ymod)) < 0)
+        goto done;
+    if (ret == 1)
+        goto patch;
     if ((fp = fopen(filename, "r")) == NULL){
         clixon_err(OE_YANG, errno, "fopen(%s)", filename);
         goto done;
     }
-    if (NULL == (ymod = yang_parse_file(fp, filename, yspec)))
+    if (h && (dir = clicon_option_str(h, "CLICON_YANG_PARSE_CACHE_DIR")) != NULL){
+        if (NULL == (ymod = yang_parse_file_cache(fp, filename, dir, yspec)))
+            goto done;
+    }
+    else if (NULL == (ymod = yang_parse_file(fp, filename, yspec)))
         goto done;
+ patch:
     /* YANG patch hook */
     if (ymod && h && clixon_plugin_yang_patch_all(h, ymod) < 0)
         goto done;
   done:
+    yang_profile_stop(YANG_PROF_PARSE, &tv);
     if (fp)
         fclose(fp);
     return ymod; /* top-level (sub)module */
@@ -1524,6 +2704,56 @@ yang_sort_modules(yang_stmt          *yspec,
     return retval;
 }
 
+/*! Remove documentation statements recursively
+ *
+ * Remove description, reference, contact and organization statements, which are not used
+ * by validation, only for printing YANG or CLI help texts.
+ * get-schema reads the YANG file and is not affected.
+ * @param[in]  yn   Yang node
+ * @retval     0    OK
+ * @retval    -1    Error
+ * @see CLICON_YANG_DOCUMENTATION
+ */
+static int
+yang_documentation_drop(yang_stmt *yn)
+{
+    yang_stmt *ys;
+    int        i;
+
+    for (i=0; i<yang_len_get(yn); ){
+        ys = yang_child_i(yn, i);
+        switch (yang_keyword_get(ys)){
+        case Y_CONTACT:
+        case Y_DESCRIPTION:
+        case Y_ORGANIZATION:
+        case Y_REFERENCE:
+            ys_prune(yn, i);
+            ys_free(ys);
+            break;
+        default:
+            if (yang_documentation_drop(ys) < 0)
+                return -1;
+            i++;
+            break;
+        }
+    }
+    return 0;
+}
+
+/*! Modules of CLICON_YANG_MAIN_DIR not yet loaded, see CLICON_YANG_MAIN_LAZY
+ */
+struct yang_lazy {
+    yang_stmt    *yz_yspec; /* Yang spec the module is loaded into */
+    clixon_handle yz_h;
+    char         *yz_name;  /* Module name */
+    char         *yz_ns;    /* Module namespace */
+    char         *yz_file;  /* Yang filename incl dir and revision */
+};
+
+static struct yang_lazy *_yang_lazy = NULL;
+static int               _yang_nlazy = 0;
+static int               _yang_lazy_loading = 0; /* Guard: no lazy loads while post-processing */
+
 /*! Parse top yang module including all its sub-modules. Expand and populate yang tree
  *
  * Perform secondary actions after yang parsing. These actions cannot be made at
@@ -1556,7 +2786,9 @@ yang_parse_post(clixon_handle h,
     int                modmax;
     struct yang_stmt **ylist = NULL; /* Topology sorted modules */
     int                ylen = 0;     /* Length of ylist */
+    struct timeval     tv;
 
+    _yang_lazy_loading++;
     if (modmin < 0){
         clixon_err(OE_YANG, EINVAL, "modmin negative");
         goto done;
@@ -1568,6 +2800,13 @@ yang_parse_post(clixon_handle h,
         if (yang_parse_recurse(h, yang_child_i(yspec, i), yspec) < 0)
             goto done;
     modmax = yang_len_get(yspec);
+    yang_profile_start(&tv);
+    /* Drop documentation statements if not needed, see CLICON_YANG_DOCUMENTATION */
+    if (clicon_option_exists(h, "CLICON_YANG_DOCUMENTATION") &&
+        !clicon_option_bool(h, "CLICON_YANG_DOCUMENTATION"))
+        for (i=modmin; i<modmax; i++)
+            if (yang_documentation_drop(yang_child_i(yspec, i)) < 0)
+                goto done;
     /* The set of modules [modmin..maxmax] is here complete wrt imports/includes and is a DAG
      * Example: A imports B, C and D, and C and D imports B
      * In some operations below (eg augment) need to be in topology order, eg B first.
@@ -1611,17 +2850,23 @@ yang_parse_post(clixon_handle h,
      *    This alters the original YANG: after this all YANG uses have been expanded
      *    augments as sub-statements of uses are also done here
      */
+    yang_profile_stop(YANG_PROF_POST, &tv);
+    yang_profile_start(&tv);
     for (i=0; i<ylen; i++){
         if (yang_expand_grouping(h, ylist[i]) < 0)
             goto done;
     }
+    yang_profile_stop(YANG_PROF_EXPAND, &tv);
     /* 7: Top-level augmentation of all modules.
      * Note: There is an ordering problem, where an augment in one module depends on an augment in
      * another module not yet augmented.
      */
+    yang_profile_start(&tv);
     for (i=0; i<ylen; i++)
         if (yang_augment_module(h, ylist[i]) < 0)
             goto done;
+    yang_profile_stop(YANG_PROF_AUGMENT, &tv);
+    yang_profile_start(&tv);
     /* 8: Check deviations: not-supported add/delete/replace statements
      *    done late since eg groups must be expanded
      */
@@ -1648,8 +2893,15 @@ yang_parse_post(clixon_handle h,
     for (i=0; i<ylen; i++)
         if (yang_cardinality(h, ylist[i], yang_argument_get(ylist[i])) < 0)
             goto done;
+#ifdef YANG_CHILD_INDEX
+    /* 12. Build data-node child indexes, also of modules augmented above */
+    if (yang_apply(yspec, -1, yang_child_index_build, 1, NULL) < 0)
+        goto done;
+#endif
+    yang_profile_stop(YANG_PROF_POST, &tv);
     retval = 0;
  done:
+    _yang_lazy_loading--;
     if (ylist)
         free(ylist);
     return retval;
@@ -1756,6 +3008,181 @@ yang_spec_parse_file(clixon_handle h,
     return retval;
 }
 
+/*! Check if a parsed module can be loaded lazily
+ *
+ * A module can be deferred if no other module depends on it being loaded, ie it does
+ * not augment or deviate others, define identities, or include submodules.
+ * @param[in]  ymod  Parsed, not yet populated, yang module
+ * @retval     1     Module may be loaded lazily
+ * @retval     0     Module must be loaded at startup
+ */
+static int
+yang_lazy_module(yang_stmt *ymod)
+{
+    yang_stmt *ys;
+    int        inext;
+
+    if (yang_keyword_get(ymod) != Y_MODULE ||
+        yang_find(ymod, Y_NAMESPACE, NULL) == NULL)
+        return 0;
+    inext = 0;
+    while ((ys = yn_iter(ymod, &inext)) != NULL){
+        switch (yang_keyword_get(ys)){
+        case Y_AUGMENT:
+        case Y_DEVIATION:
+        case Y_IDENTITY:
+        case Y_INCLUDE:
+            return 0;
+        default:
+            break;
+        }
+    }
+    return 1;
+}
+
+/*! Register a parsed module of a yang directory for lazy loading
+ *
+ * @param[in]  h         Clixon handle
+ * @param[in]  ymod      Parsed yang module, only name and namespace are kept
+ * @param[in]  filename  Yang file of module
+ * @param[in]  yspec     Yang spec the module is later loaded into
+ * @retval     0         OK
+ * @retval    -1         Error
+ */
+static int
+yang_lazy_add(clixon_handle h,
+              yang_stmt    *ymod,
+              const char   *filename,
+              yang_stmt    *yspec)
+{
+    struct yang_lazy *yz;
+
+    if ((_yang_lazy = realloc(_yang_lazy, (_yang_nlazy+1)*sizeof(*_yang_lazy))) == NULL){
+        clixon_err(OE_UNIX, errno, "realloc");
+        return -1;
+    }
+    yz = &_yang_lazy[_yang_nlazy];
+    memset(yz, 0, sizeof(*yz));
+    yz->yz_yspec = yspec;
+    yz->yz_h = h;
+    if ((yz->yz_name = strdup(yang_argument_get(ymod))) == NULL ||
+        (yz->yz_ns = strdup(yang_argument_get(yang_find(ymod, Y_NAMESPACE, NULL)))) == NULL ||
+        (yz->yz_file = strdup(filename)) == NULL){
+        clixon_err(OE_UNIX, errno, "strdup");
+        if (yz->yz_name)
+            free(yz->yz_name);
+        if (yz->yz_ns)
+            free(yz->yz_ns);
+        return -1;
+    }
+    _yang_nlazy++;
+    return 0;
+}
+
+/*! Remove lazy module entry i from registry
+ */
+static void
+yang_lazy_del(int i)
+{
+    struct yang_lazy *yz = &_yang_lazy[i];
+
+    free(yz->yz_name);
+    free(yz->yz_ns);
+    free(yz->yz_file);
+    _yang_nlazy--;
+    if (i < _yang_nlazy)
+        memmove(yz, yz+1, (_yang_nlazy-i)*sizeof(*yz));
+    if (_yang_nlazy == 0){
+        free(_yang_lazy);
+        _yang_lazy = NULL;
+    }
+}
+
+/*! Load a lazy module, given namespace or name, on first reference
+ *
+ * Called when a namespace or module name is not found in a yang spec, eg when binding
+ * datastore or RPC XML, or on get-schema.
+ * The module and its imports are parsed and post-processed as if loaded at startup.
+ * If yspec is the top-level spec its prefix is added to the global namespace context.
+ * @param[in]  yspec  Yang spec
+ * @param[in]  ns     Namespace of module, or NULL
+ * @param[in]  name   Name of module, or NULL
+ * @retval     ymod   Loaded yang module
+ * @retval     NULL   No such lazy module, or error (check clixon_err)
+ * @see CLICON_YANG_MAIN_LAZY
+ */
+yang_stmt *
+yang_lazy_load(yang_stmt  *yspec,
+               const char *ns,
+               const char *name)
+{
+    yang_stmt    *ymod = NULL;
+    yang_stmt    *yprefix;
+    clixon_handle h;
+    char         *file = NULL;
+    char         *modname = NULL;
+    cvec         *nsc;
+    int           i;
+
+    if (_yang_nlazy == 0 || _yang_lazy_loading)
+        goto done;
+    for (i=0; i<_yang_nlazy; i++){
+        if (_yang_lazy[i].yz_yspec != yspec)
+            continue;
+        if (ns && strcmp(ns, _yang_lazy[i].yz_ns) == 0)
+            break;
+        if (name && strcmp(name, _yang_lazy[i].yz_name) == 0)
+            break;
+    }
+    if (i == _yang_nlazy)
+        goto done;
+    h = _yang_lazy[i].yz_h;
+    /* Take ownership of name and file before removing entry */
+    modname = _yang_lazy[i].yz_name;
+    file = _yang_lazy[i].yz_file;
+    _yang_lazy[i].yz_name = NULL;
+    _yang_lazy[i].yz_file = NULL;
+    yang_lazy_del(i);
+    clixon_debug(CLIXON_DBG_YANG, "%s", file);
+    if (yang_spec_parse_file(h, file, yspec) < 0)
+        goto done;
+    if ((ymod = yang_find(yspec, Y_MODULE, modname)) == NULL)
+        goto done;
+    if (yspec == clicon_dbspec_yang(h) &&
+        (nsc = clicon_nsctx_global_get(h)) != NULL &&
+        (yprefix = yang_find(ymod, Y_PREFIX, NULL)) != NULL &&
+        xml_nsctx_get(nsc, yang_argument_get(yprefix)) == NULL){
+        if (xml_nsctx_add(nsc, yang_argument_get(yprefix),
+                          yang_argument_get(yang_find(ymod, Y_NAMESPACE, NULL))) < 0){
+            ymod = NULL;
+            goto done;
+        }
+    }
+ done:
+    if (modname)
+        free(modname);
+    if (file)
+        free(file);
+    return ymod;
+}
+
+/*! Remove all lazy module entries of a yang spec, eg when it is freed
+ *
+ * @param[in]  yspec  Yang spec, or NULL for all
+ */
+void
+yang_lazy_rm(yang_stmt *yspec)
+{
+    int i = 0;
+
+    while (i < _yang_nlazy){
+        if (yspec == NULL || _yang_lazy[i].yz_yspec == yspec)
+            yang_lazy_del(i);
+        else
+            i++;
+    }
+}
+
 /*! Load all yang modules in directory
  *
  * @param[in]  h     Clicon handle
@@ -1771,6 +3198,8 @@ yang_spec_parse_file(clixon_handle h,
  * 3) If only x@rev.yang's found, prefer newest (newest revision)
  * There is also an extra failsafe which may not be necessary, which removes
  * the oldest module if 1-3 for some reason fails.
+ * If CLICON_YANG_MAIN_LAZY is set, modules nothing else depends on are only registered
+ * by name and namespace, and loaded on first reference, see yang_lazy_load
  */
 int
 yang_spec_load_dir(clixon_handle h,
@@ -1793,7 +3222,13 @@ yang_spec_load_dir(clixon_handle h,
     uint32_t       rev0; /* revision in existing module */
     char          *oldbase = NULL;
     int            taken = 0;
+    char         **files = NULL; /* Selected yang files */
+    int            nfiles = 0;
+    char          *base1 = NULL;
+    int            lazy;
+    struct timeval tv;
 
+    lazy = clicon_option_bool(h, "CLICON_YANG_MAIN_LAZY");
     /* Get yang files names from yang module directory. Note that these
      * are sorted alphatetically:
      * a.yang,
@@ -1806,7 +3241,11 @@ yang_spec_load_dir(clixon_handle h,
         goto ok;
     /* Apply post steps on new modules, ie ones after modmin. */
     modmin = yang_len_get(yspec);
-    /* Load all yang files in dir */
+    if ((files = calloc(ndp, sizeof(*files))) == NULL){
+        clixon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    /* Select yang files in dir: latest revision of each module not already loaded */
     for (i = 0; i < ndp; i++) {
         /* base = module name [+ @rev ] + .yang */
        if (oldbase)
@@ -1839,17 +3278,39 @@ yang_spec_load_dir(clixon_handle h,
             taken = 1; /* last in line and not taken */
         }
         /* Here only a single file is reached(taken)
-         * Check if module already exists -> ym0/rev0 */
+         * Check if module already exists */
+        if (yang_find(yspec, Y_MODULE, base) != NULL ||
+            yang_find(yspec, Y_SUBMODULE, base) != NULL)
+            continue; /* skip if already added by specific file or module */
+        /* Create full filename */
+        snprintf(filename, MAXPATHLEN-1, "%s/%s", dir, dp[i].d_name);
+        if ((files[nfiles] = strdup(filename)) == NULL){
+            clixon_err(OE_UNIX, errno, "strdup");
+            goto done;
+        }
+        nfiles++;
+    }
+    /* Parse files in parallel, if enabled, and then load them in order */
+    yang_profile_start(&tv);
+    if (nfiles > 1 && yang_parse_parallel(h, files, nfiles) < 0)
+        goto done;
+    yang_profile_stop(YANG_PROF_PARSE, &tv);
+    for (i = 0; i < nfiles; i++) {
+        if (filename2revision(files[i] + strlen(dir) + 1, &base1, &revf) < 0)
+            goto done;
+        /* Check if module already exists -> ym0/rev0 */
         rev0 = 0;
-        if ((ym0 = yang_find(yspec, Y_MODULE, base)) != NULL ||
-            (ym0 = yang_find(yspec, Y_SUBMODULE, base)) != NULL){
+        if ((ym0 = yang_find(yspec, Y_MODULE, base1)) != NULL ||
+            (ym0 = yang_find(yspec, Y_SUBMODULE, base1)) != NULL){
             yrev = yang_find(ym0, Y_REVISION, NULL);
             rev0 = cv_uint32_get(yang_cv_get(yrev));
+            free(base1);
+            base1 = NULL;
             continue; /* skip if already added by specific file or module */
         }
-        /* Create full filename */
-        snprintf(filename, MAXPATHLEN-1, "%s/%s", dir, dp[i].d_name);
-        if ((ym = yang_parse_filename(h, filename, yspec)) == NULL)
+        free(base1);
+        base1 = NULL;
+        if ((ym = yang_parse_filename(h, files[i], yspec)) == NULL)
             goto done;
         revm = 0;
         if ((yrev = yang_find(ym, Y_REVISION, NULL)) != NULL)
@@ -1857,12 +3318,21 @@ yang_spec_load_dir(clixon_handle h,
         /* Sanity check that file revision does not match internal rev stmt */
         if (revf && revm && revm != revf){ /* XXX */
 #ifdef CLIXON_RELAX_VALIDATE
-            clixon_log(h, LOG_WARNING, "Yang module file revision and in yang does not match: %s(%u) vs %u", filename, revf, revm);
+            clixon_log(h, LOG_WARNING, "Yang module file revision and in yang does not match: %s(%u) vs %u", files[i], revf, revm);
 #else
-            clixon_err(OE_YANG, EINVAL, "Yang module file revision and in yang does not match: %s(%u) vs %u", filename, revf, revm);
+            clixon_err(OE_YANG, EINVAL, "Yang module file revision and in yang does not match: %s(%u) vs %u", files[i], revf, revm);
             goto done;
 #endif
         }
+        /* Defer module to first reference, see yang_lazy_load */
+        if (lazy && yang_lazy_module(ym)){
+            if (yang_lazy_add(h, ym, files[i], yspec) < 0)
+                goto done;
+            if (ys_prune_self(ym) < 0)
+                goto done;
+            ys_free(ym);
+            continue;
+        }
         /* If ym0 and ym exists, delete the yang with oldest revision
          * This is a failsafe in case anything else fails
          */
@@ -1881,10 +3351,18 @@ yang_spec_load_dir(clixon_handle h,
  ok:
     retval = 0;
   done:
+    ypc_prefetch_free();
+    if (files){
+        for (i=0; i<nfiles; i++)
+            free(files[i]);
+        free(files);
+    }
     if (dp)
         free(dp);
     if (base)
         free(base);
+    if (base1)
+        free(base1);
     if (oldbase)
         free(oldbase);
     return retval;
@@ -2147,58 +3625,139 @@ ys_parse_sub(yang_stmt  *ys,
     return retval;
 }
 
-#ifdef OPTIMIZE_YSPEC_NAMESPACE
+/*! Namespace and prefix to module cache of a yang spec
+ *
+ * Built on first lookup and cleared when modules are added to or removed from the spec
+ */
+struct yspec_nscache {
+    clicon_hash_t *yn_ns;     /* Namespace -> module */
+    clicon_hash_t *yn_prefix; /* Prefix in a module scope -> module, see yang_find_module_by_prefix */
+};
+
+/*! Clear namespace and prefix cache of yang spec
+ *
+ * @param[in]  yspec  Yang spec
+ * @retval     0      OK
+ */
 int
 yspec_nscache_clear(yang_stmt *yspec)
 {
-    if (yspec->ys_nscache){         /* Clear cache */
-        free(yspec->ys_nscache);
+    struct yspec_nscache *yn;
+
+    if ((yn = yspec->ys_nscache) != NULL){
         yspec->ys_nscache = NULL;
+        if (yn->yn_ns)
+            clicon_hash_free(yn->yn_ns);
+        if (yn->yn_prefix)
+            clicon_hash_free(yn->yn_prefix);
+        free(yn);
     }
     return 0;
 }
 
-/*!
+/*! Get module from namespace using yang spec cache
+ *
+ * @param[in]  yspec  Yang spec
+ * @param[in]  ns     Namespace
+ * @retval     ymod   Yang module
+ * @retval     NULL   Not found or error
  */
 yang_stmt *
 yspec_nscache_get(yang_stmt  *yspec,
                   const char *ns)
 {
+    yang_stmt **yp;
+
     if (yspec->ys_nscache == NULL){
         if (yspec_nscache_new(yspec) < 0)
             return NULL;
     }
-    return clixon_str2ptr(yspec->ys_nscache, ns, yang_len_get(yspec));
+    if ((yp = clicon_hash_value(yspec->ys_nscache->yn_ns, ns, NULL)) == NULL)
+        return NULL;
+    return *yp;
 }
 
-/*!
+/*! Build namespace cache of yang spec
+ *
+ * If several modules have the same namespace, the first is used
+ * The prefix cache is filled in on lookup
+ * @param[in]  yspec  Yang spec
+ * @retval     0      OK
+ * @retval    -1      Error
  */
 int
 yspec_nscache_new(yang_stmt *yspec)
 {
-    int          retval = -1;
-    map_str2ptr *mp;
-    yang_stmt   *ym;
-    int          i;
-    size_t       sz;
+    int                   retval = -1;
+    struct yspec_nscache *yn;
+    yang_stmt            *ym;
+    char                 *ns;
+    int                   inext;
 
     yspec_nscache_clear(yspec);
-    sz = sizeof(*yspec->ys_nscache);
-    if ((yspec->ys_nscache = calloc(yang_len_get(yspec)+1, sz)) == NULL){
+    if ((yn = calloc(1, sizeof(*yn))) == NULL){
         clixon_err(OE_UNIX, errno, "calloc");
         goto done;
     }
-    for (i=0; i<yang_len_get(yspec); i++){
-        ym = yang_child_i(yspec, i);
+    yspec->ys_nscache = yn;
+    if ((yn->yn_ns = clicon_hash_init()) == NULL ||
+        (yn->yn_prefix = clicon_hash_init()) == NULL)
+        goto done;
+    inext = 0;
+    while ((ym = yn_iter(yspec, &inext)) != NULL){
         if (yang_keyword_get(ym) != Y_MODULE)
             continue;
-        mp = &yspec->ys_nscache[i];
-        mp->mp_str = yang_find_mynamespace(ym);
-        mp->mp_ptr = ym;
+        if ((ns = yang_find_mynamespace(ym)) == NULL)
+            continue;
+        if (clicon_hash_lookup(yn->yn_ns, ns) != NULL)
+            continue;
+        if (clicon_hash_add(yn->yn_ns, ns, &ym, sizeof(ym)) == NULL)
+            goto done;
     }
-    clixon_str2ptr_sort(yspec->ys_nscache, yang_len_get(yspec));
     retval = 0;
  done:
+    if (retval < 0)
+        yspec_nscache_clear(yspec);
     return retval;
 }
-#endif
+
+/*! Get module from prefix cache of yang spec
+ *
+ * @param[in]  yspec  Yang spec
+ * @param[in]  key    Prefix with scope, see yang_find_module_by_prefix
+ * @retval     ymod   Yang module
+ * @retval     NULL   Not cached
+ */
+yang_stmt *
+yspec_nscache_prefix_get(yang_stmt  *yspec,
+                         const char *key)
+{
+    yang_stmt **yp;
+
+    if (yspec->ys_nscache == NULL)
+        return NULL;
+    if ((yp = clicon_hash_value(yspec->ys_nscache->yn_prefix, key, NULL)) == NULL)
+        return NULL;
+    return *yp;
+}
+
+/*! Add module to prefix cache of yang spec
+ *
+ * @param[in]  yspec  Yang spec
+ * @param[in]  key    Prefix with scope, see yang_find_module_by_prefix
+ * @param[in]  ymod   Yang module
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+int
+yspec_nscache_prefix_set(yang_stmt  *yspec,
+                         const char *key,
+                         yang_stmt  *ymod)
+{
+    if (yspec->ys_nscache == NULL &&
+        yspec_nscache_new(yspec) < 0)
+        return -1;
+    if (clicon_hash_add(yspec->ys_nscache->yn_prefix, key, &ymod, sizeof(ymod)) == NULL)
+        return -1;
+    return 0;
+}
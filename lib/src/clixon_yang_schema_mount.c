@@ -255,6 +255,55 @@ yang_mount_get_xpath(clixon_handle h,
     return retval;
 }
 
+#ifdef YANG_SCHEMA_MOUNT_INDEX
+/*! Add mount-point xpath of mounted yspec to index
+ *
+ * @param[in]  ymounts  Top-level yang mounts
+ * @param[in]  xpath    Canonical xpath of XML mount-point
+ * @param[in]  yspec    Mounted yspec
+ * @retval     0        OK
+ * @retval    -1        Error
+ * @see yang_mount_get
+ */
+static int
+yang_mount_index_add(yang_stmt  *ymounts,
+                     const char *xpath,
+                     yang_stmt  *yspec)
+{
+    clicon_hash_t *index;
+
+    if ((index = yang_mount_index_get(ymounts)) == NULL){
+        if ((index = clicon_hash_init()) == NULL)
+            return -1;
+        if (yang_mount_index_set(ymounts, index) < 0){
+            clicon_hash_free(index);
+            return -1;
+        }
+    }
+    if (clicon_hash_add(index, xpath, &yspec, sizeof(yspec)) == NULL)
+        return -1;
+    return 0;
+}
+
+/*! Remove mount-point xpath from index
+ *
+ * @param[in]  ymounts  Top-level yang mounts
+ * @param[in]  xpath    Canonical xpath of XML mount-point
+ * @retval     0        OK
+ */
+static int
+yang_mount_index_rm(yang_stmt  *ymounts,
+                    const char *xpath)
+{
+    clicon_hash_t *index;
+
+    if (ymounts != NULL &&
+        (index = yang_mount_index_get(ymounts)) != NULL)
+        clicon_hash_del(index, xpath);
+    return 0;
+}
+#endif /* YANG_SCHEMA_MOUNT_INDEX */
+
 /*! Get yangspec mount-point
  *
  * @param[in]  ys    Yang container/list containing unknown node
@@ -265,6 +314,7 @@ yang_mount_get_xpath(clixon_handle h,
  * With domains it is assumed an xpath is unique across domains, which is true if the xpath
  * has eg a list name which is unique. But there could be cases where this is not true.
  * @see yang_mount_get_xpath  which is slightly different (but more logical)
+ * @see YANG_SCHEMA_MOUNT_INDEX  Lookup by xpath in index
  */
 int
 yang_mount_get(yang_stmt  *ys,
@@ -282,6 +332,19 @@ yang_mount_get(yang_stmt  *ys,
         clixon_err(OE_YANG, ENOENT, "Top-level yang mounts not found");
         goto done;
     }
+#ifdef YANG_SCHEMA_MOUNT_INDEX
+    if (xpath != NULL){
+        clicon_hash_t *index;
+        yang_stmt    **yp;
+
+        if ((index = yang_mount_index_get(ymounts)) != NULL &&
+            (yp = clicon_hash_value(index, xpath, NULL)) != NULL)
+            yspec = *yp;
+        *yspecp = yspec;
+        retval = 0;
+        goto done;
+    }
+#endif
     inext = 0;
     ydomain = NULL;
     while ((ydomain = yn_iter(ymounts, &inext)) != NULL) {
@@ -453,6 +516,29 @@ xml_yang_mount_get(clixon_handle   h,
     goto done;
 }
 
+#ifdef YANG_SCHEMA_MOUNT_INDEX
+/*! Check if yspec has any mount-points
+ *
+ * @param[in]  yspec  Yang spec
+ * @retval     1      Yes, some node in yspec has a mount-point extension
+ * @retval     0      No
+ */
+static int
+yspec_mount_points(yang_stmt *yspec)
+{
+    yang_stmt *ymod;
+    yang_stmt *yext;
+    cvec      *cvv;
+
+    if (yspec == NULL ||
+        (ymod = yang_find(yspec, Y_MODULE, "ietf-yang-schema-mount")) == NULL ||
+        (yext = yang_find(ymod, Y_EXTENSION, "mount-point")) == NULL ||
+        (cvv = yang_cvec_get(yext)) == NULL)
+        return 0;
+    return cvec_len(cvv) > 0;
+}
+#endif /* YANG_SCHEMA_MOUNT_INDEX */
+
 /*! Find schema mounts - callback function for xml_apply
  *
  * @param[in]  x    XML node
@@ -470,6 +556,10 @@ find_xml_schema_mounts(cxobj *x,
     cvec      *cvv = (cvec *)arg;
     cg_var    *cv;
     int        ret;
+#ifdef YANG_SCHEMA_MOUNT_INDEX
+    cxobj     *xc;
+    yang_stmt *yc;
+#endif
 
     if ((y = xml_spec(x)) == NULL)
         return 2;
@@ -484,6 +574,17 @@ find_xml_schema_mounts(cxobj *x,
         return -1;
     }
     cv_void_set(cv, x);
+#ifdef YANG_SCHEMA_MOUNT_INDEX
+    /* Only descend into mounted tree if its yspec in turn has mount-points */
+    xc = NULL;
+    while ((xc = xml_child_each(x, xc, CX_ELMNT)) != NULL) {
+        if ((yc = xml_spec(xc)) == NULL)
+            continue;
+        if (yspec_mount_points(ys_spec(yc)) == 0)
+            return 2;
+        break;
+    }
+#endif
     return 0;
 }
 
@@ -863,12 +964,21 @@ yang_schema_yanglib_mount_parse(clixon_handle h,
         yspec1 = NULL;
         goto done;
     }
+#ifdef YANG_SCHEMA_MOUNT_INDEX
+    if (yang_mount_index_add(ymounts, xpath, yspec1) < 0){
+        yspec1 = NULL;
+        goto done;
+    }
+#endif
     /* Either yspec0 = NULL and yspec1 is new, or yspec0 == yspec1 != NULL (shared) */
     if (!skip && new){
         /* Parse yang modules into yspec */
         if ((ret = yang_lib2yspec(h, xyanglib, xpath, domain, yspec1)) < 0)
             goto done;
         if (ret == 0){
+#ifdef YANG_SCHEMA_MOUNT_INDEX
+            yang_mount_index_rm(ymounts, xpath);
+#endif
             ys_prune_self(yspec1); /* remove from tree, free in done code */
             goto anydata;
         }
@@ -1002,6 +1112,10 @@ yang_schema_yspec_rm(clixon_handle h,
     if (ret == 1 && xpath != NULL && yspec != NULL){
         if (yang_cvec_rm(yspec, xpath) < 0)
             goto done;
+#ifdef YANG_SCHEMA_MOUNT_INDEX
+        if (yang_mount_index_rm(ys_mounts(yspec), xpath) < 0)
+            goto done;
+#endif
 #if 0
         cvec      *cvv;
         /* see https://github.com/clicon/clixon-controller/issues/169
@@ -196,20 +196,19 @@ compile_pattern2regexp(clixon_handle h,
     pcv = NULL;
     while ((pcv = cvec_each(patterns, pcv)) != NULL){
         pattern = cv_string_get(pcv);
-        /* Compile yang pattern. handle necessary to select regex engine */
-        if ((ret = regex_compile(h, pattern, &re)) < 0)
+        /* Compile yang pattern. handle necessary to select regex engine
+         * Compiled patterns are shared between types and owned by the regex cache */
+        if ((ret = regex_cache_compile(clicon_yang_regexp(h), pattern, &re)) < 0)
             goto done;
         if (ret == 0){
             yang_stmt *ymod;
 
             clixon_err(OE_YANG, 0, "regexp compile fail: \"%s\"", pattern);
-            if (regex_free(h, re) < 0)
-                goto done;
             re = NULL;
             ymod = ys_module(ytype);
             clixon_log(h, LOG_WARNING, "Regexp compile fail: \"%s\" in file %s, fallback using .*",
                        pattern, yang_filename_get(ymod));
-            if ((ret = regex_compile(h, ".*", &re)) < 0)
+            if ((ret = regex_cache_compile(clicon_yang_regexp(h), ".*", &re)) < 0)
                 goto done;
             if (ret == 0){
                 clixon_err(OE_YANG, 0, "regexp compile fail: \"%s\"",
@@ -230,8 +229,6 @@ compile_pattern2regexp(clixon_handle h,
     }
     retval = 1;
  done:
-    if (re != NULL)
-        retval = regex_free(h, re);
     return retval;
 }
 
@@ -242,7 +239,7 @@ compile_pattern2regexp(clixon_handle h,
  * @param[in]  arg  Not used
  * @retval     0    OK
  * @retval    -1    Error
- * @note unions not cached
+ * @note union members are cached in their own type statements
  */
 int
 ys_resolve_type(yang_stmt *ytype,
@@ -266,6 +263,11 @@ ys_resolve_type(yang_stmt *ytype,
         clixon_err(OE_YANG, EINVAL, "ytype has no parent");
         goto done;
     }
+#ifdef YANG_USES_SHARED
+    /* Shared type already resolved in the context of its original */
+    if (yang_typecache_get(ytype) != NULL)
+        goto ok;
+#endif
     if ((patterns = cvec_new(0)) == NULL){
        clixon_err(OE_UNIX, errno, "cvec_new");
        goto done;
@@ -294,6 +296,7 @@ ys_resolve_type(yang_stmt *ytype,
     if (yang_type_cache_set2(ytype, resolved, options, cvv,
                              patterns, fraction, clicon_yang_regexp(h), regexps) < 0)
         goto done;
+ ok:
     retval = 0;
  done:
     if (regexps)
@@ -787,20 +790,23 @@ cv_validate1(clixon_handle h,
 static int ys_cv_validate_union(clixon_handle h,yang_stmt *ys, char **reason,
                                 yang_stmt *yrestype, char *type, char *val, yang_stmt **ysubp);
 
+/*! Find referred YANG node of leafref, the leaf or leaf-list whose type is used
+ *
+ * @param[in]  ys       Leaf or leaf-list of type leafref
+ * @param[in]  yrestype Resolved type (leafref)
+ * @param[out] yrefp    Referred YANG node
+ * @retval     0        OK
+ * @retval    -1        Error
+ */
 static int
-ys_cv_validate_leafref(clixon_handle h,
-                       char         *body,
-                       yang_stmt    *ys,
-                       yang_stmt    *yrestype,
-                       yang_stmt   **ysub,
-                       char        **reason)
+ys_leafref_target(yang_stmt  *ys,
+                  yang_stmt  *yrestype,
+                  yang_stmt **yrefp)
 {
     int        retval = -1;
     yang_stmt *yref = NULL;
     char      *path_arg;
     yang_stmt *ypath;
-    cg_var    *cv = NULL;
-    int        ret;
 
     if ((ypath = yang_find(yrestype, Y_PATH, NULL)) == NULL){
         clixon_err(OE_YANG, 0, "No Y_PATH for leafref");
@@ -837,6 +843,34 @@ ys_cv_validate_leafref(clixon_handle h,
             goto done;
         }
     }
+    *yrefp = yref;
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Validate leafref value using the type of the referred node
+ *
+ * @param[in]  h       Clixon handle
+ * @param[in]  body    Value
+ * @param[in]  yref    Referred YANG node, see ys_leafref_target
+ * @param[out] ysub    Sub-type that matches val
+ * @param[out] reason  If given, and return value is 0, contains malloced string
+ * @retval     1       Validation OK
+ * @retval     0       Validation not OK, malloced reason is returned. Free reason with free()
+ * @retval    -1       Error (fatal), with errno set to indicate error
+ */
+static int
+ys_cv_validate_leafref_target(clixon_handle h,
+                              char         *body,
+                              yang_stmt    *yref,
+                              yang_stmt   **ysub,
+                              char        **reason)
+{
+    int     retval = -1;
+    cg_var *cv = NULL;
+    int     ret;
+
     if ((cv = cv_dup(yang_cv_get(yref))) == NULL){
         clixon_err(OE_UNIX, errno, "cv_dup");
         goto done;
@@ -858,6 +892,25 @@ ys_cv_validate_leafref(clixon_handle h,
     goto done;
 }
 
+/*! Validate leafref value, resolve referred node and use its type
+ *
+ * @see ys_cv_validate_leafref_target
+ */
+static int
+ys_cv_validate_leafref(clixon_handle h,
+                       char         *body,
+                       yang_stmt    *ys,
+                       yang_stmt    *yrestype,
+                       yang_stmt   **ysub,
+                       char        **reason)
+{
+    yang_stmt *yref = NULL;
+
+    if (ys_leafref_target(ys, yrestype, &yref) < 0)
+        return -1;
+    return ys_cv_validate_leafref_target(h, body, yref, ysub, reason);
+}
+
 /*! Validate union
  *
  * @param[in]  h      Clixon handle
@@ -1009,6 +1062,359 @@ ys_cv_validate_union(clixon_handle h,
     return retval;
 }
 
+#ifdef YANG_TYPE_VALIDATOR
+/*! Type validator compiled from a resolved type, cached on leaf or leaf-list
+ *
+ * The top validator is the type of the leaf, union members have their own validators.
+ * @see YANG_TYPE_VALIDATOR
+ */
+struct yang_validator {
+    yang_stmt             *yv_ytype;    /* Type statement, for union member match */
+    yang_stmt             *yv_restype;  /* Resolved type */
+    char                  *yv_restypestr; /* Name of resolved type, or NULL */
+    enum cv_type           yv_cvtype;   /* Cligen type of value */
+    int                    yv_options;  /* See YANG_OPTIONS_* */
+    cvec                  *yv_cvv;      /* Range or length, not owned */
+    cvec                  *yv_regexps;  /* Compiled regexps, owned by regex cache */
+    uint8_t                yv_fraction; /* Fraction digits of decimal64 */
+    yang_stmt             *yv_yref;     /* Leafref: referred node, set on first use */
+    int                    yv_len;      /* Union: number of member types */
+    struct yang_validator *yv_vec;      /* Union: member types in declared order */
+    int                    yv_hot;      /* Union: member that matched last */
+    int                    yv_classify; /* Value must start with a char in yv_first */
+    uint8_t                yv_first[32]; /* Bitmap of possible first chars, 0 is empty */
+};
+
+#define YV_FIRST_SET(yv, c) ((yv)->yv_first[(uint8_t)(c)>>3] |= 1<<((uint8_t)(c)&7))
+#define YV_FIRST_ISSET(yv, c) ((yv)->yv_first[(uint8_t)(c)>>3] & 1<<((uint8_t)(c)&7))
+
+/*! Free fields of a validator, not the validator itself
+ */
+static void
+yang_validator_free1(struct yang_validator *yv)
+{
+    cg_var *cv;
+    int     i;
+
+    if (yv->yv_regexps){
+        /* Compiled regexps are owned by the regex cache, see regex_cache_compile */
+        cv = NULL;
+        while ((cv = cvec_each(yv->yv_regexps, cv)) != NULL)
+            cv_void_set(cv, NULL);
+        cvec_free(yv->yv_regexps);
+    }
+    for (i=0; i<yv->yv_len; i++)
+        yang_validator_free1(&yv->yv_vec[i]);
+    if (yv->yv_vec)
+        free(yv->yv_vec);
+}
+
+/*! Free type validator
+ *
+ * @param[in]  arg  Validator, see yang_validator_get
+ */
+void
+yang_validator_free(void *arg)
+{
+    if (arg){
+        yang_validator_free1((struct yang_validator *)arg);
+        free(arg);
+    }
+}
+
+/*! Pre-classify union member type on first char of values
+ *
+ * Numbers start with a digit, sign, period or whitespace, enumerations with the first
+ * char of an enum. Other types are not classified.
+ * @param[in]  yv   Validator of a union member
+ */
+static void
+yang_validator_classify(struct yang_validator *yv)
+{
+    yang_stmt *ye;
+    char      *str;
+    int        inext;
+    int        c;
+
+    if (cv_isint(yv->yv_cvtype) || yv->yv_cvtype == CGV_DEC64){
+        for (c='0'; c<='9'; c++)
+            YV_FIRST_SET(yv, c);
+        for (str = "+-. \t\n\r"; *str; str++)
+            YV_FIRST_SET(yv, *str);
+        yv->yv_classify = 1;
+    }
+    else if (yv->yv_restypestr && strcmp(yv->yv_restypestr, "enumeration") == 0){
+        inext = 0;
+        while ((ye = yn_iter(yv->yv_restype, &inext)) != NULL){
+            if (yang_keyword_get(ye) != Y_ENUM)
+                continue;
+            if ((str = yang_argument_get(ye)) != NULL)
+                YV_FIRST_SET(yv, str[0]);
+        }
+        yv->yv_classify = 1;
+    }
+}
+
+/*! Compile type validator of a leaf type or of a union member type
+ *
+ * @param[in]  ys      Leaf or leaf-list
+ * @param[in]  ytype   Union member type, or NULL for the type of ys
+ * @param[out] yv      Validator, zeroed on entry
+ * @retval     0       OK
+ * @retval    -1       Error
+ */
+static int
+yang_validator_compile(yang_stmt             *ys,
+                       yang_stmt             *ytype,
+                       struct yang_validator *yv)
+{
+    int        retval = -1;
+    char      *origtype = NULL;
+    cvec      *patterns = NULL;
+    yang_stmt *yt;
+    int        inext;
+    int        i;
+
+    if ((patterns = cvec_new(0)) == NULL ||
+        (yv->yv_regexps = cvec_new(0)) == NULL){
+        clixon_err(OE_UNIX, errno, "cvec_new");
+        goto done;
+    }
+    if (ytype == NULL){
+        if (yang_type_get(ys, &origtype, &yv->yv_restype, &yv->yv_options, &yv->yv_cvv,
+                          patterns, yv->yv_regexps, &yv->yv_fraction) < 0)
+            goto done;
+        yv->yv_ytype = yang_find(ys, Y_TYPE, NULL);
+    }
+    else{
+        if (yang_type_resolve(ys, ys, ytype, &yv->yv_restype, &yv->yv_options, &yv->yv_cvv,
+                              patterns, yv->yv_regexps, &yv->yv_fraction) < 0)
+            goto done;
+        yv->yv_ytype = ytype;
+    }
+    yv->yv_restypestr = yv->yv_restype?yang_argument_get(yv->yv_restype):NULL;
+    if (clicon_type2cv(origtype?origtype:yang_argument_get(ytype), yv->yv_restypestr,
+                       ys, &yv->yv_cvtype) < 0)
+        goto done;
+    if (yv->yv_restypestr && strcmp(yv->yv_restypestr, "union") == 0){
+        inext = 0;
+        while ((yt = yn_iter(yv->yv_restype, &inext)) != NULL)
+            if (yang_keyword_get(yt) == Y_TYPE)
+                yv->yv_len++;
+        if (yv->yv_len &&
+            (yv->yv_vec = calloc(yv->yv_len, sizeof(*yv->yv_vec))) == NULL){
+            clixon_err(OE_UNIX, errno, "calloc");
+            goto done;
+        }
+        i = 0;
+        inext = 0;
+        while ((yt = yn_iter(yv->yv_restype, &inext)) != NULL){
+            if (yang_keyword_get(yt) != Y_TYPE)
+                continue;
+            if (yang_validator_compile(ys, yt, &yv->yv_vec[i]) < 0)
+                goto done;
+            yang_validator_classify(&yv->yv_vec[i++]);
+        }
+    }
+    retval = 0;
+ done:
+    if (origtype)
+        free(origtype);
+    if (patterns)
+        cvec_free(patterns);
+    return retval;
+}
+
+/*! Get type validator of leaf or leaf-list, compile it on first use
+ *
+ * @param[in]  ys   Leaf or leaf-list
+ * @param[out] yvp  Validator
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+yang_validator_ys(yang_stmt              *ys,
+                  struct yang_validator **yvp)
+{
+    int                    retval = -1;
+    struct yang_validator *yv;
+
+    if ((yv = yang_validator_get(ys)) == NULL){
+        if ((yv = calloc(1, sizeof(*yv))) == NULL){
+            clixon_err(OE_UNIX, errno, "calloc");
+            goto done;
+        }
+        if (yang_validator_compile(ys, NULL, yv) < 0){
+            yang_validator_free(yv);
+            goto done;
+        }
+        if (yang_validator_set(ys, yv) < 0){
+            yang_validator_free(yv);
+            goto done;
+        }
+    }
+    *yvp = yv;
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Validate leafref value with validator, referred node is resolved once
+ */
+static int
+yv_validate_leafref(clixon_handle          h,
+                    char                  *val,
+                    yang_stmt             *ys,
+                    struct yang_validator *yv,
+                    yang_stmt            **ysub,
+                    char                 **reason)
+{
+    if (yv->yv_yref == NULL &&
+        ys_leafref_target(ys, yv->yv_restype, &yv->yv_yref) < 0)
+        return -1;
+    return ys_cv_validate_leafref_target(h, val, yv->yv_yref, ysub, reason);
+}
+
+static int yv_validate_union(clixon_handle h, yang_stmt *ys, struct yang_validator *yv,
+                             char *val, yang_stmt **ysubp, char **reason);
+
+/*! Validate value string with validator of one union member
+ *
+ * @see ys_cv_validate_union_one  non-compiled variant
+ */
+static int
+yv_validate_one(clixon_handle          h,
+                yang_stmt             *ys,
+                struct yang_validator *yv,
+                char                  *val,
+                char                 **reason)
+{
+    int     retval = -1;
+    cg_var *cvt = NULL;
+
+    if (yv->yv_restypestr && strcmp(yv->yv_restypestr, "union") == 0){ /* recursive union */
+        retval = yv_validate_union(h, ys, yv, val, NULL, reason);
+        goto done;
+    }
+    if (yv->yv_restypestr && strcmp(yv->yv_restypestr, "leafref") == 0){
+        retval = yv_validate_leafref(h, val, ys, yv, NULL, reason);
+        goto done;
+    }
+    if (val == NULL){ /* Fail validation on NULL */
+        retval = 0;
+        goto done;
+    }
+    /* reparse value with the member type */
+    if ((cvt = cv_new(yv->yv_cvtype)) == NULL){
+        clixon_err(OE_UNIX, errno, "cv_new");
+        goto done;
+    }
+    if (yv->yv_cvtype == CGV_DEC64)
+        cv_dec64_n_set(cvt, yv->yv_fraction);
+    if ((retval = cv_parse1(val, cvt, reason)) < 0){
+        clixon_err(OE_UNIX, errno, "cv_parse");
+        goto done;
+    }
+    if (retval == 0)
+        goto done;
+    retval = cv_validate1(h, cvt, yv->yv_cvtype, yv->yv_options, yv->yv_cvv,
+                          yv->yv_regexps, yv->yv_restype, yv->yv_restypestr, reason);
+ done:
+    if (cvt)
+        cv_free(cvt);
+    return retval;
+}
+
+/*! Validate value string with union validator
+ *
+ * If the matching member is not requested, the member that matched last time is tried
+ * first. Otherwise members are tried in declared order.
+ * Members that cannot match the first char of the value are skipped, see
+ * yang_validator_classify.
+ * If no member matches, the reason is that of the last member in declared order.
+ * @see ys_cv_validate_union  non-compiled variant
+ */
+static int
+yv_validate_union1(clixon_handle          h,
+                   yang_stmt             *ys,
+                   struct yang_validator *yv,
+                   char                  *val,
+                   yang_stmt            **ysubp,
+                   char                 **reason,
+                   int                    classify,
+                   int                   *skipped)
+{
+    int   retval = 0;
+    char *reason1 = NULL;  /* saved reason */
+    int   ri = -1;         /* member of saved reason */
+    int   first;
+    int   k;
+    int   i;
+    int   c;
+
+    c = val ? val[0] : '\0';
+    first = ysubp ? 0 : yv->yv_hot;
+    for (k=0; k<yv->yv_len; k++){
+        i = (k == 0) ? first : (k <= first ? k - 1 : k);
+        if (classify && yv->yv_vec[i].yv_classify && !YV_FIRST_ISSET(&yv->yv_vec[i], c)){
+            (*skipped)++;
+            continue;
+        }
+        if ((retval = yv_validate_one(h, ys, &yv->yv_vec[i], val, reason)) < 0)
+            goto done;
+        if (retval == 1){
+            yv->yv_hot = i;
+            if (ysubp)
+                *ysubp = yv->yv_vec[i].yv_ytype;
+            break;
+        }
+        if (reason && *reason != NULL){
+            if (i > ri){
+                if (reason1)
+                    free(reason1);
+                reason1 = *reason;
+                ri = i;
+            }
+            else
+                free(*reason);
+            *reason = NULL;
+        }
+    }
+ done:
+    if (retval == 0 && reason1){
+        *reason = reason1;
+        reason1 = NULL;
+    }
+    if (reason1)
+        free(reason1);
+    return retval;
+}
+
+static int
+yv_validate_union(clixon_handle          h,
+                  yang_stmt             *ys,
+                  struct yang_validator *yv,
+                  char                  *val,
+                  yang_stmt            **ysubp,
+                  char                 **reason)
+{
+    int retval;
+    int skipped = 0;
+
+    if ((retval = yv_validate_union1(h, ys, yv, val, ysubp, reason, 1, &skipped)) != 0)
+        return retval;
+    /* No match: try skipped members for the same reason as without classification */
+    if (skipped && reason){
+        if (*reason){
+            free(*reason);
+            *reason = NULL;
+        }
+        retval = yv_validate_union1(h, ys, yv, val, ysubp, reason, 0, &skipped);
+    }
+    return retval;
+}
+#endif /* YANG_TYPE_VALIDATOR */
+
 /*! Validate cligen variable cv using yang statement as spec
  *
  * @param[in]  h       Clixon handle     
@@ -1040,10 +1446,15 @@ ys_cv_validate(clixon_handle h,
     char           *origtype = NULL;  /* orig type */
     yang_stmt      *yrestype = NULL; /* resolved type */
     char           *restype;
-    uint8_t         fraction = 0;
     int             retval2;
     char           *val;
     cg_var         *cvt = NULL;
+    cvec           *rxs;      /* compiled regexps */
+#ifdef YANG_TYPE_VALIDATOR
+    struct yang_validator *yv;
+#else
+    uint8_t         fraction = 0;
+#endif
 
     if (reason)
         *reason=NULL;
@@ -1052,6 +1463,16 @@ ys_cv_validate(clixon_handle h,
         goto done;
     }
     ycv = yang_cv_get(ys);
+#ifdef YANG_TYPE_VALIDATOR
+    if (yang_validator_ys(ys, &yv) < 0)
+        goto done;
+    yrestype = yv->yv_restype;
+    restype = yv->yv_restypestr;
+    cvtype = yv->yv_cvtype;
+    options = yv->yv_options;
+    cvv = yv->yv_cvv;
+    rxs = yv->yv_regexps;
+#else
     if ((patterns = cvec_new(0)) == NULL){
         clixon_err(OE_UNIX, errno, "cvec_new");
         goto done;
@@ -1069,6 +1490,8 @@ ys_cv_validate(clixon_handle h,
     restype = yrestype?yang_argument_get(yrestype):NULL;
     if (clicon_type2cv(origtype, restype, ys, &cvtype) < 0)
         goto done;
+    rxs = regexps;
+#endif /* YANG_TYPE_VALIDATOR */
     if (cv_type_get(ycv) != cvtype){
         /* special case: dbkey has rest syntax-> cv but yang cant have that */
         if (cvtype == CGV_STRING && cv_type_get(ycv) == CGV_REST)
@@ -1090,8 +1513,13 @@ ys_cv_validate(clixon_handle h,
          */
         if ((val = cv_string_get(cv)) == NULL)
             val = "";
+#ifdef YANG_TYPE_VALIDATOR
+        if ((retval2 = yv_validate_union(h, ys, yv, val, ysub, reason)) < 0)
+            goto done;
+#else
         if ((retval2 = ys_cv_validate_union(h, ys, reason, yrestype, origtype, val, ysub)) < 0)
             goto done;
+#endif
         retval = retval2; /* invalid (0) with latest reason or valid 1 */
     }
     else{
@@ -1114,11 +1542,15 @@ ys_cv_validate(clixon_handle h,
              */
             if ((val = cv_string_get(cv)) == NULL)
                 val = "";
+#ifdef YANG_TYPE_VALIDATOR
+            retval = yv_validate_leafref(h, val, ys, yv, ysub, reason);
+#else
             retval = ys_cv_validate_leafref(h, val, ys, yrestype, ysub, reason);
+#endif
             goto done;
         }
         if ((retval = cv_validate1(h, cv, cvtype, options, cvv,
-                                   regexps, yrestype, restype, reason)) < 0)
+                                   rxs, yrestype, restype, reason)) < 0)
             goto done;
         if (ysub)
             *ysub = ys;
@@ -0,0 +1,595 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+ 
+  Copyright (C) 2009-2016 Olof Hagsand and Benny Holmgren
+  Copyright (C) 2017-2019 Olof Hagsand
+  Copyright (C) 2020-2022 Olof Hagsand and Rubicon Communications, LLC (Netgate)
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2, 
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+
+ * Microbenchmarks of clixon library functions, see test/bench/README.md
+ * Generates a tree of a YANG list with n entries (3n+1 elements), and times:
+ * XML parse and print, YANG bind, sort, index lookup, XPath, diff and validation.
+ * Results are printed as one JSON object on stdout.
+ * Usage: clixon_bench [-n <entries>] [-r <repetitions>] [-l <lookups>]
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <unistd.h>
+#include <errno.h>
+#include <syslog.h>
+#include <sys/time.h>
+
+/* cligen */
+#include <cligen/cligen.h>
+
+/* clixon */
+#include <clixon/clixon.h>
+
+/* Command line options to be passed to getopt(3) */
+#define BENCH_OPTS "hn:r:l:D:"
+
+#define BENCH_NS "urn:example:bench"
+
+/* Benchmark YANG, list entries are key k, and leafs v and w */
+static const char *bench_yang =
+    "module bench{\n"
+    "  yang-version 1.1;\n"
+    "  namespace \"" BENCH_NS "\";\n"
+    "  prefix b;\n"
+    "  container c{\n"
+    "    list x{\n"
+    "      key k;\n"
+    "      leaf k{ type int32; }\n"
+    "      leaf v{ type string; }\n"
+    "      leaf w{ type int32{ range \"0..1000000000\"; } }\n"
+    "    }\n"
+    "  }\n"
+    "}\n";
+
+/*! Timing of one benchmark
+ */
+struct bench_result {
+    const char *br_name;     /* Benchmark name */
+    int         br_ops;      /* Operations per repetition */
+    uint64_t   *br_usec;     /* Time in microseconds of each repetition */
+};
+
+/* Number of repetitions of each benchmark */
+static int _reps = 3;
+
+/* Benchmark results printed on exit */
+static struct bench_result *_results = NULL;
+static int                  _nresults = 0;
+
+/*! Current time in microseconds
+ */
+static uint64_t
+bench_usec(void)
+{
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+    return (uint64_t)tv.tv_sec*1000000 + tv.tv_usec;
+}
+
+/*! Start a new benchmark
+ *
+ * @param[in]  name  Benchmark name
+ * @param[in]  ops   Operations per repetition
+ * @retval     br    Benchmark result
+ * @retval     NULL  Error
+ */
+static struct bench_result *
+bench_new(const char *name,
+          int         ops)
+{
+    struct bench_result *br;
+
+    if ((_results = realloc(_results, (_nresults+1)*sizeof(*_results))) == NULL){
+        clixon_err(OE_UNIX, errno, "realloc");
+        return NULL;
+    }
+    br = &_results[_nresults++];
+    br->br_name = name;
+    br->br_ops = ops;
+    if ((br->br_usec = calloc(_reps, sizeof(uint64_t))) == NULL){
+        clixon_err(OE_UNIX, errno, "calloc");
+        return NULL;
+    }
+    return br;
+}
+
+static int
+bench_cmp(const void *a,
+          const void *b)
+{
+    uint64_t ua = *(uint64_t*)a;
+    uint64_t ub = *(uint64_t*)b;
+
+    return ua < ub ? -1 : ua > ub;
+}
+
+/*! Print results as JSON and free them
+ *
+ * @param[in]  f        Output file
+ * @param[in]  entries  Number of list entries
+ */
+static void
+bench_print(FILE *f,
+            int   entries)
+{
+    struct bench_result *br;
+    int                  i;
+
+    fprintf(f, "{\"entries\":%d,\"nodes\":%d,\"reps\":%d,\"results\":[",
+            entries, 3*entries+1, _reps);
+    for (i=0; i<_nresults; i++){
+        br = &_results[i];
+        qsort(br->br_usec, _reps, sizeof(uint64_t), bench_cmp);
+        fprintf(f, "%s{\"name\":\"%s\",\"ops\":%d,\"usec_min\":%" PRIu64 ",\"usec_median\":%" PRIu64 "}",
+                i?",":"", br->br_name, br->br_ops, br->br_usec[0], br->br_usec[_reps/2]);
+        free(br->br_usec);
+    }
+    fprintf(f, "]}\n");
+    if (_results)
+        free(_results);
+    _results = NULL;
+    _nresults = 0;
+}
+
+/*! Generate XML of n list entries
+ *
+ * @param[in]  n        Number of entries
+ * @param[in]  reverse  Generate keys in descending order, ie unsorted
+ * @retval     cb       XML string, free with cbuf_free
+ * @retval     NULL     Error
+ */
+static cbuf *
+bench_xml_gen(int n,
+              int reverse)
+{
+    cbuf *cb;
+    int   i;
+    int   k;
+
+    if ((cb = cbuf_new()) == NULL){
+        clixon_err(OE_UNIX, errno, "cbuf_new");
+        return NULL;
+    }
+    cprintf(cb, "<c xmlns=\"%s\">", BENCH_NS);
+    for (i=0; i<n; i++){
+        k = reverse ? n-1-i : i;
+        cprintf(cb, "<x><k>%d</k><v>v%d</v><w>%d</w></x>", k, k, k);
+    }
+    cprintf(cb, "</c>");
+    return cb;
+}
+
+/*! Parse XML string and bind it to YANG, untimed setup of other benchmarks
+ */
+static cxobj *
+bench_parse(const char *str,
+            yang_stmt  *yspec)
+{
+    cxobj *xt = NULL;
+
+    if (clixon_xml_parse_string(str, YB_MODULE, yspec, &xt, NULL) < 1){
+        clixon_err(OE_XML, 0, "bench parse failed");
+        if (xt)
+            xml_free(xt);
+        return NULL;
+    }
+    return xt;
+}
+
+/*! Run all benchmarks on n list entries
+ *
+ * @param[in]  h        Clixon handle
+ * @param[in]  yspec    Yang spec of bench yang
+ * @param[in]  n        Number of list entries
+ * @param[in]  lookups  Number of lookups in lookup benchmarks
+ * @retval     0        OK
+ * @retval    -1        Error
+ */
+static int
+bench_run(clixon_handle h,
+          yang_stmt    *yspec,
+          int           n,
+          int           lookups)
+{
+    int                  retval = -1;
+    struct bench_result *br;
+    cbuf                *cbs = NULL;     /* XML sorted */
+    cbuf                *cbr = NULL;     /* XML reverse */
+    cbuf                *cb = NULL;
+    cxobj               *xt = NULL;
+    cxobj               *x1 = NULL;
+    cxobj               *xerr = NULL;
+    cxobj               *x;
+    cxobj              **vec = NULL;
+    size_t               veclen;
+    cxobj              **first = NULL;
+    cxobj              **second = NULL;
+    cxobj              **changed0 = NULL;
+    cxobj              **changed1 = NULL;
+    size_t               firstlen;
+    size_t               secondlen;
+    size_t               changedlen;
+    cvec                *nsc = NULL;
+    cvec                *cvk = NULL;
+    clixon_xvec         *xv = NULL;
+    yang_stmt           *yc;
+    char                 kstr[16];
+    uint64_t             t0;
+    int                  r;
+    int                  i;
+    int                  ret;
+
+    if ((cbs = bench_xml_gen(n, 0)) == NULL)
+        goto done;
+    if ((cbr = bench_xml_gen(n, 1)) == NULL)
+        goto done;
+    if ((cb = cbuf_new()) == NULL){
+        clixon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    if ((nsc = xml_nsctx_init(NULL, BENCH_NS)) == NULL)
+        goto done;
+    /* XML parse without YANG */
+    if ((br = bench_new("xml_parse", 1)) == NULL)
+        goto done;
+    for (r=0; r<_reps; r++){
+        t0 = bench_usec();
+        if (clixon_xml_parse_string(cbuf_get(cbs), YB_NONE, NULL, &xt, NULL) < 0)
+            goto done;
+        br->br_usec[r] = bench_usec() - t0;
+        xml_free(xt);
+        xt = NULL;
+    }
+    /* XML parse with YANG bind and sort */
+    if ((br = bench_new("xml_parse_bind", 1)) == NULL)
+        goto done;
+    for (r=0; r<_reps; r++){
+        t0 = bench_usec();
+        if ((xt = bench_parse(cbuf_get(cbs), yspec)) == NULL)
+            goto done;
+        br->br_usec[r] = bench_usec() - t0;
+        xml_free(xt);
+        xt = NULL;
+    }
+    /* xml_bind_yang */
+    if ((br = bench_new("xml_bind_yang", 1)) == NULL)
+        goto done;
+    for (r=0; r<_reps; r++){
+        if (clixon_xml_parse_string(cbuf_get(cbs), YB_NONE, NULL, &xt, NULL) < 0)
+            goto done;
+        t0 = bench_usec();
+        if ((ret = xml_bind_yang(h, xt, YB_MODULE, yspec, 0, &xerr)) < 0)
+            goto done;
+        br->br_usec[r] = bench_usec() - t0;
+        if (ret == 0){
+            clixon_err(OE_YANG, 0, "bench bind failed");
+            goto done;
+        }
+        xml_free(xt);
+        xt = NULL;
+    }
+    /* xml_sort of reverse ordered entries */
+    if ((br = bench_new("xml_sort", 1)) == NULL)
+        goto done;
+    for (r=0; r<_reps; r++){
+        if (clixon_xml_parse_string(cbuf_get(cbr), YB_NONE, NULL, &xt, NULL) < 0)
+            goto done;
+        if (xml_bind_yang(h, xt, YB_MODULE, yspec, 0, NULL) < 1)
+            goto done;
+        t0 = bench_usec();
+        if (xml_sort_recurse(xt) < 0)
+            goto done;
+        br->br_usec[r] = bench_usec() - t0;
+        xml_free(xt);
+        xt = NULL;
+    }
+    if ((xt = bench_parse(cbuf_get(cbs), yspec)) == NULL)
+        goto done;
+    /* XML print */
+    if ((br = bench_new("xml_print", 1)) == NULL)
+        goto done;
+    for (r=0; r<_reps; r++){
+        cbuf_reset(cb);
+        t0 = bench_usec();
+        if (clixon_xml2cbuf(cb, xt, 0, 0, NULL, -1, 0) < 0)
+            goto done;
+        br->br_usec[r] = bench_usec() - t0;
+    }
+    /* clixon_xml_find_index of random keys */
+    if ((x = xml_find_type(xt, NULL, "c", CX_ELMNT)) == NULL){
+        clixon_err(OE_XML, 0, "c not found");
+        goto done;
+    }
+    yc = xml_spec(x);
+    if ((cvk = cvec_new(0)) == NULL){
+        clixon_err(OE_UNIX, errno, "cvec_new");
+        goto done;
+    }
+    if (cvec_add_string(cvk, "k", "0") < 0){
+        clixon_err(OE_UNIX, errno, "cvec_add_string");
+        goto done;
+    }
+    if ((xv = clixon_xvec_new()) == NULL)
+        goto done;
+    if ((br = bench_new("clixon_xml_find_index", lookups)) == NULL)
+        goto done;
+    srandom(n);
+    for (r=0; r<_reps; r++){
+        t0 = bench_usec();
+        for (i=0; i<lookups; i++){
+            snprintf(kstr, sizeof(kstr), "%ld", random()%n);
+            if (cv_string_set(cvec_i(cvk, 0), kstr) == NULL){
+                clixon_err(OE_UNIX, errno, "cv_string_set");
+                goto done;
+            }
+            if (clixon_xml_find_index(x, yc, NULL, "x", cvk, xv) < 0)
+                goto done;
+            if (clixon_xvec_len(xv) != 1){
+                clixon_err(OE_XML, 0, "key %s not found", kstr);
+                goto done;
+            }
+            if (clixon_xvec_rm_pos(xv, 0) < 0)
+                goto done;
+        }
+        br->br_usec[r] = bench_usec() - t0;
+    }
+    /* xpath_vec key lookups */
+    if ((br = bench_new("xpath_vec_key", lookups)) == NULL)
+        goto done;
+    for (r=0; r<_reps; r++){
+        t0 = bench_usec();
+        for (i=0; i<lookups; i++){
+            if (xpath_vec(xt, nsc, "/c/x[k='%ld']", &vec, &veclen, random()%n) < 0)
+                goto done;
+            if (vec){
+                free(vec);
+                vec = NULL;
+            }
+        }
+        br->br_usec[r] = bench_usec() - t0;
+    }
+    /* xpath_vec of all leafs */
+    if ((br = bench_new("xpath_vec_all", 1)) == NULL)
+        goto done;
+    for (r=0; r<_reps; r++){
+        t0 = bench_usec();
+        if (xpath_vec(xt, nsc, "/c/x/v", &vec, &veclen) < 0)
+            goto done;
+        br->br_usec[r] = bench_usec() - t0;
+        if (vec){
+            free(vec);
+            vec = NULL;
+        }
+    }
+    /* xpath_vec with non-key predicate, linear scan */
+    if ((br = bench_new("xpath_vec_nonkey", 1)) == NULL)
+        goto done;
+    for (r=0; r<_reps; r++){
+        t0 = bench_usec();
+        if (xpath_vec(xt, nsc, "/c/x[v='v%d']", &vec, &veclen, n/2) < 0)
+            goto done;
+        br->br_usec[r] = bench_usec() - t0;
+        if (vec){
+            free(vec);
+            vec = NULL;
+        }
+    }
+    /* xml_diff with every 100th entry changed */
+    if ((x1 = xml_dup(xt)) == NULL)
+        goto done;
+    for (i=0; i<n; i+=100){
+        if ((x = xpath_first(x1, nsc, "/c/x[k='%d']/v", i)) != NULL &&
+            xml_body_get(x) != NULL &&
+            xml_value_set(xml_body_get(x), "changed") < 0)
+            goto done;
+    }
+    if ((br = bench_new("xml_diff", 1)) == NULL)
+        goto done;
+    for (r=0; r<_reps; r++){
+        t0 = bench_usec();
+        if (xml_diff(xt, x1,
+                     &first, &firstlen,
+                     &second, &secondlen,
+                     &changed0, &changed1, &changedlen) < 0)
+            goto done;
+        br->br_usec[r] = bench_usec() - t0;
+        if (first){
+            free(first);
+            first = NULL;
+        }
+        if (second){
+            free(second);
+            second = NULL;
+        }
+        if (changed0){
+            free(changed0);
+            changed0 = NULL;
+        }
+        if (changed1){
+            free(changed1);
+            changed1 = NULL;
+        }
+    }
+    /* Validation */
+    if ((br = bench_new("xml_yang_validate_all", 1)) == NULL)
+        goto done;
+    for (r=0; r<_reps; r++){
+        t0 = bench_usec();
+        if ((ret = xml_yang_validate_all_state(h, xt, 0, &xerr)) < 0)
+            goto done;
+        br->br_usec[r] = bench_usec() - t0;
+        if (ret == 0){
+            clixon_err(OE_YANG, 0, "bench validate failed");
+            goto done;
+        }
+    }
+    if ((br = bench_new("xml_yang_validate_add", 1)) == NULL)
+        goto done;
+    for (r=0; r<_reps; r++){
+        t0 = bench_usec();
+        if ((ret = xml_yang_validate_add(h, xt, &xerr)) < 0)
+            goto done;
+        br->br_usec[r] = bench_usec() - t0;
+        if (ret == 0){
+            clixon_err(OE_YANG, 0, "bench validate failed");
+            goto done;
+        }
+    }
+    bench_print(stdout, n);
+    retval = 0;
+ done:
+    if (xv)
+        clixon_xvec_free(xv);
+    if (cvk)
+        cvec_free(cvk);
+    if (nsc)
+        cvec_free(nsc);
+    if (vec)
+        free(vec);
+    if (xerr)
+        xml_free(xerr);
+    if (x1)
+        xml_free(x1);
+    if (xt)
+        xml_free(xt);
+    if (cb)
+        cbuf_free(cb);
+    if (cbs)
+        cbuf_free(cbs);
+    if (cbr)
+        cbuf_free(cbr);
+    return retval;
+}
+
+static void
+usage(char *argv0)
+{
+    fprintf(stderr, "usage:%s [options]\n"
+            "where options are\n"
+            "\t-h \t\tHelp\n"
+            "\t-D <level> \tDebug\n"
+            "\t-n <entries> \tNumber of list entries, default 1000\n"
+            "\t-r <reps> \tRepetitions of each benchmark, default 3\n"
+            "\t-l <lookups> \tLookups in lookup benchmarks, default 1000\n",
+            argv0);
+    exit(0);
+}
+
+int
+main(int    argc,
+     char **argv)
+{
+    int           retval = -1;
+    clixon_handle h = NULL;
+    yang_stmt    *yspec;
+    char          dir[] = "/tmp/clixon_benchXXXXXX";
+    char          filename[64] = {0,};
+    FILE         *f;
+    int           n = 1000;
+    int           lookups = 1000;
+    int           dbg = 0;
+    int           c;
+
+    if ((h = clixon_handle_init()) == NULL)
+        goto done;
+    clixon_log_init(h, "clixon_bench", LOG_NOTICE, CLIXON_LOG_STDERR);
+    optind = 1;
+    opterr = 0;
+    while ((c = getopt(argc, argv, BENCH_OPTS)) != -1)
+        switch (c) {
+        case 'h':
+            usage(argv[0]);
+            break;
+        case 'D':
+            if ((dbg = clixon_debug_str2key(optarg)) < 0 &&
+                sscanf(optarg, "%d", &dbg) != 1)
+                usage(argv[0]);
+            break;
+        case 'n':
+            if ((n = atoi(optarg)) <= 0)
+                usage(argv[0]);
+            break;
+        case 'r':
+            if ((_reps = atoi(optarg)) <= 0)
+                usage(argv[0]);
+            break;
+        case 'l':
+            if ((lookups = atoi(optarg)) <= 0)
+                usage(argv[0]);
+            break;
+        default:
+            usage(argv[0]);
+            break;
+        }
+    clixon_debug_init(h, dbg);
+    if (yang_init(h) < 0)
+        goto done;
+    if (yang_start(h) < 0)
+        goto done;
+    if ((yspec = yspec_new1(h, YANG_DOMAIN_TOP, YANG_DATA_TOP)) == NULL)
+        goto done;
+    /* Parse bench yang via file, so that the normal post-processing is made */
+    if (mkdtemp(dir) == NULL){
+        clixon_err(OE_UNIX, errno, "mkdtemp");
+        goto done;
+    }
+    snprintf(filename, sizeof(filename), "%s/bench.yang", dir);
+    if ((f = fopen(filename, "w")) == NULL){
+        clixon_err(OE_UNIX, errno, "fopen(%s)", filename);
+        goto done;
+    }
+    fprintf(f, "%s", bench_yang);
+    fclose(f);
+    if (yang_spec_parse_file(h, filename, yspec) < 0)
+        goto done;
+    if (bench_run(h, yspec, n, lookups) < 0)
+        goto done;
+    retval = 0;
+ done:
+    if (strlen(filename)){
+        unlink(filename);
+        rmdir(dir);
+    }
+    if (h){
+        yang_exit(h);
+        clixon_handle_exit(h);
+    }
+    return retval==0?0:-1;
+}
@@ -0,0 +1,42 @@
+#!/usr/bin/env bash
+# Run a complexity fuzzing test using PerfFuzz or american fuzzy lop
+# Searches for inputs that maximize execution cost instead of inputs that crash
+# Add input strings in input/<target>, see targets.sh for targets
+set -eux
+
+if [ $# -ne 1 ]; then
+    echo "usage: $0 xml|xpath|netconf|restconf"
+    exit 255
+fi
+target=$1
+
+# Fuzzer, set PERFFUZZ=true if afl-fuzz is PerfFuzz to maximize per-edge execution counts
+: ${AFL:=afl-fuzz}
+: ${PERFFUZZ:=false}
+
+MEGS=500 # memory limit for child process (50 MB)
+TMO=200  # exec timeout in ms, slower inputs are saved in output/<target>/hangs
+
+. ./targets.sh
+target_setup $target
+
+# remove output dir
+test ! -d output/$target || sudo rm -rf output/$target
+
+# create if dirs dont exists
+test -d output || mkdir output
+
+opts="-i input/$target -o output/$target -m $MEGS -t $TMO"
+if [ -n "$dict" ]; then
+    opts="$opts -x $dict"
+fi
+if $PERFFUZZ; then
+    opts="$opts -p"
+fi
+
+# Run script
+if [ -n "$preload" ]; then
+    sudo LD_PRELOAD="$preload" $AFL $opts -d -- $cmd
+else
+    $AFL $opts -- $cmd
+fi
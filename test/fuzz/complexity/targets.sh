@@ -0,0 +1,138 @@
+#!/usr/bin/env bash
+# Complexity fuzzing targets, sourced by runfuzz.sh and triage.sh
+# Sets up config, yang and data of a target, and sets:
+#   cmd     Command reading one input on stdin
+#   dict    AFL dictionary, or empty
+#   preload LD_PRELOAD of cmd, or empty
+# Targets:
+#   xml      clixon_util_xml parsing XML, eg deeply nested XML
+#   xpath    clixon_util_xpath on a nested XML tree, eg XPaths with exponential blowup
+#   netconf  clixon_netconf with backend, eg ordered-by user insert sequences
+#   restconf clixon_restconf with backend using preeny desock, eg long api-paths
+
+APPNAME=example
+cfg=$(pwd)/conf.xml
+fyang=$(pwd)/complexity.yang
+xml=$(pwd)/nested.xml
+
+# Depth and fan-out of the nested XML tree of the xpath target
+: ${depth:=8}
+: ${fanout:=3}
+
+# Print nested tree of <a> elements
+# @param[in] d  Depth
+function nested_xml()
+{
+    local d=$1
+    local i
+
+    if [ $d -eq 0 ]; then
+        echo -n "<b>$RANDOM</b>"
+        return
+    fi
+    echo -n "<a>"
+    for (( i=0; i<$fanout; i++ )); do
+        nested_xml $(( d - 1 ))
+    done
+    echo -n "</a>"
+}
+
+# Write yang and config of backend targets and (re)start the backend
+function backend_setup()
+{
+    cat <<EOF > $fyang
+module complexity{
+    yang-version 1.1;
+    namespace "urn:example:complexity";
+    prefix cx;
+    container c{
+        list u{
+            ordered-by user;
+            key k;
+            leaf k{
+                type string;
+            }
+            leaf v{
+                type string;
+            }
+        }
+        leaf-list l{
+            ordered-by user;
+            type string;
+        }
+        list s{
+            key "k1 k2";
+            leaf k1{
+                type string;
+            }
+            leaf k2{
+                type string;
+            }
+            container c{
+                list s{
+                    key k;
+                    leaf k{
+                        type string;
+                    }
+                }
+            }
+        }
+    }
+}
+EOF
+    cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_FEATURE>clixon-restconf:allow-auth-none</CLICON_FEATURE>
+  <CLICON_YANG_DIR>/usr/local/share/clixon</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/$APPNAME/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/$APPNAME/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>/usr/local/var/$APPNAME</CLICON_XMLDB_DIR>
+  <CLICON_STARTUP_MODE>init</CLICON_STARTUP_MODE>
+  <CLICON_NETCONF_HELLO_OPTIONAL>true</CLICON_NETCONF_HELLO_OPTIONAL>
+  <restconf><enable>true</enable><auth-type>none</auth-type><socket><namespace>default</namespace><address>0.0.0.0</address><port>80</port><ssl>false</ssl></socket></restconf>
+</clixon-config>
+EOF
+    # Kill previous
+    sudo clixon_backend -z -f $cfg -s init
+    # Start backend
+    sudo clixon_backend -f $cfg -s init
+}
+
+# Set up a target
+# @param[in] target  xml, xpath, netconf or restconf
+function target_setup()
+{
+    target=$1
+    dict=""
+    preload=""
+    case $target in
+        xml)
+            cmd="clixon_util_xml"
+            dict=../netconf/xml.dict
+            ;;
+        xpath)
+            nested_xml $depth > $xml
+            cmd="clixon_util_xpath -f $xml"
+            ;;
+        netconf)
+            backend_setup
+            cmd="clixon_netconf -qf $cfg"
+            dict=../netconf/xml.dict
+            ;;
+        restconf)
+            if [ ! -x /usr/local/lib/desock.so ] ; then
+                echo "preeny desock.so not found"
+                exit 255
+            fi
+            backend_setup
+            cmd="/usr/local/sbin/clixon_restconf -rf $cfg"
+            preload=/usr/local/lib/desock.so
+            ;;
+        *)
+            echo "unknown target: $target"
+            exit 255
+            ;;
+    esac
+}
@@ -0,0 +1,43 @@
+#!/usr/bin/env bash
+# Rank inputs found by runfuzz.sh by CPU time and memory per input byte
+# Prints: CPU us, max RSS KB, input bytes, CPU ns per byte, RSS bytes per byte, file
+# Copies the top inputs to hits/<target> if -c is given, where they are run as regression
+# tests with a time budget by test/test_perf_complexity.sh
+set -eu
+
+if [ $# -lt 1 -o $# -gt 3 ]; then
+    echo "usage: $0 xml|xpath|netconf|restconf [<n>] [-c]"
+    exit 255
+fi
+target=$1
+n=${2:-10}
+copy=${3:-}
+
+TMO=10 # max run time of one input in s
+
+. ./targets.sh
+target_setup $target
+
+tmp=$(mktemp)
+res=$(mktemp)
+find output/$target -type f \( -path "*/queue/id*" -o -path "*/hangs/id*" \) | while read f; do
+    bytes=$(wc -c < $f)
+    if [ $bytes -eq 0 ]; then
+        continue
+    fi
+    if [ -n "$preload" ]; then
+        sudo LD_PRELOAD="$preload" /usr/bin/time -f "%U %S %M" -o $tmp timeout $TMO $cmd < $f > /dev/null 2>&1 || true
+    else
+        /usr/bin/time -f "%U %S %M" -o $tmp timeout $TMO $cmd < $f > /dev/null 2>&1 || true
+    fi
+    tail -1 $tmp | awk -v b=$bytes -v f=$f '{ us = ($1 + $2) * 1000000; printf "%d %d %d %d %d %s\n", us, $3, b, us*1000/b, $3*1024/b, f }'
+done | sort -n -r -k4 | head -n $n > $res
+cat $res
+
+if [ "$copy" = "-c" ]; then
+    test -d hits/$target || mkdir -p hits/$target
+    awk '{print $6}' $res | while read f; do
+        cp $f hits/$target/$(sha1sum $f | cut -c1-16)
+    done
+fi
+rm -f $tmp $res
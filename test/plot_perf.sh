@@ -8,7 +8,23 @@
 #    run=false plot=true resdir=/tmp/plots term=x11 ./plot_perf.sh
 # 3. Use existing data plot i686 and armv7l data as png
 #    archs="i686 armv7l" run=false plot=true resdir=/tmp/plots term=png ./plot_perf.sh 
-# Need gnuplot installed
+# 4. Run all scenarios and compare with an earlier run, fail if more than 20% slower
+#    scenarios="flat nested openconfig nacm privcand multidb" baseline=/tmp/base.csv ./plot_perf.sh
+# Need gnuplot installed for plotting
+#
+# Scenarios:
+#   flat       List of <step>..<to> entries with a key and a leaf
+#   nested     As flat but each entry has a nested list of <nest> entries
+#   openconfig openconfig-interfaces, needs OPENCONFIG (skipped otherwise)
+#   nacm       As flat with external NACM file permitting all
+#   privcand   As flat with private candidate (no commit operation measured)
+#   multidb    As flat with multi-file datastores (CLICON_XMLDB_MULTI)
+# All results are written as CSV to <csv>, and as JSON to <json>, one row per
+# measurement with: scenario,op,proto,reqs,state,entries,seconds,ops_per_s,latency_ms
+# where reqs=0 means all entries in one request.
+# If <baseline> is set to an earlier CSV, latency is compared per row and rows more
+# than <threshold> percent slower are reported as regressions (also if run=false)
+# Plots are made of the flat scenario
 
 set -u
 
@@ -27,6 +43,12 @@ arch=$(arch)
 : ${archs=$arch} # Plotting can be made for many architectures (not run)
 : ${protos="netconf restconf"}
 : ${state=true} # Generate state data and netconf get state plot
+: ${scenarios="flat"} # Scenarios to run, see above
+: ${nest=10} # Nested list entries in each entry in nested scenario
+: ${csv=$resdir/perf-$arch.csv} # Result file in CSV
+: ${json=$resdir/perf-$arch.json} # Result file in JSON
+: ${baseline=} # Earlier CSV result file to compare with
+: ${threshold=20} # Regression threshold in percent
 
 # 0 prefix to protect against shell dynamic binding)
 to0=$to
@@ -42,6 +64,7 @@ fyang=$dir/scaling.yang
 fstate=$dir/state.xml
 fxml=$dir/data.xml
 fjson=$dir/data.json
+nacmfile=$dir/nacm.xml
 
 if [ ! -d $resdir ]; then
     mkdir $resdir
@@ -52,11 +75,100 @@ fi
 # clixon_netconf="valgrind --tool=callgrind clixon_netconf 
 clixon_netconf=clixon_netconf
 
-cat <<EOF > $fyang
+RESTCONFIG=$(restconf_config none false)
+
+# NACM permitting all for the users running the test, used in nacm scenario
+cat <<EOF > $nacmfile
+<nacm xmlns="urn:ietf:params:xml:ns:yang:ietf-netconf-acm">
+  <enable-nacm>true</enable-nacm>
+  <read-default>deny</read-default>
+  <write-default>deny</write-default>
+  <exec-default>deny</exec-default>
+  <groups>
+    <group>
+      <name>perf</name>
+      <user-name>root</user-name>
+      <user-name>$(whoami)</user-name>
+      <user-name>anonymous</user-name>
+    </group>
+  </groups>
+  <rule-list>
+    <name>perf-acl</name>
+    <group>perf</group>
+    <rule>
+      <name>permit-all</name>
+      <module-name>*</module-name>
+      <access-operations>*</access-operations>
+      <action>permit</action>
+    </rule>
+  </rule-list>
+</nacm>
+EOF
+
+# Set up yang, config and data model variables of a scenario
+# args:
+# 1: <scenario>  See scenarios above
+# Sets: sc pre TOP NS LIST KEY KPRE RCMOD scstate nested
+# Returns 1 if scenario cannot be run
+function scenario()
+{
+    sc=$1
+    pre="$sc-" # Plot file prefix
+    if [ $sc = flat ]; then
+        pre=""
+    fi
+    # Data model: /TOP/LIST[KEY=KPRE<i>] in namespace NS, restconf module RCMOD
+    TOP=x
+    NS="urn:example:clixon"
+    LIST=y
+    KEY=a
+    KPRE=""
+    RCMOD=scaling
+    scstate=$state
+    nested=0
+    EXTRA=""
+    IMPORT=""
+    case $sc in
+        flat)
+            ;;
+        nested)
+            nested=$nest
+            ;;
+        openconfig)
+            if [ ! -d "$OPENCONFIG" ]; then
+                echo "...skipped: $sc: OPENCONFIG not set or dir not exist"
+                return 1
+            fi
+            TOP=interfaces
+            NS="http://openconfig.net/yang/interfaces"
+            LIST=interface
+            KEY=name
+            KPRE=e
+            RCMOD=openconfig-interfaces
+            scstate=false
+            EXTRA="<CLICON_YANG_DIR>$IETFRFC</CLICON_YANG_DIR><CLICON_YANG_DIR>$OPENCONFIG/release/models</CLICON_YANG_DIR>"
+            IMPORT="import openconfig-interfaces { prefix oc-if; } import iana-if-type { prefix ianaift; }"
+            ;;
+        nacm)
+            EXTRA="<CLICON_NACM_MODE>external</CLICON_NACM_MODE><CLICON_NACM_FILE>$nacmfile</CLICON_NACM_FILE><CLICON_NACM_CREDENTIALS>none</CLICON_NACM_CREDENTIALS>"
+            ;;
+        privcand)
+            EXTRA="<CLICON_FEATURE>ietf-netconf-private-candidate:private-candidate</CLICON_FEATURE><CLICON_YANG_DIR>$IETFRFC</CLICON_YANG_DIR><CLICON_XMLDB_PRIVATE_CANDIDATE>true</CLICON_XMLDB_PRIVATE_CANDIDATE>"
+            ;;
+        multidb)
+            EXTRA="<CLICON_XMLDB_MULTI>true</CLICON_XMLDB_MULTI>"
+            ;;
+        *)
+            err "Scenario not supported" "$sc"
+            ;;
+    esac
+
+    cat <<EOF > $fyang
 module scaling{
    yang-version 1.1;
    namespace "urn:example:clixon";
    prefix sc;
+   $IMPORT
    container x {
       description "top-level container";
       list y {
@@ -75,13 +187,22 @@ module scaling{
             type string;
             config false;
          }
+         list z {
+            description "Nested list, used in nested scenario";
+            key "c";
+            leaf c {
+               type int32;
+            }
+            leaf d {
+               type string;
+            }
+         }
       }
    }
 }
 EOF
 
-RESTCONFIG=$(restconf_config none false)
-cat <<EOF > $cfg
+    cat <<EOF > $cfg
 <clixon-config xmlns="http://clicon.org/config">
   <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
   <CLICON_FEATURE>ietf-netconf:startup</CLICON_FEATURE>
@@ -94,35 +215,73 @@ cat <<EOF > $cfg
   <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
   <CLICON_XMLDB_PRETTY>false</CLICON_XMLDB_PRETTY>
   <CLICON_VALIDATE_STATE_XML>false</CLICON_VALIDATE_STATE_XML>
+  $EXTRA
   $RESTCONFIG
 </clixon-config>
 EOF
+    return 0
+}
+
+# Set ex and ej to list entry i of current scenario in XML and JSON
+# args:
+# 1: <i>
+function entry()
+{
+    i=$1
+    if [ $sc = openconfig ]; then
+        ex="<interface><name>e$i</name><config><name>e$i</name><type xmlns:ianaift=\"urn:ietf:params:xml:ns:yang:iana-if-type\">ianaift:ethernetCsmacd</type><description>$i</description></config></interface>"
+        ej="{\"name\":\"e$i\",\"config\":{\"name\":\"e$i\",\"type\":\"iana-if-type:ethernetCsmacd\",\"description\":\"$i\"}}"
+        return
+    fi
+    ex="<y><a>$i</a><b>$i</b>"
+    ej="{\"a\":$i,\"b\":\"$i\""
+    if [ $nested -gt 0 ]; then
+        ej+=",\"z\":["
+        for (( j=0; j<$nested; j++ )); do
+            ex+="<z><c>$j</c><d>$j</d></z>"
+            if [ $j -ne 0 ]; then
+                ej+=","
+            fi
+            ej+="{\"c\":$j,\"d\":\"$j\"}"
+        done
+        ej+="]"
+    fi
+    ex+="</y>"
+    ej+="}"
+}
 
 # Generate file $fxml or $fjson with "nr" entries for PUT operations
 # arguments:
 # 1: <nr>
 # 2: <proto>  netconf(in xml) or json (for restconf)
+# 3: <commit> true: commit in same session (netconf only)
 function genfile()
 {
     new "genfile"
     nr=$1
     myproto=$2
+    mycommit=${3:-false}
 
     if [ $myproto = netconf ]; then
-        rpc="<rpc $DEFAULTNS><edit-config><target><candidate/></target><default-operation>replace</default-operation><config><x xmlns=\"urn:example:clixon\">"
+        rpc="<rpc $DEFAULTNS><edit-config><target><candidate/></target><default-operation>replace</default-operation><config><$TOP xmlns=\"$NS\">"
         for (( i=0; i<$nr; i++ )); do  
-            rpc+="<y><a>$i</a><b>$i</b></y>"
+            entry $i
+            rpc+="$ex"
         done
-        rpc+="</x></config></edit-config></rpc>"
+        rpc+="</$TOP></config></edit-config></rpc>"
         echo -n "$DEFAULTHELLO" > $fxml
         echo "$(chunked_framing "$rpc")" >> $fxml
+        if $mycommit; then
+            echo "$(chunked_framing "<rpc $DEFAULTNS><commit/></rpc>")" >> $fxml
+        fi
     else # json
-        echo -n '{"scaling:x":{"y":[' > $fjson
+        echo -n "{\"$RCMOD:$TOP\":{\"$LIST\":[" > $fjson
         for (( i=0; i<$nr; i++ )); do  
             if [ $i -ne 0 ]; then
                 echo -n ',' >> $fjson
             fi
-            echo -n "{\"a\":$i,\"b\":\"$i\"}" >> $fjson
+            entry $i
+            echo -n "$ej" >> $fjson
         done
         echo ']}}' >> $fjson
     fi
@@ -143,6 +302,66 @@ function genstate()
     echo "</x>" >> $fstate
 }
 
+# Append last measurement in a plot file as a row in the CSV file
+# args:
+# 1: <op>    put, get, commit, delete, startup
+# 2: <proto> netconf, restconf or backend
+# 3: <reqs>  =0 means all in one go
+# 4: <st>    true: Also get state data
+# 5: <file>  Plot file with lines: <entries> <seconds>
+function perfrecord()
+{
+    tail -1 $5 | awk -v sc=$sc -v op=$1 -v proto=$2 -v reqs=$3 -v st=$4 '
+        NF == 2 {
+            ops = reqs > 0 ? reqs : 1;
+            tput = $2 > 0 ? ops / $2 : 0;
+            printf "%s,%s,%s,%d,%s,%d,%s,%.2f,%.3f\n", sc, op, proto, reqs, st, $1, $2, tput, $2 * 1000 / ops;
+        }' >> $csv
+}
+
+# Convert the CSV file to a JSON array
+function perfjson()
+{
+    awk -F, '
+        NR == 1 { n = split($0, h, ","); printf "["; next }
+        {
+            printf "%s\n{", (NR > 2 ? "," : "");
+            for (i = 1; i <= n; i++) {
+                if ($i ~ /^[0-9.]+$/)
+                    printf "%s\"%s\":%s", (i > 1 ? "," : ""), h[i], $i;
+                else
+                    printf "%s\"%s\":\"%s\"", (i > 1 ? "," : ""), h[i], $i;
+            }
+            printf "}";
+        }
+        END { print "]" }' $csv > $json
+}
+
+# Compare latency of the CSV file with a baseline CSV file
+# Rows are matched on scenario,op,proto,reqs,state,entries
+# args:
+# 1: <baseline>  Baseline CSV file
+# 2: <threshold> Percent
+# Returns number of regressions
+function perfcompare()
+{
+    new "compare $csv with baseline $1 threshold $2%"
+    awk -F, -v thr=$2 '
+        FNR == 1 { next }
+        NR == FNR { base[$1","$2","$3","$4","$5","$6] = $9; next }
+        {
+            key = $1","$2","$3","$4","$5","$6;
+            if (!(key in base) || base[key] <= 0)
+                next;
+            pct = ($9 - base[key]) * 100 / base[key];
+            if (pct > thr) {
+                printf "REGRESSION %s: %.3f ms -> %.3f ms (+%.1f%%)\n", key, base[key], $9, pct;
+                nr++;
+            }
+        }
+        END { exit nr > 255 ? 255 : nr }' $1 $csv
+}
+
 # Run netconf function
 # args:
 # 1: <op>    put, get, commit, delete
@@ -156,7 +375,7 @@ function runnetconf()
     reqs=$3
     st=$4
 
-    file=$resdir/$op-netconf-$reqs-$st-$arch
+    file=$resdir/$pre$op-netconf-$reqs-$st-$arch
     new "runnetconf $file $nr"
     echo -n "$nr " >>  $file
     case $op in
@@ -167,7 +386,8 @@ function runnetconf()
             else # reqs != 0
                 { time -p for (( i=0; i<$reqs; i++ )); do
                     rnd=$(( ( RANDOM % $nr ) ));
-                    rpc=$(chunked_framing "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><x xmlns=\"urn:example:clixon\"><y><a>$rnd</a><b>$rnd</b></y></x></config></edit-config></rpc>")
+                    entry $rnd
+                    rpc=$(chunked_framing "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><$TOP xmlns=\"$NS\">$ex</$TOP></config></edit-config></rpc>")
                     if [ $i == 0 ]; then
                         echo -n "$DEFAULTHELLO";
                     fi       
@@ -189,7 +409,7 @@ function runnetconf()
             else # reqs != 0
                 { time -p for (( i=0; i<$reqs; i++ )); do
                     rnd=$(( ( RANDOM % $nr ) ))
-                    rpc=$(chunked_framing "<rpc $DEFAULTNS>${GET1}<filter type=\"xpath\" select=\"/ex:x/ex:y[ex:a=$rnd]\" xmlns:ex=\"urn:example:clixon\"/>${GET2}</rpc>")
+                    rpc=$(chunked_framing "<rpc $DEFAULTNS>${GET1}<filter type=\"xpath\" select=\"/ex:$TOP/ex:$LIST[ex:$KEY='$KPRE$rnd']\" xmlns:ex=\"$NS\"/>${GET2}</rpc>")
                     if [ $i == 0 ]; then
                         echo -n "$DEFAULTHELLO";
                     fi       
@@ -200,12 +420,14 @@ function runnetconf()
             ;;
         delete)
             if [ $reqs = 0 ]; then # Delete all in one go
-                rpc=$(chunked_framing "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><x xmlns=\"urn:example:clixon\"><y><a>$rnd</a><b>$rnd</b></y></x></config></edit-config></rpc>")
+                entry $rnd
+                rpc=$(chunked_framing "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><$TOP xmlns=\"$NS\">$ex</$TOP></config></edit-config></rpc>")
                 { time -p  echo "$DEFAULTHELLO$rpc" | $clixon_netconf -qf $cfg > /dev/null ; } 2>&1 | awk '/real/ {print $2}' | tr , . >> $file    
             else
             { time -p for (( i=0; i<$reqs; i++ )); do
                 rnd=$(( ( RANDOM % $nr ) ))
-                rpc=$(chunked_framing "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><x xmlns=\"urn:example:clixon\"><y><a>$rnd</a><b>$rnd</b></y></x></config></edit-config></rpc>")
+                entry $rnd
+                rpc=$(chunked_framing "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><$TOP xmlns=\"$NS\">$ex</$TOP></config></edit-config></rpc>")
                 if [ $i == 0 ]; then
                     echo -n "$DEFAULTHELLO";
                 fi       
@@ -222,6 +444,7 @@ function runnetconf()
         exit
         ;;
     esac
+    perfrecord $op netconf $reqs $st $file
 }
 
 # Run restconf function
@@ -237,7 +460,7 @@ function runrestconf()
     reqs=$3
     st=$4
     
-    file=$resdir/$op-restconf-$reqs-$st-$arch
+    file=$resdir/$pre$op-restconf-$reqs-$st-$arch
     new "runrestconf $file $nr"
     echo -n "$nr " >>  $file
     case $op in
@@ -245,11 +468,12 @@ function runrestconf()
             if [ $reqs = 0 ]; then # Write all in one go
                 genfile $nr json
                 # restconf @- means from stdin
-                { time -p curl $CURLOPTS -X PUT -H 'Content-Type: application/yang-data+json' -d @$fjson $RCPROTO://localhost/restconf/data/scaling:x ; } 2>&1 | awk '/real/ {print $2}' | tr , . >> $file
+                { time -p curl $CURLOPTS -X PUT -H 'Content-Type: application/yang-data+json' -d @$fjson $RCPROTO://localhost/restconf/data/$RCMOD:$TOP ; } 2>&1 | awk '/real/ {print $2}' | tr , . >> $file
             else # Small requests
                 { time -p for (( i=0; i<$reqs; i++ )); do
                     rnd=$(( ( RANDOM % $nr ) ));
-                    curl $CURLOPTS -X PUT -H 'Content-Type: application/yang-data+json' $RCPROTO://localhost/restconf/data/scaling:x/y=$rnd -d "{\"scaling:y\":{\"a\":$rnd,\"b\":\"$rnd\"}}" 
+                    entry $rnd
+                    curl $CURLOPTS -X PUT -H 'Content-Type: application/yang-data+json' $RCPROTO://localhost/restconf/data/$RCMOD:$TOP/$LIST=$KPRE$rnd -d "{\"$RCMOD:$LIST\":$ej}"
                 done ; } 2>&1 | awk '/real/ {print $2}' | tr , .>> $file
                 # 
             fi
@@ -261,18 +485,18 @@ function runrestconf()
                 CONTENT=config
             fi
             if [ $reqs = 0 ]; then # Read all in one go
-                { time -p curl $CURLOPTS -X GET $RCPROTO://localhost/restconf/data/scaling:x?content=$CONTENT > /dev/null; } 2>&1 | awk '/real/ {print $2}' | tr , . >> $file
+                { time -p curl $CURLOPTS -X GET $RCPROTO://localhost/restconf/data/$RCMOD:$TOP?content=$CONTENT > /dev/null; } 2>&1 | awk '/real/ {print $2}' | tr , . >> $file
             else # Small requests
                 { time -p for (( i=0; i<$reqs; i++ )); do
                     rnd=$(( ( RANDOM % $nr ) ));
-                    curl $CURLOPTS -X GET $RCPROTO://localhost/restconf/data/scaling:x/y=$rnd?content=$CONTENT  
+                    curl $CURLOPTS -X GET $RCPROTO://localhost/restconf/data/$RCMOD:$TOP/$LIST=$KPRE$rnd?content=$CONTENT
                 done ; } 2>&1 | awk '/real/ {print $2}' | tr , .>> $file
             fi
             ;;
         delete)
                 { time -p for (( i=0; i<$reqs; i++ )); do
         rnd=$(( ( RANDOM % $nr ) ));
-        curl $CURLOPTS -X GET $RCPROTO://localhost/restconf/data/scaling:x/y=$rnd  
+        curl $CURLOPTS -X GET $RCPROTO://localhost/restconf/data/$RCMOD:$TOP/$LIST=$KPRE$rnd
     done ; } 2>&1 | awk '/real/ {print $2}' | tr , .>> $file
                 ;;
             *)
@@ -280,6 +504,7 @@ function runrestconf()
         exit
         ;;
     esac
+    perfrecord $op restconf $reqs $st $file
 }
 
 function commit()
@@ -290,26 +515,27 @@ function commit()
 }
 
 # Delete all in candidate and commit, and state file
+# Made in one session, which private candidate requires
 function reset()
 {
     new "reset"
-    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><default-operation>none</default-operation><config operation='delete'/></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
-    # commit to running
-    commit
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO$(chunked_framing "<rpc $DEFAULTNS><edit-config><target><candidate/></target><default-operation>none</default-operation><config operation='delete'/></edit-config></rpc>")" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
     echo "" > $fstate
 }
 
 # Load nr entries into candidate
-# Args: <nr>
+# Args:
+# 1: <nr>
+# 2: <commit>  true: also commit to running in same session
 function load()
 {
     new "load $1"
     nr=$1
     # Generate file ($fxml)
-    genfile $nr netconf
+    genfile $nr netconf ${2:-false}
     # Write it to backend in one chunk
     new "generated netconf"
-    expecteof_file "$clixon_netconf -qef $cfg" 0 "$fxml" "^<rpc-reply $DEFAULTNS><ok/></rpc-reply>$"
+    expecteof_file "$clixon_netconf -qef $cfg" 0 "$fxml" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
     new "load done"
 }
 
@@ -340,8 +566,8 @@ function genplot()
         exit "plot should be called with 8 arguments, got $#"
     fi
     # reset file
-    new "Create file $resdir/$op-$proto-$reqs-$st-$arch"
-    echo -n "" > $resdir/$op-$proto-$reqs-$st-$arch
+    new "Create file $resdir/$pre$op-$proto-$reqs-$st-$arch"
+    echo -n "" > $resdir/$pre$op-$proto-$reqs-$st-$arch
     for (( nr=$from; nr<=$to; nr=$nr+$step )); do  
         reset
         if $st; then
@@ -350,8 +576,7 @@ function genplot()
         if [ $fill = candidate ]; then 
             load $nr
         elif [ $fill = running ]; then 
-            load $nr
-            commit
+            load $nr true
         fi
         if [ $proto = netconf ]; then
             runnetconf $op $nr $reqs $st
@@ -378,31 +603,47 @@ function startup()
         exit "startup should be called with 3 arguments, got $#"
     fi
     # gnuplot file
-    gfile=$resdir/startup-$arch    
+    gfile=$resdir/${pre}startup-$arch
     new "Create file $gfile"
     echo -n "" > $gfile
 
     # Startup db: load with n entries
     dbfile=$dir/${mode}_db
+    if [ $sc = multidb ]; then # Multi-file datastore: top file
+        sudo mkdir -p $dir/${mode}.d
+        dbfile=$dir/${mode}.d/0.xml
+    fi
     sudo touch $dbfile
     sudo chmod 666 $dbfile
     for (( n=$from; n<=$to; n=$n+$step )); do  
         new "startup-$arch $n"
         new "Generate $n entries to $dbfile"
-        echo -n "<config><x xmlns=\"urn:example:clixon\">" > $dbfile
+        echo -n "<config><$TOP xmlns=\"$NS\">" > $dbfile
         for (( i=0; i<$n; i++ )); do  
-            echo -n "<y><a>$i</a><b>$i</b></y>" >> $dbfile
+            entry $i
+            echo -n "$ex" >> $dbfile
         done
-        echo "</x></config>" >> $dbfile
+        echo "</$TOP></config>" >> $dbfile
 
         new "Startup backend once -s $mode -f $cfg"
         echo -n "$n " >>  $gfile
         { time -p sudo $clixon_backend -F1 -D $DBG -s $mode -f $cfg 2> /dev/null; } 2>&1 |  awk '/real/ {print $2}' | tr , . >> $gfile
+        perfrecord startup backend 0 false $gfile
     done
     echo # newline
 }
 
 if $run; then
+  echo "scenario,op,proto,reqs,state,entries,seconds,ops_per_s,latency_ms" > $csv
+  for sc in $scenarios; do
+    if ! scenario $sc; then
+        continue
+    fi
+    new "scenario $sc"
+
+    to=$to0
+    step=$step0
+    reqs=$reqs0
 
     # Startup test before regular backend/restconf start since we only start
     # backend a single time
@@ -443,15 +684,18 @@ if $run; then
     done
 
     # Netconf commit all
-    new "Netconf commit all entries from candidate to running"
-    genplot commit netconf $step $step $to 0 candidate false # candidate full running empty
+    # Private candidate is per session, a commit in a new session has nothing to commit
+    if [ $sc != privcand ]; then
+        new "Netconf commit all entries from candidate to running"
+        genplot commit netconf $step $step $to 0 candidate false # candidate full running empty
+    fi
 
     # Get all tests
     for pr in ${protos}; do
         new "$pr get all config entries from running"
         genplot get $pr $step $step $to 0 running false # start w full datastore
     done
-    if $state; then
+    if $scstate; then
         for pr in ${protos}; do
             new "$pr get all state entries from running"
             genplot get $pr $step $step $to 0 running true # start w full datastore
@@ -484,8 +728,19 @@ if $run; then
         # kill backend
         stop_backend -f $cfg
     fi
+  done # scenarios
+  perfjson
+  echo "Results: $csv $json"
 fi # if run
 
+if [ -n "$baseline" ]; then
+    perfcompare $baseline $threshold
+    nr=$?
+    if [ $nr -ne 0 ]; then
+        err "No regressions above $threshold% compared to $baseline" "$nr regressions"
+    fi
+fi
+
 if $plot; then
 
 # 0. Startup
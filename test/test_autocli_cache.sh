@@ -263,6 +263,21 @@ wait_backend
 new "clear cache"
 expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><clixon-cache $LIBNS><operation>clear</operation><type>autocli</type></clixon-cache></rpc>" "<ok/>"
 
+new "read cache file name"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><clixon-cache $LIBNS><operation>read</operation><type>autocli</type><domain>top</domain><spec>data</spec><module>clixon-example</module><revision>2025-05-01</revision><keyword>module</keyword><argument>clixon-example</argument><file>true</file></clixon-cache></rpc>" "<rpc-reply $DEFAULTNS><file $LIBNS>$cachedir/top_data_clixon-example_2025-05-01_module_clixon-example.cli</file></rpc-reply>" ""
+
+new "Check cache file is NUL-terminated"
+ret=$(tail -c 1 $cachedir/top_data_clixon-example_2025-05-01_module_clixon-example.cli | od -An -tx1 | tr -d ' ')
+if [ "$ret" != "00" ]; then
+    err "00" "$ret"
+fi
+
+new "read cache data"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><clixon-cache $LIBNS><operation>read</operation><type>autocli</type><domain>top</domain><spec>data</spec><module>clixon-example</module><revision>2025-05-01</revision><keyword>module</keyword><argument>clixon-example</argument></clixon-cache></rpc>" "<rpc-reply $DEFAULTNS><data $LIBNS>.*table" ""
+
+new "cli set via mapped cache"
+expectpart "$($clixon_cli -f $cfg -1 set table parameter x index1 a)" 0 ""
+
 if [ $BE -ne 0 ]; then
     new "Kill backend"
     # Check if premature kill
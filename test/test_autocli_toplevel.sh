@@ -0,0 +1,186 @@
+#!/usr/bin/env bash
+# Autocli of top-level containers and lists as tree references, see autocli toplevel-treeref
+# Run the same CLI commands with and without top-level treerefs, and check completion, set,
+# delete and show in top-level containers and lists, in nested nodes, in a grouping and in
+# edit modes.
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/clixon-example.yang
+clidir=$dir/cli
+if [ -d $clidir ]; then
+    rm -rf $clidir/*
+else
+    mkdir $clidir
+fi
+
+cat <<EOF > $fyang
+module clixon-example{
+    yang-version 1.1;
+    namespace "urn:example:clixon";
+    prefix ex;
+    grouping pg {
+        leaf value {
+            type string;
+        }
+    }
+    container table {
+        list parameter {
+            key name;
+            leaf name {
+                type string;
+            }
+            uses pg;
+            container sub {
+                leaf w {
+                    type int32;
+                }
+            }
+        }
+    }
+    list toplist {
+        key name;
+        leaf name {
+            type string;
+        }
+        leaf x {
+            type int32;
+        }
+    }
+    container other {
+        leaf y {
+            type string;
+        }
+    }
+}
+EOF
+
+cat <<EOF > $clidir/ex.cli
+CLICON_MODE="example";
+CLICON_PROMPT="%U@%H %W> ";
+
+set @datamodel, cli_auto_set();
+delete("Delete a configuration item") @datamodel, cli_auto_del();
+commit("Commit the changes"), cli_commit();
+edit @datamodelmode, cli_auto_edit("basemodel");
+up, cli_auto_up("basemodel");
+top, cli_auto_top("basemodel");
+show("Show a particular state of the system"){
+    configuration("Show configuration"), cli_show_auto_mode("candidate", "cli", true, false, "explicit", "set ");
+}
+EOF
+
+for treeref in false true; do
+    cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_CLISPEC_DIR>$clidir</CLICON_CLISPEC_DIR>
+  <CLICON_CLI_DIR>/usr/local/lib/$APPNAME/cli</CLICON_CLI_DIR>
+  <CLICON_CLI_MODE>$APPNAME</CLICON_CLI_MODE>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_DIR>/usr/local/lib/$APPNAME/backend</CLICON_BACKEND_DIR>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_YANG_LIBRARY>false</CLICON_YANG_LIBRARY>
+  <autocli>
+     <module-default>false</module-default>
+     <list-keyword-default>kw-nokey</list-keyword-default>
+     <grouping-treeref>false</grouping-treeref>
+     <toplevel-treeref>$treeref</toplevel-treeref>
+     <rule>
+       <name>include example</name>
+       <operation>enable</operation>
+       <module-name>clixon-example</module-name>
+     </rule>
+  </autocli>
+</clixon-config>
+EOF
+
+    new "test params: -f $cfg"
+
+    if [ $BE -ne 0 ]; then
+        new "kill old backend"
+        sudo clixon_backend -z -f $cfg
+        if [ $? -ne 0 ]; then
+            err
+        fi
+        new "start backend -s init -f $cfg"
+        start_backend -s init -f $cfg
+    fi
+
+    new "wait backend"
+    wait_backend
+
+    new "treeref $treeref: complete top"
+    expectpart "$(echo "set ?" | $clixon_cli -f $cfg 2> /dev/null)" 0 table toplist other
+
+    new "treeref $treeref: complete top-level container"
+    expectpart "$(echo "set table ?" | $clixon_cli -f $cfg 2> /dev/null)" 0 parameter --not-- toplist
+
+    new "treeref $treeref: complete list entry below top-level container"
+    expectpart "$(echo "set table parameter a ?" | $clixon_cli -f $cfg 2> /dev/null)" 0 value sub
+
+    new "treeref $treeref: complete top-level list entry"
+    expectpart "$(echo "set toplist k ?" | $clixon_cli -f $cfg 2> /dev/null)" 0 x --not-- parameter
+
+    new "treeref $treeref: set leaf of grouping"
+    expectpart "$($clixon_cli -1 -f $cfg set table parameter a value 42)" 0 "^$"
+
+    new "treeref $treeref: set nested leaf"
+    expectpart "$($clixon_cli -1 -f $cfg set table parameter a sub w 7)" 0 "^$"
+
+    new "treeref $treeref: set top-level list"
+    expectpart "$($clixon_cli -1 -f $cfg set toplist k x 1)" 0 "^$"
+
+    new "treeref $treeref: set other"
+    expectpart "$($clixon_cli -1 -f $cfg set other y z)" 0 "^$"
+
+    new "treeref $treeref: invalid leaf"
+    expectpart "$($clixon_cli -1 -f $cfg set toplist k value 1 2>&1)" 255 "Unknown command"
+
+    new "treeref $treeref: show configuration"
+    expectpart "$($clixon_cli -1 -f $cfg show configuration)" 0 "set table parameter a value 42" "set table parameter a sub w 7" "set toplist k x 1" "set other y z"
+
+    new "treeref $treeref: edit mode in top-level container"
+    expectpart "$(echo "edit table parameter a
+set value 43
+top
+show configuration" | $clixon_cli -f $cfg 2> /dev/null)" 0 "set table parameter a value 43"
+
+    new "treeref $treeref: delete in top-level list"
+    expectpart "$($clixon_cli -1 -f $cfg delete toplist k x)" 0 "^$"
+
+    new "treeref $treeref: commit"
+    expectpart "$($clixon_cli -1 -f $cfg commit)" 0 "^$"
+
+    new "treeref $treeref: show configuration after commit"
+    expectpart "$($clixon_cli -1 -f $cfg show configuration)" 0 "set table parameter a value 43" "set toplist k" --not-- "set toplist k x 1"
+
+    new "treeref $treeref: delete all"
+    expectpart "$($clixon_cli -1 -f $cfg delete table)" 0 "^$"
+    expectpart "$($clixon_cli -1 -f $cfg delete toplist k)" 0 "^$"
+    expectpart "$($clixon_cli -1 -f $cfg delete other)" 0 "^$"
+    expectpart "$($clixon_cli -1 -f $cfg commit)" 0 "^$"
+
+    if [ $BE -ne 0 ]; then
+        new "Kill backend"
+        # Check if premature kill
+        pid=$(pgrep -u root -f clixon_backend)
+        if [ -z "$pid" ]; then
+            err "backend already dead"
+        fi
+        # kill backend
+        stop_backend -f $cfg
+    fi
+done
+
+rm -rf $dir
+
+new "endtest"
+endtest
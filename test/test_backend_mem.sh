@@ -0,0 +1,135 @@
+#!/usr/bin/env bash
+# Test backend memory admission control
+# Requests whose estimated cost exceeds CLICON_BACKEND_SESSION_MEM_MAX or
+# CLICON_BACKEND_MEM_MAX are rejected with resource-denied
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+# Backend must be started by the test
+if [ $BE -eq 0 ]; then
+    echo "...skipped: must run with backend"
+    rm -rf $dir
+    if [ "$s" = $0 ]; then exit 0; else return 0; fi
+fi
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/clixon-example.yang
+
+# Number of list entries, makes a full get-config exceed the budget
+: ${nr:=100}
+# Memory budget in bytes
+: ${max:=10000}
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>$dir</CLICON_YANG_DIR>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_BACKEND_DIR>/usr/local/lib/$APPNAME/backend</CLICON_BACKEND_DIR>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_YANG_LIBRARY>false</CLICON_YANG_LIBRARY>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module clixon-example{
+    yang-version 1.1;
+    namespace "urn:example:clixon";
+    prefix ex;
+    container table{
+        list parameter{
+            key name;
+            leaf name{
+                type string;
+            }
+            leaf value{
+                type string;
+            }
+        }
+    }
+}
+EOF
+
+# Edit-config of entries from $1 up to $2
+function edit()
+{
+    from=$1
+    to=$2
+    echo -n "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><table xmlns=\"urn:example:clixon\">"
+    for (( i=$from; i<$to; i++ )); do
+        echo -n "<parameter><name>$i</name><value>$i</value></parameter>"
+    done
+    echo -n "</table></config></edit-config></rpc>"
+}
+
+DENIED="<rpc-reply $DEFAULTNS><rpc-error><error-type>application</error-type><error-tag>resource-denied</error-tag><error-severity>error</error-severity><error-message>Request exceeds"
+
+new "test params: -f $cfg"
+
+new "kill old backend"
+sudo clixon_backend -zf $cfg
+if [ $? -ne 0 ]; then
+    err
+fi
+new "start backend -s init -f $cfg"
+start_backend -s init -f $cfg
+
+new "wait backend"
+wait_backend
+
+new "add $nr entries"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "$(edit 0 $nr)" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "commit"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+for opt in CLICON_BACKEND_SESSION_MEM_MAX CLICON_BACKEND_MEM_MAX; do
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s running -f $cfg -o $opt=$max"
+    start_backend -s running -f $cfg -o $opt=$max
+
+    new "wait backend"
+    wait_backend
+
+    new "$opt: get-config of all entries is denied"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source></get-config></rpc>" "$DENIED" ""
+
+    new "$opt: get of all entries is denied"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get><filter type=\"xpath\" select=\"/ex:table\" xmlns:ex=\"urn:example:clixon\"/></get></rpc>" "$DENIED" ""
+
+    new "$opt: get-config of one entry"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source><filter type=\"xpath\" select=\"/ex:table/ex:parameter[ex:name='42']\" xmlns:ex=\"urn:example:clixon\"/></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><table xmlns=\"urn:example:clixon\"><parameter><name>42</name><value>42</value></parameter></table></data></rpc-reply>"
+
+    new "$opt: edit-config of one entry"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "$(edit $nr $((nr+1)))" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+    new "$opt: edit-config of $nr entries is denied"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "$(edit $nr $((2*nr)))" "$DENIED" ""
+
+    new "$opt: discard-changes"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><discard-changes/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+done
+
+new "Kill backend"
+# Check if premature kill
+pid=$(pgrep -u root -f clixon_backend)
+if [ -z "$pid" ]; then
+    err "backend already dead"
+fi
+# kill backend
+stop_backend -f $cfg
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -0,0 +1,171 @@
+#!/usr/bin/env bash
+# Backend client output queues, see CLICON_BACKEND_OUTQ_MAX
+# Two clients subscribe to the config-change stream, and large changes are committed.
+# One subscriber is stopped and does not read its notifications: the backend queues them
+# without blocking, commits and other clients are served, and when the queue exceeds
+# CLICON_BACKEND_OUTQ_MAX the stalled subscriber is disconnected.
+# The other subscriber reads all notifications and stays connected.
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+# Backend must be started by the test
+if [ $BE -eq 0 ]; then
+    echo "...skipped: must run with backend"
+    rm -rf $dir
+    if [ "$s" = $0 ]; then exit 0; else return 0; fi
+fi
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/outq.yang
+flog=$dir/backend.log
+fslow=$dir/slow.out
+ffast=$dir/fast.out
+
+# Max output queue in bytes
+outqmax=100000
+
+# Number of commits
+nr=40
+
+# Number of list entries changed in each commit
+entries=100
+
+# Each notification is entries*300 bytes, well above outqmax in total
+value=$(printf "%0300d" 0)
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>$dir</CLICON_YANG_DIR>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_YANG_LIBRARY>false</CLICON_YANG_LIBRARY>
+  <CLICON_NETCONF_MONITORING>false</CLICON_NETCONF_MONITORING>
+  <CLICON_STREAM_CONFIG_CHANGE>true</CLICON_STREAM_CONFIG_CHANGE>
+  <CLICON_BACKEND_OUTQ_MAX>$outqmax</CLICON_BACKEND_OUTQ_MAX>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module outq{
+    yang-version 1.1;
+    namespace "urn:example:outq";
+    prefix ex;
+    container c{
+        list x{
+            key k;
+            leaf k{
+                type int32;
+            }
+            leaf v{
+                type string;
+            }
+        }
+    }
+}
+EOF
+
+function rpc()
+{
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS>$1</rpc>" "" "<rpc-reply $DEFAULTNS>$2</rpc-reply>"
+}
+
+# Subscribe to the config-change stream, output to file $1
+function subscribe()
+{
+    sleep 60 | cat <(echo "$HELLONO11<rpc $DEFAULTNS><create-subscription xmlns=\"urn:ietf:params:xml:ns:netmod:notification\"><stream>CONFIG-CHANGE</stream></create-subscription></rpc>]]>]]>") - | $clixon_netconf -qf $cfg > $1 &
+}
+
+new "test params: -f $cfg"
+
+new "kill old backend"
+sudo clixon_backend -zf $cfg
+if [ $? -ne 0 ]; then
+    err
+fi
+new "start backend -s init -f $cfg -l f$flog"
+start_backend -s init -f $cfg -l f$flog
+
+new "wait backend"
+wait_backend
+
+new "slow subscriber"
+subscribe $fslow
+pslow=$!
+
+new "fast subscriber"
+subscribe $ffast
+pfast=$!
+
+sleep 1
+
+new "subscriptions ok"
+expectpart "$(cat $fslow)" 0 "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+expectpart "$(cat $ffast)" 0 "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "stop slow subscriber $pslow"
+kill -STOP $pslow
+
+new "commit $nr changes of $entries entries"
+for (( i=0; i<$nr; i++ )); do
+    C=""
+    for (( j=0; j<$entries; j++ )); do
+        C="$C<x><k>$j</k><v>$i-$value</v></x>"
+    done
+    rpc "<edit-config><target><candidate/></target><config><c xmlns=\"urn:example:outq\">$C</c></config></edit-config>" "<ok/>"
+    rpc "<commit/>" "<ok/>"
+done
+
+new "other client is served"
+rpc "<get-config><source><running/></source><filter type=\"xpath\" select=\"/ex:c/ex:x[ex:k='0']/ex:k\" xmlns:ex=\"urn:example:outq\"/></get-config>" "<data><c xmlns=\"urn:example:outq\"><x><k>0</k></x></c></data>"
+
+sleep 1
+
+new "slow subscriber is disconnected"
+expectpart "$(sudo cat $flog)" 0 "output queue exceeds $outqmax bytes, disconnecting"
+
+new "continue slow subscriber $pslow"
+kill -CONT $pslow
+sleep 1
+
+new "slow subscriber has exited"
+if ps -p $pslow > /dev/null; then
+    err "exited" "running"
+fi
+
+new "fast subscriber has all $nr notifications"
+n=$(grep -o "<config-change xmlns" $ffast | wc -l)
+if [ $n -ne $nr ]; then
+    err "$nr" "$n"
+fi
+
+new "fast subscriber is connected"
+if ! ps -p $pfast > /dev/null; then
+    err "running" "exited"
+fi
+
+new "last change in fast subscriber"
+expectpart "$(cat $ffast)" 0 "<v xmlns=\"urn:example:outq\">$((nr-1))-$value</v>"
+
+new "soft kill subscribers"
+kill $(jobs -p)
+
+new "Kill backend"
+# Check if premature kill
+pid=$(pgrep -u root -f clixon_backend)
+if [ -z "$pid" ]; then
+    err "backend already dead"
+fi
+# kill backend
+stop_backend -f $cfg
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -0,0 +1,107 @@
+#!/usr/bin/env bash
+# Backend reader processes serving read-only rpcs, see CLICON_BACKEND_READERS
+# Check replies of get-config, get, get-schema and that pipelined rpcs of one session
+# are replied in order when reads are served by reader processes
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/readers.yang
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>$dir</CLICON_YANG_DIR>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_NETCONF_MONITORING>true</CLICON_NETCONF_MONITORING>
+  <CLICON_BACKEND_READERS>2</CLICON_BACKEND_READERS>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module readers{
+    yang-version 1.1;
+    namespace "urn:example:readers";
+    prefix ex;
+    container c{
+        list x{
+            key k;
+            leaf k{
+                type string;
+            }
+            leaf v{
+                type string;
+            }
+        }
+    }
+}
+EOF
+
+new "test params: -f $cfg"
+
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+new "add entry"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><c xmlns=\"urn:example:readers\"><x><k>a</k><v>1</v></x></c></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "commit"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "get-config running"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source><filter type=\"xpath\" select=\"/ex:c\" xmlns:ex=\"urn:example:readers\"/></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><c xmlns=\"urn:example:readers\"><x><k>a</k><v>1</v></x></c></data></rpc-reply>"
+
+new "get"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get><filter type=\"xpath\" select=\"/ex:c\" xmlns:ex=\"urn:example:readers\"/></get></rpc>" "" "<rpc-reply $DEFAULTNS><data><c xmlns=\"urn:example:readers\"><x><k>a</k><v>1</v></x></c></data></rpc-reply>"
+
+new "get-schema"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-schema xmlns=\"urn:ietf:params:xml:ns:yang:ietf-netconf-monitoring\"><identifier>readers</identifier></get-schema></rpc>" "<rpc-reply $DEFAULTNS><data xmlns=\"urn:ietf:params:xml:ns:yang:ietf-netconf-monitoring\">module readers{" ""
+
+new "pipelined get-config, edit-config and get-config are replied in order"
+rpc=$(chunked_framing "<rpc $DEFAULTNS message-id=\"1\"><get-config><source><candidate/></source><filter type=\"xpath\" select=\"/ex:c/ex:x[ex:k='b']\" xmlns:ex=\"urn:example:readers\"/></get-config></rpc>")
+rpc+=$(chunked_framing "<rpc $DEFAULTNS message-id=\"2\"><edit-config><target><candidate/></target><config><c xmlns=\"urn:example:readers\"><x><k>b</k><v>2</v></x></c></config></edit-config></rpc>")
+rpc+=$(chunked_framing "<rpc $DEFAULTNS message-id=\"3\"><get-config><source><candidate/></source><filter type=\"xpath\" select=\"/ex:c/ex:x[ex:k='b']\" xmlns:ex=\"urn:example:readers\"/></get-config></rpc>")
+ret=$($clixon_netconf -qf $cfg<<EOF
+$DEFAULTHELLO$rpc
+EOF
+   )
+match=$(echo "$ret" | tr -d '\n' | grep "message-id=\"1\"><data/></rpc-reply>.*message-id=\"2\"><ok/></rpc-reply>.*message-id=\"3\"><data><c xmlns=\"urn:example:readers\"><x><k>b</k><v>2</v></x></c></data></rpc-reply>")
+if [ -z "$match" ]; then
+    err "replies 1, 2, 3 in order" "$ret"
+fi
+
+new "discard"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><discard-changes/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -0,0 +1,142 @@
+#!/usr/bin/env bash
+# Backend scheduling of clients with pipelined requests, see CLICON_BACKEND_SLICE
+# Concurrent RESTCONF GETs over HTTP/2 are sent as pipelined requests on a few backend
+# connections, see RPC_ASYNC_CONNECTIONS. With no time slice, a time slice of 1us where a
+# client yields after each request, and the default, all GETs are replied correctly, and a
+# NETCONF client is served meanwhile.
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+# Only works with native and http/2
+if [ "${WITH_RESTCONF}" != "native" -o ${HVER} != 2 ]; then
+    rm -rf $dir
+    if [ "$s" = $0 ]; then exit 0; else return 0; fi # skip
+fi
+
+# Backend and restconf must be started by the test
+if [ $BE -eq 0 -o $RC -eq 0 ]; then
+    echo "...skipped: must run with backend and restconf"
+    rm -rf $dir
+    if [ "$s" = $0 ]; then exit 0; else return 0; fi
+fi
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/clixon-example.yang
+
+# Number of list entries and concurrent GETs
+nr=100
+
+# Define default restconfig config: RESTCONFIG
+RESTCONFIG=$(restconf_config none false)
+if [ $? -ne 0 ]; then
+    err1 "Error when generating certs"
+fi
+
+cat <<EOF > $fyang
+module clixon-example{
+    yang-version 1.1;
+    namespace "urn:example:clixon";
+    prefix ex;
+    container c {
+        list x {
+            key k;
+            leaf k {
+                type string;
+            }
+            leaf v {
+                type string;
+            }
+        }
+    }
+}
+EOF
+
+function rpc()
+{
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS>$1</rpc>" "" "<rpc-reply $DEFAULTNS>$2</rpc-reply>"
+}
+
+C=""
+U=""
+for (( i=0; i<$nr; i++ )); do
+    C="$C<x><k>k$i</k><v>v$i</v></x>"
+    U="$U $RCPROTO://localhost/restconf/data/clixon-example:c/x=k$i -o $dir/get$i"
+done
+
+for slice in 0 1 10000; do
+    cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_FEATURE>clixon-restconf:allow-auth-none</CLICON_FEATURE> <!-- Use auth-type=none -->
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_YANG_LIBRARY>false</CLICON_YANG_LIBRARY>
+  <CLICON_BACKEND_SLICE>$slice</CLICON_BACKEND_SLICE>
+  $RESTCONFIG
+</clixon-config>
+EOF
+
+    new "test params: -f $cfg"
+
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+
+    new "wait backend"
+    wait_backend
+
+    new "kill old restconf daemon"
+    stop_restconf_pre
+
+    new "start restconf daemon"
+    start_restconf -f $cfg
+
+    new "wait restconf"
+    wait_restconf
+
+    new "slice $slice: add $nr entries"
+    rpc "<edit-config><target><candidate/></target><config><c xmlns=\"urn:example:clixon\">$C</c></config></edit-config>" "<ok/>"
+    rpc "<commit/>" "<ok/>"
+
+    new "slice $slice: $nr concurrent GETs"
+    rm -f $dir/get*
+    curl $CURLOPTS -Z -X GET $U > /dev/null &
+    pcurl=$!
+
+    new "slice $slice: netconf client is served"
+    rpc "<get-config><source><running/></source><filter type=\"xpath\" select=\"/ex:c/ex:x[ex:k='k0']\" xmlns:ex=\"urn:example:clixon\"/></get-config>" "<data><c xmlns=\"urn:example:clixon\"><x><k>k0</k><v>v0</v></x></c></data>"
+
+    wait $pcurl
+
+    for (( i=0; i<$nr; i++ )); do
+        new "slice $slice: GET $i"
+        expectpart "$(cat $dir/get$i)" 0 "HTTP/$HVER 200" "{\"clixon-example:x\":\[{\"k\":\"k$i\",\"v\":\"v$i\"}\]}"
+    done
+
+    new "Kill restconf daemon"
+    stop_restconf
+
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+done
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -0,0 +1,127 @@
+#!/usr/bin/env bash
+# Datastore generation and change feed, see CLICON_CHANGE_FEED
+# Commit changes and get them with the change-feed rpc since a generation
+# Also the same changes with values on the config-change stream, see CLICON_STREAM_CONFIG_CHANGE
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/feed.yang
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>$dir</CLICON_YANG_DIR>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_YANG_LIBRARY>false</CLICON_YANG_LIBRARY>
+  <CLICON_NETCONF_MONITORING>false</CLICON_NETCONF_MONITORING>
+  <CLICON_CHANGE_FEED>2</CLICON_CHANGE_FEED>
+  <CLICON_STREAM_CONFIG_CHANGE>true</CLICON_STREAM_CONFIG_CHANGE>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module feed{
+    yang-version 1.1;
+    namespace "urn:example:feed";
+    prefix ex;
+    container c{
+        list x{
+            key k;
+            leaf k{
+                type string;
+            }
+            leaf v{
+                type string;
+            }
+        }
+    }
+}
+EOF
+
+new "test params: -f $cfg"
+
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+new "add entries"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><c xmlns=\"urn:example:feed\"><x><k>a</k><v>1</v></x><x><k>b</k><v>2</v></x></c></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "commit"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "get generation of running"
+rpc=$(chunked_framing "<rpc $DEFAULTNS><change-feed $LIBNS/></rpc>")
+ret=$($clixon_netconf -qf $cfg<<EOF
+$DEFAULTHELLO$rpc
+EOF
+   )
+gen=$(echo "$ret" | sed -n 's/.*<generation xmlns="http:\/\/clicon.org\/lib">\([0-9]*\)<\/generation>.*/\1/p')
+if [ -z "$gen" ]; then
+    err "<generation>" "$ret"
+fi
+
+new "change-feed since current generation is complete and empty"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><change-feed $LIBNS><since>$gen</since></change-feed></rpc>" "" "<rpc-reply $DEFAULTNS><generation $LIBNS>$gen</generation><complete $LIBNS>true</complete></rpc-reply>"
+
+new "change and delete entries"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><c xmlns=\"urn:example:feed\"><x><k>b</k><v>3</v></x><x nc:operation=\"delete\" xmlns:nc=\"urn:ietf:params:xml:ns:netconf:base:1.0\"><k>a</k></x></c></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "commit"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "change-feed since generation"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><change-feed $LIBNS><since>$gen</since></change-feed></rpc>" "<complete $LIBNS>true</complete><commit $LIBNS><generation>[0-9]*</generation><transaction-id>[0-9]*</transaction-id><deleted>/feed:c/x=a</deleted><changed>/feed:c/x=b/v</changed></commit></rpc-reply>" ""
+
+for i in 1 2; do
+    new "edit and commit $i"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><c xmlns=\"urn:example:feed\"><x><k>e$i</k><v>$i</v></x></c></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+done
+
+new "change-feed since dropped generation is not complete"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><change-feed $LIBNS><since>$gen</since></change-feed></rpc>" "<complete $LIBNS>false</complete><commit $LIBNS><generation>[0-9]*</generation><transaction-id>[0-9]*</transaction-id><added>/feed:c/x=e1</added></commit><commit $LIBNS><generation>[0-9]*</generation><transaction-id>[0-9]*</transaction-id><added>/feed:c/x=e2</added></commit></rpc-reply>" ""
+
+DATE=$(date -u +"%Y-%m-%d")
+
+new "config-change stream replay of commit with filter"
+expectwait "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><create-subscription xmlns=\"urn:ietf:params:xml:ns:netmod:notification\"><stream>CONFIG-CHANGE</stream><filter type=\"xpath\" select=\"config-change[edit/operation='delete']\"/><startTime>${DATE}T00:00:00Z</startTime></create-subscription></rpc>" 2 "<rpc-reply $DEFAULTNS><ok/></rpc-reply>" "<config-change xmlns=\"http://clicon.org/lib\"><generation>[0-9]*</generation><previous-generation>[0-9]*</previous-generation><transaction-id>[0-9]*</transaction-id><edit><target>/feed:c/x=a</target><operation>delete</operation></edit><edit><target>/feed:c/x=b/v</target><operation>replace</operation><value><v xmlns=\"urn:example:feed\">3</v></value></edit></config-change>" --not-- "<target>/feed:c/x=e1</target>"
+
+new "config-change stream replay of added node"
+expectwait "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><create-subscription xmlns=\"urn:ietf:params:xml:ns:netmod:notification\"><stream>CONFIG-CHANGE</stream><startTime>${DATE}T00:00:00Z</startTime></create-subscription></rpc>" 2 "<rpc-reply $DEFAULTNS><ok/></rpc-reply>" "<edit><target>/feed:c/x=e2</target><operation>create</operation><value><x xmlns=\"urn:example:feed\"><k>e2</k><v>2</v></x></value></edit>"
+
+new "stats has generation of running"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><stats $LIBNS/></rpc>" "<datastore><name>running</name><nr>[0-9]*</nr><size>[0-9]*</size><generation>[0-9]*</generation></datastore>" ""
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
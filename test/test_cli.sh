@@ -37,6 +37,7 @@ cat <<EOF > $cfg
   <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
   <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
   <CLICON_XMLDB_DIR>/usr/local/var/$APPNAME</CLICON_XMLDB_DIR>
+  <CLICON_CLI_TIMING>true</CLICON_CLI_TIMING>
 </clixon-config>
 EOF
 
@@ -130,6 +131,7 @@ debug("Debugging parts of the system"){
 }
 show("Show a particular state of the system"){
     xpath("Show configuration") <xpath:string>("XPATH expression") <ns:string>("Namespace"), show_conf_xpath("candidate");
+    cli-timing("Show timing of last CLI commands"), cli_show_timing();
     compare("Compare candidate and running databases"), compare_dbs("running", "candidate", "xml");{
     		     xml("Show comparison in xml"), compare_dbs("running", "candidate", "xml");
 		     text("Show comparison in text"), compare_dbs("running", "candidate", "text");
@@ -250,6 +252,51 @@ expectpart "$($clixon_cli -1 -f $cfg -l o load $dir/foo cli)" 0 "^$"
 new "cli check load"
 expectpart "$($clixon_cli -1 -f $cfg -l o show conf cli)" 0 "interfaces interface eth/0/0 ipv4"
 
+new "cli save xml"
+expectpart "$($clixon_cli -1 -f $cfg -l o save $dir/foo.xml xml)" 0 "^$"
+
+new "cli delete all"
+expectpart "$($clixon_cli -1 -f $cfg -l o delete all)" 0 "^$"
+
+# Files with a config top element are sent to the backend unparsed
+new "cli load xml with declaration and comment"
+(echo '<?xml version="1.0" encoding="UTF-8"?>'; echo '<!-- saved -->'; cat $dir/foo.xml) > $dir/foo2.xml
+expectpart "$($clixon_cli -1 -f $cfg -l o load $dir/foo2.xml xml)" 0 "^$"
+
+new "cli check load xml"
+expectpart "$($clixon_cli -1 -f $cfg -l o show conf cli)" 0 "interfaces interface eth/0/0 ipv4"
+
+new "cli load xml unknown element"
+echo '<config><xxx xmlns="urn:example:clixon"/></config>' > $dir/bad.xml
+expectpart "$($clixon_cli -1 -f $cfg -l o load $dir/bad.xml xml 2>&1)" 0 "Editing configuration" "unknown-element"
+
+new "cli check load xml unchanged"
+expectpart "$($clixon_cli -1 -f $cfg -l o show conf cli)" 0 "interfaces interface eth/0/0 ipv4"
+
+# Same files parsed in the CLI
+new "cli delete all"
+expectpart "$($clixon_cli -1 -f $cfg -l o delete all)" 0 "^$"
+
+new "cli load xml not streamed"
+expectpart "$($clixon_cli -1 -f $cfg -l o -o CLICON_CLI_LOAD_STREAM=false load $dir/foo2.xml xml)" 0 "^$"
+
+new "cli check load xml not streamed"
+expectpart "$($clixon_cli -1 -f $cfg -l o show conf cli)" 0 "interfaces interface eth/0/0 ipv4"
+
+new "cli load xml unknown element not streamed"
+expectpart "$($clixon_cli -1 -f $cfg -l o -o CLICON_CLI_LOAD_STREAM=false load $dir/bad.xml xml 2>&1)" 0 "Editing configuration" "unknown-element"
+
+new "cli check load xml not streamed unchanged"
+expectpart "$($clixon_cli -1 -f $cfg -l o show conf cli)" 0 "interfaces interface eth/0/0 ipv4"
+
+new "cli timing of commands"
+cat <<EOF > $dir/timing.cli
+validate
+show conf cli
+show cli-timing
+EOF
+expectpart "$(cat $dir/timing.cli | $clixon_cli -f $cfg 2>&1)" 0 "match *expand *rpc *rpcs *print *command" " 1 .* validate" "show conf cli" "(average of 2)" "(max)"
+
 new "cli debug set"
 expectpart "$($clixon_cli -1 -f $cfg -l o debug cli 1)" 0 "^$"
 
@@ -268,6 +315,14 @@ expectpart "$($clixon_cli -1 -f $cfg set table parameter foobar)" 0 "^$"
 new "cli bug with choice+dbexpand: part2, make same choice"
 expectpart "$($clixon_cli -1 -f $cfg choicebug foobar)" 0 "^$"
 
+new "cli dbexpand cached expansion refreshed after change"
+cat <<EOF > $dir/expand.cli
+choicebug foobar
+set table parameter fiebar
+choicebug fiebar
+EOF
+expectpart "$(cat $dir/expand.cli | $clixon_cli -f $cfg 2>&1)" 0 --not-- "Unknown command"
+
 new "cli discard"
 expectpart "$($clixon_cli -1 -f $cfg discard)" 0 "^$"
 
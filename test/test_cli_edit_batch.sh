@@ -0,0 +1,171 @@
+#!/usr/bin/env bash
+# CLI edit batch, see CLICON_CLI_EDIT_BATCH
+# Set, merge and delete commands are batched in the CLI and sent to the backend when
+# the batch is full, on commit, validate, flush and when the CLI exits
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+clidir=$dir/cli
+fyang=$dir/clixon-example.yang
+
+test -d ${clidir} || rm -rf ${clidir}
+mkdir $clidir
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_CLI_MODE>$APPNAME</CLICON_CLI_MODE>
+  <CLICON_CLISPEC_DIR>$clidir</CLICON_CLISPEC_DIR>
+  <CLICON_SOCK>$dir/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_CLI_EDIT_BATCH>3</CLICON_CLI_EDIT_BATCH>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module clixon-example{
+  yang-version 1.1;
+  namespace "urn:example:clixon";
+  prefix ex;
+  container table{
+    list parameter{
+      key name;
+      leaf name{
+        type string;
+      }
+      leaf value{
+        type string;
+      }
+    }
+  }
+}
+EOF
+
+cat <<EOF > $clidir/ex.cli
+CLICON_MODE="example";
+CLICON_PROMPT="%U@%H %W> ";
+
+set @datamodel, cli_auto_set();
+create @datamodel, cli_auto_create();
+delete("Delete a configuration item") {
+      @datamodel, cli_auto_del();
+      all("Delete whole candidate configuration"), delete_all("candidate");
+}
+flush("Send batched edits"), cli_edit_flush();
+validate("Validate changes"), cli_validate();
+commit("Commit the changes"), cli_commit();
+discard("Discard edits"), discard_changes();
+show("Show a particular state of the system"){
+    configuration("Show configuration"), cli_show_auto_mode("candidate", "cli", true, false, "explicit", "set ");
+    running("Show running"), cli_show_auto_mode("running", "cli", true, false, "explicit", "set ");
+}
+EOF
+
+new "test params: -f $cfg"
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+new "cli set single command is sent on exit"
+expectpart "$($clixon_cli -1 -f $cfg set table parameter a value 1)" 0 "^$"
+
+new "cli check set on exit"
+expectpart "$($clixon_cli -1 -f $cfg show configuration)" 0 "set table parameter a value 1"
+
+new "cli batched edits not seen before flush"
+cat <<EOF > $dir/batch.cli
+set table parameter b value 2
+show configuration
+flush
+show configuration
+EOF
+ret=$(cat $dir/batch.cli | $clixon_cli -f $cfg 2>&1)
+# First show has only a, second show has a and b
+n=$(echo "$ret" | grep -c "parameter a value 1")
+if [ $n -ne 2 ]; then
+    err1 "parameter a shown twice" "$n"
+fi
+n=$(echo "$ret" | grep -c "parameter b value 2")
+if [ $n -ne 1 ]; then
+    err1 "parameter b shown once" "$n"
+fi
+
+new "cli batch sent when full"
+cat <<EOF > $dir/batch.cli
+set table parameter c1
+set table parameter c2
+set table parameter c3
+show configuration
+EOF
+expectpart "$(cat $dir/batch.cli | $clixon_cli -f $cfg 2>&1)" 0 "set table parameter c1" "set table parameter c2" "set table parameter c3"
+
+new "cli delete and set in batch keep order"
+cat <<EOF > $dir/batch.cli
+delete table parameter c1
+set table parameter c1 value 10
+delete table parameter c2
+EOF
+expectpart "$(cat $dir/batch.cli | $clixon_cli -f $cfg 2>&1)" 0 "^$"
+
+new "cli check order"
+expectpart "$($clixon_cli -1 -f $cfg show configuration)" 0 "set table parameter c1 value 10" "set table parameter c3" --not-- "parameter c2"
+
+new "cli discard drops batch"
+cat <<EOF > $dir/batch.cli
+set table parameter d
+discard
+EOF
+expectpart "$(cat $dir/batch.cli | $clixon_cli -f $cfg 2>&1)" 0 "^$"
+
+new "cli check discard"
+expectpart "$($clixon_cli -1 -f $cfg show configuration)" 0 "^$"
+
+new "cli error reported on flush"
+cat <<EOF > $dir/batch.cli
+set table parameter e
+create table parameter e
+flush
+EOF
+expectpart "$(cat $dir/batch.cli | $clixon_cli -f $cfg 2>&1)" 0 "Editing configuration" "data-exists"
+
+new "cli commit sends batch"
+cat <<EOF > $dir/batch.cli
+set table parameter f value 6
+commit
+EOF
+expectpart "$(cat $dir/batch.cli | $clixon_cli -f $cfg 2>&1)" 0 "^$"
+
+new "cli check running"
+expectpart "$($clixon_cli -1 -f $cfg show running)" 0 "set table parameter e" "set table parameter f value 6"
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
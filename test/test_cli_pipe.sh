@@ -132,8 +132,11 @@ CLICON_MODE="|mypipe"; # Must start with |
 \| {
    grep <arg:string>, pipe_grep_fn("-e", "arg");
    except <arg:string>, pipe_grep_fn("-v", "arg");
+   include <arg:string>, pipe_grep_fn("-e", "arg");
    tail <arg:string>, pipe_tail_fn("-n", "arg");
+   head <arg:uint32>, pipe_head_fn("arg");
    count, pipe_wc_fn("-l");
+   display xpath <arg:string>, pipe_xpath_fn("arg");
    show {
      json, pipe_showas_fn("json");
      text, pipe_showas_fn("text");
@@ -202,6 +205,21 @@ expectpart "$($clixon_cli -1 -m $mode -f $cfg show explicit config \| tail 5)" 0
 new "$mode show explicit | count"
 expectpart "$($clixon_cli -1 -m $mode -f $cfg show explicit config \| count)" 0 10
 
+new "$mode show explicit | include value"
+expectpart "$($clixon_cli -1 -m $mode -f $cfg show explicit config \| include value)" 0 "<value>a</value>" "<value>b</value>" --not-- "name" "table"
+
+new "$mode show explicit | except par"
+expectpart "$($clixon_cli -1 -m $mode -f $cfg show explicit config \| except par)" 0 "table" "<name>x</name>" --not-- "parameter"
+
+new "$mode show explicit | head 1"
+expectpart "$($clixon_cli -1 -m $mode -f $cfg show explicit config \| head 1)" 0 "^<table xmlns=\"urn:example:clixon\">$" --not-- "parameter"
+
+new "$mode show explicit | tail 1"
+expectpart "$($clixon_cli -1 -m $mode -f $cfg show explicit config \| tail 1)" 0 "^</table>$" --not-- "parameter"
+
+new "$mode show explicit | display xpath"
+expectpart "$($clixon_cli -1 -m $mode -f $cfg show explicit config \| display xpath "/ex:table/ex:parameter[ex:name='y']")" 0 "<name>y</name>" "<value>b</value>" --not-- "<name>x</name>" "table"
+
 # XXX dont work with valgrind?
 if [ $valgrindtest -eq 0 ]; then
 new "$mode show explicit | show json"
@@ -0,0 +1,109 @@
+#!/usr/bin/env bash
+# Group commit, see CLICON_COMMIT_GROUP
+# Concurrent edits and commits of several sessions are made as one transaction
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/group.yang
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>$dir</CLICON_YANG_DIR>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_YANG_LIBRARY>false</CLICON_YANG_LIBRARY>
+  <CLICON_NETCONF_MONITORING>false</CLICON_NETCONF_MONITORING>
+  <CLICON_COMMIT_GROUP>200</CLICON_COMMIT_GROUP>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module group{
+    yang-version 1.1;
+    namespace "urn:example:group";
+    prefix ex;
+    container c{
+        list x{
+            key k;
+            leaf k{
+                type string;
+            }
+            leaf v{
+                type string;
+            }
+        }
+    }
+}
+EOF
+
+new "test params: -f $cfg"
+
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+new "edit and commit in one session"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><c xmlns=\"urn:example:group\"><x><k>a</k><v>1</v></x></c></config></edit-config></rpc><rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply><rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "get running after single commit"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><c xmlns=\"urn:example:group\"><x><k>a</k><v>1</v></x></c></data></rpc-reply>"
+
+new "edit and commit in parallel sessions"
+for i in 1 2 3 4; do
+    rpc=$(chunked_framing "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><c xmlns=\"urn:example:group\"><x><k>p$i</k><v>$i</v></x></c></config></edit-config></rpc>")
+    rpc1=$(chunked_framing "<rpc $DEFAULTNS><commit/></rpc>")
+    ($clixon_netconf -qf $cfg > $dir/reply$i.xml <<EOF
+$DEFAULTHELLO$rpc$rpc1
+EOF
+    ) &
+done
+wait
+for i in 1 2 3 4; do
+    new "commit reply $i"
+    match=$(grep -c "<ok/></rpc-reply>" $dir/reply$i.xml)
+    if [ "$match" != 2 ]; then
+        err "<ok/> twice" "$(cat $dir/reply$i.xml)"
+    fi
+done
+
+new "get running after grouped commits"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><c xmlns=\"urn:example:group\"><x><k>a</k><v>1</v></x><x><k>p1</k><v>1</v></x><x><k>p2</k><v>2</v></x><x><k>p3</k><v>3</v></x><x><k>p4</k><v>4</v></x></c></data></rpc-reply>"
+
+new "edit, commit and discard in one session"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><c xmlns=\"urn:example:group\"><x><k>b</k><v>2</v></x></c></config></edit-config></rpc><rpc $DEFAULTNS><commit/></rpc><rpc $DEFAULTNS><discard-changes/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply><rpc-reply $DEFAULTNS><ok/></rpc-reply><rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "get running has committed entry"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source><filter type=\"xpath\" select=\"/ex:c/ex:x[ex:k='b']\" xmlns:ex=\"urn:example:group\"/></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><c xmlns=\"urn:example:group\"><x><k>b</k><v>2</v></x></c></data></rpc-reply>"
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -0,0 +1,172 @@
+#!/usr/bin/env bash
+# Confirmed-commit rollback from inverse edits, see CLICON_CONFIRMED_COMMIT_INVERSE
+# Run the same confirmed-commits and rollbacks without and with inverse edits, and check
+# that running is restored to the same configuration as before the confirmed-commits.
+# Rollbacks are made by cancel-commit, by disconnect of an ephemeral confirmed-commit, and
+# by timeout. Changes include deleted, added and changed nodes, chained confirmed-commits,
+# and an ordered-by user leaf-list which is not inverted but copied.
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+# Backend must be started by the test
+if [ $BE -eq 0 ]; then
+    echo "...skipped: must run with backend"
+    rm -rf $dir
+    if [ "$s" = $0 ]; then exit 0; else return 0; fi
+fi
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/clixon-example.yang
+
+cat <<EOF > $fyang
+module clixon-example{
+    yang-version 1.1;
+    namespace "urn:example:clixon";
+    prefix ex;
+    container table{
+        list parameter{
+            key name;
+            leaf name{
+                type string;
+            }
+            leaf value{
+                type string;
+            }
+            container sub{
+                leaf x{
+                    type string;
+                }
+            }
+        }
+        leaf-list order{
+            type string;
+            ordered-by user;
+        }
+    }
+}
+EOF
+
+function rpc() {
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS>$1</rpc>" "" "<rpc-reply $DEFAULTNS>$2</rpc-reply>"
+}
+
+function edit() {
+    rpc "<edit-config><target><candidate/></target><config><table xmlns=\"urn:example:clixon\" xmlns:nc=\"${BASENS}\">$1</table></config></edit-config>" "<ok/>"
+}
+
+function commit() {
+    rpc "<commit>$1</commit>" "<ok/>"
+}
+
+function running() {
+    new "running is $2"
+    if [ -z "$1" ]; then
+        rpc "<get-config><source><running/></source></get-config>" "<data/>"
+    else
+        rpc "<get-config><source><running/></source></get-config>" "<data><table xmlns=\"urn:example:clixon\">$1</table></data>"
+    fi
+}
+
+BASE="<parameter><name>p1</name><value>1</value></parameter><parameter><name>p2</name><value>2</value><sub><x>a</x></sub></parameter><order>x</order><order>y</order>"
+
+# Set running to BASE
+function base() {
+    new "base"
+    rpc "<edit-config><target><candidate/></target><default-operation>none</default-operation><config operation=\"delete\"/></edit-config>" "<ok/>"
+    edit "$BASE"
+    commit
+    running "$BASE" "base"
+}
+
+for inverse in false true; do
+    cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_FEATURE>ietf-netconf:confirmed-commit</CLICON_FEATURE>
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_BACKEND_DIR>/usr/local/lib/$APPNAME/backend</CLICON_BACKEND_DIR>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_CONFIRMED_COMMIT_INVERSE>$inverse</CLICON_CONFIRMED_COMMIT_INVERSE>
+</clixon-config>
+EOF
+
+    new "test params: -f $cfg"
+
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+
+    new "wait backend"
+    wait_backend
+
+    new "inverse $inverse: cancel-commit of delete, change and add"
+    base
+    edit "<parameter nc:operation=\"delete\"><name>p1</name></parameter><parameter><name>p2</name><value>3</value><sub><x>b</x></sub></parameter><parameter><name>p3</name><value>4</value></parameter>"
+    commit "<confirmed/><persist>a</persist>"
+    running "<parameter><name>p2</name><value>3</value><sub><x>b</x></sub></parameter><parameter><name>p3</name><value>4</value></parameter><order>x</order><order>y</order>" "changed"
+    rpc "<cancel-commit><persist-id>a</persist-id></cancel-commit>" "<ok/>"
+    running "$BASE" "base after cancel-commit"
+
+    new "inverse $inverse: cancel-commit of chained confirmed-commits"
+    base
+    edit "<parameter><name>p2</name><value>5</value></parameter>"
+    commit "<confirmed/><persist>b</persist>"
+    edit "<parameter nc:operation=\"delete\"><name>p2</name></parameter><parameter><name>p4</name></parameter>"
+    commit "<confirmed/><persist-id>b</persist-id><persist>c</persist>"
+    running "<parameter><name>p1</name><value>1</value></parameter><parameter><name>p4</name></parameter><order>x</order><order>y</order>" "changed twice"
+    rpc "<cancel-commit><persist-id>c</persist-id></cancel-commit>" "<ok/>"
+    running "$BASE" "base after cancel-commit"
+
+    new "inverse $inverse: cancel-commit of ordered-by user change"
+    base
+    edit "<parameter><name>p1</name><value>6</value></parameter><order>z</order>"
+    commit "<confirmed/><persist>d</persist>"
+    running "<parameter><name>p1</name><value>6</value></parameter><parameter><name>p2</name><value>2</value><sub><x>a</x></sub></parameter><order>x</order><order>y</order><order>z</order>" "changed"
+    rpc "<cancel-commit><persist-id>d</persist-id></cancel-commit>" "<ok/>"
+    running "$BASE" "base after cancel-commit"
+
+    new "inverse $inverse: ephemeral confirmed-commit rolls back after disconnect"
+    base
+    edit "<parameter><name>p1</name><value>7</value></parameter>"
+    commit "<confirmed/><confirm-timeout>30</confirm-timeout>"
+    running "$BASE" "base after disconnect"
+
+    new "inverse $inverse: confirmed-commit rolls back after timeout"
+    base
+    edit "<parameter><name>p2</name><sub nc:operation=\"delete\"/></parameter>"
+    commit "<confirmed/><confirm-timeout>2</confirm-timeout><persist>e</persist>"
+    running "<parameter><name>p1</name><value>1</value></parameter><parameter><name>p2</name><value>2</value></parameter><order>x</order><order>y</order>" "changed"
+    sleep 3
+    running "$BASE" "base after timeout"
+
+    new "inverse $inverse: confirming commit keeps changes"
+    base
+    edit "<parameter><name>p3</name></parameter>"
+    commit "<confirmed/><persist>f</persist>"
+    commit "<persist-id>f</persist-id>"
+    running "<parameter><name>p1</name><value>1</value></parameter><parameter><name>p2</name><value>2</value><sub><x>a</x></sub></parameter><parameter><name>p3</name></parameter><order>x</order><order>y</order>" "confirmed"
+
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+done
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -0,0 +1,104 @@
+#!/usr/bin/env bash
+# Count and existence checks of datastore nodes with the clixon-lib count rpc
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/count.yang
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>$dir</CLICON_YANG_DIR>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module count{
+    yang-version 1.1;
+    namespace "urn:example:count";
+    prefix ex;
+    container c{
+        list x{
+            key k;
+            leaf k{
+                type string;
+            }
+            leaf v{
+                type string;
+            }
+        }
+    }
+}
+EOF
+
+NSC="<namespace-context><namespace><prefix>ex</prefix><ns>urn:example:count</ns></namespace></namespace-context>"
+
+new "test params: -f $cfg"
+
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+new "add entries"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><c xmlns=\"urn:example:count\"><x><k>a</k><v>1</v></x><x><k>b</k></x><x><k>c</k><v>3</v></x></c></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "count list entries in candidate"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><count $LIBNS><datastore>candidate</datastore><xpath>/ex:c/ex:x</xpath>$NSC</count></rpc>" "" "<rpc-reply $DEFAULTNS><count $LIBNS>3</count></rpc-reply>"
+
+new "count list entries in running before commit"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><count $LIBNS><xpath>/ex:c/ex:x</xpath>$NSC</count></rpc>" "" "<rpc-reply $DEFAULTNS><count $LIBNS>0</count></rpc-reply>"
+
+new "commit"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "count list entries in running"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><count $LIBNS><xpath>/ex:c/ex:x</xpath>$NSC</count></rpc>" "" "<rpc-reply $DEFAULTNS><count $LIBNS>3</count></rpc-reply>"
+
+new "count leafs with predicate"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><count $LIBNS><xpath>/ex:c/ex:x[ex:v]/ex:v</xpath>$NSC</count></rpc>" "" "<rpc-reply $DEFAULTNS><count $LIBNS>2</count></rpc-reply>"
+
+new "exists list entry"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><count $LIBNS><xpath>/ex:c/ex:x[ex:k='b']</xpath>$NSC<exists>true</exists></count></rpc>" "" "<rpc-reply $DEFAULTNS><count $LIBNS>1</count></rpc-reply>"
+
+new "exists of several entries is 1"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><count $LIBNS><xpath>/ex:c/ex:x</xpath>$NSC<exists>true</exists></count></rpc>" "" "<rpc-reply $DEFAULTNS><count $LIBNS>1</count></rpc-reply>"
+
+new "not exists list entry"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><count $LIBNS><xpath>/ex:c/ex:x[ex:k='z']</xpath>$NSC<exists>true</exists></count></rpc>" "" "<rpc-reply $DEFAULTNS><count $LIBNS>0</count></rpc-reply>"
+
+new "count with unknown prefix"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><count $LIBNS><xpath>/xx:c</xpath></count></rpc>" "<rpc-reply $DEFAULTNS><rpc-error><error-type>application</error-type><error-tag>invalid-value</error-tag>" ""
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -0,0 +1,146 @@
+#!/usr/bin/env bash
+# zstd compressed datastore files, see CLICON_XMLDB_COMPRESS
+# Write compressed running, restart and read it, then turn compression off and check
+# that the compressed file is still read and then written uncompressed
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+if [ "$HAVE_LIBZSTD" != true ]; then
+    echo "...skipped: zstd not available"
+    rm -rf $dir
+    if [ "$s" = $0 ]; then exit 0; else return 0; fi
+fi
+
+# Backend must be started by the test
+if [ $BE -eq 0 ]; then
+    echo "...skipped: must run with backend"
+    rm -rf $dir
+    if [ "$s" = $0 ]; then exit 0; else return 0; fi
+fi
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/clixon-example.yang
+
+# Number of list entries
+: ${nr:=1000}
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>$dir</CLICON_YANG_DIR>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_BACKEND_DIR>/usr/local/lib/$APPNAME/backend</CLICON_BACKEND_DIR>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_XMLDB_COMPRESS>3</CLICON_XMLDB_COMPRESS>
+  <CLICON_YANG_LIBRARY>false</CLICON_YANG_LIBRARY>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module clixon-example{
+    yang-version 1.1;
+    namespace "urn:example:clixon";
+    prefix ex;
+    container table{
+        list parameter{
+            key name;
+            leaf name{
+                type string;
+            }
+            leaf value{
+                type string;
+            }
+        }
+    }
+}
+EOF
+
+# First bytes of file in hex
+function magic()
+{
+    head -c 4 $1 | od -An -tx1 | tr -d ' \n'
+}
+
+new "test params: -f $cfg"
+
+new "kill old backend"
+sudo clixon_backend -zf $cfg
+if [ $? -ne 0 ]; then
+    err
+fi
+new "start backend -s init -f $cfg"
+start_backend -s init -f $cfg
+
+new "wait backend"
+wait_backend
+
+new "add $nr entries"
+rpc="<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><table xmlns=\"urn:example:clixon\">"
+for (( i=0; i<$nr; i++ )); do
+    rpc+="<parameter><name>$i</name><value>$i</value></parameter>"
+done
+rpc+="</table></config></edit-config></rpc>"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "$rpc" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "commit"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "running is zstd compressed"
+expectpart "$(magic $dir/running_db)" 0 "^28b52ffd$"
+
+new "kill old backend"
+sudo clixon_backend -zf $cfg
+if [ $? -ne 0 ]; then
+    err
+fi
+new "start backend -s running -f $cfg"
+start_backend -s running -f $cfg
+
+new "wait backend"
+wait_backend
+
+new "get-config of compressed running"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source><filter type=\"xpath\" select=\"/ex:table/ex:parameter[ex:name='$((nr-1))']\" xmlns:ex=\"urn:example:clixon\"/></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><table xmlns=\"urn:example:clixon\"><parameter><name>$((nr-1))</name><value>$((nr-1))</value></parameter></table></data></rpc-reply>"
+
+new "kill old backend"
+sudo clixon_backend -zf $cfg
+if [ $? -ne 0 ]; then
+    err
+fi
+new "start backend -s running -f $cfg -o CLICON_XMLDB_COMPRESS=0"
+start_backend -s running -f $cfg -o CLICON_XMLDB_COMPRESS=0
+
+new "wait backend"
+wait_backend
+
+new "get-config of compressed running without compression"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source><filter type=\"xpath\" select=\"/ex:table/ex:parameter[ex:name='0']\" xmlns:ex=\"urn:example:clixon\"/></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><table xmlns=\"urn:example:clixon\"><parameter><name>0</name><value>0</value></parameter></table></data></rpc-reply>"
+
+new "edit-config"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><table xmlns=\"urn:example:clixon\"><parameter><name>$nr</name><value>$nr</value></parameter></table></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "commit"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "running is not compressed"
+expectpart "$(head -c 8 $dir/running_db)" 0 "^<config"
+
+new "Kill backend"
+# Check if premature kill
+pid=$(pgrep -u root -f clixon_backend)
+if [ -z "$pid" ]; then
+    err "backend already dead"
+fi
+# kill backend
+stop_backend -f $cfg
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -0,0 +1,152 @@
+#!/usr/bin/env bash
+# Candidate sharing cache with running, see CLICON_XMLDB_CANDIDATE_COW
+# Run the same edits of candidate and running without and with sharing, and check that
+# candidate and running are the same in both runs, and that the candidate only shares
+# the cache of running when enabled and until either of them is modified.
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+# Backend must be started by the test
+if [ $BE -eq 0 ]; then
+    echo "...skipped: must run with backend"
+    rm -rf $dir
+    if [ "$s" = $0 ]; then exit 0; else return 0; fi
+fi
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/clixon-example.yang
+
+cat <<EOF > $fyang
+module clixon-example{
+    yang-version 1.1;
+    namespace "urn:example:clixon";
+    prefix ex;
+    container x {
+        list y {
+            key a;
+            leaf a {
+                type int32;
+            }
+            leaf b {
+                type int32;
+            }
+        }
+    }
+}
+EOF
+
+function rpc()
+{
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS>$1</rpc>" "" "<rpc-reply $DEFAULTNS>$2</rpc-reply>"
+}
+
+# Edit-config of datastore $1 with content $2 of container x
+function edit()
+{
+    rpc "<edit-config><target><$1/></target><config><x xmlns=\"urn:example:clixon\" xmlns:nc=\"${BASENS}\">$2</x></config></edit-config>" "<ok/>"
+}
+
+# Check content $2 of container x in datastore $1
+function check()
+{
+    new "$1 is $2"
+    rpc "<get-config><source><$1/></source></get-config>" "<data><x xmlns=\"urn:example:clixon\">$2</x></data>"
+}
+
+# Check if candidate shares cache: $1 is true or false
+function shared()
+{
+    new "candidate shared is $1"
+    rpc "<get content=\"nonconfig\"><filter type=\"xpath\" select=\"cl:memory-stats/cl:datastore[cl:name='candidate']/cl:shared\" xmlns:cl=\"http://clicon.org/lib\"/></get>" "<data><memory-stats xmlns=\"http://clicon.org/lib\"><datastore><name>candidate</name><shared>$1</shared></datastore></memory-stats></data>"
+}
+
+Y1="<y><a>1</a><b>1</b></y>"
+Y2="<y><a>2</a><b>2</b></y>"
+Y3="<y><a>3</a></y>"
+
+for cow in false true; do
+    cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_BACKEND_DIR>/usr/local/lib/$APPNAME/backend</CLICON_BACKEND_DIR>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_YANG_LIBRARY>false</CLICON_YANG_LIBRARY>
+  <CLICON_XMLDB_CANDIDATE_COW>$cow</CLICON_XMLDB_CANDIDATE_COW>
+</clixon-config>
+EOF
+
+    new "test params: -f $cfg"
+
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+
+    new "wait backend"
+    wait_backend
+
+    new "cow $cow: edit candidate and commit"
+    edit candidate "$Y1"
+    shared false
+    rpc "<commit/>" "<ok/>"
+    check running "$Y1"
+
+    new "cow $cow: discard-changes copies running to candidate"
+    rpc "<discard-changes/>" "<ok/>"
+    shared $cow
+    check candidate "$Y1"
+
+    new "cow $cow: edit running does not change candidate"
+    edit running "$Y2"
+    shared false
+    check running "$Y1$Y2"
+    check candidate "$Y1"
+
+    new "cow $cow: discard-changes"
+    rpc "<discard-changes/>" "<ok/>"
+    shared $cow
+    check candidate "$Y1$Y2"
+
+    new "cow $cow: edit candidate does not change running"
+    edit candidate "<y><a>1</a><b>3</b></y>$Y3"
+    shared false
+    check candidate "<y><a>1</a><b>3</b></y>$Y2$Y3"
+    check running "$Y1$Y2"
+
+    new "cow $cow: commit"
+    rpc "<commit/>" "<ok/>"
+    check running "<y><a>1</a><b>3</b></y>$Y2$Y3"
+
+    new "cow $cow: discard-changes and delete in candidate"
+    rpc "<discard-changes/>" "<ok/>"
+    shared $cow
+    edit candidate "<y nc:operation=\"delete\"><a>2</a></y>"
+    check candidate "<y><a>1</a><b>3</b></y>$Y3"
+    check running "<y><a>1</a><b>3</b></y>$Y2$Y3"
+    rpc "<commit/>" "<ok/>"
+    check running "<y><a>1</a><b>3</b></y>$Y3"
+
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+done
+
+rm -rf $dir
+
+new "endtest"
+endtest
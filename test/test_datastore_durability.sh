@@ -0,0 +1,125 @@
+#!/usr/bin/env bash
+# Deferred datastore writes, see CLICON_XMLDB_DURABILITY
+# Commits return before the datastore is written by a writer process.
+# Check that datastore files are eventually written, and written on exit
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/durability.yang
+
+cat <<EOF > $fyang
+module durability{
+    yang-version 1.1;
+    namespace "urn:example:durability";
+    prefix ex;
+    container c{
+        list x{
+            key k;
+            leaf k{
+                type string;
+            }
+            leaf v{
+                type string;
+            }
+        }
+    }
+}
+EOF
+
+# Args:
+# 1: mode: group or async
+function testrun()
+{
+    mode=$1
+
+    cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>$dir</CLICON_YANG_DIR>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_YANG_LIBRARY>false</CLICON_YANG_LIBRARY>
+  <CLICON_NETCONF_MONITORING>false</CLICON_NETCONF_MONITORING>
+  <CLICON_XMLDB_DURABILITY>$mode</CLICON_XMLDB_DURABILITY>
+  <CLICON_XMLDB_DURABILITY_INTERVAL>50</CLICON_XMLDB_DURABILITY_INTERVAL>
+</clixon-config>
+EOF
+
+    new "test params: -f $cfg durability $mode"
+
+    if [ $BE -ne 0 ]; then
+        new "kill old backend"
+        sudo clixon_backend -zf $cfg
+        if [ $? -ne 0 ]; then
+            err
+        fi
+        new "start backend -s init -f $cfg"
+        start_backend -s init -f $cfg
+    fi
+
+    new "wait backend"
+    wait_backend
+
+    for i in 1 2 3; do
+        new "edit and commit $i"
+        expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><c xmlns=\"urn:example:durability\"><x><k>e$i</k><v>$i</v></x></c></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+        expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+    done
+
+    new "get-config running"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><c xmlns=\"urn:example:durability\"><x><k>e1</k><v>1</v></x><x><k>e2</k><v>2</v></x><x><k>e3</k><v>3</v></x></c></data></rpc-reply>"
+
+    sleep 1
+
+    new "check running datastore file is written"
+    expectpart "$(sudo cat $dir/running_db)" 0 "<k>e3</k>"
+
+    new "edit and commit without waiting"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><c xmlns=\"urn:example:durability\"><x><k>e4</k><v>4</v></x></c></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+    if [ $BE -ne 0 ]; then
+        new "Kill backend"
+        # Check if premature kill
+        pid=$(pgrep -u root -f clixon_backend)
+        if [ -z "$pid" ]; then
+            err "backend already dead"
+        fi
+        stop_backend -f $cfg
+
+        new "start backend -s running -f $cfg"
+        start_backend -s running -f $cfg
+    fi
+
+    new "wait backend"
+    wait_backend
+
+    new "get-config running after restart"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source><filter type=\"xpath\" select=\"/ex:c/ex:x[ex:k='e4']\" xmlns:ex=\"urn:example:durability\"/></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><c xmlns=\"urn:example:durability\"><x><k>e4</k><v>4</v></x></c></data></rpc-reply>"
+
+    if [ $BE -ne 0 ]; then
+        new "Kill backend"
+        # Check if premature kill
+        pid=$(pgrep -u root -f clixon_backend)
+        if [ -z "$pid" ]; then
+            err "backend already dead"
+        fi
+        # kill backend
+        stop_backend -f $cfg
+    fi
+}
+
+testrun group
+testrun async
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -0,0 +1,156 @@
+#!/usr/bin/env bash
+# Edit log of candidate, see CLICON_XMLDB_EDIT_LOG
+# Run the same edits and commits without and with the edit log, and check that the commits
+# see the same changes in the transaction log of the example backend plugin, and that running
+# is the same. Includes edits that invalidate the edit log: delete operation, discard-changes,
+# and an edit of running between edit and commit of candidate.
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+# Backend must be started by the test
+if [ $BE -eq 0 ]; then
+    echo "...skipped: must run with backend"
+    rm -rf $dir
+    if [ "$s" = $0 ]; then exit 0; else return 0; fi
+fi
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/clixon-example.yang
+flog=$dir/backend.log
+
+cat <<EOF > $fyang
+module clixon-example{
+    yang-version 1.1;
+    namespace "urn:example:clixon";
+    prefix ex;
+    container x {
+        list y {
+            key a;
+            leaf a {
+                type int32;
+            }
+            leaf b {
+                type int32;
+            }
+            container z {
+                leaf c {
+                    type string;
+                }
+            }
+        }
+        leaf w {
+            type string;
+        }
+    }
+}
+EOF
+
+# Edit-config of datastore $1 with content $2 of container x
+function edit()
+{
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><$1/></target><config><x xmlns=\"urn:example:clixon\" xmlns:nc=\"${BASENS}\">$2</x></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+}
+
+function commit()
+{
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+}
+
+# Expected changes seen by the commits, as logged by main_commit of the example plugin
+cat <<EOF > $dir/commit.expect
+main_commit add: <y><a>1</a><b>1</b></y>
+main_commit change: <b>1</b><b>2</b>
+main_commit add: <y><a>2</a><z><c>foo</c></z></y>
+main_commit del: <y><a>1</a><b>2</b></y>
+main_commit add: <w>foo</w>
+main_commit add: <y><a>3</a></y>
+main_commit change: <w>bar</w><w>foo</w>
+EOF
+
+for editlog in false true; do
+    cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_BACKEND_DIR>/usr/local/lib/$APPNAME/backend</CLICON_BACKEND_DIR>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_XMLDB_EDIT_LOG>$editlog</CLICON_XMLDB_EDIT_LOG>
+</clixon-config>
+EOF
+    sudo rm -f $flog
+    touch $flog
+
+    new "test params: -f $cfg -l f$flog -- -t"
+
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg -l f$flog -- -t"
+    start_backend -s init -f $cfg -l f$flog -- -t
+
+    new "wait backend"
+    wait_backend
+
+    new "edit log $editlog: add y 1"
+    edit candidate "<y><a>1</a><b>1</b></y>"
+    commit
+
+    new "edit log $editlog: change y 1"
+    edit candidate "<y><a>1</a><b>2</b></y>"
+    commit
+
+    new "edit log $editlog: add y 2"
+    edit candidate "<y><a>2</a><z><c>foo</c></z></y>"
+    commit
+
+    new "edit log $editlog: delete y 1"
+    edit candidate "<y nc:operation=\"delete\"><a>1</a></y>"
+    commit
+
+    new "edit log $editlog: change y 2 and discard"
+    edit candidate "<y><a>2</a><z><c>bar</c></z></y>"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><discard-changes/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+    new "edit log $editlog: add w"
+    edit candidate "<w>foo</w>"
+    commit
+
+    new "edit log $editlog: add y 3, and change w in running before commit"
+    edit candidate "<y><a>3</a></y>"
+    edit running "<w>bar</w>"
+    commit
+
+    new "edit log $editlog: get-config"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><x xmlns=\"urn:example:clixon\"><y><a>2</a><z><c>foo</c></z></y><y><a>3</a></y><w>foo</w></x></data></rpc-reply>"
+
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+
+    sudo grep "transaction_log [0-9]* main_commit " $flog | sed 's/.*transaction_log [0-9]* //' > $dir/commit.$editlog
+
+    new "edit log $editlog: commits see expected changes"
+    expectpart "$(diff $dir/commit.expect $dir/commit.$editlog)" 0 ""
+done
+
+new "commits see same changes with and without edit log"
+expectpart "$(diff $dir/commit.false $dir/commit.true)" 0 ""
+
+sudo rm -f $flog
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -0,0 +1,125 @@
+#!/usr/bin/env bash
+# Datastore split test in JSON format, see CLICON_XMLDB_MULTI
+# Sub-files are parsed in parallel on restart, see CLICON_XMLDB_MULTI_PARALLEL
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/clixon-example.yang
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_DIR>${dir}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_YANG_LIBRARY>false</CLICON_YANG_LIBRARY>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_DIR>/usr/local/lib/$APPNAME/backend</CLICON_BACKEND_DIR>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_XMLDB_FORMAT>json</CLICON_XMLDB_FORMAT>
+  <CLICON_XMLDB_MULTI>true</CLICON_XMLDB_MULTI>
+  <CLICON_XMLDB_MULTI_PARALLEL>2</CLICON_XMLDB_MULTI_PARALLEL>
+  <CLICON_NETCONF_MONITORING>false</CLICON_NETCONF_MONITORING>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module clixon-example{
+  yang-version 1.1;
+  namespace "urn:example:clixon";
+  prefix ex;
+  import clixon-lib {
+    prefix cl;
+  }
+  container top{
+    list mylist{
+      key name;
+      leaf name{
+        type string;
+      }
+      container root{
+         cl:xmldb-split{
+           description "Multi-XMLDB: split datastore here";
+         }
+         list mylist1{
+            key name1;
+            leaf name1{
+               type string;
+            }
+            leaf value1 {
+               type string;
+            }
+         }
+      }
+    }
+  }
+}
+EOF
+
+new "test params: -f $cfg"
+
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+new "Add data to split-points x and y"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><top xmlns=\"urn:example:clixon\"><mylist><name>x</name><root><mylist1><name1>x1</name1><value1>42</value1></mylist1></root></mylist><mylist><name>y</name><root><mylist1><name1>y1</name1></mylist1></root></mylist></top></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "netconf commit"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "Check running root file is JSON with links"
+expectpart "$(sudo cat $dir/running.d/0.json)" 0 "\"clixon-lib:link\": \"[0-9a-f]*.json\""
+
+new "Check running has two JSON sub-files"
+nr=$(sudo ls $dir/running.d/ | grep -v "^0.json" | grep -c "\.json$")
+if [ $nr -ne 2 ]; then
+    err "2" "$nr"
+fi
+
+new "Check running sub-files are JSON"
+expectpart "$(sudo cat $dir/running.d/*.json)" 0 "\"clixon-example:root\"" "\"name1\": \"x1\""
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    stop_backend -f $cfg
+
+    new "start backend -s running -f $cfg"
+    start_backend -s running -f $cfg
+fi
+
+new "wait backend 2"
+wait_backend
+
+new "get-config running after restart"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><top xmlns=\"urn:example:clixon\"><mylist><name>x</name><root><mylist1><name1>x1</name1><value1>42</value1></mylist1></root></mylist><mylist><name>y</name><root><mylist1><name1>y1</name1></mylist1></root></mylist></top></data></rpc-reply>"
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+sudo rm -rf $dir
+
+new "endtest"
+endtest
@@ -0,0 +1,185 @@
+#!/usr/bin/env bash
+# Parallel parsing of datastore sub-files, see CLICON_XMLDB_MULTI_PARALLEL
+# Restart the backend from a running datastore split in many sub-files, sequentially and with
+# several processes, in XML and JSON format, and check that results and errors are the same.
+# Missing sub-files make the workers fail: their files are parsed again by the backend, and
+# the first missing file in document order is reported.
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+# Backend must be started by the test
+if [ $BE -eq 0 ]; then
+    echo "...skipped: must run with backend"
+    rm -rf $dir
+    if [ "$s" = $0 ]; then exit 0; else return 0; fi
+fi
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/clixon-example.yang
+
+# Number of sub-files
+nr=20
+
+# Number of processes
+workers=4
+
+cat <<EOF > $fyang
+module clixon-example{
+  yang-version 1.1;
+  namespace "urn:example:clixon";
+  prefix ex;
+  import clixon-lib {
+    prefix cl;
+  }
+  container top{
+    list mylist{
+      key name;
+      leaf name{
+        type string;
+      }
+      container root{
+         cl:xmldb-split{
+           description "Multi-XMLDB: split datastore here";
+         }
+         list mylist1{
+            key name1;
+            leaf name1{
+               type string;
+            }
+            leaf value1 {
+               type string;
+            }
+         }
+      }
+    }
+  }
+}
+EOF
+
+function rpc()
+{
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS>$1</rpc>" "" "<rpc-reply $DEFAULTNS>$2</rpc-reply>"
+}
+
+C=""
+for (( i=0; i<$nr; i++ )); do
+    k=$(printf "k%02d" $i)
+    C="$C<mylist><name>$k</name><root><mylist1><name1>$k-1</name1><value1>$i</value1></mylist1><mylist1><name1>$k-2</name1></mylist1></root></mylist>"
+done
+
+for format in xml json; do
+    for parallel in 0 $workers; do
+        cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_YANG_LIBRARY>false</CLICON_YANG_LIBRARY>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_DIR>/usr/local/lib/$APPNAME/backend</CLICON_BACKEND_DIR>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_XMLDB_FORMAT>$format</CLICON_XMLDB_FORMAT>
+  <CLICON_XMLDB_MULTI>true</CLICON_XMLDB_MULTI>
+  <CLICON_XMLDB_MULTI_PARALLEL>$parallel</CLICON_XMLDB_MULTI_PARALLEL>
+  <CLICON_NETCONF_MONITORING>false</CLICON_NETCONF_MONITORING>
+</clixon-config>
+EOF
+
+        new "test params: -f $cfg"
+
+        new "kill old backend"
+        sudo clixon_backend -zf $cfg
+        if [ $? -ne 0 ]; then
+            err
+        fi
+        sudo rm -rf $dir/*.d
+        new "start backend -s init -f $cfg"
+        start_backend -s init -f $cfg
+
+        new "wait backend"
+        wait_backend
+
+        new "$format parallel $parallel: add $nr split entries"
+        rpc "<edit-config><target><candidate/></target><config><top xmlns=\"urn:example:clixon\">$C</top></config></edit-config>" "<ok/>"
+        rpc "<commit/>" "<ok/>"
+
+        new "$format parallel $parallel: check $nr sub-files"
+        n=$(sudo ls $dir/running.d/ | grep -v "^0\.$format" | grep -c "\.$format$")
+        if [ $n -ne $nr ]; then
+            err "$nr" "$n"
+        fi
+
+        new "Kill backend"
+        stop_backend -f $cfg
+
+        new "start backend -s running -f $cfg"
+        start_backend -s running -f $cfg
+
+        new "wait backend"
+        wait_backend
+
+        new "$format parallel $parallel: get-config running after restart"
+        rpc "<get-config><source><running/></source></get-config>" "<data><top xmlns=\"urn:example:clixon\">$C</top></data>"
+
+        new "Kill backend"
+        stop_backend -f $cfg
+
+        # Sub-files in document order, linked from the root file
+        links=$(sudo grep -o "[0-9a-f]*\.$format" $dir/running.d/0.$format | grep -v "^0\.$format$")
+        f1=$(echo "$links" | sed -n 4p)
+        f2=$(echo "$links" | sed -n 16p)
+        sudo cp -a $dir/running.d $dir/saved.d
+
+        new "$format parallel $parallel: two sub-files missing"
+        sudo rm -f $dir/running.d/$f1 $dir/running.d/$f2
+        ret=$(sudo $clixon_backend -F1s running -f $cfg -l o 2>&1)
+        expectpart "$ret" 255 "open(" "$f1" --not-- "$f2"
+        echo "$ret" | grep -o "open([^)]*)" > $dir/err$format$parallel
+
+        new "$format parallel $parallel: last sub-file missing"
+        sudo rm -rf $dir/running.d
+        sudo cp -a $dir/saved.d $dir/running.d
+        sudo rm -f $dir/running.d/$f2
+        ret=$(sudo $clixon_backend -F1s running -f $cfg -l o 2>&1)
+        expectpart "$ret" 255 "open(" "$f2" --not-- "$f1"
+        echo "$ret" | grep -o "open([^)]*)" > $dir/err2$format$parallel
+
+        new "$format parallel $parallel: all sub-files again"
+        sudo rm -rf $dir/running.d
+        sudo cp -a $dir/saved.d $dir/running.d
+        new "start backend -s running -f $cfg"
+        start_backend -s running -f $cfg
+
+        new "wait backend"
+        wait_backend
+
+        new "$format parallel $parallel: get-config running"
+        rpc "<get-config><source><running/></source></get-config>" "<data><top xmlns=\"urn:example:clixon\">$C</top></data>"
+
+        new "Kill backend"
+        # Check if premature kill
+        pid=$(pgrep -u root -f clixon_backend)
+        if [ -z "$pid" ]; then
+            err "backend already dead"
+        fi
+        # kill backend
+        stop_backend -f $cfg
+    done
+
+    # Errors are the same as sequential
+    for f in err err2; do
+        new "$format same $f sequential and parallel"
+        if ! cmp -s $dir/$f${format}0 $dir/$f$format$workers; then
+            err "$(cat $dir/$f${format}0)" "$(cat $dir/$f$format$workers)"
+        fi
+    done
+done
+
+sudo rm -rf $dir
+
+new "endtest"
+endtest
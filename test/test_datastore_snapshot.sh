@@ -0,0 +1,190 @@
+#!/usr/bin/env bash
+# Read-only snapshot of running, see CLICON_XMLDB_SNAPSHOT
+# Commit to running and read the published snapshot in another process with a small
+# program using clixon_snapshot_read(). Check that the generation is incremented on each
+# change of running, also across backend restarts, but not on reads
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+# Backend must be started by the test
+if [ $BE -eq 0 ]; then
+    echo "...skipped: must run with backend"
+    rm -rf $dir
+    if [ "$s" = $0 ]; then exit 0; else return 0; fi
+fi
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/clixon-example.yang
+snapshot=$dir/running.snap
+cfile=$dir/snapshot.c
+app=$dir/snapshot
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>$dir</CLICON_YANG_DIR>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_BACKEND_DIR>/usr/local/lib/$APPNAME/backend</CLICON_BACKEND_DIR>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_XMLDB_SNAPSHOT>$snapshot</CLICON_XMLDB_SNAPSHOT>
+  <CLICON_YANG_LIBRARY>false</CLICON_YANG_LIBRARY>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module clixon-example{
+    yang-version 1.1;
+    namespace "urn:example:clixon";
+    prefix ex;
+    container table{
+        list parameter{
+            key name;
+            leaf name{
+                type string;
+            }
+            leaf value{
+                type string;
+            }
+        }
+    }
+}
+EOF
+
+cat <<EOF > $cfile
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+
+#include <cligen/cligen.h>
+#include <clixon/clixon.h>
+
+/* Usage: snapshot <file> <name>, print generation and value of parameter */
+int
+main(int    argc,
+     char **argv)
+{
+    cxobj   *xt = NULL;
+    cxobj   *x;
+    cvec    *nsc = NULL;
+    uint64_t gen0 = 0;
+    uint64_t gen = 0;
+
+    if (argc != 3)
+        return -1;
+    if (clixon_snapshot_generation(argv[1], &gen0) != 1)
+        return -1;
+    if (clixon_snapshot_read(argv[1], NULL, &xt, &gen) != 1)
+        return -1;
+    if (gen != gen0)
+        return -1;
+    if ((nsc = xml_nsctx_init("ex", "urn:example:clixon")) == NULL)
+        return -1;
+    x = xpath_first(xt, nsc, "/ex:table/ex:parameter[ex:name='%s']/ex:value", argv[2]);
+    printf("gen:%" PRIu64 " value:%s\n", gen, x ? xml_body(x) : "-");
+    xml_nsctx_free(nsc);
+    xml_free(xt);
+    return 0;
+}
+EOF
+
+# Print generation of snapshot
+function snapgen()
+{
+    sudo $app $snapshot a | sed -n 's/^gen:\([0-9]*\) .*/\1/p'
+}
+
+new "compile $cfile -> $app"
+if [ "$LINKAGE" = static ]; then
+    COMPILE="$CC ${CFLAGS} -I/usr/local/include $cfile -o $app /usr/local/lib/libclixon${LIBSTATIC_SUFFIX} ${LIBS}"
+else
+    COMPILE="$CC ${CFLAGS} -I/usr/local/include $cfile -o $app -L /usr/local/lib -lclixon"
+fi
+expectpart "$($COMPILE)" 0 ""
+
+new "test params: -f $cfg"
+
+new "kill old backend"
+sudo clixon_backend -zf $cfg
+if [ $? -ne 0 ]; then
+    err
+fi
+new "start backend -s init -f $cfg"
+start_backend -s init -f $cfg
+
+new "wait backend"
+wait_backend
+
+new "snapshot published on start"
+expectpart "$(sudo head -c 8 $snapshot)" 0 "^CLIXONSS$"
+
+new "snapshot of empty running"
+expectpart "$(sudo $app $snapshot a)" 0 "^gen:[0-9]* value:-$"
+gen0=$(snapgen)
+
+new "edit-config"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><table xmlns=\"urn:example:clixon\"><parameter><name>a</name><value>1</value></parameter></table></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "snapshot not changed by edit of candidate"
+expectpart "$(sudo $app $snapshot a)" 0 "^gen:$gen0 value:-$"
+
+new "commit"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "snapshot after commit"
+expectpart "$(sudo $app $snapshot a)" 0 "value:1$"
+gen1=$(snapgen)
+if [ -z "$gen1" ] || [ $gen1 -le $gen0 ]; then
+    err "generation > $gen0" "$gen1"
+fi
+
+new "get-config"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><table xmlns=\"urn:example:clixon\"><parameter><name>a</name><value>1</value></parameter></table></data></rpc-reply>"
+
+new "snapshot not changed by read"
+expectpart "$(sudo $app $snapshot a)" 0 "^gen:$gen1 value:1$"
+
+new "kill old backend"
+sudo clixon_backend -zf $cfg
+if [ $? -ne 0 ]; then
+    err
+fi
+new "start backend -s running -f $cfg"
+start_backend -s running -f $cfg
+
+new "wait backend"
+wait_backend
+
+new "edit-config"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><table xmlns=\"urn:example:clixon\"><parameter><name>a</name><value>2</value></parameter></table></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "commit"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "snapshot generation continues after restart"
+expectpart "$(sudo $app $snapshot a)" 0 "value:2$"
+gen2=$(snapgen)
+if [ -z "$gen2" ] || [ $gen2 -le $gen1 ]; then
+    err "generation > $gen1" "$gen2"
+fi
+
+new "Kill backend"
+# Check if premature kill
+pid=$(pgrep -u root -f clixon_backend)
+if [ -z "$pid" ]; then
+    err "backend already dead"
+fi
+# kill backend
+stop_backend -f $cfg
+
+sudo rm -f $snapshot
+rm -rf $dir
+
+new "endtest"
+endtest
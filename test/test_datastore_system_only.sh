@@ -474,6 +474,63 @@ check_db candidate false json
 new "Get mydata from candidate"
 expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><candidate/></source></get-config></rpc>" "<rpc-reply $DEFAULTNS><data><store xmlns=\"urn:example:std\"><keys><key><name>a</name><system-only-data>mydata</system-only-data><normal-data>otherdata</normal-data></key></keys></store></data></rpc-reply>"
 
+new "Restart with system-only cache"
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+fi
+
+sudo cp $dir/x_db_xml $dir/startup_db
+sudo cp $dir/y_db $dir/system-only.xml
+sudo chmod 666 $dir/system-only.xml
+
+if [ $BE -ne 0 ]; then
+    new "start backend -s startup -f $cfg -o CLICON_XMLDB_SYSTEM_ONLY_CACHE=true -- -o store/keys/key/system-only-data -O $dir/system-only.xml"
+    start_backend -s startup -f $cfg -o CLICON_XMLDB_SYSTEM_ONLY_CACHE=true -- -o store/keys/key/system-only-data -O $dir/system-only.xml
+fi
+
+new "wait backend cache"
+wait_backend
+
+new "Get mydata from running with cache"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><store xmlns=\"urn:example:std\"><keys><key><name>a</name><system-only-data>mydata</system-only-data><normal-data>otherdata</normal-data></key></keys></store></data></rpc-reply>"
+
+new "Get normal data only, system-only not selected"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source><filter type=\"xpath\" select=\"/std:store/std:keys/std:key/std:normal-data\" xmlns:std=\"urn:example:std\"/></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><store xmlns=\"urn:example:std\"><keys><key><name>a</name><normal-data>otherdata</normal-data></key></keys></store></data></rpc-reply>"
+
+new "Get system-only data only"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source><filter type=\"xpath\" select=\"/std:store/std:keys/std:key/std:system-only-data\" xmlns:std=\"urn:example:std\"/></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><store xmlns=\"urn:example:std\"><keys><key><name>a</name><system-only-data>mydata</system-only-data></key></keys></store></data></rpc-reply>"
+
+new "Source-of-truth: modify system-only outside commit"
+cat <<EOF > $dir/system-only.xml
+<store xmlns="urn:example:std">
+   <keys>
+      <key>
+         <name>a</name>
+         <system-only-data>CHANGED</system-only-data>
+      </key>
+   </keys>
+</store>
+EOF
+
+new "Get mydata from cache, not re-read"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><store xmlns=\"urn:example:std\"><keys><key><name>a</name><system-only-data>mydata</system-only-data><normal-data>otherdata</normal-data></key></keys></store></data></rpc-reply>"
+
+new "Restore original"
+cp $dir/y_db $dir/system-only.xml
+
+new "Add normal data"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><store xmlns=\"urn:example:std\"><keys><key><name>a</name><normal-data>otherdata2</normal-data></key></keys></store></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "Commit with cache"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "Get mydata from running after commit"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><store xmlns=\"urn:example:std\"><keys><key><name>a</name><system-only-data>mydata</system-only-data><normal-data>otherdata2</normal-data></key></keys></store></data></rpc-reply>"
+
 new "Restart"
 if [ $BE -ne 0 ]; then
     new "kill old backend"
@@ -0,0 +1,150 @@
+#!/usr/bin/env bash
+# Bulk merge of large sorted lists in edit-config, see CLICON_XMLDB_MODIFY_BULK
+# Run the same merges without and with bulk merge, and check that the results are the same:
+# sorted entries mixing new and existing entries, unsorted entries, and a list too short
+# for bulk merge.
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+# Backend must be started by the test
+if [ $BE -eq 0 ]; then
+    echo "...skipped: must run with backend"
+    rm -rf $dir
+    if [ "$s" = $0 ]; then exit 0; else return 0; fi
+fi
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/clixon-example.yang
+
+# Min number of entries of bulk merge
+bulk=10
+
+cat <<EOF > $fyang
+module clixon-example{
+    yang-version 1.1;
+    namespace "urn:example:clixon";
+    prefix ex;
+    container c {
+        list item {
+            key name;
+            leaf name {
+                type int32;
+            }
+            leaf value {
+                type string;
+            }
+        }
+    }
+}
+EOF
+
+function rpc()
+{
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS>$1</rpc>" "" "<rpc-reply $DEFAULTNS>$2</rpc-reply>"
+}
+
+# Merge list entries $1 in candidate
+function merge()
+{
+    rpc "<edit-config><target><candidate/></target><config><c xmlns=\"urn:example:clixon\">$1</c></config></edit-config>" "<ok/>"
+}
+
+# Get-config of candidate, expected list entries $1
+function getconf()
+{
+    rpc "<get-config><source><candidate/></source></get-config>" "<data><c xmlns=\"urn:example:clixon\">$1</c></data>"
+}
+
+# Even entries 0..38 with value a
+E=""
+for (( i=0; i<40; i+=2 )); do
+    E="$E<item><name>$i</name><value>a</value></item>"
+done
+# Entries 10..29 with value b, sorted
+S=""
+for (( i=10; i<30; i++ )); do
+    S="$S<item><name>$i</name><value>b</value></item>"
+done
+# Expected after merge of S
+R=""
+for (( i=0; i<40; i++ )); do
+    if [ $i -ge 10 -a $i -lt 30 ]; then
+        R="$R<item><name>$i</name><value>b</value></item>"
+    elif [ $((i%2)) -eq 0 ]; then
+        R="$R<item><name>$i</name><value>a</value></item>"
+    fi
+done
+# Entries 49..40 with value c, unsorted
+U=""
+for (( i=49; i>=40; i-- )); do
+    U="$U<item><name>$i</name><value>c</value></item>"
+done
+R2="$R"
+for (( i=40; i<50; i++ )); do
+    R2="$R2<item><name>$i</name><value>c</value></item>"
+done
+
+for n in 0 $bulk; do
+    cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_BACKEND_DIR>/usr/local/lib/$APPNAME/backend</CLICON_BACKEND_DIR>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_YANG_LIBRARY>false</CLICON_YANG_LIBRARY>
+  <CLICON_XMLDB_MODIFY_BULK>$n</CLICON_XMLDB_MODIFY_BULK>
+</clixon-config>
+EOF
+
+    new "test params: -f $cfg"
+
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+
+    new "wait backend"
+    wait_backend
+
+    new "bulk $n: merge even entries"
+    merge "$E"
+    getconf "$E"
+
+    new "bulk $n: merge sorted new and existing entries"
+    merge "$S"
+    getconf "$R"
+
+    new "bulk $n: merge unsorted entries"
+    merge "$U"
+    getconf "$R2"
+
+    new "bulk $n: merge few entries"
+    merge "<item><name>1</name><value>d</value></item><item><name>50</name><value>d</value></item>"
+    getconf "<item><name>0</name><value>a</value></item><item><name>1</name><value>d</value></item>${R2#<item><name>0</name><value>a</value></item>}<item><name>50</name><value>d</value></item>"
+
+    new "bulk $n: commit"
+    rpc "<commit/>" "<ok/>"
+
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+done
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -0,0 +1,150 @@
+#!/usr/bin/env bash
+# Cache of get-config replies, see CLICON_GET_REPLY_CACHE_TTL
+# Run the same get-config requests without and with the cache, and check that replies
+# follow changes of candidate and running, and differ on filter, depth and with-defaults.
+# Replies are also checked after the cached replies have expired.
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+# Backend must be started by the test
+if [ $BE -eq 0 ]; then
+    echo "...skipped: must run with backend"
+    rm -rf $dir
+    if [ "$s" = $0 ]; then exit 0; else return 0; fi
+fi
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/clixon-example.yang
+
+# Max age of cached reply in seconds
+ttl=2
+
+cat <<EOF > $fyang
+module clixon-example{
+    yang-version 1.1;
+    namespace "urn:example:clixon";
+    prefix ex;
+    container c {
+        list item {
+            key name;
+            leaf name {
+                type string;
+            }
+            leaf value {
+                type int32;
+                default 7;
+            }
+        }
+    }
+}
+EOF
+
+function rpc()
+{
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS>$1</rpc>" "" "<rpc-reply $DEFAULTNS>$2</rpc-reply>"
+}
+
+# Get-config
+# @param[in] db     Datastore
+# @param[in] attr   Attributes of get-config, eg depth
+# @param[in] select XPath filter
+# @param[in] extra  Extra elements, eg with-defaults
+# @param[in] data   Expected data
+function getconf()
+{
+    rpc "<get-config $2><source><$1/></source><filter type=\"xpath\" select=\"$3\" xmlns:ex=\"urn:example:clixon\"/>$4</get-config>" "$5"
+}
+
+for cache in 0 $ttl; do
+    cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_BACKEND_DIR>/usr/local/lib/$APPNAME/backend</CLICON_BACKEND_DIR>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_YANG_LIBRARY>false</CLICON_YANG_LIBRARY>
+  <CLICON_GET_REPLY_CACHE_TTL>$cache</CLICON_GET_REPLY_CACHE_TTL>
+</clixon-config>
+EOF
+
+    new "test params: -f $cfg"
+
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+
+    new "wait backend"
+    wait_backend
+
+    new "ttl $cache: add a and b"
+    rpc "<edit-config><target><candidate/></target><config><c xmlns=\"urn:example:clixon\"><item><name>a</name><value>1</value></item><item><name>b</name></item></c></config></edit-config>" "<ok/>"
+    rpc "<commit/>" "<ok/>"
+
+    for i in 1 2; do
+        new "ttl $cache: get-config running $i"
+        getconf running "" "/ex:c" "" "<data><c xmlns=\"urn:example:clixon\"><item><name>a</name><value>1</value></item><item><name>b</name></item></c></data>"
+    done
+
+    new "ttl $cache: get-config running other filter"
+    getconf running "" "/ex:c/ex:item[ex:name='a']" "" "<data><c xmlns=\"urn:example:clixon\"><item><name>a</name><value>1</value></item></c></data>"
+
+    new "ttl $cache: get-config running depth 2"
+    getconf running "depth=\"2\"" "/ex:c" "" "<data><c xmlns=\"urn:example:clixon\"><item></item><item></item></c></data>"
+
+    new "ttl $cache: get-config running report-all"
+    getconf running "" "/ex:c" "<with-defaults xmlns=\"urn:ietf:params:xml:ns:yang:ietf-netconf-with-defaults\">report-all</with-defaults>" "<data><c xmlns=\"urn:example:clixon\"><item><name>a</name><value>1</value></item><item><name>b</name><value>7</value></item></c></data>"
+
+    new "ttl $cache: edit candidate"
+    rpc "<edit-config><target><candidate/></target><config><c xmlns=\"urn:example:clixon\"><item><name>a</name><value>2</value></item></c></config></edit-config>" "<ok/>"
+
+    new "ttl $cache: get-config candidate is changed"
+    getconf candidate "" "/ex:c" "" "<data><c xmlns=\"urn:example:clixon\"><item><name>a</name><value>2</value></item><item><name>b</name></item></c></data>"
+
+    new "ttl $cache: get-config running is not changed"
+    getconf running "" "/ex:c" "" "<data><c xmlns=\"urn:example:clixon\"><item><name>a</name><value>1</value></item><item><name>b</name></item></c></data>"
+
+    new "ttl $cache: commit"
+    rpc "<commit/>" "<ok/>"
+
+    new "ttl $cache: get-config running is changed"
+    getconf running "" "/ex:c" "" "<data><c xmlns=\"urn:example:clixon\"><item><name>a</name><value>2</value></item><item><name>b</name></item></c></data>"
+
+    new "ttl $cache: get-config running other filter is changed"
+    getconf running "" "/ex:c/ex:item[ex:name='a']" "" "<data><c xmlns=\"urn:example:clixon\"><item><name>a</name><value>2</value></item></c></data>"
+
+    sleep $((ttl+1))
+
+    new "ttl $cache: get-config running after ttl"
+    getconf running "" "/ex:c" "" "<data><c xmlns=\"urn:example:clixon\"><item><name>a</name><value>2</value></item><item><name>b</name></item></c></data>"
+
+    new "ttl $cache: delete b"
+    rpc "<edit-config><target><candidate/></target><config><c xmlns=\"urn:example:clixon\"><item nc:operation=\"delete\" xmlns:nc=\"$BASENS\"><name>b</name></item></c></config></edit-config>" "<ok/>"
+    rpc "<commit/>" "<ok/>"
+
+    new "ttl $cache: get-config running without b"
+    getconf running "" "/ex:c" "" "<data><c xmlns=\"urn:example:clixon\"><item><name>a</name><value>2</value></item></c></data>"
+
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+done
+
+rm -rf $dir
+
+new "endtest"
+endtest
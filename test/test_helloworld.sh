@@ -7,7 +7,7 @@
 # Restconf is internal native http port 80
 # The minimality extends to the test macros that use advanced grep, and therefore more
 # primitive pattern macthing is made
-# Two variants exist, for poll and select event handling.
+# Three variants exist, for poll, epoll and select event handling.
 
 # Magic line must be first in script (see README.md)
 s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
@@ -109,15 +109,18 @@ show("Show a particular state of the system")
 EOF
 
 # Args:
-# 1: bool: event-handler
+# 1: bool: select event-handler
+# 2: bool: epoll event-handler
 function testrun()
 {
     eventhandler=$1
+    epoll=$2
 
     cat<<EOF > $CFD/diff.xml
 <?xml version="1.0" encoding="utf-8"?>
 <clixon-config xmlns="http://clicon.org/config">
    <CLICON_EVENT_SELECT>$eventhandler</CLICON_EVENT_SELECT>
+   <CLICON_EVENT_EPOLL>$epoll</CLICON_EVENT_EPOLL>
 </clixon-config>
 EOF
     new "test params: -f $cfg"
@@ -218,10 +221,13 @@ EOF
 }
 
 new "Eventhandler=select"
-testrun true
+testrun true false
 
 new "Eventhandler=poll"
-testrun false
+testrun false false
+
+new "Eventhandler=epoll"
+testrun false true
 
 rm -rf $dir
 
@@ -252,6 +252,36 @@ TP/$HVER 200" "Content-Type: text/html" "<title>Welcome to Clixon!</title>"
             err1 "$dir/foo.png $dir/www/data/example.css should be equal" "Not equal"
         fi
 
+        # Precompressed variant
+        gzip -c $dir/www/data/example.css > $dir/www/data/example.css.gz
+        new "WWW get css precompressed gzip"
+        curl $CURLOPTS2 -X GET -H 'Accept: text/css' -H 'Accept-Encoding: gzip' $proto://localhost/data/example.css -o $dir/foo.css.gz
+        gunzip -c $dir/foo.css.gz | cmp - $dir/www/data/example.css
+        if [ $? -ne 0 ]; then
+            err1 "$dir/foo.css.gz uncompressed and $dir/www/data/example.css should be equal" "Not equal"
+        fi
+
+        new "WWW head css precompressed gzip"
+        expectpart "$(curl $CURLOPTS --head -H 'Accept: text/css' -H 'Accept-Encoding: br;q=0, gzip' $proto://localhost/data/example.css)" 0 "HTTP/$HVER 200" "Content-Type: text/css" "Content-Encoding: gzip"
+
+        new "WWW get css gzip not accepted"
+        expectpart "$(curl $CURLOPTS -X GET -H 'Accept: text/css' -H 'Accept-Encoding: gzip;q=0' $proto://localhost/data/example.css)" 0 "HTTP/$HVER 200" "Content-Type: text/css" "display: inline;" --not-- "Content-Encoding"
+        rm -f $dir/www/data/example.css.gz
+
+        new "WWW get css range"
+        expectpart "$(curl $CURLOPTS -X GET -H 'Accept: text/css' -H 'Range: bytes=0-3' $proto://localhost/data/example.css)" 0 "HTTP/$HVER 206" "Content-Range: bytes 0-3/" "Content-Length: 4"
+
+        new "WWW get css range not satisfiable"
+        expectpart "$(curl $CURLOPTS -X GET -H 'Accept: text/css' -H 'Range: bytes=100000-' $proto://localhost/data/example.css)" 0 "HTTP/$HVER 416" "Content-Range: bytes \*/"
+
+        new "WWW get css etag"
+        ret=$(curl $CURLOPTS -X GET -H 'Accept: text/css' $proto://localhost/data/example.css)
+        expectpart "$ret" 0 "HTTP/$HVER 200" "ETag: \"" "Last-Modified: " "Accept-Ranges: bytes"
+        etag=$(echo "$ret" | grep -i "^etag:" | awk '{print $2}' | tr -d '\r')
+
+        new "WWW get css If-None-Match: 304"
+        expectpart "$(curl $CURLOPTS -X GET -H 'Accept: text/css' -H "If-None-Match: $etag" $proto://localhost/data/example.css)" 0 "HTTP/$HVER 304" "ETag: $etag" --not-- "display: inline;"
+
         # negative errors
         new "WWW get http not found"
         expectpart "$(curl $CURLOPTS -X GET -H 'Accept: text/html' $proto://localhost/data/notfound.html)" 0 "HTTP/$HVER 404" "Content-Type: text/html" "<title>404 Not Found</title>"
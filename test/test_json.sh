@@ -174,6 +174,15 @@ JSON='{"text":"bmp:\uFAIL"}'
 new "json escaping unicode BMP fail"
 expecteofx "$clixon_util_json -j -D $DBG" 255 "$JSON" 2> /dev/null
 
+new "json nested lists to xml"
+expecteofx "$clixon_util_json" 0 '{"a":[[1,2],{"b":3}],"c":{}}' "<a>1</a><a>2</a><a><b>3</b></a><c/>"
+
+new "json exponent without sign expect fail"
+expecteofx "$clixon_util_json" 255 '{"a":1e5}' 2> /dev/null
+
+new "json trailing comma expect fail"
+expecteofx "$clixon_util_json" 255 '{"a":1,}' 2> /dev/null
+
 rm -rf $dir
 
 new "endtest"
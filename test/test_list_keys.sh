@@ -0,0 +1,129 @@
+#!/usr/bin/env bash
+# Keys of lists and leaf-lists with the clixon-lib list-keys rpc, with prefix and max
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/list-keys.yang
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>$dir</CLICON_YANG_DIR>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module list-keys{
+    yang-version 1.1;
+    namespace "urn:example:keys";
+    prefix ex;
+    container c{
+        list x{
+            key k;
+            leaf k{
+                type string;
+            }
+            leaf v{
+                type string;
+            }
+        }
+        list y{
+            key n;
+            leaf n{
+                type int32;
+            }
+        }
+        list u{
+            key k;
+            ordered-by user;
+            leaf k{
+                type string;
+            }
+        }
+        leaf-list ll{
+            type string;
+        }
+    }
+}
+EOF
+
+NSC="<namespace-context><namespace><prefix>ex</prefix><ns>urn:example:keys</ns></namespace></namespace-context>"
+
+new "test params: -f $cfg"
+
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+new "add entries"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><c xmlns=\"urn:example:keys\"><x><k>b</k></x><x><k>ac</k><v>3</v></x><x><k>aa</k><v>1</v></x><x><k>ab</k></x><y><n>10</n></y><y><n>2</n></y><y><n>1</n></y><u><k>bb</k></u><u><k>ba</k></u><u><k>a</k></u><ll>xb</ll><ll>y</ll><ll>xa</ll></c></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "commit"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "list-keys all keys"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><list-keys $LIBNS><xpath>/ex:c/ex:x/ex:k</xpath>$NSC</list-keys></rpc>" "><cl:key>aa</cl:key><cl:key>ab</cl:key><cl:key>ac</cl:key><cl:key>b</cl:key></rpc-reply>" ""
+
+new "list-keys with prefix"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><list-keys $LIBNS><xpath>/ex:c/ex:x/ex:k</xpath>$NSC<prefix>a</prefix></list-keys></rpc>" "><cl:key>aa</cl:key><cl:key>ab</cl:key><cl:key>ac</cl:key></rpc-reply>" ""
+
+new "list-keys with prefix and max"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><list-keys $LIBNS><xpath>/ex:c/ex:x/ex:k</xpath>$NSC<prefix>a</prefix><max>2</max></list-keys></rpc>" "><cl:key>aa</cl:key><cl:key>ab</cl:key><cl:more>true</cl:more></rpc-reply>" ""
+
+new "list-keys with max equal to number of keys"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><list-keys $LIBNS><xpath>/ex:c/ex:x/ex:k</xpath>$NSC<prefix>a</prefix><max>3</max></list-keys></rpc>" "><cl:key>aa</cl:key><cl:key>ab</cl:key><cl:key>ac</cl:key></rpc-reply>" ""
+
+new "list-keys with no matching prefix"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><list-keys $LIBNS><xpath>/ex:c/ex:x/ex:k</xpath>$NSC<prefix>z</prefix></list-keys></rpc>" "<rpc-reply [^>]*/>" ""
+
+new "list-keys of integer keys with prefix"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><list-keys $LIBNS><xpath>/ex:c/ex:y/ex:n</xpath>$NSC<prefix>1</prefix></list-keys></rpc>" "><cl:key>1</cl:key><cl:key>10</cl:key></rpc-reply>" ""
+
+new "list-keys of ordered-by user list with prefix"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><list-keys $LIBNS><xpath>/ex:c/ex:u/ex:k</xpath>$NSC<prefix>b</prefix></list-keys></rpc>" "><cl:key>bb</cl:key><cl:key>ba</cl:key></rpc-reply>" ""
+
+new "list-keys of leaf-list with prefix"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><list-keys $LIBNS><xpath>/ex:c/ex:ll</xpath>$NSC<prefix>x</prefix></list-keys></rpc>" "><cl:key>xa</cl:key><cl:key>xb</cl:key></rpc-reply>" ""
+
+new "list-keys of non-key leaf"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><list-keys $LIBNS><xpath>/ex:c/ex:x/ex:v</xpath>$NSC</list-keys></rpc>" "><cl:key>1</cl:key><cl:key>3</cl:key></rpc-reply>" ""
+
+new "list-keys with predicate"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><list-keys $LIBNS><xpath>/ex:c/ex:x[ex:v]/ex:k</xpath>$NSC</list-keys></rpc>" "><cl:key>aa</cl:key><cl:key>ac</cl:key></rpc-reply>" ""
+
+new "list-keys without xpath"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><list-keys $LIBNS/></rpc>" "<rpc-reply $DEFAULTNS><rpc-error><error-type>protocol</error-type><error-tag>missing-element</error-tag>" ""
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
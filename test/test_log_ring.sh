@@ -0,0 +1,96 @@
+#!/usr/bin/env bash
+# Log destination ring, see CLIXON_LOG_RING
+# Start backend logging debug messages to the in-memory ring
+# Check that nothing is written to the log file until SIGUSR1 dumps the ring
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/ring.yang
+flog=$dir/ring.log
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>$dir</CLICON_YANG_DIR>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>/usr/local/var/$APPNAME</CLICON_XMLDB_DIR>
+  <CLICON_LOG_FILE>$flog</CLICON_LOG_FILE>
+  <CLICON_YANG_LIBRARY>false</CLICON_YANG_LIBRARY>
+  <CLICON_NETCONF_MONITORING>false</CLICON_NETCONF_MONITORING>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module ring{
+    yang-version 1.1;
+    namespace "urn:example:ring";
+    prefix ex;
+    container c{
+        leaf v{
+            type string;
+        }
+    }
+}
+EOF
+
+new "test params: -f $cfg"
+
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    rm -f $flog
+    new "start backend -s init -f $cfg -l r -D msg"
+    start_backend -s init -f $cfg -l r -D msg
+fi
+
+new "wait backend"
+wait_backend
+
+new "edit-config"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><c xmlns=\"urn:example:ring\"><v>ringmark</v></c></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+if [ $BE -ne 0 ]; then
+    new "no message in log file before dump"
+    if sudo grep -qs ringmark $flog; then
+        err "empty log file" "$(cat $flog)"
+    fi
+
+    new "dump log ring on SIGUSR1"
+    pid=$(pgrep -u root -f clixon_backend)
+    sudo kill -USR1 $pid
+    sleep 1
+
+    new "edit-config message in log file after dump"
+    if ! sudo grep -q ringmark $flog; then
+        err "ringmark in $flog" "$(sudo cat $flog)"
+    fi
+fi
+
+new "get-config after SIGUSR1"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><candidate/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><c xmlns=\"urn:example:ring\"><v>ringmark</v></c></data></rpc-reply>"
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
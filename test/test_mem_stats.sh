@@ -0,0 +1,111 @@
+#!/usr/bin/env bash
+# Memory usage of backend per subsystem and per datastore cache
+# Check clixon-lib memory-stats state data and that it is not part of a full get
+# Check cli show memory
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/memstats.yang
+clispec=$dir/spec.cli
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>$dir</CLICON_YANG_DIR>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_CLISPEC_DIR>$dir</CLICON_CLISPEC_DIR>
+  <CLICON_CLI_MODE>$APPNAME</CLICON_CLI_MODE>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>/usr/local/var/$APPNAME</CLICON_XMLDB_DIR>
+  <CLICON_YANG_LIBRARY>false</CLICON_YANG_LIBRARY>
+  <CLICON_NETCONF_MONITORING>false</CLICON_NETCONF_MONITORING>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module memstats{
+    yang-version 1.1;
+    namespace "urn:example:memstats";
+    prefix ex;
+    container c{
+        list x{
+            key k;
+            leaf k{
+                type string;
+            }
+            leaf v{
+                type string;
+            }
+        }
+    }
+}
+EOF
+
+cat <<EOF > $clispec
+CLICON_MODE="$APPNAME";
+CLICON_PROMPT="cli> ";
+show("Show") memory("Show memory"), cli_show_memory();{
+    xml("As XML"), cli_show_memory("xml");
+}
+EOF
+
+new "test params: -f $cfg"
+
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+new "add entries"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><c xmlns=\"urn:example:memstats\"><x><k>a</k><v>1</v></x><x><k>b</k><v>2</v></x></c></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "commit"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "get memory-stats tagged category"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get content=\"nonconfig\"><filter type=\"xpath\" select=\"cl:memory-stats\" xmlns:cl=\"http://clicon.org/lib\"/></get></rpc>" "<category><name>transaction</name><nr>[0-9]*</nr><bytes>[0-9]*</bytes><max-bytes>[1-9][0-9]*</max-bytes></category>" ""
+
+new "get memory-stats yang"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get content=\"nonconfig\"><filter type=\"xpath\" select=\"cl:memory-stats\" xmlns:cl=\"http://clicon.org/lib\"/></get></rpc>" "<category><name>yang</name><nr>[1-9][0-9]*</nr><bytes>[1-9][0-9]*</bytes></category>" ""
+
+new "get memory-stats running"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get content=\"nonconfig\"><filter type=\"xpath\" select=\"cl:memory-stats/cl:datastore[cl:name='running']\" xmlns:cl=\"http://clicon.org/lib\"/></get></rpc>" "<rpc-reply $DEFAULTNS><data><memory-stats xmlns=\"http://clicon.org/lib\"><datastore><name>running</name><nodes>[1-9][0-9]*</nodes><bytes>[1-9][0-9]*</bytes><shared>[a-z]*</shared></datastore></memory-stats></data></rpc-reply>" ""
+
+new "memory-stats not in full get"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get content=\"nonconfig\"/></rpc>" "" "<rpc-reply $DEFAULTNS><data/></rpc-reply>"
+
+new "cli show memory"
+expectpart "$($clixon_cli -1 -f $cfg show memory)" 0 "Category" "transaction" "stream" "yang" "Datastore" "running" "Total"
+
+new "cli show memory xml"
+expectpart "$($clixon_cli -1 -f $cfg show memory xml)" 0 "<memory-stats xmlns=\"http://clicon.org/lib\">" "<name>nacm</name>"
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
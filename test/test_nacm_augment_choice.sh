@@ -0,0 +1,242 @@
+#!/usr/bin/env bash
+# Authentication and authorization and IETF NACM
+# NACM data node rules on augmented nodes and on nodes below choice/case
+# Subtrees where no rule applies are skipped, see nacm_ymatch_below, so rules on
+# augmented nodes and on case nodes must be found from the schema of the ancestors.
+# Read with read-default permit and write with write-default permit, using:
+# - path rules on an augmented leaf and on nodes of a case
+# - module rules on the augmenting module
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+# Common NACM scripts
+. ./nacm.sh
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/nacm-example.yang
+fyang2=$dir/nacm-aug.yang
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_DIR>$dir</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_DIR>$dir</CLICON_YANG_MAIN_DIR>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_DIR>/usr/local/lib/$APPNAME/backend</CLICON_BACKEND_DIR>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_NACM_MODE>internal</CLICON_NACM_MODE>
+  <CLICON_NACM_CREDENTIALS>none</CLICON_NACM_CREDENTIALS>
+  <CLICON_NACM_DISABLED_ON_EMPTY>true</CLICON_NACM_DISABLED_ON_EMPTY>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module nacm-example{
+  yang-version 1.1;
+  namespace "urn:example:nacm";
+  prefix ex;
+  import ietf-netconf-acm {
+    prefix nacm;
+  }
+  container table{
+    container parameters{
+      list parameter{
+        key name;
+        leaf name{
+          type string;
+        }
+        choice kind{
+          case c1{
+            leaf x{
+              type string;
+            }
+          }
+          case c2{
+            leaf y{
+              type string;
+            }
+            container z{
+              leaf w{
+                type string;
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+}
+EOF
+
+cat <<EOF > $fyang2
+module nacm-aug{
+  yang-version 1.1;
+  namespace "urn:example:aug";
+  prefix aug;
+  import nacm-example {
+    prefix ex;
+  }
+  augment "/ex:table/ex:parameters/ex:parameter" {
+    leaf extra{
+      type string;
+    }
+    container ext{
+      leaf v{
+        type string;
+      }
+    }
+  }
+}
+EOF
+
+CONFIG="<table xmlns=\"urn:example:nacm\"><parameters><parameter><name>a</name><x>1</x><extra xmlns=\"urn:example:aug\">e1</extra><ext xmlns=\"urn:example:aug\"><v>v1</v></ext></parameter><parameter><name>b</name><y>2</y><z><w>3</w></z></parameter></parameters></table>"
+
+DENIED="<rpc-reply $DEFAULTNS><rpc-error><error-type>application</error-type><error-tag>access-denied</error-tag><error-severity>error</error-severity><error-message>access denied</error-message></rpc-error></rpc-reply>"
+
+# Print a rule
+# @param[in] name    Rule name
+# @param[in] module  Module name
+# @param[in] ops     Access operations
+# @param[in] path    Path or empty for module rule
+# @param[in] action  permit or deny
+function rule()
+{
+    echo -n "<rule><name>$1</name><module-name>$2</module-name><access-operations>$3</access-operations>"
+    if [ -n "$4" ]; then
+        echo -n "<path xmlns:ex=\"urn:example:nacm\" xmlns:aug=\"urn:example:aug\">$4</path>"
+    fi
+    echo -n "<action>$5</action></rule>"
+}
+
+# Replace rules of limited group as admin and commit
+# @param[in] rules  Rules
+function setrules()
+{
+    new "set limited rules"
+    expecteof_netconf "$clixon_netconf -U andy -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><nacm xmlns=\"urn:ietf:params:xml:ns:yang:ietf-netconf-acm\"><rule-list nc:operation=\"replace\" xmlns:nc=\"$BASENS\"><name>limited-acl</name><group>limited</group>$1</rule-list></nacm></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+    new "commit limited rules"
+    expecteof_netconf "$clixon_netconf -U andy -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+}
+
+# Get-config of table in running as wilma
+# @param[in] data    Expected data
+function gettable()
+{
+    expecteof_netconf "$clixon_netconf -U wilma -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source><filter type=\"xpath\" select=\"/ex:table\" xmlns:ex=\"urn:example:nacm\"/></get-config></rpc>" "" "<rpc-reply $DEFAULTNS>$1</rpc-reply>"
+}
+
+# Edit parameters in candidate as wilma, then discard changes
+# @param[in] params  Parameter list entries
+# @param[in] reply   Expected reply
+function editparams()
+{
+    expecteof_netconf "$clixon_netconf -U wilma -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><table xmlns=\"urn:example:nacm\"><parameters>$1</parameters></table></config></edit-config></rpc>" "" "$2"
+
+    expecteof_netconf "$clixon_netconf -U andy -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><discard-changes/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+}
+
+new "test params: -f $cfg"
+
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+new "set nacm and app config"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><nacm xmlns=\"urn:ietf:params:xml:ns:yang:ietf-netconf-acm\"><enable-nacm>true</enable-nacm><read-default>permit</read-default><write-default>permit</write-default><exec-default>permit</exec-default>$NGROUPS$NADMIN</nacm>$CONFIG</config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "commit it"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "no limited rules: read table"
+gettable "<data>$CONFIG</data>"
+
+# Read with read-default permit
+setrules "$(rule deny-extra "*" read "/ex:table/ex:parameters/ex:parameter/aug:extra" deny)"
+
+new "read: deny augmented leaf"
+gettable "<data><table xmlns=\"urn:example:nacm\"><parameters><parameter><name>a</name><x>1</x><ext xmlns=\"urn:example:aug\"><v>v1</v></ext></parameter><parameter><name>b</name><y>2</y><z><w>3</w></z></parameter></parameters></table></data>"
+
+setrules "$(rule deny-aug nacm-aug read "" deny)"
+
+new "read: deny augmenting module"
+gettable "<data><table xmlns=\"urn:example:nacm\"><parameters><parameter><name>a</name><x>1</x></parameter><parameter><name>b</name><y>2</y><z><w>3</w></z></parameter></parameters></table></data>"
+
+setrules "$(rule deny-x "*" read "/ex:table/ex:parameters/ex:parameter/ex:x" deny)"
+
+new "read: deny leaf in case"
+gettable "<data><table xmlns=\"urn:example:nacm\"><parameters><parameter><name>a</name><extra xmlns=\"urn:example:aug\">e1</extra><ext xmlns=\"urn:example:aug\"><v>v1</v></ext></parameter><parameter><name>b</name><y>2</y><z><w>3</w></z></parameter></parameters></table></data>"
+
+setrules "$(rule deny-w "*" read "/ex:table/ex:parameters/ex:parameter/ex:z/ex:w" deny)"
+
+new "read: deny leaf below container in case"
+gettable "<data><table xmlns=\"urn:example:nacm\"><parameters><parameter><name>a</name><x>1</x><extra xmlns=\"urn:example:aug\">e1</extra><ext xmlns=\"urn:example:aug\"><v>v1</v></ext></parameter><parameter><name>b</name><y>2</y><z/></parameter></parameters></table></data>"
+
+# Write with write-default permit
+setrules "$(rule deny-extra "*" "create update delete" "/ex:table/ex:parameters/ex:parameter/aug:extra" deny)"
+
+new "write: read augmented leaf"
+gettable "<data>$CONFIG</data>"
+
+new "write: deny augmented leaf"
+editparams "<parameter><name>a</name><extra xmlns=\"urn:example:aug\">e2</extra></parameter>" "$DENIED"
+
+new "write: permit augmented container"
+editparams "<parameter><name>a</name><ext xmlns=\"urn:example:aug\"><v>v2</v></ext></parameter>" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+setrules "$(rule deny-aug nacm-aug "create update delete" "" deny)"
+
+new "write: deny augmenting module"
+editparams "<parameter><name>a</name><ext xmlns=\"urn:example:aug\"><v>v2</v></ext></parameter>" "$DENIED"
+
+new "write: permit other module"
+editparams "<parameter><name>a</name><x>2</x></parameter>" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+setrules "$(rule deny-x "*" "create update delete" "/ex:table/ex:parameters/ex:parameter/ex:x" deny)"
+
+new "write: deny leaf in case"
+editparams "<parameter><name>c</name><x>4</x></parameter>" "$DENIED"
+
+new "write: permit other case"
+editparams "<parameter><name>c</name><y>4</y></parameter>" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+setrules "$(rule deny-w "*" "create update delete" "/ex:table/ex:parameters/ex:parameter/ex:z/ex:w" deny)"
+
+new "write: deny leaf below container in case"
+editparams "<parameter><name>b</name><z><w>5</w></z></parameter>" "$DENIED"
+
+new "write: permit leaf in same case"
+editparams "<parameter><name>b</name><y>5</y></parameter>" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "write: running unchanged"
+gettable "<data>$CONFIG</data>"
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
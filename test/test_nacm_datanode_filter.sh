@@ -0,0 +1,214 @@
+#!/usr/bin/env bash
+# Authentication and authorization and IETF NACM
+# NACM data node read rules with read-default permit
+# With read-default permit, denied subtrees are left out while the reply is printed
+# instead of pruned from the tree, see nacm_datanode_read_filter.
+# Check exact replies of:
+# - deny path rule with a key predicate
+# - deny module rule
+# - permit rule under a denied subtree
+# - depth combined with NACM
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+# Common NACM scripts
+. ./nacm.sh
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/nacm-example.yang
+fyang2=$dir/nacm-example2.yang
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_DIR>$dir</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_DIR>/usr/local/lib/$APPNAME/backend</CLICON_BACKEND_DIR>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_NACM_MODE>internal</CLICON_NACM_MODE>
+  <CLICON_NACM_CREDENTIALS>none</CLICON_NACM_CREDENTIALS>
+  <CLICON_NACM_DISABLED_ON_EMPTY>true</CLICON_NACM_DISABLED_ON_EMPTY>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module nacm-example{
+  yang-version 1.1;
+  namespace "urn:example:nacm";
+  prefix ex;
+  import ietf-netconf-acm {
+    prefix nacm;
+  }
+  import nacm-example2 {
+    prefix ex2;
+  }
+  container table{
+    container parameters{
+      list parameter{
+        key name;
+        leaf name{
+          type string;
+        }
+        leaf value{
+          type string;
+        }
+      }
+    }
+  }
+  container other{
+    leaf value{
+      type string;
+    }
+  }
+}
+EOF
+
+cat <<EOF > $fyang2
+module nacm-example2{
+  yang-version 1.1;
+  namespace "urn:example:nacm2";
+  prefix ex2;
+  container other2{
+    leaf value{
+      type string;
+    }
+  }
+}
+EOF
+
+CONFIG="<table xmlns=\"urn:example:nacm\"><parameters><parameter><name>a</name><value>1</value></parameter><parameter><name>b</name><value>2</value></parameter></parameters></table><other xmlns=\"urn:example:nacm\"><value>99</value></other><other2 xmlns=\"urn:example:nacm2\"><value>88</value></other2>"
+
+# Print a read rule
+# @param[in] name    Rule name
+# @param[in] module  Module name
+# @param[in] path    Path or empty for module rule
+# @param[in] action  permit or deny
+function rule()
+{
+    echo -n "<rule><name>$1</name><module-name>$2</module-name><access-operations>read</access-operations>"
+    if [ -n "$3" ]; then
+        echo -n "<path xmlns:ex=\"urn:example:nacm\">$3</path>"
+    fi
+    echo -n "<action>$4</action></rule>"
+}
+
+# Replace rules of limited group as admin and commit
+# @param[in] rules  Rules
+function setrules()
+{
+    new "set limited rules"
+    expecteof_netconf "$clixon_netconf -U andy -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><nacm xmlns=\"urn:ietf:params:xml:ns:yang:ietf-netconf-acm\"><rule-list nc:operation=\"replace\" xmlns:nc=\"$BASENS\"><name>limited-acl</name><group>limited</group>$1</rule-list></nacm></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+    new "commit limited rules"
+    expecteof_netconf "$clixon_netconf -U andy -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+}
+
+# Get-config of running as user with xpath filter
+# @param[in] user    User name
+# @param[in] select  XPath filter
+# @param[in] attr    Attributes of get-config, eg depth
+# @param[in] data    Expected data
+function getconf()
+{
+    expecteof_netconf "$clixon_netconf -U $1 -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config $3><source><running/></source><filter type=\"xpath\" select=\"$2\" xmlns:ex=\"urn:example:nacm\" xmlns:ex2=\"urn:example:nacm2\"/></get-config></rpc>" "" "<rpc-reply $DEFAULTNS>$4</rpc-reply>"
+}
+
+new "test params: -f $cfg"
+
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+new "set nacm and app config"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><nacm xmlns=\"urn:ietf:params:xml:ns:yang:ietf-netconf-acm\"><enable-nacm>true</enable-nacm><read-default>permit</read-default><write-default>deny</write-default><exec-default>permit</exec-default>$NGROUPS$NADMIN</nacm>$CONFIG</config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "commit it"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+ALL="<data><table xmlns=\"urn:example:nacm\"><parameters><parameter><name>a</name><value>1</value></parameter><parameter><name>b</name><value>2</value></parameter></parameters></table></data>"
+
+new "no limited rules: wilma reads table"
+getconf wilma "/ex:table" "" "$ALL"
+
+# Deny path rule with key predicate
+setrules "$(rule deny-a "*" "/ex:table/ex:parameters/ex:parameter[ex:name='a']" deny)"
+
+new "deny parameter a: admin reads table"
+getconf andy "/ex:table" "" "$ALL"
+
+new "deny parameter a: wilma reads table without a"
+getconf wilma "/ex:table" "" "<data><table xmlns=\"urn:example:nacm\"><parameters><parameter><name>b</name><value>2</value></parameter></parameters></table></data>"
+
+new "deny parameter a: wilma reads a"
+getconf wilma "/ex:table/ex:parameters/ex:parameter[ex:name='a']" "" "<data/>"
+
+new "deny parameter a: wilma reads value of b"
+getconf wilma "/ex:table/ex:parameters/ex:parameter[ex:name='b']/ex:value" "" "<data><table xmlns=\"urn:example:nacm\"><parameters><parameter><name>b</name><value>2</value></parameter></parameters></table></data>"
+
+new "deny parameter a: wilma reads table depth 3"
+getconf wilma "/ex:table" "depth=\"3\"" "<data><table xmlns=\"urn:example:nacm\"><parameters><parameter></parameter></parameters></table></data>"
+
+new "deny parameter a: admin reads table depth 3"
+getconf andy "/ex:table" "depth=\"3\"" "<data><table xmlns=\"urn:example:nacm\"><parameters><parameter></parameter><parameter></parameter></parameters></table></data>"
+
+new "deny parameter a: wilma reads table depth 2"
+getconf wilma "/ex:table" "depth=\"2\"" "<data><table xmlns=\"urn:example:nacm\"><parameters></parameters></table></data>"
+
+# Deny module rule
+setrules "$(rule deny-mod2 nacm-example2 "" deny)"
+
+new "deny module: wilma reads other2"
+getconf wilma "/ex2:other2" "" "<data/>"
+
+new "deny module: wilma reads other in other module"
+getconf wilma "/ex:other" "" "<data><other xmlns=\"urn:example:nacm\"><value>99</value></other></data>"
+
+new "deny module: admin reads other2"
+getconf andy "/ex2:other2" "" "<data><other2 xmlns=\"urn:example:nacm2\"><value>88</value></other2></data>"
+
+# Permit rule under a denied subtree: the first rule matching table is deny,
+# parameter b is not read even though a rule permits it
+setrules "$(rule permit-b "*" "/ex:table/ex:parameters/ex:parameter[ex:name='b']" permit)$(rule deny-table "*" "/ex:table" deny)"
+
+new "permit under deny: wilma reads table"
+getconf wilma "/ex:table" "" "<data/>"
+
+new "permit under deny: wilma reads b"
+getconf wilma "/ex:table/ex:parameters/ex:parameter[ex:name='b']" "" "<data/>"
+
+new "permit under deny: wilma reads other"
+getconf wilma "/ex:other" "" "<data><other xmlns=\"urn:example:nacm\"><value>99</value></other></data>"
+
+new "permit under deny: wilma reads table depth 1"
+getconf wilma "/ex:table" "depth=\"1\"" "<data/>"
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
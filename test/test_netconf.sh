@@ -474,6 +474,27 @@ new "netconf xpath mixed types"
 rpc="<rpc $DEFAULTNS><get-config><source><candidate/></source><filter type=\"xpath\" select=\"/if:interfaces[ex*p>@er='x']\" xmlns:if=\"urn:ietf:params:xml:ns:yang:ietf-interfaces\"/></get-config></rpc>"
 expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "$rpc" "" "<rpc-reply $DEFAULTNS><rpc-error><error-type>application</error-type><error-tag>operation-failed</error-tag><error-severity>error</error-severity><error-message>Get candidate datastore: Mixed types not supported, 1 3</error-message></rpc-error></rpc-reply>"
 
+new "netconf edit-config passed through to backend"
+expecteof_netconf "$clixon_netconf -qf $cfg -o CLICON_NETCONF_PASSTHROUGH_MIN=1" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS message-id=\"43\"><edit-config><target><candidate/></target><config><interfaces xmlns=\"urn:ietf:params:xml:ns:yang:ietf-interfaces\"><interface><name>eth/0/9</name><type xmlns:ex=\"urn:example:clixon\">ex:eth</type></interface></interfaces></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS message-id=\"43\"><ok/></rpc-reply>"
+
+new "netconf get-config passed through config"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><candidate/></source><filter type=\"xpath\" select=\"/if:interfaces/if:interface[if:name='eth/0/9']\" xmlns:if=\"urn:ietf:params:xml:ns:yang:ietf-interfaces\"/></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><interfaces xmlns=\"urn:ietf:params:xml:ns:yang:ietf-interfaces\"><interface xmlns:ex=\"urn:example:clixon\"><name>eth/0/9</name><type>ex:eth</type></interface></interfaces></data></rpc-reply>"
+
+new "netconf get-config reply relayed"
+expecteof_netconf "$clixon_netconf -qf $cfg -o CLICON_NETCONF_REPLY_RELAY=true" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS message-id=\"45\"><get-config><source><candidate/></source><filter type=\"xpath\" select=\"/if:interfaces/if:interface[if:name='eth/0/9']\" xmlns:if=\"urn:ietf:params:xml:ns:yang:ietf-interfaces\"/></get-config></rpc>" "" "<rpc-reply $DEFAULTNS message-id=\"45\"><data><interfaces xmlns=\"urn:ietf:params:xml:ns:yang:ietf-interfaces\"><interface xmlns:ex=\"urn:example:clixon\"><name>eth/0/9</name><type>ex:eth</type></interface></interfaces></data></rpc-reply>"
+
+new "netconf get-config reply relayed with EOM framing"
+expecteof "$clixon_netconf -qf $cfg -o CLICON_NETCONF_REPLY_RELAY=true" 0 "$HELLONO11<rpc $DEFAULTNS><get-config><source><candidate/></source><filter type=\"xpath\" select=\"/if:interfaces/if:interface[if:name='eth/0/9']\" xmlns:if=\"urn:ietf:params:xml:ns:yang:ietf-interfaces\"/></get-config></rpc>]]>]]>" "^<rpc-reply $DEFAULTNS><data><interfaces xmlns=\"urn:ietf:params:xml:ns:yang:ietf-interfaces\"><interface xmlns:ex=\"urn:example:clixon\"><name>eth/0/9</name><type>ex:eth</type></interface></interfaces></data></rpc-reply>]]>]]>$"
+
+new "netconf edit-config passed through, error from backend"
+expecteof_netconf "$clixon_netconf -qf $cfg -o CLICON_NETCONF_PASSTHROUGH_MIN=1" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS message-id=\"44\"><edit-config><target><candidate/></target><config><interfaces xmlns=\"urn:ietf:params:xml:ns:yang:ietf-interfaces\"><interface><name>eth/0/9</name><type>ex:eth</type></interface></interfaces></config></edit-config></rpc>" "<rpc-reply $DEFAULTNS message-id=\"44\"><rpc-error>" ""
+
+new "netconf edit-config with test-option not passed through"
+expecteof_netconf "$clixon_netconf -qf $cfg -o CLICON_NETCONF_PASSTHROUGH_MIN=1" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><test-option>test-only</test-option><config><interfaces xmlns=\"urn:ietf:params:xml:ns:yang:ietf-interfaces\"><interface><name>eth/0/8</name><type xmlns:ex=\"urn:example:clixon\">ex:eth</type></interface></interfaces></config></edit-config></rpc>" "<rpc-reply $DEFAULTNS><rpc-error>.*operation-not-supported" ""
+
+new "netconf discard-changes"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><discard-changes/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
 if [ $BE -ne 0 ]; then
     new "Kill backend"
     # Check if premature kill
@@ -42,6 +42,8 @@ cat <<EOF > $cfg
   <CLICON_STREAM_DISCOVERY_RFC5277>true</CLICON_STREAM_DISCOVERY_RFC5277>
   <CLICON_STREAM_PATH>streams</CLICON_STREAM_PATH>
   <CLICON_STREAM_RETENTION>60</CLICON_STREAM_RETENTION>
+  <CLICON_STREAM_REPLAY_MAX>100</CLICON_STREAM_REPLAY_MAX>
+  <CLICON_STREAM_REPLAY_DIR>$dir</CLICON_STREAM_REPLAY_DIR>
   <CLICON_NETCONF_MONITORING>true</CLICON_NETCONF_MONITORING>
 </clixon-config>
 EOF
@@ -127,6 +129,49 @@ expectwait "$clixon_netconf -D $DBG -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTN
 new "netconf EXAMPLE subscription with filter classifier"
 expectwait "$clixon_netconf -D $DBG -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><create-subscription xmlns=\"urn:ietf:params:xml:ns:netmod:notification\"><stream>EXAMPLE</stream><filter type=\"xpath\" select=\"event[event-class='fault']\"/></create-subscription></rpc>" $NCWAIT "<rpc-reply $DEFAULTNS><ok/></rpc-reply>" "<notification xmlns=\"${NOTIFICATION_NS}\"><eventTime>20"
 
+new "netconf EXAMPLE concurrent subscriptions with shared filters"
+pids=""
+for (( i=0; i<6; i++ )); do
+    if [ $((i % 2)) -eq 0 ]; then
+        filter="<filter type=\"xpath\" select=\"event[event-class='fault']\"/>"
+    else
+        filter=""
+    fi
+    sleep $NCWAIT | cat <(echo "$DEFAULTHELLO$(chunked_framing "<rpc $DEFAULTNS><create-subscription xmlns=\"urn:ietf:params:xml:ns:netmod:notification\"><stream>EXAMPLE</stream>$filter</create-subscription></rpc>")") - | $clixon_netconf -qef $cfg > $dir/sub$i.xml &
+    pids="$pids $!"
+done
+wait $pids
+for (( i=0; i<6; i++ )); do
+    n=$(grep -o "<notification xmlns=\"${NOTIFICATION_NS}\"><eventTime>20" $dir/sub$i.xml | wc -l)
+    if [ $n -lt 1 ]; then
+        err1 "Notification in subscription $i" "$(cat $dir/sub$i.xml)"
+    fi
+done
+
+new "netconf EXAMPLE subscriptions indexed by notification filter"
+pids=""
+i=0
+for select in "event" "other" "other/event" "other | event" "*[event-class='fault']"; do
+    sleep $NCWAIT | cat <(echo "$DEFAULTHELLO$(chunked_framing "<rpc $DEFAULTNS><create-subscription xmlns=\"urn:ietf:params:xml:ns:netmod:notification\"><stream>EXAMPLE</stream><filter type=\"xpath\" select=\"$select\"/></create-subscription></rpc>")") - | $clixon_netconf -qef $cfg > $dir/filter$i.xml &
+    pids="$pids $!"
+    i=$((i+1))
+done
+wait $pids
+# Filters 1 and 2 require another notification and should not match
+for (( i=0; i<5; i++ )); do
+    n=$(grep -o "<notification xmlns=\"${NOTIFICATION_NS}\"><eventTime>20" $dir/filter$i.xml | wc -l)
+    if [ $i -eq 1 -o $i -eq 2 ]; then
+        if [ $n -ne 0 ]; then
+            err1 "No notification in filter subscription $i" "$(cat $dir/filter$i.xml)"
+        fi
+    elif [ $n -lt 1 ]; then
+        err1 "Notification in filter subscription $i" "$(cat $dir/filter$i.xml)"
+    fi
+done
+
+new "netconf EXAMPLE subscription with invalid filter"
+expectwait "$clixon_netconf -D $DBG -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><create-subscription xmlns=\"urn:ietf:params:xml:ns:netmod:notification\"><stream>EXAMPLE</stream><filter type=\"xpath\" select=\"event[\"/></create-subscription></rpc>" 0 "<rpc-reply $DEFAULTNS><rpc-error><error-type>application</error-type><error-tag>operation-failed</error-tag>"
+
 new "netconf NONEXIST subscription"
 expectwait "$clixon_netconf -D $DBG -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><create-subscription xmlns=\"urn:ietf:params:xml:ns:netmod:notification\"><stream>NONEXIST</stream></create-subscription></rpc>" $NCWAIT "<rpc-reply $DEFAULTNS><rpc-error><error-type>application</error-type><error-tag>invalid-value</error-tag><error-severity>error</error-severity><error-message>No such stream</error-message></rpc-error></rpc-reply>"
 
@@ -138,6 +183,23 @@ expectwait "$clixon_netconf -D $DBG -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTN
 #sleep 10
 #expectwait "$clixon_netconf -D $DBG -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><create-subscription xmlns=\"urn:ietf:params:xml:ns:netmod:notification\"><stream>EXAMPLE</stream><startTime>$NOW</startTime></create-subscription></rpc>" 10 "^<rpc-reply $DEFAULTNS><ok/></rpc-reply>]]>]]><notification xmlns=\"${NOTIFICATION_NS}\"><eventTime>20"
 
+if [ $BE -ne 0 ]; then
+    new "replay segment file"
+    if [ ! -s $dir/EXAMPLE.replay ]; then
+        err1 "$dir/EXAMPLE.replay"
+    fi
+
+    new "restart backend"
+    stop_backend -f $cfg
+    start_backend -s running -f $cfg -- -n 5
+
+    new "wait backend"
+    wait_backend
+
+    new "netconf EXAMPLE replay of events before restart"
+    expectwait "$clixon_netconf -D $DBG -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><create-subscription xmlns=\"urn:ietf:params:xml:ns:netmod:notification\"><stream>EXAMPLE</stream><startTime>${DATE}T00:00:00Z</startTime></create-subscription></rpc>" 2 "<rpc-reply $DEFAULTNS><ok/></rpc-reply>" "<notification xmlns=\"${NOTIFICATION_NS}\"><eventTime>20"
+fi
+
 if [ $BE -ne 0 ]; then
     new "Kill backend"
     # Check if premature kill
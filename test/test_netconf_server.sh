@@ -0,0 +1,122 @@
+#!/usr/bin/env bash
+# Shared netconf server, see CLICON_NETCONF_SERVER_SOCK
+# A clixon_netconf -S server loads plugins and yang once, and clixon_netconf sessions
+# hand over stdin/stdout to it. If no server runs, sessions run standalone.
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/clixon-example.yang
+sock=$dir/netconf.sock
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>$dir/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_NETCONF_SERVER_SOCK>$sock</CLICON_NETCONF_SERVER_SOCK>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module clixon-example{
+  yang-version 1.1;
+  namespace "urn:example:clixon";
+  prefix ex;
+  container table{
+    list parameter{
+      key name;
+      leaf name{
+        type string;
+      }
+    }
+  }
+}
+EOF
+
+new "test params: -f $cfg"
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+new "netconf without server runs standalone"
+ret=$(echo "$DEFAULTHELLO" | $clixon_netconf -qf $cfg -l e -D netconf 2>&1)
+expectpart "$ret" 0 "No netconf server at $sock" --not-- "handed over"
+
+new "start netconf server"
+$clixon_netconf -qSf $cfg -l e &
+pid=$!
+for (( i=0; i<$DEMLOOP; i++ )); do
+    if [ -S $sock ]; then
+        break
+    fi
+    sleep $DEMSLEEP
+done
+if [ ! -S $sock ]; then
+    err1 "netconf server socket $sock"
+fi
+
+new "netconf session handed over to server"
+ret=$(echo "$DEFAULTHELLO" | $clixon_netconf -qf $cfg -l e -D netconf 2>&1)
+expectpart "$ret" 0 "handed over to netconf server at $sock"
+
+new "netconf edit-config via server"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><table xmlns=\"urn:example:clixon\"><parameter><name>a</name></parameter></table></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "netconf commit via server"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "netconf get-config via server"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><table xmlns=\"urn:example:clixon\"><parameter><name>a</name></parameter></table></data></rpc-reply>"
+
+new "netconf concurrent sessions via server"
+for (( i=0; i<10; i++ )); do
+    echo "$DEFAULTHELLO" | $clixon_netconf -qf $cfg > /dev/null &
+done
+wait $(jobs -p | grep -v "^$pid$")
+
+new "netconf server still running"
+if ! kill -0 $pid 2> /dev/null; then
+    err1 "netconf server $pid running"
+fi
+
+new "stop netconf server"
+kill $pid
+wait $pid
+if [ -S $sock ]; then
+    err1 "netconf server socket $sock removed"
+fi
+
+new "netconf get-config standalone after server stopped"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><table xmlns=\"urn:example:clixon\"><parameter><name>a</name></parameter></table></data></rpc-reply>"
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
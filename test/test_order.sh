@@ -6,6 +6,7 @@
 # No test of ordered-by system is done yet
 # (we may want to sort them alphabetically for better performance).
 # Also: ordered-by-user and "insert" and "key"/"value" attributes
+# Also: reorder of ordered-by user list, only moved entries are in the transaction
 
 # Magic line must be first in script (see README.md)
 s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
@@ -24,6 +25,7 @@ tmp=$dir/tmp.x
 # clixon_netconf="valgrind --leak-check=full --show-leak-kinds=all clixon_netconf"
 
 dbdir=$dir/order
+flog=$dir/backend.log
 
 rm -rf $dbdir
 if [ ! -d $dbdir ]; then
@@ -487,6 +489,50 @@ expectpart "$($clixon_cli -1 -f $cfg show compare xml)" 0 "\-\ *<y0 xmlns=\"urn:
 new "netconf discard"
 expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><discard-changes/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
 
+# Reorder of ordered-by user list: only moved entries are deleted and added in transactions
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    stop_backend -f $cfg
+
+    new "start backend -s running -f $cfg -l f$flog -- -s -t"
+    start_backend -s running -f $cfg -l f$flog -- -s -t
+
+    new "wait backend"
+    wait_backend
+
+    Y=""
+    for k in a b c d e f g h i j; do
+        Y="$Y<y2 xmlns=\"urn:example:order\"><k>$k</k><a>$k</a></y2>"
+    done
+    new "add y2: a b c d e f g h i j"
+    expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config>$Y</config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+    new "netconf commit"
+    expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+    new "move y2 e first"
+    expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><y2 xmlns=\"urn:example:order\" xmlns:yang=\"urn:ietf:params:xml:ns:yang:1\" yang:insert=\"first\"><k>e</k><a>e</a></y2></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+    new "netconf commit"
+    expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+    new "commit deletes and adds e only"
+    expectpart "$(grep "main_commit del:" $flog | tail -1)" 0 "<k>e</k><a>e</a>" --not-- "<k>[abcdfghij]</k>"
+    expectpart "$(grep "main_commit add:" $flog | tail -1)" 0 "<k>e</k><a>e</a>" --not-- "<k>[abcdfghij]</k>"
+
+    new "move y2 j after a"
+    expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><y2 xmlns=\"urn:example:order\" xmlns:yang=\"urn:ietf:params:xml:ns:yang:1\" yang:insert=\"after\" yang:key=\"[k='a']\"><k>j</k><a>j</a></y2></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+    new "netconf commit"
+    expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+    new "commit deletes and adds j only"
+    expectpart "$(grep "main_commit del:" $flog | tail -1)" 0 "<k>j</k><a>j</a>" --not-- "<k>[a-i]</k>"
+    expectpart "$(grep "main_commit add:" $flog | tail -1)" 0 "<k>j</k><a>j</a>" --not-- "<k>[a-i]</k>"
+
+    new "check ordered-by-user: e a j b c d f g h i"
+    expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source><filter type=\"xpath\" select=\"/exo:y2/exo:k\" xmlns:exo=\"urn:example:order\"/></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><y2 xmlns=\"urn:example:order\"><k>e</k></y2><y2 xmlns=\"urn:example:order\"><k>a</k></y2><y2 xmlns=\"urn:example:order\"><k>j</k></y2><y2 xmlns=\"urn:example:order\"><k>b</k></y2><y2 xmlns=\"urn:example:order\"><k>c</k></y2><y2 xmlns=\"urn:example:order\"><k>d</k></y2><y2 xmlns=\"urn:example:order\"><k>f</k></y2><y2 xmlns=\"urn:example:order\"><k>g</k></y2><y2 xmlns=\"urn:example:order\"><k>h</k></y2><y2 xmlns=\"urn:example:order\"><k>i</k></y2></data></rpc-reply>"
+fi
 
 if [ $BE -ne 0 ]; then
     new "Kill backend"
@@ -159,6 +159,30 @@ fi
 new "wait backend"
 wait_backend
 
+# Cursor is the key of the last entry of a page, annotated as next if entries remain
+new "netconf first member page, next cursor annotation"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source><filter type=\"xpath\" select=\"/es:members/es:member\" xmlns:es=\"https://example.com/ns/example-social\"/><list-pagination xmlns=\"urn:ietf:params:xml:ns:yang:ietf-list-pagination-nc\"><limit>1</limit></list-pagination></get-config></rpc>" "<member lp:next=\"alice\" xmlns:lp=\"urn:ietf:params:xml:ns:yang:ietf-list-pagination\"><member-id>alice</member-id>" ""
+
+new "netconf member page after cursor"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source><filter type=\"xpath\" select=\"/es:members/es:member\" xmlns:es=\"https://example.com/ns/example-social\"/><list-pagination xmlns=\"urn:ietf:params:xml:ns:yang:ietf-list-pagination-nc\"><cursor>alice</cursor><limit>1</limit></list-pagination></get-config></rpc>" "<data><members xmlns=\"https://example.com/ns/example-social\"><member><member-id>bob</member-id>" ""
+
+new "netconf ordered-by user leaf-list page after cursor"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source><filter type=\"xpath\" select=\"/es:members/es:member[es:member-id='bob']/es:favorites/es:uint64-numbers\" xmlns:es=\"https://example.com/ns/example-social\"/><list-pagination xmlns=\"urn:ietf:params:xml:ns:yang:ietf-list-pagination-nc\"><cursor>$((perfnr-2))</cursor><limit>10</limit></list-pagination></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><members xmlns=\"https://example.com/ns/example-social\"><member><member-id>bob</member-id><favorites><uint64-numbers>$((perfnr-1))</uint64-numbers></favorites></member></members></data></rpc-reply>"
+
+new "netconf invalid cursor"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source><filter type=\"xpath\" select=\"/es:members/es:member\" xmlns:es=\"https://example.com/ns/example-social\"/><list-pagination xmlns=\"urn:ietf:params:xml:ns:yang:ietf-list-pagination-nc\"><cursor>alice,bob</cursor></list-pagination></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><rpc-error><error-type>application</error-type><error-tag>invalid-value</error-tag><error-severity>error</error-severity><error-message>cursor-not-found</error-message></rpc-error></rpc-reply>"
+
+# Leaf-list has more entries than CLI_SHOW_PAGE_SIZE, shown page by page if defined
+new "cli show xpath of large leaf-list"
+ret=$($clixon_cli -1 -f $cfg show xpath "/members/member[member-id='bob']/favorites/uint64-numbers" https://example.com/ns/example-social)
+expectpart "$ret" 0 "<uint64-numbers>0</uint64-numbers>" "<uint64-numbers>$((perfnr-1))</uint64-numbers>" --not-- "lp:next" "<int8-numbers>"
+
+new "cli show xpath of large leaf-list has all entries"
+nr=$(echo "$ret" | grep -c "<uint64-numbers>")
+if [ $nr -ne $perfnr ]; then
+    err1 "$perfnr entries" "$nr"
+fi
+
 xpath="/es:members/es:member[es:member-id=\'bob\']/es:favorites/es:uint64-numbers"
 new "cli show pagination config using expect"
 sudo="sudo -g ${CLICON_GROUP}"		## cheat
@@ -0,0 +1,182 @@
+#!/usr/bin/env bash
+# Test RFC 5717 partial-lock and partial-unlock of running
+# A session holding a partial lock of a list entry prevents other sessions from changing it,
+# while other sessions may lock and commit changes of disjoint entries
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+# Backend must be started by the test
+if [ $BE -eq 0 ]; then
+    echo "...skipped: must run with backend"
+    rm -rf $dir
+    if [ "$s" = $0 ]; then exit 0; else return 0; fi
+fi
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/clixon-example.yang
+
+PLNS="urn:ietf:params:xml:ns:netconf:partial-lock:1.0"
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>$dir</CLICON_YANG_DIR>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_BACKEND_DIR>/usr/local/lib/$APPNAME/backend</CLICON_BACKEND_DIR>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_YANG_LIBRARY>false</CLICON_YANG_LIBRARY>
+  <CLICON_NETCONF_PARTIAL_LOCK>true</CLICON_NETCONF_PARTIAL_LOCK>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module clixon-example{
+    yang-version 1.1;
+    namespace "urn:example:clixon";
+    prefix ex;
+    container table{
+        list parameter{
+            key name;
+            leaf name{
+                type string;
+            }
+            leaf value{
+                type string;
+            }
+        }
+    }
+}
+EOF
+
+# Partial-lock rpc of list entry $1, or of table if not given
+function plock()
+{
+    if [ -n "$1" ]; then
+        sel="/ex:table/ex:parameter[ex:name='$1']"
+    else
+        sel="/ex:table"
+    fi
+    echo -n "<rpc $DEFAULTNS><partial-lock xmlns=\"$PLNS\"><select xmlns:ex=\"urn:example:clixon\">$sel</select></partial-lock></rpc>"
+}
+
+# Edit-config of candidate, or of datastore $3, setting value of list entry $1 to $2
+function edit()
+{
+    echo -n "<rpc $DEFAULTNS><edit-config><target><${3:-candidate}/></target><config><table xmlns=\"urn:example:clixon\"><parameter><name>$1</name><value>$2</value></parameter></table></config></edit-config></rpc>"
+}
+
+DENIED="<rpc-reply $DEFAULTNS><rpc-error><error-type>protocol</error-type><error-tag>lock-denied</error-tag><error-info><session-id>[0-9]*</session-id>"
+
+new "test params: -f $cfg"
+
+new "kill old backend"
+sudo clixon_backend -zf $cfg
+if [ $? -ne 0 ]; then
+    err
+fi
+new "start backend -s init -f $cfg"
+start_backend -s init -f $cfg
+
+new "wait backend"
+wait_backend
+
+new "partial-lock capability"
+expecteof "$clixon_netconf -f $cfg" 0 "$HELLONO11" "<capability>urn:ietf:params:netconf:capability:partial-lock:1.0</capability>" "^$"
+
+new "add entries a and b"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><table xmlns=\"urn:example:clixon\"><parameter><name>a</name><value>0</value></parameter><parameter><name>b</name><value>0</value></parameter></table></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "commit"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "partial-lock a"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "$(plock a)" "<rpc-reply $DEFAULTNS><lock-id xmlns=\"$PLNS\">[0-9]*</lock-id><locked-node xmlns=\"$PLNS\" xmlns:ex=\"urn:example:clixon\">/ex:table/ex:parameter\[ex:name='a'\]</locked-node></rpc-reply>" ""
+
+new "partial-lock no matches"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "$(plock x)" "<rpc-reply $DEFAULTNS><rpc-error><error-type>application</error-type><error-tag>invalid-value</error-tag><error-severity>error</error-severity><error-message>no-matches</error-message></rpc-error></rpc-reply>" ""
+
+new "partial-unlock of unknown lock"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><partial-unlock xmlns=\"$PLNS\"><lock-id>4711</lock-id></partial-unlock></rpc>" "<rpc-reply $DEFAULTNS><rpc-error><error-type>protocol</error-type><error-tag>lock-denied</error-tag>" ""
+
+new "asynchronous partial-lock a"
+sleep 60 | cat <(echo "$HELLONO11$(plock a)]]>]]>") -| $clixon_netconf -qf $cfg >> /dev/null &
+sleep 1
+PIDS=($(jobs -l % | cut -c 6- | awk '{print $1}'))
+
+new "partial-lock a is denied"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "$(plock a)" "$DENIED" ""
+
+new "partial-lock of ancestor table is denied"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "$(plock)" "$DENIED" ""
+
+new "partial-lock b"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "$(plock b)" "<rpc-reply $DEFAULTNS><lock-id xmlns=\"$PLNS\">[0-9]*</lock-id>" ""
+
+new "lock running is denied"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><lock><target><running/></target></lock></rpc>" "$DENIED<db>running</db></error-info>" ""
+
+new "edit a"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "$(edit a 1)" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "commit of a is denied"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "$DENIED" ""
+
+new "discard-changes"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><discard-changes/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "edit b"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "$(edit b 1)" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "commit of disjoint b"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "edit-config of running a is denied"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "$(edit a 2 running)" "$DENIED" ""
+
+new "edit-config of running disjoint b"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "$(edit b 2 running)" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "edit a"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "$(edit a 3)" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "copy-config of a to running is denied"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><copy-config><source><candidate/></source><target><running/></target></copy-config></rpc>" "$DENIED" ""
+
+new "discard-changes"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><discard-changes/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "running a not changed"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><table xmlns=\"urn:example:clixon\"><parameter><name>a</name><value>0</value></parameter><parameter><name>b</name><value>2</value></parameter></table></data></rpc-reply>"
+
+new "soft kill ${PIDS[0]}"
+kill ${PIDS[0]}                   # kill the while loop above to close STDIN on 1st
+sleep 1
+
+new "edit a"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "$(edit a 1)" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "commit of a after session end"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "get-config"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><table xmlns=\"urn:example:clixon\"><parameter><name>a</name><value>1</value></parameter><parameter><name>b</name><value>2</value></parameter></table></data></rpc-reply>"
+
+new "Kill backend"
+# Check if premature kill
+pid=$(pgrep -u root -f clixon_backend)
+if [ -z "$pid" ]; then
+    err "backend already dead"
+fi
+# kill backend
+stop_backend -f $cfg
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -126,6 +126,12 @@ expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS>
 new "netconf show info xpath + nsc"
 expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><config-path-info $LIBNS><xpath>/qx:table/qx:parameter[qx:name='a']/w:extra</xpath><namespace-context><namespace><prefix>qx</prefix><ns>urn:example:clixon</ns></namespace><namespace><prefix>w</prefix><ns>urn:example:extra</ns></namespace></namespace-context></config-path-info></rpc>" "$RET"
 
+new "netconf show info api-path other key, same shape"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><config-path-info $LIBNS><api-path>/example:table/parameter=b/extra:extra</api-path></config-path-info></rpc>" "<api-path xmlns=\"http://clicon.org/lib\">/example:table/parameter=b/extra:extra</api-path>"
+
+new "netconf stats api-path cache hit"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><stats $LIBNS/></rpc>" "<cache><name>api-path</name><entries>[1-9][0-9]*</entries><hits>[1-9][0-9]*</hits><misses>[0-9]*</misses></cache></caches>"
+
 if [ $BE -ne 0 ]; then
     new "Kill backend"
     # Check if premature kill
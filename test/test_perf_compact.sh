@@ -0,0 +1,114 @@
+#!/usr/bin/env bash
+# Test: compact XML printing performance, see XML2CBUF_COMPACT
+# Backend replies on the internal socket, and datastores that are not pretty-printed, use
+# the compact printer. A large config is committed, which writes the running datastore,
+# and read back with get-config.
+# Compare with the general printer of clixon_xml2cbuf1 by undefining XML2CBUF_COMPACT
+# in include/clixon_custom.h and running again.
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+# Number of list entries in config
+: ${perfnr:=20000}
+
+# Number of get-config requests
+: ${perfreq:=10}
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/clixon-example.yang
+fconfig=$dir/large.xml
+fget=$dir/get.xml
+
+cat <<EOF > $fyang
+module clixon-example{
+  yang-version 1.1;
+  namespace "urn:example:clixon";
+  prefix ex;
+  container x {
+    list y {
+      key "a";
+      leaf a {
+        type int32;
+      }
+      leaf b {
+        type string;
+      }
+      container c {
+        presence "empty";
+      }
+    }
+  }
+}
+EOF
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>$dir/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_XMLDB_PRETTY>false</CLICON_XMLDB_PRETTY>
+</clixon-config>
+EOF
+
+new "test params: -f $cfg"
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+new "generate config with $perfnr list entries"
+rpc="<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><x xmlns=\"urn:example:clixon\">"
+for (( i=0; i<$perfnr; i++ )); do
+    rpc+="<y><a>$i</a><b>value $i</b><c/></y>"
+done
+rpc+="</x></config></edit-config></rpc>"
+echo -n "$DEFAULTHELLO" > $fconfig
+echo "$(chunked_framing "$rpc")" >> $fconfig
+
+new "netconf edit-config large config"
+expecteof_file "time -p $clixon_netconf -qef $cfg" 0 "$fconfig" "^<rpc-reply $DEFAULTNS><ok/></rpc-reply>$" 2>&1 | awk '/real/ {print $2}'
+
+new "netconf commit large config, write running"
+expecteof_netconf "time -p $clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>" 2>&1 | awk '/real/ {print $2}'
+
+new "netconf get-config large config $perfreq times"
+echo -n "$DEFAULTHELLO" > $fget
+for (( i=0; i<$perfreq; i++ )); do
+    echo "$(chunked_framing "<rpc $DEFAULTNS><get-config><source><running/></source></get-config></rpc>")" >> $fget
+done
+{ time -p $clixon_netconf -qef $cfg < $fget > /dev/null; } 2>&1 | awk '/real/ {print $2}'
+
+new "netconf get-config compact reply"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source><filter type=\"xpath\" select=\"/ex:x/ex:y[ex:a=1]\" xmlns:ex=\"urn:example:clixon\"/></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><x xmlns=\"urn:example:clixon\"><y><a>1</a><b>value 1</b><c/></y></x></data></rpc-reply>"
+
+new "check compact running datastore"
+expectpart "$(sudo cat $dir/running_db)" 0 "<y><a>1</a><b>value 1</b><c/></y><y><a>2</a>"
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -0,0 +1,353 @@
+#!/usr/bin/env bash
+# Algorithmic complexity regression tests with time budgets
+# Pathological inputs of the kind found by complexity fuzzing, see fuzz/complexity:
+# - Deeply nested XML and elements with many attributes
+# - XPaths with nested predicates, deep nesting and long boolean chains
+# - Long ordered-by user insert sequences
+# - Long api-paths in RESTCONF
+# Also runs inputs found by fuzzing in fuzz/complexity/hits/<target>
+# Each input must complete within a time budget in ms, scaled by budgetx, eg:
+#   budgetx=10 ./test_perf_complexity.sh   # Slow machine or valgrind
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+if [ -z "${EPOCHREALTIME:-}" ]; then
+    echo "...skipped: bash 5 EPOCHREALTIME needed for time budgets"
+    rm -rf $dir
+    if [ "$s" = $0 ]; then exit 0; else return 0; fi
+fi
+
+: ${clixon_util_xml:="clixon_util_xml"}
+: ${clixon_util_xpath:=clixon_util_xpath}
+
+# Scale of all time budgets
+: ${budgetx:=1}
+
+# Time budget in ms of each input found by fuzzing
+: ${hitbudget:=2000}
+
+# Dir of inputs found by fuzzing
+: ${hitdir:=fuzz/complexity/hits}
+
+# Depth of nested XML
+: ${depth:=10000}
+
+# Number of ordered-by user inserts
+: ${inserts:=2000}
+
+# Length in chars of RESTCONF api-path key
+: ${keylen:=8000}
+
+# Depth of nested containers of list in commit benchmark
+: ${deepnr:=40}
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/complexity.yang
+fin=$dir/in
+xml=$dir/nested.xml
+
+# Print nested containers d0/d1/.. of depth $deepnr with a list e, not in fuzz targets
+function deep_yang()
+{
+    local i
+
+    for (( i=0; i<$deepnr; i++ )); do echo "container d$i{"; done
+    echo "list e{ key k; leaf k{ type string; } leaf v{ type string; } }"
+    for (( i=0; i<$deepnr; i++ )); do echo "}"; done
+}
+
+# Same as in fuzz/complexity/targets.sh, except deep_yang
+cat <<EOF > $fyang
+module complexity{
+    yang-version 1.1;
+    namespace "urn:example:complexity";
+    prefix cx;
+    container c{
+        list u{
+            ordered-by user;
+            key k;
+            leaf k{
+                type string;
+            }
+            leaf v{
+                type string;
+            }
+        }
+        leaf-list l{
+            ordered-by user;
+            type string;
+        }
+        list s{
+            key "k1 k2";
+            leaf k1{
+                type string;
+            }
+            leaf k2{
+                type string;
+            }
+            container c{
+                list s{
+                    key k;
+                    leaf k{
+                        type string;
+                    }
+                }
+            }
+        }
+    }
+    $(deep_yang)
+}
+EOF
+
+# Define default restconfig config: RESTCONFIG
+RESTCONFIG=$(restconf_config none false)
+if [ $? -ne 0 ]; then
+    err1 "Error when generating certs"
+fi
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_FEATURE>clixon-restconf:allow-auth-none</CLICON_FEATURE>
+  <CLICON_YANG_DIR>$dir</CLICON_YANG_DIR>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_NETCONF_HELLO_OPTIONAL>true</CLICON_NETCONF_HELLO_OPTIONAL>
+  $RESTCONFIG
+</clixon-config>
+EOF
+
+# Run a command and check that it completes within a time budget
+# The exit value is not checked, except that the command must not crash
+# @param[in] budget  Time budget in ms, scaled by budgetx
+# @param[in] cmd     Command
+# @param[in] input   File piped to stdin
+function expectbudget()
+{
+    budget=$(( $1 * budgetx ))
+    cmd=$2
+    input=$3
+
+    t0=${EPOCHREALTIME/./}
+    $cmd < $input > /dev/null 2>&1
+    r=$?
+    t1=${EPOCHREALTIME/./}
+    ms=$(( (t1 - t0) / 1000 ))
+    echo "$ms ms (budget $budget ms)"
+    if [ $r -gt 128 ]; then
+        err1 "no crash" "signal $(( r - 128 ))"
+    fi
+    if [ $ms -gt $budget ]; then
+        err1 "less than $budget ms" "$ms ms"
+    fi
+}
+
+# Print nested tree of <a> elements, as in fuzz/complexity/targets.sh
+# @param[in] d       Depth
+# @param[in] fanout  Children of each element
+function nested_xml()
+{
+    local d=$1
+    local fanout=$2
+    local i
+
+    if [ $d -eq 0 ]; then
+        echo -n "<b>$RANDOM</b>"
+        return
+    fi
+    echo -n "<a>"
+    for (( i=0; i<$fanout; i++ )); do
+        nested_xml $(( d - 1 )) $fanout
+    done
+    echo -n "</a>"
+}
+
+new "test params: -f $cfg"
+
+new "xml nested depth $depth"
+for (( i=0; i<$depth; i++ )); do echo -n "<a>"; done > $fin
+for (( i=0; i<$depth; i++ )); do echo -n "</a>"; done >> $fin
+expectbudget 2000 "$clixon_util_xml" $fin
+
+new "xml element with $depth attributes"
+{ echo -n "<a"; for (( i=0; i<$depth; i++ )); do echo -n " x$i=\"$i\""; done; echo -n "/>"; } > $fin
+expectbudget 2000 "$clixon_util_xml" $fin
+
+new "xml element with $depth namespace declarations"
+{ echo -n "<a"; for (( i=0; i<$depth; i++ )); do echo -n " xmlns:p$i=\"urn:$i\""; done; echo -n "><p0:b/></a>"; } > $fin
+expectbudget 2000 "$clixon_util_xml" $fin
+
+nested_xml 8 3 > $xml
+
+new "xpath chained descendants"
+echo "//a//a//a//a//b" > $fin
+expectbudget 3000 "$clixon_util_xpath -f $xml" $fin
+
+new "xpath nested predicates"
+echo "count(//a[.//a[.//a[.//b > 30000]]])" > $fin
+expectbudget 3000 "$clixon_util_xpath -f $xml" $fin
+
+new "xpath parent and child steps"
+{ echo -n "/a"; for (( i=0; i<200; i++ )); do echo -n "/a/.."; done; echo "//b"; } > $fin
+expectbudget 2000 "$clixon_util_xpath -f $xml" $fin
+
+new "xpath nested parentheses"
+{ for (( i=0; i<1000; i++ )); do echo -n "("; done; echo -n "//b"; for (( i=0; i<1000; i++ )); do echo -n ")"; done; echo; } > $fin
+expectbudget 2000 "$clixon_util_xpath -f $xml" $fin
+
+new "xpath long or chain"
+{ echo -n "//b=0"; for (( i=1; i<200; i++ )); do echo -n " or //b=$i"; done; echo; } > $fin
+expectbudget 3000 "$clixon_util_xpath -f $xml" $fin
+
+new "xpath node-set comparison"
+echo "//b != //b and //b = //b" > $fin
+expectbudget 3000 "$clixon_util_xpath -f $xml" $fin
+
+if [ -d $hitdir/xml ]; then
+    for f in $hitdir/xml/*; do
+        new "xml hit $(basename $f)"
+        expectbudget $hitbudget "$clixon_util_xml" $f
+    done
+fi
+
+if [ -d $hitdir/xpath ]; then
+    nested_xml 8 3 > $xml # As fuzz/complexity/targets.sh
+    for f in $hitdir/xpath/*; do
+        new "xpath hit $(basename $f)"
+        expectbudget $hitbudget "$clixon_util_xpath -f $xml" $f
+    done
+fi
+
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+new "ordered-by user: $inserts list inserts first"
+rpc=$(
+    echo -n "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><c xmlns=\"urn:example:complexity\" xmlns:yang=\"urn:ietf:params:xml:ns:yang:1\">"
+    for (( i=0; i<$inserts; i++ )); do
+        echo -n "<u yang:insert=\"first\"><k>u$i</k></u>"
+    done
+    echo -n "</c></config></edit-config></rpc>"
+)
+echo -n "$DEFAULTHELLO$(chunked_framing "$rpc")" > $fin
+expectbudget 5000 "$clixon_netconf -qf $cfg" $fin
+
+new "ordered-by user: $inserts leaf-list inserts after previous"
+rpc=$(
+    echo -n "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><c xmlns=\"urn:example:complexity\" xmlns:yang=\"urn:ietf:params:xml:ns:yang:1\"><l>l0</l>"
+    for (( i=1; i<$inserts; i++ )); do
+        echo -n "<l yang:insert=\"after\" yang:value=\"l$(( i - 1 ))\">l$i</l>"
+    done
+    echo -n "</c></config></edit-config></rpc>"
+)
+echo -n "$DEFAULTHELLO$(chunked_framing "$rpc")" > $fin
+expectbudget 5000 "$clixon_netconf -qf $cfg" $fin
+
+new "ordered-by user: $inserts list inserts before first"
+rpc=$(
+    echo -n "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><c xmlns=\"urn:example:complexity\" xmlns:yang=\"urn:ietf:params:xml:ns:yang:1\">"
+    for (( i=0; i<$inserts; i++ )); do
+        echo -n "<u yang:insert=\"before\" yang:key=\"[cx:k='u0']\" xmlns:cx=\"urn:example:complexity\"><k>v$i</k></u>"
+    done
+    echo -n "</c></config></edit-config></rpc>"
+)
+echo -n "$DEFAULTHELLO$(chunked_framing "$rpc")" > $fin
+expectbudget 5000 "$clixon_netconf -qf $cfg" $fin
+
+new "ordered-by user: commit"
+echo -n "$DEFAULTHELLO$(chunked_framing "<rpc $DEFAULTNS><commit/></rpc>")" > $fin
+expectbudget 5000 "$clixon_netconf -qf $cfg" $fin
+
+new "ordered-by user: check first entries"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source><filter type=\"xpath\" select=\"/cx:c/cx:u[1]\" xmlns:cx=\"urn:example:complexity\"/></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><c xmlns=\"urn:example:complexity\"><u><k>u$(( inserts - 1 ))</k></u></c></data></rpc-reply>"
+
+# Commit of many new and changed nodes at depth $deepnr. Flags of changed nodes are checked
+# in diff and commit, which must not walk up the tree for each node.
+dopen=$(for (( i=0; i<$deepnr; i++ )); do echo -n "<d$i>"; done)
+dclose=$(for (( i=$deepnr-1; i>=0; i-- )); do echo -n "</d$i>"; done)
+for v in a b; do
+    new "deep commit: $inserts entries at depth $deepnr, value $v"
+    rpc=$(
+        echo -n "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config>"
+        echo -n "<d0 xmlns=\"urn:example:complexity\">${dopen#<d0>}"
+        for (( i=0; i<$inserts; i++ )); do
+            echo -n "<e><k>e$i</k><v>$v$i</v></e>"
+        done
+        echo -n "$dclose</config></edit-config></rpc>"
+    )
+    echo -n "$DEFAULTHELLO$(chunked_framing "$rpc")" > $fin
+    expectbudget 5000 "$clixon_netconf -qf $cfg" $fin
+
+    new "deep commit: commit value $v"
+    echo -n "$DEFAULTHELLO$(chunked_framing "<rpc $DEFAULTNS><commit/></rpc>")" > $fin
+    expectbudget 5000 "$clixon_netconf -qf $cfg" $fin
+done
+
+new "deep commit: check last entry"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source><filter type=\"xpath\" select=\"//cx:e[cx:k='e$(( inserts - 1 ))']/cx:v\" xmlns:cx=\"urn:example:complexity\"/></get-config></rpc>" "<v>b$(( inserts - 1 ))</v>" ""
+
+if [ -d $hitdir/netconf ]; then
+    for f in $hitdir/netconf/*; do
+        new "netconf hit $(basename $f)"
+        expectbudget $hitbudget "$clixon_netconf -qf $cfg" $f
+        new "netconf discard-changes"
+        expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><discard-changes/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+    done
+fi
+
+if [ $RC -ne 0 ]; then
+    new "kill old restconf daemon"
+    stop_restconf_pre
+
+    new "start restconf daemon"
+    start_restconf -f $cfg
+
+    new "wait restconf"
+    wait_restconf
+
+    key=$(for (( i=0; i<$keylen; i++ )); do echo -n "%2C"; done)
+    new "restconf api-path with $keylen escaped chars"
+    expectbudget 2000 "curl $CURLOPTS -o /dev/null -X GET $RCPROTO://localhost/restconf/data/complexity:c/s=$key,b/c/s=x" /dev/null
+
+    path=$(for (( i=0; i<$keylen; i++ )); do echo -n "/u=a"; done)
+    new "restconf api-path with $keylen segments"
+    expectbudget 2000 "curl $CURLOPTS -o /dev/null -X GET $RCPROTO://localhost/restconf/data/complexity:c$path" /dev/null
+
+    new "restconf still alive"
+    expectpart "$(curl $CURLOPTS -X GET $RCPROTO://localhost/restconf/data/complexity:c/u=v0)" 0 "HTTP/$HVER 200"
+
+    new "Kill restconf daemon"
+    stop_restconf
+fi
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
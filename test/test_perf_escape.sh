@@ -0,0 +1,43 @@
+#!/usr/bin/env bash
+# Test: XML and JSON escaping performance
+# Config text with long descriptions where a few characters need escaping, is parsed and
+# printed as XML and as JSON. Most of the time is spent in printing and escaping the text.
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+: ${clixon_util_xml:="clixon_util_xml"}
+
+# Number of list entries in file
+: ${perfnr:=20000}
+
+fxml=$dir/escape.xml
+
+new "generate file $fxml with $perfnr entries"
+echo -n "<interfaces>" > $fxml
+for (( i=0; i<$perfnr; i++ )); do
+    echo "<interface><name>eth$i</name><description>Uplink $i to core router in rack 12, connected via patch panel B port 7 &amp; monitored by NMS &lt;primary&gt;</description><alias>link \"$i\" 'a'</alias></interface>" >> $fxml
+done
+echo "</interfaces>" >> $fxml
+
+new "xml print with escaping"
+expecteof_file "time -p $clixon_util_xml -o" 0 "$fxml" 2>&1 | awk '/real/ {print $2}'
+
+new "json print with escaping"
+expecteof_file "time -p $clixon_util_xml -oj" 0 "$fxml" 2>&1 | awk '/real/ {print $2}'
+
+new "check xml escaping"
+ret=$(echo "<a>x &amp; &lt;y&gt; \"z\"</a>" | $clixon_util_xml -o)
+if [ "$ret" != "<a>x &amp; &lt;y&gt; \"z\"</a>" ]; then
+    err "<a>x &amp; &lt;y&gt; \"z\"</a>" "$ret"
+fi
+
+new "check json escaping"
+ret=$(echo "<a>x &amp; &lt;y&gt; \"z\"</a>" | $clixon_util_xml -oj)
+if [ "$ret" != '{"a":"x & <y> \"z\""}' ]; then
+    err '{"a":"x & <y> \"z\""}' "$ret"
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -0,0 +1,133 @@
+#!/usr/bin/env bash
+# Hash table microbenchmark, see clixon_hash.c
+# Compile and run a program that adds, looks up and deletes <perfnr> similar string keys
+# (eth0, eth1,...) and pointer keys, and checks the result
+# If hash_perf_max is set (usec), a phase taking longer than that is an error
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+cfile=$dir/hash-bench.c
+app=$dir/hash-bench
+
+# Number of keys
+: ${perfnr:=100000}
+
+# Max usec of any phase, unset: no regression check
+: ${hash_perf_max:=}
+
+cat <<EOF > $cfile
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <sys/time.h>
+
+#include <clixon/clixon_hash.h>
+
+static struct timeval t0;
+
+static void
+phase(const char *name)
+{
+    struct timeval t;
+
+    gettimeofday(&t, NULL);
+    if (name){
+        timersub(&t, &t0, &t);
+        printf("%s usec:%lu\n", name, (unsigned long)(t.tv_sec*1000000 + t.tv_usec));
+    }
+    gettimeofday(&t0, NULL);
+}
+
+int
+main(int    argc,
+     char **argv)
+{
+    clicon_hash_t *hash;
+    clicon_hash_t *hptr;
+    char           key[32];
+    char         **keys = NULL;
+    size_t         nkeys;
+    int           *vec;
+    int           *v;
+    int            n;
+    int            i;
+
+    n = atoi(argv[1]);
+    if ((hash = clicon_hash_init()) == NULL || (hptr = clicon_hash_init()) == NULL)
+        return 1;
+    if ((vec = calloc(n, sizeof(int))) == NULL)
+        return 1;
+    phase(NULL);
+    for (i=0; i<n; i++){
+        snprintf(key, sizeof(key), "eth%d", i);
+        if (clicon_hash_add(hash, key, &i, sizeof(i)) == NULL)
+            return 1;
+    }
+    phase("add");
+    for (i=0; i<n; i++){
+        snprintf(key, sizeof(key), "eth%d", i);
+        if ((v = clicon_hash_value(hash, key, NULL)) == NULL || *v != i)
+            return 1;
+    }
+    phase("lookup");
+    for (i=0; i<n; i+=2){
+        snprintf(key, sizeof(key), "eth%d", i);
+        if (clicon_hash_del(hash, key) < 0)
+            return 1;
+    }
+    phase("del");
+    for (i=0; i<n; i++){
+        snprintf(key, sizeof(key), "eth%d", i);
+        if ((clicon_hash_value(hash, key, NULL) == NULL) != (i%2 == 0))
+            return 1;
+    }
+    if (clicon_hash_keys(hash, &keys, &nkeys) < 0 || nkeys != n/2)
+        return 1;
+    phase("lookup-after-del");
+    for (i=0; i<n; i++)
+        if (clicon_hash_add_ptr(hptr, &vec[i], &vec[i]) == NULL)
+            return 1;
+    for (i=0; i<n; i++)
+        if (clicon_hash_ptr_value(hptr, &vec[i]) != &vec[i])
+            return 1;
+    phase("ptr");
+    if (keys)
+        free(keys);
+    clicon_hash_free(hash);
+    clicon_hash_free(hptr);
+    free(vec);
+    printf("ok\n");
+    return 0;
+}
+EOF
+
+new "compile $cfile -> $app"
+if [ "$LINKAGE" = static ]; then
+    COMPILE="$CC ${CFLAGS} -I/usr/local/include $cfile -o $app /usr/local/lib/libclixon${LIBSTATIC_SUFFIX} ${LIBS}"
+else
+    COMPILE="$CC ${CFLAGS} -I/usr/local/include $cfile -o $app -L /usr/local/lib -lclixon"
+fi
+echo "COMPILE:$COMPILE"
+expectpart "$($COMPILE)" 0 ""
+
+new "run $app $perfnr"
+ret=$($app $perfnr)
+if [ $? -ne 0 ]; then
+    err "ok" "$ret"
+fi
+echo "$ret"
+expectpart "$ret" 0 "^ok$"
+
+if [ -n "$hash_perf_max" ]; then
+    for usec in $(echo "$ret" | sed -n 's/.* usec:\([0-9]*\)$/\1/p'); do
+        if [ $usec -gt $hash_perf_max ]; then
+            err "usec <= $hash_perf_max" "$ret"
+        fi
+    done
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
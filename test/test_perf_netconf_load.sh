@@ -0,0 +1,292 @@
+#!/usr/bin/env bash
+# Load benchmark of NETCONF with concurrent sessions
+# Concurrent sessions run a mix of get, get-config, edit-config and commit RPCs with
+# chunked framing, over the internal socket using clixon_netconf, and over SSH if sshcmd
+# is set. Each session sends an RPC when the reply of the previous has been received.
+# Throughput and latency percentiles are reported for each RPC and transport, for each
+# number of sessions from step to to. The results may be plotted with gnuplot.
+# SSH needs a netconf subsystem running clixon_netconf with this config, see the config
+# file of the test in $dir
+# Examples:
+#   loadreqs=200 step=5 to=20 ./test_perf_netconf_load.sh
+#   sshcmd="ssh -s localhost netconf" plot=true term=png resdir=/tmp/plots ./test_perf_netconf_load.sh
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+if [ -z "${EPOCHREALTIME:-}" ]; then
+    echo "...skipped: bash 5 EPOCHREALTIME needed for latency"
+    rm -rf $dir
+    if [ "$s" = $0 ]; then exit 0; else return 0; fi
+fi
+
+# Number of list entries in initial config
+: ${perfnr:=1000}
+
+# Number of RPCs per session
+: ${loadreqs:=100}
+
+# RPCs of each session in round-robin order
+: ${loadmix:="get get-config edit-config commit"}
+
+# Number of concurrent sessions, from step to to in steps
+: ${step:=5}
+: ${to:=10}
+
+# Command of NETCONF over SSH, eg "ssh -s localhost netconf", empty to skip
+: ${sshcmd:=}
+
+# Plot results with gnuplot
+: ${plot:=false}
+: ${term:=x11} # x11 interactive, alt: png
+: ${resdir:=$dir} # Result dir (both data and gnuplot)
+
+APPNAME=example
+
+cfg=$dir/load-conf.xml
+fyang=$dir/scaling.yang
+fdataxml=$dir/large.xml
+arch=$(arch)
+
+cat <<EOF > $fyang
+module scaling{
+   yang-version 1.1;
+   namespace "urn:example:clixon";
+   prefix ex;
+   container x {
+    list y {
+      key "a";
+      leaf a {
+        type int32;
+      }
+      leaf b {
+        type int32;
+      }
+    }
+  }
+}
+EOF
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>$dir</CLICON_YANG_DIR>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_XMLDB_PRETTY>false</CLICON_XMLDB_PRETTY>
+  <CLICON_LOG_STRING_LIMIT>128</CLICON_LOG_STRING_LIMIT>
+</clixon-config>
+EOF
+
+# Transports: sock is clixon_netconf on the internal socket, ssh is sshcmd
+transports="sock"
+if [ -n "$sshcmd" ]; then
+    transports="$transports ssh"
+fi
+
+# Make one RPC of the mix with a random list entry
+# @param[in] op  get, get-config, edit-config or commit
+function load_rpc()
+{
+    op=$1
+    rnd=$(( RANDOM % $perfnr ))
+    case $op in
+        get)
+            echo "<rpc $DEFAULTNS><get><filter type=\"xpath\" select=\"/ex:x/ex:y[ex:a=$rnd]\" xmlns:ex=\"urn:example:clixon\"/></get></rpc>"
+            ;;
+        get-config)
+            echo "<rpc $DEFAULTNS><get-config><source><running/></source><filter type=\"xpath\" select=\"/ex:x/ex:y[ex:a=$rnd]\" xmlns:ex=\"urn:example:clixon\"/></get-config></rpc>"
+            ;;
+        edit-config)
+            echo "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><x xmlns=\"urn:example:clixon\"><y><a>$rnd</a><b>$RANDOM</b></y></x></config></edit-config></rpc>"
+            ;;
+        commit)
+            echo "<rpc $DEFAULTNS><commit/></rpc>"
+            ;;
+    esac
+}
+
+# Run one NETCONF session, send an RPC when the reply of the previous is received
+# Log file columns: start time (us), rpc, latency (us), 1 if ok else 0
+# @param[in] transport  sock or ssh
+# @param[in] log        Log file
+function load_session()
+{
+    transport=$1
+    log=$2
+
+    if [ $transport = ssh ]; then
+        coproc NC { $sshcmd 2> /dev/null; }
+    else
+        coproc NC { $clixon_netconf -qf $cfg 2> /dev/null; }
+    fi
+    echo "$DEFAULTHELLO" >&${NC[1]}
+    if [ $transport = ssh ]; then # Skip server hello
+        while read -r -u ${NC[0]} line; do
+            case "$line" in
+                *"]]>]]>"*) break;;
+            esac
+        done
+    fi
+    ops=($loadmix)
+    for (( i=0; i<$loadreqs; i++ )); do
+        op=${ops[$(( i % ${#ops[@]} ))]}
+        rpc=$(chunked_framing "$(load_rpc $op)")
+        t0=${EPOCHREALTIME/./}
+        echo "$rpc" >&${NC[1]}
+        ok=1
+        while read -r -u ${NC[0]} line; do
+            case "$line" in
+                "##") break;;
+                *"<rpc-error>"*) ok=0;;
+            esac
+        done
+        t1=${EPOCHREALTIME/./}
+        echo "$t0 $op $(( t1 - t0 )) $ok" >> $log
+    done
+    exec {NC[1]}>&-
+    wait $NC_PID 2> /dev/null
+}
+
+# Print number of RPCs, throughput and latency percentiles in ms of log files
+# Also append "sessions rpc/s p50 p90 p99" to a result file if given
+# @param[in] name     Label
+# @param[in] elapsed  Elapsed time in us
+# @param[in] res      Result file, or empty
+# @param[in] sessions Number of sessions
+# @param[in] logs     Log files
+function load_report()
+{
+    name=$1
+    elapsed=$2
+    res=$3
+    sessions=$4
+    shift 4
+    cat $@ | sort -n -k3 | awk -v name="$name" -v t=$elapsed -v res="$res" -v n=$sessions '
+function pct(p,  i) { i = int(p*NR); if (i < p*NR) i++; if (i < 1) i = 1; return lat[i]/1000 }
+{ lat[NR] = $3; if ($4 != 1) fail++ }
+END {
+    if (NR == 0) { printf "%-20s no rpcs\n", name; exit }
+    printf "%-20s %8d rpc %9.1f rpc/s  p50 %7.2f p90 %7.2f p99 %7.2f max %7.2f ms  %d failed\n",
+        name, NR, NR*1000000/t, pct(0.50), pct(0.90), pct(0.99), lat[NR]/1000, fail
+    if (res != "")
+        printf "%d %.1f %.2f %.2f %.2f\n", n, NR*1000000/t, pct(0.50), pct(0.90), pct(0.99) >> res
+}'
+}
+
+new "test params: -f $cfg"
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+new "generate config with $perfnr list entries"
+echo -n "<x xmlns=\"urn:example:clixon\">" > $fdataxml
+for (( i=0; i<$perfnr; i++ )); do
+    echo -n "<y><a>$i</a><b>$i</b></y>" >> $fdataxml
+done
+echo -n "</x>" >> $fdataxml
+
+new "netconf edit-config initial config"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config>$(cat $fdataxml)</config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "netconf commit initial config"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+if [ ! -d $resdir ]; then
+    mkdir $resdir
+fi
+for transport in $transports; do
+    rm -f $resdir/netconf-load-$transport-$arch
+    for op in $loadmix; do
+        rm -f $resdir/netconf-load-$transport-$op-$arch
+    done
+    for (( n=$step; n<=$to; n+=$step )); do
+        new "netconf load $transport: $n sessions, $loadreqs rpcs each: $loadmix"
+        rm -f $dir/$transport-*.log
+        t0=${EPOCHREALTIME/./}
+        for (( j=0; j<$n; j++ )); do
+            load_session $transport $dir/$transport-$j.log &
+        done
+        wait
+        t1=${EPOCHREALTIME/./}
+        for op in $loadmix; do
+            for (( j=0; j<$n; j++ )); do
+                awk -v op=$op '$2 == op' $dir/$transport-$j.log
+            done > $dir/$transport-$op.log
+            load_report "$transport $op" $(( t1 - t0 )) $resdir/netconf-load-$transport-$op-$arch $n $dir/$transport-$op.log
+        done
+        load_report "$transport total" $(( t1 - t0 )) $resdir/netconf-load-$transport-$arch $n $dir/$transport-[0-9]*.log
+        nr=$(cat $dir/$transport-[0-9]*.log | wc -l)
+        if [ $nr -ne $(( n * loadreqs )) ]; then
+            err1 "$(( n * loadreqs )) rpcs" "$nr"
+        fi
+        nr=$(awk '$4 != 1' $dir/$transport-[0-9]*.log | wc -l)
+        if [ $nr -ne 0 ]; then
+            err1 "no rpc-errors" "$nr"
+        fi
+    done
+done
+
+if $plot; then
+    ext=$term # gnuplot output file extension
+    gplot=""
+    gplot99=""
+    for transport in $transports; do
+        gplot="$gplot \"$resdir/netconf-load-$transport-$arch\" using 1:2 title \"$transport-$arch\","
+        for op in $loadmix; do
+            gplot99="$gplot99 \"$resdir/netconf-load-$transport-$op-$arch\" using 1:5 title \"$transport-$op-$arch\","
+        done
+    done
+
+gnuplot -persist <<EOF
+set title "Clixon netconf load throughput"
+set style data linespoint
+set xlabel "sessions"
+set ylabel "rpc/s"
+set grid
+set terminal $term
+set yrange [0:*]
+set output "$resdir/clixon-netconf-load.$ext"
+plot $gplot
+EOF
+
+gnuplot -persist <<EOF
+set title "Clixon netconf load p99 latency"
+set style data linespoint
+set xlabel "sessions"
+set ylabel "ms"
+set grid
+set terminal $term
+set yrange [0:*]
+set output "$resdir/clixon-netconf-load-p99.$ext"
+plot $gplot99
+EOF
+fi # if plot
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
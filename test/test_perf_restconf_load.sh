@@ -0,0 +1,233 @@
+#!/usr/bin/env bash
+# Load benchmark of RESTCONF using h2load from nghttp2
+# Concurrent clients run a mix of GET, PUT and PATCH requests on a list for a fixed
+# time, over HTTP/1.1 with keep-alive and HTTP/2 with multiplexed streams.
+# Throughput and latency percentiles are reported for each method and protocol.
+# Runs with native or fcgi restconf, fcgi only with HTTP/1.1
+# Example:
+#   loadclients=50 loadtime=30 workers=4 ./test_perf_restconf_load.sh
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+if ! type h2load > /dev/null 2>&1; then
+    echo "...skipped: h2load (nghttp2) not installed"
+    rm -rf $dir
+    if [ "$s" = $0 ]; then exit 0; else return 0; fi
+fi
+
+# Number of list entries in initial config
+: ${perfnr:=1000}
+
+# Number of concurrent clients (connections) per method
+: ${loadclients:=10}
+
+# Max concurrent streams per client in HTTP/2
+: ${loadstreams:=10}
+
+# Duration of each run in seconds
+: ${loadtime:=10}
+
+# Fixed rate in requests per second per client, empty for as fast as possible
+: ${loadrate:=}
+
+# Methods run concurrently
+: ${loadmix:="get put patch"}
+
+# Restconf worker processes, see CLICON_RESTCONF_WORKERS
+: ${workers:=0}
+
+# Protocols, h1 is HTTP/1.1 with keep-alive, h2 is HTTP/2
+if [ -z "${loadprotos:-}" ]; then
+    if [ "${WITH_RESTCONF}" = "fcgi" ]; then
+        loadprotos="h1"
+    else
+        ${HAVE_HTTP1} && loadprotos="h1"
+        ${HAVE_LIBNGHTTP2} && loadprotos="${loadprotos} h2"
+    fi
+fi
+
+APPNAME=example
+
+cfg=$dir/load-conf.xml
+fyang=$dir/scaling.yang
+fdataxml=$dir/large.xml
+furis=$dir/uris
+fput=$dir/put.json
+fpatch=$dir/patch.json
+
+cat <<EOF > $fyang
+module scaling{
+   yang-version 1.1;
+   namespace "urn:example:clixon";
+   prefix ex;
+   container x {
+    list y {
+      key "a";
+      leaf a {
+        type int32;
+      }
+      leaf b {
+        type int32;
+      }
+    }
+  }
+}
+EOF
+
+# Define default restconfig config: RESTCONFIG
+RESTCONFIG=$(restconf_config none false)
+if [ $? -ne 0 ]; then
+    err1 "Error when generating certs"
+fi
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_FEATURE>clixon-restconf:allow-auth-none</CLICON_FEATURE> <!-- Use auth-type=none -->
+  <CLICON_YANG_DIR>$dir</CLICON_YANG_DIR>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_XMLDB_PRETTY>false</CLICON_XMLDB_PRETTY>
+  <CLICON_LOG_STRING_LIMIT>128</CLICON_LOG_STRING_LIMIT>
+  <CLICON_RESTCONF_HTTP2_PLAIN>true</CLICON_RESTCONF_HTTP2_PLAIN>
+  <CLICON_RESTCONF_WORKERS>$workers</CLICON_RESTCONF_WORKERS>
+  $RESTCONFIG
+</clixon-config>
+EOF
+
+# Run h2load for one method in background
+# Log file columns: start time (us), status code, response time (us)
+# @param[in] proto   h1 or h2
+# @param[in] method  get, put or patch
+# @param[in] log     Log file
+function load_run()
+{
+    proto=$1
+    method=$2
+    log=$3
+
+    opts="-c $loadclients -D $loadtime --log-file=$log"
+    if [ $proto = h1 ]; then
+        opts="$opts --h1 -m 1"
+    else
+        opts="$opts -m $loadstreams"
+    fi
+    if [ -n "$loadrate" ]; then
+        opts="$opts --rps=$loadrate"
+    fi
+    case $method in
+        get)
+            h2load $opts -H "Accept: application/yang-data+json" -i $furis > /dev/null &
+            ;;
+        put)
+            h2load $opts -H ":method: PUT" -H "Content-Type: application/yang-data+json" -d $fput $RCPROTO://localhost/restconf/data/scaling:x/y=1 > /dev/null &
+            ;;
+        patch)
+            h2load $opts -H ":method: PATCH" -H "Content-Type: application/yang-data+json" -d $fpatch $RCPROTO://localhost/restconf/data/scaling:x > /dev/null &
+            ;;
+    esac
+}
+
+# Print number of requests, throughput and latency percentiles in ms of log files
+# @param[in] name  Label
+# @param[in] logs  Log files
+function load_report()
+{
+    name=$1
+    shift
+    cat $@ | sort -n -k3 | awk -v name="$name" -v t=$loadtime '
+function pct(p,  i) { i = int(p*NR); if (i < p*NR) i++; if (i < 1) i = 1; return lat[i]/1000 }
+{ lat[NR] = $3; if ($2 < 200 || $2 > 299) fail++ }
+END {
+    if (NR == 0) { printf "%-10s no requests\n", name; exit }
+    printf "%-10s %8d req %9.1f req/s  p50 %7.2f p90 %7.2f p99 %7.2f max %7.2f ms  %d failed\n",
+        name, NR, NR/t, pct(0.50), pct(0.90), pct(0.99), lat[NR]/1000, fail
+}'
+}
+
+new "test params: -f $cfg"
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+if [ $RC -ne 0 ]; then
+    new "kill old restconf daemon"
+    stop_restconf_pre
+
+    new "start restconf daemon"
+    start_restconf -f $cfg
+fi
+
+new "wait restconf"
+wait_restconf
+
+new "generate config with $perfnr list entries"
+echo -n "<x xmlns=\"urn:example:clixon\">" > $fdataxml
+for (( i=0; i<$perfnr; i++ )); do
+    echo -n "<y><a>$i</a><b>$i</b></y>" >> $fdataxml
+done
+echo -n "</x>" >> $fdataxml
+
+new "restconf PUT initial config"
+expectpart "$(curl $CURLOPTS -X PUT -H "Content-Type: application/yang-data+xml" $RCPROTO://localhost/restconf/data/scaling:x -d @$fdataxml)" 0 "HTTP/$HVER 20"
+
+# GET uses random keys, PUT and PATCH write fixed entries
+rm -f $furis
+for (( i=0; i<100; i++ )); do
+    echo "$RCPROTO://localhost/restconf/data/scaling:x/y=$(( RANDOM % $perfnr ))" >> $furis
+done
+echo '{"scaling:y":[{"a":1,"b":1}]}' > $fput
+echo '{"scaling:x":{"y":[{"a":2,"b":2}]}}' > $fpatch
+
+for proto in $loadprotos; do
+    new "restconf load $proto: $loadmix, $loadclients clients per method, ${loadtime}s"
+    for method in $loadmix; do
+        rm -f $dir/$proto-$method.log
+        load_run $proto $method $dir/$proto-$method.log
+    done
+    wait
+    for method in $loadmix; do
+        load_report "$proto $method" $dir/$proto-$method.log
+        if [ ! -s $dir/$proto-$method.log ]; then
+            err1 "$proto $method requests" "none"
+        fi
+        n=$(awk '$2 < 200 || $2 > 499' $dir/$proto-$method.log | wc -l)
+        if [ $n -ne 0 ]; then
+            err1 "$proto $method no server errors" "$n"
+        fi
+    done
+    load_report "$proto total" $dir/$proto-*.log
+done
+
+if [ $RC -ne 0 ]; then
+    new "Kill restconf daemon"
+    stop_restconf
+fi
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
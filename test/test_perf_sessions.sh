@@ -0,0 +1,526 @@
+#!/usr/bin/env bash
+# Scaling of backend with many concurrent client sessions
+# A number of sessions are opened and held: idle NETCONF sessions, NETCONF sessions with a
+# CONFIG-CHANGE subscription, NETCONF sessions holding a private candidate with an
+# uncommitted edit, and CLI sessions. Optionally also RESTCONF event stream subscribers.
+# While the sessions are held, a few active NETCONF sessions (and RESTCONF clients) run a
+# mix of RPCs for a fixed time, and a probe session sends a ping at a fixed interval.
+# For each number of held sessions, from step to to, the following is reported:
+#   - Backend memory (RSS) per held session
+#   - Event loop latency as the ping latency percentiles of the probe
+#   - Throughput and latency of the active sessions, and fairness between them as
+#     min/max RPCs per session and Jain's fairness index
+#   - Number of notifications delivered to the subscribers
+# The results may be plotted with gnuplot.
+# Examples:
+#   step=100 to=500 loadtime=20 ./test_perf_sessions.sh
+#   subpct=50 privpct=0 plot=true term=png resdir=/tmp/plots ./test_perf_sessions.sh
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+if [ -z "${EPOCHREALTIME:-}" ]; then
+    echo "...skipped: bash 5 EPOCHREALTIME needed for latency"
+    rm -rf $dir
+    if [ "$s" = $0 ]; then exit 0; else return 0; fi
+fi
+
+# Number of list entries in initial config
+: ${perfnr:=1000}
+
+# Number of held sessions, from step to to in steps
+: ${step:=50}
+: ${to:=100}
+
+# Percent of held sessions that are NETCONF subscribers, private candidates and CLI
+# The rest are idle NETCONF sessions
+: ${subpct:=20}
+: ${privpct:=20}
+: ${clipct:=10}
+
+# Number of RESTCONF event stream subscribers, needs restconf with stream support
+: ${rcsubscribers:=0}
+
+# Number of active NETCONF sessions
+: ${active:=10}
+
+# RPCs of each active session in round-robin order
+: ${loadmix:="get get-config edit-config commit"}
+
+# Number of active RESTCONF clients, each a GET loop with curl
+: ${rcclients:=0}
+
+# Duration of load with held sessions in seconds
+: ${loadtime:=10}
+
+# Interval of probe pings in seconds
+: ${probeint:=0.05}
+
+# Plot results with gnuplot
+: ${plot:=false}
+: ${term:=x11} # x11 interactive, alt: png
+: ${resdir:=$dir} # Result dir (both data and gnuplot)
+
+APPNAME=example
+
+cfg=$dir/sessions-conf.xml
+fyang=$dir/scaling.yang
+clispec=$dir/spec.cli
+fdataxml=$dir/large.xml
+fhold=$dir/hold # Held sessions close when this file is removed
+arch=$(arch)
+
+if [ $privpct -gt 0 ]; then
+    PRIVCAND="<CLICON_FEATURE>ietf-netconf-private-candidate:private-candidate</CLICON_FEATURE><CLICON_XMLDB_PRIVATE_CANDIDATE>true</CLICON_XMLDB_PRIVATE_CANDIDATE>"
+else
+    PRIVCAND=""
+fi
+
+if [ $RC -eq 0 ]; then
+    rcclients=0
+    rcsubscribers=0
+fi
+if [ $rcclients -gt 0 -o $rcsubscribers -gt 0 ]; then
+    RESTCONFIG=$(restconf_config none false)
+    if [ $? -ne 0 ]; then
+        err1 "Error when generating certs"
+    fi
+else
+    RESTCONFIG=""
+fi
+
+cat <<EOF > $fyang
+module scaling{
+   yang-version 1.1;
+   namespace "urn:example:clixon";
+   prefix ex;
+   container x {
+    list y {
+      key "a";
+      leaf a {
+        type int32;
+      }
+      leaf b {
+        type int32;
+      }
+    }
+  }
+}
+EOF
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_FEATURE>clixon-restconf:allow-auth-none</CLICON_FEATURE>
+  <CLICON_YANG_DIR>$dir</CLICON_YANG_DIR>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_DIR>$IETFRFC</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_CLISPEC_DIR>$dir</CLICON_CLISPEC_DIR>
+  <CLICON_CLI_MODE>$APPNAME</CLICON_CLI_MODE>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_XMLDB_PRETTY>false</CLICON_XMLDB_PRETTY>
+  <CLICON_STREAM_CONFIG_CHANGE>true</CLICON_STREAM_CONFIG_CHANGE>
+  <CLICON_LOG_STRING_LIMIT>128</CLICON_LOG_STRING_LIMIT>
+  $PRIVCAND
+  $RESTCONFIG
+</clixon-config>
+EOF
+
+cat <<EOF > $clispec
+CLICON_MODE="$APPNAME";
+CLICON_PROMPT="cli> ";
+show("Show") config("Config"), cli_show_config("running", "xml");
+EOF
+
+# Ping of clixon-lib, used by idle sessions and the probe
+PING="<rpc $DEFAULTNS><ping xmlns=\"http://clicon.org/lib\"/></rpc>"
+
+# Make one RPC of the mix with a random list entry
+# @param[in] op  get, get-config, edit-config or commit
+function load_rpc()
+{
+    op=$1
+    rnd=$(( RANDOM % $perfnr ))
+    case $op in
+        get)
+            echo "<rpc $DEFAULTNS><get><filter type=\"xpath\" select=\"/ex:x/ex:y[ex:a=$rnd]\" xmlns:ex=\"urn:example:clixon\"/></get></rpc>"
+            ;;
+        get-config)
+            echo "<rpc $DEFAULTNS><get-config><source><running/></source><filter type=\"xpath\" select=\"/ex:x/ex:y[ex:a=$rnd]\" xmlns:ex=\"urn:example:clixon\"/></get-config></rpc>"
+            ;;
+        edit-config)
+            echo "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><x xmlns=\"urn:example:clixon\"><y><a>$rnd</a><b>$RANDOM</b></y></x></config></edit-config></rpc>"
+            ;;
+        commit)
+            echo "<rpc $DEFAULTNS><commit/></rpc>"
+            ;;
+    esac
+}
+
+# Hold a NETCONF session until $fhold is removed
+# @param[in] rpc  RPC sent after hello
+# @param[in] out  Output file
+function hold_netconf()
+{
+    rpc=$1
+    out=$2
+
+    { echo -n "$DEFAULTHELLO"; chunked_framing "$rpc"; while [ -f $fhold ]; do sleep 1; done; } | $clixon_netconf -qf $cfg > $out 2> /dev/null
+}
+
+# Hold a CLI session until $fhold is removed
+function hold_cli()
+{
+    { echo "show config"; while [ -f $fhold ]; do sleep 1; done; } | $clixon_cli -f $cfg > /dev/null 2>&1
+}
+
+# Hold a RESTCONF event stream subscription until $fhold is removed
+# @param[in] out  Output file
+function hold_restconf()
+{
+    out=$1
+
+    curl $CURLOPTS -N -X GET -H "Accept: text/event-stream" -H "Cache-Control: no-cache" -H "Connection: keep-alive" $RCPROTO://localhost/streams/CONFIG-CHANGE > $out 2> /dev/null &
+    pid=$!
+    while [ -f $fhold ]; do sleep 1; done
+    kill $pid 2> /dev/null
+}
+
+# Run one active NETCONF session for loadtime seconds, send an RPC when the reply of the
+# previous is received
+# Log file columns: start time (us), rpc, latency (us), 1 if ok else 0
+# @param[in] log  Log file
+function load_session()
+{
+    log=$1
+
+    coproc NC { $clixon_netconf -qf $cfg 2> /dev/null; }
+    echo "$DEFAULTHELLO" >&${NC[1]}
+    ops=($loadmix)
+    tend=$(( ${EPOCHREALTIME/./} + loadtime * 1000000 ))
+    for (( i=0; ; i++ )); do
+        op=${ops[$(( i % ${#ops[@]} ))]}
+        rpc=$(chunked_framing "$(load_rpc $op)")
+        t0=${EPOCHREALTIME/./}
+        if [ $t0 -ge $tend ]; then
+            break
+        fi
+        echo "$rpc" >&${NC[1]}
+        ok=1
+        while read -r -u ${NC[0]} line; do
+            case "$line" in
+                "##") break;;
+                *"<rpc-error>"*) ok=0;;
+            esac
+        done
+        t1=${EPOCHREALTIME/./}
+        echo "$t0 $op $(( t1 - t0 )) $ok" >> $log
+    done
+    exec {NC[1]}>&-
+    wait $NC_PID 2> /dev/null
+}
+
+# Run the probe session for loadtime seconds, send a ping each probeint seconds
+# Log file columns as load_session
+# @param[in] log  Log file
+function probe_session()
+{
+    log=$1
+
+    coproc PR { $clixon_netconf -qf $cfg 2> /dev/null; }
+    echo "$DEFAULTHELLO" >&${PR[1]}
+    rpc=$(chunked_framing "$PING")
+    tend=$(( ${EPOCHREALTIME/./} + loadtime * 1000000 ))
+    while true; do
+        t0=${EPOCHREALTIME/./}
+        if [ $t0 -ge $tend ]; then
+            break
+        fi
+        echo "$rpc" >&${PR[1]}
+        ok=1
+        while read -r -u ${PR[0]} line; do
+            case "$line" in
+                "##") break;;
+                *"<rpc-error>"*) ok=0;;
+            esac
+        done
+        t1=${EPOCHREALTIME/./}
+        echo "$t0 ping $(( t1 - t0 )) $ok" >> $log
+        sleep $probeint
+    done
+    exec {PR[1]}>&-
+    wait $PR_PID 2> /dev/null
+}
+
+# Run one active RESTCONF client for loadtime seconds, GET a random list entry in a loop
+# Log file columns as load_session
+# @param[in] log  Log file
+function load_restconf()
+{
+    log=$1
+
+    tend=$(( ${EPOCHREALTIME/./} + loadtime * 1000000 ))
+    while true; do
+        t0=${EPOCHREALTIME/./}
+        if [ $t0 -ge $tend ]; then
+            break
+        fi
+        code=$(curl $CURLOPTS -o /dev/null -w "%{http_code}" -X GET -H "Accept: application/yang-data+json" $RCPROTO://localhost/restconf/data/scaling:x/y=$(( RANDOM % $perfnr )))
+        t1=${EPOCHREALTIME/./}
+        if [ "$code" = 200 ]; then ok=1; else ok=0; fi
+        echo "$t0 restconf-get $(( t1 - t0 )) $ok" >> $log
+    done
+}
+
+# Print backend resident memory in KB, or 0 if not known
+function backend_rss()
+{
+    pid=$(cat /usr/local/var/run/$APPNAME.pidfile 2> /dev/null)
+    if [ -n "$pid" -a -f /proc/$pid/status ]; then
+        awk '/^VmRSS:/ {print $2}' /proc/$pid/status
+    else
+        echo 0
+    fi
+}
+
+# Print number of backend sessions using ietf-netconf-monitoring, including this one
+function backend_sessions()
+{
+    echo "$DEFAULTHELLO$(chunked_framing "<rpc $DEFAULTNS><get><filter type=\"subtree\"><netconf-state xmlns=\"urn:ietf:params:xml:ns:yang:ietf-netconf-monitoring\"><sessions/></netconf-state></filter></get></rpc>")" | $clixon_netconf -qf $cfg 2> /dev/null | grep -o "<session>" | wc -l
+}
+
+# Print number of RPCs, throughput and latency percentiles in ms of log files
+# Also append "sessions rpc/s p50 p90 p99" to a result file if given
+# @param[in] name     Label
+# @param[in] elapsed  Elapsed time in us
+# @param[in] res      Result file, or empty
+# @param[in] sessions Number of held sessions
+# @param[in] logs     Log files
+function load_report()
+{
+    name=$1
+    elapsed=$2
+    res=$3
+    sessions=$4
+    shift 4
+    cat $@ | sort -n -k3 | awk -v name="$name" -v t=$elapsed -v res="$res" -v n=$sessions '
+function pct(p,  i) { i = int(p*NR); if (i < p*NR) i++; if (i < 1) i = 1; return lat[i]/1000 }
+{ lat[NR] = $3; if ($4 != 1) fail++ }
+END {
+    if (NR == 0) { printf "%-20s no rpcs\n", name; exit }
+    printf "%-20s %8d rpc %9.1f rpc/s  p50 %7.2f p90 %7.2f p99 %7.2f max %7.2f ms  %d failed\n",
+        name, NR, NR*1000000/t, pct(0.50), pct(0.90), pct(0.99), lat[NR]/1000, fail
+    if (res != "")
+        printf "%d %.1f %.2f %.2f %.2f\n", n, NR*1000000/t, pct(0.50), pct(0.90), pct(0.99) >> res
+}'
+}
+
+# Print min and max RPCs per session and Jain's fairness index (sum x)^2/(n * sum x^2)
+# Also append "sessions min max index" to a result file
+# @param[in] res      Result file
+# @param[in] sessions Number of held sessions
+# @param[in] logs     Log files, one per active session
+function fair_report()
+{
+    res=$1
+    sessions=$2
+    shift 2
+    for f in $@; do
+        cat $f 2> /dev/null | wc -l
+    done | awk -v res="$res" -v n=$sessions '
+NR == 1 || $1 < min { min = $1 }
+$1 > max { max = $1 }
+{ sum += $1; sq += $1*$1 }
+END {
+    j = (sq > 0) ? sum*sum/(NR*sq) : 0
+    printf "%-20s min %d max %d rpc per session  jain %.3f\n", "fairness", min, max, j
+    printf "%d %d %d %.3f\n", n, min, max, j >> res
+}'
+}
+
+new "test params: -f $cfg"
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+if [ $rcclients -gt 0 -o $rcsubscribers -gt 0 ]; then
+    new "kill old restconf daemon"
+    stop_restconf_pre
+
+    new "start restconf daemon"
+    start_restconf -f $cfg
+
+    new "wait restconf"
+    wait_restconf
+fi
+
+new "generate config with $perfnr list entries"
+echo -n "<x xmlns=\"urn:example:clixon\">" > $fdataxml
+for (( i=0; i<$perfnr; i++ )); do
+    echo -n "<y><a>$i</a><b>$i</b></y>" >> $fdataxml
+done
+echo -n "</x>" >> $fdataxml
+
+new "netconf edit-config initial config"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config>$(cat $fdataxml)</config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "netconf commit initial config"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+if [ ! -d $resdir ]; then
+    mkdir $resdir
+fi
+for res in mem probe active restconf fair notify; do
+    rm -f $resdir/sessions-$res-$arch
+done
+for (( n=$step; n<=$to; n+=$step )); do
+    nsub=$(( n * subpct / 100 ))
+    npriv=$(( n * privpct / 100 ))
+    ncli=$(( n * clipct / 100 ))
+    nidle=$(( n - nsub - npriv - ncli ))
+    rm -f $dir/held-* $dir/active-*.log $dir/probe.log $dir/restconf-*.log
+    rss0=$(backend_rss)
+    nr0=$(backend_sessions)
+
+    new "hold $n sessions: $nidle idle, $nsub subscribers, $npriv private candidates, $ncli cli"
+    touch $fhold
+    for (( j=0; j<$nidle; j++ )); do
+        hold_netconf "$PING" $dir/held-idle-$j &
+    done
+    for (( j=0; j<$nsub; j++ )); do
+        hold_netconf "<rpc $DEFAULTNS><create-subscription xmlns=\"urn:ietf:params:xml:ns:netmod:notification\"><stream>CONFIG-CHANGE</stream></create-subscription></rpc>" $dir/held-sub-$j &
+    done
+    for (( j=0; j<$npriv; j++ )); do
+        hold_netconf "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><x xmlns=\"urn:example:clixon\"><y><a>$(( perfnr + j ))</a><b>$j</b></y></x></config></edit-config></rpc>" $dir/held-priv-$j &
+    done
+    for (( j=0; j<$ncli; j++ )); do
+        hold_cli &
+    done
+    for (( j=0; j<$rcsubscribers; j++ )); do
+        hold_restconf $dir/held-rcsub-$j &
+    done
+
+    new "wait for $n held sessions"
+    for (( i=0; i<60; i++ )); do
+        nr=$(backend_sessions)
+        if [ $nr -ge $(( nr0 + n )) ]; then
+            break
+        fi
+        sleep 1
+    done
+    if [ $nr -lt $(( nr0 + n )) ]; then
+        err1 "$(( nr0 + n )) sessions" "$nr"
+    fi
+    rss1=$(backend_rss)
+    echo "$n sessions: backend rss $rss0 -> $rss1 KB, $(( (rss1 - rss0) * 1024 / n )) bytes per session"
+    echo "$n $rss0 $rss1 $(( (rss1 - rss0) * 1024 / n ))" >> $resdir/sessions-mem-$arch
+
+    new "load $loadtime s: $active active sessions, $rcclients restconf clients, probe each $probeint s"
+    t0=${EPOCHREALTIME/./}
+    probe_session $dir/probe.log &
+    for (( j=0; j<$active; j++ )); do
+        load_session $dir/active-$j.log &
+    done
+    for (( j=0; j<$rcclients; j++ )); do
+        load_restconf $dir/restconf-$j.log &
+    done
+    # Wait for load only, not for held sessions
+    wait $(jobs -p | tail -n $(( 1 + active + rcclients )))
+    t1=${EPOCHREALTIME/./}
+    load_report "probe ping" $(( t1 - t0 )) $resdir/sessions-probe-$arch $n $dir/probe.log
+    if [ $active -gt 0 ]; then
+        load_report "netconf active" $(( t1 - t0 )) $resdir/sessions-active-$arch $n $dir/active-*.log
+        fair_report $resdir/sessions-fair-$arch $n $(for (( j=0; j<$active; j++ )); do echo $dir/active-$j.log; done)
+    fi
+    if [ $rcclients -gt 0 ]; then
+        load_report "restconf get" $(( t1 - t0 )) $resdir/sessions-restconf-$arch $n $dir/restconf-*.log
+    fi
+    nr=$(cat $dir/probe.log $dir/active-*.log $dir/restconf-*.log 2> /dev/null | awk '$4 != 1' | wc -l)
+    if [ $nr -ne 0 ]; then
+        err1 "no rpc-errors" "$nr"
+    fi
+
+    new "release $n held sessions"
+    rm -f $fhold
+    wait
+    nr=$(cat $dir/held-sub-* /dev/null | grep -o "<notification" | wc -l)
+    echo "$nsub subscribers: $nr notifications"
+    echo "$n $nsub $nr" >> $resdir/sessions-notify-$arch
+    nr=$(cat $dir/held-idle-* $dir/held-sub-* $dir/held-priv-* /dev/null | grep -c "<rpc-error>")
+    if [ $nr -ne 0 ]; then
+        err1 "no rpc-errors in held sessions" "$nr"
+    fi
+done
+
+if $plot; then
+    ext=$term # gnuplot output file extension
+
+gnuplot -persist <<EOF
+set title "Clixon backend memory per held session"
+set style data linespoint
+set xlabel "sessions"
+set ylabel "bytes"
+set grid
+set terminal $term
+set yrange [0:*]
+set output "$resdir/clixon-sessions-mem.$ext"
+plot "$resdir/sessions-mem-$arch" using 1:4 title "$arch"
+EOF
+
+gnuplot -persist <<EOF
+set title "Clixon event loop latency with held sessions"
+set style data linespoint
+set xlabel "sessions"
+set ylabel "ms"
+set grid
+set terminal $term
+set yrange [0:*]
+set output "$resdir/clixon-sessions-latency.$ext"
+plot "$resdir/sessions-probe-$arch" using 1:3 title "ping p50-$arch", "$resdir/sessions-probe-$arch" using 1:5 title "ping p99-$arch", "$resdir/sessions-active-$arch" using 1:5 title "active p99-$arch"
+EOF
+
+gnuplot -persist <<EOF
+set title "Clixon fairness between active sessions"
+set style data linespoint
+set xlabel "sessions"
+set ylabel "Jain index"
+set grid
+set terminal $term
+set yrange [0:1]
+set output "$resdir/clixon-sessions-fairness.$ext"
+plot "$resdir/sessions-fair-$arch" using 1:4 title "$arch"
+EOF
+fi # if plot
+
+if [ $rcclients -gt 0 -o $rcsubscribers -gt 0 ]; then
+    new "Kill restconf daemon"
+    stop_restconf
+fi
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
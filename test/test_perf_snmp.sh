@@ -0,0 +1,247 @@
+#!/usr/bin/env bash
+# Throughput benchmark of clixon_snmp
+# IF-MIB ifTable and ENTITY-MIB entPhysicalTable are populated with perfnr rows of state
+# data. Each workload of snmpwalk, snmpbulkwalk and snmpget is run against a newly
+# started clixon_snmp, and varbind rate and request latency are reported.
+# With CLICON_SNMP_TIMING, clixon_snmp logs the time of each workload split into
+# net-snmp, clixon handler and cache, and backend rpc time, which is reported per PDU.
+# Examples:
+#   perfnr=1000 perfreq=200 ./test_perf_snmp.sh
+#   cachettl=0 ./test_perf_snmp.sh
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+if [ ${ENABLE_NETSNMP} != "yes" ]; then
+    echo "Skipping test, Net-SNMP support not enabled."
+    rm -rf $dir
+    if [ "$s" = $0 ]; then exit 0; else return 0; fi
+fi
+
+if [ -z "${EPOCHREALTIME:-}" ]; then
+    echo "...skipped: bash 5 EPOCHREALTIME needed for latency"
+    rm -rf $dir
+    if [ "$s" = $0 ]; then exit 0; else return 0; fi
+fi
+
+# Number of rows in each table
+: ${perfnr:=100}
+
+# Number of snmpget requests
+: ${perfreq:=100}
+
+# Max repetitions of snmpbulkwalk
+: ${bulkrep:=20}
+
+# Getnext cache time in ms, see CLICON_SNMP_CACHE_TTL
+: ${cachettl:=1000}
+
+snmpwalk="$(type -p snmpwalk) -On -c public -v2c localhost "
+snmpbulkwalk="$(type -p snmpbulkwalk) -On -Cr$bulkrep -c public -v2c localhost "
+snmpget="$(type -p snmpget) -On -c public -v2c localhost "
+
+cfg=$dir/conf_startup.xml
+fyang=$dir/clixon-example.yang
+fstate=$dir/state.xml
+flog=$dir/snmp.log
+
+# AgentX unix socket
+SOCK=/var/run/snmp.sock
+
+IFTABLE=".1.3.6.1.2.1.2.2"
+ENTTABLE=".1.3.6.1.2.1.47.1.1.1"
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_DIR>${YANG_STANDARD_DIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_DIR>${MIB_GENERATED_YANG_DIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>$dir/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_DIR>/usr/local/lib/$APPNAME/backend</CLICON_BACKEND_DIR>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_SNMP_AGENT_SOCK>unix:$SOCK</CLICON_SNMP_AGENT_SOCK>
+  <CLICON_SNMP_MIB>IF-MIB</CLICON_SNMP_MIB>
+  <CLICON_SNMP_MIB>ENTITY-MIB</CLICON_SNMP_MIB>
+  <CLICON_SNMP_CACHE_TTL>$cachettl</CLICON_SNMP_CACHE_TTL>
+  <CLICON_SNMP_TIMING>true</CLICON_SNMP_TIMING>
+  <CLICON_VALIDATE_STATE_XML>false</CLICON_VALIDATE_STATE_XML>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module clixon-example{
+  yang-version 1.1;
+  namespace "urn:example:clixon";
+  prefix ex;
+  import IF-MIB {
+      prefix "if-mib";
+  }
+  import ENTITY-MIB {
+      prefix "entity-mib";
+  }
+}
+EOF
+
+new "generate state with $perfnr rows in ifTable and entPhysicalTable"
+{
+    echo "<IF-MIB xmlns=\"urn:ietf:params:xml:ns:yang:smiv2:IF-MIB\">"
+    echo "<interfaces><ifNumber>$perfnr</ifNumber></interfaces>"
+    echo "<ifTable>"
+    for (( i=1; i<=$perfnr; i++ )); do
+        echo "<ifEntry><ifIndex>$i</ifIndex><ifDescr>if$i</ifDescr><ifType>ethernetCsmacd</ifType><ifMtu>1500</ifMtu><ifSpeed>10000000</ifSpeed><ifAdminStatus>up</ifAdminStatus><ifOperStatus>up</ifOperStatus><ifInOctets>$i</ifInOctets><ifOutOctets>$i</ifOutOctets></ifEntry>"
+    done
+    echo "</ifTable>"
+    echo "</IF-MIB>"
+    echo "<ENTITY-MIB xmlns=\"urn:ietf:params:xml:ns:yang:smiv2:ENTITY-MIB\">"
+    echo "<entPhysicalTable>"
+    for (( i=1; i<=$perfnr; i++ )); do
+        echo "<entPhysicalEntry><entPhysicalIndex>$i</entPhysicalIndex><entPhysicalDescr>Entity $i</entPhysicalDescr><entPhysicalContainedIn>0</entPhysicalContainedIn><entPhysicalClass>port</entPhysicalClass><entPhysicalParentRelPos>$i</entPhysicalParentRelPos><entPhysicalName>port$i</entPhysicalName><entPhysicalSerialNum>SN$i</entPhysicalSerialNum><entPhysicalIsFRU>false</entPhysicalIsFRU></entPhysicalEntry>"
+    done
+    echo "</entPhysicalTable>"
+    echo "</ENTITY-MIB>"
+} > $fstate
+
+# Start clixon_snmp logging to file, see start_snmp
+function perf_snmp_start()
+{
+    rm -f ${clixon_snmp_pidfile} $flog
+    export MIBDIRS
+    $clixon_snmp -f $cfg -l f$flog -D $DBG &
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    wait_snmp
+}
+
+# Stop clixon_snmp and print its timing log per PDU
+# @param[in] name   Label
+# @param[in] pdus   Number of PDUs of workload
+function perf_snmp_stop()
+{
+    name=$1
+    pdus=$2
+
+    stop_snmp
+    for (( i=0; i<$DEMLOOP; i++ )); do
+        if grep -q "SNMP timing" $flog 2> /dev/null; then
+            break
+        fi
+        sleep $DEMSLEEP
+    done
+    grep "SNMP timing" $flog | sed 's/.*total \([0-9]*\) us: net-snmp \([0-9]*\) cache \([0-9]*\) backend \([0-9]*\) us.*/\1 \2 \3 \4/' | awk -v name="$name" -v n=$pdus '
+{
+    if (n < 1) n = 1
+    printf "%-24s per pdu: agent %8.1f us: net-snmp %8.1f cache %8.1f backend %8.1f us\n",
+        name, $1/n, $2/n, $3/n, $4/n
+}'
+}
+
+# Run snmpwalk or snmpbulkwalk on a table, print varbind rate
+# @param[in] name  Label
+# @param[in] cmd   snmpwalk or snmpbulkwalk command
+# @param[in] oid   Table OID
+# @param[in] rep   Varbinds per PDU, 1 for snmpwalk
+function perf_walk()
+{
+    name=$1
+    cmd=$2
+    oid=$3
+    rep=$4
+
+    perf_snmp_start
+    t0=${EPOCHREALTIME/./}
+    nr=$($cmd $oid | wc -l)
+    t1=${EPOCHREALTIME/./}
+    echo "$name" | awk -v nr=$nr -v t=$(( t1 - t0 )) '
+{ printf "%-24s %8d varbinds %9.1f varbinds/s %10.2f ms\n", $0, nr, nr*1000000/t, t/1000 }'
+    if [ $nr -lt $perfnr ]; then
+        err1 "at least $perfnr varbinds" "$nr"
+    fi
+    # One extra PDU for end of table
+    perf_snmp_stop "$name" $(( nr / rep + 1 ))
+}
+
+# Run snmpget of random rows, print request rate and latency percentiles
+# @param[in] name  Label
+# @param[in] oid   Column OID, row index is appended
+function perf_get()
+{
+    name=$1
+    oid=$2
+
+    perf_snmp_start
+    rm -f $dir/get.log
+    t0=${EPOCHREALTIME/./}
+    for (( i=0; i<$perfreq; i++ )); do
+        t=${EPOCHREALTIME/./}
+        $snmpget $oid.$(( RANDOM % $perfnr + 1 )) > /dev/null
+        echo "$(( ${EPOCHREALTIME/./} - t ))" >> $dir/get.log
+    done
+    t1=${EPOCHREALTIME/./}
+    sort -n $dir/get.log | awk -v name="$name" -v t=$(( t1 - t0 )) '
+function pct(p,  i) { i = int(p*NR); if (i < p*NR) i++; if (i < 1) i = 1; return lat[i]/1000 }
+{ lat[NR] = $1 }
+END {
+    printf "%-24s %8d gets %9.1f gets/s  p50 %7.2f p90 %7.2f p99 %7.2f max %7.2f ms\n",
+        name, NR, NR*1000000/t, pct(0.50), pct(0.90), pct(0.99), lat[NR]/1000
+}'
+    perf_snmp_stop "$name" $perfreq
+}
+
+new "test params: -s init -f $cfg -- -sS $fstate"
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    sudo pkill -f clixon_backend
+
+    new "start backend -s init -f $cfg -- -sS $fstate"
+    start_backend -s init -f $cfg -- -sS $fstate
+fi
+
+new "wait backend"
+wait_backend
+
+new "Terminating any old clixon_snmp processes"
+sudo killall -q clixon_snmp
+
+new "snmpwalk ifTable $perfnr rows"
+perf_walk "walk ifTable" "$snmpwalk" $IFTABLE 1
+
+new "snmpbulkwalk ifTable $perfnr rows"
+perf_walk "bulkwalk ifTable" "$snmpbulkwalk" $IFTABLE $bulkrep
+
+new "snmpwalk entPhysicalTable $perfnr rows"
+perf_walk "walk entPhysicalTable" "$snmpwalk" $ENTTABLE 1
+
+new "snmpbulkwalk entPhysicalTable $perfnr rows"
+perf_walk "bulkwalk entPhysicalTable" "$snmpbulkwalk" $ENTTABLE $bulkrep
+
+new "snmpget ifDescr $perfreq random rows"
+perf_get "get ifDescr" $IFTABLE.1.2
+
+new "snmpget entPhysicalName $perfreq random rows"
+perf_get "get entPhysicalName" $ENTTABLE.1.7
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -2,6 +2,7 @@
 # Startup performance tests for different formats and startup modes.
 # Generate file in different formats:
 # xml, xml pretty-printed, xml with prefixes, json
+# Also write a binary startup datastore via the backend and start from it
 
 # Magic line must be first in script (see README.md)
 s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
@@ -18,6 +19,7 @@ sx=$dir/sx.xml
 sxpp=$dir/sxpp.xml
 sxpre=$dir/sxpre.xml
 sj=$dir/sj.xml
+fb=$dir/binary.xml
 
 # NOTE, added a deep yang structure (x0,x1,x2) to expose performance due to turned off caching.
 cat <<EOF > $fyang
@@ -159,6 +161,62 @@ for variant in prefix plain pretty; do
     { time -p sudo $clixon_backend -F1 -D $DBG -s $mode -f $cfg -y $fyang -o CLICON_XMLDB_FORMAT=$format 2> /dev/null; } 2>&1 | awk '/real/ {print $2}'
 done
 
+# Peak memory: max resident set size in KB, startup copies the startup tree once
+if [ -x /usr/bin/time ]; then
+    cp $sx $sdb
+    new "Startup $format peak RSS (KB)"
+    sudo /usr/bin/time -f "%M" $clixon_backend -F1 -D $DBG -s $mode -f $cfg -y $fyang -o CLICON_XMLDB_FORMAT=$format 2>&1 > /dev/null | tail -1
+fi
+
+# Binary format: the startup datastore is written by the backend
+format=binary
+if [ $BE -ne 0 ]; then
+    new "start backend -s init -f $cfg -o CLICON_XMLDB_FORMAT=$format"
+    start_backend -s init -f $cfg -y $fyang -o CLICON_XMLDB_FORMAT=$format
+fi
+
+new "wait backend"
+wait_backend
+
+rpc="<rpc $DEFAULTNS><edit-config><target><candidate/></target><config>"
+rpc+="$(sed -e 's/^<config>//' -e 's/<\/config>$//' $sx)"
+rpc+="</config></edit-config></rpc>"
+echo -n "$DEFAULTHELLO" > $fb
+echo "$(chunked_framing "$rpc")" >> $fb
+
+new "netconf write $perfnr entries"
+expecteof_file "$clixon_netconf -qef $cfg" 0 "$fb" "^<rpc-reply $DEFAULTNS><ok/></rpc-reply>$"
+
+new "netconf commit"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "netconf copy running to startup"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><copy-config><target><startup/></target><source><running/></source></copy-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    stop_backend -f $cfg
+fi
+
+new "Startup $format"
+{ time -p sudo $clixon_backend -F1 -D $DBG -s $mode -f $cfg -y $fyang -o CLICON_XMLDB_FORMAT=$format 2> /dev/null; } 2>&1 | awk '/real/ {print $2}'
+
+if [ $BE -ne 0 ]; then
+    new "start backend -s $mode -f $cfg -o CLICON_XMLDB_FORMAT=$format"
+    start_backend -s $mode -f $cfg -y $fyang -o CLICON_XMLDB_FORMAT=$format
+fi
+
+new "wait backend"
+wait_backend
+
+new "netconf get entry from binary startup"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source><filter type=\"xpath\" select=\"/ip:x0/ip:x1/ip:x2[ip:name='ip']/ip:x/ip:y[ip:a=42]\" xmlns:ip=\"urn:example:clixon\"/></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><x0 xmlns=\"urn:example:clixon\"><x1><x2><name>ip</name><x><y><a>42</a><b>42</b></y></x></x2></x1></x0></data></rpc-reply>"
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    stop_backend -f $cfg
+fi
+
 rm -rf $dir
 
 new "endtest"
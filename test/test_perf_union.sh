@@ -0,0 +1,156 @@
+#!/usr/bin/env bash
+# Union performance test
+# Create a yang with a list with <perfnr> entries of union leafs, with numeric, enumeration
+# and pattern member types, similar to test_union.sh but scaled up
+# See YANG_TYPE_VALIDATOR
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/union.yang
+file=$dir/myconfig.xml
+
+# Number of list entries in file
+: ${perfnr:=10000}
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>$dir</CLICON_YANG_DIR>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_CLISPEC_DIR>/usr/local/lib/$APPNAME/clispec</CLICON_CLISPEC_DIR>
+  <CLICON_CLI_DIR>/usr/local/lib/$APPNAME/cli</CLICON_CLI_DIR>
+  <CLICON_CLI_MODE>$APPNAME</CLICON_CLI_MODE>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_FEATURE>ietf-netconf:startup</CLICON_FEATURE>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module example {
+   yang-version 1.1;
+   namespace "urn:example:clixon";
+   prefix ex;
+   typedef bound {
+      type union {
+         type int32 {
+            range "4..44";
+         }
+         type enumeration {
+            enum unbounded;
+         }
+      }
+   }
+   typedef address {
+      type string {
+         pattern '(([0-9]|[1-9][0-9]|1[0-9][0-9]|2[0-4][0-9]|25[0-5])\.){3}([0-9]|[1-9][0-9]|1[0-9][0-9]|2[0-4][0-9]|25[0-5])';
+      }
+   }
+   container c {
+      list x {
+         key k;
+         leaf k {
+            type uint32;
+         }
+         leaf u {
+            type bound;
+         }
+         leaf a {
+            type union {
+               type enumeration {
+                  enum any;
+                  enum none;
+               }
+               type uint16;
+               type address;
+            }
+         }
+      }
+   }
+}
+EOF
+
+new "test params: -s startup -f $cfg"
+
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend  -s startup -f $cfg"
+    start_backend -s startup -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+new "Generate file"
+echo -n "<${DATASTORE_TOP}><c xmlns=\"urn:example:clixon\">" > $file
+for (( i=0; i<$perfnr; i++ )); do
+    case $(( i % 3 )) in
+        0) echo -n "<x><k>$i</k><u>$(( i % 40 + 4 ))</u><a>10.0.$(( i % 256 )).1</a></x>" >> $file ;;
+        1) echo -n "<x><k>$i</k><u>unbounded</u><a>$(( i % 65536 ))</a></x>" >> $file ;;
+        2) echo -n "<x><k>$i</k><u>44</u><a>any</a></x>" >> $file ;;
+    esac
+done
+echo "</c></${DATASTORE_TOP}>" >> $file
+
+new "Load file"
+expectpart "$($clixon_cli -1 -f $cfg load $file)" 0 "^$"
+
+new "Validate"
+time expectpart "$($clixon_cli -1 -f $cfg validate)" 0 "^$"
+
+new "Commit"
+time expectpart "$($clixon_cli -1 -f $cfg commit)" 0 "^$"
+
+# Negative tests, no member matches
+new "Set out of range union"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><c xmlns=\"urn:example:clixon\"><x><k>0</k><u>45</u></x></c></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "Validate out of range union expect fail"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><validate><source><candidate/></source></validate></rpc>" "<rpc-reply $DEFAULTNS><rpc-error><error-type>application</error-type><error-tag>bad-element</error-tag><error-info><bad-element>u</bad-element></error-info><error-severity>error</error-severity>" ""
+
+new "Discard"
+expectpart "$($clixon_cli -1 -f $cfg discard)" 0 "^$"
+
+new "Set non-matching address union"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><c xmlns=\"urn:example:clixon\"><x><k>0</k><a>10.0.0.256</a></x></c></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "Validate non-matching address union expect fail"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><validate><source><candidate/></source></validate></rpc>" "<rpc-reply $DEFAULTNS><rpc-error><error-type>application</error-type><error-tag>bad-element</error-tag><error-info><bad-element>a</bad-element></error-info><error-severity>error</error-severity>" ""
+
+new "Discard"
+expectpart "$($clixon_cli -1 -f $cfg discard)" 0 "^$"
+
+new "Set matching last member"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><c xmlns=\"urn:example:clixon\"><x><k>0</k><a>192.168.1.1</a></x></c></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "Validate ok"
+expectpart "$($clixon_cli -1 -f $cfg validate 2>&1)" 0 "^$"
+
+new "Discard"
+expectpart "$($clixon_cli -1 -f $cfg discard)" 0 "^$"
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -0,0 +1,184 @@
+#!/usr/bin/env bash
+# XML object vector (clixon_xvec) microbenchmark, see clixon_xml_vec.c
+# Compile and run a program that builds a sorted vector of <perfnr> entries in different
+# insert orders, as when building a search index, and removes them, and checks the result
+# If xvec_perf_max is set (usec), a phase taking longer than that is an error
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+cfile=$dir/xvec-bench.c
+app=$dir/xvec-bench
+
+# Number of entries
+: ${perfnr:=100000}
+
+# Max usec of any phase, unset: no regression check
+: ${xvec_perf_max:=}
+
+cat <<EOF > $cfile
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <sys/time.h>
+
+typedef struct xml cxobj; /* Opaque, only pointers are stored */
+#include <clixon/clixon_xml_vec.h>
+
+static struct timeval t0;
+
+static void
+phase(const char *name)
+{
+    struct timeval t;
+
+    gettimeofday(&t, NULL);
+    if (name){
+        timersub(&t, &t0, &t);
+        printf("%s usec:%lu\n", name, (unsigned long)(t.tv_sec*1000000 + t.tv_usec));
+    }
+    gettimeofday(&t0, NULL);
+}
+
+/* Entries are pointers into vec, ordered by address */
+static int
+check(clixon_xvec *xv,
+      cxobj      **vec,
+      int          n)
+{
+    int i;
+
+    if (clixon_xvec_len(xv) != n)
+        return -1;
+    for (i=0; i<n; i++)
+        if (clixon_xvec_i(xv, i) != vec[i])
+            return -1;
+    return 0;
+}
+
+/* Sorted insert using binary search, as the search index */
+static int
+insert_sorted(clixon_xvec *xv,
+              cxobj       *x)
+{
+    int low = 0;
+    int upper = clixon_xvec_len(xv);
+    int mid;
+
+    while (low < upper){
+        mid = (low + upper) / 2;
+        if ((uintptr_t)clixon_xvec_i(xv, mid) < (uintptr_t)x)
+            low = mid+1;
+        else
+            upper = mid;
+    }
+    return clixon_xvec_insert_pos(xv, x, low);
+}
+
+int
+main(int    argc,
+     char **argv)
+{
+    clixon_xvec *xv;
+    cxobj      **vec;
+    char        *mem;
+    int          n;
+    int          i;
+    int          j;
+
+    n = atoi(argv[1]);
+    if ((mem = calloc(n, 1)) == NULL || (vec = calloc(n, sizeof(cxobj*))) == NULL)
+        return 1;
+    for (i=0; i<n; i++)
+        vec[i] = (cxobj*)&mem[i];
+    /* Append in order */
+    if ((xv = clixon_xvec_new()) == NULL)
+        return 1;
+    phase(NULL);
+    for (i=0; i<n; i++)
+        if (insert_sorted(xv, vec[i]) < 0)
+            return 1;
+    phase("append");
+    if (check(xv, vec, n) < 0)
+        return 1;
+    clixon_xvec_free(xv);
+    /* Prepend, ie reverse order */
+    if ((xv = clixon_xvec_new()) == NULL)
+        return 1;
+    phase(NULL);
+    for (i=n-1; i>=0; i--)
+        if (insert_sorted(xv, vec[i]) < 0)
+            return 1;
+    phase("prepend");
+    if (check(xv, vec, n) < 0)
+        return 1;
+    clixon_xvec_free(xv);
+    /* Even entries, then odd entries in the middle, each next to the previous insert */
+    if ((xv = clixon_xvec_new()) == NULL)
+        return 1;
+    phase(NULL);
+    for (i=0; i<n; i+=2)
+        if (insert_sorted(xv, vec[i]) < 0)
+            return 1;
+    for (i=1; i<n; i+=2)
+        if (insert_sorted(xv, vec[i]) < 0)
+            return 1;
+    phase("middle");
+    if (check(xv, vec, n) < 0)
+        return 1;
+    /* Pseudo-random order */
+    clixon_xvec_free(xv);
+    if ((xv = clixon_xvec_new()) == NULL)
+        return 1;
+    phase(NULL);
+    for (i=0, j=0; i<n; i++, j=(j+7919)%n)
+        if (insert_sorted(xv, vec[j]) < 0)
+            return 1;
+    phase("random");
+    if (n%7919 && check(xv, vec, n) < 0)
+        return 1;
+    /* Remove from the front */
+    phase(NULL);
+    for (i=0; i<n; i++)
+        if (clixon_xvec_rm_pos(xv, 0) < 0)
+            return 1;
+    phase("rm");
+    if (clixon_xvec_len(xv) != 0)
+        return 1;
+    clixon_xvec_free(xv);
+    free(vec);
+    free(mem);
+    printf("ok\n");
+    return 0;
+}
+EOF
+
+new "compile $cfile -> $app"
+if [ "$LINKAGE" = static ]; then
+    COMPILE="$CC ${CFLAGS} -I/usr/local/include $cfile -o $app /usr/local/lib/libclixon${LIBSTATIC_SUFFIX} ${LIBS}"
+else
+    COMPILE="$CC ${CFLAGS} -I/usr/local/include $cfile -o $app -L /usr/local/lib -lclixon"
+fi
+echo "COMPILE:$COMPILE"
+expectpart "$($COMPILE)" 0 ""
+
+new "run $app $perfnr"
+ret=$($app $perfnr)
+if [ $? -ne 0 ]; then
+    err "ok" "$ret"
+fi
+echo "$ret"
+expectpart "$ret" 0 "^ok$"
+
+if [ -n "$xvec_perf_max" ]; then
+    for usec in $(echo "$ret" | sed -n 's/.* usec:\([0-9]*\)$/\1/p'); do
+        if [ $usec -gt $xvec_perf_max ]; then
+            err "usec <= $xvec_perf_max" "$ret"
+        fi
+    done
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -0,0 +1,156 @@
+#!/usr/bin/env bash
+# YANG load benchmark: time and memory per phase for IETF, OpenConfig and IEEE YANG sets
+# Phases: parse, grouping expansion, augment, post, autocli and datastore bind
+# See CLICON_YANG_PROFILE
+# Notes:
+# - Env variable YANG_STANDARD_DIR should point to yangmodels/standard (IETF and IEEE)
+# - Env variable OPENCONFIG should point to openconfig/public
+# - Sets whose dir does not exist are skipped
+# - If yang_perf_max is set (usec), a phase taking longer than that is an error
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/bench.yang
+file=$dir/startup_db
+
+# Number of list entries in startup datastore for bind phase
+: ${perfnr:=10000}
+
+# Max usec of any phase, unset: no regression check
+: ${yang_perf_max:=}
+
+# Check profile output of a run
+# Args:
+# 1: name of YANG set
+# 2: output of clixon_cli or clixon_backend with -l e
+function yang_profile_check()
+{
+    name=$1
+    ret=$2
+
+    prof=$(echo "$ret" | grep "YANG profile")
+    if [ -z "$prof" ]; then
+        err "YANG profile" "$ret"
+    fi
+    echo "$name:"
+    echo "$prof" | sed -e 's/^.*YANG profile /  /'
+    if [ -n "$yang_perf_max" ]; then
+        for usec in $(echo "$prof" | sed -n 's/.* usec:\([0-9]*\) .*/\1/p'); do
+            if [ $usec -gt $yang_perf_max ]; then
+                err "usec <= $yang_perf_max" "$prof"
+            fi
+        done
+    fi
+}
+
+# Run CLI on a YANG main dir and check profile
+# Args:
+# 1: name of YANG set
+# 2: main dir
+# 3: extra CLICON_YANG_DIR
+function yang_perf_set()
+{
+    name=$1
+    maindir=$2
+    yangdir=$3
+
+    if [ ! -d "$maindir" ]; then
+        echo "...skipped: $name dir $maindir does not exist"
+        return
+    fi
+    AUTOCLI=$(autocli_config \* kw-nokey false)
+    cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_FEATURE>ietf-netconf:startup</CLICON_FEATURE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_DIR>$yangdir</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_DIR>$maindir</CLICON_YANG_MAIN_DIR>
+  <CLICON_YANG_AUGMENT_ACCEPT_BROKEN>true</CLICON_YANG_AUGMENT_ACCEPT_BROKEN>
+  <CLICON_YANG_PROFILE>true</CLICON_YANG_PROFILE>
+  <CLICON_CLISPEC_DIR>/usr/local/lib/$APPNAME/clispec</CLICON_CLISPEC_DIR>
+  <CLICON_CLI_DIR>/usr/local/lib/$APPNAME/cli</CLICON_CLI_DIR>
+  <CLICON_CLI_MODE>$APPNAME</CLICON_CLI_MODE>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  ${AUTOCLI}
+</clixon-config>
+EOF
+    new "$name: $clixon_cli -1 -l e -f $cfg show version"
+    ret=$($clixon_cli -1 -l e -f $cfg show version 2>&1)
+    if [ $? -ne 0 ]; then
+        err "$name" "$ret"
+    fi
+    yang_profile_check "$name" "$ret"
+}
+
+yang_perf_set ietf "${YANG_STANDARD_DIR}/ietf/RFC" "${YANG_STANDARD_DIR}/iana"
+yang_perf_set openconfig "${OPENCONFIG}/release/models" "${OPENCONFIG}"
+yang_perf_set ieee "${YANG_STANDARD_DIR}/ieee/published" "${YANG_STANDARD_DIR}/ietf/RFC"
+
+# Datastore bind phase of backend startup
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>$dir</CLICON_YANG_DIR>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_YANG_PROFILE>true</CLICON_YANG_PROFILE>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_FEATURE>ietf-netconf:startup</CLICON_FEATURE>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module bench{
+   yang-version 1.1;
+   namespace "urn:example:bench";
+   prefix ex;
+   grouping entry{
+      leaf k{
+         type uint32;
+      }
+      leaf v{
+         type string;
+      }
+   }
+   container c{
+      list x{
+         key k;
+         uses entry;
+      }
+   }
+}
+EOF
+
+new "Generate startup with $perfnr entries"
+echo -n "<${DATASTORE_TOP}><c xmlns=\"urn:example:bench\">" > $file
+for (( i=0; i<$perfnr; i++ )); do
+    echo -n "<x><k>$i</k><v>$i</v></x>" >> $file
+done
+echo "</c></${DATASTORE_TOP}>" >> $file
+
+new "kill old backend"
+sudo clixon_backend -zf $cfg
+if [ $? -ne 0 ]; then
+    err
+fi
+
+new "bind: $clixon_backend -1 -l e -s startup -f $cfg"
+ret=$(sudo $clixon_backend -1 -l e -s startup -f $cfg 2>&1)
+if [ $? -ne 0 ]; then
+    err "bind" "$ret"
+fi
+yang_profile_check bind "$ret"
+
+rm -rf $dir
+
+new "endtest"
+endtest
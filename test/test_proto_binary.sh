@@ -0,0 +1,118 @@
+#!/usr/bin/env bash
+# Binary replies on the internal socket, see CLICON_SOCK_BINARY
+# Check that get and get-config replies are the same as with XML replies, for whole
+# trees, xpath filters of the datastore cache, state data and with-defaults
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/binary.yang
+
+AUTOCLI=$(autocli_config binary\* kw-nokey false)
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>$dir</CLICON_YANG_DIR>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_CLISPEC_DIR>/usr/local/lib/$APPNAME/clispec</CLICON_CLISPEC_DIR>
+  <CLICON_CLI_DIR>/usr/local/lib/$APPNAME/cli</CLICON_CLI_DIR>
+  <CLICON_CLI_MODE>$APPNAME</CLICON_CLI_MODE>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_SOCK_BINARY>true</CLICON_SOCK_BINARY>
+  ${AUTOCLI}
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module binary{
+    yang-version 1.1;
+    namespace "urn:example:binary";
+    prefix ex;
+    container c{
+        list x{
+            key k;
+            leaf k{
+                type string;
+            }
+            leaf v{
+                type string;
+            }
+            leaf d{
+                type uint32;
+                default 7;
+            }
+        }
+    }
+}
+EOF
+
+new "test params: -f $cfg"
+
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+new "add entries"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><c xmlns=\"urn:example:binary\"><x><k>a</k><v>1</v></x><x><k>b</k><v>&lt;2&amp;</v></x></c></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "commit"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "get-config running"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><c xmlns=\"urn:example:binary\"><x><k>a</k><v>1</v></x><x><k>b</k><v>&lt;2&amp;</v></x></c></data></rpc-reply>"
+
+new "get-config xpath filter"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source><filter type=\"xpath\" select=\"/ex:c/ex:x[ex:k='b']/ex:v\" xmlns:ex=\"urn:example:binary\"/></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><c xmlns=\"urn:example:binary\"><x><k>b</k><v>&lt;2&amp;</v></x></c></data></rpc-reply>"
+
+new "get-config no match"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source><filter type=\"xpath\" select=\"/ex:c/ex:x[ex:k='z']\" xmlns:ex=\"urn:example:binary\"/></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data/></rpc-reply>"
+
+new "get report-all"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get><filter type=\"xpath\" select=\"/ex:c/ex:x[ex:k='a']\" xmlns:ex=\"urn:example:binary\"/><with-defaults xmlns=\"urn:ietf:params:xml:ns:yang:ietf-netconf-with-defaults\">report-all</with-defaults></get></rpc>" "" "<rpc-reply $DEFAULTNS><data><c xmlns=\"urn:example:binary\"><x><k>a</k><v>1</v><d>7</d></x></c></data></rpc-reply>"
+
+new "get report-all-tagged"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get><filter type=\"xpath\" select=\"/ex:c/ex:x[ex:k='a']/ex:d\" xmlns:ex=\"urn:example:binary\"/><with-defaults xmlns=\"urn:ietf:params:xml:ns:yang:ietf-netconf-with-defaults\">report-all-tagged</with-defaults></get></rpc>" "" "<rpc-reply $DEFAULTNS><data><c xmlns=\"urn:example:binary\"><x><k>a</k><d xmlns:wd=\"urn:ietf:params:xml:ns:netconf:default:1.0\" wd:default=\"true\">7</d></x></c></data></rpc-reply>"
+
+new "cli show config"
+expectpart "$($clixon_cli -1 -f $cfg show config xml)" 0 "<c xmlns=\"urn:example:binary\">" "<k>b</k>" "<v>&lt;2&amp;</v>"
+
+new "cli set"
+expectpart "$($clixon_cli -1 -f $cfg set c x c v 3)" 0 "^$"
+
+new "cli show candidate"
+expectpart "$($clixon_cli -1 -f $cfg show config xml)" 0 "<k>a</k>" "<k>b</k>" "<k>c</k>" "<v>3</v>"
+
+new "discard"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><discard-changes/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -0,0 +1,113 @@
+#!/usr/bin/env bash
+# Large backend replies sent in chunks while printed, see CLICON_BACKEND_REPLY_STREAM
+# Run the same gets without and with streaming with a small chunk size, and check that the
+# replies are the same: large replies, small replies, and two pipelined requests.
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+# Backend must be started by the test
+if [ $BE -eq 0 ]; then
+    echo "...skipped: must run with backend"
+    rm -rf $dir
+    if [ "$s" = $0 ]; then exit 0; else return 0; fi
+fi
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/clixon-example.yang
+
+# Number of list entries
+: ${perfnr:=1000}
+
+# Chunk size
+chunk=1024
+
+cat <<EOF > $fyang
+module clixon-example{
+    yang-version 1.1;
+    namespace "urn:example:clixon";
+    prefix ex;
+    container c {
+        list item {
+            key name;
+            leaf name {
+                type int32;
+            }
+            leaf value {
+                type string;
+            }
+        }
+    }
+}
+EOF
+
+function rpc()
+{
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS>$1</rpc>" "" "<rpc-reply $DEFAULTNS>$2</rpc-reply>"
+}
+
+C=""
+for (( i=0; i<$perfnr; i++ )); do
+    C="$C<item><name>$i</name><value>value$i</value></item>"
+done
+
+for stream in 0 $chunk; do
+    cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_BACKEND_DIR>/usr/local/lib/$APPNAME/backend</CLICON_BACKEND_DIR>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_YANG_LIBRARY>false</CLICON_YANG_LIBRARY>
+  <CLICON_BACKEND_REPLY_STREAM>$stream</CLICON_BACKEND_REPLY_STREAM>
+</clixon-config>
+EOF
+
+    new "test params: -f $cfg"
+
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+
+    new "wait backend"
+    wait_backend
+
+    new "stream $stream: add $perfnr entries"
+    rpc "<edit-config><target><candidate/></target><config><c xmlns=\"urn:example:clixon\">$C</c></config></edit-config>" "<ok/>"
+    rpc "<commit/>" "<ok/>"
+
+    new "stream $stream: get-config running"
+    rpc "<get-config><source><running/></source></get-config>" "<data><c xmlns=\"urn:example:clixon\">$C</c></data>"
+
+    new "stream $stream: get config"
+    rpc "<get content=\"config\" xmlns:ex=\"urn:example:clixon\"><filter type=\"xpath\" select=\"/ex:c\"/></get>" "<data><c xmlns=\"urn:example:clixon\">$C</c></data>"
+
+    new "stream $stream: get-config one entry"
+    rpc "<get-config><source><running/></source><filter type=\"xpath\" select=\"/ex:c/ex:item[ex:name=7]\" xmlns:ex=\"urn:example:clixon\"/></get-config>" "<data><c xmlns=\"urn:example:clixon\"><item><name>7</name><value>value7</value></item></c></data>"
+
+    new "stream $stream: two pipelined get-config"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO$(chunked_framing "<rpc $DEFAULTNS><get-config><source><running/></source></get-config></rpc>")" "<rpc $DEFAULTNS><get-config><source><candidate/></source><filter type=\"xpath\" select=\"/ex:c/ex:item[ex:name=7]\" xmlns:ex=\"urn:example:clixon\"/></get-config></rpc>" "<rpc-reply $DEFAULTNS><data><c xmlns=\"urn:example:clixon\"><item><name>0</name><value>value0</value></item>" "<rpc-reply $DEFAULTNS><data><c xmlns=\"urn:example:clixon\"><item><name>7</name><value>value7</value></item></c></data></rpc-reply>"
+
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+done
+
+rm -rf $dir
+
+new "endtest"
+endtest
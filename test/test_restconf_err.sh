@@ -243,7 +243,15 @@ Host: localhost
 Accept: application/yang-data+xml
 
 EOF
-)" 0 "HTTP/$HVER 405" # nginx uses "method not allowed" 
+)" 0 "HTTP/$HVER 405" # nginx uses "method not allowed"
+
+    if [ "${WITH_RESTCONF}" = "native" ]; then
+        new "netcat restconf GET with header fields split over two writes"
+        expectpart "$( (printf "GET /restconf/data/example:a=0 HTTP/$HVER\r\nHost: loc"; sleep 0.5; printf "alhost\r\nAccept: application/yang-data+xml\r\n\r\n") | ${netcat} 127.0.0.1 80)" 0 "HTTP/$HVER 200" "$XML"
+
+        new "netcat restconf GET invalid header field name"
+        expectpart "$(printf "GET /restconf/data/example:a=0 HTTP/$HVER\r\nHost: localhost\r\nAcc ept: application/yang-data+xml\r\n\r\n" | ${netcat} 127.0.0.1 80)" 0 "HTTP/$HVER 400" "Invalid header field name"
+    fi
 
 if false; then # XXX >50% does not work on docker alpine
     new "netcat restconf GET wrong http version raw"
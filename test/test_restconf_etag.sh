@@ -0,0 +1,132 @@
+#!/usr/bin/env bash
+# RESTCONF entity-tags and conditional GET of config data, see CLICON_RESTCONF_ETAG
+# ETag and Last-Modified are derived from the generation of running
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf.xml
+fyang=$dir/cond.yang
+
+# Define default restconfig config: RESTCONFIG
+RESTCONFIG=$(restconf_config none false)
+if [ $? -ne 0 ]; then
+    err1 "Error when generating certs"
+fi
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_FEATURE>clixon-restconf:allow-auth-none</CLICON_FEATURE> <!-- Use auth-type=none -->
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_RESTCONF_ETAG>true</CLICON_RESTCONF_ETAG>
+  $RESTCONFIG
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module cond{
+   yang-version 1.1;
+   namespace "urn:example:cond";
+   prefix ex;
+   container table{
+      list parameter{
+         key name;
+         leaf name{
+            type string;
+         }
+         leaf value{
+            type string;
+         }
+      }
+   }
+}
+EOF
+
+new "test params: -f $cfg"
+
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    sudo pkill -f clixon_backend # to be sure
+
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+if [ $RC -ne 0 ]; then
+    new "kill old restconf daemon"
+    stop_restconf_pre
+
+    new "start restconf daemon"
+    start_restconf -f $cfg
+fi
+
+new "wait restconf"
+wait_restconf
+
+new "generation rpc"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><generation $LIBNS/></rpc>" "<rpc-reply $DEFAULTNS><generation $LIBNS>[0-9]*</generation><last-modified $LIBNS>" ""
+
+new "restconf POST initial"
+expectpart "$(curl $CURLOPTS -X POST -H "Content-Type: application/yang-data+json" -d '{"cond:table":{"parameter":[{"name":"A","value":"0"}]}}' $RCPROTO://localhost/restconf/data)" 0 "HTTP/$HVER 201"
+
+new "restconf GET config with ETag and Last-Modified"
+ret=$(curl $CURLOPTS -X GET "$RCPROTO://localhost/restconf/data/cond:table/parameter=A?content=config")
+expectpart "$ret" 0 "HTTP/$HVER 200" "ETag: \"" "Last-Modified: " '{"cond:parameter":\[{"name":"A","value":"0"}\]}'
+etag=$(echo "$ret" | grep -i "^etag:" | awk '{print $2}' | tr -d '\r')
+lastmod=$(echo "$ret" | grep -i "^last-modified:" | cut -d' ' -f2- | tr -d '\r')
+
+new "restconf GET without content=config has no ETag"
+expectpart "$(curl $CURLOPTS -X GET $RCPROTO://localhost/restconf/data/cond:table/parameter=A)" 0 "HTTP/$HVER 200" --not-- "ETag:"
+
+new "restconf GET If-None-Match unchanged: 304"
+expectpart "$(curl $CURLOPTS -X GET -H "If-None-Match: $etag" "$RCPROTO://localhost/restconf/data/cond:table/parameter=A?content=config")" 0 "HTTP/$HVER 304" "ETag: $etag" --not-- "cond:parameter"
+
+new "restconf GET If-None-Match weak in list unchanged: 304"
+expectpart "$(curl $CURLOPTS -X GET -H "If-None-Match: \"x\", W/$etag" "$RCPROTO://localhost/restconf/data/cond:table/parameter=A?content=config")" 0 "HTTP/$HVER 304"
+
+new "restconf GET If-None-Match other representation: 200"
+expectpart "$(curl $CURLOPTS -X GET -H "Accept: application/yang-data+xml" -H "If-None-Match: $etag" "$RCPROTO://localhost/restconf/data/cond:table/parameter=A?content=config")" 0 "HTTP/$HVER 200" "<parameter xmlns=\"urn:example:cond\"><name>A</name><value>0</value></parameter>"
+
+new "restconf GET If-Modified-Since unchanged: 304"
+expectpart "$(curl $CURLOPTS -X GET -H "If-Modified-Since: $lastmod" "$RCPROTO://localhost/restconf/data/cond:table/parameter=A?content=config")" 0 "HTTP/$HVER 304"
+
+new "restconf PUT change"
+expectpart "$(curl $CURLOPTS -X PUT -H "Content-Type: application/yang-data+json" -d '{"cond:parameter":[{"name":"A","value":"1"}]}' $RCPROTO://localhost/restconf/data/cond:table/parameter=A)" 0 "HTTP/$HVER 204"
+
+new "restconf GET If-None-Match changed: 200"
+expectpart "$(curl $CURLOPTS -X GET -H "If-None-Match: $etag" "$RCPROTO://localhost/restconf/data/cond:table/parameter=A?content=config")" 0 "HTTP/$HVER 200" "ETag: \"" '{"cond:parameter":\[{"name":"A","value":"1"}\]}'
+
+if [ $RC -ne 0 ]; then
+    new "Kill restconf daemon"
+    stop_restconf
+fi
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
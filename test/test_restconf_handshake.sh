@@ -0,0 +1,137 @@
+#!/usr/bin/env bash
+# Native RESTCONF TLS handshake in the event loop
+# Clients that connect and do not complete the TLS handshake, either sending nothing or
+# only the start of a ClientHello, do not block the restconf daemon: other requests are
+# served meanwhile. The stalled clients are closed after the handshake timeout,
+# RESTCONF_HANDSHAKE_TIMEOUT in apps/restconf/restconf_native.c.
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+# Only works with native and https
+if [ "${WITH_RESTCONF}" != "native" ]; then
+    rm -rf $dir
+    if [ "$s" = $0 ]; then exit 0; else return 0; fi # skip
+fi
+
+# Backend and restconf must be started by the test
+if [ $BE -eq 0 -o $RC -eq 0 ]; then
+    echo "...skipped: must run with backend and restconf"
+    rm -rf $dir
+    if [ "$s" = $0 ]; then exit 0; else return 0; fi
+fi
+
+RCPROTO=https
+APPNAME=example
+
+cfg=$dir/conf.xml
+fyang=$dir/clixon-example.yang
+
+# Handshake timeout in seconds, see RESTCONF_HANDSHAKE_TIMEOUT
+htimeout=10
+
+# Define default restconfig config: RESTCONFIG
+# Its idle timeout is longer than the handshake timeout
+RESTCONFIG=$(restconf_config none false)
+if [ $? -ne 0 ]; then
+    err1 "Error when generating certs"
+fi
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_FEATURE>clixon-restconf:allow-auth-none</CLICON_FEATURE> <!-- Use auth-type=none -->
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_YANG_LIBRARY>false</CLICON_YANG_LIBRARY>
+  $RESTCONFIG
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module clixon-example{
+    yang-version 1.1;
+    namespace "urn:example:clixon";
+    prefix ex;
+    container c {
+        leaf x {
+            type int32;
+        }
+    }
+}
+EOF
+
+new "test params: -f $cfg"
+
+new "kill old backend"
+sudo clixon_backend -zf $cfg
+if [ $? -ne 0 ]; then
+    err
+fi
+new "start backend -s init -f $cfg"
+start_backend -s init -f $cfg
+
+new "wait backend"
+wait_backend
+
+new "kill old restconf daemon"
+stop_restconf_pre
+
+new "start restconf daemon"
+start_restconf -f $cfg
+
+new "wait restconf"
+wait_restconf
+
+new "put x"
+expectpart "$(curl $CURLOPTS -X PUT -H 'Content-Type: application/yang-data+json' $RCPROTO://localhost/restconf/data/clixon-example:c -d '{"clixon-example:c":{"x":42}}')" 0 "HTTP/$HVER 201"
+
+new "connect without handshake"
+exec 3<>/dev/tcp/127.0.0.1/443
+start=$SECONDS
+
+new "connect with start of ClientHello"
+exec 4<>/dev/tcp/127.0.0.1/443
+printf '\x16\x03\x01\x02\x00\x01' >&4
+
+for i in 1 2 3; do
+    new "get x while handshakes are stalled $i"
+    expectpart "$(curl $CURLOPTS -m 5 -X GET $RCPROTO://localhost/restconf/data/clixon-example:c)" 0 "HTTP/$HVER 200" '{"clixon-example:c":{"x":42}}'
+done
+
+new "stalled clients are closed after handshake timeout"
+for fd in 3 4; do
+    timeout $((htimeout+5)) cat <&$fd > /dev/null 2>&1
+    if [ $? -eq 124 ]; then
+        err "closed within $((htimeout+5))s" "open"
+    fi
+done
+t=$((SECONDS-start))
+if [ $t -lt $((htimeout-1)) ]; then
+    err "closed after ${htimeout}s" "closed after ${t}s"
+fi
+exec 3<&-
+exec 4<&-
+
+new "get x after timeout"
+expectpart "$(curl $CURLOPTS -X GET $RCPROTO://localhost/restconf/data/clixon-example:c)" 0 "HTTP/$HVER 200" '{"clixon-example:c":{"x":42}}'
+
+new "Kill restconf daemon"
+stop_restconf
+
+new "Kill backend"
+# Check if premature kill
+pid=$(pgrep -u root -f clixon_backend)
+if [ -z "$pid" ]; then
+    err "backend already dead"
+fi
+# kill backend
+stop_backend -f $cfg
+
+rm -rf $dir
+
+new "endtest"
+endtest
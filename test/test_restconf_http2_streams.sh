@@ -0,0 +1,184 @@
+#!/usr/bin/env bash
+# Concurrent RESTCONF GET streams over one HTTP/2 connection
+# A GET on an HTTP/2 stream is replied when the backend replies, and other streams are
+# served meanwhile, see restconf_reply_defer().
+# The state data of the example backend plugin is delivered after a delay (-D): GETs of
+# config data on other streams of the same connection are replied before the state GET,
+# and several state GETs are made concurrently.
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+# Only works with native and http/2
+if [ "${WITH_RESTCONF}" != "native" -o ${HVER} != 2 ]; then
+    rm -rf $dir
+    if [ "$s" = $0 ]; then exit 0; else return 0; fi # skip
+fi
+
+# Backend and restconf must be started by the test
+if [ $BE -eq 0 -o $RC -eq 0 ]; then
+    echo "...skipped: must run with backend and restconf"
+    rm -rf $dir
+    if [ "$s" = $0 ]; then exit 0; else return 0; fi
+fi
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/clixon-example.yang
+fout=$dir/curl.out
+
+# Delay of state data in ms
+: ${delay:=2000}
+
+# Number of concurrent streams
+nr=4
+
+# Define default restconfig config: RESTCONFIG
+RESTCONFIG=$(restconf_config none false)
+if [ $? -ne 0 ]; then
+    err1 "Error when generating certs"
+fi
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_FEATURE>clixon-restconf:allow-auth-none</CLICON_FEATURE> <!-- Use auth-type=none -->
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_DIR>$IETFRFC</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_BACKEND_DIR>/usr/local/lib/$APPNAME/backend</CLICON_BACKEND_DIR>
+  <CLICON_BACKEND_REGEXP>example_backend.so$</CLICON_BACKEND_REGEXP>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_YANG_LIBRARY>false</CLICON_YANG_LIBRARY>
+  <CLICON_STATE_ASYNC_TIMEOUT>$((4*delay))</CLICON_STATE_ASYNC_TIMEOUT>
+  $RESTCONFIG
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module clixon-example{
+    yang-version 1.1;
+    namespace "urn:example:clixon";
+    prefix ex;
+    import ietf-interfaces {
+        prefix if;
+    }
+    identity eth {
+        base if:interface-type;
+    }
+    augment "/if:interfaces/if:interface" {
+        container my-status {
+            config false;
+            leaf int {
+                type int32;
+            }
+            leaf str {
+                type string;
+            }
+        }
+    }
+}
+EOF
+
+# Time in seconds of transfer to file $1 in curl -w output
+function ttime()
+{
+    awk -v f=$1 '$1 == f {print $2}' $fout
+}
+
+# Check that time $1 is less than $2 seconds
+function lessthan()
+{
+    if ! awk -v t=$1 -v m=$2 'BEGIN {exit !(t < m)}'; then
+        err "less than $2s" "$1s"
+    fi
+}
+
+new "test params: -f $cfg -- -s -D $delay"
+
+new "kill old backend"
+sudo clixon_backend -zf $cfg
+if [ $? -ne 0 ]; then
+    err
+fi
+new "start backend -s init -f $cfg -- -s -D $delay"
+start_backend -s init -f $cfg -- -s -D $delay
+
+new "wait backend"
+wait_backend
+
+new "kill old restconf daemon"
+stop_restconf_pre
+
+new "start restconf daemon"
+start_restconf -f $cfg
+
+new "wait restconf"
+wait_restconf
+
+new "add interfaces eth0 and eth1"
+expectpart "$(curl $CURLOPTS -X POST -H 'Content-Type: application/yang-data+json' $RCPROTO://localhost/restconf/data -d '{"ietf-interfaces:interfaces":{"interface":[{"name":"eth0","type":"clixon-example:eth"},{"name":"eth1","type":"clixon-example:eth"}]}}')" 0 "HTTP/$HVER 201"
+
+new "state GET and $nr config GETs on one connection"
+U="$RCPROTO://localhost/restconf/data/ietf-interfaces:interfaces/interface=eth1/clixon-example:my-status -o $dir/state"
+for (( i=0; i<$nr; i++ )); do
+    U="$U $RCPROTO://localhost/restconf/data/ietf-interfaces:interfaces/interface=eth0?content=config -o $dir/config$i"
+done
+curl $CURLOPTS -Z -X GET -w "%{filename_effective} %{time_total} %{num_connects}\n" $U > $fout
+
+new "one connection"
+n=$(awk '{s += $3} END {print s}' $fout)
+if [ "$n" != 1 ]; then
+    err "1" "$n"
+fi
+
+new "state GET is replied with state data"
+expectpart "$(cat $dir/state)" 0 "HTTP/$HVER 200" '{"clixon-example:my-status":{"int":42,"str":"foo"}}'
+
+new "state GET waits for state data"
+if awk -v t=$(ttime $dir/state) -v m=$((delay/1000)) 'BEGIN {exit !(t < m)}'; then
+    err "at least $((delay/1000))s" "$(ttime $dir/state)s"
+fi
+
+for (( i=0; i<$nr; i++ )); do
+    new "config GET $i is replied"
+    expectpart "$(cat $dir/config$i)" 0 "HTTP/$HVER 200" '{"ietf-interfaces:interface":\[{"name":"eth0","type":"clixon-example:eth","enabled":true}\]}'
+
+    new "config GET $i is replied before state GET"
+    lessthan $(ttime $dir/config$i) $((delay/1000))
+done
+
+new "$nr concurrent state GETs on one connection"
+U=""
+for (( i=0; i<$nr; i++ )); do
+    U="$U $RCPROTO://localhost/restconf/data/ietf-interfaces:interfaces/interface=eth$((i%2))/clixon-example:my-status -o $dir/state$i"
+done
+curl $CURLOPTS -Z -X GET -w "%{filename_effective} %{time_total} %{num_connects}\n" $U > $fout
+
+for (( i=0; i<$nr; i++ )); do
+    new "state GET $i is replied"
+    expectpart "$(cat $dir/state$i)" 0 "HTTP/$HVER 200" '{"clixon-example:my-status":{"int":42,"str":"foo"}}'
+
+    new "state GET $i is made concurrently"
+    lessthan $(ttime $dir/state$i) $((2*delay/1000))
+done
+
+new "Kill restconf daemon"
+stop_restconf
+
+new "Kill backend"
+# Check if premature kill
+pid=$(pgrep -u root -f clixon_backend)
+if [ -z "$pid" ]; then
+    err "backend already dead"
+fi
+# kill backend
+stop_backend -f $cfg
+
+rm -rf $dir
+
+new "endtest"
+endtest
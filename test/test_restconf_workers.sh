@@ -0,0 +1,146 @@
+#!/usr/bin/env bash
+# Restconf with several worker processes, see CLICON_RESTCONF_WORKERS
+# Send requests to the workers, kill a worker and check that it is restarted
+# Native workers share the listen sockets, fcgi workers share the fcgi socket
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf.xml
+fyang=$dir/restconf.yang
+
+# Number of restconf workers
+nr=3
+
+# Define default restconfig config: RESTCONFIG
+RESTCONFIG=$(restconf_config none false)
+if [ $? -ne 0 ]; then
+    err1 "Error when generating certs"
+fi
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_FEATURE>clixon-restconf:allow-auth-none</CLICON_FEATURE> <!-- Use auth-type=none -->
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>/usr/local/share/clixon</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>$dir/restconf.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>/usr/local/var/$APPNAME</CLICON_XMLDB_DIR>
+  <CLICON_RESTCONF_WORKERS>$nr</CLICON_RESTCONF_WORKERS>
+  $RESTCONFIG
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module example{
+   yang-version 1.1;
+   namespace "urn:example:clixon";
+   prefix ex;
+   container table{
+      list parameter{
+         key name;
+         leaf name{
+            type string;
+         }
+         leaf value{
+            type string;
+         }
+      }
+   }
+}
+EOF
+
+new "test params: -f $cfg"
+
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    sudo pkill -f clixon_backend # to be sure
+
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+if [ $RC -ne 0 ]; then
+    new "kill old restconf daemon"
+    stop_restconf_pre
+
+    new "start restconf daemon"
+    start_restconf -f $cfg
+fi
+
+new "wait restconf"
+wait_restconf
+
+if [ $RC -ne 0 ]; then
+    new "check $nr workers and supervisor"
+    n=$(pgrep -f clixon_restconf | wc -l)
+    if [ $n -ne $((nr+1)) ]; then
+        err "$((nr+1))" "$n"
+    fi
+fi
+
+new "restconf POST initial"
+expectpart "$(curl $CURLOPTS -X POST -H "Content-Type: application/yang-data+json" -d '{"example:table":{"parameter":[{"name":"A","value":"0"}]}}' $RCPROTO://localhost/restconf/data)" 0 "HTTP/$HVER 201"
+
+for (( i=0; i<10; i++ )); do
+    new "restconf PUT $i"
+    expectpart "$(curl $CURLOPTS -X PUT -H "Content-Type: application/yang-data+json" -d "{\"example:parameter\":[{\"name\":\"A\",\"value\":\"$i\"}]}" $RCPROTO://localhost/restconf/data/example:table/parameter=A)" 0 "HTTP/$HVER 204"
+
+    new "restconf GET $i"
+    expectpart "$(curl $CURLOPTS -X GET $RCPROTO://localhost/restconf/data/example:table/parameter=A)" 0 "HTTP/$HVER 200" "{\"example:parameter\":\[{\"name\":\"A\",\"value\":\"$i\"}\]}"
+done
+
+if [ $RC -ne 0 ]; then
+    new "kill one worker"
+    pid=$(pgrep -n -f clixon_restconf)
+    sudo kill -9 $pid
+
+    sleep $DEMSLEEP
+    sleep 1
+
+    new "check worker restarted"
+    n=$(pgrep -f clixon_restconf | wc -l)
+    if [ $n -ne $((nr+1)) ]; then
+        err "$((nr+1))" "$n"
+    fi
+fi
+
+new "restconf GET after worker restart"
+expectpart "$(curl $CURLOPTS -X GET $RCPROTO://localhost/restconf/data/example:table/parameter=A)" 0 "HTTP/$HVER 200" '{"example:parameter":\[{"name":"A","value":"9"}\]}'
+
+if [ $RC -ne 0 ]; then
+    new "Kill restconf daemon"
+    stop_restconf
+
+    new "check no workers left"
+    n=$(pgrep -f clixon_restconf | wc -l)
+    if [ $n -ne 0 ]; then
+        err "0" "$n"
+    fi
+fi
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -213,7 +213,47 @@ REQ='{
   }
 }'
 new "RFC 8072 YANG Patch JSON: Error."
-expectpart "$(curl -u andy:bar $CURLOPTS -X PATCH -H 'Content-Type: application/yang-patch+json' -H 'Accept: application/yang-patch+json' $RCPROTO://localhost/restconf/data/ietf-interfaces:interfaces -d "$REQ")" 0 "HTTP/$HVER 204"
+expectpart "$(curl -u andy:bar $CURLOPTS -X PATCH -H 'Content-Type: application/yang-patch+json' -H 'Accept: application/yang-patch+json' $RCPROTO://localhost/restconf/data/ietf-interfaces:interfaces -d "$REQ")" 0 "HTTP/$HVER 200"
+
+# Create eth3 and then eth2 which exists: the second edit fails, nothing is applied
+REQ='{
+  "ietf-yang-patch:yang-patch": {
+    "patch-id": "exists-patch",
+    "edit": [
+      {
+        "edit-id": "edit-1",
+        "operation": "create",
+        "target": "/interface=eth3",
+        "value": {
+          "interface": [
+            {
+              "name": "eth3",
+              "type": "iana-if-type:atm"
+            }
+          ]
+        }
+      },
+      {
+        "edit-id": "edit-2",
+        "operation": "create",
+        "target": "/interface=eth2",
+        "value": {
+          "interface": [
+            {
+              "name": "eth2",
+              "type": "iana-if-type:atm"
+            }
+          ]
+        }
+      }
+    ]
+  }
+}'
+new "RFC 8072 YANG Patch JSON: edit error in yang-patch-status"
+expectpart "$(curl -u andy:bar $CURLOPTS -X PATCH -H 'Content-Type: application/yang-patch+json' -H 'Accept: application/yang-patch+json' $RCPROTO://localhost/restconf/data/ietf-interfaces:interfaces -d "$REQ")" 0 "HTTP/$HVER 409" '{"ietf-yang-patch:yang-patch-status":{"patch-id":"exists-patch","edit-status":{"edit":\[{"edit-id":"edit-2","errors":{"error":{"error-type":"application","error-tag":"data-exists"'
+
+new "RFC 8072 YANG Patch JSON: failed patch not applied"
+expectpart "$(curl -u andy:bar $CURLOPTS -X GET $RCPROTO://localhost/restconf/data/ietf-interfaces:interfaces/interface=eth3)" 0 "HTTP/$HVER 404"
 #
 # Create artist in jukebox example
 REQ='{"example-jukebox:artist":[{"name":"Foo Fighters"}]}'
@@ -308,7 +348,7 @@ REQ='{
   }
 }'
 new "RFC 8072 YANG Patch JSON jukebox example: Error."
-expectpart "$(curl -u andy:bar $CURLOPTS -X PATCH -H 'Content-Type: application/yang-patch+json' -H 'Accept: application/yang-patch+json' $RCPROTO://localhost/restconf/data/example-jukebox:jukebox/playlist=Foo-One -d "$REQ")" 0 "HTTP/$HVER 201"
+expectpart "$(curl -u andy:bar $CURLOPTS -X PATCH -H 'Content-Type: application/yang-patch+json' -H 'Accept: application/yang-patch+json' $RCPROTO://localhost/restconf/data/example-jukebox:jukebox/playlist=Foo-One -d "$REQ")" 0 "HTTP/$HVER 200"
 
 # Uncomment to get info about playlist in jukebox example
 #new "RFC 8072 YANG Patch jukebox example get : Error."
@@ -0,0 +1,129 @@
+#!/usr/bin/env bash
+# Asynchronous rpc handlers in the backend
+# The example rpc of the example backend plugin is replied after a delay using
+# clixon_plugin_rpc_async(), while other clients are served
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+# Backend must be started by the test
+if [ $BE -eq 0 ]; then
+    echo "...skipped: must run with backend"
+    rm -rf $dir
+    if [ "$s" = $0 ]; then exit 0; else return 0; fi
+fi
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/clixon-example.yang
+fout=$dir/async.out
+
+# Delay of example rpc reply in ms, times out after twice the delay
+: ${delay:=2000}
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>$dir</CLICON_YANG_DIR>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_BACKEND_DIR>/usr/local/lib/$APPNAME/backend</CLICON_BACKEND_DIR>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_YANG_LIBRARY>false</CLICON_YANG_LIBRARY>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module clixon-example{
+    yang-version 1.1;
+    namespace "urn:example:clixon";
+    prefix ex;
+    rpc empty {
+    }
+    rpc example {
+        input {
+            leaf x {
+                type string;
+                mandatory true;
+            }
+            leaf y {
+                type string;
+                default "42";
+            }
+        }
+        output {
+            leaf x {
+                type string;
+            }
+            leaf y {
+                type string;
+            }
+        }
+    }
+}
+EOF
+
+new "test params: -f $cfg -- -A $delay"
+
+new "kill old backend"
+sudo clixon_backend -zf $cfg
+if [ $? -ne 0 ]; then
+    err
+fi
+new "start backend -s init -f $cfg -- -A $delay"
+start_backend -s init -f $cfg -- -A $delay
+
+new "wait backend"
+wait_backend
+
+new "asynchronous example rpc"
+sleep 10 | cat <(echo "$HELLONO11<rpc $DEFAULTNS><example xmlns=\"urn:example:clixon\"><x>0</x></example></rpc>]]>]]>") - | $clixon_netconf -qf $cfg > $fout &
+PIDS=($(jobs -l % | cut -c 6- | awk '{print $1}'))
+sleep 0.5
+
+new "other client is served while example rpc is pending"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><empty xmlns=\"urn:example:clixon\"/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "example rpc is not replied yet"
+expectpart "$(cat $fout)" 0 "" --not-- "rpc-reply"
+
+sleep $((delay/1000+1))
+
+new "example rpc is replied after delay"
+expectpart "$(cat $fout)" 0 "<rpc-reply $DEFAULTNS><x xmlns=\"urn:example:clixon\">0</x><y xmlns=\"urn:example:clixon\">42</y></rpc-reply>"
+
+new "soft kill ${PIDS[0]}"
+kill ${PIDS[0]}                   # kill the while loop above to close STDIN
+
+new "client closes session while example rpc is pending"
+sleep 1 | cat <(echo "$HELLONO11<rpc $DEFAULTNS><example xmlns=\"urn:example:clixon\"><x>2</x></example></rpc>]]>]]>") - | $clixon_netconf -qf $cfg > /dev/null &
+sleep 0.5
+PIDS=($(jobs -l % | cut -c 6- | awk '{print $1}'))
+kill ${PIDS[0]}
+sleep $((delay/1000+1))
+
+new "example rpc after closed session"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><example xmlns=\"urn:example:clixon\"><x>3</x></example></rpc>" "" "<rpc-reply $DEFAULTNS><x xmlns=\"urn:example:clixon\">3</x><y xmlns=\"urn:example:clixon\">42</y></rpc-reply>"
+
+new "example rpc times out"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><example xmlns=\"urn:example:clixon\"><x>timeout</x></example></rpc>" "" "<rpc-reply $DEFAULTNS><rpc-error><error-type>application</error-type><error-tag>operation-failed</error-tag><error-severity>error</error-severity><error-message>Asynchronous rpc timed out</error-message></rpc-error></rpc-reply>"
+
+new "example rpc after timeout"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><example xmlns=\"urn:example:clixon\"><x>1</x></example></rpc>" "" "<rpc-reply $DEFAULTNS><x xmlns=\"urn:example:clixon\">1</x><y xmlns=\"urn:example:clixon\">42</y></rpc-reply>"
+
+new "Kill backend"
+# Check if premature kill
+pid=$(pgrep -u root -f clixon_backend)
+if [ -z "$pid" ]; then
+    err "backend already dead"
+fi
+# kill backend
+stop_backend -f $cfg
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -0,0 +1,105 @@
+#!/usr/bin/env bash
+# Rpc profile of backend, see CLICON_RPC_PROFILE
+# Make rpcs and check that they are timed and sized in clixon-lib rpc-stats state data
+# Check that the backend logs the profile on SIGUSR1 and continues
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/profile.yang
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>$dir</CLICON_YANG_DIR>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>/usr/local/var/$APPNAME</CLICON_XMLDB_DIR>
+  <CLICON_YANG_LIBRARY>false</CLICON_YANG_LIBRARY>
+  <CLICON_NETCONF_MONITORING>false</CLICON_NETCONF_MONITORING>
+  <CLICON_RPC_PROFILE>true</CLICON_RPC_PROFILE>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module profile{
+    yang-version 1.1;
+    namespace "urn:example:profile";
+    prefix ex;
+    container c{
+        list x{
+            key k;
+            leaf k{
+                type string;
+            }
+            leaf v{
+                type string;
+            }
+        }
+    }
+}
+EOF
+
+new "test params: -f $cfg"
+
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+new "add entries"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><c xmlns=\"urn:example:profile\"><x><k>a</k><v>1</v></x><x><k>b</k><v>2</v></x></c></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "commit"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "get-config"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><c xmlns=\"urn:example:profile\"><x><k>a</k><v>1</v></x><x><k>b</k><v>2</v></x></c></data></rpc-reply>"
+
+new "commit with nothing to commit is ok"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "get rpc-stats of edit-config"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get content=\"nonconfig\"><filter type=\"xpath\" select=\"cl:rpc-stats\" xmlns:cl=\"http://clicon.org/lib\"/></get></rpc>" "<rpc><name>edit-config</name><calls>1</calls><errors>0</errors><total-usec>[0-9]*</total-usec><p50-usec>[0-9]*</p50-usec><p99-usec>[0-9]*</p99-usec><max-usec>[0-9]*</max-usec><request-bytes>[1-9][0-9]*</request-bytes><reply-bytes>[1-9][0-9]*</reply-bytes><max-reply-bytes>[1-9][0-9]*</max-reply-bytes></rpc>" ""
+
+new "get rpc-stats of commit"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get content=\"nonconfig\"><filter type=\"xpath\" select=\"cl:rpc-stats\" xmlns:cl=\"http://clicon.org/lib\"/></get></rpc>" "<rpc><name>commit</name><calls>2</calls>" ""
+
+if [ $BE -ne 0 ]; then
+    new "log rpc profile on SIGUSR1"
+    pid=$(pgrep -u root -f clixon_backend)
+    sudo kill -USR1 $pid
+    sleep 1
+fi
+
+new "get-config after SIGUSR1"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source><filter type=\"xpath\" select=\"/ex:c/ex:x[ex:k='a']\" xmlns:ex=\"urn:example:profile\"/></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><c xmlns=\"urn:example:profile\"><x><k>a</k><v>1</v></x></c></data></rpc-reply>"
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
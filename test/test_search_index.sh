@@ -1,6 +1,7 @@
 #!/usr/bin/env bash
 # Test explicit search index.
 # Test done by clixon explicit-index extension
+# Also test that the index is maintained by backend edits and visible in stats
 # Test explicit indexes in lists these cases:
 #   - not a key string
 #   - not a key int
@@ -91,6 +92,84 @@ new "index search latency i=$rndi"
 new "non-index search latency j=$rndi"
 { time -p $clixon_util_path -f $xml1 -y $ydir -p /a:x1/a:y[a:j=\"$rndi\"] > /dev/null; }  2>&1 | awk '/real/ {print $2}'
 
+# Search index maintained by backend on edits
+APPNAME=example
+cfg=$dir/conf.xml
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_DIR>$ydir</CLICON_YANG_MAIN_DIR>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+</clixon-config>
+EOF
+
+new "test params: -f $cfg"
+
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+new "add entries with index i"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><x1 xmlns=\"urn:example:a\"><y><k1>a</k1><i>1</i></y><y><k1>b</k1><i>2</i></y><y><k1>c</k1><i>3</i></y></x1></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "change index i of b"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><x1 xmlns=\"urn:example:a\"><y><k1>b</k1><i>7</i></y></x1></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "delete c"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><x1 xmlns=\"urn:example:a\"><y nc:operation=\"delete\" xmlns:nc=\"urn:ietf:params:xml:ns:netconf:base:1.0\"><k1>c</k1></y></x1></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "get i=7"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><candidate/></source><filter type=\"xpath\" select=\"/a:x1/a:y[a:i='7']\" xmlns:a=\"urn:example:a\"/></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><x1 xmlns=\"urn:example:a\"><y><k1>b</k1><i>7</i></y></x1></data></rpc-reply>"
+
+new "get i=2 not found"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><candidate/></source><filter type=\"xpath\" select=\"/a:x1/a:y[a:i='2']\" xmlns:a=\"urn:example:a\"/></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data/></rpc-reply>"
+
+new "search index stats of candidate"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><stats xmlns=\"http://clicon.org/lib\"><xml-type>search-index</xml-type></stats></rpc>" "<datastore><name>candidate</name><nr>1</nr><size>[0-9]*</size><generation>[0-9]*</generation></datastore>" ""
+
+new "add entries d and e"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><x1 xmlns=\"urn:example:a\"><y><k1>d</k1><i>5</i></y><y><k1>e</k1><i>3</i></y></x1></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+# List pagination using the search index of i
+new "pagination sort-by index i limit 2"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><candidate/></source><filter type=\"xpath\" select=\"/a:x1/a:y\" xmlns:a=\"urn:example:a\"/><list-pagination xmlns=\"urn:ietf:params:xml:ns:yang:ietf-list-pagination-nc\"><sort-by>i</sort-by><limit>2</limit></list-pagination></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><x1 xmlns=\"urn:example:a\"><y><k1>a</k1><i>1</i></y><y><k1>e</k1><i>3</i></y></x1></data></rpc-reply>"
+
+new "pagination sort-by index i offset 2"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><candidate/></source><filter type=\"xpath\" select=\"/a:x1/a:y\" xmlns:a=\"urn:example:a\"/><list-pagination xmlns=\"urn:ietf:params:xml:ns:yang:ietf-list-pagination-nc\"><sort-by>i</sort-by><offset>2</offset></list-pagination></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><x1 xmlns=\"urn:example:a\"><y><k1>d</k1><i>5</i></y><y><k1>b</k1><i>7</i></y></x1></data></rpc-reply>"
+
+new "pagination sort-by index i backwards limit 1"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><candidate/></source><filter type=\"xpath\" select=\"/a:x1/a:y\" xmlns:a=\"urn:example:a\"/><list-pagination xmlns=\"urn:ietf:params:xml:ns:yang:ietf-list-pagination-nc\"><sort-by>i</sort-by><direction>backwards</direction><limit>1</limit></list-pagination></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><x1 xmlns=\"urn:example:a\"><y><k1>b</k1><i>7</i></y></x1></data></rpc-reply>"
+
+new "pagination where index range"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><candidate/></source><filter type=\"xpath\" select=\"/a:x1/a:y\" xmlns:a=\"urn:example:a\"/><list-pagination xmlns=\"urn:ietf:params:xml:ns:yang:ietf-list-pagination-nc\"><where xmlns:a=\"urn:example:a\">a:i&gt;=5</where></list-pagination></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><x1 xmlns=\"urn:example:a\"><y><k1>b</k1><i>7</i></y><y><k1>d</k1><i>5</i></y></x1></data></rpc-reply>"
+
+new "pagination where index range sort-by index limit 2"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><candidate/></source><filter type=\"xpath\" select=\"/a:x1/a:y\" xmlns:a=\"urn:example:a\"/><list-pagination xmlns=\"urn:ietf:params:xml:ns:yang:ietf-list-pagination-nc\"><where>i&gt;=3</where><sort-by>i</sort-by><limit>2</limit></list-pagination></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><x1 xmlns=\"urn:example:a\"><y><k1>e</k1><i>3</i></y><y><k1>d</k1><i>5</i></y></x1></data></rpc-reply>"
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
 rm -rf $dir
 
 new "endtest"
@@ -35,6 +35,7 @@ cat <<EOF > $cfg
   <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
   <CLICON_SNMP_AGENT_SOCK>unix:$SOCK</CLICON_SNMP_AGENT_SOCK>
   <CLICON_SNMP_MIB>CLIXON-TYPES-MIB</CLICON_SNMP_MIB>
+  <CLICON_SNMP_CACHE_TTL>5000 CLIXON-TYPES-MIB=0</CLICON_SNMP_CACHE_TTL>
   <CLICON_VALIDATE_STATE_XML>true</CLICON_VALIDATE_STATE_XML>
 </clixon-config>
 EOF
@@ -292,6 +293,15 @@ validate_oid $OID17 $OID17 "INTEGER" 42
 new "Test SNMP getnext nsIETFWGName"
 expectpart "$($snmpgetnext $OID17)" 0 "STRING: \"Name1\""
 
+new "Test SNMP getnext netSnmpIETFWGEntry"
+expectpart "$($snmpgetnext $OID16)" 0 "$OID17 = INTEGER: 42"
+
+new "Test SNMP getnext nsIETFWGChair1"
+expectpart "$($snmpgetnext $OID18)" 0 "$OID19 = STRING: \"Name2\""
+
+new "Test SNMP getbulk netSnmpIETFWGTable, one table fetch for all repetitions"
+expectpart "$($snmpbulkget $OID15)" 0 "$OID17 = INTEGER: 42" "$OID18 = STRING: \"Name1\"" "$OID19 = STRING: \"Name2\""
+
 new "Test SNMP getnext netSnmpHostsTable"
 expectpart "$($snmpgetnext $OID20)" 0 "$OID21 = STRING: \"test\""
 
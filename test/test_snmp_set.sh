@@ -2,6 +2,7 @@
 # snmpset. This requires deviation of MIB-YANG to make write operations
 # Get default value, set new value via SNMP and check it, set new value via NETCONF and check
 # Selected types from CLIXON/IF-MIB/ENTITY mib
+# Several varbinds in one PDU are one backend transaction
 # Also an incomplete commit failed test
 
 # Magic line must be first in script (see README.md)
@@ -250,6 +251,12 @@ testrun bitTest "Hex-STRING" "00 20 00 00 00" "00 20 00 00 00" "bit10" ${MIB}.1.
 # XXX It was supposed to test writing hardware address type, but it is also read-only
 #testrun ifPhysAddress STRING ff:ee:dd:cc:bb:aa ff:ee:dd:cc:bb:aa ff:ee:dd:cc:bb:aa ${IFMIB}.2.2.1.6.1
 
+new "Set several values in one PDU via SNMP"
+expectpart "$($snmpset ${MIB}.1.1.0 i 42 ${MIB}.1.3.0 s batch ${MIB}.1.13.0 a 4.3.2.1)" 0 "INTEGER: 42" "STRING: batch" "IpAddress: 4.3.2.1"
+
+new "Check values of one PDU via CLI"
+expectpart "$($clixon_cli -1 -f $cfg show config)" 0 "<clixonExampleInteger>42</clixonExampleInteger>" "<clixonExampleString>batch</clixonExampleString>" "<ifIpAddr>4.3.2.1</ifIpAddr>"
+
 # Inline testrun for rowstatus complicated logic
 name=ifStackStatus
 type=INTEGER
@@ -288,6 +295,12 @@ wait_backend
 new "set value with error"
 expectpart "$($snmpset ${MIB}.1.1.0  i 4321 2>&1)" 2 "commitFailed"
 
+new "set several values with error in one PDU"
+expectpart "$($snmpset ${MIB}.1.3.0 s nobatch ${MIB}.1.1.0 i 4321 2>&1)" 2 "commitFailed"
+
+new "Check no value of failed PDU is set"
+expectpart "$($clixon_cli -1 -f $cfg show config)" 0 --not-- "nobatch"
+
 new "Cleaning up"
 testexit
 
@@ -0,0 +1,171 @@
+#!/usr/bin/env bash
+# Asynchronous state data callbacks in the backend, see ca_statedata_async
+# The state data of the example backend plugin is delivered after a delay (-D), while
+# other clients are served. The get is then made again with the collected state data.
+# The plugin counts the interface rows it makes in my-status/int (-c): each get calls
+# it once, also when the get is made again.
+# A plugin not done within CLICON_STATE_ASYNC_TIMEOUT fails the get.
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+# Backend must be started by the test
+if [ $BE -eq 0 ]; then
+    echo "...skipped: must run with backend"
+    rm -rf $dir
+    if [ "$s" = $0 ]; then exit 0; else return 0; fi
+fi
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/clixon-example.yang
+fout=$dir/async.out
+
+# Delay of state data in ms
+: ${delay:=2000}
+
+cat <<EOF > $fyang
+module clixon-example{
+    yang-version 1.1;
+    namespace "urn:example:clixon";
+    prefix ex;
+    import ietf-interfaces {
+        prefix if;
+    }
+    identity eth {
+        base if:interface-type;
+    }
+    augment "/if:interfaces/if:interface" {
+        container my-status {
+            config false;
+            leaf int {
+                type int32;
+            }
+            leaf str {
+                type string;
+            }
+        }
+    }
+}
+EOF
+
+# Config with asynchronous state timeout $1
+function config()
+{
+    cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_DIR>$IETFRFC</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_BACKEND_DIR>/usr/local/lib/$APPNAME/backend</CLICON_BACKEND_DIR>
+  <CLICON_BACKEND_REGEXP>example_backend.so$</CLICON_BACKEND_REGEXP>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_YANG_LIBRARY>false</CLICON_YANG_LIBRARY>
+  <CLICON_STATE_ASYNC_TIMEOUT>$1</CLICON_STATE_ASYNC_TIMEOUT>
+</clixon-config>
+EOF
+}
+
+function rpc()
+{
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS>$1</rpc>" "" "<rpc-reply $DEFAULTNS>$2</rpc-reply>"
+}
+
+# Get of my-status/int of interface $1, with message-id $2
+function getmsg()
+{
+    echo "<rpc $DEFAULTONLY message-id=\"$2\"><get><filter type=\"xpath\" select=\"/if:interfaces/if:interface[if:name='$1']/ex:my-status/ex:int\" xmlns:if=\"urn:ietf:params:xml:ns:yang:ietf-interfaces\" xmlns:ex=\"urn:example:clixon\"/></get></rpc>]]>]]>"
+}
+
+config $((2*delay))
+
+new "test params: -f $cfg -- -sc -D $delay"
+
+new "kill old backend"
+sudo clixon_backend -zf $cfg
+if [ $? -ne 0 ]; then
+    err
+fi
+new "start backend -s init -f $cfg -- -sc -D $delay"
+start_backend -s init -f $cfg -- -sc -D $delay
+
+new "wait backend"
+wait_backend
+
+new "add interfaces eth0 and eth1"
+rpc "<edit-config><target><candidate/></target><config><interfaces xmlns=\"urn:ietf:params:xml:ns:yang:ietf-interfaces\"><interface><name>eth0</name><type xmlns:ex=\"urn:example:clixon\">ex:eth</type></interface><interface><name>eth1</name><type xmlns:ex=\"urn:example:clixon\">ex:eth</type></interface></interfaces></config></edit-config>" "<ok/>"
+rpc "<commit/>" "<ok/>"
+
+new "get and get-config in one session, get waits for state data"
+sleep 10 | cat <(echo "$HELLONO11$(getmsg eth1 1)<rpc $DEFAULTONLY message-id=\"2\"><get-config><source><running/></source></get-config></rpc>]]>]]>") - | $clixon_netconf -qf $cfg > $fout &
+PIDS=($(jobs -l % | cut -c 6- | awk '{print $1}'))
+sleep 0.5
+
+new "other client is served while state data is collected"
+rpc "<get-config><source><running/></source><filter type=\"xpath\" select=\"/if:interfaces/if:interface[if:name='eth0']/if:name\" xmlns:if=\"urn:ietf:params:xml:ns:yang:ietf-interfaces\"/></get-config>" "<data><interfaces xmlns=\"urn:ietf:params:xml:ns:yang:ietf-interfaces\"><interface><name>eth0</name></interface></interfaces></data>"
+
+new "get and get-config are not replied yet"
+expectpart "$(cat $fout)" 0 "" --not-- "rpc-reply"
+
+sleep $((delay/1000+1))
+
+new "get is made again with state data: rows 1 and 2"
+expectpart "$(cat $fout)" 0 "<name>eth1</name>" "int>2</" --not-- "<rpc-error>"
+
+new "get-config is replied after get"
+expectpart "$(cat $fout | tr -d '\n')" 0 "message-id=.1.*int>2</.*message-id=.2.*<name>eth0</name>"
+
+new "soft kill ${PIDS[0]}"
+kill ${PIDS[0]}                   # kill the while loop above to close STDIN
+
+new "next get calls plugin once more: rows 3 and 4"
+expectpart "$(echo "$HELLONO11$(getmsg eth1 3)" | $clixon_netconf -qf $cfg)" 0 "<name>eth1</name>" "int>4</" --not-- "<rpc-error>"
+
+new "Kill backend"
+# Check if premature kill
+pid=$(pgrep -u root -f clixon_backend)
+if [ -z "$pid" ]; then
+    err "backend already dead"
+fi
+# kill backend
+stop_backend -f $cfg
+
+config $((delay/2))
+
+new "test params: -f $cfg -- -sc -D $delay"
+
+new "start backend -s running -f $cfg -- -sc -D $delay"
+start_backend -s running -f $cfg -- -sc -D $delay
+
+new "wait backend"
+wait_backend
+
+new "get times out"
+expectpart "$(echo "$HELLONO11$(getmsg eth1 4)" | $clixon_netconf -qf $cfg)" 0 "<rpc-error>" "state callback in plugin example_backend failed: timeout" --not-- "int>"
+
+# State data of the timed out get is delivered and dropped
+sleep $((delay/1000+1))
+
+new "get times out again"
+expectpart "$(echo "$HELLONO11$(getmsg eth1 5)" | $clixon_netconf -qf $cfg)" 0 "<rpc-error>" "state callback in plugin example_backend failed: timeout" --not-- "int>"
+
+new "get-config after timeout"
+rpc "<get-config><source><running/></source><filter type=\"xpath\" select=\"/if:interfaces/if:interface[if:name='eth1']/if:name\" xmlns:if=\"urn:ietf:params:xml:ns:yang:ietf-interfaces\"/></get-config>" "<data><interfaces xmlns=\"urn:ietf:params:xml:ns:yang:ietf-interfaces\"><interface><name>eth1</name></interface></interfaces></data>"
+
+new "Kill backend"
+# Check if premature kill
+pid=$(pgrep -u root -f clixon_backend)
+if [ -z "$pid" ]; then
+    err "backend already dead"
+fi
+# kill backend
+stop_backend -f $cfg
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -0,0 +1,191 @@
+#!/usr/bin/env bash
+# State data cache and pruning of backend statedata callbacks
+# The example backend plugin counts the interface rows it makes in my-status/int (-c), so
+# that calls of its state callback can be seen in the replies.
+# 1. CLICON_STATE_CACHE_TTL: identical gets within the TTL are served from the cache, after
+#    the TTL the plugin is called again, and a commit invalidates the cached state.
+# 2. ca_state_subtrees (-T): the plugin is not called for gets outside its subtree, and
+#    only makes the row of the interface requested, see clixon_plugin_statedata_keys()
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+# Backend must be started by the test
+if [ $BE -eq 0 ]; then
+    echo "...skipped: must run with backend"
+    rm -rf $dir
+    if [ "$s" = $0 ]; then exit 0; else return 0; fi
+fi
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/clixon-example.yang
+
+# State cache TTL in ms
+: ${ttl:=3000}
+
+cat <<EOF > $fyang
+module clixon-example{
+    yang-version 1.1;
+    namespace "urn:example:clixon";
+    prefix ex;
+    import ietf-interfaces {
+        prefix if;
+    }
+    identity eth {
+        base if:interface-type;
+    }
+    container state {
+        config false;
+        leaf-list op {
+            type string;
+        }
+    }
+    augment "/if:interfaces/if:interface" {
+        container my-status {
+            config false;
+            leaf int {
+                type int32;
+            }
+            leaf str {
+                type string;
+            }
+        }
+    }
+}
+EOF
+
+# Config with state cache TTL $1
+function config()
+{
+    cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_DIR>$IETFRFC</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_BACKEND_DIR>/usr/local/lib/$APPNAME/backend</CLICON_BACKEND_DIR>
+  <CLICON_BACKEND_REGEXP>example_backend.so$</CLICON_BACKEND_REGEXP>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_YANG_LIBRARY>false</CLICON_YANG_LIBRARY>
+  <CLICON_STATE_CACHE_TTL>$1</CLICON_STATE_CACHE_TTL>
+</clixon-config>
+EOF
+}
+
+function rpc()
+{
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS>$1</rpc>" "" "<rpc-reply $DEFAULTNS>$2</rpc-reply>"
+}
+
+# Get with xpath filter $1, print reply
+function getx()
+{
+    echo "$DEFAULTHELLO$(chunked_framing "<rpc $DEFAULTNS><get><filter type=\"xpath\" select=\"$1\" xmlns:if=\"urn:ietf:params:xml:ns:yang:ietf-interfaces\" xmlns:ex=\"urn:example:clixon\"/></get></rpc>")" | $clixon_netconf -qf $cfg
+}
+
+# Check that my-status/int of interface $1 is $2
+function getint()
+{
+    expectpart "$(getx "/if:interfaces/if:interface[if:name='$1']/ex:my-status/ex:int")" 0 "<name>$1</name>" "int>$2</" --not-- "<rpc-error>"
+}
+
+# Add interface $1 and commit
+function addif()
+{
+    rpc "<edit-config><target><candidate/></target><config><interfaces xmlns=\"urn:ietf:params:xml:ns:yang:ietf-interfaces\"><interface><name>$1</name><type xmlns:ex=\"urn:example:clixon\">ex:eth</type></interface></interfaces></config></edit-config>" "<ok/>"
+    rpc "<commit/>" "<ok/>"
+}
+
+config $ttl
+
+new "test params: -f $cfg -- -sc"
+
+new "kill old backend"
+sudo clixon_backend -zf $cfg
+if [ $? -ne 0 ]; then
+    err
+fi
+new "start backend -s init -f $cfg -- -sc"
+start_backend -s init -f $cfg -- -sc
+
+new "wait backend"
+wait_backend
+
+new "add interfaces eth0 and eth1"
+addif eth0
+addif eth1
+
+new "get eth1 calls plugin: rows 1 and 2"
+getint eth1 2
+
+new "identical get within TTL is cached"
+getint eth1 2
+
+sleep $((ttl/1000+1))
+
+new "get eth1 after TTL calls plugin: rows 3 and 4"
+getint eth1 4
+
+new "get eth0 is another request: rows 5 and 6"
+getint eth0 5
+
+new "identical get of eth0 within TTL is cached"
+getint eth0 5
+
+new "add interface eth2"
+addif eth2
+
+new "commit invalidates cached state: rows 7, 8 and 9"
+getint eth0 7
+
+new "Kill backend"
+# Check if premature kill
+pid=$(pgrep -u root -f clixon_backend)
+if [ -z "$pid" ]; then
+    err "backend already dead"
+fi
+# kill backend
+stop_backend -f $cfg
+
+config 0
+
+new "test params: -f $cfg -- -sc -T /ietf-interfaces:interfaces"
+
+new "start backend -s running -f $cfg -- -sc -T /ietf-interfaces:interfaces"
+start_backend -s running -f $cfg -- -sc -T /ietf-interfaces:interfaces
+
+new "wait backend"
+wait_backend
+
+new "get state outside subtree does not call plugin"
+rpc "<get content=\"nonconfig\"><filter type=\"xpath\" select=\"/ex:state\" xmlns:ex=\"urn:example:clixon\"/></get>" "<data/>"
+
+new "get eth1 makes row of eth1 only: row 1"
+getint eth1 1
+
+new "get eth2 makes row of eth2 only: row 2"
+getint eth2 2
+
+new "get interfaces above subtree makes all rows: rows 3, 4 and 5"
+expectpart "$(getx "/if:interfaces")" 0 "<name>eth0</name>" "int>3</" "int>4</" "int>5</" --not-- "<rpc-error>"
+
+new "get union calls plugin with all rows: rows 6, 7 and 8"
+expectpart "$(getx "/if:interfaces | /ex:state")" 0 "int>6</" "int>7</" "int>8</" "op>42</" --not-- "<rpc-error>"
+
+new "Kill backend"
+# Check if premature kill
+pid=$(pgrep -u root -f clixon_backend)
+if [ -z "$pid" ]; then
+    err "backend already dead"
+fi
+# kill backend
+stop_backend -f $cfg
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -13,7 +13,8 @@
 # -- to here only basic callback tests (that they occur). Below transaction data
 # 6. Validate user-error with plugin_rpc_err (invalidation by user callback)
 # 7. Detailed transaction vector add/del/change tests
-# For the last test, the yang is a list with three members, so that you can do
+# 12. Transaction subtrees (ca_trans_subtrees of the nacm plugin)
+# For the detailed tests, the yang is a list with three members, so that you can do
 # add/delete/change in a single go.
 # The user-error uses a trick feature in the example nacm plugin which is started
 # with an "error-trigger" xpath which triggers an error. This also toggles between
@@ -474,6 +475,47 @@ let line++
 checklog "$nr nacm_end add: <fff><bar/></fff>" $line
 let line++
 
+#---------------------------------------------
+# 12. Transaction subtrees: the nacm plugin only sees changes in /trans:x/y
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    stop_backend -f $cfg
+
+    new "start backend -s running -f $cfg -l f$flog -- -t -w /trans:x/y"
+    start_backend -s running -f $cfg -l f$flog -- -t -w /trans:x/y
+
+    new "wait backend"
+    wait_backend
+
+    new "12. Transaction subtrees: commit in subtree"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><x xmlns='urn:example:clixon'><y><a>100</a></y></x></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+    new "Main and nacm see change in subtree"
+    expectpart "$(cat $flog)" 0 "main_commit add: <y><a>100</a></y>" "nacm_commit add: <y><a>100</a></y>"
+
+    n0=$(grep -c "nacm_" $flog)
+    new "Commit outside subtree"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><x xmlns='urn:example:clixon'><eee>true</eee></x></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+    new "Main sees change outside subtree"
+    expectpart "$(cat $flog)" 0 "main_commit add: <eee>true</eee>"
+
+    new "Nacm is not called"
+    n1=$(grep -c "nacm_" $flog)
+    if [ $n1 -ne $n0 ]; then
+        err "$n0" "$n1"
+    fi
+
+    new "Commit in and outside subtree"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><x xmlns='urn:example:clixon'><y><a>100</a><b>5</b></y><eee>false</eee></x></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+    new "Main sees both changes, nacm only the change in subtree"
+    expectpart "$(cat $flog)" 0 "main_commit add: <b>5</b>" "main_commit change: <eee>true</eee><eee>false</eee>" "nacm_commit add: <b>5</b>" --not-- "nacm_.*<eee>"
+fi
+
 if [ $BE -ne 0 ]; then
     new "Kill backend"
     # Check if premature kill
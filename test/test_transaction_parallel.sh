@@ -0,0 +1,193 @@
+#!/usr/bin/env bash
+# Parallel-safe transaction callbacks, see CA_PARALLEL_*
+# The two example backend plugins (main and nacm) are started with -- -P, so that their
+# validate and commit callbacks run as one batch in forked worker processes.
+# The callbacks log to a file, the order of log lines of a batch is not known.
+# 1. Commit
+# 2. Validate user-error in a worker, plugin memory of a worker is not kept
+# 3. Commit user-error in a worker: commit_failed in the failed plugin, revert in the other
+# 4. Same commit user-error without -P: same reply, sequential commit_failed and no revert
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/trans.yang
+flog=$dir/backend.log
+
+# Validate error in nacm plugin
+verr=42
+# Commit error in main plugin
+cerr=43
+
+cat <<EOF > $fyang
+module trans{
+   yang-version 1.1;
+   namespace "urn:example:clixon";
+   prefix ex;
+   container x {
+    list y {
+      key "a";
+      leaf a {
+        type int32;
+      }
+      leaf b {
+        type int32;
+      }
+    }
+  }
+}
+EOF
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_BACKEND_DIR>/usr/local/lib/$APPNAME/backend</CLICON_BACKEND_DIR>
+  <CLICON_SOCK>$dir/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+</clixon-config>
+EOF
+
+# Check number of log lines of a callback
+# @param[in] s  Callback and data, eg "main_commit add: <y><a>1</a></y>"
+# @param[in] n  Expected number of lines
+function checkcount(){
+    s=$1
+    n=$2
+    new "Check $n of $s in log"
+    c=$(grep -c "transaction_log [0-9]* $s" $flog)
+    if [ $c -ne $n ]; then
+        err "$n of \"$s\"" "$c"
+    fi
+}
+
+# Start backend with transaction logging
+# @param[in] opts  Extra plugin options
+function startlog(){
+    if [ $BE -ne 0 ]; then
+        new "kill old backend"
+        sudo clixon_backend -zf $cfg
+        if [ $? -ne 0 ]; then
+            err
+        fi
+        rm -f $flog
+        touch $flog
+        new "start backend -s init -f $cfg -l f$flog -- -t $1 -v /x/y[a=$verr] -C /x/y[a=$cerr]"
+        start_backend -s init -f $cfg -l f$flog -- -t $1 -v "/x/y[a='$verr']" -C "/x/y[a='$cerr']"
+    fi
+
+    new "wait backend"
+    wait_backend
+}
+
+# Stop backend
+function stoplog(){
+    if [ $BE -ne 0 ]; then
+        new "Kill backend"
+        # Check if premature kill
+        pid=$(pgrep -u root -f clixon_backend)
+        if [ -z "$pid" ]; then
+            err "backend already dead"
+        fi
+        # kill backend
+        stop_backend -f $cfg
+    fi
+}
+
+# Edit y entry in candidate
+# @param[in] a  Key of entry
+function edity(){
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><x xmlns='urn:example:clixon'><y><a>$1</a></y></x></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+}
+
+COMMITERR="<rpc-reply $DEFAULTNS><rpc-error><error-type>application</error-type><error-tag>operation-failed</error-tag><error-severity>error</error-severity><error-message>User commit error</error-message></rpc-error></rpc-reply>"
+RUNNING="<rpc-reply $DEFAULTNS><data><x xmlns=\"urn:example:clixon\"><y><a>1</a></y></x></data></rpc-reply>"
+
+new "test params: -f $cfg"
+
+startlog -P
+
+new "1. Commit"
+edity 1
+
+new "commit"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+for op in validate commit; do
+    checkcount "main_$op add: <y><a>1</a></y>" 1
+    checkcount "nacm_$op add: <y><a>1</a></y>" 1
+done
+
+new "2. Validate user-error"
+edity $verr
+
+# The nacm plugin toggles to a commit error after a validate error, but the toggle is
+# made in a worker and is lost
+for i in 1 2; do
+    new "validate $i (should fail)"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><validate><source><candidate/></source></validate></rpc>" "" "<rpc-reply $DEFAULTNS><rpc-error><error-type>application</error-type><error-tag>operation-failed</error-tag><error-severity>error</error-severity><error-message>User error</error-message></rpc-error></rpc-reply>"
+done
+
+new "discard-changes"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><discard-changes/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+checkcount "main_validate add: <y><a>$verr</a></y>" 2
+checkcount "nacm_validate add: <y><a>$verr</a></y>" 2
+checkcount "main_abort add: <y><a>$verr</a></y>" 2
+checkcount "nacm_abort add: <y><a>$verr</a></y>" 2
+
+new "3. Commit user-error"
+edity $cerr
+
+new "commit (should fail)"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "$COMMITERR"
+
+new "discard-changes"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><discard-changes/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "running is not changed"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source></get-config></rpc>" "" "$RUNNING"
+
+# Both commits of the batch are called, the other plugin of the batch is reverted
+checkcount "main_commit add: <y><a>$cerr</a></y>" 1
+checkcount "nacm_commit add: <y><a>$cerr</a></y>" 1
+checkcount "main_commit_failed add: <y><a>$cerr</a></y>" 1
+checkcount "main_revert add: <y><a>$cerr</a></y>" 0
+checkcount "nacm_revert add: <y><a>$cerr</a></y>" 1
+checkcount "main_abort add: <y><a>$cerr</a></y>" 1
+checkcount "nacm_abort add: <y><a>$cerr</a></y>" 1
+
+stoplog
+
+startlog
+
+new "4. Commit user-error sequential"
+edity $cerr
+
+new "commit sequential (should fail)"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "$COMMITERR"
+
+new "discard-changes"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><discard-changes/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "running is not changed"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source></get-config></rpc>" "" "$RUNNING"
+
+# Main plugin is first and fails, the nacm plugin is not called and not reverted
+checkcount "main_commit add: <y><a>$cerr</a></y>" 1
+checkcount "nacm_commit add: <y><a>$cerr</a></y>" 0
+checkcount "main_commit_failed add: <y><a>$cerr</a></y>" 1
+checkcount "main_revert add: <y><a>$cerr</a></y>" 0
+checkcount "nacm_revert add: <y><a>$cerr</a></y>" 0
+
+stoplog
+
+rm -rf $dir
+
+new "endtest"
+endtest
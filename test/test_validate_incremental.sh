@@ -0,0 +1,162 @@
+#!/usr/bin/env bash
+# Incremental validation of changes, see CLICON_VALIDATE_INCREMENTAL
+# Run the same changes without and with incremental validation, and check that validation
+# fails or succeeds in the same way.
+# The changes only affect unchanged nodes via must, when, leafref, unique and min-elements,
+# and incremental validation must find that they read a changed node.
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+# Backend must be started by the test
+if [ $BE -eq 0 ]; then
+    echo "...skipped: must run with backend"
+    rm -rf $dir
+    if [ "$s" = $0 ]; then exit 0; else return 0; fi
+fi
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/clixon-example.yang
+
+cat <<EOF > $fyang
+module clixon-example{
+    yang-version 1.1;
+    namespace "urn:example:clixon";
+    prefix ex;
+    container cfg {
+        leaf forbidden {
+            type int32;
+        }
+        leaf mode {
+            type string;
+        }
+    }
+    container d {
+        list item {
+            key name;
+            min-elements 1;
+            unique value;
+            leaf name {
+                type string;
+            }
+            leaf value {
+                type int32;
+                must ". != /ex:cfg/ex:forbidden";
+            }
+        }
+        leaf ref {
+            type leafref {
+                path "../item/name";
+            }
+        }
+        leaf w {
+            when "/ex:cfg/ex:mode = 'on'";
+            type string;
+        }
+    }
+}
+EOF
+
+function rpc()
+{
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS>$1</rpc>" "" "<rpc-reply $DEFAULTNS>$2</rpc-reply>"
+}
+
+# Edit-config of candidate with content $1
+function edit()
+{
+    rpc "<edit-config><target><candidate/></target><config>$1</config></edit-config>" "<ok/>"
+}
+
+# Validate of candidate fails with rpc-error matching $1, then discard changes
+function validate_fail()
+{
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><validate><source><candidate/></source></validate></rpc>" "<rpc-reply $DEFAULTNS><rpc-error>.*$1" ""
+    rpc "<discard-changes/>" "<ok/>"
+}
+
+CFG="<cfg xmlns=\"urn:example:clixon\"><forbidden>100</forbidden><mode>on</mode></cfg>"
+D="<d xmlns=\"urn:example:clixon\"><item><name>a</name><value>1</value></item><item><name>b</name><value>2</value></item><ref>a</ref><w>x</w></d>"
+
+for incr in false true; do
+    cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_BACKEND_DIR>/usr/local/lib/$APPNAME/backend</CLICON_BACKEND_DIR>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_YANG_LIBRARY>false</CLICON_YANG_LIBRARY>
+  <CLICON_VALIDATE_TARGET_STATE>false</CLICON_VALIDATE_TARGET_STATE>
+  <CLICON_VALIDATE_INCREMENTAL>$incr</CLICON_VALIDATE_INCREMENTAL>
+</clixon-config>
+EOF
+
+    new "test params: -f $cfg"
+
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+
+    new "wait backend"
+    wait_backend
+
+    new "incremental $incr: commit base"
+    edit "$CFG$D"
+    rpc "<commit/>" "<ok/>"
+
+    new "incremental $incr: change node read by must of unchanged node"
+    edit "<cfg xmlns=\"urn:example:clixon\"><forbidden>2</forbidden></cfg>"
+    validate_fail "Failed MUST xpath"
+
+    new "incremental $incr: change node read by when of unchanged node"
+    edit "<cfg xmlns=\"urn:example:clixon\"><mode>off</mode></cfg>"
+    validate_fail "WHEN condition failed"
+
+    new "incremental $incr: delete node read by leafref of unchanged node"
+    edit "<d xmlns=\"urn:example:clixon\" xmlns:nc=\"${BASENS}\"><item nc:operation=\"delete\"><name>a</name></item></d>"
+    validate_fail "<error-app-tag>instance-required</error-app-tag>"
+
+    new "incremental $incr: change node to duplicate of unchanged unique node"
+    edit "<d xmlns=\"urn:example:clixon\"><item><name>b</name><value>1</value></item></d>"
+    validate_fail "<error-app-tag>data-not-unique</error-app-tag>"
+
+    new "incremental $incr: delete all list entries"
+    edit "<d xmlns=\"urn:example:clixon\" xmlns:nc=\"${BASENS}\"><item nc:operation=\"delete\"><name>a</name></item><item nc:operation=\"delete\"><name>b</name></item><ref nc:operation=\"delete\"/></d>"
+    validate_fail "<error-app-tag>too-few-elements</error-app-tag>"
+
+    new "incremental $incr: running unchanged"
+    rpc "<get-config><source><running/></source></get-config>" "<data>$CFG$D</data>"
+
+    new "incremental $incr: change unrelated node"
+    edit "<d xmlns=\"urn:example:clixon\"><item><name>c</name><value>3</value></item></d>"
+    rpc "<validate><source><candidate/></source></validate>" "<ok/>"
+    rpc "<commit/>" "<ok/>"
+
+    new "incremental $incr: change node and node read by must"
+    edit "<cfg xmlns=\"urn:example:clixon\"><forbidden>2</forbidden></cfg><d xmlns=\"urn:example:clixon\"><item><name>b</name><value>4</value></item></d>"
+    rpc "<commit/>" "<ok/>"
+    rpc "<get-config><source><running/></source><filter type=\"xpath\" select=\"/ex:d/ex:item\" xmlns:ex=\"urn:example:clixon\"/></get-config>" "<data><d xmlns=\"urn:example:clixon\"><item><name>a</name><value>1</value></item><item><name>b</name><value>4</value></item><item><name>c</name><value>3</value></item></d></data>"
+
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+done
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -0,0 +1,170 @@
+#!/usr/bin/env bash
+# Parallel validation of nodes with many children, see CLICON_VALIDATE_PARALLEL
+# Validate and commit a list larger than VALIDATE_PARALLEL_MIN sequentially and with several
+# processes, and check that results and errors are the same.
+# Must failures in two shards of workers check that the first error in document order is
+# reported. Invalid regexps in must expressions make workers fail: the failed shards are
+# validated again by the backend, which reports the same error as sequential validation.
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+# Backend must be started by the test
+if [ $BE -eq 0 ]; then
+    echo "...skipped: must run with backend"
+    rm -rf $dir
+    if [ "$s" = $0 ]; then exit 0; else return 0; fi
+fi
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/clixon-example.yang
+
+# Number of list entries, larger than VALIDATE_PARALLEL_MIN in include/clixon_custom.h
+: ${perfnr:=12000}
+
+# Number of processes, each validates perfnr/workers entries
+workers=4
+
+# Entries in the second and last shards
+e1=5000
+e2=$((perfnr-1000))
+
+cat <<EOF > $fyang
+module clixon-example{
+    yang-version 1.1;
+    namespace "urn:example:clixon";
+    prefix ex;
+    container c {
+        list item {
+            key name;
+            leaf name {
+                type int32;
+            }
+            leaf value {
+                type int32;
+                must ". >= 0";
+            }
+            leaf pattern {
+                type string;
+                must "re-match(../value, .)";
+            }
+        }
+    }
+}
+EOF
+
+function rpc()
+{
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS>$1</rpc>" "" "<rpc-reply $DEFAULTNS>$2</rpc-reply>"
+}
+
+# Send rpc $1, print reply
+function rpcx()
+{
+    echo "$DEFAULTHELLO$(chunked_framing "<rpc $DEFAULTNS>$1</rpc>")" | $clixon_netconf -qf $cfg
+}
+
+# Edit-config of candidate with list entries $1
+function edit()
+{
+    rpc "<edit-config><target><candidate/></target><config><c xmlns=\"urn:example:clixon\">$1</c></config></edit-config>" "<ok/>"
+}
+
+C=""
+for (( i=0; i<$perfnr; i++ )); do
+    C="$C<item><name>$i</name><value>$i</value><pattern>[0-9]+</pattern></item>"
+done
+
+for parallel in 0 $workers; do
+    cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_BACKEND_DIR>/usr/local/lib/$APPNAME/backend</CLICON_BACKEND_DIR>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_YANG_LIBRARY>false</CLICON_YANG_LIBRARY>
+  <CLICON_VALIDATE_INCREMENTAL>false</CLICON_VALIDATE_INCREMENTAL>
+  <CLICON_VALIDATE_PARALLEL>$parallel</CLICON_VALIDATE_PARALLEL>
+</clixon-config>
+EOF
+
+    new "test params: -f $cfg"
+
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+
+    new "wait backend"
+    wait_backend
+
+    new "parallel $parallel: add $perfnr entries"
+    edit "$C"
+
+    new "parallel $parallel: validate"
+    rpc "<validate><source><candidate/></source></validate>" "<ok/>"
+
+    new "parallel $parallel: commit"
+    rpc "<commit/>" "<ok/>"
+
+    new "parallel $parallel: must fails in two shards"
+    edit "<item><name>$e1</name><value>-1</value><pattern>.*</pattern></item><item><name>$e2</name><value>-2</value><pattern>.*</pattern></item>"
+    rpcx "<validate><source><candidate/></source></validate>" > $dir/must$parallel.xml
+    expectpart "$(cat $dir/must$parallel.xml)" 0 "<rpc-error>" "Failed MUST xpath" "$e1" --not-- "<ok/>" "$e2"
+
+    new "parallel $parallel: commit fails with same error"
+    rpcx "<commit/>" > $dir/mustc$parallel.xml
+    expectpart "$(cat $dir/mustc$parallel.xml)" 0 "<rpc-error>" "Failed MUST xpath" "$e1" --not-- "<ok/>" "$e2"
+
+    new "parallel $parallel: must fails in last shard"
+    edit "<item><name>$e1</name><value>$e1</value></item>"
+    rpcx "<validate><source><candidate/></source></validate>" > $dir/must2$parallel.xml
+    expectpart "$(cat $dir/must2$parallel.xml)" 0 "<rpc-error>" "Failed MUST xpath" "$e2" --not-- "<ok/>" "$e1"
+
+    new "parallel $parallel: discard-changes"
+    rpc "<discard-changes/>" "<ok/>"
+
+    new "parallel $parallel: invalid regexps in two shards"
+    edit "<item><name>$e1</name><pattern>(b</pattern></item><item><name>$e2</name><pattern>[a</pattern></item>"
+    rpcx "<validate><source><candidate/></source></validate>" > $dir/err$parallel.xml
+    expectpart "$(cat $dir/err$parallel.xml)" 0 "<rpc-error>" "regexp compile fail" "(b" --not-- "<ok/>" "\[a"
+
+    new "parallel $parallel: invalid regexp in last shard"
+    edit "<item><name>$e1</name><pattern>[0-9]+</pattern></item>"
+    rpcx "<validate><source><candidate/></source></validate>" > $dir/err2$parallel.xml
+    expectpart "$(cat $dir/err2$parallel.xml)" 0 "<rpc-error>" "regexp compile fail" "\[a" --not-- "<ok/>" "(b"
+
+    new "parallel $parallel: discard-changes and validate"
+    rpc "<discard-changes/>" "<ok/>"
+    rpc "<validate><source><candidate/></source></validate>" "<ok/>"
+
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+done
+
+# Errors are the same as sequential
+for f in must mustc must2 err err2; do
+    new "same $f reply sequential and parallel"
+    if ! cmp -s $dir/${f}0.xml $dir/$f$workers.xml; then
+        err "$(cat $dir/${f}0.xml)" "$(cat $dir/$f$workers.xml)"
+    fi
+done
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -225,6 +225,19 @@ EOF
 new "utf-8 string"
 expecteof "$clixon_util_xml -o" 0 "$XML" "^ruled over the shores of the Hreiðsea$"
 
+# Files are parsed by the hand-written scanner, see clixon_xml_scan.c
+new "xml entities"
+expecteofx "$clixon_util_xml -o" 0 "<a>x&amp;y&lt;z&gt;</a>" "<a>x&amp;y&lt;z&gt;</a>"
+
+new "xml comment and processing instruction in element"
+expecteof "$clixon_util_xml -o" 0 "<a><!-- comment --><b>x</b><?pi text?> </a>" "^<a><b>x</b></a>$"
+
+new "xml duplicate attribute replaced"
+expecteof "$clixon_util_xml -o" 0 "<a x=\"1\" x=\"2\"/>" "^<a x=\"2\"/>$"
+
+new "xml end tag mismatch"
+expecteof "$clixon_util_xml -o" 255 "<a><b></a>" ""
+
 rm -rf $dir
 
 new "endtest"
@@ -0,0 +1,58 @@
+#!/usr/bin/env bash
+# Test yang binding and sorting of XML in the same traversal when parsing
+# Lists and leaf-lists in unsorted input are sorted at every level, sorted input is kept,
+# and ordered-by user lists and anydata are not sorted.
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+: ${clixon_util_xml:="clixon_util_xml -D $DBG"}
+
+fyang=$dir/example.yang
+
+cat <<EOF > $fyang
+module example {
+    yang-version 1.1;
+    namespace "urn:example:example";
+    prefix ex;
+    container x{
+        list y{
+          key a;
+          leaf a {
+            type int32;
+          }
+          leaf-list b {
+            type string;
+          }
+          list z{
+            key c;
+            leaf c {
+              type string;
+            }
+          }
+        }
+        list u{
+          key a;
+          ordered-by user;
+          leaf a {
+            type string;
+          }
+        }
+        anydata d;
+    }
+}
+EOF
+
+new "xml parse sorted input, kept"
+expecteof "$clixon_util_xml -y $fyang -o" 0 '<x xmlns="urn:example:example"><y><a>1</a><b>p</b><b>q</b><z><c>m</c></z><z><c>n</c></z></y><y><a>2</a></y></x>' '^<x xmlns="urn:example:example"><y><a>1</a><b>p</b><b>q</b><z><c>m</c></z><z><c>n</c></z></y><y><a>2</a></y></x>$'
+
+new "xml parse unsorted input, sorted at each level"
+expecteof "$clixon_util_xml -y $fyang -o" 0 '<x xmlns="urn:example:example"><y><a>10</a></y><y><a>2</a><z><c>n</c></z><z><c>m</c></z><b>q</b><b>p</b></y></x>' '^<x xmlns="urn:example:example"><y><a>2</a><b>p</b><b>q</b><z><c>m</c></z><z><c>n</c></z></y><y><a>10</a></y></x>$'
+
+new "xml parse ordered-by user and anydata, not sorted"
+expecteof "$clixon_util_xml -y $fyang -o" 0 '<x xmlns="urn:example:example"><d><k>2</k><k>1</k></d><u><a>q</a></u><u><a>p</a></u></x>' '^<x xmlns="urn:example:example"><u><a>q</a></u><u><a>p</a></u><d><k>2</k><k>1</k></d></x>$'
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -0,0 +1,145 @@
+#!/usr/bin/env bash
+# Chunked child vectors of large lists, see CLICON_XML_CHILDVEC_CHUNK
+# Run the same inserts in the middle, deletes and reads of a list with more entries than the
+# chunk threshold without and with chunks, and check that the list is the same.
+# Deletes make the list small enough for the chunks to be merged again.
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+# Backend must be started by the test
+if [ $BE -eq 0 ]; then
+    echo "...skipped: must run with backend"
+    rm -rf $dir
+    if [ "$s" = $0 ]; then exit 0; else return 0; fi
+fi
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/clixon-example.yang
+
+# Number of list entries, larger than the chunk threshold
+: ${perfnr:=5000}
+
+cat <<EOF > $fyang
+module clixon-example{
+    yang-version 1.1;
+    namespace "urn:example:clixon";
+    prefix ex;
+    container x {
+        list y {
+            key a;
+            leaf a {
+                type int32;
+            }
+        }
+    }
+}
+EOF
+
+function rpc()
+{
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS>$1</rpc>" "" "<rpc-reply $DEFAULTNS>$2</rpc-reply>"
+}
+
+# Edit-config of candidate with content $1 of container x
+function edit()
+{
+    rpc "<edit-config><target><candidate/></target><config><x xmlns=\"urn:example:clixon\" xmlns:nc=\"${BASENS}\">$1</x></config></edit-config>" "<ok/>"
+}
+
+# Get-config of candidate with xpath $1, expect content $2 of container x
+function get()
+{
+    rpc "<get-config><source><candidate/></source><filter type=\"xpath\" select=\"$1\" xmlns:ex=\"urn:example:clixon\"/></get-config>" "<data><x xmlns=\"urn:example:clixon\">$2</x></data>"
+}
+
+# Print list entries with keys read from stdin, optionally with delete operation $1
+function entries()
+{
+    while read i; do
+        if [ -n "$1" ]; then
+            echo -n "<y nc:operation=\"$1\"><a>$i</a></y>"
+        else
+            echo -n "<y><a>$i</a></y>"
+        fi
+    done
+}
+
+# Even keys
+Y=$(seq 0 2 $((2*perfnr-2)) | entries)
+# Odd keys inserted in the middle
+ODD="1 $((perfnr-1)) $((2*perfnr-1))"
+Y1=$( (seq 0 2 $((2*perfnr-2)); echo $ODD | tr ' ' '\n') | sort -n | entries)
+# Delete entries until below the threshold
+DEL=$(seq 0 2 $((2*perfnr-2)) | sed -n "1~4p;2~4p;3~4p" | entries delete)
+Y2=$( (seq 0 2 $((2*perfnr-2)) | sed -n "4~4p"; echo $ODD | tr ' ' '\n') | sort -n | entries)
+
+for chunk in false true; do
+    cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_BACKEND_DIR>/usr/local/lib/$APPNAME/backend</CLICON_BACKEND_DIR>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_YANG_LIBRARY>false</CLICON_YANG_LIBRARY>
+  <CLICON_XML_CHILDVEC_CHUNK>$chunk</CLICON_XML_CHILDVEC_CHUNK>
+</clixon-config>
+EOF
+
+    new "test params: -f $cfg"
+
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+
+    new "wait backend"
+    wait_backend
+
+    new "chunk $chunk: add $perfnr entries"
+    edit "$Y"
+    get "/ex:x/ex:y" "$Y"
+
+    new "chunk $chunk: insert entries in the middle"
+    for i in $ODD; do
+        edit "<y><a>$i</a></y>"
+    done
+    get "/ex:x/ex:y" "$Y1"
+
+    new "chunk $chunk: get entry by position"
+    get "/ex:x/ex:y[2]" "<y><a>1</a></y>"
+    get "/ex:x/ex:y[$((perfnr/2+2))]" "<y><a>$((perfnr-1))</a></y>"
+
+    new "chunk $chunk: commit"
+    rpc "<commit/>" "<ok/>"
+
+    new "chunk $chunk: delete entries"
+    edit "$DEL"
+    get "/ex:x/ex:y" "$Y2"
+
+    new "chunk $chunk: commit"
+    rpc "<commit/>" "<ok/>"
+    rpc "<get-config><source><running/></source></get-config>" "<data><x xmlns=\"urn:example:clixon\">$Y2</x></data>"
+
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+done
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -0,0 +1,157 @@
+#!/usr/bin/env bash
+# Comparison of XML subtrees by digest, see CLICON_XML_DIGEST
+# Make the same commits without and with digests, and check with the transaction log of
+# the example backend plugin that the diffs are the same: changed, deleted and added list
+# entries in a list where other entries are equal, and an edit not changing anything.
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+# Backend must be started by the test
+if [ $BE -eq 0 ]; then
+    echo "...skipped: must run with backend"
+    rm -rf $dir
+    if [ "$s" = $0 ]; then exit 0; else return 0; fi
+fi
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/clixon-example.yang
+flog=$dir/backend.log
+
+# Number of list entries
+: ${perfnr:=20}
+
+cat <<EOF > $fyang
+module clixon-example{
+    yang-version 1.1;
+    namespace "urn:example:clixon";
+    prefix ex;
+    container c {
+        list item {
+            key name;
+            leaf name {
+                type int32;
+            }
+            leaf value {
+                type int32;
+            }
+            container sub {
+                leaf w {
+                    type string;
+                }
+            }
+        }
+    }
+}
+EOF
+
+function rpc()
+{
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS>$1</rpc>" "" "<rpc-reply $DEFAULTNS>$2</rpc-reply>"
+}
+
+# Edit-config of candidate with content $1 and commit
+function editcommit()
+{
+    rpc "<edit-config><target><candidate/></target><config><c xmlns=\"urn:example:clixon\">$1</c></config></edit-config>" "<ok/>"
+    rpc "<commit/>" "<ok/>"
+}
+
+# Check number of log lines of a callback
+# @param[in] s  Callback and data, eg "main_commit add: <item>...</item>"
+# @param[in] n  Expected number of lines
+function checkcount(){
+    s=$1
+    n=$2
+    new "Check $n of $s in log"
+    c=$(grep -c "transaction_log [0-9]* $s" $flog)
+    if [ $c -ne $n ]; then
+        err "$n of \"$s\"" "$c"
+    fi
+}
+
+C=""
+for (( i=0; i<$perfnr; i++ )); do
+    C="$C<item><name>$i</name><value>$i</value><sub><w>w$i</w></sub></item>"
+done
+
+for digest in false true; do
+    cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_BACKEND_DIR>/usr/local/lib/$APPNAME/backend</CLICON_BACKEND_DIR>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_YANG_LIBRARY>false</CLICON_YANG_LIBRARY>
+  <CLICON_XML_DIGEST>$digest</CLICON_XML_DIGEST>
+</clixon-config>
+EOF
+
+    new "test params: -f $cfg"
+
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    rm -f $flog
+    touch $flog
+    new "start backend -s init -f $cfg -l f$flog -- -t"
+    start_backend -s init -f $cfg -l f$flog -- -t
+
+    new "wait backend"
+    wait_backend
+
+    new "digest $digest: add $perfnr entries"
+    editcommit "$C"
+
+    new "digest $digest: change value of entry 5"
+    editcommit "<item><name>5</name><value>55</value></item>"
+    checkcount "main_commit change: <value>5</value><value>55</value>" 1
+
+    new "digest $digest: change leaf below entry 7"
+    editcommit "<item><name>7</name><sub><w>x7</w></sub></item>"
+    checkcount "main_commit change: <w>w7</w><w>x7</w>" 1
+
+    new "digest $digest: set same values"
+    editcommit "<item><name>5</name><value>55</value></item><item><name>7</name><sub><w>x7</w></sub></item>"
+    checkcount "main_commit change:" 2
+
+    new "digest $digest: delete entry 3"
+    rpc "<edit-config><target><candidate/></target><config><c xmlns=\"urn:example:clixon\"><item nc:operation=\"delete\" xmlns:nc=\"$BASENS\"><name>3</name></item></c></config></edit-config>" "<ok/>"
+    rpc "<commit/>" "<ok/>"
+    checkcount "main_commit del: <item><name>3</name><value>3</value><sub><w>w3</w></sub></item>" 1
+
+    new "digest $digest: add entry $perfnr"
+    editcommit "<item><name>$perfnr</name><value>0</value></item>"
+    checkcount "main_commit add: <item><name>$perfnr</name><value>0</value></item>" 1
+    checkcount "main_commit change:" 2
+
+    new "digest $digest: get-config entries 5 and 7"
+    rpc "<get-config><source><running/></source><filter type=\"xpath\" select=\"/ex:c/ex:item[ex:name=5 or ex:name=7]\" xmlns:ex=\"urn:example:clixon\"/></get-config>" "<data><c xmlns=\"urn:example:clixon\"><item><name>5</name><value>55</value><sub><w>w5</w></sub></item><item><name>7</name><value>7</value><sub><w>x7</w></sub></item></c></data>"
+
+    new "digest $digest: change candidate and discard"
+    rpc "<edit-config><target><candidate/></target><config><c xmlns=\"urn:example:clixon\"><item><name>9</name><value>99</value></item></c></config></edit-config>" "<ok/>"
+    rpc "<discard-changes/>" "<ok/>"
+    rpc "<commit/>" "<ok/>"
+    checkcount "main_commit change:" 2
+
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+done
+
+rm -rf $dir
+
+new "endtest"
+endtest
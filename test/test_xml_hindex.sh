@@ -0,0 +1,176 @@
+#!/usr/bin/env bash
+# Hash index of list entries for exact key lookups, see CLICON_XML_HASH_INDEX
+# Run the same lookups, edits and deletes of entries of a large list without and with the
+# hash index, and check that the results are the same as with binary search.
+# Includes keys that are equal as integers but not as strings, eg 0150 and 150, and
+# entries added and deleted after the index is built.
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+# Backend must be started by the test
+if [ $BE -eq 0 ]; then
+    echo "...skipped: must run with backend"
+    rm -rf $dir
+    if [ "$s" = $0 ]; then exit 0; else return 0; fi
+fi
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/clixon-example.yang
+
+# Number of list entries, larger than the index threshold
+: ${perfnr:=200}
+
+cat <<EOF > $fyang
+module clixon-example{
+    yang-version 1.1;
+    namespace "urn:example:clixon";
+    prefix ex;
+    container x {
+        list y {
+            key a;
+            leaf a {
+                type int32;
+            }
+            leaf b {
+                type string;
+            }
+        }
+        list z {
+            key "k1 k2";
+            leaf k1 {
+                type string;
+            }
+            leaf k2 {
+                type uint8;
+            }
+            leaf v {
+                type string;
+            }
+        }
+    }
+}
+EOF
+
+function rpc()
+{
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS>$1</rpc>" "" "<rpc-reply $DEFAULTNS>$2</rpc-reply>"
+}
+
+# Edit-config of candidate with content $1 of container x
+function edit()
+{
+    rpc "<edit-config><target><candidate/></target><config><x xmlns=\"urn:example:clixon\" xmlns:nc=\"${BASENS}\">$1</x></config></edit-config>" "<ok/>"
+}
+
+# Get-config of candidate with xpath $1, expect content $2 of container x
+function get()
+{
+    if [ -z "$2" ]; then
+        rpc "<get-config><source><candidate/></source><filter type=\"xpath\" select=\"$1\" xmlns:ex=\"urn:example:clixon\"/></get-config>" "<data/>"
+    else
+        rpc "<get-config><source><candidate/></source><filter type=\"xpath\" select=\"$1\" xmlns:ex=\"urn:example:clixon\"/></get-config>" "<data><x xmlns=\"urn:example:clixon\">$2</x></data>"
+    fi
+}
+
+Y=""
+Z=""
+for (( i=0; i<$perfnr; i++ )); do
+    Y="$Y<y><a>$i</a><b>$i</b></y>"
+    Z="$Z<z><k1>k$i</k1><k2>$((i%2))</k2><v>$i</v></z>"
+done
+
+# Expected content after edits below
+YE=""
+for (( i=0; i<$perfnr; i++ )); do
+    if [ $i -eq 10 ]; then
+        continue
+    elif [ $i -eq 150 ]; then
+        YE="$YE<y><a>$i</a><b>x</b></y>"
+    else
+        YE="$YE<y><a>$i</a><b>$i</b></y>"
+    fi
+done
+YE="$YE<y><a>1000</a><b>1000</b></y>"
+
+for hindex in false true; do
+    cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_BACKEND_DIR>/usr/local/lib/$APPNAME/backend</CLICON_BACKEND_DIR>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_YANG_LIBRARY>false</CLICON_YANG_LIBRARY>
+  <CLICON_XML_HASH_INDEX>$hindex</CLICON_XML_HASH_INDEX>
+</clixon-config>
+EOF
+
+    new "test params: -f $cfg"
+
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+
+    new "wait backend"
+    wait_backend
+
+    new "hindex $hindex: add $perfnr entries"
+    edit "$Y$Z"
+
+    new "hindex $hindex: get entry"
+    get "/ex:x/ex:y[ex:a='150']" "<y><a>150</a><b>150</b></y>"
+
+    new "hindex $hindex: get non-existing entry"
+    get "/ex:x/ex:y[ex:a='$perfnr']" ""
+
+    new "hindex $hindex: get entry with two keys"
+    get "/ex:x/ex:z[ex:k1='k7'][ex:k2='1']" "<z><k1>k7</k1><k2>1</k2><v>7</v></z>"
+
+    new "hindex $hindex: get entry with keys in other order"
+    get "/ex:x/ex:z[ex:k2='1'][ex:k1='k9']" "<z><k1>k9</k1><k2>1</k2><v>9</v></z>"
+
+    new "hindex $hindex: merge entry with same integer key"
+    edit "<y><a>0150</a><b>x</b></y><z><k1>k7</k1><k2>01</k2><v>x</v></z>"
+    get "/ex:x/ex:y[ex:a='150']" "<y><a>150</a><b>x</b></y>"
+    get "/ex:x/ex:z[ex:k1='k7']" "<z><k1>k7</k1><k2>1</k2><v>x</v></z>"
+
+    new "hindex $hindex: add entry after lookup"
+    edit "<y><a>1000</a><b>1000</b></y>"
+    get "/ex:x/ex:y[ex:a='1000']" "<y><a>1000</a><b>1000</b></y>"
+
+    new "hindex $hindex: delete entry after lookup"
+    edit "<y nc:operation=\"delete\"><a>10</a></y>"
+    get "/ex:x/ex:y[ex:a='10']" ""
+
+    new "hindex $hindex: delete non-existing entry fails"
+    rpc "<edit-config><target><candidate/></target><config><x xmlns=\"urn:example:clixon\" xmlns:nc=\"${BASENS}\"><y nc:operation=\"delete\"><a>10</a></y></x></config></edit-config>" "<rpc-error><error-type>application</error-type><error-tag>data-missing</error-tag><error-severity>error</error-severity><error-message>Data does not exist; cannot delete resource</error-message></rpc-error>"
+
+    new "hindex $hindex: all entries"
+    get "/ex:x/ex:y" "$YE"
+
+    new "hindex $hindex: commit"
+    rpc "<commit/>" "<ok/>"
+
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+done
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -0,0 +1,139 @@
+#!/usr/bin/env bash
+# Allocation of XML nodes from slabs, see CLICON_XML_SLAB_ALLOC
+# Run the same edits and gets without and with slab allocation: add, replace and delete
+# large lists so that freed nodes are reused, and check that the results are the same.
+# With slabs, nodes of the config file allocated before the option is set are freed as well.
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+# Backend must be started by the test
+if [ $BE -eq 0 ]; then
+    echo "...skipped: must run with backend"
+    rm -rf $dir
+    if [ "$s" = $0 ]; then exit 0; else return 0; fi
+fi
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/clixon-example.yang
+
+# Number of list entries, larger than a slab chunk
+: ${perfnr:=2000}
+
+cat <<EOF > $fyang
+module clixon-example{
+    yang-version 1.1;
+    namespace "urn:example:clixon";
+    prefix ex;
+    container c {
+        list item {
+            key name;
+            leaf name {
+                type int32;
+            }
+            leaf value {
+                type string;
+            }
+        }
+    }
+}
+EOF
+
+function rpc()
+{
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS>$1</rpc>" "" "<rpc-reply $DEFAULTNS>$2</rpc-reply>"
+}
+
+# Get-config of datastore $1, expected list entries $2
+function getconf()
+{
+    rpc "<get-config><source><$1/></source></get-config>" "<data><c xmlns=\"urn:example:clixon\">$2</c></data>"
+}
+
+# Replace candidate with list entries $1
+function replace()
+{
+    rpc "<edit-config><target><candidate/></target><default-operation>replace</default-operation><config><c xmlns=\"urn:example:clixon\">$1</c></config></edit-config>" "<ok/>"
+}
+
+A=""
+B=""
+for (( i=0; i<$perfnr; i++ )); do
+    A="$A<item><name>$i</name><value>a$i</value></item>"
+    B="$B<item><name>$i</name><value>b$i</value></item>"
+done
+
+for slab in false true; do
+    cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_BACKEND_DIR>/usr/local/lib/$APPNAME/backend</CLICON_BACKEND_DIR>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_YANG_LIBRARY>false</CLICON_YANG_LIBRARY>
+  <CLICON_XML_SLAB_ALLOC>$slab</CLICON_XML_SLAB_ALLOC>
+</clixon-config>
+EOF
+
+    new "test params: -f $cfg"
+
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+
+    new "wait backend"
+    wait_backend
+
+    new "slab $slab: add $perfnr entries"
+    rpc "<edit-config><target><candidate/></target><config><c xmlns=\"urn:example:clixon\">$A</c></config></edit-config>" "<ok/>"
+    rpc "<commit/>" "<ok/>"
+
+    new "slab $slab: get-config running"
+    getconf running "$A"
+
+    new "slab $slab: replace all entries"
+    replace "$B"
+    getconf candidate "$B"
+
+    new "slab $slab: discard-changes"
+    rpc "<discard-changes/>" "<ok/>"
+    getconf candidate "$A"
+
+    new "slab $slab: replace and commit"
+    replace "$B"
+    rpc "<commit/>" "<ok/>"
+    getconf running "$B"
+
+    new "slab $slab: delete all entries"
+    rpc "<edit-config><target><candidate/></target><config><c xmlns=\"urn:example:clixon\" nc:operation=\"delete\" xmlns:nc=\"$BASENS\"/></config></edit-config>" "<ok/>"
+    rpc "<commit/>" "<ok/>"
+    rpc "<get-config><source><running/></source></get-config>" "<data/>"
+
+    new "slab $slab: add entries again"
+    rpc "<edit-config><target><candidate/></target><config><c xmlns=\"urn:example:clixon\">$A</c></config></edit-config>" "<ok/>"
+    rpc "<commit/>" "<ok/>"
+    getconf running "$A"
+
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+done
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -0,0 +1,145 @@
+#!/usr/bin/env bash
+# Sharing of large values between copies of XML trees, see CLICON_XML_VALUE_SHARED
+# Run the same edits and gets without and with shared values, using values larger than
+# the limit that are copied between candidate and running, encoded when printed, and
+# modified in one copy only.
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+# Backend must be started by the test
+if [ $BE -eq 0 ]; then
+    echo "...skipped: must run with backend"
+    rm -rf $dir
+    if [ "$s" = $0 ]; then exit 0; else return 0; fi
+fi
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/clixon-example.yang
+
+# Min length of shared values
+limit=100
+
+cat <<EOF > $fyang
+module clixon-example{
+    yang-version 1.1;
+    namespace "urn:example:clixon";
+    prefix ex;
+    container c {
+        leaf a {
+            type string;
+        }
+        leaf b {
+            type string;
+        }
+        leaf s {
+            type string;
+        }
+    }
+}
+EOF
+
+function rpc()
+{
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS>$1</rpc>" "" "<rpc-reply $DEFAULTNS>$2</rpc-reply>"
+}
+
+# Get-config of datastore $1, expected data $2
+function getconf()
+{
+    rpc "<get-config><source><$1/></source></get-config>" "<data>$2</data>"
+}
+
+# Large values, a with chars that are encoded when printed
+A=""
+B=""
+for (( i=0; i<$limit; i++ )); do
+    A="${A}x&lt;$i&amp;"
+    B="${B}b$i"
+done
+B2="${B}new"
+
+for shared in 0 $limit; do
+    cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_BACKEND_DIR>/usr/local/lib/$APPNAME/backend</CLICON_BACKEND_DIR>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_YANG_LIBRARY>false</CLICON_YANG_LIBRARY>
+  <CLICON_XML_VALUE_SHARED>$shared</CLICON_XML_VALUE_SHARED>
+</clixon-config>
+EOF
+
+    new "test params: -f $cfg"
+
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+
+    new "wait backend"
+    wait_backend
+
+    new "shared $shared: add large and small values"
+    rpc "<edit-config><target><candidate/></target><config><c xmlns=\"urn:example:clixon\"><a>$A</a><b>$B</b><s>small</s></c></config></edit-config>" "<ok/>"
+
+    new "shared $shared: commit"
+    rpc "<commit/>" "<ok/>"
+
+    new "shared $shared: get-config running"
+    getconf running "<c xmlns=\"urn:example:clixon\"><a>$A</a><b>$B</b><s>small</s></c>"
+
+    new "shared $shared: get-config running again"
+    getconf running "<c xmlns=\"urn:example:clixon\"><a>$A</a><b>$B</b><s>small</s></c>"
+
+    new "shared $shared: modify large value in candidate"
+    rpc "<edit-config><target><candidate/></target><config><c xmlns=\"urn:example:clixon\"><b>$B2</b></c></config></edit-config>" "<ok/>"
+
+    new "shared $shared: get-config candidate is changed"
+    getconf candidate "<c xmlns=\"urn:example:clixon\"><a>$A</a><b>$B2</b><s>small</s></c>"
+
+    new "shared $shared: get-config running is not changed"
+    getconf running "<c xmlns=\"urn:example:clixon\"><a>$A</a><b>$B</b><s>small</s></c>"
+
+    new "shared $shared: discard-changes"
+    rpc "<discard-changes/>" "<ok/>"
+
+    new "shared $shared: get-config candidate"
+    getconf candidate "<c xmlns=\"urn:example:clixon\"><a>$A</a><b>$B</b><s>small</s></c>"
+
+    new "shared $shared: copy-config running to startup"
+    rpc "<copy-config><target><startup/></target><source><running/></source></copy-config>" "<ok/>"
+
+    new "shared $shared: delete large value in running"
+    rpc "<edit-config><target><candidate/></target><config><c xmlns=\"urn:example:clixon\"><a nc:operation=\"delete\" xmlns:nc=\"$BASENS\"/></c></config></edit-config>" "<ok/>"
+    rpc "<commit/>" "<ok/>"
+
+    new "shared $shared: get-config running without a"
+    getconf running "<c xmlns=\"urn:example:clixon\"><b>$B</b><s>small</s></c>"
+
+    new "shared $shared: get-config startup"
+    getconf startup "<c xmlns=\"urn:example:clixon\"><a>$A</a><b>$B</b><s>small</s></c>"
+
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+done
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -596,6 +596,24 @@ expectpart "$($clixon_util_xpath -D $DBG -f $dir/1.xml -n ex:urn:example:clixon
 new "xpath issue fail"
 expectpart "$($clixon_util_xpath -D $DBG -f $dir/1.xml -n null:urn:ietf:params:xml:ns:netconf:base:1.0 -n ex:urn:example:clixon -y $fyang -p "/ex:table/ex:options/*")" 0 "<max-number>50000</max-number>"
 
+cat <<EOF > $dir/2.xml
+<a xmlns="urn:example:a" xmlns:p="urn:example:p1">
+   <b>
+      <p:c>1</p:c>
+      <d xmlns:p="urn:example:p2">
+         <p:c>2</p:c>
+         <e><p:c>3</p:c></e>
+      </d>
+   </b>
+</a>
+EOF
+
+new "xpath prefix redeclared in nested scope"
+expectpart "$($clixon_util_xpath -D $DBG -f $dir/2.xml -n q:urn:example:p2 -p "//q:c")" 0 "<p:c>2</p:c>" "<p:c>3</p:c>" --not-- "<p:c>1</p:c>"
+
+new "xpath prefix of outer scope"
+expectpart "$($clixon_util_xpath -D $DBG -f $dir/2.xml -n q:urn:example:p1 -p "//q:c")" 0 "<p:c>1</p:c>" --not-- "<p:c>2</p:c>" "<p:c>3</p:c>"
+
 rm -rf $dir
 
 new "endtest"
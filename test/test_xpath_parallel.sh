@@ -0,0 +1,169 @@
+#!/usr/bin/env bash
+# Parallel evaluation of XPath predicates over large node-sets, see CLICON_XPATH_PARALLEL
+# Run the same get-configs with an XPath filter over a list larger than XPATH_PARALLEL_MIN
+# sequentially and with several processes, and check that results and errors are the same.
+# Errors are made by entries with invalid regexps in shards of workers: the failed shards are
+# evaluated again by the backend, and the first error in document order is reported.
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+# Backend must be started by the test
+if [ $BE -eq 0 ]; then
+    echo "...skipped: must run with backend"
+    rm -rf $dir
+    if [ "$s" = $0 ]; then exit 0; else return 0; fi
+fi
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/clixon-example.yang
+
+# Number of list entries, larger than XPATH_PARALLEL_MIN in include/clixon_custom.h
+: ${perfnr:=12000}
+
+# Number of processes, each evaluates perfnr/workers entries
+workers=4
+
+cat <<EOF > $fyang
+module clixon-example{
+    yang-version 1.1;
+    namespace "urn:example:clixon";
+    prefix ex;
+    container c {
+        list item {
+            key name;
+            leaf name {
+                type int32;
+            }
+            leaf value {
+                type string;
+            }
+            leaf pattern {
+                type string;
+            }
+        }
+    }
+}
+EOF
+
+function rpc()
+{
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS>$1</rpc>" "" "<rpc-reply $DEFAULTNS>$2</rpc-reply>"
+}
+
+# Get-config of running with xpath filter $1, print reply
+function getx()
+{
+    echo "$DEFAULTHELLO$(chunked_framing "<rpc $DEFAULTNS><get-config><source><running/></source><filter type=\"xpath\" select=\"$1\" xmlns:ex=\"urn:example:clixon\"/></get-config></rpc>")" | $clixon_netconf -qf $cfg
+}
+
+# Set pattern of entry $1 to $2 and commit
+function setpattern()
+{
+    rpc "<edit-config><target><candidate/></target><config><c xmlns=\"urn:example:clixon\"><item><name>$1</name><pattern>$2</pattern></item></c></config></edit-config>" "<ok/>"
+    rpc "<commit/>" "<ok/>"
+}
+
+# Entries whose pattern matches their value: every 1000th from 3
+C=""
+M=""
+N=""
+for (( i=0; i<$perfnr; i++ )); do
+    if [ $((i%1000)) -eq 3 ]; then
+        e="<item><name>$i</name><value>v$i</value><pattern>v[0-9]+</pattern></item>"
+        M="$M$e"
+    else
+        e="<item><name>$i</name><value>v$i</value><pattern>x.*</pattern></item>"
+    fi
+    if [ $((i%1000)) -eq 7 ]; then
+        N="$N$e"
+    fi
+    C="$C$e"
+done
+
+for parallel in 0 $workers; do
+    cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_BACKEND_DIR>/usr/local/lib/$APPNAME/backend</CLICON_BACKEND_DIR>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_YANG_LIBRARY>false</CLICON_YANG_LIBRARY>
+  <CLICON_XPATH_PARALLEL>$parallel</CLICON_XPATH_PARALLEL>
+</clixon-config>
+EOF
+
+    new "test params: -f $cfg"
+
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+
+    new "wait backend"
+    wait_backend
+
+    new "parallel $parallel: add $perfnr entries"
+    rpc "<edit-config><target><candidate/></target><config><c xmlns=\"urn:example:clixon\">$C</c></config></edit-config>" "<ok/>"
+    rpc "<commit/>" "<ok/>"
+
+    new "parallel $parallel: numeric predicate"
+    getx "/ex:c/ex:item[ex:name mod 1000 = 7]" > $dir/num$parallel.xml
+    rpc "<get-config><source><running/></source><filter type=\"xpath\" select=\"/ex:c/ex:item[ex:name mod 1000 = 7]\" xmlns:ex=\"urn:example:clixon\"/></get-config>" "<data><c xmlns=\"urn:example:clixon\">$N</c></data>"
+
+    new "parallel $parallel: function predicate"
+    getx "/ex:c/ex:item[re-match(ex:value, ex:pattern)]" > $dir/fn$parallel.xml
+    rpc "<get-config><source><running/></source><filter type=\"xpath\" select=\"/ex:c/ex:item[re-match(ex:value, ex:pattern)]\" xmlns:ex=\"urn:example:clixon\"/></get-config>" "<data><c xmlns=\"urn:example:clixon\">$M</c></data>"
+
+    new "parallel $parallel: position predicate"
+    getx "/ex:c/ex:item[position() = $perfnr - 1]/ex:value" > $dir/pos$parallel.xml
+    expectpart "$(cat $dir/pos$parallel.xml)" 0 "<value>v[0-9]*</value>" --not-- "<rpc-error>"
+
+    new "parallel $parallel: invalid regexps in two shards"
+    setpattern 5000 "(b"
+    setpattern $((perfnr-1000)) "[a"
+    getx "/ex:c/ex:item[re-match(ex:value, ex:pattern)]" > $dir/err$parallel.xml
+    expectpart "$(cat $dir/err$parallel.xml)" 0 "<rpc-error>" "regexp compile fail" "(b" --not-- "<data>" "\[a"
+
+    new "parallel $parallel: invalid regexp in last shard"
+    setpattern 5000 "x.*"
+    getx "/ex:c/ex:item[re-match(ex:value, ex:pattern)]" > $dir/err2$parallel.xml
+    expectpart "$(cat $dir/err2$parallel.xml)" 0 "<rpc-error>" "regexp compile fail" "\[a" --not-- "<data>" "(b"
+
+    new "parallel $parallel: valid regexps again"
+    setpattern $((perfnr-1000)) "x.*"
+    getx "/ex:c/ex:item[re-match(ex:value, ex:pattern)]" > $dir/fn2$parallel.xml
+    if ! cmp -s $dir/fn$parallel.xml $dir/fn2$parallel.xml; then
+        err "$(cat $dir/fn$parallel.xml)" "$(cat $dir/fn2$parallel.xml)"
+    fi
+
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+done
+
+# Replies are the same as sequential
+for f in num fn pos err err2 fn2; do
+    new "same $f reply sequential and parallel"
+    if ! cmp -s $dir/${f}0.xml $dir/$f$workers.xml; then
+        err "$(cat $dir/${f}0.xml)" "$(cat $dir/$f$workers.xml)"
+    fi
+done
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -0,0 +1,175 @@
+#!/usr/bin/env bash
+# Cache of parsed XPath trees, see CLICON_XPATH_PARSE_CACHE and XPATH_PARSE_CACHE
+# Run the same validations and XPath filters without and with the cache, and check that
+# the results are the same.
+# Uses more distinct must expressions than the cache size so that entries are evicted
+# during validation, and deref() which parses a leafref path in an ongoing evaluation.
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+# Backend must be started by the test
+if [ $BE -eq 0 ]; then
+    echo "...skipped: must run with backend"
+    rm -rf $dir
+    if [ "$s" = $0 ]; then exit 0; else return 0; fi
+fi
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/clixon-example.yang
+
+# Number of must expressions, larger than XPATH_PARSE_CACHE
+: ${perfnr:=600}
+
+cat <<EOF > $fyang
+module clixon-example{
+    yang-version 1.1;
+    namespace "urn:example:clixon";
+    prefix ex;
+    container c {
+EOF
+for (( i=0; i<$perfnr; i++ )); do
+    cat <<EOF >> $fyang
+        leaf l$i {
+            type int32;
+            must ". != $i";
+        }
+EOF
+done
+cat <<EOF >> $fyang
+    }
+    container d {
+        list item {
+            key name;
+            leaf name {
+                type string;
+            }
+            leaf value {
+                type int32;
+            }
+        }
+        leaf ref {
+            type leafref {
+                path "../item/name";
+            }
+            must "deref(.)/../value != 0";
+        }
+        leaf w {
+            when "../ref = 'a'";
+            type string;
+        }
+    }
+}
+EOF
+
+function rpc()
+{
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS>$1</rpc>" "" "<rpc-reply $DEFAULTNS>$2</rpc-reply>"
+}
+
+# Edit-config of candidate with content $1
+function edit()
+{
+    rpc "<edit-config><target><candidate/></target><config>$1</config></edit-config>" "<ok/>"
+}
+
+# Validate of candidate fails with error-message starting with $1
+function validate_fail()
+{
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><validate><source><candidate/></source></validate></rpc>" "<rpc-reply $DEFAULTNS><rpc-error><error-type>application</error-type><error-tag>operation-failed</error-tag><error-severity>error</error-severity><error-message>$1" ""
+}
+
+C=""
+for (( i=0; i<$perfnr; i++ )); do
+    C="$C<l$i>$((i+1))</l$i>"
+done
+D="<item><name>a</name><value>1</value></item><item><name>b</name><value>0</value></item>"
+
+for cache in false true; do
+    cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_BACKEND_DIR>/usr/local/lib/$APPNAME/backend</CLICON_BACKEND_DIR>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_YANG_LIBRARY>false</CLICON_YANG_LIBRARY>
+  <CLICON_XPATH_PARSE_CACHE>$cache</CLICON_XPATH_PARSE_CACHE>
+</clixon-config>
+EOF
+
+    new "test params: -f $cfg"
+
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+
+    new "wait backend"
+    wait_backend
+
+    new "cache $cache: add $perfnr leafs with must"
+    edit "<c xmlns=\"urn:example:clixon\">$C</c>"
+
+    new "cache $cache: validate ok"
+    rpc "<validate><source><candidate/></source></validate>" "<ok/>"
+
+    new "cache $cache: validate ok again"
+    rpc "<validate><source><candidate/></source></validate>" "<ok/>"
+
+    new "cache $cache: stats reports xpath-parse cache"
+    if $cache; then
+        expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><stats $LIBNS/></rpc>" "<caches xmlns=\"http://clicon.org/lib\"><cache><name>xpath-parse</name><entries>[1-9][0-9]*</entries><hits>[1-9][0-9]*</hits><misses>[0-9]*</misses></cache>" ""
+    else
+        expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><stats $LIBNS/></rpc>" "" "<caches xmlns=\"http://clicon.org/lib\"><cache><name>xpath-parse</name><entries>0</entries><hits>0</hits><misses>0</misses></cache>"
+    fi
+
+    new "cache $cache: change leaf to fail must"
+    edit "<c xmlns=\"urn:example:clixon\"><l300>300</l300></c>"
+    validate_fail "Failed MUST xpath '. != 300'"
+
+    new "cache $cache: change leaf back"
+    edit "<c xmlns=\"urn:example:clixon\"><l300>301</l300></c>"
+    rpc "<validate><source><candidate/></source></validate>" "<ok/>"
+
+    new "cache $cache: deref ok"
+    edit "<d xmlns=\"urn:example:clixon\">$D<ref>a</ref><w>x</w></d>"
+    rpc "<validate><source><candidate/></source></validate>" "<ok/>"
+
+    new "cache $cache: deref fail"
+    edit "<d xmlns=\"urn:example:clixon\"><ref>b</ref></d>"
+    validate_fail "Failed MUST xpath 'deref(.)/../value != 0'"
+
+    new "cache $cache: when fail"
+    edit "<d xmlns=\"urn:example:clixon\"><item><name>b</name><value>2</value></item></d>"
+    validate_fail "WHEN condition failed"
+
+    new "cache $cache: commit"
+    edit "<d xmlns=\"urn:example:clixon\"><ref>a</ref></d>"
+    rpc "<commit/>" "<ok/>"
+
+    new "cache $cache: get-config with xpath filter"
+    rpc "<get-config><source><running/></source><filter type=\"xpath\" select=\"/ex:d/ex:item[ex:value > 1]\" xmlns:ex=\"urn:example:clixon\"/></get-config>" "<data><d xmlns=\"urn:example:clixon\"><item><name>b</name><value>2</value></item></d></data>"
+    rpc "<get-config><source><running/></source><filter type=\"xpath\" select=\"/ex:c/ex:l300\" xmlns:ex=\"urn:example:clixon\"/></get-config>" "<data><c xmlns=\"urn:example:clixon\"><l300>301</l300></c></data>"
+
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+done
+
+rm -rf $dir
+
+new "endtest"
+endtest
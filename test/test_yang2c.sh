@@ -0,0 +1,256 @@
+#!/usr/bin/env bash
+# Typed C accessors generated from YANG, see clixon_yang2c.c
+# Generate a header with clixon_backend -G, compile a C backend plugin that reads committed
+# values in a transaction callback using the generated structs, and check the values.
+# Also compile a C++ file using the constant expression indexed accessors.
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+# Backend must be started by the test
+if [ $BE -eq 0 ]; then
+    echo "...skipped: must run with backend"
+    rm -rf $dir
+    if [ "$s" = $0 ]; then exit 0; else return 0; fi
+fi
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/clixon-example.yang
+pdir=$dir/plugin
+hfile=$dir/clixon_example_yang2c.h
+cfile=$dir/example-yang2c.c
+cxxfile=$dir/example-yang2c.cpp
+sofile=$pdir/example-yang2c.so
+fout=$dir/yang2c.out
+
+test -d $pdir || mkdir $pdir
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>$dir</CLICON_YANG_DIR>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_BACKEND_DIR>$pdir</CLICON_BACKEND_DIR>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_YANG_LIBRARY>false</CLICON_YANG_LIBRARY>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module clixon-example{
+    yang-version 1.1;
+    namespace "urn:example:clixon";
+    prefix ex;
+    typedef percent {
+        type uint8 {
+            range "0..100";
+        }
+    }
+    container table{
+        list parameter{
+            key name;
+            leaf name{
+                type string;
+            }
+            leaf value{
+                type int32;
+            }
+            leaf enabled{
+                type boolean;
+            }
+            leaf ratio{
+                type decimal64{
+                    fraction-digits 2;
+                }
+            }
+            leaf load{
+                type percent;
+            }
+            choice kind{
+                leaf flag{
+                    type empty;
+                }
+                leaf default{
+                    type string;
+                }
+            }
+            leaf-list tag{
+                type string;
+            }
+        }
+    }
+}
+EOF
+
+cat <<EOF > $cfile
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <sys/syslog.h>
+
+/* cligen */
+#include <cligen/cligen.h>
+
+/* Clixon */
+#include <clixon/clixon.h>
+#include <clixon/clixon_backend.h>
+
+#include "clixon_example_yang2c.h"
+
+/*! Write committed parameters to file using generated accessors
+ */
+static int
+yang2c_commit(clixon_handle    h,
+              transaction_data td)
+{
+    int                                   retval = -1;
+    struct clixon_example                 top;
+    struct clixon_example_table           table;
+    struct clixon_example_table_parameter p;
+    cxobj                                *x = NULL;
+    FILE                                 *f = NULL;
+
+    if ((f = fopen("$fout", "w")) == NULL){
+        clixon_err(OE_UNIX, errno, "fopen");
+        goto done;
+    }
+    if (clixon_example_get(transaction_target(td), &top) < 0)
+        goto done;
+    if (top.table == NULL)
+        goto ok;
+    if (clixon_example_table_get(top.table, &table) < 0)
+        goto done;
+    while ((x = xml_child_each(table.x, x, CX_ELMNT)) != NULL) {
+        if (xml_spec(x) != clixon_example_yspecs[CLIXON_EXAMPLE_TABLE_PARAMETER])
+            continue;
+        if (clixon_example_table_parameter_get(x, &p) < 0)
+            goto done;
+        fprintf(f, "%s", p.name);
+        if (p.value_set)
+            fprintf(f, " value:%" PRId32, p.value);
+        if (p.enabled_set)
+            fprintf(f, " enabled:%d", p.enabled);
+        if (p.ratio_set)
+            fprintf(f, " ratio:%" PRId64, p.ratio);
+        if (p.load_set)
+            fprintf(f, " load:%" PRIu8, p.load);
+        if (p.flag_set)
+            fprintf(f, " flag:%d", p.flag);
+        if (p.default__set)
+            fprintf(f, " default:%s", p.default_);
+        if (p.tag)
+            fprintf(f, " tag:%s", xml_body(p.tag));
+        fprintf(f, "\n");
+    }
+ ok:
+    retval = 0;
+ done:
+    if (f)
+        fclose(f);
+    return retval;
+}
+
+/*! Bind schema node ids when all YANG modules are loaded
+ */
+static int
+yang2c_start(clixon_handle h)
+{
+    return clixon_example_yang2c_init(h);
+}
+
+clixon_plugin_api *clixon_plugin_init(clixon_handle h);
+
+static clixon_plugin_api api = {
+    .ca_name = "yang2c",
+    .ca_init = clixon_plugin_init,
+    .ca_start = yang2c_start,
+    .ca_trans_commit = yang2c_commit,
+};
+
+clixon_plugin_api *
+clixon_plugin_init(clixon_handle h)
+{
+    return &api;
+}
+EOF
+
+cat <<EOF > $cxxfile
+#include <cligen/cligen.h>
+#include <clixon/clixon.h>
+
+#include "clixon_example_yang2c.h"
+
+int
+parameter_value(cxobj *x)
+{
+    int32_t value = 0;
+    char   *name = NULL;
+
+    if (clixon_example_yang2c::get<CLIXON_EXAMPLE_TABLE_PARAMETER_NAME>(x, name) < 0)
+        return -1;
+    if (clixon_example_yang2c::get<CLIXON_EXAMPLE_TABLE_PARAMETER_VALUE>(x, value) < 0)
+        return -1;
+    return value;
+}
+EOF
+
+new "kill old backend"
+sudo clixon_backend -zf $cfg
+if [ $? -ne 0 ]; then
+    err
+fi
+
+new "generate C accessors"
+sudo $clixon_backend -f $cfg -G clixon-example > $hfile
+if [ $? -ne 0 ]; then
+    err "generated header" "$(cat $hfile)"
+fi
+
+new "check generated schema node ids"
+expectpart "$(cat $hfile)" 0 "CLIXON_EXAMPLE_TABLE_PARAMETER_VALUE," "\"/ex:table/ex:parameter/ex:flag\"," "int32_t value;" "uint8_t load;" "char \*default_;" "cxobj \*tag;"
+
+new "generate from unknown module"
+expectpart "$(sudo $clixon_backend -f $cfg -G clixon-xxx 2>&1)" 255 "Yang module clixon-xxx not found"
+
+new "compile $cfile"
+# -I /usr/local_include for eg freebsd
+expectpart "$($CC -g -Wall -rdynamic -fPIC -shared -I/usr/local/include -I$dir $cfile -o $sofile)" 0 ""
+
+new "C++ compile $cxxfile"
+expectpart "$($CXX -g -Wall -fsyntax-only -I/usr/local/include -I$dir $cxxfile)" 0 ""
+
+new "start backend -s init -f $cfg"
+start_backend -s init -f $cfg
+
+new "wait backend"
+wait_backend
+
+new "edit-config"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><table xmlns=\"urn:example:clixon\"><parameter><name>a</name><value>-42</value><enabled>true</enabled><ratio>3.14</ratio><load>99</load><flag/><tag>x</tag><tag>y</tag></parameter><parameter><name>b</name><default>z</default></parameter></table></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "commit"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "check typed values"
+expectpart "$(cat $fout)" 0 "^a value:-42 enabled:1 ratio:314 load:99 flag:1 tag:x$" "^b default:z$"
+
+new "Kill backend"
+# Check if premature kill
+pid=$(pgrep -u root -f clixon_backend)
+if [ -z "$pid" ]; then
+    err "backend already dead"
+fi
+# kill backend
+stop_backend -f $cfg
+
+rm -rf $dir
+
+new "endtest"
+endtest
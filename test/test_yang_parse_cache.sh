@@ -0,0 +1,111 @@
+#!/usr/bin/env bash
+# YANG parse cache, see CLICON_YANG_PARSE_CACHE_DIR
+# Start backend twice, first time parse-trees are written, second time read from cache
+# Check that values created when parsing (eg max-elements) are the same
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/cache.yang
+cachedir=$dir/ycache
+
+test -d $cachedir || mkdir -p $cachedir
+chmod 777 $cachedir
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>$dir</CLICON_YANG_DIR>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_YANG_PARSE_CACHE_DIR>$cachedir</CLICON_YANG_PARSE_CACHE_DIR>
+  <CLICON_CLISPEC_DIR>/usr/local/lib/$APPNAME/clispec</CLICON_CLISPEC_DIR>
+  <CLICON_CLI_DIR>/usr/local/lib/$APPNAME/cli</CLICON_CLI_DIR>
+  <CLICON_CLI_MODE>$APPNAME</CLICON_CLI_MODE>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module cache{
+    yang-version 1.1;
+    namespace "urn:example:cache";
+    prefix ex;
+    revision 2026-03-01;
+    container c{
+        list x{
+            key k;
+            max-elements 2;
+            leaf k{
+                type string;
+            }
+            leaf d{
+                type decimal64{
+                    fraction-digits 2;
+                }
+            }
+        }
+    }
+}
+EOF
+
+for i in 1 2; do
+    new "test params: -f $cfg run $i"
+
+    if [ $BE -ne 0 ]; then
+        new "kill old backend"
+        sudo clixon_backend -zf $cfg
+        if [ $? -ne 0 ]; then
+            err
+        fi
+        new "start backend -s init -f $cfg"
+        start_backend -s init -f $cfg
+    fi
+
+    new "wait backend"
+    wait_backend
+
+    new "parse cache files exist"
+    if [ -z "$(ls $cachedir/*.ypc 2> /dev/null)" ]; then
+        err "cache files in $cachedir" "none"
+    fi
+
+    new "add two entries"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><c xmlns=\"urn:example:cache\"><x><k>a</k><d>1.25</d></x><x><k>b</k></x></c></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+    new "get decimal64"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><candidate/></source><filter type=\"xpath\" select=\"/ex:c/ex:x[ex:k='a']\" xmlns:ex=\"urn:example:cache\"/></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><c xmlns=\"urn:example:cache\"><x><k>a</k><d>1.25</d></x></c></data></rpc-reply>"
+
+    new "add third entry, expect fail"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><c xmlns=\"urn:example:cache\"><x><k>c</k></x></c></config></edit-config></rpc>" "<error-app-tag>too-many-elements</error-app-tag>" ""
+
+    new "discard"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><discard-changes/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+    if [ $BE -ne 0 ]; then
+        new "Kill backend"
+        # Check if premature kill
+        pid=$(pgrep -u root -f clixon_backend)
+        if [ -z "$pid" ]; then
+            err "backend already dead"
+        fi
+        # kill backend
+        stop_backend -f $cfg
+    fi
+done
+
+new "corrupt cache files are ignored"
+for f in $cachedir/*.ypc; do
+    echo "garbage" > $f
+done
+expectpart "$($clixon_cli -1 -f $cfg show version)" 0 "${CLIXON_VERSION}"
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -0,0 +1,175 @@
+#!/usr/bin/env bash
+# Parallel parsing of the YANG files of a directory, see CLICON_YANG_PARSE_PARALLEL
+# Load many YANG modules of CLICON_YANG_MAIN_DIR sequentially and with several processes,
+# and check that results and errors are the same.
+# Syntax errors in two files make the workers skip them: they are parsed again when loaded,
+# and the first error in file order is reported.
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+# Backend must be started by the test
+if [ $BE -eq 0 ]; then
+    echo "...skipped: must run with backend"
+    rm -rf $dir
+    if [ "$s" = $0 ]; then exit 0; else return 0; fi
+fi
+
+cfg=$dir/conf_yang.xml
+ydir=$dir/yang
+
+# Number of YANG modules
+nr=20
+
+# Number of processes
+workers=4
+
+test -d $ydir || mkdir $ydir
+
+cat <<EOF > $ydir/ex00.yang
+module ex00{
+    yang-version 1.1;
+    namespace "urn:example:ex00";
+    prefix ex00;
+    typedef t {
+        type string {
+            length "1..8";
+        }
+    }
+    container c {
+        leaf v {
+            type t;
+        }
+    }
+}
+EOF
+
+# Module $1 that uses the typedef of ex00
+function module()
+{
+    cat <<EOF
+module $1{
+    yang-version 1.1;
+    namespace "urn:example:$1";
+    prefix $1;
+    import ex00 {
+        prefix ex00;
+    }
+    container c {
+        leaf v {
+            type ex00:t;
+        }
+    }
+}
+EOF
+}
+
+# Module $1 with syntax error
+function badmodule()
+{
+    cat <<EOF
+module $1{
+    yang-version 1.1;
+    namespace "urn:example:$1";
+    prefix $1;
+    container c {
+        leaf v {
+            type string
+        }
+    }
+}
+EOF
+}
+
+function rpc()
+{
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS>$1</rpc>" "" "<rpc-reply $DEFAULTNS>$2</rpc-reply>"
+}
+
+C=""
+for (( i=0; i<$nr; i++ )); do
+    m=$(printf "ex%02d" $i)
+    if [ $i -gt 0 ]; then
+        module $m > $ydir/$m.yang
+    fi
+    C="$C<c xmlns=\"urn:example:$m\"><v>$m</v></c>"
+done
+
+for parallel in 0 $workers; do
+    cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_DIR>$ydir</CLICON_YANG_MAIN_DIR>
+  <CLICON_YANG_LIBRARY>false</CLICON_YANG_LIBRARY>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_DIR>/usr/local/lib/$APPNAME/backend</CLICON_BACKEND_DIR>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_YANG_PARSE_PARALLEL>$parallel</CLICON_YANG_PARSE_PARALLEL>
+</clixon-config>
+EOF
+
+    new "test params: -f $cfg"
+
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+
+    new "wait backend"
+    wait_backend
+
+    new "parallel $parallel: edit all $nr modules"
+    rpc "<edit-config><target><candidate/></target><config>$C</config></edit-config>" "<ok/>"
+
+    new "parallel $parallel: get-config"
+    rpc "<get-config><source><candidate/></source></get-config>" "<data>$C</data>"
+
+    new "parallel $parallel: imported typedef"
+    rpc "<edit-config><target><candidate/></target><config><c xmlns=\"urn:example:ex19\"><v>toolongvalue</v></c></config></edit-config>" "<ok/>"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><validate><source><candidate/></source></validate></rpc>" "<rpc-reply $DEFAULTNS><rpc-error><error-type>application</error-type><error-tag>bad-element</error-tag><error-info><bad-element>v</bad-element></error-info><error-severity>error</error-severity><error-message>String length 12 out of range: 1 - 8"
+    rpc "<discard-changes/>" "<ok/>"
+
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+
+    new "parallel $parallel: syntax errors in two files"
+    badmodule ex05 > $ydir/ex05.yang
+    badmodule ex15 > $ydir/ex15.yang
+    ret=$(sudo $clixon_backend -F1s init -f $cfg -l o 2>&1)
+    expectpart "$ret" 255 "ex05.yang on line 8" --not-- "ex15.yang"
+    echo "$ret" | grep -o "ex[0-9]*\.yang on line.*" > $dir/err$parallel
+
+    new "parallel $parallel: syntax error in last file"
+    module ex05 > $ydir/ex05.yang
+    ret=$(sudo $clixon_backend -F1s init -f $cfg -l o 2>&1)
+    expectpart "$ret" 255 "ex15.yang on line 8" --not-- "ex05.yang"
+    echo "$ret" | grep -o "ex[0-9]*\.yang on line.*" > $dir/err2$parallel
+
+    module ex15 > $ydir/ex15.yang
+done
+
+# Errors are the same as sequential
+for f in err err2; do
+    new "same $f sequential and parallel"
+    if ! cmp -s $dir/${f}0 $dir/$f$workers; then
+        err "$(cat $dir/${f}0)" "$(cat $dir/$f$workers)"
+    fi
+done
+
+rm -rf $dir
+
+new "endtest"
+endtest